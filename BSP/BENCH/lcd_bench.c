@@ -0,0 +1,395 @@
+/**
+ ******************************************************************************
+ * @file    lcd_bench.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   屏幕渲染基准测试实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 测试项(名称即结果表中的 name)：
+ * - gb_index / u8_index：GB2312_FindIndex_Flash / UTF8_FindIndex_Flash
+ *   遍历同一组汉字，每字平均周期
+ * - glyph：LCD_DisplayChinese 逐字绘制(查找 + DrawFont_Bitmap 展开 + 发送)，
+ *   每字平均周期，减去 *_index 即为绘制本身的开销
+ * - text：LCD_MeasureTextCycles 整行中英文混排，每字平均周期
+ * - writebuff / fillrect / clear：LCD_WriteBuff、LCD_FillRect、LCD_Clear
+ *   单次调用周期，只测热Cache
+ * - window / win_px：BENCH_WINDOWS 个16像素的小窗口逐个发送，每窗口平均周期；
+ *   win_px 的 cycles 为扣除像素本身后一个窗口的开销折合的像素数，
+ *   同时经 LCD_Flush_SetWindowCost() 设为帧缓冲脏矩形合并的代价模型
+ * - exp_bit / exp_lut / exp_sel：LCD_MeasureExpandCycles 把一个字号见方的
+ *   1bpp字模按逐位判断、查展开表、__SEL选取三种方式展开，每字平均周期，
+ *   只测热Cache；exp_sel 明显小于 exp_lut 时定义 LCD_EXPAND_SEL_ENABLE
+ *
+ * 所有计时都包含等待最后一次SPI/BDMA传输结束(LCD_WaitIdle)
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+#include <stdio.h>
+
+#if defined(LCD_BENCH_ENABLE) && defined(LCD_SPI_ENABLE) &&                    \
+    defined(FLASH_FONT_ENABLE)
+
+/*******************************************************************************
+ *                              测试语料
+ ******************************************************************************/
+
+#define BENCH_HZ_COUNT 24 /*!< 汉字语料字数 */
+
+/* 界面常用字，UTF8每字3字节 */
+static const char g_bench_hz_utf8[] =
+    "温度湿度电压电流设置返回确定取消字库渲染性能测试";
+
+/* 与 g_bench_hz_utf8 相同的汉字，GB2312每字2字节 */
+static const char g_bench_hz_gbk[] =
+    "\xCE\xC2\xB6\xC8\xCA\xAA\xB6\xC8\xB5\xE7\xD1\xB9\xB5\xE7\xC1\xF7"
+    "\xC9\xE8\xD6\xC3\xB7\xB5\xBB\xD8\xC8\xB7\xB6\xA8\xC8\xA1\xCF\xFB"
+    "\xD7\xD6\xBF\xE2\xE4\xD6\xC8\xBE\xD0\xD4\xC4\xDC\xB2\xE2\xCA\xD4";
+
+/* 整行混排语料，编码与 LCD_DisplayText 的输入一致 */
+#ifdef IS_GB2312
+static const char g_bench_text[] = "\xCE\xC2\xB6\xC8" "25.6C \xCA\xAA\xB6\xC8"
+                                   "48% \xB5\xE7\xD1\xB9" "3.30V \xC9\xE8\xD6\xC3"
+                                   " \xB7\xB5\xBB\xD8" " OK";
+#define BENCH_HZ_TEXT g_bench_hz_gbk /*!< LCD_DisplayChinese 的输入 */
+#define BENCH_HZ_STRIDE 2
+#else
+static const char g_bench_text[] = "温度25.6C 湿度48% 电压3.30V 设置 返回 OK";
+#define BENCH_HZ_TEXT g_bench_hz_utf8
+#define BENCH_HZ_STRIDE 3
+#endif
+
+static const uint8_t g_bench_sizes[] = {12, 16, 20, 24, 32}; /*!< 测试字号 */
+
+#define BENCH_BLOCK_LINES 16 /*!< writebuff 测试的行数 */
+#define BENCH_WINDOWS 64       /*!< window 测试的窗口数 */
+#define BENCH_WINDOW_PIXELS 16 /*!< window 测试每个窗口的像素数 */
+
+/*******************************************************************************
+ *                              私有变量
+ ******************************************************************************/
+
+static LCD_BenchResult_t g_bench_result[LCD_BENCH_MAX_RESULTS]; /*!< 结果表 */
+static uint16_t g_bench_count = 0;                              /*!< 已记录结果数 */
+static uint16_t g_bench_page = 0;      /*!< 下一页第一条结果的序号 */
+static uint32_t g_bench_tick = 0;      /*!< 上次翻页时刻 */
+static volatile int32_t g_bench_sink;  /*!< 接收查找结果，防止被优化 */
+static uint16_t g_bench_block[LCD_Width * BENCH_BLOCK_LINES]; /*!< writebuff 数据 */
+static uint8_t g_bench_glyph[32 * 4]; /*!< 展开测试的字模，最大32x32 */
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  使能DWT周期计数器
+ */
+static void Bench_CycleInit(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief  计时前的准备：等待传输结束，冷测试时清空全部Cache
+ */
+static void Bench_Prepare(uint8_t cold) {
+  LCD_WaitIdle(); // 不计入之前未完成的传输
+  if (cold) {
+    SCB_InvalidateICache();
+    SCB_CleanInvalidateDCache();
+#ifdef GLYPH_CACHE_ENABLE
+    GlyphCache_Clear();
+#endif
+  }
+  __DSB();
+}
+
+/**
+ * @brief  结束计时，返回从start开始的周期数(包含等待传输结束)
+ */
+static uint32_t Bench_Elapsed(uint32_t start) {
+  LCD_WaitIdle();
+  __DSB();
+  return DWT->CYCCNT - start;
+}
+
+/**
+ * @brief  向结果表追加一项，表满时丢弃
+ */
+static void Bench_Record(const char *name, uint8_t font_size, uint8_t cold,
+                         uint16_t items, uint32_t cycles) {
+  LCD_BenchResult_t *r;
+
+  if (g_bench_count >= LCD_BENCH_MAX_RESULTS) {
+    return;
+  }
+  r = &g_bench_result[g_bench_count++];
+  r->name = name;
+  r->font_size = font_size;
+  r->cold = cold;
+  r->items = items;
+  r->cycles = cycles;
+  r->per_item = (items > 0) ? cycles / items : cycles;
+}
+
+/**
+ * @brief  统计字符串中的字符数(按 LCD_DisplayText 的编码)
+ */
+static uint16_t Bench_CountChars(const char *text) {
+  const uint8_t *p = (const uint8_t *)text;
+  uint16_t n = 0;
+
+  while (*p != 0) {
+#ifdef IS_GB2312
+    p += (*p >= 0x80 && p[1] != 0) ? 2 : 1;
+#else
+    uint32_t cp;
+
+    p += FlashFont_DecodeUTF8(p, &cp);
+#endif
+    n++;
+  }
+  return n;
+}
+
+/**
+ * @brief  字库查找：GB2312区位表与UTF8码点索引，每个字平均周期
+ */
+static void Bench_Lookup(uint8_t cold) {
+  const uint8_t *u8 = (const uint8_t *)g_bench_hz_utf8;
+  uint32_t gb_cycles = 0, u8_cycles = 0, start;
+  int32_t sum = 0;
+
+  for (uint16_t pass = 0; pass < LCD_BENCH_LOOKUP_PASSES; pass++) {
+    Bench_Prepare(cold);
+    start = DWT->CYCCNT;
+    for (uint16_t i = 0; i < BENCH_HZ_COUNT; i++) {
+      sum += GB2312_FindIndex_Flash(g_bench_hz_gbk + i * 2);
+    }
+    gb_cycles += Bench_Elapsed(start);
+
+    Bench_Prepare(cold);
+    start = DWT->CYCCNT;
+    for (uint16_t i = 0; i < BENCH_HZ_COUNT; i++) {
+      sum += UTF8_FindIndex_Flash(u8 + i * 3, 3);
+    }
+    u8_cycles += Bench_Elapsed(start);
+  }
+  g_bench_sink = sum;
+
+  Bench_Record("gb_index", 0, cold, BENCH_HZ_COUNT * LCD_BENCH_LOOKUP_PASSES,
+               gb_cycles);
+  Bench_Record("u8_index", 0, cold, BENCH_HZ_COUNT * LCD_BENCH_LOOKUP_PASSES,
+               u8_cycles);
+}
+
+/**
+ * @brief  逐字绘制与整行文字，测试单个字号
+ */
+static void Bench_Font(uint8_t font_size, uint8_t cold) {
+  uint16_t x = 0, y = 0;
+  uint32_t start;
+
+  LCD_SetTextFont(font_size);
+
+  Bench_Prepare(cold);
+  start = DWT->CYCCNT;
+  for (uint16_t i = 0; i < BENCH_HZ_COUNT; i++) {
+    if (x + font_size > LCD_Width) {
+      x = 0;
+      y += font_size;
+    }
+    LCD_DisplayChinese(x, y, (char *)BENCH_HZ_TEXT + i * BENCH_HZ_STRIDE);
+    x += font_size;
+  }
+  Bench_Record("glyph", font_size, cold, BENCH_HZ_COUNT, Bench_Elapsed(start));
+
+  Bench_Record("text", font_size, cold, Bench_CountChars(g_bench_text),
+               LCD_MeasureTextCycles(0, y + font_size, (char *)g_bench_text,
+                                     cold));
+}
+
+/**
+ * @brief  三种1bpp展开方式，测试单个字号
+ */
+static void Bench_Expand(uint8_t font_size) {
+  static const char *const names[3] = {"exp_bit", "exp_lut", "exp_sel"};
+  uint32_t seed = 0x12345678;
+
+  for (uint16_t i = 0; i < sizeof(g_bench_glyph); i++) {
+    seed = seed * 1103515245U + 12345U;
+    g_bench_glyph[i] = (uint8_t)(seed >> 16); // 笔画与背景大致各半
+  }
+  for (uint8_t m = LCD_EXPAND_BIT; m <= LCD_EXPAND_SEL; m++) {
+    Bench_Record(names[m], font_size, 0, LCD_BENCH_EXPAND_PASSES,
+                 LCD_MeasureExpandCycles(m, g_bench_glyph, font_size, font_size,
+                                         LCD_BENCH_EXPAND_PASSES));
+  }
+}
+
+/**
+ * @brief  批量写屏、填充矩形和清屏
+ */
+static void Bench_Fill(void) {
+  uint32_t start, cpu, block, windows, px;
+
+  for (uint32_t i = 0; i < LCD_Width * BENCH_BLOCK_LINES; i++) {
+    g_bench_block[i] = (uint16_t)(i * 0x0841); // 渐变色，避免全同色
+  }
+
+  Bench_Prepare(0);
+  start = DWT->CYCCNT;
+  LCD_SetAddress(0, 0, LCD_Width - 1, BENCH_BLOCK_LINES - 1);
+  LCD_WriteBuff(g_bench_block, LCD_Width * BENCH_BLOCK_LINES);
+  block = Bench_Elapsed(start);
+  Bench_Record("writebuff", 0, 0, 1, block);
+
+  // 同样的像素分成每行一个窗口发送，多出的时间即窗口开销
+  Bench_Prepare(0);
+  start = DWT->CYCCNT;
+  for (uint16_t y = 0; y < BENCH_WINDOWS; y++) {
+    LCD_SetAddress(y, y, y + BENCH_WINDOW_PIXELS - 1, y);
+    LCD_WriteBuff(&g_bench_block[y * BENCH_WINDOW_PIXELS], BENCH_WINDOW_PIXELS);
+  }
+  windows = Bench_Elapsed(start);
+  Bench_Record("window", 0, 0, BENCH_WINDOWS, windows);
+  px = block / (LCD_Width * BENCH_BLOCK_LINES); // 每像素周期数
+  windows = windows / BENCH_WINDOWS;
+  windows = (px > 0 && windows > px * BENCH_WINDOW_PIXELS)
+                ? (windows - px * BENCH_WINDOW_PIXELS) / px
+                : 0;
+  Bench_Record("win_px", 0, 0, 1, windows);
+  if (windows > 0) {
+    LCD_Flush_SetWindowCost((uint16_t)(windows < 0xFFFF ? windows : 0xFFFF));
+  }
+
+  Bench_Prepare(0);
+  start = DWT->CYCCNT;
+  LCD_FillRect(0, 0, 64, 64);
+  Bench_Record("fillrect", 0, 0, 1, Bench_Elapsed(start));
+
+  Bench_Prepare(0);
+  start = DWT->CYCCNT;
+  LCD_Clear();
+  cpu = DWT->CYCCNT - start; // DMA填充时 LCD_Clear() 启动后即返回
+  Bench_Record("clear", 0, 0, 1, Bench_Elapsed(start));
+  Bench_Record("clear_cpu", 0, 0, 1, cpu);
+}
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  运行全部基准测试
+ * @retval 记录的结果数
+ */
+uint16_t LCD_Bench_Run(void) {
+  g_bench_count = 0;
+  Bench_CycleInit();
+
+  LCD_SetColor(LCD_WHITE);
+  LCD_SetBackColor(LCD_BLACK);
+  LCD_Clear();
+
+  Bench_Lookup(1);
+  Bench_Lookup(0);
+
+  for (uint16_t i = 0; i < sizeof(g_bench_sizes); i++) {
+    if (FlashFont_BytesPerChar(g_bench_sizes[i]) <= 0) {
+      continue; // 字库中没有该字号
+    }
+    Bench_Font(g_bench_sizes[i], 1);
+    Bench_Font(g_bench_sizes[i], 0); // 紧接冷测试，字模已在各级Cache中
+    LCD_Clear();
+  }
+  for (uint16_t i = 0; i < sizeof(g_bench_sizes); i++) {
+    Bench_Expand(g_bench_sizes[i]); // 与字库无关，字号都测
+  }
+
+  Bench_Fill();
+
+  LCD_SetTextFont(24);
+  LCD_Clear();
+  g_bench_page = 0;
+  return g_bench_count;
+}
+
+/**
+ * @brief  读取测试结果表
+ * @param  count: 输出结果数，可为NULL
+ * @retval 结果表首地址
+ */
+const LCD_BenchResult_t *LCD_Bench_GetResults(uint16_t *count) {
+  if (count != NULL) {
+    *count = g_bench_count;
+  }
+  return g_bench_result;
+}
+
+/**
+ * @brief  通过 LCD_BENCH_PRINTF 输出全部结果
+ */
+void LCD_Bench_Print(void) {
+#ifdef LCD_BENCH_PRINTF
+  LCD_BENCH_PRINTF("name       size cache  items     cycles   per_item\r\n");
+  for (uint16_t i = 0; i < g_bench_count; i++) {
+    const LCD_BenchResult_t *r = &g_bench_result[i];
+
+    LCD_BENCH_PRINTF("%-10s %4u %5s %6u %10lu %10lu\r\n", r->name,
+                     (unsigned)r->font_size, r->cold ? "cold" : "warm",
+                     (unsigned)r->items, (unsigned long)r->cycles,
+                     (unsigned long)r->per_item);
+  }
+  LCD_BENCH_PRINTF("core clock %lu Hz\r\n", (unsigned long)SystemCoreClock);
+#endif
+}
+
+/**
+ * @brief  在屏幕上显示一页结果
+ * @param  first: 本页第一条结果的序号
+ * @retval 下一页第一条结果的序号，已显示到最后一条时返回0
+ */
+uint16_t LCD_Bench_Show(uint16_t first) {
+  char line[48];
+  uint16_t rows = LCD_Height / 14 - 1; // 12号字体，行距14像素，首行为标题
+  uint16_t i;
+
+  LCD_SetTextFont(12);
+  LCD_Clear();
+  sprintf(line, "BENCH %u/%u %s cyc/item @%luMHz", (unsigned)(first + 1),
+          (unsigned)g_bench_count, LCD_Panel_Controller()->Name,
+          (unsigned long)(SystemCoreClock / 1000000));
+  LCD_DisplayString(0, 0, line);
+
+  for (i = first; i < g_bench_count && i < first + rows; i++) {
+    const LCD_BenchResult_t *r = &g_bench_result[i];
+
+    sprintf(line, "%-9s %2u %c %9lu", r->name, (unsigned)r->font_size,
+            r->cold ? 'C' : 'W', (unsigned long)r->per_item);
+    LCD_DisplayString(0, (uint16_t)((i - first + 1) * 14), line);
+  }
+  return (i < g_bench_count) ? i : 0;
+}
+
+/**
+ * @brief  分页显示周期任务，在主循环中调用
+ */
+void LCD_Bench_Task(void) {
+  if (g_bench_count == 0) {
+    return;
+  }
+  if (g_bench_tick != 0 && GetTick() - g_bench_tick < LCD_BENCH_PAGE_MS) {
+    return;
+  }
+  g_bench_tick = GetTick();
+  if (g_bench_tick == 0) {
+    g_bench_tick = 1; // 0 表示尚未显示过
+  }
+  g_bench_page = LCD_Bench_Show(g_bench_page);
+}
+
+#endif /* LCD_BENCH_ENABLE && LCD_SPI_ENABLE && FLASH_FONT_ENABLE */
@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ * @file    lcd_bench.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   屏幕渲染基准测试头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 用DWT周期计数器(DWT->CYCCNT)测量字库查找、单字绘制、批量写屏、清屏、
+ *   填充矩形、整行文字和三种1bpp字模展开方式的耗时，每项都在固定语料上运行，便于前后对比
+ * - 覆盖全部字号(12/16/20/24/32)、GB2312与UTF8两种查找方式、冷/热Cache
+ * - 冷：测量前清空指令/数据Cache和字模缓存；热：同一语料紧接着再测一次
+ * - 结果保存在内部表中，LCD_Bench_Show() 分页显示到屏幕，
+ *   定义 LCD_BENCH_PRINTF 后 LCD_Bench_Print() 输出到调试串口
+ * - 测试会覆盖屏幕内容，只应在调试固件中启用(init.h 中的 LCD_BENCH_ENABLE)
+ *
+ * 使用示例：
+ *     LCD_Bench_Run();     // 阻塞运行全部测试，约数百毫秒
+ *     LCD_Bench_Print();   // 串口输出(需定义 LCD_BENCH_PRINTF)
+ *     while (1) {
+ *         LCD_Bench_Task(); // 屏幕上轮流显示各页结果
+ *     }
+ *
+ ******************************************************************************
+ */
+
+#ifndef LCD_BENCH_H
+#define LCD_BENCH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define LCD_BENCH_MAX_RESULTS 48 /*!< 结果表容量，超出的测试项不再记录 */
+#define LCD_BENCH_LOOKUP_PASSES 8 /*!< 字库查找测试重复遍历语料的次数 */
+#define LCD_BENCH_EXPAND_PASSES 64 /*!< 展开测试每种方式重复展开的次数 */
+#define LCD_BENCH_PAGE_MS 3000 /*!< LCD_Bench_Task() 翻页间隔(ms) */
+// #define LCD_BENCH_PRINTF printf /*!< 定义了：LCD_Bench_Print() 用该函数输出(需自行重定向到串口), 注释后：只在屏幕显示 */
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  单项测试结果
+     */
+    typedef struct
+    {
+        const char *name;   /*!< 测试项名称(ASCII) */
+        uint8_t font_size;  /*!< 字号，与字号无关的测试为0 */
+        uint8_t cold;       /*!< 1-冷Cache, 0-热Cache */
+        uint16_t items;     /*!< 本项处理的字符/像素块数 */
+        uint32_t cycles;    /*!< 总CPU周期数 */
+        uint32_t per_item;  /*!< 平均每项周期数 */
+    } LCD_BenchResult_t;
+
+    /*******************************************************************************
+     *                          导出函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  运行全部基准测试
+     * @note   需在 SPI_LCD_Init() 和 FlashFont_Init() 之后调用
+     * @note   会改写屏幕内容、字体和颜色，结束后恢复为24号字体并清屏
+     * @retval 记录的结果数
+     */
+    uint16_t LCD_Bench_Run(void);
+
+    /**
+     * @brief  读取测试结果表
+     * @param  count: 输出结果数，可为NULL
+     * @retval 结果表首地址
+     */
+    const LCD_BenchResult_t *LCD_Bench_GetResults(uint16_t *count);
+
+    /**
+     * @brief  通过 LCD_BENCH_PRINTF 输出全部结果
+     * @note   未定义 LCD_BENCH_PRINTF 时为空函数
+     */
+    void LCD_Bench_Print(void);
+
+    /**
+     * @brief  在屏幕上显示一页结果
+     * @param  first: 本页第一条结果的序号
+     * @retval 下一页第一条结果的序号，已显示到最后一条时返回0
+     */
+    uint16_t LCD_Bench_Show(uint16_t first);
+
+    /**
+     * @brief  分页显示周期任务，在主循环中调用
+     * @note   每 LCD_BENCH_PAGE_MS 毫秒显示下一页，最后一页后从头开始
+     */
+    void LCD_Bench_Task(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LCD_BENCH_H
@@ -0,0 +1,446 @@
+/**
+ ******************************************************************************
+ * @file    qspi_bench.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   QSPI Flash映射读取基准测试实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 测试项：
+ * - seq：从 QSPI_BENCH_ADDR 按字顺序读取 QSPI_BENCH_SEQ_BYTES 字节，
+ *   可Cache时先使该范围的Cache行失效，结果换算为KB/s
+ * - rnd：在 QSPI_BENCH_SPAN 范围内按固定伪随机序列读取 QSPI_BENCH_RANDOM_LINES 个
+ *   32字节对齐的Cache行，每行读取前使其失效，结果为每行平均CPU周期
+ *
+ * 读取命令(wait 与 qspi_flash.c 的 MapConfig 一致，为地址之后到数据之前的时钟数，含模式位)：
+ * - 1-1-4：0x6C，8个空周期
+ * - 1-4-4：0xEC，模式位2 + 空周期4
+ * - 1-4-4 cont：0xEC连续读(M7-M0=0xA0)，QUADSPI只在首次访问时发送指令(SIOO)
+ * - DTR：0xED双沿采样，需4字节地址模式，采样移位固定为无
+ * - QPI w4/w6/w8：4-4-4模式，读参数P5-P4依次为01/10/11，扫描空周期个数
+ * SPI模式下器件的空周期由命令决定，不可配置，空周期扫描只在QPI模式下进行
+ * 16MB及以下的器件(QSPI_W25Qxx_GetPart()->addr_bytes为3)改用0x6B/0xEB和3字节地址，DTR不切换地址模式
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(QSPI_BENCH_ENABLE) && defined(QSPI_FLASH_ENABLE)
+
+#ifdef QSPI_XIP_ENABLE
+#error "QSPI_BENCH_ENABLE 会反复切换QSPI配置，不能与 QSPI_XIP_ENABLE 同时定义"
+#endif
+
+/*******************************************************************************
+ *                              读取命令表
+ ******************************************************************************/
+
+#define BENCH_QSPI_CONT 0x01 /*!< 连续读模式 + SIOO */
+#define BENCH_QSPI_QPI 0x02  /*!< 进入QPI模式，指令走4线 */
+#define BENCH_QSPI_DTR 0x04  /*!< 双沿采样 */
+
+#define BENCH_QSPI_LINE 32 /*!< Cache行字节数 */
+
+/**
+ * @brief  映射读取命令
+ */
+typedef struct {
+  const char *name;    /*!< 名称 */
+  uint8_t instruction; /*!< 读取指令 */
+  uint8_t addr_lines;  /*!< 地址线数(1/4) */
+  uint8_t data_lines;  /*!< 数据线数(4) */
+  uint8_t wait;        /*!< 地址之后到数据之前的时钟数(含模式位) */
+  uint8_t flags;       /*!< BENCH_QSPI_* */
+  uint8_t read_param;  /*!< QPI读参数，非QPI命令为0 */
+} Bench_QspiMode_t;
+
+static const Bench_QspiMode_t g_bench_modes[] = {
+    {"1-1-4", 0x6C, 1, 4, 8, 0, 0},
+    {"1-4-4", W25Qxx_CMD_FastReadQuad_IO, 4, 4, 6, 0, 0},
+    {"1-4-4 cont", W25Qxx_CMD_FastReadQuad_IO, 4, 4, 6, BENCH_QSPI_CONT, 0},
+    {"DTR", W25Qxx_CMD_FastReadQuad_IO_DTR, 4, 4, 8, BENCH_QSPI_DTR, 0},
+    {"QPI w4", W25Qxx_CMD_FastReadQuad_IO, 4, 4, 4, BENCH_QSPI_QPI, 0x10},
+    {"QPI w6", W25Qxx_CMD_FastReadQuad_IO, 4, 4, 6, BENCH_QSPI_QPI, 0x20},
+    {"QPI w8", W25Qxx_CMD_FastReadQuad_IO, 4, 4, 8, BENCH_QSPI_QPI,
+     W25Qxx_QPI_READ_PARAM},
+};
+
+static const uint8_t g_bench_prescalers[] = QSPI_BENCH_PRESCALERS;
+
+/*******************************************************************************
+ *                              私有变量
+ ******************************************************************************/
+
+static QSPI_BenchResult_t g_bench_qspi[QSPI_BENCH_MAX_RESULTS]; /*!< 结果表 */
+static uint16_t g_bench_qspi_count = 0; /*!< 已记录结果数 */
+static QSPI_InitTypeDef g_bench_init;   /*!< 测试前的QUADSPI配置 */
+static uint32_t g_bench_seq_ref = 0;    /*!< 默认配置下顺序读取的校验值 */
+static uint32_t g_bench_rnd_ref = 0;    /*!< 默认配置下随机读取的校验值 */
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  使能DWT周期计数器
+ */
+static void Bench_CycleInit(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief  与读取顺序有关的校验值，空周期错位时必然不同
+ */
+static uint32_t Bench_Hash(uint32_t h, uint32_t w) {
+  return ((h << 5) | (h >> 27)) ^ w;
+}
+
+/**
+ * @brief  第i个随机Cache行的偏移(相对测试区起始)
+ */
+static uint32_t Bench_RandomLine(uint32_t *seed) {
+  *seed = *seed * 1664525U + 1013904223U; // 与运行次数无关的固定序列
+  return (*seed >> 8) % (QSPI_BENCH_SPAN / BENCH_QSPI_LINE) * BENCH_QSPI_LINE;
+}
+
+/**
+ * @brief  发送不带地址的命令(数据线数与指令线数一致)
+ */
+static int8_t Bench_Command(uint8_t instruction, uint32_t inst_mode,
+                            uint8_t *data, uint32_t size) {
+  QSPI_CommandTypeDef s_command = {0};
+
+  s_command.InstructionMode = inst_mode;
+  s_command.Instruction = instruction;
+  s_command.AddressMode = QSPI_ADDRESS_NONE;
+  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+  s_command.DdrMode = QSPI_DDR_MODE_DISABLE;
+  s_command.DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
+  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD;
+  s_command.DataMode = (data == NULL) ? QSPI_DATA_NONE
+                       : (inst_mode == QSPI_INSTRUCTION_4_LINES)
+                           ? QSPI_DATA_4_LINES
+                           : QSPI_DATA_1_LINE;
+  s_command.NbData = size;
+
+  if (HAL_QSPI_Command(&hqspi, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+      HAL_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  if (data != NULL &&
+      HAL_QSPI_Transmit(&hqspi, data, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+          HAL_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  按指定时钟、采样移位和读取命令进入映射模式
+ * @note   先用测试前的配置复位器件(退出QPI/连续读)，再改QUADSPI时钟
+ */
+static int8_t Bench_Map(const Bench_QspiMode_t *m, uint8_t prescaler,
+                        uint8_t shift) {
+  QSPI_CommandTypeDef s_command = {0};
+  QSPI_MemoryMappedTypeDef s_mem_mapped_cfg = {0};
+  const QSPI_W25Qxx_Part_t *part = QSPI_W25Qxx_GetPart();
+  uint8_t param[W25Qxx_CHIPS]; // 双片时每片各收一个字节
+  uint8_t instruction = m->instruction;
+  uint32_t lines;
+
+  memset(param, m->read_param, sizeof(param));
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    HAL_QSPI_Abort(&hqspi);
+  }
+  hqspi.Init = g_bench_init;
+  if (HAL_QSPI_Init(&hqspi) != HAL_OK || QSPI_W25Qxx_Reset() != QSPI_W25Qxx_OK) {
+    return W25Qxx_ERROR_MemoryMapped;
+  }
+  hqspi.Init.ClockPrescaler = prescaler;
+  hqspi.Init.SampleShifting =
+      shift ? QSPI_SAMPLE_SHIFTING_HALFCYCLE : QSPI_SAMPLE_SHIFTING_NONE;
+  if (HAL_QSPI_Init(&hqspi) != HAL_OK) {
+    return W25Qxx_ERROR_MemoryMapped;
+  }
+
+  if (part->addr_bytes == 3) { // 16MB及以下的器件使用3字节地址版本的指令
+    if (instruction == 0x6C) {
+      instruction = 0x6B;
+    } else if (instruction == W25Qxx_CMD_FastReadQuad_IO) {
+      instruction = W25Qxx_CMD_FastReadQuad_IO_3B;
+    }
+  } else if ((m->flags & BENCH_QSPI_DTR) &&
+             Bench_Command(W25Qxx_CMD_Enter4ByteMode, QSPI_INSTRUCTION_1_LINE,
+                           NULL, 0) != QSPI_W25Qxx_OK) {
+    return W25Qxx_ERROR_MemoryMapped;
+  }
+  if ((m->flags & BENCH_QSPI_QPI) &&
+      (Bench_Command(W25Qxx_CMD_EnterQPI, QSPI_INSTRUCTION_1_LINE, NULL, 0) !=
+           QSPI_W25Qxx_OK ||
+       Bench_Command(W25Qxx_CMD_SetReadParam, QSPI_INSTRUCTION_4_LINES, param,
+                     sizeof(param)) != QSPI_W25Qxx_OK)) {
+    return W25Qxx_ERROR_MemoryMapped;
+  }
+
+  lines = (m->addr_lines == 4) ? QSPI_ADDRESS_4_LINES : QSPI_ADDRESS_1_LINE;
+  s_command.InstructionMode = (m->flags & BENCH_QSPI_QPI)
+                                  ? QSPI_INSTRUCTION_4_LINES
+                                  : QSPI_INSTRUCTION_1_LINE;
+  s_command.Instruction = instruction;
+  s_command.AddressMode = lines;
+  s_command.AddressSize = (part->addr_bytes == 4) ? QSPI_ADDRESS_32_BITS
+                                                  : QSPI_ADDRESS_24_BITS;
+  s_command.DataMode =
+      (m->data_lines == 4) ? QSPI_DATA_4_LINES : QSPI_DATA_1_LINE;
+  s_command.DdrMode = (m->flags & BENCH_QSPI_DTR) ? QSPI_DDR_MODE_ENABLE
+                                                   : QSPI_DDR_MODE_DISABLE;
+  s_command.DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
+  if (m->flags & BENCH_QSPI_CONT) {
+    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_4_LINES;
+    s_command.AlternateBytesSize = QSPI_ALTERNATE_BYTES_8_BITS;
+    s_command.AlternateBytes = W25Qxx_CONTINUOUS_READ_MODE;
+    s_command.SIOOMode = QSPI_SIOO_INST_ONLY_FIRST_CMD;
+    s_command.DummyCycles = m->wait - 2; // 模式位占2个时钟
+  } else {
+    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD;
+    s_command.DummyCycles = m->wait;
+  }
+  s_mem_mapped_cfg.TimeOutActivation = QSPI_TIMEOUT_COUNTER_DISABLE;
+
+  if (HAL_QSPI_MemoryMapped(&hqspi, &s_command, &s_mem_mapped_cfg) != HAL_OK) {
+    return W25Qxx_ERROR_MemoryMapped;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  设置映射区是否可Cache
+ * @note   未定义 QSPI_MMAP_MPU_ENABLE 时映射区使用默认属性，只测可Cache
+ */
+static void Bench_SetCached(uint8_t cached) {
+#ifdef QSPI_MMAP_MPU_ENABLE
+  MPU_Region_InitTypeDef MPU_InitStruct = {0};
+
+  QSPI_W25Qxx_MPU_Config();
+  if (!cached) {
+    HAL_MPU_Disable();
+    MPU_InitStruct.Enable = MPU_REGION_ENABLE;
+    MPU_InitStruct.Number = QSPI_MMAP_MPU_REGION + 1;
+    MPU_InitStruct.BaseAddress = W25Qxx_Mem_Addr;
+    MPU_InitStruct.Size = MPU_REGION_SIZE_32MB;
+    MPU_InitStruct.SubRegionDisable = 0x00;
+    MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL0;
+    MPU_InitStruct.AccessPermission = MPU_REGION_PRIV_RO_URO;
+    MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_ENABLE;
+    MPU_InitStruct.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+    MPU_InitStruct.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+    MPU_InitStruct.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+    HAL_MPU_ConfigRegion(&MPU_InitStruct);
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+  }
+#else
+  (void)cached;
+#endif
+  SCB_InvalidateDCache_by_Addr((uint32_t *)(W25Qxx_Mem_Addr + QSPI_BENCH_ADDR),
+                               QSPI_BENCH_SPAN);
+}
+
+/**
+ * @brief  检查顺序读取范围是否全为0xFF(擦除后未写入)
+ * @retval 1-全为0xFF, 0-有数据
+ */
+static uint8_t Bench_Erased(void) {
+  const volatile uint32_t *p =
+      (const volatile uint32_t *)(W25Qxx_Mem_Addr + QSPI_BENCH_ADDR);
+
+  for (uint32_t i = 0; i < QSPI_BENCH_SEQ_BYTES / 4; i++) {
+    if (p[i] != 0xFFFFFFFFU) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief  顺序读取
+ * @param  hash: 输出校验值
+ * @retval CPU周期数
+ */
+static uint32_t Bench_Sequential(uint32_t *hash) {
+  const volatile uint32_t *p =
+      (const volatile uint32_t *)(W25Qxx_Mem_Addr + QSPI_BENCH_ADDR);
+  uint32_t h = 0, start, cycles;
+
+  SCB_InvalidateDCache_by_Addr((uint32_t *)p, QSPI_BENCH_SEQ_BYTES);
+  __DSB();
+  start = DWT->CYCCNT;
+  for (uint32_t i = 0; i < QSPI_BENCH_SEQ_BYTES / 4; i++) {
+    h = Bench_Hash(h, p[i]);
+  }
+  __DSB();
+  cycles = DWT->CYCCNT - start;
+  *hash = h;
+  return cycles;
+}
+
+/**
+ * @brief  随机读取Cache行
+ * @param  hash: 输出校验值
+ * @retval 所有行的CPU周期数之和(不含使Cache行失效的时间)
+ */
+static uint32_t Bench_Random(uint32_t *hash) {
+  uint32_t seed = 1, h = 0, total = 0, start;
+
+  for (uint16_t n = 0; n < QSPI_BENCH_RANDOM_LINES; n++) {
+    const volatile uint32_t *p = (const volatile uint32_t *)(
+        W25Qxx_Mem_Addr + QSPI_BENCH_ADDR + Bench_RandomLine(&seed));
+
+    SCB_InvalidateDCache_by_Addr((uint32_t *)p, BENCH_QSPI_LINE);
+    __DSB();
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < BENCH_QSPI_LINE / 4; i++) {
+      h = Bench_Hash(h, p[i]);
+    }
+    __DSB();
+    total += DWT->CYCCNT - start;
+  }
+  *hash = h;
+  return total;
+}
+
+/**
+ * @brief  测试一个组合并记录结果，表满时丢弃
+ */
+static void Bench_Case(const Bench_QspiMode_t *m, uint8_t prescaler,
+                       uint8_t shift, uint8_t cached) {
+  QSPI_BenchResult_t *r;
+  uint32_t seq_hash = 0, rnd_hash = 0, seq = 0, rnd = 0;
+  uint8_t ok = 0;
+
+  if (g_bench_qspi_count >= QSPI_BENCH_MAX_RESULTS) {
+    return;
+  }
+  if (Bench_Map(m, prescaler, shift) == QSPI_W25Qxx_OK) {
+    Bench_SetCached(cached);
+    seq = Bench_Sequential(&seq_hash);
+    rnd = Bench_Random(&rnd_hash);
+    ok = (seq_hash == g_bench_seq_ref && rnd_hash == g_bench_rnd_ref);
+  }
+
+  r = &g_bench_qspi[g_bench_qspi_count++];
+  r->mode = m->name;
+  r->prescaler = prescaler;
+  r->shift = shift;
+  r->cached = cached;
+  r->ok = ok;
+  r->seq_kbps = (seq > 0) ? (uint32_t)((uint64_t)QSPI_BENCH_SEQ_BYTES *
+                                       SystemCoreClock / 1024 / seq)
+                          : 0;
+  r->rnd_cycles = rnd / QSPI_BENCH_RANDOM_LINES;
+}
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  运行全部组合
+ * @retval QSPI_BENCH_OK / QSPI_BENCH_BUSY / QSPI_BENCH_ERROR
+ */
+int8_t QSPI_Bench_Run(void) {
+  int8_t status = QSPI_BENCH_OK;
+
+  if (QSPI_W25Qxx_DMA_Busy() || QSPI_W25Qxx_Write_Busy()) {
+    return QSPI_BENCH_BUSY;
+  }
+  g_bench_qspi_count = 0;
+  Bench_CycleInit();
+
+  // 默认配置下的读取结果作为参考
+  if (QSPI_W25Qxx_MemoryMappedMode() != QSPI_W25Qxx_OK) {
+    return QSPI_BENCH_ERROR;
+  }
+  g_bench_init = hqspi.Init;
+  Bench_Sequential(&g_bench_seq_ref);
+  Bench_Random(&g_bench_rnd_ref);
+  if (Bench_Erased()) {
+    DEBUG_ERROR("QSPI Bench: 测试区未写入数据，无法校验");
+    status = QSPI_BENCH_ERROR;
+  }
+
+  for (uint16_t i = 0;
+       status == QSPI_BENCH_OK && i < sizeof(g_bench_modes) / sizeof(g_bench_modes[0]);
+       i++) {
+    const Bench_QspiMode_t *m = &g_bench_modes[i];
+
+    for (uint16_t p = 0; p < sizeof(g_bench_prescalers); p++) {
+      for (uint8_t shift = 0; shift < 2; shift++) {
+        if (shift && (m->flags & BENCH_QSPI_DTR)) {
+          continue; // DDR模式下必须关闭采样移位
+        }
+        Bench_Case(m, g_bench_prescalers[p], shift, 1);
+#ifdef QSPI_MMAP_MPU_ENABLE
+        Bench_Case(m, g_bench_prescalers[p], shift, 0);
+#endif
+      }
+    }
+  }
+
+  // 恢复 MX_QUADSPI_Init() 的配置和驱动的映射方式
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    HAL_QSPI_Abort(&hqspi);
+  }
+  hqspi.Init = g_bench_init;
+  if (HAL_QSPI_Init(&hqspi) != HAL_OK ||
+      QSPI_W25Qxx_MemoryMappedMode() != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Bench: 恢复映射模式失败");
+    return QSPI_BENCH_ERROR;
+  }
+  return status;
+}
+
+/**
+ * @brief  读取测试结果表
+ * @param  count: 输出结果数，可为NULL
+ * @retval 结果表首地址
+ */
+const QSPI_BenchResult_t *QSPI_Bench_GetResults(uint16_t *count) {
+  if (count != NULL) {
+    *count = g_bench_qspi_count;
+  }
+  return g_bench_qspi;
+}
+
+/**
+ * @brief  通过 QSPI_BENCH_PRINTF 输出全部结果
+ */
+void QSPI_Bench_Print(void) {
+  uint32_t hclk = HAL_RCC_GetHCLKFreq();
+
+  QSPI_BENCH_PRINTF(
+      "mode        presc  MHz shift cache  seq_KB/s  rnd_cyc  rnd_ns  ok\r\n");
+  for (uint16_t i = 0; i < g_bench_qspi_count; i++) {
+    const QSPI_BenchResult_t *r = &g_bench_qspi[i];
+
+    QSPI_BENCH_PRINTF("%-11s %5u %4lu %5s %5s %9lu %8lu %7lu  %s\r\n", r->mode,
+                      (unsigned)r->prescaler,
+                      (unsigned long)(hclk / (r->prescaler + 1U) / 1000000U),
+                      r->shift ? "half" : "none", r->cached ? "on" : "off",
+                      (unsigned long)r->seq_kbps, (unsigned long)r->rnd_cycles,
+                      (unsigned long)((uint64_t)r->rnd_cycles * 1000U /
+                                      (SystemCoreClock / 1000000U)),
+                      r->ok ? "OK" : "FAIL");
+  }
+  QSPI_BENCH_PRINTF("core clock %lu Hz, seq %u bytes, rnd %u lines\r\n",
+                    (unsigned long)SystemCoreClock,
+                    (unsigned)QSPI_BENCH_SEQ_BYTES,
+                    (unsigned)QSPI_BENCH_RANDOM_LINES);
+}
+
+#endif /* QSPI_BENCH_ENABLE && QSPI_FLASH_ENABLE */
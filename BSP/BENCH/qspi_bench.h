@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ * @file    qspi_bench.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   QSPI Flash映射读取基准测试头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 在内存映射模式下测量顺序读取吞吐量(KB/s)和随机32字节(一个Cache行)读取延迟，
+ *   用于在XIP、字模读取混合访问时挑选QSPI配置
+ * - 扫描的参数：ClockPrescaler(QSPI_BENCH_PRESCALERS)、采样移位(无/半周期)、
+ *   读取命令(1-1-4/1-4-4/连续读+SIOO/DTR/QPI不同空周期)、MPU区域可Cache/不可Cache
+ * - 每种组合都与默认配置下读到的数据比较校验值，配置超出器件时序(时钟过高、
+ *   空周期不足、器件不支持QPI/DTR)时该项标为FAIL，吞吐量不可信
+ * - 测试阻塞运行，期间QSPI反复退出/重新进入映射模式，结束后恢复 MX_QUADSPI_Init()
+ *   的配置并调用 QSPI_W25Qxx_MemoryMappedMode()
+ * - 定义 QSPI_XIP_ENABLE 时不能使用(代码在QSPI中执行，不能切换配置)
+ * - 只应在调试固件中启用(init.h 中的 QSPI_BENCH_ENABLE)
+ *
+ * 使用示例：
+ *     QSPI_Bench_Run();    // 阻塞运行全部组合，约数百毫秒
+ *     QSPI_Bench_Print();  // 通过 QSPI_BENCH_PRINTF 输出表格
+ *
+ ******************************************************************************
+ */
+
+#ifndef QSPI_BENCH_H
+#define QSPI_BENCH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define QSPI_BENCH_MAX_RESULTS 96 /*!< 结果表容量，超出的组合不再记录 */
+#define QSPI_BENCH_ADDR 0x01D00000 /*!< 测试区起始(相对Flash起始)，默认字库A区，内容不能全为0xFF才能检出错误配置 */
+#define QSPI_BENCH_SEQ_BYTES 0x10000 /*!< 顺序读取字节数，大于D-Cache容量 */
+#define QSPI_BENCH_SPAN 0x100000 /*!< 随机读取的地址范围(从测试区起始算起) */
+#define QSPI_BENCH_RANDOM_LINES 256 /*!< 随机读取的Cache行数 */
+#define QSPI_BENCH_PRESCALERS {1, 2, 3} /*!< 扫描的ClockPrescaler，QSPI时钟 = HCLK / (值 + 1)，不含超出器件上限的0 */
+#define QSPI_BENCH_PRINTF printf /*!< 结果输出函数(需自行重定向到调试串口) */
+
+#define QSPI_BENCH_OK 0      /*!< QSPI_Bench_Run()：完成 */
+#define QSPI_BENCH_BUSY -1   /*!< QSPI_Bench_Run()：DMA读取或异步写入进行中 */
+#define QSPI_BENCH_ERROR -2  /*!< QSPI_Bench_Run()：默认配置下映射失败或测试区全为0xFF */
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  单个组合的测试结果
+     */
+    typedef struct
+    {
+        const char *mode;     /*!< 读取命令名称 */
+        uint8_t prescaler;    /*!< ClockPrescaler */
+        uint8_t shift;        /*!< 1-半周期采样移位, 0-不移位 */
+        uint8_t cached;       /*!< 1-映射区可Cache, 0-不可Cache */
+        uint8_t ok;           /*!< 1-数据与默认配置一致, 0-读取错误(结果不可信) */
+        uint32_t seq_kbps;    /*!< 顺序读取吞吐量(KB/s) */
+        uint32_t rnd_cycles;  /*!< 随机读取一个Cache行的平均CPU周期数 */
+    } QSPI_BenchResult_t;
+
+    /*******************************************************************************
+     *                          导出函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  运行全部组合
+     * @note   需在 QSPI_W25Qxx_Init() 和 QSPI_W25Qxx_MemoryMappedMode() 之后调用，
+     *         结束时映射模式已按默认配置恢复
+     * @retval QSPI_BENCH_OK / QSPI_BENCH_BUSY / QSPI_BENCH_ERROR
+     */
+    int8_t QSPI_Bench_Run(void);
+
+    /**
+     * @brief  读取测试结果表
+     * @param  count: 输出结果数，可为NULL
+     * @retval 结果表首地址
+     */
+    const QSPI_BenchResult_t *QSPI_Bench_GetResults(uint16_t *count);
+
+    /**
+     * @brief  通过 QSPI_BENCH_PRINTF 输出全部结果
+     */
+    void QSPI_Bench_Print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // QSPI_BENCH_H
@@ -0,0 +1,456 @@
+/**
+ ******************************************************************************
+ * @file    stress_bench.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   混合负载压力测试实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 画面布局(自上而下)：
+ * - 跑马灯：STRESS_FONT 号字，每帧左移 STRESS_BENCH_TICKER_DX 列，新进入的字符
+ *   经字模缓存或QSPI读取
+ * - 趋势图：每帧移入一个采样点，整区重画(LCD_PlotSeries 按列擦除旧曲线)
+ * - 整页文字：按键事件到达后的下一帧开始时清空并重画下一页
+ * - 报警条(LCD_ALARM_ENABLE)：盖在跑马灯上，下一帧跑马灯整行重画时被覆盖
+ *
+ * 时间戳按帧累加为64位，运行时间超过DWT计数器的回绕周期(480MHz下约8.9秒)也不出错
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(STRESS_BENCH_ENABLE) && defined(LCD_SPI_ENABLE) &&                 \
+    defined(FLASH_FONT_ENABLE)
+
+#ifdef IS_GB2312
+#error "STRESS_BENCH_ENABLE 的跑马灯和语料为UTF-8，不能与 IS_GB2312 同时定义"
+#endif
+
+/*******************************************************************************
+ *                              场景与语料
+ ******************************************************************************/
+
+#define STRESS_FONT 16 /*!< 跑马灯和整页文字的字号 */
+#define STRESS_TICKER_Y 0
+#define STRESS_CHART_Y (STRESS_FONT + 4)
+#define STRESS_CHART_H 96
+#define STRESS_CHART_DX 2 /*!< 趋势图相邻采样的水平间距 */
+#define STRESS_CHART_N (LCD_Width / STRESS_CHART_DX + 1) /*!< 趋势图采样数 */
+#define STRESS_PAGE_Y (STRESS_CHART_Y + STRESS_CHART_H + 4)
+#define STRESS_PAGE_H (LCD_Height - STRESS_PAGE_Y)
+
+static const char g_stress_ticker[] =
+    "系统运行正常 温度25.6C 湿度48% 电压3.30V 电流0.52A 网络已连接 "
+    "固件版本V1.2.0 字库渲染压力测试进行中 ";
+
+static const char *const g_stress_pages[] = {
+    "第一章 概述\n本设备采用高性能微控制器，内置双精度浮点单元和一级缓存，"
+    "外部串行闪存用于存放字库、图片和部分程序代码。屏幕通过串行外设接口连接，"
+    "刷新时由直接存储器访问在后台发送像素数据，处理器同时准备下一块内容。"
+    "按键采用中断方式检测，事件进入队列后由主循环统一分发。",
+    "第二章 操作说明\n1. 长按电源键三秒开机，屏幕显示启动画面后进入主界面。\n"
+    "2. 主界面上方滚动显示运行状态，中部为实时趋势曲线，下方为说明文字。\n"
+    "3. 按确定键翻到下一页，按返回键回到上一级菜单。\n"
+    "4. 设置菜单中可以调整亮度、音量、时间和日期，修改后自动保存。",
+    "第三章 注意事项\n请在温度零下十度至五十度、相对湿度百分之九十以下的环境中使用，"
+    "避免阳光直射和强烈震动。清洁屏幕时请使用干燥的软布，不要使用酒精等溶剂。"
+    "如果设备长时间没有响应，请长按电源键十秒强制关机后重新启动。"
+    "维修请联系售后服务中心，不要自行拆开外壳。",
+};
+
+#define STRESS_PAGES (sizeof(g_stress_pages) / sizeof(g_stress_pages[0]))
+
+#ifdef LCD_ALARM_ENABLE
+static const char g_stress_alarm_chars[] = "报警温度过高压力超限0123456789.C ";
+static const char g_stress_alarm_text[] = "报警 温度过高 85.6C 压力超限";
+#endif
+
+/*******************************************************************************
+ *                              私有变量
+ ******************************************************************************/
+
+static Stress_BenchResult_t g_stress_result;            /*!< 最近一次结果 */
+static uint32_t g_stress_frame[STRESS_BENCH_FRAMES];    /*!< 各帧耗时(周期) */
+static uint32_t g_stress_key[STRESS_BENCH_KEYS];        /*!< 各按键事件延迟(周期) */
+static int16_t g_stress_series[STRESS_CHART_N];         /*!< 趋势图采样(屏幕纵坐标) */
+static uint16_t g_stress_strip[LCD_MARQUEE_BUFF_PIXELS(LCD_Width, STRESS_FONT)]; /*!< 跑马灯缓冲区 */
+static LCD_Marquee_t g_stress_ticker_mq;                /*!< 跑马灯 */
+static uint32_t g_stress_seed;                          /*!< 趋势图伪随机数 */
+static uint16_t g_stress_page;                          /*!< 当前页 */
+static uint64_t g_stress_clock;                         /*!< 64位时间戳(周期) */
+static uint32_t g_stress_last;                          /*!< 上次读到的计数器值 */
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  当前时刻(周期)，两次调用间隔须小于计数器回绕周期
+ */
+static uint64_t Stress_Now(void) {
+  uint32_t t = STRESS_BENCH_TIMESTAMP();
+
+  g_stress_clock += t - g_stress_last;
+  g_stress_last = t;
+  return g_stress_clock;
+}
+
+/**
+ * @brief  周期数换算为微秒
+ */
+static uint32_t Stress_Us(uint64_t cycles) {
+  uint32_t mhz = SystemCoreClock / 1000000;
+
+  return (uint32_t)(cycles / (mhz > 0 ? mhz : 1));
+}
+
+/**
+ * @brief  升序排序后取99百分位(向上取整的秩)
+ */
+static uint32_t Stress_P99(uint32_t *v, uint32_t n) {
+  if (n == 0) {
+    return 0;
+  }
+  for (uint32_t i = 1; i < n; i++) {
+    uint32_t x = v[i], k = i;
+
+    for (; k > 0 && v[k - 1] > x; k--) {
+      v[k] = v[k - 1];
+    }
+    v[k] = x;
+  }
+  return v[(n * 99 + 99) / 100 - 1];
+}
+
+/**
+ * @brief  趋势图移入一个采样点：随机游走，偶尔出现尖峰
+ */
+static void Stress_ChartPush(void) {
+  int32_t v = g_stress_series[STRESS_CHART_N - 1];
+
+  memmove(g_stress_series, g_stress_series + 1,
+          (STRESS_CHART_N - 1) * sizeof(g_stress_series[0]));
+  g_stress_seed = g_stress_seed * 1103515245U + 12345U;
+  v += (int32_t)((g_stress_seed >> 16) % 9) - 4;
+  if (((g_stress_seed >> 8) & 0x3F) == 0) {
+    v = STRESS_CHART_Y + 2 + (int32_t)((g_stress_seed >> 20) % (STRESS_CHART_H - 4));
+  }
+  if (v < STRESS_CHART_Y + 2) {
+    v = STRESS_CHART_Y + 2;
+  }
+  if (v > STRESS_CHART_Y + STRESS_CHART_H - 3) {
+    v = STRESS_CHART_Y + STRESS_CHART_H - 3;
+  }
+  g_stress_series[STRESS_CHART_N - 1] = (int16_t)v;
+}
+
+/**
+ * @brief  清空文字区并绘制当前页
+ */
+static void Stress_DrawPage(void) {
+  LCD_SetColor(LCD_WHITE);
+  LCD_ClearRect(0, STRESS_PAGE_Y, LCD_Width, STRESS_PAGE_H);
+  LCD_SetClip(0, STRESS_PAGE_Y, LCD_Width, STRESS_PAGE_H);
+  LCD_DisplayTextBox(0, STRESS_PAGE_Y, LCD_Width,
+                     (char *)g_stress_pages[g_stress_page % STRESS_PAGES],
+                     LCD_TEXT_ALIGN_LEFT);
+  LCD_ResetClip();
+}
+
+/**
+ * @brief  一帧的常规负载：跑马灯、趋势图，然后发送并等待传输完成
+ * @param  alarm: 1-趋势图还在发送时显示报警条
+ * @retval 报警条耗时(周期)，未显示为0
+ */
+static uint32_t Stress_DrawFrame(uint8_t alarm) {
+  uint32_t cycles = 0;
+
+  LCD_Marquee_Step(&g_stress_ticker_mq, STRESS_BENCH_TICKER_DX);
+
+  Stress_ChartPush();
+  LCD_SetColor(LCD_GREEN);
+  LCD_SetClip(0, STRESS_CHART_Y, LCD_Width, STRESS_CHART_H);
+  LCD_PlotSeries(g_stress_series, STRESS_CHART_N, 0, STRESS_CHART_DX);
+  LCD_ResetClip();
+
+  LCD_Flush();
+#ifdef LCD_ALARM_ENABLE
+  if (alarm) {
+    LCD_AlarmStats_t st;
+
+    LCD_Alarm_Show(0, STRESS_TICKER_Y, LCD_Width, g_stress_alarm_text,
+                   LCD_WHITE, LCD_RED);
+    LCD_Alarm_Release();
+    LCD_Alarm_GetStats(&st);
+    cycles = st.LastCycles;
+  }
+#else
+  (void)alarm;
+#endif
+  LCD_WaitIdle();
+  return cycles;
+}
+
+/**
+ * @brief  建立画面：清屏、跑马灯、趋势图初值和第一页
+ */
+static void Stress_Setup(void) {
+  LCD_GC_t gc;
+
+  LCD_SetColor(LCD_WHITE);
+  LCD_SetBackColor(LCD_BLACK);
+  LCD_SetTextFont(STRESS_FONT);
+  LCD_Clear();
+
+  LCD_GC_Init(&gc);
+  LCD_GC_SetColor(&gc, LCD_YELLOW);
+  LCD_GC_SetFont(&gc, STRESS_FONT);
+  LCD_Marquee_Init(&g_stress_ticker_mq, &gc, 0, STRESS_TICKER_Y, LCD_Width,
+                   STRESS_FONT, g_stress_strip, g_stress_ticker, STRESS_FONT);
+
+  g_stress_seed = 0x12345678;
+  for (uint16_t i = 0; i < STRESS_CHART_N; i++) {
+    g_stress_series[i] = STRESS_CHART_Y + STRESS_CHART_H / 2;
+  }
+  g_stress_page = 0;
+  Stress_DrawPage();
+  LCD_Flush();
+  LCD_WaitIdle();
+}
+
+#ifdef PERF_STATS_ENABLE
+/**
+ * @brief  估算QSPI总线占用率(千分比)
+ * @param  reads: 字模读取次数
+ * @param  bytes: 字模字节数
+ * @param  total: 总周期数
+ * @param  line: 随机读取一个Cache行的周期数
+ * @param  seq: 顺序读取4KB的周期数
+ */
+static uint16_t Stress_QspiPermille(uint32_t reads, uint32_t bytes,
+                                    uint64_t total, uint32_t line,
+                                    uint32_t seq) {
+  uint64_t busy;
+  uint32_t first;
+
+  if (line == 0 || seq == 0 || total == 0) {
+    return STRESS_BENCH_QSPI_UNKNOWN;
+  }
+  // 每次读取的第一行付出指令/地址/空周期，其余字节按顺序读取计
+  first = (line > seq / 128) ? line - seq / 128 : 0;
+  busy = (uint64_t)reads * first + (uint64_t)bytes * seq / 4096;
+  busy = busy * 1000 / total;
+  return (uint16_t)(busy < 1000 ? busy : 1000);
+}
+#endif
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  运行压力测试
+ * @retval 统计的帧数
+ */
+uint32_t Stress_Bench_Run(void) {
+  Stress_BenchResult_t *r = &g_stress_result;
+  uint64_t key_cycles, due, begin, total;
+  uint64_t frame_sum = 0, key_sum = 0, alarm_sum = 0;
+  uint32_t frame_max = 0, key_max = 0, keys = 0, alarm_max = 0, alarms = 0;
+#ifdef PERF_STATS_ENABLE
+  uint32_t line, seq, reads, bytes;
+#endif
+
+  memset(r, 0, sizeof(*r));
+  r->qspi_permille = STRESS_BENCH_QSPI_UNKNOWN;
+  if (FlashFont_BytesPerChar(STRESS_FONT) <= 0) {
+    return 0; // 字库中没有该字号
+  }
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+#ifdef PERF_STATS_ENABLE
+  // 字模区的开头，读取前使Cache行失效
+  line = QSPI_W25Qxx_MeasureReadCycles(BASE_ADDR, 32, 1);
+  seq = QSPI_W25Qxx_MeasureReadCycles(BASE_ADDR, 4096, 1);
+#endif
+
+  Stress_Setup();
+#ifdef LCD_ALARM_ENABLE
+  LCD_Alarm_Load(g_stress_alarm_chars, STRESS_FONT); // 查字库和读QSPI不计入测试
+#endif
+  g_stress_last = STRESS_BENCH_TIMESTAMP();
+  g_stress_clock = 0;
+  for (uint16_t i = 0; i < STRESS_BENCH_WARMUP; i++) {
+    Stress_DrawFrame(0);
+  }
+
+#ifdef PERF_STATS_ENABLE
+  reads = g_perf_stats.glyph_qspi;
+  bytes = g_perf_stats.qspi_bytes;
+#endif
+  key_cycles = (uint64_t)STRESS_BENCH_KEY_MS * (SystemCoreClock / 1000);
+  begin = Stress_Now();
+  due = begin + key_cycles;
+  for (uint32_t f = 0; f < STRESS_BENCH_FRAMES; f++) {
+    uint64_t start = Stress_Now();
+    uint32_t cycles;
+
+    // 帧开始时处理已到达的按键，事件在上一帧中途到达时延迟包含等待该帧结束
+    while (due <= start) {
+      uint32_t latency;
+
+      g_stress_page++;
+      Stress_DrawPage();
+      LCD_Flush();
+      LCD_WaitIdle();
+      latency = (uint32_t)(Stress_Now() - due);
+      if (keys < STRESS_BENCH_KEYS) {
+        g_stress_key[keys++] = latency;
+        key_sum += latency;
+        key_max = (latency > key_max) ? latency : key_max;
+      }
+      due += key_cycles;
+    }
+#ifdef LCD_ALARM_ENABLE
+    if (f % STRESS_BENCH_ALARM_FRAMES == STRESS_BENCH_ALARM_FRAMES - 1) {
+      uint32_t alarm = Stress_DrawFrame(1);
+
+      alarm_sum += alarm;
+      alarm_max = (alarm > alarm_max) ? alarm : alarm_max;
+      alarms++;
+    } else
+#endif
+    {
+      Stress_DrawFrame(0);
+    }
+
+    cycles = (uint32_t)(Stress_Now() - start);
+    g_stress_frame[f] = cycles;
+    frame_sum += cycles;
+    frame_max = (cycles > frame_max) ? cycles : frame_max;
+  }
+  total = Stress_Now() - begin;
+
+  r->frames = STRESS_BENCH_FRAMES;
+  r->elapsed_us = Stress_Us(total);
+  r->fps_x100 = (r->elapsed_us > 0)
+                    ? (uint32_t)((uint64_t)STRESS_BENCH_FRAMES * 100000000U /
+                                 r->elapsed_us)
+                    : 0;
+  r->frame_avg_us = Stress_Us(frame_sum / STRESS_BENCH_FRAMES);
+  r->frame_p99_us = Stress_Us(Stress_P99(g_stress_frame, STRESS_BENCH_FRAMES));
+  r->frame_max_us = Stress_Us(frame_max);
+  r->keys = keys;
+  if (keys > 0) {
+    r->key_avg_us = Stress_Us(key_sum / keys);
+    r->key_p99_us = Stress_Us(Stress_P99(g_stress_key, keys));
+    r->key_max_us = Stress_Us(key_max);
+  }
+  r->alarms = alarms;
+  if (alarms > 0) {
+    r->alarm_avg_us = Stress_Us(alarm_sum / alarms);
+    r->alarm_max_us = Stress_Us(alarm_max);
+  }
+#ifdef PERF_STATS_ENABLE
+  r->qspi_reads = g_perf_stats.glyph_qspi - reads;
+  r->qspi_bytes = g_perf_stats.qspi_bytes - bytes;
+  r->qspi_permille =
+      Stress_QspiPermille(r->qspi_reads, r->qspi_bytes, total, line, seq);
+#endif
+
+  LCD_ResetClip();
+  LCD_SetColor(LCD_WHITE);
+  LCD_SetTextFont(24);
+  LCD_Clear();
+  return r->frames;
+}
+
+/**
+ * @brief  读取最近一次的测试结果
+ * @retval 结果
+ */
+const Stress_BenchResult_t *Stress_Bench_GetResult(void) {
+  return &g_stress_result;
+}
+
+/**
+ * @brief  通过 STRESS_BENCH_PRINTF 输出结果
+ */
+void Stress_Bench_Print(void) {
+#ifdef STRESS_BENCH_PRINTF
+  const Stress_BenchResult_t *r = &g_stress_result;
+
+  STRESS_BENCH_PRINTF("stress frames %lu elapsed %lu us fps %lu.%02lu\r\n",
+                      (unsigned long)r->frames, (unsigned long)r->elapsed_us,
+                      (unsigned long)(r->fps_x100 / 100),
+                      (unsigned long)(r->fps_x100 % 100));
+  STRESS_BENCH_PRINTF("frame avg %lu p99 %lu max %lu us\r\n",
+                      (unsigned long)r->frame_avg_us,
+                      (unsigned long)r->frame_p99_us,
+                      (unsigned long)r->frame_max_us);
+  STRESS_BENCH_PRINTF("key %lu avg %lu p99 %lu max %lu us\r\n",
+                      (unsigned long)r->keys, (unsigned long)r->key_avg_us,
+                      (unsigned long)r->key_p99_us,
+                      (unsigned long)r->key_max_us);
+  if (r->alarms > 0) {
+    STRESS_BENCH_PRINTF("alarm %lu avg %lu max %lu us\r\n",
+                        (unsigned long)r->alarms,
+                        (unsigned long)r->alarm_avg_us,
+                        (unsigned long)r->alarm_max_us);
+  }
+  if (r->qspi_permille != STRESS_BENCH_QSPI_UNKNOWN) {
+    STRESS_BENCH_PRINTF("qspi reads %lu bytes %lu busy %u.%u%%\r\n",
+                        (unsigned long)r->qspi_reads,
+                        (unsigned long)r->qspi_bytes,
+                        (unsigned)(r->qspi_permille / 10),
+                        (unsigned)(r->qspi_permille % 10));
+  } else {
+    STRESS_BENCH_PRINTF("qspi busy n/a\r\n");
+  }
+  STRESS_BENCH_PRINTF("core clock %lu Hz\r\n", (unsigned long)SystemCoreClock);
+#endif
+}
+
+/**
+ * @brief  在屏幕上显示结果
+ */
+void Stress_Bench_Show(void) {
+  const Stress_BenchResult_t *r = &g_stress_result;
+  char line[64];
+
+  LCD_SetTextFont(12);
+  LCD_Clear();
+  sprintf(line, "STRESS %s @%luMHz", LCD_Panel_Controller()->Name,
+          (unsigned long)(SystemCoreClock / 1000000));
+  LCD_DisplayString(0, 0, line);
+  sprintf(line, "fps %lu.%02lu (%lu frames)", (unsigned long)(r->fps_x100 / 100),
+          (unsigned long)(r->fps_x100 % 100), (unsigned long)r->frames);
+  LCD_DisplayString(0, 14, line);
+  sprintf(line, "frame us %lu/%lu/%lu", (unsigned long)r->frame_avg_us,
+          (unsigned long)r->frame_p99_us, (unsigned long)r->frame_max_us);
+  LCD_DisplayString(0, 28, line);
+  sprintf(line, "key us %lu/%lu/%lu (%lu)", (unsigned long)r->key_avg_us,
+          (unsigned long)r->key_p99_us, (unsigned long)r->key_max_us,
+          (unsigned long)r->keys);
+  LCD_DisplayString(0, 42, line);
+  if (r->qspi_permille != STRESS_BENCH_QSPI_UNKNOWN) {
+    sprintf(line, "qspi busy %u.%u%%", (unsigned)(r->qspi_permille / 10),
+            (unsigned)(r->qspi_permille % 10));
+  } else {
+    sprintf(line, "qspi busy n/a");
+  }
+  LCD_DisplayString(0, 56, line);
+  LCD_DisplayString(0, 70, "avg/p99/max");
+  if (r->alarms > 0) {
+    sprintf(line, "alarm us %lu/%lu (%lu)", (unsigned long)r->alarm_avg_us,
+            (unsigned long)r->alarm_max_us, (unsigned long)r->alarms);
+    LCD_DisplayString(0, 84, line);
+  }
+}
+
+#endif /* STRESS_BENCH_ENABLE && LCD_SPI_ENABLE && FLASH_FONT_ENABLE */
@@ -0,0 +1,125 @@
+/**
+ ******************************************************************************
+ * @file    stress_bench.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   混合负载压力测试头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 单项基准(lcd_bench、qspi_bench)各自独占总线，压力测试把实际界面中同时存在的
+ *   负载放在一帧里：顶部跑马灯(LCD_Marquee_Step)、中部滚动趋势图(LCD_PlotSeries)
+ *   和下部整页文字，按键事件每 STRESS_BENCH_KEY_MS 到达一次，下一帧开始时翻页
+ *   重画整页文字，与主循环中 KEY_Task() 分发事件的时机相同
+ * - 每帧结束时 LCD_Flush() 并等待最后一次SPI/DMA传输完成，帧耗时和按键延迟都
+ *   以像素发送到屏幕为终点；帧之间不等待，测的是持续最高帧率
+ * - 报告：持续帧率、帧耗时平均/99百分位/最大、按键到像素的延迟平均/99百分位/最大，
+ *   定义 PERF_STATS_ENABLE 时还有字模QSPI读取次数、字节数和估算的QSPI总线占用率
+ * - 定义 LCD_ALARM_ENABLE 时每 STRESS_BENCH_ALARM_FRAMES 帧在上一帧的趋势图还在发送时
+ *   调用一次 LCD_Alarm_Show()，报告报警条从调用到发送完的平均/最大耗时，即满负载下
+ *   实测的最坏情况(WCET)；测试会用 LCD_Alarm_Load() 替换已锁定的报警字符
+ * - QSPI占用率 = (读取次数 x 随机读取首行开销 + 字节数 x 顺序读取每字节开销) / 总时间，
+ *   两项开销在测试开始前用 QSPI_W25Qxx_MeasureReadCycles() 实测；XIP取指和
+ *   常量读取没有计数器，不计入占用率，其影响体现在帧率中
+ * - 场景、语料、按键时刻和趋势图数据都是固定的(伪随机数种子固定)，同一固件重复
+ *   运行结果只随Cache和总线状态小幅波动，可作为各项优化叠加效果的基线
+ * - 只支持UTF-8字库(跑马灯只接受UTF-8)，测试会覆盖屏幕内容，
+ *   只应在调试固件中启用(init.h 中的 STRESS_BENCH_ENABLE)
+ *
+ * 使用示例：
+ *     Stress_Bench_Run();   // 阻塞运行，约数秒
+ *     Stress_Bench_Print(); // 通过 STRESS_BENCH_PRINTF 输出
+ *     Stress_Bench_Show();  // 在屏幕上显示结果
+ *
+ ******************************************************************************
+ */
+
+#ifndef STRESS_BENCH_H
+#define STRESS_BENCH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define STRESS_BENCH_FRAMES 300 /*!< 统计的帧数 */
+#define STRESS_BENCH_WARMUP 30 /*!< 统计前先运行的帧数(填充各级Cache，不计入结果) */
+#ifndef STRESS_BENCH_KEY_MS
+#define STRESS_BENCH_KEY_MS 250 /*!< 模拟按键事件的间隔(ms)，每个事件翻一页 */
+#endif
+#define STRESS_BENCH_KEYS 64 /*!< 记录延迟的按键事件数，超出的事件照常处理但不计入延迟统计 */
+#define STRESS_BENCH_TICKER_DX 2 /*!< 跑马灯每帧左移的列数 */
+#define STRESS_BENCH_ALARM_FRAMES 10 /*!< 定义 LCD_ALARM_ENABLE 时每隔多少帧显示一次报警条 */
+#define STRESS_BENCH_PRINTF printf /*!< 结果输出函数(需自行重定向到调试串口) */
+
+#ifndef STRESS_BENCH_TIMESTAMP
+#define STRESS_BENCH_TIMESTAMP() (DWT->CYCCNT) /*!< 时间戳来源，单位为CPU周期 */
+#endif
+
+#define STRESS_BENCH_QSPI_UNKNOWN 0xFFFF /*!< qspi_permille：未定义 PERF_STATS_ENABLE 或开销实测失败 */
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  测试结果(时间单位均为微秒)
+     */
+    typedef struct
+    {
+        uint32_t frames;        /*!< 统计的帧数 */
+        uint32_t elapsed_us;    /*!< 统计期间的总时间 */
+        uint32_t fps_x100;      /*!< 持续帧率 x100 */
+        uint32_t frame_avg_us;  /*!< 帧耗时平均 */
+        uint32_t frame_p99_us;  /*!< 帧耗时99百分位 */
+        uint32_t frame_max_us;  /*!< 帧耗时最大 */
+        uint32_t keys;          /*!< 统计的按键事件数 */
+        uint32_t key_avg_us;    /*!< 按键到像素延迟平均 */
+        uint32_t key_p99_us;    /*!< 按键到像素延迟99百分位 */
+        uint32_t key_max_us;    /*!< 按键到像素延迟最大 */
+        uint32_t qspi_reads;    /*!< 从QSPI读取字模的次数(需 PERF_STATS_ENABLE) */
+        uint32_t qspi_bytes;    /*!< 从QSPI读取的字模字节数(需 PERF_STATS_ENABLE) */
+        uint16_t qspi_permille; /*!< 估算的QSPI总线占用率(千分比)，STRESS_BENCH_QSPI_UNKNOWN 为未知 */
+        uint32_t alarms;        /*!< 显示报警条的次数(需 LCD_ALARM_ENABLE) */
+        uint32_t alarm_avg_us;  /*!< 报警条耗时平均 */
+        uint32_t alarm_max_us;  /*!< 报警条耗时最大 */
+    } Stress_BenchResult_t;
+
+    /*******************************************************************************
+     *                          导出函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  运行压力测试
+     * @note   需在 SPI_LCD_Init() 和 FlashFont_Init() 之后调用
+     * @note   会改写屏幕内容、字体、颜色和裁剪区，结束后恢复为24号字体、不裁剪并清屏
+     * @retval 统计的帧数
+     */
+    uint32_t Stress_Bench_Run(void);
+
+    /**
+     * @brief  读取最近一次的测试结果
+     * @retval 结果，未运行时各项为0
+     */
+    const Stress_BenchResult_t *Stress_Bench_GetResult(void);
+
+    /**
+     * @brief  通过 STRESS_BENCH_PRINTF 输出结果
+     */
+    void Stress_Bench_Print(void);
+
+    /**
+     * @brief  在屏幕上显示结果
+     */
+    void Stress_Bench_Show(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STRESS_BENCH_H
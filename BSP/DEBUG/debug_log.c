@@ -0,0 +1,229 @@
+/**
+ ******************************************************************************
+ * @file    debug_log.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   延迟输出的调试日志
+ ******************************************************************************
+ * @attention
+ * 实现方式：
+ * 1. 写入方用 LDREX/STREX 递增 g_log_head 分配槽位，超过读位置一圈时放弃并计入丢弃次数
+ * 2. 槽内先写节拍和数值，DMB之后写消息地址；读出方看到地址不为NULL才认为该槽已写完
+ * 3. 只有 DebugLog_Task() 读出：格式化到行缓冲区，输出函数接收后清空消息地址并前移读位置；
+ *    两个行缓冲区交替使用，输出函数接收的一行在下一行输出之前保持不变
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef DEBUG_LOG_ENABLE
+#include <stdio.h>
+
+#if (DEBUG_LOG_DEPTH & (DEBUG_LOG_DEPTH - 1)) != 0
+#error "DEBUG_LOG_DEPTH 必须为2的幂"
+#endif
+
+#define DEBUG_LOG_MASK (DEBUG_LOG_DEPTH - 1)
+
+/**
+ * @brief  一条记录
+ */
+typedef struct
+{
+    const char *volatile msg; /*!< 消息字符串(日志ID)，NULL表示空槽或正在写入 */
+    uint32_t tick;            /*!< 记录时的系统节拍 */
+    int32_t value;            /*!< 附带的数值 */
+    uint16_t suppressed;      /*!< 本条之前被限速的次数 */
+    uint8_t level;            /*!< DebugLog_Level_t */
+    uint8_t has;              /*!< 是否附带数值 */
+} DebugLog_Entry_t;
+
+DTCM_BSS static DebugLog_Entry_t g_log_ring[DEBUG_LOG_DEPTH]; /*!< 记录缓冲区 */
+DEBUG_LOG_LINE_ATTR static char g_log_lines[2][DEBUG_LOG_LINE_BYTES]; /*!< 两个行缓冲区交替使用，一个发送时格式化另一个 */
+static volatile uint32_t g_log_head = 0; /*!< 下一条记录的序号，只增不减 */
+static volatile uint32_t g_log_tail = 0; /*!< 下一条要输出的序号，只由 DebugLog_Task() 修改 */
+static char *g_log_line = g_log_lines[0]; /*!< 正在格式化或等待输出的行 */
+static uint16_t g_log_line_len = 0;      /*!< 行缓冲区中等待输出的字节数 */
+static uint8_t g_log_line_drop = 0;      /*!< 行缓冲区中是丢弃统计行，不对应记录 */
+static uint32_t g_log_drop_shown = 0;    /*!< 已输出过的丢弃次数 */
+static DebugLog_Output_t g_log_output = NULL;
+static DebugLog_Stats_t g_log_stats;
+
+#ifdef DEBUG_LOG_ITM
+/**
+ * @brief  逐字节写入ITM端口0，调试器未连接时 ITM_SendChar() 直接返回
+ */
+static uint8_t DebugLog_OutputITM(const char *data, uint16_t len)
+{
+    while (len--)
+    {
+        ITM_SendChar((uint8_t)*data++);
+    }
+    return 1;
+}
+#endif
+
+/**
+ * @brief  清空缓冲区和统计，定义 DEBUG_LOG_ITM 时设置ITM为默认输出
+ * @retval None
+ */
+void DebugLog_Init(void)
+{
+    for (uint32_t i = 0; i < DEBUG_LOG_DEPTH; i++)
+    {
+        g_log_ring[i].msg = NULL;
+    }
+    g_log_head = 0;
+    g_log_tail = 0;
+    g_log_line_len = 0;
+    g_log_drop_shown = 0;
+    g_log_stats.logged = 0;
+    g_log_stats.written = 0;
+    g_log_stats.suppressed = 0;
+    g_log_stats.dropped = 0;
+#ifdef DEBUG_LOG_ITM
+    g_log_output = DebugLog_OutputITM;
+#endif
+}
+
+/**
+ * @brief  写入一条记录，由日志宏调用
+ * @param  site: 调用点的限速状态
+ * @param  level: 日志级别
+ * @param  msg: 消息字符串常量
+ * @param  value: 附带的数值
+ * @param  has: 是否附带数值
+ * @retval None
+ */
+void DebugLog_Put(DebugLog_Site_t *site, DebugLog_Level_t level, const char *msg, int32_t value, uint8_t has)
+{
+    uint32_t now = GetTick();
+    uint32_t idx;
+    DebugLog_Entry_t *e;
+
+    if (site->used && DEBUG_LOG_RATE_MS != 0 && (now - site->last) < DEBUG_LOG_RATE_MS)
+    {
+        if (site->suppressed != 0xFFFF)
+            site->suppressed++;
+        g_log_stats.suppressed++;
+        return;
+    }
+    site->used = 1;
+    site->last = now; // 缓冲区满丢弃时同样开始限速，满载期间每个调用点每个间隔只尝试一次
+
+    // 中断可能在主循环写入途中插入，用独占访问分配槽位，双方各写各的槽
+    do
+    {
+        idx = __LDREXW(&g_log_head);
+        if (idx - g_log_tail >= DEBUG_LOG_DEPTH)
+        {
+            __CLREX();
+            g_log_stats.dropped++;
+            return;
+        }
+    } while (__STREXW(idx + 1, &g_log_head) != 0U);
+
+    e = &g_log_ring[idx & DEBUG_LOG_MASK];
+    e->tick = now;
+    e->value = value;
+    e->suppressed = site->suppressed;
+    e->level = (uint8_t)level;
+    e->has = has;
+    site->suppressed = 0;
+    g_log_stats.logged++;
+    __DMB(); // 内容先于消息地址可见
+    e->msg = msg;
+}
+
+/**
+ * @brief  注册输出函数
+ * @param  output: 输出函数，NULL时记录只缓存不输出
+ * @retval None
+ */
+void DebugLog_SetOutput(DebugLog_Output_t output)
+{
+    g_log_output = output;
+}
+
+/**
+ * @brief  把一条记录格式化到行缓冲区
+ */
+static void DebugLog_Format(const DebugLog_Entry_t *e)
+{
+    int len = snprintf(g_log_line, DEBUG_LOG_LINE_BYTES, "[%lu.%03lu] %c %s",
+                       (unsigned long)(e->tick / 1000U), (unsigned long)(e->tick % 1000U),
+                       (e->level == DEBUG_LOG_ERROR) ? 'E' : 'I', e->msg);
+
+    if (len >= 0 && len < (int)DEBUG_LOG_LINE_BYTES && e->has)
+        len += snprintf(g_log_line + len, DEBUG_LOG_LINE_BYTES - len, "=%ld", (long)e->value);
+    if (len >= 0 && len < (int)DEBUG_LOG_LINE_BYTES && e->suppressed != 0)
+        len += snprintf(g_log_line + len, DEBUG_LOG_LINE_BYTES - len, " (另有%u次)", (unsigned)e->suppressed);
+    if (len < 0)
+        len = 0;
+    if (len > (int)DEBUG_LOG_LINE_BYTES - 2) // 截断后仍以换行结尾
+        len = (int)DEBUG_LOG_LINE_BYTES - 2;
+    g_log_line[len++] = '\n';
+    g_log_line_len = (uint16_t)len;
+}
+
+/**
+ * @brief  输出缓冲区中的记录，由调度器在主循环中调用
+ * @retval 1=还有未输出的记录，0=已输出完
+ */
+uint8_t DebugLog_Task(void)
+{
+    for (uint32_t n = 0; n < DEBUG_LOG_DRAIN_LINES; n++)
+    {
+        DebugLog_Entry_t *e = &g_log_ring[g_log_tail & DEBUG_LOG_MASK];
+
+        if (g_log_output == NULL)
+            return 0;
+        if (g_log_line_len == 0)
+        {
+            uint32_t dropped = g_log_stats.dropped;
+
+            if (dropped != g_log_drop_shown)
+            {
+                int len = snprintf(g_log_line, DEBUG_LOG_LINE_BYTES, "[log] 缓冲区满，丢弃%lu条\n",
+                                   (unsigned long)(dropped - g_log_drop_shown));
+
+                g_log_drop_shown = dropped;
+                g_log_line_len = (uint16_t)len;
+                g_log_line_drop = 1;
+            }
+            else
+            {
+                if (g_log_tail == g_log_head || e->msg == NULL) // 空，或最早的一条还在写入
+                    return g_log_tail != g_log_head;
+                DebugLog_Format(e);
+                g_log_line_drop = 0;
+            }
+        }
+        if (!g_log_output(g_log_line, g_log_line_len))
+            return 1; // 输出忙，下次重发同一行
+        g_log_line_len = 0;
+        g_log_line = (g_log_line == g_log_lines[0]) ? g_log_lines[1] : g_log_lines[0]; // 交出的行可能还在DMA发送
+        g_log_stats.written++;
+        if (!g_log_line_drop)
+        {
+            e->msg = NULL;
+            __DMB(); // 槽位清空后再归还
+            g_log_tail++;
+        }
+    }
+    return g_log_tail != g_log_head || g_log_stats.dropped != g_log_drop_shown;
+}
+
+/**
+ * @brief  读取统计
+ * @param  stats: 输出
+ * @retval None
+ */
+void DebugLog_GetStats(DebugLog_Stats_t *stats)
+{
+    if (stats == NULL)
+        return;
+    *stats = g_log_stats;
+}
+
+#endif /* DEBUG_LOG_ENABLE */
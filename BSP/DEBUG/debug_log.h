@@ -0,0 +1,166 @@
+/**
+ ******************************************************************************
+ * @file    debug_log.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   延迟输出的调试日志头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - DEBUG_INFO() / DEBUG_ERROR() 不在调用处格式化和发送：只把消息字符串的地址(即日志ID，
+ *   字符串本身留在Flash中)、系统节拍和一个可选的数值写入DTCM中的环形缓冲区，
+ *   耗时为几十个周期，可以留在字模查找等热点路径中
+ * - 主循环空闲时 DebugLog_Task() 取出记录，格式化为 "[秒.毫秒] E 消息" 一行，交给
+ *   DebugLog_SetOutput() 注册的输出函数(串口DMA等)；定义 DEBUG_LOG_ITM 时默认经ITM端口0(SWO)输出
+ * - 输出函数返回0表示忙(如上一行的DMA还没发完)，该行保留到下次再发，不丢失也不阻塞
+ * - 每个调用点各自限速：DEBUG_LOG_RATE_MS 内只记录第一次，其余次数累加，
+ *   下一次记录时以 "(另有N次)" 附在行尾；缓冲区满时丢弃新记录并计数
+ * - 写入不加锁：主循环和中断都可以记录，槽位用 LDREX/STREX 原子递增分配，
+ *   消息地址最后写入，作为该槽已写完的标志
+ * - 由 init.h 中的 DEBUG_LOG_ENABLE 控制，未定义时所有日志宏展开为空
+ *
+ * 使用示例：
+ *     static uint8_t Uart_Output(const char *s, uint16_t len) {
+ *         if (huart1.gState != HAL_UART_STATE_READY) return 0;   // 上一行还在发送
+ *         return HAL_UART_Transmit_DMA(&huart1, (uint8_t *)s, len) == HAL_OK;
+ *     }
+ *     DebugLog_SetOutput(Uart_Output);  // 行缓冲区需用 DEBUG_LOG_LINE_ATTR 放到DMA可访问的RAM
+ *     DEBUG_ERROR("QSPI Flash ID error");
+ *     DEBUG_VALUE("FontHash_Build: 冲突链长度", len);
+ *
+ ******************************************************************************
+ */
+
+#ifndef DEBUG_LOG_H
+#define DEBUG_LOG_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define DEBUG_LOG_DEPTH 64         /*!< 记录缓冲区条数，必须为2的幂，每条16字节 */
+#define DEBUG_LOG_RATE_MS 1000     /*!< 同一调用点两次记录的最小间隔(毫秒)，0为不限速 */
+#define DEBUG_LOG_LINE_BYTES 128   /*!< 一行输出的最大字节数，超出的部分截断 */
+#define DEBUG_LOG_DRAIN_LINES 4    /*!< DebugLog_Task() 每次最多输出的行数 */
+// #define DEBUG_LOG_ITM /*!< 定义了：默认经ITM端口0(SWO)输出, 注释后：注册输出函数之前记录只缓存不输出 */
+#ifndef DEBUG_LOG_LINE_ATTR
+#define DEBUG_LOG_LINE_ATTR /*!< 行缓冲区存放位置，默认RAM(DTCM)；输出函数直接用DMA发送时改为 AXI_SRAM_AT(地址) */
+#endif
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  日志级别
+     */
+    typedef enum
+    {
+        DEBUG_LOG_INFO = 0, /*!< 提示，行首标记 I */
+        DEBUG_LOG_ERROR     /*!< 错误，行首标记 E */
+    } DebugLog_Level_t;
+
+    /**
+     * @brief  调用点的限速状态，由日志宏在调用处定义为静态变量
+     */
+    typedef struct
+    {
+        uint32_t last;       /*!< 上次记录时的系统节拍 */
+        uint16_t suppressed; /*!< 限速期间未记录的次数 */
+        uint8_t used;        /*!< 是否记录过 */
+    } DebugLog_Site_t;
+
+    /**
+     * @brief  日志统计
+     */
+    typedef struct
+    {
+        uint32_t logged;     /*!< 写入缓冲区的记录数 */
+        uint32_t written;    /*!< 已交给输出函数的行数 */
+        uint32_t suppressed; /*!< 限速丢弃的次数 */
+        uint32_t dropped;    /*!< 缓冲区满丢弃的次数 */
+    } DebugLog_Stats_t;
+
+    /**
+     * @brief  输出函数
+     * @param  data: 一行文本(以换行结尾，不以0结尾)
+     * @param  len: 字节数
+     * @retval 1=已接收；0=忙，稍后以同样内容再次调用
+     * @note   行缓冲区有两个交替使用，data 在下一次调用返回1之前保持不变，可以直接用DMA发送；
+     *         上一行还没发完时应返回0
+     */
+    typedef uint8_t (*DebugLog_Output_t)(const char *data, uint16_t len);
+
+/**
+ * @brief  记录一条日志
+ * @param  level: DebugLog_Level_t
+ * @param  msg: 字符串常量，只保存地址，不能是栈上或会被修改的字符串
+ * @param  value: 附带的数值，输出为 "=值"
+ * @param  has: 是否附带数值
+ */
+#define DEBUG_LOG(level, msg, value, has)                            \
+    do                                                               \
+    {                                                                \
+        static DebugLog_Site_t debug_log_site_;                      \
+        DebugLog_Put(&debug_log_site_, (level), (msg), (int32_t)(value), (has)); \
+    } while (0)
+
+#define DEBUG_INFO(msg) DEBUG_LOG(DEBUG_LOG_INFO, msg, 0, 0)           /*!< 提示 */
+#define DEBUG_ERROR(msg) DEBUG_LOG(DEBUG_LOG_ERROR, msg, 0, 0)         /*!< 错误 */
+#define DEBUG_VALUE(msg, value) DEBUG_LOG(DEBUG_LOG_ERROR, msg, value, 1) /*!< 带一个数值的错误 */
+#define Debug_Init() DebugLog_Init()
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  清空缓冲区和统计，定义 DEBUG_LOG_ITM 时设置ITM为默认输出
+     * @retval None
+     */
+    void DebugLog_Init(void);
+
+    /**
+     * @brief  写入一条记录，由日志宏调用
+     * @param  site: 调用点的限速状态
+     * @param  level: 日志级别
+     * @param  msg: 消息字符串常量
+     * @param  value: 附带的数值
+     * @param  has: 是否附带数值
+     * @retval None
+     * @note   可在中断中调用；不格式化、不等待
+     */
+    void DebugLog_Put(DebugLog_Site_t *site, DebugLog_Level_t level, const char *msg, int32_t value, uint8_t has);
+
+    /**
+     * @brief  注册输出函数
+     * @param  output: 输出函数，NULL时记录只缓存不输出
+     * @retval None
+     */
+    void DebugLog_SetOutput(DebugLog_Output_t output);
+
+    /**
+     * @brief  输出缓冲区中的记录，由调度器在主循环中调用
+     * @retval 1=还有未输出的记录，0=已输出完
+     * @note   每次最多 DEBUG_LOG_DRAIN_LINES 行，输出函数忙时立即返回
+     */
+    uint8_t DebugLog_Task(void);
+
+    /**
+     * @brief  读取统计
+     * @param  stats: 输出
+     * @retval None
+     */
+    void DebugLog_GetStats(DebugLog_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEBUG_LOG_H
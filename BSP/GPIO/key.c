@@ -7,15 +7,19 @@
  * @attention
  *
  * 本文件实现：
- * - 软件消抖（可配置消抖时间）
+ * - 软件消抖（可配置消抖时间）：每次扫描每个GPIO端口只读一次IDR，同一端口上的按键用垂直计数器
+ *   按位同时消抖，扫描耗时只与端口数和正在变化的按键数有关，与按键总数无关
  * - 事件检测：按下/释放/单击/双击/长按
  * - 弱符号事件处理函数，支持HAL风格回调
+ * - 中断驱动扫描（KEY_EXTI_ENABLE）：EXTI边沿启动定时器扫描，事件经单生产者单消费者队列交给主循环；
+ *   触摸驱动在同优先级中断中经 KEY_Post() 写入同一队列，按键与触摸事件按发生顺序分发
  ******************************************************************************
  */
 
 #include "key.h"
 
 #ifdef KEY_ENABLE
+#include <string.h>
 
 /*******************************************************************************
  *                              私有配置参数
@@ -27,6 +31,20 @@
 #define KEY_LONG_MS 600    /*!< 长按触发时间（毫秒） */
 #define KEY_DBL_MS 200     /*!< 双击最大间隔时间（毫秒） */
 
+#ifdef KEY_EXTI_ENABLE
+#define KEY_PERIOD_MS KEY_SCAN_MS /*!< 扫描间隔 */
+#else
+#define KEY_PERIOD_MS SCHED_KEY_MS
+#endif
+/**
+ * @brief 连续多少次采样与稳定状态不同才确认变化：电平保持 KEY_DEBOUNCE_MS 后的下一次采样确认，与按时间戳消抖一致
+ */
+#define KEY_DEBOUNCE_SAMPLES ((KEY_DEBOUNCE_MS + KEY_PERIOD_MS - 1) / KEY_PERIOD_MS + 1)
+#if KEY_DEBOUNCE_SAMPLES > 8
+#error "KEY_DEBOUNCE_MS 不能超过扫描间隔的7倍(垂直计数器为3位)"
+#endif
+#define KEY_CNT_BIT(c, n) ((KEY_DEBOUNCE_SAMPLES - 1) & (n) ? (c) : (uint16_t)~(c)) /*!< 计数器第n位与目标值相同的引脚 */
+
 /*******************************************************************************
  *                              私有状态数组
  ******************************************************************************/
@@ -39,20 +57,62 @@ KEY keys[] = {
     KEY_LIST};
 #undef X
 
-static uint8_t stable_state[KEY_COUNT];    /*!< 去抖后的稳定状态（0/1） */
-static uint8_t last_raw[KEY_COUNT];        /*!< 上一次原始电平（用于检测变化） */
-static uint32_t last_change_ts[KEY_COUNT]; /*!< 上一次电平变化时间戳 */
-static uint32_t press_ts[KEY_COUNT];       /*!< 按下时间戳 */
-static uint32_t release_ts[KEY_COUNT];     /*!< 释放时间戳 */
-static uint8_t click_pending[KEY_COUNT];   /*!< 单击待处理标志（等待双击窗口） */
-static uint8_t long_reported[KEY_COUNT];   /*!< 长按已报告标志 */
+/**
+ * @brief  一个GPIO端口上全部按键的扫描状态，每个位对应一个引脚
+ * @note   c0/c1/c2 为垂直计数器：每个引脚的3位计数分别放在三个字的同一位上，记录连续多少次采样与
+ *         state 不同，采样与 state 相同时清零，按位运算一次更新全部引脚
+ */
+typedef struct
+{
+    GPIO_TypeDef *port; /*!< GPIO端口 */
+    uint16_t mask;      /*!< 本端口上的按键引脚 */
+    uint16_t idle;      /*!< 空闲为高电平的引脚 */
+    uint16_t state;     /*!< 去抖后处于按下状态的引脚 */
+    uint16_t c0;        /*!< 垂直计数器第0位 */
+    uint16_t c1;        /*!< 垂直计数器第1位 */
+    uint16_t c2;        /*!< 垂直计数器第2位 */
+    uint16_t hold;      /*!< 按下后还没有报告长按的引脚 */
+    uint16_t click;     /*!< 单击待处理(等待双击窗口)的引脚 */
+    uint8_t id[16];     /*!< 引脚号对应的按键ID */
+} KEY_Port;
+
+static KEY_Port key_ports[KEY_COUNT]; /*!< 按键所在的端口，KEY_Init() 按 KEY_LIST 生成，最多每个按键一个端口 */
+static uint8_t key_port_count = 0;    /*!< 实际端口数 */
+static uint32_t press_ts[KEY_COUNT];   /*!< 按下时间戳 */
+static uint32_t release_ts[KEY_COUNT]; /*!< 释放时间戳 */
 
 static KEY_Callback callbacks[KEY_COUNT] = {0}; /*!< 回调函数数组 */
 
+#ifdef KEY_EXTI_ENABLE
+static uint16_t key_exti_mask = 0; /*!< 全部按键引脚(EXTI线)，各端口 mask 的并集 */
+
+/**
+ * @brief  事件队列项
+ */
+typedef struct
+{
+    uint8_t id;     /*!< 按键ID，KEY_ID_TOUCH 位为1时是触摸事件 */
+    uint8_t ev;     /*!< 事件类型 */
+    uint16_t x;     /*!< 触摸事件的参数，按键事件为0 */
+    uint16_t y;
+    uint32_t stamp; /*!< 产生事件时的DWT周期计数 */
+} KEY_QueueItem;
+
+static KEY_QueueItem key_queue[KEY_QUEUE_LEN]; /*!< 事件队列，扫描定时器中断写入、KEY_Task() 读出 */
+static volatile uint8_t key_queue_head = 0;    /*!< 写位置，只由中断修改 */
+static volatile uint8_t key_queue_tail = 0;    /*!< 读位置，只由主循环修改 */
+static volatile uint8_t key_scan_running = 0;  /*!< 扫描定时器是否在运行 */
+static KEY_LatencyStats key_latency;           /*!< 事件延迟统计，只由主循环修改 */
+#endif /* KEY_EXTI_ENABLE */
+
 /*******************************************************************************
  *                              私有函数声明
  ******************************************************************************/
 static void emit_event(KEY_ID id, KEY_Event ev);
+#ifdef KEY_EXTI_ENABLE
+static void KEY_EXTI_Config(void);
+static void KEY_ScanStart(void);
+#endif
 
 /**
  * @brief  读取按键原始GPIO电平
@@ -110,7 +170,7 @@ __weak void KEY_EventHandler(KEY_ID id, KEY_Event ev)
  * @param  ev: 事件类型
  * @note   优先调用已注册回调，否则调用弱处理函数
  */
-static void emit_event(KEY_ID id, KEY_Event ev)
+static void dispatch_event(KEY_ID id, KEY_Event ev)
 {
     if (id >= KEY_COUNT)
         return;
@@ -121,6 +181,46 @@ static void emit_event(KEY_ID id, KEY_Event ev)
         KEY_EventHandler(id, ev); /* 调用弱处理函数（用户可重定义） */
 }
 
+/**
+ * @brief  扫描状态机产生事件
+ * @param  id: 按键ID
+ * @param  ev: 事件类型
+ * @note   轮询模式直接分发；中断模式写入队列，由 KEY_Task() 在主循环中分发
+ * @note   队列只有一个生产者(扫描中断)和一个消费者(主循环)，写入数据后再发布写位置，不需要关中断
+ */
+static void emit_event(KEY_ID id, KEY_Event ev)
+{
+#ifdef KEY_EXTI_ENABLE
+    KEY_Post((uint8_t)id, (uint8_t)ev, 0, 0);
+#else
+    dispatch_event(id, ev);
+#endif
+}
+
+#ifdef KEY_EXTI_ENABLE
+/**
+ * @brief  向事件队列写入一项
+ * @note   扫描中断和触摸中断优先级相同，不会互相打断，写入仍是单生产者
+ */
+uint8_t KEY_Post(uint8_t id, uint8_t ev, uint16_t x, uint16_t y)
+{
+    uint8_t head = key_queue_head;
+    uint8_t next = (uint8_t)((head + 1) & (KEY_QUEUE_LEN - 1));
+
+    if (next == key_queue_tail)
+        return 0; /* 队列满，丢弃 */
+    key_queue[head].id = id;
+    key_queue[head].ev = ev;
+    key_queue[head].x = x;
+    key_queue[head].y = y;
+    key_queue[head].stamp = DWT->CYCCNT;
+    __DMB(); /* 队列项先于写位置可见 */
+    key_queue_head = next;
+    Sched_Kick(); /* 主循环本轮若已分发过事件，不要睡眠 */
+    return 1;
+}
+#endif
+
 /**
  * @brief  初始化所有按键
  * @note   清空状态数组并读取初始电平
@@ -128,21 +228,40 @@ static void emit_event(KEY_ID id, KEY_Event ev)
  */
 void KEY_Init(void)
 {
-    uint32_t now = GetTick();
+#ifdef KEY_EXTI_ENABLE
+    KEY_EXTI_Config();
+#endif
+    memset(key_ports, 0, sizeof(key_ports));
+    key_port_count = 0;
     for (int i = 0; i < KEY_COUNT; ++i)
     {
+        KEY_Port *kp = key_ports;
+        KEY_Port *end = key_ports + key_port_count;
+
         /* 读取初始电平作为空闲电平(假设按键未按下) */
         keys[i].idle_level = KEY_ReadRaw(&keys[i]);
 
-        last_raw[i] = keys[i].idle_level;
-        stable_state[i] = 0; /* 初始化为未按下 */
-        last_change_ts[i] = now;
+        /* 按端口归并，扫描时每个端口读一次IDR */
+        while (kp < end && kp->port != keys[i].port)
+            kp++;
+        if (kp == end)
+        {
+            kp->port = keys[i].port;
+            key_port_count++;
+        }
+        kp->mask |= keys[i].pin;
+        if (keys[i].idle_level)
+            kp->idle |= keys[i].pin;
+        kp->id[31 - __CLZ(keys[i].pin)] = (uint8_t)i;
+
         press_ts[i] = 0;
         release_ts[i] = 0;
-        click_pending[i] = 0;
-        long_reported[i] = 0;
         callbacks[i] = NULL;
     }
+#ifdef KEY_EXTI_ENABLE
+    key_queue_head = key_queue_tail = 0;
+    KEY_ScanStart(); /* 先扫描一轮，确认初始状态后自动停止 */
+#endif
 }
 
 /**
@@ -173,106 +292,308 @@ void KEY_UnregisterCallback(KEY_ID id)
 }
 
 /**
- * @brief  按键扫描任务（非阻塞，需周期调用）
- * @note   建议在主循环或定时器中每5~20ms调用一次
+ * @brief  扫描一次所有按键
+ * @param  now: 当前系统节拍
  * @note   内部处理：消抖 -> 边沿检测 -> 事件识别 -> 回调触发
  * @retval None
  *
- * @par    状态机逻辑：
- *         1. 检测原始电平变化 -> 重置消抖计时器
- *         2. 原始电平稳定超过消抖时间 -> 确认为有效电平
- *         3. 有效电平与上次稳定状态不同 -> 触发边沿事件（按下/释放）
- *         4. 按下后持续时间检测 -> 触发长按事件
- *         5. 释放后检测持续时间 -> 判断单击/双击
+ * @par    状态机逻辑(每个端口按位并行)：
+ *         1. 读一次IDR，与空闲电平异或得到按下的引脚，与去抖后状态不同的引脚计数加1，相同的清零
+ *         2. 连续 KEY_DEBOUNCE_SAMPLES 次不同 -> 确认为有效电平，翻转去抖后状态
+ *         3. 翻转的引脚逐个触发边沿事件（按下/释放），释放时判断单击/双击
+ *         4. 电平稳定时，按住且未报告长按的引脚检测长按，释放且单击待处理的引脚检测双击超时
+ *         只有发生变化或等待超时的引脚需要逐个处理，其余按键不产生任何计算
  */
-void KEY_Task(void)
+static void KEY_Scan(uint32_t now)
 {
-    uint32_t now = GetTick();
-
-    for (int i = 0; i < KEY_COUNT; ++i)
+    for (uint32_t p = 0; p < key_port_count; ++p)
     {
-        uint8_t raw = KEY_ReadRaw(&keys[i]);
-        uint8_t pressed = (raw != keys[i].idle_level) ? 1 : 0;
+        KEY_Port *kp = &key_ports[p];
+        uint16_t sample = (uint16_t)((kp->port->IDR ^ kp->idle) & kp->mask);
+        uint16_t delta = sample ^ kp->state;
+        uint16_t toggle = delta & KEY_CNT_BIT(kp->c0, 1) & KEY_CNT_BIT(kp->c1, 2) & KEY_CNT_BIT(kp->c2, 4);
+        uint16_t count = delta & ~toggle;
+        uint16_t bits;
+
+        /* 阶段1、2: 计数加1(三位加法按位进行)，状态翻转或采样相同的引脚清零 */
+        kp->c2 = (kp->c2 ^ (kp->c1 & kp->c0)) & count;
+        kp->c1 = (kp->c1 ^ kp->c0) & count;
+        kp->c0 = (uint16_t)~kp->c0 & count;
+        kp->state ^= toggle;
 
-        /* 阶段1: 检测原始电平变化 */
-        if (raw != last_raw[i])
+        /* 阶段3: 边沿事件 */
+        while (toggle)
         {
-            last_change_ts[i] = now; /* 重置消抖计时器 */
-            last_raw[i] = raw;
+            uint32_t pin = 31 - __CLZ(toggle);
+            uint16_t m = (uint16_t)(1U << pin);
+            KEY_ID id = (KEY_ID)kp->id[pin];
+
+            toggle &= ~m;
+            if (kp->state & m)
+            {
+                /* 按下边沿 */
+                press_ts[id] = now;
+                kp->hold |= m;
+                emit_event(id, KEY_EV_PRESS);
+                continue;
+            }
+
+            /* 释放边沿 */
+            release_ts[id] = now;
+            kp->hold &= ~m;
+            emit_event(id, KEY_EV_RELEASE);
+            if ((now - press_ts[id]) >= KEY_LONG_MS)
+            {
+                /* 长按后释放,不当作点击 */
+                kp->click &= ~m;
+            }
+            else if (kp->click & m)
+            {
+                /* 双击窗口内的第二次释放 -> 双击 */
+                kp->click &= ~m;
+                emit_event(id, KEY_EV_DOUBLE_CLICK);
+            }
+            else
+            {
+                /* 标记单击待处理，等待双击窗口结束 */
+                kp->click |= m;
+            }
         }
-        else
+
+        /* 阶段4: 持续按下检测长按，持续释放检测单击超时(电平正在变化的引脚等消抖结束) */
+        bits = ((kp->hold & kp->state) | (kp->click & ~kp->state)) & ~delta;
+        while (bits)
         {
-            /* 阶段2: 原始电平稳定,检查是否超过消抖时间 */
-            if (((int32_t)(now - last_change_ts[i])) >= KEY_DEBOUNCE_MS)
+            uint32_t pin = 31 - __CLZ(bits);
+            uint16_t m = (uint16_t)(1U << pin);
+            KEY_ID id = (KEY_ID)kp->id[pin];
+
+            bits &= ~m;
+            if (kp->state & m)
             {
-                /* 阶段3: 比较去抖后状态,检测边沿 */
-                if (pressed != stable_state[i])
-                {
-                    stable_state[i] = pressed;
-
-                    if (pressed)
-                    {
-                        /* 按下边沿 */
-                        press_ts[i] = now;
-                        long_reported[i] = 0;
-                        emit_event((KEY_ID)i, KEY_EV_PRESS);
-                    }
-                    else
-                    {
-                        /* 释放边沿 */
-                        release_ts[i] = now;
-                        emit_event((KEY_ID)i, KEY_EV_RELEASE);
-
-                        uint32_t held = (press_ts[i] ? (now - press_ts[i]) : 0);
-
-                        if (held < KEY_LONG_MS)
-                        {
-                            /* 短按: 检测单击/双击 */
-                            if (click_pending[i] && ((now - release_ts[i]) <= KEY_DBL_MS))
-                            {
-                                /* 双击窗口内的第二次释放 -> 双击 */
-                                click_pending[i] = 0;
-                                emit_event((KEY_ID)i, KEY_EV_DOUBLE_CLICK);
-                            }
-                            else
-                            {
-                                /* 标记单击待处理，等待双击窗口结束 */
-                                click_pending[i] = 1;
-                            }
-                        }
-                        else
-                        {
-                            /* 长按后释放,不当作点击 */
-                            click_pending[i] = 0;
-                        }
-                    }
-                }
-                else
+                if ((now - press_ts[id]) >= KEY_LONG_MS)
                 {
-                    /* 阶段4: 状态稳定,检测长按和双击超时 */
-                    if (stable_state[i])
-                    {
-                        /* 持续按下: 检测长按 */
-                        if (!long_reported[i] && press_ts[i] &&
-                            ((now - press_ts[i]) >= KEY_LONG_MS))
-                        {
-                            long_reported[i] = 1;
-                            emit_event((KEY_ID)i, KEY_EV_LONG_PRESS);
-                        }
-                    }
-                    else
-                    {
-                        /* 持续释放: 检测单击超时 */
-                        if (click_pending[i] && ((now - release_ts[i]) > KEY_DBL_MS))
-                        {
-                            click_pending[i] = 0;
-                            emit_event((KEY_ID)i, KEY_EV_CLICK);
-                        }
-                    }
+                    kp->hold &= ~m;
+                    emit_event(id, KEY_EV_LONG_PRESS);
                 }
             }
+            else if ((now - release_ts[id]) > KEY_DBL_MS)
+            {
+                kp->click &= ~m;
+                emit_event(id, KEY_EV_CLICK);
+            }
+        }
+    }
+}
+
+/**
+ * @brief  按键扫描任务（非阻塞，需周期调用）
+ * @note   轮询模式：建议在主循环或定时器中每5~20ms调用一次
+ * @note   中断模式：扫描在定时器中断中完成，这里只按顺序取出队列中的事件并调用回调
+ * @retval None
+ */
+void KEY_Task(void)
+{
+#ifdef KEY_EXTI_ENABLE
+    while (key_queue_tail != key_queue_head)
+    {
+        uint8_t tail = key_queue_tail;
+        KEY_QueueItem item = key_queue[tail];
+        uint32_t wait;
+
+        __DMB(); /* 读完队列项再释放位置 */
+        key_queue_tail = (uint8_t)((tail + 1) & (KEY_QUEUE_LEN - 1));
+        wait = DWT->CYCCNT - item.stamp;
+        key_latency.count++;
+        key_latency.total_cycles += wait;
+        if (wait > key_latency.max_cycles)
+            key_latency.max_cycles = wait;
+        if (item.id & KEY_ID_TOUCH)
+        {
+#ifdef LCD_RGB_TOUCH_ENABLE
+            Touch_Dispatch((uint8_t)(item.id & 0x0F), item.ev, item.x, item.y);
+#endif
+            continue;
         }
+        dispatch_event((KEY_ID)item.id, (KEY_Event)item.ev);
     }
+#else
+    KEY_Scan(GetTick());
+#endif
+}
+
+#ifdef KEY_EXTI_ENABLE
+/**
+ * @brief  所有按键是否都已空闲（释放、电平稳定、没有等待双击的单击）
+ * @retval 1=空闲，可停止扫描定时器
+ */
+static uint8_t KEY_AllIdle(void)
+{
+    for (uint32_t p = 0; p < key_port_count; ++p)
+    {
+        const KEY_Port *kp = &key_ports[p];
+
+        /* 计数为0说明最近一次采样与状态相同，即已回到空闲电平 */
+        if (kp->state | kp->click | kp->c0 | kp->c1 | kp->c2)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief  按键引脚对应的EXTI中断号
+ * @param  pin: 引脚掩码
+ * @retval 中断号
+ */
+static IRQn_Type KEY_EXTI_IRQn(uint16_t pin)
+{
+    uint32_t line = 0;
+
+    while (line < 15 && !(pin & (1U << line)))
+        line++;
+    if (line <= 4)
+        return (IRQn_Type)(EXTI0_IRQn + line);
+    if (line <= 9)
+        return EXTI9_5_IRQn;
+    return EXTI15_10_IRQn;
+}
+
+/**
+ * @brief  配置按键引脚为双边沿中断，配置扫描定时器
+ * @note   定时器计数频率10kHz，周期 KEY_SCAN_MS；APB1分频不为1时定时器时钟为PCLK1的2倍
+ * @retval None
+ */
+static void KEY_EXTI_Config(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+    uint32_t clk = HAL_RCC_GetPCLK1Freq();
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; /* 事件时间戳使用DWT周期计数器 */
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    key_exti_mask = 0;
+    for (int i = 0; i < KEY_COUNT; ++i)
+    {
+        key_exti_mask |= keys[i].pin; /* 先于EXTI中断使能，中断服务函数按它清除挂起位 */
+        gpio.Pin = keys[i].pin;
+        gpio.Mode = GPIO_MODE_IT_RISING_FALLING;
+        gpio.Pull = KEY_EXTI_PULL;
+        gpio.Speed = GPIO_SPEED_FREQ_LOW;
+        HAL_GPIO_Init(keys[i].port, &gpio);
+    }
+
+    __HAL_RCC_TIM6_CLK_ENABLE();
+    if ((RCC->D2CFGR & RCC_D2CFGR_D2PPRE1) != RCC_APB1_DIV1)
+        clk *= 2;
+    KEY_SCAN_TIM->CR1 = 0;
+    KEY_SCAN_TIM->PSC = clk / 10000 - 1;
+    KEY_SCAN_TIM->ARR = KEY_SCAN_MS * 10 - 1;
+    KEY_SCAN_TIM->EGR = TIM_EGR_UG; /* 装载PSC/ARR */
+    KEY_SCAN_TIM->SR = 0;
+    KEY_SCAN_TIM->DIER = TIM_DIER_UIE;
+    HAL_NVIC_SetPriority(KEY_SCAN_IRQn, KEY_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(KEY_SCAN_IRQn);
+
+    for (int i = 0; i < KEY_COUNT; ++i)
+    {
+        IRQn_Type irq = KEY_EXTI_IRQn(keys[i].pin);
+        __HAL_GPIO_EXTI_CLEAR_IT(keys[i].pin);
+        HAL_NVIC_SetPriority(irq, KEY_IRQ_PRIORITY, 0);
+        HAL_NVIC_EnableIRQ(irq);
+    }
+}
+
+/**
+ * @brief  启动扫描定时器（已在运行时不做任何事）
+ * @note   只在同优先级的EXTI中断、扫描中断或初始化中调用，与停止定时器不会交错
+ * @retval None
+ */
+static void KEY_ScanStart(void)
+{
+    if (key_scan_running)
+        return;
+    key_scan_running = 1;
+    KEY_SCAN_TIM->CNT = 0;
+    KEY_SCAN_TIM->CR1 = TIM_CR1_CEN;
+}
+
+/**
+ * @brief  EXTI中断服务入口
+ * @retval None
+ */
+void KEY_EXTI_IRQHandler(void)
+{
+    uint32_t pending = __HAL_GPIO_EXTI_GET_IT(key_exti_mask);
+
+    while (pending)
+    {
+        uint32_t line = 31 - __CLZ(pending);
+
+        pending &= ~(1U << line);
+        HAL_GPIO_EXTI_IRQHandler((uint16_t)(1U << line));
+    }
+}
+
+/**
+ * @brief  EXTI边沿处理
+ * @param  pin: 触发的引脚
+ * @note   边沿只用来唤醒扫描，电平在定时器中断中读取并消抖，抖动产生的多次边沿不会重复计数
+ * @retval None
+ */
+void KEY_EXTI_Handler(uint16_t pin)
+{
+    if (pin & key_exti_mask)
+        KEY_ScanStart();
+}
+
+/**
+ * @brief  扫描定时器中断服务入口
+ * @retval None
+ */
+void KEY_TIM_IRQHandler(void)
+{
+    uint32_t now = GetTick();
+
+    if (!(KEY_SCAN_TIM->SR & TIM_SR_UIF))
+        return;
+    KEY_SCAN_TIM->SR = ~TIM_SR_UIF;
+    KEY_Scan(now);
+    if (KEY_AllIdle())
+    {
+        KEY_SCAN_TIM->CR1 = 0;
+        key_scan_running = 0;
+    }
+}
+
+/**
+ * @brief  查询是否有待处理的按键事件或正在进行的扫描
+ * @retval 0=空闲，1=忙
+ */
+uint8_t KEY_IsBusy(void)
+{
+    return (key_queue_tail != key_queue_head) || key_scan_running;
+}
+
+/**
+ * @brief  读取事件延迟统计
+ * @param  st: 输出
+ * @retval None
+ */
+void KEY_GetLatency(KEY_LatencyStats *st)
+{
+    *st = key_latency;
+}
+
+/**
+ * @brief  清零事件延迟统计
+ * @retval None
+ */
+void KEY_ResetLatency(void)
+{
+    key_latency.count = 0;
+    key_latency.max_cycles = 0;
+    key_latency.total_cycles = 0;
 }
+#endif /* KEY_EXTI_ENABLE */
 
 #endif // KEY_ENABLE
@@ -11,9 +11,13 @@
  *    - name: 枚举名称(如 KEY1)
  *    - port: GPIO端口(如 GPIOA)
  *    - pin: GPIO引脚(如 GPIO_PIN_9)
- * 2. 初始化时自动检测按键极性(默认释放状态)
+ * 2. 初始化时自动检测按键极性(默认释放状态)，并按端口归并按键；扫描时每个端口只读一次IDR，
+ *    同一端口上的按键按位同时消抖，按键数增加不增加扫描耗时
  * 3. 在主循环或者定时器中断中周期调用 KEY_Task()
  * 4. 实现 KEY_EventHandler() 或使用回调注册
+ * 5. 定义 KEY_EXTI_ENABLE 后改为中断驱动：EXTI检测边沿并启动扫描定时器，定时器中断完成消抖和
+ *    事件识别，事件写入环形队列；KEY_Task() 只在主循环中取出事件并调用回调。所有按键空闲时定时器停止，
+ *    不占CPU；主循环被长时间绘图阻塞时事件在队列中等待，不会丢失
  *
  * 示例配置:
  * #define KEY_LIST \
@@ -52,6 +56,20 @@ extern "C"
 #define KEY_LIST \
     X(KEY1, GPIOA, GPIO_PIN_9)
 
+/**
+ * @brief 中断驱动扫描
+ * @note  各按键引脚不能共用EXTI线(不同端口的同号引脚)，EXTI中断服务函数在 stm32h7xx_it.c 中
+ * @note  扫描定时器只在有按键活动(消抖、按住、等待双击)时运行，间隔 KEY_SCAN_MS
+ */
+#define KEY_EXTI_ENABLE /*!< 定义了：EXTI+定时器扫描，事件经队列交给 KEY_Task(), 注释后：KEY_Task() 周期轮询 */
+#define KEY_EXTI_PULL GPIO_PULLUP /*!< 中断模式下按键引脚的上下拉 */
+#define KEY_SCAN_TIM TIM6 /*!< 扫描定时器，中断服务函数为 TIM6_DAC_IRQHandler */
+#define KEY_SCAN_IRQn TIM6_DAC_IRQn /*!< 扫描定时器中断号 */
+#define KEY_SCAN_MS 10 /*!< 按键活动期间的扫描间隔(毫秒) */
+#define KEY_IRQ_PRIORITY 14 /*!< EXTI与扫描定时器的中断优先级(两者相同，互不抢占) */
+#define KEY_QUEUE_LEN 32 /*!< 事件队列长度(2的幂)，满时丢弃新事件；触摸事件(LCD_RGB_TOUCH_ENABLE)共用此队列 */
+#define KEY_ID_TOUCH 0x80 /*!< 队列项ID的最高位：置1时为触摸事件，低4位为触点号，由 Touch_Dispatch() 分发 */
+
     /*******************************************************************************
      *                              按键导出类型
      ******************************************************************************/
@@ -96,6 +114,17 @@ extern "C"
      */
     typedef void (*KEY_Callback)(KEY_ID id, KEY_Event ev);
 
+    /**
+     * @brief  中断模式下的事件延迟统计
+     * @note   从扫描中断产生事件到 KEY_Task() 调用回调的CPU周期数(DWT计数)，反映主循环睡眠和任务阻塞带来的响应延迟
+     */
+    typedef struct
+    {
+        uint32_t count;        /*!< 已分发的事件数 */
+        uint32_t max_cycles;   /*!< 最大延迟 */
+        uint64_t total_cycles; /*!< 延迟总和，平均值 = total_cycles / count */
+    } KEY_LatencyStats;
+
     /*******************************************************************************
      *                              按键数组
      ******************************************************************************/
@@ -128,10 +157,64 @@ extern "C"
      * @brief  按键扫描任务（非阻塞）
      * @note   必须在主循环或定时器中周期调用，建议间隔5~20ms
      * @note   内部实现消抖、边沿检测、事件识别
+     * @note   定义 KEY_EXTI_ENABLE 时只取出中断中产生的事件并调用回调，可在主循环中任意间隔调用
      * @retval None
      */
     void KEY_Task(void);
 
+#ifdef KEY_EXTI_ENABLE
+    /**
+     * @brief  EXTI中断服务入口
+     * @note   由 stm32h7xx_it.c 中各EXTI中断服务函数调用，逐个清除按键引脚的挂起位
+     * @retval None
+     */
+    void KEY_EXTI_IRQHandler(void);
+
+    /**
+     * @brief  EXTI边沿处理
+     * @param  pin: 触发的引脚
+     * @note   由 HAL_GPIO_EXTI_Callback() 调用，启动扫描定时器
+     * @retval None
+     */
+    void KEY_EXTI_Handler(uint16_t pin);
+
+    /**
+     * @brief  扫描定时器中断服务入口
+     * @note   由 TIM6_DAC_IRQHandler() 调用，执行一次消抖与事件识别，按键全部空闲时停止定时器
+     * @retval None
+     */
+    void KEY_TIM_IRQHandler(void);
+
+    /**
+     * @brief  查询是否有待处理的按键事件或正在进行的扫描
+     * @retval 0=空闲，1=有事件待 KEY_Task() 处理或定时器在运行
+     */
+    uint8_t KEY_IsBusy(void);
+
+    /**
+     * @brief  读取事件延迟统计
+     * @param  st: 输出
+     * @retval None
+     */
+    void KEY_GetLatency(KEY_LatencyStats *st);
+
+    /**
+     * @brief  清零事件延迟统计
+     * @retval None
+     */
+    void KEY_ResetLatency(void);
+
+    /**
+     * @brief  向事件队列写入一项(其他输入源使用)
+     * @param  id: KEY_ID_TOUCH | 触点号
+     * @param  ev: 事件类型，由输入源定义
+     * @param  x、y: 事件参数(触摸为坐标)
+     * @note   只能在优先级等于 KEY_IRQ_PRIORITY 的中断中调用，与扫描中断互不抢占，队列仍只有一个生产者
+     * @retval 1-已写入，0-队列满已丢弃
+     */
+    uint8_t KEY_Post(uint8_t id, uint8_t ev, uint16_t x, uint16_t y);
+#endif /* KEY_EXTI_ENABLE */
+
     /*******************************************************************************
      *                              辅助功能函数
      ******************************************************************************/
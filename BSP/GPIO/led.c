@@ -7,12 +7,15 @@
  * @attention
  *
  * 本文件实现：
- * - LED基本控制（开/关/切换,单个/全部）
+ * - LED基本控制（开/关/切换,单个/全部）：全部LED的操作按端口合成BSRR字，每个端口一次写入，
+ *   同一端口上的LED在同一时刻变化
  * - LED动画效果（闪烁/呼吸/流水，阻塞实现）
+ * - LED动画效果（闪烁/呼吸/流水，非阻塞实现，由 LED_Task() 推进）
+ * - 硬件波形闪烁/呼吸（LED_HW_ENABLE，TIM1事件触发DMA写BSRR，不占CPU）
  *
  * 注意事项：
- * - 动画函数使用HAL_Delay阻塞，适用于简单应用
- * - 若需非阻塞动画，建议使用状态机+定时器驱动
+ * - 阻塞动画函数使用HAL_Delay，调用期间按键扫描和刷屏都停止，只适用于简单应用
+ * - 主循环中使用 LED_Effect_*()，效果状态只有起始时刻和参数，亮灭由系统节拍算出
  *
  ******************************************************************************
  */
@@ -24,7 +27,57 @@
 /* Private defines -----------------------------------------------------------*/
 #define BREATHE_STEPS 100 /*!< 呼吸效果的PWM分段数 */
 
+/* Private types -------------------------------------------------------------*/
+/**
+ * @brief  一个GPIO端口上全部LED的引脚，每个位对应一个引脚
+ */
+typedef struct
+{
+    GPIO_TypeDef *port; /*!< GPIO端口 */
+    uint16_t pins;      /*!< 本端口上的LED引脚 */
+    uint16_t high;      /*!< 高电平点亮的引脚 */
+} LED_Port;
+
 /* Private variables ---------------------------------------------------------*/
+static LED_Port led_ports[LED_COUNT]; /*!< LED所在的端口，LED_Init() 按 LED_LIST 生成，最多每个LED一个端口 */
+static uint8_t led_port_count = 0;    /*!< 实际端口数 */
+static LED_Effect led_effect = LED_EFFECT_NONE; /*!< 当前非阻塞效果 */
+static uint32_t led_effect_period = 0;          /*!< 效果周期（闪烁/呼吸）或单步时间（流水） */
+static uint32_t led_effect_start = 0;           /*!< 效果开始时的系统节拍 */
+
+#ifdef LED_HW_ENABLE
+#define LED_HW_LEVELS 256  /*!< PWM周期的计数值(ARR+1)，CCR1取该值时比较不发生，保持点亮 */
+#define LED_HW_STEPS 128   /*!< 呼吸伽马表长度(上坡64 + 下坡64) */
+#define LED_HW_REP_MAX 65536 /*!< 重复计数器上限(RCR为16位) */
+
+/**
+ * @brief  呼吸亮度表(伽马2.2，0~256)，DMA在每次更新事件写入CCR1
+ * @note   按32位存放，DMA源和目标宽度一致，不需要FIFO打包
+ */
+static const uint32_t led_hw_breathe[LED_HW_STEPS] = {
+    0, 0, 0, 0, 1, 1, 1, 2, 3, 4, 4, 6, 7, 8, 9, 11,
+    13, 14, 16, 18, 21, 23, 25, 28, 31, 34, 37, 40, 43, 46, 50, 54,
+    58, 62, 66, 70, 75, 79, 84, 89, 94, 99, 105, 110, 116, 122, 128, 134,
+    141, 147, 154, 161, 168, 175, 182, 190, 198, 205, 213, 222, 230, 238, 247, 256,
+    256, 247, 238, 230, 222, 213, 205, 198, 190, 182, 175, 168, 161, 154, 147, 141,
+    134, 128, 122, 116, 110, 105, 99, 94, 89, 84, 79, 75, 70, 66, 62, 58,
+    54, 50, 46, 43, 40, 37, 34, 31, 28, 25, 23, 21, 18, 16, 14, 13,
+    11, 9, 8, 7, 6, 4, 4, 3, 2, 1, 1, 1, 0, 0, 0, 0};
+
+/**
+ * @brief  闪烁亮度表：全亮半周期、全灭半周期
+ */
+static const uint32_t led_hw_blink[2] = {LED_HW_LEVELS, 0};
+
+/**
+ * @brief  写入BSRR的点亮字[0]和熄灭字[1]，由 LED_LIST 中位于 LED_HW_PORT 的LED的极性算出
+ */
+static uint32_t led_hw_word[8] LED_HW_RAM_ATTR __attribute__((aligned(32)));
+
+static DMA_HandleTypeDef led_hw_dma[3]; /*!< 更新事件/CH1比较/CH2比较 三个DMA句柄 */
+static uint8_t led_hw_running = 0;      /*!< 硬件波形是否在运行 */
+#endif /* LED_HW_ENABLE */
+
 /** @defgroup LED_Private_Variables LED数组定义
  * @{
  */
@@ -41,16 +94,47 @@ LED leds[] = {
  * @}
  */
 
+/**
+ * @brief  端口上指定引脚点亮、其余LED熄灭时的BSRR字
+ * @param  p: 端口
+ * @param  lit: 要点亮的引脚
+ * @retval BSRR字：低16位置位，高16位复位
+ * @note   点亮即电平与高电平点亮的引脚一致，lit ^ high 为需要输出低电平的引脚
+ */
+static uint32_t LED_Port_Word(const LED_Port *p, uint16_t lit)
+{
+    uint16_t low = (uint16_t)((lit ^ p->high) & p->pins);
+
+    return (uint32_t)(p->pins & ~low) | ((uint32_t)low << 16);
+}
+
 /**
  * @brief  初始化所有LED（关闭状态）
+ * @note   按端口归并 LED_LIST，之后全部LED的操作每个端口只写一次BSRR
  * @retval None
  */
 void LED_Init(void)
 {
+    led_port_count = 0;
     for (int i = 0; i < LED_COUNT; ++i)
     {
-        LED_Off(&leds[i]);
+        LED_Port *p = led_ports;
+        LED_Port *end = led_ports + led_port_count;
+
+        while (p < end && p->port != leds[i].port)
+            p++;
+        if (p == end)
+        {
+            p->port = leds[i].port;
+            p->pins = 0;
+            p->high = 0;
+            led_port_count++;
+        }
+        p->pins |= leds[i].pin;
+        if (leds[i].direct)
+            p->high |= leds[i].pin;
     }
+    LED_Off_All();
 }
 
 /**
@@ -101,9 +185,9 @@ void LED_Toggle(LED *led)
  */
 void LED_On_All(void)
 {
-    for (int i = 0; i < LED_COUNT; ++i)
+    for (uint32_t i = 0; i < led_port_count; ++i)
     {
-        LED_On(&leds[i]);
+        led_ports[i].port->BSRR = LED_Port_Word(&led_ports[i], led_ports[i].pins);
     }
 }
 
@@ -113,9 +197,9 @@ void LED_On_All(void)
  */
 void LED_Off_All(void)
 {
-    for (int i = 0; i < LED_COUNT; ++i)
+    for (uint32_t i = 0; i < led_port_count; ++i)
     {
-        LED_Off(&leds[i]);
+        led_ports[i].port->BSRR = LED_Port_Word(&led_ports[i], 0);
     }
 }
 
@@ -125,9 +209,13 @@ void LED_Off_All(void)
  */
 void LED_Toggle_All(void)
 {
-    for (int i = 0; i < LED_COUNT; ++i)
+    for (uint32_t i = 0; i < led_port_count; ++i)
     {
-        LED_Toggle(&leds[i]);
+        const LED_Port *p = &led_ports[i];
+        uint32_t odr = p->port->ODR;
+
+        /* 与 HAL_GPIO_TogglePin() 相同：原来为高的复位、为低的置位 */
+        p->port->BSRR = ((odr & p->pins) << 16) | (~odr & p->pins);
     }
 }
 
@@ -294,4 +382,249 @@ void LED_ChaseStart(uint32_t step_ms)
     }
 }
 
+/* Animation functions (non-blocking) ----------------------------------------*/
+
+#ifdef LED_HW_ENABLE
+/**
+ * @brief  停止硬件波形：关定时器、中止三个DMA流
+ * @retval None
+ */
+static void LED_HW_Stop(void)
+{
+    if (!led_hw_running)
+        return;
+    TIM1->CR1 &= ~TIM_CR1_CEN;
+    TIM1->DIER = 0;
+    for (int i = 0; i < 3; i++)
+        HAL_DMA_Abort(&led_hw_dma[i]);
+    led_hw_running = 0;
+}
+
+/**
+ * @brief  初始化一个循环模式、存储器到外设的32位DMA流
+ * @param  hdma: 句柄
+ * @param  stream: DMA流
+ * @param  request: DMAMUX请求号
+ * @param  mem_inc: 存储器地址是否递增
+ * @param  priority: 优先级，同时到来的点亮/熄灭请求按优先级先后执行
+ * @retval HAL_OK 成功
+ */
+static HAL_StatusTypeDef LED_HW_DmaInit(DMA_HandleTypeDef *hdma, DMA_Stream_TypeDef *stream,
+                                        uint32_t request, uint8_t mem_inc, uint32_t priority)
+{
+    hdma->Instance = stream;
+    hdma->Init.Request = request;
+    hdma->Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma->Init.MemInc = mem_inc ? DMA_MINC_ENABLE : DMA_MINC_DISABLE;
+    hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma->Init.Mode = DMA_CIRCULAR;
+    hdma->Init.Priority = priority;
+    hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    return HAL_DMA_Init(hdma);
+}
+
+/**
+ * @brief  启动硬件波形
+ * @param  table: 亮度表(0~LED_HW_LEVELS)，循环写入CCR1
+ * @param  steps: 亮度表长度
+ * @param  period_ms: 整个亮度表播放一遍的时间（毫秒）
+ * @note   CCR1/CCR2开预装载，DMA在更新事件写入的亮度从下一个重复周期开始生效，不会在PWM周期中途改变
+ * @note   亮度为0时点亮与熄灭在同一计数值发生，点亮流优先级更高先执行，随后立即熄灭
+ * @retval HAL_OK 成功；LED_HW_PORT 上没有LED或DMA初始化失败时返回错误，调用者改用软件效果
+ */
+static HAL_StatusTypeDef LED_HW_Start(const uint32_t *table, uint32_t steps, uint32_t period_ms)
+{
+    const LED_Port *p = led_ports;
+    const LED_Port *end = led_ports + led_port_count;
+    uint32_t clk, psc, rep;
+
+    while (p < end && p->port != LED_HW_PORT)
+        p++;
+    if (p == end)
+        return HAL_ERROR;
+    led_hw_word[0] = LED_Port_Word(p, p->pins);
+    led_hw_word[1] = LED_Port_Word(p, 0);
+    SCB_CleanDCache_by_Addr(led_hw_word, sizeof(led_hw_word)); // DMA从SRAM读取，先写回Cache
+
+    /* APB2分频不为1时定时器时钟为PCLK2的2倍 */
+    clk = HAL_RCC_GetPCLK2Freq();
+    if ((RCC->D2CFGR & RCC_D2CFGR_D2PPRE2) != RCC_APB2_DIV1)
+        clk *= 2;
+    psc = clk / (LED_HW_LEVELS * LED_HW_PWM_HZ);
+    if (psc == 0)
+        psc = 1;
+    rep = (uint32_t)(((uint64_t)period_ms * LED_HW_PWM_HZ) / (1000U * steps));
+    if (rep == 0)
+        rep = 1;
+    if (rep > LED_HW_REP_MAX)
+        rep = LED_HW_REP_MAX;
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    __HAL_RCC_TIM1_CLK_ENABLE();
+    if (LED_HW_DmaInit(&led_hw_dma[0], LED_HW_DMA_UP, DMA_REQUEST_TIM1_UP, 1, DMA_PRIORITY_MEDIUM) != HAL_OK ||
+        LED_HW_DmaInit(&led_hw_dma[1], LED_HW_DMA_OFF, DMA_REQUEST_TIM1_CH1, 0, DMA_PRIORITY_HIGH) != HAL_OK ||
+        LED_HW_DmaInit(&led_hw_dma[2], LED_HW_DMA_ON, DMA_REQUEST_TIM1_CH2, 0, DMA_PRIORITY_VERY_HIGH) != HAL_OK)
+        return HAL_ERROR;
+
+    TIM1->CR1 = 0;
+    TIM1->DIER = 0;
+    TIM1->PSC = psc - 1;
+    TIM1->ARR = LED_HW_LEVELS - 1;
+    TIM1->RCR = rep - 1;
+    TIM1->CCMR1 = TIM_CCMR1_OC1PE | TIM_CCMR1_OC2PE; /* 冻结模式，只产生比较事件，不驱动引脚 */
+    TIM1->CCR1 = table[0];
+    TIM1->CCR2 = 0;
+    TIM1->EGR = TIM_EGR_UG; /* 装载PSC/ARR/RCR/CCR，此时DMA请求尚未打开 */
+    TIM1->SR = 0;
+
+    /* 第一次更新事件写入的 table[0] 在第二次更新时生效，整体滞后一个台阶，循环播放时无影响 */
+    HAL_DMA_Start(&led_hw_dma[0], (uint32_t)table, (uint32_t)&TIM1->CCR1, steps);
+    HAL_DMA_Start(&led_hw_dma[1], (uint32_t)&led_hw_word[1], (uint32_t)&LED_HW_PORT->BSRR, 1);
+    HAL_DMA_Start(&led_hw_dma[2], (uint32_t)&led_hw_word[0], (uint32_t)&LED_HW_PORT->BSRR, 1);
+
+    TIM1->DIER = TIM_DIER_UDE | TIM_DIER_CC1DE | TIM_DIER_CC2DE;
+    TIM1->CR1 = TIM_CR1_ARPE | TIM_CR1_CEN;
+    led_hw_running = 1;
+    return HAL_OK;
+}
+#endif /* LED_HW_ENABLE */
+
+/**
+ * @brief  按软件效果设置LED，跳过由硬件波形驱动的LED
+ * @param  on: 1=点亮，0=熄灭
+ * @retval None
+ */
+static void LED_Soft_Set(uint8_t on)
+{
+    for (uint32_t i = 0; i < led_port_count; i++)
+    {
+        const LED_Port *p = &led_ports[i];
+
+#ifdef LED_HW_ENABLE
+        if (led_hw_running && p->port == LED_HW_PORT)
+            continue;
+#endif
+        p->port->BSRR = LED_Port_Word(p, on ? p->pins : 0);
+    }
+}
+
+/**
+ * @brief  切换非阻塞效果，从周期起点开始
+ * @param  effect: 效果
+ * @param  period_ms: 周期或单步时间（毫秒），为0时停止效果
+ * @retval None
+ */
+static void LED_Effect_Set(LED_Effect effect, uint32_t period_ms)
+{
+    if (period_ms == 0)
+        effect = LED_EFFECT_NONE;
+#ifdef LED_HW_ENABLE
+    LED_HW_Stop();
+#endif
+    led_effect = effect;
+    led_effect_period = period_ms;
+    led_effect_start = GetTick();
+    LED_Off_All();
+#ifdef LED_HW_ENABLE
+    if (effect == LED_EFFECT_BLINK)
+        LED_HW_Start(led_hw_blink, 2, period_ms);
+    else if (effect == LED_EFFECT_BREATHE)
+        LED_HW_Start(led_hw_breathe, LED_HW_STEPS, period_ms);
+#endif
+    LED_Task(); /* 立即按起点状态输出 */
+}
+
+/**
+ * @brief  开始所有LED同步闪烁（非阻塞）
+ * @param  period_ms: 闪烁周期（毫秒）
+ * @retval None
+ */
+void LED_Effect_Blink(uint32_t period_ms)
+{
+    LED_Effect_Set(LED_EFFECT_BLINK, period_ms);
+}
+
+/**
+ * @brief  开始所有LED同步呼吸（非阻塞）
+ * @param  period_ms: 呼吸总周期（毫秒），从暗到亮再到暗
+ * @retval None
+ */
+void LED_Effect_Breathe(uint32_t period_ms)
+{
+    LED_Effect_Set(LED_EFFECT_BREATHE, (period_ms < 2) ? 0 : period_ms);
+}
+
+/**
+ * @brief  开始流水灯（非阻塞）
+ * @param  step_ms: 单步停留时间（毫秒）
+ * @retval None
+ */
+void LED_Effect_Chase(uint32_t step_ms)
+{
+    LED_Effect_Set(LED_EFFECT_CHASE, step_ms);
+}
+
+/**
+ * @brief  停止动画效果并熄灭所有LED
+ * @retval None
+ */
+void LED_Effect_Stop(void)
+{
+    LED_Effect_Set(LED_EFFECT_NONE, 0);
+}
+
+/**
+ * @brief  读取当前动画效果
+ * @retval 当前效果
+ */
+LED_Effect LED_Effect_Get(void)
+{
+    return led_effect;
+}
+
+/**
+ * @brief  动画效果周期任务（非阻塞）
+ * @note   亮灭只由 (GetTick() - 起始节拍) 决定，调用间隔抖动或偶尔漏调用不会累积误差
+ * @note   呼吸按三角波计算占空比，每个 LED_PWM_FRAME_MS 周期内前 duty 毫秒点亮
+ * @note   硬件波形运行时 LED_HW_PORT 上的LED不在这里改写
+ * @retval None
+ */
+void LED_Task(void)
+{
+    uint32_t t = GetTick() - led_effect_start;
+    uint32_t phase, level;
+
+    switch (led_effect)
+    {
+    case LED_EFFECT_BLINK:
+        LED_Soft_Set((t % led_effect_period) < led_effect_period / 2);
+        break;
+
+    case LED_EFFECT_BREATHE:
+        /* 三角波：0 -> LED_PWM_FRAME_MS -> 0，按半周期线性变化 */
+        phase = t % led_effect_period;
+        if (phase >= led_effect_period / 2)
+            phase = led_effect_period - phase;
+        level = (uint32_t)(((uint64_t)phase * 2 * LED_PWM_FRAME_MS + led_effect_period / 2) / led_effect_period);
+        LED_Soft_Set((t % LED_PWM_FRAME_MS) < level);
+        break;
+
+    case LED_EFFECT_CHASE:
+        /* 每个端口一次写入：当前LED点亮，其余熄灭，换步时前后两个LED同时变化 */
+        phase = (t / led_effect_period) % LED_COUNT;
+        for (uint32_t i = 0; i < led_port_count; i++)
+        {
+            const LED_Port *p = &led_ports[i];
+
+            p->port->BSRR = LED_Port_Word(p, p->port == leds[phase].port ? leds[phase].pin : 0);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
 #endif // LED_ENABLE
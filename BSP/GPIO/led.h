@@ -15,6 +15,10 @@
  * 2. 编译后自动生成 leds[] 数组和 LED_ID 枚举
  * 3. 基本控制：LED_On/Off/Toggle(&leds[LD1])
  * 4. 动画效果（阻塞）：LED_Blink / LED_Breathe / LED_ChaseStart
+ * 5. 动画效果（非阻塞）：LED_Effect_Blink / LED_Effect_Breathe / LED_Effect_Chase 设置效果后立即返回，
+ *    由调度器每 SCHED_LED_MS 调用一次的 LED_Task() 按系统节拍推进
+ * 6. 定义 LED_HW_ENABLE 后，闪烁/呼吸由TIM1+DMA直接写GPIO的BSRR寄存器产生（不占CPU），
+ *    作用于 LED_HW_PORT 上的LED；其他端口的LED和流水灯仍由 LED_Task() 驱动
  *
  * 示例配置：
  * #define LED_LIST \
@@ -41,6 +45,24 @@ extern "C"
 #define LED_LIST \
     X(LD1, GPIOC, GPIO_PIN_13, 0)
 
+#define LED_PWM_FRAME_MS 10 /*!< 非阻塞呼吸效果的软件PWM周期(毫秒)，亮度分 N+1 级，LED_Task() 需每1ms调用 */
+
+/**
+ * @brief 硬件波形闪烁/呼吸
+ * @note  PC13等引脚没有定时器通道，因此不用TIM输出比较，而由定时器事件触发DMA写BSRR：
+ *        CH2比较(计数0)写"点亮"字，CH1比较(计数=亮度)写"熄灭"字，更新事件从伽马表取下一个亮度写入CCR1
+ * @note  定时器不连接引脚，比较事件照常产生DMA请求；重复计数器让每个亮度保持若干个PWM周期
+ * @note  三个DMA流工作在循环模式，启动后不需要中断和CPU参与；数据源为Flash中的常量表和AXI SRAM中的两个字
+ * @note  TIM1和下面三个DMA1流由本驱动独占
+ */
+#define LED_HW_ENABLE /*!< 定义了：LED_Effect_Blink/Breathe 使用TIM1+DMA硬件波形, 注释后：LED_Task() 软件PWM */
+#define LED_HW_PORT GPIOC /*!< 硬件波形驱动的GPIO端口，LED_LIST中位于该端口的LED全部参与 */
+#define LED_HW_PWM_HZ 1000 /*!< 硬件PWM频率(Hz)，亮度256级，闪烁/呼吸周期按 1000/LED_HW_PWM_HZ 毫秒的PWM周期计数 */
+#define LED_HW_DMA_UP DMA1_Stream5 /*!< TIM1更新事件：伽马表 -> TIM1->CCR1 */
+#define LED_HW_DMA_OFF DMA1_Stream6 /*!< TIM1 CH1比较：熄灭字 -> BSRR */
+#define LED_HW_DMA_ON DMA1_Stream7 /*!< TIM1 CH2比较：点亮字 -> BSRR */
+#define LED_HW_RAM_ATTR AXI_SRAM_AT(0x2407FFE0) /*!< BSRR字放在AXI SRAM末尾(一个Cache行)，DMA1不能访问DTCM */
+
     /** @defgroup LED_Exported_Types LED导出类型
      * @{
      */
@@ -55,6 +77,17 @@ extern "C"
         uint8_t direct;     /*!< 点亮极性：1=高电平亮，0=低电平亮 */
     } LED;
 
+    /**
+     * @brief  非阻塞动画效果
+     */
+    typedef enum
+    {
+        LED_EFFECT_NONE = 0, /*!< 无效果，LED保持当前状态 */
+        LED_EFFECT_BLINK,    /*!< 所有LED同步闪烁 */
+        LED_EFFECT_BREATHE,  /*!< 所有LED同步呼吸 */
+        LED_EFFECT_CHASE     /*!< 流水灯 */
+    } LED_Effect;
+
 /**
  * @brief  LED枚举ID（自动生成）
  */
@@ -132,6 +165,53 @@ extern "C"
      */
     void LED_ChaseStart(uint32_t step_ms);
 
+    /** @defgroup LED_Effect_Functions 动画效果函数（非阻塞实现）
+     * @brief 设置效果后立即返回，由 LED_Task() 按系统节拍推进，不占用主循环
+     * @{
+     */
+
+    /**
+     * @brief  开始所有LED同步闪烁（非阻塞）
+     * @param  period_ms: 闪烁周期（毫秒），前半周期亮、后半周期灭
+     * @retval None
+     */
+    void LED_Effect_Blink(uint32_t period_ms);
+
+    /**
+     * @brief  开始所有LED同步呼吸（非阻塞）
+     * @param  period_ms: 呼吸总周期（毫秒），从暗到亮再到暗
+     * @note   软件PWM周期为 LED_PWM_FRAME_MS，亮度按1ms分级
+     * @note   定义 LED_HW_ENABLE 时亮度按伽马表分256级，周期按128个亮度台阶取整
+     * @retval None
+     */
+    void LED_Effect_Breathe(uint32_t period_ms);
+
+    /**
+     * @brief  开始流水灯（非阻塞）
+     * @param  step_ms: 单步停留时间（毫秒），依次点亮leds[]中的每个LED并循环
+     * @retval None
+     */
+    void LED_Effect_Chase(uint32_t step_ms);
+
+    /**
+     * @brief  停止动画效果并熄灭所有LED
+     * @retval None
+     */
+    void LED_Effect_Stop(void);
+
+    /**
+     * @brief  读取当前动画效果
+     * @retval 当前效果，见 LED_Effect
+     */
+    LED_Effect LED_Effect_Get(void);
+
+    /**
+     * @brief  动画效果周期任务（非阻塞）
+     * @note   由 init.c 中的调度器每 SCHED_LED_MS 调用，只按 GetTick() 计算应有的亮灭状态
+     * @retval None
+     */
+    void LED_Task(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,343 @@
+/**
+ ******************************************************************************
+ * @file    lcd_jpeg.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   硬件JPEG解码显示实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * MCU数据格式(JPEG编解码器输出，每字节一个样本，8x8块内逐行存放)：
+ * - 灰度      8x8，  64字节：Y
+ * - 4:4:4     8x8， 192字节：Y, Cb, Cr 各一块
+ * - 4:2:2    16x8， 256字节：Y 左右两块, Cb, Cr
+ * - 4:2:0   16x16， 384字节：Y 左上/右上/左下/右下四块, Cb, Cr
+ *
+ * 解码器按光栅顺序逐个输出MCU；同一MCU行中相邻的MCU转换到同一个渲染缓冲区，
+ * 拼成 (n x MCU宽) x MCU高 的矩形后调用一次 LCD_DrawImage565()，
+ * BDMA发送这一块时CPU继续转换下一块
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#if defined(LCD_JPEG_ENABLE) && defined(LCD_SPI_ENABLE)
+#include <string.h>
+
+#define LCD_JPEG_MCU_MAX 384 /*!< 最大MCU字节数(4:2:0) */
+#define LCD_JPEG_OUT_SIZE (LCD_JPEG_OUT_MCUS * LCD_JPEG_MCU_MAX) /*!< 输出缓冲区字节数 */
+
+#if LCD_BUFF_PIXELS < 256
+#error "LCD_BUFF_PIXELS 至少要容纳一个4:2:0 MCU(16x16)"
+#endif
+
+/**
+ * @brief  解码过程状态，由HAL回调更新
+ */
+typedef struct
+{
+    const uint8_t *pData; /*!< 输入数据首地址 */
+    uint16_t *pBuff;      /*!< 正在填充的渲染缓冲区，NULL表示还没有开始 */
+    uint32_t mcu;         /*!< 已转换的MCU数 */
+    uint32_t mcu_total;   /*!< 图片的MCU总数 */
+    uint16_t x, y;        /*!< 显示坐标 */
+    uint16_t width;       /*!< 图片宽度 */
+    uint16_t height;      /*!< 图片高度 */
+    uint16_t cols;        /*!< 每个MCU行的MCU数 */
+    uint16_t mcu_bytes;   /*!< 每个MCU的字节数 */
+    uint16_t c0;          /*!< 当前矩形的起始MCU列 */
+    uint16_t cw;          /*!< 当前矩形的宽度(像素) */
+    uint8_t vh;           /*!< 当前矩形的高度(像素) */
+    uint8_t left;         /*!< 当前矩形还差的MCU数 */
+    uint8_t cap;          /*!< 一个渲染缓冲区容纳的MCU数 */
+    uint8_t mw, mh;       /*!< MCU宽高 */
+    uint8_t hsh, vsh;     /*!< 色度水平/垂直抽样的移位数(0或1) */
+    uint8_t gray;         /*!< 1-灰度图 */
+    uint8_t unsupported;  /*!< 1-颜色空间不支持，只解码不显示 */
+} LCD_JPEG_State_t;
+
+static JPEG_HandleTypeDef hjpeg;      /*!< JPEG编解码器句柄 */
+static uint8_t LCD_JPEG_Inited = 0;   /*!< 解码器已初始化 */
+static LCD_JPEG_State_t LCD_JPEG_St; /*!< 当前解码状态 */
+DTCM_BSS static uint32_t LCD_JPEG_Out[LCD_JPEG_OUT_SIZE / 4]; /*!< MCU输出缓冲区，只有CPU读写 */
+
+/**
+ * @brief  使能时钟并初始化解码器，只执行一次
+ */
+static int8_t LCD_JPEG_Init(void)
+{
+    if (LCD_JPEG_Inited)
+    {
+        return 0;
+    }
+    __HAL_RCC_JPGDECEN_CLK_ENABLE();
+
+    hjpeg.Instance = JPEG;
+    if (HAL_JPEG_Init(&hjpeg) != HAL_OK)
+    {
+        return -1;
+    }
+    LCD_JPEG_Inited = 1;
+    return 0;
+}
+
+/**
+ * @brief  YCbCr 转 RGB565(JFIF全范围)，Q16定点
+ */
+#define LCD_JPEG_RGB565(Y, rd, gd, bd)                                      \
+    (uint16_t)(((__USAT((Y) + (rd), 8) & 0xF8) << 8) |                      \
+               ((__USAT((Y) + (gd), 8) & 0xFC) << 3) | (__USAT((Y) + (bd), 8) >> 3))
+
+/**
+ * @brief  把一个MCU转换为RGB565，写入渲染缓冲区
+ * @param  pDst: 目标左上角
+ * @param  stride: 目标每行像素数
+ * @param  pMcu: MCU数据
+ * @param  w, h: 可见部分的宽高(图片右边、下边不足一个MCU时小于MCU宽高)
+ */
+ITCM_CODE static void LCD_JPEG_Convert(uint16_t *pDst, uint16_t stride, const uint8_t *pMcu, uint8_t w, uint8_t h)
+{
+    const LCD_JPEG_State_t *s = &LCD_JPEG_St;
+    const uint8_t *pCb = pMcu + s->mw * s->mh;
+    const uint8_t *pCr = pCb + 64;
+    int32_t rd[8], gd[8], bd[8]; // 当前色度行每个样本的 R/G/B 增量
+    uint8_t blocks = s->mw >> 3; // 每行Y块数
+
+    if (s->gray)
+    {
+        for (uint8_t r = 0; r < h; r++, pDst += stride)
+        {
+            for (uint8_t c = 0; c < w; c++)
+            {
+                uint8_t v = pMcu[r * 8 + c];
+                pDst[c] = (uint16_t)(((v & 0xF8) << 8) | ((v & 0xFC) << 3) | (v >> 3));
+            }
+        }
+        return;
+    }
+
+    for (uint8_t r = 0; r < h; r++, pDst += stride)
+    {
+        const uint8_t *pY = pMcu + ((r >> 3) * blocks) * 64 + (r & 7) * 8;
+
+        if ((r & ((1U << s->vsh) - 1U)) == 0)
+        {
+            // 每个色度行只算一次色度项，4:2:0 时上下两行共用
+            uint8_t k = (uint8_t)((r >> s->vsh) * 8);
+            uint8_t n = (uint8_t)((w + (1U << s->hsh) - 1U) >> s->hsh);
+
+            for (uint8_t i = 0; i < n; i++)
+            {
+                int32_t cb = (int32_t)pCb[k + i] - 128;
+                int32_t cr = (int32_t)pCr[k + i] - 128;
+
+                rd[i] = (91881 * cr + 32768) >> 16;
+                gd[i] = (32768 - 22554 * cb - 46802 * cr) >> 16;
+                bd[i] = (116130 * cb + 32768) >> 16;
+            }
+        }
+        for (uint8_t c = 0; c < w; c++)
+        {
+            int32_t yv = pY[((c >> 3) * 64) + (c & 7)];
+            uint8_t i = (uint8_t)(c >> s->hsh);
+
+            pDst[c] = LCD_JPEG_RGB565(yv, rd[i], gd[i], bd[i]);
+        }
+    }
+}
+
+/**
+ * @brief  处理解码器输出的一个MCU：转换到当前矩形，矩形拼满后发送
+ */
+static void LCD_JPEG_PutMcu(const uint8_t *pMcu)
+{
+    LCD_JPEG_State_t *s = &LCD_JPEG_St;
+    uint16_t row, col, ofs;
+
+    if (s->mcu >= s->mcu_total)
+    {
+        return;
+    }
+    row = (uint16_t)(s->mcu / s->cols);
+    col = (uint16_t)(s->mcu % s->cols);
+    s->mcu++;
+
+    if (s->pBuff == NULL)
+    {
+        // 从这个MCU开始一个新矩形，不跨MCU行
+        uint16_t n = s->cols - col;
+        uint32_t w;
+
+        if (n > s->cap)
+        {
+            n = s->cap;
+        }
+        w = (uint32_t)n * s->mw;
+        if (w > (uint32_t)(s->width - col * s->mw))
+        {
+            w = s->width - col * s->mw;
+        }
+        s->c0 = col;
+        s->cw = (uint16_t)w;
+        s->vh = (uint8_t)((s->height - row * s->mh < s->mh) ? s->height - row * s->mh : s->mh);
+        s->left = (uint8_t)n;
+        s->pBuff = LCD_GetBuff(); // 另一个缓冲区可能仍在发送，不用等待
+    }
+
+    ofs = (uint16_t)((col - s->c0) * s->mw);
+    LCD_JPEG_Convert(s->pBuff + ofs, s->cw, pMcu, (uint8_t)((s->cw - ofs < s->mw) ? s->cw - ofs : s->mw), s->vh);
+
+    if (--s->left == 0)
+    {
+        LCD_DrawImage565(s->x + s->c0 * s->mw, s->y + row * s->mh, s->cw, s->vh, s->pBuff);
+        s->pBuff = NULL;
+    }
+}
+
+/**
+ * @brief  帧头解析完成：确定MCU格式，按MCU大小重新设置输出缓冲区长度
+ */
+void LCD_JPEG_InfoHandler(JPEG_HandleTypeDef *hjpeg, JPEG_ConfTypeDef *pInfo)
+{
+    LCD_JPEG_State_t *s = &LCD_JPEG_St;
+    uint16_t rows;
+
+    s->width = (uint16_t)pInfo->ImageWidth;
+    s->height = (uint16_t)pInfo->ImageHeight;
+    s->mw = 8;
+    s->mh = 8;
+    s->hsh = 0;
+    s->vsh = 0;
+
+    if (pInfo->ColorSpace == JPEG_GRAYSCALE_COLORSPACE)
+    {
+        s->gray = 1;
+        s->mcu_bytes = 64;
+    }
+    else if (pInfo->ColorSpace == JPEG_YCBCR_COLORSPACE)
+    {
+        if (pInfo->ChromaSubsampling == JPEG_420_SUBSAMPLING)
+        {
+            s->mw = 16;
+            s->mh = 16;
+            s->hsh = 1;
+            s->vsh = 1;
+        }
+        else if (pInfo->ChromaSubsampling == JPEG_422_SUBSAMPLING)
+        {
+            s->mw = 16;
+            s->hsh = 1;
+        }
+        s->mcu_bytes = (uint16_t)(s->mw * s->mh + 128);
+    }
+    else
+    {
+        s->unsupported = 1; // CMYK
+        s->mcu_bytes = 256;
+    }
+
+    s->cols = (uint16_t)((s->width + s->mw - 1) / s->mw);
+    rows = (uint16_t)((s->height + s->mh - 1) / s->mh);
+    s->mcu_total = (uint32_t)s->cols * rows;
+    s->cap = (uint8_t)(LCD_BUFF_PIXELS / (s->mw * s->mh));
+
+    // 输出缓冲区长度取MCU的整数倍，每次回调都是完整的MCU
+    HAL_JPEG_ConfigOutputBuffer(hjpeg, (uint8_t *)LCD_JPEG_Out,
+                                (LCD_JPEG_OUT_SIZE / s->mcu_bytes) * s->mcu_bytes);
+}
+
+/**
+ * @brief  输入数据已全部送入解码器，设置长度为0表示没有更多数据
+ */
+void LCD_JPEG_GetDataHandler(JPEG_HandleTypeDef *hjpeg, uint32_t NbDecodedData)
+{
+    (void)NbDecodedData;
+    HAL_JPEG_ConfigInputBuffer(hjpeg, (uint8_t *)LCD_JPEG_St.pData, 0);
+}
+
+/**
+ * @brief  转换输出缓冲区中的全部MCU，返回后解码器继续写入同一缓冲区
+ */
+void LCD_JPEG_DataReadyHandler(JPEG_HandleTypeDef *hjpeg, uint8_t *pDataOut, uint32_t OutDataLength)
+{
+    LCD_JPEG_State_t *s = &LCD_JPEG_St;
+
+    (void)hjpeg;
+    if (s->unsupported || s->mcu_bytes == 0)
+    {
+        return;
+    }
+    while (OutDataLength >= s->mcu_bytes)
+    {
+        LCD_JPEG_PutMcu(pDataOut);
+        pDataOut += s->mcu_bytes;
+        OutDataLength -= s->mcu_bytes;
+    }
+}
+
+/**
+ * @brief  解码JPEG并显示在指定坐标处
+ * @param  x: 起始水平坐标
+ * @param  y: 起始垂直坐标
+ * @param  pData: JPEG数据首地址
+ * @param  size: 数据字节数
+ * @retval 0-成功，-1-初始化失败，-2-不支持的颜色空间，-3-解码出错或超时
+ */
+int8_t LCD_JPEG_Draw(uint16_t x, uint16_t y, const uint8_t *pData, uint32_t size)
+{
+    LCD_JPEG_State_t *s = &LCD_JPEG_St;
+    HAL_StatusTypeDef status;
+
+    if (pData == NULL || size < 4)
+    {
+        return -3;
+    }
+    if (LCD_JPEG_Init() != 0)
+    {
+        return -1;
+    }
+
+    memset(s, 0, sizeof(*s));
+    s->pData = pData;
+    s->x = x;
+    s->y = y;
+
+    status = HAL_JPEG_Decode(&hjpeg, (uint8_t *)pData, size, (uint8_t *)LCD_JPEG_Out,
+                             LCD_JPEG_OUT_SIZE, LCD_JPEG_TIMEOUT_MS);
+    if (status == HAL_TIMEOUT)
+    {
+        HAL_JPEG_Abort(&hjpeg); // 停止解码核并清空FIFO
+    }
+    if (s->unsupported)
+    {
+        return -2;
+    }
+    if (status != HAL_OK || s->mcu < s->mcu_total || s->mcu_total == 0)
+    {
+        return -3; // 数据不完整时已显示的部分保留
+    }
+    return 0;
+}
+
+#ifdef FLASH_FONT_ENABLE
+/**
+ * @brief  解码并显示字库分区中的JPEG图片
+ * @param  x: 起始水平坐标
+ * @param  y: 起始垂直坐标
+ * @param  index: 图片编号
+ * @retval 同 LCD_JPEG_Draw()，-4-字库中没有该图片
+ */
+int8_t LCD_JPEG_DrawFlash(uint16_t x, uint16_t y, uint16_t index)
+{
+    uint32_t size;
+    const uint8_t *pData = FlashFont_GetJpeg(index, &size, NULL, NULL);
+
+    if (pData == NULL)
+    {
+        return -4;
+    }
+    return LCD_JPEG_Draw(x, y, pData, size);
+}
+#endif
+
+#endif /* LCD_JPEG_ENABLE && LCD_SPI_ENABLE */
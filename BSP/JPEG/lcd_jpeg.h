@@ -0,0 +1,103 @@
+/**
+ ******************************************************************************
+ * @file    lcd_jpeg.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   硬件JPEG解码显示头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 用STM32H7的JPEG编解码器解码基线JPEG，解码出的MCU(YCbCr块)由CPU
+ *   转换为RGB565，写入渲染缓冲区后经 LCD_DrawImage565() 由BDMA发送
+ * - 不需要整幅RGB565帧缓冲：输出缓冲只容纳 LCD_JPEG_OUT_MCUS 个MCU，
+ *   同一MCU行中相邻的MCU并成一个矩形发送，CPU转换与BDMA发送交替进行
+ * - 支持灰度和YCbCr 4:4:4 / 4:2:2 / 4:2:0，不支持CMYK；
+ *   渐进式和算术编码的JPEG硬件无法解码，fontbin_tool.py --jpeg 会拒绝
+ * - JPEG数据可以直接位于QSPI映射区(见 FlashFont_GetJpeg())，硬件按32位字
+ *   读取输入，数据长度需补齐到4字节
+ * - 解码为阻塞方式，在 LCD_JPEG_Draw() 返回前完成；HAL回调在 user_hal_callbacks.c
+ *   中转发到 LCD_JPEG_*Handler()
+ * - 不能在 LCD_TileBegin() 与 LCD_TileEnd() 之间调用：渲染缓冲区在解码过程中
+ *   反复改写，显示列表只能记录缓冲区地址
+ * - 由 init.h 中的 LCD_JPEG_ENABLE 控制，需在 stm32h7xx_hal_conf.h 中使能
+ *   HAL_JPEG_MODULE_ENABLED
+ *
+ * 使用示例：
+ *     LCD_JPEG_Draw(0, 0, jpeg_data, sizeof(jpeg_data));
+ *     LCD_JPEG_DrawFlash(0, 0, 0);  // fontbin_tool.py --jpeg 的第一张图片
+ *
+ ******************************************************************************
+ */
+
+#ifndef LCD_JPEG_H
+#define LCD_JPEG_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define LCD_JPEG_OUT_MCUS 4 /*!< 输出缓冲区容纳的MCU数(按4:2:0每个384字节计)，放在DTCM */
+#define LCD_JPEG_TIMEOUT_MS 1000 /*!< 单张图片的解码超时(ms) */
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  解码JPEG并显示在指定坐标处
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  pData JPEG数据首地址，可以位于QSPI映射区
+     * @param  size 数据字节数，不是4的倍数时末尾不足一个字的部分不会送入解码器
+     * @note   超出屏幕或裁剪区的部分与 LCD_DrawImage565() 相同处理
+     * @retval 0-成功，-1-解码器初始化失败，-2-不支持的颜色空间(CMYK)，-3-解码出错或超时
+     */
+    int8_t LCD_JPEG_Draw(uint16_t x, uint16_t y, const uint8_t *pData, uint32_t size);
+
+#ifdef FLASH_FONT_ENABLE
+    /**
+     * @brief  解码并显示字库分区中的JPEG图片
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  index 图片编号(fontbin_tool.py --jpeg 的参数顺序)
+     * @retval 同 LCD_JPEG_Draw()，另有 -4-字库中没有该图片
+     */
+    int8_t LCD_JPEG_DrawFlash(uint16_t x, uint16_t y, uint16_t index);
+#endif
+
+    /**
+     * @brief  帧头解析完成处理，在 HAL_JPEG_InfoReadyCallback 中调用
+     * @param  hjpeg JPEG句柄
+     * @param  pInfo 图片信息
+     * @retval None
+     */
+    void LCD_JPEG_InfoHandler(JPEG_HandleTypeDef *hjpeg, JPEG_ConfTypeDef *pInfo);
+
+    /**
+     * @brief  输入数据用完处理，在 HAL_JPEG_GetDataCallback 中调用
+     * @param  hjpeg JPEG句柄
+     * @param  NbDecodedData 已送入解码器的字节数
+     * @retval None
+     */
+    void LCD_JPEG_GetDataHandler(JPEG_HandleTypeDef *hjpeg, uint32_t NbDecodedData);
+
+    /**
+     * @brief  输出缓冲区已满或解码结束处理，在 HAL_JPEG_DataReadyCallback 中调用
+     * @param  hjpeg JPEG句柄
+     * @param  pDataOut MCU数据
+     * @param  OutDataLength 字节数
+     * @retval None
+     */
+    void LCD_JPEG_DataReadyHandler(JPEG_HandleTypeDef *hjpeg, uint8_t *pDataOut, uint32_t OutDataLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LCD_JPEG_H
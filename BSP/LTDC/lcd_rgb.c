@@ -0,0 +1,325 @@
+/**
+ ******************************************************************************
+ * @file    lcd_rgb.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   LTDC RGB屏驱动实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 帧缓冲为 RGB_LCD_WIDTH x RGB_LCD_HEIGHT 的RGB565数组，LTDC层0按行扫描；
+ * 文字由 LCD_ExpandText() 直接展开到帧缓冲中字符所在的位置(stride为屏幕宽度)，
+ * 与SPI屏的行缓冲合成走同一段展开代码，只是目标换成了帧缓冲。
+ * 每次绘制结束后按涉及的行清理D-Cache，LTDC下一帧即可读到新像素。
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef LCD_RGB_ENABLE
+#include <string.h>
+
+#if !defined(LCD_SPI_ENABLE) || !defined(USE_FLASH_FONT) || defined(IS_GB2312)
+#error "LCD_RGB_ENABLE 与SPI屏共用字体引擎，需定义 LCD_SPI_ENABLE 并使用UTF-8 Flash字库"
+#endif
+#ifdef LCD_SPI_CLOCK_ENABLE
+#error "LTDC像素时钟只能来自PLL3R，LCD_SPI_SetClock() 会改写PLL3，需在 lcd_spi.h 中注释 LCD_SPI_CLOCK_ENABLE"
+#endif
+#ifndef HAL_LTDC_MODULE_ENABLED
+#error "LCD_RGB_ENABLE 需在 stm32h7xx_hal_conf.h 中使能 HAL_LTDC_MODULE_ENABLED"
+#endif
+
+/**
+ * @brief  RGB接口引脚，同一端口、同一复用功能的引脚合并为一项
+ */
+typedef struct
+{
+    GPIO_TypeDef *port; /*!< 端口 */
+    uint32_t pins;      /*!< 引脚掩码 */
+    uint8_t af;         /*!< 复用功能 */
+} RGB_LCD_Pin_t;
+
+static const RGB_LCD_Pin_t RGB_LCD_Pins[] = {
+    {GPIOA, GPIO_PIN_3 | GPIO_PIN_4 | GPIO_PIN_6 | GPIO_PIN_11 | GPIO_PIN_12, GPIO_AF14_LTDC}, // B5 VSYNC G2 R4 R5
+    {GPIOB, GPIO_PIN_0 | GPIO_PIN_1, GPIO_AF9_LTDC},                                          // R3 R6
+    {GPIOB, GPIO_PIN_8 | GPIO_PIN_9 | GPIO_PIN_10 | GPIO_PIN_11, GPIO_AF14_LTDC},             // B6 B7 G4 G5
+    {GPIOC, GPIO_PIN_6 | GPIO_PIN_7, GPIO_AF14_LTDC},                                         // HSYNC G6
+    {GPIOD, GPIO_PIN_3 | GPIO_PIN_10, GPIO_AF14_LTDC},                                        // G7 B3
+    {GPIOE, GPIO_PIN_11 | GPIO_PIN_12 | GPIO_PIN_13 | GPIO_PIN_14 | GPIO_PIN_15, GPIO_AF14_LTDC}, // G3 B4 DE CLK R7
+};
+
+static LTDC_HandleTypeDef hltdc;                                    /*!< LTDC句柄 */
+#ifdef SDRAM_ENABLE
+static uint16_t *const RGB_LCD_FB = (uint16_t *)RGB_LCD_FB_ADDR; /*!< 帧缓冲 */
+#else
+AXI_SRAM_AT(RGB_LCD_FB_ADDR) static uint16_t RGB_LCD_FB[RGB_LCD_WIDTH * RGB_LCD_HEIGHT] DMA_ALIGNED; /*!< 帧缓冲，占住该地址，链接器不再把其他变量分配到这里 */
+#endif
+static uint16_t RGB_LCD_Color = 0xFFFF;                             /*!< 画笔色(RGB565) */
+static uint16_t RGB_LCD_BackColor = 0x0000;                         /*!< 背景色(RGB565) */
+static uint8_t RGB_LCD_FontSize = 24;                               /*!< 字号 */
+
+/**
+ * @brief  RGB888转RGB565
+ */
+static uint16_t RGB_LCD_To565(uint32_t Color)
+{
+    return (uint16_t)(((Color & 0x00F80000) >> 8) | ((Color & 0x0000FC00) >> 5) | ((Color & 0x000000F8) >> 3));
+}
+
+/**
+ * @brief  把CPU写入的若干行刷回内存，LTDC不经过D-Cache读取
+ */
+static void RGB_LCD_CleanRows(uint16_t y, uint16_t rows)
+{
+    SCB_CleanDCache_by_Addr((uint32_t *)(RGB_LCD_FB + (uint32_t)y * RGB_LCD_WIDTH),
+                            (int32_t)((uint32_t)rows * RGB_LCD_WIDTH * 2));
+}
+
+/**
+ * @brief  像素时钟由PLL3 R输出
+ */
+static int8_t RGB_LCD_ClockInit(void)
+{
+    RCC_PeriphCLKInitTypeDef clk = {0};
+
+    clk.PeriphClockSelection = RCC_PERIPHCLK_LTDC;
+    clk.PLL3.PLL3M = RGB_LCD_PLL3M;
+    clk.PLL3.PLL3N = RGB_LCD_PLL3N;
+    clk.PLL3.PLL3P = 2;
+    clk.PLL3.PLL3Q = 2;
+    clk.PLL3.PLL3R = RGB_LCD_PLL3R;
+    clk.PLL3.PLL3RGE = RCC_PLL3VCIRANGE_2; // 输入5MHz
+    clk.PLL3.PLL3VCOSEL = RCC_PLL3VCOWIDE;
+    clk.PLL3.PLL3FRACN = 0;
+    return (HAL_RCCEx_PeriphCLKConfig(&clk) == HAL_OK) ? 0 : -1;
+}
+
+/**
+ * @brief  RGB接口引脚和背光引脚
+ */
+static void RGB_LCD_GPIO_Init(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+    __HAL_RCC_GPIOD_CLK_ENABLE();
+    __HAL_RCC_GPIOE_CLK_ENABLE();
+    RGB_LCD_BL_CLK_ENABLE();
+
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Pull = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+    for (uint8_t i = 0; i < sizeof(RGB_LCD_Pins) / sizeof(RGB_LCD_Pins[0]); i++)
+    {
+        gpio.Pin = RGB_LCD_Pins[i].pins;
+        gpio.Alternate = RGB_LCD_Pins[i].af;
+        HAL_GPIO_Init(RGB_LCD_Pins[i].port, &gpio);
+    }
+
+    HAL_GPIO_WritePin(RGB_LCD_BL_PORT, RGB_LCD_BL_PIN, GPIO_PIN_RESET); // 帧缓冲清空之前先关闭背光
+    gpio.Pin = RGB_LCD_BL_PIN;
+    gpio.Mode = GPIO_MODE_OUTPUT_PP;
+    gpio.Speed = GPIO_SPEED_FREQ_LOW;
+    HAL_GPIO_Init(RGB_LCD_BL_PORT, &gpio);
+}
+
+/**
+ * @brief  初始化像素时钟、引脚和LTDC层0，帧缓冲清为黑色后打开背光
+ * @note   定义了 SDRAM_ENABLE 时需在 SDRAM_Initialization_Sequence() 之后调用，init.c 中已按此顺序
+ * @retval 0-成功，-1-像素时钟或LTDC初始化失败
+ */
+int8_t RGB_LCD_Init(void)
+{
+    LTDC_LayerCfgTypeDef layer = {0};
+
+    if (RGB_LCD_ClockInit() != 0)
+    {
+        return -1;
+    }
+    RGB_LCD_GPIO_Init();
+    __HAL_RCC_LTDC_CLK_ENABLE();
+
+    hltdc.Instance = LTDC;
+    hltdc.Init.HSPolarity = LTDC_HSPOLARITY_AL;
+    hltdc.Init.VSPolarity = LTDC_VSPOLARITY_AL;
+    hltdc.Init.DEPolarity = LTDC_DEPOLARITY_AL;
+    hltdc.Init.PCPolarity = LTDC_PCPOLARITY_IPC;
+    hltdc.Init.HorizontalSync = RGB_LCD_HSW - 1;
+    hltdc.Init.VerticalSync = RGB_LCD_VSW - 1;
+    hltdc.Init.AccumulatedHBP = RGB_LCD_HSW + RGB_LCD_HBP - 1;
+    hltdc.Init.AccumulatedVBP = RGB_LCD_VSW + RGB_LCD_VBP - 1;
+    hltdc.Init.AccumulatedActiveW = RGB_LCD_HSW + RGB_LCD_HBP + RGB_LCD_WIDTH - 1;
+    hltdc.Init.AccumulatedActiveH = RGB_LCD_VSW + RGB_LCD_VBP + RGB_LCD_HEIGHT - 1;
+    hltdc.Init.TotalWidth = RGB_LCD_HSW + RGB_LCD_HBP + RGB_LCD_WIDTH + RGB_LCD_HFP - 1;
+    hltdc.Init.TotalHeigh = RGB_LCD_VSW + RGB_LCD_VBP + RGB_LCD_HEIGHT + RGB_LCD_VFP - 1;
+    hltdc.Init.Backcolor.Red = 0;
+    hltdc.Init.Backcolor.Green = 0;
+    hltdc.Init.Backcolor.Blue = 0;
+    if (HAL_LTDC_Init(&hltdc) != HAL_OK)
+    {
+        return -1;
+    }
+
+    memset(RGB_LCD_FB, 0, RGB_LCD_FB_BYTES);
+    RGB_LCD_CleanRows(0, RGB_LCD_HEIGHT);
+
+    layer.WindowX0 = 0;
+    layer.WindowX1 = RGB_LCD_WIDTH;
+    layer.WindowY0 = 0;
+    layer.WindowY1 = RGB_LCD_HEIGHT;
+    layer.PixelFormat = LTDC_PIXEL_FORMAT_RGB565;
+    layer.Alpha = 255;
+    layer.Alpha0 = 0;
+    layer.BlendingFactor1 = LTDC_BLENDING_FACTOR1_CA;
+    layer.BlendingFactor2 = LTDC_BLENDING_FACTOR2_CA;
+    layer.FBStartAdress = (uint32_t)RGB_LCD_FB;
+    layer.ImageWidth = RGB_LCD_WIDTH;
+    layer.ImageHeight = RGB_LCD_HEIGHT;
+    if (HAL_LTDC_ConfigLayer(&hltdc, &layer, 0) != HAL_OK)
+    {
+        return -1;
+    }
+
+    HAL_GPIO_WritePin(RGB_LCD_BL_PORT, RGB_LCD_BL_PIN, GPIO_PIN_SET);
+    return 0;
+}
+
+/**
+ * @brief  设置画笔色
+ * @param  Color: RGB888颜色，高8位忽略
+ */
+void RGB_LCD_SetColor(uint32_t Color)
+{
+    RGB_LCD_Color = RGB_LCD_To565(Color);
+}
+
+/**
+ * @brief  设置背景色
+ * @param  Color: RGB888颜色，高8位忽略
+ */
+void RGB_LCD_SetBackColor(uint32_t Color)
+{
+    RGB_LCD_BackColor = RGB_LCD_To565(Color);
+}
+
+/**
+ * @brief  用指定颜色填充矩形，调用者保证矩形在屏幕内
+ */
+static void RGB_LCD_Fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color)
+{
+    uint16_t *row = RGB_LCD_FB + (uint32_t)y * RGB_LCD_WIDTH + x;
+
+    for (uint16_t j = 0; j < height; j++, row += RGB_LCD_WIDTH)
+    {
+        for (uint16_t i = 0; i < width; i++)
+        {
+            row[i] = color;
+        }
+    }
+    RGB_LCD_CleanRows(y, height);
+}
+
+/**
+ * @brief  用背景色清屏
+ */
+void RGB_LCD_Clear(void)
+{
+    RGB_LCD_Fill(0, 0, RGB_LCD_WIDTH, RGB_LCD_HEIGHT, RGB_LCD_BackColor);
+}
+
+/**
+ * @brief  用画笔色填充矩形，超出屏幕的部分裁掉
+ */
+void RGB_LCD_FillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+    if (x >= RGB_LCD_WIDTH || y >= RGB_LCD_HEIGHT)
+    {
+        return;
+    }
+    if (width > RGB_LCD_WIDTH - x)
+    {
+        width = RGB_LCD_WIDTH - x;
+    }
+    if (height > RGB_LCD_HEIGHT - y)
+    {
+        height = RGB_LCD_HEIGHT - y;
+    }
+    RGB_LCD_Fill(x, y, width, height, RGB_LCD_Color);
+}
+
+/**
+ * @brief  用画笔色画点
+ */
+void RGB_LCD_DrawPoint(uint16_t x, uint16_t y)
+{
+    if (x < RGB_LCD_WIDTH && y < RGB_LCD_HEIGHT)
+    {
+        RGB_LCD_Fill(x, y, 1, 1, RGB_LCD_Color);
+    }
+}
+
+/**
+ * @brief  设置字号
+ * @retval 0-成功，-1-字库中没有该字号
+ */
+int8_t RGB_LCD_SetTextFont(uint8_t font_size)
+{
+    if (FlashFont_BytesPerChar(font_size) <= 0)
+    {
+        return -1;
+    }
+    RGB_LCD_FontSize = font_size;
+    return 0;
+}
+
+/**
+ * @brief  从 (x, y) 起展开一行文字，到屏幕右边缘、'\n' 或字符串末尾为止
+ * @retval 展开的字节数
+ */
+static uint16_t RGB_LCD_TextLine(uint16_t x, uint16_t y, const char *pText)
+{
+    uint16_t len;
+
+    if (x >= RGB_LCD_WIDTH || y + RGB_LCD_FontSize > RGB_LCD_HEIGHT)
+    {
+        return 0;
+    }
+    len = LCD_ExpandText(RGB_LCD_FB + (uint32_t)y * RGB_LCD_WIDTH + x, RGB_LCD_WIDTH, RGB_LCD_WIDTH - x, pText,
+                         RGB_LCD_FontSize, RGB_LCD_Color, RGB_LCD_BackColor, NULL);
+    RGB_LCD_CleanRows(y, RGB_LCD_FontSize);
+    return len;
+}
+
+/**
+ * @brief  显示一行字符串，超出屏幕右边缘的字符不显示
+ */
+void RGB_LCD_DisplayString(uint16_t x, uint16_t y, const char *pText)
+{
+    RGB_LCD_TextLine(x, y, pText);
+}
+
+/**
+ * @brief  显示字符串，到屏幕右边缘或遇到 '\n' 时换到下一行
+ */
+void RGB_LCD_DisplayText(uint16_t x, uint16_t y, const char *pText)
+{
+    while (*pText != 0)
+    {
+        uint16_t len = RGB_LCD_TextLine(x, y, pText);
+
+        pText += len;
+        if (*pText == '\n')
+        {
+            pText++;
+        }
+        else if (len == 0)
+        {
+            break; // 超出屏幕底部，或一个字符也放不下
+        }
+        y += RGB_LCD_FontSize;
+    }
+}
+
+#endif /* LCD_RGB_ENABLE */
@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file    lcd_rgb.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   LTDC RGB屏驱动头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - LTDC单层RGB565帧缓冲，定义了 SDRAM_ENABLE 时放在SDRAM起始处，否则放在
+ *   AXI SRAM后256KB(只够480x272)；CPU写入后清理D-Cache，LTDC直接扫描显示
+ * - 文字与SPI屏共用同一套字体引擎：Flash字库的字符查找、字模缓存、ASCII字宽表
+ *   和字模展开表都由 lcd_spi.c 的 LCD_ExpandText() 提供，展开结果直接写入帧
+ *   缓冲，不经过中间缓冲区；因此需要同时定义 LCD_SPI_ENABLE 和 USE_FLASH_FONT(UTF-8)
+ * - 文字按不透明模式绘制，画笔色/背景色与SPI屏各自独立
+ * - 像素时钟由PLL3R输出，PLL3不能再由 LCD_SPI_SetClock() 调整，需注释 lcd_spi.h 中的
+ *   LCD_SPI_CLOCK_ENABLE(SPI6沿用CubeMX配置的60MHz)
+ * - 引脚表 RGB_LCD_Pins[] 和时序参数按核心板RGB接口与面板数据手册填写，换用其他
+ *   面板时修改本文件的配置即可
+ * - 由 init.h 中的 LCD_RGB_ENABLE 控制，需在 stm32h7xx_hal_conf.h 中使能
+ *   HAL_LTDC_MODULE_ENABLED
+ *
+ * 使用示例：
+ *     RGB_LCD_Init();
+ *     RGB_LCD_SetColor(RGB_LCD_WHITE);
+ *     RGB_LCD_SetBackColor(RGB_LCD_BLACK);
+ *     RGB_LCD_Clear();
+ *     RGB_LCD_SetTextFont(32);
+ *     RGB_LCD_DisplayText(42, 20, "电容触摸测试");
+ *
+ ******************************************************************************
+ */
+
+#ifndef LCD_RGB_H
+#define LCD_RGB_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          面板配置
+ ******************************************************************************/
+#define RGB_LCD_WIDTH 480  /*!< 水平分辨率，800x480等大尺寸面板需定义 SDRAM_ENABLE */
+#define RGB_LCD_HEIGHT 272 /*!< 垂直分辨率 */
+
+#define RGB_LCD_HSW 1  /*!< 行同步宽度(像素时钟) */
+#define RGB_LCD_HBP 40 /*!< 行后肩 */
+#define RGB_LCD_HFP 5  /*!< 行前肩 */
+#define RGB_LCD_VSW 1  /*!< 场同步宽度(行) */
+#define RGB_LCD_VBP 8  /*!< 场后肩 */
+#define RGB_LCD_VFP 8  /*!< 场前肩 */
+
+#define RGB_LCD_PLL3M 5   /*!< 像素时钟 = 25MHz / M * N / R = 10MHz */
+#define RGB_LCD_PLL3N 132 /*!< PLL3倍频 */
+#define RGB_LCD_PLL3R 66  /*!< PLL3 R分频，输出到LTDC */
+
+#define RGB_LCD_BL_PORT GPIOD                                  /*!< 背光 GPIO端口 */
+#define RGB_LCD_BL_PIN GPIO_PIN_6                              /*!< 背光 引脚，高电平点亮 */
+#define RGB_LCD_BL_CLK_ENABLE() __HAL_RCC_GPIOD_CLK_ENABLE() /*!< 背光 GPIO时钟 */
+
+#define RGB_LCD_FB_BYTES (RGB_LCD_WIDTH * RGB_LCD_HEIGHT * 2) /*!< 帧缓冲字节数 */
+#ifdef SDRAM_ENABLE
+#define RGB_LCD_FB_ADDR 0xC0000000 /*!< 帧缓冲地址：SDRAM起始处 */
+#else
+#define RGB_LCD_FB_ADDR 0x24040000 /*!< 帧缓冲地址：AXI SRAM后半部分，由 AXI_SRAM_AT() 占住，前256KB留给 LCD_FB_ATTR 等(写成不带后缀的十六进制数) */
+#define RGB_LCD_FB_END 0x2407FFA0 /*!< 帧缓冲不能越过的地址，其后为触摸DMA接收缓冲区(0x2407FFA0)和LED的BSRR字(0x2407FFE0) */
+#if RGB_LCD_FB_ADDR + RGB_LCD_FB_BYTES > RGB_LCD_FB_END
+#error "没有SDRAM时帧缓冲须在0x2407FFA0之前结束，需定义 SDRAM_ENABLE 或减小 RGB_LCD_WIDTH/RGB_LCD_HEIGHT"
+#endif
+#endif
+
+/*******************************************************************************
+ *                          颜色定义
+ ******************************************************************************/
+#define RGB_LCD_WHITE 0xFFFFFF /*!< 纯白色 */
+#define RGB_LCD_BLACK 0x000000 /*!< 纯黑色 */
+#define RGB_LCD_RED 0xFF0000   /*!< 纯红色 */
+#define RGB_LCD_GREEN 0x00FF00 /*!< 纯绿色 */
+#define RGB_LCD_BLUE 0x0000FF  /*!< 纯蓝色 */
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  初始化像素时钟、引脚和LTDC，帧缓冲清为黑色后打开背光
+     * @retval 0-成功，-1-LTDC初始化失败
+     */
+    int8_t RGB_LCD_Init(void);
+
+    /**
+     * @brief  设置画笔色
+     * @param  Color RGB888颜色，高8位忽略，示例：RGB_LCD_SetColor(0xff333333)
+     * @retval None
+     */
+    void RGB_LCD_SetColor(uint32_t Color);
+
+    /**
+     * @brief  设置背景色，清屏和文字背景使用
+     * @param  Color RGB888颜色，高8位忽略
+     * @retval None
+     */
+    void RGB_LCD_SetBackColor(uint32_t Color);
+
+    /**
+     * @brief  用背景色清屏
+     * @retval None
+     */
+    void RGB_LCD_Clear(void);
+
+    /**
+     * @brief  用画笔色填充矩形，超出屏幕的部分裁掉
+     * @retval None
+     */
+    void RGB_LCD_FillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+    /**
+     * @brief  用画笔色画点
+     * @retval None
+     */
+    void RGB_LCD_DrawPoint(uint16_t x, uint16_t y);
+
+    /**
+     * @brief  设置字号，与 LCD_SetTextFont() 相同的Flash字库字号
+     * @retval 0-成功，-1-字库中没有该字号
+     */
+    int8_t RGB_LCD_SetTextFont(uint8_t font_size);
+
+    /**
+     * @brief  显示一行字符串，超出屏幕右边缘的字符不显示
+     * @param  pText UTF-8字符串
+     * @retval None
+     */
+    void RGB_LCD_DisplayString(uint16_t x, uint16_t y, const char *pText);
+
+    /**
+     * @brief  显示字符串，到屏幕右边缘或遇到 '\n' 时换到下一行(行首为 x)
+     * @param  pText UTF-8字符串
+     * @retval None
+     */
+    void RGB_LCD_DisplayText(uint16_t x, uint16_t y, const char *pText);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LCD_RGB_H */
@@ -0,0 +1,385 @@
+/**
+ ******************************************************************************
+ * @file    lcd_touch.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   电容触摸屏驱动实现文件(GT911，5点)
+ ******************************************************************************
+ * @attention
+ *
+ * 一次INT对应一条流水：EXTI中断启动DMA读出 0x814E 起的状态字节和5个触点(41字节) ->
+ * I2C读完成中断解析触点、产生事件 -> 中断方式写0清除状态 -> 写完成中断结束；
+ * 流水进行中又来INT时只记一个标志，结束后立即再读一次，不会重叠访问总线。
+ *
+ * 每个跟踪号的最新坐标放在一个32位字里(按下序号<<24 | y<<12 | x)，中断写、主循环读都是
+ * 一次完成的字访问，不需要关中断。移动事件入队时只带按下序号，分发时读取最新坐标；序号不同
+ * 说明该手指已经抬起又按下，这项移动由后面的抬起/按下事件代替，直接丢弃。
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef LCD_RGB_TOUCH_ENABLE
+#include <string.h>
+
+#if !defined(KEY_ENABLE) || !defined(KEY_EXTI_ENABLE)
+#error "触摸事件经按键事件队列分发，需定义 KEY_ENABLE 并在 key.h 中定义 KEY_EXTI_ENABLE"
+#endif
+#if TOUCH_IRQ_PRIORITY != KEY_IRQ_PRIORITY
+#error "TOUCH_IRQ_PRIORITY 须与 KEY_IRQ_PRIORITY 相同，事件队列只允许一个生产者优先级"
+#endif
+
+/*******************************************************************************
+ *                          GT911寄存器
+ ******************************************************************************/
+#define GT911_REG_XRES 0x8048   /*!< X分辨率(低字节在前)，其后为Y分辨率 */
+#define GT911_REG_ID 0x8140     /*!< 产品ID，ASCII "911" */
+#define GT911_REG_STATUS 0x814E /*!< bit7：数据就绪，低4位：触点数，写0清除 */
+#define GT911_POINT_SIZE 8      /*!< 每个触点：跟踪号、X(2)、Y(2)、面积(2)、保留 */
+
+#define TOUCH_READ_LEN (1 + TOUCH_MAX_POINTS * GT911_POINT_SIZE) /*!< 一次读取的字节数 */
+#define TOUCH_IDS 16                                              /*!< 跟踪号范围 */
+#define TOUCH_POS(gen, x, y) (((uint32_t)(gen) << 24) | ((uint32_t)(y) << 12) | (uint32_t)(x))
+#define TOUCH_POS_XY 0x00FFFFFFUL /*!< 打包坐标中的 x、y 部分 */
+
+#define TOUCH_IDLE 0  /*!< 总线空闲 */
+#define TOUCH_READ 1  /*!< DMA读取触点中 */
+#define TOUCH_CLEAR 2 /*!< 写状态寄存器中 */
+
+/*******************************************************************************
+ *                          私有变量
+ ******************************************************************************/
+static uint8_t touch_rx[64] AXI_SRAM_AT(0x2407FFA0); /*!< DMA接收缓冲区(两个Cache行)，在AXI SRAM末尾LED的BSRR字之前，DMA1不能访问DTCM */
+static uint8_t touch_zero = 0;                        /*!< 写入状态寄存器的0 */
+
+static volatile uint8_t touch_state = TOUCH_IDLE; /*!< 流水状态，只在触摸中断中修改 */
+static volatile uint8_t touch_again = 0;          /*!< 流水进行中又收到了INT */
+static volatile uint16_t touch_down = 0;          /*!< 按下的跟踪号，中断修改 */
+static volatile uint32_t touch_pos[TOUCH_IDS];    /*!< 最新坐标，中断写、主循环读 */
+static uint8_t touch_gen[TOUCH_IDS];              /*!< 按下序号，只由中断修改 */
+static volatile uint8_t touch_move_queued[TOUCH_IDS]; /*!< 队列中已有移动事件：中断置1，分发时清0 */
+static uint32_t touch_sent[TOUCH_IDS];            /*!< 最近一次分发的坐标，只由主循环修改 */
+static uint16_t touch_xres = TOUCH_WIDTH;         /*!< 芯片配置的分辨率 */
+static uint16_t touch_yres = TOUCH_HEIGHT;
+static Touch_Callback touch_cb = NULL; /*!< 注册的回调 */
+static Touch_Stats_t touch_stats;      /*!< 统计 */
+
+/*******************************************************************************
+ *                          私有函数
+ ******************************************************************************/
+
+/**
+ * @brief  启动一次DMA读取
+ */
+static void Touch_StartRead(void)
+{
+    touch_again = 0;
+    touch_state = TOUCH_READ;
+    if (Touch_IIC_ReadDMA(TOUCH_ADDR, GT911_REG_STATUS, touch_rx, TOUCH_READ_LEN) != 0)
+    {
+        touch_state = TOUCH_IDLE;
+        touch_stats.Errors++;
+    }
+}
+
+/**
+ * @brief  流水结束，期间收到过INT时再读一次
+ */
+static void Touch_Finish(void)
+{
+    touch_state = TOUCH_IDLE;
+    if (touch_again)
+        Touch_StartRead();
+}
+
+/**
+ * @brief  写入一项触摸事件
+ */
+static uint8_t Touch_Post(uint8_t id, Touch_Event ev, uint16_t x, uint16_t y)
+{
+    if (KEY_Post((uint8_t)(KEY_ID_TOUCH | id), (uint8_t)ev, x, y))
+        return 1;
+    touch_stats.Dropped++;
+    return 0;
+}
+
+/**
+ * @brief  芯片坐标换算到输出范围
+ */
+static uint16_t Touch_Scale(uint16_t raw, uint16_t res, uint16_t size)
+{
+    uint32_t v = (res == size) ? raw : (uint32_t)raw * size / res;
+
+    return (uint16_t)((v < size) ? v : (uint32_t)size - 1);
+}
+
+/**
+ * @brief  解析本次读到的触点，与上次比较产生按下、移动和抬起
+ * @param  p: 第一个触点
+ * @param  n: 触点数
+ */
+static void Touch_Parse(const uint8_t *p, uint8_t n)
+{
+    uint16_t down = touch_down;
+    uint16_t now = 0;
+    uint16_t released;
+
+    for (uint8_t i = 0; i < n; i++, p += GT911_POINT_SIZE)
+    {
+        uint8_t id = (uint8_t)(p[0] & (TOUCH_IDS - 1));
+        uint16_t x = Touch_Scale((uint16_t)(p[1] | (p[2] << 8)), touch_xres, TOUCH_WIDTH);
+        uint16_t y = Touch_Scale((uint16_t)(p[3] | (p[4] << 8)), touch_yres, TOUCH_HEIGHT);
+        uint32_t pos;
+
+        now |= (uint16_t)(1U << id);
+        if (!(down & (1U << id)))
+        {
+            touch_gen[id]++;
+            touch_pos[id] = TOUCH_POS(touch_gen[id], x, y);
+            Touch_Post(id, TOUCH_EV_DOWN, x, y);
+            continue;
+        }
+        pos = TOUCH_POS(touch_gen[id], x, y);
+        if (pos == touch_pos[id])
+            continue;
+        touch_pos[id] = pos;
+        if (touch_move_queued[id])
+        {
+            touch_stats.Coalesced++; /* 分发时读取最新坐标 */
+            continue;
+        }
+        touch_move_queued[id] = 1;
+        if (!Touch_Post(id, TOUCH_EV_MOVE, touch_gen[id], 0))
+            touch_move_queued[id] = 0;
+    }
+
+    released = (uint16_t)(down & ~now);
+    while (released)
+    {
+        uint8_t id = (uint8_t)(31 - __CLZ(released));
+        uint32_t pos = touch_pos[id];
+
+        released &= (uint16_t)~(1U << id);
+        Touch_Post(id, TOUCH_EV_UP, (uint16_t)(pos & 0xFFF), (uint16_t)((pos >> 12) & 0xFFF));
+    }
+    touch_down = now;
+}
+
+/*******************************************************************************
+ *                          导出函数
+ ******************************************************************************/
+
+/**
+ * @brief  复位触摸芯片、读取分辨率并使能INT中断
+ * @note   复位时INT保持低电平选择地址0xBA；之后INT改为输入，等芯片完成初始化再访问
+ * @retval 0-成功，-1-I2C初始化失败，-2-没有读到触摸芯片
+ */
+int8_t Touch_Init(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+    uint8_t buf[4];
+
+    if (Touch_IIC_Init() != 0)
+    {
+        return -1;
+    }
+
+    TOUCH_INT_CLK_ENABLE();
+    TOUCH_RST_CLK_ENABLE();
+    HAL_GPIO_WritePin(TOUCH_INT_PORT, TOUCH_INT_PIN, GPIO_PIN_RESET);
+    HAL_GPIO_WritePin(TOUCH_RST_PORT, TOUCH_RST_PIN, GPIO_PIN_RESET);
+    gpio.Mode = GPIO_MODE_OUTPUT_PP;
+    gpio.Pull = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_LOW;
+    gpio.Pin = TOUCH_INT_PIN;
+    HAL_GPIO_Init(TOUCH_INT_PORT, &gpio);
+    gpio.Pin = TOUCH_RST_PIN;
+    HAL_GPIO_Init(TOUCH_RST_PORT, &gpio);
+    HAL_Delay(10);
+    HAL_GPIO_WritePin(TOUCH_RST_PORT, TOUCH_RST_PIN, GPIO_PIN_SET);
+    HAL_Delay(10);
+    gpio.Pin = TOUCH_INT_PIN;
+    gpio.Mode = GPIO_MODE_INPUT;
+    HAL_GPIO_Init(TOUCH_INT_PORT, &gpio);
+    HAL_Delay(50);
+
+    if (Touch_IIC_Read(TOUCH_ADDR, GT911_REG_ID, buf, 4) != 0 || buf[0] != '9')
+    {
+        return -2;
+    }
+    if (Touch_IIC_Read(TOUCH_ADDR, GT911_REG_XRES, buf, 4) == 0)
+    {
+        touch_xres = (uint16_t)(buf[0] | (buf[1] << 8));
+        touch_yres = (uint16_t)(buf[2] | (buf[3] << 8));
+    }
+    if (touch_xres == 0 || touch_yres == 0)
+    {
+        touch_xres = TOUCH_WIDTH;
+        touch_yres = TOUCH_HEIGHT;
+    }
+    Touch_IIC_Write(TOUCH_ADDR, GT911_REG_STATUS, &touch_zero, 1); /* 丢弃上电后残留的触点 */
+
+    touch_state = TOUCH_IDLE;
+    touch_down = 0;
+    gpio.Mode = TOUCH_INT_EDGE;
+    HAL_GPIO_Init(TOUCH_INT_PORT, &gpio);
+    __HAL_GPIO_EXTI_CLEAR_IT(TOUCH_INT_PIN);
+    HAL_NVIC_SetPriority(TOUCH_INT_IRQn, TOUCH_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TOUCH_INT_IRQn);
+    return 0;
+}
+
+/**
+ * @brief  读取当前按下的触点
+ * @note   主循环中调用，按下集合与坐标各读一次，最多相差一次扫描
+ */
+uint8_t Touch_GetPoints(Touch_Point_t *points)
+{
+    uint16_t down = touch_down;
+    uint8_t n = 0;
+
+    while (down && n < TOUCH_MAX_POINTS)
+    {
+        uint8_t id = (uint8_t)(31 - __CLZ(down));
+        uint32_t pos = touch_pos[id];
+
+        down &= (uint16_t)~(1U << id);
+        points[n].id = id;
+        points[n].x = (uint16_t)(pos & 0xFFF);
+        points[n].y = (uint16_t)((pos >> 12) & 0xFFF);
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief  注册触摸回调
+ */
+void Touch_RegisterCallback(Touch_Callback cb)
+{
+    touch_cb = cb;
+}
+
+/**
+ * @brief  触摸事件处理函数(弱定义)
+ */
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((weak)) void Touch_EventHandler(uint8_t id, Touch_Event ev, uint16_t x, uint16_t y)
+#else
+__weak void Touch_EventHandler(uint8_t id, Touch_Event ev, uint16_t x, uint16_t y)
+#endif
+{
+    (void)id;
+    (void)ev;
+    (void)x;
+    (void)y;
+}
+
+/**
+ * @brief  分发队列中的一项触摸事件
+ * @note   移动事件先清除入队标志再读坐标：其间中断再次移动会重新入队，下一项因坐标相同被跳过
+ */
+void Touch_Dispatch(uint8_t id, uint8_t ev, uint16_t x, uint16_t y)
+{
+    if (ev == TOUCH_EV_MOVE)
+    {
+        uint32_t pos;
+
+        touch_move_queued[id] = 0;
+        __DMB();
+        pos = touch_pos[id];
+        if ((pos >> 24) != (x & 0xFF) || (pos & TOUCH_POS_XY) == touch_sent[id])
+            return; /* 已抬起又按下，或与上次分发的坐标相同 */
+        touch_sent[id] = pos & TOUCH_POS_XY;
+        x = (uint16_t)(pos & 0xFFF);
+        y = (uint16_t)((pos >> 12) & 0xFFF);
+        touch_stats.Moves++;
+    }
+    else if (ev == TOUCH_EV_DOWN)
+    {
+        touch_sent[id] = TOUCH_POS(0, x, y);
+    }
+
+    if (touch_cb)
+        touch_cb(id, (Touch_Event)ev, x, y);
+    else
+        Touch_EventHandler(id, (Touch_Event)ev, x, y);
+}
+
+/**
+ * @brief  读取触摸统计
+ */
+void Touch_GetStats(Touch_Stats_t *stats, uint8_t reset)
+{
+    *stats = touch_stats;
+    if (reset)
+        memset(&touch_stats, 0, sizeof(touch_stats));
+}
+
+/**
+ * @brief  INT引脚EXTI中断服务入口
+ */
+void Touch_EXTI_IRQHandler(void)
+{
+    if (__HAL_GPIO_EXTI_GET_IT(TOUCH_INT_PIN) == 0x00U)
+        return;
+    __HAL_GPIO_EXTI_CLEAR_IT(TOUCH_INT_PIN);
+
+    touch_stats.Irqs++;
+    if (touch_state == TOUCH_IDLE)
+        Touch_StartRead();
+    else
+        touch_again = 1;
+}
+
+/**
+ * @brief  DMA读取完成：作废Cache后解析触点，数据就绪时写0清除状态
+ * @note   INT与芯片扫描周期错开时可能读到未就绪的状态，直接结束，不清除
+ */
+void Touch_RxCpltHandler(I2C_HandleTypeDef *hi2c)
+{
+    uint8_t status;
+
+    if (hi2c->Instance != TOUCH_IIC_INSTANCE)
+        return;
+    SCB_InvalidateDCache_by_Addr((uint32_t *)touch_rx, sizeof(touch_rx));
+    touch_stats.Reads++;
+
+    status = touch_rx[0];
+    if (!(status & 0x80))
+    {
+        Touch_Finish();
+        return;
+    }
+    Touch_Parse(touch_rx + 1, (uint8_t)((status & 0x0F) < TOUCH_MAX_POINTS ? (status & 0x0F) : TOUCH_MAX_POINTS));
+
+    touch_state = TOUCH_CLEAR;
+    if (Touch_IIC_WriteIT(TOUCH_ADDR, GT911_REG_STATUS, &touch_zero, 1) != 0)
+    {
+        touch_stats.Errors++;
+        Touch_Finish();
+    }
+}
+
+/**
+ * @brief  状态清除完成
+ */
+void Touch_TxCpltHandler(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c->Instance != TOUCH_IIC_INSTANCE)
+        return;
+    Touch_Finish();
+}
+
+/**
+ * @brief  I2C出错：结束本次流水，等下一次INT重新读取
+ */
+void Touch_ErrorHandler(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c->Instance != TOUCH_IIC_INSTANCE)
+        return;
+    touch_stats.Errors++;
+    Touch_Finish();
+}
+
+#endif /* LCD_RGB_TOUCH_ENABLE */
@@ -0,0 +1,163 @@
+/**
+ ******************************************************************************
+ * @file    lcd_touch.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   电容触摸屏驱动头文件(GT911，5点)
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 中断驱动：触摸芯片每完成一次扫描拉出INT脉冲，EXTI中断启动DMA一次读出状态和全部触点，
+ *   读完后在I2C中断中解析并清除状态；没有触摸时不产生任何中断，也没有轮询任务
+ * - 按下、抬起写入按键驱动的事件队列(KEY_Post())，与按键事件按发生顺序由 KEY_Task() 分发；
+ *   移动只保存最新坐标，每个触点在队列中最多有一项移动事件，分发时读取当时的最新位置，
+ *   主循环被绘图阻塞多久都只收到一次移动，不会积压过时的坐标
+ * - 触点号为芯片的跟踪号(0-15)，同一手指从按下到抬起不变
+ * - 坐标按芯片配置的分辨率换算到 TOUCH_WIDTH x TOUCH_HEIGHT
+ * - 需要 KEY_ENABLE 并在 key.h 中定义 KEY_EXTI_ENABLE；中断优先级见 touch_iic.h
+ * - 由 init.h 中的 LCD_RGB_TOUCH_ENABLE 控制
+ *
+ * 使用示例：
+ *     void Touch_EventHandler(uint8_t id, Touch_Event ev, uint16_t x, uint16_t y)
+ *     {
+ *         if (ev != TOUCH_EV_UP)
+ *             RGB_LCD_FillRect(x, y, 4, 4);
+ *     }
+ *
+ ******************************************************************************
+ */
+
+#ifndef LCD_TOUCH_H
+#define LCD_TOUCH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          触摸芯片配置
+ ******************************************************************************/
+#define TOUCH_ADDR 0xBA        /*!< GT911器件地址(8位格式)，复位时INT为低电平选择0xBA/0xBB */
+#define TOUCH_MAX_POINTS 5     /*!< 最多触点数 */
+#define TOUCH_WIDTH RGB_LCD_WIDTH   /*!< 输出坐标范围 */
+#define TOUCH_HEIGHT RGB_LCD_HEIGHT
+
+#define TOUCH_INT_PORT GPIOG                                /*!< INT GPIO端口 */
+#define TOUCH_INT_PIN GPIO_PIN_3                            /*!< INT 引脚，EXTI线不能与按键、TE引脚相同 */
+#define TOUCH_INT_IRQn EXTI3_IRQn                           /*!< INT 引脚的EXTI中断号 */
+#define TOUCH_INT_EDGE GPIO_MODE_IT_RISING                  /*!< INT 触发边沿，与芯片配置寄存器0x804D的低2位一致(0：上升沿) */
+#define TOUCH_INT_CLK_ENABLE() __HAL_RCC_GPIOG_CLK_ENABLE() /*!< INT GPIO时钟 */
+#define TOUCH_RST_PORT GPIOG                                /*!< RST GPIO端口 */
+#define TOUCH_RST_PIN GPIO_PIN_2                            /*!< RST 引脚，低电平复位 */
+#define TOUCH_RST_CLK_ENABLE() __HAL_RCC_GPIOG_CLK_ENABLE() /*!< RST GPIO时钟 */
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  触摸事件类型
+     */
+    typedef enum
+    {
+        TOUCH_EV_DOWN = 0, /*!< 按下 */
+        TOUCH_EV_MOVE,     /*!< 移动(已合并为最新位置) */
+        TOUCH_EV_UP        /*!< 抬起，坐标为最后位置 */
+    } Touch_Event;
+
+    /**
+     * @brief  当前按下的触点
+     */
+    typedef struct
+    {
+        uint8_t id; /*!< 触点号 */
+        uint16_t x; /*!< 最新坐标 */
+        uint16_t y;
+    } Touch_Point_t;
+
+    /**
+     * @brief  触摸回调函数原型
+     * @param  id: 触点号
+     * @param  ev: 事件类型
+     * @param  x、y: 坐标
+     */
+    typedef void (*Touch_Callback)(uint8_t id, Touch_Event ev, uint16_t x, uint16_t y);
+
+    /**
+     * @brief  触摸统计
+     */
+    typedef struct
+    {
+        uint32_t Irqs;      /*!< INT中断次数 */
+        uint32_t Reads;     /*!< 完成的DMA读取次数 */
+        uint32_t Moves;     /*!< 分发的移动事件数 */
+        uint32_t Coalesced; /*!< 合并掉的移动次数(队列中已有该触点的移动事件) */
+        uint32_t Dropped;   /*!< 队列满丢弃的事件数 */
+        uint32_t Errors;    /*!< I2C错误次数 */
+    } Touch_Stats_t;
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  复位触摸芯片、读取分辨率并使能INT中断
+     * @note   初始化期间阻塞约70ms
+     * @retval 0-成功，-1-I2C初始化失败，-2-没有读到触摸芯片
+     */
+    int8_t Touch_Init(void);
+
+    /**
+     * @brief  读取当前按下的触点
+     * @param  points: 输出，至少 TOUCH_MAX_POINTS 项
+     * @retval 触点数
+     */
+    uint8_t Touch_GetPoints(Touch_Point_t *points);
+
+    /**
+     * @brief  注册触摸回调，NULL时恢复调用 Touch_EventHandler()
+     */
+    void Touch_RegisterCallback(Touch_Callback cb);
+
+    /**
+     * @brief  触摸事件处理函数(弱定义，用户可重定义)
+     * @note   由 KEY_Task() 在主循环中调用
+     */
+    void Touch_EventHandler(uint8_t id, Touch_Event ev, uint16_t x, uint16_t y);
+
+    /**
+     * @brief  分发队列中的一项触摸事件，由 KEY_Task() 调用
+     * @param  id: 触点号
+     * @param  ev: 事件类型
+     * @param  x、y: 队列项参数
+     */
+    void Touch_Dispatch(uint8_t id, uint8_t ev, uint16_t x, uint16_t y);
+
+    /**
+     * @brief  读取触摸统计
+     * @param  stats: 输出
+     * @param  reset: 1-读取后清零
+     */
+    void Touch_GetStats(Touch_Stats_t *stats, uint8_t reset);
+
+    /**
+     * @brief  INT引脚EXTI中断服务入口，由 stm32h7xx_it.c 调用，只清除INT引脚的挂起位
+     */
+    void Touch_EXTI_IRQHandler(void);
+
+    /**
+     * @brief  I2C读取完成、写入完成和错误处理，由 user_hal_callbacks.c 中的HAL回调调用
+     * @param  hi2c: I2C句柄，不是触摸总线时直接返回
+     */
+    void Touch_RxCpltHandler(I2C_HandleTypeDef *hi2c);
+    void Touch_TxCpltHandler(I2C_HandleTypeDef *hi2c);
+    void Touch_ErrorHandler(I2C_HandleTypeDef *hi2c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LCD_TOUCH_H */
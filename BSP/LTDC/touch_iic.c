@@ -0,0 +1,162 @@
+/**
+ ******************************************************************************
+ * @file    touch_iic.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   触摸屏I2C总线实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 引脚、DMA和I2C在这里直接初始化，不依赖CubeMX生成的 i2c.c；接收用DMA，
+ * 发送只有清除状态的1个字节，用中断方式完成。DMA完成后由 HAL 的I2C中断处理结束条件，
+ * 再调用 HAL_I2C_MemRxCpltCallback()。
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef LCD_RGB_TOUCH_ENABLE
+
+#ifndef HAL_I2C_MODULE_ENABLED
+#error "LCD_RGB_TOUCH_ENABLE 需在 stm32h7xx_hal_conf.h 中使能 HAL_I2C_MODULE_ENABLED"
+#endif
+
+static I2C_HandleTypeDef htouch_iic; /*!< I2C句柄 */
+static DMA_HandleTypeDef htouch_dma; /*!< 接收DMA句柄 */
+
+/**
+ * @brief  SCL/SDA 开漏复用
+ */
+static void Touch_IIC_GPIO_Init(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+
+    TOUCH_IIC_GPIO_CLK_ENABLE();
+    gpio.Mode = GPIO_MODE_AF_OD;
+    gpio.Pull = GPIO_PULLUP;
+    gpio.Speed = GPIO_SPEED_FREQ_LOW;
+    gpio.Alternate = TOUCH_IIC_AF;
+    gpio.Pin = TOUCH_IIC_SCL_PIN;
+    HAL_GPIO_Init(TOUCH_IIC_SCL_PORT, &gpio);
+    gpio.Pin = TOUCH_IIC_SDA_PIN;
+    HAL_GPIO_Init(TOUCH_IIC_SDA_PORT, &gpio);
+}
+
+/**
+ * @brief  接收DMA：外设到内存，字节传输，不用FIFO
+ */
+static int8_t Touch_IIC_DMA_Init(void)
+{
+    TOUCH_IIC_DMA_CLK_ENABLE();
+    htouch_dma.Instance = TOUCH_IIC_DMA;
+    htouch_dma.Init.Request = TOUCH_IIC_DMA_REQUEST;
+    htouch_dma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    htouch_dma.Init.PeriphInc = DMA_PINC_DISABLE;
+    htouch_dma.Init.MemInc = DMA_MINC_ENABLE;
+    htouch_dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    htouch_dma.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    htouch_dma.Init.Mode = DMA_NORMAL;
+    htouch_dma.Init.Priority = DMA_PRIORITY_LOW;
+    htouch_dma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&htouch_dma) != HAL_OK)
+    {
+        return -1;
+    }
+    __HAL_LINKDMA(&htouch_iic, hdmarx, htouch_dma);
+    HAL_NVIC_SetPriority(TOUCH_IIC_DMA_IRQn, TOUCH_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TOUCH_IIC_DMA_IRQn);
+    return 0;
+}
+
+/**
+ * @brief  初始化引脚、DMA和I2C，使能I2C与DMA中断
+ * @retval 0-成功，-1-I2C或DMA初始化失败
+ */
+int8_t Touch_IIC_Init(void)
+{
+    Touch_IIC_GPIO_Init();
+    TOUCH_IIC_CLK_ENABLE();
+
+    htouch_iic.Instance = TOUCH_IIC_INSTANCE;
+    htouch_iic.Init.Timing = TOUCH_IIC_TIMING;
+    htouch_iic.Init.OwnAddress1 = 0;
+    htouch_iic.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+    htouch_iic.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+    htouch_iic.Init.OwnAddress2 = 0;
+    htouch_iic.Init.OwnAddress2Masks = I2C_OA2_NOMASK;
+    htouch_iic.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+    htouch_iic.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+    if (HAL_I2C_Init(&htouch_iic) != HAL_OK || HAL_I2CEx_ConfigAnalogFilter(&htouch_iic, I2C_ANALOGFILTER_ENABLE) != HAL_OK)
+    {
+        return -1;
+    }
+    if (Touch_IIC_DMA_Init() != 0)
+    {
+        return -1;
+    }
+
+    HAL_NVIC_SetPriority(TOUCH_IIC_EV_IRQn, TOUCH_IRQ_PRIORITY, 0);
+    HAL_NVIC_SetPriority(TOUCH_IIC_ER_IRQn, TOUCH_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TOUCH_IIC_EV_IRQn);
+    HAL_NVIC_EnableIRQ(TOUCH_IIC_ER_IRQn);
+    return 0;
+}
+
+/**
+ * @brief  阻塞读取寄存器，只在初始化时使用
+ */
+int8_t Touch_IIC_Read(uint8_t addr, uint16_t reg, uint8_t *buf, uint16_t len)
+{
+    return (HAL_I2C_Mem_Read(&htouch_iic, addr, reg, I2C_MEMADD_SIZE_16BIT, buf, len, TOUCH_IIC_TIMEOUT) == HAL_OK) ? 0 : -1;
+}
+
+/**
+ * @brief  阻塞写寄存器，只在初始化时使用
+ */
+int8_t Touch_IIC_Write(uint8_t addr, uint16_t reg, const uint8_t *buf, uint16_t len)
+{
+    return (HAL_I2C_Mem_Write(&htouch_iic, addr, reg, I2C_MEMADD_SIZE_16BIT, (uint8_t *)buf, len, TOUCH_IIC_TIMEOUT) == HAL_OK) ? 0 : -1;
+}
+
+/**
+ * @brief  启动DMA读取寄存器
+ * @note   CPU不写接收缓冲区，Cache中没有脏行，完成后由调用者按地址作废Cache再读取
+ */
+int8_t Touch_IIC_ReadDMA(uint8_t addr, uint16_t reg, uint8_t *buf, uint16_t len)
+{
+    return (HAL_I2C_Mem_Read_DMA(&htouch_iic, addr, reg, I2C_MEMADD_SIZE_16BIT, buf, len) == HAL_OK) ? 0 : -1;
+}
+
+/**
+ * @brief  以中断方式写寄存器
+ */
+int8_t Touch_IIC_WriteIT(uint8_t addr, uint16_t reg, uint8_t *buf, uint16_t len)
+{
+    return (HAL_I2C_Mem_Write_IT(&htouch_iic, addr, reg, I2C_MEMADD_SIZE_16BIT, buf, len) == HAL_OK) ? 0 : -1;
+}
+
+/**
+ * @brief  I2C事件中断服务入口
+ */
+void Touch_IIC_EV_IRQHandler(void)
+{
+    HAL_I2C_EV_IRQHandler(&htouch_iic);
+}
+
+/**
+ * @brief  I2C错误中断服务入口
+ */
+void Touch_IIC_ER_IRQHandler(void)
+{
+    HAL_I2C_ER_IRQHandler(&htouch_iic);
+}
+
+/**
+ * @brief  接收DMA中断服务入口
+ */
+void Touch_IIC_DMA_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&htouch_dma);
+}
+
+#endif /* LCD_RGB_TOUCH_ENABLE */
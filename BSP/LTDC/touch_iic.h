@@ -0,0 +1,105 @@
+/**
+ ******************************************************************************
+ * @file    touch_iic.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   触摸屏I2C总线头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 硬件I2C(400kHz)，只供 lcd_touch.c 使用：初始化阶段用阻塞读写配置触摸芯片，
+ *   运行时由INT中断启动DMA读取全部触点，读完后用中断方式写寄存器清除状态，CPU不等待总线
+ * - 引脚、DMA通道和中断优先级在本文件配置；I2C与DMA的中断服务函数在 stm32h7xx_it.c 中，
+ *   更换 TOUCH_IIC_INSTANCE / TOUCH_IIC_DMA 时同步修改函数名
+ * - 中断优先级须与 key.h 的 KEY_IRQ_PRIORITY 相同：触摸事件与按键事件写入同一个队列，
+ *   同优先级的中断互不抢占，队列仍只有一个生产者
+ * - 由 init.h 中的 LCD_RGB_TOUCH_ENABLE 控制，需在 stm32h7xx_hal_conf.h 中使能 HAL_I2C_MODULE_ENABLED
+ *
+ ******************************************************************************
+ */
+
+#ifndef TOUCH_IIC_H
+#define TOUCH_IIC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          总线配置
+ ******************************************************************************/
+#define TOUCH_IIC_INSTANCE I2C1                                 /*!< I2C外设，中断服务函数为 I2C1_EV_IRQHandler / I2C1_ER_IRQHandler */
+#define TOUCH_IIC_EV_IRQn I2C1_EV_IRQn                          /*!< I2C事件中断号 */
+#define TOUCH_IIC_ER_IRQn I2C1_ER_IRQn                          /*!< I2C错误中断号 */
+#define TOUCH_IIC_CLK_ENABLE() __HAL_RCC_I2C1_CLK_ENABLE()      /*!< I2C时钟 */
+#define TOUCH_IIC_TIMING 0x20321F37                             /*!< I2C时钟120MHz(rcc_pclk1)下的400kHz：PRESC=2，SCLL=56、SCLH=32个25ns，修改系统时钟后用CubeMX重新计算 */
+#define TOUCH_IIC_TIMEOUT 10                                    /*!< 阻塞读写超时(ms)，只在初始化时使用 */
+
+#define TOUCH_IIC_SCL_PORT GPIOB                                /*!< SCL GPIO端口 */
+#define TOUCH_IIC_SCL_PIN GPIO_PIN_6                            /*!< SCL 引脚 */
+#define TOUCH_IIC_SDA_PORT GPIOB                                /*!< SDA GPIO端口 */
+#define TOUCH_IIC_SDA_PIN GPIO_PIN_7                            /*!< SDA 引脚 */
+#define TOUCH_IIC_AF GPIO_AF4_I2C1                              /*!< 引脚复用功能 */
+#define TOUCH_IIC_GPIO_CLK_ENABLE() __HAL_RCC_GPIOB_CLK_ENABLE() /*!< SCL/SDA GPIO时钟 */
+
+#define TOUCH_IIC_DMA DMA1_Stream0                   /*!< 接收DMA，中断服务函数为 DMA1_Stream0_IRQHandler(DMA1_Stream5~7 已由LED使用) */
+#define TOUCH_IIC_DMA_IRQn DMA1_Stream0_IRQn         /*!< 接收DMA中断号 */
+#define TOUCH_IIC_DMA_REQUEST DMA_REQUEST_I2C1_RX    /*!< DMAMUX请求 */
+#define TOUCH_IIC_DMA_CLK_ENABLE() __HAL_RCC_DMA1_CLK_ENABLE() /*!< DMA时钟 */
+
+#define TOUCH_IRQ_PRIORITY 14 /*!< INT引脚EXTI、I2C和DMA的中断优先级，须与 KEY_IRQ_PRIORITY 相同 */
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  初始化引脚、DMA和I2C，使能I2C与DMA中断
+     * @retval 0-成功，-1-I2C初始化失败
+     */
+    int8_t Touch_IIC_Init(void);
+
+    /**
+     * @brief  阻塞读取寄存器(16位地址)
+     * @param  addr: 器件地址(8位格式)
+     * @param  reg: 寄存器地址
+     * @param  buf、len: 接收缓冲区和字节数
+     * @retval 0-成功，-1-失败或超时
+     */
+    int8_t Touch_IIC_Read(uint8_t addr, uint16_t reg, uint8_t *buf, uint16_t len);
+
+    /**
+     * @brief  阻塞写寄存器(16位地址)
+     * @retval 0-成功，-1-失败或超时
+     */
+    int8_t Touch_IIC_Write(uint8_t addr, uint16_t reg, const uint8_t *buf, uint16_t len);
+
+    /**
+     * @brief  启动DMA读取寄存器，完成后 HAL_I2C_MemRxCpltCallback() 调用 Touch_RxCpltHandler()
+     * @param  buf: 接收缓冲区，须在DMA可访问的RAM(AXI SRAM)并按Cache行对齐
+     * @retval 0-已启动，-1-总线忙
+     */
+    int8_t Touch_IIC_ReadDMA(uint8_t addr, uint16_t reg, uint8_t *buf, uint16_t len);
+
+    /**
+     * @brief  以中断方式写寄存器，完成后 HAL_I2C_MemTxCpltCallback() 调用 Touch_TxCpltHandler()
+     * @param  buf: 发送数据，完成前须保持有效
+     * @retval 0-已启动，-1-总线忙
+     */
+    int8_t Touch_IIC_WriteIT(uint8_t addr, uint16_t reg, uint8_t *buf, uint16_t len);
+
+    /**
+     * @brief  I2C事件、错误中断和接收DMA中断服务入口，由 stm32h7xx_it.c 调用
+     */
+    void Touch_IIC_EV_IRQHandler(void);
+    void Touch_IIC_ER_IRQHandler(void);
+    void Touch_IIC_DMA_IRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TOUCH_IIC_H */
@@ -0,0 +1,344 @@
+/**
+ ******************************************************************************
+ * @file    lcd_lvgl.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   LVGL显示驱动实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 刷新流程：
+ * - LVGL渲染完一块区域后调用 flush_cb，这里只启动 LCD_CopyBufferAsync() 就返回，
+ *   LVGL随即在另一个绘制缓冲区中渲染下一块
+ * - 复制的最后一段在SPI发送完成中断中结束，回调里通知LVGL该缓冲区可以重用；
+ *   下一次 flush_cb 前驱动自动等待上一块发送完成
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#if defined(LCD_LVGL_ENABLE) && defined(LCD_SPI_ENABLE)
+#include <string.h>
+
+#if LV_COLOR_DEPTH != 16
+#error "LCD_LVGL_ENABLE 需要在 lv_conf.h 中设置 LV_COLOR_DEPTH 16"
+#endif
+#if defined(LV_COLOR_16_SWAP) && (LV_COLOR_16_SWAP != 0) && !defined(LCD_LVGL_PANEL_SWAP)
+#error "像素按16位帧发送不需要字节交换：请设置 LV_COLOR_16_SWAP 0，或在 lcd_lvgl.h 中定义 LCD_LVGL_PANEL_SWAP"
+#endif
+#if defined(LCD_FRAMEBUFFER_ENABLE) || defined(LCD_TILE_ENABLE)
+#error "LCD_LVGL_ENABLE 不能与 LCD_FRAMEBUFFER_ENABLE / LCD_TILE_ENABLE 同时使用"
+#endif
+#if defined(LCD_RGB_ENABLE) && !defined(SDRAM_ENABLE) && (LCD_LVGL_BUF_ADDR < RGB_LCD_FB_ADDR + RGB_LCD_FB_BYTES) && \
+    (RGB_LCD_FB_ADDR < LCD_LVGL_BUF_ADDR + LCD_LVGL_BUF_PIXELS * 2 * 2)
+#error "LVGL绘制缓冲区与RGB屏帧缓冲在AXI SRAM中重叠：定义 SDRAM_ENABLE 把帧缓冲移到SDRAM，或修改 LCD_LVGL_BUF_ADDR"
+#endif
+
+LCD_LVGL_BUF_ATTR static uint16_t LCD_LVGL_Buff[2][LCD_LVGL_BUF_PIXELS] DMA_ALIGNED; /*!< 两个部分刷新绘制缓冲区 */
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief  发送完成回调，在SPI发送完成中断中调用
+ * @param  arg 显示设备
+ */
+static void LCD_LVGL_FlushDone(void *arg)
+{
+    lv_display_flush_ready((lv_display_t *)arg);
+}
+
+/**
+ * @brief  LVGL刷新回调：启动后台发送后立即返回
+ */
+static void LCD_LVGL_Flush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    LCD_CopyBufferAsync((uint16_t)area->x1, (uint16_t)area->y1, (uint16_t)lv_area_get_width(area),
+                        (uint16_t)lv_area_get_height(area), (const uint16_t *)px_map, LCD_LVGL_FlushDone, disp);
+}
+#else
+static lv_disp_draw_buf_t LCD_LVGL_DrawBuf; /*!< 绘制缓冲区描述 */
+static lv_disp_drv_t LCD_LVGL_Drv;          /*!< 显示驱动 */
+
+/**
+ * @brief  发送完成回调，在SPI发送完成中断中调用
+ * @param  arg 显示驱动
+ */
+static void LCD_LVGL_FlushDone(void *arg)
+{
+    lv_disp_flush_ready((lv_disp_drv_t *)arg);
+}
+
+/**
+ * @brief  LVGL刷新回调：启动后台发送后立即返回
+ */
+static void LCD_LVGL_Flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    LCD_CopyBufferAsync((uint16_t)area->x1, (uint16_t)area->y1, (uint16_t)lv_area_get_width(area),
+                        (uint16_t)lv_area_get_height(area), (const uint16_t *)color_p, LCD_LVGL_FlushDone, drv);
+}
+#endif
+
+/**
+ * @brief  初始化LVGL并注册显示设备
+ */
+void LCD_LVGL_Init(void)
+{
+    lv_init();
+#ifdef LCD_LVGL_PANEL_SWAP
+    LCD_SetByteSwap(1); // 屏幕直接接收交换过字节的像素
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+    lv_display_t *disp = lv_display_create(LCD_LVGL_HOR_RES, LCD_LVGL_VER_RES);
+
+    lv_tick_set_cb(HAL_GetTick);
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
+    lv_display_set_flush_cb(disp, LCD_LVGL_Flush);
+    lv_display_set_buffers(disp, LCD_LVGL_Buff[0], LCD_LVGL_Buff[1], sizeof(LCD_LVGL_Buff[0]),
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+#else
+    lv_disp_draw_buf_init(&LCD_LVGL_DrawBuf, LCD_LVGL_Buff[0], LCD_LVGL_Buff[1], LCD_LVGL_BUF_PIXELS);
+    lv_disp_drv_init(&LCD_LVGL_Drv);
+    LCD_LVGL_Drv.hor_res = LCD_LVGL_HOR_RES;
+    LCD_LVGL_Drv.ver_res = LCD_LVGL_VER_RES;
+    LCD_LVGL_Drv.flush_cb = LCD_LVGL_Flush;
+    LCD_LVGL_Drv.draw_buf = &LCD_LVGL_DrawBuf;
+    lv_disp_drv_register(&LCD_LVGL_Drv);
+#endif
+}
+
+/**
+ * @brief  LVGL周期任务
+ */
+uint32_t LCD_LVGL_Task(void)
+{
+    return lv_timer_handler();
+}
+
+#ifdef FLASH_FONT_ENABLE
+/* 字体引擎：字模不转换为LVGL的C数组，按码点经常驻子集、字模缓存查找，
+ * 抗锯齿字模直接从QSPI映射区读取，只把字模外框内的像素解包为LVGL的格式 */
+
+static lv_font_t LCD_LVGL_Fonts[LCD_LVGL_FONT_COUNT];            /*!< 各字号的字体对象 */
+static const uint8_t LCD_LVGL_FontSizes[LCD_LVGL_FONT_COUNT] = LCD_LVGL_FONT_SIZES; /*!< 字体对象对应的字号 */
+#if LVGL_VERSION_MAJOR < 9
+static uint8_t LCD_LVGL_GlyphBuff[(LCD_LVGL_FONT_MAX_SIZE * LCD_LVGL_FONT_MAX_SIZE * 4 + 7) / 8]; /*!< 解包后的字模(最大4bpp) */
+#endif
+
+/**
+ * @brief  字模的来源和待输出的区域
+ */
+typedef struct
+{
+    const uint8_t *data; /*!< 字模数据 */
+    uint8_t packed;      /*!< 1表示1bpp行程压缩，2表示每行按4字节补齐 */
+    uint8_t bpp;         /*!< 字模每像素位数(1/2/4)，低位在前 */
+    uint8_t cell_w;      /*!< 字模单元宽度 */
+    uint8_t cell_h;      /*!< 字模单元高度 */
+    uint8_t x, y, w, h;  /*!< 输出区域(字模单元坐标) */
+} LCD_LVGL_Glyph_t;
+
+/**
+ * @brief  查找字模并确定输出区域
+ * @param  font_size 字号
+ * @param  cp 码点
+ * @param  g 输出字模信息
+ * @retval 0-成功，-1-字库中没有该字符
+ */
+static int8_t LCD_LVGL_FindGlyph(uint8_t font_size, uint32_t cp, LCD_LVGL_Glyph_t *g)
+{
+    g->cell_w = (cp < 0x80) ? font_size / 2 : font_size;
+    g->cell_h = font_size;
+    g->x = 0;
+    g->y = 0;
+    g->w = g->cell_w;
+    g->h = g->cell_h;
+    g->packed = 0;
+    g->bpp = 1;
+    g->data = NULL;
+
+#ifdef FLASH_FONT_AA_ENABLE
+    g->data = FlashFont_GetGlyphAA(cp, font_size, &g->bpp); // 灰度字模较大，直接读映射区
+#endif
+    if (g->data == NULL)
+    {
+        g->bpp = 1;
+        g->data = FlashFont_GetGlyphCP(cp, font_size);
+        if (g->data == NULL)
+        {
+            return -1;
+        }
+        g->packed = FlashFont_GlyphPacked(cp, font_size);
+#ifdef FLASH_FONT_BOX_ENABLE
+        const FontGlyphBox_t *box = (cp < 0x80) ? NULL : FlashFont_GetGlyphBox(cp, font_size);
+
+        if (box != NULL) // 外框之外全是背景，LVGL不必混合
+        {
+            g->x = box->x;
+            g->y = box->y;
+            g->w = box->w;
+            g->h = box->h;
+            if (g->w == 0 || g->h == 0)
+            {
+                g->w = 0;
+                g->h = 0;
+            }
+        }
+#endif
+    }
+    return 0;
+}
+
+/**
+ * @brief  把字模输出区域逐像素交给 put
+ * @note   压缩字模按行标记跳过重复行，外框上方的行也要走一遍以定位存储行
+ */
+#if LVGL_VERSION_MAJOR >= 9
+#define LCD_LVGL_PUT(dst, i, v, bpp) ((dst)[i] = (uint8_t)((v) * 255 / ((1 << (bpp)) - 1)))
+#else
+#define LCD_LVGL_PUT(dst, i, v, bpp) ((dst)[(i) * (bpp) >> 3] |= (uint8_t)((v) << (8 - (bpp) - (((i) * (bpp)) & 0x07))))
+#endif
+
+/**
+ * @brief  解包字模输出区域
+ * @param  g 字模信息
+ * @param  dst 目标缓冲区，v8为连续存放的高位在前 bpp位像素(需预先清零)，v9为A8
+ * @param  stride 目标每行像素数
+ */
+static void LCD_LVGL_Unpack(const LCD_LVGL_Glyph_t *g, uint8_t *dst, uint32_t stride)
+{
+    uint16_t bytes_per_row = (g->packed == 2) ? FONT_ROW32_BYTES(g->cell_w) : (uint16_t)((g->cell_w * g->bpp + 7) / 8);
+    const uint8_t *tags = (g->packed == 1) ? g->data : NULL;
+    const uint8_t *next = (g->packed == 1) ? g->data + (g->cell_h + 7) / 8 : g->data;
+    const uint8_t *row = NULL; // 压缩字模第0行之前视为空行
+    uint8_t mask = (uint8_t)((1 << g->bpp) - 1);
+
+    for (uint16_t r = 0; r < g->y + g->h; r++)
+    {
+        if (tags == NULL || (tags[r >> 3] & (0x01 << (r & 0x07))))
+        {
+            row = next;
+            next += bytes_per_row;
+        }
+        if (r < g->y || row == NULL)
+        {
+            continue;
+        }
+        for (uint16_t c = 0; c < g->w; c++)
+        {
+            uint16_t bit = (uint16_t)((g->x + c) * g->bpp);
+            uint8_t v = (row[bit >> 3] >> (bit & 0x07)) & mask;
+
+            if (v != 0)
+            {
+                uint32_t i = (uint32_t)(r - g->y) * stride + c;
+
+                LCD_LVGL_PUT(dst, i, v, g->bpp);
+            }
+        }
+    }
+}
+
+/**
+ * @brief  LVGL查询字模尺寸
+ */
+static bool LCD_LVGL_GetGlyphDsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next)
+{
+    uint8_t font_size = (uint8_t)(uintptr_t)font->dsc;
+    LCD_LVGL_Glyph_t g;
+    int8_t src_x = 0;
+
+    if (LCD_LVGL_FindGlyph(font_size, letter, &g) != 0)
+    {
+        return false;
+    }
+    dsc->adv_w = g.cell_w;
+    if (letter < 0x80)
+    {
+        dsc->adv_w = FlashFont_AsciiAdvance((char)letter, (letter_next < 0x80) ? (char)letter_next : 0, font_size, &src_x);
+    }
+    dsc->box_w = g.w;
+    dsc->box_h = g.h;
+    dsc->ofs_x = (int16_t)(g.x - src_x);
+    dsc->ofs_y = (int16_t)(g.cell_h - g.y - g.h); // 基线在字模单元底部
+#if LVGL_VERSION_MAJOR >= 9
+    dsc->format = (g.bpp == 4) ? LV_FONT_GLYPH_FORMAT_A4 : (g.bpp == 2) ? LV_FONT_GLYPH_FORMAT_A2 : LV_FONT_GLYPH_FORMAT_A1;
+    dsc->gid.index = letter;
+    dsc->is_placeholder = 0;
+#else
+    dsc->bpp = g.bpp;
+#endif
+    return true;
+}
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief  LVGL读取字模：解包为A8写入LVGL提供的绘制缓冲区
+ */
+static const void *LCD_LVGL_GetGlyphBitmap(lv_font_glyph_dsc_t *dsc, lv_draw_buf_t *draw_buf)
+{
+    uint8_t font_size = (uint8_t)(uintptr_t)dsc->resolved_font->dsc;
+    LCD_LVGL_Glyph_t g;
+
+    if (draw_buf == NULL || LCD_LVGL_FindGlyph(font_size, dsc->gid.index, &g) != 0)
+    {
+        return NULL;
+    }
+    for (uint16_t r = 0; r < g.h; r++)
+    {
+        memset(draw_buf->data + (uint32_t)r * draw_buf->header.stride, 0, g.w);
+    }
+    LCD_LVGL_Unpack(&g, draw_buf->data, draw_buf->header.stride);
+    return draw_buf;
+}
+#else
+/**
+ * @brief  LVGL读取字模：解包为高位在前的连续位图
+ * @note   返回的位图在下一次调用前有效
+ */
+static const uint8_t *LCD_LVGL_GetGlyphBitmap(const lv_font_t *font, uint32_t letter)
+{
+    uint8_t font_size = (uint8_t)(uintptr_t)font->dsc;
+    LCD_LVGL_Glyph_t g;
+
+    if (LCD_LVGL_FindGlyph(font_size, letter, &g) != 0)
+    {
+        return NULL;
+    }
+    memset(LCD_LVGL_GlyphBuff, 0, ((uint32_t)g.w * g.h * g.bpp + 7) / 8);
+    LCD_LVGL_Unpack(&g, LCD_LVGL_GlyphBuff, g.w);
+    return LCD_LVGL_GlyphBuff;
+}
+#endif
+
+/**
+ * @brief  获取Flash字库的LVGL字体
+ */
+const lv_font_t *LCD_LVGL_GetFont(uint8_t font_size)
+{
+    for (uint8_t i = 0; i < LCD_LVGL_FONT_COUNT; i++)
+    {
+        lv_font_t *font = &LCD_LVGL_Fonts[i];
+
+        if (LCD_LVGL_FontSizes[i] != font_size)
+        {
+            continue;
+        }
+        if (font_size > LCD_LVGL_FONT_MAX_SIZE || FlashFont_BytesPerChar(font_size) <= 0)
+        {
+            return NULL; // 字库没有该字号
+        }
+        if (font->get_glyph_dsc == NULL)
+        {
+            font->get_glyph_dsc = LCD_LVGL_GetGlyphDsc;
+            font->get_glyph_bitmap = LCD_LVGL_GetGlyphBitmap;
+            font->line_height = font_size;
+            font->base_line = 0;
+            font->dsc = (const void *)(uintptr_t)font_size;
+        }
+        return font;
+    }
+    return NULL;
+}
+#endif /* FLASH_FONT_ENABLE */
+
+#endif /* LCD_LVGL_ENABLE */
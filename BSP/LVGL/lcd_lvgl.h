@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ * @file    lcd_lvgl.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   LVGL显示驱动头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 把 lcd_spi.c 注册为LVGL的显示设备，支持LVGL v8/v9，颜色深度须为16位
+ * - 两个部分刷新绘制缓冲区放在AXI SRAM：LVGL渲染一个缓冲区时，另一个由
+ *   LCD_CopyBufferAsync() 在后台发送，flush_cb 立即返回，最后一段的SPI发送完成中断中
+ *   调用 lv_disp_flush_ready()/lv_display_flush_ready()
+ * - BDMA只能读SRAM4，缓冲区由MDMA逐段搬到渲染缓冲区后发送，搬运与发送交替进行，
+ *   CPU不逐像素拷贝
+ * - 像素按16位帧发送，高字节先出，LVGL缓冲区不需要字节交换(v8 LV_COLOR_16_SWAP 设为0)；
+ *   已有工程必须使用交换过的缓冲区时定义 LCD_LVGL_PANEL_SWAP，由屏幕的字节序设置接收，
+ *   不在 flush_cb 中逐像素交换
+ * - 时基：v8 在 lv_conf.h 中设置 LV_TICK_CUSTOM 1 且
+ *   LV_TICK_CUSTOM_SYS_TIME_EXPR 为 HAL_GetTick()；v9 由 LCD_LVGL_Init() 注册 HAL_GetTick
+ * - 不使用帧缓冲和条带模式(LCD_FRAMEBUFFER_ENABLE / LCD_TILE_ENABLE)，LVGL自己维护脏区域
+ * - LCD_LVGL_GetFont() 返回由Flash字库直接提供字模的 lv_font_t，不把字模转换为C数组：
+ *   按码点经常驻子集、字模缓存查找，字库带抗锯齿段时输出2/4bpp灰度字模；
+ *   1bpp字模只解包笔画外框内的像素，LVGL不混合外框外的背景
+ * - 字库字模按行补齐且低位在前，LVGL v8 需要连续存放、高位在前的位图，v9 需要A8，
+ *   因此每个字模在读取时解包一次，不能原地交给LVGL
+ * - v9 按 9.2 及之后的字体接口(get_glyph_bitmap 传入绘制缓冲区)实现
+ * - 由 init.h 中的 LCD_LVGL_ENABLE 控制，LVGL源码和 lv_conf.h 需另行加入工程
+ *
+ * 使用示例：
+ *     LCD_LVGL_Init();              // init_all() 中已调用
+ *     lv_obj_t *label = lv_label_create(lv_scr_act());
+ *     lv_label_set_text(label, "LVGL");
+ *     lv_obj_set_style_text_font(label, LCD_LVGL_GetFont(24), 0); // 显示GB2312汉字
+ *     while (1) { LCD_LVGL_Task(); } // main_while() 中已调用
+ *
+ ******************************************************************************
+ */
+
+#ifndef LCD_LVGL_H
+#define LCD_LVGL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include "lvgl.h"
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define LCD_LVGL_HOR_RES LCD_Width /*!< 水平分辨率，竖屏(Direction_V)时为 LCD_Width，横屏时改为 LCD_Height */
+#define LCD_LVGL_VER_RES LCD_Height /*!< 垂直分辨率，横屏时改为 LCD_Width */
+#define LCD_LVGL_BUF_PIXELS (320 * 40) /*!< 每个绘制缓冲区的像素数(屏幕长边 x 40行，25KB) */
+#define LCD_LVGL_BUF_ADDR 0x24040000 /*!< 两个绘制缓冲区(50KB)的地址：AXI SRAM 256KB处，避开SPI屏帧缓冲(写成不带后缀的十六进制数) */
+#ifndef LCD_LVGL_BUF_ATTR
+#define LCD_LVGL_BUF_ATTR AXI_SRAM_AT(LCD_LVGL_BUF_ADDR) /*!< 绘制缓冲区存放位置，改为其他属性时 LCD_LVGL_BUF_ADDR 同步修改 */
+#endif
+#define LCD_LVGL_FONT_SIZES {12, 16, 20, 24, 32} /*!< LCD_LVGL_GetFont() 支持的字号 */
+#define LCD_LVGL_FONT_COUNT 5 /*!< LCD_LVGL_FONT_SIZES 中的字号个数 */
+#define LCD_LVGL_FONT_MAX_SIZE 32 /*!< 最大字号，决定v8字模解包缓冲区大小(4bpp时N*N/2字节) */
+// #define LCD_LVGL_PANEL_SWAP /*!< 定义了：屏幕设为低字节在前，直接接收字节交换过的缓冲区(LV_COLOR_16_SWAP 1), 注释后：不交换 */
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  初始化LVGL并注册显示设备
+     * @note   需在 SPI_LCD_Init() 之后调用，内部调用 lv_init()
+     * @retval None
+     */
+    void LCD_LVGL_Init(void);
+
+    /**
+     * @brief  LVGL周期任务，执行定时器和渲染
+     * @note   在主循环中调用，建议间隔不超过5ms
+     * @retval 距下一个LVGL定时器到期的毫秒数，界面没有变化时可以等这么久再调用
+     */
+    uint32_t LCD_LVGL_Task(void);
+
+#ifdef FLASH_FONT_ENABLE
+    /**
+     * @brief  获取Flash字库的LVGL字体
+     * @param  font_size 字号(LCD_LVGL_FONT_SIZES 之一)
+     * @note   需在 FlashFont_Init() 之后调用；字体对象是静态的，可以重复获取
+     * @retval 字体指针，字库中没有该字号返回NULL
+     */
+    const lv_font_t *LCD_LVGL_GetFont(uint8_t font_size);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LCD_LVGL_H
@@ -0,0 +1,306 @@
+/**
+ ******************************************************************************
+ * @file    perf_frame.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   帧耗时监视
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef PERF_FRAME_ENABLE
+#include <stdio.h>
+#include <string.h>
+
+#if PERF_FRAME_SCREENS < 1 || PERF_FRAME_SCREENS > 255
+#error "PERF_FRAME_SCREENS 必须在1-255之间"
+#endif
+#if PERF_FRAME_BINS < 2
+#error "PERF_FRAME_BINS 至少为2"
+#endif
+
+#define PERF_FRAME_STEPS 16U /*!< 每个预算分成的桶数 */
+
+/**
+ * @brief  单个画面的统计
+ */
+typedef struct
+{
+    uint32_t budget_us;
+    uint32_t budget_cycles;
+    uint32_t frames;
+    uint32_t overruns;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t sum_cycles;
+    uint32_t hist[PERF_FRAME_BINS]; /*!< 第i桶为 [i, i+1) * 预算/16，最后一桶不封顶 */
+} PerfFrame_Screen_t;
+
+DTCM_BSS static PerfFrame_Screen_t g_frame_screens[PERF_FRAME_SCREENS];
+DTCM_BSS static PerfFrame_Overrun_t g_frame_log[PERF_FRAME_LOG]; /*!< 超预算记录环形缓冲 */
+static uint32_t g_frame_log_count;                                /*!< 累计记录条数，对 PERF_FRAME_LOG 取余为下一个写入位置 */
+static PerfFrame_Callback_t g_frame_callback;
+
+static uint8_t g_frame_screen;  /*!< 当前帧的画面编号 */
+static uint8_t g_frame_active;  /*!< 是否在 Begin/End 之间 */
+static uint32_t g_frame_start;  /*!< 当前帧起始的DWT周期 */
+#ifdef PERF_STATS_ENABLE
+static PerfStats_t g_frame_stats; /*!< 当前帧起始时的热点计数 */
+#endif
+
+/**
+ * @brief  画面编号限定到统计表范围内
+ */
+static PerfFrame_Screen_t *PerfFrame_Screen(uint8_t screen)
+{
+    if (screen >= PERF_FRAME_SCREENS)
+    {
+        screen = PERF_FRAME_SCREENS - 1;
+    }
+    return &g_frame_screens[screen];
+}
+
+/**
+ * @brief  清零一个画面的统计并按微秒预算换算周期
+ */
+static void PerfFrame_ClearScreen(PerfFrame_Screen_t *s, uint32_t us)
+{
+    memset(s, 0, sizeof(*s));
+    s->budget_us = us;
+    s->budget_cycles = us * (SystemCoreClock / 1000000U);
+    if (s->budget_cycles == 0)
+    {
+        s->budget_cycles = 1;
+    }
+    s->min_cycles = 0xFFFFFFFFU;
+}
+
+/**
+ * @brief  由直方图求99百分位(桶上沿，不超过最大值)
+ */
+static uint32_t PerfFrame_P99(const PerfFrame_Screen_t *s)
+{
+    uint32_t need = s->frames - s->frames / 100U; // 至少覆盖99%的帧
+    uint32_t sum = 0;
+    uint32_t edge;
+
+    for (uint32_t i = 0; i < PERF_FRAME_BINS - 1; i++)
+    {
+        sum += s->hist[i];
+        if (sum >= need)
+        {
+            edge = (uint32_t)(((uint64_t)(i + 1) * s->budget_cycles) / PERF_FRAME_STEPS);
+            return edge < s->max_cycles ? edge : s->max_cycles;
+        }
+    }
+    return s->max_cycles;
+}
+
+/**
+ * @brief  清零全部统计和记录，预算恢复默认值，并使能DWT周期计数器
+ * @retval None
+ */
+void PerfFrame_Reset(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55; // 解锁DWT
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t i = 0; i < PERF_FRAME_SCREENS; i++)
+    {
+        PerfFrame_ClearScreen(&g_frame_screens[i], PERF_FRAME_BUDGET_US);
+    }
+    memset(g_frame_log, 0, sizeof(g_frame_log));
+    g_frame_log_count = 0;
+    g_frame_active = 0;
+}
+
+/**
+ * @brief  开始一帧
+ * @param  screen: 画面编号
+ * @retval None
+ */
+void PerfFrame_Begin(uint8_t screen)
+{
+    g_frame_screen = screen < PERF_FRAME_SCREENS ? screen : PERF_FRAME_SCREENS - 1;
+    g_frame_active = 1;
+#ifdef PERF_STATS_ENABLE
+    g_frame_stats = g_perf_stats;
+#endif
+    g_frame_start = DWT->CYCCNT; // 最后读取，计数器快照不计入本帧
+}
+
+/**
+ * @brief  结束一帧，更新统计，超出预算时记录并调用回调
+ * @retval 本帧耗时(周期)
+ */
+uint32_t PerfFrame_End(void)
+{
+    uint32_t cycles = DWT->CYCCNT - g_frame_start;
+    PerfFrame_Screen_t *s;
+    uint32_t bin;
+
+    if (!g_frame_active)
+    {
+        return 0;
+    }
+    g_frame_active = 0;
+    s = &g_frame_screens[g_frame_screen];
+
+    s->frames++;
+    s->sum_cycles += cycles;
+    if (cycles < s->min_cycles)
+    {
+        s->min_cycles = cycles;
+    }
+    if (cycles > s->max_cycles)
+    {
+        s->max_cycles = cycles;
+    }
+    bin = (uint32_t)(((uint64_t)cycles * PERF_FRAME_STEPS) / s->budget_cycles);
+    s->hist[bin < PERF_FRAME_BINS - 1 ? bin : PERF_FRAME_BINS - 1]++;
+
+    if (cycles > s->budget_cycles)
+    {
+        PerfFrame_Overrun_t *r = &g_frame_log[g_frame_log_count % PERF_FRAME_LOG];
+
+        s->overruns++;
+        g_frame_log_count++;
+        r->screen = g_frame_screen;
+        r->seq = s->frames;
+        r->cycles = cycles;
+        r->budget_cycles = s->budget_cycles;
+#ifdef PERF_STATS_ENABLE
+        {
+            const uint32_t *now = (const uint32_t *)&g_perf_stats;
+            const uint32_t *then = (const uint32_t *)&g_frame_stats;
+            uint32_t *delta = (uint32_t *)&r->delta;
+
+            // PerfStats_t 全部为uint32_t计数，逐项相减(回绕时差值仍正确)
+            for (uint32_t i = 0; i < sizeof(PerfStats_t) / sizeof(uint32_t); i++)
+            {
+                delta[i] = now[i] - then[i];
+            }
+        }
+#endif
+        if (g_frame_callback != NULL)
+        {
+            g_frame_callback(r);
+        }
+    }
+    return cycles;
+}
+
+/**
+ * @brief  设置画面的帧预算
+ * @param  screen: 画面编号
+ * @param  us: 预算(微秒)，0为默认值
+ * @retval None
+ */
+void PerfFrame_SetBudget(uint8_t screen, uint32_t us)
+{
+    PerfFrame_ClearScreen(PerfFrame_Screen(screen), us != 0 ? us : PERF_FRAME_BUDGET_US);
+}
+
+/**
+ * @brief  注册超预算回调
+ * @param  callback: 回调函数，NULL为取消
+ * @retval None
+ */
+void PerfFrame_SetCallback(PerfFrame_Callback_t callback)
+{
+    g_frame_callback = callback;
+}
+
+/**
+ * @brief  读取画面的统计
+ * @param  screen: 画面编号
+ * @param  summary: 输出统计
+ * @retval None
+ */
+void PerfFrame_GetSummary(uint8_t screen, PerfFrame_Summary_t *summary)
+{
+    const PerfFrame_Screen_t *s = PerfFrame_Screen(screen);
+
+    if (summary == NULL)
+    {
+        return;
+    }
+    summary->frames = s->frames;
+    summary->overruns = s->overruns;
+    summary->budget_cycles = s->budget_cycles;
+    if (s->frames == 0)
+    {
+        summary->min_cycles = 0;
+        summary->avg_cycles = 0;
+        summary->max_cycles = 0;
+        summary->p99_cycles = 0;
+        return;
+    }
+    summary->min_cycles = s->min_cycles;
+    summary->avg_cycles = (uint32_t)(s->sum_cycles / s->frames);
+    summary->max_cycles = s->max_cycles;
+    summary->p99_cycles = PerfFrame_P99(s);
+}
+
+/**
+ * @brief  读取超预算记录
+ * @param  log: 输出记录，最新的在前
+ * @param  max: 最多读取的条数
+ * @retval 读取的条数
+ */
+uint32_t PerfFrame_GetOverruns(PerfFrame_Overrun_t *log, uint32_t max)
+{
+    uint32_t n = g_frame_log_count < PERF_FRAME_LOG ? g_frame_log_count : PERF_FRAME_LOG;
+
+    if (log == NULL)
+    {
+        return 0;
+    }
+    if (n > max)
+    {
+        n = max;
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        log[i] = g_frame_log[(g_frame_log_count - 1 - i) % PERF_FRAME_LOG];
+    }
+    return n;
+}
+
+/**
+ * @brief  按 "画面 帧数 最小 平均 最大 p99 超预算 预算" 逐行导出统计(微秒)
+ * @param  write: 输出函数
+ * @retval 导出的画面数
+ */
+uint32_t PerfFrame_Export(PerfFrame_Write_t write)
+{
+    uint32_t mhz = SystemCoreClock / 1000000U;
+    uint32_t lines = 0;
+    PerfFrame_Summary_t sum;
+    char line[96];
+    int len;
+
+    if (write == NULL || mhz == 0)
+    {
+        return 0;
+    }
+    for (uint32_t i = 0; i < PERF_FRAME_SCREENS; i++)
+    {
+        PerfFrame_GetSummary((uint8_t)i, &sum);
+        if (sum.frames == 0)
+        {
+            continue;
+        }
+        len = snprintf(line, sizeof(line), "%lu %lu %lu %lu %lu %lu %lu %lu\n",
+                       (unsigned long)i, (unsigned long)sum.frames,
+                       (unsigned long)(sum.min_cycles / mhz), (unsigned long)(sum.avg_cycles / mhz),
+                       (unsigned long)(sum.max_cycles / mhz), (unsigned long)(sum.p99_cycles / mhz),
+                       (unsigned long)sum.overruns, (unsigned long)g_frame_screens[i].budget_us);
+        write(line, (uint16_t)len);
+        lines++;
+    }
+    return lines;
+}
+
+#endif /* PERF_FRAME_ENABLE */
@@ -0,0 +1,170 @@
+/**
+ ******************************************************************************
+ * @file    perf_frame.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   帧耗时监视头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 在一帧(一次页面刷新、一次控件更新)前后调用 LCD_FrameBegin(画面编号) /
+ *   LCD_FrameEnd()，用DWT周期计数器测量耗时，按画面编号分别统计次数、最小、
+ *   平均、最大和99百分位
+ * - 百分位来自每个画面一张直方图，每桶为帧预算的1/16，覆盖0~2倍预算，
+ *   超过2倍预算的帧计入最后一桶(百分位取最大值)
+ * - 超出预算的帧记入最近 PERF_FRAME_LOG 条的环形记录，并调用
+ *   PerfFrame_SetCallback() 注册的函数；同时定义 PERF_STATS_ENABLE 时记录中
+ *   带本帧内热点计数的增量，据此判断时间花在文本(字模查找、QSPI读取)、
+ *   填充(fill_pixels)还是SPI/DMA等待上
+ * - 不支持嵌套，帧内再次 LCD_FrameBegin() 时重新开始计时
+ * - 由 init.h 中的 PERF_FRAME_ENABLE 控制，未定义时 LCD_FrameBegin() /
+ *   LCD_FrameEnd() 展开为空；PerfFrame_Reset() 会使能DWT
+ *
+ * 使用示例：
+ *     PerfFrame_SetBudget(SCREEN_MAIN, 16667);   // 主界面 60fps
+ *     PerfFrame_SetCallback(OnOverrun);
+ *     LCD_FrameBegin(SCREEN_MAIN);
+ *     DrawMainPage();
+ *     LCD_FrameEnd();
+ *     PerfFrame_Export(Uart_Write);               // 每个画面一行统计
+ *
+ ******************************************************************************
+ */
+
+#ifndef PERF_FRAME_H
+#define PERF_FRAME_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#ifdef PERF_STATS_ENABLE
+#include "perf_stats.h"
+#endif
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define PERF_FRAME_SCREENS 8           /*!< 分别统计的画面数，超出的编号计入最后一个 */
+#define PERF_FRAME_BUDGET_US 33333     /*!< 默认帧预算(微秒)，PerfFrame_SetBudget() 可按画面修改 */
+#define PERF_FRAME_BINS 33             /*!< 直方图桶数：32桶覆盖0~2倍预算，最后一桶收录超过2倍预算的帧 */
+#define PERF_FRAME_LOG 8               /*!< 保留的超预算记录条数 */
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  单个画面的帧耗时统计(单位均为CPU周期)
+     */
+    typedef struct
+    {
+        uint32_t frames;        /*!< 帧数 */
+        uint32_t overruns;      /*!< 超出预算的帧数 */
+        uint32_t min_cycles;    /*!< 最短帧 */
+        uint32_t avg_cycles;    /*!< 平均 */
+        uint32_t max_cycles;    /*!< 最长帧 */
+        uint32_t p99_cycles;    /*!< 99百分位，取直方图桶的上沿，精度为预算的1/16 */
+        uint32_t budget_cycles; /*!< 帧预算 */
+    } PerfFrame_Summary_t;
+
+    /**
+     * @brief  一次超预算记录
+     */
+    typedef struct
+    {
+        uint8_t screen;         /*!< 画面编号 */
+        uint32_t seq;           /*!< 该画面的第几帧(从1开始) */
+        uint32_t cycles;        /*!< 本帧耗时 */
+        uint32_t budget_cycles; /*!< 帧预算 */
+#ifdef PERF_STATS_ENABLE
+        PerfStats_t delta; /*!< 本帧内各热点计数的增量 */
+#endif
+    } PerfFrame_Overrun_t;
+
+    /**
+     * @brief  超预算回调，在 LCD_FrameEnd() 中调用
+     * @param  overrun: 本次记录，回调返回后失效
+     */
+    typedef void (*PerfFrame_Callback_t)(const PerfFrame_Overrun_t *overrun);
+
+    /**
+     * @brief  导出输出函数
+     * @param  data: 待输出的字符
+     * @param  len: 字符数
+     */
+    typedef void (*PerfFrame_Write_t)(const char *data, uint16_t len);
+
+#define LCD_FrameBegin(screen) PerfFrame_Begin(screen) /*!< 开始一帧 */
+#define LCD_FrameEnd() PerfFrame_End()                 /*!< 结束一帧 */
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  清零全部统计和记录，预算恢复默认值，并使能DWT周期计数器
+     * @retval None
+     */
+    void PerfFrame_Reset(void);
+
+    /**
+     * @brief  开始一帧
+     * @param  screen: 画面编号(0 ~ PERF_FRAME_SCREENS-1)
+     * @retval None
+     */
+    void PerfFrame_Begin(uint8_t screen);
+
+    /**
+     * @brief  结束一帧，更新统计，超出预算时记录并调用回调
+     * @retval 本帧耗时(周期)，没有对应的 PerfFrame_Begin() 时返回0
+     */
+    uint32_t PerfFrame_End(void);
+
+    /**
+     * @brief  设置画面的帧预算
+     * @param  screen: 画面编号
+     * @param  us: 预算(微秒)，0为默认值
+     * @retval None
+     * @note   直方图按预算分桶，修改后该画面的统计清零
+     */
+    void PerfFrame_SetBudget(uint8_t screen, uint32_t us);
+
+    /**
+     * @brief  注册超预算回调
+     * @param  callback: 回调函数，NULL为取消
+     * @retval None
+     */
+    void PerfFrame_SetCallback(PerfFrame_Callback_t callback);
+
+    /**
+     * @brief  读取画面的统计
+     * @param  screen: 画面编号
+     * @param  summary: 输出统计
+     * @retval None
+     */
+    void PerfFrame_GetSummary(uint8_t screen, PerfFrame_Summary_t *summary);
+
+    /**
+     * @brief  读取超预算记录
+     * @param  log: 输出记录，最新的在前
+     * @param  max: 最多读取的条数
+     * @retval 读取的条数
+     */
+    uint32_t PerfFrame_GetOverruns(PerfFrame_Overrun_t *log, uint32_t max);
+
+    /**
+     * @brief  按 "画面 帧数 最小 平均 最大 p99 超预算 预算" 逐行导出统计(微秒)
+     * @param  write: 输出函数
+     * @retval 导出的画面数(跳过没有帧的画面)
+     */
+    uint32_t PerfFrame_Export(PerfFrame_Write_t write);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_FRAME_H
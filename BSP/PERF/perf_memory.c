@@ -0,0 +1,239 @@
+/**
+ ******************************************************************************
+ * @file    perf_memory.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   渲染/字库缓存内存占用报告
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef PERF_MEMORY_ENABLE
+#include <stdio.h>
+#include <string.h>
+
+#if defined(FLASH_FONT_ENABLE) && defined(GLYPH_CACHE_ENABLE)
+#define PERF_MEMORY_HAS_GLYPH
+#endif
+#if defined(LCD_SPI_ENABLE) && defined(USE_FLASH_FONT)
+#ifdef LCD_PIXEL_CACHE_ENABLE
+#define PERF_MEMORY_HAS_PIXEL
+#endif
+#ifdef LCD_NUM_ATLAS_ENABLE
+#define PERF_MEMORY_HAS_ATLAS
+#endif
+#if defined(LCD_TEXT_MEMO_ENABLE) && !defined(IS_GB2312)
+#define PERF_MEMORY_HAS_MEMO
+#endif
+#endif
+#if defined(LCD_SPI_ENABLE) && defined(LCD_SPRITE_ENABLE)
+#define PERF_MEMORY_HAS_SPRITE
+#endif
+#if defined(FLASH_FONT_ENABLE) && defined(FLASH_FONT_RESIDENT_ENABLE)
+#define PERF_MEMORY_HAS_RESIDENT
+#endif
+
+/**
+ * @brief  按名称调整上限的一项
+ */
+typedef struct
+{
+    const char *name;
+    uint32_t (*set)(uint32_t limit); /*!< 返回生效的上限 */
+} PerfMemory_Limit_t;
+
+/**
+ * @brief  各模块 *_SetLimit() 的参数宽度不同，超出范围时按0(编译时容量)处理
+ */
+#ifdef PERF_MEMORY_HAS_GLYPH
+static uint32_t PerfMemory_SetGlyph(uint32_t n)
+{
+    return GlyphCache_SetLimit((n > 0xFFFFU) ? 0 : (uint16_t)n);
+}
+#endif
+#ifdef PERF_MEMORY_HAS_PIXEL
+static uint32_t PerfMemory_SetPixel(uint32_t n)
+{
+    return LCD_PixelCache_SetLimit((n > 0xFFFFU) ? 0 : (uint16_t)n);
+}
+#endif
+#ifdef PERF_MEMORY_HAS_ATLAS
+static uint32_t PerfMemory_SetAtlas(uint32_t n)
+{
+    return LCD_NumAtlas_SetLimit((n > 0xFFU) ? 0 : (uint8_t)n);
+}
+#endif
+#ifdef PERF_MEMORY_HAS_MEMO
+static uint32_t PerfMemory_SetMemo(uint32_t n)
+{
+    return LCD_TextMemo_SetLimit((n > 0xFFU) ? 0 : (uint8_t)n);
+}
+#endif
+#ifdef PERF_MEMORY_HAS_RESIDENT
+static uint32_t PerfMemory_SetResident(uint32_t n)
+{
+    return FlashFont_ResidentSetLimit((n > 0xFFFFU) ? 0 : (uint16_t)n);
+}
+#endif
+
+static const PerfMemory_Limit_t g_memory_limits[] = {
+#ifdef PERF_MEMORY_HAS_GLYPH
+    {"glyph", PerfMemory_SetGlyph},
+#endif
+#ifdef PERF_MEMORY_HAS_PIXEL
+    {"pixel", PerfMemory_SetPixel},
+#endif
+#ifdef PERF_MEMORY_HAS_ATLAS
+    {"atlas", PerfMemory_SetAtlas},
+#endif
+#ifdef PERF_MEMORY_HAS_MEMO
+    {"memo", PerfMemory_SetMemo},
+#endif
+#ifdef PERF_MEMORY_HAS_SPRITE
+    {"sprite", LCD_Sprite_SetLimit},
+#endif
+#ifdef PERF_MEMORY_HAS_RESIDENT
+    {"resident", PerfMemory_SetResident},
+#endif
+#ifdef LCD_POOL_ENABLE
+    {"arena", LCD_Arena_SetLimit},
+#endif
+    {NULL, NULL},
+};
+
+/**
+ * @brief  按地址判断存储区
+ */
+static uint8_t PerfMemory_Region(const void *base)
+{
+    uint32_t addr = (uint32_t)(uintptr_t)base;
+
+    if (addr >= 0x20000000U && addr < 0x20020000U)
+    {
+        return PERF_MEMORY_DTCM;
+    }
+    if (addr >= 0x24000000U && addr < 0x24080000U)
+    {
+        return PERF_MEMORY_AXI;
+    }
+    if (addr >= 0x30000000U && addr < 0x30048000U)
+    {
+        return PERF_MEMORY_SRAM;
+    }
+    if (addr >= 0x38000000U && addr < 0x38010000U)
+    {
+        return PERF_MEMORY_SRAM4;
+    }
+    return PERF_MEMORY_OTHER;
+}
+
+const char *PerfMemory_RegionName(uint8_t region)
+{
+    static const char *const names[PERF_MEMORY_REGIONS] = {"dtcm", "axi", "sram", "sram4", "other"};
+
+    return (region < PERF_MEMORY_REGIONS) ? names[region] : names[PERF_MEMORY_OTHER];
+}
+
+uint32_t PerfMemory_GetReport(PerfMemory_Entry_t *entries, uint32_t max)
+{
+    void (*const fill[])(PerfMemory_Entry_t *) = {
+#ifdef PERF_MEMORY_HAS_GLYPH
+        GlyphCache_GetMemory,
+#endif
+#ifdef PERF_MEMORY_HAS_PIXEL
+        LCD_PixelCache_GetMemory,
+#endif
+#ifdef PERF_MEMORY_HAS_ATLAS
+        LCD_NumAtlas_GetMemory,
+#endif
+#ifdef PERF_MEMORY_HAS_MEMO
+        LCD_TextMemo_GetMemory,
+#endif
+#ifdef PERF_MEMORY_HAS_SPRITE
+        LCD_Sprite_GetMemory,
+#endif
+#ifdef PERF_MEMORY_HAS_RESIDENT
+        FlashFont_ResidentGetMemory,
+#endif
+        NULL,
+    };
+    uint32_t n = 0;
+
+    if (entries == NULL)
+    {
+        return 0;
+    }
+    for (uint32_t i = 0; fill[i] != NULL && n < max; i++)
+    {
+        memset(&entries[n], 0, sizeof(entries[n]));
+        fill[i](&entries[n++]);
+    }
+#ifdef LCD_POOL_ENABLE
+    n += LCD_Pool_GetMemory(&entries[n], max - n);
+#endif
+    for (uint32_t i = 0; i < n; i++)
+    {
+        entries[i].region = PerfMemory_Region(entries[i].base);
+    }
+    return n;
+}
+
+uint32_t PerfMemory_SetLimit(const char *name, uint32_t limit)
+{
+    if (name == NULL)
+    {
+        return 0;
+    }
+    for (const PerfMemory_Limit_t *l = g_memory_limits; l->name != NULL; l++)
+    {
+        if (strcmp(l->name, name) == 0)
+        {
+            return l->set(limit);
+        }
+    }
+    return 0;
+}
+
+uint32_t PerfMemory_Export(PerfMemory_Write_t write)
+{
+    PerfMemory_Entry_t entries[PERF_MEMORY_ENTRIES];
+    uint32_t total[PERF_MEMORY_REGIONS] = {0};
+    uint32_t n, lines = 0;
+    char line[128];
+    int len;
+
+    if (write == NULL)
+    {
+        return 0;
+    }
+    n = PerfMemory_GetReport(entries, PERF_MEMORY_ENTRIES);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const PerfMemory_Entry_t *e = &entries[i];
+
+        len = snprintf(line, sizeof(line), "%s %s %lu %lu %lu %lu %lu %lu %lu %s\n", e->name,
+                       PerfMemory_RegionName(e->region), (unsigned long)e->bytes, (unsigned long)e->capacity,
+                       (unsigned long)e->limit, (unsigned long)e->used, (unsigned long)e->peak,
+                       (unsigned long)e->hits, (unsigned long)e->misses, e->unit);
+        if (len > (int)sizeof(line) - 1)
+        {
+            len = (int)sizeof(line) - 1;
+        }
+        write(line, (uint16_t)len);
+        total[e->region] += e->bytes;
+        lines++;
+    }
+    for (uint8_t r = 0; r < PERF_MEMORY_REGIONS; r++)
+    {
+        if (total[r] == 0)
+        {
+            continue;
+        }
+        len = snprintf(line, sizeof(line), "total %s %lu\n", PerfMemory_RegionName(r), (unsigned long)total[r]);
+        write(line, (uint16_t)len);
+        lines++;
+    }
+    return lines;
+}
+
+#endif /* PERF_MEMORY_ENABLE */
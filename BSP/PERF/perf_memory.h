@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ * @file    perf_memory.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   渲染/字库缓存内存占用报告头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - PerfMemory_GetReport() 汇总字模缓存、RGB565像素缓存、数字图集、文本解析缓存、
+ *   控件位图缓存、常驻字模、帧内分配区和已使用过的内存池，每项给出存放区域、
+ *   占用字节、编译时容量、运行时上限、当前用量、峰值和命中次数
+ * - 各缓存的存储区按编译时容量静态分配，运行时只能在此范围内调整上限：
+ *   PerfMemory_SetLimit() 按名称调用各模块的 *_SetLimit()，字模缓存和像素缓存
+ *   只移除超出上限的槽，其他缓存清空，命中统计都保留；同一固件可按产品型号调小上限，把命中率和刷新耗时对比后
+ *   再确定编译时容量(省下的RAM要改宏后重新编译才能给其他模块使用)
+ * - 区域按存储区地址判断(DTCM/AXI/SRAM1-3/SRAM4)，修改各模块的 *_ATTR 后自动反映
+ * - 只在主循环中调用；由 init.h 中的 PERF_MEMORY_ENABLE 控制，
+ *   未启用的模块不出现在报告中
+ *
+ * 使用示例：
+ *     PerfMemory_SetLimit("glyph", 32);         // 小RAM型号：字模缓存只用32槽
+ *     ...运行一段时间...
+ *     PerfMemory_Export(Uart_Write);            // 每项一行，最后按区域汇总
+ *
+ ******************************************************************************
+ */
+
+#ifndef PERF_MEMORY_H
+#define PERF_MEMORY_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define PERF_MEMORY_ENTRIES 16 /*!< PerfMemory_Export() 最多导出的项数(缓存和内存池合计) */
+
+#define PERF_MEMORY_DTCM 0  /*!< 区域：DTCM(0x20000000) */
+#define PERF_MEMORY_AXI 1   /*!< 区域：AXI SRAM(0x24000000) */
+#define PERF_MEMORY_SRAM 2  /*!< 区域：SRAM1-3(0x30000000) */
+#define PERF_MEMORY_SRAM4 3 /*!< 区域：SRAM4(0x38000000) */
+#define PERF_MEMORY_OTHER 4 /*!< 区域：其他(SDRAM、主机仿真) */
+#define PERF_MEMORY_REGIONS 5
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  一个缓存或内存池的占用
+     * @note   容量、上限、用量和峰值的单位相同，由 unit 给出
+     */
+    typedef struct
+    {
+        const char *name;  /*!< 名称，PerfMemory_SetLimit() 按此查找 */
+        const char *unit;  /*!< 容量单位："slot"/"entry"/"byte"/"block" */
+        const void *base;  /*!< 存储区首地址 */
+        uint32_t bytes;    /*!< 静态占用的RAM字节数(含索引) */
+        uint32_t capacity; /*!< 编译时容量 */
+        uint32_t limit;    /*!< 运行时上限，不能调整的项等于 capacity */
+        uint32_t used;     /*!< 当前用量 */
+        uint32_t peak;     /*!< 用量峰值(调整上限或清空后重新统计) */
+        uint32_t hits;     /*!< 命中次数，内存池和分配区为0 */
+        uint32_t misses;   /*!< 未命中次数；内存池和分配区为分配失败次数，常驻字模为未能常驻的字模数 */
+        uint8_t region;    /*!< PERF_MEMORY_DTCM 等，由 PerfMemory_GetReport() 填写 */
+        uint8_t resizable; /*!< 1-可用 PerfMemory_SetLimit() 调整 */
+    } PerfMemory_Entry_t;
+
+    /**
+     * @brief  导出输出函数
+     * @param  data: 待输出的字符
+     * @param  len: 字符数
+     */
+    typedef void (*PerfMemory_Write_t)(const char *data, uint16_t len);
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  汇总各缓存和内存池的占用
+     * @param  entries: 输出数组
+     * @param  max: 数组项数
+     * @retval 填写的项数
+     */
+    uint32_t PerfMemory_GetReport(PerfMemory_Entry_t *entries, uint32_t max);
+
+    /**
+     * @brief  按名称调整缓存的运行时上限
+     * @param  name: PerfMemory_Entry_t::name
+     * @param  limit: 新上限(单位同 capacity)，0或超过编译时容量时取编译时容量
+     * @retval 实际生效的上限，名称不存在或不能调整时返回0
+     * @note   字模缓存和像素缓存只移除超出上限的槽，其他缓存随即清空
+     */
+    uint32_t PerfMemory_SetLimit(const char *name, uint32_t limit);
+
+    /**
+     * @brief  按 "名称 区域 字节 容量 上限 已用 峰值 命中 未命中 单位" 逐行导出，
+     *         最后按 "total 区域 字节" 每个区域一行
+     * @param  write: 输出函数
+     * @retval 导出的行数
+     */
+    uint32_t PerfMemory_Export(PerfMemory_Write_t write);
+
+    /**
+     * @brief  区域名称
+     * @param  region: PERF_MEMORY_DTCM 等
+     * @retval "dtcm"/"axi"/"sram"/"sram4"/"other"
+     */
+    const char *PerfMemory_RegionName(uint8_t region);
+
+    /**
+     * @brief  各模块填写自己的占用，由 PerfMemory_GetReport() 调用
+     * @param  entry: 输出，region 不用填写
+     */
+    void GlyphCache_GetMemory(PerfMemory_Entry_t *entry);
+    void LCD_PixelCache_GetMemory(PerfMemory_Entry_t *entry);
+    void LCD_NumAtlas_GetMemory(PerfMemory_Entry_t *entry);
+    void LCD_TextMemo_GetMemory(PerfMemory_Entry_t *entry);
+    void LCD_Sprite_GetMemory(PerfMemory_Entry_t *entry);
+    void FlashFont_ResidentGetMemory(PerfMemory_Entry_t *entry);
+
+    /**
+     * @brief  填写帧内分配区和已使用过的内存池的占用
+     * @param  entries: 输出数组
+     * @param  max: 数组项数
+     * @retval 填写的项数
+     */
+    uint32_t LCD_Pool_GetMemory(PerfMemory_Entry_t *entries, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_MEMORY_H
@@ -0,0 +1,315 @@
+/**
+ ******************************************************************************
+ * @file    perf_profile.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   函数级周期剖析(编译器插桩钩子与统计导出)
+ ******************************************************************************
+ * @attention
+ *
+ * 本文件不能加插桩选项：钩子和它调用的代码被插桩会无限递归
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef PERF_PROFILE_ENABLE
+#include <stdio.h>
+#include <string.h>
+
+#if (PERF_PROFILE_FUNCS & (PERF_PROFILE_FUNCS - 1)) != 0
+#error "PERF_PROFILE_FUNCS 必须为2的幂"
+#endif
+
+#define PERF_PROFILE_MASK (PERF_PROFILE_FUNCS - 1)
+#define PERF_PROFILE_NONE 0xFFFFU /*!< 调用栈中未进入统计表的函数 */
+
+/**
+ * @brief  调用栈的一层
+ */
+typedef struct
+{
+    uint32_t start; /*!< 进入时的时间戳 */
+    uint32_t child; /*!< 子函数(含中断中被插桩函数)的inclusive之和 */
+    uint16_t slot;  /*!< 统计表项序号，PERF_PROFILE_NONE 表示未统计 */
+} PerfProfile_Frame_t;
+
+DTCM_BSS static PerfProfile_Entry_t g_prof_table[PERF_PROFILE_FUNCS]; /*!< 按地址散列的统计表 */
+DTCM_BSS static PerfProfile_Frame_t g_prof_stack[PERF_PROFILE_DEPTH]; /*!< 影子调用栈 */
+static uint32_t g_prof_depth = 0;       /*!< 当前调用深度(可超过 PERF_PROFILE_DEPTH) */
+static uint32_t g_prof_count = 0;       /*!< 统计表中的函数数 */
+static uint32_t g_prof_full = 0;        /*!< 统计表满而未单独统计的调用次数 */
+static uint32_t g_prof_deep = 0;        /*!< 调用栈过深而未单独统计的调用次数 */
+static volatile uint8_t g_prof_on = 0;  /*!< 是否正在记录 */
+
+/**
+ * @brief  查找或登记函数的统计表项
+ * @retval 表项序号，表满返回 PERF_PROFILE_NONE
+ */
+__attribute__((no_instrument_function)) ITCM_CODE static uint16_t PerfProfile_Slot(uintptr_t func)
+{
+    uint32_t i = ((uint32_t)func * 2654435761U) >> 7; // 函数地址低位对齐，取乘积的中间位
+
+    for (uint32_t n = 0; n < PERF_PROFILE_FUNCS; n++, i++)
+    {
+        PerfProfile_Entry_t *e = &g_prof_table[i & PERF_PROFILE_MASK];
+
+        if (e->func == func)
+        {
+            return (uint16_t)(i & PERF_PROFILE_MASK);
+        }
+        if (e->func == 0)
+        {
+            if (g_prof_count >= PERF_PROFILE_FUNCS * 3 / 4)
+            {
+                break; // 留出空项，查找不会退化为遍历全表
+            }
+            e->func = func;
+            g_prof_count++;
+            return (uint16_t)(i & PERF_PROFILE_MASK);
+        }
+    }
+    return PERF_PROFILE_NONE;
+}
+
+/**
+ * @brief  函数入口：压入调用栈
+ */
+__attribute__((no_instrument_function)) ITCM_CODE void __cyg_profile_func_enter(void *func, void *call_site)
+{
+    uint32_t primask;
+    uint32_t depth;
+
+    (void)call_site;
+    if (!g_prof_on)
+    {
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq(); // 中断中的被插桩函数也压在这个栈上
+    depth = g_prof_depth++;
+    if (depth < PERF_PROFILE_DEPTH)
+    {
+        PerfProfile_Frame_t *f = &g_prof_stack[depth];
+
+        f->slot = PerfProfile_Slot((uintptr_t)func);
+        if (f->slot != PERF_PROFILE_NONE)
+        {
+            g_prof_table[f->slot].active++;
+        }
+        else
+        {
+            g_prof_full++;
+        }
+        f->child = 0;
+        f->start = PERF_PROFILE_TIMESTAMP(); // 最后读取，登记的开销不计入本函数
+    }
+    else
+    {
+        g_prof_deep++;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  函数出口：弹出调用栈并累计
+ */
+__attribute__((no_instrument_function)) ITCM_CODE void __cyg_profile_func_exit(void *func, void *call_site)
+{
+    uint32_t now = PERF_PROFILE_TIMESTAMP();
+    uint32_t primask;
+    uint32_t depth;
+
+    (void)func;
+    (void)call_site;
+    if (!g_prof_on)
+    {
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    depth = g_prof_depth;
+    if (depth == 0)
+    {
+        __set_PRIMASK(primask); // PerfProfile_Start() 之前进入的调用
+        return;
+    }
+    g_prof_depth = --depth;
+    if (depth < PERF_PROFILE_DEPTH)
+    {
+        PerfProfile_Frame_t *f = &g_prof_stack[depth];
+        uint32_t incl = now - f->start;
+
+        if (f->slot != PERF_PROFILE_NONE)
+        {
+            PerfProfile_Entry_t *e = &g_prof_table[f->slot];
+
+            e->calls++;
+            e->exclusive += (incl > f->child) ? incl - f->child : 0;
+            if (--e->active == 0)
+            {
+                e->inclusive += incl; // 递归时只在最外层累计
+            }
+            if (incl > e->max)
+            {
+                e->max = incl;
+            }
+        }
+        if (depth > 0)
+        {
+            g_prof_stack[depth - 1].child += incl;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  清空统计表、使能DWT并开始记录
+ */
+void PerfProfile_Start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55; // 解锁DWT
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    g_prof_on = 0;
+    memset(g_prof_table, 0, sizeof(g_prof_table));
+    g_prof_depth = 0;
+    g_prof_count = 0;
+    g_prof_full = 0;
+    g_prof_deep = 0;
+    g_prof_on = 1;
+}
+
+/**
+ * @brief  停止记录
+ */
+void PerfProfile_Stop(void)
+{
+    g_prof_on = 0;
+}
+
+/**
+ * @brief  按exclusive从大到小取前max个函数
+ * @retval 填写的项数
+ */
+uint32_t PerfProfile_GetTop(PerfProfile_Entry_t *entries, uint32_t max)
+{
+    uint32_t n = 0;
+
+    if (entries == NULL)
+    {
+        return 0;
+    }
+    for (uint32_t i = 0; i < PERF_PROFILE_FUNCS; i++)
+    {
+        const PerfProfile_Entry_t *e = &g_prof_table[i];
+        uint32_t k;
+
+        if (e->func == 0 || e->calls == 0)
+        {
+            continue;
+        }
+        // 插入排序：数组保持降序，满了以后挤掉最小的
+        for (k = n; k > 0 && entries[k - 1].exclusive < e->exclusive; k--)
+        {
+            if (k < max)
+            {
+                entries[k] = entries[k - 1];
+            }
+        }
+        if (k < max)
+        {
+            entries[k] = *e;
+            if (n < max)
+            {
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief  取未单独统计的调用次数
+ */
+void PerfProfile_GetDropped(uint32_t *full, uint32_t *deep)
+{
+    if (full != NULL)
+    {
+        *full = g_prof_full;
+    }
+    if (deep != NULL)
+    {
+        *deep = g_prof_deep;
+    }
+}
+
+/**
+ * @brief  逐行导出exclusive最多的top个函数
+ * @retval 导出的函数数
+ */
+uint32_t PerfProfile_Export(PerfProfile_Write_t write, uint32_t top)
+{
+    PerfProfile_Entry_t e = {0};
+    uint8_t on = g_prof_on;
+    uint64_t last = UINT64_MAX;
+    uintptr_t last_func = 0;
+    uint32_t n = 0;
+    char line[96];
+    int len;
+
+    if (write == NULL)
+    {
+        return 0;
+    }
+    g_prof_on = 0; // 输出函数和snprintf可能也被插桩
+    len = snprintf(line, sizeof(line), "profile %lu %lu %lu %lu\n", (unsigned long)g_prof_count,
+                   (unsigned long)g_prof_full, (unsigned long)g_prof_deep,
+                   (unsigned long)(SystemCoreClock / 1000000));
+    write(line, (uint16_t)len);
+
+    // 逐个取下一个较小的项，不需要按 top 开输出数组(相同exclusive按地址排序)
+    while (top == 0 || n < top)
+    {
+        uint8_t found = 0;
+
+        for (uint32_t i = 0; i < PERF_PROFILE_FUNCS; i++)
+        {
+            const PerfProfile_Entry_t *c = &g_prof_table[i];
+
+            if (c->func == 0 || c->calls == 0)
+            {
+                continue;
+            }
+            if (c->exclusive > last || (c->exclusive == last && c->func <= last_func))
+            {
+                continue; // 已经输出过
+            }
+            if (!found || c->exclusive > e.exclusive || (c->exclusive == e.exclusive && c->func < e.func))
+            {
+                e = *c;
+                found = 1;
+            }
+        }
+        if (!found)
+        {
+            break;
+        }
+        last = e.exclusive;
+        last_func = e.func;
+        len = snprintf(line, sizeof(line), "0x%08lx %lu %llu %llu %lu\n", (unsigned long)e.func,
+                       (unsigned long)e.calls, (unsigned long long)e.inclusive, (unsigned long long)e.exclusive,
+                       (unsigned long)e.max);
+        if (len > (int)sizeof(line) - 1)
+        {
+            len = (int)sizeof(line) - 1;
+        }
+        write(line, (uint16_t)len);
+        n++;
+    }
+    g_prof_on = on;
+    return n;
+}
+
+#endif /* PERF_PROFILE_ENABLE */
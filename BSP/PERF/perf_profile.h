@@ -0,0 +1,135 @@
+/**
+ ******************************************************************************
+ * @file    perf_profile.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   函数级周期剖析头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 编译器在每个函数的入口和出口插入 __cyg_profile_func_enter/exit() 调用
+ *   (ARMCC 的 --gnu_instrument，GCC/ARMCLANG 的 -finstrument-functions)，
+ *   本模块用DWT周期计数器记录进出时间，按函数地址累计调用次数、
+ *   包含子函数的周期(inclusive)、不含子函数的周期(exclusive)和单次最长
+ * - 只对要分析的源文件打开插桩选项：lcd_spi.c、lcd_ctrl.c、flash_font.c、
+ *   glyph_cache.c、glyph_prefetch.c、qspi_flash.c 等，即 LCD_*、FlashFont_*、
+ *   QSPI_W25Qxx_* 所在的模块；同一文件中的静态函数一并统计，
+ *   本文件和其他未加选项的文件不插桩
+ * - 统计表为按地址开放寻址的固定表(PERF_PROFILE_FUNCS 项)，表满后新函数只计入
+ *   父函数的exclusive，调用栈深度超过 PERF_PROFILE_DEPTH 时同样处理
+ * - 中断中执行的被插桩函数压在同一个调用栈上，其耗时从被打断的函数的
+ *   exclusive中扣除；记录时关中断，被插桩的函数整体变慢，每次调用约多数十个周期，
+ *   因此只用于定位热点，不用于测量绝对耗时
+ * - 递归调用的inclusive只在最外层返回时累计一次
+ * - 板上没有符号表，导出为函数地址，用 Tools/profile_view.py 按MDK的.map文件
+ *   或GCC的 nm 输出换算为函数名
+ * - 由 init.h 中的 PERF_PROFILE_ENABLE 控制，未定义时不编译；
+ *   PerfProfile_Start() 会使能DWT
+ *
+ * 使用示例：
+ *     PerfProfile_Start();
+ *     DrawPage();                       // 需要分析的操作
+ *     PerfProfile_Stop();
+ *     PerfProfile_Export(Uart_Write, 20); // exclusive最多的20个函数
+ *
+ ******************************************************************************
+ */
+
+#ifndef PERF_PROFILE_H
+#define PERF_PROFILE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define PERF_PROFILE_FUNCS 128 /*!< 统计表项数，必须为2的幂，每项40字节(放在DTCM) */
+#define PERF_PROFILE_DEPTH 32  /*!< 记录的最大调用深度，每层12字节 */
+
+#ifndef PERF_PROFILE_TIMESTAMP
+#define PERF_PROFILE_TIMESTAMP() (DWT->CYCCNT) /*!< 时间戳来源，单位为CPU周期 */
+#endif
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  一个函数的统计(单位均为CPU周期)
+     */
+    typedef struct
+    {
+        uintptr_t func;     /*!< 函数地址(Thumb函数最低位为1)，0为空项 */
+        uint32_t calls;     /*!< 调用次数 */
+        uint32_t max;       /*!< 单次调用最长的inclusive */
+        uint64_t inclusive; /*!< 包含子函数的周期 */
+        uint64_t exclusive; /*!< 不含子函数(和中断中被插桩函数)的周期 */
+        uint16_t active;    /*!< 正在执行的层数(递归时大于1) */
+    } PerfProfile_Entry_t;
+
+    /**
+     * @brief  导出输出函数
+     * @param  data: 待输出的字符
+     * @param  len: 字符数
+     */
+    typedef void (*PerfProfile_Write_t)(const char *data, uint16_t len);
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  清空统计表、使能DWT并开始记录
+     * @retval None
+     * @note   在未被插桩的代码(主循环)中调用；进行中的调用返回时不再计入
+     */
+    void PerfProfile_Start(void);
+
+    /**
+     * @brief  停止记录，统计保留
+     * @retval None
+     */
+    void PerfProfile_Stop(void);
+
+    /**
+     * @brief  按exclusive从大到小取前n个函数
+     * @param  entries: 输出数组
+     * @param  max: 数组项数
+     * @retval 填写的项数
+     */
+    uint32_t PerfProfile_GetTop(PerfProfile_Entry_t *entries, uint32_t max);
+
+    /**
+     * @brief  取统计表满和调用栈过深而未单独统计的调用次数
+     * @param  full: 输出统计表满的次数，可为NULL
+     * @param  deep: 输出调用栈过深的次数，可为NULL
+     * @retval None
+     */
+    void PerfProfile_GetDropped(uint32_t *full, uint32_t *deep);
+
+    /**
+     * @brief  按 "地址 调用次数 inclusive exclusive 最长" 逐行导出exclusive最多的n个函数，
+     *         首行为 "profile 函数数 表满次数 过深次数 MHz"
+     * @param  write: 输出函数
+     * @param  top: 导出的函数数，0为全部
+     * @retval 导出的函数数
+     * @note   导出期间暂停记录(输出函数可能也被插桩)，完成后恢复原来的状态
+     */
+    uint32_t PerfProfile_Export(PerfProfile_Write_t write, uint32_t top);
+
+    /**
+     * @brief  编译器插入的入口/出口钩子，不要直接调用
+     */
+    void __cyg_profile_func_enter(void *func, void *call_site) __attribute__((no_instrument_function));
+    void __cyg_profile_func_exit(void *func, void *call_site) __attribute__((no_instrument_function));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_PROFILE_H
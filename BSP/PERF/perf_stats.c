@@ -0,0 +1,131 @@
+/**
+ ******************************************************************************
+ * @file    perf_stats.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   热点路径计数器
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef PERF_STATS_ENABLE
+#include <stdio.h>
+#include <string.h>
+
+#if PERF_GLYPH_PROFILE_SLOTS & (PERF_GLYPH_PROFILE_SLOTS - 1)
+#error "PERF_GLYPH_PROFILE_SLOTS 必须为2的幂"
+#endif
+
+DTCM_BSS PerfStats_t g_perf_stats; /*!< 全局计数，计数宏直接访问 */
+
+#if PERF_GLYPH_PROFILE_SLOTS > 0
+/**
+ * @brief  码点统计表项，cp为0表示空位
+ */
+typedef struct
+{
+    uint32_t cp;
+    uint32_t count;
+} PerfGlyphSlot_t;
+
+DTCM_BSS static PerfGlyphSlot_t g_perf_glyphs[PERF_GLYPH_PROFILE_SLOTS]; /*!< 开放寻址哈希表 */
+#endif
+
+/**
+ * @brief  清零全部计数并使能DWT周期计数器
+ * @retval None
+ */
+void PerfStats_Reset(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55; // 解锁DWT
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    memset(&g_perf_stats, 0, sizeof(g_perf_stats));
+#if PERF_GLYPH_PROFILE_SLOTS > 0
+    memset(g_perf_glyphs, 0, sizeof(g_perf_glyphs));
+#endif
+}
+
+/**
+ * @brief  读取当前计数
+ * @param  stats: 输出计数
+ * @retval None
+ */
+void PerfStats_Get(PerfStats_t *stats)
+{
+    if (stats != NULL)
+    {
+        *stats = g_perf_stats;
+    }
+}
+
+/**
+ * @brief  记录一次从QSPI读取的汉字字模
+ * @param  cp: Unicode码点
+ * @retval None
+ */
+ITCM_CODE void PerfStats_GlyphFetch(uint32_t cp)
+{
+#if PERF_GLYPH_PROFILE_SLOTS > 0
+    uint32_t i = (cp * 2654435761UL) & (PERF_GLYPH_PROFILE_SLOTS - 1);
+
+    // 线性探测，最多查满一圈
+    for (uint32_t n = 0; n < PERF_GLYPH_PROFILE_SLOTS; n++)
+    {
+        PerfGlyphSlot_t *slot = &g_perf_glyphs[i];
+
+        if (slot->cp == cp)
+        {
+            slot->count++;
+            return;
+        }
+        if (slot->cp == 0)
+        {
+            slot->cp = cp;
+            slot->count = 1;
+            return;
+        }
+        i = (i + 1) & (PERF_GLYPH_PROFILE_SLOTS - 1);
+    }
+    g_perf_stats.glyph_profile_dropped++;
+#else
+    (void)cp;
+#endif
+}
+
+/**
+ * @brief  按 "U+XXXX 次数" 逐行导出码点统计
+ * @param  write: 输出函数
+ * @retval 导出的码点数
+ */
+uint32_t PerfStats_ExportGlyphProfile(PerfStats_Write_t write)
+{
+    uint32_t lines = 0;
+#if PERF_GLYPH_PROFILE_SLOTS > 0
+    char line[32];
+    int len;
+
+    if (write == NULL)
+    {
+        return 0;
+    }
+    for (uint32_t i = 0; i < PERF_GLYPH_PROFILE_SLOTS; i++)
+    {
+        if (g_perf_glyphs[i].cp == 0)
+        {
+            continue;
+        }
+        len = snprintf(line, sizeof(line), "U+%04lX %lu\n",
+                       (unsigned long)g_perf_glyphs[i].cp,
+                       (unsigned long)g_perf_glyphs[i].count);
+        write(line, (uint16_t)len);
+        lines++;
+    }
+#else
+    (void)write;
+#endif
+    return lines;
+}
+
+#endif /* PERF_STATS_ENABLE */
@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ * @file    perf_stats.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   热点路径计数器头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 常开的低开销计数器，运行时随时读取，用来定位超出帧预算的画面
+ * - 统计字模查找各层(常驻子集/字模缓存/QSPI)的命中次数、从QSPI读取的字模
+ *   字节数、SPI发送字节数与传输次数、SPI数据宽度切换次数、LCD_SetAddress()
+ *   调用次数、单色填充像素数，以及阻塞在 LCD_SPI_WaitOnFlagUntilTimeout() / LCD_WaitIdle()
+ *   中的CPU周期数
+ * - 每个计数点只是一次全局变量自增，计数器放在DTCM；耗时用DWT周期计数器，
+ *   PerfStats_Reset() 会使能DWT
+ * - 由 init.h 中的 PERF_STATS_ENABLE 控制，未定义时所有计数宏展开为空
+ * - 计数器为32位，@480MHz 等待周期约9秒回绕，读取前按需 PerfStats_Reset()
+ * - 另按码点统计从QSPI读取汉字字模的次数(PERF_GLYPH_PROFILE_SLOTS 个码点)，
+ *   PerfStats_ExportGlyphProfile() 按 "U+4E2D 次数" 逐行输出，交给
+ *   fontbuild.py --profile 把常用字排在一起，减少QSPI读取的Cache行数
+ *
+ * 使用示例：
+ *     PerfStats_t s;
+ *     PerfStats_Reset();
+ *     DrawPage();           // 需要分析的画面
+ *     PerfStats_Get(&s);    // s.glyph_qspi、s.spi_wait_cycles ...
+ *     PerfStats_ExportGlyphProfile(Uart_Write); // 保存为 profile.txt
+ *
+ ******************************************************************************
+ */
+
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define PERF_GLYPH_PROFILE_SLOTS 512 /*!< 字模读取统计的码点数(2的幂，0为不统计)，每个8字节放在DTCM，表满后新码点只计入 glyph_profile_dropped */
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  热点路径计数
+     */
+    typedef struct
+    {
+        uint32_t glyph_resident;  /*!< 字模命中常驻子集次数 */
+        uint32_t glyph_cache;     /*!< 字模命中字模缓存次数 */
+        uint32_t glyph_qspi;      /*!< 字模从QSPI读取次数 */
+        uint32_t glyph_missing;   /*!< 字库中不存在的字符数 */
+        uint32_t qspi_bytes;      /*!< 从QSPI读取的字模字节数 */
+        uint32_t spi_bytes;       /*!< SPI发送字节数(指令 + 数据) */
+        uint32_t spi_transfers;   /*!< SPI传输次数(阻塞 + DMA) */
+        uint32_t spi_reconfigs;   /*!< SPI数据宽度切换次数(取代原 HAL_SPI_Init 调用) */
+        uint32_t set_address;     /*!< LCD_SetAddress() 调用次数 */
+        uint32_t window_skips;    /*!< 列或行范围与上次相同而省去的 CASET/RASET 次数 */
+        uint32_t window_continues; /*!< 新窗口接着写指针继续写入、不发送任何指令的次数 */
+        uint32_t spi_wait_cycles; /*!< 阻塞在 LCD_SPI_WaitOnFlagUntilTimeout() 的周期数 */
+        uint32_t dma_wait_cycles; /*!< 阻塞在 LCD_WaitIdle() 等待DMA的周期数 */
+        uint32_t fill_pixels;     /*!< 以单色填充写入的像素数(矩形、清屏、线段等) */
+        uint32_t glyph_profile_dropped; /*!< 码点统计表已满而未记录的汉字字模读取次数 */
+    } PerfStats_t;
+
+    /**
+     * @brief  导出输出函数
+     * @param  data: 待输出的字符
+     * @param  len: 字符数
+     */
+    typedef void (*PerfStats_Write_t)(const char *data, uint16_t len);
+
+    extern PerfStats_t g_perf_stats;
+
+    /*******************************************************************************
+     *                          计数宏
+     ******************************************************************************/
+
+#define PERF_COUNT(field) (g_perf_stats.field++)                   /*!< 计数加1 */
+#define PERF_ADD(field, n) (g_perf_stats.field += (uint32_t)(n))   /*!< 计数加n */
+#define PERF_TIMER_START(t) uint32_t t = DWT->CYCCNT               /*!< 记录起始周期，须放在声明区 */
+#define PERF_TIMER_STOP(field, t) PERF_ADD(field, DWT->CYCCNT - (t)) /*!< 累加经过的周期 */
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  清零全部计数并使能DWT周期计数器
+     * @retval None
+     */
+    void PerfStats_Reset(void);
+
+    /**
+     * @brief  读取当前计数
+     * @param  stats: 输出计数
+     * @retval None
+     */
+    void PerfStats_Get(PerfStats_t *stats);
+
+    /**
+     * @brief  记录一次从QSPI读取的汉字字模
+     * @param  cp: Unicode码点
+     * @retval None
+     * @note   由 flash_font.c 在绕过常驻子集和字模缓存时调用
+     */
+    void PerfStats_GlyphFetch(uint32_t cp);
+
+    /**
+     * @brief  按 "U+XXXX 次数" 逐行导出码点统计
+     * @param  write: 输出函数
+     * @retval 导出的码点数
+     * @note   按统计表顺序输出，不排序(fontbuild.py 按次数排序)
+     */
+    uint32_t PerfStats_ExportGlyphProfile(PerfStats_Write_t write);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_STATS_H
@@ -0,0 +1,191 @@
+/**
+ ******************************************************************************
+ * @file    perf_trace.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   渲染时间线事件记录与Chrome Trace导出
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef PERF_TRACE_ENABLE
+#include <stdio.h>
+#include <string.h>
+
+#if (PERF_TRACE_DEPTH & (PERF_TRACE_DEPTH - 1)) != 0
+#error "PERF_TRACE_DEPTH 必须为2的幂"
+#endif
+
+#define PERF_TRACE_MASK (PERF_TRACE_DEPTH - 1)
+
+DTCM_BSS static PerfTrace_Entry_t g_trace_ring[PERF_TRACE_DEPTH]; /*!< 事件缓冲区 */
+static volatile uint32_t g_trace_head = 0; /*!< 下一条事件的序号，只增不减 */
+static volatile uint8_t g_trace_on = 0;    /*!< 是否正在记录 */
+
+/* 事件名与所在的时间线，同一时间线上的开始/结束事件按嵌套关系显示 */
+static const char *const g_trace_names[PERF_TRACE_EVENT_COUNT] = {
+    "resolve", "expand", "spi", "dma", "qspi_map", "qspi_unmap"};
+static const uint8_t g_trace_tid[PERF_TRACE_EVENT_COUNT] = {1, 1, 2, 2, 3, 3};
+static const char *const g_trace_threads[] = {"CPU", "LCD SPI", "QSPI"};
+
+#define PERF_TRACE_THREADS (sizeof(g_trace_threads) / sizeof(g_trace_threads[0]))
+
+/**
+ * @brief  输出以0结尾的字符串
+ */
+static void PerfTrace_Puts(PerfTrace_Write_t write, const char *s)
+{
+    write(s, (uint16_t)strlen(s));
+}
+
+/**
+ * @brief  清空缓冲区、使能DWT并开始记录
+ */
+void PerfTrace_Start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55; // 解锁DWT
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    g_trace_on = 0;
+    g_trace_head = 0;
+    g_trace_on = 1;
+}
+
+/**
+ * @brief  停止记录
+ */
+void PerfTrace_Stop(void)
+{
+    g_trace_on = 0;
+}
+
+/**
+ * @brief  记录一条事件，可在中断中调用
+ */
+ITCM_CODE void PerfTrace_Record(uint8_t event, uint8_t phase, uint32_t arg)
+{
+    PerfTrace_Entry_t *e;
+    uint32_t idx;
+
+    if (!g_trace_on)
+    {
+        return;
+    }
+    // 中断可能在主循环写入途中插入，用独占访问分配槽位，双方各写各的槽
+    do
+    {
+        idx = __LDREXW(&g_trace_head);
+    } while (__STREXW(idx + 1, &g_trace_head) != 0U);
+
+    e = &g_trace_ring[idx & PERF_TRACE_MASK];
+    e->ts = PERF_TRACE_TIMESTAMP();
+    e->arg = (arg > 0xFFFF) ? 0xFFFF : (uint16_t)arg;
+    e->event = event;
+    e->phase = phase;
+}
+
+/**
+ * @brief  自开始记录以来的事件总数
+ */
+uint32_t PerfTrace_Count(void)
+{
+    return g_trace_head;
+}
+
+/**
+ * @brief  以Chrome Trace(JSON)格式导出
+ */
+void PerfTrace_Export(PerfTrace_Write_t write)
+{
+    char line[160];
+    uint32_t head = g_trace_head;
+    uint32_t first = (head > PERF_TRACE_DEPTH) ? head - PERF_TRACE_DEPTH : 0;
+    uint32_t mhz = SystemCoreClock / 1000000;
+    uint8_t depth[PERF_TRACE_THREADS + 1] = {0};
+    const char *sep = "";
+    int64_t cycles = 0;
+    uint32_t prev;
+    int len;
+
+    if (write == NULL)
+    {
+        return;
+    }
+    if (mhz == 0)
+    {
+        mhz = 1;
+    }
+
+    PerfTrace_Puts(write, "{\"traceEvents\":[\n");
+    for (uint8_t i = 0; i < PERF_TRACE_THREADS; i++)
+    {
+        len = snprintf(line, sizeof(line),
+                       "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                       sep, i + 1, g_trace_threads[i]);
+        write(line, (uint16_t)len);
+        sep = ",\n";
+    }
+
+    prev = g_trace_ring[first & PERF_TRACE_MASK].ts;
+    for (uint32_t i = first; i < head; i++)
+    {
+        const PerfTrace_Entry_t *e = &g_trace_ring[i & PERF_TRACE_MASK];
+        uint64_t t;
+        uint8_t tid;
+
+        if (e->event >= PERF_TRACE_EVENT_COUNT)
+        {
+            continue;
+        }
+        // 按相邻差值累加，CYCCNT回绕不影响；中断插入的事件可能比前一条略早
+        cycles += (int32_t)(e->ts - prev);
+        prev = e->ts;
+        t = (cycles > 0) ? (uint64_t)cycles : 0;
+
+        tid = g_trace_tid[e->event];
+        if (e->phase == 'B')
+        {
+            depth[tid]++;
+        }
+        else if (e->phase == 'E')
+        {
+            if (depth[tid] == 0)
+            {
+                continue; // 对应的开始事件已被覆盖
+            }
+            depth[tid]--;
+        }
+
+        len = snprintf(line, sizeof(line),
+                       "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu.%03lu,\"pid\":1,\"tid\":%u%s,\"args\":{\"n\":%u}}",
+                       sep, g_trace_names[e->event], e->phase, (unsigned long)(t / mhz),
+                       (unsigned long)((t % mhz) * 1000 / mhz), tid, (e->phase == 'i') ? ",\"s\":\"t\"" : "",
+                       e->arg);
+        write(line, (uint16_t)len);
+    }
+    PerfTrace_Puts(write, "\n],\"displayTimeUnit\":\"ns\"}\n");
+}
+
+#ifdef PERF_TRACE_ITM
+/**
+ * @brief  逐字节写入ITM端口0，调试器未连接时 ITM_SendChar() 直接返回
+ */
+static void PerfTrace_WriteITM(const char *data, uint16_t len)
+{
+    while (len--)
+    {
+        ITM_SendChar((uint8_t)*data++);
+    }
+}
+
+/**
+ * @brief  经ITM端口0(SWO)导出
+ */
+void PerfTrace_ExportITM(void)
+{
+    PerfTrace_Export(PerfTrace_WriteITM);
+}
+#endif
+
+#endif /* PERF_TRACE_ENABLE */
@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ * @file    perf_trace.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   渲染时间线事件记录头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - DTCM中的环形事件缓冲区，记录字模查找、字模展开、SPI阻塞传输、
+ *   BDMA后台传输(启动到完成中断)和QSPI映射模式切换的开始/结束时间，
+ *   用来观察查找、展开与发送三个阶段的并行情况
+ * - 时间戳为DWT周期计数，PerfTrace_Start() 会使能DWT
+ * - 写入不加锁：主循环是主要写入方，DMA完成中断也会写入，
+ *   槽位用 LDREX/STREX 原子递增分配，不需要关中断
+ * - 缓冲区写满后覆盖最旧的事件，只保留最近 PERF_TRACE_DEPTH 条
+ * - PerfTrace_Export() 按Chrome Trace(JSON)格式输出，保存为.json后可用
+ *   chrome://tracing 或 ui.perfetto.dev 打开；输出函数由调用者提供(串口等)，
+ *   定义 PERF_TRACE_ITM 后 PerfTrace_ExportITM() 直接经SWO输出
+ * - 由 init.h 中的 PERF_TRACE_ENABLE 控制，未定义时所有记录宏展开为空
+ *
+ * 使用示例：
+ *     static void Uart_Write(const char *s, uint16_t len) {
+ *         HAL_UART_Transmit(&huart1, (uint8_t *)s, len, 1000);
+ *     }
+ *     PerfTrace_Start();
+ *     DrawPage();                 // 需要分析的画面
+ *     PerfTrace_Stop();
+ *     PerfTrace_Export(Uart_Write);
+ *
+ ******************************************************************************
+ */
+
+#ifndef PERF_TRACE_H
+#define PERF_TRACE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define PERF_TRACE_DEPTH 1024 /*!< 事件缓冲区条数，必须为2的幂，每条8字节 */
+// #define PERF_TRACE_ITM /*!< 定义了：提供 PerfTrace_ExportITM()，经ITM端口0(SWO)输出, 注释后：只能用自定义输出函数 */
+
+#ifndef PERF_TRACE_TIMESTAMP
+#define PERF_TRACE_TIMESTAMP() (DWT->CYCCNT) /*!< 时间戳来源，单位为CPU周期 */
+#endif
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  事件类型
+     */
+    typedef enum
+    {
+        PERF_TRACE_RESOLVE = 0, /*!< 字模查找(批量解析/缓存未命中时查表) */
+        PERF_TRACE_EXPAND,      /*!< 字模展开为RGB565 */
+        PERF_TRACE_SPI,         /*!< SPI阻塞传输 */
+        PERF_TRACE_DMA,         /*!< BDMA后台传输，结束于完成中断 */
+        PERF_TRACE_QSPI_MAP,    /*!< QSPI进入内存映射模式 */
+        PERF_TRACE_QSPI_UNMAP,  /*!< QSPI退出内存映射模式 */
+        PERF_TRACE_EVENT_COUNT
+    } PerfTrace_Event_t;
+
+    /**
+     * @brief  单条事件(8字节)
+     */
+    typedef struct
+    {
+        uint32_t ts;   /*!< 时间戳(CPU周期) */
+        uint16_t arg;  /*!< 附加参数(像素数、字符数等)，超过65535时截断 */
+        uint8_t event; /*!< PerfTrace_Event_t */
+        uint8_t phase; /*!< 'B'-开始, 'E'-结束, 'i'-瞬时 */
+    } PerfTrace_Entry_t;
+
+    /**
+     * @brief  导出输出函数
+     * @param  data: 待输出的字符
+     * @param  len: 字符数
+     */
+    typedef void (*PerfTrace_Write_t)(const char *data, uint16_t len);
+
+    /*******************************************************************************
+     *                          记录宏
+     ******************************************************************************/
+
+#define PERF_TRACE_BEGIN(ev, arg) PerfTrace_Record((ev), 'B', (arg)) /*!< 事件开始 */
+#define PERF_TRACE_END(ev, arg) PerfTrace_Record((ev), 'E', (arg))   /*!< 事件结束 */
+#define PERF_TRACE_MARK(ev, arg) PerfTrace_Record((ev), 'i', (arg))  /*!< 瞬时事件 */
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  清空缓冲区、使能DWT并开始记录
+     * @retval None
+     */
+    void PerfTrace_Start(void);
+
+    /**
+     * @brief  停止记录，缓冲区内容保留到下一次 PerfTrace_Start()
+     * @retval None
+     */
+    void PerfTrace_Stop(void);
+
+    /**
+     * @brief  记录一条事件，未开始记录时直接返回
+     * @param  event: PerfTrace_Event_t
+     * @param  phase: 'B' / 'E' / 'i'
+     * @param  arg: 附加参数
+     * @retval None
+     * @note   可在中断中调用
+     */
+    void PerfTrace_Record(uint8_t event, uint8_t phase, uint32_t arg);
+
+    /**
+     * @brief  取得自 PerfTrace_Start() 以来记录的事件总数(含已被覆盖的)
+     * @retval 事件总数
+     */
+    uint32_t PerfTrace_Count(void);
+
+    /**
+     * @brief  以Chrome Trace(JSON)格式导出缓冲区中的事件
+     * @param  write: 输出函数
+     * @retval None
+     * @note   应在 PerfTrace_Stop() 之后调用；被覆盖掉开始事件的结束事件不输出
+     */
+    void PerfTrace_Export(PerfTrace_Write_t write);
+
+#ifdef PERF_TRACE_ITM
+    /**
+     * @brief  经ITM端口0(SWO)导出，调试器的SWV窗口或 openocd itm 保存为文件
+     * @retval None
+     */
+    void PerfTrace_ExportITM(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_TRACE_H
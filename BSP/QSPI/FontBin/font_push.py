@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+font_push.py - 通过USB CDC/串口把字库镜像写入开发板的非活动分区
+
+配合 font_stream.c(init.h 中定义 FONT_STREAM_ENABLE)使用，不需要
+STM32CubeProgrammer 和外部下载算法(.stldr)。传输格式(小端):
+    头   uint32 magic "FUPD", uint32 size, uint32 check(~(magic ^ size))
+    块   镜像按扇区(4KB, 两片并联时8KB)依次分块, 每块 数据 + uint32 crc(zlib.crc32)
+开发板写完并提交分区头后回复 'K'，任何一块出错回复 'E'，本工具等待
+开发板丢弃剩余数据后从头重发；已写好的扇区内容相同，重发时不再擦写。
+
+用法:
+    python font_push.py COM5 merged_fonts.bin
+    python font_push.py /dev/ttyACM0 font_pack.bin --retry 3
+    python font_push.py COM5 dual.bin --dual   # 两片并联(QSPI_DUAL_FLASH_ENABLE)
+"""
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+try:
+    import serial
+except ImportError:
+    sys.exit("需要 pyserial: pip install pyserial")
+
+MAGIC = 0x44505546  # "FUPD"
+BLOCK = 4096
+BANK_LIMIT = 0x2FF000  # 分区头之前的容量(FONT_BANK_HDR_OFS)
+DUAL_BLOCK = 8192  # 两片并联时的扇区大小(W25Qxx_SectorSize)
+DUAL_BANK_LIMIT = 0x2FE000
+GAP_S = 0.2  # 大于 FONT_STREAM_GAP_MS，出错后等开发板恢复接收
+
+
+def push_once(port, image, block):
+    """发送一次完整镜像，返回开发板的回复字节(b'K'/b'E'/b'')"""
+    size = len(image)
+    port.reset_input_buffer()
+    port.write(struct.pack("<III", MAGIC, size, ~(MAGIC ^ size) & 0xFFFFFFFF))
+    start = time.time()
+    for ofs in range(0, size, block):
+        data = image[ofs:ofs + block]
+        port.write(data + struct.pack("<I", zlib.crc32(data) & 0xFFFFFFFF))
+        if port.in_waiting:  # 只有出错时才会提前回复
+            return port.read(1)
+        done = ofs + len(data)
+        rate = done / max(time.time() - start, 1e-3) / 1024
+        print("\r  %7d / %d 字节  %6.1f KB/s" % (done, size, rate), end="")
+    print()
+    return port.read(1)  # 等待最后一块写入和提交
+
+
+def main():
+    parser = argparse.ArgumentParser(description="通过串口更新开发板字库")
+    parser.add_argument("port", help="串口名，如 COM5 或 /dev/ttyACM0")
+    parser.add_argument("image", help="fontbin_tool.py 生成的字库镜像")
+    parser.add_argument("--baud", type=int, default=115200,
+                        help="串口波特率，USB CDC忽略此参数")
+    parser.add_argument("--retry", type=int, default=2, help="出错后重发次数")
+    parser.add_argument("--timeout", type=float, default=10.0,
+                        help="等待提交回复的秒数")
+    parser.add_argument("--dual", action="store_true",
+                        help="开发板为两片Flash并联(按8KB分块)")
+    args = parser.parse_args()
+    block = DUAL_BLOCK if args.dual else BLOCK
+    limit = DUAL_BANK_LIMIT if args.dual else BANK_LIMIT
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+    if not image or len(image) > limit:
+        sys.exit("镜像大小 %d 字节，应在1到%d字节之间" % (len(image), limit))
+    if args.dual and len(image) & 1:
+        sys.exit("两片并联时镜像须为偶数字节，请用 fontbin_tool.py --dual 生成")
+
+    with serial.Serial(args.port, args.baud, timeout=args.timeout) as port:
+        for attempt in range(args.retry + 1):
+            reply = push_once(port, image, block)
+            if reply == b"K":
+                print("完成，开发板已切换到新字库")
+                return
+            print("开发板回复 %r，第%d次重发" % (reply, attempt + 1))
+            time.sleep(GAP_S)
+    sys.exit("更新失败")
+
+
+if __name__ == "__main__":
+    main()
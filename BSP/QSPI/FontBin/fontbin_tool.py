@@ -0,0 +1,1463 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+fontbin_tool.py - merged_fonts.bin 后处理工具
+
+在原始字库文件末尾(4KB对齐)追加加速查找用的附加数据段，
+驱动(flash_font.c)在 FlashFont_Init 时校验各段魔数，
+段不存在时自动回退到原有的线性查找，因此新旧bin文件均可使用。
+
+附加段统一格式(与原 GB2312/UTF8 对照表一致):
+    uint32_t magic;      段魔数
+    uint32_t count;      数据项数量
+    uint32_t hdr_size;   段头大小(12)
+    ...数据项...
+
+随后在 +0x280000 写入字库目录(TOC)，逐段描述类型、字号、宽高、格式、
+步长、数量和索引方式，驱动初始化时只解析目录，不再依赖固定偏移:
+    目录头  uint32 magic "FTOC", uint16 version, uint16 count,
+            uint32 hdr_size(16), uint32 entry_size(28)
+    目录项  uint8 type, format, width, height, index_type, first,
+            uint16 stride, uint32 count, offset, size,
+            uint8 family(字体族, 0为默认字体), uint8 flags, 2字节保留,
+            uint32 crc(段数据的CRC32, 与 zlib.crc32 相同, flags位0为1时有效)
+    除字库标志段外各段都带CRC, 驱动在空闲时用硬件CRC单元校验, 写了一半的
+    字库不会显示乱码; 旧固件按entry_size跳过末尾的crc, 仍可使用本镜像
+
+可选在分区最后4KB写入A/B分区头(序号)，用于后台更新到非活动分区:
+    uint32_t magic;      "FBNK"
+    uint32_t seq;        分区序号, 越大越新
+    uint32_t size;       字库镜像字节数(不含分区头)
+    uint32_t check;      ~(magic ^ seq ^ size)
+
+可选(--pack)生成紧凑镜像：各段按目录顺序从分区起始依次排列，汉字字模段
+改为行程压缩格式(FMT_1BPP_RLE)，只在压缩后更小时采用，ASCII保持原格式。
+压缩字模段布局:
+    uint32 base[(count+255)/256]   每256字一个基址(相对段起始)
+    uint16 ofs[count]              各字相对块基址的偏移
+    每字: 行标记(height+7)/8字节(位r=1表示第r行为新行) + 依次存放的新行,
+          位r=0的行与上一行相同(第0行之前视为空行)
+紧凑镜像只能通过目录访问，不能再作为本工具的输入。
+
+可选(--row32 字号,...)与 --pack 同用, 把这些字号的汉字字模段改为每行补齐到
+4字节(FMT_1BPP_ROW32), 不再压缩, 段起始4字节对齐。驱动按32位字读取字模行,
+一次取32列; 32号本来就是每行4字节, 不增加空间; 24号每字由72字节增至96字节,
+完整GB2312字符集时紧凑镜像放不下, 只适合裁剪过字符集的镜像。
+
+可选(--aa 字号:位深)生成2bpp/4bpp抗锯齿灰度字模段(汉字与ASCII各一段)，
+由最大号的1bpp字模按面积平均缩小得到，放在目录扇区之后(+0x281000)。
+每行 (width*bpp+7)/8 字节，像素低位在前，0为背景，最大值为前景。
+抗锯齿段较大(16号2bpp汉字约470KB)，超出分区头之前的空间时报错，
+加 ":ascii" 只生成ASCII段(每个字号只有几KB)。
+
+可选(--metrics)由ASCII字模统计笔画范围，生成比例宽度的字宽表和字偶距表，
+同样放在目录扇区之后，驱动据此让 LCD_DisplayText 只发送有笔画的列加字间距:
+    字宽表  每字符 int8 x(从字模单元第几列开始), uint8 advance(占用列数)
+            字母/符号: 笔画宽度 + 间距(字号/16, 至少1); 数字等宽并居中; 空格 字号/4
+    字偶距表 uint8 左字符, uint8 右字符, int8 调整量, uint8 保留, 按字符对升序
+            只收录两字符笔画之间空隙明显(>=3倍间距)的字符对, 调整量只去掉
+            左字符右侧的空白列, 不会与左字符笔画重叠
+原地更新时字宽表偏移同时写入ASCII文件头各字体信息的保留字段。
+
+可选(--bounds)为每个汉字字号生成笔画外框表, 索引与字模段相同, 每字4字节
+uint8 x, y, w, h (w/h为0表示空白字), 放在目录扇区之后。驱动绘制标点等外框
+较小的字时, 四周直接发送背景色, 只展开外框内的像素。
+
+可选(--image 文件)把RGB565图片(开机画面、图标)放进同一分区, 可重复,
+图片编号按参数顺序从0开始。支持24/32位未压缩BMP, 或 "宽x高:文件" 形式的
+原始RGB565小端数据(与 Image2Lcd 小端输出、LCD_CopyBuffer 的数据相同)。
+所有图片合为一段, 放在目录扇区之后:
+    图片表  每张 uint16 width, uint16 height, uint32 offset(相对段起始)
+    像素    逐行存放的uint16 RGB565, 每张图片4字节对齐
+驱动由 LCD_DrawFlashImage 直接从映射地址经MDMA/BDMA发送, 不再逐像素展开。
+
+可选(--indexed 文件)追加调色板图片(图标等颜色少的图片), 可重复, 编号按参数顺序,
+输入为4/8位未压缩BMP(保留其调色板), 或24/32位BMP(按RGB565去重后不超过256色)。
+不超过16色时存为4bpp, 否则8bpp, 读取量是RGB565的1/4或1/2。所有图片合为一段:
+    图片表  每张 uint16 width, uint16 height, uint8 bpp, uint8 0, uint16 colors,
+            uint32 offset(调色板相对段起始)
+    调色板  colors 个uint16 RGB565, 补齐到4字节
+    像素    每行 (width*bpp+7)/8 字节, 4bpp低4位在前(与DMA2D的L4格式相同)
+驱动由 LCD_DrawFlashIndexed 经DTCM查找表展开(帧缓冲+DMA2D时按L8/L4直接转换)。
+
+可选(--rle 文件)追加行程压缩的RGB565图片(大面积纯色的界面背景), 可重复,
+编号按参数顺序, 输入与 --image 相同。所有图片合为一段:
+    图片表  每张 uint16 width, uint16 height, uint32 offset, uint32 size
+    数据    uint16记号流, 跨行连续: 最高位为1时后跟1个颜色, 重复(记号&0x7FFF)+1
+            次; 最高位为0时后跟 记号+1 个原样的颜色
+驱动由 LCD_DrawFlashRLE 边解码边经BDMA发送, 不需要整幅图片的RAM。
+
+可选(--jpeg 文件)追加基线JPEG图片(照片类背景), 可重复, 编号同样按参数顺序,
+由 LCD_JPEG_DrawFlash 经硬件JPEG解码后写屏。渐进式和算术编码的JPEG
+硬件不支持, 直接报错。所有JPEG合为一段:
+    图片表  每张 uint16 width, uint16 height, uint32 offset, uint32 size
+    数据    原始JPEG文件, 补齐到4字节(硬件按32位字读取输入)
+
+可选(--strings 语言:文件)追加界面字符串表, 可重复, 每种语言一段。文件为UTF-8文本,
+每行 "名字=文字"(#开头的行和空行忽略, 文字中 \\n 表示换行), 编号按语言0文件中的顺序,
+其他语言按名字对应, 没有翻译的字符串显示语言0的。--strings-header 输出
+#define STR_名字 编号 的头文件。每段:
+    字符串表  每个 uint32 offset(相对段起始), uint32 bytes(0表示没有译文)
+    字符串    UTF-8, 各以'\\0'结尾
+驱动由 LCD_DisplayStringID 直接从映射地址显示, 不拷贝到RAM。每种语言另有一段字符集:
+该语言显示的全部字符串(含没有译文时的语言0字符串)去重后的字符(UTF-8, '\\0'结尾), 出现次数多的在前, 切换语言时
+GlyphPrefetch_SetLanguage 按它在后台把字模预取到字模缓存。
+
+可选(--blocks)生成两级Unicode分块索引, 码点高字节查页表得到块号, 低字节在
+块内直接取字库索引, 查找固定读取QSPI两次, 与字数无关; 字数超过RAM哈希表
+容量(GBK/GB18030等2万字以上)时不必再二分查找排序索引:
+    页表    uint16 page[256], 0xFFFF表示该页没有字
+    块      uint16 block[n][256], 只为有字的页分配, 0xFFFF表示没有该字
+只覆盖BMP, 补充平面字符仍查排序索引。GB2312全集约100页, 约50KB。
+
+可选(--packed-index)再生成4字节一项的压缩排序索引, 每项为
+(码点 << 位数) | 字库索引, 按码点升序; 位数取能容纳最大字库索引的位数(至少11),
+记在目录项的width中, 其余高位须能放下最大码点。二分查找每次只读4字节, 7464字
+共约30KB, 是8字节排序索引的一半。8字节排序索引照常生成, 旧驱动不受影响。
+
+可选(--index-codes)生成字库索引编码表, 第i项为字库索引i的 uint16 Unicode码点
+和 uint16 GBK码(0xFFFF表示没有), 只收录BMP字符。驱动按GBK解码文本时经区位
+映射表得到字库索引, 再读一项得到码点; 反向转换同样经排序索引落到字库索引。
+7464字共约30KB; 没有本段时驱动扫描排序索引和区位映射表, 结果相同但较慢。
+
+可选(--phash)生成码点 -> 字库索引的最小完美哈希(CHD), 驱动启动时由MDMA把整段一次
+拷贝到RAM哈希表的存储区直接使用, 不再逐项读取对照表建立哈希表, 查找只访问一个槽:
+    桶种子  uint16 seed[2^width]   码点乘法哈希的高width位选桶
+    槽      uint16 cp, uint16 index [count]   count = BMP字数, 没有空槽
+槽号 = mix((seed << 16) | cp) * count >> 32, mix 为 MurmurHash3 的32位收尾混合;
+平均每桶约4字, 7464字共约33KB。不在字库中的码点落到某个已占用的槽, 驱动比较cp排除。
+
+可选(--records 字数)把字库索引最前的这些字的各字号字模交错存放为多字号记录
+(每条记录依次为12/16/20/24/32号未压缩字模, 全部字号共316字节), 放在目录扇区
+之后, 每个字号一个目录项(offset为该字号在记录中的起始, stride为记录长度)。
+同一屏混用多个字号时常用字只落在少数Flash页内; 通常与 fontbuild.py --profile
+同用, 使常用字排在最前。只用于未压缩镜像, 不能与 --pack 同用。
+
+可选(--family 编号:文件[:字号,...][:ascii])把另一套字体(粗体数字、界面黑体等)
+的字模段加入同一分区, 作为字体族"编号"(1-7), 可重复。文件为同样原始布局的
+merged_fonts.bin, 字符集和字库索引必须与输入相同(各字体族共用对照表、排序索引
+和分块索引), 只复制其中的汉字/ASCII字模段, 放在目录扇区之后, 目录项的family
+为该编号。默认复制全部字号, 可只列部分字号, 加 ":ascii" 只复制ASCII段;
+驱动中该字体族没有的字号和字符使用字体族0。同时指定 --metrics/--bounds 时
+为其生成对应的字宽表/外框表, --pack 时汉字字模段同样压缩, 并优先放在紧凑
+镜像与目录之间的空闲区(其余附加段之后的空间很小, 放不下完整字符集的汉字字号)。
+
+可选(--dual)生成两片Flash并联(qspi_flash.h 中的 QSPI_DUAL_FLASH_ENABLE)用的镜像:
+映射地址上的布局不变, 偶数字节存在BK1、奇数字节存在BK2, 每片在分区地址/2处。
+扇区按两片合计为8KB, 分区头改在 +0x2FE000; 压缩字模每字从偶数地址开始, 一个
+QSPI时钟同时取到两片的首字节; 镜像补齐到偶数字节(间接写入的字节数须为偶数)。
+除合并镜像外另外输出 <输出>.bk1.bin / <输出>.bk2.bin, 用编程器分别烧录两片,
+串口在线更新(font_push.py --dual)和SD卡安装使用合并镜像。
+
+可选(--extra-sizes 字号,...)生成原始布局以外字号(14/18/28等)的1bpp汉字和ASCII
+字模段(ASCII宽度为字号/2), 由同类最大号的字模按面积平均缩小, 覆盖过半的像素
+置1; 与 --pack 同用时汉字字模段同样压缩, 并与字体族一样优先放在紧凑镜像与目录
+之间的空闲区。驱动按目录中的字号建立段描述, LCD_SetTextFont(14) 即可使用。
+
+可选(--sizes 字号,...)只保留这些字号的汉字/ASCII字模段, 与固件 init.h 中的
+FONT_SIZES 对应。与 --pack 同用时其余字号的字模不进入紧凑镜像, 不占Flash;
+未压缩镜像保持原始布局, 只是目录中不再列出其余字号。抗锯齿、字宽表、外框表、
+多字号记录和字体族同样只生成这些字号, 抗锯齿段仍可由未保留的更大字号缩小。
+
+用法:
+    python fontbin_tool.py merged_fonts.bin            # 原地更新
+    python fontbin_tool.py merged_fonts.bin -o out.bin
+    python fontbin_tool.py merged_fonts.bin --seq 2    # 同时写入分区头
+    python fontbin_tool.py merged_fonts.bin --pack -o packed.bin
+    python fontbin_tool.py merged_fonts.bin --pack --row32 32 -o word.bin
+    python fontbin_tool.py merged_fonts.bin --aa 16:2 --aa 24:4:ascii -o aa.bin
+    python fontbin_tool.py merged_fonts.bin --metrics -o prop.bin
+    python fontbin_tool.py merged_fonts.bin --bounds -o box.bin
+    python fontbin_tool.py merged_fonts.bin --image logo.bmp --image 32x32:icon.raw
+    python fontbin_tool.py merged_fonts.bin --jpeg splash.jpg
+    python fontbin_tool.py merged_fonts.bin --indexed icon16.bmp --indexed logo256.bmp
+    python fontbin_tool.py merged_fonts.bin --rle 240x320:background.raw
+    python fontbin_tool.py merged_fonts.bin --strings 0:zh.txt --strings 1:en.txt --strings-header ui_strings.h
+    python fontbin_tool.py merged_fonts.bin --blocks -o blocks.bin
+    python fontbin_tool.py merged_fonts.bin --packed-index -o index32.bin
+    python fontbin_tool.py merged_fonts.bin --index-codes -o gbk.bin
+    python fontbin_tool.py merged_fonts.bin --phash -o phash.bin
+    python fontbin_tool.py merged_fonts.bin --family 1:bold.bin:24,32:ascii -o ui.bin
+    python fontbin_tool.py merged_fonts.bin --pack --dual --seq 1 -o dual.bin
+    python fontbin_tool.py merged_fonts.bin --pack --sizes 16,24 -o small.bin
+    python fontbin_tool.py merged_fonts.bin --pack --extra-sizes 14,18 -o more.bin
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+# ---------------------------------------------------------------------------
+# 原始布局(相对于 BASE_ADDR 的偏移, 与 flash_font.h 保持一致)
+# ---------------------------------------------------------------------------
+GLYPH_OFS = (0x0, 0x2BBE0, 0x66100, 0xD3680, 0x1569E0)  # 12/16/20/24/32 汉字字模区
+GLYPH_HDR = "<4sHHIIH"        # magic "23BG", 宽, 高, 数量, 保留, 每字节数 (18字节)
+GB2312_TABLE_OFS = 0x23FE00
+UTF8_TABLE_OFS = 0x2472D0
+FONT_FLAG_OFS = 0x2572F0
+FONT_FLAG_SIZE = 12
+ASCII_FONTS_OFS = 0x267310
+ASCII_CHARS = 95              # 0x20-0x7E
+LEGACY_END_OFS = 0x26B634     # 原始 merged_fonts.bin 长度
+
+TABLE_HDR_SIZE = 12
+TABLE_ENTRIES = 7464          # 原始对照表项数
+
+# ---------------------------------------------------------------------------
+# 附加段布局
+# ---------------------------------------------------------------------------
+UTF8_SORTED_OFS = 0x26C000    # 按码点排序的UTF-8索引
+UTF8_SORTED_MAGIC = b"U8SR"
+GB2312_MAP_OFS = 0x27B000     # GB2312区位码直接映射表
+GB2312_MAP_MAGIC = b"GBDM"
+GB2312_ROWS = 94              # 区: 0xA1-0xFE
+GB2312_COLS = 94              # 位: 0xA1-0xFE
+NO_GLYPH = 0xFFFF
+
+TOC_OFS = 0x280000            # 字库目录
+TOC_MAGIC = b"FTOC"
+TOC_VERSION = 1
+TOC_HDR = "<4sHHII"
+TOC_ENTRY = "<BBBBBBHIIIBB2xI"  # 末尾为字体族, 标志, 2字节保留, CRC32
+TOC_F_CRC = 0x01              # 目录项标志: crc有效
+
+SEC_GLYPH, SEC_ASCII, SEC_GB2312_TABLE, SEC_UTF8_TABLE = 1, 2, 3, 4
+SEC_UTF8_SORTED, SEC_GB2312_MAP, SEC_FLAG = 5, 6, 7
+SEC_GLYPH_AA, SEC_ASCII_AA = 8, 9
+SEC_ASCII_METRICS, SEC_ASCII_KERN, SEC_GLYPH_BOX = 10, 11, 12
+SEC_IMAGE, SEC_JPEG, SEC_UNICODE_BLOCKS = 13, 14, 15
+SEC_GLYPH_RECORD, SEC_UTF8_PACKED, SEC_INDEX_CODES = 16, 17, 18
+SEC_UTF8_PHASH, SEC_INDEXED_IMAGE, SEC_RLE_IMAGE = 19, 20, 21
+SEC_STRINGS, SEC_STRING_CHARS = 22, 23
+FMT_NONE, FMT_1BPP_ROW, FMT_1BPP_RLE = 0, 1, 2
+FMT_2BPP_ROW, FMT_4BPP_ROW, FMT_RGB565, FMT_JPEG = 3, 4, 5, 6
+FMT_1BPP_ROW32 = 7            # 每行按4字节补齐, 驱动按32位字读取
+FMT_INDEXED = 8               # RGB565调色板 + 4/8bpp颜色序号
+FMT_RLE565 = 9                # RGB565行程压缩记号流
+IMAGE_ENTRY = "<HHI"          # 图片表项: 宽, 高, 像素偏移(相对段起始)
+JPEG_ENTRY = "<HHII"          # JPEG表项: 宽, 高, 数据偏移, 数据字节数
+INDEXED_ENTRY = "<HHBBHI"     # 调色板图片表项: 宽, 高, 位深, 保留, 颜色数, 调色板偏移
+RLE_ENTRY = "<HHII"           # 行程压缩图片表项: 宽, 高, 数据偏移, 数据字节数
+RLE_REPEAT, RLE_MAX_RUN = 0x8000, 0x8000  # 重复记号标志, 一个记号最多的像素数
+RLE_MIN_REPEAT = 3            # 至少连续3个相同颜色才拆成重复段
+STRING_ENTRY = "<II"          # 字符串表项: 偏移(相对段起始), 字节数(不含'\0')
+LANG_MAX = 16                 # FONT_LANG_MAX, 语言编号上限(不含)
+EXTRA_OFS = 0x281000          # 字宽表/抗锯齿字模段, 紧接目录所在扇区之后
+RLE_BLOCK_BITS = 8            # 压缩字模段每256字一个基址
+IDX_NONE, IDX_TABLE, IDX_CODE = 0, 1, 2
+BLOCK_PAGES = 256             # Unicode分块索引页表项数(BMP码点高字节)
+PACKED_MIN_BITS = 11          # 压缩排序索引中字库索引的最少位数
+PACKED_MAX_BITS = 15          # FONT_PACKED_INDEX_MAX_BITS, 驱动的字库索引为int16
+PHASH_KEYS_PER_BUCKET = 4     # 完美哈希平均每桶字数, 越大种子表越小、搜索越慢
+PHASH_MAX_BUCKET_BITS = 15    # 种子表最多 2^15 项(64KB)
+MAX_FAMILY = 7                # 字体族编号上限(驱动缓存键中占3位)
+
+REGION_SIZE = 0x300000        # 字库分区大小(A区为外部flash最后3MB, B区紧邻其前)
+BANK_A_ADDR = 0x1D00000       # A分区起始(相对Flash起始, 与 flash_font.h 一致)
+BANK_B_ADDR = 0x1A00000       # B分区起始
+BANK_HDR_OFS = 0x2FF000       # 分区头偏移(分区最后一个4KB扇区)
+DUAL_BANK_HDR_OFS = 0x2FE000  # 双片并联时的分区头偏移(两片合计8KB扇区)
+DUAL_GLYPH_ALIGN = 2          # 双片并联时压缩字模的起始对齐(每个时钟读两片各一字节)
+BANK_MAGIC = b"FBNK"
+ERASED = 0xFF
+
+
+def read_legacy_utf8_table(data):
+    """读取原始UTF-8对照表, 返回 {码点: 字库索引}, 跳过无效项"""
+    if data[UTF8_TABLE_OFS:UTF8_TABLE_OFS + 4] != b"UTF8":
+        raise ValueError("UTF8对照表魔数错误")
+    count = struct.unpack_from("<I", data, UTF8_TABLE_OFS + 4)[0]
+    mapping = {}
+    for i in range(min(count, TABLE_ENTRIES)):
+        ofs = UTF8_TABLE_OFS + TABLE_HDR_SIZE + i * 8
+        utf8_len = data[ofs]
+        raw = bytes(data[ofs + 1:ofs + 1 + utf8_len])
+        index = struct.unpack_from("<H", data, ofs + 5)[0]
+        try:
+            text = raw.decode("utf-8")
+        except UnicodeDecodeError:
+            continue
+        # 生成脚本中不可映射的字符被写成 "??" 等双字节ASCII, 驱动永远无法命中
+        if len(text) != 1:
+            continue
+        mapping.setdefault(ord(text), index)
+    return mapping
+
+
+def read_legacy_gb2312_table(data):
+    """读取原始GB2312对照表, 返回 {GBK码: 字库索引}"""
+    if data[GB2312_TABLE_OFS:GB2312_TABLE_OFS + 4] != b"GLBT":
+        raise ValueError("GB2312对照表魔数错误")
+    count = struct.unpack_from("<I", data, GB2312_TABLE_OFS + 4)[0]
+    mapping = {}
+    for i in range(min(count, TABLE_ENTRIES)):
+        code, index = struct.unpack_from(
+            "<HH", data, GB2312_TABLE_OFS + TABLE_HDR_SIZE + i * 4)
+        if code == NO_GLYPH:
+            break
+        mapping.setdefault(code, index)
+    return mapping
+
+
+def build_gb2312_map(mapping):
+    """生成94x94区位直接映射表: map[(区-0xA1)*94+(位-0xA1)] = 字库索引, 0xFFFF=无字形"""
+    table = [NO_GLYPH] * (GB2312_ROWS * GB2312_COLS)
+    for code, index in mapping.items():
+        row, col = (code >> 8) - 0xA1, (code & 0xFF) - 0xA1
+        if 0 <= row < GB2312_ROWS and 0 <= col < GB2312_COLS:
+            table[row * GB2312_COLS + col] = index
+    out = bytearray(GB2312_MAP_MAGIC)
+    out += struct.pack("<II", len(table), TABLE_HDR_SIZE)
+    out += struct.pack("<%dH" % len(table), *table)
+    return out
+
+
+def build_utf8_sorted(mapping):
+    """生成按码点升序排列的索引段: uint32 code + uint16 index + uint16 reserved"""
+    out = bytearray(UTF8_SORTED_MAGIC)
+    out += struct.pack("<II", len(mapping), TABLE_HDR_SIZE)
+    for cp in sorted(mapping):
+        out += struct.pack("<IHH", cp, mapping[cp], 0)
+    return out
+
+
+def build_unicode_blocks(mapping):
+    """生成两级Unicode分块索引段: 页表[256] + 每个有字的页一块256项"""
+    pages = sorted({cp >> 8 for cp in mapping if cp <= 0xFFFF})
+    table = [NO_GLYPH] * (BLOCK_PAGES * (len(pages) + 1))
+    for n, page in enumerate(pages):
+        table[page] = n
+    for cp, index in mapping.items():
+        if cp > 0xFFFF:
+            continue  # 补充平面字符仍由排序索引查找
+        if index > 0x7FFF:
+            raise ValueError("字库索引 %d 超出驱动支持的范围" % index)
+        block = table[cp >> 8]
+        table[BLOCK_PAGES * (block + 1) + (cp & 0xFF)] = index
+    print("  Unicode分块索引: %d 页, %d 字节" % (len(pages), len(table) * 2))
+    return ((SEC_UNICODE_BLOCKS, FMT_NONE, 0, 0, IDX_NONE, 0, 2, len(table)),
+            struct.pack("<%dH" % len(table), *table))
+
+
+def build_utf8_packed(mapping):
+    """生成4字节一项的压缩排序索引段: (码点 << 位数) | 字库索引"""
+    bits = max(PACKED_MIN_BITS, max(mapping.values(), default=0).bit_length())
+    if bits > PACKED_MAX_BITS:
+        raise ValueError("字库索引 %d 超出压缩索引支持的范围" %
+                         max(mapping.values()))
+    top = max(mapping, default=0)
+    if top >> (32 - bits):
+        raise ValueError("码点 U+%X 超出 %d 位字库索引时压缩索引的码点范围" %
+                         (top, bits))
+    table = [(cp << bits) | mapping[cp] for cp in sorted(mapping)]
+    print("  压缩排序索引: %d 项, 字库索引 %d 位, %d 字节" %
+          (len(table), bits, len(table) * 4))
+    return ((SEC_UTF8_PACKED, FMT_NONE, bits, 0, IDX_NONE, 0, 4, len(table)),
+            struct.pack("<%dI" % len(table), *table))
+
+
+def build_index_codes(utf8_map, gb_map):
+    """生成字库索引编码表: 每个字库索引一项 uint16 码点 + uint16 GBK码"""
+    count = max(list(utf8_map.values()) + list(gb_map.values()), default=-1) + 1
+    table = [[NO_GLYPH, NO_GLYPH] for _ in range(count)]
+    for cp, index in utf8_map.items():
+        if cp <= 0xFFFF and table[index][0] == NO_GLYPH:
+            table[index][0] = cp
+    for code, index in gb_map.items():
+        if table[index][1] == NO_GLYPH:
+            table[index][1] = code
+    print("  字库索引编码表: %d 项, %d 字节" % (count, count * 4))
+    return ((SEC_INDEX_CODES, FMT_NONE, 0, 0, IDX_NONE, 0, 4, count),
+            b"".join(struct.pack("<HH", *item) for item in table))
+
+
+def phash_mix(x):
+    """MurmurHash3 fmix32, 与 flash_font.c 中的 FontPHash_Mix() 一致"""
+    x ^= x >> 16
+    x = (x * 0x85EBCA6B) & 0xFFFFFFFF
+    x ^= x >> 13
+    x = (x * 0xC2B2AE35) & 0xFFFFFFFF
+    return x ^ (x >> 16)
+
+
+def phash_bucket(cp, bits):
+    """码点所在的桶: 乘法哈希的高bits位"""
+    return ((cp * 2654435761) & 0xFFFFFFFF) >> (32 - bits)
+
+
+def phash_search(keys, bits):
+    """按桶从大到小为每个桶找一个种子, 使桶内各字落到互不相同的空槽
+
+    返回种子表, 某个桶的种子用尽时返回None
+    """
+    count = len(keys)
+    buckets = [[] for _ in range(1 << bits)]
+    for cp in keys:
+        buckets[phash_bucket(cp, bits)].append(cp)
+    used = bytearray(count)
+    seeds = [0] * len(buckets)
+    for b in sorted(range(len(buckets)), key=lambda i: -len(buckets[i])):
+        if not buckets[b]:
+            break
+        for seed in range(0x10000):
+            slots = {(phash_mix((seed << 16) | cp) * count) >> 32
+                     for cp in buckets[b]}
+            if len(slots) == len(buckets[b]) and not any(used[i] for i in slots):
+                for i in slots:
+                    used[i] = 1
+                seeds[b] = seed
+                break
+        else:
+            return None
+    return seeds
+
+
+def build_utf8_phash(mapping):
+    """生成码点 -> 字库索引的最小完美哈希段: 桶种子表 + 每字一槽"""
+    keys = sorted(cp for cp in mapping if 0 < cp <= 0xFFFF)
+    if not keys:
+        raise ValueError("没有BMP字符, 无法生成完美哈希")
+    if max(mapping[cp] for cp in keys) > 0x7FFF:
+        raise ValueError("字库索引超出驱动支持的范围")
+    bits = max(1, (len(keys) // PHASH_KEYS_PER_BUCKET).bit_length())
+    while True:
+        if bits > PHASH_MAX_BUCKET_BITS:
+            raise ValueError("完美哈希搜索失败")
+        seeds = phash_search(keys, bits)
+        if seeds is not None:
+            break
+        bits += 1  # 桶更小更容易放下
+    count = len(keys)
+    table = [None] * count
+    for cp in keys:
+        seed = seeds[phash_bucket(cp, bits)]
+        table[(phash_mix((seed << 16) | cp) * count) >> 32] = (cp, mapping[cp])
+    assert all(item is not None for item in table)
+    blob = struct.pack("<%dH" % len(seeds), *seeds)
+    blob += b"".join(struct.pack("<HH", *item) for item in table)
+    print("  完美哈希: %d 字, %d 桶, %d 字节" % (count, len(seeds), len(blob)))
+    return ((SEC_UTF8_PHASH, FMT_NONE, bits, 0, IDX_NONE, 0, 4, count), blob)
+
+
+def build_record_section(data, entries, count):
+    """把字库索引最前的count个字的各字号字模交错为记录
+
+    返回 (各字号的 (目录项, 记录内偏移), 数据), 数据末尾补齐到最后一个字号的
+    目录项按 count*stride 计算的结尾
+    """
+    planes = [e for e in entries if e[0] == SEC_GLYPH]
+    count = min([count] + [e[7] for e in planes])
+    record = sum(e[6] for e in planes)
+    blob = bytearray()
+    for i in range(count):
+        for e in planes:
+            stride, ofs = e[6], e[8]
+            blob += data[ofs + i * stride:ofs + (i + 1) * stride]
+    metas, pos = [], 0
+    for e in planes:
+        metas.append(((SEC_GLYPH_RECORD, FMT_1BPP_ROW, e[2], e[3], IDX_TABLE,
+                       0, record, count), pos))
+        pos += e[6]
+    blob += bytes([ERASED]) * (record - planes[-1][6])
+    print("  多字号记录: %d 字, 每条 %d 字节, 共 %d 字节" %
+          (count, record, len(blob)))
+    return metas, blob
+
+
+def place(data, offset, blob):
+    """把数据段写到指定偏移, 中间空隙以0xFF(擦除值)填充"""
+    if offset + len(blob) > REGION_SIZE:
+        raise ValueError("附加段超出字库区域: 0x%X" % (offset + len(blob)))
+    if len(data) < offset:
+        data += bytes([ERASED]) * (offset - len(data))
+    data[offset:offset + len(blob)] = blob
+
+
+def build_toc_entries(data, utf8_count, gb_map_count):
+    """由原始布局各段文件头生成字库目录项"""
+    entries = []
+    for ofs in GLYPH_OFS:
+        magic, width, height, count, _, stride = struct.unpack_from(
+            GLYPH_HDR, data, ofs)
+        if magic != b"23BG":
+            raise ValueError("字模区魔数错误 @ +0x%X" % ofs)
+        entries.append((SEC_GLYPH, FMT_1BPP_ROW, width, height, IDX_TABLE, 0,
+                        stride, count, ofs + struct.calcsize(GLYPH_HDR),
+                        count * stride))
+
+    if data[ASCII_FONTS_OFS:ASCII_FONTS_OFS + 4] != b"ASCI":
+        raise ValueError("ASCII字库魔数错误")
+    num = struct.unpack_from("<I", data, ASCII_FONTS_OFS + 4)[0]
+    for i in range(num):
+        offset, size, width, height = struct.unpack_from(
+            "<IIHH", data, ASCII_FONTS_OFS + 8 + i * 16)
+        entries.append((SEC_ASCII, FMT_1BPP_ROW, width, height, IDX_CODE,
+                        0x20, size // ASCII_CHARS, ASCII_CHARS,
+                        ASCII_FONTS_OFS + offset, size))
+
+    for sec, ofs, stride in ((SEC_GB2312_TABLE, GB2312_TABLE_OFS, 4),
+                             (SEC_UTF8_TABLE, UTF8_TABLE_OFS, 8)):
+        count = min(struct.unpack_from("<I", data, ofs + 4)[0], TABLE_ENTRIES)
+        entries.append((sec, FMT_NONE, 0, 0, IDX_NONE, 0, stride, count,
+                        ofs + TABLE_HDR_SIZE, count * stride))
+    entries.append((SEC_UTF8_SORTED, FMT_NONE, 0, 0, IDX_NONE, 0, 8,
+                    utf8_count, UTF8_SORTED_OFS + TABLE_HDR_SIZE,
+                    utf8_count * 8))
+    entries.append((SEC_GB2312_MAP, FMT_NONE, 0, 0, IDX_NONE, 0, 2,
+                    gb_map_count, GB2312_MAP_OFS + TABLE_HDR_SIZE,
+                    gb_map_count * 2))
+    entries.append((SEC_FLAG, FMT_NONE, 0, 0, IDX_NONE, 0, FONT_FLAG_SIZE, 1,
+                    FONT_FLAG_OFS, FONT_FLAG_SIZE))
+    return entries
+
+
+def build_toc(entries, data):
+    """把目录项打包为字库目录, 没有字体族字段的目录项属于字体族0
+
+    各段的CRC32由已放置好的镜像数据计算; 字库标志段可能在烧录最后单独写入,
+    不带CRC(驱动另外检查其魔数)
+    """
+    out = bytearray(struct.pack(TOC_HDR, TOC_MAGIC, TOC_VERSION, len(entries),
+                                struct.calcsize(TOC_HDR),
+                                struct.calcsize(TOC_ENTRY)))
+    for e in entries:
+        e = tuple(e) + (0,) * (11 - len(e))
+        offset, size = e[8], e[9]
+        if e[0] == SEC_FLAG:
+            flags, crc = 0, 0
+        else:
+            if offset + size > len(data):
+                raise ValueError("目录项超出镜像: 0x%X" % (offset + size))
+            flags, crc = TOC_F_CRC, zlib.crc32(data[offset:offset + size])
+        out += struct.pack(TOC_ENTRY, *(e + (flags, crc)))
+    return out
+
+
+def pack_glyph(raw, bytes_per_row, height):
+    """行程压缩单个字模: 行标记 + 与上一行不同的行"""
+    tags = bytearray((height + 7) // 8)
+    rows = bytearray()
+    prev = bytes(bytes_per_row)
+    for r in range(height):
+        row = raw[r * bytes_per_row:(r + 1) * bytes_per_row]
+        if row != prev:
+            tags[r >> 3] |= 1 << (r & 7)
+            rows += row
+            prev = row
+    return tags + rows
+
+
+def pack_glyph_plane(plane, width, height, count, stride, align=1):
+    """行程压缩整个字模段, 返回 块基址 + 字偏移 + 字模数据
+
+    align>1 时每字起始按该字节数对齐(段起始本身4字节对齐), 驱动由行标记
+    计算字模长度, 字之间的填充字节不会被读取
+    """
+    bytes_per_row = (width + 7) // 8
+    blocks = (count + (1 << RLE_BLOCK_BITS) - 1) >> RLE_BLOCK_BITS
+    index_size = blocks * 4 + count * 2
+    bases, offsets, payload = [], [], bytearray()
+    for i in range(count):
+        payload += bytes([ERASED]) * (-(index_size + len(payload)) % align)
+        if i & ((1 << RLE_BLOCK_BITS) - 1) == 0:
+            bases.append(index_size + len(payload))
+        offsets.append(index_size + len(payload) - bases[-1])
+        payload += pack_glyph(plane[i * stride:(i + 1) * stride],
+                              bytes_per_row, height)
+    out = bytearray(struct.pack("<%dI" % blocks, *bases))
+    out += struct.pack("<%dH" % count, *offsets)
+    return out + payload
+
+
+def pack_glyph_section(plane, width, height, count, stride, align=1):
+    """逐段比较压缩前后的大小, 压缩后不更小时保持原格式, 返回 (字模段, 格式)
+
+    笔画密集的小字号(如12x12)行间差异大, 行标记和字偏移反而使段变大
+    """
+    rle = pack_glyph_plane(plane, width, height, count, stride, align)
+    if len(rle) < len(plane):
+        return rle, FMT_1BPP_RLE
+    return plane, FMT_1BPP_ROW
+
+
+def pad_glyph_plane(plane, width, height, count, stride):
+    """字模每行补齐到4字节(FMT_1BPP_ROW32), 返回 (字模段, 新步长)"""
+    bytes_per_row = (width + 7) // 8
+    padded = (width + 31) // 32 * 4
+    pad = bytes(padded - bytes_per_row)
+    out = bytearray()
+    for i in range(count):
+        raw = plane[i * stride:(i + 1) * stride]
+        for r in range(height):
+            out += raw[r * bytes_per_row:(r + 1) * bytes_per_row] + pad
+    return out, padded * height
+
+
+def build_packed_image(data, entries, row32=(), align=1):
+    """把各段依次排到分区起始处, 汉字字模段在压缩后更小时改为压缩格式,
+    row32 中的字号改为每行按4字节补齐, align 为压缩字模的起始对齐"""
+    image = bytearray()
+    packed = []
+    for e in entries:
+        sec, fmt, width, height, index_type, first, stride, count, ofs, size = e
+        blob = data[ofs:ofs + size]
+        if sec == SEC_GLYPH and height in row32:
+            blob, stride = pad_glyph_plane(blob, width, height, count, stride)
+            fmt = FMT_1BPP_ROW32
+            print("  %dx%d 字模: %d -> %d 字节(每行按4字节补齐)" %
+                  (width, height, size, len(blob)))
+        elif sec == SEC_GLYPH:
+            blob, fmt = pack_glyph_section(blob, width, height, count, stride,
+                                           align)
+            print("  %dx%d 字模: %d -> %d 字节%s" %
+                  (width, height, size, len(blob),
+                   "" if fmt == FMT_1BPP_RLE else "(压缩不更小, 保持原格式)"))
+        image += bytes([ERASED]) * (-len(image) % 4)  # 段起始4字节对齐
+        packed.append((sec, fmt, width, height, index_type, first, stride,
+                       count, len(image), len(blob)))
+        image += blob
+    if len(image) > TOC_OFS:
+        raise ValueError("紧凑镜像超出目录位置: 0x%X" % len(image))
+    return image, packed
+
+
+def axis_weights(src, dst):
+    """缩放的单轴面积权重: 目标像素t覆盖的源像素及重叠长度(单位 1/dst 源像素)"""
+    weights = []
+    for t in range(dst):
+        lo, hi = t * src, (t + 1) * src
+        weights.append([(s, min(hi, (s + 1) * dst) - max(lo, s * dst))
+                        for s in range(lo // dst, (hi - 1) // dst + 1)])
+    return weights
+
+
+def downsample_glyph(glyph, src_w, src_h, dst_w, dst_h, bpp):
+    """把1bpp字模按面积平均缩小为灰度字模, 返回按行打包的字节"""
+    src_bpr = (src_w + 7) // 8
+    bits = [[(glyph[y * src_bpr + (x >> 3)] >> (x & 7)) & 1
+             for x in range(src_w)] for y in range(src_h)]
+    wx, wy = axis_weights(src_w, dst_w), axis_weights(src_h, dst_h)
+    # 先水平后垂直，两次一维加权求和
+    rows = [[sum(row[s] * w for s, w in wx[t]) for t in range(dst_w)]
+            for row in bits]
+    total = src_w * src_h
+    top = (1 << bpp) - 1
+    out = bytearray()
+    for ty in range(dst_h):
+        acc = 0
+        nbits = 0
+        for tx in range(dst_w):
+            cover = sum(rows[s][tx] * w for s, w in wy[ty])
+            acc |= ((cover * top + total // 2) // total) << nbits
+            nbits += bpp
+            if nbits == 8:
+                out.append(acc)
+                acc = nbits = 0
+        if nbits:
+            out.append(acc)
+    return out
+
+
+def build_aa_sections(data, entries, specs):
+    """按 (字号, 位深, 只生成ASCII) 生成抗锯齿段, 源为同类最大号的1bpp字模段"""
+    sections = []
+    for size, bpp, ascii_only in specs:
+        kinds = ((SEC_ASCII, SEC_ASCII_AA),) if ascii_only else (
+            (SEC_GLYPH, SEC_GLYPH_AA), (SEC_ASCII, SEC_ASCII_AA))
+        for sec, aa_sec in kinds:
+            planes = [e for e in entries if e[0] == sec]
+            target = [e for e in planes if e[3] == size]
+            sources = [e for e in planes if e[3] > size]
+            if not target or not sources:
+                raise ValueError("%d号字没有可缩小的更大字模段" % size)
+            _, _, width, height, index_type, first, _, count, _, _ = target[0]
+            # 缩小倍数越大灰度级越多
+            _, _, src_w, src_h, _, _, stride, src_count, ofs, _ = max(
+                sources, key=lambda e: e[3])
+            blob = bytearray()
+            for i in range(min(count, src_count)):
+                blob += downsample_glyph(data[ofs + i * stride:
+                                              ofs + (i + 1) * stride],
+                                         src_w, src_h, width, height, bpp)
+            aa_stride = (width * bpp + 7) // 8 * height
+            fmt = FMT_4BPP_ROW if bpp == 4 else FMT_2BPP_ROW
+            sections.append(((aa_sec, fmt, width, height, index_type, first,
+                              aa_stride, min(count, src_count)), blob))
+            print("  %dx%d %dbpp 抗锯齿(源 %dx%d): %d 字节" %
+                  (width, height, bpp, src_w, src_h, len(blob)))
+    return sections
+
+
+def build_size_sections(data, entries, sizes, args):
+    """生成原始布局以外字号的1bpp汉字/ASCII字模段, 源为同类最大号的1bpp字模段,
+    覆盖面积过半的像素置1; --pack 时汉字字模段同样压缩"""
+    sections = []
+    for size in sorted(sizes):
+        for sec, width in ((SEC_GLYPH, size), (SEC_ASCII, size // 2)):
+            planes = [e for e in entries if e[0] == sec]
+            if any(e[3] == size for e in planes):
+                raise ValueError("%d号字已有字模段" % size)
+            sources = [e for e in planes if e[3] > size]
+            if not sources:
+                raise ValueError("%d号字没有可缩小的更大字模段" % size)
+            _, _, src_w, src_h, index_type, first, stride, count, ofs, _ = max(
+                sources, key=lambda e: e[3])
+            blob = bytearray()
+            for i in range(count):
+                blob += downsample_glyph(data[ofs + i * stride:
+                                              ofs + (i + 1) * stride],
+                                         src_w, src_h, width, size, 1)
+            fmt, out_stride = FMT_1BPP_ROW, (width + 7) // 8 * size
+            if sec == SEC_GLYPH and args.pack:
+                blob, fmt = pack_glyph_section(
+                    blob, width, size, count, out_stride,
+                    DUAL_GLYPH_ALIGN if args.dual else 1)
+            sections.append(((sec, fmt, width, size, index_type, first,
+                              out_stride, count), blob))
+            print("  %dx%d %s(源 %dx%d): %d 字节" %
+                  (width, size, "汉字" if sec == SEC_GLYPH else "ASCII",
+                   src_w, src_h, len(blob)))
+    return sections
+
+
+def glyph_row_extents(glyph, width, height):
+    """逐行统计1bpp字模的笔画范围, 返回 [(最左列, 最右列) 或 None]"""
+    bytes_per_row = (width + 7) // 8
+    extents = []
+    for r in range(height):
+        v = int.from_bytes(glyph[r * bytes_per_row:(r + 1) * bytes_per_row],
+                           "little") & ((1 << width) - 1)
+        extents.append(((v & -v).bit_length() - 1, v.bit_length() - 1)
+                       if v else None)
+    return extents
+
+
+def build_ascii_metrics(plane, width, height, stride):
+    """由一个ASCII字模段生成字宽表和字偶距表"""
+    rows = [glyph_row_extents(plane[c * stride:(c + 1) * stride], width, height)
+            for c in range(ASCII_CHARS)]
+    ink = []
+    for extents in rows:
+        inked = [e for e in extents if e is not None]
+        ink.append((min(e[0] for e in inked), max(e[1] for e in inked))
+                   if inked else None)
+    spacing = max(1, height // 16)
+    digits = range(ord("0") - 0x20, ord("9") - 0x20 + 1)
+    # 数字保持等宽, 便于数值刷新时对齐
+    tab = max(ink[c][1] - ink[c][0] + 1 for c in digits) + spacing
+
+    metrics = []
+    for c in range(ASCII_CHARS):
+        if ink[c] is None:
+            metrics.append((0, max(2, height // 4)))
+        elif c in digits:
+            ink_w = ink[c][1] - ink[c][0] + 1
+            metrics.append((ink[c][0] - (tab - spacing - ink_w) // 2, tab))
+        else:
+            metrics.append((ink[c][0], ink[c][1] - ink[c][0] + 1 + spacing))
+
+    pairs = []
+    for a in range(ASCII_CHARS):
+        if ink[a] is None or a in digits:
+            continue
+        xa, adv_a = metrics[a]
+        lower = ink[a][1] + 1 - xa - adv_a  # 不能侵入左字符笔画
+        for b in range(ASCII_CHARS):
+            if ink[b] is None or b in digits:
+                continue
+            xb = metrics[b][0]
+            gap = None
+            for r in range(height):
+                if rows[b][r] is None:
+                    continue
+                # 左字符取上下相邻三行的最右列, 避免笔画斜向相接
+                right = [rows[a][k][1] for k in (r - 1, r, r + 1)
+                         if 0 <= k < height and rows[a][k] is not None]
+                if right:
+                    g = (adv_a - 1 - (max(right) - xa)) + (rows[b][r][0] - xb)
+                    gap = g if gap is None else min(gap, g)
+            if gap is not None and gap < 3 * spacing:
+                continue
+            adjust = lower if gap is None else max(lower, spacing - gap)
+            if adjust < 0:
+                pairs.append((a + 0x20, b + 0x20, adjust))
+
+    metric_blob = b"".join(struct.pack("<bB", x, adv) for x, adv in metrics)
+    kern_blob = b"".join(struct.pack("<BBbB", l, r, adj, 0)
+                         for l, r, adj in pairs)
+    return metric_blob, kern_blob, len(pairs)
+
+
+def build_metrics_sections(data, entries):
+    """为每个ASCII字模段生成字宽表段和字偶距段"""
+    sections = []
+    for e in entries:
+        if e[0] != SEC_ASCII:
+            continue
+        _, _, width, height, _, first, stride, count, ofs, _ = e
+        metric_blob, kern_blob, pairs = build_ascii_metrics(
+            data[ofs:ofs + count * stride], width, height, stride)
+        sections.append(((SEC_ASCII_METRICS, FMT_NONE, width, height,
+                          IDX_CODE, first, 2, count), metric_blob))
+        if pairs:
+            sections.append(((SEC_ASCII_KERN, FMT_NONE, width, height,
+                              IDX_NONE, 0, 4, pairs), kern_blob))
+        print("  %dx%d 字宽表: %d 字符, 字偶距 %d 对" %
+              (width, height, count, pairs))
+    return sections
+
+
+def build_box_sections(data, entries):
+    """为每个汉字字模段生成笔画外框表"""
+    sections = []
+    for e in entries:
+        if e[0] != SEC_GLYPH:
+            continue
+        _, _, width, height, index_type, first, stride, count, ofs, _ = e
+        blob = bytearray()
+        sparse = 0
+        for i in range(count):
+            extents = glyph_row_extents(data[ofs + i * stride:
+                                             ofs + (i + 1) * stride],
+                                        width, height)
+            inked = [r for r in range(height) if extents[r] is not None]
+            if not inked:
+                blob += bytes(4)
+                sparse += 1
+                continue
+            x0 = min(extents[r][0] for r in inked)
+            x1 = max(extents[r][1] for r in inked)
+            w, h = x1 - x0 + 1, inked[-1] - inked[0] + 1
+            blob += struct.pack("<BBBB", x0, inked[0], w, h)
+            if w * h * 2 <= width * height:
+                sparse += 1
+        sections.append(((SEC_GLYPH_BOX, FMT_NONE, width, height, index_type,
+                          first, 4, count), blob))
+        print("  %dx%d 笔画外框: %d 字, 其中外框不超过一半的 %d 字" %
+              (width, height, count, sparse))
+    return sections
+
+
+def read_bmp_rgb565(path):
+    """读取24/32位未压缩BMP, 转为逐行的RGB565小端数据"""
+    with open(path, "rb") as f:
+        raw = f.read()
+    if raw[:2] != b"BM":
+        raise ValueError("%s 不是BMP文件" % path)
+    pixels_ofs = struct.unpack_from("<I", raw, 10)[0]
+    width, height, _, bpp, compression = struct.unpack_from("<iiHHI", raw, 18)
+    if bpp not in (24, 32) or compression not in (0, 3):
+        raise ValueError("%s: 只支持24/32位未压缩BMP" % path)
+    bottom_up = height > 0
+    height = abs(height)
+    step = bpp // 8
+    row_bytes = (width * step + 3) & ~3
+    out = bytearray()
+    for y in range(height):
+        row = pixels_ofs + (height - 1 - y if bottom_up else y) * row_bytes
+        for x in range(width):
+            b, g, r = raw[row + x * step:row + x * step + 3]
+            out += struct.pack("<H", ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+    return width, height, bytes(out)
+
+
+def parse_image_spec(text):
+    """解析 --image 参数 "文件.bmp" 或 "宽x高:文件" """
+    size, sep, path = text.partition(":")
+    if not sep or "x" not in size:
+        return text, None
+    try:
+        width, height = (int(v) for v in size.split("x"))
+    except ValueError:
+        return text, None  # Windows 盘符等不是尺寸的前缀
+    return path, (width, height)
+
+
+def load_image(spec):
+    """读取一张图片, 返回 (宽, 高, RGB565数据)"""
+    path, size = spec
+    if size is None:
+        return read_bmp_rgb565(path)
+    with open(path, "rb") as f:
+        pixels = f.read()
+    if len(pixels) != size[0] * size[1] * 2:
+        raise ValueError("%s: 数据 %d 字节, 与 %dx%d RGB565 不符" %
+                         (path, len(pixels), size[0], size[1]))
+    return size[0], size[1], pixels
+
+
+def build_image_section(specs):
+    """把全部图片合为一个图片段: 图片表 + 4字节对齐的像素数据"""
+    images = [load_image(spec) for spec in specs]
+    offset = (len(images) * struct.calcsize(IMAGE_ENTRY) + 3) & ~3
+    table = bytearray()
+    pixels = bytearray()
+    for i, (width, height, data) in enumerate(images):
+        if width == 0 or height == 0 or width > 0xFFFF or height > 0xFFFF:
+            raise ValueError("%s: 图片尺寸无效" % specs[i][0])
+        table += struct.pack(IMAGE_ENTRY, width, height, offset + len(pixels))
+        pixels += data
+        pixels += bytes((-len(pixels)) & 3)
+        print("  图片 %d: %dx%d, %d 字节" % (i, width, height, len(data)))
+    table += bytes((-len(table)) & 3)
+    return ((SEC_IMAGE, FMT_RGB565, 0, 0, IDX_NONE, 0,
+             struct.calcsize(IMAGE_ENTRY), len(images)), bytes(table + pixels))
+
+
+def read_bmp_indexed(path):
+    """读取BMP为 (宽, 高, RGB565调色板, 逐行颜色序号)
+
+    4/8位BMP保留原调色板; 24/32位BMP按RGB565去重, 超过256色报错"""
+    with open(path, "rb") as f:
+        raw = f.read()
+    if raw[:2] != b"BM":
+        raise ValueError("%s 不是BMP文件" % path)
+    pixels_ofs, header_size = struct.unpack_from("<II", raw, 10)
+    width, height, _, bpp, compression = struct.unpack_from("<iiHHI", raw, 18)
+    if bpp in (24, 32):
+        width, height, data = read_bmp_rgb565(path)
+        colors = struct.unpack("<%dH" % (width * height), data)
+        palette = sorted(set(colors), key=colors.index)
+        if len(palette) > 256:
+            raise ValueError("%s: %d 色, 超过256色, 请先减色" %
+                             (path, len(palette)))
+        lookup = {c: i for i, c in enumerate(palette)}
+        return width, height, palette, [lookup[c] for c in colors]
+    if bpp not in (4, 8) or compression != 0:
+        raise ValueError("%s: 只支持4/8/24/32位未压缩BMP" % path)
+    used = struct.unpack_from("<I", raw, 46)[0] or (1 << bpp)
+    palette = []
+    for i in range(used):
+        b, g, r = raw[14 + header_size + i * 4:14 + header_size + i * 4 + 3]
+        palette.append(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+    bottom_up = height > 0
+    height = abs(height)
+    row_bytes = ((width * bpp + 31) // 32) * 4
+    indices = []
+    for y in range(height):
+        row = pixels_ofs + (height - 1 - y if bottom_up else y) * row_bytes
+        for x in range(width):
+            if bpp == 8:
+                indices.append(raw[row + x])
+            else:
+                indices.append((raw[row + x // 2] >> (0 if x & 1 else 4)) & 0x0F)
+    return width, height, palette, indices
+
+
+def pack_indexed(width, height, indices, bpp):
+    """颜色序号逐行打包, 每行按字节补齐, 4bpp低4位在前"""
+    if bpp == 8:
+        return bytes(indices)
+    out = bytearray()
+    for y in range(height):
+        row = indices[y * width:(y + 1) * width] + [0]
+        for x in range(0, width, 2):
+            out.append(row[x] | (row[x + 1] << 4))
+    return bytes(out)
+
+
+def build_indexed_section(paths):
+    """把全部调色板图片合为一段: 图片表 + 各图调色板(4字节对齐) + 像素"""
+    images = [read_bmp_indexed(path) for path in paths]
+    offset = len(images) * struct.calcsize(INDEXED_ENTRY)
+    table = bytearray()
+    blobs = bytearray()
+    for i, (width, height, palette, indices) in enumerate(images):
+        if width == 0 or height == 0 or width > 0xFFFF or height > 0xFFFF:
+            raise ValueError("%s: 图片尺寸无效" % paths[i])
+        if max(indices) >= len(palette):
+            raise ValueError("%s: 颜色序号超出调色板" % paths[i])
+        bpp = 4 if len(palette) <= 16 else 8
+        pal = struct.pack("<%dH" % len(palette), *palette)
+        pal += bytes((-len(pal)) & 3)
+        pixels = pack_indexed(width, height, indices, bpp)
+        table += struct.pack(INDEXED_ENTRY, width, height, bpp, 0,
+                             len(palette), offset + len(blobs))
+        blobs += pal + pixels
+        blobs += bytes((-len(blobs)) & 3)
+        print("  调色板图片 %d: %dx%d, %d 色 %dbpp, %d 字节(RGB565为 %d 字节)" %
+              (i, width, height, len(palette), bpp, len(pal) + len(pixels),
+               width * height * 2))
+    return ((SEC_INDEXED_IMAGE, FMT_INDEXED, 0, 0, IDX_NONE, 0,
+             struct.calcsize(INDEXED_ENTRY), len(images)), bytes(table + blobs))
+
+
+def encode_rle565(pixels):
+    """RGB565像素序列编码为行程压缩记号流(uint16列表)"""
+    out = []
+    literal = []
+
+    def flush():
+        while literal:
+            chunk = literal[:RLE_MAX_RUN]
+            del literal[:RLE_MAX_RUN]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+
+    i = 0
+    while i < len(pixels):
+        j = i + 1
+        while j < len(pixels) and pixels[j] == pixels[i] and j - i < RLE_MAX_RUN:
+            j += 1
+        if j - i >= RLE_MIN_REPEAT:
+            flush()
+            out += [RLE_REPEAT | (j - i - 1), pixels[i]]
+        else:
+            literal.extend(pixels[i:j])
+        i = j
+    flush()
+    return out
+
+
+def build_rle_section(specs):
+    """把全部图片压缩后合为一段: 图片表 + 4字节对齐的记号流"""
+    offset = len(specs) * struct.calcsize(RLE_ENTRY)
+    table = bytearray()
+    blobs = bytearray()
+    for i, spec in enumerate(specs):
+        width, height, data = load_image(spec)
+        if width == 0 or height == 0 or width > 0xFFFF or height > 0xFFFF:
+            raise ValueError("%s: 图片尺寸无效" % spec[0])
+        tokens = encode_rle565(struct.unpack("<%dH" % (width * height), data))
+        blob = struct.pack("<%dH" % len(tokens), *tokens)
+        table += struct.pack(RLE_ENTRY, width, height, offset + len(blobs),
+                             len(blob))
+        blobs += blob + bytes((-len(blob)) & 3)
+        print("  行程压缩图片 %d: %dx%d, %d 字节(RGB565为 %d 字节, %.1f%%)" %
+              (i, width, height, len(blob), len(data),
+               100.0 * len(blob) / len(data)))
+    return ((SEC_RLE_IMAGE, FMT_RLE565, 0, 0, IDX_NONE, 0,
+             struct.calcsize(RLE_ENTRY), len(specs)), bytes(table + blobs))
+
+
+def parse_strings_spec(text):
+    """解析 --strings 参数 "语言:文件" """
+    lang, sep, path = text.partition(":")
+    if not sep or not lang.isdigit() or not path:
+        raise argparse.ArgumentTypeError("格式为 语言:文件")
+    if int(lang) >= LANG_MAX:
+        raise argparse.ArgumentTypeError("语言编号为0-%d" % (LANG_MAX - 1))
+    return int(lang), path
+
+
+def read_strings(path):
+    """读取 "名字=文字" 文本, 返回 [(名字, 文字)], 保持文件顺序"""
+    items, names = [], set()
+    with open(path, "r", encoding="utf-8-sig") as f:
+        for no, line in enumerate(f, 1):
+            line = line.rstrip("\r\n")
+            if not line.strip() or line.lstrip().startswith("#"):
+                continue
+            name, sep, text = line.partition("=")
+            name = name.strip()
+            if not sep or not name.isidentifier() or not name.isascii():
+                raise ValueError("%s:%d: 格式为 名字=文字, 名字须为C标识符" %
+                                 (path, no))
+            if name in names:
+                raise ValueError("%s:%d: 名字 %s 重复" % (path, no, name))
+            names.add(name)
+            text = text.replace("\\\\", "\0").replace("\\n", "\n")
+            items.append((name, text.replace("\0", "\\")))
+    return items
+
+
+def build_string_chars(texts):
+    """统计字符串用到的字符, 按出现次数降序(次数相同按码点), 返回'\\0'结尾的UTF-8"""
+    counts = {}
+    for text in texts:
+        for ch in text or "":
+            if ord(ch) >= 0x20:
+                counts[ch] = counts.get(ch, 0) + 1
+    chars = sorted(counts, key=lambda ch: (-counts[ch], ord(ch)))
+    return "".join(chars).encode("utf-8") + b"\0", len(chars)
+
+
+def build_string_sections(specs, utf8_map):
+    """每种语言一个字符串表段和一个字符集段, 返回 (目录项列表, 名字列表)"""
+    langs = dict(specs)
+    if len(langs) != len(specs):
+        raise ValueError("--strings 的语言编号重复")
+    if 0 not in langs:
+        raise ValueError("--strings 需要语言0, 它决定字符串编号")
+    tables = {lang: read_strings(path) for lang, path in langs.items()}
+    names = [name for name, _ in tables[0]]
+    ids = {name: i for i, name in enumerate(names)}
+    sections = []
+    for lang in sorted(tables):
+        texts = [None] * len(names)
+        for name, text in tables[lang]:
+            if name not in ids:
+                raise ValueError("%s: %s 不在语言0中" % (langs[lang], name))
+            texts[ids[name]] = text
+        table = bytearray()
+        blobs = bytearray()
+        offset = len(names) * struct.calcsize(STRING_ENTRY)
+        missing = set()
+        for text in texts:
+            raw = text.encode("utf-8") if text else b""
+            if not raw:
+                table += struct.pack(STRING_ENTRY, 0, 0)  # 没有译文
+                continue
+            missing.update(ch for ch in text if ord(ch) >= 0x80 and
+                           ord(ch) not in utf8_map)
+            table += struct.pack(STRING_ENTRY, offset + len(blobs), len(raw))
+            blobs += raw + b"\0"
+        blob = bytes(table + blobs)
+        print("  字符串表 语言%d: %d 个, %d 已翻译, %d 字节" %
+              (lang, len(names), sum(1 for t in texts if t), len(blob)))
+        if missing:
+            print("    字库中没有: %s" % "".join(sorted(missing)))
+        sections.append(((SEC_STRINGS, FMT_NONE, 0, 0, IDX_NONE, lang,
+                          struct.calcsize(STRING_ENTRY), len(names)), blob))
+        # 没有译文的字符串显示语言0的, 字符集一并计入
+        chars, count = build_string_chars(
+            [t or tables[0][i][1] for i, t in enumerate(texts)])
+        print("    字符集: %d 字, %d 字节" % (count, len(chars)))
+        sections.append(((SEC_STRING_CHARS, FMT_NONE, 0, 0, IDX_NONE, lang,
+                          1, len(chars)), chars))
+    return sections, names
+
+
+def write_strings_header(path, names):
+    """输出 STR_名字 编号定义, 供 LCD_DisplayStringID 使用"""
+    guard = "FONTBIN_STRINGS_H"
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("/* fontbin_tool.py --strings 生成, 请勿手工修改 */\n")
+        f.write("#ifndef %s\n#define %s\n\n" % (guard, guard))
+        for i, name in enumerate(names):
+            f.write("#define STR_%s %d\n" % (name, i))
+        f.write("#define STR_COUNT %d\n\n#endif\n" % len(names))
+
+
+def read_jpeg_size(path, data):
+    """遍历JPEG标记段, 取基线帧头(SOF0/SOF1)中的宽高"""
+    if data[:2] != b"\xFF\xD8":
+        raise ValueError("%s 不是JPEG文件" % path)
+    pos = 2
+    while pos + 4 <= len(data):
+        if data[pos] != 0xFF:
+            raise ValueError("%s: 标记段格式错误 @ %d" % (path, pos))
+        marker = data[pos + 1]
+        if marker == 0xFF:
+            pos += 1  # 填充字节
+            continue
+        length = struct.unpack_from(">H", data, pos + 2)[0]
+        if marker in (0xC0, 0xC1):
+            height, width = struct.unpack_from(">HH", data, pos + 5)
+            return width, height
+        if 0xC2 <= marker <= 0xCF and marker not in (0xC4, 0xC8, 0xCC):
+            raise ValueError("%s: 硬件JPEG只支持基线哈夫曼编码(SOF%d)" %
+                             (path, marker - 0xC0))
+        if marker == 0xDA:
+            break
+        pos += 2 + length
+    raise ValueError("%s: 没有找到帧头" % path)
+
+
+def build_jpeg_section(paths):
+    """把全部JPEG合为一个JPEG段: 图片表 + 4字节对齐的JPEG数据"""
+    offset = (len(paths) * struct.calcsize(JPEG_ENTRY) + 3) & ~3
+    table = bytearray()
+    blobs = bytearray()
+    for i, path in enumerate(paths):
+        with open(path, "rb") as f:
+            data = f.read()
+        width, height = read_jpeg_size(path, data)
+        data += bytes((-len(data)) & 3)
+        table += struct.pack(JPEG_ENTRY, width, height, offset + len(blobs),
+                             len(data))
+        blobs += data
+        print("  JPEG %d: %dx%d, %d 字节(RGB565为 %d 字节)" %
+              (i, width, height, len(data), width * height * 2))
+    table += bytes((-len(table)) & 3)
+    return ((SEC_JPEG, FMT_JPEG, 0, 0, IDX_NONE, 0,
+             struct.calcsize(JPEG_ENTRY), len(paths)), bytes(table + blobs))
+
+
+def patch_ascii_metrics(data, height, offset):
+    """把字宽表偏移写入ASCII文件头中对应字体信息的保留字段"""
+    num = struct.unpack_from("<I", data, ASCII_FONTS_OFS + 4)[0]
+    for i in range(num):
+        info = ASCII_FONTS_OFS + 8 + i * 16
+        if struct.unpack_from("<H", data, info + 10)[0] == height:
+            struct.pack_into("<I", data, info + 12, offset - ASCII_FONTS_OFS)
+
+
+def parse_aa_spec(text):
+    """解析 --aa 参数 "字号:位深[:ascii]" """
+    fields = text.split(":")
+    if len(fields) > 3 or (len(fields) == 3 and fields[2] != "ascii"):
+        raise argparse.ArgumentTypeError("格式为 字号:位深[:ascii]")
+    bpp = int(fields[1]) if len(fields) > 1 else 4
+    if bpp not in (2, 4):
+        raise argparse.ArgumentTypeError("位深只能是2或4")
+    return int(fields[0]), bpp, len(fields) == 3
+
+
+def parse_size_list(text):
+    """解析逗号分隔的字号列表"""
+    try:
+        return {int(v) for v in text.split(",") if v}
+    except ValueError:
+        raise argparse.ArgumentTypeError("格式为 字号,字号,...")
+
+
+def parse_family_spec(text):
+    """解析 --family 参数 "编号:文件[:字号,...][:ascii]", 文件名中可以有冒号"""
+    family, _, rest = text.partition(":")
+    ascii_only = rest.endswith(":ascii")
+    if ascii_only:
+        rest = rest[:-len(":ascii")]
+    path, _, tail = rest.rpartition(":")
+    if path and tail and all(v.isdigit() for v in tail.split(",")):
+        sizes = {int(v) for v in tail.split(",")}
+    else:
+        path, sizes = rest, None
+    if not family.isdigit() or not path:
+        raise argparse.ArgumentTypeError("格式为 编号:文件[:字号,...][:ascii]")
+    if not 1 <= int(family) <= MAX_FAMILY:
+        raise argparse.ArgumentTypeError("字体族编号为1-%d" % MAX_FAMILY)
+    return int(family), path, sizes, ascii_only
+
+
+def build_family_sections(spec, utf8_map, args):
+    """复制另一字体文件中的字模段作为字体族, 返回 (目录项, 数据, 字体族) 列表"""
+    family, path, sizes, ascii_only = spec
+    with open(path, "rb") as f:
+        data = bytearray(f.read())
+    if len(data) < LEGACY_END_OFS:
+        raise ValueError("%s 不是完整的 merged_fonts.bin" % path)
+    if read_legacy_utf8_table(data) != utf8_map:
+        raise ValueError("%s 的字符集与输入不同, 不能共用索引" % path)
+    kinds = (SEC_ASCII,) if ascii_only else (SEC_GLYPH, SEC_ASCII)
+    planes = [e for e in build_toc_entries(data, 0, 0)
+              if e[0] in kinds and (sizes is None or e[3] in sizes)
+              and (not args.sizes or e[3] in args.sizes)]
+    if not planes:
+        raise ValueError("%s 中没有指定的字号" % path)
+
+    sections = []
+    for e in planes:
+        sec, fmt, width, height, index_type, first, stride, count, ofs, size = e
+        blob = data[ofs:ofs + size]
+        if sec == SEC_GLYPH and height in args.row32:
+            blob, stride = pad_glyph_plane(blob, width, height, count, stride)
+            fmt = FMT_1BPP_ROW32
+        elif sec == SEC_GLYPH and args.pack:
+            blob, fmt = pack_glyph_section(blob, width, height, count, stride,
+                                           DUAL_GLYPH_ALIGN if args.dual else 1)
+        sections.append(((sec, fmt, width, height, index_type, first, stride,
+                          count), blob, family))
+        print("  字体族%d %dx%d %s: %d 字节" %
+              (family, width, height, "汉字" if sec == SEC_GLYPH else "ASCII",
+               len(blob)))
+    extra = []
+    if args.metrics:
+        extra += build_metrics_sections(data, planes)
+    if args.bounds:
+        extra += build_box_sections(data, planes)
+    return sections + [(meta, blob, family) for meta, blob in extra]
+
+
+def split_dual(data):
+    """按字节交替拆分为两片的烧录数据: 偶数字节在BK1, 奇数字节在BK2"""
+    data = bytes(data) + bytes([ERASED]) * (len(data) & 1)
+    return data[0::2], data[1::2]
+
+
+def build_bank_header(seq, size):
+    """生成分区头: magic + seq + size + check"""
+    magic = struct.unpack("<I", BANK_MAGIC)[0]
+    check = ~(magic ^ seq ^ size) & 0xFFFFFFFF
+    return struct.pack("<IIII", magic, seq, size, check)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="merged_fonts.bin 附加索引生成")
+    parser.add_argument("input", help="原始 merged_fonts.bin")
+    parser.add_argument("-o", "--output", help="输出文件(默认覆盖输入)")
+    parser.add_argument("--seq", type=int,
+                        help="写入分区头的序号(不指定则不写分区头)")
+    parser.add_argument("--pack", action="store_true",
+                        help="生成汉字字模行程压缩的紧凑镜像(需指定 -o)")
+    parser.add_argument("--row32", type=parse_size_list, default=set(),
+                        metavar="SIZES",
+                        help="这些字号的汉字字模每行按4字节补齐(需与 --pack 同用)")
+    parser.add_argument("--sizes", type=parse_size_list, default=set(),
+                        metavar="SIZES",
+                        help="只保留这些字号的字模段(与固件 FONT_SIZES 一致)")
+    parser.add_argument("--extra-sizes", type=parse_size_list, default=set(),
+                        metavar="SIZES",
+                        help="由更大字号缩小生成这些字号的1bpp字模段(如 14,18,28)")
+    parser.add_argument("--aa", type=parse_aa_spec, action="append",
+                        default=[], metavar="SIZE:BPP[:ascii]",
+                        help="生成该字号的抗锯齿字模段(位深2或4), 可重复")
+    parser.add_argument("--metrics", action="store_true",
+                        help="生成ASCII比例宽度字宽表和字偶距表")
+    parser.add_argument("--bounds", action="store_true",
+                        help="生成汉字笔画外框表")
+    parser.add_argument("--image", type=parse_image_spec, action="append",
+                        default=[], metavar="[WxH:]FILE",
+                        help="追加RGB565图片(BMP或原始小端数据), 可重复")
+    parser.add_argument("--indexed", action="append", default=[],
+                        metavar="FILE",
+                        help="追加调色板图片(4/8/24/32位BMP, 不超过256色), 可重复")
+    parser.add_argument("--rle", type=parse_image_spec, action="append",
+                        default=[], metavar="[WxH:]FILE",
+                        help="追加行程压缩的RGB565图片(输入与--image相同), 可重复")
+    parser.add_argument("--jpeg", action="append", default=[], metavar="FILE",
+                        help="追加基线JPEG图片, 可重复")
+    parser.add_argument("--strings", type=parse_strings_spec, action="append",
+                        default=[], metavar="LANG:FILE",
+                        help="追加一种语言的界面字符串表(每行 名字=文字), 可重复")
+    parser.add_argument("--strings-header", metavar="FILE",
+                        help="输出字符串编号头文件(STR_名字, 需与 --strings 同用)")
+    parser.add_argument("--blocks", action="store_true",
+                        help="生成两级Unicode分块索引(O(1)查找, 不需要RAM哈希表)")
+    parser.add_argument("--packed-index", action="store_true",
+                        help="生成4字节一项的压缩排序索引(二分查找读取量减半)")
+    parser.add_argument("--index-codes", action="store_true",
+                        help="生成字库索引编码表(GBK与Unicode经字库索引互查)")
+    parser.add_argument("--phash", action="store_true",
+                        help="生成码点最小完美哈希(驱动启动时不再建立RAM哈希表)")
+    parser.add_argument("--records", type=int, default=0, metavar="N",
+                        help="字库索引最前的N个字各字号字模交错存放(不能与 --pack 同用)")
+    parser.add_argument("--family", type=parse_family_spec, action="append",
+                        default=[], metavar="ID:FILE[:SIZES][:ascii]",
+                        help="加入另一字体文件的字模段作为字体族ID, 可重复")
+    parser.add_argument("--dual", action="store_true",
+                        help="双片并联布局(QSPI_DUAL_FLASH_ENABLE), 另外输出两片各自的烧录文件")
+    args = parser.parse_args(argv)
+    hdr_ofs = DUAL_BANK_HDR_OFS if args.dual else BANK_HDR_OFS
+    if args.pack and not args.output:
+        print("--pack 的输出不能再作为输入, 请用 -o 指定输出文件",
+              file=sys.stderr)
+        return 1
+    if args.row32 and not args.pack:
+        print("--row32 只能用于紧凑镜像, 请同时指定 --pack", file=sys.stderr)
+        return 1
+    if args.records and args.pack:
+        print("--records 只用于未压缩镜像, 不能与 --pack 同用", file=sys.stderr)
+        return 1
+    if args.strings_header and not args.strings:
+        print("--strings-header 需要同时指定 --strings", file=sys.stderr)
+        return 1
+
+    with open(args.input, "rb") as f:
+        data = bytearray(f.read())
+    if len(data) < LEGACY_END_OFS:
+        print("输入文件过短, 不是完整的 merged_fonts.bin", file=sys.stderr)
+        return 1
+    # 丢弃旧的附加段, 保证重复执行结果一致
+    del data[LEGACY_END_OFS:]
+
+    utf8_map = read_legacy_utf8_table(data)
+    place(data, UTF8_SORTED_OFS, build_utf8_sorted(utf8_map))
+    print("UTF8排序索引: %d 项 @ +0x%X" % (len(utf8_map), UTF8_SORTED_OFS))
+
+    gb_map = read_legacy_gb2312_table(data)
+    place(data, GB2312_MAP_OFS, build_gb2312_map(gb_map))
+    print("GB2312区位映射: %d 字 @ +0x%X" % (len(gb_map), GB2312_MAP_OFS))
+
+    entries = build_toc_entries(data, len(utf8_map),
+                                GB2312_ROWS * GB2312_COLS)
+    planes = entries  # 抗锯齿段可以从未保留的更大字号缩小
+    if args.sizes:
+        entries = [e for e in entries
+                   if e[0] not in (SEC_GLYPH, SEC_ASCII) or e[3] in args.sizes]
+        print("保留字号: %s" % ",".join(str(v) for v in sorted(args.sizes)))
+    extra = build_metrics_sections(data, entries) if args.metrics else []
+    if args.blocks:
+        extra.append(build_unicode_blocks(utf8_map))
+    if args.packed_index:
+        extra.append(build_utf8_packed(utf8_map))
+    if args.index_codes:
+        extra.append(build_index_codes(utf8_map, gb_map))
+    if args.phash:
+        extra.append(build_utf8_phash(utf8_map))
+    if args.bounds:
+        extra += build_box_sections(data, entries)
+    extra += build_aa_sections(data, planes, args.aa)
+    if args.extra_sizes:
+        extra += build_size_sections(data, planes, args.extra_sizes, args)
+    if args.image:
+        extra.append(build_image_section(args.image))
+    if args.indexed:
+        extra.append(build_indexed_section(args.indexed))
+    if args.rle:
+        extra.append(build_rle_section(args.rle))
+    if args.jpeg:
+        extra.append(build_jpeg_section(args.jpeg))
+    if args.strings:
+        sections, names = build_string_sections(args.strings, utf8_map)
+        extra += sections
+        if args.strings_header:
+            write_strings_header(args.strings_header, names)
+            print("字符串编号: %d 个 -> %s" % (len(names), args.strings_header))
+    for spec in args.family:
+        extra += build_family_sections(spec, utf8_map, args)
+    records = (build_record_section(data, entries, args.records)
+               if args.records > 0 else None)
+    if args.pack:
+        data, entries = build_packed_image(
+            data, entries, args.row32, DUAL_GLYPH_ALIGN if args.dual else 1)
+        print("紧凑镜像: %d 字节" % len(data))
+    offset = EXTRA_OFS
+    gap = len(data) if args.pack else TOC_OFS  # 紧凑镜像与目录之间的空闲区
+    for item in extra:
+        meta, blob = item[:2]
+        family = item[2] if len(item) > 2 else 0
+        gap = (gap + 3) & ~3
+        if ((family or meta[0] == SEC_GLYPH) and
+                gap + len(blob) <= TOC_OFS):
+            place(data, gap, blob)  # 字体族和附加字号的字模段较大, 优先放在空闲区
+            entries.append(meta + (gap, len(blob), family))
+            gap += len(blob)
+            continue
+        if offset + len(blob) > hdr_ofs:
+            raise ValueError("附加段超出分区头之前的空间: 0x%X" %
+                             (offset + len(blob)))
+        place(data, offset, blob)
+        entries.append(meta + (offset, len(blob), family))
+        if meta[0] == SEC_ASCII_METRICS and not args.pack and family == 0:
+            patch_ascii_metrics(data, meta[3], offset)  # 紧凑镜像没有ASCII文件头
+        offset += (len(blob) + 3) & ~3
+    if records:
+        metas, blob = records
+        if offset + len(blob) > hdr_ofs:
+            raise ValueError("多字号记录超出分区头之前的空间: 0x%X" %
+                             (offset + len(blob)))
+        place(data, offset, blob)
+        for meta, pos in metas:
+            entries.append(meta + (offset + pos, meta[6] * meta[7], 0))
+        offset += (len(blob) + 3) & ~3
+    place(data, TOC_OFS, build_toc(entries, data))
+    print("字库目录: %d 段 @ +0x%X" % (len(entries), TOC_OFS))
+
+    if args.seq is not None:
+        image_size = len(data)
+        place(data, hdr_ofs,
+              build_bank_header(args.seq & 0xFFFFFFFF, image_size))
+        print("分区头: 序号 %d, 镜像 %d 字节 @ +0x%X" %
+              (args.seq, image_size, hdr_ofs))
+    if args.dual:
+        data += bytes([ERASED]) * (len(data) & 1)  # 间接写入的字节数须为偶数
+
+    output = args.output or args.input
+    with open(output, "wb") as f:
+        f.write(data)
+    print("输出 %d 字节" % len(data))
+    if args.dual:
+        base = output[:-4] if output.lower().endswith(".bin") else output
+        for i, half in enumerate(split_dual(data)):
+            with open("%s.bk%d.bin" % (base, i + 1), "wb") as f:
+                f.write(half)
+        print("双片烧录文件: %s.bk1.bin / %s.bk2.bin 各 %d 字节, "
+              "写入各片的分区地址/2 (A区 0x%X, B区 0x%X)" %
+              (base, base, len(data) // 2, BANK_A_ADDR // 2, BANK_B_ADDR // 2))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,867 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+fontbuild.py - 字库镜像生成工具
+
+从字模源重新生成 merged_fonts.bin 的原始布局(与 flash_font.h 中的
+FONT_xxx_ADDR 一致)，再调用 fontbin_tool.py 追加排序索引、区位映射和目录，
+可选的压缩、抗锯齿、字宽表、外框表、分块索引、压缩排序索引、字体族和分区头参数原样转交，同一组输入每次
+生成的镜像逐字节相同。
+
+字模源(二选一):
+    --from-bin FILE    从已有的 merged_fonts.bin 提取字模(可为追加过附加段的
+                       文件，但不能是 --pack 生成的紧凑镜像)
+    --ttf FILE         用TrueType字体渲染(需要 Pillow)，--ascii-ttf 可另指定
+                       英文字体，默认与汉字相同
+
+字符集:
+    --charset FILE     UTF-8文本，列出的非ASCII字符按出现顺序编号，重复和
+                       空白字符忽略，以 # 开头的行为注释；不指定时 --from-bin
+                       保留原文件全部字符，--ttf 使用GB2312全部字符
+    ASCII 0x20-0x7E 总是全部生成
+
+字模排列:
+    --profile FILE     按使用频率重排字库索引，常用字的字模排在各字号字模段的
+                       前部，相邻存放，QSPI读取时共用Cache行和连续读取突发；
+                       对照表、排序索引和区位映射都按新索引生成，驱动不需改动。
+                       FILE为 "U+4E2D 次数" 或 "中 次数" 逐行的计数文件(板上
+                       PerfStats_ExportGlyphProfile() 或主机仿真 lcd_sim -p 的
+                       输出)，否则按语料文本统计每个字符的出现次数；可重复，
+                       次数累加，没有出现的字保持原顺序排在后面
+    --records N        再把排在最前的N个字的各字号字模交错存为多字号记录
+                       (转交 fontbin_tool.py)，混用多个字号的界面中常用字的
+                       各字号落在相邻的Flash页；不能与 --pack 同用
+
+字号固定为 12/16/20/24/32(原始布局每个字号一个区域)，ASCII宽度为字号一半。
+字模格式: 1bpp，逐行，每行按字节补齐，字节内低位为左侧像素。
+
+头文件:
+    --header FILE      生成镜像布局常量(各段偏移、格式、数量)，可选再加
+                       --resident FILE 生成 FLASH_FONT_RESIDENT_CHARS 及其
+                       所需RAM字节数(按 --resident-sizes 各字号计算)
+    --check-header FILE 检查 flash_font.h 中的布局常量与本工具一致
+
+字体族:
+    --family ID:FILE[:SIZES][:ascii]
+                       按同一组字模记录(字符和字库索引)再生成一套字体作为字体族
+                       ID(1-7)，FILE为 .bin 时从原始布局的 merged_fonts.bin 按字符
+                       提取，否则按TrueType渲染；SIZES 如 24,32 只生成部分字号，
+                       ":ascii" 只生成ASCII，可重复。源中没有的字符沿用主字体的
+                       字模，生成的临时文件交给 fontbin_tool.py --family
+
+预解析文本串:
+    --runs FILE        每行 NAME[:SIZE]=文本(字号默认24，# 开头为注释)，按生成的
+                       镜像解析出每个字符的字模偏移和显示宽度，写入 --runs-header
+                       指定的头文件，LCD_DisplayGlyphRun(x, y, LCD_GLYPH_RUN(NAME))
+                       绘制；--runs-image BIN 按已有镜像生成，不重新生成镜像
+                       镜像更新后需重新生成，否则驱动校验不符时按原文本绘制
+
+用法:
+    python fontbuild.py --from-bin merged_fonts.bin -o rebuilt.bin
+    python fontbuild.py --from-bin merged_fonts.bin --charset ui.txt --pack -o ui.bin
+    python fontbuild.py --from-bin merged_fonts.bin --profile profile.txt \
+        --profile corpus.txt --pack -o hot.bin
+    python fontbuild.py --ttf simsun.ttf --pack --metrics --bounds -o new.bin --seq 1
+    python fontbuild.py --ttf simsun.ttf --charset ui.txt --pack --row32 24,32 -o ui.bin
+    python fontbuild.py --from-bin merged_fonts.bin --resident common.txt \\
+        --header fontbin_layout.h -o out.bin
+    python fontbuild.py --check-header ../flash_font.h
+    python fontbuild.py --ttf simsun.ttf --family 1:simhei.ttf:24,32:ascii \
+        --pack --metrics -o ui.bin
+    python fontbuild.py --runs-image merged_fonts.bin --runs ui_text.txt \\
+        --runs-header fontbin_runs.h
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import fontbin_tool as fb  # noqa: E402
+
+GLYPH_SIZES = (12, 16, 20, 24, 32)      # 与 fb.GLYPH_OFS 一一对应
+ASCII_ORDER = (32, 24, 20, 16, 12)      # 原始ASCII文件头中的字体顺序
+ASCII_HDR_SIZE = 8 + 5 * 16             # magic + num_fonts + 5个字体信息
+FLAG_MAGIC = b"GALF"                    # 0x464C4147 ("FLAG") 小端存储
+
+SEC_NAMES = {
+    fb.SEC_GLYPH: "GLYPH", fb.SEC_ASCII: "ASCII",
+    fb.SEC_GB2312_TABLE: "GB2312_TABLE", fb.SEC_UTF8_TABLE: "UTF8_TABLE",
+    fb.SEC_UTF8_SORTED: "UTF8_SORTED", fb.SEC_GB2312_MAP: "GB2312_MAP",
+    fb.SEC_FLAG: "FLAG", fb.SEC_GLYPH_AA: "GLYPH_AA",
+    fb.SEC_ASCII_AA: "ASCII_AA", fb.SEC_ASCII_METRICS: "ASCII_METRICS",
+    fb.SEC_ASCII_KERN: "ASCII_KERN", fb.SEC_GLYPH_BOX: "GLYPH_BOX",
+    fb.SEC_IMAGE: "IMAGE", fb.SEC_JPEG: "JPEG",
+    fb.SEC_UNICODE_BLOCKS: "UNICODE_BLOCKS",
+    fb.SEC_GLYPH_RECORD: "GLYPH_RECORD", fb.SEC_UTF8_PACKED: "UTF8_PACKED",
+    fb.SEC_INDEX_CODES: "INDEX_CODES",
+}
+
+# flash_font.h 中必须与本工具一致的常量
+HEADER_CONSTANTS = {
+    "FONT_BANK_SIZE": fb.REGION_SIZE,
+    "FONT_BANK_HDR_OFS": fb.BANK_HDR_OFS,
+    "FONT_TOC_ADDR": fb.TOC_OFS,
+    "FONT_12x12_ADDR": fb.GLYPH_OFS[0],
+    "FONT_16x16_ADDR": fb.GLYPH_OFS[1],
+    "FONT_20x20_ADDR": fb.GLYPH_OFS[2],
+    "FONT_24x24_ADDR": fb.GLYPH_OFS[3],
+    "FONT_32x32_ADDR": fb.GLYPH_OFS[4],
+    "GB2312_TABLE_ADDR": fb.GB2312_TABLE_OFS,
+    "UTF8_TABLE_ADDR": fb.UTF8_TABLE_OFS,
+    "FONT_FLAG_ADDR": fb.FONT_FLAG_OFS,
+    "ASCII_FONTS_ADDR": fb.ASCII_FONTS_OFS,
+    "UTF8_SORTED_ADDR": fb.UTF8_SORTED_OFS,
+    "GB2312_MAP_ADDR": fb.GB2312_MAP_OFS,
+    "FONT_TOC_VERSION": fb.TOC_VERSION,
+    "FONT_RLE_BLOCK_BITS": fb.RLE_BLOCK_BITS,
+    "FONT_PACKED_INDEX_MAX_BITS": fb.PACKED_MAX_BITS,
+    "FONT_FMT_1BPP_ROW": fb.FMT_1BPP_ROW,
+    "FONT_FMT_1BPP_RLE": fb.FMT_1BPP_RLE,
+    "FONT_FMT_2BPP_ROW": fb.FMT_2BPP_ROW,
+    "FONT_FMT_4BPP_ROW": fb.FMT_4BPP_ROW,
+    "FONT_FMT_1BPP_ROW32": fb.FMT_1BPP_ROW32,
+    "FONT_IDX_TABLE": fb.IDX_TABLE,
+    "FONT_IDX_CODE": fb.IDX_CODE,
+}
+HEADER_CONSTANTS.update(("FONT_SEC_" + name, sec)
+                        for sec, name in SEC_NAMES.items())
+
+
+def glyph_stride(width, height):
+    """1bpp字模字节数(每行按字节补齐)"""
+    return (width + 7) // 8 * height
+
+
+def load_charset(path):
+    """读取字符集文件, 返回按出现顺序去重的非ASCII字符列表"""
+    chars, seen = [], set()
+    with open(path, "r", encoding="utf-8-sig") as f:
+        for line in f:
+            if line.startswith("#"):
+                continue
+            for ch in line:
+                if ord(ch) < 0x80 or ch.isspace() or ch in seen:
+                    continue
+                seen.add(ch)
+                chars.append(ch)
+    return chars
+
+
+def gb2312_charset():
+    """GB2312全部字符, 按区位码顺序"""
+    chars = []
+    for row in range(0xA1, 0xF8):
+        for col in range(0xA1, 0xFF):
+            try:
+                ch = bytes((row, col)).decode("gb2312")
+            except UnicodeDecodeError:
+                continue
+            chars.append(ch)
+    return chars
+
+
+def gb2312_code(ch):
+    """字符的GB2312双字节编码(区字节在高位), 不能编码返回None"""
+    try:
+        raw = ch.encode("gb2312")
+    except UnicodeEncodeError:
+        return None
+    return (raw[0] << 8) | raw[1] if len(raw) == 2 else None
+
+
+def read_bin_source(data):
+    """从原始布局的 merged_fonts.bin 提取字模
+
+    返回 (字模记录, 汉字字模, ASCII字模)。字模记录按字库索引排列, 每项为
+    (字符或None, GB2312编码或None)；只能经GB2312对照表访问的字模字符为None。
+    """
+    glyphs = {}
+    count = None
+    for size, ofs in zip(GLYPH_SIZES, fb.GLYPH_OFS):
+        magic, width, height, n, _, stride = struct.unpack_from(
+            fb.GLYPH_HDR, data, ofs)
+        if magic != b"23BG":
+            raise ValueError("字模区魔数错误 @ +0x%X (紧凑镜像不能作为输入)" % ofs)
+        if width != size or height != size or \
+                stride != glyph_stride(size, size):
+            raise ValueError("%d号汉字字模尺寸不是 %dx%d" % (size, size, size))
+        base = ofs + struct.calcsize(fb.GLYPH_HDR)
+        glyphs[size] = [bytes(data[base + i * stride:base + (i + 1) * stride])
+                        for i in range(n)]
+        count = n if count is None else min(count, n)
+
+    by_index = {}
+    for cp, index in fb.read_legacy_utf8_table(data).items():
+        by_index.setdefault(index, chr(cp))
+    gb_index = {}
+    for code, index in fb.read_legacy_gb2312_table(data).items():
+        gb_index.setdefault(index, code)
+    records = [(by_index.get(i), gb_index.get(i)) for i in range(count)]
+
+    if data[fb.ASCII_FONTS_OFS:fb.ASCII_FONTS_OFS + 4] != b"ASCI":
+        raise ValueError("ASCII字库魔数错误")
+    ascii_planes = {}
+    num = struct.unpack_from("<I", data, fb.ASCII_FONTS_OFS + 4)[0]
+    for i in range(num):
+        offset, size, width, height = struct.unpack_from(
+            "<IIHH", data, fb.ASCII_FONTS_OFS + 8 + i * 16)
+        start = fb.ASCII_FONTS_OFS + offset
+        ascii_planes[height] = bytes(data[start:start + size])
+    return records, glyphs, ascii_planes
+
+
+def select_records(records, glyphs, wanted):
+    """按字符集挑选字模记录, 返回 (记录, 字模, 源中没有的字符)"""
+    where = {ch: i for i, (ch, _) in enumerate(records) if ch is not None}
+    picked = [where[ch] for ch in wanted if ch in where]
+    missing = [ch for ch in wanted if ch not in where]
+    return ([records[i] for i in picked],
+            {size: [plane[i] for i in picked] for size, plane in glyphs.items()},
+            missing)
+
+
+PROFILE_LINE = re.compile(r"^\s*(U\+[0-9A-Fa-f]{4,6}|\S)\s+(\d+)\s*$")
+
+
+def load_profile(path, counts):
+    """读取使用频率文件, 把每个字符的次数累加到 counts
+
+    所有非注释行都是 "U+XXXX 次数"/"字 次数" 时按计数文件读取,
+    否则按语料文本统计非ASCII字符的出现次数
+    """
+    with open(path, "r", encoding="utf-8-sig") as f:
+        lines = [line for line in f if not line.startswith("#")]
+    matches = [PROFILE_LINE.match(line) for line in lines if line.strip()]
+    if matches and all(matches):
+        for m in matches:
+            key = m.group(1)
+            ch = chr(int(key[2:], 16)) if len(key) > 1 else key
+            counts[ch] = counts.get(ch, 0) + int(m.group(2))
+        return "计数文件", len(matches)
+    total = 0
+    for line in lines:
+        for ch in line:
+            if ord(ch) >= 0x80 and not ch.isspace():
+                counts[ch] = counts.get(ch, 0) + 1
+                total += 1
+    return "语料", total
+
+
+def order_by_profile(records, glyphs, counts):
+    """按次数从多到少重排字模记录(字库索引), 次数相同的保持原顺序
+
+    返回 (记录, 字模, 有次数的字数)
+    """
+    order = sorted(range(len(records)),
+                   key=lambda i: -counts.get(records[i][0], 0))
+    hot = sum(1 for ch, _ in records if counts.get(ch, 0) > 0)
+    return ([records[i] for i in order],
+            {size: [plane[i] for i in order] for size, plane in glyphs.items()},
+            hot)
+
+
+def render_ttf(path, chars, size, width):
+    """用Pillow把字符渲染为1bpp字模(字节内低位为左侧像素), 返回字模列表"""
+    try:
+        from PIL import Image, ImageDraw, ImageFont
+    except ImportError:
+        raise SystemExit("--ttf 需要 Pillow: pip install pillow")
+    font = ImageFont.truetype(path, size)
+    ascent, descent = font.getmetrics()
+    baseline = round(size * ascent / float(ascent + descent))
+    bytes_per_row = (width + 7) // 8
+    out = []
+    for ch in chars:
+        img = Image.new("1", (width, size), 0)
+        draw = ImageDraw.Draw(img)
+        draw.fontmode = "1"  # 不抗锯齿, 阈值化由字体渲染器完成
+        draw.text((width / 2.0, baseline), ch, fill=1, font=font, anchor="ms")
+        glyph = bytearray(bytes_per_row * size)
+        px = img.load()
+        for y in range(size):
+            for x in range(width):
+                if px[x, y]:
+                    glyph[y * bytes_per_row + (x >> 3)] |= 1 << (x & 7)
+        out.append(bytes(glyph))
+    return out
+
+
+def render_ttf_source(path, ascii_path, chars):
+    """用TrueType字体生成全部字号的汉字和ASCII字模"""
+    asc = [chr(c) for c in range(0x20, 0x20 + fb.ASCII_CHARS)]
+    glyphs, ascii_planes = {}, {}
+    for size in GLYPH_SIZES:
+        glyphs[size] = render_ttf(path, chars, size, size)
+        plane = render_ttf(ascii_path or path, asc, size, size // 2)
+        ascii_planes[size] = b"".join(plane)
+        print("  %d号: %d 汉字 + %d ASCII" % (size, len(chars), len(asc)))
+    return glyphs, ascii_planes
+
+
+def build_legacy_image(records, glyphs, ascii_planes):
+    """按原始固定布局生成字库镜像(不含附加段), 字库索引即records中的顺序"""
+    if len(records) > fb.TABLE_ENTRIES:
+        raise ValueError("字符数 %d 超过原始布局上限 %d" %
+                         (len(records), fb.TABLE_ENTRIES))
+    data = bytearray([fb.ERASED]) * fb.LEGACY_END_OFS
+
+    limits = list(fb.GLYPH_OFS[1:]) + [fb.GB2312_TABLE_OFS]
+    for size, ofs, limit in zip(GLYPH_SIZES, fb.GLYPH_OFS, limits):
+        stride = glyph_stride(size, size)
+        blob = bytearray(struct.pack(fb.GLYPH_HDR, b"23BG", size, size,
+                                     len(records), 0, stride))
+        for glyph in glyphs[size]:
+            blob += glyph
+        if ofs + len(blob) > limit:
+            raise ValueError("%d号字模区超出原始布局" % size)
+        data[ofs:ofs + len(blob)] = blob
+
+    gb = [(code, i) for i, (_, code) in enumerate(records) if code is not None]
+    blob = bytearray(b"GLBT" + struct.pack("<II", len(gb), fb.TABLE_HDR_SIZE))
+    for code, i in gb:
+        blob += struct.pack("<HH", code, i)
+    data[fb.GB2312_TABLE_OFS:fb.GB2312_TABLE_OFS + len(blob)] = blob
+
+    utf8 = [(ch, i) for i, (ch, _) in enumerate(records) if ch is not None]
+    blob = bytearray(b"UTF8" + struct.pack("<II", len(utf8),
+                                           fb.TABLE_HDR_SIZE))
+    for ch, i in utf8:
+        raw = ch.encode("utf-8")
+        blob += struct.pack("<B4sHB", len(raw), raw, i, 0)
+    data[fb.UTF8_TABLE_OFS:fb.UTF8_TABLE_OFS + len(blob)] = blob
+
+    blob = FLAG_MAGIC + bytes((1, 1, 1, 1, 1, 0, 0, 0))
+    data[fb.FONT_FLAG_OFS:fb.FONT_FLAG_OFS + fb.FONT_FLAG_SIZE] = blob
+
+    hdr = bytearray(b"ASCI" + struct.pack("<I", len(ASCII_ORDER)))
+    body = bytearray()
+    for size in ASCII_ORDER:
+        plane = ascii_planes[size]
+        if len(plane) != fb.ASCII_CHARS * glyph_stride(size // 2, size):
+            raise ValueError("%d号ASCII字模长度错误" % size)
+        hdr += struct.pack("<IIHHI", ASCII_HDR_SIZE + len(body), len(plane),
+                           size // 2, size, 0)
+        body += plane
+    blob = hdr + body
+    if fb.ASCII_FONTS_OFS + len(blob) != fb.LEGACY_END_OFS:
+        raise ValueError("ASCII字库长度与原始布局不一致")
+    data[fb.ASCII_FONTS_OFS:] = blob
+    return data
+
+
+def read_toc(image):
+    """读取镜像中的字库目录, 返回目录项列表"""
+    magic, version, count, hdr_size, entry_size = struct.unpack_from(
+        fb.TOC_HDR, image, fb.TOC_OFS)
+    if magic != fb.TOC_MAGIC:
+        raise ValueError("输出镜像没有字库目录")
+    return [struct.unpack_from(fb.TOC_ENTRY, image,
+                               fb.TOC_OFS + hdr_size + i * entry_size)[:10]
+            for i in range(count)]
+
+
+def resident_bytes(chars, sizes, records, glyphs, ascii_planes, toc):
+    """计算常驻子集所需的字模字节数(与驱动一致, 每字4字节对齐)"""
+    formats = {e[3]: e[1] for e in toc if e[0] == fb.SEC_GLYPH}
+    where = {ch: i for i, (ch, _) in enumerate(records) if ch is not None}
+    total = count = 0
+    for ch in chars:
+        for size in sizes:
+            if ord(ch) < 0x80:
+                if size not in ascii_planes:
+                    continue
+                n = glyph_stride(size // 2, size)
+            elif ch in where:
+                raw = glyphs[size][where[ch]]
+                if formats.get(size) == fb.FMT_1BPP_RLE:
+                    n = len(fb.pack_glyph(raw, (size + 7) // 8, size))
+                elif formats.get(size) == fb.FMT_1BPP_ROW32:
+                    n = (size + 31) // 32 * 4 * size
+                else:
+                    n = len(raw)
+            else:
+                continue
+            total += (n + 3) & ~3
+            count += 1
+    return total, count
+
+
+def c_string(text):
+    """把字符串转为C字符串字面量"""
+    return '"%s"' % text.replace("\\", "\\\\").replace('"', '\\"')
+
+
+def write_header(path, image, toc, resident=None):
+    """生成镜像布局常量头文件"""
+    guard = re.sub(r"\W", "_", os.path.basename(path)).upper()
+    lines = [
+        "/* 由 fontbuild.py 生成, 请勿手工修改 */",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#define FONTBIN_IMAGE_SIZE 0x%X /*!< 字库镜像字节数 */" % len(image),
+        "#define FONTBIN_TOC_VERSION %d /*!< 目录格式版本 */" % fb.TOC_VERSION,
+        "#define FONTBIN_SECTION_COUNT %d /*!< 目录段数 */" % len(toc),
+    ]
+    glyph = [e for e in toc if e[0] == fb.SEC_GLYPH]
+    if glyph:
+        lines.append("#define FONTBIN_GLYPH_COUNT %d /*!< 汉字字模数 */" %
+                     glyph[0][7])
+    lines.append("")
+    lines.append("/* 各段: 偏移(相对分区起始) / 字节数 / 格式 / 项数 */")
+    for sec, fmt, width, height, _, _, _, count, ofs, size in toc:
+        name = "FONTBIN_%s" % SEC_NAMES.get(sec, "SEC%d" % sec)
+        if height:
+            name += "_%d" % height
+        lines.append("#define %s_OFS 0x%X" % (name, ofs))
+        lines.append("#define %s_SIZE %d" % (name, size))
+        if fmt != fb.FMT_NONE:
+            lines.append("#define %s_FMT %d" % (name, fmt))
+        lines.append("#define %s_COUNT %d" % (name, count))
+    if resident is not None:
+        text, nbytes, nglyphs, sizes = resident
+        lines += [
+            "",
+            "/* 常驻字模子集, 在包含 flash_font.h 之前包含本文件即可替换默认列表 */",
+            "#define FLASH_FONT_RESIDENT_CHARS %s" % c_string(text),
+            "#define FONTBIN_RESIDENT_SIZES {%s} /*!< 计算字节数时使用的字号 */" %
+            ", ".join(str(s) for s in sizes),
+            "#define FONTBIN_RESIDENT_GLYPHS %d /*!< 常驻字模项数, 不应超过 "
+            "FLASH_FONT_RESIDENT_MAX */" % nglyphs,
+            "#define FONTBIN_RESIDENT_BYTES %d /*!< 常驻字模字节数, 不应超过 "
+            "FLASH_FONT_RESIDENT_BYTES */" % nbytes,
+        ]
+    lines += ["", "#endif // %s" % guard, ""]
+    with open(path, "w", encoding="utf-8", newline="\n") as f:
+        f.write("\n".join(lines))
+
+
+RUN_FNV_BASIS = 0x811C9DC5
+RUN_FNV_PRIME = 0x01000193
+GLYPH_REF_NONE = 0xFFFFFFFF
+
+
+def fnv1a(h, data):
+    """FNV-1a, 与 flash_font.c 中 FontStamp_Hash() 相同"""
+    for b in data:
+        h = ((h ^ b) * RUN_FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def load_runs(path):
+    """读取 --runs 文件, 每行 NAME[:SIZE]=文本, 返回 [(name, size, text)]"""
+    runs = []
+    with open(path, "r", encoding="utf-8-sig") as f:
+        for no, line in enumerate(f, 1):
+            line = line.rstrip("\r\n")
+            if not line.strip() or line.startswith("#"):
+                continue
+            m = re.match(r"^\s*([A-Za-z_]\w*)(?::(\d+))?\s*=(.*)$", line)
+            if not m:
+                raise ValueError("%s:%d: 格式应为 NAME[:SIZE]=文本" % (path, no))
+            size = int(m.group(2)) if m.group(2) else 24
+            if size not in GLYPH_SIZES:
+                raise ValueError("%s:%d: 字号只能是 12/16/20/24/32" % (path, no))
+            runs.append((m.group(1).upper(), size, m.group(3)))
+    return runs
+
+
+class RunResolver:
+    """按镜像目录预解析文本串, 结果与驱动运行时的查找一致"""
+
+    def __init__(self, image, toc):
+        self.image = image
+        self.sec = {}
+        for e in toc:
+            self.sec.setdefault((e[0], e[3] if e[0] != fb.SEC_UTF8_SORTED
+                                 else 0), e)
+        sorted_sec = self.sec.get((fb.SEC_UTF8_SORTED, 0))
+        if sorted_sec is None:
+            raise ValueError("镜像没有UTF8排序索引, 不能预解析")
+        ofs, count = sorted_sec[8], sorted_sec[7]
+        self.index = {}
+        for i in range(count):
+            code, idx, _ = struct.unpack_from("<IHH", image, ofs + i * 8)
+            self.index.setdefault(code, idx)
+        self.index_stamp = fnv1a(RUN_FNV_BASIS, image[ofs:ofs + count * 8])
+
+    def _desc(self, h, e):
+        """与 FontStamp_Desc() 相同, 段不存在时计入4个0"""
+        v = (e[8], e[7], e[6], e[1]) if e is not None else (0, 0, 0, 0)
+        return fnv1a(h, struct.pack("<4I", *v))
+
+    def stamp(self, size):
+        """与 FlashFont_RunStamp() 相同"""
+        h = self._desc(self.index_stamp, self.sec.get((fb.SEC_GLYPH, size)))
+        h = self._desc(h, self.sec.get((fb.SEC_ASCII, size)))
+        for sec in (fb.SEC_ASCII_METRICS, fb.SEC_ASCII_KERN):
+            e = self.sec.get((sec, size))
+            h = self._desc(h, e)
+            if e is not None:
+                h = fnv1a(h, self.image[e[8]:e[8] + e[7] * e[6]])
+        return h or 1
+
+    def _advance(self, cp, nxt, size):
+        """与 FlashFont_AsciiAdvance() 相同, 返回 (advance, x)"""
+        m = self.sec.get((fb.SEC_ASCII_METRICS, size))
+        if m is None or not m[5] <= cp < m[5] + m[7]:
+            return size // 2, 0
+        x, adv = struct.unpack_from("<bB", self.image, m[8] + 2 * (cp - m[5]))
+        k = self.sec.get((fb.SEC_ASCII_KERN, size))
+        if nxt and k is not None:
+            for i in range(k[7]):
+                left, right, adjust, _ = struct.unpack_from(
+                    "<BBbB", self.image, k[8] + 4 * i)
+                if (left, right) == (cp, nxt):
+                    adv += adjust
+                    break
+        return max(1, adv), x
+
+    def _offset(self, cp, size):
+        """字模相对字模段起始的偏移, 没有该字符返回 GLYPH_REF_NONE"""
+        if cp < 0x80:
+            e = self.sec.get((fb.SEC_ASCII, size))
+            if e is None or not e[5] <= cp < e[5] + e[7]:
+                return GLYPH_REF_NONE
+            return (cp - e[5]) * e[6]
+        e = self.sec.get((fb.SEC_GLYPH, size))
+        idx = self.index.get(cp)
+        if e is None or idx is None or idx >= e[7]:
+            return GLYPH_REF_NONE
+        if e[1] == fb.FMT_1BPP_RLE:
+            blocks = (e[7] + 255) >> 8
+            base, = struct.unpack_from("<I", self.image, e[8] + 4 * (idx >> 8))
+            ofs, = struct.unpack_from("<H", self.image,
+                                      e[8] + 4 * blocks + 2 * idx)
+            return base + ofs
+        return idx * e[6]
+
+    def resolve(self, text, size):
+        """返回 (glyphs, width, missing), glyphs 为 (offset, cp, advance, x)"""
+        glyphs, missing = [], []
+        for i, ch in enumerate(text):
+            cp = ord(ch)
+            if cp < 0x80:
+                nxt = ord(text[i + 1]) if i + 1 < len(text) else 0
+                adv, x = self._advance(cp, nxt if nxt < 0x80 else 0, size)
+            else:
+                adv, x = size, 0
+            ofs = self._offset(cp, size)
+            if ofs == GLYPH_REF_NONE:
+                missing.append(ch)
+            glyphs.append((ofs, cp, adv, x))
+        return glyphs, sum(g[2] for g in glyphs), missing
+
+
+def write_runs_header(path, image, toc, runs):
+    """生成预解析文本串头文件, 返回缺字总数"""
+    guard = re.sub(r"\W", "_", os.path.basename(path)).upper()
+    resolver = RunResolver(image, toc)
+    lines = [
+        "/* 由 fontbuild.py --runs 生成, 请勿手工修改 */",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        '#include "flash_font.h"',
+    ]
+    total = 0
+    for name, size, text in runs:
+        glyphs, width, missing = resolver.resolve(text, size)
+        if missing:
+            print("%s: 字库中没有 %d 个字符: %s" %
+                  (name, len(missing), "".join(missing[:20])), file=sys.stderr)
+            total += len(missing)
+        lines += ["", "/* %s: %d 字, 宽 %d */" % (name, len(glyphs), width),
+                  "static const FontGlyphRef_t FONTBIN_RUN_%s_GLYPHS[] = {" %
+                  name]
+        lines += ["    {0x%X, 0x%04X, %d, %d}," % g for g in glyphs] or \
+            ["    {0xFFFFFFFF, 0, 0, 0},"]
+        lines += [
+            "};",
+            "static const FontGlyphRun_t FONTBIN_RUN_%s = {" % name,
+            "    0x%08X, FONTBIN_RUN_%s_GLYPHS, %s, %d, %d, %d};" %
+            (resolver.stamp(size), name, c_string(text), len(glyphs), width,
+             size),
+        ]
+    lines += ["", "#endif // %s" % guard, ""]
+    with open(path, "w", encoding="utf-8", newline="\n") as f:
+        f.write("\n".join(lines))
+    return total
+
+
+def check_header(path):
+    """比较 flash_font.h 中的布局常量, 返回不一致的项数"""
+    with open(path, "r", encoding="utf-8") as f:
+        text = f.read()
+    defines = dict(re.findall(r"^#define\s+(\w+)\s+(0x[0-9A-Fa-f]+|\d+)\b",
+                              text, re.M))
+    errors = 0
+    for name, value in sorted(HEADER_CONSTANTS.items()):
+        if name not in defines:
+            print("缺少常量 %s" % name, file=sys.stderr)
+            errors += 1
+        elif value is not None and int(defines[name], 0) != value:
+            print("%s = %s, 工具为 0x%X" % (name, defines[name], value),
+                  file=sys.stderr)
+            errors += 1
+    print("%s: %d 项常量, %d 项不一致" % (path, len(HEADER_CONSTANTS), errors))
+    return errors
+
+
+def parse_sizes(text):
+    """解析 --resident-sizes 参数 "16,24" """
+    sizes = tuple(int(s) for s in text.split(",") if s)
+    if not sizes or any(s not in GLYPH_SIZES for s in sizes):
+        raise argparse.ArgumentTypeError("字号只能是 12/16/20/24/32")
+    return sizes
+
+
+def build_family_source(spec, records, glyphs, ascii_planes, path):
+    """按主字体的字模记录生成字体族的原始布局文件, 返回转交的 --family 参数"""
+    family, src, sizes, ascii_only = spec
+    wanted = sorted(sizes) if sizes else GLYPH_SIZES
+    if any(size not in GLYPH_SIZES for size in wanted):
+        raise SystemExit("--family 字号只能是 12/16/20/24/32")
+    fam_glyphs, fam_ascii = dict(glyphs), dict(ascii_planes)
+    if src.lower().endswith(".bin"):
+        with open(src, "rb") as f:
+            src_records, src_glyphs, src_ascii = read_bin_source(
+                bytearray(f.read()))
+        where = {ch: i for i, (ch, _) in enumerate(src_records)
+                 if ch is not None}
+        missing = sum(1 for ch, _ in records if ch not in where)
+        for size in wanted:
+            if not ascii_only:
+                fam_glyphs[size] = [
+                    src_glyphs[size][where[ch]] if ch in where else glyph
+                    for (ch, _), glyph in zip(records, glyphs[size])]
+            fam_ascii[size] = src_ascii[size]
+        if missing and not ascii_only:
+            print("  字体族%d 源中没有 %d 个字符, 沿用主字体" %
+                  (family, missing), file=sys.stderr)
+    else:
+        asc = [chr(c) for c in range(0x20, 0x20 + fb.ASCII_CHARS)]
+        for size in wanted:
+            if not ascii_only:
+                fam_glyphs[size] = render_ttf(
+                    src, [ch or " " for ch, _ in records], size, size)
+            fam_ascii[size] = b"".join(render_ttf(src, asc, size, size // 2))
+    with open(path, "wb") as f:
+        f.write(build_legacy_image(records, fam_glyphs, fam_ascii))
+    print("字体族%d %s: %s号%s" % (family, src, ",".join(map(str, wanted)),
+                                 " ASCII" if ascii_only else ""))
+    return "%d:%s:%s%s" % (family, path, ",".join(map(str, wanted)),
+                           ":ascii" if ascii_only else "")
+
+
+def write_runs(args, image):
+    """按 --runs 生成预解析文本串头文件, 返回缺字总数"""
+    runs = load_runs(args.runs)
+    missing = write_runs_header(args.runs_header, image, read_toc(image), runs)
+    print("预解析文本串 %s: %d 条" % (args.runs_header, len(runs)))
+    return missing
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="字库镜像生成")
+    src = parser.add_mutually_exclusive_group()
+    src.add_argument("--from-bin", metavar="FILE",
+                     help="从已有的 merged_fonts.bin 提取字模")
+    src.add_argument("--ttf", metavar="FILE", help="用TrueType字体渲染字模")
+    parser.add_argument("--ascii-ttf", metavar="FILE",
+                        help="ASCII使用的TrueType字体(默认与 --ttf 相同)")
+    parser.add_argument("--charset", metavar="FILE",
+                        help="字符集文件(UTF-8), 只生成其中的字符")
+    parser.add_argument("--profile", metavar="FILE", action="append",
+                        default=[], help="按使用频率(计数文件或语料)重排字模, 可重复")
+    parser.add_argument("-o", "--output", help="输出镜像")
+    parser.add_argument("--header", metavar="FILE", help="生成布局常量头文件")
+    parser.add_argument("--resident", metavar="FILE",
+                        help="常驻子集字符文件, 写入 --header 生成的头文件")
+    parser.add_argument("--resident-sizes", type=parse_sizes, default=(16, 24),
+                        metavar="16,24", help="常驻子集字号(默认 16,24)")
+    parser.add_argument("--check-header", metavar="FILE",
+                        help="检查 flash_font.h 中的布局常量")
+    parser.add_argument("--seq", type=int, help="转交 fontbin_tool.py")
+    parser.add_argument("--pack", action="store_true",
+                        help="转交 fontbin_tool.py")
+    parser.add_argument("--row32", metavar="SIZES", help="转交 fontbin_tool.py")
+    parser.add_argument("--sizes", metavar="SIZES", help="转交 fontbin_tool.py")
+    parser.add_argument("--extra-sizes", metavar="SIZES", help="转交 fontbin_tool.py")
+    parser.add_argument("--dual", action="store_true",
+                        help="转交 fontbin_tool.py, 双片并联布局并输出两片烧录文件")
+    parser.add_argument("--aa", action="append", default=[],
+                        metavar="SIZE:BPP[:ascii]", help="转交 fontbin_tool.py")
+    parser.add_argument("--metrics", action="store_true",
+                        help="转交 fontbin_tool.py")
+    parser.add_argument("--bounds", action="store_true",
+                        help="转交 fontbin_tool.py")
+    parser.add_argument("--blocks", action="store_true",
+                        help="转交 fontbin_tool.py")
+    parser.add_argument("--packed-index", action="store_true",
+                        help="转交 fontbin_tool.py")
+    parser.add_argument("--index-codes", action="store_true",
+                        help="转交 fontbin_tool.py")
+    parser.add_argument("--phash", action="store_true",
+                        help="转交 fontbin_tool.py")
+    parser.add_argument("--records", type=int, default=0, metavar="N",
+                        help="转交 fontbin_tool.py")
+    parser.add_argument("--image", action="append", default=[],
+                        metavar="[WxH:]FILE", help="转交 fontbin_tool.py")
+    parser.add_argument("--indexed", action="append", default=[],
+                        metavar="FILE", help="转交 fontbin_tool.py")
+    parser.add_argument("--rle", action="append", default=[],
+                        metavar="[WxH:]FILE", help="转交 fontbin_tool.py")
+    parser.add_argument("--jpeg", action="append", default=[],
+                        metavar="FILE", help="转交 fontbin_tool.py")
+    parser.add_argument("--strings", action="append", default=[],
+                        metavar="LANG:FILE", help="转交 fontbin_tool.py")
+    parser.add_argument("--strings-header", metavar="FILE",
+                        help="转交 fontbin_tool.py")
+    parser.add_argument("--family", type=fb.parse_family_spec,
+                        action="append", default=[], metavar="ID:FILE[:SIZES][:ascii]",
+                        help="再生成一套字体作为字体族ID(.bin提取或TTF渲染)")
+    parser.add_argument("--runs", metavar="FILE",
+                        help="预解析文本串文件, 每行 NAME[:SIZE]=文本")
+    parser.add_argument("--runs-header", metavar="FILE",
+                        help="--runs 生成的头文件")
+    parser.add_argument("--runs-image", metavar="BIN",
+                        help="不重新生成镜像, 按已有的镜像预解析 --runs")
+    args = parser.parse_args(argv)
+
+    if bool(args.runs) != bool(args.runs_header):
+        parser.error("--runs 与 --runs-header 需同时指定")
+    if args.check_header:
+        if check_header(args.check_header):
+            return 1
+        if not (args.from_bin or args.ttf or args.runs_image):
+            return 0
+    if args.runs_image:
+        if not args.runs or args.from_bin or args.ttf:
+            parser.error("--runs-image 只与 --runs 一起使用")
+        with open(args.runs_image, "rb") as f:
+            image = f.read()
+        return 1 if write_runs(args, image) else 0
+    if not (args.from_bin or args.ttf) or not args.output:
+        parser.error("需要 --from-bin 或 --ttf, 并用 -o 指定输出")
+    if args.resident and not args.header:
+        parser.error("--resident 需要同时指定 --header")
+
+    if args.from_bin:
+        with open(args.from_bin, "rb") as f:
+            records, glyphs, ascii_planes = read_bin_source(
+                bytearray(f.read()))
+        if args.charset:
+            records, glyphs, missing = select_records(
+                records, glyphs, load_charset(args.charset))
+            if missing:
+                print("源文件中没有 %d 个字符: %s" %
+                      (len(missing), "".join(missing[:20])), file=sys.stderr)
+        print("字模源 %s: %d 字" % (args.from_bin, len(records)))
+    else:
+        chars = load_charset(args.charset) if args.charset else gb2312_charset()
+        print("渲染 %s: %d 字" % (args.ttf, len(chars)))
+        glyphs, ascii_planes = render_ttf_source(args.ttf, args.ascii_ttf,
+                                                 chars)
+        records = [(ch, gb2312_code(ch)) for ch in chars]
+
+    if args.profile:
+        counts = {}
+        for path in args.profile:
+            kind, n = load_profile(path, counts)
+            print("使用频率 %s(%s): %d %s" %
+                  (path, kind, n, "行" if kind == "计数文件" else "字"))
+        records, glyphs, hot = order_by_profile(records, glyphs, counts)
+        print("字模重排: %d 个常用字排在前部" % hot)
+
+    data = build_legacy_image(records, glyphs, ascii_planes)
+    with open(args.output, "wb") as f:
+        f.write(data)
+    print("原始布局: %d 字, %d 字节" % (len(records), len(data)))
+
+    forward = [args.output, "-o", args.output]
+    if args.seq is not None:
+        forward += ["--seq", str(args.seq)]
+    if args.pack:
+        forward.append("--pack")
+    if args.row32:
+        forward += ["--row32", args.row32]
+    if args.sizes:
+        forward += ["--sizes", args.sizes]
+    if args.extra_sizes:
+        forward += ["--extra-sizes", args.extra_sizes]
+    if args.dual:
+        forward.append("--dual")
+    for spec in args.aa:
+        forward += ["--aa", spec]
+    if args.metrics:
+        forward.append("--metrics")
+    if args.bounds:
+        forward.append("--bounds")
+    if args.blocks:
+        forward.append("--blocks")
+    if args.packed_index:
+        forward.append("--packed-index")
+    if args.index_codes:
+        forward.append("--index-codes")
+    if args.phash:
+        forward.append("--phash")
+    if args.records:
+        forward += ["--records", str(args.records)]
+    for spec in args.image:
+        forward += ["--image", spec]
+    for path in args.indexed:
+        forward += ["--indexed", path]
+    for spec in args.rle:
+        forward += ["--rle", spec]
+    for path in args.jpeg:
+        forward += ["--jpeg", path]
+    for spec in args.strings:
+        forward += ["--strings", spec]
+    if args.strings_header:
+        forward += ["--strings-header", args.strings_header]
+    temps = []
+    try:
+        for spec in args.family:
+            temps.append("%s.family%d" % (args.output, len(temps)))
+            forward += ["--family", build_family_source(
+                spec, records, glyphs, ascii_planes, temps[-1])]
+        status = fb.main(forward)
+    finally:
+        for path in temps:
+            if os.path.exists(path):
+                os.remove(path)
+    if status:
+        return status
+
+    if args.header:
+        with open(args.output, "rb") as f:
+            image = f.read()
+        toc = read_toc(image)
+        resident = None
+        if args.resident:
+            with open(args.resident, "r", encoding="utf-8-sig") as f:
+                text = "".join(ch for line in f if not line.startswith("#")
+                               for ch in line if ch == " " or not ch.isspace())
+            unique = "".join(dict.fromkeys(text))
+            nbytes, nglyphs = resident_bytes(unique, args.resident_sizes,
+                                             records, glyphs, ascii_planes,
+                                             toc)
+            resident = (unique, nbytes, nglyphs, args.resident_sizes)
+            print("常驻子集: %d 字符, %d 项, %d 字节" %
+                  (len(unique), nglyphs, nbytes))
+        write_header(args.header, image, toc, resident)
+        print("头文件 %s: %d 段" % (args.header, len(toc)))
+    if args.runs:
+        with open(args.output, "rb") as f:
+            image = f.read()
+        if write_runs(args, image):
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
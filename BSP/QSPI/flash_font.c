@@ -15,322 +15,4279 @@
  *                              私有宏定义
  ******************************************************************************/
 #define FLAG_MAGIC 0x464C4147 /*!< 标志位魔数 "FLAG" */
+#define BANK_MAGIC 0x4B4E4246 /*!< 分区头魔数 "FBNK" */
+#define TOC_MAGIC 0x434F5446 /*!< 字库目录魔数 "FTOC" */
 #define FONT_MAGIC 0x47423332 /*!< 字库魔数 "GB23" (GB2312) */
 #define ASCII_MAGIC 0x49435341 /*!< ASCII魔数 "ASCI" */
+#define GB2312_TABLE_MAGIC 0x54424C47 /*!< GB2312对照表魔数 "GLBT" */
+#define UTF8_TABLE_MAGIC 0x38465455 /*!< UTF8对照表魔数 "UTF8" */
+#define UTF8_SORTED_MAGIC 0x52533855 /*!< UTF8排序索引魔数 "U8SR" */
+#define GB2312_MAP_MAGIC 0x4D444247 /*!< GB2312区位映射魔数 "GBDM" */
+#define FONT_TABLE_ENTRIES 7464 /*!< 旧版对照表最大项数 */
+#define ASCII_CHAR_COUNT 95 /*!< ASCII可见字符数(0x20-0x7E) */
+#define GB2312_MAP_DIM 94 /*!< GB2312区/位数量(0xA1-0xFE) */
+#define FONT_NO_GLYPH 0xFFFF /*!< 映射表中的无字形标记 */
+#define RESOLVE_CHUNK 32 /*!< 批量解析时每批排序的字符数 */
 #define FLASHFONT_OK 0        /*!< 操作成功 */
 
 /*******************************************************************************
  *                              私有函数与变量声明
  ******************************************************************************/
-static uint32_t GetFontBaseAddr(uint8_t font_size);
+static const uint8_t *GetGlyphAddr(int16_t index, uint8_t font_size);
+static const uint8_t *GlyphDesc_Addr(const FontDesc_t *d, int16_t index);
+static void UBlock_Load(const uint16_t *page, uint32_t blocks);
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+static void FontFallback_Load(void);
+#endif
 
 static uint8_t g_font_initialized = 0;      /*!< 初始化标志 */
+static uint32_t g_font_bank = FONT_BANK_A_ADDR; /*!< 当前使用的分区起始地址 */
+static uint32_t g_font_seq = 0;             /*!< 当前分区序号 */
+static volatile uint8_t g_bank_hold = 0;     /*!< 1-非活动分区正被直接擦写，QSPI不在映射模式 */
+#ifdef FLASH_FONT_HOLD_SUSPEND
+static uint8_t g_hold_mapped = 0;            /*!< 1-为读取字库暂停了擦写，映射区可读 */
+static FontHoldStats_t g_hold_stats;         /*!< 擦写暂停统计 */
+#endif
+static FontDesc_t g_font_desc[FLASH_FONT_MAX_SECTIONS]; /*!< RAM段描述表 */
+static uint8_t g_font_desc_count = 0;       /*!< 段描述数量 */
+static uint8_t g_font_family = 0;           /*!< 当前字体族，按字号索引的段表按它建立 */
+static uint8_t g_font_lang = 0;             /*!< 界面字符串的当前语言 */
+static uint8_t g_font_legacy = 0;           /*!< 当前分区没有目录(旧版固定布局) */
+static uint32_t g_font_epoch = 0;           /*!< 已同步到的Flash改写序号 */
+
+static void FontEpoch_Sync(void);
+
+/**
+ * @brief  Flash改写过时作废受影响的RAM索引和缓存
+ * @note   只比较改写序号，没有改写时不进入函数
+ */
+#define FontEpoch_Check()                                                      \
+  do {                                                                         \
+    if (g_font_epoch != QSPI_W25Qxx_UpdateEpoch()) {                          \
+      FontEpoch_Sync();                                                        \
+    }                                                                          \
+  } while (0)
+
+#define FONT_IDLE_DONE 0     /*!< 分步初始化：全部建完 */
+#define FONT_IDLE_HASH 1     /*!< 分步初始化：正在建立哈希表 */
+#define FONT_IDLE_RESIDENT 2 /*!< 分步初始化：等待拷贝常驻子集 */
+static uint8_t g_font_idle_stage = FONT_IDLE_DONE; /*!< FlashFont_Idle() 的当前阶段 */
+static void FontIdle_Resident(void);
+static const FontDesc_t *g_glyph_desc[FLASH_FONT_MAX_SIZE + 1]; /*!< 按字号索引的汉字字模段 */
+static const FontDesc_t *g_ascii_desc[FLASH_FONT_MAX_SIZE + 1]; /*!< 按字号索引的ASCII字模段 */
+#ifdef FLASH_FONT_AA_ENABLE
+static const FontDesc_t *g_glyph_aa_desc[FLASH_FONT_MAX_SIZE + 1]; /*!< 按字号索引的汉字抗锯齿段 */
+static const FontDesc_t *g_ascii_aa_desc[FLASH_FONT_MAX_SIZE + 1]; /*!< 按字号索引的ASCII抗锯齿段 */
+#endif
+#ifdef FLASH_FONT_METRICS_ENABLE
+static const FontDesc_t *g_ascii_metrics_desc[FLASH_FONT_MAX_SIZE + 1]; /*!< 按字号索引的ASCII字宽表 */
+static const FontDesc_t *g_ascii_kern_desc[FLASH_FONT_MAX_SIZE + 1]; /*!< 按字号索引的ASCII字偶距表 */
+#endif
+#ifdef FLASH_FONT_BOX_ENABLE
+static const FontDesc_t *g_glyph_box_desc[FLASH_FONT_MAX_SIZE + 1]; /*!< 按字号索引的汉字笔画外框表 */
+#endif
+#ifdef FLASH_FONT_RECORD_ENABLE
+static const FontDesc_t *g_glyph_record_desc[FLASH_FONT_MAX_SIZE + 1]; /*!< 按字号索引的多字号记录段 */
+#endif
+static const GB2312_TableEntry_t *g_gb2312_table = NULL; /*!< GB2312对照表,NULL表示不存在 */
+static uint32_t g_gb2312_count = 0;         /*!< GB2312对照表项数 */
+static const UTF8_TableEntry_t *g_utf8_table = NULL; /*!< UTF8对照表,NULL表示不存在 */
+static uint32_t g_utf8_count = 0;           /*!< UTF8对照表项数 */
+static const UTF8_SortedEntry_t *g_utf8_sorted = NULL; /*!< UTF8排序索引,NULL表示不存在 */
+static uint16_t g_utf8_sorted_count = 0;    /*!< UTF8排序索引项数 */
+static const uint32_t *g_utf8_packed = NULL; /*!< 压缩UTF8排序索引,NULL表示不存在(存在时优先使用) */
+static uint16_t g_utf8_packed_count = 0;    /*!< 压缩排序索引项数 */
+static uint8_t g_utf8_packed_bits = 0;      /*!< 压缩排序索引中字库索引的位数 */
+static uint32_t g_run_index_stamp = 0;      /*!< UTF8排序索引的校验，FlashFont_RunStamp() 第一次调用时计算 */
+static uint8_t g_run_index_valid = 0;       /*!< g_run_index_stamp 是否已计算 */
+static const uint16_t *g_gb2312_map = NULL; /*!< GB2312区位映射表,NULL表示不存在 */
+#ifdef FLASH_FONT_GBK_TEXT
+static const FontIndexCode_t *g_index_codes = NULL; /*!< 字库索引编码表,NULL表示不存在 */
+static uint16_t g_index_codes_count = 0;            /*!< 字库索引编码表项数 */
+static uint8_t g_text_enc = FONT_ENC_UTF8;          /*!< FlashFont_DecodeText() 的文本编码 */
+#endif
+#ifdef FLASH_FONT_GB2312_ROWS
+/**
+ * @brief  GB2312行表项(16字节)
+ * @note   区内字库索引按位号连续递增时，第c位的字库索引 =
+ *         base + 位图中c之前的1的个数；否则base为GB_ROW_FLASH，该区查Flash中的映射表
+ */
+typedef struct {
+  uint32_t bits[3]; /*!< 存在位图，位c对应第c位(c=0对应0xA1) */
+  uint16_t base;    /*!< 该区第一个字的字库索引，GB_ROW_FLASH表示该区不能由行表计算 */
+  uint8_t pre[2];   /*!< bits[0]、bits[0..1]中1的个数 */
+} GbRow_t;
+
+#define GB_ROW_FLASH 0xFFFF /*!< 行表项的base：该区字库索引不连续 */
+#define GB_ROW_MAP (-2)     /*!< GbRows_Find()：需要查映射表 */
+
+FLASH_FONT_GB2312_ROWS_ATTR static GbRow_t g_gb_rows[GB2312_MAP_DIM]; /*!< GB2312行表 */
+static uint8_t g_gb_rows_ready = 0; /*!< 行表是否可用 */
+
+static void GbRows_Build(void);
+#endif
+static const uint16_t *g_ublock_page = NULL; /*!< Unicode分块索引页表,NULL表示不存在 */
+
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+#define MISS_SLOTS (1UL << FLASH_FONT_MISS_BITS) /*!< 缺字缓存槽数 */
+#define MISS_NO_FALLBACK 0x80000000U             /*!< 备用分区也没有该字 */
+
+static uint32_t g_font_miss[MISS_SLOTS]; /*!< 活动分区中没有的码点(直接映射)，0为空槽 */
+#endif
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+static const UTF8_SortedEntry_t *g_fb_sorted = NULL; /*!< 备用分区的UTF8排序索引,NULL表示没有备用分区 */
+static uint16_t g_fb_sorted_count = 0;      /*!< 备用分区排序索引项数 */
+static FontDesc_t g_fb_glyph[FLASH_FONT_FALLBACK_SECTIONS]; /*!< 备用分区中与活动分区格式相同的汉字字模段 */
+static uint8_t g_fb_glyph_count = 0;        /*!< 备用汉字字模段数 */
+static FontDesc_t g_fb_index;               /*!< 备用分区排序索引的段描述(用于校验) */
+#endif
+static CRC_HandleTypeDef g_font_crc;        /*!< CRC单元句柄，段校验和 FlashFont_Crc32() 共用 */
+static uint8_t g_crc_ready = 0;             /*!< 0-未初始化, 1-可用, 2-初始化失败 */
+#ifdef FLASH_FONT_CRC_ENABLE
+static const FontDesc_t *g_crc_desc = NULL; /*!< FlashFont_Idle() 正在校验的段 */
+static uint32_t g_crc_pos = 0;              /*!< 该段已校验的字节数 */
+static uint32_t g_crc_value = 0;            /*!< 该段的CRC中间值 */
+
+static const FontDesc_t *FontCrc_Require(const FontDesc_t *d);
+static uint8_t FontCrc_Step(uint32_t n);
+#endif
+#ifdef FLASH_FONT_MIRROR_ENABLE
+#define FONT_MIRROR_OFF 0    /*!< 没有镜像(未启动、空间不足或传输出错) */
+#define FONT_MIRROR_COPY 1   /*!< MDMA拷贝中 */
+#define FONT_MIRROR_COPIED 2 /*!< 拷贝完成，等待 FlashFont_Idle() 切换 */
+#define FONT_MIRROR_ON 3     /*!< 查找已改读SDRAM */
+
+/**
+ * @brief  镜像的一段连续数据
+ */
+typedef struct {
+  uint32_t ofs;  /*!< 分区内偏移(4字节对齐) */
+  uint32_t size; /*!< 字节数(4的倍数) */
+  uint32_t dst;  /*!< 镜像区内偏移 */
+} FontMirrorItem_t;
+
+static MDMA_HandleTypeDef g_mirror_mdma;                       /*!< MDMA句柄 */
+static FontMirrorItem_t g_mirror_item[FLASH_FONT_MAX_SECTIONS]; /*!< 要拷贝的数据段 */
+static uint8_t g_mirror_count = 0;                             /*!< 数据段数 */
+static uint8_t g_mirror_cur = 0;                               /*!< 正在拷贝的数据段 */
+static uint32_t g_mirror_pos = 0;                              /*!< 该段已拷贝的字节数 */
+static uint32_t g_mirror_len = 0;                              /*!< 本次传输的字节数 */
+static uint32_t g_mirror_bank = 0;                             /*!< 镜像的分区 */
+static uint8_t g_mirror_ready = 0;                             /*!< MDMA是否已初始化 */
+static volatile uint8_t g_mirror_state = FONT_MIRROR_OFF;      /*!< 镜像状态 */
+
+/**
+ * @brief  地址是否在SDRAM镜像区内，只有切换之后段描述才会指向这里
+ */
+#define FONT_MIRROR_HOLDS(p)                                                   \
+  ((uint32_t)(p) - FLASH_FONT_MIRROR_ADDR < FLASH_FONT_MIRROR_BYTES)
+
+static const uint8_t *FontMirror_Flash(const uint8_t *p);
+static void FontMirror_Stop(void);
+static void FontMirror_Start(const FontTocHeader_t *toc);
+static void FontMirror_Switch(void);
+#endif
+#ifdef FLASH_FONT_HOLD_SUSPEND
+static void FontHold_Map(void);
+
+/**
+ * @brief  分区安装擦写期间访问映射区之前调用，暂停擦写并映射
+ */
+#define FontHold_Use()                                                         \
+  do {                                                                         \
+    if (g_bank_hold && !g_hold_mapped) {                                       \
+      FontHold_Map();                                                          \
+    }                                                                          \
+  } while (0)
+#else
+#define FontHold_Use() ((void)0)
+#endif
+#ifdef FLASH_FONT_POWER_DOWN
+#define FONT_PD_USED 0   /*!< 上次检查之后访问过字库 */
+#define FONT_PD_IDLE 1   /*!< 映射中，从g_pd_tick起没有访问 */
+#define FONT_PD_ASLEEP 2 /*!< Flash处于深度掉电 */
+static uint8_t g_pd_state = FONT_PD_USED; /*!< 深度掉电状态 */
+static uint32_t g_pd_tick = 0;            /*!< 进入FONT_PD_IDLE的时刻 */
+static FontPowerStats_t g_pd_stats;       /*!< 深度掉电统计 */
+
+static void FontPower_Wake(void);
+
+/**
+ * @brief  访问映射区之前调用，记录访问并在掉电时唤醒
+ * @note   只比较一个字节，绝大多数调用不进入函数
+ */
+#define FontPower_Use()                                                        \
+  do {                                                                         \
+    FontHold_Use();                                                            \
+    if (g_pd_state != FONT_PD_USED) {                                          \
+      FontPower_Wake();                                                        \
+    }                                                                          \
+  } while (0)
+#else
+#define FontPower_Use() FontHold_Use()
+#endif
+#ifdef FLASH_FONT_TOFU_ENABLE
+#define TOFU_ROW_BYTES FONT_ROW32_BYTES(FLASH_FONT_TOFU_MAX_SIZE) /*!< 方框字模每行最多字节数(按字补齐) */
+
+static uint8_t g_tofu[TOFU_ROW_BYTES + FLASH_FONT_TOFU_MAX_SIZE * TOFU_ROW_BYTES]
+    __attribute__((aligned(4))); /*!< 方框字模(含压缩格式的行标记)，按字读取需4字节对齐 */
+static uint8_t g_tofu_size = 0;             /*!< g_tofu 对应的字号，0表示未生成 */
+#endif
+
+#ifdef FLASH_FONT_RAM_HASH
+#define HASH_SLOTS (1UL << FLASH_FONT_HASH_BITS) /*!< 哈希表槽数 */
+#define HASH_MAX_USED (HASH_SLOTS * 7UL / 10UL) /*!< 最多容纳的字符数，负载率不超过0.7，线性探测的平均探测次数保持在2次以内 */
+#define HASH_EMPTY 0x0000                        /*!< 空槽标记(码点0不会出现在字库中) */
+
+/**
+ * @brief  哈希表槽(4字节)
+ * @note   字库只包含BMP字符，码点用16位保存
+ */
+typedef struct {
+  uint16_t code;  /*!< Unicode码点, HASH_EMPTY表示空槽 */
+  uint16_t index; /*!< 字库索引 */
+} FontHashSlot_t;
+
+#ifdef FLASH_FONT_PHASH_ENABLE
+#if FLASH_FONT_PHASH_BYTES > 65536 || (FLASH_FONT_PHASH_BYTES % 32) != 0
+#error "FLASH_FONT_PHASH_BYTES 必须是32的倍数且不超过65536(一次MDMA块传输)"
+#endif
+#endif
+
+/**
+ * @brief  哈希表存储区
+ * @note   使用完美哈希段时同一块内存存放拷贝来的种子表和槽
+ */
+typedef union {
+  FontHashSlot_t slot[HASH_SLOTS]; /*!< 由对照表建立的哈希表 */
+#ifdef FLASH_FONT_PHASH_ENABLE
+  uint32_t phash[FLASH_FONT_PHASH_BYTES / 4]; /*!< 完美哈希段的拷贝 */
+#endif
+} FontHashMem_t;
+
+FLASH_FONT_HASH_ATTR static FontHashMem_t g_font_hash DMA_ALIGNED; /*!< 码点->索引哈希表，按Cache行对齐(MDMA写入前按地址作废Cache) */
+static uint8_t g_font_hash_ready = 0; /*!< 哈希表是否可用 */
+static uint32_t g_hash_pos = 0;  /*!< 分步建立时下一个要处理的对照表项 */
+static uint32_t g_hash_used = 0; /*!< 已占用的槽数 */
+#ifdef FLASH_FONT_PHASH_ENABLE
+static const FontHashSlot_t *g_phash_slot = NULL; /*!< 完美哈希的槽，NULL表示未使用 */
+static uint16_t g_phash_count = 0;     /*!< 完美哈希的槽数 */
+static uint8_t g_phash_bits = 0;       /*!< 种子表项数=2^N */
+static MDMA_HandleTypeDef g_phash_mdma; /*!< 拷贝完美哈希段的MDMA句柄 */
+static uint8_t g_phash_mdma_state = 0; /*!< 0-未配置, 1-可用, 2-配置失败(改由CPU拷贝) */
+#endif
+
+#ifndef FLASH_FONT_LAZY_INIT
+static void FontHash_Build(void);
+#endif
+static int16_t FontHash_Find(uint32_t cp);
+#endif
+
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+#if FLASH_FONT_RESIDENT_BYTES > 65535 || FLASH_FONT_RESIDENT_MAX > 65535
+#error "FLASH_FONT_RESIDENT_BYTES 和 FLASH_FONT_RESIDENT_MAX 不能超过65535"
+#endif
+
+/**
+ * @brief  常驻字模索引项(8字节)
+ */
+typedef struct {
+  uint32_t key;   /*!< (码点 << 8) | 字号，按升序排列 */
+  uint16_t ofs;   /*!< 字模在数据池中的偏移 */
+  uint16_t bytes; /*!< 字模字节数 */
+} FontResidentEntry_t;
+
+FLASH_FONT_RESIDENT_ATTR static FontResidentEntry_t
+    g_res_index[FLASH_FONT_RESIDENT_MAX]; /*!< 常驻字模索引 */
+FLASH_FONT_RESIDENT_ATTR static uint8_t g_res_pool[FLASH_FONT_RESIDENT_BYTES]
+    __attribute__((aligned(4))); /*!< 常驻字模数据池 */
+static uint16_t g_res_count = 0;          /*!< 常驻字模数 */
+static FontResidentStats_t g_res_stats;   /*!< 常驻子集统计 */
+static const char *g_res_chars = FLASH_FONT_RESIDENT_CHARS; /*!< 常驻字符列表 */
+static uint16_t g_res_budget = FLASH_FONT_RESIDENT_BYTES;   /*!< 运行时字模数据预算 */
+#endif
 
 /*******************************************************************************
  *                              私有函数实现
  ******************************************************************************/
 
 /**
- * @brief  获取字体存储基地址
+ * @brief  把当前分区内的偏移转换为内存映射地址
+ */
+static inline const uint8_t *FontPtr(uint32_t ofs) {
+  return (const uint8_t *)(W25Qxx_Mem_Addr + g_font_bank + ofs);
+}
+
+/**
+ * @brief  读取分区的字库目录
+ * @param  bank: 分区起始地址
+ * @retval 目录头指针，目录不存在或格式不支持返回NULL
+ */
+static const FontTocHeader_t *FontToc_Get(uint32_t bank) {
+  const FontTocHeader_t *toc =
+      (const FontTocHeader_t *)(W25Qxx_Mem_Addr + bank + FONT_TOC_ADDR);
+
+  if (toc->magic != TOC_MAGIC || toc->version != FONT_TOC_VERSION ||
+      toc->hdr_size < sizeof(FontTocHeader_t) ||
+      toc->entry_size < FONT_TOC_ENTRY_MIN ||
+      FONT_TOC_ADDR + toc->hdr_size + (uint32_t)toc->count * toc->entry_size >
+          FONT_BANK_HDR_OFS) {
+    return NULL;
+  }
+  return toc;
+}
+
+/**
+ * @brief  取目录第i项
+ */
+static inline const FontTocEntry_t *FontToc_Entry(const FontTocHeader_t *toc,
+                                                  uint16_t i) {
+  return (const FontTocEntry_t *)((const uint8_t *)toc + toc->hdr_size +
+                                  (uint32_t)i * toc->entry_size);
+}
+
+/**
+ * @brief  取目录项的校验状态初值
+ * @retval 目录项带CRC且启用校验时为 FONT_TRUST_PENDING，否则为 FONT_TRUST_OK
+ */
+static inline uint8_t FontToc_Trust(const FontTocHeader_t *toc,
+                                    const FontTocEntry_t *e) {
+#ifdef FLASH_FONT_CRC_ENABLE
+  if (toc->entry_size >= sizeof(FontTocEntry_t) && (e->flags & FONT_TOC_F_CRC)) {
+    return FONT_TRUST_PENDING;
+  }
+#else
+  (void)toc;
+  (void)e;
+#endif
+  return FONT_TRUST_OK;
+}
+
+/**
+ * @brief  检查段描述是否可以使用
+ * @retval 可信的段返回d本身；待校验的段当场校验，失败返回NULL
+ * @note   字模等数据在交给调用者之前都经过这里，旧版布局的段总是可信
+ */
+static inline const FontDesc_t *FontDesc_Use(const FontDesc_t *d) {
+#ifdef FLASH_FONT_MIRROR_ENABLE
+  if (d == NULL || !FONT_MIRROR_HOLDS(d->data)) // 镜像中的段不读Flash，不唤醒
+#endif
+  FontPower_Use();
+#ifdef FLASH_FONT_CRC_ENABLE
+  if (d != NULL && d->trust != FONT_TRUST_OK) {
+    return FontCrc_Require(d);
+  }
+#endif
+  return d;
+}
+
+/**
+ * @brief  获取分区的字库写入标志
+ * @param  bank: 分区起始地址
+ * @retval 标志指针，有目录时取目录中的标志段，否则为旧版固定地址
+ */
+static const FontWriteFlag_t *FontBank_Flag(uint32_t bank) {
+  const FontTocHeader_t *toc = FontToc_Get(bank);
+
+  if (toc != NULL) {
+    for (uint16_t i = 0; i < toc->count; i++) {
+      const FontTocEntry_t *e = FontToc_Entry(toc, i);
+      if (e->type == FONT_SEC_FLAG && e->size >= sizeof(FontWriteFlag_t)) {
+        return (const FontWriteFlag_t *)(W25Qxx_Mem_Addr + bank + e->offset);
+      }
+    }
+    return NULL;
+  }
+  return (const FontWriteFlag_t *)(W25Qxx_Mem_Addr + bank + FONT_FLAG_ADDR);
+}
+
+/**
+ * @brief  检查分区是否有效并读取序号
+ * @param  bank: 分区起始地址
+ * @param  seq: 输出分区序号
+ * @retval 1-有效, 0-无效
+ * @note   A区没有分区头但字库标志有效时视为序号0(直接烧录的旧bin文件)
+ */
+static uint8_t FontBank_Probe(uint32_t bank, uint32_t *seq) {
+  const FontBankHeader_t *hdr =
+      (const FontBankHeader_t *)(W25Qxx_Mem_Addr + bank + FONT_BANK_HDR_OFS);
+  const FontWriteFlag_t *flag = FontBank_Flag(bank);
+
+  if (flag == NULL || flag->magic != FLAG_MAGIC) {
+    return 0;
+  }
+  if (hdr->magic == BANK_MAGIC &&
+      hdr->check == ~(hdr->magic ^ hdr->seq ^ hdr->size)) {
+    *seq = hdr->seq;
+    return 1;
+  }
+  if (bank == FONT_BANK_A_ADDR && hdr->magic == 0xFFFFFFFF) {
+    *seq = 0;
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief  追加一项RAM段描述
+ * @retval 新段描述指针，描述表已满返回NULL
+ */
+static FontDesc_t *FontDesc_Add(uint8_t type, uint8_t font_size,
+                                const uint8_t *data, uint32_t count,
+                                uint16_t stride) {
+  FontDesc_t *d;
+
+  if (g_font_desc_count >= FLASH_FONT_MAX_SECTIONS) {
+    DEBUG_ERROR("FontDesc_Add: 段描述表已满");
+    return NULL;
+  }
+  d = &g_font_desc[g_font_desc_count++];
+  memset(d, 0, sizeof(*d));
+  d->type = type;
+  d->font_size = font_size;
+  d->data = data;
+  d->count = count;
+  d->stride = stride;
+  return d;
+}
+
+/**
+ * @brief  计算压缩字模段的块基址数
+ */
+static inline uint32_t FontRle_Blocks(uint32_t count) {
+  return (count + (1UL << FONT_RLE_BLOCK_BITS) - 1) >> FONT_RLE_BLOCK_BITS;
+}
+
+/**
+ * @brief  计算压缩字模段索引(块基址 + 字偏移)的字节数
+ */
+static inline uint32_t FontRle_IndexBytes(uint32_t count) {
+  return FontRle_Blocks(count) * sizeof(uint32_t) + count * sizeof(uint16_t);
+}
+
+/**
+ * @brief  检查图片段中每张图片的像素都在段内
+ * @note   RAM描述表不保存段大小，越界检查只在解析目录时做一次
+ */
+static uint8_t FontImage_Check(const FontTocEntry_t *e) {
+  const FontImage_t *img = (const FontImage_t *)FontPtr(e->offset);
+
+  for (uint32_t i = 0; i < e->count; i++) {
+    uint32_t bytes = (uint32_t)img[i].width * img[i].height * 2;
+
+    if ((img[i].offset & 1) != 0 || img[i].offset > e->size ||
+        bytes > e->size - img[i].offset) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief  检查调色板图片段中每张图片的调色板和像素都在段内
+ */
+static uint8_t FontIndexed_Check(const FontTocEntry_t *e) {
+  const FontIndexedImage_t *img =
+      (const FontIndexedImage_t *)FontPtr(e->offset);
+
+  for (uint32_t i = 0; i < e->count; i++) {
+    uint32_t bytes = FONT_INDEXED_PIXELS(&img[i]) +
+                     (((uint32_t)img[i].width * img[i].bpp + 7) / 8) *
+                         img[i].height;
+
+    if ((img[i].bpp != 4 && img[i].bpp != 8) || img[i].colors == 0 ||
+        img[i].colors > (1U << img[i].bpp) || (img[i].offset & 3) != 0 ||
+        img[i].offset > e->size || bytes > e->size - img[i].offset) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief  检查行程压缩图片段中每张图片的数据都在段内且2字节对齐
+ */
+static uint8_t FontRle_Check(const FontTocEntry_t *e) {
+  const FontRleImage_t *img = (const FontRleImage_t *)FontPtr(e->offset);
+
+  for (uint32_t i = 0; i < e->count; i++) {
+    if (((img[i].offset | img[i].size) & 1) != 0 ||
+        img[i].offset > e->size || img[i].size > e->size - img[i].offset) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief  检查字符串表中每个字符串连同结尾的'\0'都在段内
+ */
+static uint8_t FontString_Check(const FontTocEntry_t *e) {
+  const FontString_t *str = (const FontString_t *)FontPtr(e->offset);
+
+  for (uint32_t i = 0; i < e->count; i++) {
+    if (str[i].bytes == 0) {
+      continue; // 该语言没有译文
+    }
+    if (str[i].offset >= e->size || str[i].bytes >= e->size - str[i].offset ||
+        FontPtr(e->offset)[str[i].offset + str[i].bytes] != '\0') {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief  检查JPEG段中每张图片的数据都在段内且4字节对齐
+ */
+static uint8_t FontJpeg_Check(const FontTocEntry_t *e) {
+  const FontJpeg_t *jpeg = (const FontJpeg_t *)FontPtr(e->offset);
+
+  for (uint32_t i = 0; i < e->count; i++) {
+    if (((jpeg[i].offset | jpeg[i].size) & 3) != 0 ||
+        jpeg[i].offset > e->size || jpeg[i].size > e->size - jpeg[i].offset) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief  由字库目录生成RAM段描述表
+ * @param  toc: 目录头
+ * @note   数据越界或步长与大小不符的目录项直接丢弃
+ */
+static void FontDesc_LoadToc(const FontTocHeader_t *toc) {
+  for (uint16_t i = 0; i < toc->count; i++) {
+    const FontTocEntry_t *e = FontToc_Entry(toc, i);
+    uint8_t font_size = 0;
+    FontDesc_t *d;
+
+    if (e->offset > FONT_BANK_HDR_OFS ||
+        e->size > FONT_BANK_HDR_OFS - e->offset ||
+        e->family >= FLASH_FONT_MAX_FAMILIES) {
+      continue;
+    }
+    if (e->format == FONT_FMT_1BPP_RLE) {
+      if (e->type != FONT_SEC_GLYPH || (e->offset & 3) != 0 ||
+          FontRle_IndexBytes(e->count) > e->size) {
+        continue; // 只有汉字字模段可以压缩，索引需4字节对齐
+      }
+    } else if (e->format == FONT_FMT_1BPP_ROW32) {
+      if (e->type != FONT_SEC_GLYPH || (e->offset & 3) != 0 ||
+          e->stride != FONT_ROW32_BYTES(e->width) * e->height ||
+          (uint64_t)e->count * e->stride > e->size) {
+        continue; // 只有汉字字模段按字补齐，段起始和每行都需4字节对齐
+      }
+    } else if ((uint64_t)e->count * e->stride > e->size) {
+      continue;
+    }
+    if (e->type == FONT_SEC_GLYPH || e->type == FONT_SEC_ASCII) {
+      if ((e->format != FONT_FMT_1BPP_ROW && e->format != FONT_FMT_1BPP_RLE &&
+           e->format != FONT_FMT_1BPP_ROW32) ||
+          e->stride == 0) {
+        continue; // 不支持的字模格式
+      }
+      font_size = e->height;
+    } else if (e->type == FONT_SEC_GLYPH_AA || e->type == FONT_SEC_ASCII_AA) {
+      if ((e->format != FONT_FMT_2BPP_ROW && e->format != FONT_FMT_4BPP_ROW) ||
+          e->stride == 0) {
+        continue;
+      }
+      font_size = e->height;
+    } else if (e->type == FONT_SEC_ASCII_METRICS) {
+      if (e->stride != sizeof(FontAsciiMetric_t) ||
+          e->index_type != FONT_IDX_CODE) {
+        continue;
+      }
+      font_size = e->height;
+    } else if (e->type == FONT_SEC_ASCII_KERN) {
+      if (e->stride != sizeof(FontKernPair_t)) {
+        continue;
+      }
+      font_size = e->height;
+    } else if (e->type == FONT_SEC_GLYPH_RECORD) {
+      if (e->format != FONT_FMT_1BPP_ROW || e->index_type != FONT_IDX_TABLE ||
+          e->stride < ((e->width + 7) / 8) * e->height) {
+        continue; // 记录中只存未压缩字模
+      }
+      font_size = e->height;
+    } else if (e->type == FONT_SEC_GLYPH_BOX) {
+      if (e->stride != sizeof(FontGlyphBox_t) ||
+          e->index_type != FONT_IDX_TABLE) {
+        continue;
+      }
+      font_size = e->height;
+    } else if (e->type == FONT_SEC_IMAGE) {
+      if (e->format != FONT_FMT_RGB565 || e->stride != sizeof(FontImage_t) ||
+          (e->offset & 3) != 0 || !FontImage_Check(e)) {
+        continue;
+      }
+    } else if (e->type == FONT_SEC_INDEXED_IMAGE) {
+      if (e->format != FONT_FMT_INDEXED ||
+          e->stride != sizeof(FontIndexedImage_t) || (e->offset & 3) != 0 ||
+          !FontIndexed_Check(e)) {
+        continue;
+      }
+    } else if (e->type == FONT_SEC_RLE_IMAGE) {
+      if (e->format != FONT_FMT_RLE565 ||
+          e->stride != sizeof(FontRleImage_t) || (e->offset & 3) != 0 ||
+          !FontRle_Check(e)) {
+        continue;
+      }
+    } else if (e->type == FONT_SEC_STRINGS) {
+      if (e->stride != sizeof(FontString_t) || (e->offset & 3) != 0 ||
+          e->first >= FONT_LANG_MAX || !FontString_Check(e)) {
+        continue;
+      }
+    } else if (e->type == FONT_SEC_STRING_CHARS) {
+      if (e->stride != 1 || e->count == 0 || e->first >= FONT_LANG_MAX ||
+          FontPtr(e->offset)[e->count - 1] != '\0') {
+        continue;
+      }
+    } else if (e->type == FONT_SEC_JPEG) {
+      if (e->format != FONT_FMT_JPEG || e->stride != sizeof(FontJpeg_t) ||
+          (e->offset & 3) != 0 || !FontJpeg_Check(e)) {
+        continue;
+      }
+    } else if (e->type == FONT_SEC_UTF8_PACKED) {
+      if (e->stride != sizeof(uint32_t) || (e->offset & 3) != 0 ||
+          e->width == 0 || e->width > FONT_PACKED_INDEX_MAX_BITS) {
+        continue; // 索引位数超出int16_t的字库索引
+      }
+    } else if (e->type == FONT_SEC_INDEX_CODES) {
+      if (e->stride != sizeof(FontIndexCode_t) || (e->offset & 1) != 0) {
+        continue;
+      }
+    } else if (e->type == FONT_SEC_UTF8_PHASH) {
+      if (e->stride != sizeof(uint32_t) || (e->offset & 3) != 0 ||
+          e->width == 0 || e->width > FONT_PHASH_MAX_BITS ||
+          e->count == 0 || e->count > 0xFFFF ||
+          e->size != (2UL << e->width) + e->count * sizeof(uint32_t)) {
+        continue; // 种子表和槽按4字节整段拷贝
+      }
+    }
+    if (font_size != 0 && !FONT_SIZE_USED(font_size)) {
+      continue; // init.h FONT_SIZES 未启用的字号不建描述
+    }
+    d = FontDesc_Add(e->type, font_size, FontPtr(e->offset), e->count,
+                     e->stride);
+    if (d == NULL) {
+      return;
+    }
+    d->width = e->width;
+    d->format = e->format;
+    d->index_type = e->index_type;
+    d->first = e->first;
+    d->family = e->family;
+    d->trust = FontToc_Trust(toc, e);
+    d->toc = i;
+  }
+}
+
+/**
+ * @brief  读取旧版固定布局中的一个附加数据段头
+ * @param  ofs: 段头在分区中的偏移
+ * @param  magic: 段魔数
+ * @param  item_size: 每个数据项的字节数
+ * @retval 段头指针，魔数不符、段头大小或项数超出分区(空白Flash读出0xFFFFFFFF)时返回NULL
+ */
+static const FontSectionHeader_t *FontSec_Get(uint32_t ofs, uint32_t magic,
+                                              uint32_t item_size) {
+  const FontSectionHeader_t *sec = (const FontSectionHeader_t *)FontPtr(ofs);
+  uint32_t room = FONT_BANK_SIZE - ofs; // 段头到分区末尾的字节数
+
+  if (sec->magic != magic || sec->hdr_size < sizeof(FontSectionHeader_t) ||
+      sec->hdr_size > room || sec->count > (room - sec->hdr_size) / item_size) {
+    return NULL;
+  }
+  return sec;
+}
+
+/**
+ * @brief  按旧版固定布局解析各段文件头，生成RAM段描述表
+ * @note   汉字字模区18字节文件头、对照表12字节段头、ASCII字库文件头
+ *         只在这里解析一次
+ */
+static void FontDesc_LoadLegacy(void) {
+  static const uint32_t glyph_ofs[] = {FONT_12x12_ADDR, FONT_16x16_ADDR,
+                                       FONT_20x20_ADDR, FONT_24x24_ADDR,
+                                       FONT_32x32_ADDR};
+  const FontSectionHeader_t *sec;
+  const ASCII_FontHeader_t *ascii;
+  FontDesc_t *d;
+
+  for (uint8_t i = 0; i < sizeof(glyph_ofs) / sizeof(glyph_ofs[0]); i++) {
+    const FontGlyphHeader_t *h =
+        (const FontGlyphHeader_t *)FontPtr(glyph_ofs[i]);
+
+    if (h->magic != FONT_MAGIC || h->bytes_per_char == 0 ||
+        !FONT_SIZE_USED(h->height)) {
+      continue;
+    }
+    d = FontDesc_Add(FONT_SEC_GLYPH, (uint8_t)h->height,
+                     (const uint8_t *)h + sizeof(FontGlyphHeader_t), h->count,
+                     h->bytes_per_char);
+    if (d != NULL) {
+      d->width = (uint8_t)h->width;
+      d->format = FONT_FMT_1BPP_ROW;
+      d->index_type = FONT_IDX_TABLE;
+    }
+  }
+
+  ascii = (const ASCII_FontHeader_t *)FontPtr(ASCII_FONTS_ADDR);
+  if (ascii->magic == ASCII_MAGIC) {
+    for (uint32_t i = 0; i < ascii->num_fonts && i < 5; i++) {
+      const ASCII_FontInfo_t *info = &ascii->fonts[i];
+
+      if (!FONT_SIZE_USED(info->height)) {
+        continue;
+      }
+
+      d = FontDesc_Add(FONT_SEC_ASCII, (uint8_t)info->height,
+                       FontPtr(ASCII_FONTS_ADDR + info->offset),
+                       ASCII_CHAR_COUNT,
+                       (uint16_t)(info->size / ASCII_CHAR_COUNT));
+      if (d != NULL) {
+        d->width = (uint8_t)info->width;
+        d->format = FONT_FMT_1BPP_ROW;
+        d->index_type = FONT_IDX_CODE;
+        d->first = 0x20;
+      }
+      // 字宽表偏移存放在原保留字节中，原始bin文件为0
+      if (info->metrics != 0 && info->metrics != 0xFFFFFFFF &&
+          info->metrics < FONT_BANK_HDR_OFS - ASCII_FONTS_ADDR -
+                              ASCII_CHAR_COUNT * sizeof(FontAsciiMetric_t)) {
+        d = FontDesc_Add(FONT_SEC_ASCII_METRICS, (uint8_t)info->height,
+                         FontPtr(ASCII_FONTS_ADDR + info->metrics),
+                         ASCII_CHAR_COUNT, sizeof(FontAsciiMetric_t));
+        if (d != NULL) {
+          d->index_type = FONT_IDX_CODE;
+          d->first = 0x20;
+        }
+      }
+    }
+  }
+
+  sec = FontSec_Get(GB2312_TABLE_ADDR, GB2312_TABLE_MAGIC,
+                    sizeof(GB2312_TableEntry_t));
+  if (sec != NULL) {
+    FontDesc_Add(FONT_SEC_GB2312_TABLE, 0,
+                 (const uint8_t *)sec + sec->hdr_size,
+                 (sec->count < FONT_TABLE_ENTRIES) ? sec->count
+                                                   : FONT_TABLE_ENTRIES,
+                 sizeof(GB2312_TableEntry_t));
+  }
+  sec = FontSec_Get(UTF8_TABLE_ADDR, UTF8_TABLE_MAGIC, sizeof(UTF8_TableEntry_t));
+  if (sec != NULL) {
+    FontDesc_Add(FONT_SEC_UTF8_TABLE, 0, (const uint8_t *)sec + sec->hdr_size,
+                 (sec->count < FONT_TABLE_ENTRIES) ? sec->count
+                                                   : FONT_TABLE_ENTRIES,
+                 sizeof(UTF8_TableEntry_t));
+  }
+
+  // fontbin_tool.py生成的加速段，旧版bin文件没有
+  sec = FontSec_Get(UTF8_SORTED_ADDR, UTF8_SORTED_MAGIC,
+                    sizeof(UTF8_SortedEntry_t));
+  if (sec != NULL) {
+    FontDesc_Add(FONT_SEC_UTF8_SORTED, 0, (const uint8_t *)sec + sec->hdr_size,
+                 sec->count, sizeof(UTF8_SortedEntry_t));
+  }
+  sec = FontSec_Get(GB2312_MAP_ADDR, GB2312_MAP_MAGIC, sizeof(uint16_t));
+  if (sec != NULL) {
+    FontDesc_Add(FONT_SEC_GB2312_MAP, 0, (const uint8_t *)sec + sec->hdr_size,
+                 sec->count, sizeof(uint16_t));
+  }
+}
+
+/**
+ * @brief  按字体族选择字模段：当前字体族优先，其次字体族0，同一字体族取第一段
+ */
+static void FontDesc_Pick(const FontDesc_t **slot, const FontDesc_t *d) {
+  if (*slot == NULL ||
+      (d->family == g_font_family && (*slot)->family != g_font_family)) {
+    *slot = d;
+  }
+}
+
+/**
+ * @brief  附属段(抗锯齿、字宽、外框)只跟随同字号、同字体族的字模段
+ */
+static void FontDesc_Attach(const FontDesc_t **slot, const FontDesc_t *d,
+                            const FontDesc_t *owner) {
+  if (*slot == NULL && owner != NULL && d->family == owner->family) {
+    *slot = d;
+  }
+}
+
+/**
+ * @brief  按当前字体族建立按字号索引的字模段表
+ * @note   先选字模段，再选与其同字体族的附属段；当前字体族为0时与
+ *         FlashFont_GetDesc() 一致，同一字号出现多段时取第一段
+ */
+static void FontDesc_Index(void) {
+  memset(g_glyph_desc, 0, sizeof(g_glyph_desc));
+  memset(g_ascii_desc, 0, sizeof(g_ascii_desc));
+#ifdef FLASH_FONT_AA_ENABLE
+  memset(g_glyph_aa_desc, 0, sizeof(g_glyph_aa_desc));
+  memset(g_ascii_aa_desc, 0, sizeof(g_ascii_aa_desc));
+#endif
+#ifdef FLASH_FONT_METRICS_ENABLE
+  memset(g_ascii_metrics_desc, 0, sizeof(g_ascii_metrics_desc));
+  memset(g_ascii_kern_desc, 0, sizeof(g_ascii_kern_desc));
+#endif
+#ifdef FLASH_FONT_BOX_ENABLE
+  memset(g_glyph_box_desc, 0, sizeof(g_glyph_box_desc));
+#endif
+#ifdef FLASH_FONT_RECORD_ENABLE
+  memset(g_glyph_record_desc, 0, sizeof(g_glyph_record_desc));
+#endif
+
+  for (uint8_t i = 0; i < g_font_desc_count; i++) {
+    const FontDesc_t *d = &g_font_desc[i];
+
+    if (d->font_size == 0 || d->font_size > FLASH_FONT_MAX_SIZE ||
+        (d->family != g_font_family && d->family != 0)) {
+      continue;
+    }
+    if (d->type == FONT_SEC_GLYPH) {
+      FontDesc_Pick(&g_glyph_desc[d->font_size], d);
+    } else if (d->type == FONT_SEC_ASCII) {
+      FontDesc_Pick(&g_ascii_desc[d->font_size], d);
+    }
+  }
+
+  for (uint8_t i = 0; i < g_font_desc_count; i++) {
+    const FontDesc_t *d = &g_font_desc[i];
+
+    if (d->font_size == 0 || d->font_size > FLASH_FONT_MAX_SIZE) {
+      continue;
+    }
+#ifdef FLASH_FONT_AA_ENABLE
+    if (d->type == FONT_SEC_GLYPH_AA) {
+      FontDesc_Attach(&g_glyph_aa_desc[d->font_size], d,
+                      g_glyph_desc[d->font_size]);
+    } else if (d->type == FONT_SEC_ASCII_AA) {
+      FontDesc_Attach(&g_ascii_aa_desc[d->font_size], d,
+                      g_ascii_desc[d->font_size]);
+    }
+#endif
+#ifdef FLASH_FONT_METRICS_ENABLE
+    if (d->type == FONT_SEC_ASCII_METRICS) {
+      FontDesc_Attach(&g_ascii_metrics_desc[d->font_size], d,
+                      g_ascii_desc[d->font_size]);
+    } else if (d->type == FONT_SEC_ASCII_KERN) {
+      FontDesc_Attach(&g_ascii_kern_desc[d->font_size], d,
+                      g_ascii_desc[d->font_size]);
+    }
+#endif
+#ifdef FLASH_FONT_BOX_ENABLE
+    if (d->type == FONT_SEC_GLYPH_BOX) {
+      FontDesc_Attach(&g_glyph_box_desc[d->font_size], d,
+                      g_glyph_desc[d->font_size]);
+    }
+#endif
+#ifdef FLASH_FONT_RECORD_ENABLE
+    if (d->type == FONT_SEC_GLYPH_RECORD) {
+      const FontDesc_t *owner = g_glyph_desc[d->font_size];
+
+      // 字模格式与字模段一致时才能互相替代，压缩/补齐的字模段不使用记录
+      if (owner != NULL && owner->format == FONT_FMT_1BPP_ROW &&
+          owner->width == d->width && owner->stride <= d->stride &&
+          d->count <= owner->count) {
+        FontDesc_Attach(&g_glyph_record_desc[d->font_size], d, owner);
+      }
+    }
+#endif
+  }
+}
+
+/**
+ * @brief  取字号对应的汉字字模段
+ * @retval 段描述指针，不支持该字号返回NULL
+ */
+static inline const FontDesc_t *GlyphDesc(uint8_t font_size) {
+  return (font_size <= FLASH_FONT_MAX_SIZE) ? FontDesc_Use(g_glyph_desc[font_size])
+                                            : NULL;
+}
+
+/**
+ * @brief  取字号对应的汉字字模段，只用于读取格式，不等待校验
+ * @retval 段描述指针，不支持该字号返回NULL
+ */
+static inline const FontDesc_t *GlyphDesc_Meta(uint8_t font_size) {
+  return (font_size <= FLASH_FONT_MAX_SIZE) ? g_glyph_desc[font_size] : NULL;
+}
+
+/**
+ * @brief  取字号对应的ASCII字模段
+ * @retval 段描述指针，不支持该字号返回NULL
+ */
+static inline const FontDesc_t *AsciiDesc(uint8_t font_size) {
+  return (font_size <= FLASH_FONT_MAX_SIZE) ? FontDesc_Use(g_ascii_desc[font_size])
+                                            : NULL;
+}
+
+#ifdef FLASH_FONT_RECORD_ENABLE
+/**
+ * @brief  取包含该字的多字号记录段
+ * @retval 段描述指针，没有记录段、索引不在记录中或记录段尚未校验返回NULL
+ * @note   记录段未校验完时不当场校验，先从各字号字模段读取
+ */
+ITCM_CODE static inline const FontDesc_t *RecordDesc(uint8_t font_size,
+                                                     int16_t index) {
+  const FontDesc_t *r =
+      (font_size <= FLASH_FONT_MAX_SIZE) ? g_glyph_record_desc[font_size] : NULL;
+
+  if (r == NULL || index < 0 || (uint32_t)index >= r->count ||
+      r->trust != FONT_TRUST_OK) {
+    return NULL;
+  }
+  return FontDesc_Use(r);
+}
+#endif
+
+/**
+ * @brief  由字库索引计算字模地址
+ * @param  index: 字库索引, <0表示未找到
+ * @param  font_size: 字体大小
+ * @retval 字模数据指针，失败返回NULL
+ * @note   一次按字号的查表 + 一次乘加，压缩段改为读取块基址和字偏移；
+ *         记录段中的常用字直接取记录内的地址
+ */
+ITCM_CODE static const uint8_t *GetGlyphAddr(int16_t index, uint8_t font_size) {
+#ifdef FLASH_FONT_RECORD_ENABLE
+  const FontDesc_t *r = RecordDesc(font_size, index);
+
+  if (r != NULL) {
+    return r->data + (uint32_t)index * r->stride;
+  }
+#endif
+  return GlyphDesc_Addr(GlyphDesc(font_size), index);
+}
+
+/**
+ * @brief  由字模段和字库索引计算字模地址，活动分区与备用分区共用
+ * @retval 字模数据指针，段不存在或索引越界返回NULL
+ */
+ITCM_CODE static const uint8_t *GlyphDesc_Addr(const FontDesc_t *d, int16_t index) {
+  if (index < 0 || d == NULL || (uint32_t)index >= d->count) {
+    return NULL;
+  }
+
+  if (d->format == FONT_FMT_1BPP_RLE) {
+    const uint32_t *base = (const uint32_t *)d->data;
+    const uint16_t *ofs = (const uint16_t *)(base + FontRle_Blocks(d->count));
+
+    return d->data + base[(uint32_t)index >> FONT_RLE_BLOCK_BITS] + ofs[index];
+  }
+  return d->data + (uint32_t)index * d->stride;
+}
+
+#ifdef FLASH_FONT_RAM_HASH
+/**
+ * @brief  计算码点的哈希槽位(乘法哈希)
+ */
+static inline uint32_t FontHash_Slot(uint32_t cp) {
+  return (uint32_t)(cp * 2654435761U) >> (32 - FLASH_FONT_HASH_BITS);
+}
+
+#ifdef FLASH_FONT_PHASH_ENABLE
+/**
+ * @brief  计算码点在完美哈希中的槽位
+ * @note   与 fontbin_tool.py 的 phash_mix()/phash_bucket() 一致：
+ *         乘法哈希选桶，桶种子与码点拼成32位后做 MurmurHash3 收尾混合
+ */
+static inline uint32_t FontPHash_Slot(uint32_t cp) {
+  const uint16_t *seed = (const uint16_t *)g_font_hash.phash;
+  uint32_t x = ((uint32_t)seed[(uint32_t)(cp * 2654435761U) >> (32 - g_phash_bits)] << 16) | cp;
+
+  x ^= x >> 16;
+  x *= 0x85EBCA6BU;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35U;
+  x ^= x >> 16;
+  return (uint32_t)(((uint64_t)x * g_phash_count) >> 32);
+}
+
+/**
+ * @brief  把数据一次拷贝到哈希表存储区
+ * @note   一次MDMA块传输(不超过64KB)，轮询等待完成；MDMA不可用或出错时由CPU拷贝
+ */
+static void FontHash_Copy(void *dst, const void *src, uint32_t bytes) {
+  if (g_phash_mdma_state == 0) {
+    __HAL_RCC_MDMA_CLK_ENABLE();
+    g_phash_mdma.Instance = FLASH_FONT_PHASH_CHANNEL;
+    g_phash_mdma.Init.Request = MDMA_REQUEST_SW;
+    g_phash_mdma.Init.TransferTriggerMode = MDMA_BLOCK_TRANSFER;
+    g_phash_mdma.Init.Priority = MDMA_PRIORITY_HIGH;
+    g_phash_mdma.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+    g_phash_mdma.Init.SourceInc = MDMA_SRC_INC_WORD;
+    g_phash_mdma.Init.DestinationInc = MDMA_DEST_INC_WORD;
+    g_phash_mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_WORD; // 段起始和长度都是4的倍数
+    g_phash_mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_WORD;
+    g_phash_mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+    g_phash_mdma.Init.BufferTransferLength = 128;
+    g_phash_mdma.Init.SourceBurst = MDMA_SOURCE_BURST_SINGLE;
+    g_phash_mdma.Init.DestBurst = MDMA_DEST_BURST_SINGLE;
+    g_phash_mdma.Init.SourceBlockAddressOffset = 0;
+    g_phash_mdma.Init.DestBlockAddressOffset = 0;
+    g_phash_mdma_state = (HAL_MDMA_Init(&g_phash_mdma) == HAL_OK) ? 1 : 2;
+  }
+  if (g_phash_mdma_state == 1) {
+    SCB_InvalidateDCache_by_Addr((uint32_t *)dst, (int32_t)bytes); // 存储区在AXI SRAM时丢弃旧Cache行
+    if (HAL_MDMA_Start(&g_phash_mdma, (uint32_t)src, (uint32_t)dst, bytes, 1) == HAL_OK) {
+      if (HAL_MDMA_PollForTransfer(&g_phash_mdma, HAL_MDMA_FULL_TRANSFER, 10) == HAL_OK) {
+        return;
+      }
+      (void)HAL_MDMA_Abort(&g_phash_mdma);
+    }
+  }
+  memcpy(dst, src, bytes);
+}
+
+/**
+ * @brief  把字库中的完美哈希段拷贝到哈希表存储区
+ * @retval 1-已拷贝，可以直接查找, 0-没有该段或存储区放不下
+ */
+static uint8_t FontHash_LoadPerfect(void) {
+  const FontDesc_t *d = FlashFont_GetDesc(FONT_SEC_UTF8_PHASH, 0);
+  uint32_t seeds, bytes;
+
+  g_phash_slot = NULL;
+  if (d == NULL) {
+    return 0;
+  }
+  seeds = 1UL << d->width;
+  bytes = seeds * sizeof(uint16_t) + d->count * sizeof(FontHashSlot_t);
+  if (bytes > sizeof(g_font_hash)) {
+    DEBUG_INFO("完美哈希段超出 FLASH_FONT_PHASH_BYTES，由对照表建立哈希表");
+    return 0;
+  }
+  FontHash_Copy(g_font_hash.phash, d->data, bytes);
+  g_phash_bits = d->width;
+  g_phash_count = (uint16_t)d->count;
+  g_phash_slot = (const FontHashSlot_t *)((const uint16_t *)g_font_hash.phash + seeds);
+  return 1;
+}
+#endif /* FLASH_FONT_PHASH_ENABLE */
+
+/**
+ * @brief  清空哈希表，准备从对照表第一项开始建立
+ * @note   字库带完美哈希段时改为整段拷贝，哈希表立即可用
+ */
+static void FontHash_Begin(void) {
+  g_font_hash_ready = 0;
+  g_hash_pos = 0;
+  g_hash_used = 0;
+#ifdef FLASH_FONT_PHASH_ENABLE
+  if (FontHash_LoadPerfect()) {
+    g_hash_pos = g_utf8_count; // 不再逐项插入
+    g_font_hash_ready = 1;
+    return;
+  }
+#endif
+  if (g_utf8_count > HASH_MAX_USED) { // 负载过高时探测链变长，不如直接用Flash中的索引
+    DEBUG_INFO("对照表项数超过哈希表槽数的0.7倍，不建立哈希表");
+    g_hash_pos = g_utf8_count;
+    return;
+  }
+  memset(g_font_hash.slot, 0, sizeof(g_font_hash.slot));
+}
+
+/**
+ * @brief  把对照表中接下来的最多n项插入哈希表
+ * @param  n: 本次处理的项数
+ * @retval 1-已处理完(哈希表可用或已放弃), 0-还有剩余
+ * @note   开放寻址+线性探测，整个对照表(约60KB)只读取一次
+ * @note   槽数不足以容纳全部字符时放弃哈希表，退回Flash查找，保证结果正确
+ */
+static uint8_t FontHash_Step(uint32_t n) {
+  const UTF8_TableEntry_t *pEntry = g_utf8_table;
+  uint32_t end;
+
+  if (pEntry == NULL || g_hash_pos >= g_utf8_count) {
+    return 1;
+  }
+  end = (n < g_utf8_count - g_hash_pos) ? g_hash_pos + n : g_utf8_count;
+
+  for (uint32_t i = g_hash_pos; i < end; i++) {
+    uint8_t len = pEntry[i].utf8_len;
+    uint32_t cp, slot;
+
+    // 跳过生成脚本写入的"??"等无法命中的无效项
+    if (len < 1 || len > 4 || FlashFont_DecodeUTF8(pEntry[i].utf8, &cp) != len) {
+      continue;
+    }
+    if (cp == HASH_EMPTY || cp > 0xFFFF) {
+      continue;
+    }
+
+    slot = FontHash_Slot(cp);
+    while (g_font_hash.slot[slot].code != HASH_EMPTY &&
+           g_font_hash.slot[slot].code != cp) {
+      slot = (slot + 1) & (HASH_SLOTS - 1);
+    }
+    if (g_font_hash.slot[slot].code == HASH_EMPTY) {
+      // 负载率不超过0.7，同时保证查找探测一定能遇到空槽而终止
+      if (++g_hash_used > HASH_MAX_USED) {
+        DEBUG_ERROR("FontHash_Build: 哈希表容量不足");
+        g_hash_pos = g_utf8_count;
+        return 1;
+      }
+      g_font_hash.slot[slot].code = (uint16_t)cp;
+      g_font_hash.slot[slot].index = pEntry[i].index;
+    }
+  }
+
+  g_hash_pos = end;
+  if (end < g_utf8_count) {
+    return 0;
+  }
+  g_font_hash_ready = 1;
+  return 1;
+}
+
+#ifndef FLASH_FONT_LAZY_INIT
+/**
+ * @brief  由Flash中的UTF8对照表一次建立RAM哈希表
+ * @note   FLASH_FONT_LAZY_INIT 时改由 FlashFont_Idle() 分步建立
+ */
+static void FontHash_Build(void) {
+  FontHash_Begin();
+  (void)FontHash_Step(UINT32_MAX);
+}
+#endif
+
+/**
+ * @brief  在RAM哈希表中查找码点
+ * @param  cp: Unicode码点(BMP)
+ * @retval 字库索引, 未找到返回-1
+ */
+ITCM_CODE static int16_t FontHash_Find(uint32_t cp) {
+  uint32_t slot;
+
+#ifdef FLASH_FONT_PHASH_ENABLE
+  if (g_phash_slot != NULL) { // 每个槽恰好一个字，只比较一次
+    const FontHashSlot_t *s = &g_phash_slot[FontPHash_Slot(cp)];
+    return (s->code == cp) ? (int16_t)s->index : -1;
+  }
+#endif
+  slot = FontHash_Slot(cp);
+  while (g_font_hash.slot[slot].code != HASH_EMPTY) {
+    if (g_font_hash.slot[slot].code == cp) {
+      return (int16_t)g_font_hash.slot[slot].index;
+    }
+    slot = (slot + 1) & (HASH_SLOTS - 1);
+  }
+  return -1;
+}
+#endif /* FLASH_FONT_RAM_HASH */
+
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+/**
+ * @brief  计算常驻索引的查找键
+ */
+static inline uint32_t FontResident_Key(uint32_t cp, uint8_t font_size) {
+  return (cp << 8) | font_size;
+}
+
+/**
+ * @brief  在常驻索引中二分查找
+ * @retval 第一个key>=目标键的位置
+ */
+ITCM_CODE static uint16_t FontResident_LowerBound(uint32_t key) {
+  uint16_t lo = 0, hi = g_res_count;
+
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) >> 1;
+    if (g_res_index[mid].key < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+#endif /* FLASH_FONT_RESIDENT_ENABLE */
+
+/**
+ * @brief  按段描述取出对照表、排序索引、区位映射和分块索引的地址
+ * @note   初始化和字库镜像切换到SDRAM之后调用
+ */
+static void FontTables_Load(void) {
+  const FontDesc_t *d;
+
+  d = FlashFont_GetDesc(FONT_SEC_GB2312_TABLE, 0);
+  g_gb2312_table = (d != NULL) ? (const GB2312_TableEntry_t *)d->data : NULL;
+  g_gb2312_count = (d != NULL) ? d->count : 0;
+
+  d = FlashFont_GetDesc(FONT_SEC_UTF8_TABLE, 0);
+  g_utf8_table = (d != NULL) ? (const UTF8_TableEntry_t *)d->data : NULL;
+  g_utf8_count = (d != NULL) ? d->count : 0;
+
+  d = FlashFont_GetDesc(FONT_SEC_UTF8_SORTED, 0);
+  if (d != NULL && d->count > 0 && d->count <= 0xFFFF) {
+    g_utf8_sorted = (const UTF8_SortedEntry_t *)d->data;
+    g_utf8_sorted_count = (uint16_t)d->count;
+  } else {
+    g_utf8_sorted = NULL;
+    g_utf8_sorted_count = 0;
+    DEBUG_INFO("未找到UTF8排序索引，使用线性查找");
+  }
+
+  d = FlashFont_GetDesc(FONT_SEC_UTF8_PACKED, 0);
+  if (d != NULL && d->count > 0 && d->count <= 0xFFFF) {
+    g_utf8_packed = (const uint32_t *)d->data;
+    g_utf8_packed_count = (uint16_t)d->count;
+    g_utf8_packed_bits = d->width;
+  } else {
+    g_utf8_packed = NULL;
+    g_utf8_packed_count = 0;
+  }
+
+  d = FlashFont_GetDesc(FONT_SEC_GB2312_MAP, 0);
+  if (d != NULL && d->count == GB2312_MAP_DIM * GB2312_MAP_DIM) {
+    g_gb2312_map = (const uint16_t *)d->data;
+  } else {
+    g_gb2312_map = NULL;
+    DEBUG_INFO("未找到GB2312区位映射表，使用线性查找");
+  }
+#ifdef FLASH_FONT_GB2312_ROWS
+  GbRows_Build();
+#endif
+#ifdef FLASH_FONT_GBK_TEXT
+  d = FlashFont_GetDesc(FONT_SEC_INDEX_CODES, 0);
+  if (d != NULL && d->count > 0 && d->count <= 0x8000) {
+    g_index_codes = (const FontIndexCode_t *)d->data;
+    g_index_codes_count = (uint16_t)d->count;
+  } else {
+    g_index_codes = NULL;
+    g_index_codes_count = 0;
+  }
+#endif
+
+  d = FlashFont_GetDesc(FONT_SEC_UNICODE_BLOCKS, 0);
+  g_ublock_page = NULL;
+  if (d != NULL && d->stride == sizeof(uint16_t) && d->count > FONT_BLOCK_PAGES &&
+      d->count % FONT_BLOCK_PAGES == 0 &&
+      d->count / FONT_BLOCK_PAGES <= FONT_BLOCK_PAGES + 1) {
+    UBlock_Load((const uint16_t *)d->data, d->count / FONT_BLOCK_PAGES - 1);
+  }
+}
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  初始化Flash字库驱动
+ * @retval 0-成功, <0-失败
+ * @note   前提：QSPI已开启内存映射模式，字库已预烧录
+ */
+int8_t FlashFont_Init(void) {
+  const FontTocHeader_t *toc;
+  uint32_t seq_a, seq_b;
+  uint8_t ok_a, ok_b;
+
+#ifdef GLYPH_CACHE_ENABLE
+  GlyphCache_Clear(); // 字库可能已更新，旧缓存作废
+#endif
+  g_font_epoch = QSPI_W25Qxx_UpdateEpoch(); // 之前的改写已包含在重新解析中
+  g_font_initialized = 0;
+#ifdef FLASH_FONT_MIRROR_ENABLE
+  FontMirror_Stop(); // 段描述将重新生成，镜像随新分区重新拷贝
+#endif
+  g_font_desc_count = 0;
+  g_font_family = 0; // 常驻子集和备用分区按字体族0建立
+  g_font_idle_stage = FONT_IDLE_DONE; // 分步建立的索引随分区重新开始
+#ifdef FLASH_FONT_CRC_ENABLE
+  g_crc_desc = NULL; // 新分区的段重新校验
+  g_crc_pos = 0;
+#endif
+#ifdef FLASH_FONT_RAM_HASH
+  g_font_hash_ready = 0;
+#endif
+  g_run_index_valid = 0; // 预解析文本串的校验随分区重新计算
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+  memset(g_font_miss, 0, sizeof(g_font_miss)); // 新分区可能已补上缺字
+#endif
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+  g_fb_glyph_count = 0;
+#endif
+#ifdef FLASH_FONT_TOFU_ENABLE
+  g_tofu_size = 0; // 字模格式可能变化
+#endif
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+  g_res_count = 0; // 旧分区的常驻字模作废
+#endif
+  FontDesc_Index(); // 失败返回时不保留旧分区的描述
+
+  // 通过内存映射读取两个分区的标志位和分区头，选择序号最新的有效分区
+  ok_a = FontBank_Probe(FONT_BANK_A_ADDR, &seq_a);
+  ok_b = FontBank_Probe(FONT_BANK_B_ADDR, &seq_b);
+  if (!ok_a && !ok_b) {
+    DEBUG_ERROR("字库标志无效，字库可能未烧录");
+    return -1;
+  }
+  if (ok_b && (!ok_a || (int32_t)(seq_b - seq_a) > 0)) {
+    g_font_bank = FONT_BANK_B_ADDR;
+    g_font_seq = seq_b;
+  } else {
+    g_font_bank = FONT_BANK_A_ADDR;
+    g_font_seq = seq_a;
+  }
+
+  // 目录或旧版文件头只在此解析一次，之后全部查找都走RAM段描述表
+  toc = FontToc_Get(g_font_bank);
+  g_font_legacy = (toc == NULL);
+  if (toc != NULL) {
+    FontDesc_LoadToc(toc);
+  } else {
+    DEBUG_INFO("未找到字库目录，按旧版固定布局解析");
+    FontDesc_LoadLegacy();
+  }
+  FontDesc_Index();
+
+  FontTables_Load();
+
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+  FontFallback_Load();
+#endif
+
+  g_font_initialized = 1;
+#ifdef FLASH_FONT_MIRROR_ENABLE
+  FontMirror_Start(toc);
+#endif
+
+#ifdef FLASH_FONT_LAZY_INIT
+#ifdef FLASH_FONT_RAM_HASH
+  FontHash_Begin();
+#endif
+  g_font_idle_stage = FONT_IDLE_HASH; // 其余索引由 FlashFont_Idle() 建立
+#else
+#ifdef FLASH_FONT_RAM_HASH
+  FontHash_Build();
+#endif
+  FontIdle_Resident();
+#endif
+
+  return FLASHFONT_OK;
+}
+
+/**
+ * @brief  按保存的列表重建常驻字模子集
+ */
+static void FontIdle_Resident(void) {
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+  if (FlashFont_ResidentLoad(g_res_chars) > 0) {
+    DEBUG_INFO("常驻字模超出预算，其余字符从QSPI读取");
+  }
+#endif
+}
+
+/**
+ * @brief  在主循环空闲时分步建立RAM索引
+ * @retval 1-还有未完成的工作, 0-全部建完(或未定义FLASH_FONT_LAZY_INIT)
+ * @note   每次最多处理 FLASH_FONT_IDLE_ENTRIES 项对照表；哈希表未建完时
+ *         查找使用Flash中的索引，常驻子集在哈希表之后一次拷贝
+ * @note   字库镜像拷贝完成后，在这里把段描述切换到SDRAM
+ */
+uint8_t FlashFont_Idle(void) {
+  if (g_bank_hold) {
+    return 0; // 分区安装期间QSPI被异步擦写占用，后台任务暂停
+  }
+  FontEpoch_Check();
+#ifdef FLASH_FONT_MIRROR_ENABLE
+  if (g_mirror_state == FONT_MIRROR_COPIED) {
+    FontMirror_Switch(); // 在主循环中切换，查找不会看到一半新一半旧的描述
+  }
+#endif
+#ifdef FLASH_FONT_LAZY_INIT
+  if (g_font_idle_stage != FONT_IDLE_DONE) {
+    FontPower_Use();
+  }
+  switch (g_font_idle_stage) {
+  case FONT_IDLE_HASH:
+#ifdef FLASH_FONT_RAM_HASH
+    if (!FontHash_Step(FLASH_FONT_IDLE_ENTRIES)) {
+      return 1;
+    }
+#endif
+    g_font_idle_stage = FONT_IDLE_RESIDENT;
+    return 1;
+  case FONT_IDLE_RESIDENT:
+    FontIdle_Resident();
+    g_font_idle_stage = FONT_IDLE_DONE;
+    return 1;
+  default:
+    break;
+  }
+#endif
+#ifdef FLASH_FONT_CRC_ENABLE
+  return FontCrc_Step(FLASH_FONT_CRC_CHUNK);
+#else
+  return 0;
+#endif
+}
+
+/*******************************************************************************
+ *                          Flash改写后的缓存同步
+ ******************************************************************************/
+
+/**
+ * @brief  判断两个Flash地址区间[a0, a1)与[b0, b1)是否重叠
+ */
+static inline uint8_t FontRange_Overlap(uint32_t a0, uint32_t a1, uint32_t b0,
+                                        uint32_t b1) {
+  return a0 < b1 && b0 < a1;
+}
+
+/**
+ * @brief  按Flash改写记录作废受影响的RAM索引和缓存
+ * @note   字模缓存只作废源地址落在改写范围内的项；对照表/排序索引等被改写时
+ *         重建哈希表并清空缺字缓存；字模段被改写时重建常驻子集并重新校验该段；
+ *         活动分区的目录(或旧版文件头)被改写时重新初始化
+ * @note   改写记录已被覆盖时按整片改写处理
+ */
+static void FontEpoch_Sync(void) {
+  QSPI_W25Qxx_Range_t r[W25Qxx_UPDATE_LOG_LEN];
+  const FontTocHeader_t *toc = NULL;
+  uint8_t n = QSPI_W25Qxx_UpdateRanges(&g_font_epoch, r);
+  uint8_t index = 0, glyph = 0;
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+  uint32_t fb_bank = (g_font_bank == FONT_BANK_A_ADDR) ? FONT_BANK_B_ADDR
+                                                       : FONT_BANK_A_ADDR;
+  uint8_t fallback = 0;
+#endif
+
+  if (!g_font_initialized || n == 0) {
+    return;
+  }
+  if (n == W25Qxx_UPDATE_OVERFLOW) {
+    n = 1;
+    r[0].addr = 0;
+    r[0].size = W25Qxx_FlashSize;
+  }
+  FontPower_Use(); // 以下要读取目录
+
+  for (uint8_t i = 0; i < n; i++) {
+    uint32_t start = r[i].addr, end = r[i].addr + r[i].size;
+
+#ifdef GLYPH_CACHE_ENABLE
+    (void)GlyphCache_Invalidate((const uint8_t *)(W25Qxx_Mem_Addr + start),
+                                r[i].size);
+#endif
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+    if (g_fb_glyph_count > 0 &&
+        FontRange_Overlap(start, end, fb_bank, fb_bank + FONT_BANK_SIZE)) {
+      fallback = 1;
+    }
+#endif
+    if (!FontRange_Overlap(start, end, g_font_bank,
+                           g_font_bank + FONT_BANK_SIZE)) {
+      continue;
+    }
+#ifdef FLASH_FONT_MIRROR_ENABLE
+    if (g_mirror_state != FONT_MIRROR_OFF) {
+      DEBUG_INFO("FlashFont: 活动分区被改写，重新初始化并重新镜像");
+      (void)FlashFont_Init();
+      return;
+    }
+#endif
+    if (g_font_legacy ||
+        FontRange_Overlap(start, end, g_font_bank + FONT_TOC_ADDR,
+                          g_font_bank + FONT_TOC_ADDR + W25Qxx_SectorSize) ||
+        (toc == NULL && (toc = FontToc_Get(g_font_bank)) == NULL)) {
+      DEBUG_INFO("FlashFont: 活动分区目录被改写，重新初始化");
+      (void)FlashFont_Init();
+      return;
+    }
+    for (uint8_t k = 0; k < g_font_desc_count; k++) {
+      FontDesc_t *d = &g_font_desc[k];
+      const FontTocEntry_t *e;
+      uint32_t ofs;
+
+      if (d->toc >= toc->count) {
+        continue;
+      }
+      e = FontToc_Entry(toc, d->toc);
+      ofs = g_font_bank + e->offset;
+      if (!FontRange_Overlap(start, end, ofs, ofs + e->size)) {
+        continue;
+      }
+      if (d->type == FONT_SEC_GB2312_TABLE || d->type == FONT_SEC_UTF8_TABLE ||
+          d->type == FONT_SEC_UTF8_SORTED || d->type == FONT_SEC_GB2312_MAP ||
+          d->type == FONT_SEC_UNICODE_BLOCKS || d->type == FONT_SEC_UTF8_PACKED ||
+          d->type == FONT_SEC_INDEX_CODES || d->type == FONT_SEC_UTF8_PHASH) {
+        index = 1;
+      } else if (d->type == FONT_SEC_GLYPH || d->type == FONT_SEC_ASCII) {
+        glyph = 1;
+      }
+#ifdef FLASH_FONT_CRC_ENABLE
+      d->trust = FontToc_Trust(toc, e); // 按新内容重新校验
+      if (g_crc_desc == d) {
+        g_crc_desc = NULL;
+        g_crc_pos = 0;
+      }
+#endif
+    }
+  }
+
+  if (index) {
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+    memset(g_font_miss, 0, sizeof(g_font_miss)); // 新索引可能已补上缺字
+#endif
+    g_run_index_valid = 0;
+    glyph = 1; // 常驻子集按索引选字
+#ifdef FLASH_FONT_GB2312_ROWS
+    GbRows_Build();
+#endif
+#ifdef FLASH_FONT_LAZY_INIT
+#ifdef FLASH_FONT_RAM_HASH
+    FontHash_Begin(); // 建完之前查找走Flash中的索引
+#endif
+    g_font_idle_stage = FONT_IDLE_HASH;
+#elif defined(FLASH_FONT_RAM_HASH)
+    FontHash_Build();
+#endif
+  }
+  if (glyph) {
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+    g_res_count = 0; // 立即停用旧的常驻字模
+#endif
+#ifdef FLASH_FONT_LAZY_INIT
+    if (g_font_idle_stage == FONT_IDLE_DONE) {
+      g_font_idle_stage = FONT_IDLE_RESIDENT;
+    }
+#else
+    FontIdle_Resident();
+#endif
+  }
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+  if (fallback) {
+    FontFallback_Load();
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+    memset(g_font_miss, 0, sizeof(g_font_miss)); // 缺字标记中含备用分区的结果
+#endif
+  }
+#endif
+}
+
+#ifdef FLASH_FONT_MIRROR_ENABLE
+/*******************************************************************************
+ *                          SDRAM字库镜像
+ ******************************************************************************/
+
+#ifndef SDRAM_ENABLE
+#error "FLASH_FONT_MIRROR_ENABLE 需要先在 init.h 中定义 SDRAM_ENABLE"
+#endif
+
+/**
+ * @brief  启动当前数据段的下一次传输
+ */
+static void FontMirror_Next(void) {
+  const FontMirrorItem_t *it = &g_mirror_item[g_mirror_cur];
+  uint32_t left = it->size - g_mirror_pos;
+
+  g_mirror_len = (left < FLASH_FONT_MIRROR_CHUNK) ? left : FLASH_FONT_MIRROR_CHUNK;
+  if (HAL_MDMA_Start_IT(&g_mirror_mdma,
+                        W25Qxx_Mem_Addr + g_mirror_bank + it->ofs + g_mirror_pos,
+                        FLASH_FONT_MIRROR_ADDR + it->dst + g_mirror_pos,
+                        g_mirror_len, 1) != HAL_OK) {
+    g_mirror_state = FONT_MIRROR_OFF;
+  }
+}
+
+/**
+ * @brief  MDMA传输完成回调，接着拷贝下一块
+ */
+static void FontMirror_XferCplt(MDMA_HandleTypeDef *hmdma) {
+  (void)hmdma;
+  if (g_mirror_state != FONT_MIRROR_COPY) {
+    return;
+  }
+  g_mirror_pos += g_mirror_len;
+  if (g_mirror_pos >= g_mirror_item[g_mirror_cur].size) {
+    g_mirror_pos = 0;
+    if (++g_mirror_cur >= g_mirror_count) {
+      g_mirror_state = FONT_MIRROR_COPIED;
+      return;
+    }
+  }
+  FontMirror_Next();
+}
+
+/**
+ * @brief  MDMA传输出错回调，放弃镜像，查找继续读Flash
+ */
+static void FontMirror_XferError(MDMA_HandleTypeDef *hmdma) {
+  (void)hmdma;
+  g_mirror_state = FONT_MIRROR_OFF;
+}
+
+/**
+ * @brief  配置MDMA通道(软件请求，每个块按字搬运)
+ * @retval HAL_OK - 成功
+ */
+static HAL_StatusTypeDef FontMirror_InitChannel(void) {
+  if (!g_mirror_ready) {
+    __HAL_RCC_MDMA_CLK_ENABLE();
+    HAL_NVIC_SetPriority(MDMA_IRQn, GLYPH_PREFETCH_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(MDMA_IRQn);
+  }
+
+  g_mirror_mdma.Instance = FLASH_FONT_MIRROR_CHANNEL;
+  g_mirror_mdma.Init.Request = MDMA_REQUEST_SW;
+  g_mirror_mdma.Init.TransferTriggerMode = MDMA_BLOCK_TRANSFER;
+  g_mirror_mdma.Init.Priority = MDMA_PRIORITY_LOW; // 让出总线给预取和屏幕传输
+  g_mirror_mdma.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+  g_mirror_mdma.Init.SourceInc = MDMA_SRC_INC_WORD;
+  g_mirror_mdma.Init.DestinationInc = MDMA_DEST_INC_WORD;
+  g_mirror_mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_WORD; // 数据段按4字节对齐扩展
+  g_mirror_mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_WORD;
+  g_mirror_mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+  g_mirror_mdma.Init.BufferTransferLength = 128;
+  g_mirror_mdma.Init.SourceBurst = MDMA_SOURCE_BURST_SINGLE;
+  g_mirror_mdma.Init.DestBurst = MDMA_DEST_BURST_SINGLE;
+  g_mirror_mdma.Init.SourceBlockAddressOffset = 0;
+  g_mirror_mdma.Init.DestBlockAddressOffset = 0;
+  if (HAL_MDMA_Init(&g_mirror_mdma) != HAL_OK) {
+    return HAL_ERROR;
+  }
+
+  HAL_MDMA_RegisterCallback(&g_mirror_mdma, HAL_MDMA_XFER_CPLT_CB_ID,
+                            FontMirror_XferCplt);
+  HAL_MDMA_RegisterCallback(&g_mirror_mdma, HAL_MDMA_XFER_ERROR_CB_ID,
+                            FontMirror_XferError);
+  g_mirror_ready = 1;
+  return HAL_OK;
+}
+
+/**
+ * @brief  登记一段要镜像的数据，起止扩展到4字节边界
+ * @retval 1-已登记, 0-镜像区放不下
+ */
+static uint8_t FontMirror_Add(uint32_t ofs, uint32_t size, uint32_t *used) {
+  uint32_t begin = ofs & ~3UL;
+  uint32_t bytes = ((ofs + size + 3) & ~3UL) - begin;
+
+  for (uint8_t i = 0; i < g_mirror_count; i++) {
+    if (g_mirror_item[i].ofs == begin) {
+      return 1; // 同一目录项的多个描述(如字体族)只拷贝一次
+    }
+  }
+  if (g_mirror_count >= FLASH_FONT_MAX_SECTIONS ||
+      *used + bytes > FLASH_FONT_MIRROR_BYTES) {
+    return 0;
+  }
+  g_mirror_item[g_mirror_count].ofs = begin;
+  g_mirror_item[g_mirror_count].size = bytes;
+  g_mirror_item[g_mirror_count].dst = *used;
+  g_mirror_count++;
+  *used += bytes;
+  return 1;
+}
+
+/**
+ * @brief  按目录列出要镜像的数据段
+ * @param  toc 活动分区的目录，NULL为旧版固定布局
+ * @note   整分区镜像时拷贝从分区起点到最后一段末尾的连续数据；
+ *         定义了 FLASH_FONT_MIRROR_SIZES 时只拷贝这些字号的段(旧版布局不支持)
+ */
+static void FontMirror_Plan(const FontTocHeader_t *toc) {
+  uint32_t used = 0;
+
+  g_mirror_count = 0;
+#ifdef FLASH_FONT_MIRROR_SIZES
+  if (toc != NULL) {
+    static const uint8_t sizes[] = FLASH_FONT_MIRROR_SIZES;
+
+    for (uint8_t k = 0; k < g_font_desc_count; k++) {
+      const FontDesc_t *d = &g_font_desc[k];
+      const FontTocEntry_t *e;
+
+      if (d->font_size == 0 || d->toc >= toc->count ||
+          memchr(sizes, d->font_size, sizeof(sizes)) == NULL) {
+        continue;
+      }
+      e = FontToc_Entry(toc, d->toc);
+      if (!FontMirror_Add(e->offset, e->size, &used)) {
+        DEBUG_INFO("FlashFont: 镜像区已满，其余字号的段继续读Flash");
+        break;
+      }
+    }
+    return;
+  }
+#endif
+  uint32_t end = FONT_TOC_ADDR; // 旧版布局的数据都在目录位置之前
+
+  if (toc != NULL) {
+    end = 0;
+    for (uint16_t i = 0; i < toc->count; i++) {
+      const FontTocEntry_t *e = FontToc_Entry(toc, i);
+
+      if (e->offset + e->size > end && e->offset + e->size <= FONT_BANK_HDR_OFS) {
+        end = e->offset + e->size;
+      }
+    }
+  }
+  if (end > 0 && !FontMirror_Add(0, end, &used)) {
+    DEBUG_INFO("FlashFont: 分区大于镜像区，不镜像");
+  }
+}
+
+/**
+ * @brief  停止正在进行的镜像，段描述保持(或已由调用者改回)Flash地址
+ */
+static void FontMirror_Stop(void) {
+  if (g_mirror_state == FONT_MIRROR_COPY) {
+    g_mirror_state = FONT_MIRROR_OFF; // 先改状态，中止时的回调不再接续
+    (void)HAL_MDMA_Abort(&g_mirror_mdma);
+  }
+  g_mirror_state = FONT_MIRROR_OFF;
+}
+
+/**
+ * @brief  FlashFont_Init() 成功后开始后台拷贝活动分区
+ */
+static void FontMirror_Start(const FontTocHeader_t *toc) {
+  FontMirror_Plan(toc);
+  if (g_mirror_count == 0 || FontMirror_InitChannel() != HAL_OK) {
+    return;
+  }
+  g_mirror_bank = g_font_bank;
+  g_mirror_cur = 0;
+  g_mirror_pos = 0;
+  g_mirror_state = FONT_MIRROR_COPY;
+  FontMirror_Next();
+}
+
+/**
+ * @brief  拷贝完成后把落在镜像段内的段描述和表地址改到SDRAM
+ */
+static void FontMirror_Switch(void) {
+  const uint8_t *bank = FontPtr(0);
+
+  SCB_InvalidateDCache_by_Addr((uint32_t *)FLASH_FONT_MIRROR_ADDR,
+                               (int32_t)(g_mirror_item[g_mirror_count - 1].dst +
+                                         g_mirror_item[g_mirror_count - 1].size));
+  for (uint8_t k = 0; k < g_font_desc_count; k++) {
+    FontDesc_t *d = &g_font_desc[k];
+    uint32_t ofs = (uint32_t)(d->data - bank);
+
+    for (uint8_t i = 0; i < g_mirror_count; i++) {
+      const FontMirrorItem_t *it = &g_mirror_item[i];
+
+      if (ofs >= it->ofs && ofs < it->ofs + it->size) {
+        d->data = (const uint8_t *)(FLASH_FONT_MIRROR_ADDR + it->dst + (ofs - it->ofs));
+        break;
+      }
+    }
+  }
+  FontTables_Load();
+  g_mirror_state = FONT_MIRROR_ON;
+  DEBUG_INFO("FlashFont: 字库查找已切换到SDRAM镜像");
+}
+
+/**
+ * @brief  把镜像区地址换算回Flash映射地址，其余地址原样返回
+ * @note   校验读取目录项、预解析文本串的校验按Flash中的位置计算
+ */
+static const uint8_t *FontMirror_Flash(const uint8_t *p) {
+  if (g_mirror_state == FONT_MIRROR_ON && FONT_MIRROR_HOLDS(p)) {
+    uint32_t q = (uint32_t)p - FLASH_FONT_MIRROR_ADDR;
+
+    for (uint8_t i = 0; i < g_mirror_count; i++) {
+      const FontMirrorItem_t *it = &g_mirror_item[i];
+
+      if (q >= it->dst && q < it->dst + it->size) {
+        return (const uint8_t *)(W25Qxx_Mem_Addr + g_mirror_bank + it->ofs + (q - it->dst));
+      }
+    }
+  }
+  return p;
+}
+
+/**
+ * @brief  字库查找是否已改读SDRAM镜像
+ * @retval 1-已切换, 0-拷贝中、未镜像或镜像失败
+ */
+uint8_t FlashFont_MirrorActive(void) { return g_mirror_state == FONT_MIRROR_ON; }
+
+/**
+ * @brief  MDMA中断处理，在MDMA_IRQHandler中调用
+ */
+void FlashFont_MirrorIRQHandler(void) {
+  if (g_mirror_ready) {
+    HAL_MDMA_IRQHandler(&g_mirror_mdma);
+  }
+}
+#endif /* FLASH_FONT_MIRROR_ENABLE */
+
+#ifdef FLASH_FONT_POWER_DOWN
+/*******************************************************************************
+ *                          深度掉电
+ ******************************************************************************/
+
+/**
+ * @brief  记录一次字库访问，Flash掉电时唤醒并重新映射
+ * @note   唤醒耗时约为tRES1加几条QSPI命令，由本次查找承担
+ */
+static void FontPower_Wake(void) {
+  if (g_pd_state == FONT_PD_ASLEEP) {
+    uint32_t start = DWT->CYCCNT;
+    uint32_t cycles;
+
+    if (QSPI_W25Qxx_WakeUp() != QSPI_W25Qxx_OK) {
+      DEBUG_ERROR("FlashFont: QSPI Flash唤醒失败");
+      QSPI_W25Qxx_MemoryMappedMode(); // 复位器件后完整重新映射
+    }
+    cycles = DWT->CYCCNT - start;
+    g_pd_stats.wakes++;
+    g_pd_stats.last_cycles = cycles;
+    if (cycles > g_pd_stats.max_cycles) {
+      g_pd_stats.max_cycles = cycles;
+    }
+  }
+  g_pd_state = FONT_PD_USED;
+}
+
+/**
+ * @brief  主循环空闲时检查是否让Flash进入深度掉电
+ * @retval 1-Flash处于深度掉电, 0-Flash处于映射模式
+ */
+uint8_t FlashFont_PowerIdle(void) {
+  uint32_t now = HAL_GetTick();
+
+  if (!g_font_initialized) {
+    return 0;
+  }
+  if (g_pd_state == FONT_PD_USED) {
+    g_pd_state = FONT_PD_IDLE;
+    g_pd_tick = now;
+    return 0;
+  }
+  if (g_pd_state == FONT_PD_ASLEEP) {
+    return 1;
+  }
+  if (g_bank_hold) { // 分区安装期间QSPI不在映射模式，由安装程序管理
+    g_pd_tick = now;
+    return 0;
+  }
+  if (now - g_pd_tick < FLASH_FONT_PD_IDLE_MS ||
+      QSPI_W25Qxx_DMA_Busy() || QSPI_W25Qxx_Write_Busy()) {
+    return 0;
+  }
+#ifdef FLASH_FONT_MIRROR_ENABLE
+  if (g_mirror_state == FONT_MIRROR_COPY) { // 镜像拷贝的MDMA正在读取映射区
+    return 0;
+  }
+#endif
+#if defined(GLYPH_CACHE_ENABLE) && defined(GLYPH_PREFETCH_ENABLE)
+  // 预取MDMA正在读取映射区，此时退出映射会产生总线错误
+  if (GlyphPrefetch_Busy()) {
+    return 0;
+  }
+#endif
+  if (QSPI_W25Qxx_PowerDown() != QSPI_W25Qxx_OK) {
+    g_pd_tick = now; // 稍后重试
+    return 0;
+  }
+  g_pd_state = FONT_PD_ASLEEP;
+  g_pd_stats.sleeps++;
+  return 1;
+}
+
+/**
+ * @brief  读取深度掉电统计
+ */
+void FlashFont_PowerGetStats(FontPowerStats_t *stats) {
+  if (stats != NULL) {
+    *stats = g_pd_stats;
+  }
+}
+#endif
+
+/*******************************************************************************
+ *                          段校验(CRC32)
+ ******************************************************************************/
+
+/**
+ * @brief  初始化CRC单元，与zlib.crc32相同(多项式0x04C11DB7，初值全1，输入按字节、输出反转)
+ * @retval 1-可用, 0-初始化失败
+ * @note   HAL按字节输入时把4个字节高位在前拼成一个字写入，先算低地址的字节
+ */
+static uint8_t FontCrc_HwInit(void) {
+  if (g_crc_ready == 0) {
+    __HAL_RCC_CRC_CLK_ENABLE();
+    g_font_crc.Instance = CRC;
+    g_font_crc.Init.DefaultPolynomialUse = DEFAULT_POLYNOMIAL_ENABLE;
+    g_font_crc.Init.DefaultInitValueUse = DEFAULT_INIT_VALUE_ENABLE;
+    g_font_crc.Init.InputDataInversionMode = CRC_INPUTDATA_INVERSION_BYTE;
+    g_font_crc.Init.OutputDataInversionMode = CRC_OUTPUTDATA_INVERSION_ENABLE;
+    g_font_crc.InputDataFormat = CRC_INPUTDATA_FORMAT_BYTES;
+    g_crc_ready = (HAL_CRC_Init(&g_font_crc) == HAL_OK) ? 1 : 2;
+    if (g_crc_ready != 1) {
+      DEBUG_ERROR("FontCrc_HwInit: CRC单元初始化失败，字库段不做校验");
+    }
+  }
+  return g_crc_ready == 1;
+}
+
+/**
+ * @brief  用硬件CRC单元计算一段数据的CRC32
+ * @param  data: 数据
+ * @param  len: 字节数
+ * @retval 与zlib.crc32(data)相同的结果，CRC单元不可用时返回0
+ * @note   后台正在校验的段下次从头开始(CRC单元只有一份中间值)
+ */
+uint32_t FlashFont_Crc32(const void *data, uint32_t len) {
+  if (!FontCrc_HwInit()) {
+    return 0;
+  }
+#ifdef FLASH_FONT_CRC_ENABLE
+  g_crc_pos = 0;
+#endif
+  return HAL_CRC_Calculate(&g_font_crc, (uint32_t *)data, len) ^ 0xFFFFFFFFU;
+}
+
+#ifdef FLASH_FONT_CRC_ENABLE
+/**
+ * @brief  取段描述对应的目录项
+ * @retval 目录项指针，分区目录已失效或序号越界返回NULL
+ * @note   由数据地址判断所在分区，备用分区的段同样适用
+ */
+static const FontTocEntry_t *FontCrc_Entry(const FontDesc_t *d) {
+#ifdef FLASH_FONT_MIRROR_ENABLE
+  uint32_t ofs = (uint32_t)FontMirror_Flash(d->data) - W25Qxx_Mem_Addr;
+#else
+  uint32_t ofs = (uint32_t)d->data - W25Qxx_Mem_Addr;
+#endif
+  uint32_t bank = (ofs >= FONT_BANK_A_ADDR) ? FONT_BANK_A_ADDR : FONT_BANK_B_ADDR;
+  const FontTocHeader_t *toc = FontToc_Get(bank);
+
+  if (toc == NULL || d->toc >= toc->count ||
+      toc->entry_size < sizeof(FontTocEntry_t)) {
+    return NULL;
+  }
+  return FontToc_Entry(toc, d->toc);
+}
+
+/**
+ * @brief  继续校验 g_crc_desc，最多n字节
+ * @retval 1-该段已有结论(g_crc_desc 清空), 0-还有剩余
+ */
+static uint8_t FontCrc_Feed(uint32_t n) {
+  FontDesc_t *d = (FontDesc_t *)g_crc_desc;
+  const FontTocEntry_t *e = FontCrc_Entry(d);
+  uint32_t *p;
+
+  if (e == NULL) {
+    d->trust = FONT_TRUST_BAD;
+  } else {
+    if (n > e->size - g_crc_pos) {
+      n = e->size - g_crc_pos;
+    }
+    p = (uint32_t *)(d->data + g_crc_pos);
+    g_crc_value = (g_crc_pos == 0) ? HAL_CRC_Calculate(&g_font_crc, p, n)
+                                   : HAL_CRC_Accumulate(&g_font_crc, p, n);
+    g_crc_pos += n;
+    if (g_crc_pos < e->size) {
+      return 0;
+    }
+    d->trust = ((g_crc_value ^ 0xFFFFFFFFU) == e->crc) ? FONT_TRUST_OK
+                                                       : FONT_TRUST_BAD;
+  }
+  if (d->trust == FONT_TRUST_BAD) {
+    DEBUG_ERROR("字库段CRC校验失败，该段不再使用");
+  }
+  g_crc_desc = NULL;
+  g_crc_pos = 0;
+  return 1;
+}
+
+/**
+ * @brief  第一次使用前校验完整个段
+ * @retval 校验通过返回d，失败返回NULL
+ * @note   后台正在校验另一段时，那一段下次从头开始(CRC单元只有一份中间值)
+ */
+static const FontDesc_t *FontCrc_Require(const FontDesc_t *d) {
+  FontDesc_t *w = (FontDesc_t *)d;
+
+  if (w->trust == FONT_TRUST_PENDING) {
+    if (!FontCrc_HwInit()) {
+      w->trust = FONT_TRUST_OK; // 无法校验时与只检查字库标志相同
+    } else {
+      if (g_crc_desc != d) {
+        g_crc_desc = d;
+        g_crc_pos = 0;
+      }
+      (void)FontCrc_Feed(UINT32_MAX);
+    }
+  }
+  return (w->trust == FONT_TRUST_OK) ? d : NULL;
+}
+
+/**
+ * @brief  取下一个待校验的段(活动分区在前，备用分区在后)
+ * @retval 段描述指针，全部校验完返回NULL
+ */
+static const FontDesc_t *FontCrc_Next(void) {
+  for (uint8_t i = 0; i < g_font_desc_count; i++) {
+    if (g_font_desc[i].trust == FONT_TRUST_PENDING) {
+      return &g_font_desc[i];
+    }
+  }
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+  for (uint8_t i = 0; i < g_fb_glyph_count; i++) {
+    if (g_fb_glyph[i].trust == FONT_TRUST_PENDING) {
+      return &g_fb_glyph[i];
+    }
+  }
+  if (g_fb_glyph_count > 0 && g_fb_index.trust == FONT_TRUST_PENDING) {
+    return &g_fb_index;
+  }
+#endif
+  return NULL;
+}
+
+/**
+ * @brief  后台校验最多n字节
+ * @retval 1-还有待校验的段, 0-全部校验完
+ */
+static uint8_t FontCrc_Step(uint32_t n) {
+  if (!g_font_initialized) {
+    return 0;
+  }
+  if (g_crc_desc == NULL && (g_crc_desc = FontCrc_Next()) == NULL) {
+    return 0;
+  }
+  FontPower_Use();
+  if (!FontCrc_HwInit()) {
+    ((FontDesc_t *)g_crc_desc)->trust = FONT_TRUST_OK;
+    g_crc_desc = NULL;
+    return 1;
+  }
+  (void)FontCrc_Feed(n);
+  return 1;
+}
+
+/**
+ * @brief  统计一个段的校验状态
+ */
+static void FontCrc_Count(FontCrcStats_t *stats, const FontDesc_t *d,
+                          uint8_t has_crc) {
+  if (d->trust == FONT_TRUST_PENDING) {
+    stats->pending++;
+  } else if (d->trust == FONT_TRUST_BAD) {
+    stats->failed++;
+  } else if (has_crc) {
+    stats->verified++;
+  } else {
+    stats->unchecked++;
+  }
+}
+
+/**
+ * @brief  读取段校验统计(备用分区的段一并计入)
+ * @param  stats: 输出统计信息
+ */
+void FlashFont_CrcGetStats(FontCrcStats_t *stats) {
+  const FontTocEntry_t *e;
+
+  if (stats == NULL) {
+    return;
+  }
+  memset(stats, 0, sizeof(*stats));
+  for (uint8_t i = 0; i < g_font_desc_count; i++) {
+    e = (g_font_desc[i].trust == FONT_TRUST_OK) ? FontCrc_Entry(&g_font_desc[i])
+                                                : NULL;
+    FontCrc_Count(stats, &g_font_desc[i],
+                  e != NULL && (e->flags & FONT_TOC_F_CRC));
+  }
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+  for (uint8_t i = 0; i < g_fb_glyph_count; i++) {
+    e = (g_fb_glyph[i].trust == FONT_TRUST_OK) ? FontCrc_Entry(&g_fb_glyph[i])
+                                               : NULL;
+    FontCrc_Count(stats, &g_fb_glyph[i],
+                  e != NULL && (e->flags & FONT_TOC_F_CRC));
+  }
+#endif
+}
+#endif /* FLASH_FONT_CRC_ENABLE */
+
+/**
+ * @brief  获取指定字体每字符占用的字节数
+ * @param  font_size: 字体大小(12/16/20/24/32)
+ * @retval >=0: 每字符字节数, <0: 无效字体大小
+ */
+int16_t FlashFont_BytesPerChar(uint8_t font_size) {
+  const FontDesc_t *d = GlyphDesc(font_size);
+
+  return (d != NULL) ? (int16_t)d->stride : -1;
+}
+
+/**
+ * @brief  查询字库是否有该字号的汉字或ASCII字模段
+ * @param  font_size: 字体大小
+ * @retval 1-有, 0-没有或字库未初始化
+ * @note   只读取初始化时按字号建好的段表，不访问Flash、不等待校验
+ */
+uint8_t FlashFont_HasSize(uint8_t font_size) {
+  return font_size != 0 && font_size <= FLASH_FONT_MAX_SIZE &&
+         (g_glyph_desc[font_size] != NULL || g_ascii_desc[font_size] != NULL);
+}
+
+/**
+ * @brief  查找RAM段描述
+ * @param  type: 段类型 FONT_SEC_xxx
+ * @param  font_size: 字号，非字模段传0
+ * @retval 段描述指针，字库中没有该段返回NULL
+ */
+const FontDesc_t *FlashFont_GetDesc(uint8_t type, uint8_t font_size) {
+  if (type == FONT_SEC_GLYPH) {
+    return GlyphDesc(font_size);
+  }
+  if (type == FONT_SEC_ASCII) {
+    return AsciiDesc(font_size);
+  }
+  for (uint8_t i = 0; i < g_font_desc_count; i++) {
+    if (g_font_desc[i].type == type && g_font_desc[i].font_size == font_size &&
+        g_font_desc[i].family == 0) { // 对照表等共用段只取字体族0
+      return FontDesc_Use(&g_font_desc[i]);
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief  选择字体族
+ * @param  family: 字体族(目录项的family)，0为默认字体
+ * @retval 0-成功, -1-字体族超出 FLASH_FONT_MAX_FAMILIES
+ * @note   字体族变化时按字号重建段表，不清除字模缓存(缓存键带字体族)
+ * @note   字库中没有的字体族不报错，各字号都使用字体族0
+ */
+int8_t FlashFont_SelectFamily(uint8_t family) {
+  if (family >= FLASH_FONT_MAX_FAMILIES) {
+    return -1;
+  }
+  if (family != g_font_family) {
+    g_font_family = family;
+    FontDesc_Index();
+#ifdef FLASH_FONT_TOFU_ENABLE
+    g_tofu_size = 0; // 方框字模的格式随字模段变化
+#endif
+  }
+  return FLASHFONT_OK;
+}
+
+/**
+ * @brief  获取当前字体族
+ */
+uint8_t FlashFont_GetFamily(void) { return g_font_family; }
+
+/**
+ * @brief  计算字模缓存键
+ * @param  cp: 字符键(Unicode码点，或最高位带标记的GB2312编码)
+ * @param  font_size: 字体大小
+ * @retval 实际使用的字模段属于字体族0时为cp本身，否则在第24位起带上字体族
+ * @note   不同字体族的同一字符、同一字号占用不同的缓存项
+ */
+ITCM_CODE uint32_t FlashFont_GlyphKey(uint32_t cp, uint8_t font_size) {
+  const FontDesc_t *d = (cp < 0x80) ? AsciiDesc(font_size) : GlyphDesc(font_size);
+
+  return (d != NULL) ? (cp | ((uint32_t)d->family << 24)) : cp;
+}
+
+/*******************************************************************************
+ *                          A/B分区后台更新
+ ******************************************************************************/
+
+/**
+ * @brief  获取当前使用的字库分区
+ * @retval 分区起始地址(FONT_BANK_A_ADDR / FONT_BANK_B_ADDR)
+ */
+uint32_t FlashFont_ActiveBank(void) { return g_font_bank; }
+
+/**
+ * @brief  开始向非活动分区写入新字库
+ * @param  job: 更新任务
+ * @param  size: 字库镜像字节数
+ * @retval QSPI_W25Qxx_OK - 成功
+ * @retval W25Qxx_ERROR_Erase - 字库未初始化或镜像过大
+ * @note   目标分区原有的分区头保留到提交时才改写，其序号比活动分区旧，
+ *         中途掉电或复位不会被选中
+ */
+int8_t FlashFont_BankBegin(FontBankJob_t *job, uint32_t size) {
+  if (job == NULL || !g_font_initialized || size == 0 ||
+      size > FONT_BANK_HDR_OFS) {
+    return W25Qxx_ERROR_Erase;
+  }
+  job->bank = (g_font_bank == FONT_BANK_A_ADDR) ? FONT_BANK_B_ADDR
+                                                : FONT_BANK_A_ADDR;
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+  g_fb_glyph_count = 0; // 目标分区即将改写，不再作为备用字库
+  g_fb_sorted = NULL;
+#endif
+#ifdef FLASH_FONT_CRC_ENABLE
+  g_crc_desc = NULL; // 后台校验可能正在读取目标分区
+  g_crc_pos = 0;
+#endif
+  job->seq = g_font_seq + 1;
+  job->size = size;
+  job->end = 0;
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  写入一段字库镜像
+ * @param  job: 更新任务
+ * @param  offset: 镜像内偏移(4KB对齐)
+ * @param  data: 数据
+ * @param  len: 字节数
+ * @retval QSPI_W25Qxx_OK - 成功
+ * @retval W25Qxx_ERROR_TRANSMIT - MDMA字模预取进行中，稍后重试
+ * @retval W25Qxx_ERROR_MemoryMapped - 定义了QSPI_XIP_ENABLE，不能在线更新
+ * @retval W25Qxx_ERROR_* - 写入失败
+ * @note   内容相同的扇区不会擦写，重复写入同一镜像几乎不耗时
+ */
+int8_t FlashFont_BankWrite(FontBankJob_t *job, uint32_t offset,
+                           const uint8_t *data, uint32_t len) {
+  int8_t status;
+
+  if (job == NULL || data == NULL || offset > job->size ||
+      len > job->size - offset) {
+    return W25Qxx_ERROR_Erase;
+  }
+  FontPower_Use(); // 在线更新要读取映射区比较扇区内容
+#if defined(GLYPH_CACHE_ENABLE) && defined(GLYPH_PREFETCH_ENABLE)
+  // 预取MDMA正在读取映射区，此时退出映射会产生总线错误
+  if (GlyphPrefetch_Busy()) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+#endif
+
+  status = QSPI_W25Qxx_MappedUpdate(data, job->bank + offset, len, NULL);
+  if (status == QSPI_W25Qxx_OK && offset + len > job->end) {
+    job->end = offset + len;
+  }
+  return status;
+}
+
+/**
+ * @brief  声明非活动分区正被直接擦写
+ * @param  hold: 1-开始(QSPI即将退出映射模式)，0-结束(已重新进入映射模式)
+ * @retval QSPI_W25Qxx_OK - 成功
+ * @retval W25Qxx_ERROR_TRANSMIT - MDMA字模预取或镜像拷贝正在读取映射区，稍后重试
+ * @note   期间 FlashFont_Idle() 和 FlashFont_PowerIdle() 不访问Flash
+ */
+int8_t FlashFont_BankHold(uint8_t hold) {
+  if (hold) {
+#if defined(GLYPH_CACHE_ENABLE) && defined(GLYPH_PREFETCH_ENABLE)
+    if (GlyphPrefetch_Busy()) {
+      return W25Qxx_ERROR_TRANSMIT;
+    }
+#endif
+#ifdef FLASH_FONT_MIRROR_ENABLE
+    if (g_mirror_state == FONT_MIRROR_COPY) {
+      return W25Qxx_ERROR_TRANSMIT;
+    }
+#endif
+    FontPower_Use(); // 先唤醒，之后 FlashFont_PowerIdle() 不再让Flash掉电
+  }
+  g_bank_hold = hold;
+#ifdef FLASH_FONT_HOLD_SUSPEND
+  g_hold_mapped = 0;
+#endif
+  return QSPI_W25Qxx_OK;
+}
+
+#ifdef FLASH_FONT_HOLD_SUSPEND
+/**
+ * @brief  分区安装期间第一次访问字库时暂停擦写并映射
+ * @note   擦除在tSUS(20us)内停下，编程在当前页结束后停下(tPP 3ms)，
+ *         两次擦写之间器件空闲，直接重新映射
+ * @note   活动分区与正在擦写的非活动分区不重叠，暂停期间读到的字模正确
+ */
+static void FontHold_Map(void) {
+  uint32_t start = DWT->CYCCNT;
+  uint32_t cycles;
+  int8_t status = QSPI_W25Qxx_EraseSuspend();
+
+  if (status == W25Qxx_ERROR_Erase && !QSPI_W25Qxx_Write_Busy()) {
+    status = QSPI_W25Qxx_MemoryMappedMode();
+  }
+  if (status != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("FlashFont: 安装期间暂停擦写失败");
+    g_hold_stats.failures++;
+    return;
+  }
+  cycles = DWT->CYCCNT - start;
+  g_hold_mapped = 1;
+  g_hold_stats.suspends++;
+  g_hold_stats.last_cycles = cycles;
+  if (cycles > g_hold_stats.max_cycles) {
+    g_hold_stats.max_cycles = cycles;
+  }
+}
+#endif
+
+/**
+ * @brief  恢复为读取字库而暂停的擦写
+ * @retval QSPI_W25Qxx_OK - 已恢复或没有暂停
+ * @retval W25Qxx_ERROR_TRANSMIT - MDMA字模预取正在读取映射区，稍后重试
+ * @retval W25Qxx_ERROR_* - 恢复失败
+ */
+int8_t FlashFont_HoldRelease(void) {
+#ifdef FLASH_FONT_HOLD_SUSPEND
+  if (!g_hold_mapped) {
+    return QSPI_W25Qxx_OK;
+  }
+#if defined(GLYPH_CACHE_ENABLE) && defined(GLYPH_PREFETCH_ENABLE)
+  // 预取MDMA正在读取映射区，此时退出映射会产生总线错误
+  if (GlyphPrefetch_Busy()) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+#endif
+  g_hold_mapped = 0;
+  if (QSPI_W25Qxx_EraseSuspended()) {
+    return QSPI_W25Qxx_EraseResume(); // 两次擦写之间映射的，由下一次擦写退出映射
+  }
+#endif
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  读取擦写暂停统计
+ * @param  stats: 输出统计信息
+ */
+void FlashFont_HoldGetStats(FontHoldStats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+#ifdef FLASH_FONT_HOLD_SUSPEND
+  *stats = g_hold_stats;
+#else
+  memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+/**
+ * @brief  记录已由调用者直接写入的镜像长度
+ * @param  job: 更新任务
+ * @param  end: 已写入的最大偏移
+ * @note   供不经过 FlashFont_BankWrite() 的异步写入使用，提交前须写满job->size
+ */
+void FlashFont_BankMark(FontBankJob_t *job, uint32_t end) {
+  if (job != NULL && end <= job->size && end > job->end) {
+    job->end = end;
+  }
+}
+
+/**
+ * @brief  提交新分区
+ * @param  job: 更新任务
+ * @retval QSPI_W25Qxx_OK - 成功
+ * @retval W25Qxx_ERROR_Erase - 镜像未写完或字库标志无效
+ * @retval W25Qxx_ERROR_* - 写入失败
+ */
+int8_t FlashFont_BankCommit(FontBankJob_t *job) {
+  FontBankHeader_t hdr;
+  const FontWriteFlag_t *flag;
+
+  if (job == NULL || job->end < job->size) {
+    return W25Qxx_ERROR_Erase;
+  }
+  FontPower_Use();
+  flag = FontBank_Flag(job->bank);
+  if (flag == NULL || flag->magic != FLAG_MAGIC) {
+    DEBUG_ERROR("FlashFont_BankCommit: 新分区字库标志无效");
+    return W25Qxx_ERROR_Erase;
+  }
+#if defined(GLYPH_CACHE_ENABLE) && defined(GLYPH_PREFETCH_ENABLE)
+  if (GlyphPrefetch_Busy()) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+#endif
+
+  // 分区头最后写入，写入完成的瞬间新分区生效
+  hdr.magic = BANK_MAGIC;
+  hdr.seq = job->seq;
+  hdr.size = job->size;
+  hdr.check = ~(hdr.magic ^ hdr.seq ^ hdr.size);
+  return QSPI_W25Qxx_MappedUpdate((const uint8_t *)&hdr,
+                                  job->bank + FONT_BANK_HDR_OFS, sizeof(hdr),
+                                  NULL);
+}
+
+/*******************************************************************************
+ *                          GB2312对照表Flash访问实现
+ ******************************************************************************/
+
+#ifdef FLASH_FONT_GB2312_ROWS
+/**
+ * @brief  32位字中1的个数(Cortex-M7没有popcount指令，用移位相加)
+ */
+static inline uint32_t Popcount32(uint32_t v) {
+  v = v - ((v >> 1) & 0x55555555U);
+  v = (v & 0x33333333U) + ((v >> 2) & 0x33333333U);
+  return (((v + (v >> 4)) & 0x0F0F0F0FU) * 0x01010101U) >> 24;
+}
+
+/**
+ * @brief  由区位映射表建立GB2312行表
+ * @note   读取一次Flash中的映射表(约17KB)。按GB2312顺序编号的字库(fontbuild.py
+ *         --ttf 默认字符集)每区的字库索引都连续；索引不连续的区(原始字库的部分区、
+ *         --profile 重排过的字库)行表无法表示，只标记该区，查找时仍读映射表
+ */
+static void GbRows_Build(void) {
+  g_gb_rows_ready = 0;
+  if (g_gb2312_map == NULL) {
+    return;
+  }
+  for (uint8_t row = 0; row < GB2312_MAP_DIM; row++) {
+    const uint16_t *cell = &g_gb2312_map[row * GB2312_MAP_DIM];
+    GbRow_t *r = &g_gb_rows[row];
+    uint16_t n = 0;
+
+    memset(r, 0, sizeof(*r));
+    for (uint8_t col = 0; col < GB2312_MAP_DIM; col++) {
+      uint16_t index = cell[col];
+
+      if (index == FONT_NO_GLYPH) {
+        continue;
+      }
+      if (n == 0) {
+        r->base = index;
+      } else if (index != (uint16_t)(r->base + n)) {
+        r->base = GB_ROW_FLASH;
+        break;
+      }
+      r->bits[col >> 5] |= 1UL << (col & 31);
+      n++;
+    }
+    r->pre[0] = (uint8_t)Popcount32(r->bits[0]);
+    r->pre[1] = (uint8_t)(r->pre[0] + Popcount32(r->bits[1]));
+  }
+  g_gb_rows_ready = 1;
+}
+
+/**
+ * @brief  在行表中查找区位
+ * @param  row: 区号-0xA1
+ * @param  col: 位号-0xA1
+ * @retval 字库索引, 没有该字返回-1, 该区需要查映射表返回GB_ROW_MAP
+ */
+static int16_t GbRows_Find(uint8_t row, uint8_t col) {
+  const GbRow_t *r;
+  uint32_t bits, mask;
+  uint8_t w;
+
+  if (row >= GB2312_MAP_DIM || col >= GB2312_MAP_DIM) {
+    return -1; // 不在GB2312区位范围内
+  }
+  r = &g_gb_rows[row];
+  if (r->base == GB_ROW_FLASH) {
+    return GB_ROW_MAP;
+  }
+  w = col >> 5;
+  bits = r->bits[w];
+  mask = 1UL << (col & 31);
+  if ((bits & mask) == 0) {
+    return -1;
+  }
+  return (int16_t)(r->base + (w ? r->pre[w - 1] : 0) +
+                   Popcount32(bits & (mask - 1)));
+}
+#endif
+
+/**
+ * @brief  从Flash查找汉字对应的字库索引
+ * @param  text: 汉字字符串(GBK编码，2字节)
+ * @retval 字库索引(0-7463), 未找到返回-1
+ * @note   存在区位映射表时由(区-0xA1)*94+(位-0xA1)直接定位，只读一个uint16；
+ *         定义FLASH_FONT_GB2312_ROWS时字库索引连续的区只查RAM中的行表，不读QSPI
+ * @note   旧版bin文件没有映射表，回退线性查找O(n)
+ */
+int16_t GB2312_FindIndex_Flash(const char *text) {
+  uint16_t search_gbk;
+  const GB2312_TableEntry_t *pEntry;
+
+  if (!g_font_initialized) {
+    DEBUG_ERROR("GB2312_FindIndex_Flash: 字库未初始化");
+    return -1;
+  }
+  FontEpoch_Check();
+#ifdef FLASH_FONT_GB2312_ROWS
+  if (g_gb_rows_ready) {
+    int16_t index = GbRows_Find((uint8_t)text[0] - 0xA1, (uint8_t)text[1] - 0xA1);
+
+    if (index != GB_ROW_MAP) {
+      return index;
+    }
+  }
+#endif
+  FontPower_Use();
+
+  if (g_gb2312_map != NULL) {
+    uint8_t row = (uint8_t)text[0] - 0xA1;
+    uint8_t col = (uint8_t)text[1] - 0xA1;
+    uint16_t index;
+
+    if (row >= GB2312_MAP_DIM || col >= GB2312_MAP_DIM) {
+      return -1; // 不在GB2312区位范围内
+    }
+    index = g_gb2312_map[row * GB2312_MAP_DIM + col];
+    return (index == FONT_NO_GLYPH) ? -1 : (int16_t)index;
+  }
+
+  // 将输入字符转为GBK码
+  search_gbk = ((uint16_t)(uint8_t)text[0] << 8) | (uint8_t)text[1];
+
+  // 线性查找(旧版bin文件)
+  pEntry = g_gb2312_table;
+  if (pEntry == NULL) {
+    return -1;
+  }
+  for (uint32_t i = 0; i < g_gb2312_count; i++) {
+    if (pEntry[i].gbk_code == FONT_NO_GLYPH) {
+      break; // 遇到特殊标记，提前结束
+    }
+
+    if (pEntry[i].gbk_code == search_gbk) {
+      return pEntry[i].index; // 找到
+    }
+  }
+
+  return -1; // 未找到
+}
+
+/**
+ * @brief  从Flash查找汉字并返回字模数据指针
+ * @param  text: 汉字字符串(GBK编码，2字节)
+ * @param  font_size: 字体大小(12/16/20/24/32)
+ * @retval 字模数据指针，查找失败返回NULL
+ */
+const uint8_t *GB2312_FindFont_Flash(const char *text, uint8_t font_size) {
+  return GetGlyphAddr(GB2312_FindIndex_Flash(text), font_size);
+}
+
+/*******************************************************************************
+ *                          utf8对照表Flash访问实现
+ ******************************************************************************/
+/**
+ * @brief  把码点编码为UTF8字节序列
+ * @param  cp: Unicode码点
+ * @param  out: 输出缓冲区(至少4字节)
+ * @retval UTF8字节长度(1-4)
+ * @note   内部私有函数，仅用于旧版bin文件的线性查找
+ */
+static uint8_t UTF8_EncodeCodepoint(uint32_t cp, uint8_t *out) {
+  if (cp < 0x80) {
+    out[0] = (uint8_t)cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = 0xC0 | (uint8_t)(cp >> 6);
+    out[1] = 0x80 | (uint8_t)(cp & 0x3F);
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = 0xE0 | (uint8_t)(cp >> 12);
+    out[1] = 0x80 | (uint8_t)((cp >> 6) & 0x3F);
+    out[2] = 0x80 | (uint8_t)(cp & 0x3F);
+    return 3;
+  }
+  out[0] = 0xF0 | (uint8_t)(cp >> 18);
+  out[1] = 0x80 | (uint8_t)((cp >> 12) & 0x3F);
+  out[2] = 0x80 | (uint8_t)((cp >> 6) & 0x3F);
+  out[3] = 0x80 | (uint8_t)(cp & 0x3F);
+  return 4;
+}
+
+/**
+ * @brief  在排序索引中二分查找码点
+ * @param  table: 排序索引(活动分区或备用分区)
+ * @param  count: 索引项数
+ * @param  cp: Unicode码点
+ * @retval 字库索引, 未找到返回-1
+ * @note   7350项最多13次比较，每次只读取一个8字节索引项
+ */
+ITCM_CODE static int16_t UTF8_SearchTable(const UTF8_SortedEntry_t *table,
+                                          uint32_t count, uint32_t cp) {
+  uint32_t lo = 0;
+  uint32_t hi = count;
+
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) >> 1;
+    uint32_t code = table[mid].code;
+
+    if (code == cp) {
+      return (int16_t)table[mid].index;
+    }
+    if (code < cp) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief  在压缩排序索引中二分查找码点
+ * @param  cp: Unicode码点
+ * @retval 字库索引, 未找到返回-1
+ * @note   每次比较读取一个4字节项，项数相同时访问的Cache行是8字节索引的一半
+ */
+ITCM_CODE static int16_t UTF8_SearchPacked(uint32_t cp) {
+  const uint8_t bits = g_utf8_packed_bits;
+  uint32_t lo = 0;
+  uint32_t hi = g_utf8_packed_count;
+
+  if ((cp >> (32 - bits)) != 0) {
+    return -1; // 超出压缩索引能表示的码点范围
+  }
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) >> 1;
+    uint32_t e = g_utf8_packed[mid];
+    uint32_t code = e >> bits;
+
+    if (code == cp) {
+      return (int16_t)(e & ((1UL << bits) - 1));
+    }
+    if (code < cp) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief  在活动分区的排序索引中二分查找码点
+ * @note   有压缩排序索引时使用压缩索引
+ */
+ITCM_CODE static int16_t UTF8_SearchSorted(uint32_t cp) {
+  if (g_utf8_packed != NULL) {
+    return UTF8_SearchPacked(cp);
+  }
+  return UTF8_SearchTable(g_utf8_sorted, g_utf8_sorted_count, cp);
+}
+
+/**
+ * @brief  活动分区排序索引的项数，没有排序索引返回0
+ */
+static inline uint32_t UTF8_SortedCount(void) {
+  return (g_utf8_packed != NULL) ? g_utf8_packed_count : g_utf8_sorted_count;
+}
+
+/**
+ * @brief  读取活动分区排序索引的第i项
+ * @param  i: 项序号(小于 UTF8_SortedCount())
+ * @param  index: 输出字库索引，可为NULL
+ * @retval 码点
+ */
+static inline uint32_t UTF8_SortedAt(uint32_t i, int16_t *index) {
+  if (g_utf8_packed != NULL) {
+    uint32_t e = g_utf8_packed[i];
+
+    if (index != NULL) {
+      *index = (int16_t)(e & ((1UL << g_utf8_packed_bits) - 1));
+    }
+    return e >> g_utf8_packed_bits;
+  }
+  if (index != NULL) {
+    *index = (int16_t)g_utf8_sorted[i].index;
+  }
+  return g_utf8_sorted[i].code;
+}
+
+/**
+ * @brief  检查并启用Unicode分块索引
+ * @param  page: 页表(段起始)
+ * @param  blocks: 块数
+ * @note   页表中的块号全部校验一次(512字节)，查找时不再检查越界
+ */
+static void UBlock_Load(const uint16_t *page, uint32_t blocks) {
+  for (uint16_t i = 0; i < FONT_BLOCK_PAGES; i++) {
+    if (page[i] != FONT_BLOCK_NONE && page[i] >= blocks) {
+      DEBUG_ERROR("Unicode分块索引的块号越界，不使用分块索引");
+      return;
+    }
+  }
+  g_ublock_page = page;
+}
+
+/**
+ * @brief  在Unicode分块索引中查找BMP码点
+ * @param  cp: Unicode码点(<=0xFFFF)
+ * @retval 字库索引, 未找到返回-1
+ * @note   页表一次 + 块内一次，与字库字数无关
+ */
+ITCM_CODE static int16_t UTF8_SearchBlocks(uint32_t cp) {
+  uint16_t block = g_ublock_page[cp >> 8];
+  uint16_t index;
+
+  if (block == FONT_BLOCK_NONE) {
+    return -1;
+  }
+  index = g_ublock_page[FONT_BLOCK_PAGES + ((uint32_t)block << 8) + (cp & 0xFF)];
+  return (index == FONT_BLOCK_NONE || index > 0x7FFF) ? -1 : (int16_t)index;
+}
+
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+/**
+ * @brief  计算码点的缺字缓存槽位(乘法哈希)
+ */
+static inline uint32_t FontMiss_Slot(uint32_t cp) {
+  return (uint32_t)(cp * 2654435761U) >> (32 - FLASH_FONT_MISS_BITS);
+}
+
+/**
+ * @brief  查询码点是否已知在活动分区中不存在
+ * @retval 缓存项(码点 | MISS_NO_FALLBACK)，不在缓存中返回0
+ */
+ITCM_CODE static inline uint32_t FontMiss_Find(uint32_t cp) {
+  uint32_t e = g_font_miss[FontMiss_Slot(cp)];
+
+  return ((e & ~MISS_NO_FALLBACK) == cp) ? e : 0;
+}
+
+/**
+ * @brief  记录活动分区中不存在的码点，同槽的旧码点被替换
+ * @param  flags: MISS_NO_FALLBACK 表示备用分区也已查过
+ */
+static inline void FontMiss_Add(uint32_t cp, uint32_t flags) {
+  if (cp != 0) {
+    g_font_miss[FontMiss_Slot(cp)] = cp | flags;
+  }
+}
+#endif
+
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+/**
+ * @brief  解析非活动分区的目录，作为缺字时的备用字库
+ * @note   只取排序索引和与活动分区格式、宽度、步长都相同的汉字字模段，
+ *         备用字模可以直接交给同一套展开、缓存代码；没有目录的旧版分区不使用
+ */
+static void FontFallback_Load(void) {
+  uint32_t bank = (g_font_bank == FONT_BANK_A_ADDR) ? FONT_BANK_B_ADDR
+                                                    : FONT_BANK_A_ADDR;
+  const FontTocHeader_t *toc;
+  uint32_t seq;
+
+  g_fb_sorted = NULL;
+  g_fb_sorted_count = 0;
+  g_fb_glyph_count = 0;
+  if (!FontBank_Probe(bank, &seq) || (toc = FontToc_Get(bank)) == NULL) {
+    return;
+  }
+
+  for (uint16_t i = 0; i < toc->count; i++) {
+    const FontTocEntry_t *e = FontToc_Entry(toc, i);
+    const uint8_t *data = (const uint8_t *)(W25Qxx_Mem_Addr + bank + e->offset);
+    const FontDesc_t *cur;
+    FontDesc_t *d;
+
+    if (e->offset > FONT_BANK_HDR_OFS ||
+        e->size > FONT_BANK_HDR_OFS - e->offset) {
+      continue;
+    }
+    if (e->type == FONT_SEC_UTF8_SORTED) {
+      if (g_fb_sorted == NULL && e->count > 0 && e->count <= 0xFFFF &&
+          e->count * sizeof(UTF8_SortedEntry_t) <= e->size) {
+        g_fb_sorted = (const UTF8_SortedEntry_t *)data;
+        g_fb_sorted_count = (uint16_t)e->count;
+        memset(&g_fb_index, 0, sizeof(g_fb_index));
+        g_fb_index.type = FONT_SEC_UTF8_SORTED;
+        g_fb_index.data = data;
+        g_fb_index.trust = FontToc_Trust(toc, e);
+        g_fb_index.toc = i;
+      }
+      continue;
+    }
+    cur = (e->type == FONT_SEC_GLYPH && e->family == 0)
+              ? GlyphDesc_Meta(e->height)
+              : NULL;
+    if (cur == NULL || e->format != cur->format || e->width != cur->width ||
+        e->stride != cur->stride ||
+        g_fb_glyph_count >= FLASH_FONT_FALLBACK_SECTIONS) {
+      continue; // 活动分区没有该字号或格式不同
+    }
+    if (e->format == FONT_FMT_1BPP_RLE
+            ? ((e->offset & 3) != 0 || FontRle_IndexBytes(e->count) > e->size)
+            : (uint64_t)e->count * e->stride > e->size) {
+      continue;
+    }
+    for (d = g_fb_glyph; d < g_fb_glyph + g_fb_glyph_count; d++) {
+      if (d->font_size == e->height) {
+        break;
+      }
+    }
+    if (d < g_fb_glyph + g_fb_glyph_count) {
+      continue; // 同一字号只取第一段
+    }
+    d = &g_fb_glyph[g_fb_glyph_count++];
+    memset(d, 0, sizeof(*d));
+    d->type = FONT_SEC_GLYPH;
+    d->font_size = e->height;
+    d->data = data;
+    d->count = e->count;
+    d->stride = e->stride;
+    d->width = e->width;
+    d->format = e->format;
+    d->index_type = e->index_type;
+    d->trust = FontToc_Trust(toc, e);
+    d->toc = i;
+  }
+  if (g_fb_sorted == NULL) {
+    g_fb_glyph_count = 0; // 没有排序索引时无法按码点查找
+  }
+}
+
+/**
+ * @brief  取备用分区中该字号的汉字字模段
+ * @retval 段描述指针，没有该字号或与当前字体族的字模格式不同返回NULL
+ */
+static const FontDesc_t *FontFallback_Desc(uint8_t font_size) {
+  const FontDesc_t *cur = GlyphDesc_Meta(font_size);
+
+  for (uint8_t i = 0; i < g_fb_glyph_count; i++) {
+    const FontDesc_t *d = &g_fb_glyph[i];
+
+    if (d->font_size == font_size) {
+      return (cur != NULL && d->format == cur->format &&
+              d->width == cur->width && d->stride == cur->stride)
+                 ? d
+                 : NULL;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief  在备用分区中查找字模
+ * @retval 字模数据指针，没有该字返回NULL
+ */
+static const uint8_t *FontFallback_Find(const FontDesc_t *d, uint32_t cp) {
+  if (FontDesc_Use(&g_fb_index) == NULL) {
+    return NULL;
+  }
+  return GlyphDesc_Addr(FontDesc_Use(d),
+                        UTF8_SearchTable(g_fb_sorted, g_fb_sorted_count, cp));
+}
+#endif
+
+#ifdef FLASH_FONT_TOFU_ENABLE
+/**
+ * @brief  生成当前字号的方框字模
+ * @retval 字模数据指针(格式与该字号的汉字字模段相同)，字号超出缓冲区返回NULL
+ * @note   边框离字模单元边缘 width/8 像素；只在字号变化时重新生成
+ */
+static const uint8_t *FontTofu_Get(uint8_t font_size) {
+  const FontDesc_t *d = GlyphDesc_Meta(font_size);
+  uint8_t row[TOFU_ROW_BYTES], prev[TOFU_ROW_BYTES];
+  uint16_t w, bpr, out_bpr, m, tag_bytes = 0;
+  uint8_t *out = g_tofu;
+
+  if (d == NULL || d->width > FLASH_FONT_TOFU_MAX_SIZE ||
+      font_size > FLASH_FONT_TOFU_MAX_SIZE) {
+    return NULL;
+  }
+  if (g_tofu_size == font_size) {
+    return g_tofu;
+  }
+  w = d->width;
+  bpr = (w + 7) / 8;
+  out_bpr = (d->format == FONT_FMT_1BPP_ROW32) ? FONT_ROW32_BYTES(w) : bpr;
+  m = (w >= 16) ? w / 8 : 1;
+  if (d->format != FONT_FMT_1BPP_RLE && d->stride != out_bpr * font_size) {
+    return NULL;
+  }
+
+  memset(g_tofu, 0, sizeof(g_tofu));
+  memset(prev, 0, sizeof(prev));
+  if (d->format == FONT_FMT_1BPP_RLE) {
+    tag_bytes = (font_size + 7) / 8;
+    out += tag_bytes;
+  }
+  for (uint16_t r = 0; r < font_size; r++) {
+    memset(row, 0, out_bpr);
+    if (r >= m && r < font_size - m) {
+      uint8_t edge = (r == m || r == font_size - m - 1);
+
+      for (uint16_t c = m; c < w - m; c++) {
+        if (edge || c == m || c == w - m - 1) {
+          row[c >> 3] |= (uint8_t)(1 << (c & 7)); // 低位为左侧像素
+        }
+      }
+    }
+    if (tag_bytes == 0) {
+      memcpy(out, row, out_bpr); // 逐行格式，补齐字节为0
+      out += out_bpr;
+    } else if (memcmp(row, prev, bpr) != 0) {
+      g_tofu[r >> 3] |= (uint8_t)(1 << (r & 7)); // 压缩格式只存与上一行不同的行
+      memcpy(out, row, bpr);
+      memcpy(prev, row, bpr);
+      out += bpr;
+    }
+  }
+  g_tofu_size = font_size;
+  return g_tofu;
+}
+#endif
+
+/**
+ * @brief  在原始UTF8对照表中线性查找码点(旧版bin文件)
+ * @param  cp: Unicode码点
+ * @retval 字库索引, 未找到返回-1
+ * @note   码点先编码一次为UTF8，逐项只比较长度和字节
+ */
+static int16_t UTF8_SearchLinear(uint32_t cp) {
+  const UTF8_TableEntry_t *pEntry = g_utf8_table;
+  uint8_t utf8[4];
+  uint8_t utf8_len = UTF8_EncodeCodepoint(cp, utf8);
+
+  if (pEntry == NULL) {
+    return -1;
+  }
+  for (uint32_t i = 0; i < g_utf8_count; i++) {
+    if (pEntry[i].utf8_len == utf8_len &&
+        memcmp(pEntry[i].utf8, utf8, utf8_len) == 0) {
+      return pEntry[i].index; // 找到
+    }
+  }
+  return -1; // 未找到
+}
+
+/**
+ * @brief  解码一个UTF8字符
+ * @param  utf8_text: UTF8字符串
+ * @param  cp: 输出Unicode码点, 非法序列输出FLASH_FONT_INVALID_CP
+ * @retval 本字符占用的字节数(>=1)
+ * @note   单次遍历同时完成长度判断、续字节校验和码点解码
+ * @note   截断的序列只消耗到第一个非续字节为止，不会越过字符串结束符
+ */
+ITCM_CODE uint8_t FlashFont_DecodeUTF8(const uint8_t *utf8_text, uint32_t *cp) {
+  uint8_t first_byte = utf8_text[0];
+  uint8_t utf8_len;
+  uint32_t code;
+
+  // 根据UTF-8编码规则判断字符长度
+  if ((first_byte & 0x80) == 0x00) {
+    *cp = first_byte; // 0xxxxxxx - ASCII字符
+    return 1;
+  } else if ((first_byte & 0xE0) == 0xC0) {
+    utf8_len = 2; // 110xxxxx - 2字节UTF-8
+    code = first_byte & 0x1F;
+  } else if ((first_byte & 0xF0) == 0xE0) {
+    utf8_len = 3; // 1110xxxx - 3字节UTF-8
+    code = first_byte & 0x0F;
+  } else if ((first_byte & 0xF8) == 0xF0) {
+    utf8_len = 4; // 11110xxx - 4字节UTF-8
+    code = first_byte & 0x07;
+  } else {
+    *cp = FLASH_FONT_INVALID_CP; // 孤立的续字节或非法首字节
+    return 1;
+  }
+
+  for (uint8_t i = 1; i < utf8_len; i++) {
+    if ((utf8_text[i] & 0xC0) != 0x80) {
+      *cp = FLASH_FONT_INVALID_CP;
+      return i;
+    }
+    code = (code << 6) | (utf8_text[i] & 0x3F);
+  }
+
+  *cp = code;
+  return utf8_len;
+}
+
+#ifdef FLASH_FONT_GBK_TEXT
+/**
+ * @brief  字库索引对应的Unicode码点
+ * @retval 码点，没有返回0
+ * @note   没有字库索引编码表时扫描排序索引(旧版bin文件，每字O(n))
+ */
+static uint32_t IndexCode_Cp(int16_t index) {
+  uint32_t n = UTF8_SortedCount();
+
+  if (index < 0) {
+    return 0;
+  }
+  FontPower_Use();
+  if (g_index_codes != NULL) {
+    uint16_t cp = ((uint16_t)index < g_index_codes_count) ? g_index_codes[index].cp : FONT_NO_GLYPH;
+    return (cp == FONT_NO_GLYPH) ? 0 : cp;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    int16_t found;
+    uint32_t cp = UTF8_SortedAt(i, &found);
+
+    if (found == index) {
+      return cp;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief  字库索引对应的GBK码
+ * @retval GBK码，没有返回0
+ * @note   没有字库索引编码表时扫描区位映射表或GB2312对照表
+ */
+static uint16_t IndexCode_Gbk(int16_t index) {
+  if (index < 0) {
+    return 0;
+  }
+  FontPower_Use();
+  if (g_index_codes != NULL) {
+    uint16_t gbk = ((uint16_t)index < g_index_codes_count) ? g_index_codes[index].gbk : FONT_NO_GLYPH;
+    return (gbk == FONT_NO_GLYPH) ? 0 : gbk;
+  }
+  if (g_gb2312_map != NULL) {
+    for (uint32_t i = 0; i < GB2312_MAP_DIM * GB2312_MAP_DIM; i++) {
+      if (g_gb2312_map[i] == (uint16_t)index) {
+        return (uint16_t)(((i / GB2312_MAP_DIM + 0xA1) << 8) | (i % GB2312_MAP_DIM + 0xA1));
+      }
+    }
+    return 0;
+  }
+  for (uint32_t i = 0; g_gb2312_table != NULL && i < g_gb2312_count; i++) {
+    if (g_gb2312_table[i].gbk_code == FONT_NO_GLYPH) {
+      break;
+    }
+    if (g_gb2312_table[i].index == (uint16_t)index) {
+      return g_gb2312_table[i].gbk_code;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief  选择文本编码
+ * @retval 原来的编码
+ */
+uint8_t FlashFont_SetEncoding(uint8_t enc) {
+  uint8_t old = g_text_enc;
+
+  g_text_enc = (enc == FONT_ENC_GBK) ? FONT_ENC_GBK : FONT_ENC_UTF8;
+  return old;
+}
+
+/**
+ * @brief  读取当前文本编码
+ */
+uint8_t FlashFont_GetEncoding(void) { return g_text_enc; }
+
+/**
+ * @brief  GBK码转Unicode码点
+ * @retval Unicode码点，字库中没有该字返回0
+ */
+uint32_t FlashFont_GbkToUnicode(uint16_t gbk) {
+  char text[2];
+
+  if (gbk < 0x80) {
+    return gbk;
+  }
+  text[0] = (char)(gbk >> 8);
+  text[1] = (char)(gbk & 0xFF);
+  if (!g_font_initialized || (uint8_t)text[0] < 0xA1 || (uint8_t)text[1] < 0xA1) {
+    return 0; // GB2312之外的GBK扩展字，字库中没有
+  }
+  return IndexCode_Cp(GB2312_FindIndex_Flash(text));
+}
+
+/**
+ * @brief  Unicode码点转GBK码
+ * @retval GBK码，字库中没有或不在GB2312中返回0
+ */
+uint16_t FlashFont_UnicodeToGbk(uint32_t cp) {
+  if (cp < 0x80) {
+    return (uint16_t)cp;
+  }
+  if (!g_font_initialized) {
+    return 0;
+  }
+  return IndexCode_Gbk(FlashFont_FindIndexCP(cp));
+}
+
+/**
+ * @brief  解码一个GBK字符
+ * @retval 本字符占用的字节数(1或2)
+ */
+ITCM_CODE uint8_t FlashFont_DecodeGBK(const uint8_t *gbk_text, uint32_t *cp) {
+  uint32_t code;
+
+  if (gbk_text[0] < 0x80) {
+    *cp = gbk_text[0];
+    return 1;
+  }
+  if (gbk_text[1] < 0x40) {
+    *cp = FLASH_FONT_INVALID_CP; // 缺少尾字节(含字符串结尾)，下一个字节照常解码
+    return 1;
+  }
+  code = FlashFont_GbkToUnicode((uint16_t)((gbk_text[0] << 8) | gbk_text[1]));
+  *cp = (code != 0) ? code : FLASH_FONT_INVALID_CP;
+  return 2;
+}
+#endif
+
+/**
+ * @brief  按当前文本编码解码一个字符，ASCII在调用处直接返回
+ */
+static inline uint8_t FontText_Decode(const uint8_t *text, uint32_t *cp) {
+  if (text[0] < 0x80) {
+    *cp = text[0];
+    return 1;
+  }
+#ifdef FLASH_FONT_GBK_TEXT
+  if (g_text_enc == FONT_ENC_GBK) {
+    return FlashFont_DecodeGBK(text, cp);
+  }
+#endif
+  return FlashFont_DecodeUTF8(text, cp);
+}
+
+/**
+ * @brief  按当前文本编码解码一个字符
+ * @retval 本字符占用的字节数(>=1)
+ */
+ITCM_CODE uint8_t FlashFont_DecodeText(const uint8_t *text, uint32_t *cp) {
+  return FontText_Decode(text, cp);
+}
+
+/**
+ * @brief  按Unicode码点查找字库索引
+ * @param  cp: Unicode码点
+ * @retval 字库索引, 未找到返回-1
+ * @note   查找顺序: 缺字缓存 -> RAM哈希表 -> Unicode分块索引 -> 排序索引二分查找 -> 线性查找
+ */
+ITCM_CODE int16_t FlashFont_FindIndexCP(uint32_t cp) {
+  if (!g_font_initialized) {
+    DEBUG_ERROR("FlashFont_FindIndexCP: 字库未初始化");
+    return -1;
+  }
+  FontEpoch_Check();
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+  int16_t index;
+
+  if (FontMiss_Find(cp) != 0) {
+    return -1; // 最近查过，字库中没有
+  }
+#endif
+
+#ifdef FLASH_FONT_RAM_HASH
+  // 哈希表包含全部BMP字符，未命中即表示字库中没有该字
+  if (g_font_hash_ready && cp <= 0xFFFF) {
+    return FontHash_Find(cp);
+  }
+#endif
+
+  FontPower_Use(); // 以下索引都在映射区中
+  // 分块索引覆盖全部BMP字符，读取两次即得结果
+  if (g_ublock_page != NULL && cp <= 0xFFFF) {
+    return UTF8_SearchBlocks(cp);
+  }
+
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+  index = (UTF8_SortedCount() != 0) ? UTF8_SearchSorted(cp) : UTF8_SearchLinear(cp);
+  if (index < 0) {
+    FontMiss_Add(cp, 0); // 同一个缺字再次出现时不再二分或线性查找
+  }
+  return index;
+#else
+  if (UTF8_SortedCount() != 0) {
+    return UTF8_SearchSorted(cp);
+  }
+
+  return UTF8_SearchLinear(cp);
+#endif
+}
+
+/**
+ * @brief  按Unicode码点查找字模数据指针
+ * @param  cp: Unicode码点
+ * @param  font_size: 字体大小(12/16/20/24/32)
+ * @retval 字模数据指针，查找失败返回NULL
+ */
+ITCM_CODE const uint8_t *FlashFont_FindFontCP(uint32_t cp, uint8_t font_size) {
+  return GetGlyphAddr(FlashFont_FindIndexCP(cp), font_size);
+}
+
+/**
+ * @brief  获取缺字时显示的字模
+ * @param  cp: 活动分区中找不到的Unicode码点
+ * @param  font_size: 字体大小
+ * @retval 字模数据指针(格式与该字号的汉字字模相同)，ASCII或不支持该字号返回NULL
+ * @note   依次为: 备用分区中的同一字符 -> 替换字符 FLASH_FONT_REPLACEMENT_CP -> 方框
+ * @note   备用分区没有的码点记入缺字缓存，重复出现时直接取替换字符
+ */
+ITCM_CODE const uint8_t *FlashFont_FallbackCP(uint32_t cp, uint8_t font_size) {
+  const uint8_t *pFontData = NULL;
+
+  if (!g_font_initialized || cp < 0x80) {
+    return NULL;
+  }
+#ifdef FLASH_FONT_FALLBACK_ENABLE
+  const FontDesc_t *fb = FontFallback_Desc(font_size);
+
+  if (fb != NULL) { // 格式不同(其他字体族)时不查，也不记为备用分区缺字
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+    if ((FontMiss_Find(cp) & MISS_NO_FALLBACK) == 0) {
+      pFontData = FontFallback_Find(fb, cp);
+      if (pFontData == NULL) {
+        FontMiss_Add(cp, MISS_NO_FALLBACK);
+      }
+    }
+#else
+    pFontData = FontFallback_Find(fb, cp);
+#endif
+  }
+#endif
+#if FLASH_FONT_REPLACEMENT_CP != 0
+  if (pFontData == NULL && cp != FLASH_FONT_REPLACEMENT_CP) {
+    pFontData = FlashFont_FindFontCP(FLASH_FONT_REPLACEMENT_CP, font_size);
+  }
+#endif
+#ifdef FLASH_FONT_TOFU_ENABLE
+  if (pFontData == NULL) {
+    pFontData = FontTofu_Get(font_size);
+  }
+#endif
+  return pFontData;
+}
+
+/**
+ * @brief  获取字模占用的字节数
+ * @param  cp: Unicode码点，<0x80为ASCII半角字模
+ * @param  font_size: 字体大小
+ * @retval 字模字节数，不支持该字号返回0
+ */
+uint16_t FlashFont_GlyphBytes(const uint8_t *glyph, uint32_t cp,
+                              uint8_t font_size) {
+  const FontDesc_t *d =
+      (cp < 0x80) ? AsciiDesc(font_size) : GlyphDesc(font_size);
+  uint16_t tag_bytes, rows = 0;
+
+  if (d == NULL || glyph == NULL) {
+    return 0;
+  }
+  if (d->format != FONT_FMT_1BPP_RLE) {
+    return d->stride;
+  }
+
+  // 行标记中每个1位对应一个存储的新行
+  tag_bytes = (d->font_size + 7) / 8;
+  for (uint16_t i = 0; i < tag_bytes; i++) {
+    for (uint8_t v = glyph[i]; v != 0; v &= v - 1) {
+      rows++;
+    }
+  }
+  return tag_bytes + rows * ((d->width + 7) / 8);
+}
+
+/**
+ * @brief  查询字模是否为行程压缩格式
+ * @param  cp: Unicode码点，<0x80为ASCII
+ * @param  font_size: 字体大小
+ * @retval 1-压缩格式, 2-每行按4字节补齐, 0-按字节补齐或不支持该字号
+ */
+ITCM_CODE uint8_t FlashFont_GlyphPacked(uint32_t cp, uint8_t font_size) {
+  const FontDesc_t *d =
+      (cp < 0x80) ? AsciiDesc(font_size) : GlyphDesc(font_size);
+
+  if (d == NULL) {
+    return 0;
+  }
+  return (d->format == FONT_FMT_1BPP_RLE) ? 1 : (d->format == FONT_FMT_1BPP_ROW32) ? 2 : 0;
+}
+
+#ifdef PERF_STATS_ENABLE
+/**
+ * @brief  统计一次绕过常驻子集和缓存的字模查找
+ */
+ITCM_CODE static void FontPerf_Fetch(const uint8_t *glyph, uint32_t cp,
+                                     uint8_t font_size) {
+  if (glyph == NULL) {
+    PERF_COUNT(glyph_missing);
+    return;
+  }
+  PERF_COUNT(glyph_qspi);
+  PERF_ADD(qspi_bytes, FlashFont_GlyphBytes(glyph, cp, font_size));
+  if (cp >= 0x80) {
+    PerfStats_GlyphFetch(cp); // ASCII字模不参与重排
+  }
+}
+#else
+#define FontPerf_Fetch(glyph, cp, font_size) ((void)0)
+#endif
+
+/**
+ * @brief  按码点获取字模(经过字模缓存)
+ * @param  cp: Unicode码点，<0x80时取ASCII字库
+ * @param  font_size: 字体大小(12/16/20/24/32)
+ * @retval 字模数据指针，查找失败返回NULL
+ * @note   命中常驻子集或缓存时既不查表也不读取QSPI
+ */
+ITCM_CODE const uint8_t *FlashFont_GetGlyphCP(uint32_t cp, uint8_t font_size) {
+  const uint8_t *pFontData;
+#ifdef GLYPH_CACHE_ENABLE
+  uint32_t key;
+#endif
+
+  FontEpoch_Check(); // 改写过的字模不能从缓存命中
+#ifdef GLYPH_CACHE_ENABLE
+  key = FlashFont_GlyphKey(cp, font_size);
+#endif
+
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+  pFontData = FlashFont_ResidentFind(cp, font_size);
+  if (pFontData != NULL) {
+    PERF_COUNT(glyph_resident);
+    return pFontData; // 常驻子集不占缓存槽
+  }
+#endif
+#ifdef GLYPH_CACHE_ENABLE
+  pFontData = GlyphCache_Lookup(key, font_size);
+  if (pFontData != NULL) {
+    PERF_COUNT(glyph_cache);
+    return pFontData;
+  }
+#endif
+
+  PERF_TRACE_BEGIN(PERF_TRACE_RESOLVE, 1);
+  if (cp < 0x80) {
+    pFontData = ASCII_FindFont_Flash((char)cp, font_size);
+  } else {
+    pFontData = FlashFont_FindFontCP(cp, font_size);
+  }
+  FontPerf_Fetch(pFontData, cp, font_size);
+  if (pFontData == NULL) {
+    pFontData = FlashFont_FallbackCP(cp, font_size); // 备用字模同样进入缓存
+  }
+
+#ifdef GLYPH_CACHE_ENABLE
+  pFontData = GlyphCache_Insert(key, font_size, pFontData,
+                                FlashFont_GlyphBytes(pFontData, cp, font_size));
+#endif
+  PERF_TRACE_END(PERF_TRACE_RESOLVE, 0);
+  return pFontData;
+}
+
+/**
+ * @brief  在排序索引的[lo, count)区间内查找码点的下界位置
+ * @param  cp: Unicode码点
+ * @param  lo: 查找起点(之前的字符已确定小于等于cp)
+ * @retval 第一个code>=cp的项位置
+ */
+static uint32_t UTF8_LowerBound(uint32_t cp, uint32_t lo) {
+  uint32_t hi = UTF8_SortedCount();
+
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) >> 1;
+    if (UTF8_SortedAt(mid, NULL) < cp) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/**
+ * @brief  批量解析一段非ASCII码点
+ * @param  cps: 码点数组
+ * @param  slots: 各码点对应的输出位置
+ * @param  m: 数量
+ * @param  font_size: 字体大小
+ * @param  glyphs: 输出字模指针数组
+ * @note   排序索引模式下先按码点排序，再沿排序表单向推进，整批只遍历一次索引
+ */
+static void ResolveChunk(uint32_t *cps, uint16_t *slots, uint8_t m,
+                         uint8_t font_size, const uint8_t **glyphs) {
+  uint8_t direct = (UTF8_SortedCount() == 0);
+
+#ifdef FLASH_FONT_RAM_HASH
+  direct |= g_font_hash_ready;
+#endif
+  direct |= (g_ublock_page != NULL);
+
+  if (!direct) {
+    FontPower_Use(); // 沿Flash中的排序索引推进
+  }
+  if (direct) {
+    // 哈希表和分块索引已是O(1)，旧版bin只能逐个查找，排序没有收益
+    for (uint8_t i = 0; i < m; i++) {
+      glyphs[slots[i]] = FlashFont_FindFontCP(cps[i], font_size);
+    }
+    return;
+  }
+
+  // 插入排序(每批最多RESOLVE_CHUNK个)
+  for (uint8_t i = 1; i < m; i++) {
+    uint32_t cp = cps[i];
+    uint16_t slot = slots[i];
+    int8_t j = (int8_t)(i - 1);
+
+    while (j >= 0 && cps[j] > cp) {
+      cps[j + 1] = cps[j];
+      slots[j + 1] = slots[j];
+      j--;
+    }
+    cps[j + 1] = cp;
+    slots[j + 1] = slot;
+  }
+
+  uint32_t lo = 0;
+  uint32_t count = UTF8_SortedCount();
+  for (uint8_t i = 0; i < m; i++) {
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+    if (FontMiss_Find(cps[i]) != 0) {
+      glyphs[slots[i]] = NULL; // 已知缺字，不推进索引
+      continue;
+    }
+#endif
+    int16_t index;
+
+    lo = UTF8_LowerBound(cps[i], lo);
+    if (lo < count && UTF8_SortedAt(lo, &index) == cps[i]) {
+      glyphs[slots[i]] = GetGlyphAddr(index, font_size);
+    } else {
+      glyphs[slots[i]] = NULL;
+#ifdef FLASH_FONT_MISS_CACHE_ENABLE
+      FontMiss_Add(cps[i], 0);
+#endif
+    }
+  }
+}
+
+/**
+ * @brief  一次解析整个UTF8字符串的字模地址
+ * @param  text: UTF8字符串(以0结尾)
+ * @param  font_size: 字体大小(12/16/20/24/32)
+ * @param  glyphs: 输出数组，每个字符一个字模指针，查找失败为NULL
+ * @param  max: glyphs数组容量
+ * @retval 实际解析的字符数(到字符串结束或达到max为止)
+ * @note   ASCII字符返回ASCII字库中的字模(宽度为font_size/2)
+ * @note   初始化检查和字体尺寸只处理一次，中文字符按批与排序索引归并查找
+ */
+uint16_t FlashFont_ResolveString(const char *text, uint8_t font_size,
+                                 const uint8_t **glyphs, uint16_t max) {
+  const uint8_t *p = (const uint8_t *)text;
+  uint32_t cps[RESOLVE_CHUNK];
+  uint16_t slots[RESOLVE_CHUNK];
+  uint16_t n = 0;
+
+  if (!g_font_initialized || text == NULL || glyphs == NULL ||
+      GlyphDesc(font_size) == NULL) {
+    return 0;
+  }
+  FontEpoch_Check();
+
+  PERF_TRACE_BEGIN(PERF_TRACE_RESOLVE, max);
+#if defined(GLYPH_CACHE_ENABLE) && defined(GLYPH_PREFETCH_ENABLE)
+  GlyphPrefetch_Commit(); // 后台预取完成的字模先入缓存，本次解析直接命中
+#endif
+
+#ifdef GLYPH_CACHE_ENABLE
+  if (max > GLYPH_CACHE_SLOTS) {
+    max = GLYPH_CACHE_SLOTS; // 超过槽数时先返回的指针可能被后面的插入淘汰
+  }
+#endif
+
+  while (*p != 0 && n < max) {
+    uint8_t m = 0;
+
+    // 解码一批字符，ASCII直接定位，中文暂存等待批量查找
+    while (*p != 0 && n < max && m < RESOLVE_CHUNK) {
+      uint32_t cp;
+      p += FontText_Decode(p, &cp);
+      if (cp < 0x80) {
+        glyphs[n] = FlashFont_GetGlyphCP(cp, font_size);
+      } else {
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+        glyphs[n] = FlashFont_ResidentFind(cp, font_size);
+        if (glyphs[n] != NULL) {
+          PERF_COUNT(glyph_resident);
+          n++;
+          continue; // 常驻字模，无需查表
+        }
+#endif
+#ifdef GLYPH_CACHE_ENABLE
+        glyphs[n] = GlyphCache_Lookup(FlashFont_GlyphKey(cp, font_size), font_size);
+        if (glyphs[n] != NULL) {
+          PERF_COUNT(glyph_cache);
+          n++;
+          continue; // 缓存命中，无需查表
+        }
+#endif
+        cps[m] = cp;
+        slots[m] = n;
+        m++;
+      }
+      n++;
+    }
+
+    ResolveChunk(cps, slots, m, font_size, glyphs);
+#ifdef PERF_STATS_ENABLE
+    for (uint8_t i = 0; i < m; i++) {
+      FontPerf_Fetch(glyphs[slots[i]], cps[i], font_size);
+    }
+#endif
+    for (uint8_t i = 0; i < m; i++) {
+      if (glyphs[slots[i]] == NULL) {
+        glyphs[slots[i]] = FlashFont_FallbackCP(cps[i], font_size);
+      }
+    }
+
+#ifdef GLYPH_CACHE_ENABLE
+    for (uint8_t i = 0; i < m; i++) {
+      glyphs[slots[i]] = GlyphCache_Insert(
+          FlashFont_GlyphKey(cps[i], font_size), font_size, glyphs[slots[i]],
+          FlashFont_GlyphBytes(glyphs[slots[i]], cps[i], font_size));
+    }
+#endif
+  }
+
+  PERF_TRACE_END(PERF_TRACE_RESOLVE, n);
+  return n;
+}
+
+/**
+ * @brief  从Flash查找UTF8字符对应的字库索引
+ * @param  utf8_text: UTF8字符字符串(1-4字节)
+ * @param  utf8_len: UTF8字符的字节长度(1-4)
+ * @retval 字库索引, 未找到返回-1
+ */
+int16_t UTF8_FindIndex_Flash(const uint8_t *utf8_text, uint8_t utf8_len) {
+  uint32_t cp;
+
+  if (utf8_len < 1 || utf8_len > 4 || utf8_text == NULL) {
+    DEBUG_ERROR("UTF8_FindIndex_Flash: 无效的UTF8参数");
+    return -1;
+  }
+
+  if (FlashFont_DecodeUTF8(utf8_text, &cp) != utf8_len) {
+    return -1; // 长度与编码不一致
+  }
+
+  return FlashFont_FindIndexCP(cp);
+}
+
+/**
+ * @brief  从Flash查找UTF8字符并返回字模数据指针
+ * @param  utf8_text: UTF8字符字符串(1-4字节)
+ * @param  font_size: 字体大小(12/16/20/24/32)
+ * @retval 字模数据指针，查找失败返回NULL
+ * @note   自动识别UTF-8字符长度
+ */
+const uint8_t *UTF8_FindFont_Flash(const uint8_t *utf8_text,
+                                   uint8_t font_size) {
+  uint32_t cp;
+
+  if (utf8_text == NULL) {
+    return NULL;
+  }
+
+  FlashFont_DecodeUTF8(utf8_text, &cp); // 自动获取UTF-8长度并解码
+  return FlashFont_FindFontCP(cp, font_size);
+}
+
+/**
+ * @brief  从Flash查找ASCII字符并返回字模数据指针
+ * @param  c: ASCII字符 (0x20-0x7E)
  * @param  font_size: 字体大小(12/16/20/24/32)
- * @retval Flash地址偏移, 0表示无效尺寸
- */
-static uint32_t GetFontBaseAddr(uint8_t font_size) {
-  switch (font_size) {
-  case 12:
-    return FONT_12x12_ADDR;
-  case 16:
-    return FONT_16x16_ADDR;
-  case 20:
-    return FONT_20x20_ADDR;
-  case 24:
-    return FONT_24x24_ADDR;
-  case 32:
-    return FONT_32x32_ADDR;
-  default:
-    return 0;
+ * @retval 字模数据指针，查找失败返回NULL
+ */
+const uint8_t *ASCII_FindFont_Flash(char c, uint8_t font_size) {
+  const FontDesc_t *d;
+  uint32_t code = (uint8_t)c;
+
+  if (!g_font_initialized) {
+    DEBUG_ERROR("ASCII_FindFont_Flash: 字库未初始化");
+    return NULL;
   }
-}
 
-/*******************************************************************************
- *                              导出函数实现
- ******************************************************************************/
+  // 字号对应的ASCII段由初始化时解析的文件头或目录给出
+  d = AsciiDesc(font_size);
+  if (d == NULL || code < d->first || code - d->first >= d->count) {
+    return NULL;
+  }
+
+  return d->data + (code - d->first) * d->stride;
+}
 
+#ifdef FLASH_FONT_METRICS_ENABLE
 /**
- * @brief  初始化Flash字库驱动
- * @retval 0-成功, <0-失败
- * @note   前提：QSPI已开启内存映射模式，字库已预烧录
+ * @brief  二分查找字偶距表
+ * @retval 左字符advance的调整量，表中没有该字符对返回0
  */
-int8_t FlashFont_Init(void) {
-  const FontWriteFlag_t *flag;
-  // 通过内存映射读取标志位
-  flag = (const FontWriteFlag_t *)(W25Qxx_Mem_Addr + FONT_FLAG_ADDR);
-
-  // 验证标志位魔数
-  if (flag->magic != FLAG_MAGIC) {
-    DEBUG_ERROR("字库标志无效，字库可能未烧录");
-    return -1;
-  }
+static int8_t FontKern_Find(const FontDesc_t *d, uint8_t left, uint8_t right) {
+  const FontKernPair_t *pairs = (const FontKernPair_t *)d->data;
+  uint16_t key = (uint16_t)((left << 8) | right);
+  uint32_t lo = 0, hi = d->count;
 
-  g_font_initialized = 1;
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) >> 1;
+    uint16_t k = (uint16_t)((pairs[mid].left << 8) | pairs[mid].right);
 
-  return FLASHFONT_OK;
+    if (k == key) {
+      return pairs[mid].adjust;
+    }
+    if (k < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return 0;
 }
+#endif
 
 /**
- * @brief  获取指定字体每字符占用的字节数
- * @param  font_size: 字体大小(12/16/20/24/32)
- * @retval >=0: 每字符字节数, <0: 无效字体大小
+ * @brief  获取ASCII字符的比例宽度
+ * @param  c: ASCII字符
+ * @param  next: 同一行的下一个字符(用于字偶距)，没有时传0
+ * @param  font_size: 字体大小
+ * @param  x: 输出从字模单元第几列开始显示，可为NULL
+ * @retval 占用列数，没有字宽表时为font_size/2(x为0)
  */
-int16_t FlashFont_BytesPerChar(uint8_t font_size) {
-  switch (font_size) {
-  case 12:
-    return 24;
-  case 16:
-    return 32;
-  case 20:
-    return 60;
-  case 24:
-    return 72;
-  case 32:
-    return 128;
-  default:
-    return -1;
+uint8_t FlashFont_AsciiAdvance(char c, char next, uint8_t font_size,
+                               int8_t *x) {
+#ifdef FLASH_FONT_METRICS_ENABLE
+  const FontDesc_t *d = (font_size <= FLASH_FONT_MAX_SIZE)
+                            ? FontDesc_Use(g_ascii_metrics_desc[font_size])
+                            : NULL;
+  const FontDesc_t *kern;
+  uint32_t code = (uint8_t)c;
+
+  if (d != NULL && code >= d->first && code - d->first < d->count) {
+    const FontAsciiMetric_t *m =
+        (const FontAsciiMetric_t *)d->data + (code - d->first);
+    int16_t advance = m->advance;
+
+    if (x != NULL) {
+      *x = m->x;
+    }
+    if (next != 0 &&
+        (kern = FontDesc_Use(g_ascii_kern_desc[font_size])) != NULL) {
+      advance += FontKern_Find(kern, (uint8_t)c, (uint8_t)next);
+    }
+    return (advance > 0) ? (uint8_t)advance : 1;
+  }
+#else
+  (void)c;
+  (void)next;
+#endif
+  if (x != NULL) {
+    *x = 0;
   }
+  return font_size / 2;
 }
-/*******************************************************************************
- *                          GB2312对照表Flash访问实现
- ******************************************************************************/
 
+#ifdef FLASH_FONT_RESIDENT_ENABLE
 /**
- * @brief  从Flash查找汉字对应的字库索引(线性查找)
- * @param  text: 汉字字符串(GBK编码，2字节)
- * @retval 字库索引(0-7463), 未找到返回-1
- * @note   使用线性查找，时间复杂度O(n)
- * @note   若需要高性能，可改用二分查找
+ * @brief  重新建立常驻字模子集
+ * @param  chars: UTF8字符列表，NULL表示清空子集
+ * @retval 0-全部常驻, 1-预算或项数不足, <0-字库未初始化
+ * @note   按列表顺序拷贝，索引按键值插入保持有序，只在初始化或切换列表时执行
  */
-int16_t GB2312_FindIndex_Flash(const char *text) {
-  uint16_t search_gbk;
-  const uint8_t *pData;
-  const GB2312_TableEntry_t *pEntry;
+int8_t FlashFont_ResidentLoad(const char *chars) {
+  static const uint8_t sizes[] = FLASH_FONT_RESIDENT_SIZES;
+  const uint8_t *p = (const uint8_t *)chars;
+  uint32_t used = 0;
 
+  g_res_chars = chars;
+  g_res_count = 0;
+  memset(&g_res_stats, 0, sizeof(g_res_stats));
+  g_res_stats.budget = g_res_budget;
   if (!g_font_initialized) {
-    DEBUG_ERROR("GB2312_FindIndex_Flash: 字库未初始化");
     return -1;
   }
+  if (p == NULL) {
+    return FLASHFONT_OK;
+  }
 
-  // 将输入字符转为GBK码
-  search_gbk = ((uint16_t)text[0] << 8) | (uint8_t)text[1];
+  while (*p != 0) {
+    uint32_t cp;
 
-  // 计算数据区起始地址(内存映射)
-  pData = (const uint8_t *)(W25Qxx_Mem_Addr + GB2312_TABLE_ADDR +
-                            12);
-  pEntry = (const GB2312_TableEntry_t *)pData;
+    p += FlashFont_DecodeUTF8(p, &cp);
+    for (uint8_t i = 0; i < sizeof(sizes); i++) {
+      uint32_t key = FontResident_Key(cp, sizes[i]);
+      uint16_t pos = FontResident_LowerBound(key);
+      const uint8_t *src;
+      uint16_t bytes, need;
 
-  // 线性查找
-  for (uint32_t i = 0; i < 7464; i++) {
-    if (pEntry[i].gbk_code == 0xFFFF) {
-      break; // 遇到特殊标记，提前结束
-    }
+      if (pos < g_res_count && g_res_index[pos].key == key) {
+        continue; // 重复字符
+      }
+      src = (cp < 0x80) ? ASCII_FindFont_Flash((char)cp, sizes[i])
+                        : FlashFont_FindFontCP(cp, sizes[i]);
+      if (src == NULL) {
+        g_res_stats.missing++;
+        continue;
+      }
+      bytes = FlashFont_GlyphBytes(src, cp, sizes[i]);
+      need = (bytes + 3) & ~3U; // 保持每个字模4字节对齐
+      if (g_res_count >= FLASH_FONT_RESIDENT_MAX ||
+          used + need > g_res_budget) {
+        g_res_stats.dropped++;
+        continue;
+      }
 
-    if (pEntry[i].gbk_code == search_gbk) {
-      return pEntry[i].index; // 找到
+      memmove(&g_res_index[pos + 1], &g_res_index[pos],
+              (g_res_count - pos) * sizeof(g_res_index[0]));
+      g_res_index[pos].key = key;
+      g_res_index[pos].ofs = (uint16_t)used;
+      g_res_index[pos].bytes = bytes;
+      memcpy(&g_res_pool[used], src, bytes);
+      used += need;
+      g_res_count++;
     }
   }
 
-  return -1; // 未找到
+  g_res_stats.glyphs = g_res_count;
+  g_res_stats.bytes = used;
+  return (g_res_stats.dropped != 0) ? 1 : FLASHFONT_OK;
 }
 
 /**
- * @brief  从Flash查找汉字并返回字模数据指针
- * @param  text: 汉字字符串(GBK编码，2字节)
- * @param  font_size: 字体大小(12/16/20/24/32)
- * @retval 字模数据指针，查找失败返回NULL
+ * @brief  在常驻子集中查找字模
+ * @param  cp: Unicode码点，<0x80为ASCII
+ * @param  font_size: 字体大小
+ * @retval 字模数据指针，不在子集中返回NULL
  */
-const uint8_t *GB2312_FindFont_Flash(const char *text, uint8_t font_size) {
-  int16_t index = GB2312_FindIndex_Flash(text);
-  if (index < 0) {
-    return NULL;
+ITCM_CODE const uint8_t *FlashFont_ResidentFind(uint32_t cp,
+                                                uint8_t font_size) {
+  uint32_t key = FontResident_Key(cp, font_size);
+  uint16_t pos;
+
+  if (g_res_count == 0 || FlashFont_GlyphKey(cp, font_size) != cp) {
+    return NULL; // 常驻子集按字体族0建立
+  }
+  pos = FontResident_LowerBound(key);
+  if (pos < g_res_count && g_res_index[pos].key == key) {
+    return &g_res_pool[g_res_index[pos].ofs];
   }
+  return NULL;
+}
 
-  uint32_t font_offset = GetFontBaseAddr(font_size);
-  uint16_t bytes_per_char = FlashFont_BytesPerChar(font_size);
+/**
+ * @brief  读取常驻子集统计
+ * @param  stats: 输出统计信息
+ */
+void FlashFont_ResidentGetStats(FontResidentStats_t *stats) {
+  if (stats != NULL) {
+    *stats = g_res_stats;
+  }
+}
 
-  if (font_offset == 0) {
-    return NULL;
+/**
+ * @brief  设置常驻字模数据的运行时预算并按原列表重建子集
+ * @param  bytes: 字节数，0或超过 FLASH_FONT_RESIDENT_BYTES 时为 FLASH_FONT_RESIDENT_BYTES
+ * @retval 生效的预算
+ * @note   字库未初始化时只记录预算，FlashFont_Init() 时按新预算建立
+ */
+uint16_t FlashFont_ResidentSetLimit(uint16_t bytes) {
+  if (bytes == 0 || bytes > FLASH_FONT_RESIDENT_BYTES) {
+    bytes = FLASH_FONT_RESIDENT_BYTES;
   }
+  g_res_budget = bytes;
+  FlashFont_ResidentLoad(g_res_chars);
+  return bytes;
+}
 
-  return (const uint8_t *)(W25Qxx_Mem_Addr + font_offset + 18 +
-                           index * bytes_per_char);
+#ifdef PERF_MEMORY_ENABLE
+/**
+ * @brief  填写常驻字模子集的内存占用
+ * @param  entry: 输出
+ */
+void FlashFont_ResidentGetMemory(PerfMemory_Entry_t *entry) {
+  entry->name = "resident";
+  entry->unit = "byte";
+  entry->base = g_res_pool;
+  entry->bytes = sizeof(g_res_pool) + sizeof(g_res_index);
+  entry->capacity = FLASH_FONT_RESIDENT_BYTES;
+  entry->limit = g_res_budget;
+  entry->used = g_res_stats.bytes;
+  entry->peak = g_res_stats.bytes; // 只在重建时改变
+  entry->hits = 0;
+  entry->misses = g_res_stats.dropped; // 预算或项数不足未能常驻的字模数
+  entry->resizable = 1;
 }
+#endif
+#endif /* FLASH_FONT_RESIDENT_ENABLE */
 
-/*******************************************************************************
- *                          utf8对照表Flash访问实现
- ******************************************************************************/
+#ifdef FLASH_FONT_BOX_ENABLE
 /**
- * @brief  从Flash查找UTF8字符对应的字库索引(线性查找)
- * @param  utf8_text: UTF8字符字符串(1-4字节)
- * @param  utf8_len: UTF8字符的字节长度(1-4)
- * @retval 字库索引, 未找到返回-1
+ * @brief  按字库索引取笔画外框
+ * @retval 外框指针，没有外框表或越界返回NULL
  */
-int16_t UTF8_FindIndex_Flash(const uint8_t *utf8_text, uint8_t utf8_len) {
-  const uint8_t *pData;
-  const UTF8_TableEntry_t *pEntry;
+static const FontGlyphBox_t *GetGlyphBox(uint8_t font_size, int16_t index) {
+  const FontDesc_t *d;
 
-  if (!g_font_initialized) {
-    DEBUG_ERROR("UTF8_FindIndex_Flash: 字库未初始化");
-    return -1;
+  if (!g_font_initialized || font_size > FLASH_FONT_MAX_SIZE || index < 0) {
+    return NULL;
+  }
+  d = FontDesc_Use(g_glyph_box_desc[font_size]);
+  if (d == NULL || (uint32_t)index >= d->count) {
+    return NULL;
   }
+  return (const FontGlyphBox_t *)d->data + index;
+}
 
-  if (utf8_len < 1 || utf8_len > 4 || utf8_text == NULL) {
-    DEBUG_ERROR("UTF8_FindIndex_Flash: 无效的UTF8参数");
-    return -1;
+/**
+ * @brief  按码点获取汉字笔画外框
+ * @param  cp: Unicode码点
+ * @param  font_size: 字体大小
+ * @retval 外框指针(QSPI内存映射区)，该字号没有外框表或字符不存在返回NULL
+ */
+const FontGlyphBox_t *FlashFont_GetGlyphBox(uint32_t cp, uint8_t font_size) {
+  if (cp < 0x80 || font_size > FLASH_FONT_MAX_SIZE ||
+      g_glyph_box_desc[font_size] == NULL) {
+    return NULL; // 没有外框表时不做码点查找
   }
+  return GetGlyphBox(font_size, FlashFont_FindIndexCP(cp));
+}
 
-  // 计算数据区起始地址(内存映射)
-  pData = (const uint8_t *)(W25Qxx_Mem_Addr + UTF8_TABLE_ADDR +
-                            12);
-  pEntry = (const UTF8_TableEntry_t *)pData;
-
-  // 线性查找
-  for (uint32_t i = 0; i < 7464; i++) {
-    // 检查UTF8长度是否匹配
-    if (pEntry[i].utf8_len == utf8_len) {
-      // 比较UTF8编码
-      uint8_t match = 1;
-      for (uint8_t j = 0; j < utf8_len; j++) {
-        if (pEntry[i].utf8[j] != utf8_text[j]) {
-          match = 0;
-          break;
-        }
-      }
-      if (match) {
-        return pEntry[i].index; // 找到
-      }
-    }
+/**
+ * @brief  按GBK编码获取汉字笔画外框
+ * @param  text: 汉字字符串(GBK编码，2字节)
+ * @param  font_size: 字体大小
+ * @retval 外框指针，没有外框表或字符不存在返回NULL
+ */
+const FontGlyphBox_t *GB2312_FindGlyphBox_Flash(const char *text,
+                                                uint8_t font_size) {
+  if (font_size > FLASH_FONT_MAX_SIZE || g_glyph_box_desc[font_size] == NULL) {
+    return NULL;
   }
+  return GetGlyphBox(font_size, GB2312_FindIndex_Flash(text));
+}
+#endif
 
-  return -1; // 未找到
+#ifdef FLASH_FONT_AA_ENABLE
+/**
+ * @brief  由抗锯齿段和索引计算字模地址并输出位深
+ * @param  index: FONT_IDX_TABLE时为字库索引，FONT_IDX_CODE时为字符编码
+ * @retval 字模数据指针，越界返回NULL
+ */
+static const uint8_t *GetGlyphAddrAA(const FontDesc_t *d, int32_t index,
+                                     uint8_t *bpp) {
+  if (index < 0 || (d = FontDesc_Use(d)) == NULL) {
+    return NULL;
+  }
+  if (d->index_type == FONT_IDX_CODE) {
+    index -= d->first;
+  }
+  if (index < 0 || (uint32_t)index >= d->count) {
+    return NULL;
+  }
+  if (bpp != NULL) {
+    *bpp = (d->format == FONT_FMT_4BPP_ROW) ? 4 : 2;
+  }
+  return d->data + (uint32_t)index * d->stride;
 }
 
 /**
- * @brief  获取UTF-8字符的字节长度
- * @note   内部私有函数
+ * @brief  按码点获取抗锯齿字模
+ * @param  cp: Unicode码点，<0x80时取ASCII抗锯齿字模
+ * @param  font_size: 字体大小
+ * @param  bpp: 输出每像素位数(2或4)
+ * @retval 字模数据指针，没有抗锯齿段或字符不存在返回NULL
  */
-static uint8_t GetUTF8CharLen(const uint8_t *pText) {
-  if (pText == NULL)
-    return 0;
+const uint8_t *FlashFont_GetGlyphAA(uint32_t cp, uint8_t font_size,
+                                    uint8_t *bpp) {
+  if (!g_font_initialized || font_size > FLASH_FONT_MAX_SIZE) {
+    return NULL;
+  }
+  if (cp < 0x80) {
+    return GetGlyphAddrAA(g_ascii_aa_desc[font_size], (int32_t)cp, bpp);
+  }
+  if (g_glyph_aa_desc[font_size] == NULL) {
+    return NULL; // 没有抗锯齿段时不做码点查找
+  }
+  return GetGlyphAddrAA(g_glyph_aa_desc[font_size], FlashFont_FindIndexCP(cp),
+                        bpp);
+}
+
+/**
+ * @brief  按GBK编码获取汉字抗锯齿字模
+ * @param  text: 汉字字符串(GBK编码，2字节)
+ * @param  font_size: 字体大小
+ * @param  bpp: 输出每像素位数(2或4)
+ * @retval 字模数据指针，没有抗锯齿段或字符不存在返回NULL
+ */
+const uint8_t *GB2312_FindFontAA_Flash(const char *text, uint8_t font_size,
+                                       uint8_t *bpp) {
+  if (!g_font_initialized || font_size > FLASH_FONT_MAX_SIZE ||
+      g_glyph_aa_desc[font_size] == NULL) {
+    return NULL;
+  }
+  return GetGlyphAddrAA(g_glyph_aa_desc[font_size],
+                        GB2312_FindIndex_Flash(text), bpp);
+}
+#endif
 
-  uint8_t first_byte = *pText;
+/**
+ * @brief  按编号获取RGB565图片
+ * @param  index: 图片编号(fontbin_tool.py --image 的参数顺序)
+ * @param  width/height: 输出图片尺寸，可为NULL
+ * @retval 像素数据指针(QSPI内存映射区)，没有图片段或编号越界返回NULL
+ */
+const uint16_t *FlashFont_GetImage(uint16_t index, uint16_t *width,
+                                   uint16_t *height) {
+  const FontDesc_t *d;
+  const FontImage_t *img;
 
-  // 根据UTF-8编码规则判断字符长度
-  if ((first_byte & 0x80) == 0x00) {
-    return 1; // 0xxxxxxx - ASCII字符
-  } else if ((first_byte & 0xE0) == 0xC0) {
-    return 2; // 110xxxxx - 2字节UTF-8
-  } else if ((first_byte & 0xF0) == 0xE0) {
-    return 3; // 1110xxxx - 3字节UTF-8
-  } else if ((first_byte & 0xF8) == 0xF0) {
-    return 4; // 11110xxx - 4字节UTF-8
+  if (!g_font_initialized) {
+    return NULL;
+  }
+  d = FlashFont_GetDesc(FONT_SEC_IMAGE, 0);
+  if (d == NULL || index >= d->count) {
+    return NULL;
   }
+  img = (const FontImage_t *)d->data + index;
+  if (width != NULL) {
+    *width = img->width;
+  }
+  if (height != NULL) {
+    *height = img->height;
+  }
+  return (const uint16_t *)(d->data + img->offset);
+}
+
+/**
+ * @brief  按编号获取调色板图片
+ * @param  index: 图片编号(fontbin_tool.py --indexed 的参数顺序)
+ * @param  palette: 输出RGB565调色板
+ * @param  colors/width/height: 输出颜色数和图片尺寸，可为NULL
+ * @param  bpp: 输出每像素位数
+ * @retval 像素数据指针(QSPI内存映射区)，没有调色板图片段或编号越界返回NULL
+ */
+const uint8_t *FlashFont_GetIndexedImage(uint16_t index,
+                                         const uint16_t **palette,
+                                         uint16_t *colors, uint16_t *width,
+                                         uint16_t *height, uint8_t *bpp) {
+  const FontDesc_t *d;
+  const FontIndexedImage_t *img;
+  const uint8_t *pal;
 
-  return 1; // 默认返回1
+  if (!g_font_initialized) {
+    return NULL;
+  }
+  d = FlashFont_GetDesc(FONT_SEC_INDEXED_IMAGE, 0);
+  if (d == NULL || index >= d->count) {
+    return NULL;
+  }
+  img = (const FontIndexedImage_t *)d->data + index;
+  pal = d->data + img->offset;
+  if (palette != NULL) {
+    *palette = (const uint16_t *)pal;
+  }
+  if (colors != NULL) {
+    *colors = img->colors;
+  }
+  if (width != NULL) {
+    *width = img->width;
+  }
+  if (height != NULL) {
+    *height = img->height;
+  }
+  if (bpp != NULL) {
+    *bpp = img->bpp;
+  }
+  return pal + FONT_INDEXED_PIXELS(img);
 }
 
 /**
- * @brief  从Flash查找UTF8字符并返回字模数据指针
- * @param  utf8_text: UTF8字符字符串(1-4字节)
- * @param  font_size: 字体大小(12/16/20/24/32)
- * @retval 字模数据指针，查找失败返回NULL
- * @note   自动识别UTF-8字符长度
+ * @brief  按编号获取行程压缩图片
+ * @param  index: 图片编号(fontbin_tool.py --rle 的参数顺序)
+ * @param  size: 输出压缩数据字节数，可为NULL
+ * @param  width/height: 输出图片尺寸，可为NULL
+ * @retval 压缩数据指针(QSPI内存映射区)，没有行程压缩图片段或编号越界返回NULL
  */
-const uint8_t *UTF8_FindFont_Flash(const uint8_t *utf8_text,
-                                   uint8_t font_size) {
-  uint8_t utf8_len = GetUTF8CharLen(utf8_text); // 自动获取UTF-8长度
-  int16_t index = UTF8_FindIndex_Flash(utf8_text, utf8_len);
+const uint16_t *FlashFont_GetRleImage(uint16_t index, uint32_t *size,
+                                      uint16_t *width, uint16_t *height) {
+  const FontDesc_t *d;
+  const FontRleImage_t *img;
 
-  if (index < 0) {
+  if (!g_font_initialized) {
+    return NULL;
+  }
+  d = FlashFont_GetDesc(FONT_SEC_RLE_IMAGE, 0);
+  if (d == NULL || index >= d->count) {
     return NULL;
   }
+  img = (const FontRleImage_t *)d->data + index;
+  if (size != NULL) {
+    *size = img->size;
+  }
+  if (width != NULL) {
+    *width = img->width;
+  }
+  if (height != NULL) {
+    *height = img->height;
+  }
+  return (const uint16_t *)(d->data + img->offset);
+}
 
-  uint32_t font_offset = GetFontBaseAddr(font_size);
-  uint16_t bytes_per_char = FlashFont_BytesPerChar(font_size);
+/**
+ * @brief  按编号获取JPEG图片
+ * @param  index: 图片编号(fontbin_tool.py --jpeg 的参数顺序)
+ * @param  size: 输出JPEG数据字节数
+ * @param  width/height: 输出图片尺寸，可为NULL
+ * @retval JPEG数据指针(QSPI内存映射区)，没有JPEG段或编号越界返回NULL
+ */
+const uint8_t *FlashFont_GetJpeg(uint16_t index, uint32_t *size,
+                                 uint16_t *width, uint16_t *height) {
+  const FontDesc_t *d;
+  const FontJpeg_t *jpeg;
 
-  if (font_offset == 0) {
+  if (!g_font_initialized) {
+    return NULL;
+  }
+  d = FlashFont_GetDesc(FONT_SEC_JPEG, 0);
+  if (d == NULL || index >= d->count) {
     return NULL;
   }
+  jpeg = (const FontJpeg_t *)d->data + index;
+  if (size != NULL) {
+    *size = jpeg->size;
+  }
+  if (width != NULL) {
+    *width = jpeg->width;
+  }
+  if (height != NULL) {
+    *height = jpeg->height;
+  }
+  return d->data + jpeg->offset;
+}
+
+/**
+ * @brief  查找某种语言的字符串表或字符集
+ * @param  type: FONT_SEC_STRINGS 或 FONT_SEC_STRING_CHARS
+ * @retval 段描述指针，没有该语言返回NULL
+ * @note   各语言的目录项类型相同，按first(语言编号)区分
+ */
+static const FontDesc_t *FontString_Desc(uint8_t type, uint8_t lang) {
+  for (uint8_t i = 0; i < g_font_desc_count; i++) {
+    if (g_font_desc[i].type == type && g_font_desc[i].first == lang) {
+      return &g_font_desc[i];
+    }
+  }
+  return NULL;
+}
 
-  return (const uint8_t *)(W25Qxx_Mem_Addr + font_offset + 18 +
-                           index * bytes_per_char);
+/**
+ * @brief  选择界面字符串的语言
+ * @param  lang: 语言编号，0为默认语言
+ * @retval 0-成功, -1-字库中没有该语言的字符串表
+ */
+int8_t FlashFont_SetLanguage(uint8_t lang) {
+  if (!g_font_initialized ||
+      FontString_Desc(FONT_SEC_STRINGS, lang) == NULL) {
+    return -1;
+  }
+  g_font_lang = lang;
+  return FLASHFONT_OK;
 }
 
 /**
- * @brief  从Flash查找ASCII字符并返回字模数据指针
- * @param  c: ASCII字符 (0x20-0x7E)
- * @param  font_size: 字体大小(12/16/20/24/32)
- * @retval 字模数据指针，查找失败返回NULL
+ * @brief  获取当前语言编号
  */
-const uint8_t *ASCII_FindFont_Flash(char c, uint8_t font_size) {
-  int8_t font_index = -1;
-  const ASCII_FontHeader_t *header;
-  const ASCII_FontInfo_t *info;
-  uint32_t bytes_per_char;
-  uint32_t char_offset;
+uint8_t FlashFont_GetLanguage(void) { return g_font_lang; }
+
+/**
+ * @brief  按编号获取当前语言的界面字符串
+ * @param  id: 字符串编号
+ * @param  bytes: 输出字节数(不含结尾的'\0')，可为NULL
+ * @retval 字符串指针(QSPI内存映射区)，当前语言没有译文时取语言0，都没有返回NULL
+ */
+const char *FlashFont_GetString(uint16_t id, uint32_t *bytes) {
+  uint8_t lang = g_font_lang;
 
   if (!g_font_initialized) {
-    DEBUG_ERROR("ASCII_FindFont_Flash: 字库未初始化");
     return NULL;
   }
+  for (;;) {
+    const FontDesc_t *d =
+        FontDesc_Use(FontString_Desc(FONT_SEC_STRINGS, lang));
 
-  // 范围检查 (仅支持可见字符 0x20 ' ' 到 0x7E '~')
-  if (c < 0x20 || c > 0x7E) {
-    return NULL;
+    if (d != NULL && id < d->count) {
+      const FontString_t *str = (const FontString_t *)d->data + id;
+
+      if (str->bytes != 0) {
+        if (bytes != NULL) {
+          *bytes = str->bytes;
+        }
+        return (const char *)d->data + str->offset;
+      }
+    }
+    if (lang == 0) {
+      return NULL;
+    }
+    lang = 0; // 未翻译的字符串显示默认语言
   }
+}
 
-  // 根据字体大小映射到文件中的索引
-  // 映射关系参考 ascii_fonts_info.txt
-  switch (font_size) {
-  case 32:
-    font_index = 0;
-    break; // 32x16
-  case 24:
-    font_index = 1;
-    break; // 24x12
-  case 20:
-    font_index = 2;
-    break; // 20x10
-  case 16:
-    font_index = 3;
-    break; // 16x8
-  case 12:
-    font_index = 4;
-    break; // 12x6
-  default:
-    DEBUG_ERROR("ASCII_FindFont_Flash: 不支持的字体大小");
+/**
+ * @brief  获取一种语言的字符串用到的全部字符
+ * @param  lang: 语言编号
+ * @retval UTF-8字符串(QSPI内存映射区)，出现次数多的在前；没有该语言的字符集段返回NULL
+ */
+const char *FlashFont_GetLanguageChars(uint8_t lang) {
+  const FontDesc_t *d;
+
+  if (!g_font_initialized) {
     return NULL;
   }
+  d = FontDesc_Use(FontString_Desc(FONT_SEC_STRING_CHARS, lang));
+  return (d != NULL) ? (const char *)d->data : NULL;
+}
+
+/**
+ * @brief  FNV-1a 散列，与 fontbuild.py 的 fnv1a() 相同
+ */
+static uint32_t FontStamp_Hash(uint32_t h, const uint8_t *p, uint32_t n) {
+  while (n--) {
+    h = (h ^ *p++) * 0x01000193U;
+  }
+  return h;
+}
+
+/**
+ * @brief  把段在分区内的偏移、项数、步长和格式计入校验，段不存在时计入4个0
+ */
+static uint32_t FontStamp_Desc(uint32_t h, const FontDesc_t *d) {
+  uint32_t v[4] = {0, 0, 0, 0};
 
-  // 获取文件头指针 (内存映射)
-  header = (const ASCII_FontHeader_t *)(W25Qxx_Mem_Addr + ASCII_FONTS_ADDR);
+  if (d != NULL) {
+#ifdef FLASH_FONT_MIRROR_ENABLE
+    v[0] = (uint32_t)(FontMirror_Flash(d->data) - FontPtr(0)); // 按Flash中的位置计算，与是否镜像无关
+#else
+    v[0] = (uint32_t)(d->data - FontPtr(0));
+#endif
+    v[1] = d->count;
+    v[2] = d->stride;
+    v[3] = d->format;
+  }
+  return FontStamp_Hash(h, (const uint8_t *)v, sizeof(v));
+}
 
-  // 验证魔数
-  if (header->magic != ASCII_MAGIC) {
-    DEBUG_ERROR("ASCII_FindFont_Flash: ASCII字库文件损坏");
-    return NULL;
+/**
+ * @brief  计算预解析文本串所依赖的字库内容的校验
+ * @param  font_size: 字体大小
+ * @retval 校验值，字库未初始化返回0
+ * @note   包括UTF8排序索引(字符到字库索引)、该字号汉字/ASCII字模段的位置和格式，
+ *         以及字宽表、字偶距表的内容；排序索引较大，只在初始化后第一次调用时读取
+ */
+uint32_t FlashFont_RunStamp(uint8_t font_size) {
+  const FontDesc_t *d;
+  uint32_t h;
+
+  if (!g_font_initialized) {
+    return 0;
+  }
+  if (!g_run_index_valid) {
+    FontPower_Use();
+    g_run_index_stamp =
+        (g_utf8_packed != NULL)
+            ? FontStamp_Hash(0x811C9DC5U, (const uint8_t *)g_utf8_packed,
+                             g_utf8_packed_count * sizeof(uint32_t))
+            : FontStamp_Hash(0x811C9DC5U, (const uint8_t *)g_utf8_sorted,
+                             (g_utf8_sorted != NULL) ? g_utf8_sorted_count * sizeof(UTF8_SortedEntry_t) : 0);
+    g_run_index_valid = 1;
+  }
+  h = FontStamp_Desc(g_run_index_stamp, GlyphDesc(font_size));
+  h = FontStamp_Desc(h, AsciiDesc(font_size));
+#ifdef FLASH_FONT_METRICS_ENABLE
+  for (uint8_t i = 0; i < 2; i++) { // 字宽表、字偶距表决定了预解析的advance
+    d = (font_size > FLASH_FONT_MAX_SIZE) ? NULL
+        : (i == 0) ? FontDesc_Use(g_ascii_metrics_desc[font_size])
+                   : FontDesc_Use(g_ascii_kern_desc[font_size]);
+    h = FontStamp_Desc(h, d);
+    if (d != NULL) {
+      h = FontStamp_Hash(h, d->data, d->count * d->stride);
+    }
   }
+#else
+  d = NULL; // 不使用字宽表时与没有字宽表的字库一致
+  h = FontStamp_Desc(FontStamp_Desc(h, d), d);
+#endif
+  return (h != 0) ? h : 1;
+}
 
-  // 获取对应字体的元数据
-  info = &header->fonts[font_index];
+/**
+ * @brief  按预解析的偏移获取字模(经过字模缓存)
+ * @param  ref: 预解析字形
+ * @param  font_size: 字体大小
+ * @retval 字模数据指针，字库中没有该字符返回NULL
+ * @note   调用者先用 FlashFont_RunStamp() 确认预解析结果与当前字库一致；不查对照表
+ */
+ITCM_CODE const uint8_t *FlashFont_GetGlyphRef(const FontGlyphRef_t *ref, uint8_t font_size) {
+  const FontDesc_t *d = (ref->cp < 0x80) ? AsciiDesc(font_size) : GlyphDesc(font_size);
+  const uint8_t *pFontData;
 
-  // 计算单字符字节数 (总大小 / 字符数95)
-  bytes_per_char = info->size / 95;
+  if (d == NULL) {
+    return NULL;
+  }
+  if (ref->offset == FONT_GLYPH_REF_NONE) {
+    return FlashFont_FallbackCP(ref->cp, font_size); // 生成时字库中就没有
+  }
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+  if (ref->cp >= 0x80) {
+    pFontData = FlashFont_ResidentFind(ref->cp, font_size);
+    if (pFontData != NULL) {
+      PERF_COUNT(glyph_resident);
+      return pFontData; // 与 FlashFont_ResolveString() 相同，常驻字模不占缓存槽
+    }
+  }
+#endif
+#ifdef GLYPH_CACHE_ENABLE
+  pFontData = GlyphCache_Lookup(FlashFont_GlyphKey(ref->cp, font_size), font_size);
+  if (pFontData != NULL) {
+    PERF_COUNT(glyph_cache);
+    return pFontData;
+  }
+#endif
+  pFontData = d->data + ref->offset;
+  FontPerf_Fetch(pFontData, ref->cp, font_size);
+#ifdef GLYPH_CACHE_ENABLE
+  pFontData = GlyphCache_Insert(FlashFont_GlyphKey(ref->cp, font_size), font_size, pFontData,
+                                FlashFont_GlyphBytes(pFontData, ref->cp, font_size));
+#endif
+  return pFontData;
+}
 
-  // 计算字符在数据块中的偏移
-  char_offset = (c - 0x20) * bytes_per_char;
+/**
+ * @brief  在设备上计算码点的预解析偏移
+ * @param  cp: Unicode码点
+ * @param  font_size: 字体大小
+ * @retval 字模相对所在字模段起始的偏移(FontGlyphRef_t.offset)，没有该字符返回FONT_GLYPH_REF_NONE
+ * @note   与 fontbuild.py --runs 的结果相同，校验值一致期间可交给 FlashFont_GetGlyphRef()
+ */
+uint32_t FlashFont_GlyphRefOffset(uint32_t cp, uint8_t font_size) {
+  const FontDesc_t *d;
+  const uint8_t *pFontData;
 
-  // 返回绝对地址: 基地址 + 文件基址 + 字体数据偏移 + 字符偏移
-  return (const uint8_t *)(W25Qxx_Mem_Addr + ASCII_FONTS_ADDR + info->offset +
-                           char_offset);
+  if (!g_font_initialized) {
+    return FONT_GLYPH_REF_NONE;
+  }
+  FontEpoch_Check();
+  if (cp < 0x80) {
+    d = AsciiDesc(font_size);
+    if (d == NULL || cp < d->first || cp - d->first >= d->count) {
+      return FONT_GLYPH_REF_NONE;
+    }
+    return (cp - d->first) * d->stride;
+  }
+  d = GlyphDesc(font_size);
+  pFontData = GlyphDesc_Addr(d, FlashFont_FindIndexCP(cp));
+  return (pFontData != NULL) ? (uint32_t)(pFontData - d->data) : FONT_GLYPH_REF_NONE;
 }
 
 #endif // FLASH_FONT_ENABLE
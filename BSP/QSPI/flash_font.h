@@ -18,6 +18,55 @@
  * ├──────────────────┼──────────────┼──────────────────┤
  * │ merged_fonts.bin │ 0x91D00000   │ 汉字、英文与数字 全家桶 │
  * └──────────────────┴──────────────┴──────────────────┘
+ *
+ * 字库目录(TOC):
+ * - fontbin_tool.py 在分区偏移FONT_TOC_ADDR处写入带版本号的目录，
+ *   逐段描述类型、字号、宽高、字模格式、步长、数量和索引方式
+ * - FlashFont_Init() 只解析一次目录，生成RAM描述表，之后的查找不再访问文件头
+ * - 定义 FLASH_FONT_LAZY_INIT 时哈希表和常驻子集由 FlashFont_Idle() 在主循环中分步建立，
+ *   上电后不等索引即可显示，建完前查找使用Flash中的排序/分块索引
+ * - 没有目录的旧bin文件按下方固定布局解析各段文件头，结果相同
+ *
+ * A/B双分区:
+ * - A区 0x1D00000、B区 0x1A00000，各3MB，分区最后4KB扇区存放分区头(序号)
+ * - FlashFont_Init() 选择序号最新的有效分区；A区没有分区头但字库标志有效时
+ *   视为序号0，兼容直接烧录的旧bin文件
+ * - FlashFont_Bank* 在后台改写非活动分区，渲染始终读取活动分区，
+ *   提交后下次 FlashFont_Init() 即切换，掉电时旧分区保持有效
+ *
+ * 缺字处理:
+ * - 活动分区中查不到的码点记入缺字缓存，同一个字再次出现时不再查索引
+ * - 缺字依次取非活动分区中的同一字符、替换字符 FLASH_FONT_REPLACEMENT_CP、
+ *   方框字模，不会留下未绘制的空位；FlashFont_BankBegin() 之后不再使用非活动分区
+ *
+ * 段校验:
+ * - fontbin_tool.py 在目录项末尾写入各段的CRC32(与zlib.crc32相同)，旧目录没有该字段，
+ *   其各段视为可信
+ * - 定义 FLASH_FONT_CRC_ENABLE 时各段初始为待校验，FlashFont_Idle() 用硬件CRC单元
+ *   每次校验 FLASH_FONT_CRC_CHUNK 字节；字模等段在第一次使用前还没校验完的，当场校验完
+ * - 对照表、排序索引等查找索引在 FlashFont_Init() 中校验，校验失败的段当作不存在，
+ *   缺字按缺字处理显示，不会显示写了一半的字模
+ *
+ * 字体族:
+ * - 同一分区可以放多套字体(粗体数字、界面黑体等)，目录项的family字段区分，
+ *   0为默认字体；各字体族共用UTF8对照表/排序索引，只各自带字模段(字模平面)
+ * - FlashFont_SelectFamily() 切换时按字号重建一次段表，之后的查找与单字体相同；
+ *   当前字体族没有的字号或字模类型(如只做了数字的粗体)使用字体族0
+ * - 抗锯齿、字宽、字偶距和外框表只与同一字体族的字模段配合使用
+ *
+ * 深度掉电:
+ * - 定义 FLASH_FONT_POWER_DOWN 时，主循环空闲时调用 FlashFont_PowerIdle()，
+ *   超过 FLASH_FONT_PD_IDLE_MS 没有访问字库就退出映射并让Flash进入深度掉电
+ * - 任何要读取映射区的查找在访问前自动唤醒(0xAB + tRES1)并重新映射，接口不变；
+ *   命中常驻子集和字模缓存的字不访问Flash，不会唤醒
+ *
+ * SDRAM镜像:
+ * - 定义 FLASH_FONT_MIRROR_ENABLE(需 SDRAM_ENABLE)时，FlashFont_Init() 之后由MDMA在后台
+ *   把活动分区分块拷贝到 FLASH_FONT_MIRROR_ADDR，每块完成中断中接着下一块，不占用CPU
+ * - 拷贝完成后下一次 FlashFont_Idle() 把段描述和各表地址改到SDRAM，之后的查找和字模读取
+ *   不再经过QSPI(XIP代码独占总线，随机读字模没有QSPI命令开销)，深度掉电也不会被字模访问唤醒
+ * - 定义 FLASH_FONT_MIRROR_SIZES 时只拷贝这些字号的字模段(含ASCII、抗锯齿、字宽表等)，
+ *   对照表和其他字号仍读Flash；活动分区被改写时重新初始化并重新镜像
  */
 
 #ifndef FLASH_FONT_H
@@ -29,8 +78,69 @@ extern "C"
 #endif
 
 #include "init.h"
+#include "qspi_flash.h"
+#include "glyph_cache.h"
+#include "glyph_prefetch.h"
 #include <stdint.h>
 
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define FLASH_FONT_RAM_HASH /*!< 定义了：初始化时在RAM中建立码点哈希表, 注释后：每次查表访问QSPI */
+#define FLASH_FONT_HASH_BITS 14 /*!< 哈希表槽数=2^N, 每槽4字节(14:16384槽,64KB)，对照表项数超过槽数的70%时不建立哈希表 */
+#define FLASH_FONT_PHASH_ENABLE /*!< 定义了：字库带完美哈希段时由MDMA一次拷贝到哈希表存储区，不再由对照表建立哈希表, 注释后：总是逐项建立(只在 FLASH_FONT_RAM_HASH 时使用) */
+#define FLASH_FONT_PHASH_BYTES 36864 /*!< 完美哈希段的最大字节数(不超过65536)，与RAM哈希表共用存储区，存储区取两者较大者 */
+#define FLASH_FONT_PHASH_CHANNEL MDMA_CHANNEL(FLASH_FONT_PHASH_CH) /*!< 拷贝完美哈希段的MDMA通道，通道号在 init.h 的"MDMA通道分配"中修改 */
+#define FLASH_FONT_LAZY_INIT /*!< 定义了：FlashFont_Init()只解析目录，哈希表和常驻子集由 FlashFont_Idle() 分步建立, 注释后：初始化时一次建完 */
+#define FLASH_FONT_IDLE_ENTRIES 512 /*!< FlashFont_Idle() 每次处理的UTF8对照表项数 */
+#define FLASH_FONT_CRC_ENABLE /*!< 定义了：按目录中的CRC32(硬件CRC单元)校验各段，段校验通过后才使用, 注释后：只检查字库标志 */
+#define FLASH_FONT_CRC_CHUNK 16384 /*!< FlashFont_Idle() 每次校验的字节数 */
+#define FLASH_FONT_MAX_SECTIONS 48 /*!< RAM描述表最多段数(每段20字节，字体族的字模段另占表项)，超出的目录项忽略 */
+#define FLASH_FONT_MAX_FAMILIES 4 /*!< 支持的字体族数，family超出的目录项忽略(不超过8) */
+#define FLASH_FONT_MAX_SIZE 64 /*!< 支持的最大字号，按字号索引的描述表占2*(N+1)个指针(抗锯齿再加2*(N+1)) */
+#define FLASH_FONT_AA_ENABLE /*!< 定义了：解析抗锯齿灰度字模段，绘制时优先使用, 注释后：只使用1bpp字模 */
+#define FLASH_FONT_METRICS_ENABLE /*!< 定义了：解析ASCII字宽表和字偶距表，文本按比例宽度排版, 注释后：ASCII固定半角宽度 */
+#define FLASH_FONT_BOX_ENABLE /*!< 定义了：解析汉字笔画外框表，绘制时只展开外框内的像素, 注释后：总是展开整个字模 */
+#define FLASH_FONT_RECORD_ENABLE /*!< 定义了：常用字优先从多字号记录段读取(各字号字模相邻), 注释后：只读各字号字模段 */
+#ifndef FLASH_FONT_HASH_ATTR
+#define FLASH_FONT_HASH_ATTR /*!< 哈希表存放位置, 如需指定DTCM/AXI SRAM可定义为section属性 */
+#endif
+#define FLASH_FONT_RESIDENT_ENABLE /*!< 定义了：初始化时把常用字子集拷贝到RAM并优先使用, 注释后：全部字模从QSPI读取 */
+#define FLASH_FONT_RESIDENT_BYTES 16384 /*!< 常驻字模数据预算(字节，不超过65535)，字模按4字节对齐存放 */
+#define FLASH_FONT_RESIDENT_MAX 512 /*!< 常驻字模最多项数(每个字号的每个字算一项，每项索引8字节) */
+#define FLASH_FONT_RESIDENT_SIZES {16, 24} /*!< 常驻子集包含的字号 */
+#ifndef FLASH_FONT_RESIDENT_CHARS
+#define FLASH_FONT_RESIDENT_CHARS                                              \
+  "0123456789.:-+%/ "                                                          \
+  "设置温度湿度电压电流功率时间日期菜单返回确定取消开关启动停止报警正常错误" /*!< 默认常驻字符(UTF8)，可在编译选项中重新定义 */
+#endif
+#define FLASH_FONT_GB2312_ROWS /*!< 定义了：由区位映射表在RAM中建立94项行表(约1.5KB)，GB2312查找不读QSPI, 注释后：每次读取Flash中的区位映射表 */
+#ifndef FLASH_FONT_GB2312_ROWS_ATTR
+#define FLASH_FONT_GB2312_ROWS_ATTR DTCM_BSS /*!< 行表存放位置，默认DTCM */
+#endif
+#define FLASH_FONT_GBK_TEXT /*!< 定义了：UTF8字库下文本可按 FlashFont_SetEncoding() 选择的GBK编码解码，GBK字符串不必先转换为UTF8, 注释后：文本只按UTF8解码 */
+#define FLASH_FONT_MISS_CACHE_ENABLE /*!< 定义了：记住最近查不到的码点，重复出现的缺字不再查索引, 注释后：每次重新查找 */
+#define FLASH_FONT_MISS_BITS 5 /*!< 缺字缓存槽数=2^N, 每槽4字节 */
+#define FLASH_FONT_FALLBACK_ENABLE /*!< 定义了：缺字时到非活动分区(带目录且字模格式相同)查找, 注释后：只查活动分区 */
+#define FLASH_FONT_FALLBACK_SECTIONS 5 /*!< 备用分区最多使用的汉字字模段数(每段20字节) */
+#define FLASH_FONT_REPLACEMENT_CP 0x25A1 /*!< 两个分区都没有该字时显示的替换字符(□)，0表示不使用 */
+#define FLASH_FONT_TOFU_ENABLE /*!< 定义了：替换字符也没有时显示方框, 注释后：缺字处不绘制 */
+#define FLASH_FONT_TOFU_MAX_SIZE 32 /*!< 方框字模的最大字号，RAM缓冲区约 N*N/8 字节 */
+#ifndef QSPI_XIP_ENABLE
+#define FLASH_FONT_POWER_DOWN /*!< 定义了：字库空闲后Flash进入深度掉电，下次访问时自动唤醒, 注释后：Flash始终保持映射(XIP时不可用) */
+#endif
+#define FLASH_FONT_PD_IDLE_MS 200 /*!< 最后一次访问字库后多久进入深度掉电(ms) */
+#define FLASH_FONT_HOLD_SUSPEND /*!< 定义了：分区安装擦写期间访问字库时自动暂停擦写并映射, 注释后：安装期间不能读取Flash字库 */
+// #define FLASH_FONT_MIRROR_ENABLE /*!< 定义了：启动后在后台把字库拷贝到SDRAM，完成后查找改读SDRAM(需定义SDRAM_ENABLE), 注释后：始终读QSPI */
+// #define FLASH_FONT_MIRROR_SIZES {16, 24} /*!< 定义了：只镜像这些字号的段, 注释后：镜像整个分区 */
+#define FLASH_FONT_MIRROR_ADDR 0xC0200000UL /*!< SDRAM镜像区起始地址，前2MB留给RGB屏帧缓冲 */
+#define FLASH_FONT_MIRROR_BYTES FONT_BANK_SIZE /*!< 镜像区大小，整分区镜像时放不下则不镜像 */
+#define FLASH_FONT_MIRROR_CHUNK 0x10000 /*!< 每次MDMA传输的字节数(不超过64KB)，传输之间CPU的QSPI访问可以插入 */
+#define FLASH_FONT_MIRROR_CHANNEL MDMA_CHANNEL(FLASH_FONT_MIRROR_CH) /*!< 镜像使用的MDMA通道，通道号在 init.h 的"MDMA通道分配"中修改 */
+#ifndef FLASH_FONT_RESIDENT_ATTR
+#define FLASH_FONT_RESIDENT_ATTR /*!< 常驻字模存放位置, 如需指定DTCM可定义为 DTCM_BSS */
+#endif
+
 /*******************************************************************************
  *                          内存映射基地址定义
  ******************************************************************************/
@@ -40,19 +150,345 @@ extern "C"
  *                          Flash字体存储地址分配
  *******************************************************************************/
 /**
- * @brief QSPI Flash字库存储区域定义(相对于Flash起始地址的偏移)
+ * @brief QSPI Flash字库分区定义(相对于Flash起始地址的偏移)
+ */
+#define BASE_ADDR 0x1D00000             /*!< 默认(A)分区起始地址 */
+#define FONT_BANK_A_ADDR BASE_ADDR      /*!< A分区起始地址 */
+#define FONT_BANK_B_ADDR 0x1A00000      /*!< B分区起始地址 */
+#define FONT_BANK_SIZE 0x300000         /*!< 每个分区大小：3MB */
+#ifdef QSPI_DUAL_FLASH_ENABLE
+#define FONT_BANK_HDR_OFS 0x2FE000      /*!< 分区头偏移(分区最后一个8KB扇区，fontbin_tool.py --dual) */
+#else
+#define FONT_BANK_HDR_OFS 0x2FF000      /*!< 分区头偏移(分区最后一个4KB扇区) */
+#endif
+
+#define FONT_TOC_ADDR 0x280000         /*!< 字库目录偏移(4KB对齐) */
+
+/**
+ * @brief 旧版bin文件(无目录)各区域在分区内的偏移
+ */
+#define FONT_12x12_ADDR 0x0 /*!< 12x12字体区域起始地址  */
+#define FONT_16x16_ADDR 0x2BBE0 /*!< 16x16字体区域起始地址  */
+#define FONT_20x20_ADDR 0x66100 /*!< 20x20字体区域起始地址  */
+#define FONT_24x24_ADDR 0xD3680 /*!< 24x24字体区域起始地址 */
+#define FONT_32x32_ADDR 0x1569E0 /*!< 32x32字体区域起始地址 */
+
+#define GB2312_TABLE_ADDR 0x23FE00 /*!< GB2312对照表地址 */
+#define UTF8_TABLE_ADDR 0x2472D0   /*!< utf8对照表地址 */
+#define FONT_FLAG_ADDR 0x2572F0    /*!< 字库标志存储地址 */
+#define ASCII_FONTS_ADDR 0x267310  /*!< ASCII字库地址 */
+
+#define FLASH_FONT_INVALID_CP 0xFFFD /*!< 非法UTF8序列解码得到的替换码点 */
+
+#define FONT_ENC_UTF8 0 /*!< 文本编码：UTF-8 */
+#define FONT_ENC_GBK 1  /*!< 文本编码：GBK(ASCII单字节，汉字为GB2312区位双字节) */
+
+/* 以下为 fontbin_tool.py 追加的加速段(4KB对齐)，段不存在时驱动自动回退线性查找 */
+#define UTF8_SORTED_ADDR 0x26C000  /*!< 按码点排序的UTF8索引地址 */
+#define GB2312_MAP_ADDR 0x27B000   /*!< GB2312区位直接映射表地址 */
+/*******************************************************************************
+ *                          字库目录定义
+ ******************************************************************************/
+#define FONT_TOC_VERSION 1 /*!< 目录格式版本 */
+
+/* 段类型 */
+#define FONT_SEC_GLYPH 1        /*!< 汉字字模，按字库索引排列 */
+#define FONT_SEC_ASCII 2        /*!< ASCII半角字模，按字符编码排列 */
+#define FONT_SEC_GB2312_TABLE 3 /*!< GB2312对照表(GB2312_TableEntry_t) */
+#define FONT_SEC_UTF8_TABLE 4   /*!< UTF8对照表(UTF8_TableEntry_t) */
+#define FONT_SEC_UTF8_SORTED 5  /*!< UTF8排序索引(UTF8_SortedEntry_t) */
+#define FONT_SEC_GB2312_MAP 6   /*!< GB2312区位映射表(uint16_t) */
+#define FONT_SEC_FLAG 7         /*!< 字库写入标志(FontWriteFlag_t) */
+#define FONT_SEC_GLYPH_AA 8     /*!< 汉字抗锯齿字模，索引与同字号FONT_SEC_GLYPH相同 */
+#define FONT_SEC_ASCII_AA 9     /*!< ASCII抗锯齿字模，按字符编码排列 */
+#define FONT_SEC_ASCII_METRICS 10 /*!< ASCII字宽表(FontAsciiMetric_t)，按字符编码排列 */
+#define FONT_SEC_ASCII_KERN 11  /*!< ASCII字偶距表(FontKernPair_t)，按(左字符, 右字符)升序 */
+#define FONT_SEC_GLYPH_BOX 12   /*!< 汉字笔画外框表(FontGlyphBox_t)，索引与同字号FONT_SEC_GLYPH相同 */
+#define FONT_SEC_IMAGE 13       /*!< RGB565图片表(FontImage_t)，像素数据在段内紧随其后 */
+#define FONT_SEC_JPEG 14        /*!< JPEG图片表(FontJpeg_t)，压缩数据在段内紧随其后 */
+#define FONT_SEC_UNICODE_BLOCKS 15 /*!< Unicode分块索引(uint16_t)：页表[256] + 每块256个字库索引，见下方说明 */
+#define FONT_SEC_GLYPH_RECORD 16 /*!< 多字号字模记录，索引与同字号FONT_SEC_GLYPH的前count个字相同，见下方说明 */
+#define FONT_SEC_UTF8_PACKED 17 /*!< 压缩UTF8排序索引(uint32_t)，码点和字库索引合为一项，见下方说明 */
+#define FONT_SEC_INDEX_CODES 18 /*!< 字库索引 -> Unicode码点和GBK码(FontIndexCode_t)，见下方说明 */
+#define FONT_SEC_UTF8_PHASH 19 /*!< 码点 -> 字库索引的最小完美哈希，见下方说明 */
+#define FONT_SEC_INDEXED_IMAGE 20 /*!< 调色板图片表(FontIndexedImage_t)，调色板和4/8bpp像素在段内紧随其后 */
+#define FONT_SEC_RLE_IMAGE 21 /*!< 行程压缩RGB565图片表(FontRleImage_t)，压缩数据在段内紧随其后 */
+#define FONT_SEC_STRINGS 22   /*!< 界面字符串表(FontString_t)，每种语言一段，见下方说明 */
+#define FONT_SEC_STRING_CHARS 23 /*!< 一种语言的字符串用到的字符(UTF-8，以'\0'结尾)，按出现次数降序 */
+
+/*
+ * Unicode分块索引(FONT_SEC_UNICODE_BLOCKS，fontbin_tool.py --blocks 生成):
+ *   uint16 page[256]        码点高字节 -> 块号，0xFFFF表示该页没有字
+ *   uint16 block[n][256]    码点低字节 -> 字库索引，0xFFFF表示没有该字
+ * 目录项步长为2，项数为 256*(n+1)；只覆盖BMP(U+0000-U+FFFF)，查找固定读取两次，
+ * 与字数无关，GBK等2万字以上的字库也不需要RAM哈希表
+ */
+#define FONT_BLOCK_PAGES 256     /*!< 分块索引页表项数(BMP码点高字节) */
+#define FONT_BLOCK_NONE 0xFFFF   /*!< 分块索引中的空项 */
+
+/*
+ * 压缩UTF8排序索引(FONT_SEC_UTF8_PACKED，fontbin_tool.py --packed-index 生成):
+ *   uint32 entry[count] = (码点 << width) | 字库索引，按码点升序
+ * 目录项的width为字库索引位数(11-13位即可容纳2048-8192字)，其余高位为码点，
+ * 13位时码点最大0x7FFFF，覆盖BMP和常用补充平面。每项4字节，是UTF8_SortedEntry_t
+ * 的一半，二分查找每个QSPI Cache行多取一倍的项；8字节排序索引仍然保留，
+ * 不认识本段的旧驱动和备用分区查找继续使用
+ */
+#define FONT_PACKED_INDEX_MAX_BITS 15 /*!< 压缩索引中字库索引的最大位数(字库索引为int16_t) */
+
+/*
+ * 字库索引编码表(FONT_SEC_INDEX_CODES，fontbin_tool.py --index-codes 生成):
+ *   FontIndexCode_t entry[count]   字库索引i -> {Unicode码点, GBK码}，0xFFFF表示没有
+ * 与区位映射表、排序索引配合，GBK与Unicode互查都先落到同一个字库索引再读一项：
+ * GBK -> 区位行表/映射表 -> 索引 -> 码点；码点 -> 排序索引 -> 索引 -> GBK。
+ * 只收录BMP字符；没有本段时互查回退为扫描排序索引或区位映射表
+ */
+
+/*
+ * 最小完美哈希(FONT_SEC_UTF8_PHASH，fontbin_tool.py --phash 生成):
+ *   uint16 seed[2^width]              桶 = (cp * 2654435761) >> (32 - width)
+ *   {uint16 cp, uint16 index}[count]  槽 = fmix32((seed[桶] << 16) | cp) * count >> 32
+ * count为BMP字数，每个槽恰好放一个字，没有空槽；查找只读一个种子和一个槽，
+ * 比较cp排除字库中没有的码点。整段在启动时拷贝到RAM哈希表的存储区，
+ * 不需要逐项读取对照表建立哈希表；段大于 FLASH_FONT_PHASH_BYTES 时照常建立
+ */
+#define FONT_PHASH_MAX_BITS 15 /*!< 完美哈希种子表最多2^N项 */
+
+/*
+ * 多字号字模记录(FONT_SEC_GLYPH_RECORD，fontbin_tool.py --records 生成):
+ *   记录i = 字库索引i在各字号的FONT_FMT_1BPP_ROW字模依次相接(12,16,20,24,32号)
+ * 每个字号一个目录项，各项共用同一块数据：offset为该字号字模在记录中的起始，
+ * stride为整条记录的字节数，count为记录数(字库索引 0..count-1，通常是按使用
+ * 频率排在最前的常用字)。同一屏混用多个字号时常用字的各字号落在相邻的Flash页
+ * 和Cache行中；超出count的字和压缩/补齐格式的字模段仍从各字号字模段读取
+ */
+
+/*
+ * 界面字符串表(FONT_SEC_STRINGS，fontbin_tool.py --strings 生成):
+ *   FontString_t entry[count]   字符串编号 -> 段内偏移和字节数，bytes为0表示该语言没有译文
+ *   UTF-8字符串，各以'\0'结尾
+ * 每种语言一个目录项，first为语言编号(0为默认语言)，各语言的编号一一对应。
+ * 字符串直接在映射区中显示，不拷贝到RAM；地址固定，文本解析缓存按地址命中。
+ * 同时为每种语言生成一个 FONT_SEC_STRING_CHARS 段(first同样为语言编号，步长1，
+ * count含结尾的'\0')，是该语言全部字符串去重后的字符，出现次数多的在前，
+ * 切换语言时 GlyphPrefetch_SetLanguage() 按它把新语言的字模预取到字模缓存
+ */
+#define FONT_LANG_MAX 16 /*!< 语言编号上限(不含) */
+
+/**
+ * @brief  字库索引编码表项(4字节)
+ */
+typedef struct {
+  uint16_t cp;  /*!< Unicode码点，0xFFFF表示没有 */
+  uint16_t gbk; /*!< GBK码(区位各加0xA0，高字节在前)，0xFFFF表示不在GB2312中 */
+} FontIndexCode_t;
+
+/* 字模格式 */
+#define FONT_FMT_NONE 0     /*!< 非字模段 */
+#define FONT_FMT_1BPP_ROW 1 /*!< 1bpp，逐行高位在前，每行按字节补齐 */
+#define FONT_FMT_1BPP_RLE 2 /*!< 1bpp行程压缩，与上一行相同的行不重复存储 */
+#define FONT_FMT_2BPP_ROW 3 /*!< 2bpp灰度(0为背景, 3为前景)，逐行低位在前，每行按字节补齐 */
+#define FONT_FMT_4BPP_ROW 4 /*!< 4bpp灰度(0为背景, 15为前景)，逐行低位在前，每行按字节补齐 */
+#define FONT_FMT_RGB565 5   /*!< RGB565像素(小端uint16)，逐行存放，与 LCD_CopyBuffer() 的数据相同 */
+#define FONT_FMT_JPEG 6     /*!< 基线JPEG文件，由硬件JPEG解码 */
+#define FONT_FMT_1BPP_ROW32 7 /*!< 1bpp，逐行低位在前，每行按4字节补齐，段起始4字节对齐，可按32位字读取 */
+#define FONT_FMT_INDEXED 8  /*!< RGB565调色板 + 4/8bpp颜色序号，逐行存放，4bpp低位在前，每行按字节补齐 */
+#define FONT_FMT_RLE565 9   /*!< RGB565行程压缩，uint16记号流，格式见 FontRleImage_t */
+
+#define FONT_ROW32_BYTES(w) ((((w) + 31) / 32) * 4) /*!< FONT_FMT_1BPP_ROW32 每行字节数 */
+
+/* 压缩字模段(FONT_FMT_1BPP_RLE)布局：
+ *   uint32_t base[(count + 255) / 256];  每256字一个基址(相对段起始)
+ *   uint16_t ofs[count];                 各字相对所在块基址的偏移
+ *   字模数据: 行标记(height+7)/8字节，位r=1表示第r行为新行，紧随其后存储；
+ *            位r=0表示与上一行相同(第0行之前视为空行)，然后依次存各新行
+ * 段步长(stride)仍为未压缩字模的字节数，即单个字模的最大长度 */
+#define FONT_RLE_BLOCK_BITS 8 /*!< 压缩字模段每块字数的对数(256字一块) */
+
+/* 比例宽度排版：字符占用字模单元的第x列起的advance列(超出单元的部分为背景)，
+ * 下一个字符紧接其后；字偶距作用于左字符的advance，只会去掉笔画右侧的空白列 */
+
+/* 索引方式 */
+#define FONT_IDX_NONE 0  /*!< 非字模段 */
+#define FONT_IDX_TABLE 1 /*!< 先经对照表得到字库索引，再按步长定位 */
+#define FONT_IDX_CODE 2  /*!< 按(字符编码 - first)直接定位 */
+
+/* 目录项标志 */
+#define FONT_TOC_F_CRC 0x01 /*!< crc字段有效 */
+
+/* 段校验状态 */
+#define FONT_TRUST_OK 0      /*!< 校验通过或没有CRC，可以使用 */
+#define FONT_TRUST_PENDING 1 /*!< 等待校验 */
+#define FONT_TRUST_BAD 2     /*!< 校验失败，当作不存在 */
+
+/**
+ * @brief  字库目录头(16字节)
+ * @note   位于分区偏移FONT_TOC_ADDR，目录项紧随其后
+ */
+typedef struct {
+  uint32_t magic;      /*!< 魔数 0x434F5446 ("FTOC") */
+  uint16_t version;    /*!< 目录格式版本，FONT_TOC_VERSION */
+  uint16_t count;      /*!< 目录项数量 */
+  uint32_t hdr_size;   /*!< 目录头大小(目录项起始偏移) */
+  uint32_t entry_size; /*!< 每个目录项大小，新版本只允许在末尾追加字段 */
+} FontTocHeader_t;
+
+/**
+ * @brief  字库目录项(28字节)
+ * @note   旧版目录项为24字节(没有crc)，entry_size不小于 FONT_TOC_ENTRY_MIN 即可解析
+ */
+typedef struct __attribute__((packed)) {
+  uint8_t type;       /*!< 段类型 FONT_SEC_xxx */
+  uint8_t format;     /*!< 字模格式 FONT_FMT_xxx */
+  uint8_t width;      /*!< 字模宽度(像素) */
+  uint8_t height;     /*!< 字模高度(像素)，即字号 */
+  uint8_t index_type; /*!< 索引方式 FONT_IDX_xxx */
+  uint8_t first;      /*!< FONT_IDX_CODE时的首字符编码 */
+  uint16_t stride;    /*!< 每项字节数 */
+  uint32_t count;     /*!< 项数 */
+  uint32_t offset;    /*!< 数据在分区内的偏移(已跳过段头) */
+  uint32_t size;      /*!< 数据字节数 */
+  uint8_t family;     /*!< 字体族，0为默认字体(旧版目录的保留字段，均为0) */
+  uint8_t flags;      /*!< 标志 FONT_TOC_F_xxx */
+  uint8_t reserved[2]; /*!< 保留 */
+  uint32_t crc;       /*!< 段数据(offset起size字节)的CRC32，flags带 FONT_TOC_F_CRC 时有效 */
+} FontTocEntry_t;
+
+#define FONT_TOC_ENTRY_MIN 24 /*!< 可解析的最小目录项大小(旧版目录) */
+
+/**
+ * @brief  RAM段描述(20字节)
+ * @note   FlashFont_Init() 由目录或旧版文件头生成，data为内存映射地址
+ */
+typedef struct {
+  const uint8_t *data; /*!< 数据起始地址 */
+  uint32_t count;      /*!< 项数 */
+  uint16_t stride;     /*!< 每项字节数 */
+  uint8_t type;        /*!< 段类型 FONT_SEC_xxx */
+  uint8_t font_size;   /*!< 字号(字模段为高度，其余为0) */
+  uint8_t width;       /*!< 字模宽度 */
+  uint8_t format;      /*!< 字模格式 */
+  uint8_t index_type;  /*!< 索引方式 */
+  uint8_t first;       /*!< 首字符编码 */
+  uint8_t family;      /*!< 字体族 */
+  uint8_t trust;       /*!< 校验状态 FONT_TRUST_xxx */
+  uint16_t toc;        /*!< 目录项序号(校验时读取crc)，旧版布局无意义 */
+} FontDesc_t;
+
+/**
+ * @brief  ASCII字宽表项(2字节)
+ */
+typedef struct {
+  int8_t x;        /*!< 从字模单元第几列开始显示，可为负(左侧补背景) */
+  uint8_t advance; /*!< 占用列数(字符间距已包含在内) */
+} FontAsciiMetric_t;
+
+/**
+ * @brief  汉字笔画外框(4字节)
+ * @note   外框之外全是背景像素，w或h为0表示空白字模
+ */
+typedef struct {
+  uint8_t x; /*!< 外框左列 */
+  uint8_t y; /*!< 外框上行 */
+  uint8_t w; /*!< 外框宽度 */
+  uint8_t h; /*!< 外框高度 */
+} FontGlyphBox_t;
+
+#define FONT_GLYPH_REF_NONE 0xFFFFFFFFU /*!< 预解析时字库中没有该字符 */
+
+/**
+ * @brief  预解析的字形(8字节)，由 fontbuild.py --runs 生成
+ */
+typedef struct {
+  uint32_t offset; /*!< 字模相对所在字模段起始的偏移，FONT_GLYPH_REF_NONE表示没有 */
+  uint16_t cp;     /*!< Unicode码点，<0x80为ASCII */
+  uint8_t advance; /*!< 显示宽度(已含字偶距) */
+  int8_t x;        /*!< 从字模单元第几列开始显示 */
+} FontGlyphRef_t;
+
+/**
+ * @brief  预解析的文本串，由 fontbuild.py --runs 生成，LCD_DisplayGlyphRun() 绘制
+ */
+typedef struct _FontGlyphRun {
+  uint32_t stamp;               /*!< 生成时的 FlashFont_RunStamp()，与当前字库不同时作废 */
+  const FontGlyphRef_t *glyphs; /*!< 各字符 */
+  const char *text;             /*!< 原字符串，校验不符时按它绘制 */
+  uint16_t count;               /*!< 字符数 */
+  uint16_t width;               /*!< 不换行时的总宽度 */
+  uint8_t font_size;            /*!< 字号 */
+} FontGlyphRun_t;
+
+/**
+ * @brief  图片表项(8字节)
+ * @note   图片编号即表项序号，像素共 width*height 个uint16
+ */
+typedef struct {
+  uint16_t width;  /*!< 图片宽度 */
+  uint16_t height; /*!< 图片高度 */
+  uint32_t offset; /*!< 像素数据相对段起始的偏移(4字节对齐) */
+} FontImage_t;
+
+/**
+ * @brief  调色板图片表项(12字节)
+ * @note   offset 处先存 colors 个uint16 RGB565调色板，补齐到4字节后为像素，
+ *         每行 (width*bpp+7)/8 字节；4bpp每字节两个像素，低4位在前(与DMA2D的L4格式相同)
+ */
+typedef struct {
+  uint16_t width;   /*!< 图片宽度 */
+  uint16_t height;  /*!< 图片高度 */
+  uint8_t bpp;      /*!< 每像素位数，4或8 */
+  uint8_t reserved; /*!< 保留 */
+  uint16_t colors;  /*!< 调色板颜色数，4bpp不超过16，8bpp不超过256 */
+  uint32_t offset;  /*!< 调色板相对段起始的偏移(4字节对齐) */
+} FontIndexedImage_t;
+
+#define FONT_INDEXED_PIXELS(img) (((img)->colors * 2U + 3U) & ~3U) /*!< 像素数据相对调色板的偏移 */
+
+/**
+ * @brief  行程压缩图片表项(12字节)
+ * @note   数据为uint16记号流，跨行连续，共解出 width*height 个像素：
+ *         记号最高位为1时后跟1个颜色，重复 (记号&0x7FFF)+1 次；
+ *         最高位为0时后跟 记号+1 个原样的颜色
+ */
+typedef struct {
+  uint16_t width;  /*!< 图片宽度 */
+  uint16_t height; /*!< 图片高度 */
+  uint32_t offset; /*!< 压缩数据相对段起始的偏移(4字节对齐) */
+  uint32_t size;   /*!< 压缩数据字节数 */
+} FontRleImage_t;
+
+#define FONT_RLE_REPEAT 0x8000U /*!< 行程压缩记号：重复一个颜色 */
+#define FONT_RLE_COUNT 0x7FFFU  /*!< 行程压缩记号：像素数减1 */
+
+/**
+ * @brief  JPEG图片表项(12字节)
+ * @note   size已补齐到4字节(硬件JPEG按32位字读取输入)，补齐部分在EOI之后
+ */
+typedef struct {
+  uint16_t width;  /*!< 图片宽度 */
+  uint16_t height; /*!< 图片高度 */
+  uint32_t offset; /*!< JPEG数据相对段起始的偏移(4字节对齐) */
+  uint32_t size;   /*!< JPEG数据字节数 */
+} FontJpeg_t;
+
+/**
+ * @brief  界面字符串表项(8字节)
+ */
+typedef struct {
+  uint32_t offset; /*!< 字符串相对段起始的偏移 */
+  uint32_t bytes;  /*!< 字符串字节数(不含结尾的'\0')，0表示没有译文 */
+} FontString_t;
+
+/**
+ * @brief  ASCII字偶距表项(4字节)
  */
-#define BASE_ADDR 0x1D00000
-#define FONT_12x12_ADDR BASE_ADDR + 0x0 /*!< 12x12字体区域起始地址  */
-#define FONT_16x16_ADDR BASE_ADDR + 0x2BBE0 /*!< 16x16字体区域起始地址  */
-#define FONT_20x20_ADDR BASE_ADDR + 0x66100 /*!< 20x20字体区域起始地址  */
-#define FONT_24x24_ADDR BASE_ADDR + 0xD3680 /*!< 24x24字体区域起始地址 */
-#define FONT_32x32_ADDR BASE_ADDR + 0x1569E0 /*!< 32x32字体区域起始地址 */
+typedef struct {
+  uint8_t left;     /*!< 左字符 */
+  uint8_t right;    /*!< 右字符 */
+  int8_t adjust;    /*!< 左字符advance的调整量(<=0) */
+  uint8_t reserved; /*!< 保留 */
+} FontKernPair_t;
 
-#define GB2312_TABLE_ADDR BASE_ADDR + 0x23FE00 /*!< GB2312对照表地址 */
-#define UTF8_TABLE_ADDR BASE_ADDR + 0x2472D0   /*!< utf8对照表地址 */
-#define FONT_FLAG_ADDR BASE_ADDR + 0x2572F0    /*!< 字库标志存储地址 */
-#define ASCII_FONTS_ADDR BASE_ADDR + 0x267310  /*!< ASCII字库地址 */
 /*******************************************************************************
  *                          字库标志结构定义
  ******************************************************************************/
@@ -70,6 +506,70 @@ typedef struct {
   uint8_t reserved[3]; /*!< 保留字节(4字节对齐) */
     } FontWriteFlag_t;
 
+/**
+ * @brief  字库分区头结构体
+ * @note   存储在分区偏移FONT_BANK_HDR_OFS处，字库数据全部写入并校验后最后写入
+ */
+typedef struct {
+  uint32_t magic; /*!< 魔数 0x4B4E4246 ("FBNK") */
+  uint32_t seq;   /*!< 分区序号，越大越新(按回绕比较) */
+  uint32_t size;  /*!< 字库镜像字节数 */
+  uint32_t check; /*!< 校验：~(magic ^ seq ^ size)，防止写入中途掉电 */
+} FontBankHeader_t;
+
+/**
+ * @brief  字库分区更新任务
+ * @note   由 FlashFont_BankBegin() 初始化，成员只读
+ */
+typedef struct {
+  uint32_t bank; /*!< 目标分区起始地址 */
+  uint32_t seq;  /*!< 提交时写入的序号 */
+  uint32_t size; /*!< 镜像总字节数 */
+  uint32_t end;  /*!< 已写入的最大偏移 */
+} FontBankJob_t;
+
+/**
+ * @brief  段校验统计
+ */
+typedef struct {
+  uint16_t pending;  /*!< 等待校验的段数 */
+  uint16_t verified; /*!< 校验通过的段数 */
+  uint16_t failed;   /*!< 校验失败的段数 */
+  uint16_t unchecked; /*!< 没有CRC(旧版目录或标志段)的段数 */
+} FontCrcStats_t;
+
+/**
+ * @brief  深度掉电统计
+ */
+typedef struct {
+  uint32_t sleeps;      /*!< 进入掉电的次数 */
+  uint32_t wakes;       /*!< 访问字库时唤醒的次数 */
+  uint32_t last_cycles; /*!< 最近一次唤醒+重新映射耗费的CPU周期 */
+  uint32_t max_cycles;  /*!< 唤醒耗费的最大CPU周期 */
+} FontPowerStats_t;
+
+/**
+ * @brief  分区安装期间的擦写暂停统计
+ */
+typedef struct {
+  uint32_t suspends;    /*!< 为读取字库暂停擦写(或在两次擦写之间映射)的次数 */
+  uint32_t failures;    /*!< 暂停或映射失败的次数 */
+  uint32_t last_cycles; /*!< 最近一次从访问到映射区可读耗费的CPU周期 */
+  uint32_t max_cycles;  /*!< 耗费的最大CPU周期 */
+} FontHoldStats_t;
+
+/**
+ * @brief  常驻字模子集统计
+ */
+typedef struct {
+  uint16_t glyphs;   /*!< 已常驻的字模数(按字号分别计数) */
+  uint16_t dropped;  /*!< 因预算或项数不足未能常驻的字模数 */
+  uint16_t missing;  /*!< 字库中不存在的字模数 */
+  uint16_t reserved; /*!< 保留 */
+  uint32_t bytes;    /*!< 已使用的字模数据字节数 */
+  uint32_t budget;   /*!< 字模数据预算 FLASH_FONT_RESIDENT_BYTES */
+} FontResidentStats_t;
+
     /*******************************************************************************
      *                          结构定义
      ******************************************************************************/
@@ -95,6 +595,40 @@ typedef struct {
       uint8_t reserved; /*!< 保留字节，必须存在以匹配生成脚本的8字节对齐 */
     } UTF8_TableEntry_t;
 
+    /**
+     * @brief  附加数据段头(每段12字节)
+     * @note   与原GB2312/UTF8对照表头格式一致: 魔数 + 项数 + 段头大小
+     */
+    typedef struct
+    {
+        uint32_t magic;    /*!< 段魔数 */
+        uint32_t count;    /*!< 数据项数量 */
+        uint32_t hdr_size; /*!< 段头大小(数据项起始偏移) */
+    } FontSectionHeader_t;
+
+    /**
+     * @brief  旧版汉字字模区文件头(18字节)
+     */
+    typedef struct __attribute__((packed)) {
+      uint32_t magic;          /*!< 魔数 "GB23" */
+      uint16_t width;          /*!< 字模宽度 */
+      uint16_t height;         /*!< 字模高度 */
+      uint32_t count;          /*!< 字模数量 */
+      uint32_t reserved;       /*!< 保留 */
+      uint16_t bytes_per_char; /*!< 每字模字节数 */
+    } FontGlyphHeader_t;
+
+    /**
+     * @brief  UTF8排序索引数据项(每条8字节)
+     * @note   按Unicode码点升序排列，供二分查找使用
+     */
+    typedef struct
+    {
+        uint32_t code;     /*!< Unicode码点 */
+        uint16_t index;    /*!< 字库索引(2字节) */
+        uint16_t reserved; /*!< 保留字节(4字节对齐) */
+    } UTF8_SortedEntry_t;
+
     /**
      * @brief  ASCII字库信息结构体 (对应二进制文件头)
      * @note   每项16字节
@@ -104,7 +638,7 @@ typedef struct {
       uint32_t size;       /*!< 该字体数据总大小 */
       uint16_t width;      /*!< 字符宽度 */
       uint16_t height;     /*!< 字符高度 */
-      uint8_t reserved[4]; /*!< 保留字节(补齐16字节) */
+      uint32_t metrics;    /*!< 字宽表(FontAsciiMetric_t[95])相对于文件头的偏移，0表示没有 */
     } ASCII_FontInfo_t;
 
     /**
@@ -122,22 +656,214 @@ typedef struct {
     /**
      * @brief  初始化Flash字库驱动
      * @note   前提：QSPI已开启内存映射模式，字库已预烧录
+     * @note   定义FLASH_FONT_RAM_HASH时同时由UTF8对照表建立RAM哈希表
+     * @note   定义FLASH_FONT_RESIDENT_ENABLE时同时拷贝常驻字模子集
+     * @note   定义FLASH_FONT_CRC_ENABLE时当场校验查找索引段，其余段留给 FlashFont_Idle()
      * @retval 0-成功, <0-失败
      */
     int8_t FlashFont_Init(void);
 
+    /**
+     * @brief  在主循环空闲时分步建立RAM索引
+     * @note   定义FLASH_FONT_LAZY_INIT时，每次处理 FLASH_FONT_IDLE_ENTRIES 项对照表，
+     *         哈希表建完后拷贝常驻字模子集；建完之前查找走Flash中的索引，结果相同
+     * @note   定义FLASH_FONT_CRC_ENABLE时，之后每次校验 FLASH_FONT_CRC_CHUNK 字节待校验的段
+     * @retval 1-还有未完成的工作, 0-全部建完且全部段已校验
+     */
+    uint8_t FlashFont_Idle(void);
+
+#ifdef FLASH_FONT_CRC_ENABLE
+    /**
+     * @brief  读取段校验统计(备用分区的段一并计入)
+     * @param  stats: 输出统计信息
+     */
+    void FlashFont_CrcGetStats(FontCrcStats_t *stats);
+#endif
+
+    /**
+     * @brief  用硬件CRC单元计算一段数据的CRC32(与zlib.crc32相同)
+     * @param  data: 数据，按字节读取
+     * @param  len: 字节数
+     * @note   与段校验共用CRC单元，后台正在校验的段下次从头开始
+     * @retval CRC32，CRC单元不可用时返回0
+     */
+    uint32_t FlashFont_Crc32(const void *data, uint32_t len);
+
+#ifdef FLASH_FONT_POWER_DOWN
+    /**
+     * @brief  主循环空闲时检查是否让Flash进入深度掉电
+     * @note   距最后一次访问字库超过 FLASH_FONT_PD_IDLE_MS，且没有DMA读取、异步写入
+     *         和字模预取时发送0xB9；调用者须保证没有其他模块正持有映射区指针
+     *         (如排队中的Flash图片)
+     * @retval 1-Flash处于深度掉电, 0-Flash处于映射模式
+     */
+    uint8_t FlashFont_PowerIdle(void);
+
+    /**
+     * @brief  读取深度掉电统计
+     * @param  stats: 输出统计信息
+     */
+    void FlashFont_PowerGetStats(FontPowerStats_t *stats);
+#endif
+
+#ifdef FLASH_FONT_MIRROR_ENABLE
+    /**
+     * @brief  字库查找是否已改读SDRAM镜像
+     * @retval 1-已切换, 0-拷贝中、未镜像或镜像失败(继续读Flash)
+     */
+    uint8_t FlashFont_MirrorActive(void);
+
+    /**
+     * @brief  MDMA中断处理，在MDMA_IRQHandler中调用
+     */
+    void FlashFont_MirrorIRQHandler(void);
+#endif
+
+    /**
+     * @brief  查找RAM段描述
+     * @param  type: 段类型 FONT_SEC_xxx
+     * @param  font_size: 字号，非字模段传0
+     * @retval 段描述指针，字库中没有该段返回NULL
+     */
+    const FontDesc_t *FlashFont_GetDesc(uint8_t type, uint8_t font_size);
+
+    /**
+     * @brief  选择字体族，之后的字模查找、字宽和缓存都按该字体族
+     * @param  family: 字体族，0为默认字体
+     * @retval 0-成功, -1-超出 FLASH_FONT_MAX_FAMILIES
+     * @note   FlashFont_Init() 后为字体族0；字库中没有的字号使用字体族0
+     */
+    int8_t FlashFont_SelectFamily(uint8_t family);
+
+    /**
+     * @brief  获取当前字体族
+     */
+    uint8_t FlashFont_GetFamily(void);
+
+    /**
+     * @brief  计算字模缓存键，实际使用的字模段属于其他字体族时带上字体族
+     * @param  cp: 字符键(Unicode码点，或最高位带标记的GB2312编码)
+     * @param  font_size: 字体大小
+     * @retval 缓存键
+     */
+    uint32_t FlashFont_GlyphKey(uint32_t cp, uint8_t font_size);
+
+    /**
+     * @brief  获取当前使用的字库分区
+     * @retval 分区起始地址(FONT_BANK_A_ADDR / FONT_BANK_B_ADDR)
+     */
+    uint32_t FlashFont_ActiveBank(void);
+
+    /**
+     * @brief  开始向非活动分区写入新字库
+     * @param  job: 更新任务
+     * @param  size: 字库镜像字节数
+     * @retval QSPI_W25Qxx_OK - 成功
+     * @retval W25Qxx_ERROR_Erase - 字库未初始化或镜像过大
+     */
+    int8_t FlashFont_BankBegin(FontBankJob_t *job, uint32_t size);
+
+    /**
+     * @brief  写入一段字库镜像
+     * @param  job: 更新任务
+     * @param  offset: 镜像内偏移(4KB对齐)
+     * @param  data: 数据
+     * @param  len: 字节数，除最后一段外应为4KB整数倍
+     * @note   差分擦写非活动分区，返回时QSPI仍处于映射模式，活动分区可正常渲染
+     * @note   每次传入W25Qxx_MAPPED_STEP_SIZE字节时单次阻塞不超过W25Qxx_MAPPED_STEP_MAX_MS
+     * @retval QSPI_W25Qxx_OK - 成功
+     * @retval W25Qxx_ERROR_TRANSMIT - MDMA字模预取进行中，稍后重试
+     * @retval W25Qxx_ERROR_MemoryMapped - 定义了QSPI_XIP_ENABLE，不能在线更新
+     * @retval W25Qxx_ERROR_* - 写入失败
+     */
+    int8_t FlashFont_BankWrite(FontBankJob_t *job, uint32_t offset, const uint8_t *data,
+                               uint32_t len);
+
+    /**
+     * @brief  声明非活动分区正被直接擦写(QSPI不在映射模式)
+     * @param  hold: 1-开始，0-结束
+     * @note   期间 FlashFont_Idle() 和 FlashFont_PowerIdle() 不访问Flash；定义
+     *         FLASH_FONT_HOLD_SUSPEND 时查找字模会先暂停擦写并映射(见 FlashFont_HoldRelease())，
+     *         否则调用者不能显示需要读取Flash字库的文字
+     * @retval QSPI_W25Qxx_OK - 成功
+     * @retval W25Qxx_ERROR_TRANSMIT - MDMA字模预取或镜像拷贝正在读取映射区，稍后重试
+     */
+    int8_t FlashFont_BankHold(uint8_t hold);
+
+    /**
+     * @brief  恢复为读取字库而暂停的擦写，由安装程序在主循环中调用
+     * @note   绘制期间第一次访问字库时暂停擦除(tSUS 20us)或在当前页编程结束后停下(tPP 3ms)，
+     *         之后直到本函数调用前映射区都可读，同一帧内的其余字模不再等待
+     * @note   只能在绘制结束、没有代码持有映射区指针时调用
+     * @retval QSPI_W25Qxx_OK - 已恢复或没有暂停
+     * @retval W25Qxx_ERROR_TRANSMIT - MDMA字模预取正在读取映射区，稍后重试
+     * @retval W25Qxx_ERROR_* - 恢复失败(擦写以该错误结束)
+     */
+    int8_t FlashFont_HoldRelease(void);
+
+    /**
+     * @brief  读取擦写暂停统计
+     * @param  stats: 输出统计信息
+     */
+    void FlashFont_HoldGetStats(FontHoldStats_t *stats);
+
+    /**
+     * @brief  记录已由调用者直接写入的镜像长度
+     * @param  job: 更新任务
+     * @param  end: 已写入的最大偏移
+     * @note   供不经过 FlashFont_BankWrite() 的异步写入(如 font_install.c)使用
+     */
+    void FlashFont_BankMark(FontBankJob_t *job, uint32_t end);
+
+    /**
+     * @brief  提交新分区
+     * @param  job: 更新任务
+     * @note   校验新分区的字库标志后写入分区头，下次 FlashFont_Init() 切换到新分区
+     * @retval QSPI_W25Qxx_OK - 成功
+     * @retval W25Qxx_ERROR_Erase - 镜像未写完或字库标志无效
+     * @retval W25Qxx_ERROR_* - 写入失败
+     */
+    int8_t FlashFont_BankCommit(FontBankJob_t *job);
+
     /**
      * @brief  获取指定字体每字符占用的字节数
      * @param  font_size: 字体大小(12/16/20/24/32)
-     * @retval >=0: 每字符字节数, <0: 无效字体大小
+     * @retval >=0: 每字符字节数(压缩格式为单字最大长度), <0: 无效字体大小
      */
     int16_t FlashFont_BytesPerChar(uint8_t font_size);
 
+    /**
+     * @brief  查询字库是否有该字号的汉字或ASCII字模段
+     * @param  font_size: 字体大小(字库目录中的任意字号，不限于12/16/20/24/32)
+     * @retval 1-有, 0-没有或字库未初始化
+     */
+    uint8_t FlashFont_HasSize(uint8_t font_size);
+
+    /**
+     * @brief  获取字模占用的字节数
+     * @param  glyph: 字模数据指针，压缩格式按行标记计算实际长度
+     * @param  cp: Unicode码点，<0x80为ASCII半角字模
+     * @param  font_size: 字体大小
+     * @retval 字模字节数，不支持该字号返回0
+     */
+    uint16_t FlashFont_GlyphBytes(const uint8_t *glyph, uint32_t cp,
+                                  uint8_t font_size);
+
+    /**
+     * @brief  查询字模是否为行程压缩格式
+     * @param  cp: Unicode码点(GB2312模式下为任意>=0x80的值)，<0x80为ASCII
+     * @param  font_size: 字体大小
+     * @retval 1-压缩格式(FONT_FMT_1BPP_RLE), 2-每行按4字节补齐(FONT_FMT_1BPP_ROW32),
+     *         0-按字节补齐的逐行格式或不支持该字号
+     * @note   绘制函数据此选择逐行展开方式，缓存中的字模保持压缩/补齐格式
+     */
+    uint8_t FlashFont_GlyphPacked(uint32_t cp, uint8_t font_size);
+
     /**
      * @brief  从Flash查找汉字对应的字库索引
      * @param  text: 汉字字符串(GBK编码，2字节)
      * @retval 字库索引(0-7463), 未找到返回-1
-     * @note   使用线性查找，适合少量查询
+     * @note   存在区位映射表时O(1)直接索引，否则回退线性查找
      */
     int16_t GB2312_FindIndex_Flash(const char *text);
 
@@ -154,7 +880,7 @@ typedef struct {
      * @param  utf8_text: UTF8字符字符串(1-4字节)
      * @param  utf8_len: UTF8字符的字节长度(1-4)
      * @retval 字库索引, 未找到返回-1
-     * @note   使用线性查找，适合少量查询
+     * @note   解码为码点后调用FlashFont_FindIndexCP
      */
     int16_t UTF8_FindIndex_Flash(const uint8_t *utf8_text, uint8_t utf8_len);
 
@@ -167,6 +893,109 @@ typedef struct {
      */
     const uint8_t *UTF8_FindFont_Flash(const uint8_t *utf8_text,
                                        uint8_t font_size);
+    /**
+     * @brief  解码一个UTF8字符
+     * @param  utf8_text: UTF8字符串
+     * @param  cp: 输出Unicode码点, 非法序列输出FLASH_FONT_INVALID_CP
+     * @retval 本字符占用的字节数(>=1)，调用者据此前进字符串指针
+     */
+    uint8_t FlashFont_DecodeUTF8(const uint8_t *utf8_text, uint32_t *cp);
+
+#ifdef FLASH_FONT_GBK_TEXT
+    /**
+     * @brief  选择 FlashFont_DecodeText() 和批量解析使用的文本编码
+     * @param  enc: FONT_ENC_UTF8 / FONT_ENC_GBK
+     * @retval 原来的编码
+     * @note   绘图状态和绘图上下文各自保存编码(LCD_SetTextEncoding())，通常不直接调用
+     */
+    uint8_t FlashFont_SetEncoding(uint8_t enc);
+
+    /**
+     * @brief  读取当前文本编码
+     * @retval FONT_ENC_UTF8 / FONT_ENC_GBK
+     */
+    uint8_t FlashFont_GetEncoding(void);
+
+    /**
+     * @brief  解码一个GBK字符
+     * @param  gbk_text: GBK字符串
+     * @param  cp: 输出Unicode码点，字库中没有或不是GB2312字符时输出FLASH_FONT_INVALID_CP
+     * @retval 本字符占用的字节数(1或2)
+     */
+    uint8_t FlashFont_DecodeGBK(const uint8_t *gbk_text, uint32_t *cp);
+
+    /**
+     * @brief  GBK码转Unicode码点
+     * @param  gbk: GBK码(高字节在前)，<0x80为ASCII
+     * @retval Unicode码点，字库中没有该字返回0
+     * @note   区位行表(或映射表)得到字库索引后读一项 FONT_SEC_INDEX_CODES
+     */
+    uint32_t FlashFont_GbkToUnicode(uint16_t gbk);
+
+    /**
+     * @brief  Unicode码点转GBK码
+     * @param  cp: Unicode码点，<0x80为ASCII
+     * @retval GBK码(高字节在前)，字库中没有该字或不在GB2312中返回0
+     */
+    uint16_t FlashFont_UnicodeToGbk(uint32_t cp);
+#endif
+
+    /**
+     * @brief  按当前文本编码解码一个字符
+     * @param  text: 字符串
+     * @param  cp: 输出Unicode码点, 非法序列输出FLASH_FONT_INVALID_CP
+     * @retval 本字符占用的字节数(>=1)
+     * @note   未定义 FLASH_FONT_GBK_TEXT 时与 FlashFont_DecodeUTF8() 相同；ASCII不经过分派
+     */
+    uint8_t FlashFont_DecodeText(const uint8_t *text, uint32_t *cp);
+
+    /**
+     * @brief  按Unicode码点查找字库索引
+     * @param  cp: Unicode码点
+     * @retval 字库索引, 未找到返回-1
+     */
+    int16_t FlashFont_FindIndexCP(uint32_t cp);
+
+    /**
+     * @brief  按Unicode码点查找字模数据指针
+     * @param  cp: Unicode码点
+     * @param  font_size: 字体大小(12/16/20/24/32)
+     * @retval 字模数据指针，查找失败返回NULL
+     */
+    const uint8_t *FlashFont_FindFontCP(uint32_t cp, uint8_t font_size);
+
+    /**
+     * @brief  获取缺字时显示的字模
+     * @param  cp: 活动分区中找不到的Unicode码点
+     * @param  font_size: 字体大小
+     * @retval 字模数据指针，格式与该字号的汉字字模相同；ASCII或不支持该字号返回NULL
+     * @note   依次为: 备用分区中的同一字符 -> FLASH_FONT_REPLACEMENT_CP -> 方框，
+     *         FlashFont_GetGlyphCP()/FlashFont_ResolveString() 缺字时自动调用
+     */
+    const uint8_t *FlashFont_FallbackCP(uint32_t cp, uint8_t font_size);
+
+    /**
+     * @brief  按码点获取字模(经过字模缓存)
+     * @param  cp: Unicode码点，<0x80时取ASCII字库
+     * @param  font_size: 字体大小(12/16/20/24/32)
+     * @retval 字模数据指针(常驻子集或缓存命中时位于片内SRAM)，查找失败返回NULL
+     * @note   查找顺序: 常驻子集 -> 字模缓存 -> QSPI，非ASCII缺字时取 FlashFont_FallbackCP()
+     */
+    const uint8_t *FlashFont_GetGlyphCP(uint32_t cp, uint8_t font_size);
+
+    /**
+     * @brief  一次解析整个UTF8字符串的字模地址
+     * @param  text: UTF8字符串(以0结尾)
+     * @param  font_size: 字体大小(12/16/20/24/32)
+     * @param  glyphs: 输出数组，每个字符一个字模指针，查找失败为NULL
+     * @param  max: glyphs数组容量
+     * @retval 实际解析的字符数，字符串较长时可从第n个字符处继续调用
+     * @note   ASCII字符返回ASCII字库字模(宽度font_size/2)，中文返回汉字字模
+     * @note   启用字模缓存时每次最多解析GLYPH_CACHE_SLOTS个字符，保证返回的指针全部有效
+     */
+    uint16_t FlashFont_ResolveString(const char *text, uint8_t font_size,
+                                     const uint8_t **glyphs, uint16_t max);
+
     /**
      * @brief  从Flash查找ASCII字符并返回字模数据指针
      * @param  c: ASCII字符 (0x20-0x7E)
@@ -174,7 +1003,203 @@ typedef struct {
      * @retval 字模数据指针，查找失败返回NULL
      */
     const uint8_t *ASCII_FindFont_Flash(char c, uint8_t font_size);
-    
+
+    /**
+     * @brief  获取ASCII字符的比例宽度
+     * @param  c: ASCII字符
+     * @param  next: 同一行的下一个字符(用于字偶距)，没有时传0
+     * @param  font_size: 字体大小
+     * @param  x: 输出从字模单元第几列开始显示，可为NULL
+     * @retval 占用列数，没有字宽表时为font_size/2(x为0)
+     */
+    uint8_t FlashFont_AsciiAdvance(char c, char next, uint8_t font_size,
+                                   int8_t *x);
+
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+    /**
+     * @brief  重新建立常驻字模子集
+     * @param  chars: UTF8字符列表(可来自配置文件)，NULL表示清空子集
+     * @note   FLASH_FONT_RESIDENT_SIZES 中的每个字号都拷贝一份，重复字符只拷贝一次
+     * @note   列表指针被保存，之后 FlashFont_Init() 切换分区时按同一列表重建，调用者需保证其一直有效
+     * @retval 0-全部常驻, 1-预算或项数不足(已按列表顺序常驻前面的字), <0-字库未初始化
+     */
+    int8_t FlashFont_ResidentLoad(const char *chars);
+
+    /**
+     * @brief  在常驻子集中查找字模
+     * @param  cp: Unicode码点，<0x80为ASCII
+     * @param  font_size: 字体大小
+     * @retval 字模数据指针(片内RAM，格式与Flash中相同)，不在子集中返回NULL
+     */
+    const uint8_t *FlashFont_ResidentFind(uint32_t cp, uint8_t font_size);
+
+    /**
+     * @brief  读取常驻子集统计
+     * @param  stats: 输出统计信息
+     */
+    void FlashFont_ResidentGetStats(FontResidentStats_t *stats);
+
+    /**
+     * @brief  设置常驻字模数据的运行时预算并按原列表重建子集
+     * @param  bytes: 字节数，0或超过 FLASH_FONT_RESIDENT_BYTES 时为 FLASH_FONT_RESIDENT_BYTES
+     * @retval 生效的预算
+     * @note   数据池仍按 FLASH_FONT_RESIDENT_BYTES 静态分配，调小后列表后面的字不再常驻
+     */
+    uint16_t FlashFont_ResidentSetLimit(uint16_t bytes);
+#endif
+
+#ifdef FLASH_FONT_BOX_ENABLE
+    /**
+     * @brief  按码点获取汉字笔画外框
+     * @param  cp: Unicode码点
+     * @param  font_size: 字体大小
+     * @retval 外框指针(QSPI内存映射区)，该字号没有外框表或字符不存在返回NULL
+     */
+    const FontGlyphBox_t *FlashFont_GetGlyphBox(uint32_t cp, uint8_t font_size);
+
+    /**
+     * @brief  按GBK编码获取汉字笔画外框
+     * @param  text: 汉字字符串(GBK编码，2字节)
+     * @param  font_size: 字体大小
+     * @retval 外框指针，没有外框表或字符不存在返回NULL
+     */
+    const FontGlyphBox_t *GB2312_FindGlyphBox_Flash(const char *text,
+                                                    uint8_t font_size);
+#endif
+
+#ifdef FLASH_FONT_AA_ENABLE
+    /**
+     * @brief  按码点获取抗锯齿字模
+     * @param  cp: Unicode码点，<0x80时取ASCII抗锯齿字模
+     * @param  font_size: 字体大小
+     * @param  bpp: 输出每像素位数(2或4)
+     * @retval 字模数据指针(QSPI内存映射区)，该字号没有抗锯齿段或字符不存在返回NULL
+     * @note   抗锯齿字模较大，不经过字模缓存
+     */
+    const uint8_t *FlashFont_GetGlyphAA(uint32_t cp, uint8_t font_size,
+                                        uint8_t *bpp);
+
+    /**
+     * @brief  按GBK编码获取汉字抗锯齿字模
+     * @param  text: 汉字字符串(GBK编码，2字节)
+     * @param  font_size: 字体大小
+     * @param  bpp: 输出每像素位数(2或4)
+     * @retval 字模数据指针，没有抗锯齿段或字符不存在返回NULL
+     */
+    const uint8_t *GB2312_FindFontAA_Flash(const char *text, uint8_t font_size,
+                                           uint8_t *bpp);
+#endif
+
+    /**
+     * @brief  按编号获取RGB565图片
+     * @param  index: 图片编号(fontbin_tool.py --image 的参数顺序，从0开始)
+     * @param  width: 输出图片宽度，可为NULL
+     * @param  height: 输出图片高度，可为NULL
+     * @retval 像素数据指针(QSPI内存映射区)，没有图片段或编号越界返回NULL
+     * @note   返回的指针可直接交给 LCD_DrawImage565()
+     */
+    const uint16_t *FlashFont_GetImage(uint16_t index, uint16_t *width,
+                                       uint16_t *height);
+
+    /**
+     * @brief  按编号获取调色板图片
+     * @param  index: 图片编号(fontbin_tool.py --indexed 的参数顺序，从0开始)
+     * @param  palette: 输出RGB565调色板(QSPI内存映射区)
+     * @param  colors: 输出调色板颜色数，可为NULL
+     * @param  width: 输出图片宽度，可为NULL
+     * @param  height: 输出图片高度，可为NULL
+     * @param  bpp: 输出每像素位数(4或8)
+     * @retval 像素数据指针(QSPI内存映射区)，没有调色板图片段或编号越界返回NULL
+     * @note   结果可填入 LCD_IndexedImage_t 交给 LCD_DrawImageIndexed()
+     */
+    const uint8_t *FlashFont_GetIndexedImage(uint16_t index,
+                                             const uint16_t **palette,
+                                             uint16_t *colors, uint16_t *width,
+                                             uint16_t *height, uint8_t *bpp);
+
+    /**
+     * @brief  按编号获取行程压缩图片
+     * @param  index: 图片编号(fontbin_tool.py --rle 的参数顺序，从0开始)
+     * @param  size: 输出压缩数据字节数，可为NULL
+     * @param  width: 输出图片宽度，可为NULL
+     * @param  height: 输出图片高度，可为NULL
+     * @retval 压缩数据指针(QSPI内存映射区)，没有行程压缩图片段或编号越界返回NULL
+     * @note   结果可填入 LCD_RleImage_t 交给 LCD_DrawImageRLE()
+     */
+    const uint16_t *FlashFont_GetRleImage(uint16_t index, uint32_t *size,
+                                          uint16_t *width, uint16_t *height);
+
+    /**
+     * @brief  按编号获取JPEG图片
+     * @param  index: 图片编号(fontbin_tool.py --jpeg 的参数顺序，从0开始)
+     * @param  size: 输出JPEG数据字节数(已补齐到4字节)
+     * @param  width: 输出图片宽度，可为NULL
+     * @param  height: 输出图片高度，可为NULL
+     * @retval JPEG数据指针(QSPI内存映射区)，没有JPEG段或编号越界返回NULL
+     * @note   返回的指针可直接交给 LCD_JPEG_Draw()
+     */
+    const uint8_t *FlashFont_GetJpeg(uint16_t index, uint32_t *size,
+                                     uint16_t *width, uint16_t *height);
+
+    /**
+     * @brief  选择界面字符串的语言
+     * @param  lang: 语言编号(fontbin_tool.py --strings 的LANG)，0为默认语言
+     * @retval 0-成功, -1-字库中没有该语言的字符串表
+     * @note   初始为语言0；重新初始化字库(分区切换)后保持，新字库没有该语言时取语言0
+     */
+    int8_t FlashFont_SetLanguage(uint8_t lang);
+
+    /**
+     * @brief  获取当前语言编号
+     */
+    uint8_t FlashFont_GetLanguage(void);
+
+    /**
+     * @brief  按编号获取当前语言的界面字符串
+     * @param  id: 字符串编号(fontbin_tool.py --strings-header 生成的 STR_xxx)
+     * @param  bytes: 输出字节数(不含结尾的'\0')，可为NULL
+     * @retval 以'\0'结尾的UTF-8字符串(QSPI内存映射区)，当前语言没有译文时取语言0，
+     *         都没有时返回NULL
+     * @note   返回的指针可直接交给 LCD_DisplayText() 等，不需要拷贝
+     */
+    const char *FlashFont_GetString(uint16_t id, uint32_t *bytes);
+
+    /**
+     * @brief  获取一种语言的字符串用到的全部字符
+     * @param  lang: 语言编号
+     * @retval 以'\0'结尾的UTF-8字符串(QSPI内存映射区)，出现次数多的字符在前；
+     *         字库中没有该语言的字符集段返回NULL
+     * @note   可直接交给 GlyphPrefetch_Queue() 等，不需要拷贝
+     */
+    const char *FlashFont_GetLanguageChars(uint8_t lang);
+
+    /**
+     * @brief  计算预解析文本串所依赖的字库内容的校验
+     * @param  font_size: 字体大小
+     * @retval 校验值，与 FontGlyphRun_t.stamp 相同时预解析结果有效；字库未初始化返回0
+     * @note   初始化后第一次调用时读取一遍UTF8排序索引(约60KB)
+     */
+    uint32_t FlashFont_RunStamp(uint8_t font_size);
+
+    /**
+     * @brief  按预解析的偏移获取字模(经过字模缓存)
+     * @param  ref: 预解析字形
+     * @param  font_size: 字体大小
+     * @retval 字模数据指针，没有该字符返回NULL
+     * @note   不解码UTF8、不查对照表，调用前需确认校验一致
+     */
+    const uint8_t *FlashFont_GetGlyphRef(const FontGlyphRef_t *ref,
+                                         uint8_t font_size);
+
+    /**
+     * @brief  在设备上计算码点的预解析偏移
+     * @param  cp: Unicode码点
+     * @param  font_size: 字体大小
+     * @retval FontGlyphRef_t.offset，字库中没有该字符返回FONT_GLYPH_REF_NONE
+     * @note   供运行时生成的解析结果(LCD_TEXT_MEMO_ENABLE)使用，同样以 FlashFont_RunStamp() 判断是否作废
+     */
+    uint32_t FlashFont_GlyphRefOffset(uint32_t cp, uint8_t font_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,307 @@
+/**
+ ******************************************************************************
+ * @file    font_install.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   SD卡字库流式安装实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 实现方式：
+ * - 两个缓冲区各有空/满/写入中三种状态，g_fi_fill 指向下一个读入的缓冲区，
+ *   g_fi_prog 指向下一个写入Flash的缓冲区，两者交替前进
+ * - Flash一侧每次只启动一个异步操作(擦除一个单元或编程一个缓冲区)，完成回调只记录结果，
+ *   下一个操作由主循环中的 FontInstall_Step() 启动，中断里不访问FatFs
+ * - 编程前把镜像擦除到本缓冲区末尾：块对齐且不含分区头的位置擦64KB，其余擦4KB
+ * - f_read() 的长度是扇区整数倍且缓冲区按Cache行对齐，FatFs不经过自身的扇区缓冲，
+ *   直接以多块读取写入缓冲区
+ *
+ ******************************************************************************
+ */
+
+#include "font_install.h"
+
+#if defined(FATFS_ENABLE) && defined(FLASH_FONT_ENABLE)
+
+#if (FONT_INSTALL_BUF_SIZE % 512) != 0 || FONT_INSTALL_BUF_SIZE == 0
+#error "FONT_INSTALL_BUF_SIZE 必须是SD卡扇区(512字节)的整数倍"
+#endif
+
+/*******************************************************************************
+ *                              私有类型与变量
+ ******************************************************************************/
+
+#define FI_IDLE 0 /*!< 空闲 */
+#define FI_RUN 1  /*!< 安装中 */
+
+#define FI_BUF_EMPTY 0 /*!< 缓冲区空闲，可读入 */
+#define FI_BUF_FULL 1  /*!< 已读入，等待写入Flash */
+#define FI_BUF_FLASH 2 /*!< 正在写入Flash */
+
+#define FI_OP_NONE 0    /*!< Flash空闲 */
+#define FI_OP_ERASE 1   /*!< 异步擦除中 */
+#define FI_OP_PROGRAM 2 /*!< 异步编程中 */
+
+FONT_INSTALL_BUF_ATTR static uint8_t
+    g_fi_buf[2][FONT_INSTALL_BUF_SIZE] __attribute__((aligned(32))); /*!< 双缓冲区 */
+static uint32_t g_fi_len[2];      /*!< 各缓冲区有效字节数 */
+static uint8_t g_fi_buf_state[2]; /*!< 各缓冲区状态 */
+static uint8_t g_fi_fill = 0;     /*!< 下一个读入的缓冲区 */
+static uint8_t g_fi_prog = 0;     /*!< 下一个写入Flash的缓冲区 */
+
+static FIL g_fi_file;             /*!< 镜像文件 */
+static FontBankJob_t g_fi_job;    /*!< 分区更新任务 */
+static uint32_t g_fi_read = 0;    /*!< 已读入的字节数 */
+static uint32_t g_fi_written = 0; /*!< 已写入Flash的字节数 */
+static uint32_t g_fi_erased = 0;  /*!< 已擦除到的镜像内偏移 */
+static uint32_t g_fi_unit = 0;    /*!< 当前擦除单元字节数 */
+static uint8_t g_fi_state = FI_IDLE; /*!< 安装状态 */
+static uint8_t g_fi_op = FI_OP_NONE; /*!< 当前Flash操作 */
+static volatile int8_t g_fi_status = QSPI_W25Qxx_OK; /*!< 最近一次Flash操作结果 */
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  异步擦除/编程完成回调(中断中调用)
+ * @param  status: 操作结果
+ */
+static void FontInstall_FlashDone(int8_t status) { g_fi_status = status; }
+
+/**
+ * @brief  收尾：关闭文件并重新进入映射模式
+ * @retval QSPI_W25Qxx_OK - 成功
+ * @retval W25Qxx_ERROR_MemoryMapped - 重新映射失败
+ */
+static int8_t FontInstall_Close(void) {
+  int8_t status;
+
+  while (QSPI_W25Qxx_EraseSuspended()) {
+    FlashFont_HoldRelease(); // 为读取字库暂停的擦写先恢复，否则不会结束
+  }
+  while (QSPI_W25Qxx_Write_Busy()) {
+    // 等待正在进行的擦除或页编程结束
+  }
+  f_close(&g_fi_file);
+  g_fi_state = FI_IDLE;
+  g_fi_op = FI_OP_NONE;
+  status = QSPI_W25Qxx_MemoryMappedMode(); // 异步擦写后QSPI处于间接模式
+  FlashFont_BankHold(0);
+  return status;
+}
+
+/**
+ * @brief  安装失败，收尾后返回错误码
+ * @param  status: 错误码
+ * @retval status
+ */
+static int8_t FontInstall_Fail(int8_t status) {
+  DEBUG_ERROR("FontInstall: 安装失败");
+  FontInstall_Close();
+  return status;
+}
+
+/**
+ * @brief  Flash空闲时结算上一次操作并启动下一次
+ * @retval QSPI_W25Qxx_OK - 已启动、仍在进行或等待数据
+ * @retval W25Qxx_ERROR_* - 上一次操作失败或启动失败
+ */
+static int8_t FontInstall_Flash(void) {
+  uint8_t p = g_fi_prog;
+  uint32_t end;
+  int8_t status;
+
+  if (QSPI_W25Qxx_Write_Busy()) {
+    return QSPI_W25Qxx_OK;
+  }
+  if (g_fi_op != FI_OP_NONE) {
+    if (g_fi_status != QSPI_W25Qxx_OK) {
+      return g_fi_status;
+    }
+    if (g_fi_op == FI_OP_PROGRAM) {
+      g_fi_written += g_fi_len[p];
+      g_fi_buf_state[p] = FI_BUF_EMPTY;
+      p ^= 1;
+      g_fi_prog = p;
+    } else {
+      g_fi_erased += g_fi_unit;
+    }
+    g_fi_op = FI_OP_NONE;
+  }
+  if (g_fi_buf_state[p] != FI_BUF_FULL) {
+    return QSPI_W25Qxx_OK; // 等待SD卡数据
+  }
+
+  end = g_fi_written + g_fi_len[p];
+  if (g_fi_erased < end) {
+    // 分区头所在的最后一块逐扇区擦除，分区头保留到提交时改写
+    g_fi_unit = ((g_fi_erased % W25Qxx_BlockSize) == 0 &&
+                 g_fi_erased + W25Qxx_BlockSize <= FONT_BANK_HDR_OFS)
+                    ? W25Qxx_BlockSize
+                    : W25Qxx_SectorSize;
+    g_fi_op = FI_OP_ERASE;
+    status = QSPI_W25Qxx_Erase_Async(g_fi_job.bank + g_fi_erased, g_fi_unit,
+                                     FontInstall_FlashDone);
+  } else {
+    g_fi_op = FI_OP_PROGRAM;
+    g_fi_buf_state[p] = FI_BUF_FLASH;
+    status = QSPI_W25Qxx_WriteBuffer_Async(g_fi_buf[p],
+                                           g_fi_job.bank + g_fi_written,
+                                           g_fi_len[p], NULL,
+                                           FontInstall_FlashDone);
+  }
+  if (status != QSPI_W25Qxx_OK) {
+    g_fi_op = FI_OP_NONE;
+  }
+  return status;
+}
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  打开字库镜像文件，开始安装到非活动分区
+ * @param  path: FatFs路径
+ * @retval QSPI_W25Qxx_OK - 成功
+ * @retval FONT_INSTALL_ERROR_FILE - 文件打开失败或为空
+ * @retval W25Qxx_ERROR_Erase - 字库未初始化或镜像超过分区容量
+ * @retval W25Qxx_ERROR_TRANSMIT - 上一次安装未结束或MDMA正在读取映射区
+ */
+int8_t FontInstall_Start(const char *path) {
+  uint32_t size;
+  int8_t status;
+
+  if (g_fi_state != FI_IDLE || QSPI_W25Qxx_DMA_Busy() ||
+      QSPI_W25Qxx_Write_Busy()) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  if (path == NULL || f_open(&g_fi_file, path, FA_READ) != FR_OK) {
+    return FONT_INSTALL_ERROR_FILE;
+  }
+  size = (uint32_t)f_size(&g_fi_file);
+  if (size == 0) {
+    f_close(&g_fi_file);
+    return FONT_INSTALL_ERROR_FILE;
+  }
+  status = FlashFont_BankBegin(&g_fi_job, size);
+  if (status == QSPI_W25Qxx_OK) {
+    status = FlashFont_BankHold(1);
+  }
+  if (status != QSPI_W25Qxx_OK) {
+    f_close(&g_fi_file);
+    return status;
+  }
+
+  g_fi_buf_state[0] = FI_BUF_EMPTY;
+  g_fi_buf_state[1] = FI_BUF_EMPTY;
+  g_fi_fill = 0;
+  g_fi_prog = 0;
+  g_fi_read = 0;
+  g_fi_written = 0;
+  g_fi_erased = 0;
+  g_fi_op = FI_OP_NONE;
+  g_fi_state = FI_RUN;
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  推进安装，在主循环中反复调用
+ * @retval FONT_INSTALL_PENDING - 安装进行中
+ * @retval QSPI_W25Qxx_OK - 安装完成
+ * @retval FONT_INSTALL_ERROR_FILE - 读取失败
+ * @retval W25Qxx_ERROR_Erase - 未开始安装
+ * @retval W25Qxx_ERROR_* - 擦写或提交失败
+ */
+int8_t FontInstall_Step(void) {
+  uint8_t f = g_fi_fill;
+  uint32_t want;
+  UINT br;
+  int8_t status;
+
+  if (g_fi_state != FI_RUN) {
+    return W25Qxx_ERROR_Erase;
+  }
+  // 上一帧绘制时为读取字模暂停的擦写在这里恢复，恢复失败时由 FontInstall_Flash() 报告
+  if (FlashFont_HoldRelease() == W25Qxx_ERROR_TRANSMIT) {
+    return FONT_INSTALL_PENDING; // 字模预取正在读取映射区，下次再恢复
+  }
+  status = FontInstall_Flash();
+  if (status != QSPI_W25Qxx_OK) {
+    return FontInstall_Fail(status);
+  }
+
+  // Flash在中断中擦写另一个缓冲区时读入本缓冲区
+  if (g_fi_read < g_fi_job.size && g_fi_buf_state[f] == FI_BUF_EMPTY) {
+    want = g_fi_job.size - g_fi_read;
+    if (want > FONT_INSTALL_BUF_SIZE) {
+      want = FONT_INSTALL_BUF_SIZE;
+    }
+    if (f_read(&g_fi_file, g_fi_buf[f], want, &br) != FR_OK || br != want) {
+      return FontInstall_Fail(FONT_INSTALL_ERROR_FILE);
+    }
+    g_fi_len[f] = want;
+    g_fi_buf_state[f] = FI_BUF_FULL;
+    g_fi_read += want;
+    g_fi_fill = f ^ 1;
+
+    status = FontInstall_Flash(); // Flash在等数据时立即开始
+    if (status != QSPI_W25Qxx_OK) {
+      return FontInstall_Fail(status);
+    }
+  }
+  if (g_fi_written < g_fi_job.size) {
+    return FONT_INSTALL_PENDING;
+  }
+
+  status = FontInstall_Close();
+  if (status != QSPI_W25Qxx_OK) {
+    return status;
+  }
+  FlashFont_BankMark(&g_fi_job, g_fi_written);
+  return FlashFont_BankCommit(&g_fi_job);
+}
+
+/**
+ * @brief  阻塞式安装
+ * @param  path: FatFs路径
+ * @retval 同 FontInstall_Step()，不返回 FONT_INSTALL_PENDING
+ */
+int8_t FontInstall_File(const char *path) {
+  int8_t status = FontInstall_Start(path);
+
+  if (status != QSPI_W25Qxx_OK) {
+    return status;
+  }
+  do {
+    status = FontInstall_Step();
+  } while (status == FONT_INSTALL_PENDING);
+  return status;
+}
+
+/**
+ * @brief  放弃安装
+ */
+void FontInstall_Abort(void) {
+  if (g_fi_state == FI_RUN) {
+    FontInstall_Close();
+  }
+}
+
+/**
+ * @brief  读取安装进度
+ * @param  done: 输出已写入Flash的字节数，可为NULL
+ * @param  total: 输出镜像总字节数，可为NULL
+ * @retval 1-安装进行中, 0-空闲
+ */
+uint8_t FontInstall_GetProgress(uint32_t *done, uint32_t *total) {
+  if (done != NULL) {
+    *done = g_fi_written;
+  }
+  if (total != NULL) {
+    *total = g_fi_job.size;
+  }
+  return g_fi_state == FI_RUN;
+}
+
+#endif /* FATFS_ENABLE && FLASH_FONT_ENABLE */
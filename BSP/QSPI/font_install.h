@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ * @file    font_install.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   SD卡字库流式安装头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 从SD卡(FatFs)读取 fontbin_tool.py 生成的字库镜像，写入非活动分区后提交，
+ *   下次 FlashFont_Init() 切换到新字库，中途掉电旧分区保持有效
+ * - 两个 FONT_INSTALL_BUF_SIZE 缓冲区交替使用：一个由QSPI异步擦除/页编程在中断中
+ *   写入Flash，另一个同时由 f_read() 整块读入(FatFs直接多块DMA读到缓冲区)，
+ *   SD卡读取时间被Flash编程时间覆盖，总耗时约等于擦除+编程时间
+ * - 按64KB块擦除，分区头所在的最后一块按4KB扇区擦除，不触碰分区头
+ * - 不比较旧内容，整个镜像重新擦写；只改了少量字模时 FlashFont_BankWrite() 更快
+ * - 安装期间QSPI不在映射模式；FlashFont_Idle()/FlashFont_PowerIdle() 自动暂停，可以照常调用
+ * - 定义 FLASH_FONT_HOLD_SUSPEND 时照常绘制文字即可：字模缓存未命中、需要读取Flash字库时
+ *   自动暂停擦除(tSUS 20us)或在当前页编程结束后停下(tPP 3ms)并映射，同一帧的其余字模
+ *   直接读取，下一次 FontInstall_Step() 开始时恢复擦写；活动分区与正在擦写的非活动分区
+ *   不重叠，暂停期间读取的字模正确。未定义时不能显示需要读取Flash字库的文字(SDRAM镜像
+ *   FLASH_FONT_MIRROR_ENABLE 生效或字模已在缓存中时除外)，进度可用色块显示
+ * - 由 init.h 中的 FATFS_ENABLE 和 FLASH_FONT_ENABLE 共同控制
+ *
+ * 使用示例：
+ *     FontInstall_Start("0:/font.bin");
+ *     while ((status = FontInstall_Step()) == FONT_INSTALL_PENDING) {
+ *         FontInstall_GetProgress(&done, &total);
+ *         LCD_FillRect(0, 100, done * 240 / total, 8);
+ *     }
+ *     if (status == QSPI_W25Qxx_OK) {
+ *         FlashFont_Init();          // 切换到新字库
+ *     }
+ *
+ ******************************************************************************
+ */
+
+#ifndef FONT_INSTALL_H
+#define FONT_INSTALL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "flash_font.h"
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define FONT_INSTALL_BUF_SIZE 0x8000 /*!< 每个缓冲区字节数(512的整数倍)，一次f_read的长度 */
+#ifndef FONT_INSTALL_BUF_ATTR
+#define FONT_INSTALL_BUF_ATTR AXI_SRAM_AT(0x24026000) /*!< 两个缓冲区(64KB)放在AXI SRAM，紧接SPI屏帧缓冲之后，SDMMC1的IDMA不能访问DTCM */
+#endif
+
+#define FONT_INSTALL_PENDING 1      /*!< 本步完成，安装仍在进行 */
+#define FONT_INSTALL_ERROR_FILE -10 /*!< 文件打开/读取失败或长度不符 */
+
+    /*******************************************************************************
+     *                          导出函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  打开字库镜像文件，开始安装到非活动分区
+     * @param  path: FatFs路径，如 "0:/font.bin"
+     * @retval QSPI_W25Qxx_OK - 成功
+     * @retval FONT_INSTALL_ERROR_FILE - 文件打开失败或为空
+     * @retval W25Qxx_ERROR_Erase - 字库未初始化或镜像超过分区容量
+     * @retval W25Qxx_ERROR_TRANSMIT - 上一次安装未结束或MDMA字模预取进行中
+     */
+    int8_t FontInstall_Start(const char *path);
+
+    /**
+     * @brief  推进安装，在主循环中反复调用
+     * @note   空闲缓冲区用 f_read() 读满(阻塞到本块读完)，Flash空闲时启动下一次异步擦除或编程，
+     *         其余时间立即返回
+     * @note   全部写完后重新进入映射模式并提交分区头
+     * @retval FONT_INSTALL_PENDING - 安装进行中
+     * @retval QSPI_W25Qxx_OK - 安装完成，调用 FlashFont_Init() 切换
+     * @retval FONT_INSTALL_ERROR_FILE - 读取失败
+     * @retval W25Qxx_ERROR_* - 擦写或提交失败，新分区不会被选中
+     */
+    int8_t FontInstall_Step(void);
+
+    /**
+     * @brief  阻塞式安装，逐步调用 FontInstall_Step() 直到结束
+     * @param  path: FatFs路径
+     * @retval 同 FontInstall_Step()，不返回 FONT_INSTALL_PENDING
+     */
+    int8_t FontInstall_File(const char *path);
+
+    /**
+     * @brief  放弃安装，等待正在进行的擦写结束后关闭文件并重新进入映射模式
+     * @note   非活动分区内容作废，分区头未改写，不会被选中
+     */
+    void FontInstall_Abort(void);
+
+    /**
+     * @brief  读取安装进度
+     * @param  done: 输出已写入Flash的字节数，可为NULL
+     * @param  total: 输出镜像总字节数，可为NULL
+     * @retval 1-安装进行中, 0-空闲
+     */
+    uint8_t FontInstall_GetProgress(uint32_t *done, uint32_t *total);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FONT_INSTALL_H
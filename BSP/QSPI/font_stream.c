@@ -0,0 +1,291 @@
+/**
+ ******************************************************************************
+ * @file    font_stream.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   串行通道(USB CDC/串口)字库在线更新实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 实现方式：
+ * - 接收中断只做拷贝：头收满12字节后当场检查魔数和校验字，之后按块长度+4字节CRC
+ *   依次填满块槽，g_fs_in 加1；主循环写完一块后 g_fs_out 加1，两个计数各由一方改写
+ * - 写入顺序与块序号一致，偏移为块序号*4KB，满足 FlashFont_BankWrite() 的扇区对齐要求
+ * - 块CRC在写入前由硬件CRC单元计算，写入Flash的数据都已通过校验
+ * - 放弃更新后先丢弃数据，直到 FONT_STREAM_GAP_MS 内没有再收到数据，
+ *   之后收到的数据按新的传输头解析，上位机剩余的数据不会被当成传输头
+ *
+ ******************************************************************************
+ */
+
+#include "font_stream.h"
+#include <string.h>
+
+#if defined(FONT_STREAM_ENABLE) && defined(FLASH_FONT_ENABLE)
+
+#if FONT_STREAM_SLOTS < 2
+#error "FONT_STREAM_SLOTS 至少为2，写入一块期间才能接收下一块"
+#endif
+
+/*******************************************************************************
+ *                              私有类型与变量
+ ******************************************************************************/
+
+#define FS_BLOCK W25Qxx_SectorSize /*!< 每块字节数 */
+#define FS_HDR_BYTES 12            /*!< 传输头字节数 */
+
+#define FS_OFF 0    /*!< 未初始化，丢弃收到的数据 */
+#define FS_HEADER 1 /*!< 等待传输头 */
+#define FS_DATA 2   /*!< 接收数据块 */
+#define FS_DISCARD 3 /*!< 更新失败，丢弃数据直到上位机停止发送 */
+
+FONT_STREAM_ATTR static uint8_t
+    g_fs_slot[FONT_STREAM_SLOTS][FS_BLOCK + 4] __attribute__((aligned(32))); /*!< 块槽(数据+CRC) */
+static uint8_t g_fs_hdr[FS_HDR_BYTES];  /*!< 传输头 */
+static volatile uint8_t g_fs_state = FS_OFF; /*!< 接收状态 */
+static volatile uint8_t g_fs_bad_hdr = 0;    /*!< 1-收到无效的传输头，待主循环回复 */
+static uint8_t g_fs_hdr_n = 0;               /*!< 已收到的头字节数 */
+static uint32_t g_fs_size = 0;               /*!< 镜像字节数 */
+static uint32_t g_fs_blocks = 0;             /*!< 总块数 */
+static uint32_t g_fs_wpos = 0;               /*!< 当前块槽已收到的字节数 */
+static volatile uint32_t g_fs_in = 0;        /*!< 已收满的块数(中断中改写) */
+static volatile uint32_t g_fs_out = 0;       /*!< 已写入的块数(主循环中改写) */
+static volatile uint32_t g_fs_tick = 0;      /*!< 最后一次收到数据的时间 */
+static uint8_t g_fs_begun = 0;               /*!< 1-已对非活动分区调用 FlashFont_BankBegin() */
+static FontBankJob_t g_fs_job;               /*!< 分区更新任务 */
+static FontStream_Send_t g_fs_send = NULL;   /*!< 回复发送函数 */
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  第i块的数据字节数
+ */
+static uint32_t FontStream_BlockLen(uint32_t i) {
+  uint32_t left = g_fs_size - i * FS_BLOCK;
+
+  return (left > FS_BLOCK) ? FS_BLOCK : left;
+}
+
+/**
+ * @brief  发送一字节回复
+ */
+static void FontStream_Reply(uint8_t code) {
+  if (g_fs_send != NULL) {
+    g_fs_send(&code, 1);
+  }
+}
+
+/**
+ * @brief  复位接收状态
+ * @param  state: FS_HEADER-等待下一个传输头, FS_DISCARD-先丢弃剩余数据
+ */
+static void FontStream_Reset(uint8_t state) {
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  g_fs_state = state;
+  g_fs_hdr_n = 0;
+  g_fs_wpos = 0;
+  g_fs_in = 0;
+  g_fs_out = 0;
+  g_fs_begun = 0;
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  放弃本次更新并回复错误
+ * @param  status: 错误码
+ * @retval status
+ */
+static int8_t FontStream_Fail(int8_t status) {
+  DEBUG_ERROR("FontStream: 字库更新失败");
+  FontStream_Reset(FS_DISCARD);
+  FontStream_Reply(FONT_STREAM_REPLY_ERROR);
+  return status;
+}
+
+/**
+ * @brief  检查收满的传输头
+ * @retval 1-有效(已进入数据阶段), 0-无效
+ */
+static uint8_t FontStream_Header(void) {
+  uint32_t magic;
+  uint32_t size;
+  uint32_t check;
+
+  memcpy(&magic, &g_fs_hdr[0], 4);
+  memcpy(&size, &g_fs_hdr[4], 4);
+  memcpy(&check, &g_fs_hdr[8], 4);
+  g_fs_hdr_n = 0;
+  if (magic != FONT_STREAM_MAGIC || check != ~(magic ^ size) || size == 0) {
+    return 0;
+  }
+  g_fs_size = size;
+  g_fs_blocks = (size + FS_BLOCK - 1) / FS_BLOCK;
+  g_fs_wpos = 0;
+  g_fs_state = FS_DATA;
+  return 1;
+}
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  初始化接收状态，开始等待传输头
+ * @param  send: 回复发送函数，可为NULL
+ */
+void FontStream_Init(FontStream_Send_t send) {
+  g_fs_send = send;
+  g_fs_bad_hdr = 0;
+  FontStream_Reset(FS_HEADER);
+}
+
+/**
+ * @brief  接收数据，在CDC/串口接收回调中调用
+ * @retval 接收的字节数
+ */
+uint32_t FontStream_Receive(const uint8_t *data, uint32_t len) {
+  uint32_t now = HAL_GetTick();
+  uint32_t n = 0;
+  uint32_t need;
+  uint32_t chunk;
+
+  if (g_fs_state == FS_HEADER && now - g_fs_tick > FONT_STREAM_TIMEOUT_MS) {
+    g_fs_hdr_n = 0; // 上次只收到半个头
+  }
+  g_fs_tick = now;
+  if (g_fs_state == FS_OFF || g_fs_state == FS_DISCARD || data == NULL) {
+    return len;
+  }
+  while (n < len) {
+    if (g_fs_state == FS_HEADER) {
+      g_fs_hdr[g_fs_hdr_n++] = data[n++];
+      if (g_fs_hdr_n == FS_HDR_BYTES && !FontStream_Header()) {
+        g_fs_bad_hdr = 1;
+        g_fs_state = FS_DISCARD;
+        return len;
+      }
+      continue;
+    }
+    if (g_fs_in >= g_fs_blocks) {
+      return len; // 多余的数据丢弃
+    }
+    if (g_fs_in - g_fs_out >= FONT_STREAM_SLOTS) {
+      break; // 块槽已满，等待主循环写入
+    }
+    need = FontStream_BlockLen(g_fs_in) + 4;
+    chunk = need - g_fs_wpos;
+    if (chunk > len - n) {
+      chunk = len - n;
+    }
+    memcpy(&g_fs_slot[g_fs_in % FONT_STREAM_SLOTS][g_fs_wpos], &data[n], chunk);
+    n += chunk;
+    g_fs_wpos += chunk;
+    if (g_fs_wpos == need) {
+      g_fs_wpos = 0;
+      g_fs_in++;
+    }
+  }
+  return n;
+}
+
+/**
+ * @brief  查询块槽剩余空间
+ * @retval 还能接收的字节数
+ */
+uint32_t FontStream_Space(void) {
+  uint32_t used = g_fs_in - g_fs_out;
+
+  if (g_fs_state != FS_DATA) {
+    return FONT_STREAM_SLOTS * (FS_BLOCK + 4);
+  }
+  if (used >= FONT_STREAM_SLOTS) {
+    return 0;
+  }
+  return (FONT_STREAM_SLOTS - used) * (FS_BLOCK + 4) - g_fs_wpos;
+}
+
+/**
+ * @brief  校验并写入已收到的块，在主循环中调用
+ * @retval FONT_STREAM_IDLE / FONT_STREAM_BUSY / FONT_STREAM_COMMITTED
+ * @retval W25Qxx_ERROR_* - 本次更新失败
+ */
+int8_t FontStream_Poll(void) {
+  uint32_t i = g_fs_out;
+  uint32_t len;
+  uint32_t crc;
+  uint8_t *slot;
+  int8_t status;
+
+  if (g_fs_bad_hdr) {
+    g_fs_bad_hdr = 0;
+    FontStream_Reply(FONT_STREAM_REPLY_ERROR);
+  }
+  if (g_fs_state == FS_DISCARD &&
+      HAL_GetTick() - g_fs_tick > FONT_STREAM_GAP_MS) {
+    FontStream_Reset(FS_HEADER);
+  }
+  if (g_fs_state != FS_DATA) {
+    return FONT_STREAM_IDLE;
+  }
+  if (!g_fs_begun) {
+    status = FlashFont_BankBegin(&g_fs_job, g_fs_size);
+    if (status != QSPI_W25Qxx_OK) {
+      return FontStream_Fail(status);
+    }
+    g_fs_begun = 1;
+  }
+  if (i == g_fs_in) {
+    if (HAL_GetTick() - g_fs_tick > FONT_STREAM_TIMEOUT_MS) {
+      return FontStream_Fail(W25Qxx_ERROR_TRANSMIT);
+    }
+    return FONT_STREAM_BUSY;
+  }
+
+  slot = g_fs_slot[i % FONT_STREAM_SLOTS];
+  len = FontStream_BlockLen(i);
+  memcpy(&crc, &slot[len], 4);
+  if (FlashFont_Crc32(slot, len) != crc) {
+    return FontStream_Fail(W25Qxx_ERROR_TRANSMIT);
+  }
+  status = FlashFont_BankWrite(&g_fs_job, i * FS_BLOCK, slot, len);
+  if (status == W25Qxx_ERROR_TRANSMIT) {
+    return FONT_STREAM_BUSY; // 字模预取进行中，下次重试
+  }
+  if (status != QSPI_W25Qxx_OK) {
+    return FontStream_Fail(status);
+  }
+  g_fs_out = i + 1;
+  g_fs_tick = HAL_GetTick(); // 擦写耗时不计入接收超时
+  if (g_fs_out < g_fs_blocks) {
+    return FONT_STREAM_BUSY;
+  }
+
+  status = FlashFont_BankCommit(&g_fs_job);
+  if (status != QSPI_W25Qxx_OK) {
+    return FontStream_Fail(status);
+  }
+  FontStream_Reset(FS_HEADER);
+  FontStream_Reply(FONT_STREAM_REPLY_OK);
+  return FONT_STREAM_COMMITTED;
+}
+
+/**
+ * @brief  读取更新进度
+ * @retval 1-更新进行中, 0-空闲
+ */
+uint8_t FontStream_GetProgress(uint32_t *done, uint32_t *total) {
+  uint8_t active = (g_fs_state == FS_DATA);
+
+  if (done != NULL) {
+    *done = active ? ((g_fs_out < g_fs_blocks) ? g_fs_out * FS_BLOCK : g_fs_size) : 0;
+  }
+  if (total != NULL) {
+    *total = active ? g_fs_size : 0;
+  }
+  return active;
+}
+
+#endif /* FONT_STREAM_ENABLE && FLASH_FONT_ENABLE */
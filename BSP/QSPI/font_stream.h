@@ -0,0 +1,124 @@
+/**
+ ******************************************************************************
+ * @file    font_stream.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   串行通道(USB CDC/串口)字库在线更新头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 上位机(FontBin/font_push.py)按下方格式发送字库镜像，接收中断把数据拷入
+ *   FONT_STREAM_SLOTS 个4KB块槽后立即返回，主循环中的 FontStream_Poll() 用硬件CRC
+ *   校验每块后以 FlashFont_BankWrite() 差分写入非活动分区，接收与擦写重叠进行
+ * - 差分写入时内容相同的扇区不擦写，只改了部分字模的镜像几秒即可写完；渲染全程
+ *   读取活动分区，更新期间界面照常显示
+ * - 任何一块CRC不符、超时或写入失败都放弃本次更新并回复 FONT_STREAM_REPLY_ERROR，
+ *   上位机停止发送，等待超过 FONT_STREAM_GAP_MS 后从头重发即可(已写好的扇区内容相同，不再擦写)
+ * - 全部写完后提交分区头，回复 FONT_STREAM_REPLY_OK，FontStream_Poll() 返回
+ *   FONT_STREAM_COMMITTED，调用 FlashFont_Init() 切换到新字库
+ * - 不依赖具体的USB协议栈：CDC接收回调中调用 FontStream_Receive()，
+ *   回复由 FontStream_Init() 传入的发送函数发出
+ * - 由 init.h 中的 FONT_STREAM_ENABLE 控制
+ *
+ * 传输格式(小端)：
+ *     头   uint32 magic "FUPD", uint32 size(镜像字节数), uint32 check(~(magic ^ size))
+ *     块   size按扇区(W25Qxx_SectorSize, 双片时8KB)依次分块, 每块 数据 + uint32 crc(与zlib.crc32相同)
+ *
+ * 使用示例(usbd_cdc_if.c)：
+ *     static int8_t CDC_Receive_FS(uint8_t *Buf, uint32_t *Len)
+ *     {
+ *         FontStream_Receive(Buf, *Len);
+ *         if (FontStream_Space() >= CDC_DATA_FS_MAX_PACKET_SIZE)
+ *             USBD_CDC_ReceivePacket(&hUsbDeviceFS);   // 否则等主循环中有空位后再接收
+ *         else
+ *             cdc_rx_paused = 1;
+ *         return USBD_OK;
+ *     }
+ *
+ ******************************************************************************
+ */
+
+#ifndef FONT_STREAM_H
+#define FONT_STREAM_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "flash_font.h"
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define FONT_STREAM_SLOTS 4             /*!< 块槽数(每槽一个扇区+4字节，双片时8KB)，擦写一块期间可以继续接收的块数 */
+#define FONT_STREAM_TIMEOUT_MS 3000     /*!< 超过该时间没有收到数据时放弃本次更新 */
+#define FONT_STREAM_GAP_MS 100          /*!< 失败后丢弃数据，直到该时间内没有再收到数据 */
+#define FONT_STREAM_MAGIC 0x44505546UL  /*!< 传输头魔数 "FUPD" */
+#ifndef FONT_STREAM_ATTR
+#define FONT_STREAM_ATTR /*!< 块槽存放位置，只由CPU读写 */
+#endif
+
+#define FONT_STREAM_REPLY_OK 'K'    /*!< 回复：更新已提交 */
+#define FONT_STREAM_REPLY_ERROR 'E' /*!< 回复：本次更新失败，需从头重发 */
+
+#define FONT_STREAM_IDLE 0      /*!< FontStream_Poll()：没有进行中的更新 */
+#define FONT_STREAM_BUSY 1      /*!< FontStream_Poll()：更新进行中 */
+#define FONT_STREAM_COMMITTED 2 /*!< FontStream_Poll()：新分区已提交 */
+
+/**
+ * @brief  回复发送函数类型
+ * @param  data: 回复数据
+ * @param  len: 字节数
+ * @note   在主循环中调用
+ */
+typedef void (*FontStream_Send_t)(const uint8_t *data, uint32_t len);
+
+    /*******************************************************************************
+     *                          导出函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  初始化接收状态，开始等待传输头
+     * @param  send: 回复发送函数，可为NULL
+     */
+    void FontStream_Init(FontStream_Send_t send);
+
+    /**
+     * @brief  接收数据，在CDC/串口接收回调中调用
+     * @param  data: 收到的数据
+     * @param  len: 字节数
+     * @note   只拷贝数据，不访问Flash，可在中断中调用
+     * @retval 接收的字节数，块槽已满时小于len
+     */
+    uint32_t FontStream_Receive(const uint8_t *data, uint32_t len);
+
+    /**
+     * @brief  查询块槽剩余空间
+     * @note   返回值不小于一个USB包长时，下一包一定能全部接收
+     * @retval 还能接收的字节数
+     */
+    uint32_t FontStream_Space(void);
+
+    /**
+     * @brief  校验并写入已收到的块，在主循环中调用
+     * @note   每次最多写入一块(一个扇区)，单次阻塞不超过 W25Qxx_MAPPED_STEP_MAX_MS
+     * @retval FONT_STREAM_IDLE / FONT_STREAM_BUSY / FONT_STREAM_COMMITTED
+     * @retval W25Qxx_ERROR_* - 本次更新失败(已回复 FONT_STREAM_REPLY_ERROR)
+     */
+    int8_t FontStream_Poll(void);
+
+    /**
+     * @brief  读取更新进度
+     * @param  done: 输出已写入Flash的字节数，可为NULL
+     * @param  total: 输出镜像总字节数，可为NULL
+     * @retval 1-更新进行中, 0-空闲
+     */
+    uint8_t FontStream_GetProgress(uint32_t *done, uint32_t *total);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FONT_STREAM_H
@@ -0,0 +1,460 @@
+/**
+ ******************************************************************************
+ * @file    glyph_cache.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   字模位图LRU缓存实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 实现方式：
+ * - 槽位数组 + 哈希桶单链表定位 + 双向链表维护LRU顺序
+ * - 链表指针均为uint8_t槽号，元数据每槽12字节(含字模源地址，按改写范围作废时使用)
+ * - 全部操作O(1)，无动态内存分配
+ * - 锁定分区是独立的数组，按锁定顺序存放，查找为有界的顺序比较
+ *
+ ******************************************************************************
+ */
+
+#include "flash_font.h"
+#include <string.h>
+
+#if defined(FLASH_FONT_ENABLE) && defined(GLYPH_CACHE_ENABLE)
+
+/*******************************************************************************
+ *                              私有宏定义
+ ******************************************************************************/
+#define GC_NONE 0xFF                            /*!< 空链接标记 */
+#define GC_BUCKETS (1UL << GLYPH_CACHE_BUCKET_BITS) /*!< 哈希桶数 */
+
+#if GLYPH_CACHE_SLOTS < 1 || GLYPH_CACHE_SLOTS >= GC_NONE
+#error "GLYPH_CACHE_SLOTS 必须在1-254之间"
+#endif
+#if GLYPH_CACHE_LOCK_SLOTS < 0 || GLYPH_CACHE_LOCK_SLOTS >= GC_NONE
+#error "GLYPH_CACHE_LOCK_SLOTS 必须在0-254之间"
+#endif
+
+/*******************************************************************************
+ *                              私有类型与变量
+ ******************************************************************************/
+
+/**
+ * @brief  缓存槽元数据(12字节)
+ */
+typedef struct {
+  uint32_t key;  /*!< 字符键 */
+  const uint8_t *src; /*!< 字模源地址 */
+  uint8_t size;  /*!< 字体大小，0表示已作废 */
+  uint8_t prev;  /*!< LRU前驱(更近使用) */
+  uint8_t next;  /*!< LRU后继(更久未使用) */
+  uint8_t hnext; /*!< 同一哈希桶中的下一项 */
+} GlyphSlot_t;
+
+GLYPH_CACHE_ATTR static uint32_t
+    g_gc_data[GLYPH_CACHE_SLOTS][(GLYPH_CACHE_SLOT_BYTES + 3) / 4]; /*!< 字模数据(4字节对齐) */
+GLYPH_CACHE_ATTR static GlyphSlot_t g_gc_slot[GLYPH_CACHE_SLOTS]; /*!< 槽元数据 */
+GLYPH_CACHE_ATTR static uint8_t g_gc_bucket[GC_BUCKETS];          /*!< 哈希桶头 */
+static uint8_t g_gc_head = GC_NONE;              /*!< 最近使用 */
+static uint8_t g_gc_tail = GC_NONE;              /*!< 最久未使用 */
+static uint8_t g_gc_mark = GC_NONE; /*!< 工作集起点之前最近使用的槽，GC_NONE表示整个链表 */
+static uint16_t g_gc_used = 0;                   /*!< 已使用槽数 */
+static uint16_t g_gc_limit = GLYPH_CACHE_SLOTS;  /*!< 运行时可用的槽数 */
+static uint8_t g_gc_ready = 0;                   /*!< 链表是否已初始化 */
+static GlyphCache_Stats_t g_gc_stats;            /*!< 统计信息 */
+
+#if GLYPH_CACHE_LOCK_SLOTS > 0
+/**
+ * @brief  锁定分区的一项
+ */
+typedef struct {
+  uint32_t key; /*!< 字符键 */
+  uint8_t size; /*!< 字体大小 */
+} GlyphLock_t;
+
+GLYPH_CACHE_ATTR static uint32_t
+    g_gc_lock_data[GLYPH_CACHE_LOCK_SLOTS][(GLYPH_CACHE_SLOT_BYTES + 3) / 4]; /*!< 锁定的字模数据 */
+GLYPH_CACHE_ATTR static GlyphLock_t g_gc_lock[GLYPH_CACHE_LOCK_SLOTS]; /*!< 锁定项的键 */
+GLYPH_CACHE_ATTR static uint16_t g_gc_locked; /*!< 锁定的字模数 */
+#endif
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  计算(键, 字号)的哈希桶号
+ */
+static inline uint32_t GC_Hash(uint32_t key, uint8_t font_size) {
+  return (uint32_t)((key ^ ((uint32_t)font_size << 24)) * 2654435761U) >>
+         (32 - GLYPH_CACHE_BUCKET_BITS);
+}
+
+/**
+ * @brief  把槽从LRU链表中摘下
+ */
+static void GC_Unlink(uint8_t slot) {
+  GlyphSlot_t *s = &g_gc_slot[slot];
+
+  if (slot == g_gc_mark) {
+    g_gc_mark = s->next; // 被移动的槽之后才是工作集以外的部分
+  }
+  if (s->prev != GC_NONE) {
+    g_gc_slot[s->prev].next = s->next;
+  } else {
+    g_gc_head = s->next;
+  }
+  if (s->next != GC_NONE) {
+    g_gc_slot[s->next].prev = s->prev;
+  } else {
+    g_gc_tail = s->prev;
+  }
+}
+
+/**
+ * @brief  把槽插到LRU链表头部(最近使用)
+ */
+static void GC_PushFront(uint8_t slot) {
+  GlyphSlot_t *s = &g_gc_slot[slot];
+
+  s->prev = GC_NONE;
+  s->next = g_gc_head;
+  if (g_gc_head != GC_NONE) {
+    g_gc_slot[g_gc_head].prev = slot;
+  }
+  g_gc_head = slot;
+  if (g_gc_tail == GC_NONE) {
+    g_gc_tail = slot;
+  }
+}
+
+/**
+ * @brief  把槽从所在哈希桶中移除
+ */
+static void GC_RemoveHash(uint8_t slot) {
+  uint8_t *link =
+      &g_gc_bucket[GC_Hash(g_gc_slot[slot].key, g_gc_slot[slot].size)];
+
+  while (*link != GC_NONE) {
+    if (*link == slot) {
+      *link = g_gc_slot[slot].hnext;
+      return;
+    }
+    link = &g_gc_slot[*link].hnext;
+  }
+}
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  清空缓存(字库更新后必须调用)
+ */
+void GlyphCache_Clear(void) {
+  memset(g_gc_bucket, GC_NONE, sizeof(g_gc_bucket));
+  memset(&g_gc_stats, 0, sizeof(g_gc_stats));
+  g_gc_head = GC_NONE;
+  g_gc_tail = GC_NONE;
+  g_gc_mark = GC_NONE;
+  g_gc_used = 0;
+  g_gc_stats.capacity = GLYPH_CACHE_SLOTS;
+  g_gc_ready = 1;
+}
+
+/**
+ * @brief  查找缓存中的字模
+ * @param  key: 字符键(Unicode码点)
+ * @param  font_size: 字体大小
+ * @retval 字模数据指针，未命中返回NULL
+ */
+ITCM_CODE const uint8_t *GlyphCache_Lookup(uint32_t key, uint8_t font_size) {
+  uint8_t slot;
+
+  if (!g_gc_ready) {
+    GlyphCache_Clear();
+  }
+
+  slot = g_gc_bucket[GC_Hash(key, font_size)];
+  while (slot != GC_NONE) {
+    if (g_gc_slot[slot].key == key && g_gc_slot[slot].size == font_size) {
+      if (slot != g_gc_head) {
+        GC_Unlink(slot);
+        GC_PushFront(slot);
+      } else if (slot == g_gc_mark) {
+        g_gc_mark = g_gc_slot[slot].next;
+      }
+      g_gc_stats.hits++;
+      return (const uint8_t *)g_gc_data[slot];
+    }
+    slot = g_gc_slot[slot].hnext;
+  }
+
+  g_gc_stats.misses++;
+  return NULL;
+}
+
+/**
+ * @brief  把字模拷贝进缓存
+ * @param  key: 字符键(Unicode码点)
+ * @param  font_size: 字体大小
+ * @param  src: 字模源数据
+ * @param  bytes: 字模字节数
+ * @retval 缓存中的字模指针，字模过大返回src本身
+ * @note   键已存在时直接返回已有缓存项，不重复占用槽位
+ */
+const uint8_t *GlyphCache_Insert(uint32_t key, uint8_t font_size,
+                                 const uint8_t *src, uint16_t bytes) {
+  return GlyphCache_InsertFrom(key, font_size, src, src, bytes);
+}
+
+/**
+ * @brief  把已读到RAM的字模拷贝进缓存
+ * @param  key: 字符键(Unicode码点)
+ * @param  font_size: 字体大小
+ * @param  data: 字模数据(如MDMA暂存区)
+ * @param  src: 字模在映射区中的源地址，按改写范围作废时比较
+ * @param  bytes: 字模字节数
+ * @retval 缓存中的字模指针，字模过大返回data本身
+ */
+const uint8_t *GlyphCache_InsertFrom(uint32_t key, uint8_t font_size,
+                                     const uint8_t *data, const uint8_t *src,
+                                     uint16_t bytes) {
+  uint8_t slot;
+  uint32_t bucket;
+
+  if (data == NULL || bytes > GLYPH_CACHE_SLOT_BYTES) {
+    return data;
+  }
+  if (!g_gc_ready) {
+    GlyphCache_Clear();
+  }
+
+  // 同一批次中重复出现的字符只占一个槽
+  bucket = GC_Hash(key, font_size);
+  for (slot = g_gc_bucket[bucket]; slot != GC_NONE;
+       slot = g_gc_slot[slot].hnext) {
+    if (g_gc_slot[slot].key == key && g_gc_slot[slot].size == font_size) {
+      return (const uint8_t *)g_gc_data[slot];
+    }
+  }
+
+  if (g_gc_used < g_gc_limit) {
+    slot = (uint8_t)g_gc_used++; // 还有空槽
+  } else {
+    slot = g_gc_tail; // 淘汰最久未使用的字模(已作废的槽排在最后)
+    GC_Unlink(slot);
+    if (g_gc_slot[slot].size != 0) {
+      GC_RemoveHash(slot);
+      g_gc_stats.evictions++;
+    }
+  }
+
+  memcpy(g_gc_data[slot], data, bytes);
+  g_gc_stats.fill_bytes += bytes;
+  g_gc_slot[slot].key = key;
+  g_gc_slot[slot].src = src;
+  g_gc_slot[slot].size = font_size;
+
+  g_gc_slot[slot].hnext = g_gc_bucket[bucket];
+  g_gc_bucket[bucket] = slot;
+  GC_PushFront(slot);
+
+  return (const uint8_t *)g_gc_data[slot];
+}
+
+/**
+ * @brief  作废字模源与改写范围重叠的缓存项
+ * @param  start: 改写范围起始(内存映射地址)
+ * @param  size: 改写字节数
+ * @retval 作废的项数
+ * @note   作废的槽移到LRU尾部，下次插入时优先复用
+ */
+uint16_t GlyphCache_Invalidate(const uint8_t *start, uint32_t size) {
+  uint16_t n = 0;
+
+  if (!g_gc_ready) {
+    return 0;
+  }
+  for (uint16_t i = 0; i < g_gc_used; i++) {
+    GlyphSlot_t *s = &g_gc_slot[i];
+
+    if (s->size == 0 || s->src >= start + size ||
+        s->src + GLYPH_CACHE_SLOT_BYTES <= start) {
+      continue;
+    }
+    GC_RemoveHash((uint8_t)i);
+    s->size = 0;
+    GC_Unlink((uint8_t)i);
+    // 接到LRU尾部
+    s->next = GC_NONE;
+    s->prev = g_gc_tail;
+    if (g_gc_tail != GC_NONE) {
+      g_gc_slot[g_gc_tail].next = (uint8_t)i;
+    } else {
+      g_gc_head = (uint8_t)i;
+    }
+    g_gc_tail = (uint8_t)i;
+    n++;
+  }
+  return n;
+}
+
+/**
+ * @brief  读取缓存统计信息
+ * @param  stats: 输出统计信息
+ */
+void GlyphCache_GetStats(GlyphCache_Stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  g_gc_stats.used = g_gc_used;
+  g_gc_stats.capacity = GLYPH_CACHE_SLOTS;
+  g_gc_stats.limit = g_gc_limit;
+#if GLYPH_CACHE_LOCK_SLOTS > 0
+  g_gc_stats.locked = g_gc_locked;
+#endif
+  *stats = g_gc_stats;
+}
+
+/**
+ * @brief  限制运行时使用的槽数
+ * @param  slots: 槽数，0表示全部
+ * @retval 生效的槽数
+ * @note   只用前 slots 个槽：调小时移除后面的槽，调大时已缓存的字模全部保留
+ */
+uint16_t GlyphCache_SetLimit(uint16_t slots) {
+  if (slots == 0 || slots > GLYPH_CACHE_SLOTS) {
+    slots = GLYPH_CACHE_SLOTS;
+  }
+#ifdef GLYPH_PREFETCH_ENABLE
+  if (slots < GLYPH_PREFETCH_MAX) {
+    slots = GLYPH_PREFETCH_MAX; // 一批预取的字模要能同时留在缓存中
+  }
+#endif
+  if (!g_gc_ready) {
+    GlyphCache_Clear();
+  }
+  // 槽按序号顺序分配，移除 slots 之后的槽后前面仍然连续
+  for (uint16_t i = slots; i < g_gc_used; i++) {
+    if (g_gc_slot[i].size != 0) {
+      GC_RemoveHash((uint8_t)i);
+      g_gc_stats.evictions++;
+    }
+    GC_Unlink((uint8_t)i);
+  }
+  if (g_gc_used > slots) {
+    g_gc_used = slots;
+  }
+  g_gc_limit = slots;
+  return slots;
+}
+
+/**
+ * @brief  开始记录新的工作集(切换页面时调用)
+ * @note   只记下当前的LRU链表头：之后用到的槽都会移到它前面，
+ *         它自己被移动或淘汰时起点顺延到链表中的下一个槽
+ */
+void GlyphCache_MarkWorkingSet(void) {
+  if (!g_gc_ready) {
+    GlyphCache_Clear();
+  }
+  g_gc_mark = g_gc_head;
+}
+
+/**
+ * @brief  读取工作集中的字模键
+ * @param  keys: 输出缓存键
+ * @param  sizes: 输出字号
+ * @param  max: 数组项数
+ * @retval 输出的项数，按最近使用在前
+ */
+uint16_t GlyphCache_GetWorkingSet(uint32_t *keys, uint8_t *sizes,
+                                  uint16_t max) {
+  uint16_t n = 0;
+
+  if (!g_gc_ready || keys == NULL || sizes == NULL) {
+    return 0;
+  }
+  for (uint8_t slot = g_gc_head; slot != GC_NONE && slot != g_gc_mark && n < max;
+       slot = g_gc_slot[slot].next) {
+    if (g_gc_slot[slot].size != 0) {
+      keys[n] = g_gc_slot[slot].key;
+      sizes[n] = g_gc_slot[slot].size;
+      n++;
+    }
+  }
+  return n;
+}
+
+#if GLYPH_CACHE_LOCK_SLOTS > 0
+/**
+ * @brief  把字模拷贝进锁定分区
+ * @param  key: 字符键
+ * @param  font_size: 字体大小
+ * @param  src: 字模源数据
+ * @param  bytes: 字模字节数
+ * @retval 锁定分区中的字模指针，放不下返回NULL
+ */
+const uint8_t *GlyphCache_Lock(uint32_t key, uint8_t font_size,
+                               const uint8_t *src, uint16_t bytes) {
+  const uint8_t *p = GlyphCache_LockedFind(key, font_size);
+
+  if (p != NULL) {
+    return p; // 重复字符只占一项
+  }
+  if (src == NULL || bytes > GLYPH_CACHE_SLOT_BYTES ||
+      g_gc_locked >= GLYPH_CACHE_LOCK_SLOTS) {
+    return NULL;
+  }
+  memcpy(g_gc_lock_data[g_gc_locked], src, bytes);
+  g_gc_lock[g_gc_locked].key = key;
+  g_gc_lock[g_gc_locked].size = font_size;
+  return (const uint8_t *)g_gc_lock_data[g_gc_locked++];
+}
+
+/**
+ * @brief  在锁定分区中查找字模
+ * @param  key: 字符键
+ * @param  font_size: 字体大小
+ * @retval 字模数据指针，未锁定返回NULL
+ * @note   代码和数据都在TCM中，不访问QSPI
+ */
+ITCM_CODE const uint8_t *GlyphCache_LockedFind(uint32_t key,
+                                               uint8_t font_size) {
+  for (uint16_t i = 0; i < g_gc_locked; i++) {
+    if (g_gc_lock[i].key == key && g_gc_lock[i].size == font_size) {
+      return (const uint8_t *)g_gc_lock_data[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief  清空锁定分区
+ */
+void GlyphCache_Unlock(void) { g_gc_locked = 0; }
+#endif
+
+#ifdef PERF_MEMORY_ENABLE
+/**
+ * @brief  填写字模缓存的内存占用
+ * @param  entry: 输出
+ */
+void GlyphCache_GetMemory(PerfMemory_Entry_t *entry) {
+  entry->name = "glyph";
+  entry->unit = "slot";
+  entry->base = g_gc_data;
+  entry->bytes = sizeof(g_gc_data) + sizeof(g_gc_slot) + sizeof(g_gc_bucket);
+#if GLYPH_CACHE_LOCK_SLOTS > 0
+  entry->bytes += sizeof(g_gc_lock_data) + sizeof(g_gc_lock);
+#endif
+  entry->capacity = GLYPH_CACHE_SLOTS;
+  entry->limit = g_gc_limit;
+  entry->used = g_gc_used;
+  entry->peak = entry->used; // 槽只在清空时回收，已用槽数即为峰值
+  entry->hits = g_gc_stats.hits;
+  entry->misses = g_gc_stats.misses;
+  entry->resizable = 1;
+}
+#endif
+
+#endif /* FLASH_FONT_ENABLE && GLYPH_CACHE_ENABLE */
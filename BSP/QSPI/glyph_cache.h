@@ -0,0 +1,182 @@
+/**
+ ******************************************************************************
+ * @file    glyph_cache.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   字模位图LRU缓存头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 位于字库查找(flash_font.c)与字模绘制(DrawFont_Bitmap)之间
+ * - 以(码点, 字号)为键缓存1bpp字模，命中时直接从片内SRAM读取，不再访问QSPI
+ * - 槽位用完后按LRU淘汰最久未使用的字模
+ * - 返回的缓存指针在之后插入GLYPH_CACHE_SLOTS个新字模之前保持有效
+ * - GlyphCache_MarkWorkingSet() 之后查到或装入的字模构成工作集，
+ *   GlyphCache_GetWorkingSet() 按最近使用顺序取出它们的键(页面字模快照使用)
+ * - GLYPH_CACHE_LOCK_SLOTS 大于0时另有一个锁定分区：GlyphCache_Lock() 拷入的字模
+ *   不参与LRU，也不被 GlyphCache_Clear()、GlyphCache_Invalidate() 移除，
+ *   GlyphCache_LockedFind() 只查这个分区(报警显示 LCD_Alarm_Show() 使用)
+ *
+ ******************************************************************************
+ */
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define GLYPH_CACHE_ENABLE /*!< 定义了：启用字模缓存, 注释后：每次都从QSPI读取字模 */
+#define GLYPH_CACHE_SLOTS 64 /*!< 缓存槽数(1-254)，每槽GLYPH_CACHE_SLOT_BYTES字节 */
+#define GLYPH_CACHE_SLOT_BYTES ((((FONT_SIZE_MAX + 31) / 32 * 4 * FONT_SIZE_MAX) + 31) / 32 * 32) /*!< 每槽字节数，按 init.h 中启用的最大字号的4字节行宽字模取整到32字节(32号为128字节) */
+#define GLYPH_CACHE_BUCKET_BITS 7 /*!< 哈希桶数=2^N，建议不小于槽数的2倍 */
+#ifndef GLYPH_CACHE_LOCK_SLOTS
+#define GLYPH_CACHE_LOCK_SLOTS 0 /*!< 锁定分区槽数(0-254)，每槽GLYPH_CACHE_SLOT_BYTES字节，0：不分配；定义 LCD_ALARM_ENABLE 时不小于报警字符数 */
+#endif
+#ifndef GLYPH_CACHE_ATTR
+#define GLYPH_CACHE_ATTR DTCM_BSS /*!< 缓存存放位置，默认DTCM(需定义 TCM_ENABLE，见init.h)，也可定义为其他section属性 */
+#endif
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  缓存统计信息
+     */
+    typedef struct
+    {
+        uint32_t hits;      /*!< 命中次数 */
+        uint32_t misses;    /*!< 未命中次数 */
+        uint32_t evictions; /*!< 淘汰次数 */
+        uint32_t fill_bytes; /*!< 装入缓存的字模字节数(未命中时从QSPI读取的量) */
+        uint16_t used;      /*!< 已使用槽数 */
+        uint16_t capacity;  /*!< 总槽数 */
+        uint16_t limit;     /*!< 运行时可用的槽数(GlyphCache_SetLimit()) */
+        uint16_t locked;    /*!< 锁定分区中的字模数 */
+    } GlyphCache_Stats_t;
+
+    /*******************************************************************************
+     *                          导出函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  清空缓存(字库更新后必须调用)
+     * @note   统计信息同时清零，锁定分区保留
+     */
+    void GlyphCache_Clear(void);
+
+    /**
+     * @brief  查找缓存中的字模
+     * @param  key: 字符键(Unicode码点)
+     * @param  font_size: 字体大小
+     * @retval 字模数据指针，未命中返回NULL
+     * @note   命中时该项移到LRU链表头部
+     */
+    const uint8_t *GlyphCache_Lookup(uint32_t key, uint8_t font_size);
+
+    /**
+     * @brief  把字模拷贝进缓存
+     * @param  key: 字符键(Unicode码点)
+     * @param  font_size: 字体大小
+     * @param  src: 字模源数据(通常位于QSPI内存映射区)
+     * @param  bytes: 字模字节数
+     * @retval 缓存中的字模指针，字模过大返回src本身
+     */
+    const uint8_t *GlyphCache_Insert(uint32_t key, uint8_t font_size,
+                                     const uint8_t *src, uint16_t bytes);
+
+    /**
+     * @brief  把已读到RAM的字模拷贝进缓存(字模预取使用)
+     * @param  key: 字符键(Unicode码点)
+     * @param  font_size: 字体大小
+     * @param  data: 字模数据
+     * @param  src: 字模在映射区中的源地址
+     * @param  bytes: 字模字节数
+     * @retval 缓存中的字模指针，字模过大返回data本身
+     */
+    const uint8_t *GlyphCache_InsertFrom(uint32_t key, uint8_t font_size,
+                                         const uint8_t *data, const uint8_t *src,
+                                         uint16_t bytes);
+
+    /**
+     * @brief  作废字模源与改写范围重叠的缓存项(Flash局部改写后调用)
+     * @param  start: 改写范围起始(内存映射地址)
+     * @param  size: 改写字节数
+     * @retval 作废的项数
+     * @note   其余缓存项和统计信息保留
+     */
+    uint16_t GlyphCache_Invalidate(const uint8_t *start, uint32_t size);
+
+    /**
+     * @brief  读取缓存统计信息
+     * @param  stats: 输出统计信息
+     */
+    void GlyphCache_GetStats(GlyphCache_Stats_t *stats);
+
+    /**
+     * @brief  限制运行时使用的槽数(按产品型号调整内存与命中率)
+     * @param  slots: 槽数，0或超过 GLYPH_CACHE_SLOTS 时为 GLYPH_CACHE_SLOTS；
+     *                启用字模预取时不小于 GLYPH_PREFETCH_MAX
+     * @retval 生效的槽数
+     * @note   调小时移除序号在 slots 之后的槽，其余字模和统计保留；存储区仍按 GLYPH_CACHE_SLOTS 静态分配
+     */
+    uint16_t GlyphCache_SetLimit(uint16_t slots);
+
+    /**
+     * @brief  开始记录新的工作集(切换页面时调用)
+     * @note   不移动任何槽，之后查到(命中)或装入的字模计入工作集
+     */
+    void GlyphCache_MarkWorkingSet(void);
+
+    /**
+     * @brief  读取 GlyphCache_MarkWorkingSet() 之后用到、仍在缓存中的字模键
+     * @param  keys: 输出缓存键(FlashFont_GlyphKey)
+     * @param  sizes: 输出对应的字号
+     * @param  max: 数组项数
+     * @retval 输出的项数，按最近使用在前，超过 max 时只取最近的部分
+     */
+    uint16_t GlyphCache_GetWorkingSet(uint32_t *keys, uint8_t *sizes,
+                                      uint16_t max);
+
+#if GLYPH_CACHE_LOCK_SLOTS > 0
+    /**
+     * @brief  把字模拷贝进锁定分区
+     * @param  key: 字符键(FlashFont_GlyphKey)
+     * @param  font_size: 字体大小
+     * @param  src: 字模源数据
+     * @param  bytes: 字模字节数
+     * @retval 锁定分区中的字模指针，分区已满、字模过大或src为NULL时返回NULL
+     * @note   键已锁定时直接返回已有的拷贝；拷贝在 GlyphCache_Unlock() 之前一直有效，
+     *         字库更新后内容不会随之改变，需要时先解锁再重新锁定
+     */
+    const uint8_t *GlyphCache_Lock(uint32_t key, uint8_t font_size,
+                                   const uint8_t *src, uint16_t bytes);
+
+    /**
+     * @brief  在锁定分区中查找字模
+     * @param  key: 字符键(FlashFont_GlyphKey)
+     * @param  font_size: 字体大小
+     * @retval 字模数据指针，未锁定返回NULL
+     * @note   最多比较 GLYPH_CACHE_LOCK_SLOTS 项，不改变LRU顺序和统计，耗时只取决于分区大小
+     */
+    const uint8_t *GlyphCache_LockedFind(uint32_t key, uint8_t font_size);
+
+    /**
+     * @brief  清空锁定分区
+     */
+    void GlyphCache_Unlock(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GLYPH_CACHE_H
@@ -0,0 +1,662 @@
+/**
+ ******************************************************************************
+ * @file    glyph_prefetch.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   字模MDMA批量预取实现文件
+ ******************************************************************************
+ * @attention
+ *
+ * 实现方式：
+ * - 每个待取字模对应一个MDMA链表节点：QSPI映射地址 -> 暂存区第i槽
+ * - 通道以软件请求 + MDMA_FULL_TRANSFER 启动，一次请求走完整个链表
+ * - 暂存区每槽GLYPH_CACHE_SLOT_BYTES字节，与字模缓存槽一致，提交时逐个插入
+ * - 节点和暂存区位于可Cache的SRAM，启动前清理节点、失效暂存区
+ * - 登记队列是字符串指针的环形缓冲区，队首字符串记录续传位置，
+ *   每批最多 GLYPH_PREFETCH_MAX 个字模，提交后再从续传位置解析下一批
+ * - 页面快照是按最近进入排序的记录表，每条保存页面ID和字模缓存工作集的
+ *   (缓存键, 字号)；进入页面时把该页记录移到表头，从表头记录续传预取，
+ *   先于登记队列进行；存放在备份SRAM时带魔数和校验，复位后先验证再使用
+ * - 切换语言时登记字库中该语言的字符集(映射区UTF-8串)，排在登记队列之后，
+ *   最多预取字模缓存当前上限个字，字符集按出现次数降序，超出的不常用字不挤掉常用字
+ *
+ ******************************************************************************
+ */
+
+#include "flash_font.h"
+#include <string.h>
+
+#if defined(FLASH_FONT_ENABLE) && defined(GLYPH_CACHE_ENABLE) &&               \
+    defined(GLYPH_PREFETCH_ENABLE)
+
+#if GLYPH_PREFETCH_MAX < 1 || GLYPH_PREFETCH_MAX > GLYPH_CACHE_SLOTS
+#error "GLYPH_PREFETCH_MAX 必须在1到GLYPH_CACHE_SLOTS之间"
+#endif
+#if GLYPH_PREFETCH_QUEUE < 1 || GLYPH_PREFETCH_QUEUE > 255
+#error "GLYPH_PREFETCH_QUEUE 必须在1-255之间"
+#endif
+#if (GLYPH_CACHE_SLOT_BYTES % 32) != 0
+#error "GLYPH_CACHE_SLOT_BYTES 必须是Cache行(32字节)的整数倍"
+#endif
+
+/*******************************************************************************
+ *                              私有类型与变量
+ ******************************************************************************/
+
+#define GP_IDLE 0 /*!< 空闲 */
+#define GP_BUSY 1 /*!< MDMA传输中 */
+#define GP_DONE 2 /*!< 传输完成，等待提交 */
+
+static MDMA_HandleTypeDef g_gp_mdma; /*!< MDMA句柄 */
+GLYPH_PREFETCH_ATTR static MDMA_LinkNodeTypeDef
+    g_gp_node[GLYPH_PREFETCH_MAX] __attribute__((aligned(32))); /*!< 链表节点 */
+GLYPH_PREFETCH_ATTR static uint8_t
+    g_gp_stage[GLYPH_PREFETCH_MAX][GLYPH_CACHE_SLOT_BYTES]
+    __attribute__((aligned(32))); /*!< 字模暂存区 */
+static uint32_t g_gp_key[GLYPH_PREFETCH_MAX];   /*!< 各槽缓存键(FlashFont_GlyphKey) */
+static uint16_t g_gp_bytes[GLYPH_PREFETCH_MAX]; /*!< 各槽字节数 */
+static const uint8_t *g_gp_src[GLYPH_PREFETCH_MAX]; /*!< 各槽字模源地址 */
+static uint32_t g_gp_epoch = 0;                  /*!< 启动时的Flash改写序号 */
+static uint8_t g_gp_size[GLYPH_PREFETCH_MAX];   /*!< 各槽字号 */
+static uint16_t g_gp_count = 0;                 /*!< 本次预取字模数 */
+static volatile uint8_t g_gp_state = GP_IDLE;    /*!< 预取状态 */
+static uint8_t g_gp_ready = 0;                   /*!< MDMA是否已初始化 */
+
+static const char *g_gq_text[GLYPH_PREFETCH_QUEUE]; /*!< 登记的字符串 */
+static uint8_t g_gq_size[GLYPH_PREFETCH_QUEUE];     /*!< 各字符串的字号 */
+static const uint8_t *g_gq_pos = NULL; /*!< 队首字符串的续传位置，NULL表示从头开始 */
+static uint8_t g_gq_head = 0;          /*!< 队首 */
+static uint8_t g_gq_count = 0;         /*!< 登记数 */
+
+static const uint8_t *g_gl_pos = NULL; /*!< 语言字符集的续传位置，NULL表示没有 */
+static uint8_t g_gl_size = 0;          /*!< 语言字符集的字号 */
+static uint16_t g_gl_left = 0;         /*!< 语言字符集还可预取的字模数 */
+static uint32_t g_gl_epoch = 0;        /*!< 登记时的Flash改写序号 */
+
+#ifdef GLYPH_SCREEN_ENABLE
+#if GLYPH_SCREEN_MAX < 1 || GLYPH_SCREEN_MAX > 255
+#error "GLYPH_SCREEN_MAX 必须在1-255之间"
+#endif
+#if GLYPH_SCREEN_GLYPHS < 1 || GLYPH_SCREEN_GLYPHS > GLYPH_CACHE_SLOTS
+#error "GLYPH_SCREEN_GLYPHS 必须在1到GLYPH_CACHE_SLOTS之间"
+#endif
+#if defined(GLYPH_SCREEN_BACKUP_ENABLE) &&                                     \
+    (8 + GLYPH_SCREEN_MAX * (GLYPH_SCREEN_GLYPHS * 5 + 7)) > 4096
+#error "页面快照超出4KB备份SRAM，请减小 GLYPH_SCREEN_MAX 或 GLYPH_SCREEN_GLYPHS"
+#endif
+
+#define GS_MAGIC 0x53435247U          /*!< 快照表魔数 "GRCS" */
+#define GS_FAMILY_MASK (0x07U << 24)  /*!< FlashFont_GlyphKey() 中字体族所在的位 */
+
+/**
+ * @brief  一个页面的字模快照
+ */
+typedef struct {
+  uint32_t key[GLYPH_SCREEN_GLYPHS]; /*!< 缓存键，最近使用在前 */
+  uint8_t size[GLYPH_SCREEN_GLYPHS]; /*!< 字号 */
+  uint16_t screen;                   /*!< 页面ID，GLYPH_SCREEN_NONE为空记录 */
+  uint8_t count;                     /*!< 字模数 */
+  uint8_t reserved;
+} GS_Screen_t;
+
+/**
+ * @brief  快照表，按最近进入的页面在前排列
+ */
+typedef struct {
+  uint32_t magic;                        /*!< GS_MAGIC */
+  GS_Screen_t screen[GLYPH_SCREEN_MAX];  /*!< 页面记录 */
+  uint32_t check;                        /*!< 记录的校验值 */
+} GS_Store_t;
+
+#ifdef GLYPH_SCREEN_BACKUP_ENABLE
+#define GS_STORE ((GS_Store_t *)D3_BKPSRAM_BASE) /*!< 备份SRAM(复位不清零) */
+#else
+static GS_Store_t g_gs_ram;
+#define GS_STORE (&g_gs_ram)
+#endif
+
+static uint8_t g_gs_ready = 0;                   /*!< 快照表是否已验证 */
+static uint16_t g_gs_current = GLYPH_SCREEN_NONE; /*!< 当前页面 */
+static uint8_t g_gs_restore = 0; /*!< 1-表头记录待预取 */
+static uint8_t g_gs_pos = 0;     /*!< 表头记录的续传位置 */
+static uint32_t g_gs_keys[GLYPH_SCREEN_GLYPHS]; /*!< 读取工作集用 */
+static uint8_t g_gs_sizes[GLYPH_SCREEN_GLYPHS];
+#endif
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  MDMA传输完成回调
+ */
+static void GP_XferCplt(MDMA_HandleTypeDef *hmdma) {
+  (void)hmdma;
+  g_gp_state = GP_DONE;
+}
+
+/**
+ * @brief  MDMA传输出错回调，丢弃本次预取
+ */
+static void GP_XferError(MDMA_HandleTypeDef *hmdma) {
+  (void)hmdma;
+  g_gp_count = 0;
+  g_gp_state = GP_IDLE;
+}
+
+/**
+ * @brief  配置MDMA通道参数(软件请求，整链一次传完，按字节搬运)
+ * @retval HAL_OK - 成功
+ * @note   每次启动前重新初始化，同时清空上一次的链表
+ */
+static HAL_StatusTypeDef GP_InitChannel(void) {
+  if (!g_gp_ready) {
+    __HAL_RCC_MDMA_CLK_ENABLE();
+    HAL_NVIC_SetPriority(MDMA_IRQn, GLYPH_PREFETCH_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(MDMA_IRQn);
+    g_gp_ready = 1;
+  }
+
+  g_gp_mdma.Instance = GLYPH_PREFETCH_CHANNEL;
+  g_gp_mdma.Init.Request = MDMA_REQUEST_SW;
+  g_gp_mdma.Init.TransferTriggerMode = MDMA_FULL_TRANSFER;
+  g_gp_mdma.Init.Priority = MDMA_PRIORITY_LOW;
+  g_gp_mdma.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+  g_gp_mdma.Init.SourceInc = MDMA_SRC_INC_BYTE;
+  g_gp_mdma.Init.DestinationInc = MDMA_DEST_INC_BYTE;
+  g_gp_mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_BYTE; // 字模地址不保证对齐
+  g_gp_mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_BYTE;
+  g_gp_mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+  g_gp_mdma.Init.BufferTransferLength = 128; // 单次缓冲传输最大长度
+  g_gp_mdma.Init.SourceBurst = MDMA_SOURCE_BURST_SINGLE;
+  g_gp_mdma.Init.DestBurst = MDMA_DEST_BURST_SINGLE;
+  g_gp_mdma.Init.SourceBlockAddressOffset = 0;
+  g_gp_mdma.Init.DestBlockAddressOffset = 0;
+  if (HAL_MDMA_Init(&g_gp_mdma) != HAL_OK) {
+    return HAL_ERROR;
+  }
+
+  HAL_MDMA_RegisterCallback(&g_gp_mdma, HAL_MDMA_XFER_CPLT_CB_ID, GP_XferCplt);
+  HAL_MDMA_RegisterCallback(&g_gp_mdma, HAL_MDMA_XFER_ERROR_CB_ID,
+                            GP_XferError);
+  return HAL_OK;
+}
+
+/**
+ * @brief  把一个字符登记为本批的第n个待取字模
+ * @retval 1-已登记, 0-已缓存、常驻、重复或不存在
+ */
+static uint8_t GP_Collect(uint32_t cp, uint8_t font_size, uint16_t n) {
+  uint32_t key = FlashFont_GlyphKey(cp, font_size); // 缓存键带字体族
+  const uint8_t *src;
+  uint16_t i;
+
+  if (GlyphCache_Lookup(key, font_size) != NULL) {
+    return 0;
+  }
+#ifdef FLASH_FONT_RESIDENT_ENABLE
+  if (FlashFont_ResidentFind(cp, font_size) != NULL) {
+    return 0; // 常驻字模不经过缓存
+  }
+#endif
+  for (i = 0; i < n && (g_gp_key[i] != key || g_gp_size[i] != font_size);
+       i++) {
+  }
+  if (i < n) {
+    return 0;
+  }
+  src = (cp < 0x80) ? ASCII_FindFont_Flash((char)cp, font_size)
+                    : FlashFont_FindFontCP(cp, font_size);
+  if (src == NULL) {
+    return 0;
+  }
+  g_gp_src[n] = src;
+  g_gp_key[n] = key;
+  g_gp_size[n] = font_size;
+  g_gp_bytes[n] = FlashFont_GlyphBytes(src, cp, font_size);
+  return 1;
+}
+
+/**
+ * @brief  为登记好的n个字模建立MDMA链表并启动传输
+ * @retval 实际提交给MDMA的字模数
+ */
+static uint16_t GP_Launch(uint16_t n) {
+  MDMA_LinkNodeConfTypeDef node_cfg;
+
+  if (n == 0 || GP_InitChannel() != HAL_OK) {
+    return 0;
+  }
+
+  // 第一个字模由通道寄存器直接描述，其余依次挂到链表上
+  node_cfg.Init = g_gp_mdma.Init;
+  node_cfg.BlockCount = 1;
+  node_cfg.PostRequestMaskAddress = 0;
+  node_cfg.PostRequestMaskData = 0;
+  for (uint16_t i = 1; i < n; i++) {
+    node_cfg.SrcAddress = (uint32_t)g_gp_src[i];
+    node_cfg.DstAddress = (uint32_t)g_gp_stage[i];
+    node_cfg.BlockDataLength = g_gp_bytes[i];
+    if (HAL_MDMA_LinkedList_CreateNode(&g_gp_node[i], &node_cfg) != HAL_OK ||
+        HAL_MDMA_LinkedList_AddNode(&g_gp_mdma, &g_gp_node[i], NULL) !=
+            HAL_OK) {
+      return 0;
+    }
+  }
+
+  // MDMA直接读写内存：节点写回，暂存区丢弃旧Cache行
+  SCB_CleanDCache_by_Addr((uint32_t *)g_gp_node, sizeof(g_gp_node));
+  SCB_InvalidateDCache_by_Addr((uint32_t *)g_gp_stage, sizeof(g_gp_stage));
+
+  g_gp_count = n;
+  g_gp_epoch = QSPI_W25Qxx_UpdateEpoch();
+  g_gp_state = GP_BUSY;
+  if (HAL_MDMA_Start_IT(&g_gp_mdma, (uint32_t)g_gp_src[0],
+                        (uint32_t)g_gp_stage[0], g_gp_bytes[0], 1) != HAL_OK) {
+    g_gp_count = 0;
+    g_gp_state = GP_IDLE;
+    return 0;
+  }
+  return n;
+}
+
+/**
+ * @brief  从 *text 开始解析一批字模并启动MDMA
+ * @param  text: 输入解析起点，输出下一批的起点(字符串结尾或第max+1个待取字符)
+ * @param  max: 本批最多的字模数，不超过GLYPH_PREFETCH_MAX
+ * @retval 实际提交给MDMA的字模数
+ */
+static uint16_t GP_Start(const uint8_t **text, uint8_t font_size,
+                         uint16_t max) {
+  const uint8_t *p = *text;
+  uint16_t n = 0;
+
+  if (g_gp_state != GP_IDLE || FlashFont_BytesPerChar(font_size) <= 0) {
+    return 0;
+  }
+
+  // 解析字模地址，跳过已缓存、常驻、重复和不存在的字符
+  while (*p != 0 && n < max) {
+    uint32_t cp;
+
+    p += FlashFont_DecodeText(p, &cp); // 与绘制时相同的文本编码
+    n += GP_Collect(cp, font_size, n);
+  }
+  *text = p;
+  return GP_Launch(n);
+}
+
+#ifdef GLYPH_SCREEN_ENABLE
+/**
+ * @brief  计算快照表的校验值
+ */
+static uint32_t GS_Check(const GS_Store_t *st) {
+  const uint32_t *w = (const uint32_t *)st->screen;
+  uint32_t h = GS_MAGIC;
+
+  for (uint32_t i = 0; i < sizeof(st->screen) / 4; i++) {
+    h = (h ^ w[i]) * 16777619U;
+  }
+  return h;
+}
+
+/**
+ * @brief  重新计算校验值；位于备份SRAM时写回Cache，复位前的修改不会丢失
+ */
+static void GS_Seal(GS_Store_t *st) {
+  st->check = GS_Check(st);
+#ifdef GLYPH_SCREEN_BACKUP_ENABLE
+  SCB_CleanDCache_by_Addr((uint32_t *)st, (int32_t)DMA_LINE_ROUND(sizeof(*st)));
+#endif
+}
+
+/**
+ * @brief  取得快照表，首次调用时打开备份SRAM并验证，无效时清空
+ */
+static GS_Store_t *GS_Store(void) {
+  GS_Store_t *st = GS_STORE;
+
+  if (!g_gs_ready) {
+#ifdef GLYPH_SCREEN_BACKUP_ENABLE
+    HAL_PWR_EnableBkUpAccess();
+    __HAL_RCC_BKPRAM_CLK_ENABLE();
+    HAL_PWREx_EnableBkUpReg(); // 接VBAT时掉电后继续保持
+#endif
+    if (st->magic != GS_MAGIC || st->check != GS_Check(st)) {
+      memset(st, 0, sizeof(*st));
+      st->magic = GS_MAGIC;
+      for (uint8_t i = 0; i < GLYPH_SCREEN_MAX; i++) {
+        st->screen[i].screen = GLYPH_SCREEN_NONE;
+      }
+      GS_Seal(st);
+    }
+    g_gs_ready = 1;
+  }
+  return st;
+}
+
+/**
+ * @brief  把页面的记录移到表头
+ * @param  create: 1-页面没有记录时取表尾(最久未进入)的一条清空后移到表头
+ * @retval 表头记录，页面没有记录且 create 为0时返回NULL
+ */
+static GS_Screen_t *GS_MoveFront(GS_Store_t *st, uint16_t screen,
+                                 uint8_t create) {
+  GS_Screen_t rec;
+  uint8_t i;
+
+  for (i = 0; i < GLYPH_SCREEN_MAX - 1 && st->screen[i].screen != screen;
+       i++) {
+  }
+  if (st->screen[i].screen != screen) {
+    if (!create) {
+      return NULL;
+    }
+    st->screen[i].screen = screen;
+    st->screen[i].count = 0;
+  }
+  rec = st->screen[i];
+  memmove(&st->screen[1], &st->screen[0], i * sizeof(st->screen[0]));
+  st->screen[0] = rec;
+  return &st->screen[0];
+}
+
+/**
+ * @brief  从表头记录的续传位置取一批字模并启动MDMA
+ * @retval 实际提交给MDMA的字模数
+ * @note   记录中键的字体族与当前选择的不同时跳过(该字不会按此键绘制)
+ */
+static uint16_t GS_Start(void) {
+  const GS_Screen_t *rec = &GS_Store()->screen[0];
+  uint16_t n = 0;
+
+  while (g_gs_pos < rec->count && n < GLYPH_PREFETCH_MAX) {
+    uint32_t key = rec->key[g_gs_pos];
+    uint32_t cp = key & ~GS_FAMILY_MASK;
+    uint8_t font_size = rec->size[g_gs_pos++];
+
+    if (FlashFont_BytesPerChar(font_size) > 0 &&
+        FlashFont_GlyphKey(cp, font_size) == key) {
+      n += GP_Collect(cp, font_size, n);
+    }
+  }
+  if (g_gs_pos >= rec->count) {
+    g_gs_restore = 0;
+  }
+  return GP_Launch(n);
+}
+#endif
+
+/**
+ * @brief  移除队首登记
+ */
+static void GP_Pop(void) {
+  g_gq_head = (g_gq_head + 1 < GLYPH_PREFETCH_QUEUE) ? g_gq_head + 1 : 0;
+  g_gq_count--;
+  g_gq_pos = NULL;
+}
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  启动一页文字的字模预取
+ * @param  text: UTF8字符串(以0结尾)
+ * @param  font_size: 字体大小(12/16/20/24/32)
+ * @retval 实际提交给MDMA的字模数
+ */
+uint16_t GlyphPrefetch_Start(const char *text, uint8_t font_size) {
+  const uint8_t *p = (const uint8_t *)text;
+
+  if (text == NULL) {
+    return 0;
+  }
+  return GP_Start(&p, font_size, GLYPH_PREFETCH_MAX);
+}
+
+/**
+ * @brief  登记一段稍后要显示的文字
+ * @retval 0-已登记, 1-队列已满或参数无效
+ */
+uint8_t GlyphPrefetch_Queue(const char *text, uint8_t font_size) {
+  uint8_t tail;
+
+  if (text == NULL || *text == 0 || g_gq_count >= GLYPH_PREFETCH_QUEUE) {
+    return 1;
+  }
+  tail = (uint8_t)((g_gq_head + g_gq_count) % GLYPH_PREFETCH_QUEUE);
+  g_gq_text[tail] = text;
+  g_gq_size[tail] = font_size;
+  g_gq_count++;
+  return 0;
+}
+
+/**
+ * @brief  登记一页的全部文字
+ * @retval 登记的字符串数
+ */
+uint16_t GlyphPrefetch_QueuePage(const char *const *texts, uint16_t count,
+                                 uint8_t font_size) {
+  uint16_t n = 0;
+
+  if (texts == NULL) {
+    return 0;
+  }
+  for (uint16_t i = 0; i < count && g_gq_count < GLYPH_PREFETCH_QUEUE; i++) {
+    if (GlyphPrefetch_Queue(texts[i], font_size) == 0) {
+      n++;
+    }
+  }
+  return n;
+}
+
+/**
+ * @brief  丢弃尚未开始的登记
+ */
+void GlyphPrefetch_Cancel(void) {
+  g_gq_count = 0;
+  g_gq_pos = NULL;
+  g_gl_pos = NULL;
+}
+
+/**
+ * @brief  后台预取任务：提交完成的一批，启动下一批
+ * @retval 1-有可以立即进行的工作, 0-队列已空或正在等待MDMA
+ */
+uint8_t GlyphPrefetch_Idle(void) {
+  GlyphPrefetch_Commit();
+
+#ifdef GLYPH_SCREEN_ENABLE
+  // 页面快照先于登记的文字，新页面第一帧用到的字先到
+  while (g_gs_restore && g_gp_state == GP_IDLE) {
+    if (GS_Start() > 0) {
+      break;
+    }
+  }
+#endif
+  // 启动失败(字号无效、MDMA出错)或整段都已缓存时跳到下一段，保证队列前进
+  while (g_gq_count > 0 && g_gp_state == GP_IDLE) {
+    uint16_t n;
+
+    if (g_gq_pos == NULL) {
+      g_gq_pos = (const uint8_t *)g_gq_text[g_gq_head];
+    }
+    n = GP_Start(&g_gq_pos, g_gq_size[g_gq_head], GLYPH_PREFETCH_MAX);
+    if (n == 0 || *g_gq_pos == 0) {
+      GP_Pop();
+    }
+    if (n > 0) {
+      break;
+    }
+  }
+  // 语言字符集最后进行，字库被改写过时映射区内容已变，放弃
+  if (g_gl_pos != NULL && g_gl_epoch != QSPI_W25Qxx_UpdateEpoch()) {
+    g_gl_pos = NULL;
+  }
+  while (g_gl_pos != NULL && g_gp_state == GP_IDLE) {
+    uint16_t n = GP_Start(&g_gl_pos, g_gl_size,
+                          (g_gl_left < GLYPH_PREFETCH_MAX) ? g_gl_left
+                                                           : GLYPH_PREFETCH_MAX);
+
+    g_gl_left -= n;
+    if (*g_gl_pos == 0 || g_gl_left == 0) {
+      g_gl_pos = NULL;
+    }
+    if (n > 0) {
+      break;
+    }
+  }
+#ifdef GLYPH_SCREEN_ENABLE
+  if (g_gs_restore && g_gp_state == GP_IDLE) {
+    return 1;
+  }
+#endif
+  return ((g_gq_count > 0 || g_gl_pos != NULL) && g_gp_state == GP_IDLE) ||
+         g_gp_state == GP_DONE;
+}
+
+/**
+ * @brief  登记一种语言的字符集，由 GlyphPrefetch_Idle() 在登记队列之后预取
+ * @retval 登记的字符集字节数，字库中没有该语言的字符集返回0
+ */
+uint16_t GlyphPrefetch_QueueLanguage(uint8_t lang, uint8_t font_size) {
+  const char *chars = FlashFont_GetLanguageChars(lang);
+  GlyphCache_Stats_t stats;
+
+  if (chars == NULL || *chars == 0) {
+    return 0;
+  }
+  GlyphCache_GetStats(&stats);
+  g_gl_pos = (const uint8_t *)chars; // 替换尚未完成的上一种语言
+  g_gl_size = font_size;
+  g_gl_left = stats.limit; // 字符集大于缓存时只取前面的常用字
+  g_gl_epoch = QSPI_W25Qxx_UpdateEpoch();
+  return (uint16_t)strlen(chars);
+}
+
+/**
+ * @brief  切换界面字符串的语言并在后台预热新语言的字模
+ * @retval 0-成功, -1-字库中没有该语言的字符串表
+ */
+int8_t GlyphPrefetch_SetLanguage(uint8_t lang, uint8_t font_size) {
+  if (FlashFont_SetLanguage(lang) != 0) {
+    return -1;
+  }
+  if (GlyphPrefetch_QueueLanguage(lang, font_size) > 0) {
+    GlyphPrefetch_Idle(); // 通道空闲且没有登记的文字时立即启动第一批
+  }
+  return 0;
+}
+
+/**
+ * @brief  查询预取是否仍在传输
+ * @retval 1-传输中, 0-空闲或已完成
+ */
+uint8_t GlyphPrefetch_Busy(void) { return g_gp_state == GP_BUSY; }
+
+/**
+ * @brief  把已完成的预取结果写入字模缓存
+ * @retval 写入缓存的字模数，无已完成的预取返回0
+ */
+uint16_t GlyphPrefetch_Commit(void) {
+  uint16_t n = g_gp_count;
+
+  if (g_gp_state != GP_DONE) {
+    return 0;
+  }
+
+  // 预取期间Flash被改写过时暂存区可能是旧内容，整批丢弃
+  if (g_gp_epoch != QSPI_W25Qxx_UpdateEpoch()) {
+    n = 0;
+  }
+  // 传输期间CPU可能推测读取过暂存区，提交前再失效一次
+  SCB_InvalidateDCache_by_Addr((uint32_t *)g_gp_stage, sizeof(g_gp_stage));
+  for (uint16_t i = 0; i < n; i++) {
+    GlyphCache_InsertFrom(g_gp_key[i], g_gp_size[i], g_gp_stage[i],
+                          g_gp_src[i], g_gp_bytes[i]);
+  }
+
+  g_gp_count = 0;
+  g_gp_state = GP_IDLE;
+  return n;
+}
+
+#ifdef GLYPH_SCREEN_ENABLE
+/**
+ * @brief  保存当前页面的字模工作集
+ * @retval 保存的字模数，没有当前页面或没有用到字模时返回0(原来的快照保留)
+ */
+uint16_t GlyphPrefetch_SaveScreen(void) {
+  GS_Store_t *st;
+  GS_Screen_t *rec;
+  uint16_t n;
+
+  if (g_gs_current == GLYPH_SCREEN_NONE) {
+    return 0;
+  }
+  n = GlyphCache_GetWorkingSet(g_gs_keys, g_gs_sizes, GLYPH_SCREEN_GLYPHS);
+  if (n == 0) {
+    return 0;
+  }
+  st = GS_Store();
+  g_gs_restore = 0; // 表头记录换成新内容，未预取完的部分不再续传
+  rec = GS_MoveFront(st, g_gs_current, 1);
+  memcpy(rec->key, g_gs_keys, n * sizeof(rec->key[0]));
+  memcpy(rec->size, g_gs_sizes, n);
+  rec->count = (uint8_t)n;
+  GS_Seal(st);
+  return n;
+}
+
+/**
+ * @brief  切换页面：保存当前页面的工作集，开始记录并预取新页面的快照
+ * @retval 新页面快照中的字模数，没有快照时返回0
+ */
+uint16_t GlyphPrefetch_EnterScreen(uint16_t screen) {
+  GS_Store_t *st;
+  GS_Screen_t *rec;
+
+  if (screen == GLYPH_SCREEN_NONE) {
+    return 0;
+  }
+  if (screen != g_gs_current) {
+    GlyphPrefetch_SaveScreen();
+  }
+  st = GS_Store();
+  rec = GS_MoveFront(st, screen, 0);
+  g_gs_current = screen;
+  g_gs_pos = 0;
+  g_gs_restore = 0;
+  GlyphCache_MarkWorkingSet();
+  if (rec == NULL) {
+    return 0; // 第一次进入，离开时再保存
+  }
+  GS_Seal(st);
+  g_gs_restore = (rec->count > 0);
+  GlyphPrefetch_Idle(); // 通道空闲时立即启动第一批
+  return rec->count;
+}
+
+/**
+ * @brief  丢弃全部页面快照
+ */
+void GlyphPrefetch_ForgetScreens(void) {
+  GS_Store_t *st = GS_Store();
+
+  st->magic = 0; // 下次取快照表时重新清空
+  g_gs_ready = 0;
+  g_gs_restore = 0;
+  GS_Store();
+}
+#endif
+
+/**
+ * @brief  MDMA中断处理，在MDMA_IRQHandler中调用
+ */
+void GlyphPrefetch_IRQHandler(void) {
+  if (g_gp_ready) {
+    HAL_MDMA_IRQHandler(&g_gp_mdma);
+  }
+}
+
+#endif /* FLASH_FONT_ENABLE && GLYPH_CACHE_ENABLE && GLYPH_PREFETCH_ENABLE */
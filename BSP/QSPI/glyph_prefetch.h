@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * @file    glyph_prefetch.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   字模MDMA批量预取头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 渲染大段文字前，先把整页字符解析为QSPI字模地址，由MDMA链表传输
+ *   把分散的字模搬到片内连续的暂存区，CPU在此期间可继续渲染上一页
+ * - 传输完成后 GlyphPrefetch_Commit() 把暂存区字模写入字模缓存，
+ *   之后的渲染全部命中缓存，只读取片内SRAM
+ * - FlashFont_ResolveString() 入口会自动提交已完成的预取
+ * - 切换页面前用 GlyphPrefetch_Queue()/GlyphPrefetch_QueuePage() 登记即将显示的文字，
+ *   主循环的字库后台任务调用 GlyphPrefetch_Idle() 每次启动一批、完成后提交，
+ *   超过 GLYPH_PREFETCH_MAX 的长文字分批续传，新页面第一帧即从缓存渲染
+ * - 依赖字模缓存(GLYPH_CACHE_ENABLE)，占用一个MDMA通道
+ * - 定义 GLYPH_SCREEN_ENABLE 后按页面ID保存字模快照：GlyphPrefetch_EnterScreen()
+ *   保存上一页用到的字模键，并把新页面上次的字模先于登记的文字分批预取；
+ *   快照放在备份SRAM时复位后依然有效，开机第一帧也从缓存渲染
+ * - GlyphPrefetch_SetLanguage() 切换界面字符串的语言，并把字库中该语言字符串用到的
+ *   字符(fontbin_tool.py --strings 生成，常用字在前)排在登记队列之后分批预取，
+ *   切换后重绘的界面不再逐字冷读QSPI
+ *
+ * 使用示例：
+ *     GlyphPrefetch_Start(next_page, 16);   // 后台预取下一页
+ *     LCD_DisplayText(0, 0, this_page);     // 渲染当前页
+ *     ...
+ *     LCD_DisplayText(0, 0, next_page);     // 字模已在缓存中
+ *
+ *     static const char *const labels[] = {"温度", "湿度", "气压"};
+ *     GlyphPrefetch_QueuePage(labels, 3, 24); // 登记下一页，由后台任务分批预取
+ *
+ *     GlyphPrefetch_EnterScreen(SCREEN_SETTINGS); // 切换页面时调用，再绘制新页面
+ *
+ *     GlyphPrefetch_SetLanguage(LANG_EN, 24); // 切换语言，后台预热新语言界面的字模
+ *
+ ******************************************************************************
+ */
+
+#ifndef GLYPH_PREFETCH_H
+#define GLYPH_PREFETCH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "init.h"
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define GLYPH_PREFETCH_ENABLE /*!< 定义了：启用MDMA字模预取, 注释后：不占用MDMA通道 */
+#define GLYPH_PREFETCH_MAX 32 /*!< 每次最多预取的字符数，不能超过GLYPH_CACHE_SLOTS */
+#define GLYPH_PREFETCH_CHANNEL MDMA_CHANNEL(GLYPH_PREFETCH_CH) /*!< 使用的MDMA通道，通道号在 init.h 的"MDMA通道分配"中修改 */
+#define GLYPH_PREFETCH_IRQ_PRIORITY 5 /*!< MDMA中断优先级，低于LCD的SPI/BDMA中断 */
+#define GLYPH_PREFETCH_QUEUE 16 /*!< GlyphPrefetch_Queue() 最多登记的字符串数 */
+#ifndef GLYPH_PREFETCH_ATTR
+#define GLYPH_PREFETCH_ATTR /*!< 暂存区与链表节点存放位置(MDMA可访问的AXI SRAM/DTCM) */
+#endif
+
+// #define GLYPH_SCREEN_ENABLE /*!< 定义了：按页面ID保存字模工作集，进入页面时后台预取, 注释后：不占用RAM */
+#define GLYPH_SCREEN_MAX 8 /*!< 保存快照的页面数，满了替换最久未进入的页面 */
+#define GLYPH_SCREEN_GLYPHS 48 /*!< 每页最多保存的字模数(取最近用到的)，每个5字节，不超过GLYPH_CACHE_SLOTS */
+// #define GLYPH_SCREEN_BACKUP_ENABLE /*!< 定义了：快照放在4KB备份SRAM(0x38800000)，复位后保留，接VBAT时掉电也保留, 注释后：放在RAM，每次上电重新积累 */
+#define GLYPH_SCREEN_NONE 0xFFFFU /*!< 无效页面ID */
+
+    /*******************************************************************************
+     *                          导出函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  启动一页文字的字模预取
+     * @param  text: UTF8字符串(以0结尾)
+     * @param  font_size: 字体大小(12/16/20/24/32)
+     * @retval 实际提交给MDMA的字模数，上一次预取未完成或无需预取时返回0
+     * @note   已在缓存中的字符和重复字符不会重复传输
+     * @note   字符串中超过GLYPH_PREFETCH_MAX个待取字模的部分忽略
+     */
+    uint16_t GlyphPrefetch_Start(const char *text, uint8_t font_size);
+
+    /**
+     * @brief  查询预取是否仍在传输
+     * @retval 1-传输中, 0-空闲或已完成
+     */
+    uint8_t GlyphPrefetch_Busy(void);
+
+    /**
+     * @brief  把已完成的预取结果写入字模缓存
+     * @retval 写入缓存的字模数，无已完成的预取返回0
+     * @note   不能在持有缓存指针的绘制过程中调用，插入会淘汰旧槽位
+     */
+    uint16_t GlyphPrefetch_Commit(void);
+
+    /**
+     * @brief  登记一段稍后要显示的文字，由 GlyphPrefetch_Idle() 在后台预取
+     * @param  text: UTF8字符串(以0结尾)，预取完成前须保持有效
+     * @param  font_size: 字体大小
+     * @retval 0-已登记, 1-队列已满或参数无效
+     * @note   字符数不受 GLYPH_PREFETCH_MAX 限制，按批续传；页面的不同字符多于
+     *         GLYPH_CACHE_SLOTS 时先预取的会被后预取的淘汰
+     */
+    uint8_t GlyphPrefetch_Queue(const char *text, uint8_t font_size);
+
+    /**
+     * @brief  登记一页的全部文字
+     * @param  texts: 字符串数组，NULL项跳过
+     * @param  count: 字符串个数
+     * @param  font_size: 字体大小
+     * @retval 登记的字符串数，队列放不下的部分不登记
+     */
+    uint16_t GlyphPrefetch_QueuePage(const char *const *texts, uint16_t count, uint8_t font_size);
+
+    /**
+     * @brief  登记一种语言的字符串用到的字符(FlashFont_GetLanguageChars())，由 GlyphPrefetch_Idle() 预取
+     * @param  lang: 语言编号
+     * @param  font_size: 字体大小，界面用到多个字号时取主要的一个
+     * @retval 字符集的字节数，字库中没有该语言的字符集返回0
+     * @note   排在登记的文字之后进行，最多预取字模缓存当前上限个字；只保留一种语言，
+     *         再次调用替换尚未完成的部分
+     */
+    uint16_t GlyphPrefetch_QueueLanguage(uint8_t lang, uint8_t font_size);
+
+    /**
+     * @brief  切换界面字符串的语言(FlashFont_SetLanguage())并在后台预热新语言的字模
+     * @param  lang: 语言编号
+     * @param  font_size: 字体大小
+     * @retval 0-成功, -1-字库中没有该语言的字符串表(语言不变)
+     * @note   通道空闲时立即启动第一批，其余由 GlyphPrefetch_Idle() 续传
+     */
+    int8_t GlyphPrefetch_SetLanguage(uint8_t lang, uint8_t font_size);
+
+    /**
+     * @brief  丢弃尚未开始的登记(页面在预取完成前又切换时调用)
+     * @note   正在传输的一批照常完成和提交；登记的语言字符集一并丢弃
+     */
+    void GlyphPrefetch_Cancel(void);
+
+    /**
+     * @brief  后台预取任务，在主循环空闲时调用
+     * @note   有已完成的一批时先提交到字模缓存，通道空闲时启动队首文字的下一批
+     * @retval 1-有待提交的一批或可以启动的下一批, 0-队列已空或正在传输(完成中断会唤醒睡眠)
+     */
+    uint8_t GlyphPrefetch_Idle(void);
+
+#ifdef GLYPH_SCREEN_ENABLE
+    /**
+     * @brief  切换页面，在绘制新页面之前调用
+     * @param  screen: 页面ID(应用自行编号，不能为GLYPH_SCREEN_NONE)
+     * @retval 新页面快照中的字模数，第一次进入返回0
+     * @note   先用 GlyphPrefetch_SaveScreen() 保存上一页，再开始记录新页面的工作集，
+     *         有快照时立即启动第一批预取，其余由 GlyphPrefetch_Idle() 续传；
+     *         快照中字体族与当前选择不同的字跳过
+     */
+    uint16_t GlyphPrefetch_EnterScreen(uint16_t screen);
+
+    /**
+     * @brief  保存当前页面的字模工作集(进入页面后查到或装入缓存、仍未被淘汰的字模)
+     * @retval 保存的字模数，没有用到字模时返回0，原来的快照保留
+     * @note   由 GlyphPrefetch_EnterScreen() 自动调用；需要下次开机也预取当前页时
+     *         (如关机前)可直接调用
+     */
+    uint16_t GlyphPrefetch_SaveScreen(void);
+
+    /**
+     * @brief  丢弃全部页面快照(更换界面布局或字库后调用)
+     */
+    void GlyphPrefetch_ForgetScreens(void);
+#endif
+
+    /**
+     * @brief  MDMA中断处理，在MDMA_IRQHandler中调用
+     */
+    void GlyphPrefetch_IRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GLYPH_PREFETCH_H
@@ -34,8 +34,19 @@
  *    - 只能读取，不能写入
  *    - 性能仅与QSPI时钟和Cache相关
  *    - 访问地址：0x90000000 + offset
+ *    - 需要改写时使用 QSPI_W25Qxx_MappedUpdate_Step() 按扇区分步擦写，
+ *      每步结束自动重新映射并失效对应Cache行，两步之间可正常渲染
  *
- * 5. 使用建议
+ * 5. 改写记录
+ *    - 擦除、编程命令发出后立即失效被改写范围的D-Cache行，并把范围记入改写记录、
+ *      递增改写序号；字库等RAM缓存比较序号，只作废与改写范围重叠的内容
+ *
+ * 6. 深度掉电
+ *    - QSPI_W25Qxx_PowerDown() 退出映射后发送0xB9，待机电流降到约1uA
+ *    - 掉电期间任何驱动函数访问Flash前都会先发送0xAB并等待tRES1，
+ *      映射区由 QSPI_W25Qxx_WakeUp() 恢复
+ *
+ * 7. 使用建议
  *    - 大数据量擦除优先使用64K块擦除
  *    - 写入前务必完成擦除操作
  *    - Flash使用时间越长，擦除/写入耗时越长
@@ -52,25 +63,173 @@ extern QSPI_HandleTypeDef
 
 #define W25Qxx_NumByteToTest 32 * 1024 // 测试数据的长度，64K
 
+#ifdef QSPI_XIP_ENABLE
+#define QSPI_XIP_MPU_BASE (W25Qxx_FlashSize - 0x800000) // 数据区MPU区域覆盖Flash最后8MB
+#define QSPI_XIP_MPU_SRD                                                       \
+  ((1U << ((QSPI_XIP_DATA_ADDR - QSPI_XIP_MPU_BASE) >> 20)) - 1U) // 屏蔽属于代码区的1MB子区域
+#if (QSPI_XIP_DATA_ADDR % 0x100000) != 0 ||                                    \
+    QSPI_XIP_DATA_ADDR < (W25Qxx_FlashSize - 0x800000) ||                      \
+    QSPI_XIP_DATA_ADDR >= W25Qxx_FlashSize
+#error "QSPI_XIP_DATA_ADDR 必须1MB对齐且位于Flash最后8MB内"
+#endif
+#endif
+
 int32_t QSPI_Status; // 检测标志位
 
-uint32_t W25Qxx_TestAddr = 0x1A20000;             // 测试地址
+uint32_t W25Qxx_TestAddr = 0x1900000;             // 测试地址(位于字库A/B分区之外)
 uint8_t W25Qxx_WriteBuffer[W25Qxx_NumByteToTest]; //	写数据数组
 uint8_t W25Qxx_ReadBuffer[W25Qxx_NumByteToTest];  //	读数据数组
 
+static uint8_t s_power_down = 0; // 1-已发送0xB9，访问前需先唤醒
+
+#define W25Qxx_WR_IDLE 0    // 异步写入空闲
+#define W25Qxx_WR_ENABLE 1  // 等待写使能命令完成
+#define W25Qxx_WR_PROGRAM 2 // 等待页数据DMA发送完成
+#define W25Qxx_WR_POLL 3    // 等待器件BUSY清零
+#define W25Qxx_WR_SUSPEND 4 // 擦除已暂停或编程停在两页之间，映射区可读
+#define W25Qxx_WR_ERASE 5   // 等待擦除命令发送完成
+
+static volatile uint8_t s_dma_busy = 0;               // DMA读取进行中
+static volatile uint8_t s_wr_state = W25Qxx_WR_IDLE; // 异步写入状态，非空闲时阻塞式擦写返回忙
+
+static QSPI_W25Qxx_Range_t s_update_log[W25Qxx_UPDATE_LOG_LEN]; // 最近的改写范围
+static uint8_t s_update_last = 0;            // 最新一条记录的位置
+static uint8_t s_update_used = 0;            // 有效记录数
+static volatile uint32_t s_update_epoch = 0; // 改写序号
+static uint32_t s_update_floor = 0;          // 已被覆盖的记录中最大的序号
+
+// 器件能力表，第一项为默认器件；0x40xx为JV-IQ/FV，0x70xx为支持DTR的JV-IM
+static const QSPI_W25Qxx_Part_t s_parts[] = {
+    {W25Qxx_FLASH_ID, "W25Q256JV", 0x2000000, 4, W25Qxx_CMD_FastReadQuad_IO,
+     W25Qxx_CMD_QuadInputPageProgram, W25Qxx_CMD_SectorErase,
+     W25Qxx_CMD_BlockErase_64K},
+    {0xEF7019, "W25Q256JV-M", 0x2000000, 4, W25Qxx_CMD_FastReadQuad_IO,
+     W25Qxx_CMD_QuadInputPageProgram, W25Qxx_CMD_SectorErase,
+     W25Qxx_CMD_BlockErase_64K},
+    {0xEF4020, "W25Q512JV", 0x4000000, 4, W25Qxx_CMD_FastReadQuad_IO,
+     W25Qxx_CMD_QuadInputPageProgram, W25Qxx_CMD_SectorErase,
+     W25Qxx_CMD_BlockErase_64K},
+    {0xEF7020, "W25Q512JV-M", 0x4000000, 4, W25Qxx_CMD_FastReadQuad_IO,
+     W25Qxx_CMD_QuadInputPageProgram, W25Qxx_CMD_SectorErase,
+     W25Qxx_CMD_BlockErase_64K},
+    {0xEF4018, "W25Q128JV", 0x1000000, 3, W25Qxx_CMD_FastReadQuad_IO_3B,
+     W25Qxx_CMD_QuadInputPageProgram_3B, W25Qxx_CMD_SectorErase_3B,
+     W25Qxx_CMD_BlockErase_64K_3B},
+    {0xEF7018, "W25Q128JV-M", 0x1000000, 3, W25Qxx_CMD_FastReadQuad_IO_3B,
+     W25Qxx_CMD_QuadInputPageProgram_3B, W25Qxx_CMD_SectorErase_3B,
+     W25Qxx_CMD_BlockErase_64K_3B},
+    {0xEF4017, "W25Q64JV", 0x0800000, 3, W25Qxx_CMD_FastReadQuad_IO_3B,
+     W25Qxx_CMD_QuadInputPageProgram_3B, W25Qxx_CMD_SectorErase_3B,
+     W25Qxx_CMD_BlockErase_64K_3B},
+    {0xEF7017, "W25Q64JV-M", 0x0800000, 3, W25Qxx_CMD_FastReadQuad_IO_3B,
+     W25Qxx_CMD_QuadInputPageProgram_3B, W25Qxx_CMD_SectorErase_3B,
+     W25Qxx_CMD_BlockErase_64K_3B},
+};
+static QSPI_W25Qxx_Part_t s_part_sfdp;                // 由SFDP得到的器件参数
+static const QSPI_W25Qxx_Part_t *s_part = &s_parts[0]; // 当前器件
+
+/**
+ * @brief  当前器件的指令地址长度
+ */
+static inline uint32_t QSPI_W25Qxx_AddressSize(void) {
+  return (s_part->addr_bytes == 4) ? QSPI_ADDRESS_32_BITS
+                                   : QSPI_ADDRESS_24_BITS;
+}
+
+/**
+ * @brief  检查间接读写的地址和字节数
+ * @retval 1-可以传输, 0-双片模式下地址或字节数为奇数
+ * @note   双片模式下控制器强制地址位0为0、字节数为偶数，奇数时会读写到相邻字节
+ */
+static inline uint8_t QSPI_W25Qxx_DualAligned(uint32_t addr, uint32_t size) {
+  return ((addr | size) & (W25Qxx_CHIPS - 1U)) == 0;
+}
+
+/**
+ * @brief  失效映射区中被改写范围对应的D-Cache行
+ * @param  addr: Flash地址
+ * @param  size: 字节数
+ * @note   映射区只读，Cache中不会有脏行，直接失效即可；
+ *         范围超过整个D-Cache时整体清理更快
+ */
+static void QSPI_W25Qxx_InvalidateMapped(uint32_t addr, uint32_t size) {
+  uint32_t start = addr & ~31U;
+  uint32_t end = (addr + size + 31U) & ~31U;
+
+  if (size == 0) {
+    return;
+  }
+  if (end - start >= W25Qxx_DCACHE_SIZE) {
+    SCB_CleanInvalidateDCache();
+  } else {
+    SCB_InvalidateDCache_by_Addr((uint32_t *)(W25Qxx_Mem_Addr + start),
+                                 (int32_t)(end - start));
+  }
+}
+
+/**
+ * @brief  记录一次擦除或编程：失效对应Cache行并写入改写记录
+ * @param  addr: Flash地址
+ * @param  size: 字节数
+ * @note   在擦写命令发出后调用，命令失败时内容同样可能已经改变；
+ *         此时映射已退出，失效之后到重新映射之前不会有新的Cache行填充
+ * @note   与上一条记录相距不到一个扇区时合并，逐页写入只占一条记录
+ */
+static void QSPI_W25Qxx_Touch(uint32_t addr, uint32_t size) {
+  QSPI_W25Qxx_Range_t *r = &s_update_log[s_update_last];
+
+  QSPI_W25Qxx_InvalidateMapped(addr, size);
+  if (s_update_used > 0 && addr <= r->addr + r->size + W25Qxx_SectorSize &&
+      addr + size + W25Qxx_SectorSize >= r->addr) {
+    uint32_t end = (addr + size > r->addr + r->size) ? addr + size
+                                                     : r->addr + r->size;
+    if (addr < r->addr) {
+      r->addr = addr;
+    }
+    r->size = end - r->addr;
+  } else {
+    s_update_last = (uint8_t)((s_update_last + 1) % W25Qxx_UPDATE_LOG_LEN);
+    r = &s_update_log[s_update_last];
+    if (s_update_used == W25Qxx_UPDATE_LOG_LEN) {
+      s_update_floor = r->epoch; // 最旧的记录被覆盖
+    } else {
+      s_update_used++;
+    }
+    r->addr = addr;
+    r->size = size;
+  }
+  r->epoch = ++s_update_epoch;
+}
+
+
+static int8_t QSPI_W25Qxx_Detect(uint32_t id);
+
 /**
  * @brief  初始化QSPI Flash
  * @retval QSPI_W25Qxx_OK - 初始化成功
  * @retval W25Qxx_ERROR_INIT - 初始化失败
- * @note   读取器件ID并与预期值比对
+ * @note   读取器件ID，按器件能力表(或SFDP)选择指令集和QUADSPI容量
  */
 int8_t QSPI_W25Qxx_Init(void) {
   uint32_t Device_ID; // 器件ID
 
+#ifdef QSPI_DUAL_FLASH_ENABLE
+  // MX_QUADSPI_Init() 只用BK1，复位前切到双片模式，命令同时发给两片
+  if (hqspi.Init.DualFlash != QSPI_DUALFLASH_ENABLE) {
+    hqspi.Init.DualFlash = QSPI_DUALFLASH_ENABLE;
+    if (HAL_QSPI_Init(&hqspi) != HAL_OK) {
+      DEBUG_ERROR("QSPI 双片模式初始化失败");
+      return W25Qxx_ERROR_INIT;
+    }
+  }
+#endif
   QSPI_W25Qxx_Reset();              // 复位器件
   Device_ID = QSPI_W25Qxx_ReadID(); // 读取器件ID
 
-  if (Device_ID == W25Qxx_FLASH_ID) {
+  if (QSPI_W25Qxx_Detect(Device_ID) == QSPI_W25Qxx_OK) {
+#ifdef QSPI_CALIBRATE_ENABLE
+    QSPI_W25Qxx_Calibrate(); // 失败时保留 MX_QUADSPI_Init() 的配置
+#endif
     return QSPI_W25Qxx_OK;
   } else {
     DEBUG_ERROR("QSPI Flash ID error");
@@ -78,6 +237,45 @@ int8_t QSPI_W25Qxx_Init(void) {
   }
 }
 
+/**
+ * @brief  读取当前器件参数
+ * @retval 器件参数
+ */
+const QSPI_W25Qxx_Part_t *QSPI_W25Qxx_GetPart(void) { return s_part; }
+
+/**
+ * @brief  填充等待BUSY清零的自动轮询配置
+ * @param  s_command: 输出命令配置(读状态寄存器1)
+ * @param  s_config: 输出轮询配置
+ * @param  interval: 两次读取状态寄存器之间的QSPI时钟数
+ */
+static void QSPI_W25Qxx_BusyPollConfig(QSPI_CommandTypeDef *s_command,
+                                       QSPI_AutoPollingTypeDef *s_config,
+                                       uint16_t interval) {
+  s_command->InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
+  s_command->AddressMode = QSPI_ADDRESS_NONE;               // 无地址模式
+  s_command->AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; //	无交替字节
+  s_command->DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
+  s_command->DdrHoldHalfCycle =
+      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
+  s_command->SIOOMode = QSPI_SIOO_INST_EVERY_CMD; //	每次传输数据都发送指令
+  s_command->DataMode = QSPI_DATA_1_LINE;         // 1线数据模式
+  s_command->DummyCycles = 0;                     //	空周期个数
+  s_command->Instruction = W25Qxx_CMD_ReadStatus_REG1; // 读状态信息寄存器
+
+  // 不停的查询 W25Qxx_CMD_ReadStatus_REG1 寄存器，将读取到的状态字节中的
+  // W25Qxx_Status_REG1_BUSY 不停的与0作比较
+  // 读状态寄存器1的第0位（只读），Busy标志位，当正在擦除/写入数据/写命令时会被置1，空闲或通信结束为0
+
+  s_config->Match = 0;                                  //	匹配值
+  s_config->MatchMode = QSPI_MATCH_MODE_AND;            //	与运算
+  s_config->Interval = interval;                        //	轮询间隔
+  s_config->AutomaticStop = QSPI_AUTOMATIC_STOP_ENABLE; // 自动停止模式
+  s_config->StatusBytesSize = W25Qxx_STATUS_BYTES;      //	状态字节数(每片一个)
+  s_config->Mask = W25Qxx_STATUS_FLAG(
+      W25Qxx_Status_REG1_BUSY); // 对在轮询模式下接收的状态字节进行屏蔽，只比较需要用到的位
+}
+
 /**
  * @brief  使用自动轮询等待Flash就绪
  * @retval QSPI_W25Qxx_OK - 通信正常结束
@@ -88,35 +286,150 @@ int8_t QSPI_W25Qxx_AutoPollingMemReady(void) {
   QSPI_CommandTypeDef s_command;    // QSPI传输配置
   QSPI_AutoPollingTypeDef s_config; // 轮询比较相关配置参数
 
-  s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
+  QSPI_W25Qxx_BusyPollConfig(&s_command, &s_config, W25Qxx_POLL_INTERVAL);
+
+  // 发送轮询等待命令
+  if (HAL_QSPI_AutoPolling(&hqspi, &s_command, &s_config,
+                           HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) {
+    return W25Qxx_ERROR_AUTOPOLLING; // 轮询等待无响应
+  }
+  return QSPI_W25Qxx_OK; // 通信正常结束
+}
+
+/**
+ * @brief  等待擦除结束
+ * @param  timeout: 超时时间(ms)
+ * @retval QSPI_W25Qxx_OK - 擦除结束
+ * @retval W25Qxx_ERROR_AUTOPOLLING - 轮询等待超时
+ * @note   擦除耗时数十毫秒到数百秒，按 W25Qxx_ERASE_POLL_INTERVAL 放宽轮询间隔，
+ *         减少等待期间QUADSPI的总线翻转
+ */
+static int8_t QSPI_W25Qxx_WaitErase(uint32_t timeout) {
+  QSPI_CommandTypeDef s_command;    // QSPI传输配置
+  QSPI_AutoPollingTypeDef s_config; // 轮询比较相关配置参数
+
+  QSPI_W25Qxx_BusyPollConfig(&s_command, &s_config,
+                             W25Qxx_ERASE_POLL_INTERVAL);
+  if (HAL_QSPI_AutoPolling(&hqspi, &s_command, &s_config, timeout) !=
+      HAL_OK) {
+    return W25Qxx_ERROR_AUTOPOLLING;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  发送单字节指令(可带少量写数据)
+ * @param  Instruction: 指令
+ * @param  InstructionMode: QSPI_INSTRUCTION_1_LINE / QSPI_INSTRUCTION_4_LINES
+ * @param  pData: 写入数据，无数据时为NULL
+ * @param  Size: 数据字节数
+ * @retval QSPI_W25Qxx_OK - 发送成功
+ * @retval W25Qxx_ERROR_TRANSMIT - 发送失败
+ * @note   数据线数与指令线数一致
+ */
+static int8_t QSPI_W25Qxx_SendCommand(uint8_t Instruction,
+                                      uint32_t InstructionMode,
+                                      uint8_t *pData, uint32_t Size) {
+  QSPI_CommandTypeDef s_command; // QSPI传输配置
+
+  s_command.InstructionMode = InstructionMode;             // 指令模式
+  s_command.Instruction = Instruction;                     // 指令
   s_command.AddressMode = QSPI_ADDRESS_NONE;               // 无地址模式
-  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; //	无交替字节
+  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
   s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
   s_command.DdrHoldHalfCycle =
       QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
-  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; //	每次传输数据都发送指令
-  s_command.DataMode = QSPI_DATA_1_LINE;         // 1线数据模式
-  s_command.DummyCycles = 0;                     //	空周期个数
-  s_command.Instruction = W25Qxx_CMD_ReadStatus_REG1; // 读状态信息寄存器
+  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+  s_command.DummyCycles = 0;                     // 空周期个数
+  s_command.NbData = Size;                       // 数据长度
+  if (pData == NULL) {
+    s_command.DataMode = QSPI_DATA_NONE;
+  } else if (InstructionMode == QSPI_INSTRUCTION_4_LINES) {
+    s_command.DataMode = QSPI_DATA_4_LINES;
+  } else {
+    s_command.DataMode = QSPI_DATA_1_LINE;
+  }
 
-  // 不停的查询 W25Qxx_CMD_ReadStatus_REG1 寄存器，将读取到的状态字节中的
-  // W25Qxx_Status_REG1_BUSY 不停的与0作比较
-  // 读状态寄存器1的第0位（只读），Busy标志位，当正在擦除/写入数据/写命令时会被置1，空闲或通信结束为0
+  if (HAL_QSPI_Command(&hqspi, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+      HAL_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  if (pData != NULL &&
+      HAL_QSPI_Transmit(&hqspi, pData, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+          HAL_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  return QSPI_W25Qxx_OK;
+}
 
-  s_config.Match = 0;                                  //	匹配值
-  s_config.MatchMode = QSPI_MATCH_MODE_AND;            //	与运算
-  s_config.Interval = 0x10;                            //	轮询间隔
-  s_config.AutomaticStop = QSPI_AUTOMATIC_STOP_ENABLE; // 自动停止模式
-  s_config.StatusBytesSize = 1;                        //	状态字节数
-  s_config.Mask =
-      W25Qxx_Status_REG1_BUSY; // 对在轮询模式下接收的状态字节进行屏蔽，只比较需要用到的位
+/**
+ * @brief  按DWT周期计数器忙等待
+ * @param  us: 等待微秒数
+ */
+static void QSPI_W25Qxx_DelayUs(uint32_t us) {
+  uint32_t start;
+  uint32_t cycles = us * (SystemCoreClock / 1000000U);
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  start = DWT->CYCCNT;
+  while ((DWT->CYCCNT - start) < cycles) {
+  }
+}
 
-  // 发送轮询等待命令
-  if (HAL_QSPI_AutoPolling(&hqspi, &s_command, &s_config,
-                           HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) {
-    return W25Qxx_ERROR_AUTOPOLLING; // 轮询等待无响应
+/**
+ * @brief  器件处于深度掉电时发送0xAB唤醒
+ * @retval QSPI_W25Qxx_OK - 未掉电或唤醒成功
+ * @retval W25Qxx_ERROR_TRANSMIT - 发送失败
+ * @note   掉电期间器件只响应0xAB，其余命令都会被忽略，
+ *         因此每个访问Flash的函数开头都要先调用
+ */
+static int8_t QSPI_W25Qxx_Release(void) {
+  if (!s_power_down) {
+    return QSPI_W25Qxx_OK;
   }
-  return QSPI_W25Qxx_OK; // 通信正常结束
+  if (QSPI_W25Qxx_SendCommand(W25Qxx_CMD_ReleasePowerDown,
+                              QSPI_INSTRUCTION_1_LINE, NULL,
+                              0) != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash退出掉电失败");
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  QSPI_W25Qxx_DelayUs(W25Qxx_Release_TIME_US); // tRES1内器件不接受命令
+  s_power_down = 0;
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  退出连续读模式(Mode Bit Reset)
+ * @retval QSPI_W25Qxx_OK - 发送成功
+ * @retval W25Qxx_ERROR_INIT - 发送失败
+ * @note   连续读模式下器件把片选后的前8个时钟当作4线地址，随后2个时钟为M7-M0，
+ *         因此在4线上发送全1地址和0xFF模式位即可退出；器件不在连续读模式时，
+ *         IO0上收到的是0xFF空指令，不产生任何影响
+ */
+static int8_t QSPI_W25Qxx_ModeBitReset(void) {
+  QSPI_CommandTypeDef s_command; // QSPI传输配置
+
+  s_command.InstructionMode = QSPI_INSTRUCTION_NONE;          // 无指令
+  s_command.AddressMode = QSPI_ADDRESS_4_LINES;               // 4线地址模式
+  s_command.AddressSize = QSPI_ADDRESS_32_BITS;               // 32位地址
+  s_command.Address = 0xFFFFFFFF;                             // 全1地址
+  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_4_LINES; // 4线模式位
+  s_command.AlternateBytesSize = QSPI_ALTERNATE_BYTES_8_BITS; // 8位模式位
+  s_command.AlternateBytes = 0xFF; // M5-M4≠10，退出连续读
+  s_command.DdrMode = QSPI_DDR_MODE_DISABLE;                  // 禁止DDR模式
+  s_command.DdrHoldHalfCycle =
+      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
+  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+  s_command.DataMode = QSPI_DATA_NONE;           // 无数据模式
+  s_command.DummyCycles = 0;                     // 空周期个数
+
+  if (HAL_QSPI_Command(&hqspi, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+      HAL_OK) {
+    DEBUG_ERROR("QSPI Flash退出连续读模式失败");
+    return W25Qxx_ERROR_INIT;
+  }
+  return QSPI_W25Qxx_OK;
 }
 
 /**
@@ -128,6 +441,25 @@ int8_t QSPI_W25Qxx_AutoPollingMemReady(void) {
 int8_t QSPI_W25Qxx_Reset(void) {
   QSPI_CommandTypeDef s_command; // QSPI传输配置
 
+  // 内存映射模式下QUADSPI忙，须先退出才能发送命令
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    PERF_TRACE_MARK(PERF_TRACE_QSPI_UNMAP, 0);
+    HAL_QSPI_Abort(&hqspi);
+  }
+  if (QSPI_W25Qxx_Release() != QSPI_W25Qxx_OK) {
+    return W25Qxx_ERROR_INIT;
+  }
+  // 调试器复位MCU时Flash不会复位，可能仍停在连续读/QPI模式，
+  // 依次退出后再按SPI模式复位，保证外部下载算法和调试会话可用
+  if (QSPI_W25Qxx_ModeBitReset() != QSPI_W25Qxx_OK) {
+    return W25Qxx_ERROR_INIT;
+  }
+  if (QSPI_W25Qxx_SendCommand(W25Qxx_CMD_ExitQPI, QSPI_INSTRUCTION_4_LINES,
+                              NULL, 0) != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash退出QPI模式失败");
+    return W25Qxx_ERROR_INIT;
+  }
+
   s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
   s_command.AddressMode = QSPI_ADDRESS_NONE;               // 无地址模式
   s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
@@ -175,9 +507,13 @@ int8_t QSPI_W25Qxx_Reset(void) {
  */
 uint32_t QSPI_W25Qxx_ReadID(void) {
   QSPI_CommandTypeDef s_command; // QSPI传输配置
-  uint8_t QSPI_ReceiveBuff[3];   // 存储QSPI读到的数据
+  uint8_t QSPI_ReceiveBuff[3 * W25Qxx_CHIPS]; // 存储QSPI读到的数据(双片时两片交替)
   uint32_t W25Qxx_ID;            // 器件的ID
 
+  if (QSPI_W25Qxx_Release() != QSPI_W25Qxx_OK) {
+    return 0;
+  }
+
   s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
   s_command.AddressSize = QSPI_ADDRESS_32_BITS;            // 32位地址
   s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
@@ -188,7 +524,7 @@ uint32_t QSPI_W25Qxx_ReadID(void) {
   s_command.AddressMode = QSPI_ADDRESS_NONE; // 无地址模式
   s_command.DataMode = QSPI_DATA_1_LINE;     // 1线数据模式
   s_command.DummyCycles = 0;                 // 空周期个数
-  s_command.NbData = 3;                      // 传输数据的长度
+  s_command.NbData = 3 * W25Qxx_CHIPS;       // 传输数据的长度
   s_command.Instruction =
       W25Qxx_CMD_JedecID; // 执行读器件ID命令
                           // int status1 = HAL_QSPI_Command(&hqspi, &s_command,
@@ -208,40 +544,254 @@ uint32_t QSPI_W25Qxx_ReadID(void) {
     return 0;
   }
   // 将得到的数据组合成ID
+#ifdef QSPI_DUAL_FLASH_ENABLE
+  // 偶数字节来自BK1，奇数字节来自BK2，两片型号不同时不能并联使用
+  if (QSPI_ReceiveBuff[0] != QSPI_ReceiveBuff[1] ||
+      QSPI_ReceiveBuff[2] != QSPI_ReceiveBuff[3] ||
+      QSPI_ReceiveBuff[4] != QSPI_ReceiveBuff[5]) {
+    DEBUG_ERROR("QSPI 两片Flash的ID不一致");
+    return 0;
+  }
+  W25Qxx_ID = (QSPI_ReceiveBuff[0] << 16) | (QSPI_ReceiveBuff[2] << 8) |
+              QSPI_ReceiveBuff[4];
+#else
   W25Qxx_ID = (QSPI_ReceiveBuff[0] << 16) | (QSPI_ReceiveBuff[1] << 8) |
               QSPI_ReceiveBuff[2];
+#endif
 
   return W25Qxx_ID; // 返回ID
 }
 
 /**
- * @brief  进入内存映射模式
+ * @brief  读取SFDP参数表(0x5A)
+ * @param  addr: SFDP地址
+ * @param  pBuffer: 输出缓冲区
+ * @param  Size: 字节数
+ * @retval QSPI_W25Qxx_OK - 成功
+ * @retval W25Qxx_ERROR_TRANSMIT - 传输失败
+ * @note   SFDP总是3字节地址、8个空周期、1线数据，与器件当前地址模式无关
+ */
+static int8_t QSPI_W25Qxx_ReadSFDP(uint32_t addr, uint8_t *pBuffer,
+                                   uint32_t Size) {
+  QSPI_CommandTypeDef s_command; // QSPI传输配置
+
+  s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
+  s_command.AddressMode = QSPI_ADDRESS_1_LINE;             // 1线地址模式
+  s_command.AddressSize = QSPI_ADDRESS_24_BITS;            // 24位地址
+  s_command.Address = addr;                                // SFDP地址
+  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
+  s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
+  s_command.DdrHoldHalfCycle =
+      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
+  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+  s_command.DataMode = QSPI_DATA_1_LINE;         // 1线数据模式
+  s_command.DummyCycles = 8;                     // 空周期个数
+  s_command.NbData = Size;                       // 数据长度
+  s_command.Instruction = W25Qxx_CMD_ReadSFDP;
+
+  if (HAL_QSPI_Command(&hqspi, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+          HAL_OK ||
+      HAL_QSPI_Receive(&hqspi, pBuffer, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+          HAL_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  由SFDP基本参数表(BFPT)得到器件容量和地址长度
+ * @param  id: JEDEC ID
+ * @retval QSPI_W25Qxx_OK - 成功，结果在 s_part_sfdp
+ * @retval W25Qxx_ERROR_INIT - 没有SFDP或参数不可用
+ * @note   超过16MB的器件按4字节地址指令集(0xEC/0x34/0x21/0xDC)访问，
+ *         其余按3字节地址指令集(0xEB/0x32/0x20/0xD8)，与W25Q系列一致
+ */
+static int8_t QSPI_W25Qxx_ProbeSFDP(uint32_t id) {
+  uint8_t buf[16];
+  uint32_t ptp;     // BFPT地址
+  uint32_t density; // BFPT第2个双字：容量(位)
+  uint32_t size;
+
+  if (QSPI_W25Qxx_ReadSFDP(0, buf, sizeof(buf)) != QSPI_W25Qxx_OK ||
+      memcmp(buf, "SFDP", 4) != 0 || buf[8] != 0x00 || buf[11] < 2) {
+    return W25Qxx_ERROR_INIT; // 第一个参数头必须是BFPT
+  }
+  ptp = buf[12] | (buf[13] << 8) | ((uint32_t)buf[14] << 16);
+  if (QSPI_W25Qxx_ReadSFDP(ptp, buf, 8) != QSPI_W25Qxx_OK) {
+    return W25Qxx_ERROR_INIT;
+  }
+  density = buf[4] | (buf[5] << 8) | ((uint32_t)buf[6] << 16) |
+            ((uint32_t)buf[7] << 24);
+  if (density & 0x80000000U) {
+    density &= 0x7FFFFFFFU; // 容量为2^N位
+    size = (density >= 19 && density <= 31) ? (1UL << (density - 3)) : 0;
+  } else {
+    size = (density + 1U) / 8U;
+  }
+  // 映射窗口256MB，容量须为2的幂且不小于64KB
+  if (size < W25Qxx_BlockSize || size > 0x10000000U ||
+      (size & (size - 1U)) != 0) {
+    return W25Qxx_ERROR_INIT;
+  }
+
+  s_part_sfdp.id = id;
+  s_part_sfdp.name = "SFDP";
+  s_part_sfdp.size = size;
+  if (size > 0x1000000U) {
+    s_part_sfdp.addr_bytes = 4;
+    s_part_sfdp.read = W25Qxx_CMD_FastReadQuad_IO;
+    s_part_sfdp.program = W25Qxx_CMD_QuadInputPageProgram;
+    s_part_sfdp.erase_4k = W25Qxx_CMD_SectorErase;
+    s_part_sfdp.erase_64k = W25Qxx_CMD_BlockErase_64K;
+  } else {
+    s_part_sfdp.addr_bytes = 3;
+    s_part_sfdp.read = W25Qxx_CMD_FastReadQuad_IO_3B;
+    s_part_sfdp.program = W25Qxx_CMD_QuadInputPageProgram_3B;
+    s_part_sfdp.erase_4k = W25Qxx_CMD_SectorErase_3B;
+    s_part_sfdp.erase_64k = W25Qxx_CMD_BlockErase_64K_3B;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  按JEDEC ID查器件能力表，表中没有时读取SFDP，并按容量配置QUADSPI
+ * @param  id: JEDEC ID
+ * @retval QSPI_W25Qxx_OK - 识别成功
+ * @retval W25Qxx_ERROR_INIT - 无法识别、容量小于W25Qxx_FlashSize或QUADSPI重新初始化失败
+ */
+static int8_t QSPI_W25Qxx_Detect(uint32_t id) {
+  const QSPI_W25Qxx_Part_t *part = NULL;
+  uint32_t fsize;
+
+  for (uint32_t i = 0; i < sizeof(s_parts) / sizeof(s_parts[0]); i++) {
+    if (s_parts[i].id == id) {
+      part = &s_parts[i];
+      break;
+    }
+  }
+#ifndef QSPI_DUAL_FLASH_ENABLE
+  // 双片时SFDP数据两片交替，只支持能力表中的器件
+  if (part == NULL && id != 0 && id != 0xFFFFFF &&
+      QSPI_W25Qxx_ProbeSFDP(id) == QSPI_W25Qxx_OK) {
+    part = &s_part_sfdp;
+  }
+#endif
+  if (part == NULL) {
+    return W25Qxx_ERROR_INIT;
+  }
+  if (part->size * W25Qxx_CHIPS < W25Qxx_FlashSize) {
+    DEBUG_ERROR("QSPI Flash容量小于W25Qxx_FlashSize");
+    return W25Qxx_ERROR_INIT;
+  }
+
+  // FSIZE+1 = log2(容量)，双片时按两片合计，映射窗口不超过器件容量
+  for (fsize = 0; (2UL << fsize) < part->size * W25Qxx_CHIPS; fsize++) {
+  }
+  if (hqspi.Init.FlashSize != fsize) {
+    hqspi.Init.FlashSize = fsize;
+    if (HAL_QSPI_Init(&hqspi) != HAL_OK) {
+      return W25Qxx_ERROR_INIT;
+    }
+  }
+  s_part = part;
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  配置映射读取命令并切换到内存映射模式(不复位器件，不处理MPU和Cache)
  * @retval QSPI_W25Qxx_OK - 配置成功
  * @retval W25Qxx_ERROR_MemoryMapped - 配置失败
- * @note   此模式下只能读取，不能写入
+ * @note   调用前器件须处于SPI模式且不在连续读模式
  */
-int8_t QSPI_W25Qxx_MemoryMappedMode(void) {
+static int8_t QSPI_W25Qxx_MapConfig(void) {
   QSPI_CommandTypeDef s_command;             // QSPI传输配置
   QSPI_MemoryMappedTypeDef s_mem_mapped_cfg; // 内存映射访问参数
+  uint8_t wait = 6; // 地址之后到数据之前的时钟数(含模式位)
+#ifdef QSPI_MMAP_QPI
+  uint8_t read_param[W25Qxx_CHIPS]; // 双片时每片各收一个字节
+
+  memset(read_param, W25Qxx_QPI_READ_PARAM, sizeof(read_param));
+#endif
 
+#ifdef QSPI_MMAP_DTR
+  // DDR模式下必须关闭采样移位
+  if (hqspi.Init.SampleShifting != QSPI_SAMPLE_SHIFTING_NONE) {
+    hqspi.Init.SampleShifting = QSPI_SAMPLE_SHIFTING_NONE;
+    if (HAL_QSPI_Init(&hqspi) != HAL_OK) {
+      DEBUG_ERROR("QSPI DTR模式初始化失败");
+      return W25Qxx_ERROR_MemoryMapped;
+    }
+  }
+  // 0xED只有3字节地址格式，超过16MB的器件需要先切到4字节地址模式
+  if (s_part->addr_bytes == 4 &&
+      QSPI_W25Qxx_SendCommand(W25Qxx_CMD_Enter4ByteMode,
+                              QSPI_INSTRUCTION_1_LINE, NULL,
+                              0) != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash进入4字节地址模式失败");
+    return W25Qxx_ERROR_MemoryMapped;
+  }
+  wait = 8; // 模式位1个时钟 + 7个空周期
+#endif
+
+#ifdef QSPI_MMAP_QPI
+  // 进入QPI模式后指令也走4线，读参数设为8个等待时钟以满足高频时序
+  if (QSPI_W25Qxx_SendCommand(W25Qxx_CMD_EnterQPI, QSPI_INSTRUCTION_1_LINE,
+                              NULL, 0) != QSPI_W25Qxx_OK ||
+      QSPI_W25Qxx_SendCommand(W25Qxx_CMD_SetReadParam,
+                              QSPI_INSTRUCTION_4_LINES, read_param,
+                              sizeof(read_param)) != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash进入QPI模式失败");
+    return W25Qxx_ERROR_MemoryMapped;
+  }
+  s_command.InstructionMode = QSPI_INSTRUCTION_4_LINES; // 4线指令模式
+  wait = 8; // 由读参数P5-P4决定
+#else
   s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
-  s_command.AddressSize = QSPI_ADDRESS_32_BITS;            // 32位地址
-  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
+#endif
+
+  s_command.AddressSize = QSPI_W25Qxx_AddressSize();       // 按器件3/4字节地址
+#ifdef QSPI_MMAP_DTR
+  s_command.DdrMode = QSPI_DDR_MODE_ENABLE;                // 使能DDR模式
+  s_command.Instruction =
+      W25Qxx_CMD_FastReadQuad_IO_DTR; // 4线地址4线数据双沿采样快速读取指令
+#else
   s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
+  s_command.Instruction =
+      s_part->read; // 1-4-4模式下(1线指令4线地址4线数据)，快速读取指令
+#endif
   s_command.DdrHoldHalfCycle =
-      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
-  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟
   s_command.AddressMode = QSPI_ADDRESS_4_LINES; // 4线地址模式
   s_command.DataMode = QSPI_DATA_4_LINES;       // 4线数据模式
-  s_command.DummyCycles = 6;                    // 空周期个数
-  s_command.Instruction =
-      W25Qxx_CMD_FastReadQuad_IO; // 1-4-4模式下(1线指令4线地址4线数据)，快速读取指令
+#ifdef QSPI_MMAP_CONTINUOUS_READ
+  // 连续读模式：M7-M0=0xA0，器件此后不再需要指令，QUADSPI也只在首次访问时发送指令
+  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_4_LINES; // 4线模式位
+  s_command.AlternateBytesSize = QSPI_ALTERNATE_BYTES_8_BITS; // 8位模式位
+  s_command.AlternateBytes = W25Qxx_CONTINUOUS_READ_MODE;     // 连续读模式位
+  s_command.SIOOMode = QSPI_SIOO_INST_ONLY_FIRST_CMD; // 仅第一次访问发送指令
+#ifdef QSPI_MMAP_DTR
+  s_command.DummyCycles = wait - 1; // 模式位占1个时钟
+#else
+  s_command.DummyCycles = wait - 2; // 模式位占2个时钟
+#endif
+#else
+  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
+  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+  s_command.DummyCycles = wait;                 // 空周期个数(含模式位时钟)
+#endif
 
+  // 映射模式下QUADSPI总会按顺序预取后续数据直到FIFO填满，
+  // 超时计数器决定预取完成后nCS是否释放：释放可让Flash进入待机省电，
+  // 但下一次非连续访问需要重新发送指令和地址
+#ifdef QSPI_MMAP_TIMEOUT_ENABLE
+  s_mem_mapped_cfg.TimeOutActivation =
+      QSPI_TIMEOUT_COUNTER_ENABLE; // 启用超时计数器, 空闲后释放nCS
+  s_mem_mapped_cfg.TimeOutPeriod = QSPI_MMAP_TIMEOUT_PERIOD; // 超时判断周期
+#else
   s_mem_mapped_cfg.TimeOutActivation =
       QSPI_TIMEOUT_COUNTER_DISABLE; // 禁用超时计数器, nCS 保持激活状态
   s_mem_mapped_cfg.TimeOutPeriod = 0; // 超时判断周期
-
-  QSPI_W25Qxx_Reset(); // 复位W25Qxx
+#endif
 
   if (HAL_QSPI_MemoryMapped(&hqspi, &s_command, &s_mem_mapped_cfg) !=
       HAL_OK) // 进行配置
@@ -249,9 +799,136 @@ int8_t QSPI_W25Qxx_MemoryMappedMode(void) {
     DEBUG_ERROR("QSPI内存映射模式切换失败");
     return W25Qxx_ERROR_MemoryMapped; // 设置内存映射模式错误
   }
+  PERF_TRACE_MARK(PERF_TRACE_QSPI_MAP, 0);
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  复位器件后切换到内存映射模式(不处理MPU和Cache)
+ * @retval QSPI_W25Qxx_OK - 配置成功
+ * @retval W25Qxx_ERROR_INIT - 复位失败，器件可能仍在QPI/连续读模式，不进入映射
+ * @retval W25Qxx_ERROR_MemoryMapped - 配置失败
+ */
+static int8_t QSPI_W25Qxx_MapEnter(void) {
+  int8_t status = QSPI_W25Qxx_Reset(); // 复位W25Qxx，同时退出QPI/连续读模式
+
+  if (status != QSPI_W25Qxx_OK) {
+    return status;
+  }
+  return QSPI_W25Qxx_MapConfig();
+}
+
+/**
+ * @brief  进入内存映射模式
+ * @retval QSPI_W25Qxx_OK - 配置成功
+ * @retval W25Qxx_ERROR_INIT - 复位器件失败
+ * @retval W25Qxx_ERROR_MemoryMapped - 配置失败
+ * @note   此模式下只能读取，不能写入
+ * @note   读取方式由 QSPI_MMAP_QPI / QSPI_MMAP_DTR / QSPI_MMAP_CONTINUOUS_READ 决定
+ */
+int8_t QSPI_W25Qxx_MemoryMappedMode(void) {
+  int8_t status;
+
+  QSPI_W25Qxx_MPU_Config(); // 映射前先配置区域属性
+
+  status = QSPI_W25Qxx_MapEnter();
+  if (status != QSPI_W25Qxx_OK) {
+    return status;
+  }
+#ifdef QSPI_MMAP_MPU_ENABLE
+  // 非映射模式下改写过Flash时，Cache中可能残留旧数据
+  SCB_CleanInvalidateDCache();
+#endif
   return QSPI_W25Qxx_OK; // 配置成功
 }
 
+/**
+ * @brief  配置内存映射区的MPU属性
+ * @note   背景区域覆盖整个256MB QSPI窗口并禁止访问，避免CPU推测读取
+ *         超出Flash容量的地址导致QSPI总线挂死
+ * @note   Flash区域为只读、可Cache(写通)、不共享，字模首次读取后即从Cache命中
+ * @note   定义 QSPI_XIP_ENABLE 时数据区再单独设一个禁止取指的区域，
+ *         代码区读写属性不变
+ */
+void QSPI_W25Qxx_MPU_Config(void) {
+#ifdef QSPI_MMAP_MPU_ENABLE
+  MPU_Region_InitTypeDef MPU_InitStruct = {0};
+
+  HAL_MPU_Disable();
+
+  // 背景区域：256MB，强序，禁止访问
+  MPU_InitStruct.Enable = MPU_REGION_ENABLE;
+  MPU_InitStruct.Number = QSPI_MMAP_MPU_REGION;
+  MPU_InitStruct.BaseAddress = W25Qxx_Mem_Addr;
+  MPU_InitStruct.Size = MPU_REGION_SIZE_256MB;
+  MPU_InitStruct.SubRegionDisable = 0x00;
+  MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL0;
+  MPU_InitStruct.AccessPermission = MPU_REGION_NO_ACCESS;
+  MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+  MPU_InitStruct.IsShareable = MPU_ACCESS_SHAREABLE;
+  MPU_InitStruct.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+  MPU_InitStruct.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+  HAL_MPU_ConfigRegion(&MPU_InitStruct);
+
+  // Flash区域：32MB(与W25Qxx_FlashSize一致，双片时为两片合计)，只读，写通Cache
+  MPU_InitStruct.Number = QSPI_MMAP_MPU_REGION + 1;
+  MPU_InitStruct.Size = MPU_REGION_SIZE_32MB;
+  MPU_InitStruct.AccessPermission = MPU_REGION_PRIV_RO_URO;
+  MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_ENABLE;
+  MPU_InitStruct.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+  MPU_InitStruct.IsCacheable = MPU_ACCESS_CACHEABLE;
+  MPU_InitStruct.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+  HAL_MPU_ConfigRegion(&MPU_InitStruct);
+
+#ifdef QSPI_XIP_ENABLE
+  // 数据区：Flash最后8MB中属于字库的子区域禁止取指，推测取指不会占用QUADSPI
+  MPU_InitStruct.Number = QSPI_MMAP_MPU_REGION + 2;
+  MPU_InitStruct.BaseAddress = W25Qxx_Mem_Addr + QSPI_XIP_MPU_BASE;
+  MPU_InitStruct.Size = MPU_REGION_SIZE_8MB;
+  MPU_InitStruct.SubRegionDisable = QSPI_XIP_MPU_SRD;
+  MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+  HAL_MPU_ConfigRegion(&MPU_InitStruct);
+#endif
+
+  HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+#endif
+}
+
+/**
+ * @brief  测量内存映射模式下的读取耗时
+ * @param  ReadAddr: 读取地址（相对Flash起始的偏移）
+ * @param  NumByteToRead: 读取字节数
+ * @param  cold: 1-先使对应Cache行失效, 0-直接读取
+ * @retval 读取耗费的CPU周期数
+ * @note   cold=1得到QSPI取字模的实际延迟，cold=0得到Cache命中时的耗时
+ */
+uint32_t QSPI_W25Qxx_MeasureReadCycles(uint32_t ReadAddr,
+                                       uint32_t NumByteToRead, uint8_t cold) {
+  const volatile uint32_t *p =
+      (const volatile uint32_t *)(W25Qxx_Mem_Addr + (ReadAddr & ~3U));
+  uint32_t words = (NumByteToRead + 3) / 4;
+  uint32_t start, i;
+  volatile uint32_t sum = 0;
+
+  // 使能DWT周期计数器
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  if (cold) {
+    SCB_InvalidateDCache_by_Addr((uint32_t *)p, (int32_t)(words * 4));
+  }
+  __DSB();
+
+  start = DWT->CYCCNT;
+  for (i = 0; i < words; i++) {
+    sum += p[i];
+  }
+  __DSB();
+
+  return DWT->CYCCNT - start;
+}
+
 /**
  * @brief  发送写使能命令
  * @retval QSPI_W25Qxx_OK - 写使能成功
@@ -260,7 +937,15 @@ int8_t QSPI_W25Qxx_MemoryMappedMode(void) {
  */
 int8_t QSPI_W25Qxx_WriteEnable(void) {
 
+#ifdef PERF_TRACE_ENABLE
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    PERF_TRACE_MARK(PERF_TRACE_QSPI_UNMAP, 0);
+  }
+#endif
   HAL_QSPI_Abort(&hqspi); // 先退出内存映射
+  if (QSPI_W25Qxx_Release() != QSPI_W25Qxx_OK) {
+    return W25Qxx_ERROR_WriteEnable;
+  }
 
   QSPI_CommandTypeDef s_command;    // QSPI传输配置
   QSPI_AutoPollingTypeDef s_config; // 轮询比较相关配置参数
@@ -287,17 +972,17 @@ int8_t QSPI_W25Qxx_WriteEnable(void) {
   // W25Qxx_Status_REG1_WEL 不停的与 0x02 作比较
   // 读状态寄存器1的第1位（只读），WEL写使能标志位，该标志位为1时，代表可以进行写操作
 
-  s_config.Match = 0x02; // 匹配值
-  s_config.Mask =
-      W25Qxx_Status_REG1_WEL; // 读状态寄存器1的第1位（只读），WEL写使能标志位，该标志位为1时，代表可以进行写操作
+  s_config.Match = W25Qxx_STATUS_FLAG(W25Qxx_Status_REG1_WEL); // 匹配值(每片都置位)
+  s_config.Mask = W25Qxx_STATUS_FLAG(
+      W25Qxx_Status_REG1_WEL); // 读状态寄存器1的第1位（只读），WEL写使能标志位，该标志位为1时，代表可以进行写操作
   s_config.MatchMode = QSPI_MATCH_MODE_AND;            // 与运算
-  s_config.StatusBytesSize = 1;                        // 状态字节数
+  s_config.StatusBytesSize = W25Qxx_STATUS_BYTES;      // 状态字节数(每片一个)
   s_config.Interval = 0x10;                            // 轮询间隔
   s_config.AutomaticStop = QSPI_AUTOMATIC_STOP_ENABLE; // 自动停止模式
 
   s_command.Instruction = W25Qxx_CMD_ReadStatus_REG1; // 读状态信息寄存器
   s_command.DataMode = QSPI_DATA_1_LINE;              // 1线数据模式
-  s_command.NbData = 1;                               // 数据长度
+  s_command.NbData = W25Qxx_STATUS_BYTES;             // 数据长度
 
   // 发送轮询等待命令
   if (HAL_QSPI_AutoPolling(&hqspi, &s_command, &s_config,
@@ -315,14 +1000,18 @@ int8_t QSPI_W25Qxx_WriteEnable(void) {
  * @retval W25Qxx_ERROR_WriteEnable - 写使能失败
  * @retval W25Qxx_ERROR_Erase - 擦除失败
  * @retval W25Qxx_ERROR_AUTOPOLLING - 轮询等待无响应
+ * @retval W25Qxx_ERROR_TRANSMIT - DMA读取或异步擦写进行中(含暂停)
  * @note   典型耗时：45ms，最大：400ms
  * @note   Flash使用时间越长，擦除所需时间越长
  */
 int8_t QSPI_W25Qxx_SectorErase(uint32_t SectorAddress) {
   QSPI_CommandTypeDef s_command; // QSPI传输配置
 
+  if (s_dma_busy || s_wr_state != W25Qxx_WR_IDLE) {
+    return W25Qxx_ERROR_TRANSMIT; // 擦除暂停期间器件不接受新的擦写
+  }
   s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
-  s_command.AddressSize = QSPI_ADDRESS_32_BITS;            // 32位地址
+  s_command.AddressSize = QSPI_W25Qxx_AddressSize();       // 按器件3/4字节地址
   s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; //	无交替字节
   s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
   s_command.DdrHoldHalfCycle =
@@ -332,7 +1021,7 @@ int8_t QSPI_W25Qxx_SectorErase(uint32_t SectorAddress) {
   s_command.DataMode = QSPI_DATA_NONE;            // 无数据
   s_command.DummyCycles = 0;                      // 空周期个数
   s_command.Address = SectorAddress;              // 要擦除的地址
-  s_command.Instruction = W25Qxx_CMD_SectorErase; // 扇区擦除命令
+  s_command.Instruction = s_part->erase_4k; // 扇区擦除命令
 
   // 发送写使能
   if (QSPI_W25Qxx_WriteEnable() != QSPI_W25Qxx_OK) {
@@ -345,8 +1034,9 @@ int8_t QSPI_W25Qxx_SectorErase(uint32_t SectorAddress) {
     DEBUG_ERROR("QSPI Flash擦除命令发送失败");
     return W25Qxx_ERROR_Erase; // 擦除失败
   }
+  QSPI_W25Qxx_Touch(SectorAddress & ~(W25Qxx_SectorSize - 1U), W25Qxx_SectorSize);
   // 使用自动轮询标志位，等待擦除的结束
-  if (QSPI_W25Qxx_AutoPollingMemReady() != QSPI_W25Qxx_OK) {
+  if (QSPI_W25Qxx_WaitErase(HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != QSPI_W25Qxx_OK) {
     DEBUG_ERROR("QSPI Flash擦除失败");
     return W25Qxx_ERROR_AUTOPOLLING; // 轮询等待无响应
   }
@@ -360,6 +1050,7 @@ int8_t QSPI_W25Qxx_SectorErase(uint32_t SectorAddress) {
  * @retval W25Qxx_ERROR_WriteEnable - 写使能失败
  * @retval W25Qxx_ERROR_Erase - 擦除失败
  * @retval W25Qxx_ERROR_AUTOPOLLING - 轮询等待无响应
+ * @retval W25Qxx_ERROR_TRANSMIT - DMA读取或异步擦写进行中(含暂停)
  * @note   典型耗时：150ms，最大：2000ms
  * @note   推荐使用：大数据量擦除速度最快
  * @note   Flash使用时间越长，擦除所需时间越长
@@ -367,8 +1058,11 @@ int8_t QSPI_W25Qxx_SectorErase(uint32_t SectorAddress) {
 int8_t QSPI_W25Qxx_BlockErase_64K(uint32_t SectorAddress) {
   QSPI_CommandTypeDef s_command; // QSPI传输配置
 
+  if (s_dma_busy || s_wr_state != W25Qxx_WR_IDLE) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
   s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
-  s_command.AddressSize = QSPI_ADDRESS_32_BITS;            // 32位地址
+  s_command.AddressSize = QSPI_W25Qxx_AddressSize();       // 按器件3/4字节地址
   s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; //	无交替字节
   s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
   s_command.DdrHoldHalfCycle =
@@ -379,7 +1073,7 @@ int8_t QSPI_W25Qxx_BlockErase_64K(uint32_t SectorAddress) {
   s_command.DummyCycles = 0;                   // 空周期个数
   s_command.Address = SectorAddress;           // 要擦除的地址
   s_command.Instruction =
-      W25Qxx_CMD_BlockErase_64K; // 块擦除命令，每次擦除64K字节
+      s_part->erase_64k; // 块擦除命令，每次擦除64K字节
 
   // 发送写使能
   if (QSPI_W25Qxx_WriteEnable() != QSPI_W25Qxx_OK) {
@@ -392,8 +1086,9 @@ int8_t QSPI_W25Qxx_BlockErase_64K(uint32_t SectorAddress) {
     DEBUG_ERROR("QSPI Flash擦除命令发送失败");
     return W25Qxx_ERROR_Erase; // 擦除失败
   }
+  QSPI_W25Qxx_Touch(SectorAddress & ~(W25Qxx_BlockSize - 1U), W25Qxx_BlockSize);
   // 使用自动轮询标志位，等待擦除的结束
-  if (QSPI_W25Qxx_AutoPollingMemReady() != QSPI_W25Qxx_OK) {
+  if (QSPI_W25Qxx_WaitErase(HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != QSPI_W25Qxx_OK) {
     DEBUG_ERROR("QSPI Flash擦除失败");
     return W25Qxx_ERROR_AUTOPOLLING; // 轮询等待无响应
   }
@@ -406,14 +1101,17 @@ int8_t QSPI_W25Qxx_BlockErase_64K(uint32_t SectorAddress) {
  * @retval W25Qxx_ERROR_WriteEnable - 写使能失败
  * @retval W25Qxx_ERROR_Erase - 擦除失败
  * @retval W25Qxx_ERROR_AUTOPOLLING - 轮询等待无响应
+ * @retval W25Qxx_ERROR_TRANSMIT - DMA读取或异步擦写进行中(含暂停)
  * @note   典型耗时：80s，最大：400s
  * @note   危险操作：会清除所有数据
  * @note   Flash使用时间越长，擦除所需时间越长
  */
 int8_t QSPI_W25Qxx_ChipErase(void) {
-  QSPI_CommandTypeDef s_command;    // QSPI传输配置
-  QSPI_AutoPollingTypeDef s_config; // 轮询等待配置参数
+  QSPI_CommandTypeDef s_command; // QSPI传输配置
 
+  if (s_dma_busy || s_wr_state != W25Qxx_WR_IDLE) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
   s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
   s_command.AddressSize = QSPI_ADDRESS_32_BITS;            // 32位地址
   s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; //	无交替字节
@@ -437,33 +1135,41 @@ int8_t QSPI_W25Qxx_ChipErase(void) {
     DEBUG_ERROR("QSPI Flash擦除命令发送失败");
     return W25Qxx_ERROR_Erase; // 擦除失败
   }
+  QSPI_W25Qxx_Touch(0, W25Qxx_FlashSize);
 
-  // 不停的查询 W25Qxx_CMD_ReadStatus_REG1 寄存器，将读取到的状态字节中的
-  // W25Qxx_Status_REG1_BUSY 不停的与0作比较
-  // 读状态寄存器1的第0位（只读），Busy标志位，当正在擦除/写入数据/写命令时会被置1，空闲或通信结束为0
-
-  s_config.Match = 0;                                  //	匹配值
-  s_config.MatchMode = QSPI_MATCH_MODE_AND;            //	与运算
-  s_config.Interval = 0x10;                            //	轮询间隔
-  s_config.AutomaticStop = QSPI_AUTOMATIC_STOP_ENABLE; // 自动停止模式
-  s_config.StatusBytesSize = 1;                        //	状态字节数
-  s_config.Mask =
-      W25Qxx_Status_REG1_BUSY; // 对在轮询模式下接收的状态字节进行屏蔽，只比较需要用到的位
-
-  s_command.Instruction = W25Qxx_CMD_ReadStatus_REG1; // 读状态信息寄存器
-  s_command.DataMode = QSPI_DATA_1_LINE;              // 1线数据模式
-  s_command.NbData = 1;                               // 数据长度
-
-  // W25Q256整片擦除的典型参考时间为20s，最大时间为100s，这里的超时等待值
-  // W25Qxx_ChipErase_TIMEOUT_MAX 为 100S
-  if (HAL_QSPI_AutoPolling(&hqspi, &s_command, &s_config,
-                           W25Qxx_ChipErase_TIMEOUT_MAX) != HAL_OK) {
+  // W25Q256整片擦除的典型参考时间为80s，最大时间为400s
+  if (QSPI_W25Qxx_WaitErase(W25Qxx_ChipErase_TIMEOUT_MAX) != QSPI_W25Qxx_OK) {
     DEBUG_ERROR("QSPI Flash擦除失败");
     return W25Qxx_ERROR_AUTOPOLLING; // 轮询等待无响应
   }
   return QSPI_W25Qxx_OK;
 }
 
+/**
+ * @brief  填充页编程命令
+ * @param  s_command: 输出命令配置
+ * @param  WriteAddr: 写入地址
+ * @param  NumByteToWrite: 写入字节数（≤256）
+ */
+static void QSPI_W25Qxx_PageProgramCommand(QSPI_CommandTypeDef *s_command,
+                                           uint32_t WriteAddr,
+                                           uint16_t NumByteToWrite) {
+  s_command->InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
+  s_command->AddressSize = QSPI_W25Qxx_AddressSize();       // 按器件3/4字节地址
+  s_command->AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
+  s_command->DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
+  s_command->DdrHoldHalfCycle =
+      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
+  s_command->SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+  s_command->AddressMode = QSPI_ADDRESS_1_LINE; // 1线地址模式
+  s_command->DataMode = QSPI_DATA_4_LINES;      // 4线数据模式
+  s_command->DummyCycles = 0;                   // 空周期个数
+  s_command->NbData = NumByteToWrite; // 数据长度，最大只能256字节
+  s_command->Address = WriteAddr;     // 要写入 W25Qxx 的地址
+  s_command->Instruction =
+      s_part->program; // 1-1-4模式下(1线指令1线地址4线数据)，页编程指令
+}
+
 /**
  * @brief  页写入（最大256字节）
  * @param  pBuffer: 数据缓冲区指针
@@ -471,7 +1177,7 @@ int8_t QSPI_W25Qxx_ChipErase(void) {
  * @param  NumByteToWrite: 写入字节数（≤256）
  * @retval QSPI_W25Qxx_OK - 写入成功
  * @retval W25Qxx_ERROR_WriteEnable - 写使能失败
- * @retval W25Qxx_ERROR_TRANSMIT - 传输失败
+ * @retval W25Qxx_ERROR_TRANSMIT - 传输失败，或DMA读取/异步擦写进行中(含暂停)
  * @retval W25Qxx_ERROR_AUTOPOLLING - 轮询等待无响应
  * @note   写入前必须先擦除
  * @note   典型耗时：0.4ms/页，最大：3ms
@@ -481,20 +1187,10 @@ int8_t QSPI_W25Qxx_WritePage(uint8_t *pBuffer, uint32_t WriteAddr,
                              uint16_t NumByteToWrite) {
   QSPI_CommandTypeDef s_command; // QSPI传输配置
 
-  s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
-  s_command.AddressSize = QSPI_ADDRESS_32_BITS;            // 32位地址
-  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
-  s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
-  s_command.DdrHoldHalfCycle =
-      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
-  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
-  s_command.AddressMode = QSPI_ADDRESS_1_LINE; // 1线地址模式
-  s_command.DataMode = QSPI_DATA_4_LINES;      // 4线数据模式
-  s_command.DummyCycles = 0;                   // 空周期个数
-  s_command.NbData = NumByteToWrite; // 数据长度，最大只能256字节
-  s_command.Address = WriteAddr;     // 要写入 W25Qxx 的地址
-  s_command.Instruction =
-      W25Qxx_CMD_QuadInputPageProgram; // 1-1-4模式下(1线指令1线地址4线数据)，页编程指令
+  if (s_dma_busy || s_wr_state != W25Qxx_WR_IDLE) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  QSPI_W25Qxx_PageProgramCommand(&s_command, WriteAddr, NumByteToWrite);
 
   // 写使能
   if (QSPI_W25Qxx_WriteEnable() != QSPI_W25Qxx_OK) {
@@ -507,6 +1203,7 @@ int8_t QSPI_W25Qxx_WritePage(uint8_t *pBuffer, uint32_t WriteAddr,
     DEBUG_ERROR("QSPI Flash写命令发送失败");
     return W25Qxx_ERROR_TRANSMIT; // 传输数据错误
   }
+  QSPI_W25Qxx_Touch(WriteAddr, NumByteToWrite);
   // 开始传输数据
   if (HAL_QSPI_Transmit(&hqspi, pBuffer, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
       HAL_OK) {
@@ -539,6 +1236,9 @@ int8_t QSPI_W25Qxx_WriteBuffer(uint8_t *pBuffer, uint32_t WriteAddr,
   uint32_t end_addr, current_size, current_addr;
   uint8_t *write_data; // 要写入的数据
 
+  if (!QSPI_W25Qxx_DualAligned(WriteAddr, Size)) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
   current_size =
       W25Qxx_PageSize - (WriteAddr % W25Qxx_PageSize); // 计算当前页还剩余的空间
 
@@ -584,6 +1284,30 @@ int8_t QSPI_W25Qxx_WriteBuffer(uint8_t *pBuffer, uint32_t WriteAddr,
   return QSPI_W25Qxx_OK; // 写入数据成功
 }
 
+/**
+ * @brief  填充间接模式读取命令
+ * @param  s_command: 输出命令配置
+ * @param  ReadAddr: 读取地址
+ * @param  NumByteToRead: 读取字节数
+ */
+static void QSPI_W25Qxx_ReadCommand(QSPI_CommandTypeDef *s_command,
+                                    uint32_t ReadAddr, uint32_t NumByteToRead) {
+  s_command->InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
+  s_command->AddressSize = QSPI_W25Qxx_AddressSize();       // 按器件3/4字节地址
+  s_command->AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
+  s_command->DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
+  s_command->DdrHoldHalfCycle =
+      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
+  s_command->SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+  s_command->AddressMode = QSPI_ADDRESS_4_LINES; // 4线地址模式
+  s_command->DataMode = QSPI_DATA_4_LINES;       // 4线数据模式
+  s_command->DummyCycles = 6;                    // 空周期个数
+  s_command->NbData = NumByteToRead; // 数据长度，最大不能超过flash芯片的大小
+  s_command->Address = ReadAddr; // 要读取 W25Qxx 的地址
+  s_command->Instruction =
+      s_part->read; // 1-4-4模式下(1线指令4线地址4线数据)，快速读取指令
+}
+
 /**
  * @brief  缓冲区读取（任意长度）
  * @param  pBuffer: 数据缓冲区指针
@@ -591,30 +1315,21 @@ int8_t QSPI_W25Qxx_WriteBuffer(uint8_t *pBuffer, uint32_t WriteAddr,
  * @param  NumByteToRead: 读取字节数（≤Flash容量）
  * @retval QSPI_W25Qxx_OK - 读取成功
  * @retval W25Qxx_ERROR_TRANSMIT - 传输失败
- * @retval W25Qxx_ERROR_AUTOPOLLING - 轮询等待无响应
- * @note   使用1-4-4模式快速读取（Fast Read Quad I/O, 0xEB指令）
+ * @note   使用1-4-4模式快速读取（Fast Read Quad I/O, 0xEC指令）
  * @note   读取速度受QSPI时钟、DMA、Cache、编译器优化等级影响
  * @note   数据存储位置（TCM SRAM / AXI SRAM）也会影响性能
  * @note   W25Q256JV最高驱动频率为133MHz
+ * @note   读操作不会使器件进入忙状态，接收完成即可返回，无需状态轮询
  */
 int8_t QSPI_W25Qxx_ReadBuffer(uint8_t *pBuffer, uint32_t ReadAddr,
                               uint32_t NumByteToRead) {
   QSPI_CommandTypeDef s_command; // QSPI传输配置
 
-  s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
-  s_command.AddressSize = QSPI_ADDRESS_32_BITS;            // 32位地址
-  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
-  s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
-  s_command.DdrHoldHalfCycle =
-      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
-  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
-  s_command.AddressMode = QSPI_ADDRESS_4_LINES; // 4线地址模式
-  s_command.DataMode = QSPI_DATA_4_LINES;       // 4线数据模式
-  s_command.DummyCycles = 6;                    // 空周期个数
-  s_command.NbData = NumByteToRead; // 数据长度，最大不能超过flash芯片的大小
-  s_command.Address = ReadAddr; // 要读取 W25Qxx 的地址
-  s_command.Instruction =
-      W25Qxx_CMD_FastReadQuad_IO; // 1-4-4模式下(1线指令4线地址4线数据)，快速读取指令
+  if (!QSPI_W25Qxx_DualAligned(ReadAddr, NumByteToRead) ||
+      QSPI_W25Qxx_Release() != QSPI_W25Qxx_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  QSPI_W25Qxx_ReadCommand(&s_command, ReadAddr, NumByteToRead);
 
   // 发送读取命令
   if (HAL_QSPI_Command(&hqspi, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
@@ -630,13 +1345,1344 @@ int8_t QSPI_W25Qxx_ReadBuffer(uint8_t *pBuffer, uint32_t ReadAddr,
     DEBUG_ERROR("QSPI Flash读取数据失败");
     return W25Qxx_ERROR_TRANSMIT; // 传输数据错误
   }
+  return QSPI_W25Qxx_OK; // 读取数据成功
+}
 
-  // 使用自动轮询标志位，等待接收的结束
-  if (QSPI_W25Qxx_AutoPollingMemReady() != QSPI_W25Qxx_OK) {
-    DEBUG_ERROR("QSPI Flash读取数据失败");
-    return W25Qxx_ERROR_AUTOPOLLING; // 轮询等待无响应
+/*******************************************************************************
+ *                              时钟自动校准
+ *******************************************************************************/
+
+#ifdef QSPI_CALIBRATE_ENABLE
+
+#ifdef QSPI_XIP_ENABLE
+#error "XIP时映射模式不能中断，QSPI_CALIBRATE_ENABLE 只能用于QSPI只存放数据的工程"
+#endif
+
+#define W25Qxx_CALIB_MAGIC 0x4C414351U /*!< 保存记录魔数 "QCAL" */
+#define W25Qxx_CALIB_CHUNK 256         /*!< 每次间接读取的字节数 */
+
+/**
+ * @brief  保存在 QSPI_CALIB_SAVE_ADDR 的校准记录
+ */
+typedef struct {
+  uint32_t magic;     // W25Qxx_CALIB_MAGIC
+  uint32_t kernel_hz; // 校准时的QSPI内核时钟
+  uint8_t prescaler;  // ClockPrescaler
+  uint8_t shift;      // 1-半周期采样移位
+  uint8_t reserved[2];
+  uint32_t check; // ~(magic ^ kernel_hz ^ (prescaler << 8 | shift))
+} QSPI_W25Qxx_Calib_t;
+
+#ifdef QSPI_MMAP_DTR
+static const uint8_t s_calib_shifts[] = {0}; // DDR模式下必须关闭采样移位
+#else
+static const uint8_t s_calib_shifts[] = {1, 0}; // 同一分频下优先半周期采样
+#endif
+
+static uint8_t s_calib_prescaler; // 校准得到的ClockPrescaler
+static uint8_t s_calib_shift;     // 校准得到的采样移位
+static uint8_t s_calib_source = 0; // 0-未校准, 1-保存的结果, 2-重新扫描
+
+/**
+ * @brief  计算QSPI内核时钟(与RCC中的QSPISEL一致)
+ */
+static uint32_t QSPI_W25Qxx_KernelClock(void) {
+  PLL1_ClocksTypeDef pll1;
+  PLL2_ClocksTypeDef pll2;
+
+  switch (__HAL_RCC_GET_QSPI_SOURCE()) {
+  case RCC_QSPICLKSOURCE_PLL:
+    HAL_RCCEx_GetPLL1ClockFreq(&pll1);
+    return pll1.PLL1_Q_Frequency;
+  case RCC_QSPICLKSOURCE_PLL2:
+    HAL_RCCEx_GetPLL2ClockFreq(&pll2);
+    return pll2.PLL2_R_Frequency;
+  case RCC_QSPICLKSOURCE_CLKP:
+    return HSI_VALUE; // per_ck默认来自HSI
+  default:
+    return HAL_RCC_GetHCLKFreq();
   }
-  return QSPI_W25Qxx_OK; // 读取数据成功
+}
+
+/**
+ * @brief  设置分频和采样移位并重新初始化QUADSPI
+ */
+static int8_t QSPI_W25Qxx_CalibSet(uint8_t prescaler, uint8_t shift) {
+  hqspi.Init.ClockPrescaler = prescaler;
+  hqspi.Init.SampleShifting =
+      shift ? QSPI_SAMPLE_SHIFTING_HALFCYCLE : QSPI_SAMPLE_SHIFTING_NONE;
+  if (HAL_QSPI_Init(&hqspi) != HAL_OK) {
+    return W25Qxx_ERROR_INIT;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  读取校验图样并计算与字节顺序有关的校验值
+ * @param  hash: 输出校验值
+ * @param  flat: 输出1-全部字节相同(不能作为图样), 可为NULL
+ */
+static int8_t QSPI_W25Qxx_CalibRead(uint32_t *hash, uint8_t *flat) {
+  uint8_t buf[W25Qxx_CALIB_CHUNK];
+  uint32_t h = 2166136261U; // FNV-1a
+  uint8_t first = 0, same = 1;
+
+  for (uint32_t ofs = 0; ofs < QSPI_CALIB_SIZE; ofs += W25Qxx_CALIB_CHUNK) {
+    if (QSPI_W25Qxx_ReadBuffer(buf, QSPI_CALIB_ADDR + ofs,
+                               W25Qxx_CALIB_CHUNK) != QSPI_W25Qxx_OK) {
+      return W25Qxx_ERROR_TRANSMIT;
+    }
+    if (ofs == 0) {
+      first = buf[0];
+    }
+    for (uint32_t i = 0; i < W25Qxx_CALIB_CHUNK; i++) {
+      h = (h ^ buf[i]) * 16777619U;
+      same &= (buf[i] == first);
+    }
+  }
+  *hash = h;
+  if (flat != NULL) {
+    *flat = same;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  当前配置连续 QSPI_CALIB_PASSES 次读到参考图样
+ * @retval 1-可靠, 0-出错
+ */
+static uint8_t QSPI_W25Qxx_CalibPass(uint32_t ref) {
+  uint32_t h;
+
+  for (uint16_t i = 0; i < QSPI_CALIB_PASSES; i++) {
+    if (QSPI_W25Qxx_CalibRead(&h, NULL) != QSPI_W25Qxx_OK || h != ref) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief  校准记录的校验字
+ */
+static uint32_t QSPI_W25Qxx_CalibCheck(const QSPI_W25Qxx_Calib_t *rec) {
+  return ~(rec->magic ^ rec->kernel_hz ^
+           ((uint32_t)rec->prescaler << 8 | rec->shift));
+}
+
+/**
+ * @brief  校准QSPI时钟分频和采样移位
+ * @retval QSPI_W25Qxx_OK - 校准完成
+ * @retval W25Qxx_ERROR_INIT - 校验图样无效，恢复原配置
+ */
+int8_t QSPI_W25Qxx_Calibrate(void) {
+  QSPI_InitTypeDef init = hqspi.Init; // 失败时恢复
+  QSPI_W25Qxx_Calib_t rec;
+  uint32_t hz = QSPI_W25Qxx_KernelClock();
+  uint32_t ref, again;
+  uint8_t safe = 0, fast = 0, flat = 1;
+  uint8_t best_p, best_s = s_calib_shifts[0];
+  uint8_t saved, found;
+  int16_t p;
+
+  while (hz / (safe + 1U) > QSPI_CALIB_SAFE_HZ && safe < 255) {
+    safe++;
+  }
+  while (hz / (fast + 1U) > QSPI_CALIB_MAX_HZ && fast < safe) {
+    fast++;
+  }
+
+  // 低速下两次读取一致的图样作为参考
+  if (QSPI_W25Qxx_CalibSet(safe, best_s) != QSPI_W25Qxx_OK ||
+      QSPI_W25Qxx_CalibRead(&ref, &flat) != QSPI_W25Qxx_OK || flat ||
+      QSPI_W25Qxx_CalibRead(&again, NULL) != QSPI_W25Qxx_OK || again != ref) {
+    DEBUG_ERROR("QSPI校准图样无效");
+    hqspi.Init = init;
+    HAL_QSPI_Init(&hqspi);
+    return W25Qxx_ERROR_INIT;
+  }
+
+  // 先验证上次保存的结果
+  saved = (QSPI_W25Qxx_ReadBuffer((uint8_t *)&rec, QSPI_CALIB_SAVE_ADDR,
+                                  sizeof(rec)) == QSPI_W25Qxx_OK &&
+           rec.magic == W25Qxx_CALIB_MAGIC &&
+           rec.check == QSPI_W25Qxx_CalibCheck(&rec) && rec.kernel_hz == hz &&
+           rec.prescaler >= fast && rec.prescaler <= safe &&
+           rec.shift <= 1);
+  if (saved && QSPI_W25Qxx_CalibSet(rec.prescaler, rec.shift) ==
+                   QSPI_W25Qxx_OK &&
+      QSPI_W25Qxx_CalibPass(ref)) {
+    s_calib_prescaler = rec.prescaler;
+    s_calib_shift = rec.shift;
+    s_calib_source = 1;
+    return QSPI_W25Qxx_OK;
+  }
+
+  // 从低速向高速逐级尝试，某一级全部失败后不再继续
+  best_p = safe;
+  for (p = (int16_t)safe - 1; p >= fast; p--) {
+    found = 0;
+    for (uint8_t i = 0; i < sizeof(s_calib_shifts) && !found; i++) {
+      if (QSPI_W25Qxx_CalibSet((uint8_t)p, s_calib_shifts[i]) ==
+              QSPI_W25Qxx_OK &&
+          QSPI_W25Qxx_CalibPass(ref)) {
+        best_p = (uint8_t)p;
+        best_s = s_calib_shifts[i];
+        found = 1;
+      }
+    }
+    if (!found) {
+      break;
+    }
+  }
+  QSPI_W25Qxx_CalibSet(best_p, best_s);
+  s_calib_prescaler = best_p;
+  s_calib_shift = best_s;
+  s_calib_source = 2;
+
+  // 结果与记录不同时才擦写
+  if (!saved || rec.prescaler != best_p || rec.shift != best_s) {
+    rec.magic = W25Qxx_CALIB_MAGIC;
+    rec.kernel_hz = hz;
+    rec.prescaler = best_p;
+    rec.shift = best_s;
+    rec.reserved[0] = rec.reserved[1] = 0xFF;
+    rec.check = QSPI_W25Qxx_CalibCheck(&rec);
+    if (QSPI_W25Qxx_SectorErase(QSPI_CALIB_SAVE_ADDR) != QSPI_W25Qxx_OK ||
+        QSPI_W25Qxx_WriteBuffer((uint8_t *)&rec, QSPI_CALIB_SAVE_ADDR,
+                                sizeof(rec)) != QSPI_W25Qxx_OK) {
+      DEBUG_ERROR("QSPI校准结果保存失败"); // 只影响下次上电的校准时间
+    }
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  读取校准结果
+ * @retval 0-未校准, 1-使用保存的结果, 2-本次上电重新扫描
+ */
+uint8_t QSPI_W25Qxx_GetCalibration(uint8_t *prescaler, uint8_t *shift) {
+  if (prescaler != NULL) {
+    *prescaler = s_calib_prescaler;
+  }
+  if (shift != NULL) {
+    *shift = s_calib_shift;
+  }
+  return s_calib_source;
+}
+
+#endif /* QSPI_CALIBRATE_ENABLE */
+
+/*******************************************************************************
+ *                              DMA读取与异步写入
+ *******************************************************************************/
+
+static uint8_t *s_dma_buffer;              // DMA读取目标缓冲区
+static uint32_t s_dma_size;                // DMA读取总长度
+static uint32_t s_dma_done;                // 已完成的长度
+static uint32_t s_dma_chunk;               // 当前分段长度
+static uint32_t s_dma_addr;                // DMA读取起始地址
+static QSPI_W25Qxx_Callback_t s_dma_cb;    // 完成回调
+
+static uint8_t *s_wr_data;                   // 异步写入数据源
+static uint32_t s_wr_addr;                   // 异步写入起始地址
+static uint32_t s_wr_size;                   // 异步写入总长度
+static uint32_t s_wr_done;                   // 已写入长度
+static uint32_t s_wr_chunk;                  // 当前页写入长度
+static QSPI_W25Qxx_Progress_t s_wr_progress; // 进度回调
+static QSPI_W25Qxx_Callback_t s_wr_cplt;     // 完成回调
+static uint32_t s_wr_erase;                  // 非0时为异步擦除，值为擦除字节数
+static uint32_t s_resume_cycle;              // 上次恢复擦除时的DWT计数
+static uint8_t s_resumed = 0;                // 1-恢复过擦除，再次暂停前须间隔tSUS
+static volatile uint8_t s_wr_pause = 0;      // 1-多页编程在本页结束后停下
+static uint8_t s_wr_remap = 0;               // 1-启动时处于内存映射模式，结束时恢复
+
+static void QSPI_W25Qxx_FinishWrite_Async(int8_t status);
+static void QSPI_W25Qxx_EraseCommand_IT(void);
+static void QSPI_W25Qxx_ErasePoll_IT(void);
+
+/**
+ * @brief  启动下一段DMA读取
+ * @retval QSPI_W25Qxx_OK - 启动成功
+ * @retval W25Qxx_ERROR_TRANSMIT - 启动失败
+ * @note   MDMA单块最多W25Qxx_DMA_MaxChunk字节，更长的读取分段进行
+ */
+static int8_t QSPI_W25Qxx_ReadChunk_DMA(void) {
+  QSPI_CommandTypeDef s_command; // QSPI传输配置
+  uint32_t left = s_dma_size - s_dma_done;
+
+  s_dma_chunk = (left > W25Qxx_DMA_MaxChunk) ? W25Qxx_DMA_MaxChunk : left;
+  QSPI_W25Qxx_ReadCommand(&s_command, s_dma_addr + s_dma_done, s_dma_chunk);
+
+  if (HAL_QSPI_Command(&hqspi, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+          HAL_OK ||
+      HAL_QSPI_Receive_DMA(&hqspi, s_dma_buffer + s_dma_done) != HAL_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  结束DMA读取并通知调用者
+ * @param  status: 读取结果
+ */
+static void QSPI_W25Qxx_FinishRead_DMA(int8_t status) {
+  QSPI_W25Qxx_Callback_t cb = s_dma_cb;
+
+  // MDMA直接写内存，丢弃CPU中的旧Cache行
+  SCB_InvalidateDCache_by_Addr((uint32_t *)s_dma_buffer, (int32_t)s_dma_size);
+  s_dma_busy = 0;
+  if (cb != NULL) {
+    cb(status);
+  }
+}
+
+/**
+ * @brief  缓冲区DMA读取（任意长度，非阻塞）
+ * @param  pBuffer: 数据缓冲区指针
+ * @param  ReadAddr: 读取地址
+ * @param  NumByteToRead: 读取字节数（≤Flash容量）
+ * @param  cplt: 完成回调(中断中调用)，可为NULL，之后用QSPI_W25Qxx_DMA_Busy查询
+ * @retval QSPI_W25Qxx_OK - 启动成功
+ * @retval W25Qxx_ERROR_TRANSMIT - 启动失败或上一次DMA读取未完成
+ * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能退出映射模式
+ */
+int8_t QSPI_W25Qxx_ReadBuffer_DMA(uint8_t *pBuffer, uint32_t ReadAddr,
+                                  uint32_t NumByteToRead,
+                                  QSPI_W25Qxx_Callback_t cplt) {
+  uint32_t head, tail; // 首尾不满Cache行的字节数
+
+#ifdef QSPI_XIP_ENABLE
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    return W25Qxx_ERROR_MemoryMapped; // 传输期间代码无法取指
+  }
+#endif
+  if (s_dma_busy || s_wr_state != W25Qxx_WR_IDLE || pBuffer == NULL ||
+      NumByteToRead == 0 || !QSPI_W25Qxx_DualAligned(ReadAddr, NumByteToRead)) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  if (QSPI_W25Qxx_Release() != QSPI_W25Qxx_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+
+  // 首尾不满一个Cache行的部分与相邻变量共用Cache行，传输结束后的失效会丢掉
+  // CPU在传输期间对相邻变量的改写，这两段在启动前由CPU读取，DMA只写整行
+  head = (0U - (uint32_t)pBuffer) & (DMA_CACHE_LINE - 1U);
+  if (head > NumByteToRead) {
+    head = NumByteToRead;
+  }
+  tail = (NumByteToRead - head) & (DMA_CACHE_LINE - 1U);
+  if (NumByteToRead > head + tail && ((head | tail) & (W25Qxx_CHIPS - 1U)) == 0) {
+    if ((head != 0 && QSPI_W25Qxx_ReadBuffer(pBuffer, ReadAddr, head) != QSPI_W25Qxx_OK) ||
+        (tail != 0 && QSPI_W25Qxx_ReadBuffer(pBuffer + NumByteToRead - tail,
+                                             ReadAddr + NumByteToRead - tail, tail) != QSPI_W25Qxx_OK)) {
+      return W25Qxx_ERROR_TRANSMIT;
+    }
+    pBuffer += head;
+    ReadAddr += head;
+    NumByteToRead -= head + tail;
+  }
+
+  s_dma_buffer = pBuffer;
+  s_dma_size = NumByteToRead;
+  s_dma_done = 0;
+  s_dma_addr = ReadAddr;
+  s_dma_cb = cplt;
+  s_dma_busy = 1;
+
+  // 先写回缓冲区中的脏数据，避免传输期间被逐出覆盖DMA结果
+  SCB_CleanInvalidateDCache_by_Addr((uint32_t *)pBuffer, (int32_t)NumByteToRead);
+
+  if (QSPI_W25Qxx_ReadChunk_DMA() != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash DMA读取启动失败");
+    s_dma_busy = 0;
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  查询DMA读取是否进行中
+ * @retval 1-进行中, 0-空闲
+ */
+uint8_t QSPI_W25Qxx_DMA_Busy(void) { return s_dma_busy; }
+
+/**
+ * @brief  QSPI接收完成处理，在HAL_QSPI_RxCpltCallback中调用
+ * @param  hqspi_cb: 触发回调的QSPI句柄
+ */
+void QSPI_W25Qxx_RxCpltHandler(QSPI_HandleTypeDef *hqspi_cb) {
+  if (hqspi_cb != &hqspi || !s_dma_busy) {
+    return;
+  }
+
+  s_dma_done += s_dma_chunk;
+  if (s_dma_done < s_dma_size) {
+    if (QSPI_W25Qxx_ReadChunk_DMA() != QSPI_W25Qxx_OK) {
+      QSPI_W25Qxx_FinishRead_DMA(W25Qxx_ERROR_TRANSMIT);
+    }
+    return;
+  }
+  QSPI_W25Qxx_FinishRead_DMA(QSPI_W25Qxx_OK);
+}
+
+/**
+ * @brief  QSPI错误处理，在HAL_QSPI_ErrorCallback中调用
+ * @param  hqspi_cb: 触发回调的QSPI句柄
+ */
+void QSPI_W25Qxx_ErrorHandler(QSPI_HandleTypeDef *hqspi_cb) {
+  if (hqspi_cb != &hqspi) {
+    return;
+  }
+  if (s_dma_busy) {
+    DEBUG_ERROR("QSPI Flash DMA读取失败");
+    QSPI_W25Qxx_FinishRead_DMA(W25Qxx_ERROR_TRANSMIT);
+  } else if (s_wr_state != W25Qxx_WR_IDLE) {
+    DEBUG_ERROR("QSPI Flash异步写入失败");
+    QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_TRANSMIT);
+  }
+}
+
+/**
+ * @brief  启动当前页的写使能(中断方式)
+ * @retval QSPI_W25Qxx_OK - 启动成功
+ * @retval W25Qxx_ERROR_WriteEnable - 启动失败
+ */
+static int8_t QSPI_W25Qxx_WriteEnable_IT(void) {
+  QSPI_CommandTypeDef s_command; // QSPI传输配置
+
+  s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
+  s_command.AddressMode = QSPI_ADDRESS_NONE;               // 无地址模式
+  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
+  s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
+  s_command.DdrHoldHalfCycle =
+      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
+  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+  s_command.DataMode = QSPI_DATA_NONE;           // 无数据模式
+  s_command.DummyCycles = 0;                     // 空周期个数
+  s_command.Instruction = W25Qxx_CMD_WriteEnable; // 发送写使能命令
+
+  s_wr_state = W25Qxx_WR_ENABLE;
+  if (HAL_QSPI_Command_IT(&hqspi, &s_command) != HAL_OK) {
+    return W25Qxx_ERROR_WriteEnable;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  未处于内存映射模式时重新映射(不复位器件，擦除暂停期间也可调用)
+ * @retval QSPI_W25Qxx_OK - 已映射
+ * @retval W25Qxx_ERROR_MemoryMapped - 映射失败
+ */
+static int8_t QSPI_W25Qxx_Remap(void) {
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    return QSPI_W25Qxx_OK;
+  }
+  return QSPI_W25Qxx_MapConfig();
+}
+
+/**
+ * @brief  结束异步写入并通知调用者
+ * @param  status: 写入结果
+ * @note   启动时处于内存映射模式的，先恢复映射再调用完成回调
+ */
+static void QSPI_W25Qxx_FinishWrite_Async(int8_t status) {
+  QSPI_W25Qxx_Callback_t cb = s_wr_cplt;
+
+  s_wr_state = W25Qxx_WR_IDLE;
+  // 出错时器件可能仍在擦写，映射区读到的数据无效，但总线不会挂死，字库可继续访问
+  if (s_wr_remap) {
+    s_wr_remap = 0;
+    if (QSPI_W25Qxx_Remap() != QSPI_W25Qxx_OK && status == QSPI_W25Qxx_OK) {
+      status = W25Qxx_ERROR_MemoryMapped;
+    }
+  }
+  if (cb != NULL) {
+    cb(status);
+  }
+}
+
+/**
+ * @brief  异步擦写启动失败时恢复启动前的内存映射模式
+ * @param  status: 返回给调用者的错误码
+ * @retval status
+ */
+static int8_t QSPI_W25Qxx_StartFailed(int8_t status) {
+  if (s_wr_remap) {
+    s_wr_remap = 0;
+    (void)QSPI_W25Qxx_Remap();
+  }
+  return status;
+}
+
+/**
+ * @brief  缓冲区异步写入（任意长度，非阻塞）
+ * @param  pData: 数据缓冲区指针，写入完成前须保持有效且不可修改
+ * @param  WriteAddr: 写入地址
+ * @param  Size: 写入字节数（≤Flash容量）
+ * @param  progress: 每写完一页调用一次(中断中调用)，可为NULL
+ * @param  cplt: 完成回调(中断中调用)，可为NULL
+ * @retval QSPI_W25Qxx_OK - 启动成功
+ * @retval W25Qxx_ERROR_WriteEnable - 启动失败或上一次传输未完成
+ * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能退出映射模式
+ * @note   每页流程：写使能(中断) -> 页编程(DMA) -> 等待BUSY清零(中断轮询)
+ * @note   写入前必须先擦除；启动时处于内存映射模式的，结束(完成或出错)时在中断中恢复映射，
+ *         再调用完成回调，映射失败时以 W25Qxx_ERROR_MemoryMapped 结束
+ */
+int8_t QSPI_W25Qxx_WriteBuffer_Async(uint8_t *pData, uint32_t WriteAddr,
+                                     uint32_t Size,
+                                     QSPI_W25Qxx_Progress_t progress,
+                                     QSPI_W25Qxx_Callback_t cplt) {
+#ifdef QSPI_XIP_ENABLE
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    return W25Qxx_ERROR_MemoryMapped; // 擦写期间代码无法取指，改用 QSPI_W25Qxx_MappedUpdate_Step()
+  }
+#endif
+  if (s_wr_state != W25Qxx_WR_IDLE || s_dma_busy || pData == NULL ||
+      Size == 0 || !QSPI_W25Qxx_DualAligned(WriteAddr, Size)) {
+    return W25Qxx_ERROR_WriteEnable;
+  }
+
+  // 内存映射模式下不能发送间接命令，先退出，结束时(完成或出错)恢复
+  s_wr_remap = (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED);
+  if (s_wr_remap) {
+    PERF_TRACE_MARK(PERF_TRACE_QSPI_UNMAP, 0);
+    HAL_QSPI_Abort(&hqspi);
+  }
+  if (QSPI_W25Qxx_Release() != QSPI_W25Qxx_OK) {
+    return QSPI_W25Qxx_StartFailed(W25Qxx_ERROR_WriteEnable);
+  }
+
+  s_wr_data = pData;
+  s_wr_addr = WriteAddr;
+  s_wr_size = Size;
+  s_wr_done = 0;
+  // 第一页只写到页边界
+  s_wr_chunk = W25Qxx_PageSize - (WriteAddr % W25Qxx_PageSize);
+  if (s_wr_chunk > Size) {
+    s_wr_chunk = Size;
+  }
+  s_wr_progress = progress;
+  s_wr_cplt = cplt;
+  s_wr_erase = 0;
+
+  // MDMA直接读取内存，先写回CPU中的脏数据
+  SCB_CleanDCache_by_Addr((uint32_t *)pData, (int32_t)Size);
+
+  if (QSPI_W25Qxx_WriteEnable_IT() != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash异步写入启动失败");
+    s_wr_state = W25Qxx_WR_IDLE;
+    return QSPI_W25Qxx_StartFailed(W25Qxx_ERROR_WriteEnable);
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  写使能完成后以中断方式发送擦除命令
+ */
+static void QSPI_W25Qxx_EraseCommand_IT(void) {
+  QSPI_CommandTypeDef s_command; // QSPI传输配置
+
+  s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
+  s_command.AddressSize = QSPI_W25Qxx_AddressSize();       // 按器件3/4字节地址
+  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; //	无交替字节
+  s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
+  s_command.DdrHoldHalfCycle =
+      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
+  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+  s_command.AddressMode = QSPI_ADDRESS_1_LINE;    // 1线地址模式
+  s_command.DataMode = QSPI_DATA_NONE;            // 无数据
+  s_command.DummyCycles = 0;                      // 空周期个数
+  s_command.Address = s_wr_addr;                  // 要擦除的地址
+  if (s_wr_erase == W25Qxx_FlashSize) {
+    s_command.AddressMode = QSPI_ADDRESS_NONE; // 整片擦除无地址
+    s_command.Instruction = W25Qxx_CMD_ChipErase;
+  } else if (s_wr_erase == W25Qxx_BlockSize) {
+    s_command.Instruction = s_part->erase_64k;
+  } else {
+    s_command.Instruction = s_part->erase_4k;
+  }
+
+  s_wr_state = W25Qxx_WR_ERASE; // 命令发送完成后在 CmdCpltHandler 中开始轮询
+  if (HAL_QSPI_Command_IT(&hqspi, &s_command) != HAL_OK) {
+    QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_Erase);
+  }
+}
+
+/**
+ * @brief  以中断方式轮询擦除结束(BUSY清零后进入 StatusMatchHandler)
+ */
+static void QSPI_W25Qxx_ErasePoll_IT(void) {
+  QSPI_CommandTypeDef s_command;    // QSPI传输配置
+  QSPI_AutoPollingTypeDef s_config; // 轮询比较相关配置参数
+
+  QSPI_W25Qxx_BusyPollConfig(&s_command, &s_config,
+                             W25Qxx_ERASE_POLL_INTERVAL);
+  s_wr_state = W25Qxx_WR_POLL;
+  if (HAL_QSPI_AutoPolling_IT(&hqspi, &s_command, &s_config) != HAL_OK) {
+    QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_AUTOPOLLING);
+  }
+}
+
+/**
+ * @brief  异步擦除一个扇区、块或整片（非阻塞）
+ * @param  SectorAddress: 擦除地址，按Size对齐(整片擦除为0)
+ * @param  Size: W25Qxx_SectorSize(4KB)、W25Qxx_BlockSize(64KB) 或 W25Qxx_FlashSize(整片)
+ * @param  cplt: 完成回调(中断中调用)，可为NULL
+ * @retval QSPI_W25Qxx_OK - 启动成功
+ * @retval W25Qxx_ERROR_Erase - 参数错误
+ * @retval W25Qxx_ERROR_WriteEnable - 启动失败或上一次传输未完成
+ * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能退出映射模式
+ * @note   流程：写使能(中断) -> 擦除命令 -> 等待BUSY清零(中断轮询)，
+ *         与异步写入共用同一套状态，两者不能同时进行
+ */
+int8_t QSPI_W25Qxx_Erase_Async(uint32_t SectorAddress, uint32_t Size,
+                               QSPI_W25Qxx_Callback_t cplt) {
+  if ((Size != W25Qxx_SectorSize && Size != W25Qxx_BlockSize &&
+       Size != W25Qxx_FlashSize) ||
+      (SectorAddress & (Size - 1U)) != 0) {
+    return W25Qxx_ERROR_Erase;
+  }
+#ifdef QSPI_XIP_ENABLE
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    return W25Qxx_ERROR_MemoryMapped;
+  }
+#endif
+  if (s_wr_state != W25Qxx_WR_IDLE || s_dma_busy) {
+    return W25Qxx_ERROR_WriteEnable;
+  }
+
+  s_wr_remap = (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED);
+  if (s_wr_remap) {
+    PERF_TRACE_MARK(PERF_TRACE_QSPI_UNMAP, 0);
+    HAL_QSPI_Abort(&hqspi);
+  }
+  if (QSPI_W25Qxx_Release() != QSPI_W25Qxx_OK) {
+    return QSPI_W25Qxx_StartFailed(W25Qxx_ERROR_WriteEnable);
+  }
+
+  s_wr_addr = SectorAddress;
+  s_wr_size = Size;
+  s_wr_done = 0;
+  s_wr_progress = NULL;
+  s_wr_cplt = cplt;
+  s_wr_erase = Size;
+
+  if (QSPI_W25Qxx_WriteEnable_IT() != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash异步擦除启动失败");
+    s_wr_state = W25Qxx_WR_IDLE;
+    return QSPI_W25Qxx_StartFailed(W25Qxx_ERROR_WriteEnable);
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  查询异步写入是否进行中
+ * @retval 1-进行中, 0-空闲
+ */
+uint8_t QSPI_W25Qxx_Write_Busy(void) { return s_wr_state != W25Qxx_WR_IDLE; }
+
+/**
+ * @brief  读取状态寄存器
+ * @param  Instruction: 读状态寄存器指令(如 W25Qxx_CMD_ReadStatus_REG2)
+ * @param  value: 输出寄存器值
+ */
+static int8_t QSPI_W25Qxx_ReadStatus(uint8_t Instruction, uint8_t *value) {
+  QSPI_CommandTypeDef s_command; // QSPI传输配置
+  uint8_t sr[W25Qxx_STATUS_BYTES]; // 双片时每片一个字节
+
+  s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;     // 1线指令模式
+  s_command.AddressMode = QSPI_ADDRESS_NONE;               // 无地址模式
+  s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE; // 无交替字节
+  s_command.DdrMode = QSPI_DDR_MODE_DISABLE;               // 禁止DDR模式
+  s_command.DdrHoldHalfCycle =
+      QSPI_DDR_HHC_ANALOG_DELAY; // DDR模式中数据延迟，这里用不到
+  s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD; // 每次传输数据都发送指令
+  s_command.DataMode = QSPI_DATA_1_LINE;         // 1线数据模式
+  s_command.DummyCycles = 0;                     // 空周期个数
+  s_command.NbData = W25Qxx_STATUS_BYTES;        // 每片1字节状态
+  s_command.Instruction = Instruction;
+
+  if (HAL_QSPI_Command(&hqspi, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+          HAL_OK ||
+      HAL_QSPI_Receive(&hqspi, sr, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) !=
+          HAL_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  *value = 0;
+  for (uint32_t i = 0; i < W25Qxx_STATUS_BYTES; i++) {
+    *value |= sr[i]; // 任一片置位即视为置位
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  让异步多页编程在当前页结束后停下并进入内存映射模式
+ * @retval QSPI_W25Qxx_OK - 已停下(或全部写完)，映射区可读
+ * @retval W25Qxx_ERROR_TRANSMIT - 超过一页的编程时间仍未停下
+ * @retval W25Qxx_ERROR_MemoryMapped - 映射失败
+ * @note   最多等待一页的编程时间tPP，不发送0x75，页内数据总是完整写入
+ */
+static int8_t QSPI_W25Qxx_ProgramPause(void) {
+  uint32_t tickstart = HAL_GetTick();
+
+  s_wr_pause = 1; // StatusMatchHandler 在开始下一页之前检查
+  while (s_wr_state != W25Qxx_WR_SUSPEND && s_wr_state != W25Qxx_WR_IDLE &&
+         HAL_GetTick() - tickstart <= W25Qxx_PageProgram_TIME_MAX + 1U) {
+  }
+  s_wr_pause = 0;
+  if (s_wr_state != W25Qxx_WR_SUSPEND && s_wr_state != W25Qxx_WR_IDLE) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  return QSPI_W25Qxx_Remap(); // 全部写完时完成处理可能已恢复映射
+}
+
+/**
+ * @brief  暂停正在进行的异步擦除(0x75)或多页编程，并进入内存映射模式
+ * @retval QSPI_W25Qxx_OK - 已暂停(或擦写恰好结束)，映射区可读
+ * @retval W25Qxx_ERROR_Erase - 没有可暂停的擦写(未在擦写或整片擦除)
+ * @retval W25Qxx_ERROR_TRANSMIT - 命令发送失败
+ * @retval W25Qxx_ERROR_MemoryMapped - 暂停后映射失败
+ * @note   在主循环中调用。器件在tSUS(最长20us)内停止擦除，距上次恢复不足tSUS时先补足间隔；
+ *         编程时在当前页结束后停下(最长tPP 3ms)
+ * @note   暂停期间只能读取映射区中正在擦写的扇区/块以外的地址，
+ *         也不能调用复位器件的函数(QSPI_W25Qxx_Reset/MemoryMappedMode)，否则擦除作废
+ */
+int8_t QSPI_W25Qxx_EraseSuspend(void) {
+  uint8_t sr2 = 0;
+  uint32_t gap = W25Qxx_Suspend_TIME_US * (SystemCoreClock / 1000000U);
+  uint32_t tickstart = HAL_GetTick();
+
+  if (s_wr_state == W25Qxx_WR_IDLE || s_wr_state == W25Qxx_WR_SUSPEND ||
+      s_wr_erase == W25Qxx_FlashSize) {
+    return W25Qxx_ERROR_Erase; // 整片擦除不支持暂停
+  }
+  if (s_wr_erase == 0) {
+    return QSPI_W25Qxx_ProgramPause();
+  }
+  while ((s_wr_state == W25Qxx_WR_ENABLE || s_wr_state == W25Qxx_WR_ERASE) &&
+         HAL_GetTick() - tickstart <= HAL_QPSI_TIMEOUT_DEFAULT_VALUE) {
+    // 写使能只需几微秒，等擦除命令发出后再暂停
+  }
+
+  // 关闭QUADSPI中断后检查状态，避免与擦除完成中断交错
+  HAL_NVIC_DisableIRQ(QUADSPI_IRQn);
+  if (s_wr_state != W25Qxx_WR_POLL || s_wr_erase == 0 ||
+      s_wr_erase == W25Qxx_FlashSize) {
+    HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
+    return W25Qxx_ERROR_Erase; // 整片擦除不支持暂停
+  }
+  HAL_QSPI_Abort(&hqspi); // 停止中断轮询
+  HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
+
+  while (s_resumed && (DWT->CYCCNT - s_resume_cycle) < gap) {
+    // 恢复后至少间隔tSUS才能再次暂停
+  }
+  if (QSPI_W25Qxx_SendCommand(W25Qxx_CMD_EraseSuspend, QSPI_INSTRUCTION_1_LINE,
+                              NULL, 0) != QSPI_W25Qxx_OK ||
+      QSPI_W25Qxx_AutoPollingMemReady() != QSPI_W25Qxx_OK ||
+      QSPI_W25Qxx_ReadStatus(W25Qxx_CMD_ReadStatus_REG2, &sr2) !=
+          QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash擦除暂停失败");
+    QSPI_W25Qxx_ErasePoll_IT(); // 继续等待擦除结束
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+
+  if (sr2 & W25Qxx_Status_REG2_SUS) {
+    s_wr_state = W25Qxx_WR_SUSPEND;
+  } else {
+    QSPI_W25Qxx_FinishWrite_Async(QSPI_W25Qxx_OK); // 暂停前擦除已结束，可能已恢复映射
+  }
+  return QSPI_W25Qxx_Remap();
+}
+
+/**
+ * @brief  退出内存映射模式并恢复暂停的擦除(0x7A)或多页编程
+ * @retval QSPI_W25Qxx_OK - 已恢复，擦写结束时照常调用完成回调
+ * @retval W25Qxx_ERROR_Erase - 擦写未暂停
+ * @retval W25Qxx_ERROR_TRANSMIT - 命令发送失败，擦写以该错误结束(调用完成回调)，
+ *         器件可能仍处于暂停状态，需 QSPI_W25Qxx_MemoryMappedMode() 复位
+ */
+int8_t QSPI_W25Qxx_EraseResume(void) {
+  if (s_wr_state != W25Qxx_WR_SUSPEND) {
+    return W25Qxx_ERROR_Erase;
+  }
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    PERF_TRACE_MARK(PERF_TRACE_QSPI_UNMAP, 0);
+    HAL_QSPI_Abort(&hqspi);
+  }
+  // 只退出连续读/QPI模式，不复位器件(复位会使擦除作废)
+  if (QSPI_W25Qxx_ModeBitReset() != QSPI_W25Qxx_OK ||
+      QSPI_W25Qxx_SendCommand(W25Qxx_CMD_ExitQPI, QSPI_INSTRUCTION_4_LINES,
+                              NULL, 0) != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash擦除恢复失败");
+    QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_TRANSMIT);
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  if (s_wr_erase == 0) { // 编程停在两页之间，继续下一页
+    if (QSPI_W25Qxx_WriteEnable_IT() != QSPI_W25Qxx_OK) {
+      QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_WriteEnable);
+      return W25Qxx_ERROR_TRANSMIT;
+    }
+    return QSPI_W25Qxx_OK;
+  }
+  if (QSPI_W25Qxx_SendCommand(W25Qxx_CMD_EraseResume, QSPI_INSTRUCTION_1_LINE,
+                              NULL, 0) != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash擦除恢复失败");
+    QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_TRANSMIT);
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // 下次暂停按DWT计数补足间隔
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  s_resume_cycle = DWT->CYCCNT;
+  s_resumed = 1;
+  QSPI_W25Qxx_ErasePoll_IT();
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  查询擦除是否处于暂停状态
+ * @retval 1-已暂停, 0-未暂停
+ */
+uint8_t QSPI_W25Qxx_EraseSuspended(void) {
+  return s_wr_state == W25Qxx_WR_SUSPEND;
+}
+
+/*******************************************************************************
+ *                              深度掉电
+ *******************************************************************************/
+
+/**
+ * @brief  进入深度掉电(0xB9)
+ * @retval QSPI_W25Qxx_OK - 已掉电
+ * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能退出映射模式
+ * @retval W25Qxx_ERROR_TRANSMIT - DMA读取或异步写入进行中，或命令发送失败
+ * @note   先复位器件退出映射/QPI/连续读模式，保证0xB9按SPI模式被识别
+ * @note   掉电后映射区不可读，CPU访问0x90000000会挂死总线，
+ *         调用者须保证唤醒前不再读取映射区
+ */
+int8_t QSPI_W25Qxx_PowerDown(void) {
+#ifdef QSPI_XIP_ENABLE
+  return W25Qxx_ERROR_MemoryMapped; // 代码在Flash中执行，不能掉电
+#else
+  if (s_power_down) {
+    return QSPI_W25Qxx_OK;
+  }
+  if (s_dma_busy || s_wr_state != W25Qxx_WR_IDLE) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  if (QSPI_W25Qxx_Reset() != QSPI_W25Qxx_OK ||
+      QSPI_W25Qxx_SendCommand(W25Qxx_CMD_PowerDown, QSPI_INSTRUCTION_1_LINE,
+                              NULL, 0) != QSPI_W25Qxx_OK) {
+    DEBUG_ERROR("QSPI Flash进入掉电失败");
+    QSPI_W25Qxx_MapConfig(); // 尽量恢复映射，保证字库仍可读取
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  QSPI_W25Qxx_DelayUs(W25Qxx_PowerDown_TIME_US); // tDP内不能发送0xAB
+  s_power_down = 1;
+  return QSPI_W25Qxx_OK;
+#endif
+}
+
+/**
+ * @brief  退出深度掉电并重新进入内存映射模式
+ * @retval QSPI_W25Qxx_OK - 已唤醒并映射
+ * @retval W25Qxx_ERROR_TRANSMIT - 唤醒失败
+ * @retval W25Qxx_ERROR_MemoryMapped - 映射失败
+ * @note   掉电期间Flash内容不变，Cache和MPU配置无需处理
+ */
+int8_t QSPI_W25Qxx_WakeUp(void) {
+  if (QSPI_W25Qxx_Release() != QSPI_W25Qxx_OK) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    return QSPI_W25Qxx_OK;
+  }
+  return QSPI_W25Qxx_MapConfig();
+}
+
+/**
+ * @brief  查询Flash是否处于深度掉电
+ * @retval 1-掉电中, 0-正常
+ */
+uint8_t QSPI_W25Qxx_IsPoweredDown(void) { return s_power_down; }
+
+/*******************************************************************************
+ *                              改写记录
+ *******************************************************************************/
+
+/**
+ * @brief  读取改写序号
+ * @retval 每次擦除或编程加1，初值0
+ */
+uint32_t QSPI_W25Qxx_UpdateEpoch(void) { return s_update_epoch; }
+
+/**
+ * @brief  取出某个改写序号之后的改写范围
+ * @param  since: 输入调用者上次同步的序号，输出当前序号
+ * @param  out: 输出范围数组，至少W25Qxx_UPDATE_LOG_LEN项
+ * @retval 范围数(0表示之后没有改写)
+ * @retval W25Qxx_UPDATE_OVERFLOW - 之后的改写已超出记录条数，调用者须整体作废
+ * @note   关中断读取，异步写入的中断中也会追加记录
+ */
+uint8_t QSPI_W25Qxx_UpdateRanges(uint32_t *since, QSPI_W25Qxx_Range_t *out) {
+  uint32_t primask = __get_PRIMASK();
+  uint8_t n = 0;
+
+  __disable_irq();
+  if (*since != s_update_epoch) {
+    if ((int32_t)(*since - s_update_floor) < 0) {
+      n = W25Qxx_UPDATE_OVERFLOW;
+    } else {
+      for (uint8_t i = 0; i < s_update_used; i++) {
+        const QSPI_W25Qxx_Range_t *r =
+            &s_update_log[(s_update_last + W25Qxx_UPDATE_LOG_LEN - i) %
+                          W25Qxx_UPDATE_LOG_LEN];
+        if ((int32_t)(r->epoch - *since) <= 0) {
+          break; // 更早的记录调用者已经处理过
+        }
+        out[n++] = *r;
+      }
+    }
+    *since = s_update_epoch;
+  }
+  __set_PRIMASK(primask);
+  return n;
+}
+
+/**
+ * @brief  QSPI命令完成处理，在HAL_QSPI_CmdCpltCallback中调用
+ * @param  hqspi_cb: 触发回调的QSPI句柄
+ * @note   写使能完成后发送页编程命令并以DMA发送本页数据；擦除命令完成后开始轮询BUSY位
+ * @note   中断中只用 HAL_QSPI_Command_IT，不阻塞等待命令完成
+ */
+void QSPI_W25Qxx_CmdCpltHandler(QSPI_HandleTypeDef *hqspi_cb) {
+  QSPI_CommandTypeDef s_command; // QSPI传输配置
+
+  if (hqspi_cb != &hqspi) {
+    return;
+  }
+  if (s_wr_state == W25Qxx_WR_ERASE) {
+    QSPI_W25Qxx_Touch(s_wr_addr, s_wr_erase);
+    QSPI_W25Qxx_ErasePoll_IT();
+    return;
+  }
+  if (s_wr_state != W25Qxx_WR_ENABLE) {
+    return;
+  }
+
+  if (s_wr_erase != 0) {
+    QSPI_W25Qxx_EraseCommand_IT();
+    return;
+  }
+
+  QSPI_W25Qxx_PageProgramCommand(&s_command, s_wr_addr + s_wr_done,
+                                 (uint16_t)s_wr_chunk);
+  s_wr_state = W25Qxx_WR_PROGRAM;
+  // 带数据阶段的命令只写入配置即返回，数据由DMA发送
+  if (HAL_QSPI_Command_IT(&hqspi, &s_command) != HAL_OK) {
+    QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_TRANSMIT);
+    return;
+  }
+  QSPI_W25Qxx_Touch(s_wr_addr + s_wr_done, s_wr_chunk);
+  if (HAL_QSPI_Transmit_DMA(&hqspi, s_wr_data + s_wr_done) != HAL_OK) {
+    QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_TRANSMIT);
+  }
+}
+
+/**
+ * @brief  QSPI发送完成处理，在HAL_QSPI_TxCpltCallback中调用
+ * @param  hqspi_cb: 触发回调的QSPI句柄
+ * @note   本页数据发送完毕后以中断方式轮询BUSY位
+ */
+void QSPI_W25Qxx_TxCpltHandler(QSPI_HandleTypeDef *hqspi_cb) {
+  QSPI_CommandTypeDef s_command;    // QSPI传输配置
+  QSPI_AutoPollingTypeDef s_config; // 轮询比较相关配置参数
+
+  if (hqspi_cb != &hqspi || s_wr_state != W25Qxx_WR_PROGRAM) {
+    return;
+  }
+
+  QSPI_W25Qxx_BusyPollConfig(&s_command, &s_config, W25Qxx_POLL_INTERVAL);
+  s_wr_state = W25Qxx_WR_POLL;
+  if (HAL_QSPI_AutoPolling_IT(&hqspi, &s_command, &s_config) != HAL_OK) {
+    QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_AUTOPOLLING);
+  }
+}
+
+/**
+ * @brief  QSPI状态匹配处理，在HAL_QSPI_StatusMatchCallback中调用
+ * @param  hqspi_cb: 触发回调的QSPI句柄
+ * @note   本页编程结束，报告进度后开始下一页
+ */
+void QSPI_W25Qxx_StatusMatchHandler(QSPI_HandleTypeDef *hqspi_cb) {
+  if (hqspi_cb != &hqspi || s_wr_state != W25Qxx_WR_POLL) {
+    return;
+  }
+
+  if (s_wr_erase != 0) {
+    QSPI_W25Qxx_FinishWrite_Async(QSPI_W25Qxx_OK);
+    return;
+  }
+
+  s_wr_done += s_wr_chunk;
+  if (s_wr_progress != NULL) {
+    s_wr_progress(s_wr_done, s_wr_size);
+  }
+  if (s_wr_done >= s_wr_size) {
+    QSPI_W25Qxx_FinishWrite_Async(QSPI_W25Qxx_OK);
+    return;
+  }
+
+  s_wr_chunk = s_wr_size - s_wr_done;
+  if (s_wr_chunk > W25Qxx_PageSize) {
+    s_wr_chunk = W25Qxx_PageSize;
+  }
+  if (s_wr_pause) {
+    s_wr_state = W25Qxx_WR_SUSPEND; // 在两页之间停下，由 EraseResume 继续
+    return;
+  }
+  if (QSPI_W25Qxx_WriteEnable_IT() != QSPI_W25Qxx_OK) {
+    QSPI_W25Qxx_FinishWrite_Async(W25Qxx_ERROR_WriteEnable);
+  }
+}
+
+/*******************************************************************************
+ *                              差分更新
+ *******************************************************************************/
+
+#define W25Qxx_SECTOR_SAME 0    // 内容相同，跳过
+#define W25Qxx_SECTOR_PROGRAM 1 // 只需把1写成0，不用擦除
+#define W25Qxx_SECTOR_ERASE 2   // 需要擦除后重写
+
+static uint8_t s_sector_buf[W25Qxx_SectorSize]; // 扇区比较/合并缓冲区
+
+/**
+ * @brief  比较扇区旧内容(s_sector_buf)与新数据
+ * @param  pData: 新数据
+ * @param  Size: 比较字节数（≤扇区大小）
+ * @retval W25Qxx_SECTOR_SAME / W25Qxx_SECTOR_PROGRAM / W25Qxx_SECTOR_ERASE
+ * @note   编程只能把位从1变为0，新数据含旧数据中没有的1时必须擦除
+ */
+static uint8_t QSPI_W25Qxx_SectorClass(const uint8_t *pData, uint32_t Size) {
+  uint8_t result = W25Qxx_SECTOR_SAME;
+
+  for (uint32_t i = 0; i < Size; i++) {
+    if (s_sector_buf[i] != pData[i]) {
+      if ((s_sector_buf[i] & pData[i]) != pData[i]) {
+        return W25Qxx_SECTOR_ERASE;
+      }
+      result = W25Qxx_SECTOR_PROGRAM;
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief  判断一页数据是否全为擦除值0xFF
+ */
+static uint8_t QSPI_W25Qxx_PageBlank(const uint8_t *pData, uint32_t Size) {
+  for (uint32_t i = 0; i < Size; i++) {
+    if (pData[i] != 0xFF) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief  按页写入已擦除区域，跳过全0xFF的页
+ * @param  pData: 数据(页对齐)
+ * @param  WriteAddr: 写入地址(页对齐)
+ * @param  Size: 写入字节数
+ * @param  stats: 统计信息
+ * @retval QSPI_W25Qxx_OK - 写入成功
+ * @retval W25Qxx_ERROR_* - 写入失败
+ */
+static int8_t QSPI_W25Qxx_ProgramErased(const uint8_t *pData,
+                                        uint32_t WriteAddr, uint32_t Size,
+                                        QSPI_W25Qxx_UpdateStats_t *stats) {
+  for (uint32_t ofs = 0; ofs < Size; ofs += W25Qxx_PageSize) {
+    uint32_t len =
+        (Size - ofs > W25Qxx_PageSize) ? W25Qxx_PageSize : (Size - ofs);
+    int8_t status;
+
+    if (QSPI_W25Qxx_PageBlank(pData + ofs, len)) {
+      continue;
+    }
+    status = QSPI_W25Qxx_WritePage((uint8_t *)pData + ofs, WriteAddr + ofs,
+                                   (uint16_t)len);
+    if (status != QSPI_W25Qxx_OK) {
+      return status;
+    }
+    stats->pages_programmed++;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  更新一个扇区
+ * @param  pData: 新数据
+ * @param  SectorAddr: 扇区地址(4KB对齐)
+ * @param  Size: 新数据字节数（≤扇区大小，不足部分保留原内容）
+ * @param  stats: 统计信息
+ * @retval QSPI_W25Qxx_OK - 更新成功
+ * @retval W25Qxx_ERROR_* - 更新失败
+ */
+static int8_t QSPI_W25Qxx_UpdateSector(const uint8_t *pData,
+                                       uint32_t SectorAddr, uint32_t Size,
+                                       QSPI_W25Qxx_UpdateStats_t *stats) {
+  int8_t status;
+
+  status = QSPI_W25Qxx_ReadBuffer(s_sector_buf, SectorAddr, W25Qxx_SectorSize);
+  if (status != QSPI_W25Qxx_OK) {
+    return status;
+  }
+
+  switch (QSPI_W25Qxx_SectorClass(pData, Size)) {
+  case W25Qxx_SECTOR_SAME:
+    stats->sectors_skipped++;
+    return QSPI_W25Qxx_OK;
+
+  case W25Qxx_SECTOR_PROGRAM:
+    // 只重写内容不同的页，旧数据本身就是编程结果的子集
+    for (uint32_t ofs = 0; ofs < Size; ofs += W25Qxx_PageSize) {
+      uint32_t len =
+          (Size - ofs > W25Qxx_PageSize) ? W25Qxx_PageSize : (Size - ofs);
+      if (memcmp(s_sector_buf + ofs, pData + ofs, len) == 0) {
+        continue;
+      }
+      status = QSPI_W25Qxx_WritePage((uint8_t *)pData + ofs, SectorAddr + ofs,
+                                     (uint16_t)len);
+      if (status != QSPI_W25Qxx_OK) {
+        return status;
+      }
+      stats->pages_programmed++;
+    }
+    stats->sectors_programmed++;
+    return QSPI_W25Qxx_OK;
+
+  default:
+    // 新数据覆盖缓冲区前部，尾部保留原内容，擦除后整体写回
+    memcpy(s_sector_buf, pData, Size);
+    status = QSPI_W25Qxx_SectorErase(SectorAddr);
+    if (status != QSPI_W25Qxx_OK) {
+      return status;
+    }
+    stats->sectors_erased++;
+    return QSPI_W25Qxx_ProgramErased(s_sector_buf, SectorAddr,
+                                     W25Qxx_SectorSize, stats);
+  }
+}
+
+/**
+ * @brief  差分更新Flash区域
+ * @param  pData: 新镜像数据
+ * @param  WriteAddr: 写入地址（4KB扇区对齐）
+ * @param  Size: 写入字节数
+ * @param  stats: 输出统计信息，可为NULL
+ * @retval QSPI_W25Qxx_OK - 更新成功
+ * @retval W25Qxx_ERROR_Erase - 地址未按扇区对齐
+ * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能退出映射模式
+ * @retval W25Qxx_ERROR_TRANSMIT - DMA读取或异步擦写进行中(含暂停)
+ * @retval W25Qxx_ERROR_* - 读写或擦除失败
+ * @note   逐扇区与当前内容比较：相同的跳过，只需清零位的直接编程，
+ *         其余擦除后重写；一个64KB块内全部扇区都需擦除时改用块擦除
+ * @note   最后一个扇区超出Size的部分保持原内容
+ */
+int8_t QSPI_W25Qxx_UpdateBuffer(const uint8_t *pData, uint32_t WriteAddr,
+                                uint32_t Size,
+                                QSPI_W25Qxx_UpdateStats_t *stats) {
+  QSPI_W25Qxx_UpdateStats_t local;
+  uint32_t ofs = 0;
+  int8_t status;
+
+  if (stats == NULL) {
+    stats = &local;
+  }
+  memset(stats, 0, sizeof(*stats));
+#ifdef QSPI_XIP_ENABLE
+  return W25Qxx_ERROR_MemoryMapped; // 代码在Flash中执行，不能退出映射模式
+#endif
+  if (s_dma_busy || s_wr_state != W25Qxx_WR_IDLE) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+  if (pData == NULL || (WriteAddr % W25Qxx_SectorSize) != 0) {
+    return W25Qxx_ERROR_Erase;
+  }
+  if (HAL_QSPI_GetState(&hqspi) == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    PERF_TRACE_MARK(PERF_TRACE_QSPI_UNMAP, 0);
+    HAL_QSPI_Abort(&hqspi); // 比较需要间接模式读取
+  }
+
+  while (ofs < Size) {
+    uint32_t addr = WriteAddr + ofs;
+    uint32_t left = Size - ofs;
+
+    // 完整覆盖的64KB块：先判断是否每个扇区都需要擦除
+    if ((addr % W25Qxx_BlockSize) == 0 && left >= W25Qxx_BlockSize) {
+      uint32_t sec;
+
+      for (sec = 0; sec < W25Qxx_BlockSize; sec += W25Qxx_SectorSize) {
+        status = QSPI_W25Qxx_ReadBuffer(s_sector_buf, addr + sec,
+                                        W25Qxx_SectorSize);
+        if (status != QSPI_W25Qxx_OK) {
+          return status;
+        }
+        if (QSPI_W25Qxx_SectorClass(pData + ofs + sec, W25Qxx_SectorSize) !=
+            W25Qxx_SECTOR_ERASE) {
+          break;
+        }
+      }
+      if (sec == W25Qxx_BlockSize) {
+        status = QSPI_W25Qxx_BlockErase_64K(addr);
+        if (status != QSPI_W25Qxx_OK) {
+          return status;
+        }
+        stats->blocks_erased++;
+        status = QSPI_W25Qxx_ProgramErased(pData + ofs, addr,
+                                           W25Qxx_BlockSize, stats);
+        if (status != QSPI_W25Qxx_OK) {
+          return status;
+        }
+        ofs += W25Qxx_BlockSize;
+        continue;
+      }
+    }
+
+    if (left > W25Qxx_SectorSize) {
+      left = W25Qxx_SectorSize;
+    }
+    status = QSPI_W25Qxx_UpdateSector(pData + ofs, addr, left, stats);
+    if (status != QSPI_W25Qxx_OK) {
+      return status;
+    }
+    ofs += left;
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+/*******************************************************************************
+ *                              映射模式下在线更新
+ ******************************************************************************/
+
+/**
+ * @brief  开始一次映射模式下的在线更新
+ * @param  job: 更新任务
+ * @param  pData: 新镜像数据，更新完成前必须保持有效
+ * @param  WriteAddr: 写入地址（4KB扇区对齐）
+ * @param  Size: 写入字节数
+ * @retval QSPI_W25Qxx_OK - 成功
+ * @retval W25Qxx_ERROR_Erase - 参数错误或地址未按扇区对齐
+ * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能在线更新(退出映射后代码区无法取指)
+ */
+int8_t QSPI_W25Qxx_MappedUpdate_Start(QSPI_W25Qxx_MappedJob_t *job,
+                                      const uint8_t *pData, uint32_t WriteAddr,
+                                      uint32_t Size) {
+  if (job == NULL || pData == NULL || (WriteAddr % W25Qxx_SectorSize) != 0 ||
+      WriteAddr >= W25Qxx_FlashSize || Size > W25Qxx_FlashSize - WriteAddr) {
+    return W25Qxx_ERROR_Erase;
+  }
+#ifdef QSPI_XIP_ENABLE
+  return W25Qxx_ERROR_MemoryMapped; // 擦写同一片Flash期间代码区无法取指
+#else
+  memset(job, 0, sizeof(*job));
+  job->pData = pData;
+  job->WriteAddr = WriteAddr;
+  job->Size = Size;
+  return QSPI_W25Qxx_OK;
+#endif
+}
+
+/**
+ * @brief  执行一步在线更新：退出映射 -> 差分擦写(失效改写范围的Cache) -> 重新映射
+ * @param  job: 更新任务
+ * @retval W25Qxx_MAPPED_PENDING - 本步完成，还有剩余数据
+ * @retval QSPI_W25Qxx_OK - 全部更新完成
+ * @retval W25Qxx_ERROR_TRANSMIT - QSPI正在进行DMA读取或异步擦写(含暂停)
+ * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能在线更新
+ * @retval W25Qxx_ERROR_* - 擦写或重新映射失败
+ * @note   每步最多处理W25Qxx_MAPPED_STEP_SIZE字节，返回时总处于映射模式，
+ *         两步之间可以正常渲染，单步阻塞不超过W25Qxx_MAPPED_STEP_MAX_MS
+ * @note   擦写失败时同样会重新映射，已完成的部分保持新内容
+ */
+int8_t QSPI_W25Qxx_MappedUpdate_Step(QSPI_W25Qxx_MappedJob_t *job) {
+  QSPI_W25Qxx_UpdateStats_t st;
+  HAL_QSPI_StateTypeDef state;
+  uint32_t addr, left;
+  int8_t status, remap;
+
+  if (job == NULL || job->pData == NULL) {
+    return W25Qxx_ERROR_Erase;
+  }
+  if (job->done >= job->Size) {
+    return QSPI_W25Qxx_OK;
+  }
+#ifdef QSPI_XIP_ENABLE
+  return W25Qxx_ERROR_MemoryMapped; // 不能退出映射，也不能复位器件
+#endif
+  if (s_dma_busy || s_wr_state != W25Qxx_WR_IDLE) {
+    return W25Qxx_ERROR_TRANSMIT; // 擦除暂停期间器件不接受新的擦写
+  }
+  // 间接模式的DMA操作进行中时不能打断
+  state = HAL_QSPI_GetState(&hqspi);
+  if (state != HAL_QSPI_STATE_READY &&
+      state != HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+    return W25Qxx_ERROR_TRANSMIT;
+  }
+
+  addr = job->WriteAddr + job->done;
+  left = job->Size - job->done;
+  if (left > W25Qxx_MAPPED_STEP_SIZE) {
+    left = W25Qxx_MAPPED_STEP_SIZE;
+  }
+
+  // 内部会退出映射模式，此后到重新映射前不能访问0x90000000区域
+  status = QSPI_W25Qxx_UpdateBuffer(job->pData + job->done, addr, left, &st);
+  job->stats.sectors_skipped += st.sectors_skipped;
+  job->stats.sectors_programmed += st.sectors_programmed;
+  job->stats.sectors_erased += st.sectors_erased;
+  job->stats.blocks_erased += st.blocks_erased;
+  job->stats.pages_programmed += st.pages_programmed;
+
+  remap = QSPI_W25Qxx_MapEnter(); // 实际擦写过的范围已在擦写时失效
+  if (status != QSPI_W25Qxx_OK) {
+    return status;
+  }
+  if (remap != QSPI_W25Qxx_OK) {
+    return remap;
+  }
+
+  job->done += left;
+  return (job->done < job->Size) ? W25Qxx_MAPPED_PENDING : QSPI_W25Qxx_OK;
+}
+
+/**
+ * @brief  映射模式下阻塞式在线更新
+ * @param  pData: 新镜像数据
+ * @param  WriteAddr: 写入地址（4KB扇区对齐）
+ * @param  Size: 写入字节数
+ * @param  stats: 输出统计信息，可为NULL
+ * @retval QSPI_W25Qxx_OK - 更新成功
+ * @retval W25Qxx_ERROR_* - 更新失败
+ */
+int8_t QSPI_W25Qxx_MappedUpdate(const uint8_t *pData, uint32_t WriteAddr,
+                                uint32_t Size,
+                                QSPI_W25Qxx_UpdateStats_t *stats) {
+  QSPI_W25Qxx_MappedJob_t job;
+  int8_t status;
+
+  memset(&job, 0, sizeof(job));
+  status = QSPI_W25Qxx_MappedUpdate_Start(&job, pData, WriteAddr, Size);
+  if (status == QSPI_W25Qxx_OK) {
+    do {
+      status = QSPI_W25Qxx_MappedUpdate_Step(&job);
+    } while (status == W25Qxx_MAPPED_PENDING);
+  }
+  if (stats != NULL) {
+    *stats = job.stats;
+  }
+  return status;
 }
 
 #endif
@@ -16,7 +16,8 @@
  * 硬件配置：
  * - 使用 QUADSPI_BK1
  * - 默认QSPI驱动时钟：120MHz
- * - 支持芯片：W25Q256JV（32MB）
+ * - 支持芯片：W25Q64/128/256/512JV(FV)系列，按JEDEC ID查器件能力表，表中没有的器件读取SFDP，
+ *   自动选择3/4字节地址指令集和QUADSPI的FlashSize；默认布局按W25Q256JV（32MB）
  *
  * 性能参数（参考W25Q256JV数据手册）：
  * - 扇区擦除(4K)：典型45ms，最大400ms
@@ -24,6 +25,11 @@
  * - 整片擦除：典型80s，最大400s
  * - 页写入(256B)：典型0.4ms，最大3ms
  *
+ * 内存映射读取开销（1-4-4模式，随机读取一个32字节Cache行）：
+ * - 普通模式：指令8 + 地址8 + 模式位2 + 空周期4 + 数据64 = 86个QSPI时钟
+ * - 连续读模式(QSPI_MMAP_CONTINUOUS_READ)：省去指令8个时钟 = 78个QSPI时钟，约快9%
+ * - 可用 QSPI_W25Qxx_MeasureReadCycles(地址, 32, 1) 在目标板上实测两种模式
+ *
  * 使用说明：
  * 1. 调用 QSPI_W25Qxx_Init() 初始化
  * 2. 写入前必须先擦除（擦除单位：扇区4K/块64K/整片）
@@ -53,6 +59,7 @@ extern "C"
 #define W25Qxx_ERROR_Erase -4        /*!< 擦除错误 */
 #define W25Qxx_ERROR_TRANSMIT -5     /*!< 数据传输错误 */
 #define W25Qxx_ERROR_MemoryMapped -6 /*!< 内存映射模式错误 */
+#define W25Qxx_MAPPED_PENDING 1      /*!< 在线更新本步完成，还有剩余数据 */
 
 /*******************************************************************************
  *                              W25Qxx命令集
@@ -62,12 +69,28 @@ extern "C"
 #define W25Qxx_CMD_JedecID 0x9F     /*!< 读取JEDEC ID */
 #define W25Qxx_CMD_WriteEnable 0X06 /*!< 写使能 */
 
-#define W25Qxx_CMD_SectorErase 0x21    /*!< 扇区擦除（4KB） */
-#define W25Qxx_CMD_BlockErase_64K 0xDC /*!< 块擦除（64KB） */
+#define W25Qxx_CMD_SectorErase 0x21    /*!< 扇区擦除（4KB，4字节地址） */
+#define W25Qxx_CMD_BlockErase_64K 0xDC /*!< 块擦除（64KB，4字节地址） */
+#define W25Qxx_CMD_SectorErase_3B 0x20    /*!< 扇区擦除（4KB，3字节地址，16MB及以下的器件） */
+#define W25Qxx_CMD_BlockErase_64K_3B 0xD8 /*!< 块擦除（64KB，3字节地址） */
 #define W25Qxx_CMD_ChipErase 0xC7      /*!< 整片擦除 */
+#define W25Qxx_CMD_EraseSuspend 0x75   /*!< 暂停擦除/编程 */
+#define W25Qxx_CMD_EraseResume 0x7A    /*!< 恢复擦除/编程 */
 
-#define W25Qxx_CMD_QuadInputPageProgram 0x34 /*!< 1-1-4模式页编程 */
-#define W25Qxx_CMD_FastReadQuad_IO 0xEC      /*!< 1-4-4模式快速读取 */
+#define W25Qxx_CMD_QuadInputPageProgram 0x34 /*!< 1-1-4模式页编程(4字节地址) */
+#define W25Qxx_CMD_FastReadQuad_IO 0xEC      /*!< 1-4-4模式快速读取(4字节地址) */
+#define W25Qxx_CMD_QuadInputPageProgram_3B 0x32 /*!< 1-1-4模式页编程(3字节地址) */
+#define W25Qxx_CMD_FastReadQuad_IO_3B 0xEB      /*!< 1-4-4模式快速读取(3字节地址) */
+#define W25Qxx_CMD_ReadSFDP 0x5A                /*!< 读取SFDP参数表(3字节地址+8个空周期) */
+#define W25Qxx_CONTINUOUS_READ_MODE 0xA0     /*!< 连续读模式位M7-M0(M5-M4=10) */
+#define W25Qxx_CMD_FastReadQuad_IO_DTR 0xED  /*!< 4线双沿快速读取(需4字节地址模式) */
+#define W25Qxx_CMD_Enter4ByteMode 0xB7       /*!< 进入4字节地址模式 */
+#define W25Qxx_CMD_EnterQPI 0x38             /*!< 进入QPI(4-4-4)模式 */
+#define W25Qxx_CMD_ExitQPI 0xFF              /*!< 退出QPI模式(QPI模式下4线发送) */
+#define W25Qxx_CMD_SetReadParam 0xC0         /*!< QPI模式设置读参数 */
+#define W25Qxx_QPI_READ_PARAM 0x30           /*!< 读参数：P5-P4=11(8个等待时钟) */
+#define W25Qxx_CMD_PowerDown 0xB9            /*!< 进入深度掉电 */
+#define W25Qxx_CMD_ReleasePowerDown 0xAB     /*!< 退出深度掉电 */
 
 /*******************************************************************************
  *                              状态寄存器定义
@@ -75,15 +98,122 @@ extern "C"
 #define W25Qxx_CMD_ReadStatus_REG1 0X05 /*!< 读状态寄存器1 */
 #define W25Qxx_Status_REG1_BUSY 0x01    /*!< BUSY标志位（擦除/写入时置1） */
 #define W25Qxx_Status_REG1_WEL 0x02     /*!< 写使能标志位 */
+#define W25Qxx_CMD_ReadStatus_REG2 0x35 /*!< 读状态寄存器2 */
+#define W25Qxx_Status_REG2_SUS 0x80     /*!< 暂停标志位（擦除/编程已暂停时置1） */
+#define W25Qxx_POLL_INTERVAL 0x10       /*!< 写使能/页编程的BUSY轮询间隔(QSPI时钟数)，页编程不到1ms，间隔短以减少延迟 */
+#define W25Qxx_ERASE_POLL_INTERVAL 0x4000 /*!< 擦除的BUSY轮询间隔(QSPI时钟数，最大0xFFFF)，120MHz下约137us，擦除期间总线基本空闲 */
+
+/*******************************************************************************
+ *                              双片(Dual-Flash)配置
+ *******************************************************************************/
+/**
+ * @note  两片相同型号的Flash分别接BK1/BK2，QUADSPI每个时钟传输8位数据：偶数字节在BK1，
+ *        奇数字节在BK2，地址由控制器除以2后同时发给两片，映射读取吞吐量约为单片的2倍
+ * @note  两片同时擦写，页/扇区/块按两片合计(512B/8KB/128KB)，状态寄存器每片返回一个字节，
+ *        轮询时两片都满足才算完成；W25Qxx_FlashSize 按两片合计，两片W25Q128即可满足默认布局
+ * @note  间接读写的地址和字节数须为偶数，映射读取没有限制
+ * @note  字库镜像需用 fontbin_tool.py --dual 生成，按偶/奇字节拆成两片各自的烧录文件
+ */
+// #define QSPI_DUAL_FLASH_ENABLE /*!< 定义了：两片Flash并联(DFM=1), 注释后：只用BK1单片 */
+#ifdef QSPI_DUAL_FLASH_ENABLE
+#define W25Qxx_CHIPS 2 /*!< 并联的Flash片数 */
+#else
+#define W25Qxx_CHIPS 1 /*!< 并联的Flash片数 */
+#endif
+#define W25Qxx_STATUS_BYTES W25Qxx_CHIPS /*!< 一次读取状态寄存器的字节数(每片一个) */
+#define W25Qxx_STATUS_FLAG(b) ((W25Qxx_CHIPS == 2) ? ((b) | ((b) << 8)) : (b)) /*!< 各片状态字节中的同一标志位 */
 
 /*******************************************************************************
  *                              Flash参数定义
  *******************************************************************************/
-#define W25Qxx_PageSize 256                  /*!< 页大小：256字节 */
-#define W25Qxx_FlashSize 0x2000000           /*!< Flash大小：32MB（W25Q256） */
-#define W25Qxx_FLASH_ID 0Xef4019             /*!< W25Q256 JEDEC ID */
+#define W25Qxx_PageSize (256 * W25Qxx_CHIPS)         /*!< 页大小：256字节(双片512字节) */
+#define W25Qxx_SectorSize (0x1000 * W25Qxx_CHIPS)    /*!< 扇区大小：4KB(双片8KB) */
+#define W25Qxx_BlockSize (0x10000 * W25Qxx_CHIPS)    /*!< 块大小：64KB(双片128KB) */
+#define W25Qxx_FlashSize 0x2000000           /*!< 工程使用的Flash容量：32MB（字库分区、MPU区域按此布局，双片时为两片合计），检测到的器件不能更小 */
+#define W25Qxx_FLASH_ID 0Xef4019             /*!< W25Q256 JEDEC ID(默认器件，初始化前按它访问) */
 #define W25Qxx_ChipErase_TIMEOUT_MAX 400000U /*!< 整片擦除超时时间：400s */
 #define W25Qxx_Mem_Addr 0x90000000           /*!< 内存映射模式基地址 */
+#define W25Qxx_DMA_MaxChunk 0x10000           /*!< MDMA单块最大传输字节数，更长的DMA读取自动分段 */
+#define W25Qxx_SectorErase_TIME_MAX 400U  /*!< 4KB扇区擦除最长时间：400ms */
+#define W25Qxx_PageProgram_TIME_MAX 3U     /*!< 页编程最长时间：3ms */
+#define W25Qxx_PowerDown_TIME_US 3U        /*!< 发送0xB9后进入掉电的时间tDP：3us */
+#define W25Qxx_Release_TIME_US 3U          /*!< 发送0xAB后恢复可读的时间tRES1：3us */
+#define W25Qxx_Suspend_TIME_US 20U         /*!< 发送0x75后停止擦除的时间tSUS，恢复后再次暂停的最小间隔：20us */
+#define W25Qxx_DCACHE_SIZE 0x4000          /*!< STM32H750 D-Cache容量：16KB */
+#define W25Qxx_UPDATE_LOG_LEN 8            /*!< 改写记录条数，读取方落后更多时整体作废 */
+#define W25Qxx_UPDATE_OVERFLOW 0xFF        /*!< QSPI_W25Qxx_UpdateRanges() 返回：记录已被覆盖 */
+#define W25Qxx_MAPPED_STEP_SIZE W25Qxx_SectorSize /*!< 在线更新每步最多处理的字节数(扇区整数倍)，决定单步阻塞时间 */
+#define W25Qxx_MAPPED_STEP_MAX_MS                                              \
+    ((W25Qxx_MAPPED_STEP_SIZE / W25Qxx_SectorSize) *                           \
+     (W25Qxx_SectorErase_TIME_MAX +                                            \
+      (W25Qxx_SectorSize / W25Qxx_PageSize) * W25Qxx_PageProgram_TIME_MAX)) /*!< 单步最长阻塞时间(ms)，按数据手册最大值计算 */
+
+/*******************************************************************************
+ *                              内存映射模式配置
+ *******************************************************************************/
+#define QSPI_MMAP_MPU_ENABLE /*!< 定义了：映射区配置为只读+Cache(写通), 注释后：使用默认内存属性 */
+#define QSPI_MMAP_MPU_REGION MPU_REGION_NUMBER0 /*!< MPU区域号, 背景区域占用此号, Flash区域占用此号+1, XIP数据区占用此号+2 */
+// #define QSPI_MMAP_CONTINUOUS_READ /*!< 定义了：使用连续读模式(仅首次发送指令), 注释后：每次Cache行填充都发送0xEC指令 */
+// #define QSPI_MMAP_QPI /*!< 定义了：映射读取使用QPI(4-4-4)模式, 注释后：1-4-4模式; 需器件支持QPI(如W25Q256FV) */
+// #define QSPI_MMAP_DTR /*!< 定义了：映射读取使用双沿采样(0xED), 注释后：单沿采样; 需DTR型号且QSPI时钟不超过器件DTR上限 */
+// #define QSPI_MMAP_TIMEOUT_ENABLE /*!< 定义了：总线空闲超时后释放nCS(Flash进入待机省电), 注释后：nCS保持激活, 顺序读取延迟最低 */
+#define QSPI_MMAP_TIMEOUT_PERIOD 64 /*!< 超时周期(QSPI时钟数), 取值1-65535, 仅启用超时计数器时有效 */
+
+/*******************************************************************************
+ *                              XIP(就地执行)配置
+ *******************************************************************************/
+/**
+ * @note  映射区分为两部分：[0, QSPI_XIP_DATA_ADDR) 存放代码(QSPI_CODE，或分散加载文件中按目标文件指定)，
+ *        之后存放字库等数据。数据区单独一个MPU区域并禁止取指，CPU不会向字库推测取指令，
+ *        代码只进I-Cache、字模只进D-Cache，两者互不淘汰，只在Cache未命中时共用QUADSPI
+ * @note  XIP时映射模式不能中断：DMA读取和异步写入返回 W25Qxx_ERROR_MemoryMapped，
+ *        在线更新只能改写数据区，且更新期间执行的中断服务函数不能位于QSPI
+ * @note  建议同时定义 QSPI_MMAP_CONTINUOUS_READ，代码和字模交替未命中时每次省去8个指令时钟
+ */
+// #define QSPI_XIP_ENABLE /*!< 定义了：应用代码在QSPI Flash中就地执行, 注释后：QSPI只存放字库等数据 */
+#define QSPI_XIP_DATA_ADDR 0x01A00000 /*!< 数据区起始(相对Flash起始，1MB对齐且位于最后8MB)，默认与字库B区起始相同，之前26MB为代码区 */
+
+/*******************************************************************************
+ *                              时钟自动校准配置
+ *******************************************************************************/
+/**
+ * @note  QSPI_W25Qxx_Init() 先在不超过 QSPI_CALIB_SAFE_HZ 的低速下两次读取校验图样作为参考，
+ *        再逐级减小ClockPrescaler，每级依次尝试半周期/不移位采样，连续 QSPI_CALIB_PASSES 次
+ *        与参考一致才算可靠，某一级两种采样都失败时停止，使用最后一个可靠的配置
+ * @note  QSPI内核时钟按RCC中的QSPISEL计算(D1HCLK/PLL1Q/PLL2R/per_ck)，需要更细的频率档位时
+ *        在CubeMX中把QSPI时钟源改为PLL2R即可，QSPI_CALIB_MAX_HZ 限制最高尝试频率
+ * @note  结果连同内核时钟保存在 QSPI_CALIB_SAVE_ADDR 扇区，下次上电先验证保存的配置，
+ *        通过则不再扫描；内核时钟改变、验证失败或找到不同的配置时才重新擦写该扇区
+ * @note  校准使用1-4-4单沿间接读取；定义 QSPI_MMAP_DTR 时只校准不移位采样
+ */
+// #define QSPI_CALIBRATE_ENABLE /*!< 定义了：QSPI_W25Qxx_Init() 中实测选择最快的可靠分频和采样移位, 注释后：使用 MX_QUADSPI_Init() 的配置 */
+#define QSPI_CALIB_ADDR 0x01D00000 /*!< 校验图样地址(相对Flash起始)，默认A区开头(merged_fonts.bin的目录和索引) */
+#define QSPI_CALIB_SIZE 0x1000 /*!< 校验图样字节数 */
+#define QSPI_CALIB_PASSES 8 /*!< 每个配置需连续读对的次数 */
+#define QSPI_CALIB_SAFE_HZ 50000000U /*!< 读取参考图样时的QSPI时钟上限 */
+#define QSPI_CALIB_MAX_HZ 133000000U /*!< 尝试的最高QSPI时钟(W25Q256JV上限133MHz) */
+#define QSPI_CALIB_SAVE_ADDR (0x01A00000 - W25Qxx_SectorSize) /*!< 保存校准结果的扇区(B区之前，测试区之后) */
+
+    /*******************************************************************************
+     *                              器件能力表
+     *******************************************************************************/
+
+    /**
+     * @brief  器件参数
+     * @note   W25Q系列页(256B)、扇区(4KB)、块(64KB)大小相同；QPI/DTR无法从ID区分
+     *         (W25Q256FV与W25Q256JV-IQ同为0xEF4019)，仍由 QSPI_MMAP_QPI/QSPI_MMAP_DTR 配置
+     */
+    typedef struct
+    {
+        uint32_t id;         /*!< JEDEC ID(厂商、类型、容量)，SFDP得到的器件为读到的ID */
+        const char *name;    /*!< 型号，SFDP得到的器件为"SFDP" */
+        uint32_t size;       /*!< 容量(字节) */
+        uint8_t addr_bytes;  /*!< 指令地址字节数：3(16MB及以下) 或 4 */
+        uint8_t read;        /*!< 1-4-4快速读取指令 */
+        uint8_t program;     /*!< 1-1-4页编程指令 */
+        uint8_t erase_4k;    /*!< 4KB扇区擦除指令 */
+        uint8_t erase_64k;   /*!< 64KB块擦除指令 */
+    } QSPI_W25Qxx_Part_t;
 
     /*******************************************************************************
      *                              基本功能函数
@@ -91,11 +221,18 @@ extern "C"
 
     /**
      * @brief  初始化QSPI Flash
+     * @note   读取JEDEC ID查器件能力表，表中没有时读取SFDP；按器件容量改写 hqspi.Init.FlashSize
      * @retval QSPI_W25Qxx_OK - 初始化成功
-     * @retval W25Qxx_ERROR_INIT - 初始化失败（ID不匹配）
+     * @retval W25Qxx_ERROR_INIT - 初始化失败（无法识别器件或容量小于W25Qxx_FlashSize）
      */
     int8_t QSPI_W25Qxx_Init(void);
 
+    /**
+     * @brief  读取当前器件参数
+     * @retval 器件参数，QSPI_W25Qxx_Init() 之前为默认器件(W25Q256JV)
+     */
+    const QSPI_W25Qxx_Part_t *QSPI_W25Qxx_GetPart(void);
+
     /**
      * @brief  复位Flash器件
      * @retval QSPI_W25Qxx_OK - 复位成功
@@ -111,6 +248,47 @@ extern "C"
      */
     uint32_t QSPI_W25Qxx_ReadID(void);
 
+    /**
+     * @brief  校准QSPI时钟分频和采样移位
+     * @note   定义 QSPI_CALIBRATE_ENABLE 时由 QSPI_W25Qxx_Init() 调用，须在进入映射模式之前
+     * @note   只改写 hqspi.Init 的 ClockPrescaler 和 SampleShifting，之后的映射和读写都使用校准结果
+     * @retval QSPI_W25Qxx_OK - 校准完成(使用保存的或新扫描的配置)
+     * @retval W25Qxx_ERROR_INIT - 校验图样读取失败或内容无效(全部字节相同)，恢复原配置
+     */
+    int8_t QSPI_W25Qxx_Calibrate(void);
+
+    /**
+     * @brief  读取校准结果
+     * @param  prescaler: 输出ClockPrescaler，可为NULL
+     * @param  shift: 输出1-半周期采样移位, 0-不移位，可为NULL
+     * @retval 0-未校准, 1-使用保存的结果, 2-本次上电重新扫描
+     */
+    uint8_t QSPI_W25Qxx_GetCalibration(uint8_t *prescaler, uint8_t *shift);
+
+    /**
+     * @brief  进入深度掉电(0xB9)
+     * @note   先退出内存映射，此后任何访问Flash的驱动函数都会先发送0xAB唤醒，
+     *         映射区需调用 QSPI_W25Qxx_WakeUp() 重新映射后才能读取
+     * @retval QSPI_W25Qxx_OK - 已掉电
+     * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能退出映射模式
+     * @retval W25Qxx_ERROR_TRANSMIT - DMA读取或异步写入进行中，或命令发送失败
+     */
+    int8_t QSPI_W25Qxx_PowerDown(void);
+
+    /**
+     * @brief  退出深度掉电并重新进入内存映射模式
+     * @note   发送0xAB后等待tRES1，不重新配置MPU
+     * @retval QSPI_W25Qxx_OK - 已唤醒并映射
+     * @retval W25Qxx_ERROR_* - 唤醒或映射失败
+     */
+    int8_t QSPI_W25Qxx_WakeUp(void);
+
+    /**
+     * @brief  查询Flash是否处于深度掉电
+     * @retval 1-掉电中, 0-正常
+     */
+    uint8_t QSPI_W25Qxx_IsPoweredDown(void);
+
     /*******************************************************************************
      *                              内存映射模式
      *******************************************************************************/
@@ -120,10 +298,28 @@ extern "C"
      * @note   此模式下只能读取，不能写入
      * @note   读取地址：W25Qxx_Mem_Addr + offset
      * @retval QSPI_W25Qxx_OK - 配置成功
+     * @retval W25Qxx_ERROR_INIT - 复位器件失败
      * @retval W25Qxx_ERROR_MemoryMapped - 配置失败
      */
     int8_t QSPI_W25Qxx_MemoryMappedMode(void);
 
+    /**
+     * @brief  配置内存映射区的MPU属性
+     * @note   QSPI_W25Qxx_MemoryMappedMode() 内部已调用，无需单独调用
+     * @note   256MB背景区域禁止访问(防止推测读取越界)，Flash容量内为只读、可Cache
+     */
+    void QSPI_W25Qxx_MPU_Config(void);
+
+    /**
+     * @brief  测量内存映射模式下的读取耗时
+     * @param  ReadAddr: 读取地址（相对Flash起始的偏移）
+     * @param  NumByteToRead: 读取字节数
+     * @param  cold: 1-先使对应Cache行失效(测量QSPI实际延迟), 0-直接读取(测量Cache命中)
+     * @note   使用DWT周期计数器，需在内存映射模式下调用
+     * @retval 读取耗费的CPU周期数
+     */
+    uint32_t QSPI_W25Qxx_MeasureReadCycles(uint32_t ReadAddr, uint32_t NumByteToRead, uint8_t cold);
+
     /*******************************************************************************
      *                              擦除操作
      *******************************************************************************/
@@ -196,6 +392,258 @@ extern "C"
      */
     int8_t QSPI_W25Qxx_ReadBuffer(uint8_t *pBuffer, uint32_t ReadAddr, uint32_t NumByteToRead);
 
+    /*******************************************************************************
+     *                              差分更新
+     *******************************************************************************/
+
+    /**
+     * @brief  差分更新统计信息
+     */
+    typedef struct
+    {
+        uint16_t sectors_skipped;    /*!< 内容相同而跳过的扇区数 */
+        uint16_t sectors_programmed; /*!< 免擦除直接编程的扇区数 */
+        uint16_t sectors_erased;     /*!< 单独擦除的扇区数 */
+        uint16_t blocks_erased;      /*!< 整块擦除的64KB块数 */
+        uint32_t pages_programmed;   /*!< 实际编程的页数 */
+    } QSPI_W25Qxx_UpdateStats_t;
+
+    /**
+     * @brief  差分更新Flash区域
+     * @param  pData: 新镜像数据
+     * @param  WriteAddr: 写入地址（4KB扇区对齐）
+     * @param  Size: 写入字节数
+     * @param  stats: 输出统计信息，可为NULL
+     * @note   相同扇区跳过，整块变化时使用64KB块擦除，擦除后全0xFF的页不编程
+     * @note   字库小改动通常只涉及少数扇区，更新耗时和擦写次数大幅降低
+     * @retval QSPI_W25Qxx_OK - 更新成功
+     * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能退出映射模式
+     * @retval W25Qxx_ERROR_* - 更新失败
+     */
+    int8_t QSPI_W25Qxx_UpdateBuffer(const uint8_t *pData, uint32_t WriteAddr, uint32_t Size,
+                                    QSPI_W25Qxx_UpdateStats_t *stats);
+
+    /*******************************************************************************
+     *                              改写记录
+     *******************************************************************************/
+
+    /**
+     * @brief  改写范围
+     */
+    typedef struct
+    {
+        uint32_t addr;  /*!< Flash地址(相对Flash起始) */
+        uint32_t size;  /*!< 字节数 */
+        uint32_t epoch; /*!< 最后一次改写该范围时的改写序号 */
+    } QSPI_W25Qxx_Range_t;
+
+    /**
+     * @brief  读取改写序号
+     * @note   每次擦除或编程(含异步写入的每一页)加1，对应的D-Cache行已经失效
+     * @retval 当前改写序号
+     */
+    uint32_t QSPI_W25Qxx_UpdateEpoch(void);
+
+    /**
+     * @brief  取出某个改写序号之后的改写范围
+     * @param  since: 输入调用者上次同步的序号，输出当前序号
+     * @param  out: 输出范围数组，至少 W25Qxx_UPDATE_LOG_LEN 项
+     * @note   相距不到一个扇区的改写合并为一条，返回的范围可能略大于实际改写范围
+     * @retval 范围数，W25Qxx_UPDATE_OVERFLOW 表示记录已被覆盖，调用者须整体作废缓存
+     */
+    uint8_t QSPI_W25Qxx_UpdateRanges(uint32_t *since, QSPI_W25Qxx_Range_t *out);
+
+    /*******************************************************************************
+     *                              映射模式下在线更新
+     *******************************************************************************/
+
+    /**
+     * @brief  在线更新任务
+     * @note   由 QSPI_W25Qxx_MappedUpdate_Start() 初始化，成员只读
+     */
+    typedef struct
+    {
+        const uint8_t *pData;            /*!< 新镜像数据 */
+        uint32_t WriteAddr;              /*!< 写入起始地址 */
+        uint32_t Size;                   /*!< 总字节数 */
+        uint32_t done;                   /*!< 已完成字节数 */
+        QSPI_W25Qxx_UpdateStats_t stats; /*!< 累计统计信息 */
+    } QSPI_W25Qxx_MappedJob_t;
+
+    /**
+     * @brief  开始一次映射模式下的在线更新
+     * @param  job: 更新任务
+     * @param  pData: 新镜像数据，更新完成前必须保持有效
+     * @param  WriteAddr: 写入地址（4KB扇区对齐）
+     * @param  Size: 写入字节数
+     * @retval QSPI_W25Qxx_OK - 成功
+     * @retval W25Qxx_ERROR_Erase - 参数错误或地址未按扇区对齐
+     * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能在线更新(擦写期间代码区无法取指)
+     */
+    int8_t QSPI_W25Qxx_MappedUpdate_Start(QSPI_W25Qxx_MappedJob_t *job, const uint8_t *pData,
+                                          uint32_t WriteAddr, uint32_t Size);
+
+    /**
+     * @brief  执行一步在线更新
+     * @param  job: 更新任务
+     * @note   退出映射 -> 差分擦写最多W25Qxx_MAPPED_STEP_SIZE字节 -> 重新映射 -> 失效该范围的D-Cache
+     * @note   返回时总处于内存映射模式，单步阻塞不超过W25Qxx_MAPPED_STEP_MAX_MS(默认448ms，典型约50ms)
+     * @note   与渲染在同一线程中交替调用；不能在中断或MDMA字模预取进行中调用
+     * @note   改写字库区域后需调用 GlyphCache_Clear()，缓存中的旧字模不会自动失效
+     * @retval W25Qxx_MAPPED_PENDING - 本步完成，还有剩余数据
+     * @retval QSPI_W25Qxx_OK - 全部更新完成
+     * @retval W25Qxx_ERROR_TRANSMIT - QSPI正在进行DMA读取或异步擦写(含暂停)
+     * @retval W25Qxx_ERROR_MemoryMapped - XIP时不能在线更新
+     * @retval W25Qxx_ERROR_* - 擦写或重新映射失败
+     */
+    int8_t QSPI_W25Qxx_MappedUpdate_Step(QSPI_W25Qxx_MappedJob_t *job);
+
+    /**
+     * @brief  映射模式下阻塞式在线更新
+     * @param  pData: 新镜像数据
+     * @param  WriteAddr: 写入地址（4KB扇区对齐）
+     * @param  Size: 写入字节数
+     * @param  stats: 输出统计信息，可为NULL
+     * @note   逐步调用 QSPI_W25Qxx_MappedUpdate_Step() 直到完成，结束后仍处于映射模式
+     * @retval QSPI_W25Qxx_OK - 更新成功
+     * @retval W25Qxx_ERROR_* - 更新失败
+     */
+    int8_t QSPI_W25Qxx_MappedUpdate(const uint8_t *pData, uint32_t WriteAddr, uint32_t Size,
+                                    QSPI_W25Qxx_UpdateStats_t *stats);
+
+    /*******************************************************************************
+     *                              DMA读取与异步写入
+     *******************************************************************************/
+
+    /**
+     * @brief  DMA传输完成回调类型
+     * @param  status: QSPI_W25Qxx_OK - 成功, W25Qxx_ERROR_* - 失败
+     * @note   在中断中调用
+     */
+    typedef void (*QSPI_W25Qxx_Callback_t)(int8_t status);
+
+    /**
+     * @brief  异步写入进度回调类型
+     * @param  done: 已写入字节数
+     * @param  total: 总字节数
+     * @note   每写完一页在中断中调用一次
+     */
+    typedef void (*QSPI_W25Qxx_Progress_t)(uint32_t done, uint32_t total);
+
+    /**
+     * @brief  缓冲区DMA读取（任意长度，非阻塞）
+     * @param  pBuffer: 数据缓冲区指针，建议32字节对齐且长度为32的倍数(D-Cache行)
+     * @param  ReadAddr: 读取地址
+     * @param  NumByteToRead: 读取字节数（≤Flash容量）
+     * @param  cplt: 完成回调，可为NULL
+     * @note   缓冲区首尾不满一个Cache行的部分在启动前阻塞读取，DMA只写整行，
+     *         传输期间可以改写与缓冲区相邻的变量；中间不足一整行或双片模式下首尾为奇数字节时整体DMA
+     * @note   需在间接模式下调用（未进入或已退出内存映射模式）
+     * @note   完成前不要访问pBuffer
+     * @retval QSPI_W25Qxx_OK - 启动成功
+     * @retval W25Qxx_ERROR_TRANSMIT - 启动失败或上一次DMA读取未完成
+     */
+    int8_t QSPI_W25Qxx_ReadBuffer_DMA(uint8_t *pBuffer, uint32_t ReadAddr, uint32_t NumByteToRead,
+                                      QSPI_W25Qxx_Callback_t cplt);
+
+    /**
+     * @brief  查询DMA读取是否进行中
+     * @retval 1-进行中, 0-空闲
+     */
+    uint8_t QSPI_W25Qxx_DMA_Busy(void);
+
+    /**
+     * @brief  缓冲区异步写入（任意长度，非阻塞）
+     * @param  pData: 数据缓冲区指针，写入完成前须保持有效且不可修改
+     * @param  WriteAddr: 写入地址
+     * @param  Size: 写入字节数（≤Flash容量）
+     * @param  progress: 进度回调，可为NULL
+     * @param  cplt: 完成回调，可为NULL
+     * @note   写使能、页编程(DMA)、BUSY轮询全部由中断推进，主循环和显示不受影响
+     * @note   写入前必须先擦除；启动时处于内存映射模式的，结束(完成或出错)时自动恢复映射后再调用完成回调
+     * @retval QSPI_W25Qxx_OK - 启动成功
+     * @retval W25Qxx_ERROR_WriteEnable - 启动失败或上一次传输未完成
+     */
+    int8_t QSPI_W25Qxx_WriteBuffer_Async(uint8_t *pData, uint32_t WriteAddr, uint32_t Size,
+                                         QSPI_W25Qxx_Progress_t progress,
+                                         QSPI_W25Qxx_Callback_t cplt);
+
+    /**
+     * @brief  异步擦除一个扇区、块或整片（非阻塞）
+     * @param  SectorAddress: 擦除地址，按Size对齐(整片擦除为0)
+     * @param  Size: W25Qxx_SectorSize(4KB)、W25Qxx_BlockSize(64KB) 或 W25Qxx_FlashSize(整片)
+     * @param  cplt: 完成回调，可为NULL
+     * @note   与异步写入共用状态，QSPI_W25Qxx_Write_Busy() 同样反映擦除是否进行中；内存映射模式的恢复同异步写入
+     * @retval QSPI_W25Qxx_OK - 启动成功
+     * @retval W25Qxx_ERROR_Erase - 参数错误
+     * @retval W25Qxx_ERROR_WriteEnable - 启动失败或上一次传输未完成
+     */
+    int8_t QSPI_W25Qxx_Erase_Async(uint32_t SectorAddress, uint32_t Size,
+                                   QSPI_W25Qxx_Callback_t cplt);
+
+    /**
+     * @brief  查询异步写入是否进行中
+     * @note   擦除暂停期间同样返回1
+     * @retval 1-进行中, 0-空闲
+     */
+    uint8_t QSPI_W25Qxx_Write_Busy(void);
+
+    /**
+     * @brief  暂停正在进行的异步擦除(0x75)或多页编程，并进入内存映射模式
+     * @note   用于在后台擦写期间读取字模：暂停 -> 读取映射区(正在擦写的扇区/块以外) -> 恢复
+     * @note   擦除在tSUS(20us)内停下；编程在当前页结束后停下(最长tPP 3ms)
+     * @note   整片擦除不能暂停；暂停期间不能调用复位器件的函数，否则擦除作废
+     * @retval QSPI_W25Qxx_OK - 已暂停(或擦写恰好结束)，映射区可读
+     * @retval W25Qxx_ERROR_Erase - 没有可暂停的擦写
+     * @retval W25Qxx_ERROR_TRANSMIT - 命令发送失败
+     * @retval W25Qxx_ERROR_MemoryMapped - 暂停后映射失败
+     */
+    int8_t QSPI_W25Qxx_EraseSuspend(void);
+
+    /**
+     * @brief  退出内存映射模式并恢复暂停的擦除(0x7A)或多页编程
+     * @retval QSPI_W25Qxx_OK - 已恢复
+     * @retval W25Qxx_ERROR_Erase - 擦写未暂停
+     * @retval W25Qxx_ERROR_TRANSMIT - 命令发送失败，擦写以该错误结束
+     */
+    int8_t QSPI_W25Qxx_EraseResume(void);
+
+    /**
+     * @brief  查询擦除是否处于暂停状态
+     * @retval 1-已暂停, 0-未暂停
+     */
+    uint8_t QSPI_W25Qxx_EraseSuspended(void);
+
+    /**
+     * @brief  QSPI命令完成处理，在HAL_QSPI_CmdCpltCallback中调用
+     * @param  hqspi_cb: 触发回调的QSPI句柄
+     */
+    void QSPI_W25Qxx_CmdCpltHandler(QSPI_HandleTypeDef *hqspi_cb);
+
+    /**
+     * @brief  QSPI发送完成处理，在HAL_QSPI_TxCpltCallback中调用
+     * @param  hqspi_cb: 触发回调的QSPI句柄
+     */
+    void QSPI_W25Qxx_TxCpltHandler(QSPI_HandleTypeDef *hqspi_cb);
+
+    /**
+     * @brief  QSPI状态匹配处理，在HAL_QSPI_StatusMatchCallback中调用
+     * @param  hqspi_cb: 触发回调的QSPI句柄
+     */
+    void QSPI_W25Qxx_StatusMatchHandler(QSPI_HandleTypeDef *hqspi_cb);
+
+    /**
+     * @brief  QSPI接收完成处理，在HAL_QSPI_RxCpltCallback中调用
+     * @param  hqspi_cb: 触发回调的QSPI句柄
+     */
+    void QSPI_W25Qxx_RxCpltHandler(QSPI_HandleTypeDef *hqspi_cb);
+
+    /**
+     * @brief  QSPI错误处理，在HAL_QSPI_ErrorCallback中调用
+     * @param  hqspi_cb: 触发回调的QSPI句柄
+     */
+    void QSPI_W25Qxx_ErrorHandler(QSPI_HandleTypeDef *hqspi_cb);
+
 #ifdef __cplusplus
 }
 #endif
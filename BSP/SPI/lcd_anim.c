@@ -0,0 +1,528 @@
+/**
+ ******************************************************************************
+ * @file    lcd_anim.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   界面动画实现文件
+ ******************************************************************************
+ * @attention
+ * 实现方式：
+ * 1. 动画表每项记录类型、目标、起止值、开始节拍和时长；每帧按经过的时间算出进度(Q16)，
+ *    经缓动曲线得到当前值，与上一帧的值相同时不绘制
+ * 2. 滑入的当前值是面板距最终位置的像素数，页面推入的当前值是已推入的行数；
+ *    推入时从 LCD_Scroll_Region() 起滚动区累计上移的行数正好等于已推入的行数，
+ *    新行写在显存第 Top+已推入行数 行，推满一页后显存与屏幕重新对齐，再结束滚动
+ * 3. 每项绘制前检查本帧已用的DWT周期，超过上限时记下位置，下一帧从这一项开始
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#if defined(LCD_ANIM_ENABLE) && defined(LCD_SPI_ENABLE)
+#include "lcd_anim.h"
+
+/*******************************************************************************
+ *                              私有宏定义
+ ******************************************************************************/
+#define LCD_ANIM_ONE 65536U /*!< 进度1.0(Q16) */
+
+#define LCD_ANIM_FREE 0	  /*!< 空闲项 */
+#define LCD_ANIM_BAR 1	  /*!< 进度条 */
+#define LCD_ANIM_NUMBER 2 /*!< 数字控件 */
+#define LCD_ANIM_VALUE 3  /*!< 通用数值 */
+#define LCD_ANIM_SLIDE 4  /*!< 滑入 */
+#define LCD_ANIM_PUSH 5	  /*!< 硬件滚动推入 */
+
+#if LCD_ANIM_SLOTS < 1 || LCD_ANIM_SLOTS > 127
+#error "LCD_ANIM_SLOTS 必须在1-127之间"
+#endif
+
+/*******************************************************************************
+ *                              私有类型与变量
+ ******************************************************************************/
+
+/**
+ * @brief  动画表项
+ */
+typedef struct
+{
+	const void *target;	  /*!< 进度条、数字控件、回调参数或面板内容，同一目标只有一项 */
+	const LCD_GC_t *gc;	  /*!< 数字控件的绘图上下文 */
+	LCD_AnimFunc_t func;  /*!< 通用数值的回调 */
+	uint32_t start;		  /*!< 开始时的系统节拍 */
+	int32_t from;		  /*!< 起始值 */
+	int32_t to;			  /*!< 目标值 */
+	int32_t last;		  /*!< 上一次绘制的值 */
+	uint16_t duration;	  /*!< 时长(ms) */
+	uint16_t x, y, w, h;  /*!< 滑入、推入的区域 */
+	uint8_t type;		  /*!< LCD_ANIM_* */
+	uint8_t ease;		  /*!< LCD_EASE_* */
+	uint8_t dir;		  /*!< LCD_SLIDE_* */
+} LCD_Anim_t;
+
+static LCD_Anim_t LCD_Anim_Table[LCD_ANIM_SLOTS];
+static LCD_AnimStats_t LCD_Anim_Stats;
+static uint32_t LCD_Anim_Frame = 0; /*!< 上一帧的系统节拍 */
+static uint8_t LCD_Anim_Next = 0;	/*!< 本帧从第几项开始(上一帧顺延的位置) */
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  缓动曲线
+ * @param  p: 进度，0-LCD_ANIM_ONE
+ * @retval 缓动后的进度，0-LCD_ANIM_ONE
+ */
+static uint32_t LCD_Anim_Ease(uint8_t ease, uint32_t p)
+{
+	uint32_t q;
+
+	if (p >= LCD_ANIM_ONE)
+		return LCD_ANIM_ONE;
+	switch (ease)
+	{
+	case LCD_EASE_IN:
+		return (p * p) >> 16;
+	case LCD_EASE_OUT:
+		q = LCD_ANIM_ONE - p;
+		return LCD_ANIM_ONE - ((q * q) >> 16);
+	case LCD_EASE_IN_OUT:
+		if (p < LCD_ANIM_ONE / 2)
+			return (p * p) >> 15;
+		q = LCD_ANIM_ONE - p;
+		return LCD_ANIM_ONE - ((q * q) >> 15);
+	default:
+		return p;
+	}
+}
+
+/**
+ * @brief  按经过的时间计算当前值
+ */
+static int32_t LCD_Anim_Now(const LCD_Anim_t *a, uint32_t now)
+{
+	uint32_t t = now - a->start;
+	uint32_t p = (a->duration == 0 || t >= a->duration) ? LCD_ANIM_ONE : (t << 16) / a->duration;
+
+	return a->from + (int32_t)(((int64_t)(a->to - a->from) * LCD_Anim_Ease(a->ease, p)) >> 16);
+}
+
+/**
+ * @brief  滑入：面板距最终位置 off 个像素时发送可见部分，只设置一次窗口
+ */
+static void LCD_Anim_DrawSlide(const LCD_Anim_t *a, uint16_t off)
+{
+	const uint16_t *image = (const uint16_t *)a->target;
+	uint16_t vis;
+
+	switch (a->dir)
+	{
+	case LCD_SLIDE_UP: // 可见的是面板上部，各行连续
+		if (off < a->h)
+			LCD_CopyBuffer(a->x, a->y + off, a->w, a->h - off, (uint16_t *)image);
+		break;
+	case LCD_SLIDE_DOWN: // 可见的是面板下部
+		if (off < a->h)
+			LCD_CopyBuffer(a->x, a->y, a->w, a->h - off, (uint16_t *)image + (uint32_t)off * a->w);
+		break;
+	case LCD_SLIDE_LEFT:  // 可见的是面板左侧 w-off 列
+	case LCD_SLIDE_RIGHT: // 可见的是面板右侧 w-off 列
+		if (off >= a->w)
+			break;
+		vis = a->w - off;
+		if (a->dir == LCD_SLIDE_LEFT)
+		{
+			LCD_SetAddress(a->x + off, a->y, a->x + a->w - 1, a->y + a->h - 1);
+		}
+		else
+		{
+			LCD_SetAddress(a->x, a->y, a->x + vis - 1, a->y + a->h - 1);
+			image += off;
+		}
+		for (uint16_t row = 0; row < a->h; row++) // 各行在面板中不连续，窗口内逐行接着写
+		{
+			LCD_WriteBuff((uint16_t *)image + (uint32_t)row * a->w, vis);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief  推入：滚动区上移，新出现的行写面板的 [last, value) 行
+ */
+static void LCD_Anim_DrawPush(const LCD_Anim_t *a, int32_t last, int32_t value)
+{
+	const uint16_t *image = (const uint16_t *)a->target;
+	uint16_t y = LCD_Scroll_Advance((uint16_t)(value - last));
+
+	LCD_CopyBuffer(a->x, y, a->w, (uint16_t)(value - last), (uint16_t *)image + (uint32_t)last * a->w);
+	if (value >= a->h)
+		LCD_Scroll_Stop(); // 推满一页，显存与屏幕已重新对齐
+}
+
+/**
+ * @brief  按进度条方向填充长度 [a, b) 的一段，fill 为0时用背景色清除
+ */
+static void LCD_Bar_Span(const LCD_Bar_t *bar, uint16_t a, uint16_t b, uint8_t fill)
+{
+	uint16_t x = bar->X, y = bar->Y, w = bar->Width, h = bar->Height;
+
+	if (a >= b)
+		return;
+	if (bar->Vertical)
+	{
+		y = bar->Y + bar->Height - b;
+		h = b - a;
+	}
+	else
+	{
+		x = bar->X + a;
+		w = b - a;
+	}
+	if (fill)
+		LCD_FillRect_Ex(&bar->Gc, x, y, w, h);
+	else
+		LCD_ClearRect_Ex(&bar->Gc, x, y, w, h);
+}
+
+/**
+ * @brief  数值对应的已完成长度
+ */
+static uint16_t LCD_Bar_Length(const LCD_Bar_t *bar, uint16_t value)
+{
+	uint32_t span = bar->Vertical ? bar->Height : bar->Width;
+
+	if (value > LCD_BAR_MAX)
+		value = LCD_BAR_MAX;
+	return (uint16_t)((span * value + LCD_BAR_MAX / 2) / LCD_BAR_MAX);
+}
+
+/**
+ * @brief  绘制一项的当前值
+ */
+static void LCD_Anim_Draw(LCD_Anim_t *a, int32_t value)
+{
+	switch (a->type)
+	{
+	case LCD_ANIM_BAR:
+		LCD_Bar_Set((LCD_Bar_t *)a->target, (uint16_t)value);
+		break;
+	case LCD_ANIM_NUMBER:
+		if (a->gc != NULL)
+			LCD_NumberShow_Ex(a->gc, (LCD_Number_t *)a->target, value);
+		else
+			LCD_NumberShow((LCD_Number_t *)a->target, value);
+		break;
+	case LCD_ANIM_VALUE:
+		a->func(value, (void *)a->target);
+		break;
+	case LCD_ANIM_SLIDE:
+		LCD_Anim_DrawSlide(a, (uint16_t)value);
+		break;
+	case LCD_ANIM_PUSH:
+		LCD_Anim_DrawPush(a, a->last, value);
+		break;
+	default:
+		break;
+	}
+	a->last = value;
+}
+
+/**
+ * @brief  取得目标的表项：已有动画时接着使用，否则取空闲项
+ * @retval 表项序号，没有空闲项时为-1
+ */
+static int8_t LCD_Anim_Slot(const void *target)
+{
+	int8_t free_id = -1;
+
+	for (uint8_t i = 0; i < LCD_ANIM_SLOTS; i++)
+	{
+		if (LCD_Anim_Table[i].type != LCD_ANIM_FREE && LCD_Anim_Table[i].target == target)
+			return (int8_t)i;
+		if (LCD_Anim_Table[i].type == LCD_ANIM_FREE && free_id < 0)
+			free_id = (int8_t)i;
+	}
+	return free_id;
+}
+
+/**
+ * @brief  填写表项并开始计时
+ */
+static LCD_Anim_t *LCD_Anim_Start(int8_t id, uint8_t type, const void *target, int32_t from, int32_t to, uint16_t ms,
+								  uint8_t ease)
+{
+	LCD_Anim_t *a = &LCD_Anim_Table[id];
+
+	a->type = type;
+	a->target = target;
+	a->from = from;
+	a->to = to;
+	a->last = from;
+	a->duration = ms;
+	a->ease = ease;
+	a->start = GetTick();
+	return a;
+}
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  初始化进度条并完整绘制一次
+ * @param  bar: 进度条
+ * @param  gc: 颜色和裁剪区(拷贝一份)
+ * @param  x、y、width、height: 显示区域
+ * @param  vertical: 0-从左向右，1-从下向上
+ * @param  value: 初始值，0-LCD_BAR_MAX
+ */
+void LCD_Bar_Init(LCD_Bar_t *bar, const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+				  uint8_t vertical, uint16_t value)
+{
+	bar->Gc = *gc;
+	bar->X = x;
+	bar->Y = y;
+	bar->Width = width;
+	bar->Height = height;
+	bar->Vertical = vertical;
+	bar->Value = (value > LCD_BAR_MAX) ? LCD_BAR_MAX : value;
+	bar->Fill = LCD_Bar_Length(bar, bar->Value);
+
+	LCD_Bar_Span(bar, 0, bar->Fill, 1);
+	LCD_Bar_Span(bar, bar->Fill, vertical ? height : width, 0);
+}
+
+/**
+ * @brief  立即设置进度条的值，只填充增加或清除减少的一段
+ * @param  bar: 进度条
+ * @param  value: 0-LCD_BAR_MAX
+ */
+void LCD_Bar_Set(LCD_Bar_t *bar, uint16_t value)
+{
+	uint16_t len;
+
+	bar->Value = (value > LCD_BAR_MAX) ? LCD_BAR_MAX : value;
+	len = LCD_Bar_Length(bar, bar->Value);
+	if (len > bar->Fill)
+		LCD_Bar_Span(bar, bar->Fill, len, 1);
+	else
+		LCD_Bar_Span(bar, len, bar->Fill, 0);
+	bar->Fill = len;
+}
+
+/**
+ * @brief  进度条从当前值过渡到 to
+ * @retval 动画号，没有空闲位置时为-1
+ */
+int8_t LCD_Anim_Bar(LCD_Bar_t *bar, uint16_t to, uint16_t ms, uint8_t ease)
+{
+	int8_t id = LCD_Anim_Slot(bar);
+
+	if (id < 0)
+	{
+		LCD_Bar_Set(bar, to);
+		return -1;
+	}
+	LCD_Anim_Start(id, LCD_ANIM_BAR, bar, bar->Value, (to > LCD_BAR_MAX) ? LCD_BAR_MAX : to, ms, ease);
+	return id;
+}
+
+/**
+ * @brief  数字控件从 from 过渡到 to
+ * @retval 动画号，没有空闲位置时为-1
+ */
+int8_t LCD_Anim_Number(LCD_Number_t *num, const LCD_GC_t *gc, int32_t from, int32_t to, uint16_t ms, uint8_t ease)
+{
+	int8_t id = LCD_Anim_Slot(num);
+	LCD_Anim_t *a;
+
+	if (id < 0)
+	{
+		if (gc != NULL)
+			LCD_NumberShow_Ex(gc, num, to);
+		else
+			LCD_NumberShow(num, to);
+		return -1;
+	}
+	a = LCD_Anim_Start(id, LCD_ANIM_NUMBER, num, from, to, ms, ease);
+	a->gc = gc;
+	LCD_Anim_Draw(a, from); // 先显示起始值
+	return id;
+}
+
+/**
+ * @brief  通用数值过渡
+ * @retval 动画号，没有空闲位置时为-1
+ */
+int8_t LCD_Anim_Value(LCD_AnimFunc_t func, void *arg, int32_t from, int32_t to, uint16_t ms, uint8_t ease)
+{
+	int8_t id;
+	LCD_Anim_t *a;
+
+	if (func == NULL)
+		return -1;
+	id = LCD_Anim_Slot(arg);
+	if (id < 0)
+	{
+		func(to, arg);
+		return -1;
+	}
+	a = LCD_Anim_Start(id, LCD_ANIM_VALUE, arg, from, to, ms, ease);
+	a->func = func;
+	LCD_Anim_Draw(a, from);
+	return id;
+}
+
+/**
+ * @brief  面板滑入
+ * @retval 动画号，没有空闲位置时为-1
+ */
+int8_t LCD_Anim_Slide(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *image,
+					  uint8_t dir, uint16_t ms, uint8_t ease)
+{
+	int8_t id;
+	LCD_Anim_t *a;
+	uint16_t span = (dir == LCD_SLIDE_LEFT || dir == LCD_SLIDE_RIGHT) ? width : height;
+
+	if (image == NULL || width == 0 || height == 0 || dir > LCD_SLIDE_PUSH)
+		return -1;
+	id = LCD_Anim_Slot(image);
+	if (id < 0)
+	{
+		LCD_CopyBuffer(x, y, width, height, (uint16_t *)image);
+		return -1;
+	}
+	if (dir == LCD_SLIDE_PUSH)
+	{
+		if (x == 0 && width == LCD_Width && LCD_Scroll_Region(y, height))
+		{
+			a = LCD_Anim_Start(id, LCD_ANIM_PUSH, image, 0, height, ms, ease);
+			a->x = x;
+			a->y = y;
+			a->w = width;
+			a->h = height;
+			return id;
+		}
+		dir = LCD_SLIDE_UP; // 不能硬件滚动时改为覆盖
+	}
+	a = LCD_Anim_Start(id, LCD_ANIM_SLIDE, image, span, 0, ms, ease);
+	a->x = x;
+	a->y = y;
+	a->w = width;
+	a->h = height;
+	a->dir = dir;
+	return id;
+}
+
+/**
+ * @brief  停止一个动画
+ * @param  id: 动画号
+ * @param  finish: 1-先绘制最终状态，0-停在当前状态
+ */
+void LCD_Anim_Stop(int8_t id, uint8_t finish)
+{
+	LCD_Anim_t *a;
+
+	if (id < 0 || id >= LCD_ANIM_SLOTS || LCD_Anim_Table[id].type == LCD_ANIM_FREE)
+		return;
+	a = &LCD_Anim_Table[id];
+	if (finish && a->last != a->to)
+		LCD_Anim_Draw(a, a->to);
+	else if (a->type == LCD_ANIM_PUSH)
+		LCD_Scroll_Stop(); // 停在中途时显存与屏幕错开，由调用者重画
+	a->type = LCD_ANIM_FREE;
+}
+
+/**
+ * @brief  正在运行的动画个数
+ */
+uint8_t LCD_Anim_Active(void)
+{
+	uint8_t n = 0;
+
+	for (uint8_t i = 0; i < LCD_ANIM_SLOTS; i++)
+	{
+		n += (LCD_Anim_Table[i].type != LCD_ANIM_FREE);
+	}
+	return n;
+}
+
+/**
+ * @brief  推进所有动画，由调度器每 LCD_ANIM_FRAME_MS 调用
+ * @retval 正在运行的动画个数
+ */
+uint8_t LCD_Anim_Task(void)
+{
+	uint32_t now = GetTick();
+	uint32_t begin = DWT->CYCCNT, budget = LCD_ANIM_BUDGET_US * (SystemCoreClock / 1000000U), used;
+	uint8_t first = LCD_Anim_Next, drawn = 0, active = 0, deferred = 0;
+
+	if (now - LCD_Anim_Frame < LCD_ANIM_FRAME_MS || LCD_Anim_Active() == 0)
+		return LCD_Anim_Active();
+	LCD_Anim_Frame = now;
+	LCD_Anim_Stats.Frames++;
+	LCD_Anim_Next = 0;
+
+	for (uint8_t k = 0; k < LCD_ANIM_SLOTS; k++)
+	{
+		uint8_t i = (uint8_t)((first + k) % LCD_ANIM_SLOTS);
+		LCD_Anim_t *a = &LCD_Anim_Table[i];
+		int32_t value;
+
+		if (a->type == LCD_ANIM_FREE)
+			continue;
+		if (drawn && DWT->CYCCNT - begin > budget)
+		{
+			if (!deferred)
+				LCD_Anim_Next = i; // 下一帧从第一个顺延的动画开始
+			deferred = 1;
+			LCD_Anim_Stats.Deferred++;
+			active++;
+			continue;
+		}
+		value = LCD_Anim_Now(a, now);
+		if (value != a->last)
+		{
+			LCD_Anim_Draw(a, value);
+			LCD_Anim_Stats.Steps++;
+			drawn = 1;
+		}
+		if (value == a->to && now - a->start >= a->duration)
+			a->type = LCD_ANIM_FREE;
+		else
+			active++;
+	}
+
+#ifdef LCD_ANIM_FLUSH
+	if (drawn)
+		LCD_Flush();
+#endif
+	used = DWT->CYCCNT - begin;
+	if (used > LCD_Anim_Stats.MaxCycles)
+		LCD_Anim_Stats.MaxCycles = used;
+	return active;
+}
+
+/**
+ * @brief  读取动画统计
+ * @param  stats: 输出
+ * @param  reset: 1-读取后清零
+ */
+void LCD_Anim_GetStats(LCD_AnimStats_t *stats, uint8_t reset)
+{
+	if (stats != NULL)
+		*stats = LCD_Anim_Stats;
+	if (reset)
+	{
+		LCD_Anim_Stats.Frames = 0;
+		LCD_Anim_Stats.Steps = 0;
+		LCD_Anim_Stats.Deferred = 0;
+		LCD_Anim_Stats.MaxCycles = 0;
+	}
+}
+
+#endif /* LCD_ANIM_ENABLE && LCD_SPI_ENABLE */
@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ * @file    lcd_anim.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   界面动画头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 进度条、数值过渡、面板滑入和页面推入由 LCD_Anim_Task() 按帧推进，调度器每 LCD_ANIM_FRAME_MS
+ *   调用一次；进度按开始以来的系统节拍计算，某一帧来晚了也只是跳过中间状态，总时长不变
+ * - 每帧只绘制与上一帧不同的部分：进度条只填充或清除增减的一段，数值只在整数值改变时
+ *   经 LCD_NumberShow() 重绘变化的字符，滑入只在移动了整像素时发送可见部分，
+ *   页面推入用硬件滚动(VSCSAD)上移，只写新进入的几行
+ * - 绘制经普通绘图函数完成：帧缓冲模式下改变的像素照常计入脏区域，定义 LCD_ANIM_FLUSH 时
+ *   有绘制的帧结束后调用 LCD_Flush()
+ * - 每帧的绘制时间超过 LCD_ANIM_BUDGET_US 后，其余动画顺延到下一帧(下一帧从它们开始)，
+ *   不会长时间占住主循环
+ * - 进度条、数值控件由调用者保存，动画期间须保持有效；同一目标再次启动动画时从当前值接着过渡
+ * - 由 init.h 中的 LCD_ANIM_ENABLE 控制，不要在 LCD_TileBegin()/LCD_TileEnd() 之间运行
+ *
+ * 使用示例：
+ *     static LCD_Bar_t bar;
+ *     LCD_Bar_Init(&bar, &gc, 20, 200, 200, 12, 0, 0);   // gc.Color 为已完成部分的颜色
+ *     LCD_Anim_Bar(&bar, 750, 400, LCD_EASE_OUT);          // 400ms内过渡到75%
+ *     LCD_Anim_Slide(0, 40, 240, 120, panel, LCD_SLIDE_LEFT, 300, LCD_EASE_IN_OUT);
+ *
+ ******************************************************************************
+ */
+
+#ifndef __LCD_ANIM_H
+#define __LCD_ANIM_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "lcd_spi.h"
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define LCD_ANIM_SLOTS 8         /*!< 同时运行的动画个数 */
+#define LCD_ANIM_FRAME_MS 20     /*!< 帧间隔(ms)，调度器按此周期调用 LCD_Anim_Task() */
+#define LCD_ANIM_BUDGET_US 4000  /*!< 每帧用于绘制动画的时间上限(us)，超出后其余动画顺延到下一帧 */
+#define LCD_ANIM_FLUSH           /*!< 定义了：有绘制的帧结束后调用 LCD_Flush(), 注释后：由应用自行刷新帧缓冲 */
+
+#define LCD_EASE_LINEAR 0 /*!< 匀速 */
+#define LCD_EASE_IN 1     /*!< 由慢到快(二次) */
+#define LCD_EASE_OUT 2    /*!< 由快到慢(二次) */
+#define LCD_EASE_IN_OUT 3 /*!< 两端慢、中间快 */
+
+#define LCD_SLIDE_LEFT 0  /*!< 面板从右边缘向左滑入 */
+#define LCD_SLIDE_RIGHT 1 /*!< 面板从左边缘向右滑入 */
+#define LCD_SLIDE_UP 2    /*!< 面板从下边缘向上滑入 */
+#define LCD_SLIDE_DOWN 3  /*!< 面板从上边缘向下滑入 */
+#define LCD_SLIDE_PUSH 4  /*!< 新页面从底部推入、原内容整体上移(硬件滚动)，面板须为整屏宽，不支持滚动时按 LCD_SLIDE_UP */
+
+#define LCD_BAR_MAX 1000 /*!< 进度条满量程 */
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  进度条，只记录已画的长度，数值改变时只绘制增减的一段
+     */
+    typedef struct
+    {
+        LCD_GC_t Gc;      /*!< Color：已完成部分，BackColor：未完成部分，裁剪区 */
+        uint16_t X;       /*!< 显示区域 */
+        uint16_t Y;
+        uint16_t Width;
+        uint16_t Height;
+        uint16_t Value;   /*!< 当前值，0-LCD_BAR_MAX */
+        uint16_t Fill;    /*!< 已完成部分的像素长度 */
+        uint8_t Vertical; /*!< 0：从左向右，1：从下向上 */
+    } LCD_Bar_t;
+
+    /**
+     * @brief  数值过渡的回调，整数值改变时调用
+     * @param  value: 当前值
+     * @param  arg: LCD_Anim_Value() 传入的参数
+     */
+    typedef void (*LCD_AnimFunc_t)(int32_t value, void *arg);
+
+    /**
+     * @brief  动画统计
+     */
+    typedef struct
+    {
+        uint32_t Frames;    /*!< 有动画运行的帧数 */
+        uint32_t Steps;     /*!< 绘制次数(数值没有变化的帧不绘制，不计入) */
+        uint32_t Deferred;  /*!< 超出每帧时间上限而顺延的动画次数 */
+        uint32_t MaxCycles; /*!< 一帧绘制耗费的最多CPU周期 */
+    } LCD_AnimStats_t;
+
+    /*******************************************************************************
+     *                          导出函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  初始化进度条并完整绘制一次
+     * @param  bar: 进度条
+     * @param  gc: 颜色和裁剪区(拷贝一份)
+     * @param  x、y、width、height: 显示区域
+     * @param  vertical: 0-从左向右，1-从下向上
+     * @param  value: 初始值，0-LCD_BAR_MAX
+     */
+    void LCD_Bar_Init(LCD_Bar_t *bar, const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                      uint8_t vertical, uint16_t value);
+
+    /**
+     * @brief  立即设置进度条的值，只填充增加或清除减少的一段
+     * @param  bar: 进度条
+     * @param  value: 0-LCD_BAR_MAX
+     */
+    void LCD_Bar_Set(LCD_Bar_t *bar, uint16_t value);
+
+    /**
+     * @brief  进度条从当前值过渡到 to
+     * @param  bar: 进度条
+     * @param  to: 目标值，0-LCD_BAR_MAX
+     * @param  ms: 时长
+     * @param  ease: LCD_EASE_*
+     * @retval 动画号，没有空闲位置时为-1(已直接设为目标值)
+     */
+    int8_t LCD_Anim_Bar(LCD_Bar_t *bar, uint16_t to, uint16_t ms, uint8_t ease);
+
+    /**
+     * @brief  数字控件从 from 过渡到 to，整数值改变时只重绘变化的字符
+     * @param  num: 已用 LCD_NumberInit() 初始化的数字控件
+     * @param  gc: 颜色和字体，NULL时使用绘制时的全局设置
+     * @param  from、to: 起止值(定点数，与 LCD_NumberShow() 相同)
+     * @param  ms: 时长
+     * @param  ease: LCD_EASE_*
+     * @retval 动画号，没有空闲位置时为-1(已直接显示目标值)
+     */
+    int8_t LCD_Anim_Number(LCD_Number_t *num, const LCD_GC_t *gc, int32_t from, int32_t to, uint16_t ms, uint8_t ease);
+
+    /**
+     * @brief  通用数值过渡，整数值改变时调用回调(仪表指针、颜色渐变等)
+     * @param  func: 回调
+     * @param  arg: 回调参数，同一 arg 再次启动时替换原来的动画
+     * @param  from、to: 起止值
+     * @param  ms: 时长
+     * @param  ease: LCD_EASE_*
+     * @retval 动画号，没有空闲位置时为-1(已直接以目标值调用回调)
+     */
+    int8_t LCD_Anim_Value(LCD_AnimFunc_t func, void *arg, int32_t from, int32_t to, uint16_t ms, uint8_t ease);
+
+    /**
+     * @brief  面板滑入
+     * @param  x、y、width、height: 面板最终位置
+     * @param  image: 面板内容(RGB565，width x height)，动画期间须保持有效
+     * @param  dir: LCD_SLIDE_*
+     * @param  ms: 时长
+     * @param  ease: LCD_EASE_*
+     * @note   面板只覆盖最终位置内的区域，尚未覆盖的部分保持原有内容；每帧只在移动了整像素时
+     *         设置一次窗口发送可见部分
+     * @retval 动画号，没有空闲位置时为-1(已直接显示在最终位置)
+     */
+    int8_t LCD_Anim_Slide(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *image,
+                          uint8_t dir, uint16_t ms, uint8_t ease);
+
+    /**
+     * @brief  停止一个动画
+     * @param  id: 动画号
+     * @param  finish: 1-先绘制最终状态，0-停在当前状态
+     */
+    void LCD_Anim_Stop(int8_t id, uint8_t finish);
+
+    /**
+     * @brief  正在运行的动画个数
+     */
+    uint8_t LCD_Anim_Active(void);
+
+    /**
+     * @brief  推进所有动画，由调度器每 LCD_ANIM_FRAME_MS 调用
+     * @note   距上一帧不足 LCD_ANIM_FRAME_MS 时直接返回，可以在主循环中更频繁地调用
+     * @retval 正在运行的动画个数
+     */
+    uint8_t LCD_Anim_Task(void);
+
+    /**
+     * @brief  读取动画统计
+     * @param  stats: 输出
+     * @param  reset: 1-读取后清零
+     */
+    void LCD_Anim_GetStats(LCD_AnimStats_t *stats, uint8_t reset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LCD_ANIM_H
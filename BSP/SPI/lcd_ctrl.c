@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file    lcd_ctrl.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   屏幕控制器描述表
+ ******************************************************************************
+ * @attention
+ * 说明：
+ * 1. 初始化脚本每项为：指令、参数个数、参数...，参数个数带 LCD_CTRL_DELAY 时参数之后再跟1字节延时(ms)
+ * 2. 电压、伽马等参数来自各屏幕厂家的初始化代码，换用其他模组时以厂家资料为准
+ * 3. SPI_LCD_InitBegin() 在脚本之后发送退出休眠(0x11)，SPI_LCD_InitEnd() 打开显示(0x29)
+ *
+ ******************************************************************************
+ */
+
+#include "lcd_spi.h"
+#ifdef LCD_SPI_ENABLE
+
+/*******************************************************************************
+ *                              ST7789
+ ******************************************************************************/
+
+static const uint8_t LCD_Init_ST7789[] = {
+	0x36, 1, 0x00,						 // 显存访问控制：从上到下、从左到右，RGB像素格式
+	0x3A, 1, 0x05,						 // 接口像素格式：16位
+	0xB2, 5, 0x0C, 0x0C, 0x00, 0x33, 0x33, // 前后肩设置
+	0xB7, 1, 0x35,						 // 栅极电压：VGH = 13.26V，VGL = -10.43V
+	0xBB, 1, 0x19,						 // 公共电压：VCOM = 1.35V
+	0xC0, 1, 0x2C,
+	0xC2, 1, 0x01, // VDV 和 VRH 由用户自由配置
+	0xC3, 1, 0x12, // VRH电压 = 4.6+( vcom+vcom offset+vdv)
+	0xC4, 1, 0x20, // VDV电压 = 0v
+	0xC6, 1, 0x0F, // 正常模式的刷新帧率为60帧
+	0xD0, 2, 0xA4, 0xA1, // 电源控制：AVDD = 6.8V ，AVDD = -4.8V ，VDS = 2.3V
+	0xE0, 14, 0xD0, 0x04, 0x0D, 0x11, 0x13, 0x2B, 0x3F, 0x54, 0x4C, 0x18, 0x0D, 0x0B, 0x1F, 0x23, // 正极伽马
+	0xE1, 14, 0xD0, 0x04, 0x0C, 0x11, 0x13, 0x2C, 0x3F, 0x44, 0x51, 0x2F, 0x1F, 0x1F, 0x20, 0x23, // 负极伽马
+	0x21, 0, // 打开反显，因为面板是常黑型，操作需要反过来
+};
+
+const LCD_Controller_t LCD_Ctrl_ST7789 = {
+	"ST7789",
+	LCD_Init_ST7789, sizeof(LCD_Init_ST7789),
+	{0x70, 0xA0, 0x00, 0xC0}, // 横屏、横屏上下翻转、竖屏、竖屏上下翻转
+	0x2A, 0x2B, 0x2C,
+	LCD_CTRL_SCROLL | LCD_CTRL_PARTIAL | LCD_CTRL_CONTINUE | LCD_CTRL_BYTESWAP | LCD_CTRL_RGB444 | LCD_CTRL_IDLE,
+	320,
+	LCD_SPI_CLOCK_MAX_HZ, // 写周期16ns，实际上限由 LCD_SPI_Calibrate() 测出
+};
+
+/*******************************************************************************
+ *                              ILI9341
+ ******************************************************************************/
+
+static const uint8_t LCD_Init_ILI9341[] = {
+	0x01, LCD_CTRL_DELAY | 0, 5,		 // 软件复位，之后至少等待5ms
+	0xCF, 3, 0x00, 0xC1, 0x30,			 // 功耗控制B
+	0xED, 4, 0x64, 0x03, 0x12, 0x81,	 // 上电时序控制
+	0xE8, 3, 0x85, 0x00, 0x78,			 // 驱动时序控制A
+	0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02, // 功耗控制A
+	0xF7, 1, 0x20,						 // 泵比控制
+	0xEA, 2, 0x00, 0x00,				 // 驱动时序控制B
+	0xC0, 1, 0x23,						 // 电源控制1：GVDD = 4.6V
+	0xC1, 1, 0x10,						 // 电源控制2
+	0xC5, 2, 0x3E, 0x28,				 // VCOM控制1
+	0xC7, 1, 0x86,						 // VCOM控制2
+	0x36, 1, 0x48,						 // 显存访问控制：竖屏，BGR像素格式
+	0x3A, 1, 0x55,						 // 接口像素格式：16位
+	0xB1, 2, 0x00, 0x18,				 // 帧率控制：79Hz
+	0xB6, 3, 0x08, 0x82, 0x27,			 // 显示功能控制
+	0xF2, 1, 0x00,						 // 关闭3伽马
+	0x26, 1, 0x01,						 // 伽马曲线1
+	0xE0, 15, 0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, 0x4E, 0xF1, 0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00, // 正极伽马
+	0xE1, 15, 0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, 0x31, 0xC1, 0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F, // 负极伽马
+};
+
+const LCD_Controller_t LCD_Ctrl_ILI9341 = {
+	"ILI9341",
+	LCD_Init_ILI9341, sizeof(LCD_Init_ILI9341),
+	{0x28, 0xE8, 0x48, 0x88}, // 模组的列方向与ST7789相反，均带BGR位
+	0x2A, 0x2B, 0x2C,
+	LCD_CTRL_SCROLL | LCD_CTRL_PARTIAL | LCD_CTRL_CONTINUE | LCD_CTRL_IDLE, // 字节顺序在 0xF6 中设置，与 RAMCTRL 不兼容；串口只支持16/18位像素
+	320,
+	40000000UL, // 写周期100ns为标称值，常见模组在40MHz下稳定
+};
+
+/*******************************************************************************
+ *                              GC9A01
+ ******************************************************************************/
+
+static const uint8_t LCD_Init_GC9A01[] = {
+	0xEF, 0,
+	0xEB, 1, 0x14,
+	0xFE, 0, // 打开内部寄存器访问
+	0xEF, 0,
+	0xEB, 1, 0x14,
+	0x84, 1, 0x40,
+	0x85, 1, 0xFF,
+	0x86, 1, 0xFF,
+	0x87, 1, 0xFF,
+	0x88, 1, 0x0A,
+	0x89, 1, 0x21,
+	0x8A, 1, 0x00,
+	0x8B, 1, 0x80,
+	0x8C, 1, 0x01,
+	0x8D, 1, 0x01,
+	0x8E, 1, 0xFF,
+	0x8F, 1, 0xFF,
+	0xB6, 2, 0x00, 0x20, // 显示功能控制
+	0x36, 1, 0x08,		 // 显存访问控制：竖屏，BGR像素格式
+	0x3A, 1, 0x05,		 // 接口像素格式：16位
+	0x90, 4, 0x08, 0x08, 0x08, 0x08,
+	0xBD, 1, 0x06,
+	0xBC, 1, 0x00,
+	0xFF, 3, 0x60, 0x01, 0x04,
+	0xC3, 1, 0x13, // 电源控制2
+	0xC4, 1, 0x13, // 电源控制3
+	0xC9, 1, 0x22, // 电源控制4
+	0xBE, 1, 0x11,
+	0xE1, 2, 0x10, 0x0E,
+	0xDF, 3, 0x21, 0x0C, 0x02,
+	0xF0, 6, 0x45, 0x09, 0x08, 0x08, 0x26, 0x2A, // 伽马1
+	0xF1, 6, 0x43, 0x70, 0x72, 0x36, 0x37, 0x6F, // 伽马2
+	0xF2, 6, 0x45, 0x09, 0x08, 0x08, 0x26, 0x2A, // 伽马3
+	0xF3, 6, 0x43, 0x70, 0x72, 0x36, 0x37, 0x6F, // 伽马4
+	0xED, 2, 0x1B, 0x0B,
+	0xAE, 1, 0x77,
+	0xCD, 1, 0x63,
+	0x70, 9, 0x07, 0x07, 0x04, 0x0E, 0x0F, 0x09, 0x07, 0x08, 0x03,
+	0xE8, 1, 0x34, // 帧率
+	0x62, 12, 0x18, 0x0D, 0x71, 0xED, 0x70, 0x70, 0x18, 0x0F, 0x71, 0xEF, 0x70, 0x70,
+	0x63, 12, 0x18, 0x11, 0x71, 0xF1, 0x70, 0x70, 0x18, 0x13, 0x71, 0xF3, 0x70, 0x70,
+	0x64, 7, 0x28, 0x29, 0xF1, 0x01, 0xF1, 0x00, 0x07,
+	0x66, 10, 0x3C, 0x00, 0xCD, 0x67, 0x45, 0x45, 0x10, 0x00, 0x00, 0x00,
+	0x67, 10, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x01, 0x54, 0x10, 0x32, 0x98,
+	0x74, 7, 0x10, 0x85, 0x80, 0x00, 0x00, 0x4E, 0x00,
+	0x98, 2, 0x3E, 0x07,
+	0x35, 0, // 打开撕裂效应输出
+	0x21, 0, // 打开反显
+};
+
+const LCD_Controller_t LCD_Ctrl_GC9A01 = {
+	"GC9A01",
+	LCD_Init_GC9A01, sizeof(LCD_Init_GC9A01),
+	{0x68, 0xA8, 0x08, 0xC8},
+	0x2A, 0x2B, 0x2C,
+	LCD_CTRL_SCROLL | LCD_CTRL_PARTIAL | LCD_CTRL_CONTINUE | LCD_CTRL_RGB444 | LCD_CTRL_IDLE,
+	240,
+	50000000UL,
+};
+
+#endif
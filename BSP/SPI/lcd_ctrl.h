@@ -0,0 +1,67 @@
+/**
+ ******************************************************************************
+ * @file    lcd_ctrl.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   屏幕控制器描述表声明
+ ******************************************************************************
+ * @attention
+ *
+ * 每种控制器一张描述表：初始化脚本、各显示方向的MADCTL、窗口指令、显存行数、
+ * 支持的快速路径(硬件滚动、局部显示、写指针接续)以及允许的最高SPI时钟。
+ * lcd_spi.c 只按表中的参数工作，更换屏幕时选择另一张表即可，不用修改驱动。
+ *
+ * 使用示例：
+ *    LCD_PanelConfig_t cfg = {&hspi2, GPIOB, GPIO_PIN_0, GPIOB, GPIO_PIN_1, 240, 240, 0, 0, &LCD_Ctrl_GC9A01};
+ *
+ ******************************************************************************
+ */
+
+#ifndef __LCD_CTRL_H
+#define __LCD_CTRL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include <stdint.h>
+
+    /*******************************************************************************
+     *                              控制器能力
+     ******************************************************************************/
+
+#define LCD_CTRL_SCROLL 0x01   /*!< 支持垂直滚动 VSCRDEF(0x33)/VSCSAD(0x37)，LCD_Scroll_Init() 可用 */
+#define LCD_CTRL_PARTIAL 0x02  /*!< 支持局部显示 PTLAR(0x30)/PTLON(0x12)，LCD_SetPartialArea() 可用 */
+#define LCD_CTRL_CONTINUE 0x04 /*!< 写显存期间片选释放不影响写指针，LCD_SetAddress() 可以不发指令接着写 */
+#define LCD_CTRL_BYTESWAP 0x08 /*!< RAMCTRL(0xB0) 可以设置像素字节顺序，LCD_SetByteSwap() 可用 */
+#define LCD_CTRL_RGB444 0x10   /*!< 接口像素格式 COLMOD(0x3A) 支持12位(0x03)，LCD_SetPixelFormat() 可用 */
+#define LCD_CTRL_IDLE 0x20     /*!< 支持空闲模式 IDMON(0x39)/IDMOFF(0x38)，每个分量只显示最高位(8色)，LCD_SetIdleMode() 可用 */
+
+#define LCD_CTRL_DELAY 0x80 /*!< 初始化脚本中参数个数的最高位：参数之后再跟1字节延时(ms) */
+
+    /**
+     * @brief 屏幕控制器描述表
+     * @note  初始化脚本每项为：指令、参数个数、参数...，不含退出休眠(0x11)和打开显示(0x29)
+     */
+    typedef struct
+    {
+        const char *Name;      /*!< 控制器名称，基准测试输出中使用 */
+        const uint8_t *Init;   /*!< 初始化脚本 */
+        uint16_t InitSize;     /*!< 初始化脚本字节数 */
+        uint8_t Madctl[4];     /*!< Direction_H、Direction_H_Flip、Direction_V、Direction_V_Flip 的MADCTL(0x36) */
+        uint8_t Caset;         /*!< 列地址设置指令 */
+        uint8_t Raset;         /*!< 行地址设置指令 */
+        uint8_t Ramwr;         /*!< 写显存指令 */
+        uint8_t Caps;          /*!< LCD_CTRL_SCROLL 等能力位 */
+        uint16_t RamRows;      /*!< 显存行数，VSCRDEF、PTLAR 按此计算 */
+        uint32_t MaxClockHz;   /*!< 允许的最高像素时钟(SCK) */
+    } LCD_Controller_t;
+
+    extern const LCD_Controller_t LCD_Ctrl_ST7789;  /*!< ST7789，240x320，本板的2.0寸屏 */
+    extern const LCD_Controller_t LCD_Ctrl_ILI9341; /*!< ILI9341，240x320 */
+    extern const LCD_Controller_t LCD_Ctrl_GC9A01;  /*!< GC9A01，240x240圆屏 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LCD_CTRL_H
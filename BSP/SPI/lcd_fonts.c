@@ -40,6 +40,7 @@
  *                              中文字模数据
  ******************************************************************************/
 
+#if FONT_SIZES & FONT_SIZE_BIT(12)
 /**
  * @brief 1212中文字模数据
  * @note  每个字模占24字节，后跟对应汉字作为注释索引
@@ -50,6 +51,11 @@ const uint8_t  Chinese_1212[20][24]=
 
 };
 
+/* Chinese_1212 的编码键表，由 Tools/fontsort.py 生成，不要手工修改 */
+#define CHINESE_1212_KEYS NULL, 0
+#endif
+
+#if FONT_SIZES & FONT_SIZE_BIT(16)
 /**
  * @brief 1616中文字模数据
  * @note  每个字模占32字节
@@ -59,6 +65,11 @@ const uint8_t  Chinese_1616[20][32]=
 
 };
 
+/* Chinese_1616 的编码键表，由 Tools/fontsort.py 生成，不要手工修改 */
+#define CHINESE_1616_KEYS NULL, 0
+#endif
+
+#if FONT_SIZES & FONT_SIZE_BIT(20)
 /**
  * @brief 2020中文字模数据
  * @note  每个字模占60字节
@@ -67,38 +78,52 @@ const uint8_t  Chinese_2020[20][60]=
 { 																																																																			
 };
 
+/* Chinese_2020 的编码键表，由 Tools/fontsort.py 生成，不要手工修改 */
+#define CHINESE_2020_KEYS NULL, 0
+#endif
+
+#if FONT_SIZES & FONT_SIZE_BIT(24)
 /**
  * @brief 2424中文字模数据
  * @note  每个字模占72字节
  */
 const uint8_t  Chinese_2424[65][72]=	
-{ 
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x02,0x00,0xC0,0x84,0xFF,0xCC,0x9C,0xC1,0xCC,0x88,0xC1,0xCC,0x80,0xD9,0xCC,0x83,0xD9,0xCC,0x8E,0xD9,0xCC,0x98,0xD9,0xCC,0x80,0xD9,0xCC,0x80,0xD9,0xCC,0x88,0xD9,0xCC,0x98,0xCD,0xCC,0x0C,0x0C,0xCC,0x0C,0x36,0xC0,0x0C,0x63,0xC0,0xC6,0xC1,0xC0,0x74,0x80,0x7D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"测 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x02,0x00,0x1B,0x0C,0x00,0x73,0x18,0x00,0x43,0x38,0x00,0x03,0x80,0xFF,0xFF,0x00,0x00,0x03,0x1F,0x00,0x03,0x18,0x00,0x03,0x98,0xFF,0x03,0x18,0x18,0x02,0x18,0x18,0x06,0x98,0x18,0x06,0xD8,0x18,0x86,0x78,0x18,0x8C,0x38,0xF8,0x8D,0x9C,0x0F,0x98,0x08,0x00,0xF0,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"试 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x83,0x01,0xFE,0xFF,0xFF,0x00,0x83,0x01,0xF0,0xFF,0x3F,0x30,0x00,0x30,0xF0,0xFF,0x3F,0x30,0x00,0x30,0xF0,0xFF,0x3F,0x30,0x0C,0x30,0x00,0x06,0x00,0xFE,0xFF,0xFF,0xC0,0x30,0x0C,0xF8,0xFF,0x7F,0x67,0x30,0x98,0x60,0x30,0x18,0x60,0x30,0x1F,0x00,0x30,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"幕 "},
+{
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0xFC,0xFF,0x7F,0x0C,0x18,0x60,0x0C,0x18,0x60,0x0C,0x18,0x60,0x0C,0x18,0x60,0x0C,0x18,0x60,0xFC,0xFF,0x7F,0x0C,0x18,0x60,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"中 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x08,0x00,0x00,0x18,0x00,0x00,0x38,0x00,0xFF,0xFF,0xFF,0x00,0x0E,0x00,0x80,0x83,0x01,0xC0,0x00,0x07,0x70,0x00,0x0C,0xFC,0xFF,0x3F,0x00,0xC3,0x20,0x00,0xC3,0x00,0x80,0xC1,0x00,0x80,0xC1,0xC0,0xE0,0xC0,0xC0,0x38,0xC0,0xC0,0x07,0x80,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"充 "},
 	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x63,0x00,0x80,0xC1,0x00,0xC0,0x80,0x01,0x60,0x00,0x03,0x30,0x00,0x06,0x18,0x00,0x1C,0x0E,0x00,0x70,0x02,0x00,0xC0,0xF8,0xFF,0x0F,0x00,0x03,0x0E,0x00,0x03,0x0E,0x80,0x01,0x06,0x80,0x01,0x06,0xC0,0x00,0x06,0x60,0x00,0x07,0x38,0xFC,0x03,0x0E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"分 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x60,0x0C,0x30,0x60,0x18,0x30,0x60,0x10,0xFE,0xE1,0xFF,0x00,0x60,0x00,0x82,0xED,0xC1,0xC4,0x6C,0x63,0x6C,0x6C,0x36,0xFE,0x65,0xFF,0x30,0x66,0x18,0x30,0x66,0x18,0x30,0x60,0x18,0xFE,0xB1,0xFF,0x30,0x30,0x18,0x38,0x18,0x18,0x1C,0x1C,0x18,0x0E,0x0E,0x18,0x02,0x02,0x18,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"辨 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x38,0x00,0x00,0x70,0x00,0xFF,0xFF,0xFF,0x00,0x38,0x00,0x06,0x4E,0x60,0x8C,0x63,0x38,0xD0,0x3F,0x08,0x00,0x1C,0x00,0x20,0x26,0x04,0xF8,0xC3,0x1C,0xCF,0xFF,0xF1,0x02,0x30,0x41,0x00,0x30,0x00,0xFF,0xFF,0xFF,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"率 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x30,0x80,0x00,0x30,0x80,0x01,0x30,0x00,0x03,0x30,0xFE,0xFF,0xFE,0x06,0xC0,0x30,0x86,0xC4,0x30,0x40,0x18,0x30,0x30,0x30,0x30,0x18,0x60,0xF0,0x0F,0xC0,0x3E,0xF8,0x7F,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0xFF,0xFF,0x1E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"控 "},
 	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80,0x01,0x60,0x98,0x01,0x60,0x8C,0x01,0x63,0xFC,0x3F,0x63,0x86,0x01,0x63,0x82,0x01,0x63,0xFF,0xFF,0x63,0x80,0x01,0x63,0x80,0x01,0x63,0xFC,0x7F,0x63,0x8C,0x61,0x63,0x8C,0x61,0x63,0x8C,0x61,0x60,0x8C,0x61,0x60,0x8C,0x3D,0x60,0x80,0x01,0x3F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"制 "},
 	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFC,0xC7,0x7F,0x0C,0xC6,0x60,0x0C,0xC6,0x60,0xFC,0xC7,0x7F,0x0C,0xC6,0x60,0x00,0x30,0x06,0xFE,0xFF,0xFF,0x00,0x6E,0x00,0x00,0xC7,0x01,0xF0,0x01,0x0F,0x1F,0x00,0xF8,0xFC,0xC7,0x7F,0x0C,0xC6,0x60,0x0C,0xC6,0x60,0xFC,0xC7,0x7F,0x0C,0xC6,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"器 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0xFE,0xFF,0x30,0x00,0x03,0x30,0x00,0x03,0xFF,0xFD,0x7F,0x30,0x0C,0x60,0x30,0xFC,0x7F,0x30,0x0C,0x60,0x30,0xFC,0x7F,0x30,0x0C,0x60,0xB0,0xFD,0x7F,0x78,0x0C,0x60,0x07,0xFF,0xFF,0x00,0x60,0x1C,0x00,0x1C,0xF0,0x80,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"填 "},
 	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x08,0x00,0x00,0x18,0x00,0x00,0x30,0x00,0xFE,0xFF,0xFF,0x06,0x00,0xC0,0x06,0x00,0xC0,0xE0,0xFF,0x0F,0x00,0x00,0x07,0x00,0x80,0x01,0x00,0xE0,0x00,0x00,0x30,0x00,0xFF,0xFF,0xFF,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x80,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"字 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x20,0x80,0x01,0x30,0xC0,0x00,0xF8,0xDF,0xFF,0xC8,0x60,0x06,0x84,0x71,0x0C,0x02,0x39,0x08,0x01,0x10,0x00,0x60,0x00,0x0C,0x70,0x00,0x0C,0xB8,0xFF,0xFF,0x3C,0x00,0x0C,0x36,0x04,0x0C,0x32,0x0C,0x0C,0x30,0x18,0x0C,0x30,0x10,0x0C,0x30,0x00,0x0C,0x30,0x00,0x0C,0x30,0xE0,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"符 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0x30,0x00,0x60,0xE0,0x00,0xF0,0xFF,0xFF,0x38,0x60,0x00,0xF6,0xFF,0xFF,0x33,0x60,0x00,0xF0,0xFF,0xFF,0x30,0x60,0x00,0xF0,0xFF,0xFF,0x30,0x00,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0xFE,0xFF,0xFF,0x00,0xFE,0x01,0x80,0x31,0x07,0x70,0x30,0x38,0x0F,0x30,0xC0,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"集 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0xFC,0xFF,0x7F,0x0C,0x18,0x60,0x0C,0x18,0x60,0x0C,0x18,0x60,0x0C,0x18,0x60,0x0C,0x18,0x60,0xFC,0xFF,0x7F,0x0C,0x18,0x60,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"中 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x60,0x30,0x06,0x30,0x30,0x0C,0x30,0x30,0x1C,0x18,0x30,0x38,0x18,0x30,0x30,0x0C,0x30,0x60,0x0E,0x30,0xE0,0x06,0x30,0xC0,0x02,0x30,0x80,0x00,0x30,0x00,0x00,0x30,0x00,0xC0,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"小 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x83,0x01,0xFE,0xFF,0xFF,0x00,0x83,0x01,0xF0,0xFF,0x3F,0x30,0x00,0x30,0xF0,0xFF,0x3F,0x30,0x00,0x30,0xF0,0xFF,0x3F,0x30,0x0C,0x30,0x00,0x06,0x00,0xFE,0xFF,0xFF,0xC0,0x30,0x0C,0xF8,0xFF,0x7F,0x67,0x30,0x98,0x60,0x30,0x18,0x60,0x30,0x1F,0x00,0x30,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"幕 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x30,0x80,0x00,0x30,0x80,0x01,0x30,0x00,0x03,0x30,0xFE,0xFF,0xFE,0x06,0xC0,0x30,0x86,0xC4,0x30,0x40,0x18,0x30,0x30,0x30,0x30,0x18,0x60,0xF0,0x0F,0xC0,0x3E,0xF8,0x7F,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0xFF,0xFF,0x1E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"控 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0x00,0x03,0xC6,0x0C,0x01,0xC4,0x86,0x01,0xC0,0x80,0xFF,0xFE,0xCF,0x60,0xE0,0xC0,0x60,0xF8,0xE3,0x60,0xCC,0xFE,0x31,0xC3,0x98,0x31,0x30,0x80,0x31,0xFF,0x0F,0x1B,0x0C,0x0C,0x1B,0x06,0x06,0x0E,0x3C,0x07,0x0E,0xE0,0x03,0x1B,0xE0,0xC3,0x31,0x3C,0x76,0xE0,0x07,0x18,0x80,0x00,0x00,0x00,0x00,0x00,0x00},{"数 "},
 	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1C,0x00,0x00,0x38,0x00,0x00,0x60,0x00,0xFF,0xFF,0xFF,0x60,0x00,0x0C,0x60,0x00,0x0C,0xC0,0x00,0x06,0xC0,0x00,0x06,0x80,0x01,0x03,0x00,0x83,0x01,0x00,0xC7,0x00,0x00,0x6C,0x00,0x00,0x38,0x00,0x00,0xEE,0x00,0xC0,0x83,0x07,0x78,0x00,0x3C,0x06,0x00,0xE0,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"文 "},
 	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x3F,0x18,0x00,0x30,0x18,0x00,0x30,0xF8,0xFF,0x3F,0x18,0x00,0x30,0x18,0x00,0x30,0xF8,0xFF,0x3F,0x18,0x00,0x30,0x04,0xC6,0x20,0x08,0xC6,0x30,0x18,0xC6,0x38,0x30,0xC6,0x18,0x20,0xC6,0x08,0x00,0xC6,0x00,0xFE,0xFF,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"显 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFC,0xFF,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x00,0x30,0x00,0x20,0x30,0x04,0x30,0x30,0x0C,0x38,0x30,0x18,0x18,0x30,0x30,0x0C,0x30,0x60,0x06,0x30,0xC0,0x02,0x30,0x80,0x00,0x30,0x00,0x80,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"示 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x30,0x60,0x00,0x30,0x30,0x00,0x30,0xF0,0x7F,0x30,0x78,0x70,0xFF,0x5B,0x38,0x30,0xCC,0x0C,0xF8,0x80,0x07,0xB8,0xC1,0x0F,0x3C,0x7A,0x78,0x36,0x0E,0xC0,0x33,0xF8,0x7F,0x31,0x18,0x60,0x30,0x18,0x60,0x30,0x18,0x60,0x30,0x18,0x60,0x30,0xF8,0x7F,0x30,0x18,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"格 "},
 	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFE,0xFF,0xFF,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x30,0x30,0x00,0x30,0x30,0x00,0x30,0x30,0x00,0x30,0xF0,0x7F,0x30,0x30,0x00,0x30,0x30,0x00,0x30,0x30,0x00,0x30,0x30,0x00,0x30,0x30,0x00,0x30,0x30,0x00,0xFF,0xFF,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"正 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x00,0x80,0x01,0x00,0xC0,0xFF,0x07,0x60,0x00,0x03,0x38,0x80,0x01,0x0C,0x60,0x00,0xF4,0xFF,0x3F,0x30,0x00,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0xF8,0x30,0x00,0x98,0x03,0x00,0x07,0x0E,0xE0,0x01,0x78,0x1E,0x00,0xC0,0x00,0x00,0x00,0x00,0x00,0x00},{"负 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x60,0x30,0x06,0x30,0x30,0x0C,0x30,0x30,0x1C,0x18,0x30,0x38,0x18,0x30,0x30,0x0C,0x30,0x60,0x0E,0x30,0xE0,0x06,0x30,0xC0,0x02,0x30,0x80,0x00,0x30,0x00,0x00,0x30,0x00,0xC0,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"小 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0x00,0x03,0xC6,0x0C,0x01,0xC4,0x86,0x01,0xC0,0x80,0xFF,0xFE,0xCF,0x60,0xE0,0xC0,0x60,0xF8,0xE3,0x60,0xCC,0xFE,0x31,0xC3,0x98,0x31,0x30,0x80,0x31,0xFF,0x0F,0x1B,0x0C,0x0C,0x1B,0x06,0x06,0x0E,0x3C,0x07,0x0E,0xE0,0x03,0x1B,0xE0,0xC3,0x31,0x3C,0x76,0xE0,0x07,0x18,0x80,0x00,0x00,0x00,0x00,0x00,0x00},{"数 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0xFE,0xFF,0x30,0x00,0x03,0x30,0x00,0x03,0xFF,0xFD,0x7F,0x30,0x0C,0x60,0x30,0xFC,0x7F,0x30,0x0C,0x60,0x30,0xFC,0x7F,0x30,0x0C,0x60,0xB0,0xFD,0x7F,0x78,0x0C,0x60,0x07,0xFF,0xFF,0x00,0x60,0x1C,0x00,0x1C,0xF0,0x80,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"填 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x08,0x00,0x00,0x18,0x00,0x00,0x38,0x00,0xFF,0xFF,0xFF,0x00,0x0E,0x00,0x80,0x83,0x01,0xC0,0x00,0x07,0x70,0x00,0x0C,0xFC,0xFF,0x3F,0x00,0xC3,0x20,0x00,0xC3,0x00,0x80,0xC1,0x00,0x80,0xC1,0xC0,0xE0,0xC0,0xC0,0x38,0xC0,0xC0,0x07,0x80,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"充 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x02,0x00,0xC0,0x84,0xFF,0xCC,0x9C,0xC1,0xCC,0x88,0xC1,0xCC,0x80,0xD9,0xCC,0x83,0xD9,0xCC,0x8E,0xD9,0xCC,0x98,0xD9,0xCC,0x80,0xD9,0xCC,0x80,0xD9,0xCC,0x88,0xD9,0xCC,0x98,0xCD,0xCC,0x0C,0x0C,0xCC,0x0C,0x36,0xC0,0x0C,0x63,0xC0,0xC6,0xC1,0xC0,0x74,0x80,0x7D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"测 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x38,0x00,0x00,0x70,0x00,0xFF,0xFF,0xFF,0x00,0x38,0x00,0x06,0x4E,0x60,0x8C,0x63,0x38,0xD0,0x3F,0x08,0x00,0x1C,0x00,0x20,0x26,0x04,0xF8,0xC3,0x1C,0xCF,0xFF,0xF1,0x02,0x30,0x41,0x00,0x30,0x00,0xFF,0xFF,0xFF,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"率 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFC,0xFF,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x00,0x30,0x00,0x20,0x30,0x04,0x30,0x30,0x0C,0x38,0x30,0x18,0x18,0x30,0x30,0x0C,0x30,0x60,0x06,0x30,0xC0,0x02,0x30,0x80,0x00,0x30,0x00,0x80,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"示 "},
 	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x38,0x00,0x00,0x70,0x00,0xFE,0xFF,0xFF,0x06,0x00,0xC0,0x06,0x86,0xC3,0xC0,0x01,0x1E,0x38,0x00,0x70,0x06,0x00,0xC0,0x00,0x00,0x00,0xF8,0xFF,0x3F,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0x00,0x18,0x00,0xFE,0xFF,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"空 "},
-	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x30,0x60,0x00,0x30,0x30,0x00,0x30,0xF0,0x7F,0x30,0x78,0x70,0xFF,0x5B,0x38,0x30,0xCC,0x0C,0xF8,0x80,0x07,0xB8,0xC1,0x0F,0x3C,0x7A,0x78,0x36,0x0E,0xC0,0x33,0xF8,0x7F,0x31,0x18,0x60,0x30,0x18,0x60,0x30,0x18,0x60,0x30,0x18,0x60,0x30,0xF8,0x7F,0x30,0x18,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"格 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x20,0x80,0x01,0x30,0xC0,0x00,0xF8,0xDF,0xFF,0xC8,0x60,0x06,0x84,0x71,0x0C,0x02,0x39,0x08,0x01,0x10,0x00,0x60,0x00,0x0C,0x70,0x00,0x0C,0xB8,0xFF,0xFF,0x3C,0x00,0x0C,0x36,0x04,0x0C,0x32,0x0C,0x0C,0x30,0x18,0x0C,0x30,0x10,0x0C,0x30,0x00,0x0C,0x30,0x00,0x0C,0x30,0xE0,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"符 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x02,0x00,0x1B,0x0C,0x00,0x73,0x18,0x00,0x43,0x38,0x00,0x03,0x80,0xFF,0xFF,0x00,0x00,0x03,0x1F,0x00,0x03,0x18,0x00,0x03,0x98,0xFF,0x03,0x18,0x18,0x02,0x18,0x18,0x06,0x98,0x18,0x06,0xD8,0x18,0x86,0x78,0x18,0x8C,0x38,0xF8,0x8D,0x9C,0x0F,0x98,0x08,0x00,0xF0,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"试 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x00,0x80,0x01,0x00,0xC0,0xFF,0x07,0x60,0x00,0x03,0x38,0x80,0x01,0x0C,0x60,0x00,0xF4,0xFF,0x3F,0x30,0x00,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0xF8,0x30,0x00,0x98,0x03,0x00,0x07,0x0E,0xE0,0x01,0x78,0x1E,0x00,0xC0,0x00,0x00,0x00,0x00,0x00,0x00},{"负 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x60,0x0C,0x30,0x60,0x18,0x30,0x60,0x10,0xFE,0xE1,0xFF,0x00,0x60,0x00,0x82,0xED,0xC1,0xC4,0x6C,0x63,0x6C,0x6C,0x36,0xFE,0x65,0xFF,0x30,0x66,0x18,0x30,0x66,0x18,0x30,0x60,0x18,0xFE,0xB1,0xFF,0x30,0x30,0x18,0x38,0x18,0x18,0x1C,0x1C,0x18,0x0E,0x0E,0x18,0x02,0x02,0x18,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"辨 "},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0x30,0x00,0x60,0xE0,0x00,0xF0,0xFF,0xFF,0x38,0x60,0x00,0xF6,0xFF,0xFF,0x33,0x60,0x00,0xF0,0xFF,0xFF,0x30,0x60,0x00,0xF0,0xFF,0xFF,0x30,0x00,0x00,0x00,0x30,0x00,0x00,0x30,0x00,0xFE,0xFF,0xFF,0x00,0xFE,0x01,0x80,0x31,0x07,0x70,0x30,0x38,0x0F,0x30,0xC0,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},{"集 "},
+};
+
+/* Chinese_2424 的编码键表，由 Tools/fontsort.py 生成，不要手工修改 */
+const uint16_t Chinese_2424_Keys[24] = {
+	0xE4B8, 0xE585, 0xE588, 0xE588, 0xE599, 0xE5A1, 0xE5AD, 0xE5B0, 0xE5B9, 0xE68E, 0xE695, 0xE696,
+	0xE698, 0xE6A0, 0xE6AD, 0xE6B5, 0xE78E, 0xE7A4, 0xE7A9, 0xE7AC, 0xE8AF, 0xE8B4, 0xE8BE, 0xE99B,
 };
+#define CHINESE_2424_KEYS Chinese_2424_Keys, 24
+#endif
 
+#if FONT_SIZES & FONT_SIZE_BIT(32)
 /**
  * @brief 3232中文字模数据
  * @note  每个字模占128字节
@@ -108,10 +133,15 @@ const uint8_t  Chinese_3232[20][128]=
 
 };
 
+/* Chinese_3232 的编码键表，由 Tools/fontsort.py 生成，不要手工修改 */
+#define CHINESE_3232_KEYS NULL, 0
+#endif
+
 /*******************************************************************************
  *                              ASCII字模数据
  ******************************************************************************/
 
+#if FONT_SIZES & FONT_SIZE_BIT(32)
 /**
  * @brief 3216 ASCII字模数据
  * @note  字符集从空格(0x20)到波浪号(0x7E)，共95个字符
@@ -216,6 +246,8 @@ const uint8_t ASCII_3216_Table [] =
 	0x00,0x00,0x78,0x00,0xC4,0x00,0x82,0x41,0x02,0x41,0x00,0x27,0x00,0x1C,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,/*"~",94*/
 		
 };
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(24)
 /**
  * @brief 2412 ASCII字模数据
  * @note  每个字符占48字节
@@ -318,6 +350,8 @@ const uint8_t ASCII_2412_Table [] =
 0x00,0x00,0x00,0x00,0x0C,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x20,0x00,0x40,0x00,0x20,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x10,0x00,0x0C,0x00,0x00,0x00,/*"}",93*/
 0x00,0x00,0x1C,0x00,0x22,0x04,0xC2,0x04,0x80,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,/*"~",94*/
 };
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(20)
 /**
  * @brief 2010 ASCII字模数据
  * @note  每个字符占40字节
@@ -514,6 +548,8 @@ const uint8_t ASCII_2010_Table [] =
 
 	0x1C,0x00,0x26,0x02,0x22,0x03,0xC0,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,/*"~",94*/
 };
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(16)
 /**
  * @brief 1608 ASCII字模数据
  * @note  每个字符占32字节
@@ -710,6 +746,8 @@ const uint8_t ASCII_1608_Table [] =
 
 	0x0C,0x32,0xC2,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,/*"~",94*/
 };
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(12)
 /**
  * @brief 1206 ASCII字模数据
  * @note  每个字符占24字节
@@ -907,69 +945,100 @@ const uint8_t ASCII_1206_Table [] =
 	0x02,0x25,0x18,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,/*"~",94*/	
 };
 #endif
+#endif
 /*******************************************************************************
  *                              字体参数定义
  ******************************************************************************/
 
 #if defined(USE_FLASH_FONT) || defined(USE_FLASH_FONT_RGB)
-pFONT ASCII_Font32 = {NULL, 16, 32, 64, 0};
-pFONT ASCII_Font24 = {NULL, 12, 24, 48, 0};
-pFONT ASCII_Font20 = {NULL, 10, 20, 40, 0};
-pFONT ASCII_Font16 = {NULL, 8, 16, 16, 0};
-pFONT ASCII_Font12 = {NULL, 6, 12, 12, 0};
-pFONT CH_Font12 = {NULL, 12, 12, 24,
+/** @brief 使用Flash字库时只保留字号和字模尺寸(只读常量，不占RAM)，上面的字模数组都不参与编译 */
+#if FONT_SIZES & FONT_SIZE_BIT(32)
+const pFONT ASCII_Font32 = {NULL, 16, 32, 64, 0};
+const pFONT CH_Font32 = {NULL, 32, 32, 128,
                    0};
-pFONT CH_Font16 = {NULL, 16, 16, 32,
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(24)
+const pFONT ASCII_Font24 = {NULL, 12, 24, 48, 0};
+const pFONT CH_Font24 = {NULL, 24, 24, 72,
                    0};
-pFONT CH_Font20 = {NULL, 20, 20, 60,
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(20)
+const pFONT ASCII_Font20 = {NULL, 10, 20, 40, 0};
+const pFONT CH_Font20 = {NULL, 20, 20, 60,
                    0};
-pFONT CH_Font24 = {NULL, 24, 24, 72,
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(16)
+const pFONT ASCII_Font16 = {NULL, 8, 16, 16, 0};
+const pFONT CH_Font16 = {NULL, 16, 16, 32,
                    0};
-pFONT CH_Font32 = {NULL, 32, 32, 128,
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(12)
+const pFONT ASCII_Font12 = {NULL, 6, 12, 12, 0};
+const pFONT CH_Font12 = {NULL, 12, 12, 24,
                    0};
+#endif
 #else
 /** @brief 中文字体参数结构 */
 
-pFONT CH_Font12 = {Chinese_1212[0], 12, 12, 24, sizeof(Chinese_1212) / sizeof(Chinese_1212[0])};
-pFONT CH_Font16 = {Chinese_1616[0], 16, 16, 32, sizeof(Chinese_1616) / sizeof(Chinese_1616[0])};
-pFONT CH_Font20 = {Chinese_2020[0], 20, 20, 60, sizeof(Chinese_2020) / sizeof(Chinese_2020[0])};
-pFONT CH_Font24 = {Chinese_2424[0], 24, 24, 72, sizeof(Chinese_2424) / sizeof(Chinese_2424[0])};
-pFONT CH_Font32 = {Chinese_3232[0], 32, 32, 128, sizeof(Chinese_3232) / sizeof(Chinese_3232[0])};
+#if FONT_SIZES & FONT_SIZE_BIT(12)
+const pFONT CH_Font12 = {Chinese_1212[0], 12, 12, 24, sizeof(Chinese_1212) / sizeof(Chinese_1212[0]), CHINESE_1212_KEYS};
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(16)
+const pFONT CH_Font16 = {Chinese_1616[0], 16, 16, 32, sizeof(Chinese_1616) / sizeof(Chinese_1616[0]), CHINESE_1616_KEYS};
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(20)
+const pFONT CH_Font20 = {Chinese_2020[0], 20, 20, 60, sizeof(Chinese_2020) / sizeof(Chinese_2020[0]), CHINESE_2020_KEYS};
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(24)
+const pFONT CH_Font24 = {Chinese_2424[0], 24, 24, 72, sizeof(Chinese_2424) / sizeof(Chinese_2424[0]), CHINESE_2424_KEYS};
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(32)
+const pFONT CH_Font32 = {Chinese_3232[0], 32, 32, 128, sizeof(Chinese_3232) / sizeof(Chinese_3232[0]), CHINESE_3232_KEYS};
+#endif
 
 /** @brief ASCII字体参数结构 */
-pFONT ASCII_Font32 = {
+#if FONT_SIZES & FONT_SIZE_BIT(32)
+const pFONT ASCII_Font32 = {
 	ASCII_3216_Table,		//	字模数组地址
 	16,                  //	单个字符的字模宽度
 	32,                  //	单个字符的字模长度
 	64,                  //	单个字符的字模数据个数
 	0                    // 该参数只有汉字字模用到，表示二维数组的行大小
 };
+#endif
 
-pFONT ASCII_Font24 = {			
+#if FONT_SIZES & FONT_SIZE_BIT(24)
+const pFONT ASCII_Font24 = {			
 	ASCII_2412_Table,		//	字模数组地址
 	12,                  //	单个字符的字模宽度
 	24,                  //	单个字符的字模长度
 	48,                  //	单个字符的字模数据个数
 	0                    // 该参数只有汉字字模用到，表示二维数组的行大小
 };
+#endif
 
-pFONT ASCII_Font20 = {
+#if FONT_SIZES & FONT_SIZE_BIT(20)
+const pFONT ASCII_Font20 = {
 	ASCII_2010_Table,		//	字模数组地址
 	10,                  //	单个字符的字模宽度
 	20,                  //	单个字符的字模长度
 	40,                  //	单个字符的字模数据个数
 	0                    // 该参数只有汉字字模用到，表示二维数组的行大小
 };
+#endif
 
-pFONT ASCII_Font16 = {
+#if FONT_SIZES & FONT_SIZE_BIT(16)
+const pFONT ASCII_Font16 = {
 	ASCII_1608_Table,		//	字模数组地址
 	8,                   //	单个字符的字模宽度
 	16,                  //	单个字符的字模长度
 	16,                  //	单个字符的字模数据个数
 	0                    // 该参数只有汉字字模用到，表示二维数组的行大小
 };
+#endif
 
-pFONT ASCII_Font12 = {
+#if FONT_SIZES & FONT_SIZE_BIT(12)
+const pFONT ASCII_Font12 = {
 	ASCII_1206_Table,		//	字模数组地址
 	6,                   //	单个字符的字模宽度
 	12,                  //	单个字符的字模长度
@@ -977,6 +1046,7 @@ pFONT ASCII_Font12 = {
 	0                    // 该参数只有汉字字模用到，表示二维数组的行大小
 };
 #endif
+#endif
 	
 
 #endif
@@ -11,6 +11,7 @@
  * - ASCII字体：3216、2412、2010、1608、1206（宋体）
  * - 中文字体：3232、2424、2020、1616、1212（宋体）
  * - 中文字库为小字库，用到的汉字需提前取模
+ * - 只声明 init.h 中 FONT_SIZES 启用的字号
  *
  * 取模软件：PCtolCD
  * 取模方式：阴码、逆向、逐行式、C51格式
@@ -46,27 +47,49 @@ extern "C"
 		uint16_t Height;	   /*!< 单字符高度（像素） */
 		uint16_t Sizes;		   /*!< 单字符字模数据字节数 */
 		uint16_t Table_Rows;   /*!< 中文字模二维数组行数 */
+		const uint16_t *pKeys; /*!< 中文字模按编码排序后的键表(Tools/fontsort.py 生成)，NULL时顺序查找 */
+		uint16_t Keys;		   /*!< 键表项数，第 n 项对应第 2n 行字模 */
 	} pFONT;
 
 	/*******************************************************************************
 	 *                              中文字体
 	 ******************************************************************************/
 
-	extern pFONT CH_Font12; /*!< 1212中文字体 */
-	extern pFONT CH_Font16; /*!< 1616中文字体 */
-	extern pFONT CH_Font20; /*!< 2020中文字体 */
-	extern pFONT CH_Font24; /*!< 2424中文字体 */
-	extern pFONT CH_Font32; /*!< 3232中文字体 */
+#if FONT_SIZES & FONT_SIZE_BIT(12)
+	extern const pFONT CH_Font12; /*!< 1212中文字体 */
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(16)
+	extern const pFONT CH_Font16; /*!< 1616中文字体 */
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(20)
+	extern const pFONT CH_Font20; /*!< 2020中文字体 */
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(24)
+	extern const pFONT CH_Font24; /*!< 2424中文字体 */
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(32)
+	extern const pFONT CH_Font32; /*!< 3232中文字体 */
+#endif
 
 	/*******************************************************************************
 	 *                              ASCII字体
 	 ******************************************************************************/
 
-	extern pFONT ASCII_Font32; /*!< 3216 ASCII字体 */
-	extern pFONT ASCII_Font24; /*!< 2412 ASCII字体 */
-	extern pFONT ASCII_Font20; /*!< 2010 ASCII字体 */
-	extern pFONT ASCII_Font16; /*!< 1608 ASCII字体 */
-	extern pFONT ASCII_Font12; /*!< 1206 ASCII字体 */
+#if FONT_SIZES & FONT_SIZE_BIT(32)
+	extern const pFONT ASCII_Font32; /*!< 3216 ASCII字体 */
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(24)
+	extern const pFONT ASCII_Font24; /*!< 2412 ASCII字体 */
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(20)
+	extern const pFONT ASCII_Font20; /*!< 2010 ASCII字体 */
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(16)
+	extern const pFONT ASCII_Font16; /*!< 1608 ASCII字体 */
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(12)
+	extern const pFONT ASCII_Font12; /*!< 1206 ASCII字体 */
+#endif
 
 #ifdef __cplusplus
 }
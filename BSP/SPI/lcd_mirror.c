@@ -0,0 +1,328 @@
+/**
+ ******************************************************************************
+ * @file    lcd_mirror.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   远程屏幕镜像实现文件
+ ******************************************************************************
+ * @attention
+ * 实现方式：
+ * 1. LCD_Flush() 发送的每个脏矩形经 LCD_Mirror_Mark() 登记：被已有矩形包含时忽略，
+ *    与已有矩形相交或相邻时合并，表满时并入面积增长最小的一个
+ * 2. LCD_Mirror_Task() 取出最早登记的矩形，从帧缓冲逐行编码进包缓冲区，直到再放不下
+ *    一行的最坏编码；一行一行地编，矩形可以跨多个数据包，每包自带坐标和行数，可以单独解码
+ * 3. 两个包缓冲区交替使用：输出函数接收了一包才开始编下一包，返回忙时保留该包下次重发
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#if defined(LCD_MIRROR_ENABLE) && defined(LCD_SPI_ENABLE)
+#include "lcd_mirror.h"
+#include <string.h>
+
+#ifndef LCD_FRAMEBUFFER_ENABLE
+#error "LCD_MIRROR_ENABLE 需要 lcd_spi.h 中的 LCD_FRAMEBUFFER_ENABLE"
+#endif
+
+/*******************************************************************************
+ *                              私有宏定义
+ ******************************************************************************/
+#define LCD_MIRROR_HEADER 16 /*!< 包头字节数 */
+#define LCD_MIRROR_MAX_W ((LCD_Width > LCD_Height) ? LCD_Width : LCD_Height) /*!< 横竖屏中最长的一行 */
+#define LCD_MIRROR_ROW_WORST(w) ((uint32_t)(w) * 2 + ((w) + 127) / 128) /*!< 一行的最坏编码(全部为原样像素) */
+
+#if LCD_MIRROR_PACKET_BYTES < LCD_MIRROR_HEADER + LCD_MIRROR_MAX_W * 2 + (LCD_MIRROR_MAX_W + 127) / 128
+#error "LCD_MIRROR_PACKET_BYTES 放不下包头和最长一行的最坏编码"
+#endif
+#if LCD_MIRROR_PACKET_BYTES > 65535
+#error "LCD_MIRROR_PACKET_BYTES 不能超过65535(长度为16位)"
+#endif
+
+/*******************************************************************************
+ *                              私有类型与变量
+ ******************************************************************************/
+
+/**
+ * @brief  镜像脏矩形(含端点)
+ */
+typedef struct
+{
+	uint16_t x1, y1, x2, y2;
+} LCD_MirrorRect_t;
+
+LCD_MIRROR_ATTR static uint8_t LCD_Mirror_Packet[2][LCD_MIRROR_PACKET_BYTES] DMA_ALIGNED;
+
+static LCD_Mirror_Output_t LCD_Mirror_Out = NULL;
+static LCD_MirrorRect_t LCD_Mirror_Dirty[LCD_MIRROR_RECTS];
+static uint8_t LCD_Mirror_Count = 0;	  /*!< 登记的矩形数 */
+static LCD_MirrorRect_t LCD_Mirror_Cur;	  /*!< 正在发送的矩形 */
+static uint16_t LCD_Mirror_Row = 0;		  /*!< 正在发送的矩形下一行(绝对坐标)，超过 y2 表示没有 */
+static uint8_t LCD_Mirror_Sending = 0;	  /*!< 1：Cur 还有未发送的行 */
+static uint8_t LCD_Mirror_Index = 0;	  /*!< 正在使用的包缓冲区 */
+static uint16_t LCD_Mirror_Pending = 0;	  /*!< 已编码、输出函数还没接收的字节数 */
+static LCD_Mirror_Stats_t LCD_Mirror_Stats;
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+static uint32_t LCD_Mirror_Area(const LCD_MirrorRect_t *r)
+{
+	return (uint32_t)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+/**
+ * @brief  a、b的外接矩形
+ */
+static LCD_MirrorRect_t LCD_Mirror_Union(const LCD_MirrorRect_t *a, const LCD_MirrorRect_t *b)
+{
+	LCD_MirrorRect_t u;
+
+	u.x1 = (a->x1 < b->x1) ? a->x1 : b->x1;
+	u.y1 = (a->y1 < b->y1) ? a->y1 : b->y1;
+	u.x2 = (a->x2 > b->x2) ? a->x2 : b->x2;
+	u.y2 = (a->y2 > b->y2) ? a->y2 : b->y2;
+	return u;
+}
+
+/**
+ * @brief  相交或相邻(合并后不多发送不相关的像素)
+ */
+static uint8_t LCD_Mirror_Touch(const LCD_MirrorRect_t *a, const LCD_MirrorRect_t *b)
+{
+	return (uint32_t)a->x1 <= (uint32_t)b->x2 + 1 && (uint32_t)b->x1 <= (uint32_t)a->x2 + 1 &&
+		   (uint32_t)a->y1 <= (uint32_t)b->y2 + 1 && (uint32_t)b->y1 <= (uint32_t)a->y2 + 1;
+}
+
+/**
+ * @brief  把一行编码到 out
+ * @retval 编码字节数，不超过 LCD_MIRROR_ROW_WORST(w)
+ */
+static uint32_t LCD_Mirror_EncodeRow(const uint16_t *p, uint16_t w, uint8_t *out)
+{
+	uint8_t *o = out;
+	uint16_t i = 0;
+
+	while (i < w)
+	{
+		uint16_t run = 1, start = i, n = 0;
+
+		while (i + run < w && run < 129 && p[i + run] == p[i])
+			run++;
+		if (run >= 2) // 重复段：控制字节 + 1个像素
+		{
+			*o++ = (uint8_t)(0x80 | (run - 2));
+			*o++ = (uint8_t)p[i];
+			*o++ = (uint8_t)(p[i] >> 8);
+			i += run;
+			continue;
+		}
+		while (i < w && n < 128 && !(i + 1 < w && p[i + 1] == p[i])) // 原样段：到下一个重复段之前
+		{
+			i++;
+			n++;
+		}
+		*o++ = (uint8_t)(n - 1);
+		for (uint16_t k = 0; k < n; k++)
+		{
+			*o++ = (uint8_t)p[start + k];
+			*o++ = (uint8_t)(p[start + k] >> 8);
+		}
+	}
+	return (uint32_t)(o - out);
+}
+
+static void LCD_Mirror_Put16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+/**
+ * @brief  取出最早登记的矩形，裁剪到当前方向的屏幕
+ * @retval 1-取到，0-没有
+ */
+static uint8_t LCD_Mirror_Next(uint16_t width, uint16_t height)
+{
+	while (LCD_Mirror_Count > 0)
+	{
+		LCD_MirrorRect_t r = LCD_Mirror_Dirty[0];
+
+		LCD_Mirror_Count--;
+		memmove(&LCD_Mirror_Dirty[0], &LCD_Mirror_Dirty[1], sizeof(LCD_MirrorRect_t) * LCD_Mirror_Count);
+		if (r.x1 >= width || r.y1 >= height)
+			continue; // 旋转屏幕后已在屏幕外
+		if (r.x2 >= width)
+			r.x2 = width - 1;
+		if (r.y2 >= height)
+			r.y2 = height - 1;
+		LCD_Mirror_Cur = r;
+		LCD_Mirror_Row = r.y1;
+		LCD_Mirror_Sending = 1;
+		LCD_Mirror_Stats.Rects++;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief  交给输出函数，接收后切换到另一个包缓冲区
+ */
+static void LCD_Mirror_Submit(void)
+{
+	if (!LCD_Mirror_Out(LCD_Mirror_Packet[LCD_Mirror_Index], LCD_Mirror_Pending))
+	{
+		LCD_Mirror_Stats.Busy++;
+		return;
+	}
+	LCD_Mirror_Stats.Packets++;
+	LCD_Mirror_Stats.Bytes += LCD_Mirror_Pending;
+	LCD_Mirror_Pending = 0;
+	LCD_Mirror_Index ^= 1;
+}
+
+/*******************************************************************************
+ *                              公有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  开始镜像并登记整屏
+ */
+void LCD_Mirror_Start(LCD_Mirror_Output_t output)
+{
+	LCD_Mirror_Stop();
+	LCD_Mirror_Out = output;
+	LCD_Mirror_Refresh();
+}
+
+/**
+ * @brief  停止镜像，丢弃未发送的脏区域
+ */
+void LCD_Mirror_Stop(void)
+{
+	LCD_Mirror_Out = NULL;
+	LCD_Mirror_Count = 0;
+	LCD_Mirror_Sending = 0;
+	LCD_Mirror_Pending = 0;
+}
+
+/**
+ * @brief  重新发送整屏
+ */
+void LCD_Mirror_Refresh(void)
+{
+	uint16_t width, height;
+
+	if (LCD_Mirror_Out == NULL || LCD_FB_Get(&width, &height) == NULL)
+		return;
+	LCD_Mirror_Count = 0; // 整屏包含了已登记的全部区域
+	LCD_Mirror_Mark(0, 0, width - 1, height - 1);
+}
+
+/**
+ * @brief  登记需要发送的区域
+ */
+void LCD_Mirror_Mark(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+	LCD_MirrorRect_t r = {x1, y1, x2, y2};
+	uint32_t best_growth = 0xFFFFFFFF;
+	uint8_t best = 0;
+
+	if (LCD_Mirror_Out == NULL || x1 > x2 || y1 > y2)
+		return;
+	for (uint8_t i = 0; i < LCD_Mirror_Count; i++)
+	{
+		LCD_MirrorRect_t *d = &LCD_Mirror_Dirty[i];
+
+		if (LCD_Mirror_Touch(d, &r))
+		{
+			*d = LCD_Mirror_Union(d, &r); // 包含时外接矩形不变
+			LCD_Mirror_Stats.Merged++;
+			return;
+		}
+	}
+	if (LCD_Mirror_Count < LCD_MIRROR_RECTS)
+	{
+		LCD_Mirror_Dirty[LCD_Mirror_Count++] = r;
+		return;
+	}
+	for (uint8_t i = 0; i < LCD_Mirror_Count; i++) // 表满：并入面积增长最小的矩形
+	{
+		LCD_MirrorRect_t u = LCD_Mirror_Union(&LCD_Mirror_Dirty[i], &r);
+		uint32_t growth = LCD_Mirror_Area(&u) - LCD_Mirror_Area(&LCD_Mirror_Dirty[i]);
+
+		if (growth < best_growth)
+		{
+			best_growth = growth;
+			best = i;
+		}
+	}
+	LCD_Mirror_Dirty[best] = LCD_Mirror_Union(&LCD_Mirror_Dirty[best], &r);
+	LCD_Mirror_Stats.Merged++;
+}
+
+/**
+ * @brief  编码并输出下一个数据包
+ */
+uint8_t LCD_Mirror_Task(void)
+{
+	const uint16_t *fb;
+	uint16_t width, height, w, rows = 0;
+	uint8_t *pkt;
+	uint32_t len = LCD_MIRROR_HEADER;
+
+	if (LCD_Mirror_Out == NULL)
+		return 0;
+	if (LCD_Mirror_Pending != 0)
+	{
+		LCD_Mirror_Submit(); // 上一包还没送出
+		if (LCD_Mirror_Pending != 0)
+			return 1;
+	}
+	fb = LCD_FB_Get(&width, &height);
+	if (!LCD_Mirror_Sending && !LCD_Mirror_Next(width, height))
+		return 0;
+	if (LCD_Mirror_Cur.x2 >= width || LCD_Mirror_Cur.y2 >= height)
+	{
+		LCD_Mirror_Sending = 0; // 发送中途旋转了屏幕，剩余部分作废，由之后的 LCD_Flush() 重新登记
+		return LCD_Mirror_Count != 0;
+	}
+
+	pkt = LCD_Mirror_Packet[LCD_Mirror_Index];
+	w = LCD_Mirror_Cur.x2 - LCD_Mirror_Cur.x1 + 1;
+	while (LCD_Mirror_Row <= LCD_Mirror_Cur.y2 && len + LCD_MIRROR_ROW_WORST(w) <= LCD_MIRROR_PACKET_BYTES)
+	{
+		len += LCD_Mirror_EncodeRow(&fb[(uint32_t)LCD_Mirror_Row * width + LCD_Mirror_Cur.x1], w, &pkt[len]);
+		LCD_Mirror_Row++;
+		rows++;
+	}
+	LCD_Mirror_Put16(&pkt[0], LCD_MIRROR_MAGIC);
+	LCD_Mirror_Put16(&pkt[2], width);
+	LCD_Mirror_Put16(&pkt[4], height);
+	LCD_Mirror_Put16(&pkt[6], LCD_Mirror_Cur.x1);
+	LCD_Mirror_Put16(&pkt[8], (uint16_t)(LCD_Mirror_Row - rows));
+	LCD_Mirror_Put16(&pkt[10], w);
+	LCD_Mirror_Put16(&pkt[12], rows);
+	LCD_Mirror_Put16(&pkt[14], (uint16_t)(len - LCD_MIRROR_HEADER));
+	LCD_Mirror_Stats.Pixels += (uint32_t)w * rows;
+	if (LCD_Mirror_Row > LCD_Mirror_Cur.y2)
+		LCD_Mirror_Sending = 0;
+
+	SCB_CleanDCache_by_Addr((uint32_t *)pkt, (int32_t)((len + 31) & ~31U)); // 输出函数可能直接用DMA读取
+	LCD_Mirror_Pending = (uint16_t)len;
+	LCD_Mirror_Submit();
+	return LCD_Mirror_Pending != 0 || LCD_Mirror_Sending || LCD_Mirror_Count != 0;
+}
+
+/**
+ * @brief  读取镜像统计
+ */
+void LCD_Mirror_GetStats(LCD_Mirror_Stats_t *stats, uint8_t reset)
+{
+	*stats = LCD_Mirror_Stats;
+	if (reset)
+		memset(&LCD_Mirror_Stats, 0, sizeof(LCD_Mirror_Stats));
+}
+
+#endif /* LCD_MIRROR_ENABLE */
@@ -0,0 +1,130 @@
+/**
+ ******************************************************************************
+ * @file    lcd_mirror.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   远程屏幕镜像头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 帧缓冲模式下 LCD_Flush() 每发送一个脏矩形就把它登记到镜像的脏区域，
+ *   LCD_Mirror_Task() 在主循环中逐行读取帧缓冲、行程编码后交给输出函数(串口DMA、USB CDC等)，
+ *   发送量与画面变化的面积成正比，静止的画面不发送任何数据
+ * - 每次只编码一个数据包(不超过 LCD_MIRROR_PACKET_BYTES)，输出函数返回0(上一包还在发送)时
+ *   立即返回，不等待，也不影响本地绘制和 LCD_Flush()；发送跟不上时脏区域在原位合并，
+ *   只发送最新的画面，不会积压
+ * - 读取的是发送时帧缓冲中的内容，发送期间又被修改的区域会在下一次 LCD_Flush() 后重新登记
+ * - 上位机(Tools/mirror_view.py)按包头的屏幕尺寸建立画面，连接后调用 LCD_Mirror_Refresh()
+ *   发送一次整屏
+ * - 需要 lcd_spi.h 中的 LCD_FRAMEBUFFER_ENABLE；由 init.h 中的 LCD_MIRROR_ENABLE 控制
+ *
+ * 数据包格式(小端)：
+ *     包头 uint16 magic 0x4D4C("LM"), uint16 屏幕宽, uint16 屏幕高,
+ *          uint16 x, uint16 y, uint16 宽, uint16 行数, uint16 数据字节数
+ *     数据 逐行行程编码(每行单独编码)：控制字节 c < 0x80 时后跟 c+1 个原样像素，
+ *          c >= 0x80 时后跟1个像素，重复 (c & 0x7F)+2 次；像素为RGB565
+ *
+ * 使用示例：
+ *     static uint8_t Uart_Mirror(const uint8_t *data, uint16_t len) {
+ *         if (huart1.gState != HAL_UART_STATE_READY) return 0;   // 上一包还在发送
+ *         return HAL_UART_Transmit_DMA(&huart1, (uint8_t *)data, len) == HAL_OK;
+ *     }
+ *     LCD_Mirror_Start(Uart_Mirror);   // 包缓冲区需用 LCD_MIRROR_ATTR 放到DMA可访问的RAM
+ *
+ ******************************************************************************
+ */
+
+#ifndef __LCD_MIRROR_H
+#define __LCD_MIRROR_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "lcd_spi.h"
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define LCD_MIRROR_RECTS 8             /*!< 镜像脏矩形个数，超出后并入面积增长最小的矩形 */
+#define LCD_MIRROR_PACKET_BYTES 1024   /*!< 数据包缓冲区字节数(共两个交替使用)，至少容纳包头和最长一行的最坏编码 */
+#define LCD_MIRROR_TASK_MS 2           /*!< 调度器调用 LCD_Mirror_Task() 的周期(ms) */
+#define LCD_MIRROR_MAGIC 0x4D4C        /*!< 包头魔数 "LM" */
+#ifndef LCD_MIRROR_ATTR
+#define LCD_MIRROR_ATTR /*!< 包缓冲区存放位置，默认RAM(DTCM)；输出函数直接用DMA发送时改为 AXI_SRAM_AT(地址) */
+#endif
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  输出函数
+     * @param  data: 一个完整的数据包
+     * @param  len: 字节数
+     * @retval 1=已接收；0=忙，稍后以同样内容再次调用
+     * @note   包缓冲区有两个交替使用，data 在下一次调用返回1之前保持不变，可以直接用DMA发送；
+     *         发送前已清理D-Cache
+     */
+    typedef uint8_t (*LCD_Mirror_Output_t)(const uint8_t *data, uint16_t len);
+
+    /**
+     * @brief  镜像统计
+     */
+    typedef struct
+    {
+        uint32_t Rects;    /*!< 开始发送的矩形数 */
+        uint32_t Packets;  /*!< 输出的数据包数 */
+        uint32_t Pixels;   /*!< 发送的像素数 */
+        uint32_t Bytes;    /*!< 输出的字节数(含包头) */
+        uint32_t Merged;   /*!< 登记时并入已有矩形的次数 */
+        uint32_t Busy;     /*!< 输出函数返回忙的次数 */
+    } LCD_Mirror_Stats_t;
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  开始镜像并登记整屏
+     * @param  output: 输出函数，NULL时停止
+     */
+    void LCD_Mirror_Start(LCD_Mirror_Output_t output);
+
+    /**
+     * @brief  停止镜像，丢弃未发送的脏区域
+     * @note   已交给输出函数的数据包由其自行发完
+     */
+    void LCD_Mirror_Stop(void);
+
+    /**
+     * @brief  重新发送整屏(上位机重新连接、丢包后调用)
+     */
+    void LCD_Mirror_Refresh(void);
+
+    /**
+     * @brief  登记需要发送的区域(含端点)，由 LCD_Flush() 调用
+     * @note   没有开始镜像时立即返回
+     */
+    void LCD_Mirror_Mark(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+
+    /**
+     * @brief  编码并输出下一个数据包，由调度器每 LCD_MIRROR_TASK_MS 调用
+     * @retval 1-还有未发送的区域，0-已全部发送或没有开始镜像
+     */
+    uint8_t LCD_Mirror_Task(void);
+
+    /**
+     * @brief  读取镜像统计
+     * @param  stats: 输出
+     * @param  reset: 1-读取后清零
+     */
+    void LCD_Mirror_GetStats(LCD_Mirror_Stats_t *stats, uint8_t reset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LCD_MIRROR_H */
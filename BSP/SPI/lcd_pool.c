@@ -0,0 +1,204 @@
+/**
+ ******************************************************************************
+ * @file    lcd_pool.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   渲染子系统的固定块内存池与帧内临时分配区实现文件
+ ******************************************************************************
+ * @attention
+ * 实现方式：
+ * 1. 内存池不需要初始化：fresh 之前的块分配过，之后的从未用过；分配时先取空闲链表，
+ *    链表为空再取 fresh 处的新块，第一次分配时把内存池挂入导出链表
+ * 2. 分配区只有一个偏移量，分配按 LCD_POOL_ALIGN 取整后向前移动，Reset时归零
+ * 3. 分配和释放都是常数时间，不关中断，只在主循环中使用
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#ifdef LCD_POOL_ENABLE
+#include <stdio.h>
+
+#if LCD_ARENA_BYTES == 0 || (LCD_ARENA_BYTES % LCD_POOL_ALIGN) != 0
+#error "LCD_ARENA_BYTES 必须是 LCD_POOL_ALIGN 的非零倍数"
+#endif
+
+/*******************************************************************************
+ *                              私有变量
+ ******************************************************************************/
+LCD_ARENA_ATTR static uint64_t LCD_Arena_Mem[LCD_ARENA_BYTES / 8U]; // 帧内分配区
+static uint32_t LCD_Arena_Used = 0;									// 本帧已分配的字节数
+static uint32_t LCD_Arena_Peak = 0;									// 单帧用量峰值
+static uint32_t LCD_Arena_Fails = 0;								// 分配失败次数
+static uint32_t LCD_Arena_Limit = LCD_ARENA_BYTES;					// 运行时可用的字节数(LCD_Arena_SetLimit())
+static LCD_Pool_t *LCD_Pool_List = NULL;							// 分配过的内存池
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+void *LCD_Pool_Alloc(LCD_Pool_t *pool)
+{
+	void *p;
+
+	if (pool->free != NULL)
+	{
+		p = pool->free;
+		pool->free = *(void **)p;
+	}
+	else if (pool->fresh < pool->count)
+	{
+		if (pool->fresh == 0) // 第一次分配，加入导出链表
+		{
+			pool->next = LCD_Pool_List;
+			LCD_Pool_List = pool;
+		}
+		p = pool->base + (uint32_t)pool->fresh * pool->block;
+		pool->fresh++;
+	}
+	else
+	{
+		pool->fails++;
+		return NULL;
+	}
+
+	if (++pool->used > pool->peak)
+		pool->peak = pool->used;
+	return p;
+}
+
+void LCD_Pool_Free(LCD_Pool_t *pool, void *p)
+{
+	if (p == NULL)
+		return;
+	*(void **)p = pool->free;
+	pool->free = p;
+	pool->used--;
+}
+
+void LCD_Pool_GetStats(const LCD_Pool_t *pool, LCD_PoolStats_t *stats)
+{
+	if (stats == NULL)
+		return;
+	stats->capacity = pool->count;
+	stats->used = pool->used;
+	stats->peak = pool->peak;
+	stats->fails = pool->fails;
+}
+
+void *LCD_Arena_Alloc(uint32_t size)
+{
+	uint32_t n = LCD_POOL_BLOCK(size);
+	void *p;
+
+	if (size == 0 || LCD_Arena_Used > LCD_Arena_Limit || n > LCD_Arena_Limit - LCD_Arena_Used)
+	{
+		LCD_Arena_Fails++;
+		return NULL;
+	}
+	p = (uint8_t *)LCD_Arena_Mem + LCD_Arena_Used;
+	LCD_Arena_Used += n;
+	if (LCD_Arena_Used > LCD_Arena_Peak)
+		LCD_Arena_Peak = LCD_Arena_Used;
+	return p;
+}
+
+void LCD_Arena_Reset(void)
+{
+	LCD_Arena_Used = 0;
+}
+
+void LCD_Arena_GetStats(LCD_PoolStats_t *stats)
+{
+	if (stats == NULL)
+		return;
+	stats->capacity = LCD_ARENA_BYTES;
+	stats->used = LCD_Arena_Used;
+	stats->peak = LCD_Arena_Peak;
+	stats->fails = LCD_Arena_Fails;
+}
+
+uint32_t LCD_Arena_SetLimit(uint32_t bytes)
+{
+	if (bytes == 0 || bytes > LCD_ARENA_BYTES)
+		bytes = LCD_ARENA_BYTES;
+	bytes = LCD_POOL_BLOCK(bytes); // LCD_ARENA_BYTES 是 LCD_POOL_ALIGN 的倍数，取整后不会超出
+	LCD_Arena_Limit = bytes;
+	LCD_Arena_Peak = LCD_Arena_Used;
+	return bytes;
+}
+
+/**
+ * @brief  输出一行用量
+ */
+static void LCD_Pool_Line(LCD_Pool_Write_t write, const char *name, const LCD_PoolStats_t *s)
+{
+	char line[80];
+	int len = snprintf(line, sizeof(line), "%s %lu %lu %lu %lu\n", name, (unsigned long)s->capacity,
+					   (unsigned long)s->used, (unsigned long)s->peak, (unsigned long)s->fails);
+
+	if (len > (int)sizeof(line) - 1)
+		len = (int)sizeof(line) - 1;
+	write(line, (uint16_t)len);
+}
+
+uint32_t LCD_Pool_Report(LCD_Pool_Write_t write)
+{
+	LCD_PoolStats_t s;
+	uint32_t lines = 1;
+
+	if (write == NULL)
+		return 0;
+	LCD_Arena_GetStats(&s);
+	LCD_Pool_Line(write, "arena", &s);
+	for (const LCD_Pool_t *pool = LCD_Pool_List; pool != NULL; pool = pool->next)
+	{
+		LCD_Pool_GetStats(pool, &s);
+		LCD_Pool_Line(write, pool->name, &s);
+		lines++;
+	}
+	return lines;
+}
+
+#ifdef PERF_MEMORY_ENABLE
+uint32_t LCD_Pool_GetMemory(PerfMemory_Entry_t *entries, uint32_t max)
+{
+	PerfMemory_Entry_t *e = entries;
+	LCD_PoolStats_t s;
+	uint32_t n = 1;
+
+	if (max == 0)
+		return 0;
+	LCD_Arena_GetStats(&s);
+	e->name = "arena";
+	e->unit = "byte";
+	e->base = LCD_Arena_Mem;
+	e->bytes = sizeof(LCD_Arena_Mem);
+	e->capacity = s.capacity;
+	e->limit = LCD_Arena_Limit;
+	e->used = s.used;
+	e->peak = s.peak;
+	e->hits = 0;
+	e->misses = s.fails;
+	e->resizable = 1;
+	for (const LCD_Pool_t *pool = LCD_Pool_List; pool != NULL && n < max; pool = pool->next)
+	{
+		e = &entries[n++];
+		LCD_Pool_GetStats(pool, &s);
+		e->name = pool->name;
+		e->unit = "block";
+		e->base = pool->base;
+		e->bytes = (uint32_t)pool->block * pool->count;
+		e->capacity = s.capacity;
+		e->limit = s.capacity; // 块数由 LCD_POOL_DEFINE() 决定
+		e->used = s.used;
+		e->peak = s.peak;
+		e->hits = 0;
+		e->misses = s.fails;
+		e->resizable = 0;
+	}
+	return n;
+}
+#endif
+
+#endif // LCD_POOL_ENABLE
@@ -0,0 +1,174 @@
+/**
+ ******************************************************************************
+ * @file    lcd_pool.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   渲染子系统的固定块内存池与帧内临时分配区头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 渲染相关的动态对象(绘制命令、排版对象、文本段缓存等)不使用 malloc：
+ *   长期对象从 LCD_POOL_DEFINE() 定义的固定块内存池分配，帧内临时数据从
+ *   帧内分配区(arena)顺序分配，LCD_FrameEnd() 时整体释放
+ * - 内存池每块大小固定，分配和释放都是O(1)：从未用过的块按顺序取出，
+ *   释放的块挂入空闲链表优先复用，不会产生碎片
+ * - 分配区只移动一个偏移量，不能单独释放；一帧内用完时返回NULL并计入失败次数，
+ *   调用者应退回不需要临时内存的路径(如直接绘制)
+ * - 每个内存池和分配区都记录当前用量、峰值和失败次数，LCD_Pool_Report() 逐行导出，
+ *   据此确定 LCD_ARENA_BYTES 和各内存池的块数
+ * - 只在主循环中使用，不能在中断中分配或释放
+ * - 由 init.h 中的 LCD_POOL_ENABLE 控制
+ *
+ * 使用示例：
+ *     LCD_POOL_DEFINE(Layout_Pool, sizeof(Layout_t), 16);  // 16个排版对象，放在使用它的源文件中
+ *     Layout_t *l = LCD_Pool_Alloc(&Layout_Pool);
+ *     LCD_Pool_Free(&Layout_Pool, l);
+ *     char *s = LCD_Arena_Alloc(64);                       // 本帧内有效
+ *     LCD_FrameEnd();                                      // 分配区清空
+ *     LCD_Pool_Report(Uart_Write);
+ *
+ ******************************************************************************
+ */
+
+#ifndef __LCD_POOL_H
+#define __LCD_POOL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define LCD_ARENA_BYTES 4096U /*!< 帧内分配区字节数，按 LCD_Pool_Report() 给出的峰值调整 */
+#ifndef LCD_ARENA_ATTR
+#define LCD_ARENA_ATTR DTCM_BSS /*!< 分配区存放位置，默认DTCM(只由CPU读写，不能作为DMA缓冲区) */
+#endif
+#define LCD_POOL_ALIGN 8U /*!< 分配区和内存池块的对齐字节数 */
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  固定块内存池，由 LCD_POOL_DEFINE() 定义，成员不要直接修改
+     */
+    typedef struct LCD_Pool
+    {
+        const char *name;      /*!< 名称，LCD_Pool_Report() 输出 */
+        uint8_t *base;         /*!< 块存储区 */
+        uint16_t block;        /*!< 块大小(字节，已按 LCD_POOL_ALIGN 取整) */
+        uint16_t count;        /*!< 块数 */
+        uint16_t fresh;        /*!< 从未分配过的块从此序号开始 */
+        uint16_t used;         /*!< 已分配的块数 */
+        uint16_t peak;         /*!< 已分配块数的峰值 */
+        uint32_t fails;        /*!< 块用完导致的分配失败次数 */
+        void *free;            /*!< 空闲链表(释放的块，块首存放下一项) */
+        struct LCD_Pool *next; /*!< 已使用过的内存池链表，供 LCD_Pool_Report() 遍历 */
+    } LCD_Pool_t;
+
+    /**
+     * @brief  内存池或分配区的用量
+     */
+    typedef struct
+    {
+        uint32_t capacity; /*!< 容量：内存池为块数，分配区为字节数 */
+        uint32_t used;     /*!< 当前用量 */
+        uint32_t peak;     /*!< 用量峰值 */
+        uint32_t fails;    /*!< 分配失败次数 */
+    } LCD_PoolStats_t;
+
+    /**
+     * @brief  导出输出函数
+     * @param  data: 待输出的字符
+     * @param  len: 字符数
+     */
+    typedef void (*LCD_Pool_Write_t)(const char *data, uint16_t len);
+
+/**
+ * @brief  定义一个固定块内存池(本文件的静态变量)
+ * @param  pool: 内存池变量名，存储区为 pool##_Mem
+ * @param  size: 块大小(字节)，按 LCD_POOL_ALIGN 取整
+ * @param  num: 块数(1-65535)
+ * @note   存储区按 LCD_POOL_ALIGN 对齐，放在默认RAM，不需要初始化
+ */
+#define LCD_POOL_BLOCK(size) (((size) + LCD_POOL_ALIGN - 1U) & ~(LCD_POOL_ALIGN - 1U)) /*!< 块大小取整 */
+#define LCD_POOL_DEFINE(pool, size, num)                                      \
+    static uint64_t pool##_Mem[(num) * (LCD_POOL_BLOCK(size) / 8U)];          \
+    static LCD_Pool_t pool = {#pool, (uint8_t *)pool##_Mem, (uint16_t)LCD_POOL_BLOCK(size), \
+                              (uint16_t)(num), 0, 0, 0, 0, NULL, NULL}
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  从内存池分配一块
+     * @param  pool: 内存池
+     * @retval 块首地址，块已用完时返回NULL
+     * @note   内容未初始化
+     */
+    void *LCD_Pool_Alloc(LCD_Pool_t *pool);
+
+    /**
+     * @brief  把一块归还内存池
+     * @param  pool: 分配该块的内存池
+     * @param  p: 块首地址，NULL时不操作
+     * @retval None
+     */
+    void LCD_Pool_Free(LCD_Pool_t *pool, void *p);
+
+    /**
+     * @brief  读取内存池的用量
+     * @param  pool: 内存池
+     * @param  stats: 输出用量
+     * @retval None
+     */
+    void LCD_Pool_GetStats(const LCD_Pool_t *pool, LCD_PoolStats_t *stats);
+
+    /**
+     * @brief  从帧内分配区分配
+     * @param  size: 字节数，按 LCD_POOL_ALIGN 取整
+     * @retval 首地址，本帧剩余空间不足时返回NULL
+     * @note   LCD_FrameEnd() 或 LCD_Arena_Reset() 之后全部失效
+     */
+    void *LCD_Arena_Alloc(uint32_t size);
+
+    /**
+     * @brief  释放帧内分配区的全部分配，由 LCD_FrameEnd() 调用
+     * @retval None
+     */
+    void LCD_Arena_Reset(void);
+
+    /**
+     * @brief  读取帧内分配区的用量
+     * @param  stats: 输出用量，峰值为单帧内的最大用量
+     * @retval None
+     */
+    void LCD_Arena_GetStats(LCD_PoolStats_t *stats);
+
+    /**
+     * @brief  限制帧内分配区运行时可用的字节数
+     * @param  bytes: 字节数，按 LCD_POOL_ALIGN 取整；0或超过 LCD_ARENA_BYTES 时为 LCD_ARENA_BYTES
+     * @retval 生效的字节数
+     * @note   从下一次分配起生效，本帧已分配的内存仍然有效；峰值从当前用量重新统计
+     */
+    uint32_t LCD_Arena_SetLimit(uint32_t bytes);
+
+    /**
+     * @brief  按 "名称 容量 已用 峰值 失败" 逐行导出分配区和已使用过的内存池
+     * @param  write: 输出函数
+     * @retval 导出的行数
+     * @note   分配区一行名称为 arena，容量单位为字节；内存池的容量单位为块
+     */
+    uint32_t LCD_Pool_Report(LCD_Pool_Write_t write);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LCD_POOL_H
@@ -0,0 +1,401 @@
+/**
+ ******************************************************************************
+ * @file    lcd_remote.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   远程文本显示协议实现文件
+ ******************************************************************************
+ * @attention
+ * 实现方式：
+ * 1. 包缓冲区有四种状态：空闲、接收中、待解析、等待绘制。接收中断把收完的缓冲区按到达顺序
+ *    放入待解析环，LCD_Remote_Task() 依次取出，校验包头后逐条执行记录
+ * 2. 文字记录只在描述环中填一项 LCD_GlyphIds_t(编号指向包缓冲区，对照表指向本模块)，
+ *    排入队列，记下命令序号；包解析完后缓冲区等待其中最后一条命令完成，再交还接收
+ * 3. 需要等待时(对照表仍被引用、描述环的下一项还在队列中、队列已满)保存解析位置后返回，
+ *    下次调用从该记录继续，主循环中的 LCD_Queue_Poll() 照常推进
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#if defined(LCD_REMOTE_ENABLE) && defined(LCD_SPI_ENABLE)
+#include "lcd_remote.h"
+#include <string.h>
+
+#if !defined(USE_FLASH_FONT) || defined(IS_GB2312)
+#error "LCD_REMOTE_ENABLE 需要UTF-8 Flash字库"
+#endif
+
+/*******************************************************************************
+ *                              私有宏定义
+ ******************************************************************************/
+#define LCD_REMOTE_HEADER 8 /*!< 包头字节数 */
+#define LCD_REMOTE_NONE 0xFF /*!< 没有正在解析的缓冲区 */
+
+#define LCD_REMOTE_FREE 0	 /*!< 缓冲区状态：空闲 */
+#define LCD_REMOTE_RECEIVING 1 /*!< 缓冲区状态：接收中 */
+#define LCD_REMOTE_READY 2	 /*!< 缓冲区状态：待解析(含解析中) */
+#define LCD_REMOTE_HELD 3	 /*!< 缓冲区状态：等待引用它的命令完成 */
+
+#define LCD_REMOTE_DONE 0  /*!< 记录已执行 */
+#define LCD_REMOTE_WAIT 1  /*!< 需要等待，下次从该记录继续 */
+#define LCD_REMOTE_ERROR 2 /*!< 格式错误，丢弃本包其余部分 */
+
+#if LCD_REMOTE_RX_BYTES % 32 != 0 || LCD_REMOTE_RX_BYTES < 64
+#error "LCD_REMOTE_RX_BYTES 需为32的倍数(按Cache行无效化)且不小于64"
+#endif
+#if LCD_REMOTE_RX_BYTES > 65535 || LCD_REMOTE_RX_BUFFS > 254
+#error "LCD_REMOTE_RX_BYTES 不能超过65535(长度为16位)，LCD_REMOTE_RX_BUFFS 不能超过254"
+#endif
+
+/*******************************************************************************
+ *                              私有类型与变量
+ ******************************************************************************/
+
+/**
+ * @brief  排在队列中的一段远程文字
+ */
+typedef struct
+{
+	LCD_GlyphIds_t Run; /*!< 编号指向包缓冲区 */
+	uint32_t Seq;		/*!< 命令序号，0表示空闲 */
+} LCD_RemoteRun_t;
+
+LCD_REMOTE_ATTR static uint8_t LCD_Remote_Rx[LCD_REMOTE_RX_BUFFS][LCD_REMOTE_RX_BYTES] DMA_ALIGNED;
+
+static volatile uint8_t LCD_Remote_State[LCD_REMOTE_RX_BUFFS]; /*!< 缓冲区状态 LCD_REMOTE_FREE 等 */
+static uint16_t LCD_Remote_Len[LCD_REMOTE_RX_BUFFS];		/*!< 收到的字节数 */
+static uint32_t LCD_Remote_Last[LCD_REMOTE_RX_BUFFS];		/*!< 引用该缓冲区的最后一条命令 */
+static volatile uint8_t LCD_Remote_Ready[LCD_REMOTE_RX_BUFFS + 1]; /*!< 待解析环，按到达顺序，多一项区分空和满 */
+static volatile uint8_t LCD_Remote_ReadyIn = 0;				/*!< 中断写入位置 */
+static uint8_t LCD_Remote_ReadyOut = 0;						/*!< 任务读取位置 */
+
+static uint8_t LCD_Remote_Cur = LCD_REMOTE_NONE; /*!< 正在解析的缓冲区 */
+static uint16_t LCD_Remote_Pos;				 /*!< 下一条记录在缓冲区中的位置 */
+static uint16_t LCD_Remote_End;				 /*!< 记录结束位置 */
+
+static uint16_t LCD_Remote_Table[256];			 /*!< 字符对照表：编号 → Unicode码点 */
+static LCD_GC_t LCD_Remote_Style[LCD_REMOTE_STYLES]; /*!< 样式表 */
+static LCD_RemoteRun_t LCD_Remote_Runs[LCD_REMOTE_RUNS]; /*!< 文字段描述环 */
+static uint8_t LCD_Remote_RunNext = 0;				 /*!< 下一个使用的描述项 */
+static uint32_t LCD_Remote_TextSeq = 0;				 /*!< 最近排入的文字命令，对照表在它完成前不能改 */
+static uint16_t LCD_Remote_Expect = 0;				 /*!< 期望的下一个包序号 */
+static uint8_t LCD_Remote_Synced = 0;				 /*!< 1：已收到过数据包，Expect 有效 */
+static uint8_t LCD_Remote_Inited = 0;				 /*!< 1：对照表和样式表已初始化 */
+static LCD_Remote_Stats_t LCD_Remote_Stats;
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+static uint16_t LCD_Remote_Get16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static uint32_t LCD_Remote_Rgb(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+/**
+ * @brief  排入结果计入统计；ref 为1时命令引用当前缓冲区，记下序号
+ */
+static void LCD_Remote_Issued(uint32_t seq, uint8_t ref)
+{
+	if (seq == 0)
+	{
+		LCD_Remote_Stats.Dropped++;
+		return;
+	}
+	if (ref)
+		LCD_Remote_Last[LCD_Remote_Cur] = seq;
+}
+
+/**
+ * @brief  队列能否再接受一条命令；未定义 LCD_QUEUE_SERVER 时排入函数会自行腾出空间
+ */
+static uint8_t LCD_Remote_CanPush(void)
+{
+#if defined(LCD_QUEUE_ENABLE) && defined(LCD_QUEUE_SERVER)
+	return LCD_Queue_Pending() < LCD_QUEUE_CMDS;
+#else
+	return 1;
+#endif
+}
+
+/**
+ * @brief  执行一条记录
+ * @param  p: 记录首字节(类型)
+ * @param  avail: 本包剩余字节数
+ * @param  used: 输出记录的字节数
+ * @retval LCD_REMOTE_DONE / LCD_REMOTE_WAIT / LCD_REMOTE_ERROR
+ */
+static uint8_t LCD_Remote_Record(const uint8_t *p, uint16_t avail, uint16_t *used)
+{
+	const LCD_GC_t *gc;
+	LCD_RemoteRun_t *slot;
+	uint32_t seq;
+	uint16_t n;
+
+	switch (p[0])
+	{
+	case LCD_REMOTE_RESET:
+		if (!LCD_Queue_IsDone(LCD_Remote_TextSeq))
+			return LCD_REMOTE_WAIT; // 已排入的文字还在引用对照表
+		LCD_Remote_Reset();
+		LCD_Remote_Synced = 1; // 本包的序号已核对
+		*used = 1;
+		return LCD_REMOTE_DONE;
+
+	case LCD_REMOTE_GLYPHS:
+		if (avail < 3)
+			return LCD_REMOTE_ERROR;
+		n = p[2];
+		if (avail < 3 + n * 2 || p[1] + n > 256)
+			return LCD_REMOTE_ERROR;
+		if (!LCD_Queue_IsDone(LCD_Remote_TextSeq))
+			return LCD_REMOTE_WAIT;
+		for (uint16_t i = 0; i < n; i++)
+			LCD_Remote_Table[p[1] + i] = LCD_Remote_Get16(&p[3 + i * 2]);
+		*used = (uint16_t)(3 + n * 2);
+		return LCD_REMOTE_DONE;
+
+	case LCD_REMOTE_STYLE:
+		if (avail < 10 || p[1] >= LCD_REMOTE_STYLES)
+			return LCD_REMOTE_ERROR;
+		{
+			LCD_GC_t *style = &LCD_Remote_Style[p[1]]; // 排入时已复制上下文，可以立即修改
+
+			LCD_GC_SetFont(style, p[2]);
+			LCD_GC_SetTextMode(style, p[3]);
+			LCD_GC_SetColor(style, LCD_Remote_Rgb(&p[4]));
+			LCD_GC_SetBackColor(style, LCD_Remote_Rgb(&p[7]));
+		}
+		*used = 10;
+		return LCD_REMOTE_DONE;
+
+	case LCD_REMOTE_TEXT:
+		if (avail < 9 || p[1] >= LCD_REMOTE_STYLES)
+			return LCD_REMOTE_ERROR;
+		n = p[8];
+		if (avail < 9 + n)
+			return LCD_REMOTE_ERROR;
+		slot = &LCD_Remote_Runs[LCD_Remote_RunNext];
+		if (!LCD_Queue_IsDone(slot->Seq) || !LCD_Remote_CanPush())
+			return LCD_REMOTE_WAIT;
+		gc = &LCD_Remote_Style[p[1]];
+		slot->Run.Table = LCD_Remote_Table;
+		slot->Run.Ids = &p[9]; // 直接引用包缓冲区，不拷贝
+		slot->Run.Count = n;
+		slot->Run.Clear = LCD_Remote_Get16(&p[6]);
+		slot->Seq = LCD_GC_GlyphIds(gc, LCD_Remote_Get16(&p[2]), LCD_Remote_Get16(&p[4]), &slot->Run);
+		LCD_Remote_Issued(slot->Seq, 1);
+		if (slot->Seq != 0)
+			LCD_Remote_TextSeq = slot->Seq;
+		LCD_Remote_RunNext = (uint8_t)((LCD_Remote_RunNext + 1) % LCD_REMOTE_RUNS);
+		LCD_Remote_Stats.Runs++;
+		LCD_Remote_Stats.Glyphs += n;
+		*used = (uint16_t)(9 + n);
+		return LCD_REMOTE_DONE;
+
+	case LCD_REMOTE_FILL:
+		if (avail < 10 || p[1] >= LCD_REMOTE_STYLES)
+			return LCD_REMOTE_ERROR;
+		if (!LCD_Remote_CanPush())
+			return LCD_REMOTE_WAIT;
+		seq = LCD_GC_FillRect(&LCD_Remote_Style[p[1]], LCD_Remote_Get16(&p[2]), LCD_Remote_Get16(&p[4]),
+							  LCD_Remote_Get16(&p[6]), LCD_Remote_Get16(&p[8]));
+		LCD_Remote_Issued(seq, 0); // 填充不引用包缓冲区
+		*used = 10;
+		return LCD_REMOTE_DONE;
+
+	case LCD_REMOTE_CLEAR:
+		if (avail < 2 || p[1] >= LCD_REMOTE_STYLES)
+			return LCD_REMOTE_ERROR;
+		if (!LCD_Remote_CanPush())
+			return LCD_REMOTE_WAIT;
+		LCD_Remote_Issued(LCD_GC_Clear(&LCD_Remote_Style[p[1]]), 0);
+		*used = 2;
+		return LCD_REMOTE_DONE;
+
+	default:
+		return LCD_REMOTE_ERROR;
+	}
+}
+
+/**
+ * @brief  取出下一个待解析的包并校验包头
+ * @retval 1-取到，0-没有
+ */
+static uint8_t LCD_Remote_Next(void)
+{
+	while (LCD_Remote_ReadyOut != LCD_Remote_ReadyIn)
+	{
+		uint8_t index = LCD_Remote_Ready[LCD_Remote_ReadyOut];
+		const uint8_t *pkt = LCD_Remote_Rx[index];
+		uint16_t len, seq, sum = 0;
+
+		LCD_Remote_ReadyOut = (uint8_t)((LCD_Remote_ReadyOut + 1) % (LCD_REMOTE_RX_BUFFS + 1));
+		SCB_InvalidateDCache_by_Addr((uint32_t *)pkt, LCD_REMOTE_RX_BYTES); // DMA写入的数据不经过D-Cache
+
+		len = LCD_Remote_Get16(&pkt[2]);
+		if (LCD_Remote_Len[index] < LCD_REMOTE_HEADER || LCD_Remote_Get16(&pkt[0]) != LCD_REMOTE_MAGIC ||
+			LCD_REMOTE_HEADER + len > LCD_Remote_Len[index])
+		{
+			LCD_Remote_Stats.Errors++;
+			LCD_Remote_State[index] = LCD_REMOTE_FREE;
+			continue;
+		}
+		for (uint16_t i = 0; i < len; i++)
+			sum = (uint16_t)(sum + pkt[LCD_REMOTE_HEADER + i]);
+		if (sum != LCD_Remote_Get16(&pkt[6]))
+		{
+			LCD_Remote_Stats.Errors++;
+			LCD_Remote_State[index] = LCD_REMOTE_FREE;
+			continue;
+		}
+
+		seq = LCD_Remote_Get16(&pkt[4]);
+		if (LCD_Remote_Synced)
+			LCD_Remote_Stats.Lost += (uint16_t)(seq - LCD_Remote_Expect);
+		LCD_Remote_Expect = (uint16_t)(seq + 1);
+		LCD_Remote_Synced = 1;
+
+		LCD_Remote_Cur = index;
+		LCD_Remote_Pos = LCD_REMOTE_HEADER;
+		LCD_Remote_End = (uint16_t)(LCD_REMOTE_HEADER + len);
+		LCD_Remote_Last[index] = 0;
+		LCD_Remote_Stats.Bytes += LCD_REMOTE_HEADER + len;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief  交还引用它的命令都已完成的缓冲区
+ * @retval 仍在等待绘制的缓冲区数
+ */
+static uint8_t LCD_Remote_Reclaim(void)
+{
+	uint8_t held = 0;
+
+	for (uint8_t i = 0; i < LCD_REMOTE_RX_BUFFS; i++)
+	{
+		if (LCD_Remote_State[i] != LCD_REMOTE_HELD)
+			continue;
+		if (LCD_Queue_IsDone(LCD_Remote_Last[i]))
+			LCD_Remote_State[i] = LCD_REMOTE_FREE;
+		else
+			held++;
+	}
+	return held;
+}
+
+/*******************************************************************************
+ *                              公有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  取一个空闲的包缓冲区用于下一次接收
+ */
+uint8_t *LCD_Remote_RxBuffer(void)
+{
+	for (uint8_t i = 0; i < LCD_REMOTE_RX_BUFFS; i++)
+	{
+		if (LCD_Remote_State[i] == LCD_REMOTE_FREE)
+		{
+			LCD_Remote_State[i] = LCD_REMOTE_RECEIVING;
+			return LCD_Remote_Rx[i];
+		}
+	}
+	LCD_Remote_Stats.Overruns++;
+	return NULL;
+}
+
+/**
+ * @brief  一个数据包接收完成
+ */
+void LCD_Remote_RxDone(uint8_t *buf, uint16_t len)
+{
+	uint8_t index;
+
+	if (buf < LCD_Remote_Rx[0] || buf > LCD_Remote_Rx[LCD_REMOTE_RX_BUFFS - 1])
+		return;
+	index = (uint8_t)((buf - LCD_Remote_Rx[0]) / LCD_REMOTE_RX_BYTES);
+	if (LCD_Remote_State[index] != LCD_REMOTE_RECEIVING)
+		return;
+	if (len == 0)
+	{
+		LCD_Remote_State[index] = LCD_REMOTE_FREE;
+		return;
+	}
+	LCD_Remote_Len[index] = (len > LCD_REMOTE_RX_BYTES) ? LCD_REMOTE_RX_BYTES : len;
+	LCD_Remote_State[index] = LCD_REMOTE_READY;
+	LCD_Remote_Ready[LCD_Remote_ReadyIn] = index; // 每个缓冲区最多在环中出现一次，不会溢出
+	LCD_Remote_ReadyIn = (uint8_t)((LCD_Remote_ReadyIn + 1) % (LCD_REMOTE_RX_BUFFS + 1));
+}
+
+/**
+ * @brief  清空对照表和样式表
+ */
+void LCD_Remote_Reset(void)
+{
+	for (uint16_t i = 0; i < 256; i++)
+		LCD_Remote_Table[i] = ' ';
+	for (uint8_t i = 0; i < LCD_REMOTE_STYLES; i++)
+		LCD_GC_Init(&LCD_Remote_Style[i]);
+	LCD_Remote_Synced = 0;
+	LCD_Remote_Inited = 1;
+}
+
+/**
+ * @brief  交还已画完的包缓冲区，解析下一个数据包
+ */
+uint8_t LCD_Remote_Task(void)
+{
+	uint8_t held = LCD_Remote_Reclaim();
+
+	if (!LCD_Remote_Inited)
+		LCD_Remote_Reset();
+	if (LCD_Remote_Cur == LCD_REMOTE_NONE && !LCD_Remote_Next())
+		return held != 0;
+
+	while (LCD_Remote_Pos < LCD_Remote_End)
+	{
+		uint16_t used = 0;
+		uint8_t res = LCD_Remote_Record(&LCD_Remote_Rx[LCD_Remote_Cur][LCD_Remote_Pos],
+										(uint16_t)(LCD_Remote_End - LCD_Remote_Pos), &used);
+
+		if (res == LCD_REMOTE_WAIT)
+		{
+			LCD_Remote_Stats.Stalls++;
+			return 1;
+		}
+		if (res == LCD_REMOTE_ERROR)
+		{
+			LCD_Remote_Stats.Errors++; // 已执行的记录保留，丢弃其余部分
+			break;
+		}
+		LCD_Remote_Pos += used;
+		LCD_Remote_Stats.Records++;
+	}
+
+	LCD_Remote_Stats.Packets++;
+	LCD_Remote_State[LCD_Remote_Cur] = LCD_Queue_IsDone(LCD_Remote_Last[LCD_Remote_Cur]) ? LCD_REMOTE_FREE
+																						 : LCD_REMOTE_HELD;
+	LCD_Remote_Cur = LCD_REMOTE_NONE;
+	return 1;
+}
+
+/**
+ * @brief  读取远程显示统计
+ */
+void LCD_Remote_GetStats(LCD_Remote_Stats_t *stats, uint8_t reset)
+{
+	*stats = LCD_Remote_Stats;
+	if (reset)
+		memset(&LCD_Remote_Stats, 0, sizeof(LCD_Remote_Stats));
+}
+
+#endif /* LCD_REMOTE_ENABLE */
@@ -0,0 +1,139 @@
+/**
+ ******************************************************************************
+ * @file    lcd_remote.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   远程文本显示协议头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 上位机不再发送GBK字符串，而是发送紧凑的二进制显示命令：会话开始时定义字符对照表
+ *   (1字节编号 → Unicode码点)和样式表(字号、颜色、字符模式)，之后每段文字只有
+ *   样式号、坐标、补齐宽度和每字1字节的编号
+ * - 串口DMA直接收进 LCD_REMOTE_RX_BUFFS 个包缓冲区，LCD_Remote_Task() 在主循环中解析：
+ *   文字记录不拷贝、不解码，以指向包缓冲区中编号的 LCD_GlyphIds_t 经 LCD_GC_GlyphIds()
+ *   排入命令队列；包缓冲区在引用它的最后一条命令完成后才交还接收
+ * - 增量更新由上位机完成：只发送内容变化的文字段，补齐宽度覆盖旧内容，变短的文字不需要先清除
+ * - 对照表被仍在队列中的文字引用时，重新定义对照表的记录等这些文字画完再执行，解析暂停，
+ *   不阻塞主循环；命令描述环或队列(LCD_QUEUE_SERVER)已满时同样暂停
+ * - 每包须在一次接收中收完(包之间留出串口空闲)，不超过 LCD_REMOTE_RX_BYTES；
+ *   包头校验不符的包整包丢弃，序号不连续时计入 Lost，上位机可定期重发整屏
+ * - 需要UTF-8 Flash字库；由 init.h 中的 LCD_REMOTE_ENABLE 控制
+ *
+ * 数据包格式(小端)：
+ *     包头 uint16 magic 0x524C("LR"), uint16 记录字节数, uint16 序号, uint16 记录所有字节之和
+ *     记录 依次排列，每条以1字节类型开头：
+ *          LCD_REMOTE_RESET  清空对照表(全部为空格)和样式表(LCD_GC_Init())
+ *          LCD_REMOTE_GLYPHS uint8 起始编号, uint8 个数n, n个uint16码点
+ *          LCD_REMOTE_STYLE  uint8 样式号, uint8 字号, uint8 字符模式, 画笔色R,G,B, 背景色R,G,B
+ *          LCD_REMOTE_TEXT   uint8 样式号, uint16 x, uint16 y, uint16 补齐宽度, uint8 字数n, n个uint8编号
+ *          LCD_REMOTE_FILL   uint8 样式号, uint16 x, uint16 y, uint16 宽, uint16 高(用画笔色填充)
+ *          LCD_REMOTE_CLEAR  uint8 样式号(用背景色清屏)
+ *
+ * 使用示例(串口空闲中断+DMA接收，关闭半传输中断)：
+ *     void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+ *         uint8_t *next;
+ *         LCD_Remote_RxDone(huart->pRxBuffPtr, Size);
+ *         next = LCD_Remote_RxBuffer();   // 没有空闲缓冲区时返回NULL，主循环中再启动接收
+ *         if (next != NULL && HAL_UARTEx_ReceiveToIdle_DMA(huart, next, LCD_REMOTE_RX_BYTES) == HAL_OK)
+ *             __HAL_DMA_DISABLE_IT(huart->hdmarx, DMA_IT_HT);
+ *     }
+ *     // 包缓冲区需用 LCD_REMOTE_ATTR 放到串口DMA可访问的RAM
+ *
+ ******************************************************************************
+ */
+
+#ifndef __LCD_REMOTE_H
+#define __LCD_REMOTE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "lcd_spi.h"
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define LCD_REMOTE_RX_BUFFS 4        /*!< 包缓冲区个数，解析和等待绘制期间可以继续接收的包数 */
+#define LCD_REMOTE_RX_BYTES 512      /*!< 每个包缓冲区的字节数(32的倍数)，即最大包长 */
+#define LCD_REMOTE_RUNS 32           /*!< 文字段描述环的项数，即同时排在队列中的远程文字段上限 */
+#define LCD_REMOTE_STYLES 8          /*!< 样式表项数 */
+#define LCD_REMOTE_TASK_MS 2         /*!< 调度器调用 LCD_Remote_Task() 的周期(ms) */
+#define LCD_REMOTE_MAGIC 0x524C      /*!< 包头魔数 "LR" */
+#ifndef LCD_REMOTE_ATTR
+#define LCD_REMOTE_ATTR /*!< 包缓冲区存放位置，默认RAM(DTCM)；串口DMA接收时改为 AXI_SRAM_AT(地址) */
+#endif
+
+#define LCD_REMOTE_RESET 0x00  /*!< 记录类型：会话开始 */
+#define LCD_REMOTE_GLYPHS 0x01 /*!< 记录类型：定义对照表 */
+#define LCD_REMOTE_STYLE 0x02  /*!< 记录类型：定义样式 */
+#define LCD_REMOTE_TEXT 0x03   /*!< 记录类型：文字段 */
+#define LCD_REMOTE_FILL 0x04   /*!< 记录类型：填充矩形 */
+#define LCD_REMOTE_CLEAR 0x05  /*!< 记录类型：清屏 */
+
+    /*******************************************************************************
+     *                          结构定义
+     ******************************************************************************/
+
+    /**
+     * @brief  远程显示统计
+     */
+    typedef struct
+    {
+        uint32_t Packets;  /*!< 解析完的数据包数 */
+        uint32_t Bytes;    /*!< 解析的字节数(含包头) */
+        uint32_t Records;  /*!< 执行的记录数 */
+        uint32_t Runs;     /*!< 排入的文字段数 */
+        uint32_t Glyphs;   /*!< 排入的字符数 */
+        uint32_t Errors;   /*!< 包头或记录格式错误而丢弃的包数 */
+        uint32_t Lost;     /*!< 按序号推算丢失的包数 */
+        uint32_t Stalls;   /*!< 等待已排入的文字画完而暂停解析的次数 */
+        uint32_t Overruns; /*!< LCD_Remote_RxBuffer() 没有空闲缓冲区的次数 */
+        uint32_t Dropped;  /*!< 队列拒绝(返回0)的命令数 */
+    } LCD_Remote_Stats_t;
+
+    /*******************************************************************************
+     *                          函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  取一个空闲的包缓冲区用于下一次接收
+     * @note   可在中断中调用；返回的缓冲区在 LCD_Remote_RxDone() 之前属于接收方
+     * @retval 缓冲区(LCD_REMOTE_RX_BYTES 字节)，全部在使用中时返回NULL
+     */
+    uint8_t *LCD_Remote_RxBuffer(void);
+
+    /**
+     * @brief  一个数据包接收完成，在接收中断中调用
+     * @param  buf: LCD_Remote_RxBuffer() 返回的缓冲区
+     * @param  len: 收到的字节数，0时直接交还缓冲区
+     */
+    void LCD_Remote_RxDone(uint8_t *buf, uint16_t len);
+
+    /**
+     * @brief  清空对照表(全部为空格)和样式表，下一个包的序号不计入丢包
+     * @note   上位机重新连接时调用(先 LCD_Queue_Wait() 等已排入的文字画完)；LCD_REMOTE_RESET 记录会自行等待
+     */
+    void LCD_Remote_Reset(void);
+
+    /**
+     * @brief  交还已画完的包缓冲区，解析下一个数据包，由调度器每 LCD_REMOTE_TASK_MS 调用
+     * @retval 1-还有未解析或未画完的数据包，0-空闲
+     */
+    uint8_t LCD_Remote_Task(void);
+
+    /**
+     * @brief  读取远程显示统计
+     * @param  stats: 输出
+     * @param  reset: 1-读取后清零
+     */
+    void LCD_Remote_GetStats(LCD_Remote_Stats_t *stats, uint8_t reset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LCD_REMOTE_H */
@@ -14,27 +14,113 @@
  */
 
 #include "lcd_spi.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
 #ifdef LCD_SPI_ENABLE
 
 extern SPI_HandleTypeDef hspi6; // SPI_HandleTypeDef 结构体变量
 
-#define LCD_SPI hspi6 // SPI局部宏，方便修改和移植
+// 每块屏幕的总线、引脚和状态：屏幕0为SPI6上的原有屏幕，其余由 LCD_Panel_Add() 添加；
+// 绘制函数都作用于 LCD_Cur，字体、颜色和渲染缓冲区各屏幕共用
+typedef struct
+{
+	LCD_PanelConfig_t Cfg; // 总线、引脚、控制器，以及竖屏时的尺寸和偏移
+	uint8_t Index;		   // 在 LCD_Panels 中的序号
+	uint8_t Direction;	   // 未选中时保存的显示方向，以及该方向下的尺寸和偏移
+	uint16_t Width;
+	uint16_t Height;
+	uint8_t X_Offset;
+	uint8_t Y_Offset;
+	uint32_t WinCol;	// 屏幕控制器当前窗口的模型，见 LCD_Win_Col
+	uint32_t WinRow;
+	uint32_t WinPos;
+	uint8_t WinWriting;
+	uint16_t ScrollTop; // 硬件滚动区，见 LCD_Scroll_Top
+	uint16_t ScrollHeight;
+	uint16_t ScrollLineH;
+	uint16_t ScrollOffset;
+#ifdef LCD_RGB444_ENABLE
+	uint8_t PixelFormat; // 接口像素格式，见 LCD_PIXEL_444
+	uint8_t Buf444;		 // 下一次使用的打包缓冲区
+	uint16_t Pend444;	 // 凑不成一帧、留给下一段的像素(LCD_444_PEND | 12位颜色)，0表示没有
+	uint16_t First444;	 // 当前窗口第一个像素的12位颜色
+#endif
+#ifdef LCD_SPI_DMA_ENABLE
+	const uint16_t *volatile DmaTxBuff; // 见 LCD_DMA_TxBuff
+	volatile uint32_t DmaFillLeft;
+	uint8_t DmaMode;
+#endif
+} LCD_Panel_t;
+
+static LCD_Panel_t LCD_Panels[LCD_PANEL_MAX] = {
+	{{&hspi6, LCD_DC_PORT, LCD_DC_PIN, LCD_Backlight_PORT, LCD_Backlight_PIN, LCD_Width, LCD_Height, 0, 0, LCD_CONTROLLER},
+	 0, Direction_V, LCD_Width, LCD_Height, 0, 0, 0xFFFFFFFF, 0xFFFFFFFF}};
+static uint8_t LCD_PanelCount = 1;				 // 已添加的屏幕数
+static LCD_Panel_t *LCD_Cur = &LCD_Panels[0];	 // 当前绘制的屏幕，完成中断处理期间临时指向中断所属的屏幕
+
+#ifdef LCD_FMC_ENABLE
+static LCD_Panel_t *LCD_Fmc_Panel = NULL; // 接在FMC上的屏幕，最多一块，NULL表示没有
+#define LCD_IS_FMC() (LCD_Cur->Cfg.Spi == NULL) // 当前屏幕为FMC并口屏，指令和像素直接写FMC地址
+#endif
+
+#define LCD_SPI (*LCD_Cur->Cfg.Spi) // SPI局部宏，方便修改和移植
+#define LCD_CTRL (LCD_Cur->Cfg.Ctrl) // 当前屏幕的控制器描述表
+
+#define LCD_DC_Command HAL_GPIO_WritePin(LCD_Cur->Cfg.DcPort, LCD_Cur->Cfg.DcPin, GPIO_PIN_RESET); // 低电平，指令传输
+#define LCD_DC_Data HAL_GPIO_WritePin(LCD_Cur->Cfg.DcPort, LCD_Cur->Cfg.DcPin, GPIO_PIN_SET);	   // 高电平，数据传输
+#define LCD_Backlight_OFF HAL_GPIO_WritePin(LCD_Cur->Cfg.BlPort, LCD_Cur->Cfg.BlPin, GPIO_PIN_RESET); // 低电平，关闭背光
+#define LCD_Backlight_ON HAL_GPIO_WritePin(LCD_Cur->Cfg.BlPort, LCD_Cur->Cfg.BlPin, GPIO_PIN_SET);	  // 高电平，开启背光
 
-static pFONT *LCD_AsciiFonts; // 英文字体，ASCII字符集
-static pFONT *LCD_CHFonts;	  // 中文字体（同时也包含英文字体）
+// 写SPI发送寄存器，主机仿真(Tools/HostSim)把它们重定义为记录像素流
+#ifndef LCD_SPI_WRITE_TXDR32
+#define LCD_SPI_WRITE_TXDR32(hspi, v) (*((__IO uint32_t *)&(hspi)->Instance->TXDR) = (v))
+#endif
+#ifndef LCD_SPI_WRITE_TXDR16
+#define LCD_SPI_WRITE_TXDR16(hspi, v) (*((__IO uint16_t *)&(hspi)->Instance->TXDR) = (v))
+#endif
+#ifndef LCD_SPI_WRITE_TXDR8
+#define LCD_SPI_WRITE_TXDR8(hspi, v) (*((__IO uint8_t *)&(hspi)->Instance->TXDR) = (v))
+#endif
+#define LCD_SPI_FIFO_BYTES 8 // SPI6的FIFO深度，指令参数不超过它时一次写入
+
+#define LCD_SPI_TIMEOUT_POLLS 1024U // 寄存器级发送循环中TXP未置位时，每轮询这么多次检查一次超时(2的幂)
+#define LCD_SPI_TSIZE_MAX 0xFFFEUL	 // 寄存器级发送每段的数据个数：TSIZE/TSER只有16位，取偶数使32位写入不跨段
+
+#define LCD_PERF_TX(bytes)               \
+	do                                   \
+	{                                    \
+		PERF_COUNT(spi_transfers);       \
+		PERF_ADD(spi_bytes, bytes);      \
+	} while (0) // 热点计数：一次SPI传输, 未定义 PERF_STATS_ENABLE 时为空
+
+static const pFONT *LCD_AsciiFonts; // 英文字体，ASCII字符集
+static const pFONT *LCD_CHFonts;	  // 中文字体（同时也包含英文字体）
 
 // 因为这类SPI的屏幕，每次更新显示时，需要先配置坐标区域、再写显存，
 // 在显示字符时，如果是一个个点去写坐标写显存，会非常慢，
 // 因此开辟一片缓冲区，先将需要显示的数据写进缓冲区，最后再批量写入显存。
-// 用户可以根据实际情况去修改此处缓冲区的大小，
+// 用户可以在 lcd_spi.h 中通过 LCD_BUFF_PIXELS 修改缓冲区的大小，
 // 例如，用户需要显示32*32的汉字时，需要的大小为 32*32*2 = 2048 字节（每个像素点占2字节）
-uint16_t LCD_Buff[1024]; // LCD缓冲区，16位宽（每个像素点占2字节）
+// 启用 LCD_SPI_DMA_ENABLE 时位于SRAM4，供BDMA直接读取；
+// 多个缓冲区轮流使用，一个在发送时CPU可以向另一个写入下一批数据；
+// 每个缓冲区按Cache行对齐且长度为32字节的倍数，清理/失效时不会波及相邻变量
+#if (LCD_BUFF_PIXELS * 2) % 32 != 0
+#error "LCD_BUFF_PIXELS 必须是16的倍数(每个缓冲区占整数个Cache行)"
+#endif
+LCD_DMA_BUFF_ATTR uint16_t LCD_Buff[LCD_BUFF_COUNT][LCD_BUFF_PIXELS] DMA_ALIGNED; // LCD缓冲区，16位宽（每个像素点占2字节）
+static uint8_t LCD_BuffIndex = 0;									  // 最近一次取得的缓冲区序号
 
 struct // LCD相关参数结构体
 {
 	uint32_t Color;		  //	LCD当前画笔颜色
 	uint32_t BackColor;	  //	背景色
 	uint8_t ShowNum_Mode; // 数字显示模式
+	uint8_t Text_Mode;	  // 字符背景模式
+	uint8_t Text_Scale;	  // ASCII字符放大倍数，0和1都表示不放大
+	uint8_t Text_Effect;  // 文本效果(Text_EffectBold等的组合)
+	uint16_t Effect_Color; // 描边/阴影颜色(RGB565)
 	uint8_t Direction;	  //	显示方向
 	uint16_t Width;		  // 屏幕像素长度
 	uint16_t Height;	  // 屏幕像素宽度
@@ -42,23 +128,163 @@ struct // LCD相关参数结构体
 	uint8_t Y_Offset;	  // Y坐标偏移，用于设置屏幕控制器的显存写入方式
 } LCD;
 
+#ifdef LCD_TEXT_SCALE_ENABLE
+#define LCD_ASCII_SCALE ((LCD.Text_Scale > 1) ? LCD.Text_Scale : 1) // ASCII字符当前的放大倍数
+#else
+#define LCD_ASCII_SCALE 1
+#endif
+
+#ifdef LCD_TEXT_EFFECT_ENABLE
+#define LCD_TEXT_EFFECT() (LCD.Text_Effect) // 当前文本效果，有效果时只用1bpp字模
+#else
+#define LCD_TEXT_EFFECT() Text_EffectNone
+#endif
+
+// 1bpp字模展开查找表：每个半字节(4个像素)对应两个32位字，低半字为靠前的像素
+// 字模按行存储、每行字节对齐、低位在前，表项在画笔色或背景色改变后首次使用时重建
+DTCM_BSS static uint32_t Expand_LUT[16][2];
+static uint8_t Expand_LUT_Valid = 0; // 0表示颜色已改变，需要重建
+static uint32_t Expand_LUT_Key = 0;  // 当前展开表的颜色组合(画笔色<<16 | 背景色)，清零的表即黑底黑字的表
+DTCM_BSS static uint32_t Expand_LUT_Saved[LCD_LUT_CACHE][16][2]; // 最近用过的几份展开表，按颜色组合取回
+static uint32_t Expand_LUT_SavedKey[LCD_LUT_CACHE];
+static uint8_t Expand_LUT_SavedCount = 0; // 已保存的份数
+static uint8_t Expand_LUT_SavedNext = 0;  // 下一份覆盖的位置(轮换)
+
+// 调色板：预定义颜色在编译期转换为RGB565，LCD_PAL_USER 起的项由 LCD_SetPaletteColor() 设置
+static uint16_t LCD_Palette[LCD_PALETTE_SIZE] = {
+	LCD_RGB565(LCD_WHITE), LCD_RGB565(LCD_BLACK), LCD_RGB565(LCD_BLUE), LCD_RGB565(LCD_GREEN),
+	LCD_RGB565(LCD_RED), LCD_RGB565(LCD_CYAN), LCD_RGB565(LCD_MAGENTA), LCD_RGB565(LCD_YELLOW),
+	LCD_RGB565(LCD_GREY), LCD_RGB565(LIGHT_BLUE), LCD_RGB565(LIGHT_GREEN), LCD_RGB565(LIGHT_RED),
+	LCD_RGB565(LIGHT_CYAN), LCD_RGB565(LIGHT_MAGENTA), LCD_RGB565(LIGHT_YELLOW), LCD_RGB565(LIGHT_GREY),
+	LCD_RGB565(DARK_BLUE), LCD_RGB565(DARK_GREEN), LCD_RGB565(DARK_RED), LCD_RGB565(DARK_CYAN),
+	LCD_RGB565(DARK_MAGENTA), LCD_RGB565(DARK_YELLOW), LCD_RGB565(DARK_GREY)};
+#ifdef LCD_EXPAND_FIXED_ENABLE
+static void Expand_SelectFonts(void); // 字体切换后选择固定宽度的展开函数
+#endif
+static uint8_t LCD_FontForSize(uint8_t font_size, const pFONT **ascii, const pFONT **ch); // 字号对应的字体
+static void LCD_Text_Render(uint16_t x, uint16_t y, const char *pText);     // LCD_DisplayText() 的排版和绘制
+static uint16_t LCD_Text_SumN(const char *p, uint16_t limit, uint16_t *bytes); // 字符串前 limit 字节的校验和
+#if defined(USE_FLASH_FONT) && defined(LCD_NUM_ATLAS_ENABLE)
+static uint8_t LCD_NumAtlas_Draw(uint16_t x, uint16_t y, const char *p, uint8_t text); // 数字串从图集整串发送
+#define LCD_NUM_ATLAS_DRAW(x, y, p, text) LCD_NumAtlas_Draw(x, y, p, text)
+#else
+#define LCD_NUM_ATLAS_DRAW(x, y, p, text) 0
+#endif
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312) && defined(LCD_TEXT_MEMO_ENABLE)
+#define LCD_MEMO_ZSTR 0xFFFF // LCD_TextMemo_Draw() 的 limit：到结束符为止
+static uint8_t LCD_TextMemo_Draw(uint16_t x, uint16_t y, const char *p, uint16_t limit); // 用缓存的解析结果绘制
+#endif
+
+#if defined(USE_FLASH_FONT) && defined(FLASH_FONT_AA_ENABLE)
+// 抗锯齿字模的16级色阶：背景色到画笔色的RGB565插值，与展开表同时重建，绘制时只查表
+static uint16_t AA_Ramp[16];
+static uint16_t AA_Ramp_Saved[LCD_LUT_CACHE][16]; // 与 Expand_LUT_Saved 一一对应
+#endif
+
 // 该函数修改于HAL的SPI库函数，专为 LCD_Clear() 清屏函数修改，
 // 目的是为了SPI传输数据不限数据长度的写入
 HAL_StatusTypeDef LCD_SPI_Transmit(SPI_HandleTypeDef *hspi, uint16_t pData, uint32_t Size);
 HAL_StatusTypeDef LCD_SPI_TransmitBuffer(SPI_HandleTypeDef *hspi, uint16_t *pData, uint32_t Size);
+void LCD_WriteBuff(uint16_t *DataBuff, uint16_t DataSize);
+HAL_StatusTypeDef LCD_SPI_WaitOnFlagUntilTimeout(SPI_HandleTypeDef *hspi, uint32_t Flag, FlagStatus Status,
+												 uint32_t Tickstart, uint32_t Timeout);
+void LCD_SPI_CloseTransfer(SPI_HandleTypeDef *hspi);
+
+#ifdef LCD_SPI_DMA_ENABLE
+#define LCD_DMA_TxBuff (LCD_Cur->DmaTxBuff)	  // 正在由DMA发送的缓冲区，NULL表示空闲
+#define LCD_DMA_FillLeft (LCD_Cur->DmaFillLeft) // 同色填充尚未启动的像素数，由完成中断接续
+static const uint16_t LCD_SPI_EotMark = 0;
+#define LCD_SPI_EOT_WAIT (&LCD_SPI_EotMark) // LCD_DMA_TxBuff 的取值：寄存器级发送已写完FIFO，等待EOT中断
+LCD_FILL_ATTR static uint32_t LCD_DMA_FillWords[LCD_PANEL_MAX][8] DMA_ALIGNED; // 同色填充的源数据，颜色重复两次，每块屏幕独占一个Cache行
+#define LCD_DMA_FillWord (LCD_DMA_FillWords[LCD_Cur->Index])
+
+// BDMA通道的工作方式，发送缓冲区与同色填充共用一个通道，启动前按需切换
+#define LCD_DMA_MODE_BUFF 0	  // 源地址递增，16位
+#define LCD_DMA_MODE_FILL32 1 // 源地址固定，32位(一次2个像素)
+#define LCD_DMA_MODE_FILL16 2 // 源地址固定，16位
+#define LCD_DMA_MODE_BUFF32 3 // 源地址递增，32位(一项2个像素，SPI打包为两个16位以内的帧)
+#define LCD_DMA_Mode (LCD_Cur->DmaMode) // 初值0即 LCD_DMA_MODE_BUFF
+
+// 异步复制(LCD_CopyBufferAsync)：源数据分段发送，每段的完成中断启动下一段，最后一段结束后调用完成回调
+static LCD_CopyDone_t volatile LCD_Copy_Done = NULL; // 完成回调，非NULL表示复制正在进行，占用全部渲染缓冲区
+static LCD_Panel_t *LCD_Copy_Panel;					 // 复制的目标屏幕，同一时间只有一块屏幕在复制
+static void *LCD_Copy_Arg;							 // 完成回调的参数
+static const uint16_t *LCD_Copy_Src;				 // 下一段的源地址
+static uint32_t LCD_Copy_Left;						 // 尚未取出的像素数
+static uint16_t *LCD_Copy_Buff;						 // 已准备好、等待发送的一段
+static uint16_t LCD_Copy_Count;						 // 等待发送的像素数，0表示没有
+static uint8_t LCD_Copy_Index;						 // 下一段使用的渲染缓冲区序号
+
+static HAL_StatusTypeDef LCD_Copy_Send(void);
+
+#ifdef LCD_FMC_ENABLE
+// FMC屏的MDMA发送：源数据不必在SRAM4，超过一个块(64KB)的像素在完成中断中分段接续
+#define LCD_FMC_SEG_PIXELS 32768U // 每段的最多像素数
+
+static MDMA_HandleTypeDef LCD_Fmc_Mdma;	  // FMC屏的MDMA句柄
+static uint8_t LCD_Fmc_MdmaState = 0;	  // 0-未初始化，1-可用，2-初始化失败
+static const uint16_t *LCD_Fmc_Src;		  // 下一段的源地址
+static uint32_t LCD_Fmc_Left;			  // 尚未启动的像素数
+static LCD_CopyDone_t LCD_Fmc_Done;		  // 异步复制的完成回调，不占用渲染缓冲区
+static void *LCD_Fmc_Arg;				  // 完成回调的参数
+
+static void LCD_Fmc_Finish(uint8_t ok);
+#endif
+
+#define LCD_IS_DMA_RAM(p) (((uintptr_t)(p) - LCD_DMA_RAM_BASE) < LCD_DMA_RAM_SIZE) // 是否位于SRAM4
+#define LCD_COPY_DONE() ((LCD_Copy_Panel == LCD_Cur) ? LCD_Copy_Done : NULL) // 当前屏幕的异步复制的完成回调
+
+/**
+ * @brief  等待要改写的缓冲区发送结束
+ * @note   渲染缓冲区各屏幕共用，只有它正在某块屏幕上发送(或异步复制占用全部缓冲区)时才等待那块屏幕
+ */
+ITCM_CODE static inline void LCD_WaitBuff(const uint16_t *p)
+{
+	LCD_Panel_t *cur = LCD_Cur;
+
+	for (uint8_t i = 0; i < LCD_PanelCount; i++)
+	{
+		if (LCD_Panels[i].DmaTxBuff == p || (LCD_Copy_Done != NULL && LCD_Copy_Panel == &LCD_Panels[i]))
+		{
+			LCD_Cur = &LCD_Panels[i];
+			LCD_WaitIdle();
+			LCD_Cur = cur;
+		}
+	}
+}
+#else
+#define LCD_WaitBuff(p) ((void)0)
+#endif
+
+/**
+ * @brief  取得下一个渲染缓冲区
+ * @note   缓冲区轮流使用，正在发送的缓冲区要等传输结束后才会再次返回
+ */
+static uint16_t *LCD_NextBuff(void)
+{
+	uint16_t *pBuff;
+
+	LCD_BuffIndex = (uint8_t)((LCD_BuffIndex + 1) % LCD_BUFF_COUNT);
+	pBuff = LCD_Buff[LCD_BuffIndex];
+	LCD_WaitBuff(pBuff);
+	return pBuff;
+}
 
 /****************************************************************************************************************************************
  *	函 数 名:	LCD_GPIO_Init
  *
- *	函数功能:	初始化 背光 引脚 、 数据指令选择 引脚
+ *	函数功能:	初始化当前屏幕的 背光 引脚 、 数据指令选择 引脚
  ****************************************************************************************************************************************/
 
 void LCD_GPIO_Init(void)
 {
 	GPIO_InitTypeDef GPIO_InitStruct = {0};
 
-	GPIO_LDC_Backlight_CLK_ENABLE; // 使能 背光        引脚时钟
-	GPIO_LDC_DC_CLK_ENABLE;		   // 使能 数据指令选择 引脚时钟
+	if (LCD_Cur == &LCD_Panels[0]) // 其他屏幕的引脚时钟由CubeMX生成的 MX_GPIO_Init() 打开
+	{
+		GPIO_LDC_Backlight_CLK_ENABLE; // 使能 背光        引脚时钟
+		GPIO_LDC_DC_CLK_ENABLE;		   // 使能 数据指令选择 引脚时钟
+	}
 
 	/******************************************************
 
@@ -68,1306 +294,13601 @@ void LCD_GPIO_Init(void)
 	*******************************************************/
 
 	// 初始化 背光 引脚
-	GPIO_InitStruct.Pin = LCD_Backlight_PIN;			 // 背光 引脚
-	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;			 // 推挽输出模式
-	GPIO_InitStruct.Pull = GPIO_NOPULL;					 // 无上下拉
-	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;		 // 速度等级低
-	HAL_GPIO_Init(LCD_Backlight_PORT, &GPIO_InitStruct); // 初始化
+	GPIO_InitStruct.Pin = LCD_Cur->Cfg.BlPin;			  // 背光 引脚
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;			  // 推挽输出模式
+	GPIO_InitStruct.Pull = GPIO_NOPULL;					  // 无上下拉
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;		  // 速度等级低
+	HAL_GPIO_Init(LCD_Cur->Cfg.BlPort, &GPIO_InitStruct); // 初始化
+
+	if (LCD_Cur->Cfg.DcPort == NULL) // FMC屏的RS由FMC地址线输出
+		return;
 
 	// 初始化 数据指令选择 引脚
-	GPIO_InitStruct.Pin = LCD_DC_PIN;			  // 数据指令选择 引脚
-	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;	  // 推挽输出模式
-	GPIO_InitStruct.Pull = GPIO_NOPULL;			  // 无上下拉
-	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;  // 速度等级低
-	HAL_GPIO_Init(LCD_DC_PORT, &GPIO_InitStruct); // 初始化
+	GPIO_InitStruct.Pin = LCD_Cur->Cfg.DcPin;			  // 数据指令选择 引脚
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;			  // 推挽输出模式
+	GPIO_InitStruct.Pull = GPIO_NOPULL;					  // 无上下拉
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;		  // 速度等级低
+	HAL_GPIO_Init(LCD_Cur->Cfg.DcPort, &GPIO_InitStruct); // 初始化
 }
 
 /****************************************************************************************************************************************
- *	函 数 名: LCD_WriteCommand
+ *	函 数 名: LCD_SPI_SetDataSize
  *
- *	入口参数: lcd_command - 需要写入的控制指令
+ *	入口参数: DataSize - SPI_DATASIZE_8BIT 或 SPI_DATASIZE_16BIT
  *
- *	函数功能: 用于向屏幕控制器写入指令
+ *	函数功能: 快速切换SPI数据宽度
+ *
+ *	说    明: 1. 只在SPI空闲(SPE=0)时修改 CFG1.DSIZE，并同步句柄中的 Init.DataSize，
+ *				   不再调用 HAL_SPI_Init() 重新初始化整个外设
+ *				2. HAL的阻塞传输在结束时都会关闭SPE，因此两次传输之间可以直接切换
+ *				3. 寄存器级发送(LCD_SPI_Transmit 等)在EOT中断中才关闭SPE，宽度不变时也先等它结束，
+ *				   之后的 HAL_SPI_Transmit() 不会因为句柄忙而失败
  *
  ****************************************************************************************************************************************/
 
-void LCD_WriteCommand(uint8_t lcd_command)
+static void LCD_SPI_SetDataSize(uint32_t DataSize)
 {
-	LCD_DC_Command; // 数据指令选择 引脚输出低电平，代表本次传输 指令
+#ifdef LCD_SPI_DMA_ENABLE
+	if (LCD_DMA_TxBuff == LCD_SPI_EOT_WAIT) // 寄存器级发送的最后几个数据还在FIFO中，之后的HAL传输也要等它结束
+		LCD_WaitIdle();
+#endif
+	if (LCD_SPI.Init.DataSize == DataSize) // 宽度未改变
+		return;
 
-	HAL_SPI_Transmit(&LCD_SPI, &lcd_command, 1, 1000); // 启动SPI传输
+	__HAL_SPI_DISABLE(&LCD_SPI);							 // DSIZE 只能在SPI关闭时修改
+	MODIFY_REG(LCD_SPI.Instance->CFG1, SPI_CFG1_DSIZE, DataSize); // 写入新的数据宽度
+	LCD_SPI.Init.DataSize = DataSize;						 // HAL传输函数根据此值选择打包方式
+	PERF_COUNT(spi_reconfigs);
 }
 
-/****************************************************************************************************************************************
- *	函 数 名: LCD_WriteData_8bit
- *
- *	入口参数: lcd_data - 需要写入的数据，8位
- *
- *	函数功能: 写入8位数据
- *
- ****************************************************************************************************************************************/
-
-void LCD_WriteData_8bit(uint8_t lcd_data)
+#ifdef LCD_SPI_DMA_ENABLE
+#ifndef LCD_SPI_DMA_SET_MODE
+/**
+ * @brief  修改当前屏幕DMA通道的源地址递增与数据宽度
+ * @note   只在通道关闭时(两次传输之间)调用，同时修改句柄中的Init，
+ *         HAL_SPI_Transmit_DMA() 按 MemDataAlignment 计算传输项数
+ */
+static void LCD_SPI_DMASetMode(uint8_t mode)
 {
-	LCD_DC_Data; // 数据指令选择 引脚输出高电平，代表本次传输 数据
+	DMA_HandleTypeDef *hdma = LCD_SPI.hdmatx;
+	uint32_t ccr, sxcr;
 
-	HAL_SPI_Transmit(&LCD_SPI, &lcd_data, 1, 1000); // 启动SPI传输
+	if (mode == LCD_DMA_MODE_FILL32 || mode == LCD_DMA_MODE_BUFF32)
+	{
+		ccr = BDMA_CCR_PSIZE_1 | BDMA_CCR_MSIZE_1; // 32位
+		sxcr = DMA_SxCR_PSIZE_1 | DMA_SxCR_MSIZE_1;
+		hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+		hdma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	}
+	else
+	{
+		ccr = BDMA_CCR_PSIZE_0 | BDMA_CCR_MSIZE_0; // 16位
+		sxcr = DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0;
+		hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+		hdma->Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	}
+	if (mode == LCD_DMA_MODE_BUFF || mode == LCD_DMA_MODE_BUFF32)
+	{
+		ccr |= BDMA_CCR_MINC;
+		sxcr |= DMA_SxCR_MINC;
+		hdma->Init.MemInc = DMA_MINC_ENABLE;
+	}
+	else
+	{
+		hdma->Init.MemInc = DMA_MINC_DISABLE;
+	}
+	if (IS_BDMA_CHANNEL_INSTANCE(hdma->Instance)) // SPI6
+		MODIFY_REG(((BDMA_Channel_TypeDef *)hdma->Instance)->CCR, BDMA_CCR_MINC | BDMA_CCR_PSIZE | BDMA_CCR_MSIZE, ccr);
+	else // 其他屏幕的SPI1~5使用DMA1/DMA2的数据流
+		MODIFY_REG(((DMA_Stream_TypeDef *)hdma->Instance)->CR, DMA_SxCR_MINC | DMA_SxCR_PSIZE | DMA_SxCR_MSIZE, sxcr);
 }
+#define LCD_SPI_DMA_SET_MODE(mode) LCD_SPI_DMASetMode(mode)
+#endif
 
-/****************************************************************************************************************************************
- *	函 数 名: LCD_WriteData_16bit
- *
- *	入口参数: lcd_data - 需要写入的数据，16位
- *
- *	函数功能: 写入16位数据
- *
- ****************************************************************************************************************************************/
+/**
+ * @brief  按需切换BDMA通道的工作方式
+ */
+ITCM_CODE static void LCD_DMA_SetMode(uint8_t mode)
+{
+	if (LCD_DMA_Mode != mode)
+	{
+		LCD_SPI_DMA_SET_MODE(mode);
+		LCD_DMA_Mode = mode;
+	}
+}
 
-void LCD_WriteData_16bit(uint16_t lcd_data)
+/**
+ * @brief  发送缓冲区时的BDMA工作方式
+ * @note   SPI6最大只支持16位帧，不能直接用32位帧一次发2个像素；FIFO阈值大于1个数据时
+ *         SPI支持数据打包，一次32位写入 TXDR 自动拆成两个帧(低半字先发)，因此缓冲区
+ *         4字节对齐且像素数为偶数时按32位传输，DMA请求和总线访问减半
+ */
+ITCM_CODE static inline uint8_t LCD_DMA_BuffMode(const void *p, uint32_t count)
 {
-	uint8_t lcd_data_buff[2]; // 数据发送区
-	LCD_DC_Data;			  // 数据指令选择 引脚输出高电平，代表本次传输 数据
+	if (LCD_SPI.Init.FifoThreshold > SPI_FIFO_THRESHOLD_01DATA && ((uintptr_t)p & 3U) == 0 && (count & 1U) == 0)
+		return LCD_DMA_MODE_BUFF32;
+	return LCD_DMA_MODE_BUFF;
+}
 
-	lcd_data_buff[0] = lcd_data >> 8; // 将数据拆分
-	lcd_data_buff[1] = lcd_data;
+/**
+ * @brief  启动下一段同色填充
+ * @note   1. 源地址固定指向 LCD_DMA_FillWord，颜色重复两次，32位传输时每项2个像素
+ *         2. SPI的TSIZE只有16位，每段最多65534个像素，更多的在完成中断中接续；
+ *            像素数为奇数时最后一个按16位单独发送
+ *         3. FIFO阈值为1个数据时只能按16位传输，每段最多65535个像素
+ *         4. RGB444时SPI为12位帧，同样一帧1个像素，LCD_DMA_FillLeft 按像素计数
+ */
+ITCM_CODE static HAL_StatusTypeDef LCD_DMA_FillNext(void)
+{
+	uint32_t left = LCD_DMA_FillLeft;
+	uint32_t count;
 
-	HAL_SPI_Transmit(&LCD_SPI, lcd_data_buff, 2, 1000); // 启动SPI传输
+	if (LCD_SPI.Init.FifoThreshold > SPI_FIFO_THRESHOLD_01DATA && left > 1UL)
+	{
+		count = (left > 65534UL) ? 65534UL : (left & ~1UL);
+		LCD_DMA_SetMode(LCD_DMA_MODE_FILL32);
+	}
+	else
+	{
+		count = (left > 65535UL) ? 65535UL : left;
+		LCD_DMA_SetMode(LCD_DMA_MODE_FILL16);
+	}
+	LCD_DMA_FillLeft = left - count;
+	return HAL_SPI_Transmit_DMA(&LCD_SPI, (const uint8_t *)LCD_DMA_FillWord, (uint16_t)count);
 }
+#endif
 
 /****************************************************************************************************************************************
- *	函 数 名: LCD_WriteBuff
+ *	函 数 名: LCD_WaitIdle
  *
- *	入口参数: DataBuff - 数据区，DataSize - 数据长度
+ *	函数功能: 等待后台DMA传输结束
  *
- *	函数功能: 批量写入数据到屏幕
+ *	说    明: 1. LCD_WriteBuff() 使用DMA时立即返回，屏幕的下一条指令或改写同一缓冲区之前需要等待
+ *				2. 超时(1000ms)后中止传输，避免死等
  *
  ****************************************************************************************************************************************/
 
-void LCD_WriteBuff(uint16_t *DataBuff, uint16_t DataSize)
+ITCM_CODE void LCD_WaitIdle(void)
 {
-	LCD_DC_Data; // 数据指令选择 引脚输出高电平，代表本次传输 数据
+#ifdef LCD_SPI_DMA_ENABLE
+	uint32_t tickstart = HAL_GetTick();
+	PERF_TIMER_START(wait_start);
 
-	// 修改为16位数据宽度，写入数据更加效率，不需要拆分
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_16BIT; //	16位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
-
-	HAL_SPI_Transmit(&LCD_SPI, (uint8_t *)DataBuff, DataSize, 1000); // 启动SPI传输
+	while (LCD_DMA_TxBuff != NULL)
+	{
+		if ((HAL_GetTick() - tickstart) >= 1000) // 超时
+		{
+			LCD_CopyDone_t done = LCD_COPY_DONE();
 
-	// 改回8位数据宽度，因为指令和部分数据都是按照8位传输的
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_8BIT; //	8位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
+#ifdef LCD_FMC_ENABLE
+			if (LCD_IS_FMC())
+			{
+				HAL_MDMA_Abort(&LCD_Fmc_Mdma);
+				LCD_Fmc_Finish(0);
+				break;
+			}
+#endif
+			HAL_SPI_Abort(&LCD_SPI);
+			LCD_DMA_FillLeft = 0;
+			if (done != NULL)
+				LCD_Copy_Done = NULL;
+			LCD_DMA_TxBuff = NULL;
+			PERF_TRACE_END(PERF_TRACE_DMA, 0);
+			if (done != NULL)
+				done(LCD_Copy_Arg); // 调用者不会再等到完成中断
+			break;
+		}
+	}
+	PERF_TIMER_STOP(dma_wait_cycles, wait_start);
+#endif
 }
 
 /****************************************************************************************************************************************
- *	函 数 名: SPI_LCD_Init
+ *	函 数 名: LCD_GetBuff
  *
- *	函数功能: 初始化屏幕控制器的各种参数
+ *	返 回 值: 空闲的渲染缓冲区首地址，容量为 LCD_BUFF_PIXELS 个像素
+ *
+ *	函数功能: 取得一个渲染缓冲区，供外部模块生成像素后交给 LCD_DrawImage565() 发送
+ *
+ *	说    明: 1. 缓冲区位于SRAM4，与驱动内部轮流使用，正在发送的缓冲区要等传输结束后才会返回
+ *				2. 只能在下一次调用本驱动的绘制函数之前使用，之后可能被驱动改写
  *
  ****************************************************************************************************************************************/
 
-void SPI_LCD_Init(void)
+uint16_t *LCD_GetBuff(void)
 {
-	LCD_GPIO_Init(); // 初始化 背光 引脚 、 数据指令选择 引脚
-
-	HAL_Delay(10);			  // 屏幕刚完成复位时（包括上电复位），需要等待至少5ms才能发送指令
-	LCD_WriteCommand(0x36);	  // 显存访问控制 指令，用于设置访问显存的方式
-	LCD_WriteData_8bit(0x00); // 配置成 从上到下、从左到右，RGB像素格式
-
-	LCD_WriteCommand(0x3A);	  // 接口像素格式 指令，用于设置使用 12位、16位还是18位色
-	LCD_WriteData_8bit(0x05); // 此处配置成 16位 像素格式
-
-	// 接下来很多都是电压设置指令，直接使用厂家给设定值
-	LCD_WriteCommand(0xB2);
-	LCD_WriteData_8bit(0x0C);
-	LCD_WriteData_8bit(0x0C);
-	LCD_WriteData_8bit(0x00);
-	LCD_WriteData_8bit(0x33);
-	LCD_WriteData_8bit(0x33);
-
-	LCD_WriteCommand(0xB7);	  // 栅极电压设置指令
-	LCD_WriteData_8bit(0x35); // VGH = 13.26V，VGL = -10.43V
-
-	LCD_WriteCommand(0xBB);	  // 公共电压设置指令
-	LCD_WriteData_8bit(0x19); // VCOM = 1.35V
-
-	LCD_WriteCommand(0xC0);
-	LCD_WriteData_8bit(0x2C);
-
-	LCD_WriteCommand(0xC2);	  // VDV 和 VRH 来源设置
-	LCD_WriteData_8bit(0x01); // VDV 和 VRH 由用户自由配置
-
-	LCD_WriteCommand(0xC3);	  // VRH电压 设置指令
-	LCD_WriteData_8bit(0x12); // VRH电压 = 4.6+( vcom+vcom offset+vdv)
-
-	LCD_WriteCommand(0xC4);	  // VDV电压 设置指令
-	LCD_WriteData_8bit(0x20); // VDV电压 = 0v
-
-	LCD_WriteCommand(0xC6);	  // 正常模式的帧率控制指令
-	LCD_WriteData_8bit(0x0F); // 设置屏幕控制器的刷新帧率为60帧
-
-	LCD_WriteCommand(0xD0);	  // 电源控制指令
-	LCD_WriteData_8bit(0xA4); // 无效数据，固定写入0xA4
-	LCD_WriteData_8bit(0xA1); // AVDD = 6.8V ，AVDD = -4.8V ，VDS = 2.3V
-
-	LCD_WriteCommand(0xE0); // 正极电压伽马值设定
-	LCD_WriteData_8bit(0xD0);
-	LCD_WriteData_8bit(0x04);
-	LCD_WriteData_8bit(0x0D);
-	LCD_WriteData_8bit(0x11);
-	LCD_WriteData_8bit(0x13);
-	LCD_WriteData_8bit(0x2B);
-	LCD_WriteData_8bit(0x3F);
-	LCD_WriteData_8bit(0x54);
-	LCD_WriteData_8bit(0x4C);
-	LCD_WriteData_8bit(0x18);
-	LCD_WriteData_8bit(0x0D);
-	LCD_WriteData_8bit(0x0B);
-	LCD_WriteData_8bit(0x1F);
-	LCD_WriteData_8bit(0x23);
-
-	LCD_WriteCommand(0xE1); // 负极电压伽马值设定
-	LCD_WriteData_8bit(0xD0);
-	LCD_WriteData_8bit(0x04);
-	LCD_WriteData_8bit(0x0C);
-	LCD_WriteData_8bit(0x11);
-	LCD_WriteData_8bit(0x13);
-	LCD_WriteData_8bit(0x2C);
-	LCD_WriteData_8bit(0x3F);
-	LCD_WriteData_8bit(0x44);
-	LCD_WriteData_8bit(0x51);
-	LCD_WriteData_8bit(0x2F);
-	LCD_WriteData_8bit(0x1F);
-	LCD_WriteData_8bit(0x1F);
-	LCD_WriteData_8bit(0x20);
-	LCD_WriteData_8bit(0x23);
-
-	LCD_WriteCommand(0x21); // 打开反显，因为面板是常黑型，操作需要反过来
-
-	// 退出休眠指令，LCD控制器在刚上电、复位时，会自动进入休眠模式 ，因此操作屏幕之前，需要退出休眠
-	LCD_WriteCommand(0x11); // 退出休眠 指令
-	HAL_Delay(120);			// 需要等待120ms，让电源电压和时钟电路稳定下来
-
-	// 打开显示指令，LCD控制器在刚上电、复位时，会自动关闭显示
-	LCD_WriteCommand(0x29); // 打开显示
-
-	// 以下进行一些驱动的默认设置
-        LCD_SetDirection(Direction_V); //	设置显示方向
-        LCD_SetBackColor(LCD_BLACK);   // 设置背景色
-	LCD_SetColor(LCD_WHITE);	   // 设置画笔色
-	LCD_Clear();				   // 清屏
-	LCD_SetTextFont(24);
-	LCD_ShowNumMode(Fill_Zero);		 // 设置变量显示模式，多余位填充空格还是填充0
-
-	// 全部设置完毕之后，打开背光
-	LCD_Backlight_ON; // 引脚输出高电平点亮背光
+	return LCD_NextBuff();
 }
 
-/****************************************************************************************************************************************
- *	函 数 名:	 LCD_SetAddress
- *
- *	入口参数:	 x1 - 起始水平坐标   y1 - 起始垂直坐标
- *              x2 - 终点水平坐标   y2 - 终点垂直坐标
- *
- *	函数功能:   设置需要显示的坐标区域
- *****************************************************************************************************************************************/
+// 屏幕控制器当前窗口的模型，由 LCD_SetAddress() 和各个像素发送函数维护，每块屏幕一份：
+// 列、行地址范围(含偏移，起点<<16 | 终点)与新窗口相同时不再发送 CASET/RASET；
+// 0x2C 之后没有发过其他指令时，写指针停在 LCD_Win_Pos，新窗口正好从这里接着写时什么都不发送
+#define LCD_Win_Col (LCD_Cur->WinCol)
+#define LCD_Win_Row (LCD_Cur->WinRow)
+#define LCD_Win_Pos (LCD_Cur->WinPos)		  // 0x2C 之后已写入的像素数
+#define LCD_Win_Writing (LCD_Cur->WinWriting) // 1：屏幕处于写显存状态，数据接着写入 LCD_Win_Pos
 
-void LCD_SetAddress(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
-{
-	LCD_WriteCommand(0x2a); //	列地址设置，即X坐标
-	LCD_WriteData_16bit(x1 + LCD.X_Offset);
-	LCD_WriteData_16bit(x2 + LCD.X_Offset);
+#define LCD_WIN_ADVANCE(n) (LCD_Win_Pos += (n)) // 像素发送函数每交给SPI一段像素调用一次
 
-	LCD_WriteCommand(0x2b); //	行地址设置，即Y坐标
-	LCD_WriteData_16bit(y1 + LCD.Y_Offset);
-	LCD_WriteData_16bit(y2 + LCD.Y_Offset);
+#ifdef LCD_SPI_DMA_ENABLE
+/**
+ * @brief  当前屏幕(LCD_Cur)的一次DMA传输结束
+ */
+ITCM_CODE static void LCD_DMA_Complete(SPI_HandleTypeDef *hspi)
+{
+	LCD_CopyDone_t done = LCD_COPY_DONE();
 
-	LCD_WriteCommand(0x2c); //	开始写入显存，即要显示的颜色数据
+	if (LCD_DMA_FillLeft > 0 && hspi->ErrorCode == HAL_SPI_ERROR_NONE && LCD_DMA_FillNext() == HAL_OK)
+		return; // 接续下一段填充
+	if (done != NULL && hspi->ErrorCode == HAL_SPI_ERROR_NONE && LCD_Copy_Send() == HAL_OK)
+		return; // 接续异步复制的下一段
+	if (hspi->ErrorCode != HAL_SPI_ERROR_NONE)
+		LCD_Win_Writing = 0; // 没有发完，写指针位置未知
+	LCD_DMA_FillLeft = 0;
+	if (done != NULL)
+		LCD_Copy_Done = NULL;
+	if (LCD_DMA_TxBuff != LCD_SPI_EOT_WAIT) // 寄存器级发送不在DMA时间线上
+		PERF_TRACE_END(PERF_TRACE_DMA, 0);
+	LCD_DMA_TxBuff = NULL;
+	if (done != NULL)
+		done(LCD_Copy_Arg);
 }
+#endif
 
 /****************************************************************************************************************************************
- *	函 数 名:	LCD_SetColor
+ *	函 数 名: LCD_SPI_TxCpltHandler
  *
- *	入口参数:	Color - 要显示的颜色，示例：0x0000FF 表示蓝色
+ *	入口参数: hspi - SPI句柄
  *
- *	函数功能:	此函数用于设置画笔的颜色，例如显示字符、画点画线、绘图的颜色
+ *	函数功能: DMA发送完成(或出错)后释放缓冲区
  *
- *	说    明:	1. 为了方便用户使用自定义颜色，入口参数 Color 使用24位 RGB888的颜色格式，用户无需关心颜色格式的转换
- *					2. 24位的颜色中，从高位到低位分别对应 R、G、B  3个颜色通道
+ *	说    明: 1. 在 HAL_SPI_TxCpltCallback 和 HAL_SPI_ErrorCallback 中调用，见 user_hal_callbacks.c
+ *				2. 同色填充还有剩余像素时直接启动下一段，缓冲区保持占用
+ *				3. 异步复制还有剩余像素时发送已准备好的下一段，全部发送完(或出错)后调用其完成回调
+ *				4. 按句柄找到所属的屏幕，处理期间 LCD_Cur 临时指向它，返回前恢复被打断的屏幕
  *
- *****************************************************************************************************************************************/
+ ****************************************************************************************************************************************/
 
-void LCD_SetColor(uint32_t Color)
+ITCM_CODE void LCD_SPI_TxCpltHandler(SPI_HandleTypeDef *hspi)
 {
-	uint16_t Red_Value = 0, Green_Value = 0, Blue_Value = 0; // 各个颜色通道的值
-
-	Red_Value = (uint16_t)((Color & 0x00F80000) >> 8); // 转换成 16位 的RGB565颜色
-	Green_Value = (uint16_t)((Color & 0x0000FC00) >> 5);
-	Blue_Value = (uint16_t)((Color & 0x000000F8) >> 3);
+#ifdef LCD_SPI_DMA_ENABLE
+	LCD_Panel_t *cur = LCD_Cur;
 
-	LCD.Color = (uint16_t)(Red_Value | Green_Value | Blue_Value); // 将颜色写入全局LCD参数
+	for (uint8_t i = 0; i < LCD_PanelCount; i++)
+	{
+		if (LCD_Panels[i].Cfg.Spi == hspi)
+		{
+			LCD_Cur = &LCD_Panels[i];
+			LCD_DMA_Complete(hspi);
+			LCD_Cur = cur;
+			break;
+		}
+	}
+#else
+	(void)hspi;
+#endif
 }
 
-/****************************************************************************************************************************************
- *	函 数 名:	LCD_SetBackColor
- *
- *	入口参数:	Color - 要显示的颜色，示例：0x0000FF 表示蓝色
- *
- *	函数功能:	设置背景色,此函数用于清屏以及显示字符的背景色
- *
- *	说    明:	1. 为了方便用户使用自定义颜色，入口参数 Color 使用24位 RGB888的颜色格式，用户无需关心颜色格式的转换
- *					2. 24位的颜色中，从高位到低位分别对应 R、G、B  3个颜色通道
- *
- *****************************************************************************************************************************************/
+#ifdef LCD_FMC_ENABLE
+// 8080并口屏(FMC)：RS接在FMC的一根地址线上，写 FmcCmd 为指令、写 FmcData 为参数和像素，
+// 没有SPI的数据宽度切换和FIFO，16位总线时一次写入一个像素；FMC区域需由MPU配置为Device，CPU的写入才不会被缓存
 
-void LCD_SetBackColor(uint32_t Color)
+/**
+ * @brief  向FMC屏写入一个字节的指令或参数
+ * @param  reg LCD_Cur->Cfg.FmcCmd 或 LCD_Cur->Cfg.FmcData
+ */
+static inline void LCD_Fmc_Write8(volatile uint16_t *reg, uint8_t value)
 {
-	uint16_t Red_Value = 0, Green_Value = 0, Blue_Value = 0; // 各个颜色通道的值
-
-	Red_Value = (uint16_t)((Color & 0x00F80000) >> 8); // 转换成 16位 的RGB565颜色
-	Green_Value = (uint16_t)((Color & 0x0000FC00) >> 5);
-	Blue_Value = (uint16_t)((Color & 0x000000F8) >> 3);
-
-	LCD.BackColor = (uint16_t)(Red_Value | Green_Value | Blue_Value); // 将颜色写入全局LCD参数
+	if (LCD_Cur->Cfg.FmcBus8)
+		*(volatile uint8_t *)reg = value; // 16位写入在8位总线上会拆成两次
+	else
+		*reg = value; // 指令和参数在D7~D0上
 }
 
-/****************************************************************************************************************************************
- *	函 数 名:	LCD_SetDirection
- *
- *	入口参数:	direction - 要显示的方向
- *
- *	函数功能:	设置要显示的方向
- *
- *	说    明:   1. 可输入参数 Direction_H 、Direction_V 、Direction_H_Flip 、Direction_V_Flip
- *              2. 使用示例 LCD_DisplayDirection(Direction_H) ，即设置屏幕横屏显示
- *
- *****************************************************************************************************************************************/
-
-void LCD_SetDirection(uint8_t direction)
+/**
+ * @brief  由CPU把像素写入FMC屏的当前窗口
+ * @param  src 像素数据，为NULL时写入 count 个 color
+ */
+ITCM_CODE static void LCD_Fmc_WritePixels(const uint16_t *src, uint16_t color, uint32_t count)
 {
-	LCD.Direction = direction; // 写入全局LCD参数
+	volatile uint16_t *data = LCD_Cur->Cfg.FmcData;
 
-	if (direction == Direction_H) // 横屏显示
+	if (LCD_Cur->Cfg.FmcBus8) // 高字节在前，与SPI的16位帧相同
 	{
-		LCD_WriteCommand(0x36);	  // 显存访问控制 指令，用于设置访问显存的方式
-		LCD_WriteData_8bit(0x70); // 横屏显示
-		LCD.X_Offset = 0;		  // 设置控制器坐标偏移量
-		LCD.Y_Offset = 0;
-		LCD.Width = LCD_Height; // 重新赋值长、宽
-		LCD.Height = LCD_Width;
+		volatile uint8_t *data8 = (volatile uint8_t *)data;
+
+		while (count-- > 0)
+		{
+			uint16_t c = (src != NULL) ? *src++ : color;
+
+			*data8 = (uint8_t)(c >> 8);
+			*data8 = (uint8_t)c;
+		}
 	}
-	else if (direction == Direction_V)
+	else if (src != NULL)
 	{
-		LCD_WriteCommand(0x36);	  // 显存访问控制 指令，用于设置访问显存的方式
-		LCD_WriteData_8bit(0x00); // 垂直显示
-		LCD.X_Offset = 0;		  // 设置控制器坐标偏移量
-		LCD.Y_Offset = 0;
-		LCD.Width = LCD_Width; // 重新赋值长、宽
-		LCD.Height = LCD_Height;
+		while (count-- > 0)
+			*data = *src++;
 	}
-	else if (direction == Direction_H_Flip)
+	else
 	{
-		LCD_WriteCommand(0x36);	  // 显存访问控制 指令，用于设置访问显存的方式
-		LCD_WriteData_8bit(0xA0); // 横屏显示，并上下翻转，RGB像素格式
-		LCD.X_Offset = 0;		  // 设置控制器坐标偏移量
-		LCD.Y_Offset = 0;
-		LCD.Width = LCD_Height; // 重新赋值长、宽
-		LCD.Height = LCD_Width;
+		while (count-- > 0)
+			*data = color;
 	}
-	else if (direction == Direction_V_Flip)
+}
+
+#ifdef LCD_SPI_DMA_ENABLE
+static void LCD_Fmc_XferCplt(MDMA_HandleTypeDef *hmdma);
+static void LCD_Fmc_XferError(MDMA_HandleTypeDef *hmdma);
+
+/**
+ * @brief  按需配置FMC屏的MDMA通道(软件请求，一次请求传完全部块，按半字写入固定的数据地址)
+ * @param  inc 源地址是否递增，0为同色填充
+ * @param  skip 每个块之后源地址再跳过的字节数，发送帧缓冲中的矩形时为行宽之差
+ * @retval 1-可用，0-初始化失败
+ * @note   只在两次传输之间调用，参数与上次相同时不重新初始化
+ */
+static uint8_t LCD_Fmc_MdmaSetup(uint8_t inc, uint32_t skip)
+{
+	uint32_t src_inc = inc ? MDMA_SRC_INC_HALFWORD : MDMA_SRC_INC_DISABLE;
+
+	if (LCD_Fmc_MdmaState == 2)
+		return 0;
+	if (LCD_Fmc_MdmaState == 1 && LCD_Fmc_Mdma.Init.SourceInc == src_inc &&
+		LCD_Fmc_Mdma.Init.SourceBlockAddressOffset == (int32_t)skip)
+		return 1;
+	if (LCD_Fmc_MdmaState == 0)
 	{
-		LCD_WriteCommand(0x36);	  // 显存访问控制 指令，用于设置访问显存的方式
-		LCD_WriteData_8bit(0xC0); // 垂直显示 ，并上下翻转，RGB像素格式
-		LCD.X_Offset = 0;		  // 设置控制器坐标偏移量
-		LCD.Y_Offset = 0;
-		LCD.Width = LCD_Width; // 重新赋值长、宽
-		LCD.Height = LCD_Height;
+		__HAL_RCC_MDMA_CLK_ENABLE();
+		HAL_NVIC_EnableIRQ(MDMA_IRQn); // 优先级沿用CubeMX为QSPI的MDMA配置的值
+	}
+
+	LCD_Fmc_Mdma.Instance = LCD_FMC_MDMA_CHANNEL;
+	LCD_Fmc_Mdma.Init.Request = MDMA_REQUEST_SW;
+	LCD_Fmc_Mdma.Init.TransferTriggerMode = MDMA_FULL_TRANSFER;
+	LCD_Fmc_Mdma.Init.Priority = MDMA_PRIORITY_HIGH;
+	LCD_Fmc_Mdma.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+	LCD_Fmc_Mdma.Init.SourceInc = src_inc;
+	LCD_Fmc_Mdma.Init.DestinationInc = MDMA_DEST_INC_DISABLE; // 数据地址固定
+	LCD_Fmc_Mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_HALFWORD;
+	LCD_Fmc_Mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_HALFWORD;
+	LCD_Fmc_Mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+	LCD_Fmc_Mdma.Init.BufferTransferLength = 128;
+	LCD_Fmc_Mdma.Init.SourceBurst = MDMA_SOURCE_BURST_SINGLE;
+	LCD_Fmc_Mdma.Init.DestBurst = MDMA_DEST_BURST_SINGLE;
+	LCD_Fmc_Mdma.Init.SourceBlockAddressOffset = (int32_t)skip;
+	LCD_Fmc_Mdma.Init.DestBlockAddressOffset = 0;
+	if (HAL_MDMA_Init(&LCD_Fmc_Mdma) != HAL_OK)
+	{
+		LCD_Fmc_MdmaState = 2;
+		return 0;
 	}
+	HAL_MDMA_RegisterCallback(&LCD_Fmc_Mdma, HAL_MDMA_XFER_CPLT_CB_ID, LCD_Fmc_XferCplt);
+	HAL_MDMA_RegisterCallback(&LCD_Fmc_Mdma, HAL_MDMA_XFER_ERROR_CB_ID, LCD_Fmc_XferError);
+	LCD_Fmc_MdmaState = 1;
+	return 1;
 }
 
+/**
+ * @brief  启动下一段连续像素的发送
+ */
+ITCM_CODE static HAL_StatusTypeDef LCD_Fmc_Next(void)
+{
+	uint32_t n = (LCD_Fmc_Left > LCD_FMC_SEG_PIXELS) ? LCD_FMC_SEG_PIXELS : LCD_Fmc_Left;
+	const uint16_t *src = LCD_Fmc_Src;
 
-/****************************************************************************************************************************************
+	LCD_Fmc_Left -= n;
+	if (LCD_Fmc_Mdma.Init.SourceInc != MDMA_SRC_INC_DISABLE)
+		LCD_Fmc_Src += n;
+	return HAL_MDMA_Start_IT(&LCD_Fmc_Mdma, (uint32_t)src, (uint32_t)LCD_Cur->Cfg.FmcData, n * 2, 1);
+}
+
+/**
+ * @brief  由MDMA在后台把像素写入FMC屏的当前窗口
+ * @param  owner 传输期间占用的缓冲区，LCD_WaitBuff() 据此等待
+ * @param  src 像素数据，为NULL时写入 count 个 color
+ * @param  width 为0时 src 连续存放；否则每 width 个像素为一行，行与行之间跳过 skip 个像素
+ * @param  done 全部写完后在中断中调用，可为NULL
+ * @retval 1-已启动，0-8位总线或MDMA不可用，由调用者改用CPU写入
+ */
+ITCM_CODE static uint8_t LCD_Fmc_Dma(const uint16_t *owner, const uint16_t *src, uint16_t color, uint32_t count,
+									 uint16_t width, uint16_t skip, LCD_CopyDone_t done, void *arg)
+{
+	HAL_StatusTypeDef ret;
+
+	if (LCD_Cur->Cfg.FmcBus8 || !LCD_Fmc_MdmaSetup(src != NULL, skip * 2U))
+		return 0;
+
+	if (src != NULL)
+	{
+		uint32_t span = (width != 0) ? (count / width - 1) * (width + skip) + width : count;
+
+		SCB_CleanDCache_by_Addr((uint32_t *)src, (int32_t)(span * 2)); // CPU写入的像素刷回内存
+	}
+	else
+	{
+		LCD_DMA_FillWord[0] = ((uint32_t)color << 16) | color;
+		SCB_CleanDCache_by_Addr(LCD_DMA_FillWord, sizeof(LCD_DMA_FillWord));
+		src = (const uint16_t *)LCD_DMA_FillWord;
+		owner = src; // 标记DMA忙，不对应任何渲染缓冲区
+	}
+	LCD_DMA_TxBuff = owner;
+	LCD_Fmc_Done = done;
+	LCD_Fmc_Arg = arg;
+	PERF_TRACE_BEGIN(PERF_TRACE_DMA, count); // 最后一段的完成中断中结束
+	if (width != 0) // 每行一个块，块之间由MDMA跳过行宽之差，一次传完
+	{
+		LCD_Fmc_Left = 0;
+		ret = HAL_MDMA_Start_IT(&LCD_Fmc_Mdma, (uint32_t)src, (uint32_t)LCD_Cur->Cfg.FmcData, width * 2U, count / width);
+	}
+	else
+	{
+		LCD_Fmc_Src = src;
+		LCD_Fmc_Left = count;
+		ret = LCD_Fmc_Next();
+	}
+	if (ret == HAL_OK)
+		return 1;
+
+	LCD_Fmc_Left = 0; // 启动失败，改用CPU写入
+	LCD_Fmc_Done = NULL;
+	LCD_DMA_TxBuff = NULL;
+	PERF_TRACE_END(PERF_TRACE_DMA, 0);
+	return 0;
+}
+
+/**
+ * @brief  FMC屏的MDMA传输全部结束(或出错、超时)，释放缓冲区并调用完成回调
+ */
+ITCM_CODE static void LCD_Fmc_Finish(uint8_t ok)
+{
+	LCD_CopyDone_t done = LCD_Fmc_Done;
+
+	if (!ok)
+		LCD_Win_Writing = 0; // 没有写完，写指针位置未知
+	LCD_Fmc_Left = 0;
+	LCD_Fmc_Done = NULL;
+	LCD_DMA_TxBuff = NULL;
+	PERF_TRACE_END(PERF_TRACE_DMA, 0);
+	if (done != NULL)
+		done(LCD_Fmc_Arg);
+}
+
+/**
+ * @brief  MDMA完成/出错回调，处理期间 LCD_Cur 临时指向FMC屏
+ */
+ITCM_CODE static void LCD_Fmc_Complete(uint8_t ok)
+{
+	LCD_Panel_t *cur = LCD_Cur;
+
+	LCD_Cur = LCD_Fmc_Panel;
+	if (!ok)
+		LCD_Fmc_Finish(0);
+	else if (LCD_Fmc_Left == 0)
+		LCD_Fmc_Finish(1);
+	else if (LCD_Fmc_Next() != HAL_OK) // 接续下一段
+		LCD_Fmc_Finish(0);
+	LCD_Cur = cur;
+}
+
+static void LCD_Fmc_XferCplt(MDMA_HandleTypeDef *hmdma)
+{
+	(void)hmdma;
+	LCD_Fmc_Complete(1);
+}
+
+static void LCD_Fmc_XferError(MDMA_HandleTypeDef *hmdma)
+{
+	(void)hmdma;
+	LCD_Fmc_Complete(0);
+}
+
+#define LCD_FMC_RELEASE(p)       \
+	do                           \
+	{                            \
+		if (!LCD_IS_DMA_RAM(p))  \
+			LCD_WaitIdle();      \
+	} while (0) // 与SPI屏相同，只有SRAM4中的数据返回后仍在发送，其他数据写完才返回
+#else
+#define LCD_FMC_RELEASE(p) ((void)(p))
+#endif
+
+/**
+ * @brief  把像素写入FMC屏的当前窗口
+ * @param  owner/src 与 LCD_Clip_Write 相同，src 为NULL时写入 count 个 color
+ * @note   不少于 LCD_FMC_DMA_MIN 个像素时交给MDMA后台写入，否则(或8位总线)由CPU写入
+ */
+ITCM_CODE static void LCD_Fmc_Send(const uint16_t *owner, const uint16_t *src, uint16_t color, uint32_t count)
+{
+#ifdef LCD_SPI_DMA_ENABLE
+	if (count < LCD_FMC_DMA_MIN || !LCD_Fmc_Dma(owner, src, color, count, 0, 0, NULL, NULL))
+#else
+	(void)owner;
+#endif
+	{
+		PERF_TRACE_BEGIN(PERF_TRACE_SPI, count);
+		LCD_Fmc_WritePixels(src, color, count);
+		PERF_TRACE_END(PERF_TRACE_SPI, 0);
+	}
+	LCD_PERF_TX(count * 2);
+	LCD_WIN_ADVANCE(count);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_FMC_IRQHandler
+ *
+ *	函数功能: FMC屏的MDMA中断处理
+ *
+ *	说    明: 在 MDMA_IRQHandler 中调用，见 stm32h7xx_it.c
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_FMC_IRQHandler(void)
+{
+#ifdef LCD_SPI_DMA_ENABLE
+	if (LCD_Fmc_MdmaState == 1)
+		HAL_MDMA_IRQHandler(&LCD_Fmc_Mdma);
+#endif
+}
+#endif
+
+#if defined(LCD_FRAMEBUFFER_ENABLE) || defined(LCD_TILE_ENABLE) || defined(LCD_RENDER_BUFFER_ENABLE)
+#define LCD_CAPTURE_ENABLE
+#endif
+
+typedef struct
+{
+	uint16_t x1, y1, x2, y2; // 闭区间
+} LCD_Rect_t;
+
+// 裁剪区：所有绘图只写入裁剪区与屏幕的交集，LCD_SetAddress 只设置窗口的可见部分，
+// 窗口之外的像素在发送前丢弃，部分可见的字符和图片只发送可见的行列
+#define LCD_CLIP_NONE_RECT {0, 0, 0xFFFF, 0xFFFF} // 不裁剪，只受屏幕边界限制
+#define LCD_CLIP_OFF 0							  // 当前窗口完全可见
+#define LCD_CLIP_PART 1							  // 当前窗口部分可见，像素经 LCD_Clip_Write 过滤
+#define LCD_CLIP_DROP 2							  // 当前窗口完全不可见，像素全部丢弃
+
+static LCD_Rect_t LCD_Clip = LCD_CLIP_NONE_RECT;  // 当前裁剪区
+static LCD_Rect_t LCD_Clip_Win;					  // 部分可见时：绘图函数设置的完整窗口
+static LCD_Rect_t LCD_Clip_Vis;					  // 部分可见时：实际设置到屏幕的可见窗口
+static uint16_t LCD_Clip_CurX, LCD_Clip_CurY;	  // 部分可见时：完整窗口中的写入位置
+static uint8_t LCD_Clip_Mode = LCD_CLIP_OFF;	  // 当前窗口的裁剪情况
+
+#if defined(LCD_FRAMEBUFFER_ENABLE) || defined(LCD_RETAIN_ENABLE)
+static void LCD_RectUnion(LCD_Rect_t *dst, const LCD_Rect_t *src)
+{
+	if (src->x1 < dst->x1)
+		dst->x1 = src->x1;
+	if (src->y1 < dst->y1)
+		dst->y1 = src->y1;
+	if (src->x2 > dst->x2)
+		dst->x2 = src->x2;
+	if (src->y2 > dst->y2)
+		dst->y2 = src->y2;
+}
+#endif
+
+#ifdef LCD_CAPTURE_ENABLE
+// 绘图捕获后端：LCD_SetAddress 只记录窗口，写入显存的数据改为写入内存
+// 帧缓冲：写入整屏帧缓冲，颜色改变的像素计入脏区域，LCD_Flush() 时把合并后的脏矩形逐个发送到屏幕
+// 条带：回放显示列表时写入当前条带，落在条带之外的行直接丢弃
+// 内存缓冲区：LCD_RenderTextToBuffer() 期间写入调用者的缓冲区，帧缓冲模式下不计脏区域
+static LCD_Rect_t LCD_FB_Win;			  // 当前写入窗口
+static uint16_t LCD_FB_CurX, LCD_FB_CurY; // 当前写入位置
+
+#ifdef LCD_FRAMEBUFFER_ENABLE
+LCD_FB_ATTR static uint16_t LCD_FrameBuff[LCD_Width * LCD_Height] DMA_ALIGNED; // 按当前方向的 LCD.Width 为行宽
+static LCD_Rect_t LCD_Dirty[LCD_FB_DIRTY_RECTS];						 // 脏矩形
+static uint8_t LCD_DirtyCount = 0;										 // 脏矩形个数
+static uint8_t LCD_FB_Capture = 1;										 // 1：绘图写入帧缓冲，0：LCD_Flush() 中直接写屏
+static uint16_t *LCD_Cap_Target = NULL;									 // LCD_RenderTextToBuffer() 的目标缓冲区，NULL表示写入帧缓冲
+static uint16_t LCD_Cap_Stride;											 // 目标缓冲区行宽
+
+#define LCD_FB_CAPTURE() (LCD_FB_Capture != 0)
+#define LCD_FB_OFFSCREEN() (LCD_Cap_Target != NULL)
+#define LCD_FB_HIT(y) ((y) < LCD.Height)
+#define LCD_FB_STRIDE() (LCD_FB_OFFSCREEN() ? LCD_Cap_Stride : LCD.Width)
+#define LCD_FB_ROW(y) (LCD_FB_OFFSCREEN() ? &LCD_Cap_Target[(uint32_t)(y) * LCD_Cap_Stride] \
+										  : &LCD_FrameBuff[(uint32_t)(y) * LCD.Width])
+#else
+#ifdef LCD_TILE_ENABLE
+#if (LCD_TILE_PIXELS * 2) % 32 != 0
+#error "LCD_TILE_PIXELS 必须是16的倍数(每个条带占整数个Cache行)"
+#endif
+LCD_TILE_ATTR static uint16_t LCD_TileBuff[LCD_TILE_COUNT][LCD_TILE_PIXELS] DMA_ALIGNED; // 条带缓冲区，行宽为 LCD.Width
+static uint16_t LCD_Tile_ExtY1, LCD_Tile_ExtY2;								  // 当前命令设置过的窗口行范围
+#endif
+static uint16_t *LCD_Cap_Target = NULL; // 正在回放的条带或 LCD_RenderTextToBuffer() 的目标缓冲区，NULL表示直接写屏
+static uint16_t LCD_Cap_Y0, LCD_Cap_Rows; // 目标起始行、行数
+static uint16_t LCD_Cap_Stride;			  // 目标行宽
+
+#define LCD_FB_CAPTURE() (LCD_Cap_Target != NULL)
+#define LCD_FB_HIT(y) ((uint16_t)((y) - LCD_Cap_Y0) < LCD_Cap_Rows)
+#define LCD_FB_STRIDE() (LCD_Cap_Stride)
+#define LCD_FB_ROW(y) (&LCD_Cap_Target[(uint32_t)((y) - LCD_Cap_Y0) * LCD_Cap_Stride])
+#endif
+
+#ifdef LCD_FRAMEBUFFER_ENABLE
+static uint32_t LCD_RectArea(const LCD_Rect_t *r)
+{
+	return (uint32_t)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+// 发送计划的代价模型：每个窗口的开销(命令、片选、DMA重启)折合 LCD_FB_WinCost 个像素，
+// 两个矩形合并后多发送的像素少于一个窗口的开销时合并，否则分开发送
+static uint16_t LCD_FB_WinCost = LCD_FB_WINDOW_COST;
+static LCD_FlushStats_t LCD_FB_Stats;
+
+/**
+ * @brief  合并a、b后多发送的像素数(相交部分分开发送时要发两次，计为节省)
+ */
+static int32_t LCD_FB_MergeExtra(const LCD_Rect_t *a, const LCD_Rect_t *b)
+{
+	LCD_Rect_t u = *a;
+
+	LCD_RectUnion(&u, b);
+	return (int32_t)LCD_RectArea(&u) - (int32_t)LCD_RectArea(a) - (int32_t)LCD_RectArea(b);
+}
+
+/**
+ * @brief  把r与所有值得合并的矩形合并后移出列表，返回合并结果
+ */
+static void LCD_FB_Absorb(LCD_Rect_t *r)
+{
+	for (uint8_t i = 0; i < LCD_DirtyCount;)
+	{
+		LCD_Rect_t *d = &LCD_Dirty[i];
+		int32_t extra = LCD_FB_MergeExtra(r, d);
+
+		if (extra <= (int32_t)LCD_FB_WinCost)
+		{
+			if (extra > 0)
+				LCD_FB_Stats.Waste += (uint32_t)extra;
+			LCD_RectUnion(r, d);
+			*d = LCD_Dirty[--LCD_DirtyCount];
+			i = 0; // 合并后范围变大，重新检查
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+/**
+ * @brief  标记脏区域
+ * @note   与已有矩形合并后多发送的像素少于一个窗口的开销时合并(包含、相交或相邻的细长条)；
+ *         矩形个数用完时并入使总面积增长最小的矩形
+ */
+static void LCD_FB_MarkDirty(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+	LCD_Rect_t r;
+	uint8_t i;
+
+	if (LCD_FB_OFFSCREEN() || x1 >= LCD.Width || y1 >= LCD.Height || x2 < x1 || y2 < y1)
+		return; // 写入内存缓冲区时不涉及屏幕
+	r.x1 = x1;
+	r.y1 = y1;
+	r.x2 = (x2 < LCD.Width) ? x2 : LCD.Width - 1;
+	r.y2 = (y2 < LCD.Height) ? y2 : LCD.Height - 1;
+
+	LCD_FB_Absorb(&r);
+	if (LCD_DirtyCount < LCD_FB_DIRTY_RECTS)
+	{
+		LCD_Dirty[LCD_DirtyCount++] = r;
+	}
+	else
+	{
+		uint8_t best = 0;
+		uint32_t best_cost = 0xFFFFFFFF;
+
+		for (i = 0; i < LCD_DirtyCount; i++)
+		{
+			LCD_Rect_t u = LCD_Dirty[i];
+			uint32_t cost;
+
+			LCD_RectUnion(&u, &r);
+			cost = LCD_RectArea(&u) - LCD_RectArea(&LCD_Dirty[i]);
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best = i;
+			}
+		}
+		if (best_cost > LCD_RectArea(&r))
+			LCD_FB_Stats.Waste += best_cost - LCD_RectArea(&r); // 两个矩形以外多发送的像素
+		LCD_RectUnion(&LCD_Dirty[best], &r);
+	}
+}
+
+/**
+ * @brief  发送计划：反复合并节省最多的一对矩形，直到任何一对合并都不划算，再按从上到下、从左到右排序
+ * @note   标记时只与新矩形比较，个数用完后的强制合并可能使原本分开的矩形变得值得合并
+ */
+static void LCD_FB_Plan(void)
+{
+	for (;;)
+	{
+		int32_t best_extra = (int32_t)LCD_FB_WinCost + 1;
+		uint8_t bi = 0, bj = 0;
+
+		for (uint8_t i = 0; i < LCD_DirtyCount; i++)
+		{
+			for (uint8_t j = i + 1; j < LCD_DirtyCount; j++)
+			{
+				int32_t extra = LCD_FB_MergeExtra(&LCD_Dirty[i], &LCD_Dirty[j]);
+
+				if (extra < best_extra)
+				{
+					best_extra = extra;
+					bi = i;
+					bj = j;
+				}
+			}
+		}
+		if (best_extra > (int32_t)LCD_FB_WinCost)
+			break;
+		{
+			LCD_Rect_t r = LCD_Dirty[bi];
+
+			LCD_RectUnion(&r, &LCD_Dirty[bj]);
+			LCD_Dirty[bj] = LCD_Dirty[--LCD_DirtyCount];
+			LCD_Dirty[bi] = LCD_Dirty[--LCD_DirtyCount];
+			LCD_FB_Absorb(&r); // 合并结果可能与其余矩形相交
+			LCD_Dirty[LCD_DirtyCount++] = r;
+			if (best_extra > 0)
+				LCD_FB_Stats.Waste += (uint32_t)best_extra;
+		}
+	}
+
+	for (uint8_t i = 1; i < LCD_DirtyCount; i++) // 插入排序，个数不超过 LCD_FB_DIRTY_RECTS
+	{
+		LCD_Rect_t r = LCD_Dirty[i];
+		uint8_t j = i;
+
+		while (j > 0 && (LCD_Dirty[j - 1].y1 > r.y1 || (LCD_Dirty[j - 1].y1 == r.y1 && LCD_Dirty[j - 1].x1 > r.x1)))
+		{
+			LCD_Dirty[j] = LCD_Dirty[j - 1];
+			j--;
+		}
+		LCD_Dirty[j] = r;
+	}
+}
+#endif
+
+/**
+ * @brief  窗口与裁剪区、屏幕的交集
+ * @retval 0-完全不可见
+ */
+static uint8_t LCD_FB_Visible(int32_t x1, int32_t y1, int32_t x2, int32_t y2, LCD_Rect_t *vis)
+{
+	if (x1 < LCD_Clip.x1)
+		x1 = LCD_Clip.x1;
+	if (y1 < LCD_Clip.y1)
+		y1 = LCD_Clip.y1;
+	if (x2 > LCD_Clip.x2)
+		x2 = LCD_Clip.x2;
+	if (y2 > LCD_Clip.y2)
+		y2 = LCD_Clip.y2;
+	if (x2 >= LCD.Width)
+		x2 = LCD.Width - 1;
+	if (y2 >= LCD.Height)
+		y2 = LCD.Height - 1;
+	if (x1 > x2 || y1 > y2)
+		return 0;
+	vis->x1 = (uint16_t)x1;
+	vis->y1 = (uint16_t)y1;
+	vis->x2 = (uint16_t)x2;
+	vis->y2 = (uint16_t)y2;
+	return 1;
+}
+
+#if defined(LCD_FRAMEBUFFER_ENABLE) && defined(LCD_DMA2D_ENABLE)
+#define LCD_FB_DMA2D
+// DMA2D直接写帧缓冲：启动后立即返回，CPU下一次读写帧缓冲之前调用 LCD_DMA2D_Wait()，
+// 填充、格式转换和字模混合期间CPU继续查找和展开后面的内容
+static DMA2D_HandleTypeDef LCD_Dma2d;
+static uint8_t LCD_Dma2d_State = 0; // 0：未初始化，1：可用，2：初始化失败(改由CPU完成)
+static uint8_t LCD_Dma2d_Busy = 0;	// 1：正在写帧缓冲
+static uint16_t *LCD_Dma2d_Dst;		// 正在写入的帧缓冲区域，结束后作废这段Cache
+static uint32_t LCD_Dma2d_Bytes;
+
+/**
+ * @brief  RGB565转为DMA2D使用的不透明ARGB8888，低位用高位补齐(与DMA2D读入RGB565时相同)
+ */
+static uint32_t LCD_DMA2D_Color(uint16_t c)
+{
+	uint32_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+
+	return 0xFF000000UL | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+/**
+ * @brief  等待DMA2D写完帧缓冲
+ */
+static void LCD_DMA2D_Wait(void)
+{
+	if (!LCD_Dma2d_Busy)
+		return;
+	if (HAL_DMA2D_PollForTransfer(&LCD_Dma2d, 100) != HAL_OK)
+		HAL_DMA2D_Abort(&LCD_Dma2d);
+	SCB_InvalidateDCache_by_Addr((uint32_t *)LCD_Dma2d_Dst, LCD_Dma2d_Bytes); // 丢弃传输期间预取的旧数据
+	LCD_Dma2d_Busy = 0;
+}
+
+/**
+ * @brief  按传输模式初始化DMA2D，输出为帧缓冲中宽 width 的矩形
+ * @retval 1-可以启动传输，0-DMA2D不可用
+ */
+static uint8_t LCD_DMA2D_Setup(uint32_t mode, uint16_t width)
+{
+	LCD_DMA2D_Wait();
+	if (LCD_Dma2d_State == 0)
+	{
+		__HAL_RCC_DMA2D_CLK_ENABLE();
+		LCD_Dma2d.Instance = DMA2D;
+		LCD_Dma2d_State = 1;
+	}
+	if (LCD_Dma2d_State != 1)
+		return 0;
+
+	LCD_Dma2d.Init.Mode = mode;
+	LCD_Dma2d.Init.ColorMode = DMA2D_OUTPUT_RGB565;
+	LCD_Dma2d.Init.OutputOffset = LCD_FB_STRIDE() - width;
+	LCD_Dma2d.Init.AlphaInverted = DMA2D_REGULAR_ALPHA;
+	LCD_Dma2d.Init.RedBlueSwap = DMA2D_RB_REGULAR;
+	LCD_Dma2d.Init.BytesSwap = DMA2D_BYTES_REGULAR;
+	LCD_Dma2d.Init.LineOffsetMode = DMA2D_LOM_PIXELS;
+	if (HAL_DMA2D_Init(&LCD_Dma2d) != HAL_OK)
+	{
+		LCD_Dma2d_State = 2;
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  配置DMA2D的一个输入层
+ * @param  color A4/A8输入时为前景色(ARGB8888)，其他格式只用到最高字节(透明度)
+ */
+static uint8_t LCD_DMA2D_Layer(uint32_t layer, uint32_t color_mode, uint32_t offset, uint32_t color)
+{
+	DMA2D_LayerCfgTypeDef *cfg = &LCD_Dma2d.LayerCfg[layer];
+
+	cfg->InputOffset = offset;
+	cfg->InputColorMode = color_mode;
+	cfg->AlphaMode = DMA2D_NO_MODIF_ALPHA;
+	cfg->InputAlpha = (color_mode == DMA2D_INPUT_A4 || color_mode == DMA2D_INPUT_A8) ? color : (color >> 24);
+	cfg->AlphaInverted = DMA2D_REGULAR_ALPHA;
+	cfg->RedBlueSwap = DMA2D_RB_REGULAR;
+	cfg->ChromaSubSampling = DMA2D_NO_CSS;
+	return HAL_DMA2D_ConfigLayer(&LCD_Dma2d, layer) == HAL_OK;
+}
+
+/**
+ * @brief  启动DMA2D写入帧缓冲中的可见矩形，整个矩形计入脏区域
+ * @param  src 前景层地址，R2M时为ARGB8888颜色
+ * @param  blend 1：帧缓冲中原有的像素作为背景层参与混合
+ * @retval 1-已启动，0-启动失败(由CPU完成)
+ */
+static uint8_t LCD_DMA2D_Start(uint32_t src, uint8_t blend, const LCD_Rect_t *vis)
+{
+	uint16_t width = vis->x2 - vis->x1 + 1, height = vis->y2 - vis->y1 + 1;
+	uint16_t *dst = LCD_FB_ROW(vis->y1) + vis->x1;
+	uint32_t bytes = ((uint32_t)(height - 1) * LCD_FB_STRIDE() + width) * 2;
+	HAL_StatusTypeDef status;
+
+	SCB_CleanInvalidateDCache_by_Addr((uint32_t *)dst, bytes); // CPU写入的像素先写回内存
+	if (blend)
+		status = HAL_DMA2D_BlendingStart(&LCD_Dma2d, src, (uint32_t)dst, (uint32_t)dst, width, height);
+	else
+		status = HAL_DMA2D_Start(&LCD_Dma2d, src, (uint32_t)dst, width, height);
+	if (status != HAL_OK)
+		return 0;
+
+	LCD_Dma2d_Dst = dst;
+	LCD_Dma2d_Bytes = bytes;
+	LCD_Dma2d_Busy = 1;
+	LCD_FB_MarkDirty(vis->x1, vis->y1, vis->x2, vis->y2);
+	return 1;
+}
+#else
+#define LCD_DMA2D_Wait() ((void)0)
+#endif
+
+/**
+ * @brief  设置帧缓冲写入窗口(对应屏幕的 0x2A/0x2B/0x2C)
+ */
+static void LCD_FB_SetWindow(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+	LCD_FB_Win.x1 = x1;
+	LCD_FB_Win.y1 = y1;
+	LCD_FB_Win.x2 = x2;
+	LCD_FB_Win.y2 = y2;
+	LCD_FB_CurX = x1;
+	LCD_FB_CurY = y1;
+#ifdef LCD_TILE_ENABLE
+	if (y1 < LCD_Tile_ExtY1)
+		LCD_Tile_ExtY1 = y1;
+	if (y2 > LCD_Tile_ExtY2)
+		LCD_Tile_ExtY2 = y2;
+#endif
+}
+
+/**
+ * @brief  按窗口顺序写入像素到帧缓冲或当前条带
+ * @param  pData 像素数据，为NULL时全部写入 color
+ * @note   帧缓冲只有颜色真正改变的像素才计入脏区域，整屏重绘时内容不变的部分不会再发送
+ * @note   超出屏幕和裁剪区的像素丢弃
+ */
+static void LCD_FB_Write(const uint16_t *pData, uint16_t color, uint32_t Size)
+{
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	uint16_t dx1 = 0xFFFF, dy1 = 0xFFFF, dx2 = 0, dy2 = 0; // 本次改变的像素范围
+#endif
+
+	LCD_DMA2D_Wait();
+#ifdef LCD_FB_DMA2D
+	if (pData == NULL && Size >= LCD_DMA2D_MIN_PIXELS && LCD_FB_CurX == LCD_FB_Win.x1 && LCD_FB_CurY == LCD_FB_Win.y1 &&
+		Size >= (uint32_t)(LCD_FB_Win.x2 - LCD_FB_Win.x1 + 1) * (LCD_FB_Win.y2 - LCD_FB_Win.y1 + 1))
+	{
+		// 整个窗口同色填充：由DMA2D写入可见部分
+		LCD_Rect_t vis;
+
+		if (!LCD_FB_Visible(LCD_FB_Win.x1, LCD_FB_Win.y1, LCD_FB_Win.x2, LCD_FB_Win.y2, &vis) ||
+			(LCD_DMA2D_Setup(DMA2D_R2M, vis.x2 - vis.x1 + 1) && LCD_DMA2D_Start(LCD_DMA2D_Color(color), 0, &vis)))
+		{
+			LCD_FB_CurX = LCD_FB_Win.x1;
+			LCD_FB_CurY = LCD_FB_Win.y2 + 1; // 窗口已写完
+			return;
+		}
+	}
+#endif
+
+	while (Size > 0 && LCD_FB_CurY <= LCD_FB_Win.y2)
+	{
+		uint32_t span = LCD_FB_Win.x2 - LCD_FB_CurX + 1; // 本行剩余像素
+		uint32_t n;
+
+		if (span > Size)
+			span = Size;
+
+		uint32_t c1 = (LCD_FB_CurX > LCD_Clip.x1) ? LCD_FB_CurX : LCD_Clip.x1; // 本行可见的列
+		uint32_t c2 = LCD_FB_CurX + span - 1;
+
+		if (c2 > LCD_Clip.x2)
+			c2 = LCD_Clip.x2;
+		if (c2 >= LCD.Width)
+			c2 = LCD.Width - 1;
+		if (LCD_FB_HIT(LCD_FB_CurY) && LCD_FB_CurY >= LCD_Clip.y1 && LCD_FB_CurY <= LCD_Clip.y2 && c1 <= c2)
+		{
+			uint16_t *dst = LCD_FB_ROW(LCD_FB_CurY) + c1;
+			const uint16_t *src = (pData != NULL) ? pData + (c1 - LCD_FB_CurX) : NULL;
+#ifdef LCD_FRAMEBUFFER_ENABLE
+			int32_t first = -1, last = -1;
+#endif
+
+			n = c2 - c1 + 1;
+#ifdef LCD_FRAMEBUFFER_ENABLE
+			for (uint32_t k = 0; k < n; k++)
+			{
+				uint16_t v = (src != NULL) ? src[k] : color;
+
+				if (dst[k] != v)
+				{
+					dst[k] = v;
+					if (first < 0)
+						first = (int32_t)k;
+					last = (int32_t)k;
+				}
+			}
+			if (first >= 0)
+			{
+				if (c1 + first < dx1)
+					dx1 = c1 + first;
+				if (c1 + last > dx2)
+					dx2 = c1 + last;
+				if (LCD_FB_CurY < dy1)
+					dy1 = LCD_FB_CurY;
+				dy2 = LCD_FB_CurY;
+			}
+#else
+			if (src != NULL)
+			{
+				memcpy(dst, src, n * 2);
+			}
+			else
+			{
+				for (uint32_t k = 0; k < n; k++)
+					dst[k] = color;
+			}
+#endif
+		}
+		if (pData != NULL)
+			pData += span;
+		Size -= span;
+		LCD_FB_CurX += span;
+		if (LCD_FB_CurX > LCD_FB_Win.x2) // 换到窗口的下一行
+		{
+			LCD_FB_CurX = LCD_FB_Win.x1;
+			LCD_FB_CurY++;
+		}
+	}
+
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	if (dx1 != 0xFFFF)
+	{
+		LCD_FB_MarkDirty(dx1, dy1, dx2, dy2);
+	}
+#endif
+}
+#else
+#define LCD_FB_CAPTURE() 0
+#endif
+
+#ifdef LCD_FRAMEBUFFER_ENABLE
+/**
+ * @brief  把帧缓冲中的一个矩形发送到屏幕：只设置一次窗口，按行拷贝到渲染缓冲区后分块发送，拷贝与DMA传输交替进行
+ */
+static void LCD_FB_SendRect(const LCD_Rect_t *r)
+{
+	uint16_t width = r->x2 - r->x1 + 1;
+	uint16_t rows = LCD_BUFF_PIXELS / width; // 每块能容纳的行数
+
+	LCD_SetAddress(r->x1, r->y1, r->x2, r->y2);
+#if defined(LCD_FMC_ENABLE) && defined(LCD_SPI_DMA_ENABLE)
+	if (LCD_IS_FMC() && LCD_Fmc_Dma(LCD_FrameBuff, &LCD_FrameBuff[r->y1 * LCD.Width + r->x1], 0, (uint32_t)width * (r->y2 - r->y1 + 1),
+									width, LCD.Width - width, NULL, NULL))
+	{
+		LCD_PERF_TX((uint32_t)width * (r->y2 - r->y1 + 1) * 2);
+		LCD_WIN_ADVANCE((uint32_t)width * (r->y2 - r->y1 + 1));
+		return; // MDMA按行直接读取帧缓冲，不拷贝到渲染缓冲区
+	}
+#endif
+	for (uint16_t y = r->y1; y <= r->y2; y += rows)
+	{
+		uint16_t n = (r->y2 - y + 1 < rows) ? (r->y2 - y + 1) : rows;
+		uint16_t *pBuff = LCD_NextBuff();
+
+		for (uint16_t k = 0; k < n; k++)
+		{
+			memcpy(pBuff + k * width, &LCD_FrameBuff[(y + k) * LCD.Width + r->x1], width * 2);
+		}
+		LCD_WriteBuff(pBuff, n * width);
+	}
+}
+
+static uint16_t LCD_FB_ShownY1 = 0;	   // 局部显示区(绘图坐标)，正常显示时为整屏
+static uint16_t LCD_FB_ShownY2 = 0xFFFF; // 区外的脏区域在 LCD_Flush() 中保留
+
+#ifdef LCD_TE_ENABLE
+static void LCD_TE_Order(LCD_Rect_t *rects, uint8_t count);
+static void LCD_TE_Present(const LCD_Rect_t *r, uint8_t first);
+#endif
+#endif
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Flush
+ *
+ *	函数功能: 把帧缓冲中的脏区域发送到屏幕
+ *
+ *	说    明: 1. 每个脏矩形只设置一次窗口，数据按行拷贝到渲染缓冲区后分块发送，拷贝与DMA传输交替进行
+ *				2. 锁定TE时脏矩形按屏幕刷新顺序排列，每个矩形等刷新扫过后再发送，一帧内写不完的矩形分段发送
+ *				3. 局部显示期间只发送局部区内的部分，区外的部分留在脏区域中，恢复正常显示后发送
+ *				4. 未定义 LCD_FRAMEBUFFER_ENABLE 时立即返回
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_Flush(void)
+{
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	LCD_Rect_t clip = LCD_Clip; // 帧缓冲已按裁剪区写入，发送时不再裁剪
+	LCD_Rect_t pend[LCD_FB_DIRTY_RECTS];
+	uint8_t held;
+#ifdef LCD_TE_ENABLE
+	uint8_t first = 1; // 还没有发送过矩形
+#endif
+
+	LCD_DMA2D_Wait();
+	LCD_Clip = (LCD_Rect_t)LCD_CLIP_NONE_RECT;
+	LCD_FB_Capture = 0; // 以下直接写屏
+
+	LCD_FB_Plan();
+#ifdef LCD_TE_ENABLE
+	LCD_TE_Order(LCD_Dirty, LCD_DirtyCount);
+#endif
+	LCD_FB_Stats.LastWindows = 0;
+	LCD_FB_Stats.LastPixels = 0;
+	for (uint8_t i = 0; i < LCD_DirtyCount; i++)
+	{
+		LCD_Rect_t r = LCD_Dirty[i];
+
+		if (r.y1 < LCD_FB_ShownY1)
+			r.y1 = LCD_FB_ShownY1;
+		if (r.y2 > LCD_FB_ShownY2)
+			r.y2 = LCD_FB_ShownY2;
+		if (r.y1 > r.y2)
+			continue; // 全部在局部显示区外
+		LCD_FB_Stats.LastWindows++;
+		LCD_FB_Stats.LastPixels += LCD_RectArea(&r);
+#ifdef LCD_TE_ENABLE
+		LCD_TE_Present(&r, first);
+		first = 0;
+#else
+		LCD_FB_SendRect(&r);
+#endif
+#ifdef LCD_MIRROR_ENABLE
+		LCD_Mirror_Mark(r.x1, r.y1, r.x2, r.y2); // 已上屏的区域交给远程镜像
+#endif
+	}
+
+	LCD_FB_Stats.LastCost = LCD_FB_Stats.LastPixels + (uint32_t)LCD_FB_Stats.LastWindows * LCD_FB_WinCost;
+	if (LCD_FB_Stats.LastWindows != 0)
+	{
+		LCD_FB_Stats.Flushes++;
+		LCD_FB_Stats.Windows += LCD_FB_Stats.LastWindows;
+		LCD_FB_Stats.Pixels += LCD_FB_Stats.LastPixels;
+	}
+
+	held = LCD_DirtyCount;
+	memcpy(pend, LCD_Dirty, sizeof(LCD_Rect_t) * held);
+	LCD_DirtyCount = 0;
+	for (uint8_t i = 0; i < held; i++) // 局部显示区外的部分重新计入脏区域
+	{
+		LCD_Rect_t r = pend[i];
+
+		if (r.y1 < LCD_FB_ShownY1)
+			LCD_FB_MarkDirty(r.x1, r.y1, r.x2, (r.y2 < LCD_FB_ShownY1) ? r.y2 : LCD_FB_ShownY1 - 1);
+		if (r.y2 > LCD_FB_ShownY2)
+			LCD_FB_MarkDirty(r.x1, (r.y1 > LCD_FB_ShownY2) ? r.y1 : LCD_FB_ShownY2 + 1, r.x2, r.y2);
+	}
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+		LCD_WaitIdle(); // FMC屏直接从帧缓冲发送，写完之后才能继续绘制
+#endif
+
+	LCD_FB_Capture = 1;
+	LCD_Clip = clip;
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Flush_SetWindowCost
+ *
+ *	入口参数: pixels - 设置一次窗口的开销折合的像素数，0时恢复 LCD_FB_WINDOW_COST
+ *
+ *	函数功能: 设置脏矩形合并的代价模型
+ *
+ *	说    明: 1. 两个脏矩形合并后多发送的像素不超过该值时合并为一个窗口，否则分开发送
+ *				2. 按 LCD_Bench_Run() 测得的 win_px 设置(基准测试会自动设置)；时钟越高、数据越快，
+ *				   窗口的固定开销相对越大，值越大合并越积极
+ *				3. 未定义 LCD_FRAMEBUFFER_ENABLE 时不起作用
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_Flush_SetWindowCost(uint16_t pixels)
+{
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	LCD_FB_WinCost = (pixels != 0) ? pixels : LCD_FB_WINDOW_COST;
+#else
+	(void)pixels;
+#endif
+}
+
+/**
+ * @brief  读取 LCD_Flush() 的发送统计
+ * @param  stats 输出
+ * @param  reset 1-读取后清零累计值
+ */
+void LCD_Flush_GetStats(LCD_FlushStats_t *stats, uint8_t reset)
+{
+	if (stats == NULL)
+		return;
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	LCD_FB_Stats.WindowCost = LCD_FB_WinCost;
+	*stats = LCD_FB_Stats;
+	if (reset)
+	{
+		LCD_FB_Stats.Flushes = 0;
+		LCD_FB_Stats.Windows = 0;
+		LCD_FB_Stats.Pixels = 0;
+		LCD_FB_Stats.Waste = 0;
+	}
+#else
+	(void)reset;
+	memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_FB_Get
+ *
+ *	入口参数: width、height - 输出当前方向的帧缓冲宽高，可为NULL
+ *
+ *	返 回 值: 帧缓冲首地址(行宽为 width)，未定义 LCD_FRAMEBUFFER_ENABLE 时返回NULL
+ *
+ *	说    明: 只读；内容为最近一次绘制的结果，可能尚未 LCD_Flush()
+ *
+ ****************************************************************************************************************************************/
+
+const uint16_t *LCD_FB_Get(uint16_t *width, uint16_t *height)
+{
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	LCD_DMA2D_Wait();
+	if (width != NULL)
+		*width = LCD.Width;
+	if (height != NULL)
+		*height = LCD.Height;
+	return LCD_FrameBuff;
+#else
+	if (width != NULL)
+		*width = 0;
+	if (height != NULL)
+		*height = 0;
+	return NULL;
+#endif
+}
+
+#ifdef LCD_FRAMEBUFFER_ENABLE
+#define LCD_REMAP_XOR 0	 // 与掩码异或
+#define LCD_REMAP_SWAP 1 // 两种颜色互换
+
+/**
+ * @brief  改写帧缓冲中矩形区域(与裁剪区、屏幕的交集)的像素，整个区域计入脏区域
+ * @param  mode LCD_REMAP_XOR：每个像素与 a 异或，按32位字一次处理两个像素；LCD_REMAP_SWAP：a、b两色互换
+ */
+static void LCD_FB_Remap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t mode, uint16_t a, uint16_t b)
+{
+	uint32_t x1 = (x > LCD_Clip.x1) ? x : LCD_Clip.x1;
+	uint32_t y1 = (y > LCD_Clip.y1) ? y : LCD_Clip.y1;
+	uint32_t x2 = (uint32_t)x + width - 1, y2 = (uint32_t)y + height - 1;
+
+	if (x2 > LCD_Clip.x2)
+		x2 = LCD_Clip.x2;
+	if (y2 > LCD_Clip.y2)
+		y2 = LCD_Clip.y2;
+	if (x2 >= LCD.Width)
+		x2 = LCD.Width - 1;
+	if (y2 >= LCD.Height)
+		y2 = LCD.Height - 1;
+	if (width == 0 || height == 0 || x1 > x2 || y1 > y2 || (mode == LCD_REMAP_XOR ? a == 0 : a == b))
+		return; // 不可见或像素不会改变
+
+	LCD_DMA2D_Wait();
+	for (uint32_t row = y1; row <= y2; row++)
+	{
+		uint16_t *p = &LCD_FrameBuff[row * LCD.Width + x1];
+		uint32_t n = x2 - x1 + 1;
+
+		if (mode == LCD_REMAP_SWAP)
+		{
+			for (uint32_t k = 0; k < n; k++)
+			{
+				p[k] = (p[k] == a) ? b : (p[k] == b) ? a : p[k];
+			}
+			continue;
+		}
+		if ((uintptr_t)p & 0x02) // 先补齐到4字节边界
+		{
+			*p++ ^= a;
+			n--;
+		}
+		uint32_t *p32 = (uint32_t *)p;
+		uint32_t mask = (uint32_t)a * 0x00010001UL;
+
+		for (; n >= 2; n -= 2)
+		{
+			*p32++ ^= mask;
+		}
+		if (n > 0)
+		{
+			*(uint16_t *)p32 ^= a;
+		}
+	}
+	LCD_FB_MarkDirty((uint16_t)x1, (uint16_t)y1, (uint16_t)x2, (uint16_t)y2);
+}
+#endif
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_InvertRect / LCD_HighlightRect
+ *
+ *	入口参数: x、y - 矩形左上角坐标
+ *				width、height - 矩形尺寸
+ *				Color - 高亮底色，RGB888格式，与 LCD_SetColor() 相同
+ *
+ *	函数功能: 把帧缓冲中已绘制的区域反显或换上高亮底色，不重新查找、展开字模
+ *
+ *	说    明: 1. LCD_InvertRect() 把每个像素与 (画笔色 ^ 背景色) 异或，按当前颜色绘制的文字前景、背景互换，
+ *					再调用一次恢复原样；其余颜色同样异或，两次之后也恢复
+ *				2. LCD_HighlightRect() 把背景色像素换成 Color、Color像素换回背景色，笔画颜色不变，再调用一次恢复原样
+ *				3. 移动菜单光标时对旧行和新行各调用一次再 LCD_Flush()，只有这两行计入脏区域并发送
+ *				4. 只作用于帧缓冲(LCD_FRAMEBUFFER_ENABLE)，受裁剪区限制，显示列表不录制；
+ *					没有帧缓冲时返回0，由调用者交换画笔色和背景色后重画，此时像素缓存中反色的字模按同一掩码异或后直接发送
+ *
+ *	返 回 值: 1-已在帧缓冲中完成，0-没有帧缓冲，需要重画
+ *
+ ****************************************************************************************************************************************/
+
+uint8_t LCD_InvertRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	LCD_FB_Remap(x, y, width, height, LCD_REMAP_XOR, (uint16_t)(LCD.Color ^ LCD.BackColor), 0);
+	return 1;
+#else
+	(void)x;
+	(void)y;
+	(void)width;
+	(void)height;
+	return 0;
+#endif
+}
+
+uint8_t LCD_HighlightRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t Color)
+{
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	LCD_FB_Remap(x, y, width, height, LCD_REMAP_SWAP, (uint16_t)LCD.BackColor, LCD_RGB565(Color));
+	return 1;
+#else
+	(void)x;
+	(void)y;
+	(void)width;
+	(void)height;
+	(void)Color;
+	return 0;
+#endif
+}
+
+#ifdef USE_FLASH_FONT
+#define LCD_TEXT_FAMILY() FlashFont_GetFamily() // 当前字体族
+#define LCD_TEXT_USE_FAMILY(family) ((void)FlashFont_SelectFamily(family)) // 未变化时不重建段表
+#else
+#define LCD_TEXT_FAMILY() 0 // 内置字模只有一个字体族
+#define LCD_TEXT_USE_FAMILY(family) ((void)(family))
+#endif
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312) && defined(FLASH_FONT_GBK_TEXT)
+#define LCD_TEXT_ENCODING() FlashFont_GetEncoding() // 当前文本编码
+#define LCD_TEXT_USE_ENCODING(enc) ((void)FlashFont_SetEncoding(enc))
+#else
+#define LCD_TEXT_ENCODING() Text_UTF8 // 编码在编译时由 IS_GB2312 决定
+#define LCD_TEXT_USE_ENCODING(enc) ((void)(enc))
+#endif
+
+typedef struct // 影响绘图结果的全局状态，录制命令时一并保存
+{
+	const pFONT *AsciiFonts;	// 英文字体
+	const pFONT *CHFonts;		// 中文字体
+	uint16_t Color;		// 画笔色
+	uint16_t BackColor; // 背景色
+	uint8_t Text_Mode;	// 字符背景模式
+	uint8_t Text_Scale; // ASCII字符放大倍数
+	uint8_t Text_Effect; // 文本效果
+	uint16_t Effect_Color; // 描边/阴影颜色
+	uint8_t Family;		// 字体族
+	uint8_t Encoding;	// 文本编码
+	LCD_Rect_t Clip;	// 裁剪区
+} LCD_State_t;
+
+static void LCD_SaveState(LCD_State_t *state)
+{
+	state->AsciiFonts = LCD_AsciiFonts;
+	state->CHFonts = LCD_CHFonts;
+	state->Color = (uint16_t)LCD.Color;
+	state->BackColor = (uint16_t)LCD.BackColor;
+	state->Text_Mode = LCD.Text_Mode;
+	state->Text_Scale = LCD.Text_Scale;
+	state->Text_Effect = LCD.Text_Effect;
+	state->Effect_Color = LCD.Effect_Color;
+	state->Family = LCD_TEXT_FAMILY();
+	state->Encoding = LCD_TEXT_ENCODING();
+	state->Clip = LCD_Clip;
+}
+
+static void LCD_LoadState(const LCD_State_t *state)
+{
+	if (LCD.Color != state->Color || LCD.BackColor != state->BackColor)
+	{
+		LCD.Color = state->Color;
+		LCD.BackColor = state->BackColor;
+		Expand_LUT_Valid = 0; // 字模展开表需要重建
+	}
+	LCD.Text_Mode = state->Text_Mode;
+	LCD.Text_Scale = state->Text_Scale;
+	LCD.Text_Effect = state->Text_Effect;
+	LCD.Effect_Color = state->Effect_Color;
+	LCD_Clip = state->Clip;
+	LCD_TEXT_USE_FAMILY(state->Family);
+	LCD_TEXT_USE_ENCODING(state->Encoding);
+	if (LCD_AsciiFonts != state->AsciiFonts || LCD_CHFonts != state->CHFonts)
+	{
+		LCD_AsciiFonts = state->AsciiFonts;
+		LCD_CHFonts = state->CHFonts;
+#ifdef LCD_EXPAND_FIXED_ENABLE
+		Expand_SelectFonts(); // 专用展开函数随字体切换
+#endif
+	}
+}
+
+#ifdef LCD_TILE_ENABLE
+// 显示列表：LCD_TileBegin() 之后的绘图函数只记录命令，LCD_TileEnd() 时按条带逐个回放，
+// 回放复用原有绘图函数，像素经捕获后端写入条带缓冲区，每条合成完后整条发送到屏幕
+#define LCD_OP_Clear 0
+#define LCD_OP_ClearRect 1
+#define LCD_OP_FillRect 2
+#define LCD_OP_DrawPoint 3
+#define LCD_OP_DrawLine 4
+#define LCD_OP_DrawLine_V 5
+#define LCD_OP_DrawLine_H 6
+#define LCD_OP_DrawRect 7
+#define LCD_OP_DrawCircle 8
+#define LCD_OP_DrawEllipse 9
+#define LCD_OP_FillCircle 10
+#define LCD_OP_DrawImage 11
+#define LCD_OP_CopyBuffer 12
+#define LCD_OP_DisplayChar 13
+#define LCD_OP_DisplayChinese 14
+#define LCD_OP_DisplayString 15
+#define LCD_OP_DisplayText 16
+#define LCD_OP_DrawPolyline 17
+#define LCD_OP_PlotSeries 18
+#define LCD_OP_DrawImage565 19
+#define LCD_OP_DrawImage888 20
+#define LCD_OP_DisplayTextBox 21
+#define LCD_OP_DrawLayout 22
+#define LCD_OP_DisplayGlyphRun 23
+#define LCD_OP_DisplayTextRotated 24
+#define LCD_OP_DisplayTextVertical 25
+#define LCD_OP_DisplayRichText 26
+#define LCD_OP_DrawImageIndexed 27
+#define LCD_OP_DrawFlashIndexed 28
+#define LCD_OP_DrawImageRLE 29
+#define LCD_OP_DrawFlashRLE 30
+#define LCD_OP_DrawImageARGB4444 31
+#define LCD_OP_DrawImageA8 32
+#define LCD_OP_FillGradientV 33
+#define LCD_OP_FillGradientH 34
+#define LCD_OP_FillPattern 35
+#define LCD_OP_FillRoundRect 36
+#define LCD_OP_DrawRoundRect 37
+#define LCD_OP_DisplayGlyphIds 38
+
+#define LCD_TILE_STR 0xFFFF // 拷贝整个字符串
+
+typedef struct
+{
+	const void *Ptr;   // 图片/缓冲区地址，或拷贝到字符池中的字符串
+	LCD_State_t State; // 录制时的颜色、字体、字符模式
+	int16_t Arg[4];	   // 坐标、尺寸等参数
+	uint16_t Y1, Y2;   // 命令实际设置过的窗口行范围，Known 为0时未知
+	uint8_t Op;		   // 命令类型
+	uint8_t Known;	   // 1：Y1/Y2 已在第一次回放时得到
+} LCD_TileCmd_t;
+
+static LCD_TileCmd_t LCD_TileList[LCD_TILE_CMDS]; // 显示列表
+static char LCD_TileText[LCD_TILE_TEXT_BYTES];	   // 字符串池
+static uint16_t LCD_TileCount = 0;				   // 已录制命令数
+static uint16_t LCD_TileTextUsed = 0;			   // 字符串池已用字节
+static uint8_t LCD_Tile_Recording = 0;			   // 1：绘图函数只录制
+static uint16_t LCD_Tile_Back;					   // 列表未覆盖区域的颜色
+
+#define LCD_TILE_RECORD(op, a, b, c, d, ptr, copy) \
+	(LCD_Tile_Recording && LCD_Tile_Record(op, a, b, c, d, ptr, copy))
+
+static void LCD_Tile_Render(void);
+static void LCD_Gradient565(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t c1, uint16_t c2,
+							uint8_t dir); // 回放渐变填充
+
+/**
+ * @brief  录制一条绘图命令
+ * @param  copy 从 ptr 拷贝到字符串池的最大字节数，0表示只保存地址
+ * @retval 1：已录制，调用者直接返回；0：调用者照常直接写屏
+ * @note   列表或字符串池用完时先显示已录制的部分并停止录制，本条及之后的命令直接写屏
+ */
+static uint8_t LCD_Tile_Record(uint8_t op, int16_t a, int16_t b, int16_t c, int16_t d,
+							   const void *ptr, uint16_t copy)
+{
+	LCD_TileCmd_t *cmd;
+	uint16_t len = 0;
+
+	if (copy > 0)
+	{
+		const char *str = (const char *)ptr;
+
+		while (len < copy && str[len] != 0)
+			len++;
+	}
+	if (LCD_TileCount >= LCD_TILE_CMDS || (copy > 0 && LCD_TileTextUsed + len + 1 > LCD_TILE_TEXT_BYTES))
+	{
+		LCD_Tile_Render();
+		return 0;
+	}
+
+	cmd = &LCD_TileList[LCD_TileCount++];
+	if (copy > 0)
+	{
+		memcpy(&LCD_TileText[LCD_TileTextUsed], ptr, len);
+		LCD_TileText[LCD_TileTextUsed + len] = 0;
+		ptr = &LCD_TileText[LCD_TileTextUsed];
+		LCD_TileTextUsed += len + 1;
+	}
+	cmd->Ptr = ptr;
+	LCD_SaveState(&cmd->State);
+	cmd->Arg[0] = a;
+	cmd->Arg[1] = b;
+	cmd->Arg[2] = c;
+	cmd->Arg[3] = d;
+	cmd->Op = op;
+	cmd->Known = 0;
+	return 1;
+}
+
+/**
+ * @brief  以录制时的颜色、字体和字符模式重新执行一条命令
+ */
+static void LCD_Tile_Replay(const LCD_TileCmd_t *cmd)
+{
+	const int16_t *a = cmd->Arg;
+
+	LCD_LoadState(&cmd->State);
+
+	switch (cmd->Op)
+	{
+	case LCD_OP_Clear:
+		LCD_Clear();
+		break;
+	case LCD_OP_ClearRect:
+		LCD_ClearRect(a[0], a[1], a[2], a[3]);
+		break;
+	case LCD_OP_FillRect:
+		LCD_FillRect(a[0], a[1], a[2], a[3]);
+		break;
+	case LCD_OP_DrawPoint:
+		LCD_DrawPoint(a[0], a[1], (uint16_t)a[2]);
+		break;
+	case LCD_OP_DrawLine:
+		LCD_DrawLine(a[0], a[1], a[2], a[3]);
+		break;
+	case LCD_OP_DrawLine_V:
+		LCD_DrawLine_V(a[0], a[1], a[2]);
+		break;
+	case LCD_OP_DrawLine_H:
+		LCD_DrawLine_H(a[0], a[1], a[2]);
+		break;
+	case LCD_OP_DrawRect:
+		LCD_DrawRect(a[0], a[1], a[2], a[3]);
+		break;
+	case LCD_OP_DrawCircle:
+		LCD_DrawCircle(a[0], a[1], a[2]);
+		break;
+	case LCD_OP_DrawEllipse:
+		LCD_DrawEllipse(a[0], a[1], a[2], a[3]);
+		break;
+	case LCD_OP_FillCircle:
+		LCD_FillCircle(a[0], a[1], a[2]);
+		break;
+	case LCD_OP_DrawImage:
+		LCD_DrawImage(a[0], a[1], a[2], a[3], (const uint8_t *)cmd->Ptr);
+		break;
+	case LCD_OP_DrawPolyline:
+		LCD_DrawPolyline((const LCD_Point_t *)cmd->Ptr, (uint16_t)a[0]);
+		break;
+	case LCD_OP_PlotSeries:
+		LCD_PlotSeries((const int16_t *)cmd->Ptr, (uint16_t)a[0], a[1], a[2]);
+		break;
+	case LCD_OP_CopyBuffer:
+		LCD_CopyBuffer(a[0], a[1], a[2], a[3], (uint16_t *)cmd->Ptr);
+		break;
+	case LCD_OP_DrawImage565:
+		LCD_DrawImage565(a[0], a[1], a[2], a[3], (const uint16_t *)cmd->Ptr);
+		break;
+	case LCD_OP_DrawImage888:
+		LCD_DrawImage888(a[0], a[1], a[2], a[3], (const uint8_t *)cmd->Ptr);
+		break;
+	case LCD_OP_DrawImageIndexed:
+		LCD_DrawImageIndexed(a[0], a[1], (const LCD_IndexedImage_t *)cmd->Ptr);
+		break;
+	case LCD_OP_DrawImageRLE:
+		LCD_DrawImageRLE(a[0], a[1], (const LCD_RleImage_t *)cmd->Ptr);
+		break;
+	case LCD_OP_DrawImageARGB4444:
+		LCD_DrawImageARGB4444(a[0], a[1], a[2], a[3], (const uint16_t *)cmd->Ptr);
+		break;
+	case LCD_OP_DrawImageA8:
+		LCD_DrawImageA8(a[0], a[1], a[2], a[3], (const uint8_t *)cmd->Ptr);
+		break;
+	case LCD_OP_FillGradientV:
+	case LCD_OP_FillGradientH:
+		LCD_Gradient565(a[0], a[1], a[2], a[3], (uint16_t)LCD.Color, (uint16_t)LCD.BackColor,
+						(cmd->Op == LCD_OP_FillGradientH) ? LCD_GRADIENT_H : LCD_GRADIENT_V);
+		break;
+	case LCD_OP_FillPattern:
+		LCD_FillPattern(a[0], a[1], a[2], a[3], (const LCD_Pattern_t *)cmd->Ptr);
+		break;
+	case LCD_OP_FillRoundRect:
+		LCD_FillRoundRect(a[0], a[1], a[2], a[3], (uint16_t)(uintptr_t)cmd->Ptr);
+		break;
+	case LCD_OP_DrawRoundRect:
+		LCD_DrawRoundRect(a[0], a[1], a[2], a[3], (uint16_t)(uintptr_t)cmd->Ptr);
+		break;
+#ifdef USE_FLASH_FONT
+	case LCD_OP_DrawFlashIndexed:
+		LCD_DrawFlashIndexed(a[0], a[1], (uint16_t)a[2]);
+		break;
+	case LCD_OP_DrawFlashRLE:
+		LCD_DrawFlashRLE(a[0], a[1], (uint16_t)a[2]);
+		break;
+#endif
+	case LCD_OP_DisplayChar:
+		LCD_DisplayChar(a[0], a[1], (uint8_t)a[2]);
+		break;
+	case LCD_OP_DisplayChinese:
+		LCD_DisplayChinese(a[0], a[1], (char *)cmd->Ptr);
+		break;
+	case LCD_OP_DisplayString:
+		LCD_DisplayString(a[0], a[1], (char *)cmd->Ptr);
+		break;
+	case LCD_OP_DisplayText:
+		LCD_DisplayText(a[0], a[1], (char *)cmd->Ptr);
+		break;
+	case LCD_OP_DisplayTextBox:
+		LCD_DisplayTextBox(a[0], a[1], a[2], (char *)cmd->Ptr, (uint8_t)a[3]);
+		break;
+	case LCD_OP_DrawLayout:
+		LCD_DrawLayout((const LCD_Layout_t *)cmd->Ptr, a[0], a[1]);
+		break;
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+	case LCD_OP_DisplayGlyphRun:
+		LCD_DisplayGlyphRun(a[0], a[1], (const FontGlyphRun_t *)cmd->Ptr);
+		break;
+	case LCD_OP_DisplayGlyphIds:
+		LCD_DisplayGlyphIds(a[0], a[1], (const LCD_GlyphIds_t *)cmd->Ptr);
+		break;
+#endif
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312) && defined(LCD_TEXT_ROTATE_ENABLE)
+	case LCD_OP_DisplayTextRotated:
+		LCD_DisplayTextRotated(a[0], a[1], (char *)cmd->Ptr, (uint8_t)a[2]);
+		break;
+#endif
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+	case LCD_OP_DisplayTextVertical:
+		LCD_DisplayTextVertical(a[0], a[1], (char *)cmd->Ptr);
+		break;
+#endif
+	case LCD_OP_DisplayRichText:
+		LCD_DisplayRichText(a[0], a[1], (const LCD_RichText_t *)cmd->Ptr);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief  按条带回放显示列表并发送，结束录制
+ * @note   命令第一次回放时记下实际设置过的窗口行范围，之后与条带不相交就跳过
+ */
+static void LCD_Tile_Render(void)
+{
+	LCD_State_t user;							 // 用户当前的绘图状态
+	uint16_t rows = LCD_TILE_PIXELS / LCD.Width; // 每个条带的行数
+	uint8_t k = 0;
+
+	LCD_SaveState(&user);
+	LCD_Tile_Recording = 0;
+
+	for (uint16_t y0 = 0; y0 < LCD.Height; y0 += rows)
+	{
+		uint16_t n = (LCD.Height - y0 < rows) ? (LCD.Height - y0) : rows;
+		uint16_t *pTile = LCD_TileBuff[k];
+		uint32_t *p32 = (uint32_t *)pTile;
+		uint32_t fill = LCD_Tile_Back | ((uint32_t)LCD_Tile_Back << 16);
+
+		k = (uint8_t)((k + 1) % LCD_TILE_COUNT);
+		LCD_WaitBuff(pTile); // 该条带缓冲区可能还在发送
+
+		for (uint32_t i = 0; i < ((uint32_t)n * LCD.Width + 1) / 2; i++)
+			p32[i] = fill;
+
+		LCD_Cap_Target = pTile;
+		LCD_Cap_Y0 = y0;
+		LCD_Cap_Rows = n;
+		LCD_Cap_Stride = LCD.Width;
+		for (uint16_t i = 0; i < LCD_TileCount; i++)
+		{
+			LCD_TileCmd_t *cmd = &LCD_TileList[i];
+
+			if (cmd->Known && (cmd->Y1 > y0 + n - 1 || cmd->Y2 < y0))
+				continue; // 与本条带不相交
+			LCD_Tile_ExtY1 = 0xFFFF;
+			LCD_Tile_ExtY2 = 0;
+			LCD_Tile_Replay(cmd);
+			if (!cmd->Known)
+			{
+				cmd->Y1 = LCD_Tile_ExtY1; // 没有设置过窗口时 Y1>Y2，之后总是跳过
+				cmd->Y2 = LCD_Tile_ExtY2;
+				cmd->Known = 1;
+			}
+		}
+		LCD_Cap_Target = NULL;
+
+		LCD_Clip = (LCD_Rect_t)LCD_CLIP_NONE_RECT; // 条带已按各命令的裁剪区合成
+		LCD_SetAddress(0, y0, LCD.Width - 1, LCD.Height - 1); // 窗口到屏幕底部，之后的条带接着写入，不再发送指令
+		LCD_WriteBuff(pTile, n * LCD.Width); // 后台发送，同时回放下一条
+	}
+
+	LCD_TileCount = 0;
+	LCD_TileTextUsed = 0;
+
+	LCD_LoadState(&user);
+}
+#else
+#define LCD_TILE_RECORD(op, a, b, c, d, ptr, copy) 0
+#endif
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_TileBegin
+ *
+ *	函数功能: 开始录制显示列表
+ *
+ *	说    明: 1. 之后调用的绘图、显示字符函数只记录命令，直到 LCD_TileEnd() 才显示
+ *				2. 列表未覆盖的区域显示为调用本函数时的背景色
+ *				3. LCD_DrawImage()/LCD_CopyBuffer() 只记录数据地址，字符串会拷贝保存
+ *				4. 未定义 LCD_TILE_ENABLE 时立即返回，绘图照常直接写屏
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_TileBegin(void)
+{
+#ifdef LCD_TILE_ENABLE
+	LCD_TileCount = 0;
+	LCD_TileTextUsed = 0;
+	LCD_Tile_Back = (uint16_t)LCD.BackColor;
+	LCD_Tile_Recording = 1;
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_TileEnd
+ *
+ *	函数功能: 结束录制，按条带回放显示列表并发送到屏幕
+ *
+ *	说    明: 1. 每个条带(LCD_TILE_PIXELS 个像素)先在内存中合成，后画的命令覆盖先画的，整条只设置一次窗口
+ *				2. 条带缓冲区轮流使用，一条在DMA发送时回放下一条
+ *				3. 未定义 LCD_TILE_ENABLE 或未在录制时立即返回
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_TileEnd(void)
+{
+#ifdef LCD_TILE_ENABLE
+	if (LCD_Tile_Recording)
+	{
+		LCD_Tile_Render();
+	}
+#endif
+}
+
+// 命令队列：LCD_Queue_*() 只把命令(连同当时的颜色、字体、字符模式)追加到所属优先级的链表，
+// LCD_Queue_Poll() 在主循环中调用，BDMA空闲时取出优先级最高的一条执行；填充和缓冲区发送交给BDMA后立即返回主循环，
+// 下一次调用时DMA已结束才算完成(或完成一段)，再按优先级选择下一条
+#define LCD_QOP_Clear 0
+#define LCD_QOP_FillRect 1
+#define LCD_QOP_Text 2
+#define LCD_QOP_Image 3
+#define LCD_QOP_Copy 4
+#define LCD_QOP_Fence 5
+#define LCD_QOP_GlyphIds 6
+
+static uint32_t LCD_QueueIssued = 0; // 最近一次排入命令的序号
+static volatile uint32_t LCD_QueueDone = 0; // 已完成的命令数
+static uint8_t LCD_QueuePrio = LCD_PRIO_LIVE; // LCD_Queue_*() 排入命令的优先级
+
+/**
+ * @brief  以命令自身的参数执行一条命令
+ */
+static void LCD_Queue_Exec(uint8_t op, const uint16_t *a, const void *ptr)
+{
+	switch (op)
+	{
+	case LCD_QOP_Clear:
+		LCD_Clear();
+		break;
+	case LCD_QOP_FillRect:
+		LCD_FillRect(a[0], a[1], a[2], a[3]);
+		break;
+	case LCD_QOP_Text:
+		LCD_DisplayText(a[0], a[1], (char *)ptr);
+		break;
+	case LCD_QOP_Image:
+		LCD_DrawImage(a[0], a[1], a[2], a[3], (const uint8_t *)ptr);
+		break;
+	case LCD_QOP_Copy:
+		LCD_CopyBuffer(a[0], a[1], a[2], a[3], (uint16_t *)ptr);
+		break;
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+	case LCD_QOP_GlyphIds:
+		LCD_DisplayGlyphIds(a[0], a[1], (const LCD_GlyphIds_t *)ptr);
+		break;
+#endif
+	default:
+		break; // 栅栏只有回调
+	}
+}
+
+#ifdef LCD_ALARM_ENABLE
+#if !defined(USE_FLASH_FONT) || defined(IS_GB2312) || !defined(GLYPH_CACHE_ENABLE) || GLYPH_CACHE_LOCK_SLOTS < 1
+#error "LCD_ALARM_ENABLE 需要UTF-8 Flash字库和 GLYPH_CACHE_ENABLE，并把 GLYPH_CACHE_LOCK_SLOTS 设为不小于报警字符数"
+#endif
+
+typedef struct
+{
+	const uint8_t *Data; // 锁定分区中的字模
+	uint32_t Cp;		 // Unicode码点
+	uint8_t Width;		 // 字模单元宽度
+	uint8_t Packed;		 // 字模存储方式，见 Glyph_RowBegin()
+} LCD_AlarmGlyph_t;
+
+// 报警路径只读写DTCM：字符表、状态和统计
+DTCM_BSS static LCD_AlarmGlyph_t LCD_AlarmGlyph[GLYPH_CACHE_LOCK_SLOTS];
+DTCM_BSS static LCD_AlarmStats_t LCD_AlarmStats;
+DTCM_BSS static uint8_t LCD_AlarmSize;			 // 报警字号，0表示未加载
+DTCM_BSS static volatile uint8_t LCD_AlarmActive; // 1：报警中，不接纳背景命令
+#endif
+
+#ifdef LCD_QUEUE_ENABLE
+#if LCD_QUEUE_CMDS > 255
+#error "LCD_QUEUE_CMDS 不能超过255(链表下标为8位)"
+#endif
+#define LCD_QUEUE_NONE 0xFF // 空链表/没有执行中的命令
+
+typedef struct
+{
+	const void *Ptr;			  // 图片/缓冲区地址，或拷贝到字符池中的字符串
+	LCD_QueueCallback_t Callback; // 完成回调，可为NULL
+	void *CallbackArg;			  // 回调参数
+	LCD_State_t State;			  // 排入时的颜色、字体、字符模式
+	uint32_t Seq;				  // 命令序号，空闲项为0
+	uint32_t Stamp;				  // 排入时的DWT周期计数
+	uint16_t Arg[4];			  // 坐标、尺寸
+	uint16_t Row;				  // 分段执行时已完成的行数
+	uint8_t Op;					  // 命令类型
+	uint8_t Prio;				  // 优先级
+	uint8_t Next;				  // 同一优先级的下一条命令，或空闲链表的下一项
+} LCD_QueueCmd_t;
+
+static LCD_QueueCmd_t LCD_QueueList[LCD_QUEUE_CMDS]; // 命令池，各优先级的链表共用
+static char LCD_QueueText[LCD_QUEUE_TEXT_BYTES];	  // 字符串池，队列清空时整体回收
+static uint8_t LCD_QueueFirst[LCD_QUEUE_CLASSES] = {LCD_QUEUE_NONE, LCD_QUEUE_NONE, LCD_QUEUE_NONE}; // 各优先级最早的命令
+static uint8_t LCD_QueueLast[LCD_QUEUE_CLASSES];	  // 各优先级最近排入的命令
+static uint8_t LCD_QueueFree = LCD_QUEUE_NONE;		  // 回收的空闲项
+static uint8_t LCD_QueueFresh = 0;					  // 从未使用过的项从这里开始
+static uint8_t LCD_QueueActive = LCD_QUEUE_NONE;	  // 已执行、等待DMA传输结束的命令
+static uint8_t LCD_QueueStrip = LCD_QUEUE_NONE;		  // 执行到一半的命令，让给其他命令时计入 Preempts
+static volatile uint16_t LCD_QueueCount = 0;		  // 队列中的命令数
+static uint16_t LCD_QueueTextUsed = 0;				  // 字符串池已用字节
+static uint8_t LCD_Queue_Busy = 0;					  // 1：LCD_Queue_Poll() 执行中(含回调)
+static LCD_QueueStats_t LCD_QueueStats;				  // 延迟统计
+
+#ifdef LCD_SPI_DMA_ENABLE
+#define LCD_QUEUE_DMA_BUSY() (LCD_DMA_TxBuff != NULL)
+#else
+#define LCD_QUEUE_DMA_BUSY() 0
+#endif
+
+// 排入与结束命令时的临界区，默认关中断；使用RTOS时在 lcd_spi.h 中改为 taskENTER_CRITICAL() 或互斥量
+#ifndef LCD_QUEUE_LOCK
+static uint32_t LCD_QueuePrimask; // 进入临界区前的PRIMASK，临界区不嵌套
+#define LCD_QUEUE_LOCK()                     \
+	do                                       \
+	{                                        \
+		uint32_t primask = __get_PRIMASK();  \
+		__disable_irq();                     \
+		LCD_QueuePrimask = primask;          \
+	} while (0)
+#define LCD_QUEUE_UNLOCK() __set_PRIMASK(LCD_QueuePrimask)
+#endif
+#ifndef LCD_QUEUE_YIELD
+#define LCD_QUEUE_YIELD() // 等待渲染任务时无事可做，使用RTOS时改为 osDelay(1)
+#endif
+
+/**
+ * @brief  命令的总行数，文本、编号串和栅栏不分段，按1行计
+ */
+static uint16_t LCD_Queue_Rows(const LCD_QueueCmd_t *cmd)
+{
+	switch (cmd->Op)
+	{
+	case LCD_QOP_Clear:
+		return LCD.Height;
+	case LCD_QOP_FillRect:
+	case LCD_QOP_Image:
+	case LCD_QOP_Copy:
+		return cmd->Arg[3];
+	default:
+		return 1;
+	}
+}
+
+/**
+ * @brief  执行命令的下一段，返回后 Row 为已完成的行数
+ * @note   输入反馈命令和不超过一段的命令整条执行；其余从第 Row 行起执行 LCD_QUEUE_STRIP_ROWS 行，
+ *         图片和缓冲区按已完成的行数偏移数据地址
+ */
+static void LCD_Queue_Step(LCD_QueueCmd_t *cmd)
+{
+	uint16_t rows = LCD_Queue_Rows(cmd);
+	const uint16_t *a = cmd->Arg;
+	uint16_t row = cmd->Row;
+	uint16_t n;
+
+	if (LCD_QUEUE_STRIP_ROWS == 0 || cmd->Prio == LCD_PRIO_INPUT || cmd->Op == LCD_QOP_Text ||
+		cmd->Op == LCD_QOP_GlyphIds || cmd->Op == LCD_QOP_Fence || (row == 0 && rows <= LCD_QUEUE_STRIP_ROWS))
+	{
+		LCD_Queue_Exec(cmd->Op, a, cmd->Ptr);
+		cmd->Row = rows;
+		return;
+	}
+
+	n = (uint16_t)((rows - row < LCD_QUEUE_STRIP_ROWS) ? rows - row : LCD_QUEUE_STRIP_ROWS);
+	switch (cmd->Op)
+	{
+	case LCD_QOP_Clear:
+		LCD_ClearRect(0, row, LCD.Width, n);
+		break;
+	case LCD_QOP_FillRect:
+		LCD_FillRect(a[0], (uint16_t)(a[1] + row), a[2], n);
+		break;
+	case LCD_QOP_Image:
+		LCD_DrawImage(a[0], (uint16_t)(a[1] + row), a[2], n,
+					  (const uint8_t *)cmd->Ptr + (uint32_t)row * ((a[2] + 7) / 8));
+		break;
+	default:
+		LCD_CopyBuffer(a[0], (uint16_t)(a[1] + row), a[2], n, (uint16_t *)cmd->Ptr + (uint32_t)row * a[2]);
+		break;
+	}
+	cmd->Row = (uint16_t)(row + n);
+	LCD_QueueStats.Strips++;
+}
+
+/**
+ * @brief  结束一条执行完的命令：移出所属优先级的链表、回收为空闲项并记录延迟
+ * @retval 命令序号
+ */
+static uint32_t LCD_Queue_Retire(uint8_t index)
+{
+	LCD_QueueCmd_t *cmd = &LCD_QueueList[index];
+	LCD_QueueLatency_t *lat = &LCD_QueueStats.Class[cmd->Prio];
+	uint32_t wait = DWT->CYCCNT - cmd->Stamp;
+	uint32_t seq = cmd->Seq;
+
+	LCD_QUEUE_LOCK(); // 其他任务可能同时在排入
+	LCD_QueueFirst[cmd->Prio] = cmd->Next; // 只执行各链表的第一条
+	cmd->Seq = 0;
+	cmd->Next = LCD_QueueFree;
+	LCD_QueueFree = index;
+	LCD_QueueCount--;
+	LCD_QueueDone++;
+	if (LCD_QueueCount == 0)
+		LCD_QueueTextUsed = 0; // 回收字符池
+	LCD_QUEUE_UNLOCK();
+
+	lat->Count++;
+	lat->TotalCycles += wait;
+	if (wait > lat->MaxCycles)
+		lat->MaxCycles = wait;
+	return seq;
+}
+#endif
+
+#if defined(LCD_QUEUE_ENABLE) && !defined(LCD_QUEUE_SERVER)
+/**
+ * @brief  执行队列直到全部完成(各优先级)，字符池在清空后回收
+ */
+static void LCD_Queue_Drain(void)
+{
+	while (LCD_QueueCount > 0)
+	{
+		LCD_WaitIdle(); // 带超时等待DMA，避免传输异常时死等
+		LCD_Queue_Poll();
+	}
+}
+#endif
+
+/**
+ * @brief  排入一条命令
+ * @param  args 4个参数(坐标、尺寸)
+ * @param  copy 1：把 ptr 指向的字符串拷贝到字符池
+ * @param  state 执行时使用的绘图状态，NULL表示排入时的全局状态
+ * @param  prio 优先级 LCD_PRIO_*
+ * @retval 命令序号；无法排入时返回0(命令被丢弃)
+ * @note   1. 队列或字符池用完时先执行已排入的命令腾出空间；在完成回调中，或定义 LCD_QUEUE_SERVER 时
+ *            (只有渲染任务执行命令)直接返回0
+ *         2. 字符串超过整个字符池时等队列执行完后直接绘制
+ *         3. 未定义 LCD_QUEUE_ENABLE 时直接执行并调用回调
+ *         4. 报警期间(LCD_Alarm_Show() 之后、LCD_Alarm_Release() 之前)背景优先级的命令直接返回0
+ */
+static uint32_t LCD_Queue_Push(uint8_t op, const uint16_t *args, const void *ptr, uint8_t copy,
+							   const LCD_State_t *state, LCD_QueueCallback_t callback, void *arg, uint8_t prio)
+{
+#ifdef LCD_ALARM_ENABLE
+	if (LCD_AlarmActive && prio >= LCD_PRIO_BACKGROUND)
+	{
+		LCD_AlarmStats.Refused++; // 准入控制：报警期间队列中只有数量有限的输入和实时命令
+		return 0;
+	}
+#endif
+#ifdef LCD_QUEUE_ENABLE
+	LCD_QueueCmd_t *cmd;
+	uint16_t len = (copy && ptr != NULL) ? (uint16_t)strlen((const char *)ptr) : 0;
+	uint32_t seq;
+	uint8_t index;
+
+	if (prio >= LCD_QUEUE_CLASSES)
+		prio = LCD_QUEUE_CLASSES - 1;
+	if (len + 1 > LCD_QUEUE_TEXT_BYTES) // 字符池放不下，按顺序同步绘制
+	{
+#ifdef LCD_QUEUE_SERVER
+		return 0;
+#else
+		if (LCD_Queue_Busy)
+			return 0;
+		LCD_Queue_Drain();
+		copy = 0;
+#endif
+	}
+	else
+	{
+		LCD_QUEUE_LOCK();
+		while (LCD_QueueCount >= LCD_QUEUE_CMDS || (copy && LCD_QueueTextUsed + len + 1 > LCD_QUEUE_TEXT_BYTES))
+		{
+			LCD_QUEUE_UNLOCK();
+#ifdef LCD_QUEUE_SERVER
+			return 0; // 由调用者稍后重试
+#else
+			if (LCD_Queue_Busy)
+				return 0; // 回调中无法等待
+			if (LCD_QueueCount >= LCD_QUEUE_CMDS)
+			{
+				LCD_WaitIdle(); // 带超时等待，再执行一步腾出空间
+				LCD_Queue_Poll();
+			}
+			else
+				LCD_Queue_Drain(); // 字符池在队列清空后回收
+			LCD_QUEUE_LOCK();
+#endif
+		}
+
+		if (LCD_QueueFree != LCD_QUEUE_NONE)
+		{
+			index = LCD_QueueFree;
+			LCD_QueueFree = LCD_QueueList[index].Next;
+		}
+		else
+			index = LCD_QueueFresh++;
+		cmd = &LCD_QueueList[index];
+		if (copy)
+		{
+			memcpy(&LCD_QueueText[LCD_QueueTextUsed], ptr, len + 1);
+			ptr = &LCD_QueueText[LCD_QueueTextUsed];
+			LCD_QueueTextUsed += len + 1;
+		}
+		cmd->Ptr = ptr;
+		cmd->Callback = callback;
+		cmd->CallbackArg = arg;
+		if (state != NULL)
+			cmd->State = *state;
+		else
+			LCD_SaveState(&cmd->State);
+		memcpy(cmd->Arg, args, sizeof(cmd->Arg));
+		cmd->Op = op;
+		cmd->Prio = prio;
+		cmd->Row = 0;
+		cmd->Next = LCD_QUEUE_NONE;
+		cmd->Stamp = DWT->CYCCNT;
+		seq = ++LCD_QueueIssued;
+		cmd->Seq = seq;
+		if (LCD_QueueFirst[prio] == LCD_QUEUE_NONE)
+			LCD_QueueFirst[prio] = index;
+		else
+			LCD_QueueList[LCD_QueueLast[prio]].Next = index;
+		LCD_QueueLast[prio] = index;
+		LCD_QueueCount++;
+		if (LCD_QueueCount > LCD_QueueStats.MaxPending)
+			LCD_QueueStats.MaxPending = LCD_QueueCount;
+		LCD_QUEUE_UNLOCK();
+		return seq;
+	}
+#else
+	(void)prio;
+#endif
+
+	if (state != NULL)
+	{
+		LCD_State_t user;
+
+		LCD_SaveState(&user);
+		LCD_LoadState(state);
+		LCD_Queue_Exec(op, args, ptr);
+		LCD_LoadState(&user);
+	}
+	else
+	{
+		LCD_Queue_Exec(op, args, ptr);
+	}
+	LCD_WaitIdle(); // 同步执行时返回前已发送完
+	LCD_QueueDone = ++LCD_QueueIssued;
+	if (callback != NULL)
+		callback(LCD_QueueDone, arg);
+	return LCD_QueueDone;
+}
+
+/**
+ * @brief  排入一条使用全局绘图状态的命令
+ */
+static uint32_t LCD_Queue_Post(uint8_t op, uint16_t a, uint16_t b, uint16_t c, uint16_t d, const void *ptr,
+							   uint8_t copy)
+{
+	uint16_t args[4] = {a, b, c, d};
+
+	return LCD_Queue_Push(op, args, ptr, copy, NULL, NULL, NULL, LCD_QueuePrio);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Queue_Clear / LCD_Queue_FillRect / LCD_Queue_Text / LCD_Queue_Image / LCD_Queue_Copy
+ *
+ *	入口参数: 与 LCD_Clear()、LCD_FillRect()、LCD_DisplayText()、LCD_DrawImage()、LCD_CopyBuffer() 相同
+ *
+ *	返 回 值: 命令序号，用于 LCD_Queue_IsDone() / LCD_Queue_Wait()
+ *
+ *	函数功能: 排入对应的绘图命令后立即返回
+ *
+ *	说    明: 1. 使用排入时的画笔色、背景色、字体和字符模式，之后修改不影响已排入的命令
+ *				2. 字符串会拷贝保存；图片和缓冲区只记录地址，命令完成之前数据必须保持有效
+ *				3. 未定义 LCD_QUEUE_ENABLE 时同步绘制，返回时已完成
+ *
+ ****************************************************************************************************************************************/
+
+uint32_t LCD_Queue_Clear(void)
+{
+	return LCD_Queue_Post(LCD_QOP_Clear, 0, 0, 0, 0, NULL, 0);
+}
+
+uint32_t LCD_Queue_FillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	return LCD_Queue_Post(LCD_QOP_FillRect, x, y, width, height, NULL, 0);
+}
+
+uint32_t LCD_Queue_Text(uint16_t x, uint16_t y, const char *pText)
+{
+	return LCD_Queue_Post(LCD_QOP_Text, x, y, 0, 0, pText, 1);
+}
+
+uint32_t LCD_Queue_Image(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pImage)
+{
+	return LCD_Queue_Post(LCD_QOP_Image, x, y, width, height, pImage, 0);
+}
+
+uint32_t LCD_Queue_Copy(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *DataBuff)
+{
+	return LCD_Queue_Post(LCD_QOP_Copy, x, y, width, height, DataBuff, 0);
+}
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Queue_GlyphIds
+ *
+ *	入口参数: 与 LCD_DisplayGlyphIds() 相同
+ *
+ *	返 回 值: 命令序号，用于 LCD_Queue_IsDone() / LCD_Queue_Wait()
+ *
+ *	函数功能: 排入字符编号串命令后立即返回
+ *
+ *	说    明: 与图片相同只记录 run 的地址，不拷贝编号，命令完成之前 run 及其指向的编号和对照表必须保持有效
+ *
+ ****************************************************************************************************************************************/
+
+uint32_t LCD_Queue_GlyphIds(uint16_t x, uint16_t y, const LCD_GlyphIds_t *run)
+{
+	return LCD_Queue_Post(LCD_QOP_GlyphIds, x, y, 0, 0, run, 0);
+}
+#endif
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Queue_Fence
+ *
+ *	入口参数: callback - 之前排入的同一优先级及更高优先级的命令全部完成(含DMA发送)后调用，可为NULL
+ *				arg - 回调参数
+ *
+ *	返 回 值: 栅栏序号
+ *
+ *	函数功能: 在队列中插入栅栏
+ *
+ *	说    明: 1. 回调在 LCD_Queue_Poll() 中调用，参数为栅栏序号；回调中可以排入新命令，不能调用 LCD_Queue_Wait()
+ *				2. 栅栏使用 LCD_Queue_SetPriority() 设置的优先级，较低优先级的命令可能尚未完成
+ *				3. 未定义 LCD_QUEUE_ENABLE 时立即调用回调
+ *
+ ****************************************************************************************************************************************/
+
+uint32_t LCD_Queue_Fence(LCD_QueueCallback_t callback, void *arg)
+{
+	uint16_t args[4] = {0};
+
+	return LCD_Queue_Push(LCD_QOP_Fence, args, NULL, 0, NULL, callback, arg, LCD_QueuePrio);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Queue_IsDone
+ *
+ *	入口参数: seq - LCD_Queue_*() 返回的序号
+ *
+ *	返 回 值: 1-该命令已完成，0-尚未完成
+ *
+ *	说    明: 同一优先级的命令按排入顺序完成，高优先级的命令可能先于之前排入的低优先级命令完成
+ *
+ ****************************************************************************************************************************************/
+
+uint8_t LCD_Queue_IsDone(uint32_t seq)
+{
+#ifdef LCD_QUEUE_ENABLE
+	uint8_t i;
+
+	if (seq == 0)
+		return 1;
+	if ((int32_t)(seq - LCD_QueueIssued) > 0)
+		return 0; // 尚未排入
+	for (i = 0; i < LCD_QueueFresh; i++)
+	{
+		if (LCD_QueueList[i].Seq == seq)
+			return 0; // 仍在队列中
+	}
+	return 1;
+#else
+	return (int32_t)(LCD_QueueDone - seq) >= 0;
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Queue_Wait
+ *
+ *	入口参数: seq - LCD_Queue_*() 返回的序号
+ *
+ *	函数功能: 执行队列直到该命令完成
+ *
+ *	说    明: 1. 不能在完成回调中调用
+ *				2. 定义 LCD_QUEUE_SERVER 时只等待渲染任务执行，等待期间调用 LCD_QUEUE_YIELD()
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_Queue_Wait(uint32_t seq)
+{
+#if defined(LCD_QUEUE_ENABLE) && defined(LCD_QUEUE_SERVER)
+	while (!LCD_Queue_IsDone(seq))
+	{
+		LCD_QUEUE_YIELD(); // 由渲染任务执行
+	}
+#elif defined(LCD_QUEUE_ENABLE)
+	if (LCD_Queue_Busy)
+		return;
+	while (!LCD_Queue_IsDone(seq))
+	{
+		LCD_WaitIdle(); // 带超时等待DMA，避免传输异常时死等
+		LCD_Queue_Poll();
+	}
+#else
+	(void)seq;
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Queue_Pending
+ *
+ *	返 回 值: 队列中尚未完成的命令数
+ *
+ ****************************************************************************************************************************************/
+
+uint16_t LCD_Queue_Pending(void)
+{
+	return (uint16_t)(LCD_QueueIssued - LCD_QueueDone);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Queue_Poll
+ *
+ *	函数功能: 执行队列中的命令
+ *
+ *	说    明: 1. 在 main_while() 中周期调用；BDMA正在发送时立即返回，DMA空闲后结束上一条命令并执行下一条
+ *				2. 每次从优先级最高的非空链表取命令；较低优先级的清屏、填充、图片和缓冲区发送
+ *				   按 LCD_QUEUE_STRIP_ROWS 行分段执行，每段结束后重新选择，输入反馈命令最多等待一段
+ *				3. 连续执行不超过 LCD_QUEUE_SLICE_MS 毫秒，文本命令(如整行文本)不会被拆开
+ *				4. 队列中还有命令时不要直接调用其他绘图函数，否则显示顺序与调用顺序不一致
+ *				5. 定义 LCD_QUEUE_SERVER 时只能由渲染任务调用，该任务独占SPI6和字库
+ *				6. 未定义 LCD_QUEUE_ENABLE 时立即返回
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_Queue_Poll(void)
+{
+#ifdef LCD_QUEUE_ENABLE
+	uint32_t tickstart = HAL_GetTick();
+	LCD_State_t user; // 用户当前的绘图状态
+
+	if (LCD_QueueCount == 0 || LCD_Queue_Busy)
+		return;
+	LCD_Queue_Busy = 1;
+	LCD_SaveState(&user);
+
+	while (LCD_QueueCount > 0)
+	{
+		LCD_QueueCmd_t *cmd;
+		uint8_t prio;
+
+		if (LCD_QueueActive != LCD_QUEUE_NONE)
+		{
+			if (LCD_QUEUE_DMA_BUSY())
+				break; // 后台仍在发送，先回到主循环
+
+			cmd = &LCD_QueueList[LCD_QueueActive];
+			if (cmd->Row < LCD_Queue_Rows(cmd))
+			{
+				LCD_QueueStrip = LCD_QueueActive; // 还有后续分段，留在链表头
+			}
+			else
+			{
+				LCD_QueueCallback_t callback = cmd->Callback;
+				void *arg = cmd->CallbackArg;
+				uint32_t seq = LCD_Queue_Retire(LCD_QueueActive);
+
+				if (LCD_QueueStrip == LCD_QueueActive)
+					LCD_QueueStrip = LCD_QUEUE_NONE;
+				LCD_QueueActive = LCD_QUEUE_NONE;
+				if (callback != NULL)
+				{
+					LCD_LoadState(&user); // 回调中看到的是用户自己的绘图状态
+					callback(seq, arg);
+					LCD_SaveState(&user);
+				}
+				continue;
+			}
+			LCD_QueueActive = LCD_QUEUE_NONE;
+		}
+		if ((HAL_GetTick() - tickstart) >= LCD_QUEUE_SLICE_MS)
+			break; // 本次时间片用完
+
+		for (prio = 0; LCD_QueueFirst[prio] == LCD_QUEUE_NONE; prio++)
+		{
+		}
+		LCD_QueueActive = LCD_QueueFirst[prio];
+		if (LCD_QueueStrip != LCD_QUEUE_NONE && LCD_QueueStrip != LCD_QueueActive)
+		{
+			LCD_QueueStats.Preempts++; // 分段执行的命令让给更高优先级
+			LCD_QueueStrip = LCD_QUEUE_NONE;
+		}
+		cmd = &LCD_QueueList[LCD_QueueActive];
+		LCD_LoadState(&cmd->State);
+		LCD_Queue_Step(cmd);
+	}
+
+	LCD_LoadState(&user);
+	LCD_Queue_Busy = 0;
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Queue_SetPriority
+ *
+ *	入口参数: prio - LCD_Queue_*() 之后排入命令的优先级，LCD_PRIO_INPUT / LCD_PRIO_LIVE / LCD_PRIO_BACKGROUND
+ *
+ *	返 回 值: 原来的优先级
+ *
+ *	说    明: 1. 默认为 LCD_PRIO_LIVE；绘图上下文的命令使用 LCD_GC_SetPriority() 设置的优先级
+ *				2. 按键、触摸的反馈画面用 LCD_PRIO_INPUT 排入，整屏背景等大面积绘制用 LCD_PRIO_BACKGROUND
+ *
+ ****************************************************************************************************************************************/
+
+uint8_t LCD_Queue_SetPriority(uint8_t prio)
+{
+	uint8_t old = LCD_QueuePrio;
+
+	LCD_QueuePrio = (prio < LCD_QUEUE_CLASSES) ? prio : (LCD_QUEUE_CLASSES - 1);
+	return old;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_Queue_GetStats
+ *
+ *	入口参数: stats - 输出
+ *				reset - 1：读取后清零
+ *
+ *	函数功能: 读取各优先级从排入到完成的延迟(DWT周期)、分段数和抢占次数
+ *
+ *	说    明: 未定义 LCD_QUEUE_ENABLE 时输出全0
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_Queue_GetStats(LCD_QueueStats_t *stats, uint8_t reset)
+{
+#ifdef LCD_QUEUE_ENABLE
+	*stats = LCD_QueueStats;
+	if (reset)
+		memset(&LCD_QueueStats, 0, sizeof(LCD_QueueStats));
+#else
+	(void)reset;
+	memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+/**
+ * @brief  RGB888 转 RGB565，与 LCD_SetColor() 相同
+ */
+static uint16_t LCD_ToRGB565(uint32_t Color)
+{
+	return (uint16_t)(((Color & 0x00F80000) >> 8) | ((Color & 0x0000FC00) >> 5) | ((Color & 0x000000F8) >> 3));
+}
+
+/**
+ * @brief  把绘图上下文转换为执行命令时加载的绘图状态，颜色和字体已在设置时转换好，只需拷贝
+ */
+static void LCD_GC_State(const LCD_GC_t *gc, LCD_State_t *state)
+{
+	state->AsciiFonts = gc->AsciiFonts;
+	state->CHFonts = gc->CHFonts;
+	state->Color = gc->Color;
+	state->BackColor = gc->BackColor;
+	state->Text_Mode = gc->TextMode;
+	state->Text_Scale = gc->TextScale;
+	state->Text_Effect = gc->TextEffect;
+	state->Effect_Color = gc->EffectColor;
+	state->Family = gc->Family;
+	state->Encoding = gc->Encoding;
+	if (gc->ClipWidth == 0 || gc->ClipHeight == 0)
+	{
+		state->Clip = (LCD_Rect_t)LCD_CLIP_NONE_RECT;
+	}
+	else
+	{
+		state->Clip.x1 = gc->ClipX;
+		state->Clip.y1 = gc->ClipY;
+		state->Clip.x2 = (uint16_t)(gc->ClipX + gc->ClipWidth - 1);
+		state->Clip.y2 = (uint16_t)(gc->ClipY + gc->ClipHeight - 1);
+	}
+}
+
+/**
+ * @brief  矩形与裁剪区求交
+ * @retval 1：有相交部分，x/y/width/height 改为相交部分；0：完全在裁剪区外
+ */
+static uint8_t LCD_GC_ClipRect(const LCD_GC_t *gc, uint16_t *x, uint16_t *y, uint16_t *width, uint16_t *height)
+{
+	uint32_t x1 = *x, y1 = *y, x2 = (uint32_t)*x + *width, y2 = (uint32_t)*y + *height;
+
+	if (gc->ClipWidth == 0 || gc->ClipHeight == 0)
+		return (*width > 0 && *height > 0); // 不裁剪
+	if (x1 < gc->ClipX)
+		x1 = gc->ClipX;
+	if (y1 < gc->ClipY)
+		y1 = gc->ClipY;
+	if (x2 > (uint32_t)gc->ClipX + gc->ClipWidth)
+		x2 = (uint32_t)gc->ClipX + gc->ClipWidth;
+	if (y2 > (uint32_t)gc->ClipY + gc->ClipHeight)
+		y2 = (uint32_t)gc->ClipY + gc->ClipHeight;
+	if (x1 >= x2 || y1 >= y2)
+		return 0;
+	*x = (uint16_t)x1;
+	*y = (uint16_t)y1;
+	*width = (uint16_t)(x2 - x1);
+	*height = (uint16_t)(y2 - y1);
+	return 1;
+}
+
+/**
+ * @brief  文本从 (x, y) 向右、向下排布，起点在裁剪区右侧或下方时整条不可见
+ */
+static uint8_t LCD_GC_Reachable(const LCD_GC_t *gc, uint16_t x, uint16_t y)
+{
+	if (gc->ClipWidth == 0 || gc->ClipHeight == 0)
+		return 1;
+	return (uint32_t)x < (uint32_t)gc->ClipX + gc->ClipWidth && (uint32_t)y < (uint32_t)gc->ClipY + gc->ClipHeight;
+}
+
+/**
+ * @brief  按绘图上下文排入一条命令
+ */
+static uint32_t LCD_GC_Post(const LCD_GC_t *gc, uint8_t op, const uint16_t *args, const void *ptr, uint8_t copy)
+{
+	LCD_State_t state;
+
+	LCD_GC_State(gc, &state);
+	return LCD_Queue_Push(op, args, ptr, copy, &state, NULL, NULL, gc->Priority);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_GC_Init
+ *
+ *	入口参数: gc - 绘图上下文
+ *
+ *	函数功能: 初始化绘图上下文：白色画笔、黑色背景、24号字体、背景不透明、不裁剪、LCD_PRIO_LIVE 优先级
+ *
+ *	说    明: 1. 绘图上下文由调用者(各任务、各控件)自己保存，LCD_GC_*() 和 *_Ex() 按其中的设置绘制，不读写全局的颜色和字体，
+ *				   多个任务各用各的上下文排入命令，只在排入的瞬间短暂加锁(LCD_QUEUE_LOCK)
+ *				2. 颜色和字体在 LCD_GC_SetColor()/LCD_GC_SetBackColor()/LCD_GC_SetFont() 中一次转换好，
+ *				   之后每次绘制只拷贝，不再做 RGB888→RGB565 转换和字号查表
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_GC_Init(LCD_GC_t *gc)
+{
+	LCD_GC_SetColor(gc, LCD_WHITE);
+	LCD_GC_SetBackColor(gc, LCD_BLACK);
+	LCD_GC_SetFont(gc, 24);
+	gc->TextMode = Text_Opaque;
+	gc->TextEffect = Text_EffectNone;
+	gc->EffectColor = 0;
+	gc->Encoding = Text_UTF8;
+	gc->ClipX = 0;
+	gc->ClipY = 0;
+	gc->ClipWidth = 0;
+	gc->ClipHeight = 0;
+	gc->Priority = LCD_PRIO_LIVE;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_GC_SetColor / LCD_GC_SetBackColor / LCD_GC_SetFont / LCD_GC_SetFontFamily / LCD_GC_SetTextMode /
+ *				LCD_GC_SetTextEncoding / LCD_GC_SetTextEffect / LCD_GC_SetPriority
+ *
+ *	入口参数: gc - 绘图上下文
+ *				Color - RGB888颜色，与 LCD_SetColor() 相同
+ *				family - 字体族，与 LCD_SetTextFontFamily() 相同，LCD_GC_SetFont() 使用字体族0
+ *				font_size - 字体大小，与 LCD_SetTextFont() 相同
+ *				mode - Text_Opaque / Text_Transparent
+ *				enc - Text_UTF8 / Text_GBK，与 LCD_SetTextEncoding() 相同
+ *				effect - 文本效果，与 LCD_SetTextEffect() 相同
+ *				prio - 排入命令的优先级，与 LCD_Queue_SetPriority() 相同
+ *
+ *	函数功能: 设置绘图上下文的画笔色、背景色、字体、字符背景模式、文本编码、文本效果和命令优先级
+ *
+ *	说    明: 只修改 gc，不影响全局绘图状态；颜色保存为RGB565，字体保存为字模描述指针和放大倍数
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_GC_SetColor(LCD_GC_t *gc, uint32_t Color)
+{
+	gc->Color = LCD_ToRGB565(Color);
+}
+
+void LCD_GC_SetBackColor(LCD_GC_t *gc, uint32_t Color)
+{
+	gc->BackColor = LCD_ToRGB565(Color);
+}
+
+void LCD_GC_SetFont(LCD_GC_t *gc, uint8_t font_size)
+{
+	LCD_GC_SetFontFamily(gc, 0, font_size);
+}
+
+void LCD_GC_SetFontFamily(LCD_GC_t *gc, uint8_t family, uint8_t font_size)
+{
+	gc->TextScale = LCD_FontForSize(font_size, &gc->AsciiFonts, &gc->CHFonts);
+	gc->Family = family;
+}
+
+void LCD_GC_SetTextMode(LCD_GC_t *gc, uint8_t mode)
+{
+	gc->TextMode = mode;
+}
+
+void LCD_GC_SetTextEncoding(LCD_GC_t *gc, uint8_t enc)
+{
+	gc->Encoding = enc;
+}
+
+void LCD_GC_SetTextEffect(LCD_GC_t *gc, uint8_t effect, uint32_t Color)
+{
+	gc->TextEffect = effect;
+	gc->EffectColor = LCD_ToRGB565(Color);
+}
+
+void LCD_GC_SetPriority(LCD_GC_t *gc, uint8_t prio)
+{
+	gc->Priority = (prio < LCD_QUEUE_CLASSES) ? prio : (LCD_QUEUE_CLASSES - 1);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_GC_SetClip
+ *
+ *	入口参数: gc - 绘图上下文
+ *				x、y、width、height - 裁剪区，width或height为0时不裁剪
+ *
+ *	函数功能: 设置绘图上下文的裁剪区
+ *
+ *	说    明: 与 LCD_SetClip() 相同，只作用于按该上下文绘制的命令
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_GC_SetClip(LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	gc->ClipX = x;
+	gc->ClipY = y;
+	gc->ClipWidth = width;
+	gc->ClipHeight = height;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_GC_Clear / LCD_GC_FillRect / LCD_GC_Text / LCD_GC_Image / LCD_GC_Copy / LCD_GC_GlyphIds
+ *
+ *	入口参数: gc - 绘图上下文，其余与 LCD_Queue_*() 相同
+ *
+ *	返 回 值: 命令序号，用于 LCD_Queue_IsDone() / LCD_Queue_Wait()；无法排入时返回0
+ *
+ *	函数功能: 按绘图上下文的颜色、字体、字符模式和裁剪区排入命令
+ *
+ *	说    明: 1. LCD_GC_Clear() 用背景色填充裁剪区(未设置裁剪区时为整屏)
+ *				2. 排入时已复制上下文，之后修改 gc 不影响已排入的命令
+ *				3. 完全被裁剪掉的命令以空栅栏代替，序号照常递增；部分可见时执行时由 LCD_SetAddress() 裁剪
+ *
+ ****************************************************************************************************************************************/
+
+uint32_t LCD_GC_Clear(const LCD_GC_t *gc)
+{
+	LCD_GC_t back = *gc;
+
+	back.Color = gc->BackColor;
+	return LCD_GC_FillRect(&back, 0, 0, LCD.Width, LCD.Height);
+}
+
+uint32_t LCD_GC_FillRect(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	uint16_t args[4] = {0};
+
+	if (!LCD_GC_ClipRect(gc, &x, &y, &width, &height))
+		return LCD_Queue_Fence(NULL, NULL);
+	args[0] = x;
+	args[1] = y;
+	args[2] = width;
+	args[3] = height;
+	return LCD_GC_Post(gc, LCD_QOP_FillRect, args, NULL, 0);
+}
+
+uint32_t LCD_GC_Text(const LCD_GC_t *gc, uint16_t x, uint16_t y, const char *pText)
+{
+	uint16_t args[4] = {x, y, 0, 0};
+
+	if (!LCD_GC_Reachable(gc, x, y))
+		return LCD_Queue_Fence(NULL, NULL);
+	return LCD_GC_Post(gc, LCD_QOP_Text, args, pText, 1);
+}
+
+uint32_t LCD_GC_Image(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+					  const uint8_t *pImage)
+{
+	uint16_t args[4] = {x, y, width, height};
+
+	if (!LCD_GC_ClipRect(gc, &x, &y, &width, &height))
+		return LCD_Queue_Fence(NULL, NULL);
+	return LCD_GC_Post(gc, LCD_QOP_Image, args, pImage, 0);
+}
+
+uint32_t LCD_GC_Copy(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+					 uint16_t *DataBuff)
+{
+	uint16_t args[4] = {x, y, width, height};
+
+	if (!LCD_GC_ClipRect(gc, &x, &y, &width, &height))
+		return LCD_Queue_Fence(NULL, NULL);
+	return LCD_GC_Post(gc, LCD_QOP_Copy, args, DataBuff, 0);
+}
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+uint32_t LCD_GC_GlyphIds(const LCD_GC_t *gc, uint16_t x, uint16_t y, const LCD_GlyphIds_t *run)
+{
+	uint16_t args[4] = {x, y, 0, 0};
+
+	if (!LCD_GC_Reachable(gc, x, y))
+		return LCD_Queue_Fence(NULL, NULL);
+	return LCD_GC_Post(gc, LCD_QOP_GlyphIds, args, run, 0);
+}
+#endif
+
+/**
+ * @brief  临时换上绘图上下文的颜色、字体、字符模式和裁剪区，返回前由 LCD_LoadState(user) 换回
+ */
+static void LCD_GC_Apply(const LCD_GC_t *gc, LCD_State_t *user)
+{
+	LCD_State_t state;
+
+	LCD_SaveState(user);
+	LCD_GC_State(gc, &state);
+	LCD_LoadState(&state);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_DisplayText_Ex / LCD_DisplayString_Ex / LCD_DisplayNumber_Ex / LCD_DisplayDecimals_Ex /
+ *				LCD_NumberShow_Ex / LCD_FillRect_Ex / LCD_ClearRect_Ex
+ *
+ *	入口参数: gc - 绘图上下文，其余与不带 _Ex 的函数相同
+ *
+ *	函数功能: 按绘图上下文的颜色、字体、字符模式和裁剪区立即绘制
+ *
+ *	说    明: 1. 调用前后全局绘图状态不变，控件不必每次绘制前调用 LCD_SetColor()/LCD_SetBackColor()/LCD_SetTextFont()
+ *				2. 颜色和字体已在上下文中转换好，每次只拷贝6个成员；相邻两次调用颜色不同时字模展开表照常重建
+ *				3. 裁剪区对所有绘图生效，部分可见的字符只发送可见的行列
+ *				4. 与队列同时使用时，队列非空时不要调用，否则显示顺序与调用顺序不一致
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_DisplayText_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, char *pText)
+{
+	LCD_State_t user;
+
+	if (!LCD_GC_Reachable(gc, x, y))
+		return;
+	LCD_GC_Apply(gc, &user);
+	LCD_DisplayText(x, y, pText);
+	LCD_LoadState(&user);
+}
+
+void LCD_DisplayString_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, char *p)
+{
+	LCD_State_t user;
+
+	if (!LCD_GC_Reachable(gc, x, y))
+		return;
+	LCD_GC_Apply(gc, &user);
+	LCD_DisplayString(x, y, p);
+	LCD_LoadState(&user);
+}
+
+void LCD_DisplayNumber_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, int32_t number, uint8_t len)
+{
+	LCD_State_t user;
+
+	if (!LCD_GC_Reachable(gc, x, y))
+		return;
+	LCD_GC_Apply(gc, &user);
+	LCD_DisplayNumber(x, y, number, len);
+	LCD_LoadState(&user);
+}
+
+void LCD_DisplayDecimals_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, double decimals, uint8_t len, uint8_t decs)
+{
+	LCD_State_t user;
+
+	if (!LCD_GC_Reachable(gc, x, y))
+		return;
+	LCD_GC_Apply(gc, &user);
+	LCD_DisplayDecimals(x, y, decimals, len, decs);
+	LCD_LoadState(&user);
+}
+
+void LCD_NumberShow_Ex(const LCD_GC_t *gc, LCD_Number_t *num, int32_t value)
+{
+	LCD_State_t user;
+
+	if (!LCD_GC_Reachable(gc, num->X, num->Y))
+		return;
+	LCD_GC_Apply(gc, &user);
+	LCD_NumberShow(num, value);
+	LCD_LoadState(&user);
+}
+
+void LCD_FillRect_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	LCD_State_t user;
+
+	if (!LCD_GC_ClipRect(gc, &x, &y, &width, &height))
+		return;
+	LCD_GC_Apply(gc, &user);
+	LCD_FillRect(x, y, width, height);
+	LCD_LoadState(&user);
+}
+
+void LCD_ClearRect_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	LCD_State_t user;
+
+	if (!LCD_GC_ClipRect(gc, &x, &y, &width, &height))
+		return;
+	LCD_GC_Apply(gc, &user);
+	LCD_ClearRect(x, y, width, height);
+	LCD_LoadState(&user);
+}
+
+/**
+ * @brief  当前字体的行高，LCD_DisplayText() 换行时按此下移
+ */
+static uint16_t LCD_TextLineHeight(void)
+{
+#ifdef USE_FLASH_FONT
+	return LCD_GetChineseFontSize();
+#else
+	return LCD_CHFonts->Height;
+#endif
+}
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+/**
+ * @brief  计算Flash字库文本中一个字符的显示宽度，LCD_DisplayText()与保留模式共用
+ * @param  p 该字符之后的文本，下一个字符为ASCII时参与字偶距
+ * @param  src_x 输出从字模单元第几列开始显示，可为NULL
+ * @retval 显示宽度，汉字为字号，ASCII由字宽表给出(没有字宽表时为半角)
+ */
+static uint8_t LCD_TextAdvance(uint32_t cp, const char *p, uint8_t font_size, int8_t *src_x)
+{
+	if (cp >= 0x80)
+	{
+		if (src_x != NULL)
+			*src_x = 0;
+		return font_size;
+	}
+	return FlashFont_AsciiAdvance((char)cp, ((uint8_t)*p < 0x80) ? *p : 0, font_size, src_x);
+}
+#endif
+
+/**
+ * @brief  取出 LCD_DisplayText() 文本中的一个字符，保留模式和控制台按此排版
+ * @param  width 输出字符的显示宽度
+ * @retval 字符的字节数(UTF-8 或 GBK)
+ */
+static uint8_t LCD_TextCell(const char *p, uint16_t *width)
+{
+	uint8_t len;
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+	uint32_t cp;
+
+	len = FlashFont_DecodeText((const uint8_t *)p, &cp);
+	*width = LCD_TextAdvance(cp, p + len, LCD_GetChineseFontSize(), NULL);
+#else
+	if (*p <= 0x7F)
+	{
+		len = 1;
+		*width = LCD_AsciiFonts->Width;
+	}
+	else
+	{
+		len = (p[1] != 0) ? 2 : 1; // GBK双字节
+#ifdef USE_FLASH_FONT
+		*width = LCD_GetChineseFontSize();
+#else
+		*width = LCD_CHFonts->Width;
+#endif
+	}
+#endif
+	return len;
+}
+
+#ifdef LCD_RETAIN_ENABLE
+// 保留模式：LCD_RetainBegin() 之后的文本和填充只记录到本帧列表，LCD_RetainEnd() 时与上一帧同序号的项比较，
+// 先清除删除、移动或变短留下的旧像素，再按顺序重绘改变的字符、矩形改变的部分，以及与清除/重绘区域重叠的项
+#define LCD_RETAIN_TEXT 0	// LCD_DisplayText，自动换行
+#define LCD_RETAIN_STRING 1 // LCD_DisplayString，不换行
+#define LCD_RETAIN_FILL 2	// LCD_FillRect
+
+#define LCD_RETAIN_SAME 0	// 与上一帧相同
+#define LCD_RETAIN_CELLS 1	// 属性相同，部分字符改变
+#define LCD_RETAIN_RESIZE 2 // 同色矩形，位置或尺寸改变
+#define LCD_RETAIN_NEW 3	// 新增或属性改变，整项重绘
+
+#define LCD_RETAIN_RUN 32 // 一次重绘的连续字符最多字节数
+
+typedef struct
+{
+	const char *Text;		// 字符串(位于所属列表的字符串池)，矩形为NULL
+	LCD_State_t State;		// 记录时的颜色、字体、字符模式
+	uint16_t X, Y;			// 起始坐标
+	uint16_t Width, Height; // 矩形尺寸
+	uint8_t Op;				// 项类型
+	uint8_t Diff;			// 本帧的比较结果
+} LCD_RetainItem_t;
+
+typedef struct
+{
+	LCD_RetainItem_t Item[LCD_RETAIN_ITEMS];
+	char Text[LCD_RETAIN_TEXT_BYTES]; // 字符串池
+	uint16_t Count;					  // 项数
+	uint16_t TextUsed;				  // 字符串池已用字节
+} LCD_RetainList_t;
+
+typedef struct
+{
+	const char *p; // 下一个字符
+	uint16_t x, y; // 下一个字符的坐标
+} LCD_RetainPos_t;
+
+static LCD_RetainList_t LCD_RetainList[2];			 // 本帧和上一帧
+static uint8_t LCD_RetainCur = 0;					 // 本帧列表序号
+static uint8_t LCD_Retain_Recording = 0;			 // 1：文本和填充只记录
+static LCD_Rect_t LCD_RetainDirty[LCD_RETAIN_DIRTY]; // 本帧清除或重绘过的区域
+static uint8_t LCD_RetainOwner[LCD_RETAIN_DIRTY];	 // 区域所属的项序号
+static uint8_t LCD_RetainDirtyCount = 0;			 // 区域个数
+static uint8_t LCD_RetainDirtyFull = 0;				 // 1：区域已记满，之后的项一律重绘
+
+#define LCD_RETAIN_RECORD(op, x, y, width, height, pText) \
+	(LCD_Retain_Recording && LCD_Retain_Record(op, x, y, width, height, pText))
+
+/**
+ * @brief  记录一项
+ * @retval 1：已记录，调用者直接返回；0：列表或字符串池已满，调用者照常直接写屏
+ */
+static uint8_t LCD_Retain_Record(uint8_t op, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+								 const char *pText)
+{
+	LCD_RetainList_t *list = &LCD_RetainList[LCD_RetainCur];
+	LCD_RetainItem_t *item;
+	uint16_t len = (pText != NULL) ? (uint16_t)(strlen(pText) + 1) : 0;
+
+	if (list->Count >= LCD_RETAIN_ITEMS || list->TextUsed + len > LCD_RETAIN_TEXT_BYTES)
+		return 0;
+
+	item = &list->Item[list->Count++];
+	item->Text = NULL;
+	if (pText != NULL)
+	{
+		memcpy(&list->Text[list->TextUsed], pText, len);
+		item->Text = &list->Text[list->TextUsed];
+		list->TextUsed += len;
+	}
+	LCD_SaveState(&item->State);
+	item->X = x;
+	item->Y = y;
+	item->Width = width;
+	item->Height = height;
+	item->Op = op;
+	return 1;
+}
+
+static uint8_t LCD_Retain_SameState(const LCD_State_t *a, const LCD_State_t *b)
+{
+	return a->AsciiFonts == b->AsciiFonts && a->CHFonts == b->CHFonts && a->Color == b->Color &&
+		   a->BackColor == b->BackColor && a->Text_Mode == b->Text_Mode &&
+		   a->Text_Scale == b->Text_Scale && a->Text_Effect == b->Text_Effect &&
+		   a->Effect_Color == b->Effect_Color && memcmp(&a->Clip, &b->Clip, sizeof(a->Clip)) == 0;
+}
+
+static uint8_t LCD_RectOverlap(const LCD_Rect_t *a, const LCD_Rect_t *b)
+{
+	return a->x1 <= b->x2 && b->x1 <= a->x2 && a->y1 <= b->y2 && b->y1 <= a->y2;
+}
+
+static uint8_t LCD_RectEqual(const LCD_Rect_t *a, const LCD_Rect_t *b)
+{
+	return a->x1 == b->x1 && a->y1 == b->y1 && a->x2 == b->x2 && a->y2 == b->y2;
+}
+
+/**
+ * @brief  记录本帧清除或重绘过的区域
+ */
+static void LCD_Retain_AddDirty(const LCD_Rect_t *r, uint8_t owner)
+{
+	if (LCD_RetainDirtyCount < LCD_RETAIN_DIRTY)
+	{
+		LCD_RetainDirty[LCD_RetainDirtyCount] = *r;
+		LCD_RetainOwner[LCD_RetainDirtyCount++] = owner;
+	}
+	else
+	{
+		LCD_RetainDirtyFull = 1;
+	}
+}
+
+/**
+ * @brief  区域是否与其他项清除或重绘过的区域重叠
+ */
+static uint8_t LCD_Retain_Overlap(const LCD_Rect_t *r, uint8_t owner)
+{
+	if (LCD_RetainDirtyFull)
+		return 1;
+	for (uint8_t i = 0; i < LCD_RetainDirtyCount; i++)
+	{
+		if (LCD_RetainOwner[i] != owner && LCD_RectOverlap(r, &LCD_RetainDirty[i]))
+			return 1;
+	}
+	return 0;
+}
+
+
+/**
+ * @brief  取出下一个字符的位置，排版规则与 LCD_DisplayText()/LCD_DisplayString() 相同
+ * @param  cell 输出字符所占区域
+ * @retval 字符的字节数，字符串结束返回0
+ * @note   调用前需载入该项的状态
+ */
+static uint8_t LCD_Retain_NextCell(const LCD_RetainItem_t *item, LCD_RetainPos_t *pos, LCD_Rect_t *cell)
+{
+	uint16_t width, height = LCD_TextLineHeight();
+	uint8_t len;
+
+	if (*pos->p == 0)
+		return 0;
+
+	if (item->Op == LCD_RETAIN_STRING)
+	{
+		if (pos->x >= LCD.Width)
+			return 0;
+		len = 1;
+		width = LCD_AsciiFonts->Width * LCD_ASCII_SCALE;
+		height = LCD_AsciiFonts->Height * LCD_ASCII_SCALE;
+	}
+	else
+	{
+		len = LCD_TextCell(pos->p, &width);
+		if (pos->x + width > LCD.Width && pos->x != item->X) // 换行
+		{
+			pos->x = item->X;
+			pos->y += height;
+		}
+	}
+
+	cell->x1 = pos->x;
+	cell->y1 = pos->y;
+	cell->x2 = pos->x + width - 1;
+	cell->y2 = pos->y + height - 1;
+	pos->x += width;
+	pos->p += len;
+	return len;
+}
+
+static void LCD_Retain_Start(const LCD_RetainItem_t *item, LCD_RetainPos_t *pos)
+{
+	pos->p = item->Text;
+	pos->x = item->X;
+	pos->y = item->Y;
+}
+
+/**
+ * @brief  计算项所占区域
+ * @retval 0：项为空
+ * @note   调用前需载入该项的状态
+ */
+static uint8_t LCD_Retain_Extent(const LCD_RetainItem_t *item, LCD_Rect_t *r)
+{
+	LCD_RetainPos_t pos;
+	LCD_Rect_t cell;
+	uint8_t found = 0;
+
+	if (item->Op == LCD_RETAIN_FILL)
+	{
+		if (item->Width == 0 || item->Height == 0)
+			return 0;
+		r->x1 = item->X;
+		r->y1 = item->Y;
+		r->x2 = item->X + item->Width - 1;
+		r->y2 = item->Y + item->Height - 1;
+		return 1;
+	}
+
+	LCD_Retain_Start(item, &pos);
+	while (LCD_Retain_NextCell(item, &pos, &cell))
+	{
+		if (found)
+		{
+			LCD_RectUnion(r, &cell);
+		}
+		else
+		{
+			*r = cell;
+			found = 1;
+		}
+	}
+	return found;
+}
+
+/**
+ * @brief  用该项的背景色清除一块区域；透明文本无法擦除，只记录区域，由下面重叠的项重绘
+ */
+static void LCD_Retain_Erase(const LCD_RetainItem_t *item, LCD_Rect_t r, uint8_t owner)
+{
+	if (r.x1 >= LCD.Width || r.y1 >= LCD.Height)
+		return;
+	if (r.x2 >= LCD.Width)
+		r.x2 = LCD.Width - 1;
+	if (r.y2 >= LCD.Height)
+		r.y2 = LCD.Height - 1;
+
+	if (item->Op == LCD_RETAIN_FILL || item->State.Text_Mode != Text_Transparent)
+	{
+		LCD_ClearRect(r.x1, r.y1, r.x2 - r.x1 + 1, r.y2 - r.y1 + 1);
+	}
+	LCD_Retain_AddDirty(&r, owner);
+}
+
+/**
+ * @brief  清除从 pos 开始的所有字符，同一行相邻的字符合并为一个矩形
+ */
+static void LCD_Retain_EraseCells(const LCD_RetainItem_t *item, LCD_RetainPos_t *pos, uint8_t owner)
+{
+	LCD_Rect_t cell, run;
+	uint8_t has = 0;
+
+	while (LCD_Retain_NextCell(item, pos, &cell))
+	{
+		if (has && cell.y1 == run.y1 && cell.x1 == run.x2 + 1)
+		{
+			run.x2 = cell.x2;
+			continue;
+		}
+		if (has)
+			LCD_Retain_Erase(item, run, owner);
+		run = cell;
+		has = 1;
+	}
+	if (has)
+		LCD_Retain_Erase(item, run, owner);
+}
+
+/**
+ * @brief  清除上一帧的整项
+ */
+static void LCD_Retain_EraseItem(const LCD_RetainItem_t *old, uint8_t owner)
+{
+	LCD_RetainPos_t pos;
+	LCD_Rect_t r;
+
+	LCD_LoadState(&old->State);
+	if (old->Op == LCD_RETAIN_FILL)
+	{
+		if (LCD_Retain_Extent(old, &r))
+			LCD_Retain_Erase(old, r, owner);
+		return;
+	}
+	LCD_Retain_Start(old, &pos);
+	LCD_Retain_EraseCells(old, &pos, owner);
+}
+
+/**
+ * @brief  把 a 减去 b 剩下的部分(最多4个矩形)，fill 为1时用画笔色填充，为0时清除
+ */
+static void LCD_Retain_Subtract(const LCD_RetainItem_t *item, const LCD_Rect_t *a, const LCD_Rect_t *b,
+								uint8_t fill, uint8_t owner)
+{
+	LCD_Rect_t piece[4];
+	uint8_t n = 0;
+
+	if (!LCD_RectOverlap(a, b))
+	{
+		piece[n++] = *a;
+	}
+	else
+	{
+		uint16_t y1 = (a->y1 > b->y1) ? a->y1 : b->y1; // 中间一段的行范围
+		uint16_t y2 = (a->y2 < b->y2) ? a->y2 : b->y2;
+
+		if (a->y1 < b->y1)
+			piece[n++] = (LCD_Rect_t){a->x1, a->y1, a->x2, b->y1 - 1};
+		if (a->y2 > b->y2)
+			piece[n++] = (LCD_Rect_t){a->x1, b->y2 + 1, a->x2, a->y2};
+		if (a->x1 < b->x1)
+			piece[n++] = (LCD_Rect_t){a->x1, y1, b->x1 - 1, y2};
+		if (a->x2 > b->x2)
+			piece[n++] = (LCD_Rect_t){b->x2 + 1, y1, a->x2, y2};
+	}
+
+	for (uint8_t i = 0; i < n; i++)
+	{
+		if (fill)
+		{
+			LCD_FillRect(piece[i].x1, piece[i].y1, piece[i].x2 - piece[i].x1 + 1, piece[i].y2 - piece[i].y1 + 1);
+			LCD_Retain_AddDirty(&piece[i], owner);
+		}
+		else
+		{
+			LCD_Retain_Erase(item, piece[i], owner);
+		}
+	}
+}
+
+/**
+ * @brief  与上一帧同序号的项比较，并清除不再被覆盖的旧像素
+ */
+static void LCD_Retain_Compare(LCD_RetainItem_t *item, const LCD_RetainItem_t *old, uint8_t owner)
+{
+	LCD_Rect_t rn, ro;
+
+	item->Diff = LCD_RETAIN_NEW;
+	if (old == NULL)
+		return;
+
+	if (item->Op == old->Op && LCD_Retain_SameState(&item->State, &old->State))
+	{
+		if (item->Op == LCD_RETAIN_FILL)
+		{
+			LCD_LoadState(&item->State);
+			if (LCD_Retain_Extent(item, &rn) && LCD_Retain_Extent(old, &ro))
+			{
+				if (LCD_RectEqual(&rn, &ro))
+				{
+					item->Diff = LCD_RETAIN_SAME;
+				}
+				else
+				{
+					item->Diff = LCD_RETAIN_RESIZE;
+					LCD_Retain_Subtract(old, &ro, &rn, 0, owner); // 清除缩小的部分
+				}
+				return;
+			}
+		}
+		else if (item->X == old->X && item->Y == old->Y && item->State.Text_Mode != Text_Transparent)
+		{
+			LCD_RetainPos_t pn, po, at;
+			LCD_Rect_t cn, co;
+
+			if (strcmp(item->Text, old->Text) == 0)
+			{
+				item->Diff = LCD_RETAIN_SAME;
+				return;
+			}
+
+			// 位置仍然对齐的字符会被新内容直接覆盖，从第一个错位的字符起清除旧内容
+			item->Diff = LCD_RETAIN_CELLS;
+			LCD_LoadState(&item->State);
+			LCD_Retain_Start(item, &pn);
+			LCD_Retain_Start(old, &po);
+			for (;;)
+			{
+				at = po;
+				if (LCD_Retain_NextCell(old, &po, &co) == 0)
+					break;
+				if (LCD_Retain_NextCell(item, &pn, &cn) == 0 || !LCD_RectEqual(&cn, &co))
+				{
+					LCD_Retain_EraseCells(old, &at, owner);
+					break;
+				}
+			}
+			return;
+		}
+	}
+
+	LCD_Retain_EraseItem(old, owner);
+}
+
+/**
+ * @brief  绘制一段文本并记录区域
+ */
+static void LCD_Retain_DrawText(const LCD_RetainItem_t *item, uint16_t x, uint16_t y, char *pText)
+{
+	if (item->Op == LCD_RETAIN_TEXT)
+		LCD_DisplayText(x, y, pText);
+	else
+		LCD_DisplayString(x, y, pText);
+}
+
+/**
+ * @brief  只重绘与上一帧不同的字符，同一行相邻的字符合并为一次绘制
+ */
+static void LCD_Retain_DrawCells(const LCD_RetainItem_t *item, const LCD_RetainItem_t *old, uint8_t owner)
+{
+	LCD_RetainPos_t pn, po;
+	LCD_Rect_t cn, co, dirty;
+	LCD_Rect_t run = {0}; // n>0时才使用，初始化只为消除编译器的未初始化警告
+	char buf[LCD_RETAIN_RUN + 1];
+	uint16_t n = 0; // 当前连续段的字节数
+	uint8_t len, synced = 1, has_dirty = 0;
+
+	LCD_Retain_Start(item, &pn);
+	LCD_Retain_Start(old, &po);
+	while ((len = LCD_Retain_NextCell(item, &pn, &cn)) != 0)
+	{
+		const char *p = pn.p - len;
+		uint8_t changed = 1;
+
+		if (synced)
+		{
+			uint8_t old_len = LCD_Retain_NextCell(old, &po, &co);
+
+			if (old_len == 0 || !LCD_RectEqual(&cn, &co))
+				synced = 0; // 之后的字符位置都已改变
+			else if (old_len == len)
+				changed = (memcmp(po.p - old_len, p, len) != 0);
+		}
+
+		if (n > 0 && (!changed || cn.y1 != run.y1 || cn.x1 != run.x2 + 1 || n + len > LCD_RETAIN_RUN))
+		{
+			buf[n] = 0;
+			LCD_Retain_DrawText(item, run.x1, run.y1, buf);
+			n = 0;
+		}
+		if (changed)
+		{
+			if (n == 0)
+				run = cn;
+			else
+				run.x2 = cn.x2;
+			memcpy(&buf[n], p, len);
+			n += len;
+
+			if (has_dirty)
+				LCD_RectUnion(&dirty, &cn);
+			else
+				dirty = cn;
+			has_dirty = 1;
+		}
+	}
+	if (n > 0)
+	{
+		buf[n] = 0;
+		LCD_Retain_DrawText(item, run.x1, run.y1, buf);
+	}
+	if (has_dirty)
+		LCD_Retain_AddDirty(&dirty, owner);
+}
+#else
+#define LCD_RETAIN_RECORD(op, x, y, width, height, pText) 0
+#endif
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_RetainBegin
+ *
+ *	函数功能: 开始记录一帧保留模式的内容
+ *
+ *	说    明: 1. 之后调用的 LCD_DisplayText()、LCD_DisplayString()、LCD_DisplayNumber()、LCD_DisplayDecimals()、LCD_FillRect()
+ *				   只记录位置、内容、字体和颜色，直到 LCD_RetainEnd() 才比较并绘制
+ *				2. 各项按调用顺序与上一帧同序号的项比较，界面布局不变时每帧按相同顺序调用即可
+ *				3. 列表或字符串空间用完后，多出的项直接写屏，不参与比较
+ *				4. 未定义 LCD_RETAIN_ENABLE 时立即返回，绘图照常直接写屏
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_RetainBegin(void)
+{
+#ifdef LCD_RETAIN_ENABLE
+	LCD_RetainList[LCD_RetainCur].Count = 0;
+	LCD_RetainList[LCD_RetainCur].TextUsed = 0;
+	LCD_Retain_Recording = 1;
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_RetainEnd
+ *
+ *	函数功能: 结束记录，与上一帧比较后只重绘变化的部分
+ *
+ *	说    明: 1. 文本逐字符比较，例如 "1234" 变为 "1235" 时只重发最后一个字符；变短时多出的字符用该项的背景色清除
+ *				2. 同色矩形只填充新增的部分、清除缩小的部分，适合进度条、柱状图
+ *				3. 项被删除或位置、字体、颜色改变时，先用该项的背景色清除旧区域再整项重绘
+ *				4. 与本帧清除或重绘区域重叠的其他项按调用顺序重绘，透明文本改变时靠它下面的项重绘来擦除旧笔画
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_RetainEnd(void)
+{
+#ifdef LCD_RETAIN_ENABLE
+	LCD_RetainList_t *cur = &LCD_RetainList[LCD_RetainCur];
+	LCD_RetainList_t *prev = &LCD_RetainList[LCD_RetainCur ^ 1];
+	uint16_t n = (cur->Count > prev->Count) ? cur->Count : prev->Count;
+	LCD_State_t user; // 用户当前的绘图状态
+
+	if (!LCD_Retain_Recording)
+		return;
+	LCD_Retain_Recording = 0;
+	LCD_SaveState(&user);
+	LCD_RetainDirtyCount = 0;
+	LCD_RetainDirtyFull = 0;
+
+	// 第一遍：比较，清除删除、移动、变短留下的旧像素
+	for (uint16_t i = 0; i < n; i++)
+	{
+		const LCD_RetainItem_t *old = (i < prev->Count) ? &prev->Item[i] : NULL;
+
+		if (i < cur->Count)
+			LCD_Retain_Compare(&cur->Item[i], old, (uint8_t)i);
+		else
+			LCD_Retain_EraseItem(old, (uint8_t)i);
+	}
+
+	// 第二遍：按调用顺序绘制改变的部分
+	for (uint16_t i = 0; i < cur->Count; i++)
+	{
+		const LCD_RetainItem_t *item = &cur->Item[i];
+		const LCD_RetainItem_t *old = &prev->Item[i]; // Diff 不是 NEW 时有效
+		LCD_Rect_t r;
+
+		LCD_LoadState(&item->State);
+		if (!LCD_Retain_Extent(item, &r))
+			continue;
+
+		if (item->Diff == LCD_RETAIN_NEW || LCD_Retain_Overlap(&r, (uint8_t)i))
+		{
+			if (item->Op == LCD_RETAIN_FILL)
+				LCD_FillRect(item->X, item->Y, item->Width, item->Height);
+			else
+				LCD_Retain_DrawText(item, item->X, item->Y, (char *)item->Text);
+			LCD_Retain_AddDirty(&r, (uint8_t)i);
+		}
+		else if (item->Diff == LCD_RETAIN_CELLS)
+		{
+			LCD_Retain_DrawCells(item, old, (uint8_t)i);
+		}
+		else if (item->Diff == LCD_RETAIN_RESIZE)
+		{
+			LCD_Rect_t ro;
+
+			LCD_Retain_Extent(old, &ro);
+			LCD_Retain_Subtract(item, &r, &ro, 1, (uint8_t)i); // 只填充新增的部分
+		}
+	}
+
+	LCD_RetainCur ^= 1;
+	LCD_LoadState(&user);
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_RetainInvalidate
+ *
+ *	函数功能: 丢弃上一帧的记录，下一次 LCD_RetainEnd() 整屏重绘
+ *
+ *	说    明: 调用 LCD_Clear() 或切换界面之后使用，不会清除屏幕上已有的内容
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_RetainInvalidate(void)
+{
+#ifdef LCD_RETAIN_ENABLE
+	LCD_RetainList[LCD_RetainCur ^ 1].Count = 0;
+#endif
+}
+
+/**
+ * @brief  忘记屏幕当前的窗口，下次 LCD_SetAddress() 完整设置列、行地址
+ * @note   屏幕复位、切换显示方向(偏移量改变)后调用
+ */
+static void LCD_Win_Invalidate(void)
+{
+	LCD_Win_Col = 0xFFFFFFFF;
+	LCD_Win_Row = 0xFFFFFFFF;
+	LCD_Win_Writing = 0;
+}
+
+#ifdef LCD_RGB444_ENABLE
+// RGB444：像素格式为12位时，SPI改为12位帧，一帧一个像素(RGB各4位)，连续发出即为 R1G1 B1R2 G2B2；
+// 发送函数把RGB565像素两两截成一个字(低半字为前一个像素)，先写入本屏幕的两个打包缓冲区之一
+// 再由BDMA按32位发送，SPI的数据打包把一个字拆成两帧，CPU同时打包下一段；
+// 屏幕按字节接收，一次传输必须是偶数个像素，
+// 一段像素数为奇数时最后一个留到下一段，窗口最后一个像素与窗口第一个像素凑成一对，
+// 写指针越过窗口末尾后回到起点，把原来的颜色再写一遍
+#define LCD_PIXEL_444() (LCD_Cur->PixelFormat == LCD_PIXEL_RGB444)
+#define LCD_444_PEND 0x8000U // Pend444 中的有效标记
+#define LCD_444(c) ((((uint32_t)(c) >> 4) & 0xF00U) | (((uint32_t)(c) >> 3) & 0x0F0U) | (((uint32_t)(c) >> 1) & 0x00FU)) // RGB565取各分量高4位
+#if LCD_RGB444_WORDS % 8 != 0
+#error "LCD_RGB444_WORDS 必须是8的倍数(每个打包缓冲区占整数个Cache行)"
+#endif
+LCD_RGB444_ATTR static uint32_t LCD_444_Buff[LCD_PANEL_MAX][2][LCD_RGB444_WORDS] DMA_ALIGNED; // 打包缓冲区，每项2帧
+
+/**
+ * @brief  两个RGB565像素(低半字在前)同时截为两个12位帧，顺序不变
+ */
+ITCM_CODE static inline uint32_t LCD_444_Pair(uint32_t v)
+{
+	return ((v >> 4) & 0x0F000F00U) | ((v >> 3) & 0x00F000F0U) | ((v >> 1) & 0x000F000FU);
+}
+
+/**
+ * @brief  当前窗口的像素数
+ */
+static uint32_t LCD_Win_Pixels(void)
+{
+	return ((LCD_Win_Col & 0xFFFF) - (LCD_Win_Col >> 16) + 1) * ((LCD_Win_Row & 0xFFFF) - (LCD_Win_Row >> 16) + 1);
+}
+
+/**
+ * @brief  取得下一个打包缓冲区，正在DMA发送的是另一个
+ */
+ITCM_CODE static uint32_t *LCD_444_Next(void)
+{
+	LCD_Cur->Buf444 ^= 1;
+	return LCD_444_Buff[LCD_Cur->Index][LCD_Cur->Buf444];
+}
+
+/**
+ * @brief  发送 n 对打包好的像素
+ * @param  fill 1：重复发送 w[0]，0：依次发送 w[0] ~ w[n-1]
+ */
+ITCM_CODE static void LCD_444_Transmit(uint32_t *w, uint32_t n, uint8_t fill)
+{
+	LCD_WaitIdle(); // 数据宽度只能在空闲时切换
+	LCD_DC_Data;
+	LCD_SPI_SetDataSize(SPI_DATASIZE_12BIT); // 一帧1个像素，8位宽度在下一次写指令时恢复
+	LCD_PERF_TX(n * 3);
+
+#ifdef LCD_SPI_DMA_ENABLE
+	if (fill ? (n * 2 >= LCD_SPI_DMA_FILL_MIN) : LCD_IS_DMA_RAM(w))
+	{
+		if (fill)
+		{
+			LCD_DMA_FillWord[0] = w[0]; // 与RGB565相同，同一颜色重复两次
+			SCB_CleanDCache_by_Addr(LCD_DMA_FillWord, sizeof(LCD_DMA_FillWord));
+			LCD_DMA_TxBuff = (const uint16_t *)LCD_DMA_FillWord;
+			LCD_DMA_FillLeft = n * 2;
+		}
+		else
+		{
+			SCB_CleanDCache_by_Addr(w, (int32_t)(n * 4));
+			LCD_DMA_TxBuff = (const uint16_t *)w;
+			LCD_DMA_SetMode(LCD_DMA_BuffMode(w, n * 2));
+		}
+		PERF_TRACE_BEGIN(PERF_TRACE_DMA, n * 2);
+		if ((fill ? LCD_DMA_FillNext() : HAL_SPI_Transmit_DMA(&LCD_SPI, (uint8_t *)w, (uint16_t)(n * 2))) == HAL_OK)
+			return;
+		LCD_DMA_FillLeft = 0; // 启动失败，改用阻塞传输
+		LCD_DMA_TxBuff = NULL;
+		PERF_TRACE_END(PERF_TRACE_DMA, 0);
+	}
+#endif
+
+	PERF_TRACE_BEGIN(PERF_TRACE_SPI, n * 2);
+	if (fill)
+	{
+		uint32_t k = (n < LCD_RGB444_WORDS) ? n : LCD_RGB444_WORDS;
+
+		for (uint32_t i = 1; i < k; i++)
+			w[i] = w[0];
+		for (; n > 0; n -= k)
+		{
+			if (k > n)
+				k = n;
+			HAL_SPI_Transmit(&LCD_SPI, (uint8_t *)w, (uint16_t)(k * 2), 1000);
+		}
+	}
+	else
+	{
+		HAL_SPI_Transmit(&LCD_SPI, (uint8_t *)w, (uint16_t)(n * 2), 1000);
+	}
+	PERF_TRACE_END(PERF_TRACE_SPI, 0);
+}
+
+/**
+ * @brief  以RGB444格式在当前窗口中写入像素
+ * @param  pData 像素，为NULL时写入 count 个 color
+ */
+ITCM_CODE static void LCD_444_Send(const uint16_t *pData, uint16_t color, uint32_t count)
+{
+	uint32_t c = LCD_444(color);
+	uint32_t *w;
+	uint32_t n;
+	uint8_t end;
+
+	if (count == 0)
+		return;
+	if (LCD_Win_Pos == 0)
+		LCD_Cur->First444 = (uint16_t)((pData != NULL) ? LCD_444(pData[0]) : c);
+	LCD_WIN_ADVANCE(count);
+	end = (LCD_Win_Pos >= LCD_Win_Pixels()); // 本段写到窗口末尾
+
+	if (pData != NULL)
+	{
+		while (count > 0)
+		{
+			w = LCD_444_Next();
+			n = 0;
+			if (LCD_Cur->Pend444 != 0) // 上一段留下的像素先发
+			{
+				w[n++] = (LCD_444(pData[0]) << 16) | (LCD_Cur->Pend444 & 0xFFFU);
+				LCD_Cur->Pend444 = 0;
+				pData++;
+				count--;
+			}
+			for (; count > 1 && n < LCD_RGB444_WORDS; n++, count -= 2, pData += 2)
+				w[n] = LCD_444_Pair(*(const uint32_t *)pData); // M7允许非对齐的单字读取
+			if (count == 1 && n < LCD_RGB444_WORDS)
+			{
+				LCD_Cur->Pend444 = (uint16_t)(LCD_444_PEND | LCD_444(*pData));
+				count = 0;
+			}
+			if (n > 0)
+				LCD_444_Transmit(w, n, 0);
+		}
+	}
+	else
+	{
+		if (LCD_Cur->Pend444 != 0)
+		{
+			w = LCD_444_Next();
+			w[0] = (c << 16) | (LCD_Cur->Pend444 & 0xFFFU);
+			LCD_Cur->Pend444 = 0;
+			LCD_444_Transmit(w, 1, 0);
+			count--;
+		}
+		if (count > 1)
+		{
+			w = LCD_444_Next();
+			w[0] = (c << 16) | c;
+			LCD_444_Transmit(w, count / 2, 1);
+		}
+		if (count & 1)
+			LCD_Cur->Pend444 = (uint16_t)(LCD_444_PEND | c);
+	}
+
+	if (end && LCD_Cur->Pend444 != 0)
+	{
+		w = LCD_444_Next();
+		w[0] = ((uint32_t)LCD_Cur->First444 << 16) | (LCD_Cur->Pend444 & 0xFFFU);
+		LCD_Cur->Pend444 = 0;
+		LCD_444_Transmit(w, 1, 0);
+	}
+}
+
+/**
+ * @brief  窗口没有写完就要发送指令时，把留下的像素补4位发出
+ */
+static void LCD_444_Flush(void)
+{
+	uint8_t b[2];
+
+	if (LCD_Cur->Pend444 == 0)
+		return;
+	b[0] = (uint8_t)(LCD_Cur->Pend444 >> 4);
+	b[1] = (uint8_t)(LCD_Cur->Pend444 << 4);
+	LCD_Cur->Pend444 = 0;
+	LCD_WaitIdle();
+	LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT);
+	LCD_DC_Data;
+	HAL_SPI_Transmit(&LCD_SPI, b, 2, 1000);
+	LCD_PERF_TX(2);
+}
+#define LCD_444_FLUSH() LCD_444_Flush()
+#else
+#define LCD_PIXEL_444() 0
+#define LCD_444_FLUSH() ((void)0)
+#endif
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_WriteCommand
+ *
+ *	入口参数: lcd_command - 需要写入的控制指令
+ *
+ *	函数功能: 用于向屏幕控制器写入指令
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_WriteCommand(uint8_t lcd_command)
+{
+	LCD_WaitIdle();						 // 等待后台传输结束
+	LCD_444_FLUSH();
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+	{
+		LCD_Fmc_Write8(LCD_Cur->Cfg.FmcCmd, lcd_command);
+		LCD_Win_Writing = 0;
+		LCD_PERF_TX(1);
+		return;
+	}
+#endif
+	LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT); // 指令和参数按8位传输
+	LCD_DC_Command; // 数据指令选择 引脚输出低电平，代表本次传输 指令
+	LCD_Win_Writing = 0; // 任何指令都结束写显存
+
+	HAL_SPI_Transmit(&LCD_SPI, &lcd_command, 1, 1000); // 启动SPI传输
+	LCD_PERF_TX(1);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_WriteData_8bit
+ *
+ *	入口参数: lcd_data - 需要写入的数据，8位
+ *
+ *	函数功能: 写入8位数据
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_WriteData_8bit(uint8_t lcd_data)
+{
+	LCD_WaitIdle();						 // 等待后台传输结束
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+	{
+		LCD_Fmc_Write8(LCD_Cur->Cfg.FmcData, lcd_data);
+		LCD_PERF_TX(1);
+		return;
+	}
+#endif
+	LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT); // 指令和参数按8位传输
+	LCD_DC_Data; // 数据指令选择 引脚输出高电平，代表本次传输 数据
+
+	HAL_SPI_Transmit(&LCD_SPI, &lcd_data, 1, 1000); // 启动SPI传输
+	LCD_PERF_TX(1);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_WriteData_16bit
+ *
+ *	入口参数: lcd_data - 需要写入的数据，16位
+ *
+ *	函数功能: 写入16位数据
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_WriteData_16bit(uint16_t lcd_data)
+{
+	uint8_t lcd_data_buff[2]; // 数据发送区
+
+	LCD_WaitIdle();						   // 等待后台传输结束
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+	{
+		LCD_Fmc_Write8(LCD_Cur->Cfg.FmcData, (uint8_t)(lcd_data >> 8)); // 参数同样按字节写入
+		LCD_Fmc_Write8(LCD_Cur->Cfg.FmcData, (uint8_t)lcd_data);
+		LCD_PERF_TX(2);
+		return;
+	}
+#endif
+	LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT); // 按8位拆分传输
+	LCD_DC_Data;						   // 数据指令选择 引脚输出高电平，代表本次传输 数据
+
+	lcd_data_buff[0] = lcd_data >> 8; // 将数据拆分
+	lcd_data_buff[1] = lcd_data;
+
+	HAL_SPI_Transmit(&LCD_SPI, lcd_data_buff, 2, 1000); // 启动SPI传输
+	LCD_PERF_TX(2);
+}
+
+/**
+ * @brief  发送一条指令和它的参数
+ * @param  param 参数，n 不超过 LCD_SPI_FIFO_BYTES，可为0
+ * @note   SPI只使能一次：指令字节移出后切换一次DC，参数一次写满FIFO，不再逐字节调用HAL传输
+ */
+ITCM_CODE static void LCD_WriteCommandParams(uint8_t cmd, const uint8_t *param, uint8_t n)
+{
+	SPI_HandleTypeDef *hspi = &LCD_SPI;
+	uint32_t tickstart;
+
+	LCD_WaitIdle();						   // 等待后台传输结束
+	LCD_444_FLUSH();
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+	{
+		LCD_Fmc_Write8(LCD_Cur->Cfg.FmcCmd, cmd);
+		for (uint8_t i = 0; i < n; i++)
+			LCD_Fmc_Write8(LCD_Cur->Cfg.FmcData, param[i]);
+		LCD_PERF_TX(n + 1);
+		LCD_Win_Pos = 0;
+		LCD_Win_Writing = (cmd == LCD_CTRL->Ramwr); // 写显存指令之后写指针回到窗口起点
+		return;
+	}
+#endif
+	LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT); // 指令和参数按8位传输
+	LCD_DC_Command;						   // 指令
+	LCD_Win_Writing = 0;
+
+	hspi->State = HAL_SPI_STATE_BUSY_TX; // 已等到后台传输结束，句柄空闲
+	hspi->ErrorCode = HAL_SPI_ERROR_NONE;
+	tickstart = HAL_GetTick();
+	if (hspi->Init.Direction == SPI_DIRECTION_1LINE)
+	{
+		SPI_1LINE_TX(hspi);
+	}
+	MODIFY_REG(hspi->Instance->CR2, SPI_CR2_TSIZE, 0); // 不限长度，由挂起结束
+	__HAL_SPI_ENABLE(hspi);
+	SET_BIT(hspi->Instance->CR1, SPI_CR1_CSTART);
+
+	LCD_SPI_WRITE_TXDR8(hspi, cmd);
+	if (n > 0)
+	{
+		// 屏幕在每个字节的最后一位采样DC，指令字节完全移出后才能切换
+		if (LCD_SPI_WaitOnFlagUntilTimeout(hspi, SPI_SR_TXC, RESET, tickstart, 1000) != HAL_OK)
+		{
+			SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_FLAG);
+		}
+		LCD_DC_Data; // 参数
+		for (uint8_t i = 0; i < n; i++)
+		{
+			LCD_SPI_WRITE_TXDR8(hspi, param[i]); // 不超过FIFO深度，不必等待TXP
+		}
+	}
+	if (LCD_SPI_WaitOnFlagUntilTimeout(hspi, SPI_SR_TXC, RESET, tickstart, 1000) != HAL_OK)
+	{
+		SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_FLAG);
+	}
+
+	SET_BIT(hspi->Instance->CR1, SPI_CR1_CSUSP); // 请求挂起SPI传输
+	if (LCD_SPI_WaitOnFlagUntilTimeout(hspi, SPI_FLAG_SUSP, RESET, tickstart, 1000) != HAL_OK)
+	{
+		SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_FLAG);
+	}
+	LCD_SPI_CloseTransfer(hspi);
+	SET_BIT(hspi->Instance->IFCR, SPI_IFCR_SUSPC); // 清除挂起标志位
+	hspi->State = HAL_SPI_STATE_READY;
+	LCD_PERF_TX(n + 1);
+	if (cmd == LCD_CTRL->Ramwr) // 写指针回到窗口起点
+	{
+		LCD_Win_Pos = 0;
+		LCD_Win_Writing = 1;
+	}
+}
+
+/**
+ * @brief  设置列(0x2A)或行(0x2B)地址范围，与屏幕上次的范围相同时跳过
+ * @param  last 该方向上次设置的范围
+ */
+ITCM_CODE static void LCD_WriteRange(uint8_t cmd, uint32_t *last, uint16_t start, uint16_t end)
+{
+	uint32_t range = ((uint32_t)start << 16) | end;
+	uint8_t param[4];
+
+	if (range == *last)
+	{
+		PERF_COUNT(window_skips);
+		return;
+	}
+	*last = range;
+	param[0] = start >> 8;
+	param[1] = start;
+	param[2] = end >> 8;
+	param[3] = end;
+	LCD_WriteCommandParams(cmd, param, 4);
+}
+
+/**
+ * @brief  新窗口是否正好从屏幕写指针处接着上一个窗口往下写
+ * @note   列范围相同、写指针在某一行的行首、新窗口从这一行开始且不超出原窗口的底部时，
+ *         像素直接接着发送即可，不用任何指令；例如图片按缓冲区分段发送、条带逐段刷新
+ * @retval 1-可以不发送指令
+ */
+ITCM_CODE static uint8_t LCD_Win_Continues(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+	uint32_t w = x2 - x1 + 1;
+	uint32_t row;
+
+	if (!LCD_Win_Writing || !(LCD_CTRL->Caps & LCD_CTRL_CONTINUE) || LCD_Win_Col != (((uint32_t)x1 << 16) | x2) ||
+		LCD_Win_Pos % w != 0)
+	{
+		return 0;
+	}
+	row = (LCD_Win_Row >> 16) + LCD_Win_Pos / w; // 写指针所在行
+	return (row == y1 && y2 <= (LCD_Win_Row & 0xFFFF));
+}
+
+/**
+ * @brief  把像素直接发送到屏幕当前窗口
+ * @param  owner DataBuff 所在的缓冲区，只发送其中一段时 LCD_WaitBuff() 仍以整个缓冲区判断
+ */
+ITCM_CODE static void LCD_SendBuff(const uint16_t *owner, uint16_t *DataBuff, uint16_t DataSize)
+{
+#ifdef LCD_RGB444_ENABLE
+	if (LCD_PIXEL_444())
+	{
+		LCD_444_Send(DataBuff, 0, DataSize); // 打包时与上一段的DMA发送并行
+		return;
+	}
+#endif
+	LCD_WaitIdle(); // 等待上一次DMA传输结束
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+	{
+		LCD_Fmc_Send(owner, DataBuff, 0, DataSize);
+		LCD_FMC_RELEASE(DataBuff);
+		return;
+	}
+#endif
+
+	LCD_DC_Data; // 数据指令选择 引脚输出高电平，代表本次传输 数据
+
+	// 修改为16位数据宽度，写入数据更加效率，不需要拆分
+	LCD_SPI_SetDataSize(SPI_DATASIZE_16BIT); // 16位数据宽度
+
+#ifdef LCD_SPI_DMA_ENABLE
+	// 位于SRAM4的缓冲区交给BDMA后台发送，CPU可以继续准备下一个字模
+	if (DataSize > 0 && LCD_IS_DMA_RAM(DataBuff))
+	{
+		SCB_CleanDCache_by_Addr((uint32_t *)DataBuff, DataSize * 2); // 把CPU写入的像素刷回SRAM4
+		LCD_DMA_TxBuff = owner; // LCD_WaitBuff() 按整个缓冲区判断是否在发送
+		LCD_DMA_SetMode(LCD_DMA_BuffMode(DataBuff, DataSize)); // 上一次可能是同色填充
+		PERF_TRACE_BEGIN(PERF_TRACE_DMA, DataSize);				// 完成中断中结束
+		if (HAL_SPI_Transmit_DMA(&LCD_SPI, (uint8_t *)DataBuff, DataSize) == HAL_OK)
+		{
+			LCD_PERF_TX(DataSize * 2);
+			LCD_WIN_ADVANCE(DataSize);
+			return; // 8位宽度在下一次写指令时恢复
+		}
+		LCD_DMA_TxBuff = NULL; // 启动失败，改用阻塞传输
+		PERF_TRACE_END(PERF_TRACE_DMA, 0);
+	}
+#endif
+
+	PERF_TRACE_BEGIN(PERF_TRACE_SPI, DataSize);
+	HAL_SPI_Transmit(&LCD_SPI, (uint8_t *)DataBuff, DataSize, 1000); // 启动SPI传输
+	PERF_TRACE_END(PERF_TRACE_SPI, 0);
+	LCD_PERF_TX(DataSize * 2);
+	LCD_WIN_ADVANCE(DataSize);
+
+	// 改回8位数据宽度，因为指令和部分数据都是按照8位传输的
+	LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT); // 8位数据宽度
+}
+
+/**
+ * @brief  在当前窗口中连续写入 count 个同色像素
+ * @note   1. 不少于 LCD_SPI_DMA_FILL_MIN 个像素时由BDMA从固定地址重复发送同一个颜色，立即返回，
+ *            整屏清除几乎不占用CPU，可以与后续的字模查找、展开并行
+ *         2. 更少的像素或未启用DMA时由 LCD_SPI_Transmit 写TXDR发送，不经过渲染缓冲区
+ */
+static void LCD_SendColor(uint16_t color, uint32_t count)
+{
+#ifdef LCD_RGB444_ENABLE
+	if (LCD_PIXEL_444())
+	{
+		LCD_444_Send(NULL, color, count);
+		return;
+	}
+#endif
+	LCD_WaitIdle(); // 缓冲区中的前一段可能仍在DMA发送
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+	{
+		LCD_Fmc_Send(NULL, NULL, color, count); // 同色填充同样由MDMA从固定地址重复写入
+		return;
+	}
+#endif
+	LCD_DC_Data;	// 数据指令选择 引脚输出高电平，代表本次传输 数据
+
+	LCD_SPI_SetDataSize(SPI_DATASIZE_16BIT); // 16位数据宽度
+
+#ifdef LCD_SPI_DMA_ENABLE
+	if (count >= LCD_SPI_DMA_FILL_MIN)
+	{
+		LCD_DMA_FillWord[0] = ((uint32_t)color << 16) | color;				  // 32位传输时一项为2个像素
+		SCB_CleanDCache_by_Addr(LCD_DMA_FillWord, sizeof(LCD_DMA_FillWord)); // 把颜色刷回SRAM4
+		LCD_DMA_TxBuff = (const uint16_t *)LCD_DMA_FillWord;				  // 标记DMA忙，不对应任何渲染缓冲区
+		LCD_DMA_FillLeft = count;
+		PERF_TRACE_BEGIN(PERF_TRACE_DMA, count); // 最后一段的完成中断中结束
+		if (LCD_DMA_FillNext() == HAL_OK)
+		{
+			LCD_PERF_TX(count * 2);
+			LCD_WIN_ADVANCE(count);
+			return; // 8位宽度在下一次写指令时恢复
+		}
+		LCD_DMA_FillLeft = 0; // 启动失败，改用CPU发送
+		LCD_DMA_TxBuff = NULL;
+		PERF_TRACE_END(PERF_TRACE_DMA, 0);
+	}
+#endif
+
+	PERF_TRACE_BEGIN(PERF_TRACE_SPI, count);
+	LCD_SPI_Transmit(&LCD_SPI, color, count);
+	PERF_TRACE_END(PERF_TRACE_SPI, 0);
+	LCD_WIN_ADVANCE(count);
+	LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT); // 8位数据宽度
+}
+
+/**
+ * @brief  按裁剪区过滤后发送当前窗口的像素
+ * @param  owner/pData 与 LCD_SendBuff 相同，pData 为NULL时发送 count 个 color
+ * @note   列完全可见时相邻的可见行合并为一次发送，否则逐行只发送可见的列
+ */
+static void LCD_Clip_Write(const uint16_t *owner, const uint16_t *pData, uint16_t color, uint32_t Size)
+{
+	uint32_t w = LCD_Clip_Win.x2 - LCD_Clip_Win.x1 + 1;
+	uint8_t full_cols = (LCD_Clip_Vis.x1 == LCD_Clip_Win.x1 && LCD_Clip_Vis.x2 == LCD_Clip_Win.x2);
+
+	if (LCD_Clip_Mode == LCD_CLIP_DROP)
+		return;
+
+	while (Size > 0 && LCD_Clip_CurY <= LCD_Clip_Vis.y2)
+	{
+		uint32_t col = LCD_Clip_CurX - LCD_Clip_Win.x1;
+		uint32_t c1 = LCD_Clip_CurX, c2, span;
+
+		if (LCD_Clip_CurY < LCD_Clip_Vis.y1)
+			span = (LCD_Clip_Vis.y1 - LCD_Clip_CurY) * w - col; // 跳过上方不可见的行
+		else if (full_cols)
+			span = (LCD_Clip_Vis.y2 - LCD_Clip_CurY + 1) * w - col; // 剩余可见行连续
+		else
+			span = w - col;
+		if (span > Size)
+			span = Size;
+
+		if (LCD_Clip_CurY >= LCD_Clip_Vis.y1)
+		{
+			c2 = c1 + span - 1;
+			if (!full_cols)
+			{
+				if (c1 < LCD_Clip_Vis.x1)
+					c1 = LCD_Clip_Vis.x1;
+				if (c2 > LCD_Clip_Vis.x2)
+					c2 = LCD_Clip_Vis.x2;
+			}
+			if (c1 <= c2 && pData == NULL)
+			{
+				LCD_SendColor(color, c2 - c1 + 1);
+			}
+			else if (c1 <= c2)
+			{
+				const uint16_t *p = pData + (c1 - LCD_Clip_CurX);
+
+				for (uint32_t n = c2 - c1 + 1, k; n > 0; n -= k, p += k)
+				{
+					k = (n > 0xFFFF) ? 0xFFFF : n;
+					LCD_SendBuff(owner, (uint16_t *)p, (uint16_t)k);
+				}
+			}
+		}
+
+		if (pData != NULL)
+			pData += span;
+		Size -= span;
+		col += span;
+		LCD_Clip_CurY += col / w;
+		LCD_Clip_CurX = LCD_Clip_Win.x1 + col % w;
+	}
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_WriteBuff
+ *
+ *	入口参数: DataBuff - 数据区，DataSize - 数据长度
+ *
+ *	函数功能: 批量写入数据到屏幕
+ *
+ *	说    明: 1. 启用 LCD_SPI_DMA_ENABLE 且 DataBuff 位于SRAM4时，启动BDMA传输后立即返回，
+ *				   改写 DataBuff 之前需调用 LCD_WaitIdle()
+ *				2. 窗口部分超出裁剪区时只发送可见的像素
+ *
+ ****************************************************************************************************************************************/
+
+ITCM_CODE void LCD_WriteBuff(uint16_t *DataBuff, uint16_t DataSize)
+{
+#ifdef LCD_CAPTURE_ENABLE
+	if (LCD_FB_CAPTURE())
+	{
+		LCD_FB_Write(DataBuff, 0, DataSize); // 写入帧缓冲
+		return;
+	}
+#endif
+	if (LCD_Clip_Mode != LCD_CLIP_OFF)
+	{
+		LCD_Clip_Write(DataBuff, DataBuff, 0, DataSize);
+		return;
+	}
+	LCD_SendBuff(DataBuff, DataBuff, DataSize);
+}
+
+/**
+ * @brief  在当前窗口中连续写入 count 个同色像素，经过帧缓冲/条带和裁剪区
+ */
+static void LCD_WriteColor(uint16_t color, uint32_t count)
+{
+	PERF_ADD(fill_pixels, count);
+#ifdef LCD_CAPTURE_ENABLE
+	if (LCD_FB_CAPTURE())
+	{
+		LCD_FB_Write(NULL, color, count); // 填充帧缓冲
+		return;
+	}
+#endif
+	if (LCD_Clip_Mode != LCD_CLIP_OFF)
+	{
+		LCD_Clip_Write(NULL, NULL, color, count);
+		return;
+	}
+	LCD_SendColor(color, count);
+}
+
+#ifdef LCD_SPI_CLOCK_ENABLE
+static uint32_t LCD_SPI_ClockHz = LCD_SPI_CLOCK_HZ; // 当前像素时钟，未调用 LCD_SPI_SetClock() 时为CubeMX配置的60MHz
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_SPI_SetClock
+ *
+ *	入口参数: hz - 目标像素时钟(SCK)
+ *
+ *	返 回 值: 实际频率(Hz)，配置失败返回0
+ *
+ *	函数功能: 由PLL3Q产生SPI6内核时钟，设置像素时钟
+ *
+ *	说    明: 1. SCK = PLL3Q / 2，PLL3Q = 参考时钟 x N / Q，参考时钟 = LCD_SPI_PLL_SRC_HZ / LCD_SPI_PLL3_M
+ *				2. 遍历Q(1~128)，在VCO(192~836MHz)范围内取不超过目标的最大频率
+ *				3. 原配置的D3PCLK1只有120MHz，分频系数最小为2，SCK上限60MHz
+ *
+ ****************************************************************************************************************************************/
+
+uint32_t LCD_SPI_SetClock(uint32_t hz)
+{
+	RCC_PeriphCLKInitTypeDef PeriphClkInitStruct = {0};
+	uint32_t ref = LCD_SPI_PLL_SRC_HZ / LCD_SPI_PLL3_M; // PLL3参考时钟
+	uint64_t kernel, best = 0;
+	uint32_t best_n = 0, best_q = 0;
+
+	if (LCD_Cur != &LCD_Panels[0]) // 只有屏幕0的SPI6由PLL3提供内核时钟
+		return 0;
+	if (hz > LCD_SPI_CLOCK_MAX_HZ)
+		hz = LCD_SPI_CLOCK_MAX_HZ;
+	if (hz > LCD_CTRL->MaxClockHz) // 控制器允许的上限
+		hz = LCD_CTRL->MaxClockHz;
+	kernel = (uint64_t)hz * 2; // 分频系数固定为2
+
+	for (uint32_t q = 1; q <= 128; q++)
+	{
+		uint64_t n = kernel * q / ref; // 向下取整，保证不超过目标
+		uint64_t vco = n * ref;
+
+		if (n < 4 || n > 512 || vco < 192000000ULL || vco > 836000000ULL)
+			continue;
+		if (vco / q > best)
+		{
+			best = vco / q;
+			best_n = (uint32_t)n;
+			best_q = q;
+		}
+	}
+	if (best == 0) // 目标频率过低，PLL3无法产生
+		return 0;
+
+	LCD_WaitIdle();				 // 切换时钟前等待后台传输结束
+	__HAL_SPI_DISABLE(&LCD_SPI); // PLL3重新锁定期间SPI6没有内核时钟
+
+	PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_SPI6;
+	PeriphClkInitStruct.Spi6ClockSelection = RCC_SPI6CLKSOURCE_PLL3;
+	PeriphClkInitStruct.PLL3.PLL3M = LCD_SPI_PLL3_M;
+	PeriphClkInitStruct.PLL3.PLL3N = best_n;
+	PeriphClkInitStruct.PLL3.PLL3P = 2; // P、R输出未使用
+	PeriphClkInitStruct.PLL3.PLL3Q = best_q;
+	PeriphClkInitStruct.PLL3.PLL3R = 2;
+	PeriphClkInitStruct.PLL3.PLL3RGE = (ref < 2000000)	 ? RCC_PLL3VCIRANGE_0
+									   : (ref < 4000000) ? RCC_PLL3VCIRANGE_1
+									   : (ref < 8000000) ? RCC_PLL3VCIRANGE_2
+														 : RCC_PLL3VCIRANGE_3;
+	PeriphClkInitStruct.PLL3.PLL3VCOSEL = RCC_PLL3VCOWIDE;
+	PeriphClkInitStruct.PLL3.PLL3FRACN = 0;
+	if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct) != HAL_OK)
+		return 0;
+
+	MODIFY_REG(LCD_SPI.Instance->CFG1, SPI_CFG1_MBR, SPI_BAUDRATEPRESCALER_2); // 内核时钟2分频
+	LCD_SPI.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_2;
+
+	LCD_SPI_ClockHz = (uint32_t)(best / 2);
+	return LCD_SPI_ClockHz;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_SPI_GetClock
+ *
+ *	返 回 值: 当前像素时钟(Hz)
+ *
+ ****************************************************************************************************************************************/
+
+uint32_t LCD_SPI_GetClock(void)
+{
+	return LCD_SPI_ClockHz;
+}
+
+/**
+ * @brief  以 LCD_SPI_READ_HZ 读取ST7789的8位寄存器
+ * @note   读数据由屏幕经SDA(即MOSI)送出，SPI临时切换为单线半双工接收；
+ *         硬件NSS在每次传输结束时释放，会打断读取，因此片选在读取期间改为GPIO
+ */
+static uint8_t LCD_ReadRegister(uint8_t command)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	uint32_t kernel = LCD_SPI_ClockHz * 2;
+	uint32_t mbr = 0; // 分频系数 = 2^(mbr+1)
+	uint8_t value = 0;
+
+	while (mbr < 7 && (kernel >> (mbr + 1)) > LCD_SPI_READ_HZ)
+		mbr++;
+
+	LCD_WaitIdle();
+	LCD_444_FLUSH();
+	LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT);
+	LCD_Win_Writing = 0; // 读寄存器指令结束写显存
+
+	GPIO_InitStruct.Pin = LCD_CS_PIN;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_WritePin(LCD_CS_PORT, LCD_CS_PIN, GPIO_PIN_RESET); // 先输出低电平再切换模式，避免片选抖动
+	HAL_GPIO_Init(LCD_CS_PORT, &GPIO_InitStruct);
+
+	__HAL_SPI_DISABLE(&LCD_SPI);
+	MODIFY_REG(LCD_SPI.Instance->CFG1, SPI_CFG1_MBR, mbr << SPI_CFG1_MBR_Pos);
+
+	LCD_DC_Command;
+	HAL_SPI_Transmit(&LCD_SPI, &command, 1, 10);
+
+	// 8位寄存器读取没有空周期，紧接着的8个时钟由屏幕输出数据
+	LCD_SPI.Init.Direction = SPI_DIRECTION_1LINE;
+	MODIFY_REG(LCD_SPI.Instance->CFG2, SPI_CFG2_COMM, SPI_DIRECTION_1LINE);
+	HAL_SPI_Receive(&LCD_SPI, &value, 1, 10);
+	LCD_SPI.Init.Direction = SPI_DIRECTION_2LINES_TXONLY;
+	MODIFY_REG(LCD_SPI.Instance->CFG2, SPI_CFG2_COMM, SPI_DIRECTION_2LINES_TXONLY);
+	MODIFY_REG(LCD_SPI.Instance->CFG1, SPI_CFG1_MBR, SPI_BAUDRATEPRESCALER_2);
+
+	HAL_GPIO_WritePin(LCD_CS_PORT, LCD_CS_PIN, GPIO_PIN_SET);
+	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP; // 恢复硬件NSS
+	GPIO_InitStruct.Alternate = GPIO_AF7_SPI6;
+	HAL_GPIO_Init(LCD_CS_PORT, &GPIO_InitStruct);
+
+	return value;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_SPI_TestClock
+ *
+ *	入口参数: hz - 测试频率
+ *				clear_cycles - 输出该频率下整屏清屏的CPU周期数，可为NULL
+ *
+ *	返 回 值: 读回不一致的次数，0表示全部正确
+ *
+ *	函数功能: 测试指定频率下的写入是否可靠
+ *
+ *	说    明: 1. 以测试频率写入显存访问控制寄存器(0x36)，降频后读回(0x0B)比较，指令和像素数据走同一条总线
+ *				2. 清屏耗时可以看出CPU填充FIFO能否跟上更高的时钟
+ *
+ ****************************************************************************************************************************************/
+
+uint16_t LCD_SPI_TestClock(uint32_t hz, uint32_t *clear_cycles)
+{
+	static const uint8_t pattern[4] = {0xFC, 0x00, 0xA8, 0x54}; // 0x36只有D7~D2有效，读回时D1、D0为0
+	uint16_t errors = 0;
+
+	if (LCD_SPI_SetClock(hz) == 0)
+		return LCD_SPI_CALIB_TRIALS;
+
+	for (uint16_t i = 0; i < LCD_SPI_CALIB_TRIALS; i++)
+	{
+		uint8_t value = pattern[i % 4];
+
+		LCD_WriteCommand(0x36);
+		LCD_WriteData_8bit(value);
+		if (LCD_ReadRegister(0x0B) != value)
+			errors++;
+	}
+	LCD_SetDirection(LCD.Direction); // 恢复显存访问方式
+
+	if (clear_cycles != NULL)
+	{
+		uint32_t start;
+
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->LAR = 0xC5ACCE55;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+		start = DWT->CYCCNT;
+		LCD_Clear();
+		LCD_WaitIdle();
+		*clear_cycles = DWT->CYCCNT - start;
+	}
+	return errors;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_SPI_Calibrate
+ *
+ *	入口参数: max_hz - 搜索上限
+ *
+ *	返 回 值: 最终设置的像素时钟(Hz)，无法回读时返回0
+ *
+ *	函数功能: 寻找屏幕能稳定工作的最高像素时钟并设置
+ *
+ *	说    明: 1. 从 LCD_SPI_CALIB_START_HZ 起按 LCD_SPI_CALIB_STEP_HZ 递增，遇到第一个出错的频率后退回一档
+ *				2. 起始频率就失败多半是模块的SDA不能回读，此时恢复 LCD_SPI_CLOCK_HZ
+ *				3. 结果与温度、排线长度有关，建议在产品的实际装配状态下运行并保存结果
+ *
+ ****************************************************************************************************************************************/
+
+uint32_t LCD_SPI_Calibrate(uint32_t max_hz)
+{
+	uint32_t best = 0;
+	uint8_t failed = 0;
+
+	if (max_hz > LCD_SPI_CLOCK_MAX_HZ)
+		max_hz = LCD_SPI_CLOCK_MAX_HZ;
+	if (max_hz > LCD_CTRL->MaxClockHz)
+		max_hz = LCD_CTRL->MaxClockHz;
+
+	for (uint32_t hz = LCD_SPI_CALIB_START_HZ; hz <= max_hz; hz += LCD_SPI_CALIB_STEP_HZ)
+	{
+		if (LCD_SPI_TestClock(hz, NULL) != 0)
+		{
+			failed = 1;
+			break;
+		}
+		best = hz;
+	}
+
+	if (best == 0)
+	{
+		LCD_SPI_SetClock(LCD_SPI_CLOCK_HZ);
+		return 0;
+	}
+	if (failed && best > LCD_SPI_CALIB_START_HZ)
+		best -= LCD_SPI_CALIB_STEP_HZ; // 出错频率之下再留一档余量
+
+	return LCD_SPI_SetClock(best);
+}
+#endif
+
+#ifdef LCD_TE_ENABLE
+// 撕裂效应同步：TE在每帧垂直消隐开始时输出上升沿，EXTI记下时刻，由刷新周期推算扫描线当前的位置；
+// 一段区域的每个扫描行都要在屏幕上一次读取之后、下一次读取之前写入，才能在同一帧中整体显示
+#define LCD_TE_ALONG 0	 // 竖屏，写入与刷新同向逐行推进
+#define LCD_TE_AGAINST 1 // 竖屏，写入与刷新反向推进
+#define LCD_TE_ACROSS 2	 // 横屏，显存行对应绘图坐标的列，窗口的每一行都跨过段内所有扫描行
+
+static uint8_t LCD_TE_On = 0;				 // LCD_TE_Enable() 打开
+static volatile uint32_t LCD_TE_Stamp = 0;	 // 最近一次TE上升沿的DWT周期
+static volatile uint32_t LCD_TE_Period = 0;	 // 刷新周期(CPU周期)，相邻两次上升沿的滤波值
+static volatile uint32_t LCD_TE_Count = 0;	 // 打开以来的TE脉冲数
+static uint32_t LCD_TE_Factor = 256;		 // 实测发送耗时与按像素时钟计算值之比(8.8定点)，包含指令和缓冲区切换的开销
+static uint32_t LCD_TE_Start = 0;			 // 上一段开始发送的时刻
+static uint32_t LCD_TE_Pixels = 0;			 // 上一段的像素数，0表示没有待测量的段
+
+/**
+ * @brief  TE是否可用：已打开、当前为屏幕0、测出了周期且最近仍有脉冲
+ */
+static uint8_t LCD_TE_Locked(void)
+{
+	return LCD_TE_On && LCD_Cur->Index == 0 && LCD_TE_Count >= 2 && LCD_TE_Period != 0 &&
+		   (DWT->CYCCNT - LCD_TE_Stamp) < LCD_TE_TIMEOUT_MS * (SystemCoreClock / 1000U);
+}
+
+/**
+ * @brief  当前方向下屏幕的刷新方式
+ * @param  cols 输出：1-显存行对应绘图坐标的x(MADCTL的MV位)，0-对应y
+ * @retval 1-刷新顺序随坐标增大，0-随坐标减小(MY翻转显存行地址，ML翻转刷新顺序)
+ */
+static uint8_t LCD_TE_Axis(uint8_t *cols)
+{
+	uint8_t madctl = LCD_CTRL->Madctl[LCD.Direction];
+
+	*cols = (madctl & 0x20) != 0;
+	return ((madctl & 0x80) != 0) == ((madctl & 0x10) != 0);
+}
+
+/**
+ * @brief  坐标 c (cols 为1时是x，否则是y)所在显存行的刷新序号
+ */
+static uint16_t LCD_TE_Scan(uint16_t c, uint8_t cols, uint8_t up)
+{
+	uint16_t addr = c + (cols ? LCD.X_Offset : LCD.Y_Offset);
+
+	return up ? addr : (uint16_t)(LCD_CTRL->RamRows - 1 - addr);
+}
+
+/**
+ * @brief  发送一个像素的CPU周期数(8.8定点)，按像素时钟、接口像素格式和实测开销计算
+ */
+static uint32_t LCD_TE_PixelCycles(void)
+{
+#ifdef LCD_SPI_CLOCK_ENABLE
+	uint32_t sck = LCD_SPI_ClockHz;
+#else
+	uint32_t sck = LCD_SPI_CLOCK_HZ;
+#endif
+	uint32_t bits = 16;
+
+#ifdef LCD_RGB444_ENABLE
+	if (LCD_PIXEL_444())
+		bits = 12;
+#endif
+	return (uint32_t)((uint64_t)bits * SystemCoreClock * LCD_TE_Factor / sck);
+}
+
+/**
+ * @brief  用上一段的实际耗时修正开销系数，须在上一段发送完之后调用
+ */
+static void LCD_TE_Learn(void)
+{
+	uint32_t cycles = DWT->CYCCNT - LCD_TE_Start;
+	uint32_t expect = (uint32_t)(((uint64_t)LCD_TE_Pixels * LCD_TE_PixelCycles()) / LCD_TE_Factor);
+	uint32_t factor;
+
+	if (LCD_TE_Pixels >= LCD_BUFF_PIXELS && expect != 0) // 太小的段以指令开销为主，不参与测量
+	{
+		factor = (uint32_t)(((uint64_t)cycles << 8) / expect);
+		if (factor < 256)
+			factor = 256;
+		if (factor > 1024)
+			factor = 1024;
+		LCD_TE_Factor = (LCD_TE_Factor * 3 + factor) / 4;
+	}
+	LCD_TE_Pixels = 0;
+}
+
+/**
+ * @brief  一段不撕裂所需的时间跨度：段内各扫描行的写入时刻与刷新时刻之差的范围
+ * @param  mode LCD_TE_ALONG 等
+ * @param  n 段内扫描行数-1
+ * @param  w 写一个扫描行的周期数(竖屏为一行，横屏为一列)
+ * @param  line 刷新一个扫描行的周期数
+ * @param  gmin/gmax 输出：差值的最小、最大值(gmin<=0<=gmax)
+ */
+static void LCD_TE_Span(uint8_t mode, uint32_t n, uint32_t w, uint32_t line, int32_t *gmin, int32_t *gmax)
+{
+	int32_t x = (int32_t)(n * w) - (int32_t)(n * line);
+
+	if (mode == LCD_TE_ALONG) // 第k行在 k*w 时写入、k*line 时刷新
+	{
+		*gmin = (x < 0) ? x : 0;
+		*gmax = (x > 0) ? x : 0;
+	}
+	else // 反向时最后刷新的行最先写入；横屏时每个扫描行在整段发送期间都在写入
+	{
+		*gmin = -(int32_t)(n * line);
+		*gmax = (int32_t)((mode == LCD_TE_ACROSS ? n + 1 : n) * w);
+	}
+}
+
+/**
+ * @brief  等到可以开始发送一段的时刻
+ * @param  scan 段内最先刷新的扫描行
+ * @retval None
+ */
+static void LCD_TE_Wait(uint8_t mode, uint16_t scan, uint32_t n, uint32_t w)
+{
+	uint32_t period = LCD_TE_Period;
+	uint32_t line = period / (LCD_CTRL->RamRows + LCD_TE_VBLANK_LINES);
+	uint32_t margin = LCD_TE_MARGIN_US * (SystemCoreClock / 1000000U);
+	uint32_t now = DWT->CYCCNT;
+	uint32_t phase, lo, hi, wait = 0;
+	int32_t gmin, gmax;
+
+	LCD_TE_Span(mode, n, w, line, &gmin, &gmax);
+	lo = (uint32_t)(-gmin) + margin; // 相对刷新扫到 scan 的时刻
+	hi = (period > (uint32_t)gmax + margin) ? period - (uint32_t)gmax - margin : 0;
+	phase = ((now - LCD_TE_Stamp) % period + period - ((LCD_TE_VBLANK_LINES + scan) * line) % period) % period;
+
+	if (phase < lo)
+		wait = lo - phase;
+	else if (phase > hi) // 已错过本帧的时间窗，等下一帧(一段写不完的区域 hi < lo，也在 lo 开始)
+		wait = period - phase + lo;
+	while (DWT->CYCCNT - now < wait)
+	{
+	}
+}
+
+/**
+ * @brief  一段最多的扫描行数，使时间跨度不超过一个刷新周期
+ */
+static uint32_t LCD_TE_MaxLines(uint8_t mode, uint32_t w)
+{
+	uint32_t period = LCD_TE_Period;
+	uint32_t line = period / (LCD_CTRL->RamRows + LCD_TE_VBLANK_LINES);
+	uint32_t room = LCD_TE_MARGIN_US * 2U * (SystemCoreClock / 1000000U) + (mode == LCD_TE_ACROSS ? w : 0);
+	uint32_t cost = (mode == LCD_TE_ALONG) ? (w > line ? w - line : line - w) : w + line; // 每多一个扫描行增加的跨度
+
+	if (room >= period)
+		return 1;
+	if (cost == 0)
+		return 0xFFFF;
+	return (period - room) / cost + 1;
+}
+
+/**
+ * @brief  当前方向下矩形的扫描方式和写一个扫描行的周期数
+ * @param  c1/c2 输出：沿刷新方向的坐标范围
+ * @param  up 输出：刷新顺序是否随坐标增大
+ * @retval 写一个扫描行的周期数
+ */
+static uint32_t LCD_TE_Geometry(const LCD_Rect_t *r, uint8_t *mode, uint16_t *c1, uint16_t *c2, uint8_t *up)
+{
+	uint8_t cols;
+	uint32_t other;
+
+	*up = LCD_TE_Axis(&cols);
+	*mode = cols ? LCD_TE_ACROSS : (*up ? LCD_TE_ALONG : LCD_TE_AGAINST);
+	*c1 = cols ? r->x1 : r->y1;
+	*c2 = cols ? r->x2 : r->y2;
+	other = cols ? (uint32_t)(r->y2 - r->y1 + 1) : (uint32_t)(r->x2 - r->x1 + 1);
+	return (other * LCD_TE_PixelCycles()) >> 8;
+}
+
+#ifdef LCD_FRAMEBUFFER_ENABLE
+/**
+ * @brief  脏矩形按最先刷新的扫描行排序，一次刷新中依次追上各矩形
+ */
+static void LCD_TE_Order(LCD_Rect_t *rects, uint8_t count)
+{
+	uint8_t cols, up;
+
+	if (!LCD_TE_Locked())
+		return;
+	up = LCD_TE_Axis(&cols);
+	for (uint8_t i = 1; i < count; i++)
+	{
+		LCD_Rect_t r = rects[i];
+		uint16_t key = LCD_TE_Scan(up ? (cols ? r.x1 : r.y1) : (cols ? r.x2 : r.y2), cols, up);
+		uint8_t j = i;
+
+		while (j > 0 && LCD_TE_Scan(up ? (cols ? rects[j - 1].x1 : rects[j - 1].y1) : (cols ? rects[j - 1].x2 : rects[j - 1].y2), cols, up) > key)
+		{
+			rects[j] = rects[j - 1];
+			j--;
+		}
+		rects[j] = r;
+	}
+}
+
+/**
+ * @brief  按TE时刻发送一个脏矩形，一帧内写不完时沿刷新方向分段，每段在自己的时间窗内开始
+ * @param  first 本次 LCD_Flush() 的第一个矩形，之前没有需要测量的段
+ * @note   每段开始前等待上一段发送完，段的开始时刻才是实际上屏的时刻
+ */
+static void LCD_TE_Present(const LCD_Rect_t *r, uint8_t first)
+{
+	LCD_Rect_t band = *r;
+	uint8_t mode, up;
+	uint16_t c1, c2;
+	uint32_t w, lines;
+	int32_t from, to;
+
+	if (first)
+		LCD_TE_Pixels = 0;
+	if (!LCD_TE_Locked())
+	{
+		LCD_FB_SendRect(r);
+		return;
+	}
+
+	w = LCD_TE_Geometry(r, &mode, &c1, &c2, &up);
+	lines = LCD_TE_MaxLines(mode, w);
+	from = c1;
+	to = c2;
+	while (from <= to)
+	{
+		uint32_t n = ((uint32_t)(to - from + 1) < lines) ? (uint32_t)(to - from + 1) : lines;
+		uint16_t b1 = up ? (uint16_t)from : (uint16_t)(to - n + 1);
+		uint16_t b2 = (uint16_t)(b1 + n - 1);
+
+		if (up)
+			from += n;
+		else
+			to -= n;
+		if (mode == LCD_TE_ACROSS)
+		{
+			band.x1 = b1;
+			band.x2 = b2;
+		}
+		else
+		{
+			band.y1 = b1;
+			band.y2 = b2;
+		}
+
+		LCD_WaitIdle();
+		if (LCD_TE_Pixels != 0)
+			LCD_TE_Learn();
+		LCD_TE_Wait(mode, LCD_TE_Scan(up ? b1 : b2, mode == LCD_TE_ACROSS, up), n - 1, w);
+		LCD_TE_Start = DWT->CYCCNT;
+		LCD_TE_Pixels = (uint32_t)(band.x2 - band.x1 + 1) * (band.y2 - band.y1 + 1);
+		LCD_FB_SendRect(&band);
+	}
+}
+#endif
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_TE_Enable
+ *
+ *	入口参数: enable - 1：打开，0：关闭
+ *
+ *	函数功能: 打开或关闭屏幕0的撕裂效应同步
+ *
+ *	说    明: 1. 打开时TE引脚配置为上升沿中断，TEON(0x35)参数为0，TE只在垂直消隐期为高
+ *				2. 收到两个脉冲测出刷新周期后开始同步，周期按每帧的实测值滤波，跟随屏幕帧率设置
+ *				3. 关闭时只释放TE引脚，不关闭共用的EXTI中断
+ *
+ *	返 回 值: 1-成功，0-当前不是屏幕0
+ *
+ ****************************************************************************************************************************************/
+
+uint8_t LCD_TE_Enable(uint8_t enable)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	uint8_t param = 0x00;
+
+	if (LCD_Cur->Index != 0)
+		return 0;
+
+	LCD_TE_On = 0;
+	LCD_TE_Count = 0;
+	LCD_TE_Period = 0;
+	LCD_TE_Pixels = 0;
+	if (!enable)
+	{
+		HAL_GPIO_DeInit(LCD_TE_PORT, LCD_TE_PIN);
+		LCD_WriteCommand(0x34); // TEOFF
+		return 1;
+	}
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // TE时间戳使用DWT周期计数器
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	GPIO_LDC_TE_CLK_ENABLE;
+	GPIO_InitStruct.Pin = LCD_TE_PIN;
+	GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	HAL_GPIO_Init(LCD_TE_PORT, &GPIO_InitStruct);
+	__HAL_GPIO_EXTI_CLEAR_IT(LCD_TE_PIN);
+	HAL_NVIC_SetPriority(LCD_TE_IRQn, LCD_TE_IRQ_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(LCD_TE_IRQn);
+
+	LCD_WriteCommandParams(0x35, &param, 1); // TEON，只在垂直消隐期输出
+	LCD_TE_On = 1;
+	return 1;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_TE_IRQHandler
+ *
+ *	函数功能: TE上升沿中断，记录帧起点并更新刷新周期
+ *
+ *	说    明: 1. 与上次间隔在周期的0.5~1.5倍之间时按1/8滤波，漏掉脉冲(屏幕忙、中断被屏蔽)的间隔不参与
+ *				2. 第二个脉冲时以间隔作为初始周期
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_TE_IRQHandler(void)
+{
+	uint32_t now = DWT->CYCCNT;
+	uint32_t delta;
+
+	if (__HAL_GPIO_EXTI_GET_IT(LCD_TE_PIN) == 0x00U)
+		return;
+	__HAL_GPIO_EXTI_CLEAR_IT(LCD_TE_PIN);
+
+	delta = now - LCD_TE_Stamp;
+	if (LCD_TE_Count == 1)
+		LCD_TE_Period = delta;
+	else if (LCD_TE_Count > 1 && delta > LCD_TE_Period / 2 && delta < LCD_TE_Period + LCD_TE_Period / 2)
+		LCD_TE_Period = (uint32_t)((int32_t)LCD_TE_Period + ((int32_t)(delta - LCD_TE_Period) / 8));
+	LCD_TE_Stamp = now;
+	LCD_TE_Count++;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_TE_WaitRect
+ *
+ *	入口参数: x、y - 起点坐标，width、height - 区域尺寸
+ *
+ *	函数功能: 等到矩形区域可以一次写完而不撕裂的时刻
+ *
+ *	说    明: 1. 先等待之前的DMA传输结束，返回后立即发送的区域才能按计算的时刻上屏
+ *				2. 区域一帧内写不完时在最早可以开始的时刻返回，只保证前面的部分不撕裂
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_TE_WaitRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	LCD_Rect_t r;
+	uint8_t mode, up;
+	uint16_t c1, c2;
+	uint32_t w;
+
+	if (width == 0 || height == 0 || x >= LCD.Width || y >= LCD.Height || !LCD_TE_Locked())
+		return;
+	r.x1 = x;
+	r.y1 = y;
+	r.x2 = ((uint32_t)x + width - 1 < LCD.Width) ? x + width - 1 : LCD.Width - 1;
+	r.y2 = ((uint32_t)y + height - 1 < LCD.Height) ? y + height - 1 : LCD.Height - 1;
+
+	w = LCD_TE_Geometry(&r, &mode, &c1, &c2, &up);
+	LCD_WaitIdle();
+	LCD_TE_Wait(mode, LCD_TE_Scan(up ? c1 : c2, mode == LCD_TE_ACROSS, up), (uint32_t)(c2 - c1), w);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_TE_GetPeriod
+ *
+ *	函数功能: 读取屏幕刷新周期
+ *
+ *	返 回 值: 周期(微秒)，没有锁定TE时返回0
+ *
+ ****************************************************************************************************************************************/
+
+uint32_t LCD_TE_GetPeriod(void)
+{
+	if (!LCD_TE_Locked())
+		return 0;
+	return LCD_TE_Period / (SystemCoreClock / 1000000U);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_TE_GetScanline
+ *
+ *	函数功能: 估算屏幕当前正在刷新的显存行
+ *
+ *	返 回 值: 行号(按刷新顺序)，处于垂直消隐期或没有锁定TE时返回0xFFFF
+ *
+ ****************************************************************************************************************************************/
+
+uint16_t LCD_TE_GetScanline(void)
+{
+	uint32_t line, pos;
+
+	if (!LCD_TE_Locked())
+		return 0xFFFF;
+	line = LCD_TE_Period / (LCD_CTRL->RamRows + LCD_TE_VBLANK_LINES);
+	pos = ((DWT->CYCCNT - LCD_TE_Stamp) % LCD_TE_Period) / (line != 0 ? line : 1);
+	if (pos < LCD_TE_VBLANK_LINES)
+		return 0xFFFF;
+	pos -= LCD_TE_VBLANK_LINES;
+	return (pos < LCD_CTRL->RamRows) ? (uint16_t)pos : (uint16_t)(LCD_CTRL->RamRows - 1);
+}
+#endif
+
+static uint32_t LCD_SleepOutTick = 0; // 发出退出休眠指令时的 HAL_GetTick()
+static uint32_t LCD_SleepOutMs = LCD_SLEEP_OUT_MS; // SPI_LCD_InitEnd() 需要等满的时间
+static uint8_t LCD_SplashDrawn = 0; // 显存中已写入开机画面，SPI_LCD_InitEnd() 不清屏
+
+#ifdef LCD_WARM_RESET_ENABLE
+#if LCD_PANEL_MAX > 8
+#error "LCD_WARM_RESET_ENABLE 按位记录屏幕，LCD_PANEL_MAX 不能超过8"
+#endif
+static int8_t LCD_WarmReset = -1; // -1为还没读取复位原因，1为看门狗/软件复位，0为其他复位
+static uint8_t LCD_WarmDone = 0;  // 已初始化过的屏幕(按编号的位)，再次初始化时完整执行
+static uint8_t LCD_WarmCur = 0;   // 各屏幕最近一次初始化是否为热复位(按编号的位)
+
+/**
+ * @brief  当前屏幕是否为复位后第一次初始化，且复位前一直上电、已配置
+ * @note   复位原因只在第一次调用时读取一次，随后清除 RCC->RSR：复位标志在清除前一直保留，
+ *         不清除时上电复位标志会使之后的所有软件复位都按冷启动处理
+ */
+static uint8_t LCD_WarmAttach(void)
+{
+	uint8_t bit = (uint8_t)(1U << LCD_Panel_Current());
+
+	if (LCD_WarmReset < 0)
+	{
+		LCD_WarmReset = (__HAL_RCC_GET_FLAG(RCC_FLAG_SFTRST) || __HAL_RCC_GET_FLAG(RCC_FLAG_IWDG1RST) ||
+						 __HAL_RCC_GET_FLAG(RCC_FLAG_WWDG1RST)) &&
+						!__HAL_RCC_GET_FLAG(RCC_FLAG_PORRST) && !__HAL_RCC_GET_FLAG(RCC_FLAG_BORRST);
+		__HAL_RCC_CLEAR_RESET_FLAGS();
+	}
+	LCD_WarmCur &= (uint8_t)~bit;
+	if (LCD_WarmReset == 0 || (LCD_WarmDone & bit))
+	{
+		LCD_WarmDone |= bit;
+		return 0;
+	}
+	LCD_WarmDone |= bit;
+	LCD_WarmCur |= bit;
+	return 1;
+}
+#endif
+
+/****************************************************************************************************************************************
+ *	函 数 名: SPI_LCD_Init
+ *
+ *	函数功能: 初始化屏幕控制器的各种参数
+ *
+ *	说    明: 等同于 SPI_LCD_InitBegin() 之后立即调用 SPI_LCD_InitEnd()，退出休眠的等待不做任何事
+ *
+ ****************************************************************************************************************************************/
+
+void SPI_LCD_Init(void)
+{
+	SPI_LCD_InitBegin();
+	SPI_LCD_InitEnd();
+}
+
+/**
+ * @brief  执行控制器描述表中的初始化脚本
+ */
+static void LCD_RunScript(const LCD_Controller_t *ctrl)
+{
+	const uint8_t *p = ctrl->Init;
+	const uint8_t *end = p + ctrl->InitSize;
+
+#ifdef LCD_RGB444_ENABLE
+	LCD_Cur->Pend444 = 0;
+	LCD_Cur->PixelFormat = LCD_PIXEL_RGB565; // 脚本中的 COLMOD 为16位
+#endif
+
+	while (p + 1 < end)
+	{
+		uint8_t cmd = p[0];
+		uint8_t n = p[1] & (uint8_t)~LCD_CTRL_DELAY;
+		uint8_t delay = p[1] & LCD_CTRL_DELAY;
+
+		p += 2;
+		LCD_WriteCommand(cmd);
+		while (n-- > 0)
+			LCD_WriteData_8bit(*p++);
+		if (delay)
+			HAL_Delay(*p++);
+	}
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: SPI_LCD_InitBegin
+ *
+ *	函数功能: 初始化当前屏幕的引脚和控制器寄存器，发出退出休眠指令后立即返回
+ *
+ *	说    明: 1. 控制器退出休眠后需要 LCD_SLEEP_OUT_MS 稳定，期间可以初始化QSPI、字库等，
+ *				   之后调用 SPI_LCD_InitEnd() 打开显示；两者之间除 SPI_LCD_InitSplash() 外不能调用任何绘制函数
+ *				2. 定义 LCD_WARM_RESET_ENABLE 时，看门狗或软件复位后各屏幕的第一次初始化不等待5ms、
+ *				   不执行初始化脚本，只发出退出休眠、正常显示模式、退出空闲模式(和16位像素格式)，
+ *				   SPI_LCD_InitEnd() 只等待 LCD_WARM_WAKE_MS，之后重发方向和窗口
+ *
+ ****************************************************************************************************************************************/
+
+void SPI_LCD_InitBegin(void)
+{
+	LCD_GPIO_Init(); // 初始化 背光 引脚 、 数据指令选择 引脚
+	LCD_Win_Invalidate(); // 屏幕的地址范围未知
+#ifdef LCD_SPI_CLOCK_ENABLE
+	LCD_SPI_SetClock(LCD_SPI_CLOCK_HZ); // SPI6内核时钟切换到PLL3，其他屏幕沿用CubeMX配置的时钟
+#endif
+
+#ifdef LCD_WARM_RESET_ENABLE
+	if (LCD_WarmAttach())
+	{
+		// 控制器寄存器在复位前已配置，只恢复复位前可能改变的显示模式；方向和窗口在 SPI_LCD_InitEnd() 中重发
+		LCD_WriteCommand(0x11); // 退出休眠，复位前已唤醒时无作用
+		LCD_SleepOutTick = HAL_GetTick();
+		LCD_SleepOutMs = LCD_WARM_WAKE_MS;
+		LCD_WriteCommand(0x13); // 正常显示模式，同时退出局部显示和硬件滚动
+		LCD_WriteCommand(0x38); // 退出空闲模式
+#ifdef LCD_RGB444_ENABLE
+		LCD_Cur->Pend444 = 0;
+		LCD_Cur->PixelFormat = LCD_PIXEL_RGB565;
+		LCD_WriteCommand(0x3A); // 像素格式恢复为16位
+		LCD_WriteData_8bit(0x05);
+#endif
+		return;
+	}
+#endif
+	HAL_Delay(10);			// 屏幕刚完成复位时（包括上电复位），需要等待至少5ms才能发送指令
+	LCD_RunScript(LCD_CTRL); // 像素格式、电压、伽马等寄存器，见 lcd_ctrl.c
+
+	// 退出休眠指令，LCD控制器在刚上电、复位时，会自动进入休眠模式 ，因此操作屏幕之前，需要退出休眠
+	LCD_WriteCommand(0x11); // 退出休眠 指令
+	LCD_SleepOutTick = HAL_GetTick();
+	LCD_SleepOutMs = LCD_SLEEP_OUT_MS;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名: SPI_LCD_InitEnd
+ *
+ *	函数功能: 等满退出休眠的稳定时间，打开显示、完成驱动默认设置并点亮背光
+ *
+ *	说    明: 已在 SPI_LCD_InitBegin() 之后做过其它初始化时只等待剩余的时间
+ *
+ ****************************************************************************************************************************************/
+
+void SPI_LCD_InitEnd(void)
+{
+	uint32_t elapsed = HAL_GetTick() - LCD_SleepOutTick;
+
+	// 需要等待120ms，让电源电压和时钟电路稳定下来；HAL_Delay() 自身多等1个节拍，抵消节拍计数的截断
+	if (elapsed <= LCD_SleepOutMs)
+		HAL_Delay(LCD_SleepOutMs - elapsed);
+
+	// 打开显示指令，LCD控制器在刚上电、复位时，会自动关闭显示
+	LCD_WriteCommand(0x29); // 打开显示
+
+	// 以下进行一些驱动的默认设置
+        LCD_SetDirection(Direction_V); //	设置显示方向
+        LCD_SetBackColor(LCD_BLACK);   // 设置背景色
+	LCD_SetColor(LCD_WHITE);	   // 设置画笔色
+	if (!LCD_SplashDrawn)
+		LCD_Clear(); // 清屏，已写入开机画面时保留
+	LCD_SplashDrawn = 0;
+	LCD_SetTextFont(24);
+	LCD_ShowNumMode(Fill_Zero);		 // 设置变量显示模式，多余位填充空格还是填充0
+	LCD_SetTextMode(Text_Opaque);	 // 字符背景填充背景色
+	LCD_SetTextEffect(Text_EffectNone, LCD_BLACK); // 不加粗、不描边
+	LCD_Flush();					 // 使用帧缓冲时把清屏结果发送到屏幕
+
+	// 全部设置完毕之后，打开背光
+	LCD_Backlight_ON; // 引脚输出高电平点亮背光
+}
+
+#ifdef USE_FLASH_FONT
+/****************************************************************************************************************************************
+ *	函 数 名: SPI_LCD_InitSplash
+ *
+ *	入口参数: index - 图片编号，即 fontbin_tool.py --image 的参数顺序
+ *
+ *	返 回 值: 1 - 已写入显存，0 - 字库中没有该图片或图片大于屏幕
+ *
+ *	函数功能: 在退出休眠的等待期间把开机画面写入显存
+ *
+ *	说    明: 1. 在 SPI_LCD_InitBegin() 与 SPI_LCD_InitEnd() 之间、FlashFont_Init() 之后调用；显示仍关闭，
+ *				   像素经 LCD_DrawImage565() 直接从QSPI映射区分段发送，与退出休眠的等待重叠
+ *				2. 图片居中，四周用黑色填充；SPI_LCD_InitEnd() 打开显示后不再清屏，点亮背光即为开机画面
+ *				3. 退出休眠指令之后至少等待 LCD_WARM_WAKE_MS 才发送
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t SPI_LCD_InitSplash(uint16_t index)
+{
+	uint16_t width, height, x, y;
+	const uint16_t *pImage = FlashFont_GetImage(index, &width, &height);
+
+	LCD_SetDirection(Direction_V); // SPI_LCD_InitEnd() 之前尚未设置方向和窗口
+	if (pImage == NULL || width == 0 || height == 0 || width > LCD.Width || height > LCD.Height)
+		return 0;
+	while (HAL_GetTick() - LCD_SleepOutTick <= LCD_WARM_WAKE_MS)
+	{
+	}
+
+	x = (LCD.Width - width) / 2;
+	y = (LCD.Height - height) / 2;
+	LCD_SetBackColor(LCD_BLACK);
+	LCD_ClearRect(0, 0, LCD.Width, y); // 只填充图片以外的部分，整屏只写一遍
+	LCD_ClearRect(0, y, x, height);
+	LCD_ClearRect(x + width, y, LCD.Width - x - width, height);
+	LCD_ClearRect(0, y + height, LCD.Width, LCD.Height - y - height);
+	LCD_DrawImage565(x, y, width, height, pImage);
+	LCD_SplashDrawn = 1;
+	return 1;
+}
+#endif
+
+/****************************************************************************************************************************************
+ *	函 数 名: LCD_IsWarmStart
+ *
+ *	返 回 值: 1-当前屏幕本次按热复位初始化，0-完整初始化
+ *
+ *	说    明: 复位原因读取后 RCC->RSR 已清除，应用区分冷热启动(如跳过开机画面)时使用本函数
+ *
+ ****************************************************************************************************************************************/
+
+uint8_t LCD_IsWarmStart(void)
+{
+#ifdef LCD_WARM_RESET_ENABLE
+	return (LCD_WarmCur >> LCD_Panel_Current()) & 1U;
+#else
+	return 0;
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Panel_Add
+ *
+ *	入口参数:	cfg - 屏幕的SPI句柄、DC和背光引脚、竖屏尺寸与控制器偏移、控制器描述表
+ *
+ *	返 回 值:	屏幕编号，LCD_PANEL_MAX 块已满、SPI句柄已被占用或尺寸超出屏幕0时返回 LCD_PANEL_NONE
+ *
+ *	函数功能:	添加一块接在另一条SPI总线上的屏幕，屏幕0(SPI6)始终存在
+ *
+ *	说    明:   1. SPI、DMA通道和引脚由CubeMX配置，SPI需为只发送的主机模式并关联发送DMA，
+ *				   完成中断同样调用 LCD_SPI_TxCpltHandler()；DMA需能访问SRAM4
+ *				2. 只登记参数，之后用 LCD_Panel_Select() 选中并调用 SPI_LCD_Init() 初始化
+ *				3. 尺寸不超过 LCD_Width x LCD_Height，帧缓冲和行缓冲按屏幕0分配
+ *				4. 定义了 LCD_FMC_ENABLE 时，Spi为NULL表示8080并口屏：FMC存储区(SRAM模式)由CubeMX配置，
+ *				   FmcCmd/FmcData 为RS地址线为低/高时的地址，最多一块；像素由MDMA(LCD_FMC_MDMA_CHANNEL)
+ *				   写入，源数据不必在SRAM4，MDMA_IRQHandler 中需调用 LCD_FMC_IRQHandler()
+ *
+ ****************************************************************************************************************************************/
+
+uint8_t LCD_Panel_Add(const LCD_PanelConfig_t *cfg)
+{
+	LCD_Panel_t *panel;
+
+	if (cfg == NULL || LCD_PanelCount >= LCD_PANEL_MAX)
+		return LCD_PANEL_NONE;
+#ifdef LCD_FMC_ENABLE
+	if (cfg->Spi == NULL && (cfg->FmcCmd == NULL || cfg->FmcData == NULL || LCD_Fmc_Panel != NULL))
+		return LCD_PANEL_NONE; // FMC屏只有一个MDMA通道，最多一块
+#else
+	if (cfg->Spi == NULL)
+		return LCD_PANEL_NONE;
+#endif
+	if (cfg->Width == 0 || cfg->Height == 0 || cfg->Width > LCD_Width || cfg->Height > LCD_Height)
+		return LCD_PANEL_NONE;
+	for (uint8_t i = 0; i < LCD_PanelCount; i++)
+	{
+		if (LCD_Panels[i].Cfg.Spi == cfg->Spi) // 完成中断按句柄区分屏幕
+			return LCD_PANEL_NONE;
+	}
+
+	panel = &LCD_Panels[LCD_PanelCount];
+	memset(panel, 0, sizeof(LCD_Panel_t));
+	panel->Cfg = *cfg;
+	if (panel->Cfg.Ctrl == NULL)
+		panel->Cfg.Ctrl = LCD_Panels[0].Cfg.Ctrl;
+	panel->Index = LCD_PanelCount;
+	panel->Direction = Direction_V;
+	panel->Width = cfg->Width;
+	panel->Height = cfg->Height;
+	panel->X_Offset = cfg->X_Offset;
+	panel->Y_Offset = cfg->Y_Offset;
+	panel->WinCol = 0xFFFFFFFF; // 屏幕的地址范围未知
+	panel->WinRow = 0xFFFFFFFF;
+#ifdef LCD_FMC_ENABLE
+	if (cfg->Spi == NULL)
+		LCD_Fmc_Panel = panel;
+#endif
+	return LCD_PanelCount++;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Panel_Select
+ *
+ *	入口参数:	id - LCD_Panel_Add() 返回的编号，0为SPI6上的屏幕
+ *
+ *	函数功能:	选择之后绘图函数作用的屏幕
+ *
+ *	说    明:   1. 显示方向、尺寸、硬件滚动和窗口状态每块屏幕各一份，颜色、字体、裁剪区所有屏幕共用
+ *				2. 不等待原屏幕的DMA传输，两块屏幕的发送可以同时进行，渲染缓冲区改写前仍会等待
+ *				3. 帧缓冲只有一份，启用 LCD_FRAMEBUFFER_ENABLE 时先 LCD_Flush() 到原屏幕；
+ *				   不能在 LCD_TileBegin() 与 LCD_TileEnd() 之间切换，保留模式(LCD_RetainBegin)只用于一块屏幕
+ *				4. 绘图队列和异步复制的完成回调都在选中的屏幕上执行，中断中不能调用
+ *
+ ****************************************************************************************************************************************/
+
+void LCD_Panel_Select(uint8_t id)
+{
+	if (id >= LCD_PanelCount || &LCD_Panels[id] == LCD_Cur)
+		return;
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	LCD_Flush(); // 帧缓冲中的内容属于原屏幕
+#endif
+
+	LCD_Cur->Direction = LCD.Direction; // 保存原屏幕的方向和尺寸
+	LCD_Cur->Width = LCD.Width;
+	LCD_Cur->Height = LCD.Height;
+	LCD_Cur->X_Offset = LCD.X_Offset;
+	LCD_Cur->Y_Offset = LCD.Y_Offset;
+
+	LCD_Cur = &LCD_Panels[id];
+	LCD.Direction = LCD_Cur->Direction;
+	LCD.Width = LCD_Cur->Width;
+	LCD.Height = LCD_Cur->Height;
+	LCD.X_Offset = LCD_Cur->X_Offset;
+	LCD.Y_Offset = LCD_Cur->Y_Offset;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Panel_Current
+ *
+ *	返 回 值:	当前选中的屏幕编号
+ *
+ ****************************************************************************************************************************************/
+
+uint8_t LCD_Panel_Current(void)
+{
+	return LCD_Cur->Index;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Panel_Controller
+ *
+ *	返 回 值:	当前屏幕的控制器描述表
+ *
+ ****************************************************************************************************************************************/
+
+const LCD_Controller_t *LCD_Panel_Controller(void)
+{
+	return LCD_CTRL;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	 LCD_SetAddress
+ *
+ *	入口参数:	 x1 - 起始水平坐标   y1 - 起始垂直坐标
+ *              x2 - 终点水平坐标   y2 - 终点垂直坐标
+ *
+ *	函数功能:   设置需要显示的坐标区域
+ *
+ *	说    明:   窗口超出裁剪区或屏幕时只设置可见部分，LCD_WriteBuff() 等按完整窗口的顺序写入，
+ *				不可见的像素在发送前丢弃
+ *****************************************************************************************************************************************/
+
+/**
+ * @brief  窗口与裁剪区、屏幕求交，设置 LCD_Clip_Mode
+ * @retval 0：完全不可见；1：x1/y1/x2/y2 已改为可见部分
+ */
+ITCM_CODE static uint8_t LCD_Clip_Window(uint16_t *x1, uint16_t *y1, uint16_t *x2, uint16_t *y2)
+{
+	uint16_t cx2 = (LCD_Clip.x2 < LCD.Width) ? LCD_Clip.x2 : LCD.Width - 1;
+	uint16_t cy2 = (LCD_Clip.y2 < LCD.Height) ? LCD_Clip.y2 : LCD.Height - 1;
+
+	if (*x1 >= LCD_Clip.x1 && *y1 >= LCD_Clip.y1 && *x2 <= cx2 && *y2 <= cy2 && *x1 <= *x2 && *y1 <= *y2)
+	{
+		LCD_Clip_Mode = LCD_CLIP_OFF; // 常见情况：完全可见
+		return 1;
+	}
+
+	LCD_Clip_Win.x1 = *x1;
+	LCD_Clip_Win.y1 = *y1;
+	LCD_Clip_Win.x2 = *x2;
+	LCD_Clip_Win.y2 = *y2;
+	LCD_Clip_CurX = *x1;
+	LCD_Clip_CurY = *y1;
+	LCD_Clip_Vis.x1 = (*x1 > LCD_Clip.x1) ? *x1 : LCD_Clip.x1;
+	LCD_Clip_Vis.y1 = (*y1 > LCD_Clip.y1) ? *y1 : LCD_Clip.y1;
+	LCD_Clip_Vis.x2 = (*x2 < cx2) ? *x2 : cx2;
+	LCD_Clip_Vis.y2 = (*y2 < cy2) ? *y2 : cy2;
+	if (*x1 > *x2 || *y1 > *y2 || LCD_Clip_Vis.x1 > LCD_Clip_Vis.x2 || LCD_Clip_Vis.y1 > LCD_Clip_Vis.y2)
+	{
+		LCD_Clip_Mode = LCD_CLIP_DROP;
+		return 0;
+	}
+	LCD_Clip_Mode = LCD_CLIP_PART;
+	*x1 = LCD_Clip_Vis.x1;
+	*y1 = LCD_Clip_Vis.y1;
+	*x2 = LCD_Clip_Vis.x2;
+	*y2 = LCD_Clip_Vis.y2;
+	return 1;
+}
+
+ITCM_CODE void LCD_SetAddress(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+	PERF_COUNT(set_address);
+#ifdef LCD_CAPTURE_ENABLE
+	if (LCD_FB_CAPTURE())
+	{
+		LCD_FB_SetWindow(x1, y1, x2, y2); // 只记录窗口
+		return;
+	}
+#endif
+	if (!LCD_Clip_Window(&x1, &y1, &x2, &y2))
+		return; // 完全不可见，不设置窗口，之后的像素全部丢弃
+	if (LCD_Win_Continues(x1 + LCD.X_Offset, y1 + LCD.Y_Offset, x2 + LCD.X_Offset, y2 + LCD.Y_Offset))
+	{
+		PERF_COUNT(window_continues);
+		return; // 接着上一个窗口写
+	}
+	LCD_WriteRange(LCD_CTRL->Caset, &LCD_Win_Col, x1 + LCD.X_Offset, x2 + LCD.X_Offset); //	列地址设置，即X坐标
+	LCD_WriteRange(LCD_CTRL->Raset, &LCD_Win_Row, y1 + LCD.Y_Offset, y2 + LCD.Y_Offset); //	行地址设置，即Y坐标
+
+	LCD_WriteCommandParams(LCD_CTRL->Ramwr, NULL, 0); //	开始写入显存，即要显示的颜色数据，写指针回到窗口起点
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetClip
+ *
+ *	入口参数:	x、y - 裁剪区起点
+ *					width、height - 裁剪区尺寸，width或height为0时取消裁剪
+ *
+ *	函数功能:	设置裁剪区，之后所有绘图只写入裁剪区内的部分
+ *
+ *	说    明:	1. 在 LCD_SetAddress() 中生效：部分可见的字符、图片和填充只设置可见的窗口，只发送可见的行列，
+ *					   完全不可见的不发送任何数据，适合大部分在屏幕外的滚动列表
+ *					2. 字模照常查找和展开，只省去SPI传输
+ *					3. 裁剪区随颜色、字体一起保存到显示列表、保留列表和命令队列中
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetClip(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	if (width == 0 || height == 0)
+	{
+		LCD_ResetClip();
+		return;
+	}
+	LCD_Clip.x1 = x;
+	LCD_Clip.y1 = y;
+	LCD_Clip.x2 = ((uint32_t)x + width - 1 < 0xFFFF) ? (uint16_t)(x + width - 1) : 0xFFFF;
+	LCD_Clip.y2 = ((uint32_t)y + height - 1 < 0xFFFF) ? (uint16_t)(y + height - 1) : 0xFFFF;
+}
+
+/**
+ * @brief  取消裁剪，只受屏幕边界限制
+ */
+void LCD_ResetClip(void)
+{
+	LCD_Clip = (LCD_Rect_t)LCD_CLIP_NONE_RECT;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetColor
+ *
+ *	入口参数:	Color - 要显示的颜色，示例：0x0000FF 表示蓝色
+ *
+ *	函数功能:	此函数用于设置画笔的颜色，例如显示字符、画点画线、绘图的颜色
+ *
+ *	说    明:	1. 为了方便用户使用自定义颜色，入口参数 Color 使用24位 RGB888的颜色格式，用户无需关心颜色格式的转换
+ *					2. 24位的颜色中，从高位到低位分别对应 R、G、B  3个颜色通道
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetColor(uint32_t Color)
+{
+	uint16_t Red_Value = 0, Green_Value = 0, Blue_Value = 0; // 各个颜色通道的值
+
+	Red_Value = (uint16_t)((Color & 0x00F80000) >> 8); // 转换成 16位 的RGB565颜色
+	Green_Value = (uint16_t)((Color & 0x0000FC00) >> 5);
+	Blue_Value = (uint16_t)((Color & 0x000000F8) >> 3);
+
+	LCD.Color = (uint16_t)(Red_Value | Green_Value | Blue_Value); // 将颜色写入全局LCD参数
+	Expand_LUT_Valid = 0;										  // 字模展开表需要重建
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetBackColor
+ *
+ *	入口参数:	Color - 要显示的颜色，示例：0x0000FF 表示蓝色
+ *
+ *	函数功能:	设置背景色,此函数用于清屏以及显示字符的背景色
+ *
+ *	说    明:	1. 为了方便用户使用自定义颜色，入口参数 Color 使用24位 RGB888的颜色格式，用户无需关心颜色格式的转换
+ *					2. 24位的颜色中，从高位到低位分别对应 R、G、B  3个颜色通道
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetBackColor(uint32_t Color)
+{
+	uint16_t Red_Value = 0, Green_Value = 0, Blue_Value = 0; // 各个颜色通道的值
+
+	Red_Value = (uint16_t)((Color & 0x00F80000) >> 8); // 转换成 16位 的RGB565颜色
+	Green_Value = (uint16_t)((Color & 0x0000FC00) >> 5);
+	Blue_Value = (uint16_t)((Color & 0x000000F8) >> 3);
+
+	LCD.BackColor = (uint16_t)(Red_Value | Green_Value | Blue_Value); // 将颜色写入全局LCD参数
+	Expand_LUT_Valid = 0;											  // 字模展开表需要重建
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetPaletteColor
+ *
+ *	入口参数:	index - 调色板序号，0 ~ LCD_PALETTE_SIZE-1
+ *					Color - 24位RGB888颜色，示例：0x336699
+ *
+ *	函数功能:	设置调色板中的一项，颜色在此时转换为RGB565
+ *
+ *	说    明:	1. 预定义颜色(LCD_PAL_WHITE ~ LCD_PAL_DARK_GREY)在编译期已转换好，LCD_PAL_USER 起的项默认为黑色
+ *					2. 已经用该项设置过的画笔色和背景色不随之改变，需重新调用 LCD_SetColorIndex()
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetPaletteColor(uint8_t index, uint32_t Color)
+{
+	if (index < LCD_PALETTE_SIZE)
+	{
+		LCD_Palette[index] = LCD_RGB565(Color);
+	}
+}
+
+/**
+ * @brief  读取调色板中的一项
+ * @retval RGB565颜色，序号无效时返回0
+ */
+uint16_t LCD_GetPaletteColor(uint8_t index)
+{
+	return (index < LCD_PALETTE_SIZE) ? LCD_Palette[index] : 0;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetColorIndex
+ *
+ *	入口参数:	index - 调色板序号，示例：LCD_PAL_RED
+ *
+ *	函数功能:	按调色板序号设置画笔色
+ *
+ *	说    明:	1. 只从调色板中取出RGB565颜色，不做转换；颜色不变时不使字模展开表失效
+ *					2. 展开表按颜色组合保存 LCD_LUT_CACHE 份，在几组调色板颜色之间来回切换时直接取回，不再重建
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetColorIndex(uint8_t index)
+{
+	if (index < LCD_PALETTE_SIZE && LCD.Color != LCD_Palette[index])
+	{
+		LCD.Color = LCD_Palette[index];
+		Expand_LUT_Valid = 0; // 字模展开表需要重建或取回
+	}
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetBackColorIndex
+ *
+ *	入口参数:	index - 调色板序号，示例：LCD_PAL_BLACK
+ *
+ *	函数功能:	按调色板序号设置背景色，用于清屏以及字符背景
+ *
+ *	说    明:	与 LCD_SetColorIndex() 相同，不做颜色转换
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetBackColorIndex(uint8_t index)
+{
+	if (index < LCD_PALETTE_SIZE && LCD.BackColor != LCD_Palette[index])
+	{
+		LCD.BackColor = LCD_Palette[index];
+		Expand_LUT_Valid = 0; // 字模展开表需要重建或取回
+	}
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetDirection
+ *
+ *	入口参数:	direction - 要显示的方向
+ *
+ *	函数功能:	设置要显示的方向
+ *
+ *	说    明:   1. 可输入参数 Direction_H 、Direction_V 、Direction_H_Flip 、Direction_V_Flip
+ *              2. 使用示例 LCD_DisplayDirection(Direction_H) ，即设置屏幕横屏显示
+ *              3. 会先调用 LCD_Scroll_Stop() 结束硬件滚动
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetDirection(uint8_t direction)
+{
+	LCD_Scroll_Stop();		   // 滚动区按原方向定义，先恢复正常显示
+	LCD.Direction = direction; // 写入全局LCD参数
+
+	if (direction == Direction_H) // 横屏显示
+	{
+		LCD_WriteCommand(0x36);	  // 显存访问控制 指令，用于设置访问显存的方式
+		LCD_WriteData_8bit(LCD_CTRL->Madctl[Direction_H]); // 横屏显示，各控制器的取值见 lcd_ctrl.c
+		LCD.X_Offset = LCD_Cur->Cfg.Y_Offset; // 设置控制器坐标偏移量，横屏时行列互换
+		LCD.Y_Offset = LCD_Cur->Cfg.X_Offset;
+		LCD.Width = LCD_Cur->Cfg.Height; // 重新赋值长、宽
+		LCD.Height = LCD_Cur->Cfg.Width;
+	}
+	else if (direction == Direction_V)
+	{
+		LCD_WriteCommand(0x36);	  // 显存访问控制 指令，用于设置访问显存的方式
+		LCD_WriteData_8bit(LCD_CTRL->Madctl[Direction_V]); // 垂直显示
+		LCD.X_Offset = LCD_Cur->Cfg.X_Offset; // 设置控制器坐标偏移量
+		LCD.Y_Offset = LCD_Cur->Cfg.Y_Offset;
+		LCD.Width = LCD_Cur->Cfg.Width; // 重新赋值长、宽
+		LCD.Height = LCD_Cur->Cfg.Height;
+	}
+	else if (direction == Direction_H_Flip)
+	{
+		LCD_WriteCommand(0x36);	  // 显存访问控制 指令，用于设置访问显存的方式
+		LCD_WriteData_8bit(LCD_CTRL->Madctl[Direction_H_Flip]); // 横屏显示，并上下翻转
+		LCD.X_Offset = LCD_Cur->Cfg.Y_Offset; // 设置控制器坐标偏移量，横屏时行列互换
+		LCD.Y_Offset = LCD_Cur->Cfg.X_Offset;
+		LCD.Width = LCD_Cur->Cfg.Height; // 重新赋值长、宽
+		LCD.Height = LCD_Cur->Cfg.Width;
+	}
+	else if (direction == Direction_V_Flip)
+	{
+		LCD_WriteCommand(0x36);	  // 显存访问控制 指令，用于设置访问显存的方式
+		LCD_WriteData_8bit(LCD_CTRL->Madctl[Direction_V_Flip]); // 垂直显示 ，并上下翻转
+		LCD.X_Offset = LCD_Cur->Cfg.X_Offset; // 设置控制器坐标偏移量
+		LCD.Y_Offset = LCD_Cur->Cfg.Y_Offset;
+		LCD.Width = LCD_Cur->Cfg.Width; // 重新赋值长、宽
+		LCD.Height = LCD_Cur->Cfg.Height;
+	}
+	LCD_Win_Invalidate(); // 偏移量和坐标方向改变
+
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	LCD_DirtyCount = 0;
+	LCD_FB_MarkDirty(0, 0, LCD.Width - 1, LCD.Height - 1); // 行宽改变，整屏重发
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetByteSwap
+ *
+ *	入口参数:	swap - 1：像素低字节在前(小端)，0：高字节在前(默认)
+ *
+ *	函数功能:	设置屏幕接收像素数据的字节顺序
+ *
+ *	说    明:   1. 写 RAMCTRL(0xB0) 的 ENDIAN 位，屏幕直接接收字节交换过的RGB565数据，CPU不必逐像素交换
+ *              2. 本驱动按16位帧发送像素，不需要交换；仅在整个界面都由已交换字节的缓冲区绘制时使用
+ *                 (如LVGL的 LV_COLOR_16_SWAP)，设置后本驱动绘制的内容颜色会错乱
+ *              3. 控制器没有 LCD_CTRL_BYTESWAP 能力时不做任何事
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetByteSwap(uint8_t swap)
+{
+	if (!(LCD_CTRL->Caps & LCD_CTRL_BYTESWAP)) // RAMCTRL 是ST7789的指令
+		return;
+	LCD_WriteCommand(0xB0);					// RAM控制 指令
+	LCD_WriteData_8bit(0x00);				// 显存由MCU接口写入
+	LCD_WriteData_8bit(swap ? 0xF8 : 0xF0); // ENDIAN=1 时低字节在前，其余位为复位值
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetPixelFormat
+ *
+ *	入口参数:	format - LCD_PIXEL_RGB565 或 LCD_PIXEL_RGB444
+ *
+ *	函数功能:	设置当前屏幕的接口像素格式
+ *
+ *	说    明:   1. 写 COLMOD(0x3A)：0x05 为16位，0x03 为12位；绘图函数和缓冲区仍为RGB565，
+ *				   RGB444时各发送函数在最后一步两两打包像素，SPI上每像素少发4位，整屏刷新少25%
+ *              2. 12位下图片和渐变会出现色带，适合文字和色块为主的界面
+ *              3. FMC屏或控制器没有 LCD_CTRL_RGB444 能力时返回0
+ *
+ *	返 回 值:	1-已切换，0-不支持
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_SetPixelFormat(uint8_t format)
+{
+#ifdef LCD_RGB444_ENABLE
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+		return 0;
+#endif
+	if (format == LCD_PIXEL_RGB444 && !(LCD_CTRL->Caps & LCD_CTRL_RGB444))
+		return 0;
+	if (format == LCD_Cur->PixelFormat)
+		return 1;
+	LCD_WriteCommand(0x3A); // 接口像素格式，同时补发未凑成帧的像素
+	LCD_WriteData_8bit(format == LCD_PIXEL_RGB444 ? 0x03 : 0x05);
+	LCD_Cur->PixelFormat = format;
+	return 1;
+#else
+	return (format == LCD_PIXEL_RGB565);
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_GetPixelFormat
+ *
+ *	返 回 值:	当前屏幕的接口像素格式，LCD_PIXEL_RGB565 或 LCD_PIXEL_RGB444
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_GetPixelFormat(void)
+{
+#ifdef LCD_RGB444_ENABLE
+	return LCD_Cur->PixelFormat;
+#else
+	return LCD_PIXEL_RGB565;
+#endif
+}
+
+
+// 硬件滚动：VSCRDEF(0x33) 把显存分为顶部固定区、滚动区和底部固定区，VSCSAD(0x37) 指定滚动区第一行显示的显存行，
+// 滚动一行只改变起始行，新的一行画在刚移出顶部的那一行显存上。滚动沿屏幕控制器的行方向，只支持竖屏
+#define LCD_SCROLL_ROWS (LCD_CTRL->RamRows) // 显存行数，VSCRDEF 三个区域之和必须等于该值
+
+#define LCD_Scroll_Top (LCD_Cur->ScrollTop)		  // 滚动区起始行(绘图坐标)，每块屏幕一份
+#define LCD_Scroll_Height (LCD_Cur->ScrollHeight) // 滚动区行数，0：未启用
+#define LCD_Scroll_LineH (LCD_Cur->ScrollLineH)	  // 每次滚动的行数，即一行文字的高度
+#define LCD_Scroll_Offset (LCD_Cur->ScrollOffset) // 滚动区第一行显示的是第几行显存(相对滚动区起始行)
+
+/**
+ * @brief  滚动区之上的显存行数(VSCRDEF 的 TFA)
+ * @note   上下翻转(MY=1)时显存第0行在屏幕底部，顶部、底部固定区对调
+ */
+static uint16_t LCD_Scroll_Fixed(void)
+{
+	uint16_t top = LCD_Scroll_Top + LCD.Y_Offset; // 绘图坐标转为显存行
+
+	if (LCD.Direction == Direction_V_Flip)
+		return LCD_SCROLL_ROWS - top - LCD_Scroll_Height;
+	return top;
+}
+
+/**
+ * @brief  按 LCD_Scroll_Offset 写入 VSCSAD，上下翻转时起始行反向移动
+ */
+static void LCD_Scroll_Start(void)
+{
+	uint16_t vsp = LCD_Scroll_Fixed();
+	uint8_t param[2];
+
+	if (LCD.Direction == Direction_V_Flip)
+		vsp += (LCD_Scroll_Height - LCD_Scroll_Offset) % LCD_Scroll_Height;
+	else
+		vsp += LCD_Scroll_Offset;
+
+	param[0] = vsp >> 8;
+	param[1] = vsp;
+	LCD_WriteCommandParams(0x37, param, 2); // 滚动区起始行，每帧滚动时只有这一条指令
+}
+
+/**
+ * @brief  定义滚动区(VSCRDEF)，起始行为滚动区顶部，clear 为1时先用背景色清除
+ */
+static uint8_t LCD_Scroll_Define(uint16_t y, uint16_t height, uint16_t line_height, uint8_t clear)
+{
+	LCD_Scroll_Stop();
+	if (!(LCD_CTRL->Caps & LCD_CTRL_SCROLL))
+		return 0;
+	if (LCD.Direction != Direction_V && LCD.Direction != Direction_V_Flip)
+		return 0;
+	if (line_height == 0 || height < line_height || y + height > LCD.Height)
+		return 0;
+
+	LCD_Scroll_Top = y;
+	LCD_Scroll_LineH = line_height;
+	LCD_Scroll_Height = height - height % line_height;
+	LCD_Scroll_Offset = 0;
+
+	if (clear)
+		LCD_ClearRect(0, LCD_Scroll_Top, LCD.Width, LCD_Scroll_Height);
+
+	LCD_WriteCommand(0x33); // 垂直滚动区定义：顶部固定区、滚动区、底部固定区
+	LCD_WriteData_16bit(LCD_Scroll_Fixed());
+	LCD_WriteData_16bit(LCD_Scroll_Height);
+	LCD_WriteData_16bit(LCD_SCROLL_ROWS - LCD_Scroll_Fixed() - LCD_Scroll_Height);
+	LCD_Scroll_Start();
+	return 1;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Scroll_Init
+ *
+ *	入口参数:	y - 滚动区起始垂直坐标
+ *				height - 滚动区高度
+ *				line_height - 每行文字的高度，每次滚动这么多行
+ *
+ *	函数功能:	设置硬件滚动区并用背景色清除，之后用 LCD_Scroll_Print() 逐行追加文字
+ *
+ *	返 回 值:	1 - 成功，0 - 横屏、参数超出屏幕或控制器不支持滚动，未启用滚动
+ *
+ *	说    明:   1. 高度按 line_height 取整，多出的行不参与滚动
+ *				2. 滚动区外的内容照常绘制；滚动区内显存行与屏幕行不再对应，只用 LCD_Scroll_NewLine()/Print() 绘制
+ *				3. 只支持 Direction_V 和 Direction_V_Flip，横屏时屏幕控制器只能左右滚动
+ *				4. 不要在 LCD_TileBegin()/LCD_TileEnd() 之间使用；帧缓冲模式下新的一行随 LCD_Flush() 显示
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_Scroll_Init(uint16_t y, uint16_t height, uint16_t line_height)
+{
+	return LCD_Scroll_Define(y, height, line_height, 1);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Scroll_Region
+ *
+ *	入口参数:	y - 滚动区起始垂直坐标
+ *				height - 滚动区高度
+ *
+ *	函数功能:	设置硬件滚动区，不清除，原有内容照常显示，之后用 LCD_Scroll_Advance() 按任意行数滚动
+ *
+ *	返 回 值:	1 - 成功，0 - 与 LCD_Scroll_Init() 相同的原因未启用滚动
+ *
+ *	说    明:   用于新页面从底部推入、旧页面整体上移的过渡，每帧只写VSCSAD和新进入的几行
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_Scroll_Region(uint16_t y, uint16_t height)
+{
+	return LCD_Scroll_Define(y, height, 1, 0);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Scroll_Advance
+ *
+ *	入口参数:	rows - 上移的行数，超过滚动区高度时按滚动区高度
+ *
+ *	函数功能:	滚动区上移 rows 行，不清除
+ *
+ *	返 回 值:	第一行新出现的行的垂直坐标，在此处绘制的内容显示在滚动区底部往上第 rows 行；未启用滚动时返回0
+ *
+ *	说    明:   新出现的 rows 行从返回的坐标起向下排列，越过滚动区底部的部分接着从滚动区顶部开始；
+ *				从 LCD_Scroll_Region() 起累计上移整个滚动区高度后显存与屏幕重新逐行对应
+ *
+ *****************************************************************************************************************************************/
+
+uint16_t LCD_Scroll_Advance(uint16_t rows)
+{
+	uint16_t y;
+
+	if (LCD_Scroll_Height == 0)
+		return 0;
+	if (rows > LCD_Scroll_Height)
+		rows = LCD_Scroll_Height;
+
+	y = LCD_Scroll_Top + LCD_Scroll_Offset; // 即将移出顶部的行，滚动后显示在底部
+	LCD_Scroll_Offset = (LCD_Scroll_Offset + rows) % LCD_Scroll_Height;
+
+	LCD_Scroll_Start(); // 只改变起始行，滚动区定义不变
+	return y;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Scroll_NewLine
+ *
+ *	函数功能:	滚动区上移一行，并用背景色清除底部新出现的一行
+ *
+ *	返 回 值:	新的一行的垂直坐标，在该坐标处绘制的内容显示在滚动区最底部；未启用滚动时返回0
+ *
+ *	说    明:   只发送一次 VSCSAD 和一行的清除，已有的行不重画
+ *
+ *****************************************************************************************************************************************/
+
+uint16_t LCD_Scroll_NewLine(void)
+{
+	uint16_t y;
+
+	if (LCD_Scroll_Height == 0)
+		return 0;
+
+	y = LCD_Scroll_Advance(LCD_Scroll_LineH);
+	LCD_ClearRect(0, y, LCD.Width, LCD_Scroll_LineH);
+	return y;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Scroll_Print
+ *
+ *	入口参数:	pText - 字符串，可以包含中文
+ *
+ *	函数功能:	滚动区上移一行，在底部显示一行文字
+ *
+ *	说    明:   1. 使用当前字体、颜色和字符模式，从左边开始显示
+ *				2. 超出这一行的部分不显示(临时把裁剪区设为这一行)
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Scroll_Print(const char *pText)
+{
+	LCD_Rect_t clip = LCD_Clip;
+	uint16_t y;
+
+	if (LCD_Scroll_Height == 0)
+		return;
+
+	y = LCD_Scroll_NewLine();
+	LCD_SetClip(0, y, LCD.Width, LCD_Scroll_LineH);
+	LCD_DisplayText(0, y, (char *)pText);
+	LCD_Clip = clip;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Scroll_Stop
+ *
+ *	函数功能:	结束硬件滚动，恢复显存与屏幕逐行对应
+ *
+ *	说    明:   滚动区内的行按显存顺序显示，顺序可能已经错开，需要时重画
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Scroll_Stop(void)
+{
+	if (LCD_Scroll_Height == 0)
+		return;
+
+	LCD_Scroll_Height = 0;
+	LCD_WriteCommand(0x33); // 整个显存作为滚动区，起始行为0
+	LCD_WriteData_16bit(0);
+	LCD_WriteData_16bit(LCD_SCROLL_ROWS);
+	LCD_WriteData_16bit(0);
+
+	LCD_WriteCommand(0x37);
+	LCD_WriteData_16bit(0);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetPartialArea
+ *
+ *	入口参数:	y - 局部区起始垂直坐标
+ *				height - 局部区行数，0表示恢复正常显示
+ *
+ *	函数功能:	局部显示：PTLAR(0x30) 设置显示的行范围后进入局部模式 PTLON(0x12)，其余行不再刷新
+ *
+ *	返 回 值:	1 - 成功，0 - 横屏、超出屏幕或控制器没有 LCD_CTRL_PARTIAL 能力
+ *
+ *	说    明:   1. 与硬件滚动一样按控制器的行方向，只支持 Direction_V 和 Direction_V_Flip
+ *				2. 区域外显示为背景(黑或白由控制器决定)，显存内容保留，恢复正常显示(NORON)后重新出现
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_SetPartialArea(uint16_t y, uint16_t height)
+{
+	uint16_t top;
+
+	if (!(LCD_CTRL->Caps & LCD_CTRL_PARTIAL))
+		return 0;
+	if (height == 0)
+	{
+		LCD_WriteCommand(0x13); // 正常显示模式
+#ifdef LCD_FRAMEBUFFER_ENABLE
+		LCD_FB_ShownY1 = 0;
+		LCD_FB_ShownY2 = 0xFFFF;
+#endif
+		return 1;
+	}
+	if (LCD.Direction != Direction_V && LCD.Direction != Direction_V_Flip)
+		return 0;
+	if (y + height > LCD.Height)
+		return 0;
+
+	top = y + LCD.Y_Offset; // 绘图坐标转为显存行
+	if (LCD.Direction == Direction_V_Flip)
+		top = LCD_SCROLL_ROWS - top - height;
+	LCD_WriteCommand(0x30); // 局部显示区：起始行、结束行
+	LCD_WriteData_16bit(top);
+	LCD_WriteData_16bit(top + height - 1);
+	LCD_WriteCommand(0x12); // 进入局部显示模式
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	LCD_FB_ShownY1 = y;
+	LCD_FB_ShownY2 = y + height - 1;
+#endif
+	return 1;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetIdleMode
+ *
+ *	入口参数:	enable - 1：进入空闲模式，0：退出
+ *
+ *	函数功能:	空闲模式 IDMON(0x39)：每个颜色分量只显示最高位(8色)，控制器降低驱动电压和帧率
+ *
+ *	返 回 值:	1 - 成功，0 - 控制器没有 LCD_CTRL_IDLE 能力
+ *
+ *	说    明:   显存内容不变，IDMOFF(0x38) 后恢复原来的颜色
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_SetIdleMode(uint8_t enable)
+{
+	if (!(LCD_CTRL->Caps & LCD_CTRL_IDLE))
+		return 0;
+	LCD_WriteCommand(enable ? 0x39 : 0x38);
+	return 1;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_LowPower_Enter
+ *
+ *	入口参数:	y - 继续刷新的区域起始垂直坐标
+ *				height - 区域行数
+ *
+ *	函数功能:	进入低功耗静态显示：局部显示只刷新该区域，并打开空闲模式
+ *
+ *	返 回 值:	1 - 成功，0 - 横屏、超出屏幕或控制器不支持局部显示
+ *
+ *	说    明:   1. 进入前发送帧缓冲中已有的脏区域，静态内容完整地留在显存中
+ *				2. 之后区外的修改只记录在脏区域中，LCD_Flush() 只发送区内的部分，SPI在其余时间空闲
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_LowPower_Enter(uint16_t y, uint16_t height)
+{
+	if (height == 0)
+		return 0;
+	LCD_Flush();
+	if (!LCD_SetPartialArea(y, height))
+		return 0;
+	LCD_SetIdleMode(1);
+	return 1;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_LowPower_Exit
+ *
+ *	函数功能:	退出低功耗静态显示：关闭空闲模式和局部显示，发送期间保留的脏区域
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_LowPower_Exit(void)
+{
+	LCD_SetIdleMode(0);
+	LCD_SetPartialArea(0, 0);
+	LCD_Flush();
+}
+
+/**
+ * @brief  控制台缓冲区中的第 seq 行
+ */
+static char *LCD_Console_Line(LCD_Console_t *con, uint32_t seq)
+{
+	return con->Lines[seq % LCD_CONSOLE_LINES];
+}
+
+/**
+ * @brief  控制台缓冲区另起一行，最早的一行被覆盖
+ */
+static void LCD_Console_Break(LCD_Console_t *con)
+{
+	con->Total++;
+	LCD_Console_Line(con, con->Total - 1)[0] = 0;
+	con->Len = 0;
+	con->LineWidth = 0;
+}
+
+/**
+ * @brief  在光标处画出第 Shown 行中尚未显示的部分，只写入这一行
+ * @note   调用前需载入控制台的绘图状态
+ */
+static void LCD_Console_DrawTail(LCD_Console_t *con)
+{
+	char *text = LCD_Console_Line(con, con->Shown) + con->Drawn;
+	uint16_t width;
+
+	if (*text == 0)
+		return;
+	LCD_SetClip(con->X, con->CursorY, con->Width, con->LineHeight);
+	LCD_DisplayText(con->CursorX, con->CursorY, text);
+	while (*text != 0)
+	{
+		uint8_t len = LCD_TextCell(text, &width);
+
+		text += len;
+		con->Drawn += len;
+		con->CursorX += width;
+	}
+}
+
+/**
+ * @brief  清除显示区域，从第 first 行起重画到最后一行；硬件滚动时同时复位滚动起始行
+ * @note   调用前需载入控制台的绘图状态
+ */
+static void LCD_Console_Repaint(LCD_Console_t *con, uint32_t first)
+{
+	LCD_ResetClip();
+	if (!con->HwScroll || !LCD_Scroll_Init(con->Y, con->Rows * con->LineHeight, con->LineHeight))
+	{
+		con->HwScroll = 0;
+		LCD_ClearRect(con->X, con->Y, con->Width, con->Height);
+	}
+	con->Row = 0;
+	for (con->Shown = first;; con->Shown++)
+	{
+		con->Drawn = 0;
+		con->CursorX = con->X;
+		con->CursorY = con->Y + con->Row * con->LineHeight;
+		LCD_Console_DrawTail(con);
+		if (con->Shown == con->Total - 1)
+			break;
+		con->Row++;
+	}
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Console_Init
+ *
+ *	入口参数:	con - 控制台
+ *				gc - 颜色、字体，初始化时拷贝一份，之后可直接修改 con->Gc
+ *				x、y、width、height - 显示区域
+ *
+ *	函数功能:	初始化文本控制台并清除显示区域
+ *
+ *	返 回 值:	1 - 成功，0 - 区域放不下一行
+ *
+ *	说    明:   1. 区域占满屏幕宽度且为竖屏时使用硬件滚动(LCD_Scroll_Init)，新的一行只需一次VSCSAD；
+ *				   否则写满后整体重画，同一时间只有一个控制台可以使用硬件滚动
+ *				2. 可见行数为 height / 行高，不超过 LCD_CONSOLE_LINES
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_Console_Init(LCD_Console_t *con, const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	LCD_State_t user;
+
+	memset(con, 0, sizeof(*con));
+	con->Gc = *gc;
+	con->X = x;
+	con->Y = y;
+	con->Width = width;
+	con->Height = height;
+	con->Total = 1; // 第0行为正在追加的行
+
+	LCD_GC_Apply(&con->Gc, &user);
+	con->LineHeight = LCD_TextLineHeight();
+	con->Rows = height / con->LineHeight;
+	if (con->Rows > LCD_CONSOLE_LINES)
+		con->Rows = LCD_CONSOLE_LINES;
+	if (con->Rows > 0)
+	{
+		con->HwScroll = (x == 0 && width == LCD.Width);
+		LCD_Console_Repaint(con, 0);
+	}
+	LCD_LoadState(&user);
+	return con->Rows > 0;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Console_Puts
+ *
+ *	入口参数:	con - 控制台
+ *				pText - 字符串，编码与 LCD_DisplayText() 相同，'\n' 换行，'\r' 忽略
+ *
+ *	函数功能:	把文字追加到控制台缓冲区，不写屏
+ *
+ *	说    明:   1. 超出区域宽度或 LCD_CONSOLE_LINE_BYTES 时自动换行
+ *				2. 只拷贝和排版，可在短时间内连续调用；由 LCD_Console_Flush() 显示
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Console_Puts(LCD_Console_t *con, const char *pText)
+{
+	LCD_State_t user;
+
+	if (con->Rows == 0)
+		return;
+
+	LCD_GC_Apply(&con->Gc, &user); // 按控制台的字体计算字宽
+	while (*pText != 0)
+	{
+		char *line;
+		uint16_t width;
+		uint8_t len;
+
+		if (*pText == '\n')
+		{
+			LCD_Console_Break(con);
+			pText++;
+			continue;
+		}
+		if (*pText == '\r')
+		{
+			pText++;
+			continue;
+		}
+
+		len = LCD_TextCell(pText, &width);
+		if ((con->Len > 0 && con->LineWidth + width > con->Width) || con->Len + len >= LCD_CONSOLE_LINE_BYTES)
+			LCD_Console_Break(con);
+
+		line = LCD_Console_Line(con, con->Total - 1);
+		memcpy(line + con->Len, pText, len);
+		con->Len += len;
+		line[con->Len] = 0;
+		con->LineWidth += width;
+		pText += len;
+	}
+	LCD_LoadState(&user);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Console_Printf
+ *
+ *	入口参数:	con - 控制台
+ *				fmt - 格式字符串，与 printf 相同
+ *
+ *	函数功能:	格式化后追加到控制台缓冲区，不写屏
+ *
+ *	说    明:   单次输出最多 LCD_CONSOLE_PRINTF_BYTES - 1 个字节，超出部分截断
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Console_Printf(LCD_Console_t *con, const char *fmt, ...)
+{
+	char buf[LCD_CONSOLE_PRINTF_BYTES];
+	va_list args;
+
+	va_start(args, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, args);
+	va_end(args);
+	LCD_Console_Puts(con, buf);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Console_Flush
+ *
+ *	入口参数:	con - 控制台
+ *
+ *	函数功能:	把上次显示以来追加的文字画到屏幕上
+ *
+ *	说    明:   1. 光标所在行只画新增的字符；每个新行硬件滚动一次，已有的行不重画
+ *				2. 新增的行超过可见行数(短时间内大量输出)时，只画最后一屏，中间的行直接跳过，耗时不随输出量增长
+ *				3. 不使用硬件滚动时，写满后每次 Flush 整体重画一次
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Console_Flush(LCD_Console_t *con)
+{
+	LCD_State_t user; // 包含裁剪区，返回前一并恢复
+	uint32_t last = con->Total - 1;
+
+	if (con->Rows == 0)
+		return;
+
+	LCD_GC_Apply(&con->Gc, &user);
+	if (last - con->Shown >= con->Rows ||
+		(!con->HwScroll && con->Row + (last - con->Shown) >= con->Rows))
+	{
+		// 新增的行超过一屏，或软件滚动需要移动已有的行：整体重画最后一屏
+		LCD_Console_Repaint(con, (last + 1 >= con->Rows) ? last + 1 - con->Rows : 0);
+	}
+	else
+	{
+		for (;;)
+		{
+			LCD_Console_DrawTail(con);
+			if (con->Shown == last)
+				break;
+
+			// 该行已结束，光标移到下一行
+			con->Shown++;
+			con->Drawn = 0;
+			con->CursorX = con->X;
+			if (con->Row + 1 < con->Rows)
+			{
+				con->Row++;
+				con->CursorY = con->Y + con->Row * con->LineHeight;
+			}
+			else
+			{
+				LCD_ResetClip();
+				con->CursorY = LCD_Scroll_NewLine(); // 只改变滚动起始行并清除新的一行
+			}
+		}
+	}
+	LCD_LoadState(&user);
+}
+
+/**
+ * @brief  取出跑马灯的下一个字符渲染到字符单元；文字结束时改为进入空白列
+ * @note   调用前需载入跑马灯的绘图状态；字符单独渲染，宽度也按单独的字符计算
+ */
+static void LCD_Marquee_NextCell(LCD_Marquee_t *mq)
+{
+	char ch[8];
+	uint16_t width;
+	uint8_t len;
+
+	mq->CellWidth = 0;
+	mq->CellCol = 0;
+	if (*mq->Next == 0)
+	{
+		mq->Next = mq->Text;
+		mq->GapLeft = (*mq->Text != 0 || mq->Gap > 0) ? mq->Gap : mq->Width; // 空字符串只显示背景
+		return;
+	}
+
+	len = LCD_TextCell(mq->Next, &width);
+	if (len == 0 || len >= sizeof(ch))
+		len = 1;
+	memcpy(ch, mq->Next, len);
+	ch[len] = 0;
+	mq->Next += len;
+	LCD_TextCell(ch, &width); // 不与下一个字符做字偶距，与单独渲染的结果一致
+	if (width == 0 || width > LCD_MARQUEE_CELL_MAX)
+		return; // 控制字符，或超出字符单元缓冲区的字符：跳过
+
+	for (uint16_t y = 0; y < mq->Height; y++)
+	{
+		uint16_t *row = mq->Cell + (uint32_t)y * LCD_MARQUEE_CELL_MAX;
+		for (uint16_t i = 0; i < width; i++)
+			row[i] = (uint16_t)LCD.BackColor;
+	}
+	LCD_RenderTextToBuffer(mq->Cell, LCD_MARQUEE_CELL_MAX, width, mq->Height, ch, NULL);
+	mq->CellWidth = width;
+}
+
+/**
+ * @brief  从第 col 列起补齐窗口右侧的列：依次取字符单元中尚未进入的列和空白列
+ * @note   调用前需载入跑马灯的绘图状态
+ */
+static void LCD_Marquee_Fill(LCD_Marquee_t *mq, uint16_t col)
+{
+	while (col < mq->Width)
+	{
+		uint16_t n = mq->Width - col;
+		const uint16_t *src = NULL;
+
+		if (mq->CellCol < mq->CellWidth)
+		{
+			if (n > mq->CellWidth - mq->CellCol)
+				n = mq->CellWidth - mq->CellCol;
+			src = mq->Cell + mq->CellCol;
+			mq->CellCol += n;
+		}
+		else if (mq->GapLeft > 0)
+		{
+			if (n > mq->GapLeft)
+				n = mq->GapLeft;
+			mq->GapLeft -= n;
+		}
+		else
+		{
+			LCD_Marquee_NextCell(mq);
+			continue;
+		}
+
+		for (uint16_t y = 0; y < mq->Height; y++)
+		{
+			uint16_t *dst = mq->Strip + (uint32_t)y * mq->Width + col;
+			if (src != NULL)
+				memcpy(dst, src + (uint32_t)y * LCD_MARQUEE_CELL_MAX, n * sizeof(uint16_t));
+			else
+				for (uint16_t i = 0; i < n; i++)
+					dst[i] = (uint16_t)LCD.BackColor;
+		}
+		col += n;
+	}
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Marquee_Init
+ *
+ *	入口参数:	mq - 跑马灯
+ *				gc - 颜色、字体，初始化时拷贝一份
+ *				x、y、width、height - 显示区域
+ *				buff - 像素缓冲区，至少 LCD_MARQUEE_BUFF_PIXELS(width, height) 个像素
+ *				pText - 循环显示的字符串
+ *				gap - 每遍文字之后的空白列数
+ *
+ *	函数功能:	初始化水平跑马灯，不写屏
+ *
+ *	返 回 值:	1 - 成功，0 - 参数无效
+ *
+ *	说    明:   缓冲区前 width x height 个像素为可见窗口，之后为正在进入的字符单元；
+ *				窗口先填满背景色，文字从右边缘进入，第一次 LCD_Marquee_Step() 时显示
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_Marquee_Init(LCD_Marquee_t *mq, const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width,
+						 uint16_t height, uint16_t *buff, const char *pText, uint16_t gap)
+{
+	uint32_t count = (uint32_t)width * height;
+
+	memset(mq, 0, sizeof(*mq));
+	if (gc == NULL || buff == NULL || pText == NULL || width == 0 || height == 0)
+		return 0;
+	mq->Gc = *gc;
+	mq->Text = pText;
+	mq->Next = pText;
+	mq->Strip = buff;
+	mq->Cell = buff + count;
+	mq->X = x;
+	mq->Y = y;
+	mq->Width = width;
+	mq->Height = height;
+	mq->Gap = gap;
+
+	for (uint32_t i = 0; i < count; i++)
+		buff[i] = gc->BackColor;
+	return 1;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Marquee_SetText
+ *
+ *	入口参数:	mq - 跑马灯
+ *				pText - 新的字符串
+ *
+ *	函数功能:	更换跑马灯的文字，窗口中已有的内容照常移出
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Marquee_SetText(LCD_Marquee_t *mq, const char *pText)
+{
+	if (mq->Strip == NULL || pText == NULL)
+		return;
+	mq->Text = pText;
+	mq->Next = pText;
+	mq->GapLeft = 0;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_Marquee_Step
+ *
+ *	入口参数:	mq - 跑马灯
+ *				dx - 左移的列数，超过窗口宽度时按窗口宽度
+ *
+ *	函数功能:	跑马灯左移 dx 列并显示
+ *
+ *	说    明:   1. 缓冲区中每行左移 dx 列，右边缘只补 dx 列：字符进入时渲染一次到字符单元，之后每步拷贝其中的几列
+ *				2. 整个窗口由 LCD_CopyBuffer() 一次发送，不再逐字查找字模和设置窗口，
+ *				   每帧的耗时只与窗口大小有关，适合每帧移动1~2列的平滑滚动
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Marquee_Step(LCD_Marquee_t *mq, uint16_t dx)
+{
+	LCD_State_t user;
+
+	if (mq->Strip == NULL)
+		return;
+	if (dx > mq->Width)
+		dx = mq->Width;
+
+	if (dx > 0)
+	{
+		LCD_GC_Apply(&mq->Gc, &user); // 按跑马灯的字体计算字宽和渲染
+		if (dx < mq->Width)
+		{
+			for (uint16_t y = 0; y < mq->Height; y++)
+			{
+				uint16_t *row = mq->Strip + (uint32_t)y * mq->Width;
+				memmove(row, row + dx, (mq->Width - dx) * sizeof(uint16_t));
+			}
+		}
+		LCD_Marquee_Fill(mq, mq->Width - dx);
+		LCD_LoadState(&user);
+	}
+	LCD_CopyBuffer(mq->X, mq->Y, mq->Width, mq->Height, mq->Strip);
+}
+
+/****************************************************************************************************************************************
  *	函 数 名:	LCD_Clear
  *
- *	函数功能:	清屏函数，将LCD清除为 LCD.BackColor 的颜色
+ *	函数功能:	清屏函数，将LCD清除为 LCD.BackColor 的颜色
+ *
+ *	说    明:	先用 LCD_SetBackColor() 设置要清除的背景色，再调用该函数清屏即可
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Clear(void)
+{
+	if (LCD_TILE_RECORD(LCD_OP_Clear, 0, 0, 0, 0, NULL, 0))
+		return; // 录制到显示列表
+
+	LCD_SetAddress(0, 0, LCD.Width - 1, LCD.Height - 1); // 设置坐标
+	LCD_WriteColor((uint16_t)LCD.BackColor, (uint32_t)LCD.Width * LCD.Height); // 写入帧缓冲，或由DMA/CPU发送
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_ClearRect
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					width  - 要清除区域的横向长度
+ *					height - 要清除区域的纵向宽度
+ *
+ *	函数功能:	局部清屏函数，将指定位置对应的区域清除为 LCD.BackColor 的颜色
+ *
+ *	说    明:	1. 先用 LCD_SetBackColor() 设置要清除的背景色，再调用该函数清屏即可
+ *				   2. 使用示例 LCD_ClearRect( 10, 10, 100, 50) ，清除坐标(10,10)开始的长100宽50的区域
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_ClearRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	if (LCD_TILE_RECORD(LCD_OP_ClearRect, x, y, width, height, NULL, 0))
+		return; // 录制到显示列表
+
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1); // 设置坐标
+	LCD_WriteColor((uint16_t)LCD.BackColor, (uint32_t)width * height); // 写入帧缓冲，或由DMA/CPU发送
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_DrawPoint
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					color  - 要绘制的颜色，使用 24位 RGB888 的颜色格式，用户无需关心颜色格式的转换
+ *
+ *	函数功能:	在指定坐标绘制指定颜色的点
+ *
+ *	说    明:	使用示例 LCD_DrawPoint( 10, 10, 0x0000FF) ，在坐标(10,10)绘制蓝色的点
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DrawPoint(uint16_t x, uint16_t y, uint32_t color)
+{
+	if (LCD_TILE_RECORD(LCD_OP_DrawPoint, x, y, (uint16_t)color, 0, NULL, 0))
+		return; // 录制到显示列表
+
+	LCD_SetAddress(x, y, x, y); //	设置坐标
+
+#ifdef LCD_CAPTURE_ENABLE
+	if (LCD_FB_CAPTURE())
+	{
+		LCD_FB_Write(NULL, (uint16_t)color, 1);
+		return;
+	}
+#endif
+	if (LCD_Clip_Mode == LCD_CLIP_DROP)
+		return; // 在裁剪区外
+#ifdef LCD_RGB444_ENABLE
+	if (LCD_PIXEL_444())
+	{
+		LCD_444_Send(NULL, (uint16_t)color, 1); // 12位像素补成一帧
+		return;
+	}
+#endif
+	LCD_WriteData_16bit(color);
+}
+
+
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayString
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					p - ASCII字符串的首地址
+ *
+ *	函数功能:	在指定坐标显示指定的字符串
+ *
+ *	说    明:	1. 可设置要显示的字体，例如使用
+ *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0x0000FF) 设置为蓝色
+ *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0x000000) 设置为黑色的背景色
+ *					4. 使用示例 LCD_DisplayString( 10, 10, "hello") ，在起始坐标为(10,10)的地方显示字符串"hello"
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayString(uint16_t x, uint16_t y, char *p)
+{
+	if (LCD_RETAIN_RECORD(LCD_RETAIN_STRING, x, y, 0, 0, p))
+		return; // 记录到保留列表
+	if (LCD_TILE_RECORD(LCD_OP_DisplayString, x, y, 0, 0, p, LCD_TILE_STR))
+		return; // 录制到显示列表
+	if (LCD_NUM_ATLAS_DRAW(x, y, p, 0))
+		return; // 数字串从图集整串发送
+
+	while ((x < LCD.Width) && (*p != 0)) // 判断显示坐标是否超出显示区域并且字符是否为空字符
+	{
+		LCD_DisplayChar(x, y, *p);
+		x += LCD_AsciiFonts->Width * LCD_ASCII_SCALE; // 显示下一个字符
+		p++;						// 取下一个字符地址
+	}
+}
+
+#if defined(USE_FLASH_FONT) && LCD_FONT_EXTRA_SIZES > 0
+static pFONT LCD_FontExtraAscii[LCD_FONT_EXTRA_SIZES]; // 字库目录中其他字号的字体参数，按选用顺序登记
+static pFONT LCD_FontExtraCH[LCD_FONT_EXTRA_SIZES];
+static uint8_t LCD_FontExtraCount = 0;
+
+/**
+ * @brief  取得字库目录中其他字号的字体，第一次选用时登记
+ * @retval 1-字库有该字号，0-没有或登记表已满
+ * @note   字体参数只由字号决定，字库切换后不必重新登记；字模段描述由 FlashFont_Init() 按字号建好
+ */
+static uint8_t LCD_FontExtra(uint8_t font_size, const pFONT **ascii, const pFONT **ch)
+{
+	uint8_t i;
+
+	for (i = 0; i < LCD_FontExtraCount && LCD_FontExtraCH[i].Width != font_size; i++)
+		;
+	if (i == LCD_FontExtraCount)
+	{
+		if (i >= LCD_FONT_EXTRA_SIZES || !FlashFont_HasSize(font_size))
+			return 0;
+		LCD_FontExtraCH[i].pTable = NULL;
+		LCD_FontExtraCH[i].Width = font_size;
+		LCD_FontExtraCH[i].Height = font_size;
+		LCD_FontExtraCH[i].Sizes = ((font_size + 7) / 8) * font_size;
+		LCD_FontExtraCH[i].Table_Rows = 0;
+		LCD_FontExtraCH[i].pKeys = NULL;
+		LCD_FontExtraCH[i].Keys = 0;
+		LCD_FontExtraAscii[i] = LCD_FontExtraCH[i];
+		LCD_FontExtraAscii[i].Width = font_size / 2; // 与Flash字库的ASCII字宽一致
+		LCD_FontExtraAscii[i].Sizes = ((font_size / 2 + 7) / 8) * font_size;
+		LCD_FontExtraCount++;
+	}
+	*ascii = &LCD_FontExtraAscii[i];
+	*ch = &LCD_FontExtraCH[i];
+	return 1;
+}
+#endif
+
+#define LCD_FONT_CAT(a, b) a##b
+#define LCD_FONT_SIZE(a, b) LCD_FONT_CAT(a, b) // 字号为宏时先展开再拼接
+
+/**
+ * @brief  取得字号对应的中英文字体
+ * @retval ASCII字符的放大倍数
+ * @note   其他字号在Flash字库目录中有字模段时登记后使用(LCD_FONT_EXTRA_SIZES)，
+ *         否则与 FONT_SIZES 未启用的字号一样使用启用的最小字号(默认12号)
+ */
+static uint8_t LCD_FontForSize(uint8_t font_size, const pFONT **ascii, const pFONT **ch)
+{
+	uint8_t scale = 1;
+
+	switch (font_size)
+	{
+#if FONT_SIZES & FONT_SIZE_BIT(12)
+	case 12:
+		*ascii = &ASCII_Font12;
+		*ch = &CH_Font12;
+		break;
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(16)
+	case 16:
+		*ascii = &ASCII_Font16;
+		*ch = &CH_Font16;
+		break;
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(20)
+	case 20:
+		*ascii = &ASCII_Font20;
+		*ch = &CH_Font20;
+		break;
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(24)
+	case 24:
+		*ascii = &ASCII_Font24;
+		*ch = &CH_Font24;
+		break;
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(32)
+	case 32:
+		*ascii = &ASCII_Font32;
+		*ch = &CH_Font32;
+		break;
+#endif
+#ifdef LCD_TEXT_SCALE_ENABLE
+#if FONT_SIZES & FONT_SIZE_BIT(24)
+	case 48:
+		*ascii = &ASCII_Font24;
+		*ch = &CH_Font24;
+		scale = 2;
+		break;
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(32)
+	case 64:
+		*ascii = &ASCII_Font32;
+		*ch = &CH_Font32;
+		scale = 2;
+		break;
+	case 96:
+		*ascii = &ASCII_Font32;
+		*ch = &CH_Font32;
+		scale = 3;
+		break;
+#endif
+#endif
+	default:
+#if defined(USE_FLASH_FONT) && LCD_FONT_EXTRA_SIZES > 0
+		if (LCD_FontExtra(font_size, ascii, ch))
+			break;
+#endif
+		*ascii = &LCD_FONT_SIZE(ASCII_Font, FONT_SIZE_MIN);
+		*ch = &LCD_FONT_SIZE(CH_Font, FONT_SIZE_MIN);
+		break;
+	}
+	return scale;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetTextFont
+ *
+ *	入口参数:	font_size - 字体大小 (12/16/20/24/32，定义 LCD_TEXT_SCALE_ENABLE 时另有48/64/96；
+ *				            Flash字库目录中有的其他字号，如14/18/28)
+ *
+ *	函数功能:	通过数字直接设置中英文字体大小
+ *
+ *	说    明:	1. 输入数字自动匹配 ASCII_Font 和 CH_Font
+ *					2. 使用示例: LCD_SetTextFont(24) 设置24号字体
+ *					3. 如果输入无效大小或 FONT_SIZES 未启用的字号，使用启用的最小字号(默认12号)
+ *					4. 48/64/96 用24/32/32号ASCII字模放大2/2/3倍，适合大号数字读数，中文保持24/32号
+ *					5. 同时复位 LCD_SetTextScale() 设置的放大倍数
+ *					6. 其余字号在Flash字库中有字模段时直接使用(第一次选用时登记，最多 LCD_FONT_EXTRA_SIZES 个)，
+ *						不放大、不拼接；没有时按第3条处理
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetTextFont(uint8_t font_size)
+{
+	LCD_SetTextFontFamily(0, font_size);
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetTextFontFamily
+ *
+ *	入口参数:	family - 字体族 (字库目录项的 family，0为默认字体，不超过 FLASH_FONT_MAX_FAMILIES-1)
+ *				font_size - 字体大小，与 LCD_SetTextFont() 相同
+ *
+ *	函数功能:	按字体族和字号设置中英文字体
+ *
+ *	说    明:	1. 字体族在切换时解析为各字号的字模段，之后的绘制与单字体相同，不逐字查找字体族
+ *					2. 当前字体族没有的字号或只有ASCII时，其余字符使用字体族0
+ *					3. 字体族随显示列表、绘图队列命令一起保存，回放时不受之后的切换影响
+ *					4. 不使用Flash字库时只有内置字模，family 被忽略
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetTextFontFamily(uint8_t family, uint8_t font_size)
+{
+	LCD.Text_Scale = LCD_FontForSize(font_size, &LCD_AsciiFonts, &LCD_CHFonts);
+	LCD_TEXT_USE_FAMILY(family);
+#ifdef LCD_EXPAND_FIXED_ENABLE
+	Expand_SelectFonts();
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetTextEncoding
+ *
+ *	入口参数:	enc - Text_UTF8 / Text_GBK
+ *
+ *	函数功能:	选择之后的文本函数按哪种编码解码字符串
+ *
+ *	说    明:	1. 只在UTF8 Flash字库(未定义 IS_GB2312)且定义了 FLASH_FONT_GBK_TEXT 时生效，其余配置编码由编译选项决定
+ *					2. GBK汉字经区位行表查到字库索引，再由字库索引编码表得到码点，之后的查找、缓存、字宽和排版
+ *						与UTF-8字符串完全相同，不需要先转换到临时缓冲区
+ *					3. 编码随显示列表、绘图队列命令、绘图上下文(LCD_GC_SetTextEncoding())和排版结果一起保存
+ *					4. 预解析文本串(LCD_DisplayGlyphRun())的原字符串总是UTF-8
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetTextEncoding(uint8_t enc)
+{
+	LCD_TEXT_USE_ENCODING(enc);
+}
+
+/**
+ * @brief  获取当前中文字体大小
+ * @note   内部函数,用于Flash字库模式
+ */
+uint8_t LCD_GetChineseFontSize(void)
+{
+	if (LCD_CHFonts != NULL)
+	{
+		return LCD_CHFonts->Width;
+	}
+	return FONT_SIZE_MIN; // 默认启用的最小字号
+}
+
+/**
+ * @brief  按当前画笔色和背景色重建展开表
+ */
+static void Expand_BuildLUT(void)
+{
+	uint16_t fg = (uint16_t)LCD.Color;
+	uint16_t bg = (uint16_t)LCD.BackColor;
+	uint32_t key = ((uint32_t)fg << 16) | bg;
+	uint8_t slot;
+
+	if (key == Expand_LUT_Key) // 颜色改回了当前表的组合
+	{
+		Expand_LUT_Valid = 1;
+		return;
+	}
+	for (slot = 0; slot < Expand_LUT_SavedCount; slot++)
+	{
+		if (Expand_LUT_SavedKey[slot] == key) // 最近用过，取回保存的表
+		{
+			memcpy(Expand_LUT, Expand_LUT_Saved[slot], sizeof(Expand_LUT));
+#if defined(USE_FLASH_FONT) && defined(FLASH_FONT_AA_ENABLE)
+			memcpy(AA_Ramp, AA_Ramp_Saved[slot], sizeof(AA_Ramp));
+#endif
+			Expand_LUT_Key = key;
+			Expand_LUT_Valid = 1;
+			return;
+		}
+	}
+
+	for (uint8_t v = 0; v < 16; v++)
+	{
+		uint32_t p0 = (v & 0x01) ? fg : bg;
+		uint32_t p1 = (v & 0x02) ? fg : bg;
+		uint32_t p2 = (v & 0x04) ? fg : bg;
+		uint32_t p3 = (v & 0x08) ? fg : bg;
+
+		Expand_LUT[v][0] = p0 | (p1 << 16);
+		Expand_LUT[v][1] = p2 | (p3 << 16);
+	}
+#if defined(USE_FLASH_FONT) && defined(FLASH_FONT_AA_ENABLE)
+	for (uint8_t i = 0; i < 16; i++) // 按通道线性插值，四舍五入
+	{
+		uint16_t r = ((bg >> 11) * (15 - i) + (fg >> 11) * i + 7) / 15;
+		uint16_t g = (((bg >> 5) & 0x3F) * (15 - i) + ((fg >> 5) & 0x3F) * i + 7) / 15;
+		uint16_t b = ((bg & 0x1F) * (15 - i) + (fg & 0x1F) * i + 7) / 15;
+
+		AA_Ramp[i] = (uint16_t)((r << 11) | (g << 5) | b);
+	}
+	memcpy(AA_Ramp_Saved[Expand_LUT_SavedNext], AA_Ramp, sizeof(AA_Ramp));
+#endif
+	memcpy(Expand_LUT_Saved[Expand_LUT_SavedNext], Expand_LUT, sizeof(Expand_LUT));
+	Expand_LUT_SavedKey[Expand_LUT_SavedNext] = key;
+	Expand_LUT_SavedNext = (Expand_LUT_SavedNext + 1) % LCD_LUT_CACHE;
+	if (Expand_LUT_SavedCount < LCD_LUT_CACHE)
+	{
+		Expand_LUT_SavedCount++;
+	}
+	Expand_LUT_Key = key;
+	Expand_LUT_Valid = 1;
+}
+
+#ifdef LCD_EXPAND_SEL_ENABLE
+#define EXPAND_SEL_DEFAULT 1
+#else
+#define EXPAND_SEL_DEFAULT 0
+#endif
+
+/**
+ * @brief  由两位字模选取一对像素
+ * @param  bits 低2位为这两个像素的字模位
+ * @param  fore 画笔色重复两次，back 背景色重复两次
+ * @note   字模位移到两个半字的最低位，USUB16 减1不借位的半字置位GE，SEL 按GE逐字节选取画笔色或背景色，
+ *         没有分支和查表
+ */
+__STATIC_FORCEINLINE uint32_t Expand_SelPair(uint32_t bits, uint32_t fore, uint32_t back)
+{
+	(void)__USUB16((bits & 0x01U) | ((bits & 0x02U) << 15), 0x00010001UL);
+	return __SEL(fore, back);
+}
+
+/**
+ * @brief  展开4个像素(两个32位字)
+ * @param  v 低4位为字模位
+ * @param  sel 1：按 Expand_SelPair() 选取，0：查展开表
+ * @note   选取方式用到的画笔色对和背景色对就是展开表的全1项和全0项
+ */
+__STATIC_FORCEINLINE void Expand_Quad(uint32_t *dst32, uint32_t v, uint8_t sel)
+{
+	if (sel)
+	{
+		uint32_t fore = Expand_LUT[0x0F][0], back = Expand_LUT[0][0];
+
+		dst32[0] = Expand_SelPair(v, fore, back);
+		dst32[1] = Expand_SelPair(v >> 2, fore, back);
+	}
+	else
+	{
+		dst32[0] = Expand_LUT[v & 0x0F][0];
+		dst32[1] = Expand_LUT[v & 0x0F][1];
+	}
+}
+
+/**
+ * @brief  展开一行字模
+ * @param  dst 目标像素，4字节对齐时每次写入4个像素(两个32位字)
+ * @param  src 该行字模数据
+ * @param  width 该行像素数，不必是8的倍数
+ * @param  sel 整字节部分的展开方式，见 Expand_Quad()，为常量时编译器只保留一种
+ * @note   强制内联，width为常量时编译器展开全部循环，见 EXPAND_GLYPH_FIXED
+ */
+__STATIC_FORCEINLINE void Expand_RowWith(uint16_t *dst, const uint8_t *src, uint16_t width, uint8_t sel)
+{
+	uint8_t v;
+
+	if (((uintptr_t)dst & 0x03) == 0)
+	{
+		uint32_t *dst32 = (uint32_t *)dst;
+
+		for (; width >= 8; width -= 8) // 整字节，一次8个像素
+		{
+			v = *src++;
+			Expand_Quad(dst32, v & 0x0F, sel);
+			Expand_Quad(dst32 + 2, v >> 4, sel);
+			dst32 += 4;
+		}
+		dst = (uint16_t *)dst32;
+	}
+	else
+	{
+		for (; width >= 8; width -= 8) // 奇数宽度时行首未对齐，按半字写入
+		{
+			const uint16_t *lo, *hi;
+
+			v = *src++;
+			lo = (const uint16_t *)Expand_LUT[v & 0x0F];
+			hi = (const uint16_t *)Expand_LUT[v >> 4];
+			dst[0] = lo[0], dst[1] = lo[1], dst[2] = lo[2], dst[3] = lo[3];
+			dst[4] = hi[0], dst[5] = hi[1], dst[6] = hi[2], dst[7] = hi[3];
+			dst += 8;
+		}
+	}
+
+	if (width) // 行尾不足8个像素(宽度12/20/24等)
+	{
+		const uint16_t *p;
+
+		v = *src;
+		if (width >= 4)
+		{
+			p = (const uint16_t *)Expand_LUT[v & 0x0F];
+			dst[0] = p[0], dst[1] = p[1], dst[2] = p[2], dst[3] = p[3];
+			dst += 4;
+			width -= 4;
+			v >>= 4;
+		}
+		p = (const uint16_t *)Expand_LUT[v & 0x0F];
+		for (uint8_t k = 0; k < width; k++)
+		{
+			dst[k] = p[k];
+		}
+	}
+}
+
+/**
+ * @brief  按编译时选定的方式展开一行字模
+ */
+__STATIC_FORCEINLINE void Expand_RowInline(uint16_t *dst, const uint8_t *src, uint16_t width)
+{
+	Expand_RowWith(dst, src, width, EXPAND_SEL_DEFAULT);
+}
+
+/**
+ * @brief  展开一行字模，宽度任意
+ */
+ITCM_CODE static void Expand_Row(uint16_t *dst, const uint8_t *src, uint16_t width)
+{
+	Expand_RowInline(dst, src, width);
+}
+
+/**
+ * @brief  展开一行按4字节补齐的字模，每次读取32个像素
+ * @param  src 行数据，4字节对齐，低位在前(小端字的第k位即第k列)
+ * @note   整字为背景时直接填充，否则在寄存器中逐半字节查表，不再逐字节读取映射区
+ */
+ITCM_CODE static void Expand_Row32(uint16_t *dst, const uint32_t *src, uint16_t width)
+{
+	while (width > 0)
+	{
+		uint32_t v = *src++;
+		uint16_t n = (width < 32) ? width : 32;
+
+		if (((uintptr_t)dst & 0x03) != 0 || (n & 0x03) != 0)
+		{
+			Expand_RowInline(dst, (const uint8_t *)&v, n); // 目标未对齐或行尾不足4个像素
+		}
+		else
+		{
+			uint32_t *dst32 = (uint32_t *)dst;
+
+			if (v == 0) // 整字为背景(补齐位为0)
+			{
+				for (uint16_t k = 0; k < n / 2; k++)
+				{
+					dst32[k] = Expand_LUT[0][0];
+				}
+			}
+			else
+			{
+				for (uint16_t k = 0; k < n; k += 4, v >>= 4, dst32 += 2)
+				{
+					Expand_Quad(dst32, v & 0x0F, EXPAND_SEL_DEFAULT);
+				}
+			}
+		}
+		dst += n;
+		width -= n;
+	}
+}
+
+#ifdef LCD_EXPAND_FIXED_ENABLE
+// 固定宽度的整字展开函数：只处理逐行存储的字模，行内没有宽度判断
+typedef void (*Expand_Glyph_t)(uint16_t *dst, const uint8_t *pData, uint16_t height, uint16_t stride);
+
+#define EXPAND_GLYPH_FIXED(W)                                                                                    \
+	ITCM_CODE static void Expand_Glyph##W(uint16_t *dst, const uint8_t *pData, uint16_t height, uint16_t stride) \
+	{                                                                                                            \
+		for (uint16_t row = 0; row < height; row++, pData += ((W) + 7) / 8, dst += stride)                       \
+		{                                                                                                        \
+			Expand_RowInline(dst, pData, (W));                                                                   \
+		}                                                                                                        \
+	}
+
+// 只生成 FONT_SIZES 启用的字号用到的宽度
+#define EXPAND_W6 (FONT_SIZES & FONT_SIZE_BIT(12))
+#define EXPAND_W8 (FONT_SIZES & FONT_SIZE_BIT(16))
+#define EXPAND_W10 (FONT_SIZES & FONT_SIZE_BIT(20))
+#define EXPAND_W12 (FONT_SIZES & (FONT_SIZE_BIT(24) | FONT_SIZE_BIT(12)))
+#define EXPAND_W16 (FONT_SIZES & (FONT_SIZE_BIT(32) | FONT_SIZE_BIT(16)))
+#define EXPAND_W20 (FONT_SIZES & FONT_SIZE_BIT(20))
+#define EXPAND_W24 (FONT_SIZES & FONT_SIZE_BIT(24))
+#define EXPAND_W32 (FONT_SIZES & FONT_SIZE_BIT(32))
+
+#if EXPAND_W6
+EXPAND_GLYPH_FIXED(6) // 12号ASCII
+#endif
+#if EXPAND_W8
+EXPAND_GLYPH_FIXED(8) // 16号ASCII
+#endif
+#if EXPAND_W10
+EXPAND_GLYPH_FIXED(10) // 20号ASCII
+#endif
+#if EXPAND_W12
+EXPAND_GLYPH_FIXED(12) // 24号ASCII、12号汉字
+#endif
+#if EXPAND_W16
+EXPAND_GLYPH_FIXED(16) // 32号ASCII、16号汉字
+#endif
+#if EXPAND_W20
+EXPAND_GLYPH_FIXED(20) // 20号汉字
+#endif
+#if EXPAND_W24
+EXPAND_GLYPH_FIXED(24) // 24号汉字
+#endif
+#if EXPAND_W32
+EXPAND_GLYPH_FIXED(32) // 32号汉字
+#endif
+
+static const struct
+{
+	uint8_t Width;
+	Expand_Glyph_t Fn;
+} Expand_GlyphTable[] = {
+#if EXPAND_W6
+	{6, Expand_Glyph6},
+#endif
+#if EXPAND_W8
+	{8, Expand_Glyph8},
+#endif
+#if EXPAND_W10
+	{10, Expand_Glyph10},
+#endif
+#if EXPAND_W12
+	{12, Expand_Glyph12},
+#endif
+#if EXPAND_W16
+	{16, Expand_Glyph16},
+#endif
+#if EXPAND_W20
+	{20, Expand_Glyph20},
+#endif
+#if EXPAND_W24
+	{24, Expand_Glyph24},
+#endif
+#if EXPAND_W32
+	{32, Expand_Glyph32},
+#endif
+};
+
+// 当前字体对应的专用展开函数，[0]为ASCII、[1]为汉字，切换字体时重新选择
+static Expand_Glyph_t Expand_FontFn[2] = {NULL, NULL};
+static uint8_t Expand_FontWidth[2] = {0, 0};
+
+/**
+ * @brief  按当前中英文字体选择专用展开函数
+ * @note   LCD_SetTextFont() 以及回放录制状态时调用
+ */
+static void Expand_SelectFonts(void)
+{
+	const pFONT *fonts[2] = {LCD_AsciiFonts, LCD_CHFonts};
+
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		Expand_FontFn[i] = NULL;
+		Expand_FontWidth[i] = 0;
+		for (uint8_t k = 0; fonts[i] != NULL && k < sizeof(Expand_GlyphTable) / sizeof(Expand_GlyphTable[0]); k++)
+		{
+			if (Expand_GlyphTable[k].Width == fonts[i]->Width)
+			{
+				Expand_FontFn[i] = Expand_GlyphTable[k].Fn;
+				Expand_FontWidth[i] = Expand_GlyphTable[k].Width;
+			}
+		}
+	}
+}
+#endif
+
+// 压缩字模第0行之前的空行，宽度最大64像素
+static const uint8_t Glyph_BlankRow[8] = {0};
+
+#define GLYPH_RLE 1	  // 行程压缩字模(FONT_FMT_1BPP_RLE)
+#define GLYPH_ROW32 2 // 每行按4字节补齐的逐行字模(FONT_FMT_1BPP_ROW32)，可按32位字读取
+
+/**
+ * @brief  字模每个存储行的字节数
+ * @param  packed 字模存储方式，见 Glyph_RowBegin()
+ */
+static inline uint16_t Glyph_RowBytes(uint16_t width, uint8_t packed)
+{
+	return (packed == GLYPH_ROW32) ? ((width + 31) / 32) * 4 : (width + 7) / 8;
+}
+
+/**
+ * @brief  字模是否可以按32位字逐行读取
+ * @note   字模段、缓存槽和常驻池中的字模都是4字节对齐的，仍检查地址，未对齐时按字节读取
+ */
+static inline uint8_t Glyph_WordRows(const uint8_t *pData, uint8_t packed)
+{
+	return packed == GLYPH_ROW32 && ((uintptr_t)pData & 0x03) == 0;
+}
+
+/**
+ * @brief  初始化字模逐行读取
+ * @param  pData 字模数据
+ * @param  packed 1表示行程压缩格式(行标记 + 新行)，2表示每行按4字节补齐，0表示逐行存储
+ * @param  tags 输出行标记，未压缩时为NULL
+ * @retval 第一个存储行的地址
+ */
+static inline const uint8_t *Glyph_RowBegin(const uint8_t *pData, uint8_t packed, uint16_t height, const uint8_t **tags)
+{
+	*tags = (packed == GLYPH_RLE) ? pData : NULL;
+	return (packed == GLYPH_RLE) ? pData + (height + 7) / 8 : pData;
+}
+
+/**
+ * @brief  取字模第row行的数据
+ * @param  next 下一个存储行的地址，取出存储行后后移 bytes_per_row
+ * @param  prev 上一行数据，压缩字模中与上一行相同的行直接沿用
+ * @retval 本行数据
+ */
+static inline const uint8_t *Glyph_Row(const uint8_t **next, const uint8_t *tags, const uint8_t *prev,
+									   uint16_t row, uint16_t bytes_per_row)
+{
+	if (tags != NULL && !(tags[row >> 3] & (0x01 << (row & 0x07))))
+	{
+		return prev; // 重复行不占存储
+	}
+	prev = *next;
+	*next += bytes_per_row;
+	return prev;
+}
+
+/**
+ * @brief  把1bpp位图展开为RGB565像素
+ * @param  dst 目标缓冲区
+ * @param  pData 字模数据，每行 (width+7)/8 字节，低位在前
+ * @param  stride 目标缓冲区每行像素数，单独展开时等于 width，合成到行缓冲区时为整行宽度
+ * @param  packed 1表示pData为行程压缩字模，重复行直接复制上一行已展开的像素；
+ *                2表示每行按4字节补齐，逐行按32位字读取
+ * @note   Flash字库、内置字库(lcd_fonts.c)与1bpp图片共用，不叠加文本效果
+ */
+ITCM_CODE static void LCD_ExpandBitmap(uint16_t *dst, const uint8_t *pData, uint16_t width, uint16_t height,
+									   uint16_t stride, uint8_t packed)
+{
+	uint16_t bytes_per_row = Glyph_RowBytes(width, packed);
+	const uint8_t *tags;
+	const uint8_t *next = Glyph_RowBegin(pData, packed, height, &tags);
+	const uint8_t *src = Glyph_BlankRow;
+
+	if (!Expand_LUT_Valid)
+	{
+		Expand_BuildLUT();
+	}
+	if (Glyph_WordRows(pData, packed)) // 按字补齐的大字号，逐行按32位字读取
+	{
+		for (uint16_t row = 0; row < height; row++, pData += bytes_per_row, dst += stride)
+		{
+			Expand_Row32(dst, (const uint32_t *)pData, width);
+		}
+		return;
+	}
+#ifdef LCD_EXPAND_FIXED_ENABLE
+	if (!packed && (width == Expand_FontWidth[0] || width == Expand_FontWidth[1])) // 当前字号走专用展开函数
+	{
+		Expand_FontFn[width == Expand_FontWidth[0] ? 0 : 1](dst, pData, height, stride);
+		return;
+	}
+#endif
+	for (uint16_t row = 0; row < height; row++)
+	{
+		const uint8_t *prev = src;
+
+		src = Glyph_Row(&next, tags, prev, row, bytes_per_row);
+		if (src == prev && row > 0)
+		{
+			memcpy(dst, dst - stride, width * sizeof(uint16_t)); // 与上一行相同
+		}
+		else
+		{
+			Expand_Row(dst, src, width);
+		}
+		dst += stride;
+	}
+}
+
+#ifdef LCD_TEXT_EFFECT_ENABLE
+#define EFFECT_MAX_WIDTH 32	 // 效果按32位字计算，更宽的字模(放大后的大号ASCII)不加效果
+#define EFFECT_MAX_HEIGHT 96 // 放大3倍的32号ASCII
+
+// 施加效果后的字模：前景和描边/阴影各一个位图，每行一个字，与 GLYPH_ROW32 格式相同
+DTCM_BSS static uint32_t Effect_Fg[EFFECT_MAX_HEIGHT];
+DTCM_BSS static uint32_t Effect_Edge[EFFECT_MAX_HEIGHT];
+
+/**
+ * @brief  读出一行字模(最多32像素)
+ */
+static inline uint32_t Effect_Load(const uint8_t *src, uint16_t bytes_per_row)
+{
+	uint32_t v = 0;
+
+	memcpy(&v, src, (bytes_per_row < 4) ? bytes_per_row : 4);
+	return v;
+}
+
+/**
+ * @brief  按当前文本效果由1bpp字模生成前景和描边/阴影位图
+ * @param  packed 字模存储方式，见 Glyph_RowBegin()
+ * @retval 1-已生成，0-没有效果或字模超出 EFFECT_MAX_WIDTH x EFFECT_MAX_HEIGHT，按原字模绘制
+ * @note   每行一次32位运算：加粗为本行与右移1列相或；描边为上中下三行相或后左右各扩1列，
+ *         再去掉前景；阴影为上一行右移1列后去掉前景(向右下偏移1像素)。效果不超出字模单元
+ */
+static uint8_t Effect_Build(const uint8_t *pData, uint16_t width, uint16_t height, uint8_t packed)
+{
+	uint16_t bytes_per_row = Glyph_RowBytes(width, packed);
+	uint8_t effect = LCD.Text_Effect;
+	uint32_t mask, up = 0, cur;
+	const uint8_t *tags;
+	const uint8_t *next;
+	const uint8_t *src = Glyph_BlankRow;
+
+	if (effect == Text_EffectNone || width == 0 || width > EFFECT_MAX_WIDTH || height > EFFECT_MAX_HEIGHT)
+	{
+		return 0;
+	}
+	mask = 0xFFFFFFFFUL >> (32 - width);
+
+	next = Glyph_RowBegin(pData, packed, height, &tags);
+	for (uint16_t row = 0; row < height; row++)
+	{
+		src = Glyph_Row(&next, tags, src, row, bytes_per_row);
+		cur = Effect_Load(src, bytes_per_row) & mask;
+		if (effect & Text_EffectBold)
+		{
+			cur |= (cur << 1) & mask;
+		}
+		Effect_Fg[row] = cur;
+	}
+	if (!(effect & (Text_EffectOutline | Text_EffectShadow)))
+	{
+		memset(Effect_Edge, 0, height * sizeof(Effect_Edge[0]));
+		return 1;
+	}
+	for (uint16_t row = 0; row < height; row++)
+	{
+		uint32_t down = (row + 1 < height) ? Effect_Fg[row + 1] : 0;
+		uint32_t edge = 0;
+
+		cur = Effect_Fg[row];
+		if (effect & Text_EffectOutline)
+		{
+			uint32_t v = up | cur | down;
+
+			edge = v | (v << 1) | (v >> 1);
+		}
+		if (effect & Text_EffectShadow)
+		{
+			edge |= up << 1;
+		}
+		Effect_Edge[row] = edge & ~cur & mask;
+		up = cur;
+	}
+	return 1;
+}
+
+/**
+ * @brief  展开一行施加效果后的字模：前景/背景按半字节查表，描边/阴影像素逐位改写
+ * @param  fg 前景位图，edge 描边/阴影位图，两者不重叠
+ */
+static inline void Effect_ExpandRow(uint16_t *dst, uint32_t fg, uint32_t edge, uint16_t width)
+{
+	Expand_Row32(dst, &fg, width);
+	for (; edge != 0; edge &= edge - 1)
+	{
+		dst[__CLZ(__RBIT(edge))] = LCD.Effect_Color;
+	}
+}
+#endif
+
+/**
+ * @brief  把1bpp文本字模展开为RGB565像素
+ * @note   参数与 LCD_ExpandBitmap() 相同；设置了文本效果时先由 Effect_Build() 生成前景和描边/阴影位图，
+ *         再在同一遍中展开到目标缓冲区，效果像素不需要再绘制一次字模
+ */
+ITCM_CODE static void LCD_ExpandGlyph(uint16_t *dst, const uint8_t *pData, uint16_t width, uint16_t height,
+									  uint16_t stride, uint8_t packed)
+{
+#ifdef LCD_TEXT_EFFECT_ENABLE
+	if (LCD.Text_Effect != Text_EffectNone && Effect_Build(pData, width, height, packed))
+	{
+		if (!Expand_LUT_Valid)
+		{
+			Expand_BuildLUT();
+		}
+		for (uint16_t row = 0; row < height; row++, dst += stride)
+		{
+			Effect_ExpandRow(dst, Effect_Fg[row], Effect_Edge[row], width);
+		}
+		return;
+	}
+#endif
+	LCD_ExpandBitmap(dst, pData, width, height, stride, packed);
+}
+
+/**
+ * @brief  透明模式绘制1bpp位图：只发送置位的像素
+ * @param  pData 字模数据，每行 (width+7)/8 字节，低位在前
+ * @param  packed 1表示pData为行程压缩字模
+ * @param  color 像素颜色(RGB565)
+ * @note   每一段连续的前景像素作为一个单行窗口发送，背景像素不传输
+ */
+static void LCD_DrawBitmapSpans(uint16_t x, uint16_t y, const uint8_t *pData, uint16_t width, uint16_t height,
+								uint8_t packed, uint16_t color)
+{
+	uint16_t bytes_per_row = Glyph_RowBytes(width, packed);
+	uint16_t *pBuff = LCD_NextBuff();
+	const uint8_t *tags;
+	const uint8_t *next = Glyph_RowBegin(pData, packed, height, &tags);
+	const uint8_t *src = Glyph_BlankRow;
+
+	for (uint16_t k = 0; k < width; k++) // 一段最长为整行，所有段共用同一块画笔色数据
+	{
+		pBuff[k] = color;
+	}
+
+	for (uint16_t row = 0; row < height; row++)
+	{
+		uint16_t col = 0;
+
+		src = Glyph_Row(&next, tags, src, row, bytes_per_row);
+
+		while (col < width)
+		{
+			uint16_t start;
+
+			if ((col & 0x07) == 0 && src[col >> 3] == 0) // 整字节为背景，直接跳过
+			{
+				col += 8;
+				continue;
+			}
+			if (!(src[col >> 3] & (0x01 << (col & 0x07))))
+			{
+				col++;
+				continue;
+			}
+			start = col;
+			while (col < width && (src[col >> 3] & (0x01 << (col & 0x07))))
+			{
+				col++;
+			}
+			LCD_SetAddress(x + start, y + row, x + col - 1, y + row); // 单行窗口
+			LCD_WriteBuff(pBuff, col - start);
+		}
+	}
+}
+
+/**
+ * @brief  透明模式绘制字模：只发送前景像素
+ * @param  pData 字模数据，每行 (width+7)/8 字节，低位在前
+ * @param  packed 1表示pData为行程压缩字模
+ * @note   有文本效果时先以效果颜色发送描边/阴影段，再以画笔色发送前景段
+ */
+static void LCD_DrawGlyphSpans(uint16_t x, uint16_t y, const uint8_t *pData, uint16_t width, uint16_t height,
+							   uint8_t packed)
+{
+#ifdef LCD_TEXT_EFFECT_ENABLE
+	if (LCD.Text_Effect != Text_EffectNone && Effect_Build(pData, width, height, packed))
+	{
+		LCD_DrawBitmapSpans(x, y, (const uint8_t *)Effect_Edge, width, height, GLYPH_ROW32, LCD.Effect_Color);
+		LCD_DrawBitmapSpans(x, y, (const uint8_t *)Effect_Fg, width, height, GLYPH_ROW32, (uint16_t)LCD.Color);
+		return;
+	}
+#endif
+	LCD_DrawBitmapSpans(x, y, pData, width, height, packed, (uint16_t)LCD.Color);
+}
+
+#ifdef LCD_TEXT_SCALE_ENABLE
+#define SCALE_MAX 3			// 最大放大倍数
+#define SCALE_MAX_HEIGHT 32 // 可放大的字模最大高度，放大后每行最多64像素
+
+// 放大后的1bpp字模，每行 (width*scale+7)/8 字节，低位在前
+static uint8_t Scale_Glyph[SCALE_MAX_HEIGHT * SCALE_MAX * 8];
+
+// 半字节(4个像素)横向放大2/3倍后的位图
+static const uint16_t Scale_Nibble[2][16] = {
+	{0x000, 0x003, 0x00C, 0x00F, 0x030, 0x033, 0x03C, 0x03F, 0x0C0, 0x0C3, 0x0CC, 0x0CF, 0x0F0, 0x0F3, 0x0FC, 0x0FF},
+	{0x000, 0x007, 0x038, 0x03F, 0x1C0, 0x1C7, 0x1F8, 0x1FF, 0xE00, 0xE07, 0xE38, 0xE3F, 0xFC0, 0xFC7, 0xFF8, 0xFFF}};
+
+#ifdef LCD_TEXT_SCALE_SMOOTH
+// 放大后每个像素块中第k列的位置，用于把平滑后的各列合成一行
+static const uint64_t Scale_Lane[2][SCALE_MAX] = {
+	{0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL, 0},
+	{0x9249249249249249ULL, 0x2492492492492492ULL, 0x4924924924924924ULL}};
+
+#define SCALE_SEL(c, a, e) (((c) & (a)) | (~(c) & (e))) // c为1的像素取a，否则取e
+#endif
+
+/**
+ * @brief  读出一行字模(最多32像素)
+ */
+static inline uint32_t Scale_Load(const uint8_t *src, uint16_t bytes_per_row)
+{
+	uint32_t v = 0;
+
+	memcpy(&v, src, bytes_per_row);
+	return v;
+}
+
+/**
+ * @brief  把一行像素横向放大scale倍，每个像素复制成scale个相邻位
+ */
+static uint64_t Scale_Spread(uint32_t v, uint8_t scale)
+{
+	const uint16_t *table = Scale_Nibble[scale - 2];
+	uint64_t out = 0;
+
+	for (uint8_t shift = 0; v != 0; shift += 4 * scale, v >>= 4)
+	{
+		out |= (uint64_t)table[v & 0x0F] << shift;
+	}
+	return out;
+}
+
+/**
+ * @brief  把字模的一行放大为scale行
+ * @param  dst 输出的第一行，之后每行间隔 out_bpr 字节
+ * @param  up,cur,down 上一行、本行、下一行像素，字模之外为0
+ * @param  mask 字模宽度内的位
+ * @note   定义 LCD_TEXT_SCALE_SMOOTH 时按Scale2x/Scale3x规则在斜边处补角，否则直接复制像素
+ */
+static void Scale_Row(uint8_t *dst, uint16_t out_bpr, uint32_t up, uint32_t cur, uint32_t down, uint8_t scale,
+					  uint32_t mask)
+{
+	uint64_t rows[SCALE_MAX];
+
+#ifdef LCD_TEXT_SCALE_SMOOTH
+	const uint64_t *lane = Scale_Lane[scale - 2];
+	uint32_t D = (cur << 1) & mask, F = cur >> 1; // 左、右相邻像素
+	uint32_t k_db = ~(D ^ up) & (D ^ down) & (up ^ F); // 左上角：左=上，且左!=下、上!=右
+	uint32_t k_bf = ~(up ^ F) & (up ^ D) & (F ^ down); // 右上角
+	uint32_t k_hd = ~(down ^ D) & (down ^ F) & (D ^ up); // 左下角
+	uint32_t k_fh = ~(F ^ down) & (F ^ up) & (down ^ D); // 右下角
+
+	if (scale == 2)
+	{
+		rows[0] = (Scale_Spread(SCALE_SEL(k_db, D, cur), 2) & lane[0]) |
+				  (Scale_Spread(SCALE_SEL(k_bf, F, cur), 2) & lane[1]);
+		rows[1] = (Scale_Spread(SCALE_SEL(k_hd, D, cur), 2) & lane[0]) |
+				  (Scale_Spread(SCALE_SEL(k_fh, F, cur), 2) & lane[1]);
+	}
+	else
+	{
+		uint32_t A = (up << 1) & mask, C = up >> 1;		// 左上、右上像素
+		uint32_t G = (down << 1) & mask, I = down >> 1; // 左下、右下像素
+		uint32_t top = (k_db & (cur ^ C)) | (k_bf & (cur ^ A));
+		uint32_t left = (k_hd & (cur ^ A)) | (k_db & (cur ^ G));
+		uint32_t right = (k_bf & (cur ^ I)) | (k_fh & (cur ^ C));
+		uint32_t bottom = (k_fh & (cur ^ G)) | (k_hd & (cur ^ I));
+
+		rows[0] = (Scale_Spread(SCALE_SEL(k_db, D, cur), 3) & lane[0]) |
+				  (Scale_Spread(SCALE_SEL(top, up, cur), 3) & lane[1]) |
+				  (Scale_Spread(SCALE_SEL(k_bf, F, cur), 3) & lane[2]);
+		rows[1] = (Scale_Spread(SCALE_SEL(left, D, cur), 3) & lane[0]) |
+				  (Scale_Spread(cur, 3) & lane[1]) |
+				  (Scale_Spread(SCALE_SEL(right, F, cur), 3) & lane[2]);
+		rows[2] = (Scale_Spread(SCALE_SEL(k_hd, D, cur), 3) & lane[0]) |
+				  (Scale_Spread(SCALE_SEL(bottom, down, cur), 3) & lane[1]) |
+				  (Scale_Spread(SCALE_SEL(k_fh, F, cur), 3) & lane[2]);
+	}
+#else
+	(void)up;
+	(void)down;
+	(void)mask;
+	rows[0] = Scale_Spread(cur, scale);
+	for (uint8_t k = 1; k < scale; k++)
+	{
+		rows[k] = rows[0];
+	}
+#endif
+	for (uint8_t k = 0; k < scale; k++)
+	{
+		memcpy(dst + k * out_bpr, &rows[k], out_bpr); // 小端序，低位字节在前
+	}
+}
+
+/**
+ * @brief  把1bpp字模整数倍放大后绘制
+ * @param  packed 1表示pData为行程压缩字模
+ * @param  scale 放大倍数(2-3)
+ * @retval 1-已绘制, 0-字模过大(放大后超过64像素宽或字模高于32像素)，由调用者按原字号绘制
+ * @note   先生成放大后的1bpp字模，再按渲染缓冲区大小分段展开，在同一个窗口内连续发送
+ */
+static uint8_t LCD_DrawGlyphScaled(uint16_t x, uint16_t y, const uint8_t *pData, uint16_t width, uint16_t height,
+								   uint8_t packed, uint8_t scale)
+{
+	uint16_t bytes_per_row = Glyph_RowBytes(width, packed);
+	uint16_t out_w = width * scale, out_h = height * scale;
+	uint16_t out_bpr = (out_w + 7) / 8;
+	uint16_t rows_per_buff = LCD_BUFF_PIXELS / out_w;
+	uint32_t mask, up = 0, cur, down;
+	const uint8_t *tags;
+	const uint8_t *next;
+	const uint8_t *src = Glyph_BlankRow;
+
+	if (scale < 2 || scale > SCALE_MAX || width == 0 || out_w > 64 || height > SCALE_MAX_HEIGHT)
+	{
+		return 0;
+	}
+	mask = 0xFFFFFFFFUL >> (32 - width);
+
+	next = Glyph_RowBegin(pData, packed, height, &tags);
+	src = Glyph_Row(&next, tags, src, 0, bytes_per_row);
+	cur = Scale_Load(src, bytes_per_row) & mask;
+	for (uint16_t row = 0; row < height; row++)
+	{
+		down = 0;
+		if (row + 1 < height)
+		{
+			src = Glyph_Row(&next, tags, src, row + 1, bytes_per_row);
+			down = Scale_Load(src, bytes_per_row) & mask;
+		}
+		Scale_Row(Scale_Glyph + row * scale * out_bpr, out_bpr, up, cur, down, scale, mask);
+		up = cur;
+		cur = down;
+	}
+
+	if (LCD.Text_Mode == Text_Transparent)
+	{
+		LCD_DrawGlyphSpans(x, y, Scale_Glyph, out_w, out_h, 0);
+		return 1;
+	}
+	for (uint16_t row = 0; row < out_h; row += rows_per_buff) // 放大后的字模大于一个渲染缓冲区，分段发送
+	{
+		uint16_t rows = (out_h - row < rows_per_buff) ? (out_h - row) : rows_per_buff;
+		uint16_t *pBuff = LCD_NextBuff();
+
+		LCD_ExpandGlyph(pBuff, Scale_Glyph + row * out_bpr, out_w, rows, out_w, 0);
+		if (row == 0)
+		{
+			LCD_SetAddress(x, y, x + out_w - 1, y + out_h - 1); // 第一段展开后再设置窗口
+		}
+		LCD_WriteBuff(pBuff, rows * out_w);
+	}
+	return 1;
+}
+#endif
+
+#if defined(USE_FLASH_FONT) && defined(LCD_GLYPH_RUN_ENABLE)
+/**
+ * @brief  把一个同色段追加到渲染缓冲区，长段直接以常量色发送
+ * @param  pBuff 当前渲染缓冲区，写满或发送后换成下一个
+ * @param  fill 缓冲区中尚未发送的像素数
+ * @retval 追加后缓冲区中尚未发送的像素数
+ */
+static uint16_t LCD_EmitRun(uint16_t **pBuff, uint16_t fill, uint16_t color, uint32_t run)
+{
+	if (run >= LCD_GLYPH_RUN_MIN)
+	{
+		if (fill > 0) // 先按窗口顺序发出之前的短段
+		{
+			LCD_WriteBuff(*pBuff, fill);
+			*pBuff = LCD_NextBuff();
+		}
+		LCD_WriteColor(color, run);
+		return 0;
+	}
+	while (run > 0)
+	{
+		uint16_t n = (run < (uint32_t)(LCD_BUFF_PIXELS - fill)) ? (uint16_t)run : LCD_BUFF_PIXELS - fill;
+
+		for (uint16_t k = 0; k < n; k++)
+		{
+			(*pBuff)[fill + k] = color;
+		}
+		fill += n;
+		run -= n;
+		if (fill == LCD_BUFF_PIXELS)
+		{
+			LCD_WriteBuff(*pBuff, fill);
+			*pBuff = LCD_NextBuff();
+			fill = 0;
+		}
+	}
+	return fill;
+}
+
+/**
+ * @brief  按同色段绘制字模(不透明模式)
+ * @param  packed 1表示pData为行程压缩字模，2表示每行按4字节补齐
+ * @note   整个字模只设置一次窗口，光栅顺序上相邻的同色像素合为一段，可以跨行；
+ *         大字号的空白行和行首尾背景通常连成长段，不再逐像素写入缓冲区
+ * @note   按字补齐的字模每次读取32列，用 RBIT+CLZ 直接找到下一个颜色变化的列
+ */
+static void LCD_DrawGlyphRuns(uint16_t x, uint16_t y, const uint8_t *pData, uint16_t width, uint16_t height,
+							  uint8_t packed)
+{
+	uint16_t bytes_per_row = Glyph_RowBytes(width, packed);
+	uint8_t words = Glyph_WordRows(pData, packed);
+	const uint8_t *tags;
+	const uint8_t *next = Glyph_RowBegin(pData, packed, height, &tags);
+	const uint8_t *src = Glyph_BlankRow;
+	uint16_t *pBuff;
+	uint16_t fill = 0; // 缓冲区中待发送的像素数
+	uint32_t run = 0;  // 当前同色段长度
+	uint8_t fg = 0;	   // 当前同色段是否为前景
+
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+	pBuff = LCD_NextBuff();
+
+	for (uint16_t row = 0; row < height; row++)
+	{
+		uint16_t col = 0;
+
+		src = Glyph_Row(&next, tags, src, row, bytes_per_row);
+		for (const uint32_t *src32 = (const uint32_t *)src; words && col < width; col += 32)
+		{
+			uint32_t v = *src32++;
+			uint16_t n = (width - col < 32) ? width - col : 32; // 本字有效列数
+
+			for (;;)
+			{
+				uint32_t diff = fg ? ~v : v; // 与当前段颜色不同的列
+
+				if (n < 32)
+				{
+					diff &= (1UL << n) - 1;
+				}
+				if (diff == 0)
+				{
+					run += n; // 本字剩余的列都并入当前段
+					break;
+				}
+				uint32_t k = __CLZ(__RBIT(diff)); // 下一个颜色变化的列
+
+				run += k;
+				fill = LCD_EmitRun(&pBuff, fill, fg ? LCD.Color : LCD.BackColor, run);
+				fg ^= 1;
+				run = 0;
+				v >>= k;
+				n -= (uint16_t)k;
+			}
+		}
+		while (col < width)
+		{
+			uint8_t v = src[col >> 3];
+			uint8_t bit;
+
+			if ((col & 0x07) == 0 && col + 8 <= width && v == (fg ? 0xFF : 0x00))
+			{
+				run += 8; // 整字节与当前段同色
+				col += 8;
+				continue;
+			}
+			bit = (v >> (col & 0x07)) & 0x01;
+			if (bit != fg)
+			{
+				fill = LCD_EmitRun(&pBuff, fill, fg ? LCD.Color : LCD.BackColor, run);
+				fg = bit;
+				run = 0;
+			}
+			run++;
+			col++;
+		}
+	}
+	fill = LCD_EmitRun(&pBuff, fill, fg ? LCD.Color : LCD.BackColor, run);
+	if (fill > 0)
+	{
+		LCD_WriteBuff(pBuff, fill);
+	}
+}
+#endif
+
+#ifdef USE_FLASH_FONT
+#define GLYPH_KEY_GBK 0x80000000UL // GB2312模式下字符键的标记位，与Unicode码点区分
+
+#ifdef FLASH_FONT_AA_ENABLE
+/**
+ * @brief  查找字符键对应的抗锯齿字模
+ * @param  bpp 输出每像素位数(2或4)
+ * @retval 字模数据指针，字库中没有该字号的抗锯齿段或设置了文本效果时返回NULL
+ */
+static const uint8_t *LCD_FindGlyphAA(uint32_t key, uint8_t font_size, uint8_t *bpp)
+{
+	if (LCD_TEXT_EFFECT() != Text_EffectNone)
+	{
+		return NULL; // 文本效果只作用于1bpp字模
+	}
+	if (key & GLYPH_KEY_GBK)
+	{
+		const char gbk[2] = {(char)(key >> 8), (char)key};
+
+		return GB2312_FindFontAA_Flash(gbk, font_size, bpp);
+	}
+	return FlashFont_GetGlyphAA(key, font_size, bpp);
+}
+
+#ifdef LCD_CAPTURE_ENABLE
+/**
+ * @brief  抗锯齿字模按灰度与帧缓冲/条带中已有的像素混合(透明模式)
+ * @param  x 字模单元第0列的坐标，按比例宽度截取时可以为负
+ * @param  pData 字模数据，每行 (width*bpp+7)/8 字节，低位在前
+ * @note   4bpp字模在帧缓冲模式下由DMA2D混合(A4前景层+帧缓冲背景层)，其余由CPU按色阶表相同的公式混合
+ */
+static void LCD_FB_BlendGlyph(int32_t x, uint16_t y, const uint8_t *pData, uint16_t width, uint16_t height, uint8_t bpp)
+{
+	uint16_t stride = (width * bpp + 7) / 8;
+	uint8_t mask = (1 << bpp) - 1, scale = (bpp == 2) ? 5 : 1;
+	uint16_t fr = LCD.Color >> 11, fg = (LCD.Color >> 5) & 0x3F, fb = LCD.Color & 0x1F;
+	LCD_Rect_t vis;
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	uint16_t dy1 = 0xFFFF, dy2 = 0;
+#endif
+
+	if (!LCD_FB_Visible(x, y, x + width - 1, (int32_t)y + height - 1, &vis))
+		return;
+	LCD_FB_SetWindow(vis.x1, vis.y1, vis.x2, vis.y2); // 条带据此得知本命令涉及的行
+	LCD_DMA2D_Wait();
+#ifdef LCD_FB_DMA2D
+	if (bpp == 4 && (width & 1) == 0 && ((vis.x1 - x) & 1) == 0 &&
+		(uint32_t)(vis.x2 - vis.x1 + 1) * (vis.y2 - vis.y1 + 1) >= LCD_DMA2D_MIN_PIXELS)
+	{
+		// A4每字节两个像素，起始列为偶数时行首按字节对齐
+		uint16_t w = vis.x2 - vis.x1 + 1;
+		const uint8_t *src = pData + (uint32_t)(vis.y1 - y) * stride + (vis.x1 - x) / 2;
+
+		if (LCD_DMA2D_Setup(DMA2D_M2M_BLEND, w) &&
+			LCD_DMA2D_Layer(DMA2D_FOREGROUND_LAYER, DMA2D_INPUT_A4, width - w, LCD_DMA2D_Color(LCD.Color)) &&
+			LCD_DMA2D_Layer(DMA2D_BACKGROUND_LAYER, DMA2D_INPUT_RGB565, LCD_FB_STRIDE() - w, 0xFF000000UL) &&
+			LCD_DMA2D_Start((uint32_t)src, 1, &vis))
+			return;
+	}
+#endif
+
+	for (uint16_t row = vis.y1; row <= vis.y2; row++)
+	{
+		const uint8_t *line = pData + (uint32_t)(row - y) * stride;
+		uint16_t *dst = LCD_FB_ROW(row);
+		uint8_t changed = 0;
+
+		if (!LCD_FB_HIT(row))
+			continue;
+		for (uint16_t col = vis.x1; col <= vis.x2; col++)
+		{
+			uint32_t bit = (uint32_t)(col - x) * bpp;
+			uint16_t a = ((line[bit >> 3] >> (bit & 7)) & mask) * scale;
+			uint16_t b = dst[col], r, g, v;
+
+			if (a == 0)
+				continue;
+			r = ((b >> 11) * (15 - a) + fr * a + 7) / 15;
+			g = (((b >> 5) & 0x3F) * (15 - a) + fg * a + 7) / 15;
+			v = (uint16_t)((r << 11) | (g << 5) | (((b & 0x1F) * (15 - a) + fb * a + 7) / 15));
+			if (v != b)
+			{
+				dst[col] = v;
+				changed = 1;
+			}
+		}
+#ifdef LCD_FRAMEBUFFER_ENABLE
+		if (changed)
+		{
+			if (dy1 == 0xFFFF)
+				dy1 = row;
+			dy2 = row;
+		}
+#else
+		(void)changed;
+#endif
+	}
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	if (dy1 != 0xFFFF)
+		LCD_FB_MarkDirty(vis.x1, dy1, vis.x2, dy2);
+#endif
+}
+#endif
+
+/**
+ * @brief  把2bpp/4bpp抗锯齿字模按色阶展开为RGB565像素
+ * @param  pData 字模数据，每行 (width*bpp+7)/8 字节，低位在前
+ * @param  stride 目标缓冲区每行像素数
+ * @note   灰度只与背景色混合，色阶表随画笔色/背景色改变重建，逐像素只查表
+ */
+ITCM_CODE static void LCD_ExpandGlyphAA(uint16_t *dst, const uint8_t *pData, uint16_t width, uint16_t height,
+										uint16_t stride, uint8_t bpp)
+{
+	uint8_t mask = (uint8_t)((1 << bpp) - 1);
+	uint8_t scale = (bpp == 4) ? 1 : 5; // 2bpp的0-3对应色阶0/5/10/15
+
+	if (!Expand_LUT_Valid)
+	{
+		Expand_BuildLUT();
+	}
+	for (uint16_t row = 0; row < height; row++, dst += stride)
+	{
+		uint16_t col = 0;
+
+		while (col < width)
+		{
+			uint8_t v = *pData++;
+
+			for (uint8_t k = 0; k < 8 && col < width; k += bpp, col++)
+			{
+				dst[col] = AA_Ramp[((v >> k) & mask) * scale];
+			}
+		}
+	}
+}
+#endif
+
+/**
+ * @brief  把一行1bpp字模平移为以src_x列为第0列
+ * @param  bits 输出行数据(8字节，最多64列)
+ * @param  mask 字模单元有效列的掩码，单元外的列为背景
+ */
+static inline void Glyph_ShiftRow(uint8_t *bits, const uint8_t *src, uint16_t bytes_per_row, uint64_t mask,
+								  int8_t src_x)
+{
+	uint64_t v = 0;
+
+	memcpy(&v, src, bytes_per_row); // 低位在前，与小端字节序一致
+	v &= mask;
+	v = (src_x >= 0) ? (v >> src_x) : (v << -src_x);
+	memcpy(bits, &v, sizeof(v));
+}
+
+/**
+ * @brief  按比例宽度窗口展开ASCII字模
+ * @param  pData 字模数据(整个字模单元)，bpp为1时每行 (cell_w+7)/8 字节，否则每行 (cell_w*bpp+7)/8 字节
+ * @param  cell_w 字模单元宽度
+ * @param  src_x 窗口第0列对应的字模单元列，可为负
+ * @param  width 窗口宽度(不超过64)，超出字模单元的列填充背景色
+ * @param  bpp 1为1bpp字模，2/4为抗锯齿字模
+ * @note   1bpp字模把每行移位到窗口坐标后仍按查找表展开，文本效果在移位前按整个字模单元计算
+ */
+static void LCD_ExpandGlyphWindow(uint16_t *dst, const uint8_t *pData, uint16_t cell_w, uint16_t height,
+								  uint16_t stride, int8_t src_x, uint16_t width, uint8_t bpp)
+{
+	uint16_t bytes_per_row = (cell_w * bpp + 7) / 8;
+	uint64_t mask = (cell_w >= 64) ? ~0ULL : (1ULL << cell_w) - 1;
+
+	if (!Expand_LUT_Valid)
+	{
+		Expand_BuildLUT();
+	}
+#ifdef LCD_TEXT_EFFECT_ENABLE
+	if (bpp == 1 && width <= EFFECT_MAX_WIDTH && LCD.Text_Effect != Text_EffectNone &&
+		Effect_Build(pData, cell_w, height, 0))
+	{
+		uint32_t win = 0xFFFFFFFFUL >> (32 - width);
+
+		for (uint16_t row = 0; row < height; row++, dst += stride) // 效果位图移位到窗口坐标
+		{
+			uint32_t fg = (src_x >= 0) ? Effect_Fg[row] >> src_x : Effect_Fg[row] << -src_x;
+			uint32_t edge = (src_x >= 0) ? Effect_Edge[row] >> src_x : Effect_Edge[row] << -src_x;
+
+			Effect_ExpandRow(dst, fg & win, edge & win, width);
+		}
+		return;
+	}
+#endif
+	for (uint16_t row = 0; row < height; row++, pData += bytes_per_row, dst += stride)
+	{
+#ifdef FLASH_FONT_AA_ENABLE
+		if (bpp > 1)
+		{
+			uint8_t level_mask = (uint8_t)((1 << bpp) - 1);
+			uint8_t scale = (bpp == 4) ? 1 : 5;
+
+			for (uint16_t col = 0; col < width; col++)
+			{
+				int16_t sx = src_x + (int16_t)col;
+				uint8_t level = 0;
+
+				if (sx >= 0 && sx < (int16_t)cell_w)
+				{
+					level = (pData[(sx * bpp) >> 3] >> ((sx * bpp) & 0x07)) & level_mask;
+				}
+				dst[col] = AA_Ramp[level * scale];
+			}
+			continue;
+		}
+#endif
+		uint8_t bits[8];
+
+		Glyph_ShiftRow(bits, pData, bytes_per_row, mask, src_x);
+		Expand_Row(dst, bits, width);
+	}
+}
+
+#ifdef FLASH_FONT_BOX_ENABLE
+/**
+ * @brief  查找字符键对应的汉字笔画外框
+ * @param  width 字模宽度，超出字模的外框视为无效
+ * @retval 外框指针，没有外框表或外框无效返回NULL
+ */
+static const FontGlyphBox_t *LCD_FindGlyphBox(uint32_t key, uint8_t font_size, uint16_t width)
+{
+	const FontGlyphBox_t *box;
+
+	if (LCD_TEXT_EFFECT() != Text_EffectNone)
+	{
+		return NULL; // 描边/阴影会画到外框之外
+	}
+	if (key & GLYPH_KEY_GBK)
+	{
+		const char gbk[2] = {(char)(key >> 8), (char)key};
+
+		box = GB2312_FindGlyphBox_Flash(gbk, font_size);
+	}
+	else
+	{
+		box = FlashFont_GetGlyphBox(key, font_size);
+	}
+	if (box == NULL || box->x + box->w > width || box->y + box->h > font_size)
+	{
+		return NULL;
+	}
+	return box;
+}
+
+/**
+ * @brief  只展开字模笔画外框内的像素
+ * @param  dst 外框左上角像素在目标缓冲区中的位置
+ * @param  width 字模宽度
+ * @param  stride 目标缓冲区每行像素数
+ * @param  packed 1表示pData为行程压缩字模
+ * @note   外框以上的行只取行地址，不展开
+ */
+static void LCD_ExpandGlyphBox(uint16_t *dst, const uint8_t *pData, uint16_t width, uint16_t height, uint16_t stride,
+							   uint8_t packed, const FontGlyphBox_t *box)
+{
+	uint16_t bytes_per_row = Glyph_RowBytes(width, packed);
+	uint64_t mask = (width >= 64) ? ~0ULL : (1ULL << width) - 1;
+	const uint8_t *tags;
+	const uint8_t *next = Glyph_RowBegin(pData, packed, height, &tags);
+	const uint8_t *src = Glyph_BlankRow;
+
+	if (!Expand_LUT_Valid)
+	{
+		Expand_BuildLUT();
+	}
+	for (uint16_t row = 0; row < box->y + box->h; row++)
+	{
+		src = Glyph_Row(&next, tags, src, row, bytes_per_row);
+		if (row >= box->y)
+		{
+			uint8_t bits[8];
+
+			Glyph_ShiftRow(bits, src, bytes_per_row, mask, (int8_t)box->x);
+			Expand_Row(dst, bits, box->w);
+			dst += stride;
+		}
+	}
+}
+
+/**
+ * @brief  按笔画外框绘制字模：外框四周用同色填充，只展开并发送外框内的像素
+ * @note   上下整行、左右两侧各一个窗口，由 LCD_WriteColor 直接发送背景色
+ */
+static void LCD_DrawGlyphBox(uint16_t x, uint16_t y, const uint8_t *pData, uint16_t width, uint16_t height,
+							 uint8_t packed, const FontGlyphBox_t *box)
+{
+	uint16_t bx = box->x, by = box->y, bw = box->w, bh = box->h;
+	uint16_t back = (uint16_t)LCD.BackColor;
+	uint16_t *pBuff;
+
+	if (bw == 0 || bh == 0) // 空白字模，整个单元都是背景
+	{
+		LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+		LCD_WriteColor(back, (uint32_t)width * height);
+		return;
+	}
+
+	pBuff = LCD_NextBuff(); // 先展开，与上一次DMA传输并行
+	LCD_ExpandGlyphBox(pBuff, pData, width, height, bw, packed, box);
+
+	if (by > 0)
+	{
+		LCD_SetAddress(x, y, x + width - 1, y + by - 1);
+		LCD_WriteColor(back, (uint32_t)width * by);
+	}
+	if (by + bh < height)
+	{
+		LCD_SetAddress(x, y + by + bh, x + width - 1, y + height - 1);
+		LCD_WriteColor(back, (uint32_t)width * (height - by - bh));
+	}
+	if (bx > 0)
+	{
+		LCD_SetAddress(x, y + by, x + bx - 1, y + by + bh - 1);
+		LCD_WriteColor(back, (uint32_t)bx * bh);
+	}
+	if (bx + bw < width)
+	{
+		LCD_SetAddress(x + bx + bw, y + by, x + width - 1, y + by + bh - 1);
+		LCD_WriteColor(back, (uint32_t)(width - bx - bw) * bh);
+	}
+	LCD_SetAddress(x + bx, y + by, x + bx + bw - 1, y + by + bh - 1);
+	LCD_WriteBuff(pBuff, (uint32_t)bw * bh);
+}
+#endif
+
+#ifdef LCD_PIXEL_CACHE_ENABLE
+// 已展开的RGB565字模缓存，键为(字符, 尺寸, 前景色, 背景色)
+typedef struct
+{
+	uint32_t key;		// 字符键(FlashFont_GlyphKey()，带字体族)，UTF8为码点，GB2312为 GLYPH_KEY_GBK|GBK码
+	uint32_t stamp;		// 最近使用时间戳，用于LRU淘汰
+	uint16_t color;		// 展开时的前景色
+	uint16_t back_color; // 展开时的背景色
+	uint16_t effect_color; // 展开时的描边/阴影颜色
+	uint8_t effect;		// 展开时的文本效果
+	uint8_t mono;		// 1：只含前景色和背景色(1bpp展开、无效果)，可按异或掩码得到反色字模
+	uint8_t width;		// 字模宽度，0表示空槽
+	uint8_t height;		// 字模高度
+} PixelCache_Tag_t;
+
+static PixelCache_Tag_t PixelCache_Tag[LCD_PIXEL_CACHE_SLOTS];
+#if (LCD_PIXEL_CACHE_SLOT_PIXELS * 2) % 32 != 0
+#error "LCD_PIXEL_CACHE_SLOT_PIXELS 必须是16的倍数(每槽占整数个Cache行)"
+#endif
+LCD_PIXEL_CACHE_ATTR static uint16_t PixelCache_Data[LCD_PIXEL_CACHE_SLOTS][LCD_PIXEL_CACHE_SLOT_PIXELS] DMA_ALIGNED;
+static uint32_t PixelCache_Clock = 0;  // LRU时间戳
+static uint32_t PixelCache_Hits = 0;   // 命中次数
+static uint32_t PixelCache_Misses = 0; // 未命中次数
+static uint16_t PixelCache_Limit = LCD_PIXEL_CACHE_SLOTS; // 运行时使用的槽数(LCD_PixelCache_SetLimit())
+static uint16_t PixelCache_Used = 0;   // 已填充的槽数
+static uint32_t PixelCache_MissPixels = 0; // 未命中时展开的像素数
+
+/**
+ * @brief  在像素缓存中查找字模，未命中时选出淘汰槽
+ * @param  victim 输出淘汰槽号(最久未使用或空槽)
+ * @retval 命中的槽号，未命中返回-1
+ * @note   槽数很少，线性比较即可
+ */
+static int16_t PixelCache_Find(uint32_t key, uint8_t width, uint8_t height, uint16_t *victim)
+{
+	uint16_t oldest = 0;
+
+	for (uint16_t i = 0; i < PixelCache_Limit; i++)
+	{
+		PixelCache_Tag_t *tag = &PixelCache_Tag[i];
+
+		if (tag->width == width && tag->height == height && tag->key == key &&
+			tag->color == (uint16_t)LCD.Color && tag->back_color == (uint16_t)LCD.BackColor &&
+			tag->effect == LCD_TEXT_EFFECT() && tag->effect_color == LCD.Effect_Color)
+		{
+			tag->stamp = ++PixelCache_Clock;
+			return (int16_t)i;
+		}
+		if (tag->stamp < PixelCache_Tag[oldest].stamp) // 空槽时间戳为0，优先使用
+		{
+			oldest = i;
+		}
+	}
+	*victim = oldest;
+	return -1;
+}
+
+/**
+ * @brief  查找前景色与背景色互换后展开的同一字模(菜单选中行反显)
+ * @retval 槽号，没有返回-1
+ * @note   两色字模中每个像素与 (画笔色 ^ 背景色) 异或即得到当前颜色的字模，不需要重新展开
+ */
+static int16_t PixelCache_FindInverse(uint32_t key, uint8_t width, uint8_t height)
+{
+	for (uint16_t i = 0; i < PixelCache_Limit; i++)
+	{
+		PixelCache_Tag_t *tag = &PixelCache_Tag[i];
+
+		if (tag->width == width && tag->height == height && tag->key == key && tag->mono &&
+			tag->color == (uint16_t)LCD.BackColor && tag->back_color == (uint16_t)LCD.Color &&
+			LCD_TEXT_EFFECT() == Text_EffectNone)
+		{
+			tag->stamp = ++PixelCache_Clock;
+			return (int16_t)i;
+		}
+	}
+	return -1;
+}
+#endif
+
+/**
+ * @brief  绘制字模到LCD(支持12/16/20/24/32)
+ * @param  width 显示宽度，ASCII按比例宽度排版时可与字模单元宽度(height/2)不同
+ * @param  key 字符键，用于RGB565像素缓存
+ * @param  src_x 显示区域第0列对应的字模单元列，等宽显示时为0
+ * @note   内部函数,用于Flash字库模式
+ * @note   启用像素缓存时，相同字符和颜色的字模直接从缓存发送，不再展开
+ * @note   像素缓存放不下的大字号(LCD_GLYPH_RUN_SIZE及以上)按同色段发送
+ * @note   字库带笔画外框表时，外框不超过字模一半的字(标点等)只展开外框
+ */
+ITCM_CODE static void DrawFont_Bitmap(uint16_t x, uint16_t y, uint16_t width,
+                                      uint16_t height, const uint8_t *pData,
+                                      uint32_t key, int8_t src_x) {
+  uint16_t *pBuff = NULL; // 展开目标
+  uint8_t packed = FlashFont_GlyphPacked(key, (uint8_t)height); // 字库中的压缩字号
+  const uint8_t *pAA = NULL; // 抗锯齿字模，字库中没有时为NULL
+  uint8_t bpp = 1;
+  uint16_t cell_w = (key < 0x80) ? height / 2 : width; // 字模单元宽度
+  uint8_t window = (src_x != 0 || width != cell_w);    // 按比例宽度截取
+
+  if (LCD.Text_Mode == Text_Transparent) {
+#if defined(FLASH_FONT_AA_ENABLE) && defined(LCD_CAPTURE_ENABLE)
+    if (LCD_FB_CAPTURE() && (pAA = LCD_FindGlyphAA(key, (uint8_t)height, &bpp)) != NULL) {
+      LCD_FB_BlendGlyph((int32_t)x - src_x, y, pAA, cell_w, height, bpp); // 底色就在内存中，可以抗锯齿
+      return;
+    }
+#endif
+    // 笔画都在显示区域内，按字模单元原点绘制即可
+    LCD_DrawGlyphSpans((uint16_t)(x - src_x), y, pData, cell_w, height, packed); // 不知道底色，只画1bpp笔画
+    return;
+  }
+#ifdef FLASH_FONT_AA_ENABLE
+  pAA = LCD_FindGlyphAA(key, (uint8_t)height, &bpp);
+#endif
+#ifdef FLASH_FONT_BOX_ENABLE
+  const FontGlyphBox_t *box = NULL; // 外框不超过字模一半时按外框绘制
+
+  if (pAA == NULL && !window) {
+    box = LCD_FindGlyphBox(key, (uint8_t)height, width);
+    if (box != NULL && (uint32_t)box->w * box->h * 2 > (uint32_t)width * height) {
+      box = NULL;
+    }
+  }
+#endif
+
+#ifdef LCD_PIXEL_CACHE_ENABLE
+  PixelCache_Tag_t *tag = NULL;
+  uint32_t ckey = key;
+
+  if (width * height <= LCD_PIXEL_CACHE_SLOT_PIXELS) {
+    uint16_t victim;
+    int16_t slot;
+
+    ckey = FlashFont_GlyphKey(key, (uint8_t)height); // 不同字体族的同一字符分开缓存
+    slot = PixelCache_Find(ckey, width, height, &victim);
+
+    if (slot >= 0) {
+      PixelCache_Hits++;
+      LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+      LCD_WriteBuff(PixelCache_Data[slot], width * height); // 直接发送已展开的像素
+      return;
+    }
+    if (pAA == NULL && (slot = PixelCache_FindInverse(ckey, width, height)) >= 0) {
+      const uint32_t *src = (const uint32_t *)PixelCache_Data[slot];
+      uint32_t *dst;
+      uint32_t mask = (uint32_t)(uint16_t)(LCD.Color ^ LCD.BackColor) * 0x00010001UL;
+
+      PixelCache_Hits++;
+      pBuff = LCD_NextBuff();
+      dst = (uint32_t *)pBuff;
+      for (uint32_t k = 0; k < ((uint32_t)width * height + 1) / 2; k++) {
+        dst[k] = src[k] ^ mask; // 反色：前景与背景互换，每次两个像素
+      }
+      LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+      LCD_WriteBuff(pBuff, width * height);
+      return;
+    }
+    PixelCache_Misses++;
+    PixelCache_MissPixels += width * height;
+
+#ifdef FLASH_FONT_BOX_ENABLE
+    if (box == NULL) // 按外框绘制的稀疏字模不占用缓存槽
+#endif
+    {
+      // 直接展开到淘汰槽中，发送后即成为缓存
+      tag = &PixelCache_Tag[victim];
+      if (tag->width == 0) {
+        PixelCache_Used++; // 空槽，下面一定会填充
+      }
+      tag->width = 0; // 展开完成前先作废
+      tag->stamp = 0;
+      pBuff = PixelCache_Data[victim];
+    }
+  }
+#else
+  (void)key;
+#endif
+
+#ifdef FLASH_FONT_BOX_ENABLE
+  if (box != NULL) {
+    LCD_DrawGlyphBox(x, y, pData, width, height, packed, box);
+    return;
+  }
+#endif
+
+#ifdef LCD_GLYPH_RUN_ENABLE
+  if (pBuff == NULL && pAA == NULL && !window && height >= LCD_GLYPH_RUN_SIZE &&
+      LCD_TEXT_EFFECT() == Text_EffectNone) {
+    LCD_DrawGlyphRuns(x, y, pData, width, height, packed);
+    return;
+  }
+#endif
+
+  // 先展开再设置坐标：上一个字模仍在DMA发送时，展开到另一个缓冲区可以与传输并行
+  if (pBuff == NULL) {
+    pBuff = LCD_NextBuff();
+  } else {
+    LCD_WaitBuff(pBuff);
+  }
+  PERF_TRACE_BEGIN(PERF_TRACE_EXPAND, width * height);
+  if (window) {
+    LCD_ExpandGlyphWindow(pBuff, (pAA != NULL) ? pAA : pData, cell_w, height,
+                          width, src_x, width, bpp);
+  }
+#ifdef FLASH_FONT_AA_ENABLE
+  else if (pAA != NULL) {
+    LCD_ExpandGlyphAA(pBuff, pAA, width, height, width, bpp);
+  }
+#endif
+  else {
+    LCD_ExpandGlyph(pBuff, pData, width, height, width, packed); // 查表展开，每次写入4个像素
+  }
+  PERF_TRACE_END(PERF_TRACE_EXPAND, 0);
+
+#ifdef LCD_PIXEL_CACHE_ENABLE
+  if (tag != NULL) {
+    tag->key = ckey;
+    tag->color = (uint16_t)LCD.Color;
+    tag->back_color = (uint16_t)LCD.BackColor;
+    tag->effect = LCD_TEXT_EFFECT();
+    tag->effect_color = LCD.Effect_Color;
+    tag->mono = (pAA == NULL && tag->effect == Text_EffectNone);
+    tag->width = (uint8_t)width;
+    tag->height = (uint8_t)height;
+    tag->stamp = ++PixelCache_Clock;
+  }
+#endif
+
+  // 设置显示区域 (根据实际宽高)，随后批量写入显存
+  LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+  LCD_WriteBuff(pBuff, width * height);
+}
+#endif
+
+#if defined(USE_FLASH_FONT) && defined(LCD_NUM_ATLAS_ENABLE)
+#define LCD_NUM_ATLAS_COUNT (sizeof(LCD_NUM_ATLAS_CHARS) - 1)						  // 收录的字符数
+#define LCD_NUM_ATLAS_CELL ((LCD_NUM_ATLAS_MAX_SIZE / 2) * LCD_NUM_ATLAS_MAX_SIZE) // 每个字符最多占用的像素数
+
+/**
+ * @brief  数字图集槽，一个字号和一组颜色
+ */
+typedef struct
+{
+	uint32_t family;	 // FlashFont_GlyphKey(0, 字号)，区分字体族
+	uint32_t stamp;		 // 最近使用时刻，0表示空槽
+	uint16_t color;		 // 展开时的前景色
+	uint16_t back_color; // 展开时的背景色
+	uint8_t font_size;	 // 字号
+} LCD_NumAtlas_Tag_t;
+
+static LCD_NumAtlas_Tag_t LCD_NumAtlas_Tag[LCD_NUM_ATLAS_SLOTS];
+DTCM_BSS static uint16_t LCD_NumAtlas_Data[LCD_NUM_ATLAS_SLOTS][LCD_NUM_ATLAS_COUNT * LCD_NUM_ATLAS_CELL]; // 每个字符按 字号/2 x 字号 连续存放
+static uint8_t LCD_NumAtlas_Map[0x80]; // ASCII到图集序号+1，0表示不收录
+static uint32_t LCD_NumAtlas_Clock = 0;
+static uint8_t LCD_NumAtlas_Limit = LCD_NUM_ATLAS_SLOTS; // 运行时使用的槽数(LCD_NumAtlas_SetLimit())
+static uint32_t LCD_NumAtlas_Hits = 0;					  // 命中次数
+static uint32_t LCD_NumAtlas_Misses = 0;				  // 重新展开的次数
+
+/**
+ * @brief  取得当前字号和颜色的图集，没有时把全部字符展开到最久未用的槽
+ * @retval 图集首地址，字库缺字时返回NULL
+ */
+static const uint16_t *LCD_NumAtlas_Get(uint8_t font_size)
+{
+	uint32_t family = FlashFont_GlyphKey(0, font_size);
+	uint16_t color = (uint16_t)LCD.Color, back = (uint16_t)LCD.BackColor;
+	uint16_t w = font_size / 2;
+	LCD_NumAtlas_Tag_t *tag = &LCD_NumAtlas_Tag[0];
+	uint16_t *dst;
+
+	for (uint8_t i = 0; i < LCD_NumAtlas_Limit; i++)
+	{
+		LCD_NumAtlas_Tag_t *t = &LCD_NumAtlas_Tag[i];
+
+		if (t->stamp != 0 && t->font_size == font_size && t->color == color && t->back_color == back &&
+			t->family == family)
+		{
+			t->stamp = ++LCD_NumAtlas_Clock;
+			LCD_NumAtlas_Hits++;
+			return LCD_NumAtlas_Data[i];
+		}
+		if (t->stamp < tag->stamp)
+			tag = t;
+	}
+
+	LCD_NumAtlas_Misses++;
+	tag->stamp = 0; // 展开完成前先作废
+	dst = LCD_NumAtlas_Data[tag - LCD_NumAtlas_Tag];
+	for (uint8_t k = 0; k < LCD_NUM_ATLAS_COUNT; k++, dst += w * font_size)
+	{
+		uint8_t c = (uint8_t)LCD_NUM_ATLAS_CHARS[k];
+		const uint8_t *pData = FlashFont_GetGlyphCP(c, font_size);
+
+		if (pData == NULL)
+			return NULL; // 缺字时逐字绘制，显示与原来相同
+#ifdef FLASH_FONT_AA_ENABLE
+		uint8_t bpp = 1;
+		const uint8_t *pAA = LCD_FindGlyphAA(c, font_size, &bpp);
+
+		if (pAA != NULL)
+		{
+			LCD_ExpandGlyphAA(dst, pAA, w, font_size, w, bpp);
+			continue;
+		}
+#endif
+		LCD_ExpandGlyph(dst, pData, w, font_size, w, FlashFont_GlyphPacked(c, font_size));
+	}
+	tag->family = family;
+	tag->color = color;
+	tag->back_color = back;
+	tag->font_size = font_size;
+	tag->stamp = ++LCD_NumAtlas_Clock;
+	return LCD_NumAtlas_Data[tag - LCD_NumAtlas_Tag];
+}
+
+/**
+ * @brief  数字串从图集整串发送：只设置一次窗口，按行从图集拷贝到渲染缓冲区，拷贝与DMA传输交替进行
+ * @param  text 1：按 LCD_DisplayText() 排版，字宽表给出的宽度不是半角时放弃
+ * @retval 1-已绘制，0-不满足条件(含图集外的字符、透明/效果/放大、超出屏幕宽度)，由调用者照常绘制
+ * @note   不透明模式下与逐字展开的像素完全相同
+ */
+static uint8_t LCD_NumAtlas_Draw(uint16_t x, uint16_t y, const char *p, uint8_t text)
+{
+	uint8_t font_size = LCD_GetChineseFontSize();
+	uint16_t w = font_size / 2, n, total, rows;
+	uint8_t index[LCD_PRINTF_BYTES]; // 每个字符在图集中的序号
+	const uint16_t *atlas;
+
+	if (font_size > LCD_NUM_ATLAS_MAX_SIZE || LCD.Text_Mode == Text_Transparent ||
+		LCD_TEXT_EFFECT() != Text_EffectNone || LCD_ASCII_SCALE != 1)
+		return 0;
+	if (LCD_NumAtlas_Map[(uint8_t)LCD_NUM_ATLAS_CHARS[0]] == 0)
+	{
+		for (uint8_t k = 0; k < LCD_NUM_ATLAS_COUNT; k++)
+			LCD_NumAtlas_Map[(uint8_t)LCD_NUM_ATLAS_CHARS[k]] = k + 1;
+	}
+
+	for (n = 0; p[n] != 0; n++)
+	{
+		uint8_t c = (uint8_t)p[n];
+
+		if (n >= sizeof(index) || c >= 0x80 || LCD_NumAtlas_Map[c] == 0)
+			return 0;
+#ifndef IS_GB2312
+		int8_t src_x;
+
+		if (text && (LCD_TextAdvance(c, p + n + 1, font_size, &src_x) != w || src_x != 0))
+			return 0; // 比例宽度或字偶距，按 LCD_DisplayText() 排版
+#else
+		(void)text;
+#endif
+		index[n] = LCD_NumAtlas_Map[c] - 1;
+	}
+	total = n * w;
+	if (n == 0 || x + total > LCD.Width || (rows = LCD_BUFF_PIXELS / total) == 0)
+		return 0;
+	if ((atlas = LCD_NumAtlas_Get(font_size)) == NULL)
+		return 0;
+
+	LCD_SetAddress(x, y, x + total - 1, y + font_size - 1);
+	for (uint16_t r = 0; r < font_size; r += rows)
+	{
+		uint16_t m = (font_size - r < rows) ? font_size - r : rows;
+		uint16_t *pBuff = LCD_NextBuff();
+		uint16_t *dst = pBuff;
+
+		for (uint16_t k = r; k < r + m; k++)
+		{
+			for (uint16_t i = 0; i < n; i++, dst += w)
+				memcpy(dst, atlas + ((uint32_t)index[i] * font_size + k) * w, w * 2);
+		}
+		LCD_WriteBuff(pBuff, m * total);
+	}
+	return 1;
+}
+#endif
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_NumAtlas_Invalidate
+ *
+ *	函数功能:	作废数字图集，下次显示数字时重新展开
+ *
+ *	说    明:	1. 图集按字号、颜色和字体族匹配，改颜色或字号不需要调用；更换字库内容(FlashFont_Init)后调用
+ *					2. 未定义 LCD_NUM_ATLAS_ENABLE 或不使用Flash字库时为空函数
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_NumAtlas_Invalidate(void)
+{
+#if defined(USE_FLASH_FONT) && defined(LCD_NUM_ATLAS_ENABLE)
+	for (uint8_t i = 0; i < LCD_NUM_ATLAS_SLOTS; i++)
+		LCD_NumAtlas_Tag[i].stamp = 0;
+#endif
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_NumAtlas_SetLimit
+ *
+ *	入口参数:	slots - 槽数，0或超过 LCD_NUM_ATLAS_SLOTS 时为 LCD_NUM_ATLAS_SLOTS
+ *
+ *	返 回 值:	生效的槽数，未启用数字图集时为0
+ *
+ *	函数功能:	限制数字图集运行时使用的槽数
+ *
+ *	说    明:	图集随即作废，之后只在前 slots 个槽中按最久未使用替换；存储区仍按 LCD_NUM_ATLAS_SLOTS 静态分配
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_NumAtlas_SetLimit(uint8_t slots)
+{
+#if defined(USE_FLASH_FONT) && defined(LCD_NUM_ATLAS_ENABLE)
+	if (slots == 0 || slots > LCD_NUM_ATLAS_SLOTS)
+		slots = LCD_NUM_ATLAS_SLOTS;
+	LCD_NumAtlas_Invalidate();
+	LCD_NumAtlas_Limit = slots;
+	return slots;
+#else
+	(void)slots;
+	return 0;
+#endif
+}
+
+#if defined(PERF_MEMORY_ENABLE) && defined(USE_FLASH_FONT) && defined(LCD_NUM_ATLAS_ENABLE)
+/**
+ * @brief  填写数字图集的内存占用
+ * @param  entry 输出
+ */
+void LCD_NumAtlas_GetMemory(PerfMemory_Entry_t *entry)
+{
+	uint32_t used = 0;
+
+	for (uint8_t i = 0; i < LCD_NumAtlas_Limit; i++)
+	{
+		if (LCD_NumAtlas_Tag[i].stamp != 0)
+			used++;
+	}
+	entry->name = "atlas";
+	entry->unit = "slot";
+	entry->base = LCD_NumAtlas_Data;
+	entry->bytes = sizeof(LCD_NumAtlas_Data) + sizeof(LCD_NumAtlas_Tag) + sizeof(LCD_NumAtlas_Map);
+	entry->capacity = LCD_NUM_ATLAS_SLOTS;
+	entry->limit = LCD_NumAtlas_Limit;
+	entry->used = used;
+	entry->peak = used; // 展开过的槽一直保留到作废
+	entry->hits = LCD_NumAtlas_Hits;
+	entry->misses = LCD_NumAtlas_Misses;
+	entry->resizable = 1;
+}
+#endif
+
+// LCD_DisplayRichText() 正在绘制的样式表，NULL表示按当前颜色绘制
+static const LCD_RichText_t *Text_Rich = NULL;
+static uint8_t Text_RichNext = 0; // 下一段尚未生效的样式
+
+/**
+ * @brief  绘制 p 处的字符之前，让起点不超过它的样式段生效
+ * @note   只改画笔色和背景色，展开表在下一次展开时重建；颜色不变的段不触发重建
+ */
+static inline void LCD_Text_Style(const char *p)
+{
+	if (Text_Rich == NULL)
+	{
+		return;
+	}
+	while (Text_RichNext < Text_Rich->Count &&
+		   Text_Rich->Styles[Text_RichNext].Start <= (uint32_t)(p - Text_Rich->Text))
+	{
+		const LCD_TextStyle_t *style = &Text_Rich->Styles[Text_RichNext++];
+		uint16_t color = LCD_ToRGB565(style->Color);
+		uint16_t back = LCD_ToRGB565(style->BackColor);
+
+		if (color != LCD.Color || back != LCD.BackColor)
+		{
+			LCD.Color = color;
+			LCD.BackColor = back;
+			Expand_LUT_Valid = 0;
+		}
+	}
+}
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+/**
+ * @brief  码点按当前文本编码的字节数，缓存的解析结果据此跳过原字符串，不再解码
+ */
+static inline uint8_t LCD_Text_Bytes(uint32_t cp)
+{
+	if (cp < 0x80)
+	{
+		return 1;
+	}
+	if (LCD_TEXT_ENCODING() == Text_GBK)
+	{
+		return 2;
+	}
+	return (cp < 0x800) ? 2 : 3; // 缓存只收录BMP内的字符
+}
+#endif
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312) && defined(LCD_TEXT_STRIP_ENABLE)
+LCD_STRIP_ATTR static uint16_t LCD_Strip[LCD_STRIP_PIXELS] DMA_ALIGNED; // 文本行缓冲区，宽度x字号
+
+/**
+ * @brief  把行缓冲区中的一块矩形填充为背景色
+ * @param  stride 行缓冲区每行像素数
+ */
+static void LCD_FillBackPixels(uint16_t *dst, uint16_t stride, uint16_t width, uint16_t height)
+{
+	for (uint16_t row = 0; row < height; row++, dst += stride)
+	{
+		for (uint16_t k = 0; k < width; k++)
+		{
+			dst[k] = LCD.BackColor;
+		}
+	}
+}
+
+/**
+ * @brief  把一行文本的字模合成到行缓冲区，再用一个窗口一次发送
+ * @param  pText 行首字符(UTF-8)
+ * @param  count 本行字符数
+ * @param  line_width 本行总宽度(像素)，即行缓冲区每行的像素数
+ * @param  refs 各字符的解析结果(LCD_TextMemo_Draw())，NULL时解码 pText 并批量查找
+ * @retval 本行消耗的字节数，字库不可用时返回0
+ * @note   ASCII(半宽或字宽表给出的比例宽度)与中文(全宽)字模混排在同一行缓冲区中，字库中缺失的字符填充背景色
+ */
+static uint16_t DrawText_Strip(uint16_t x, uint16_t y, const char *pText, uint16_t count,
+							   uint16_t line_width, uint8_t font_size, const FontGlyphRef_t *refs)
+{
+	const uint8_t *glyphs[LCD_TEXT_BATCH];
+	const char *p = pText;
+	uint16_t col = 0; // 当前字符在行缓冲区中的起始列
+
+	LCD_WaitBuff(LCD_Strip); // 上一行可能仍在发送
+
+	while (count > 0)
+	{
+		uint16_t n = (count < LCD_TEXT_BATCH) ? count : LCD_TEXT_BATCH;
+
+		if (refs == NULL)
+		{
+			n = FlashFont_ResolveString(p, font_size, glyphs, n);
+		}
+		if (n == 0)
+		{
+			return 0; // 字库未初始化或字体大小无效
+		}
+		PERF_TRACE_BEGIN(PERF_TRACE_EXPAND, n);
+		for (uint16_t i = 0; i < n; i++)
+		{
+			uint32_t cp;
+			uint8_t width, cell_w;
+			int8_t src_x;
+
+			LCD_Text_Style(p); // 富文本在行缓冲区中换色，不打断整行发送
+			if (refs != NULL) // 已解析过，只按偏移取字模
+			{
+				cp = refs->cp;
+				width = refs->advance;
+				src_x = refs->x;
+				glyphs[i] = FlashFont_GetGlyphRef(refs++, font_size);
+				p += LCD_Text_Bytes(cp);
+			}
+			else
+			{
+				p += FlashFont_DecodeText((const uint8_t *)p, &cp);
+				width = LCD_TextAdvance(cp, p, font_size, &src_x);
+			}
+			cell_w = (cp < 0x80) ? font_size / 2 : font_size;
+
+			if (LCD.Text_Mode == Text_Transparent) // 透明模式不能整行覆盖，逐字只画笔画
+			{
+#if defined(FLASH_FONT_AA_ENABLE) && defined(LCD_CAPTURE_ENABLE)
+				uint8_t bpp;
+				const uint8_t *pAA = LCD_FB_CAPTURE() ? LCD_FindGlyphAA(cp, font_size, &bpp) : NULL;
+
+				if (pAA != NULL) // 底色就在内存中，可以抗锯齿
+				{
+					LCD_FB_BlendGlyph((int32_t)x + col - src_x, y, pAA, cell_w, font_size, bpp);
+				}
+				else
+#endif
+				if (glyphs[i] != NULL) // 笔画都在显示宽度内，按字模单元原点绘制
+				{
+					LCD_DrawGlyphSpans((uint16_t)(x + col - src_x), y, glyphs[i], cell_w, font_size,
+									   FlashFont_GlyphPacked(cp, font_size));
+				}
+			}
+			else if (glyphs[i] != NULL)
+			{
+				uint8_t bpp = 1;
+				const uint8_t *pAA = NULL;
+
+#ifdef FLASH_FONT_AA_ENABLE
+				pAA = LCD_FindGlyphAA(cp, font_size, &bpp);
+#endif
+#ifdef FLASH_FONT_BOX_ENABLE
+				const FontGlyphBox_t *box = (pAA == NULL) ? LCD_FindGlyphBox(cp, font_size, width) : NULL;
+#endif
+				if (src_x != 0 || width != cell_w) // 比例宽度：截取字模单元的一部分
+				{
+					LCD_ExpandGlyphWindow(LCD_Strip + col, (pAA != NULL) ? pAA : glyphs[i], cell_w, font_size,
+										  line_width, src_x, width, bpp);
+				}
+#ifdef FLASH_FONT_BOX_ENABLE
+				else if (box != NULL) // 外框四周直接填背景色，只展开外框内的像素
+				{
+					uint16_t *cell = LCD_Strip + col;
+					uint16_t right = width - box->x - box->w;
+
+					LCD_FillBackPixels(cell, line_width, width, box->y);
+					LCD_FillBackPixels(cell + (box->y + box->h) * line_width, line_width, width,
+								   font_size - box->y - box->h);
+					LCD_FillBackPixels(cell + box->y * line_width, line_width, box->x, box->h);
+					LCD_FillBackPixels(cell + box->y * line_width + box->x + box->w, line_width, right, box->h);
+					if (box->w > 0 && box->h > 0)
+					{
+						LCD_ExpandGlyphBox(cell + box->y * line_width + box->x, glyphs[i], width, font_size,
+										   line_width, FlashFont_GlyphPacked(cp, font_size), box);
+					}
+				}
+#endif
+#ifdef FLASH_FONT_AA_ENABLE
+				else if (pAA != NULL)
+				{
+					LCD_ExpandGlyphAA(LCD_Strip + col, pAA, width, font_size, line_width, bpp);
+				}
+#endif
+				else
+				{
+					LCD_ExpandGlyph(LCD_Strip + col, glyphs[i], width, font_size, line_width,
+									FlashFont_GlyphPacked(cp, font_size));
+				}
+			}
+			else
+			{
+				LCD_FillBackPixels(LCD_Strip + col, line_width, width, font_size); // 缺字留空
+			}
+			col += width;
+		}
+		PERF_TRACE_END(PERF_TRACE_EXPAND, 0);
+		count -= n;
+	}
+
+	if (LCD.Text_Mode != Text_Transparent)
+	{
+		LCD_SetAddress(x, y, x + line_width - 1, y + font_size - 1); // 整行只设置一次窗口
+		LCD_WriteBuff(LCD_Strip, line_width * font_size);
+	}
+	return (uint16_t)(p - pText);
+}
+
+/**
+ * @brief  把一列竖排文本的字模合成到行缓冲区，再用一个窗口一次发送
+ * @param  pText 列首字符(UTF-8)
+ * @param  count 本列字符数，count*font_size*font_size 不超过 LCD_STRIP_PIXELS
+ * @retval 本列消耗的字节数，字库不可用时返回0
+ * @note   列宽为字号，每个字符占 font_size 行：各字的像素在缓冲区中首尾相接，直接按
+ *         字模单元宽度展开即可；ASCII保持直立，在列中水平居中
+ */
+static uint16_t DrawText_Column(uint16_t x, uint16_t y, const char *pText, uint16_t count, uint8_t font_size)
+{
+	const uint8_t *glyphs[LCD_TEXT_BATCH];
+	const char *p = pText;
+	uint16_t *cell = LCD_Strip; // 当前字符在缓冲区中的起始像素
+	uint16_t top = y;			// 当前字符的上边界
+
+	LCD_WaitBuff(LCD_Strip); // 上一列可能仍在发送
+
+	while (count > 0)
+	{
+		uint16_t n = FlashFont_ResolveString(p, font_size, glyphs, (count < LCD_TEXT_BATCH) ? count : LCD_TEXT_BATCH);
+
+		if (n == 0)
+		{
+			return 0; // 字库未初始化或字体大小无效
+		}
+		PERF_TRACE_BEGIN(PERF_TRACE_EXPAND, n);
+		for (uint16_t i = 0; i < n; i++, cell += font_size * font_size, top += font_size)
+		{
+			uint32_t cp;
+			uint8_t cell_w;
+			int8_t pad;
+
+			p += FlashFont_DecodeText((const uint8_t *)p, &cp);
+			cell_w = (cp < 0x80) ? font_size / 2 : font_size;
+			pad = (int8_t)((font_size - cell_w) / 2); // ASCII左右留白
+
+			if (glyphs[i] == NULL)
+			{
+				if (LCD.Text_Mode != Text_Transparent)
+				{
+					LCD_FillBackPixels(cell, font_size, font_size, font_size); // 缺字留空
+				}
+				continue;
+			}
+			if (LCD.Text_Mode == Text_Transparent) // 透明模式不能整列覆盖，逐字只画笔画
+			{
+				LCD_DrawGlyphSpans(x + pad, top, glyphs[i], cell_w, font_size, FlashFont_GlyphPacked(cp, font_size));
+				continue;
+			}
+
+			uint8_t bpp = 1;
+			const uint8_t *pAA = NULL;
+
+#ifdef FLASH_FONT_AA_ENABLE
+			pAA = LCD_FindGlyphAA(cp, font_size, &bpp);
+#endif
+			if (pad != 0)
+			{
+				LCD_ExpandGlyphWindow(cell, (pAA != NULL) ? pAA : glyphs[i], cell_w, font_size, font_size, -pad,
+									  font_size, bpp);
+			}
+#ifdef FLASH_FONT_AA_ENABLE
+			else if (pAA != NULL)
+			{
+				LCD_ExpandGlyphAA(cell, pAA, font_size, font_size, font_size, bpp);
+			}
+#endif
+			else
+			{
+				LCD_ExpandGlyph(cell, glyphs[i], font_size, font_size, font_size, FlashFont_GlyphPacked(cp, font_size));
+			}
+		}
+		PERF_TRACE_END(PERF_TRACE_EXPAND, 0);
+		count -= n;
+	}
+
+	if (LCD.Text_Mode != Text_Transparent)
+	{
+		LCD_SetAddress(x, y, x + font_size - 1, top - 1); // 整列只设置一次窗口
+		LCD_WriteBuff(LCD_Strip, (uint16_t)(cell - LCD_Strip));
+	}
+	return (uint16_t)(p - pText);
+}
+#endif
+
+/**
+ * @brief  读取RGB565像素缓存的命中统计
+ * @param  hits 输出命中次数，可为NULL
+ * @param  misses 输出未命中次数，可为NULL
+ */
+void LCD_PixelCache_GetStats(uint32_t *hits, uint32_t *misses)
+{
+#if defined(USE_FLASH_FONT) && defined(LCD_PIXEL_CACHE_ENABLE)
+	if (hits != NULL)
+		*hits = PixelCache_Hits;
+	if (misses != NULL)
+		*misses = PixelCache_Misses;
+#else
+	if (hits != NULL)
+		*hits = 0;
+	if (misses != NULL)
+		*misses = 0;
+#endif
+}
+
+/**
+ * @brief  限制RGB565像素缓存运行时使用的槽数
+ * @param  slots 槽数，0或超过 LCD_PIXEL_CACHE_SLOTS 时为 LCD_PIXEL_CACHE_SLOTS
+ * @retval 生效的槽数，未启用像素缓存时为0
+ */
+uint16_t LCD_PixelCache_SetLimit(uint16_t slots)
+{
+#if defined(USE_FLASH_FONT) && defined(LCD_PIXEL_CACHE_ENABLE)
+	if (slots == 0 || slots > LCD_PIXEL_CACHE_SLOTS)
+		slots = LCD_PIXEL_CACHE_SLOTS;
+	for (uint16_t i = slots; i < LCD_PIXEL_CACHE_SLOTS; i++) // 只从前 slots 个槽中查找和淘汰，后面的作废
+	{
+		if (PixelCache_Tag[i].width != 0)
+			PixelCache_Used--;
+		memset(&PixelCache_Tag[i], 0, sizeof(PixelCache_Tag[i]));
+	}
+	PixelCache_Limit = slots;
+	return slots;
+#else
+	(void)slots;
+	return 0;
+#endif
+}
+
+#if defined(PERF_MEMORY_ENABLE) && defined(USE_FLASH_FONT) && defined(LCD_PIXEL_CACHE_ENABLE)
+/**
+ * @brief  填写RGB565像素缓存的内存占用
+ * @param  entry 输出
+ */
+void LCD_PixelCache_GetMemory(PerfMemory_Entry_t *entry)
+{
+	entry->name = "pixel";
+	entry->unit = "slot";
+	entry->base = PixelCache_Data;
+	entry->bytes = sizeof(PixelCache_Data) + sizeof(PixelCache_Tag);
+	entry->capacity = LCD_PIXEL_CACHE_SLOTS;
+	entry->limit = PixelCache_Limit;
+	entry->used = PixelCache_Used;
+	entry->peak = PixelCache_Used; // 槽只在清空时回收，已填充槽数即为峰值
+	entry->hits = PixelCache_Hits;
+	entry->misses = PixelCache_Misses;
+	entry->resizable = 1;
+}
+#endif
+
+#ifdef LCD_CACHE_BALANCE_ENABLE
+#if !defined(USE_FLASH_FONT) || !defined(LCD_PIXEL_CACHE_ENABLE) || !defined(GLYPH_CACHE_ENABLE)
+#error "LCD_CACHE_BALANCE_ENABLE 需要Flash字库、LCD_PIXEL_CACHE_ENABLE 和 GLYPH_CACHE_ENABLE"
+#endif
+#define LCD_BALANCE_GLYPH_BYTES ((uint32_t)GLYPH_CACHE_SLOT_BYTES)		  // 字模缓存每槽字节数
+#define LCD_BALANCE_PIXEL_BYTES ((uint32_t)LCD_PIXEL_CACHE_SLOT_PIXELS * 2U) // 像素缓存每槽字节数
+#define LCD_BALANCE_STEP (LCD_BALANCE_PIXEL_BYTES / LCD_BALANCE_GLYPH_BYTES > 0 ? LCD_BALANCE_PIXEL_BYTES / LCD_BALANCE_GLYPH_BYTES : 1U) // 一个像素缓存槽折合的字模缓存槽数
+
+static LCD_CacheBalanceStats_t LCD_Balance = {0};
+static GlyphCache_Stats_t LCD_Balance_Glyph; // 上一周期结束时的字模缓存统计
+static uint32_t LCD_Balance_Pixels = 0;		 // 上一周期结束时的 PixelCache_MissPixels
+static uint8_t LCD_Balance_Ready = 0;		 // 已设置过预算
+
+/**
+ * @brief  按预算设置两个缓存的槽数，字模缓存用剩下的字节
+ */
+static void LCD_Balance_Apply(uint16_t pixel)
+{
+	uint32_t rest = LCD_Balance.Budget - (uint32_t)pixel * LCD_BALANCE_PIXEL_BYTES;
+	uint32_t glyph = rest / LCD_BALANCE_GLYPH_BYTES;
+
+	LCD_Balance.PixelSlots = LCD_PixelCache_SetLimit(pixel);
+	LCD_Balance.GlyphSlots = GlyphCache_SetLimit((uint16_t)((glyph < GLYPH_CACHE_SLOTS) ? glyph : GLYPH_CACHE_SLOTS));
+}
+
+/**
+ * @brief  像素缓存槽数的允许范围：至少1槽，字模缓存至少留一次预取的槽数
+ */
+static uint16_t LCD_Balance_MaxPixel(void)
+{
+	uint32_t glyph_min = 1;
+	uint32_t n;
+
+#ifdef GLYPH_PREFETCH_ENABLE
+	glyph_min = GLYPH_PREFETCH_MAX;
+#endif
+	if (LCD_Balance.Budget <= glyph_min * LCD_BALANCE_GLYPH_BYTES + LCD_BALANCE_PIXEL_BYTES)
+		return 1;
+	n = (LCD_Balance.Budget - glyph_min * LCD_BALANCE_GLYPH_BYTES) / LCD_BALANCE_PIXEL_BYTES;
+	return (uint16_t)((n < LCD_PIXEL_CACHE_SLOTS) ? n : LCD_PIXEL_CACHE_SLOTS);
+}
+
+uint32_t LCD_CacheBalance_SetBudget(uint32_t bytes)
+{
+	uint32_t full = (uint32_t)GLYPH_CACHE_SLOTS * LCD_BALANCE_GLYPH_BYTES + (uint32_t)LCD_PIXEL_CACHE_SLOTS * LCD_BALANCE_PIXEL_BYTES;
+	uint16_t pixel;
+
+	LCD_Balance_Ready = 1;
+	GlyphCache_GetStats(&LCD_Balance_Glyph);
+	LCD_Balance_Pixels = PixelCache_MissPixels;
+	if (bytes == 0 || bytes >= full)
+	{
+		LCD_Balance.Budget = 0; // 都能放下，不需要调整
+		LCD_Balance.PixelSlots = LCD_PixelCache_SetLimit(0);
+		LCD_Balance.GlyphSlots = GlyphCache_SetLimit(0);
+		return (bytes == 0) ? 0 : full;
+	}
+	LCD_Balance.Budget = bytes;
+	pixel = (uint16_t)(bytes / 2U / LCD_BALANCE_PIXEL_BYTES);
+	if (pixel == 0)
+		pixel = 1;
+	if (pixel > LCD_Balance_MaxPixel())
+		pixel = LCD_Balance_MaxPixel();
+	LCD_Balance_Apply(pixel);
+	return bytes;
+}
+
+void LCD_CacheBalance_Task(void)
+{
+	GlyphCache_Stats_t g;
+	uint32_t pixels = PixelCache_MissPixels;
+	uint8_t glyph_full, pixel_full;
+
+	if (!LCD_Balance_Ready)
+	{
+		LCD_CacheBalance_SetBudget(LCD_CACHE_BALANCE_BYTES); // 第一次调用时按默认预算分配
+		return;
+	}
+	if (LCD_Balance.Budget == 0)
+		return;
+
+	GlyphCache_GetStats(&g);
+	LCD_Balance.GlyphCost = (g.fill_bytes - LCD_Balance_Glyph.fill_bytes) * LCD_CACHE_QSPI_CYCLES;
+	LCD_Balance.PixelCost = (pixels - LCD_Balance_Pixels) * LCD_CACHE_EXPAND_CYCLES;
+	glyph_full = (g.evictions != LCD_Balance_Glyph.evictions); // 本周期有淘汰，增加槽数才有用
+	pixel_full = (PixelCache_Used >= PixelCache_Limit);
+	LCD_Balance_Glyph = g;
+	LCD_Balance_Pixels = pixels;
+
+	// 代价高出1/4以上才移动，避免两个缓存来回清空
+	if (pixel_full && LCD_Balance.PixelCost > LCD_Balance.GlyphCost + LCD_Balance.GlyphCost / 4U &&
+		LCD_Balance.PixelSlots < LCD_Balance_MaxPixel())
+	{
+		LCD_Balance_Apply(LCD_Balance.PixelSlots + 1);
+		LCD_Balance.Moves++;
+	}
+	else if (glyph_full && LCD_Balance.GlyphCost > LCD_Balance.PixelCost + LCD_Balance.PixelCost / 4U &&
+			 LCD_Balance.PixelSlots > 1 && LCD_Balance.GlyphSlots + LCD_BALANCE_STEP <= GLYPH_CACHE_SLOTS)
+	{
+		LCD_Balance_Apply(LCD_Balance.PixelSlots - 1);
+		LCD_Balance.Moves++;
+	}
+}
+
+void LCD_CacheBalance_GetStats(LCD_CacheBalanceStats_t *stats)
+{
+	if (stats != NULL)
+		*stats = LCD_Balance;
+}
+#endif
+#ifndef USE_FLASH_FONT
+/**
+ * @brief  在内置中文字模表中查找字符
+ * @note   有键表时二分查找(相同编码取第一个，与顺序查找一致)，并核对字模之后的编码行；
+ *         没有键表或键表过期(追加字模后未重新运行 Tools/fontsort.py)时顺序查找
+ * @retval 字模所在的行号，字模列表中无相应的汉字时返回0(显示第一个字模)
+ */
+static uint16_t LCD_FindChinese(const pFONT *font, const char *pText)
+{
+	uint16_t code = ((uint16_t)(uint8_t)pText[0] << 8) | (uint8_t)pText[1];
+	const uint8_t *row;
+
+	if (font->pKeys != NULL)
+	{
+		uint16_t lo = 0, hi = font->Keys;
+
+		while (lo < hi)
+		{
+			uint16_t mid = (lo + hi) / 2;
+			if (font->pKeys[mid] < code)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo < font->Keys && font->pKeys[lo] == code && lo * 2U + 1 < font->Table_Rows)
+		{
+			row = font->pTable + (lo * 2U + 1) * font->Sizes;
+			if (row[0] == (uint8_t)pText[0] && row[1] == (uint8_t)pText[1])
+				return lo * 2U;
+		}
+	}
+
+	for (uint16_t i = 0; i + 1U < font->Table_Rows; i += 2) // 每个汉字占字模、编码两行
+	{
+		// 对比数组中的汉字编码，用以定位该汉字字模的地址
+		row = font->pTable + (i + 1) * font->Sizes;
+		if (row[0] == (uint8_t)pText[0] && row[1] == (uint8_t)pText[1])
+			return i;
+	}
+	return 0;
+}
+#endif
+
+/******************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayChinese
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					pText - 中文字符
+ *
+ *	函数功能:	在指定坐标显示指定的单个中文字符
+ *
+ *	说    明:	1. 可设置要显示的字体，例如使用 LCD_SetTextFont(&CH_Font24) 设置为 2424的中文字体以及2412的ASCII字符字体
+ *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0xff0000FF) 设置为蓝色
+ *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0xff000000) 设置为黑色的背景色
+ *					4. 使用示例 LCD_DisplayChinese( 10, 10, "好") ，在坐标(10,10)显示中文字符"好"
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayChinese(uint16_t x, uint16_t y, char *pText)
+{
+	if (LCD_TILE_RECORD(LCD_OP_DisplayChinese, x, y, 0, 0, pText, 4))
+		return; // 录制到显示列表，只保存第一个字符
+
+#ifdef USE_FLASH_FONT
+  uint8_t font_size = LCD_GetChineseFontSize();
+
+#ifdef IS_GB2312
+        uint32_t key = GLYPH_KEY_GBK | ((uint8_t)pText[0] << 8) | (uint8_t)pText[1];
+        // 使用查找表获得的索引计算最终地址
+        const uint8_t *pFontData = GB2312_FindFont_Flash(pText, font_size);
+
+        if (pFontData == NULL)
+          pFontData = FlashFont_FallbackCP(FLASH_FONT_INVALID_CP, font_size); // 缺字显示替换字符或方框
+#else
+        uint32_t key;
+
+        FlashFont_DecodeText((const uint8_t *)pText, &key);
+        const uint8_t *pFontData = FlashFont_GetGlyphCP(key, font_size);
+#endif
+        if (pFontData != NULL) {
+          DrawFont_Bitmap(x, y, font_size, font_size, pFontData, key, 0);
+        }
+
+#else
+	uint16_t addr = LCD_FindChinese(LCD_CHFonts, pText); // 字模地址
+	uint16_t *pBuff;									 // 渲染缓冲区
+
+	if (LCD.Text_Mode == Text_Transparent)
+	{
+		LCD_DrawGlyphSpans(x, y, LCD_CHFonts->pTable + addr * LCD_CHFonts->Sizes, LCD_CHFonts->Width, LCD_CHFonts->Height, 0);
+		return;
+	}
+	pBuff = LCD_NextBuff(); // 取得空闲的缓冲区
+	LCD_ExpandGlyph(pBuff, LCD_CHFonts->pTable + addr * LCD_CHFonts->Sizes,
+					LCD_CHFonts->Width, LCD_CHFonts->Height, LCD_CHFonts->Width, 0); // 查表展开字模
+	LCD_SetAddress(x, y, x + LCD_CHFonts->Width - 1, y + LCD_CHFonts->Height - 1); // 设置坐标
+	LCD_WriteBuff(pBuff, LCD_CHFonts->Width * LCD_CHFonts->Height);				   // 写入显存
+#endif
+}
+
+/**
+ * @brief  按指定放大倍数绘制一个ASCII字符，LCD_DisplayChar() 与 LCD_DisplayText() 共用
+ * @param  scale 放大倍数，1为原字号
+ */
+static void LCD_DrawAsciiChar(uint16_t x, uint16_t y, uint8_t c, uint8_t scale) {
+  (void)scale;
+#ifdef USE_FLASH_FONT
+  uint8_t font_size = LCD_GetChineseFontSize();
+  const uint8_t *pFontData = (c < 0x80) ? FlashFont_GetGlyphCP(c, font_size) : NULL;
+
+  if (pFontData != NULL) {
+    uint8_t width = font_size / 2;
+#ifdef LCD_TEXT_SCALE_ENABLE
+    if (scale > 1 &&
+        LCD_DrawGlyphScaled(x, y, pFontData, width, font_size,
+                            FlashFont_GlyphPacked(c, font_size), scale))
+      return; // 大号字只用1bpp字模放大
+#endif
+    DrawFont_Bitmap(x, y, width, font_size, pFontData, c, 0);
+    return;
+  }
+#else
+
+  uint16_t *pBuff;
+
+  c = c - 32; // 计算ASCII字符的偏移
+
+#ifdef LCD_TEXT_SCALE_ENABLE
+  if (scale > 1 &&
+      LCD_DrawGlyphScaled(x, y, LCD_AsciiFonts->pTable + c * LCD_AsciiFonts->Sizes,
+                          LCD_AsciiFonts->Width, LCD_AsciiFonts->Height, 0, scale))
+    return;
+#endif
+  if (LCD.Text_Mode == Text_Transparent) {
+    LCD_DrawGlyphSpans(x, y, LCD_AsciiFonts->pTable + c * LCD_AsciiFonts->Sizes,
+                       LCD_AsciiFonts->Width, LCD_AsciiFonts->Height, 0);
+    return;
+  }
+  pBuff = LCD_NextBuff(); // 取得空闲的缓冲区
+  LCD_ExpandGlyph(pBuff, LCD_AsciiFonts->pTable + c * LCD_AsciiFonts->Sizes,
+                  LCD_AsciiFonts->Width, LCD_AsciiFonts->Height,
+                  LCD_AsciiFonts->Width, 0); // 查表展开字模
+  LCD_SetAddress(x, y, x + LCD_AsciiFonts->Width - 1,
+                 y + LCD_AsciiFonts->Height - 1); // 设置坐标
+  LCD_WriteBuff(pBuff,
+                LCD_AsciiFonts->Width * LCD_AsciiFonts->Height); // 写入显存
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayChar
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					c  - ASCII字符
+ *
+ *	函数功能:	在指定坐标显示指定的字符
+ *
+ *	说    明:	1. 可设置要显示的字体
+ *					2.	可设置要显示的颜色，例如使用
+ *LCD_SetColor(0xff0000FF) 设置为蓝色
+ *					3. 可设置对应的背景色，例如使用
+ *LCD_SetBackColor(0x000000) 设置为黑色的背景色
+ *					4. 使用示例 LCD_DisplayChar( 10, 10,
+ *'a') ，在坐标(10,10)显示字符 'a'
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayChar(uint16_t x, uint16_t y, uint8_t c) {
+  if (LCD_TILE_RECORD(LCD_OP_DisplayChar, x, y, c, 0, NULL, 0))
+    return; // 录制到显示列表
+
+  LCD_DrawAsciiChar(x, y, c, LCD_ASCII_SCALE);
+}
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_ExpandText
+ *
+ *	入口参数:	dst - 目标RGB565缓冲区中第一个字符左上角的像素
+ *					stride - 目标缓冲区每行像素数
+ *					max_width - 可用宽度(像素)，放不下的字符不展开
+ *					pText - UTF-8字符串，遇到 '\0' 或 '\n' 停止
+ *					font_size - 字号
+ *					color / back_color - RGB565画笔色和背景色
+ *					width - 输出展开的总宽度，可为NULL
+ *
+ *	返 回 值:	展开的字节数，字库不可用时返回0
+ *
+ *	函数功能:	把一行文字按指定颜色展开到内存缓冲区，不设置窗口、不发送
+ *
+ *	说    明:	1. 供LTDC帧缓冲等不经过SPI的显示后端使用，字模查找、字模缓存、字宽表和展开表与SPI屏共用
+ *					2. 按不透明模式展开，缺字填充背景色；展开表按颜色缓存，与SPI屏交替使用时只在首次建表
+ *
+ *****************************************************************************************************************************************/
+
+uint16_t LCD_ExpandText(uint16_t *dst, uint16_t stride, uint16_t max_width, const char *pText, uint8_t font_size,
+						uint16_t color, uint16_t back_color, uint16_t *width)
+{
+	const uint8_t *glyphs[LCD_TEXT_BATCH];
+	uint16_t user_color = LCD.Color, user_back = LCD.BackColor;
+	const char *p = pText;
+	uint16_t col = 0;
+
+	if (color != LCD.Color || back_color != LCD.BackColor)
+	{
+		LCD.Color = color;
+		LCD.BackColor = back_color;
+		Expand_LUT_Valid = 0;
+	}
+	while (*p != 0 && *p != '\n')
+	{
+		const char *q = p;
+		uint16_t count = 0, end = col, n;
+
+		while (count < LCD_TEXT_BATCH && *q != 0 && *q != '\n') // 先排版，只解析放得下的字符
+		{
+			uint32_t cp;
+			uint8_t len = FlashFont_DecodeText((const uint8_t *)q, &cp);
+			uint8_t advance = LCD_TextAdvance(cp, q + len, font_size, NULL);
+
+			if (end + advance > max_width)
+				break;
+			end += advance;
+			q += len;
+			count++;
+		}
+		if (count == 0)
+			break;
+		n = FlashFont_ResolveString(p, font_size, glyphs, count);
+		if (n == 0)
+			break; // 字库未初始化或字体大小无效
+
+		for (uint16_t i = 0; i < n; i++)
+		{
+			uint32_t cp;
+			uint8_t advance, cell_w, bpp = 1;
+			int8_t src_x;
+			const uint8_t *pAA = NULL;
+
+			p += FlashFont_DecodeText((const uint8_t *)p, &cp);
+			advance = LCD_TextAdvance(cp, p, font_size, &src_x);
+			cell_w = (cp < 0x80) ? font_size / 2 : font_size;
+#ifdef FLASH_FONT_AA_ENABLE
+			pAA = LCD_FindGlyphAA(cp, font_size, &bpp);
+#endif
+			if (glyphs[i] == NULL)
+			{
+				uint16_t *cell = dst + col;
+
+				for (uint16_t row = 0; row < font_size; row++, cell += stride) // 缺字留空
+				{
+					for (uint16_t k = 0; k < advance; k++)
+						cell[k] = LCD.BackColor;
+				}
+			}
+			else if (src_x != 0 || advance != cell_w) // 比例宽度：截取字模单元的一部分
+			{
+				LCD_ExpandGlyphWindow(dst + col, (pAA != NULL) ? pAA : glyphs[i], cell_w, font_size, stride, src_x,
+									  advance, bpp);
+			}
+#ifdef FLASH_FONT_AA_ENABLE
+			else if (pAA != NULL)
+			{
+				LCD_ExpandGlyphAA(dst + col, pAA, advance, font_size, stride, bpp);
+			}
+#endif
+			else
+			{
+				LCD_ExpandGlyph(dst + col, glyphs[i], advance, font_size, stride, FlashFont_GlyphPacked(cp, font_size));
+			}
+			col += advance;
+		}
+	}
+
+	if (user_color != LCD.Color || user_back != LCD.BackColor)
+	{
+		LCD.Color = user_color;
+		LCD.BackColor = user_back;
+		Expand_LUT_Valid = 0;
+	}
+	if (width != NULL)
+		*width = col;
+	return (uint16_t)(p - pText);
+}
+#endif
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312) && defined(LCD_TEXT_MEMO_ENABLE)
+#define LCD_MEMO_MAX_GLYPHS (LCD_TEXT_MEMO_GLYPHS / 4) // 超过的字符串不缓存，避免一条长文本挤掉全部标签
+
+#if LCD_TEXT_MEMO_ENTRIES < 1 || LCD_TEXT_MEMO_ENTRIES > 255 || LCD_TEXT_MEMO_GLYPHS < 4 || LCD_TEXT_MEMO_GLYPHS > 0xFFFF
+#error "LCD_TEXT_MEMO_ENTRIES 必须在1-255之间，LCD_TEXT_MEMO_GLYPHS 必须在4-65535之间"
+#endif
+
+typedef struct // 一个字符串的解析结果
+{
+	const char *Text; // 字符串地址，NULL表示空项
+	uint32_t Stamp;	  // 解析时的 FlashFont_RunStamp()
+	uint16_t Limit;	  // 字节数上限，LCD_MEMO_ZSTR 表示到结束符为止
+	uint16_t Bytes;	  // 实际字节数
+	uint16_t Sum;	  // 内容校验和(LCD_TEXT_MEMO_VERIFY)
+	uint16_t Start;	  // 在 LCD_Memo_Glyphs 中的起始项
+	uint16_t Count;	  // 字符数
+	uint8_t FontSize; // 字号
+	uint8_t Family;	  // 字体族
+	uint8_t Encoding; // 文本编码
+} LCD_TextMemo_t;
+
+static FontGlyphRef_t LCD_Memo_Glyphs[LCD_TEXT_MEMO_GLYPHS]; // 各字符串的字形，按环形依次分配
+static LCD_TextMemo_t LCD_Memo[LCD_TEXT_MEMO_ENTRIES];
+static uint16_t LCD_Memo_Head = 0; // 下一次分配的起始字形
+static uint8_t LCD_Memo_Next = 0;  // 下一次替换的项(先进先出)
+static uint8_t LCD_Memo_Limit = LCD_TEXT_MEMO_ENTRIES; // 运行时使用的项数(LCD_TextMemo_SetLimit())
+static uint8_t LCD_Memo_Peak = 0;  // 有效项数的峰值
+static uint32_t LCD_Memo_Hits = 0;
+static uint32_t LCD_Memo_Misses = 0;
+
+/**
+ * @brief  有效项数
+ */
+static uint8_t LCD_TextMemo_Count(void)
+{
+	uint8_t n = 0;
+
+	for (uint8_t i = 0; i < LCD_TEXT_MEMO_ENTRIES; i++)
+	{
+		if (LCD_Memo[i].Text != NULL)
+			n++;
+	}
+	return n;
+}
+
+/**
+ * @brief  解析字符串并存入缓存
+ * @retval 缓存项，含BMP之外的字符、非法编码或字符数超过 LCD_MEMO_MAX_GLYPHS 时返回NULL
+ * @note   字形按环形分配，与新分配区间重叠的旧项一并作废
+ */
+static LCD_TextMemo_t *LCD_TextMemo_Build(const char *p, uint16_t limit, uint8_t font_size, uint32_t stamp)
+{
+	LCD_TextMemo_t *m;
+	FontGlyphRef_t *ref;
+	uint16_t n = 0, count = 0;
+
+	while (n < limit && p[n] != 0) // 先只解码，确认能缓存再查表
+	{
+		uint32_t cp;
+		uint8_t len = FlashFont_DecodeText((const uint8_t *)&p[n], &cp);
+
+		if (cp > 0xFFFF || len != LCD_Text_Bytes(cp) || n + len > limit || ++count > LCD_MEMO_MAX_GLYPHS)
+		{
+			return NULL;
+		}
+		n += len;
+	}
+	if (count == 0)
+	{
+		return NULL;
+	}
+
+	if (LCD_Memo_Head + count > LCD_TEXT_MEMO_GLYPHS)
+	{
+		LCD_Memo_Head = 0; // 回到开头
+	}
+	for (uint8_t i = 0; i < LCD_TEXT_MEMO_ENTRIES; i++)
+	{
+		m = &LCD_Memo[i];
+		if (m->Text != NULL && m->Start < LCD_Memo_Head + count && LCD_Memo_Head < m->Start + m->Count)
+		{
+			m->Text = NULL; // 字形区间将被覆盖
+		}
+	}
+	m = &LCD_Memo[LCD_Memo_Next];
+	LCD_Memo_Next = (LCD_Memo_Next + 1 < LCD_Memo_Limit) ? LCD_Memo_Next + 1 : 0;
+
+	m->Text = p;
+	m->Stamp = stamp;
+	m->Limit = limit;
+	m->Bytes = n;
+	m->Sum = LCD_Text_SumN(p, n, &n);
+	m->Start = LCD_Memo_Head;
+	m->Count = count;
+	m->FontSize = font_size;
+	m->Family = LCD_TEXT_FAMILY();
+	m->Encoding = LCD_TEXT_ENCODING();
+	LCD_Memo_Head += count;
+	if (LCD_TextMemo_Count() > LCD_Memo_Peak)
+		LCD_Memo_Peak = LCD_TextMemo_Count();
+
+	ref = &LCD_Memo_Glyphs[m->Start];
+	for (n = 0; n < m->Bytes; ref++)
+	{
+		uint32_t cp;
+		int8_t src_x;
+
+		n += FlashFont_DecodeText((const uint8_t *)&p[n], &cp);
+		ref->offset = FlashFont_GlyphRefOffset(cp, font_size);
+		ref->cp = (uint16_t)cp;
+		ref->advance = LCD_TextAdvance(cp, (n < m->Bytes) ? &p[n] : "", font_size, &src_x); // 末字之后没有字偶距
+		ref->x = src_x;
+	}
+	return m;
+}
+
+/**
+ * @brief  查找字符串的解析结果，没有或已过期时重新解析
+ * @retval 缓存项，不能缓存时返回NULL
+ */
+static LCD_TextMemo_t *LCD_TextMemo_Get(const char *p, uint16_t limit)
+{
+	uint8_t font_size = LCD_GetChineseFontSize();
+	uint8_t family = LCD_TEXT_FAMILY();
+	uint8_t enc = LCD_TEXT_ENCODING();
+	uint32_t stamp;
+
+	if (Text_Rich != NULL || p == NULL || *p == 0)
+	{
+		return NULL; // 富文本逐段换色，按原路径绘制
+	}
+	stamp = FlashFont_RunStamp(font_size);
+	if (stamp == 0)
+	{
+		return NULL; // 字库未初始化
+	}
+	for (uint8_t i = 0; i < LCD_Memo_Limit; i++)
+	{
+		LCD_TextMemo_t *m = &LCD_Memo[i];
+
+		if (m->Text != p || m->Limit != limit || m->FontSize != font_size || m->Family != family ||
+			m->Encoding != enc)
+		{
+			continue;
+		}
+#ifdef LCD_TEXT_MEMO_VERIFY
+		{
+			uint16_t bytes;
+			uint16_t sum = LCD_Text_SumN(p, limit, &bytes);
+
+			if (bytes != m->Bytes || sum != m->Sum)
+			{
+				m->Text = NULL; // 缓冲区已被改写
+				break;
+			}
+		}
+#endif
+		if (m->Stamp != stamp)
+		{
+			m->Text = NULL; // 字库已更新
+			break;
+		}
+		LCD_Memo_Hits++;
+		return m;
+	}
+	LCD_Memo_Misses++;
+	return LCD_TextMemo_Build(p, limit, font_size, stamp);
+}
+
+/**
+ * @brief  用缓存的解析结果绘制字符串，排版与 LCD_Text_Render() 相同
+ * @param  limit 最多绘制的字节数，LCD_MEMO_ZSTR 表示到结束符为止
+ * @retval 1：已绘制；0：不能缓存，调用者按原路径绘制
+ */
+static uint8_t LCD_TextMemo_Draw(uint16_t x, uint16_t y, const char *p, uint16_t limit)
+{
+	const LCD_TextMemo_t *m = LCD_TextMemo_Get(p, limit);
+	const FontGlyphRef_t *ref, *end;
+	uint8_t font_size;
+	uint16_t x_start = x;
+
+	if (m == NULL)
+	{
+		return 0;
+	}
+	font_size = m->FontSize;
+	ref = &LCD_Memo_Glyphs[m->Start];
+	end = ref + m->Count;
+#ifdef LCD_TEXT_STRIP_ENABLE
+	while (ref < end) // 与 LCD_Text_Render() 相同地按行宽和行缓冲区大小分行
+	{
+		uint16_t count = 0, line_width = 0, used;
+
+		while (ref + count < end)
+		{
+			uint8_t width = ref[count].advance;
+
+			if (count > 0 && (x + line_width + width > LCD.Width ||
+							  (uint32_t)(line_width + width) * font_size > LCD_STRIP_PIXELS))
+			{
+				break;
+			}
+			if (count == 0 && x + width > LCD.Width && x != x_start)
+			{
+				break;
+			}
+			line_width += width;
+			count++;
+		}
+		if (count == 0)
+		{
+			x = x_start; // 换行
+			y += font_size;
+			continue;
+		}
+		used = DrawText_Strip(x, y, p, count, line_width, font_size, ref);
+		if (used == 0)
+		{
+			break;
+		}
+		p += used;
+		ref += count;
+		x += line_width;
+	}
+#else
+	(void)p;
+	for (; ref < end; ref++)
+	{
+		const uint8_t *pData;
+
+		if (x + ref->advance > LCD.Width)
+		{
+			x = x_start;
+			y += font_size;
+		}
+		pData = FlashFont_GetGlyphRef(ref, font_size);
+		if (pData != NULL)
+		{
+			DrawFont_Bitmap(x, y, ref->advance, font_size, pData, ref->cp, ref->x);
+		}
+		x += ref->advance;
+	}
+#endif
+	return 1;
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_TextMemo_Invalidate / LCD_TextMemo_GetStats
+ *
+ *	入口参数:	pText - 字符串地址，NULL时作废全部
+ *					hits、misses - 输出命中和解析次数，可为NULL
+ *
+ *	函数功能:	作废缓存的字符串解析结果 / 读取缓存统计
+ *
+ *	说    明:	1. 作废所有起点落在 pText 字符串内的项，包括 LCD_DrawLayout() 按行缓存的各行
+ *					2. LCD_TextMemo_GetStats() 返回当前有效项占用的字形个数
+ *
+ ***********************************************************************************************************************************/
+
+void LCD_TextMemo_Invalidate(const char *pText)
+{
+	uint16_t bytes = 0;
+
+	if (pText != NULL)
+	{
+		LCD_Text_SumN(pText, LCD_MEMO_ZSTR, &bytes);
+	}
+	for (uint8_t i = 0; i < LCD_TEXT_MEMO_ENTRIES; i++)
+	{
+		LCD_TextMemo_t *m = &LCD_Memo[i];
+
+		if (pText == NULL || (m->Text >= pText && m->Text <= pText + bytes))
+		{
+			m->Text = NULL;
+		}
+	}
+}
+
+uint16_t LCD_TextMemo_GetStats(uint32_t *hits, uint32_t *misses)
+{
+	uint16_t used = 0;
+
+	for (uint8_t i = 0; i < LCD_TEXT_MEMO_ENTRIES; i++)
+	{
+		if (LCD_Memo[i].Text != NULL)
+		{
+			used += LCD_Memo[i].Count;
+		}
+	}
+	if (hits != NULL)
+		*hits = LCD_Memo_Hits;
+	if (misses != NULL)
+		*misses = LCD_Memo_Misses;
+	return used;
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_TextMemo_SetLimit
+ *
+ *	入口参数:	entries - 项数，0或超过 LCD_TEXT_MEMO_ENTRIES 时为 LCD_TEXT_MEMO_ENTRIES
+ *
+ *	返 回 值:	生效的项数
+ *
+ *	函数功能:	限制解析结果缓存运行时使用的字符串个数
+ *
+ *	说    明:	缓存随即作废，命中统计保留；字形存储区仍为 LCD_TEXT_MEMO_GLYPHS
+ *
+ ***********************************************************************************************************************************/
+
+uint8_t LCD_TextMemo_SetLimit(uint8_t entries)
+{
+	if (entries == 0 || entries > LCD_TEXT_MEMO_ENTRIES)
+		entries = LCD_TEXT_MEMO_ENTRIES;
+	LCD_TextMemo_Invalidate(NULL);
+	LCD_Memo_Head = 0;
+	LCD_Memo_Next = 0;
+	LCD_Memo_Peak = 0;
+	LCD_Memo_Limit = entries;
+	return entries;
+}
+
+#ifdef PERF_MEMORY_ENABLE
+/**
+ * @brief  填写解析结果缓存的内存占用
+ * @param  entry 输出
+ */
+void LCD_TextMemo_GetMemory(PerfMemory_Entry_t *entry)
+{
+	entry->name = "memo";
+	entry->unit = "entry";
+	entry->base = LCD_Memo_Glyphs;
+	entry->bytes = sizeof(LCD_Memo_Glyphs) + sizeof(LCD_Memo);
+	entry->capacity = LCD_TEXT_MEMO_ENTRIES;
+	entry->limit = LCD_Memo_Limit;
+	entry->used = LCD_TextMemo_Count();
+	entry->peak = LCD_Memo_Peak;
+	entry->hits = LCD_Memo_Hits;
+	entry->misses = LCD_Memo_Misses;
+	entry->resizable = 1;
+}
+#endif
+#endif
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayText
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					pText - 字符串，可以显示中文或者ASCII字符
+ *
+ *	函数功能:	在指定坐标显示指定的字符串
+ *
+ *	说    明:	1. 可设置要显示的字体，例如使用 LCD_SetTextFont(&CH_Font24) 设置为 2424的中文字体以及2412的ASCII字符字体
+ *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0xff0000FF) 设置为蓝色
+ *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0xff000000) 设置为黑色的背景色
+ *					4. 使用示例 LCD_DisplayChinese( 10, 10, "菜菜why") ，在坐标(10,10)显示字符串"菜菜why"
+ *					5. Flash字库带ASCII字宽表时英文按比例宽度和字偶距排版，LCD_DisplayChar/LCD_DisplayString 仍为等宽
+ *					6. 定义了 LCD_TEXT_MEMO_ENABLE 时按字符串地址缓存解析结果，重复显示同一个标签不再解码和查表；
+ *						改写缓冲区后由 LCD_TEXT_MEMO_VERIFY 的校验或 LCD_TextMemo_Invalidate() 重新解析
+ *
+ ***********************************************************************************************************************************/
+
+void LCD_DisplayText(uint16_t x, uint16_t y, char *pText)
+{
+	if (LCD_RETAIN_RECORD(LCD_RETAIN_TEXT, x, y, 0, 0, pText))
+		return; // 记录到保留列表
+	if (LCD_TILE_RECORD(LCD_OP_DisplayText, x, y, 0, 0, pText, LCD_TILE_STR))
+		return; // 录制到显示列表
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312) && defined(LCD_TEXT_MEMO_ENABLE)
+	if (LCD_TextMemo_Draw(x, y, pText, LCD_MEMO_ZSTR))
+		return; // 按缓存的解析结果绘制
+#endif
+
+	LCD_Text_Render(x, y, pText);
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayRichText
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					rich - 字符串和样式表，样式段按 Start 升序排列
+ *
+ *	函数功能:	显示带内联样式的字符串，每段文字使用样式表中的画笔色和背景色
+ *
+ *	说    明:	1. 排版、换行和字体与 LCD_DisplayText() 相同，逐字绘制前切换颜色；整行合成时换色只重建展开表，
+ *						一行仍然只设置一个窗口、一次发送，不必为每种颜色各调用一次 LCD_SetColor() 和 LCD_DisplayText()
+ *					2. 第一段样式之前的文字用当前颜色，绘制完成后恢复原来的画笔色和背景色
+ *					3. 显示列表只记录 rich 的地址，录制期间字符串和样式表需保持有效；不进入保留列表
+ *					4. 一行的高度由当前字号决定，样式段不改变字号
+ *
+ ***********************************************************************************************************************************/
+
+void LCD_DisplayRichText(uint16_t x, uint16_t y, const LCD_RichText_t *rich)
+{
+	uint16_t color = LCD.Color, back = LCD.BackColor;
+
+	if (LCD_TILE_RECORD(LCD_OP_DisplayRichText, x, y, 0, 0, rich, 0))
+		return; // 录制到显示列表
+
+	Text_Rich = rich;
+	Text_RichNext = 0;
+	LCD_Text_Render(x, y, rich->Text);
+	Text_Rich = NULL;
+
+	if (LCD.Color != color || LCD.BackColor != back)
+	{
+		LCD.Color = color;
+		LCD.BackColor = back;
+		Expand_LUT_Valid = 0;
+	}
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_RenderTextToBuffer
+ *
+ *	入口参数:	dst - 目标缓冲区(RGB565)
+ *					stride - 缓冲区每行像素数，不小于 width
+ *					width、height - 绘制区域尺寸
+ *					pText - 字符串，编码与 LCD_DisplayText() 相同
+ *					gc - 绘图上下文，NULL时使用当前的颜色、字体和字符模式
+ *
+ *	函数功能:	把字符串绘制到内存缓冲区，不访问屏幕
+ *
+ *	说    明:	1. 从缓冲区左上角开始排版，按 width 换行，超出 height 的行丢弃；查找、批量解析、整行合成和字模展开
+ *						与 LCD_DisplayText() 相同，只是像素经捕获后端写入 dst
+ *					2. 字符单元之外的像素保持原样；Text_Transparent 时笔画(含抗锯齿字模)与缓冲区原有内容混合
+ *					3. 绘制期间逻辑屏幕尺寸临时换为 width x height，上下文的裁剪区按缓冲区内的坐标计算；
+ *						不进入保留列表和显示列表，返回前恢复全局绘图状态
+ *					4. 之后用 LCD_CopyBuffer() 一次发送，动画中不再查找字模
+ *					5. 未定义 LCD_RENDER_BUFFER_ENABLE 时立即返回
+ *
+ ***********************************************************************************************************************************/
+
+void LCD_RenderTextToBuffer(uint16_t *dst, uint16_t stride, uint16_t width, uint16_t height, const char *pText,
+							const LCD_GC_t *gc)
+{
+#ifdef LCD_RENDER_BUFFER_ENABLE
+	LCD_State_t user;
+	uint16_t screen_w = LCD.Width, screen_h = LCD.Height;
+#ifdef LCD_TILE_ENABLE
+	uint8_t tile = LCD_Tile_Recording;
+#endif
+#ifdef LCD_RETAIN_ENABLE
+	uint8_t retain = LCD_Retain_Recording;
+#endif
+
+	if (dst == NULL || pText == NULL || width == 0 || height == 0 || stride < width)
+		return;
+	if (gc != NULL)
+		LCD_GC_Apply(gc, &user);
+	else
+		LCD_SaveState(&user);
+#ifdef LCD_TILE_ENABLE
+	LCD_Tile_Recording = 0;
+#endif
+#ifdef LCD_RETAIN_ENABLE
+	LCD_Retain_Recording = 0;
+#endif
+
+	LCD.Width = width;
+	LCD.Height = height;
+	LCD_Cap_Target = dst;
+	LCD_Cap_Stride = stride;
+#ifndef LCD_FRAMEBUFFER_ENABLE
+	LCD_Cap_Y0 = 0;
+	LCD_Cap_Rows = height;
+#endif
+	LCD_Text_Render(0, 0, pText);
+	LCD_DMA2D_Wait(); // 返回后调用者即可读取 dst
+	LCD_Cap_Target = NULL;
+	LCD.Width = screen_w;
+	LCD.Height = screen_h;
+
+#ifdef LCD_TILE_ENABLE
+	LCD_Tile_Recording = tile;
+#endif
+#ifdef LCD_RETAIN_ENABLE
+	LCD_Retain_Recording = retain;
+#endif
+	LCD_LoadState(&user);
+#else
+	(void)dst;
+	(void)stride;
+	(void)width;
+	(void)height;
+	(void)pText;
+	(void)gc;
+#endif
+}
+
+/**
+ * @brief  LCD_DisplayText() 的排版和绘制，不经过保留列表和显示列表
+ * @note   到屏幕右边缘时回到 x 换行
+ */
+static void LCD_Text_Render(uint16_t x, uint16_t y, const char *pText)
+{
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312) && defined(LCD_TEXT_STRIP_ENABLE)
+	uint8_t font_size = LCD_GetChineseFontSize();
+	uint16_t x_start = x; // 记录起始X坐标,用于换行
+
+	// 每次排出一行：先只解码UTF-8计算本行能放下的字符，再合成整行一次发送
+	while (*pText != 0)
+	{
+		const char *p = pText;
+		uint16_t count = 0, line_width = 0, used;
+
+		while (*p != 0)
+		{
+			uint32_t cp;
+			uint8_t len = FlashFont_DecodeText((const uint8_t *)p, &cp);
+			uint8_t width = LCD_TextAdvance(cp, p + len, font_size, NULL);
+
+			if (count > 0 && (x + line_width + width > LCD.Width ||
+							  (uint32_t)(line_width + width) * font_size > LCD_STRIP_PIXELS))
+			{
+				break; // 本行放不下了
+			}
+			if (count == 0 && x + width > LCD.Width && x != x_start)
+			{
+				break; // 行首字符就放不下，先换行
+			}
+			line_width += width;
+			p += len;
+			count++;
+		}
+
+		if (count == 0)
+		{
+			x = x_start; // 换行
+			y += font_size;
+			continue;
+		}
+
+		used = DrawText_Strip(x, y, pText, count, line_width, font_size, NULL);
+		if (used == 0)
+		{
+			break; // 字库未初始化或字体大小无效
+		}
+		pText += used;
+		x += line_width;
+	}
+#elif defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+	uint8_t font_size = LCD_GetChineseFontSize();
+	uint16_t x_start = x; // 记录起始X坐标,用于换行
+	const uint8_t *glyphs[LCD_TEXT_BATCH];
+
+	// 每次批量解析一段字符串的字模地址，再逐字绘制
+	while (*pText != 0)
+	{
+		uint16_t count = FlashFont_ResolveString(pText, font_size, glyphs, LCD_TEXT_BATCH);
+
+		if (count == 0)
+		{
+			break; // 字库未初始化或字体大小无效
+		}
+
+		for (uint16_t i = 0; i < count; i++)
+		{
+			uint32_t cp;
+			uint8_t width;
+			int8_t src_x;
+
+			LCD_Text_Style(pText);
+			pText += FlashFont_DecodeText((const uint8_t *)pText, &cp);
+			width = LCD_TextAdvance(cp, pText, font_size, &src_x);
+
+			// 检查是否需要换行
+			if (x + width > LCD.Width)
+			{
+				x = x_start;
+				y += font_size;
+			}
+
+			if (glyphs[i] != NULL)
+			{
+				DrawFont_Bitmap(x, y, width, font_size, glyphs[i], cp, src_x);
+			}
+			x += width;
+		}
+	}
+#else
+#ifdef USE_FLASH_FONT
+	uint8_t font_size = LCD_GetChineseFontSize();
+#endif
+	uint16_t x_start = x; // 记录起始X坐标,用于换行
+
+	while (*pText != 0)
+	{
+		LCD_Text_Style(pText);
+		if (*pText <= 0x7F) // ASCII字符
+		{
+			// 检查是否需要换行
+			if (x + LCD_AsciiFonts->Width > LCD.Width)
+			{
+				x = x_start;
+#ifdef USE_FLASH_FONT
+				y += font_size;
+#else
+				y += LCD_CHFonts->Height;
+#endif
+			}
+
+			LCD_DrawAsciiChar(x, y, *pText, 1); // 混排文本不放大
+			x += LCD_AsciiFonts->Width;
+			pText++;
+		}
+		else // 汉字(GBK编码,双字节)
+		{
+#ifdef USE_FLASH_FONT
+			// 检查是否需要换行
+			if (x + font_size > LCD.Width)
+			{
+				x = x_start;
+				y += font_size;
+			}
+#else
+			// 检查是否需要换行
+			if (x + LCD_CHFonts->Width > LCD.Width)
+			{
+				x = x_start;
+				y += LCD_CHFonts->Height;
+			}
+#endif
+
+			LCD_DisplayChinese(x, y, (char *)pText);
+
+#ifdef USE_FLASH_FONT
+			x += font_size; // Flash字库使用动态字体大小
+#else
+			x += LCD_CHFonts->Width; // 内置字库使用固定宽度
+#endif
+			pText += 2; // GBK
+                }
+	}
+#endif
+}
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayTextVertical
+ *
+ *	入口参数:	x - 第一列的左边界
+ *					y - 每列的上边界
+ *					pText - UTF-8字符串
+ *
+ *	函数功能:	竖排显示文本：字符直立，从上往下排，一列排满后向左换到下一列
+ *
+ *	说    明:	1. 每列宽为字号，每个字符占字号高的一格，ASCII在格中水平居中
+ *					2. 定义 LCD_TEXT_STRIP_ENABLE 时一列字模合成到行缓冲区后只设置一个窗口、一次发送，
+ *						与 LCD_DisplayText() 的整行合成相同；否则逐字绘制
+ *					3. 用当前字体、颜色和字符模式；竖排标点不换用竖排字形
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayTextVertical(uint16_t x, uint16_t y, char *pText)
+{
+	uint8_t font_size = LCD_GetChineseFontSize();
+	uint16_t y_start = y; // 每列的上边界
+
+	if (LCD_TILE_RECORD(LCD_OP_DisplayTextVertical, x, y, 0, 0, pText, LCD_TILE_STR))
+		return; // 录制到显示列表
+	if (font_size == 0 || y + font_size > LCD.Height)
+	{
+		return;
+	}
+
+	while (*pText != 0 && x + font_size <= LCD.Width)
+	{
+		uint16_t rows = (LCD.Height - y) / font_size; // 本列还能放下的字符数
+
+#ifdef LCD_TEXT_STRIP_ENABLE
+		const char *p = pText;
+		uint16_t count = 0, used;
+
+		if (rows > LCD_STRIP_PIXELS / (font_size * font_size))
+		{
+			rows = LCD_STRIP_PIXELS / (font_size * font_size); // 行缓冲区放不下整列时分段发送
+		}
+		while (*p != 0 && count < rows)
+		{
+			uint32_t cp;
+
+			p += FlashFont_DecodeText((const uint8_t *)p, &cp);
+			count++;
+		}
+		used = DrawText_Column(x, y, pText, count, font_size);
+		if (used == 0)
+		{
+			break; // 字库未初始化或字体大小无效
+		}
+		pText += used;
+		y += count * font_size;
+#else
+		for (uint16_t row = 0; row < rows && *pText != 0; row++, y += font_size)
+		{
+			uint32_t cp;
+			const uint8_t *pData;
+			uint8_t cell_w;
+
+			pText += FlashFont_DecodeText((const uint8_t *)pText, &cp);
+			cell_w = (cp < 0x80) ? font_size / 2 : font_size;
+			pData = FlashFont_GetGlyphCP(cp, font_size);
+			if (pData != NULL)
+			{
+				DrawFont_Bitmap(x + (font_size - cell_w) / 2, y, cell_w, font_size, pData, cp, 0);
+			}
+		}
+#endif
+		if (y + font_size > LCD.Height) // 本列排满，向左换列
+		{
+			if (x < font_size)
+			{
+				break;
+			}
+			x -= font_size;
+			y = y_start;
+		}
+	}
+}
+#endif
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+// 不能出现在行首的标点(Unicode码点)，与前一个字符之间不换行
+static const uint16_t LCD_Text_NoStart[] = {',', '.', ';', ':', '!', '?', ')', ']', '}', '%',
+											0xFF0C, 0x3002, 0x3001, 0xFF1B, 0xFF1A, 0xFF01, 0xFF1F, 0xFF09,
+											0x300D, 0x300F, 0x3011, 0x300B, 0x3009, 0x201D, 0x2019, 0x2026,
+											0x00B7, 0xFF05, 0x3015, 0x2014};
+// 不能出现在行尾的标点，与后一个字符之间不换行
+static const uint16_t LCD_Text_NoEnd[] = {'(', '[', '{', 0xFF08, 0x300C, 0x300E, 0x3010, 0x300A, 0x3008, 0x201C, 0x2018, 0x3014};
+#define LCD_TEXT_IS_CJK(code) ((code) >= 0x2E80) // 汉字、假名、全角符号，前后都可以换行
+#else
+// GBK编码的标点，双字节按 (第一字节 << 8) | 第二字节
+static const uint16_t LCD_Text_NoStart[] = {',', '.', ';', ':', '!', '?', ')', ']', '}', '%',
+											0xA3AC, 0xA1A3, 0xA1A2, 0xA3BB, 0xA3BA, 0xA3A1, 0xA3BF, 0xA3A9,
+											0xA1B9, 0xA1BB, 0xA1BF, 0xA1B7, 0xA1B5, 0xA1B1, 0xA1AF, 0xA1AD,
+											0xA1A4, 0xA3A5, 0xA1B3, 0xA1AA};
+static const uint16_t LCD_Text_NoEnd[] = {'(', '[', '{', 0xA3A8, 0xA1B8, 0xA1BA, 0xA1BE, 0xA1B6, 0xA1B4, 0xA1B0, 0xA1AE, 0xA1B2};
+#define LCD_TEXT_IS_CJK(code) ((code) > 0xFF)
+#endif
+
+static LCD_Layout_t LCD_TextLayout; // LCD_MeasureText() 的排版结果，供紧接着的 LCD_DisplayTextBox() 使用
+
+/**
+ * @brief  取出一个字符的编码：UTF-8为码点，GBK为双字节编码
+ * @retval 字符的字节数，与 LCD_TextCell() 相同
+ */
+static uint8_t LCD_Text_Code(const char *p, uint32_t *code)
+{
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+	return FlashFont_DecodeText((const uint8_t *)p, code);
+#else
+	if ((uint8_t)p[0] <= 0x7F || p[1] == 0)
+	{
+		*code = (uint8_t)p[0];
+		return 1;
+	}
+	*code = ((uint32_t)(uint8_t)p[0] << 8) | (uint8_t)p[1];
+	return 2;
+#endif
+}
+
+static uint8_t LCD_Text_InList(uint32_t code, const uint16_t *list, uint8_t count)
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		if (list[i] == code)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief  两个相邻的非空格字符之间能否换行
+ * @note   汉字前后可以换行，ASCII单词内部只在连字符之后换行；行首禁用标点、行尾禁用标点不与相邻字符分开
+ */
+static uint8_t LCD_Text_CanBreak(uint32_t prev, uint32_t next)
+{
+	if (LCD_Text_InList(prev, LCD_Text_NoEnd, sizeof(LCD_Text_NoEnd) / sizeof(LCD_Text_NoEnd[0])) ||
+		LCD_Text_InList(next, LCD_Text_NoStart, sizeof(LCD_Text_NoStart) / sizeof(LCD_Text_NoStart[0])))
+	{
+		return 0;
+	}
+	return LCD_TEXT_IS_CJK(prev) || LCD_TEXT_IS_CJK(next) || prev == '-';
+}
+
+/**
+ * @brief  计算字符串的字节数和校验和，只扫描字节，不解码
+ */
+static uint16_t LCD_Text_Sum(const char *p, uint16_t *bytes)
+{
+	return LCD_Text_SumN(p, 0xFFFF, bytes);
+}
+
+/**
+ * @brief  同 LCD_Text_Sum()，最多扫描 limit 个字节
+ */
+static uint16_t LCD_Text_SumN(const char *p, uint16_t limit, uint16_t *bytes)
+{
+	uint16_t sum = 0, n = 0;
+
+	while (n < limit && p[n] != 0)
+	{
+		sum = (uint16_t)(((sum << 1) | (sum >> 15)) ^ (uint8_t)p[n]);
+		n++;
+	}
+	*bytes = n;
+	return sum;
+}
+
+/**
+ * @brief  计算一段文字的显示宽度(含空格)，不换行
+ */
+static uint16_t LCD_Text_Width(const char *p, uint16_t bytes)
+{
+	uint16_t n = 0, width = 0;
+
+	while (n < bytes && p[n] != 0)
+	{
+		uint16_t w;
+
+		n += LCD_TextCell(&p[n], &w);
+		width += w;
+	}
+	return width;
+}
+
+/**
+ * @brief  按当前字体排出一行
+ * @param  max_width 行宽
+ * @param  width 输出本行显示宽度(不含行尾空格)
+ * @param  next 输出下一行相对 p 的偏移，p 已是字符串结尾时为0
+ * @retval 本行要绘制的字节数(不含行尾空格和换行符)
+ * @note   在空格、汉字前后和连字符之后换行，单词比整行还长时才从中间断开；
+ *         换行处的空格不显示，'\n' 强制换行；只读取字宽表，不读取字模
+ */
+static uint16_t LCD_Text_LineBreak(const char *p, uint16_t max_width, uint16_t *width, uint16_t *next)
+{
+	uint16_t bytes = 0, line_width = 0; // 已排入本行的字节数和宽度(含空格)
+	uint16_t ink = 0, ink_width = 0;	// 到最后一个非空格字符为止
+	uint16_t brk = 0, brk_width = 0;	// 最近的换行机会之前的字节数和宽度，0表示还没有
+	uint16_t end, end_width;
+	uint32_t code = 0;
+
+	while (p[bytes] != 0 && p[bytes] != '\n')
+	{
+		uint32_t prev = code;
+		uint16_t w;
+		uint8_t len = LCD_Text_Code(&p[bytes], &code);
+
+		LCD_TextCell(&p[bytes], &w);
+		if (code == ' ')
+		{
+			if (ink == bytes && ink > 0)
+			{
+				brk = ink; // 空格之前可以换行
+				brk_width = ink_width;
+			}
+			line_width += w; // 行尾空格可以超出行宽
+			bytes += len;
+			continue;
+		}
+		if (ink > 0 && ink == bytes && LCD_Text_CanBreak(prev, code))
+		{
+			brk = bytes; // 与前一个字符之间可以换行
+			brk_width = line_width;
+		}
+		if (ink > 0 && line_width + w > max_width)
+		{
+			break; // 本行放不下了
+		}
+		line_width += w;
+		bytes += len;
+		ink = bytes;
+		ink_width = line_width;
+	}
+
+	if (p[bytes] == 0 || p[bytes] == '\n')
+	{
+		end = ink;
+		end_width = ink_width;
+		bytes += (p[bytes] == '\n') ? 1 : 0; // 强制换行，下一行保留行首空格
+	}
+	else
+	{
+		if (brk > 0)
+		{
+			end = brk;
+			end_width = brk_width;
+		}
+		else
+		{
+			end = ink; // 没有换行机会，单词从中间断开
+			end_width = ink_width;
+		}
+		bytes = end;
+		while (p[bytes] == ' ')
+		{
+			bytes++; // 换行处的空格不显示
+		}
+	}
+	*width = end_width;
+	*next = bytes;
+	return end;
+}
+
+/**
+ * @brief  不换行地绘制一行中的 bytes 个字节
+ * @note   按 LCD_TEXT_LINE_BYTES 分段拷贝出以0结尾的字符串，分段只落在字符边界上
+ */
+static void LCD_Text_DrawLine(uint16_t x, uint16_t y, const char *p, uint16_t bytes)
+{
+	char line[LCD_TEXT_LINE_BYTES + 1];
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312) && defined(LCD_TEXT_MEMO_ENABLE)
+	if (LCD_TextMemo_Draw(x, y, p, bytes))
+		return; // 按行缓存原字符串中的这一段，不必拷贝
+#endif
+
+	while (bytes > 0)
+	{
+		uint16_t n = 0, w;
+
+		while (n < bytes)
+		{
+			uint8_t len = LCD_TextCell(&p[n], &w);
+
+			if (n + len > LCD_TEXT_LINE_BYTES)
+			{
+				break;
+			}
+			n += len;
+		}
+		if (n == 0)
+		{
+			break; // 不会发生：一个字符最多4字节
+		}
+		memcpy(line, p, n);
+		line[n] = 0;
+		LCD_Text_Render(x, y, line);
+		x += LCD_Text_Width(line, n);
+		p += n;
+		bytes -= n;
+	}
+}
+
+/**
+ * @brief  切换中英文字体指针，用于按排版时的字体测量或绘制
+ */
+static void LCD_Text_UseFonts(const pFONT *ascii, const pFONT *ch)
+{
+	if (LCD_AsciiFonts != ascii || LCD_CHFonts != ch)
+	{
+		LCD_AsciiFonts = ascii;
+		LCD_CHFonts = ch;
+#ifdef LCD_EXPAND_FIXED_ENABLE
+		Expand_SelectFonts();
+#endif
+	}
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_LayoutText
+ *
+ *	入口参数:	layout - 输出排版结果
+ *					pText - 字符串，绘制前需保持有效且不被改写
+ *					width - 文本框宽度，0表示屏幕宽度
+ *					align - 每行的对齐方式，LCD_TEXT_ALIGN_LEFT / LCD_TEXT_ALIGN_CENTER / LCD_TEXT_ALIGN_RIGHT
+ *
+ *	函数功能:	按当前字体把字符串排成若干行，结果可以反复用 LCD_DrawLayout() 绘制
+ *
+ *	说    明:	1. 在空格、汉字前后和连字符之后换行，不会把单词从中间断开(单词比整行还长时除外)；
+ *						逗号、句号、右括号等不出现在行首，左括号、左引号不出现在行尾
+ *					2. 换行处的空格不显示，'\n' 强制换行
+ *					3. 只解码字符串、读取字宽表，不读取字模
+ *					4. 记录前 LCD_LAYOUT_LINES 行的位置，更多的行在绘制时接着排版
+ *
+ *	返 回 值:	总行数
+ *
+ *****************************************************************************************************************************************/
+
+uint16_t LCD_LayoutText(LCD_Layout_t *layout, const char *pText, uint16_t width, uint8_t align)
+{
+	uint16_t offset = 0, n = 0, max = 0, w, bytes, next;
+
+	if (width == 0)
+	{
+		width = LCD.Width;
+	}
+	layout->Text = pText;
+	layout->AsciiFonts = LCD_AsciiFonts;
+	layout->CHFonts = LCD_CHFonts;
+	layout->Family = LCD_TEXT_FAMILY();
+	layout->Encoding = LCD_TEXT_ENCODING();
+	layout->BoxWidth = width;
+	layout->LineHeight = LCD_TextLineHeight();
+	layout->Align = align;
+	layout->Sum = LCD_Text_Sum(pText, &layout->Bytes);
+	layout->Rest = 0;
+
+	while (1)
+	{
+		bytes = LCD_Text_LineBreak(pText + offset, width, &w, &next);
+		if (bytes == 0 && next == 0)
+		{
+			break;
+		}
+		if (n < LCD_LAYOUT_LINES)
+		{
+			layout->Line[n].Start = offset;
+			layout->Line[n].Bytes = bytes;
+			layout->Line[n].Width = w;
+		}
+		else if (n == LCD_LAYOUT_LINES)
+		{
+			layout->Rest = offset; // 之后的行绘制时再排
+		}
+		if (w > max)
+		{
+			max = w;
+		}
+		n++;
+		offset += next;
+	}
+	layout->Lines = n;
+	layout->Width = max;
+	layout->Height = n * layout->LineHeight;
+	return n;
+}
+
+/**
+ * @brief  按对齐方式绘制一行
+ */
+static void LCD_Layout_DrawLine(uint16_t x, uint16_t y, const char *p, uint16_t bytes, uint16_t w, uint16_t box,
+								uint8_t align)
+{
+	if (w < box)
+	{
+		if (align == LCD_TEXT_ALIGN_CENTER)
+			x += (box - w) / 2;
+		else if (align == LCD_TEXT_ALIGN_RIGHT)
+			x += box - w;
+	}
+	LCD_Text_DrawLine(x, y, p, bytes);
+}
+
+/**
+ * @brief  按指定对齐方式绘制排版结果
+ */
+static void LCD_Layout_Draw(const LCD_Layout_t *layout, uint16_t x, uint16_t y, uint8_t align)
+{
+	const pFONT *ascii = LCD_AsciiFonts, *ch = LCD_CHFonts;
+	uint8_t family = LCD_TEXT_FAMILY(), enc = LCD_TEXT_ENCODING();
+	uint16_t n = (layout->Lines < LCD_LAYOUT_LINES) ? layout->Lines : LCD_LAYOUT_LINES;
+
+	LCD_TEXT_USE_FAMILY(layout->Family);
+	LCD_TEXT_USE_ENCODING(layout->Encoding);
+	LCD_Text_UseFonts(layout->AsciiFonts, layout->CHFonts);
+	for (uint16_t i = 0; i < n; i++)
+	{
+		const LCD_LayoutLine_t *line = &layout->Line[i];
+
+		LCD_Layout_DrawLine(x, y, layout->Text + line->Start, line->Bytes, line->Width, layout->BoxWidth, align);
+		y += layout->LineHeight;
+	}
+	if (layout->Lines > LCD_LAYOUT_LINES)
+	{
+		const char *p = layout->Text + layout->Rest;
+		uint16_t bytes, w, next;
+
+		while (1) // 没有记录的行边排边画
+		{
+			bytes = LCD_Text_LineBreak(p, layout->BoxWidth, &w, &next);
+			if (bytes == 0 && next == 0)
+				break;
+			LCD_Layout_DrawLine(x, y, p, bytes, w, layout->BoxWidth, align);
+			y += layout->LineHeight;
+			p += next;
+		}
+	}
+	LCD_Text_UseFonts(ascii, ch);
+	LCD_TEXT_USE_FAMILY(family);
+	LCD_TEXT_USE_ENCODING(enc);
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DrawLayout
+ *
+ *	入口参数:	layout - LCD_LayoutText() 的排版结果
+ *					x - 文本框左边界
+ *					y - 第一行的垂直坐标
+ *
+ *	函数功能:	绘制排版结果，不再解码和换行
+ *
+ *	说    明:	1. 用排版时的字体和当前的颜色、字符模式绘制，每行交给 LCD_DisplayText() 的批量绘制路径
+ *					2. 静态段落只需排版一次，之后每帧直接绘制
+ *					3. 显示列表只记录 layout 的地址，LCD_TileEnd() 之前需保持有效
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DrawLayout(const LCD_Layout_t *layout, uint16_t x, uint16_t y)
+{
+	if (LCD_TILE_RECORD(LCD_OP_DrawLayout, x, y, 0, 0, layout, 0))
+		return; // 录制到显示列表
+
+	LCD_Layout_Draw(layout, x, y, layout->Align);
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_MeasureText
+ *
+ *	入口参数:	pText - 字符串
+ *					font_size - 字号，与 LCD_SetTextFont() 的参数相同，0表示当前字体
+ *					max_width - 换行宽度，0表示屏幕宽度
+ *					width - 输出最宽一行的宽度，可为NULL
+ *					height - 输出总高度(行数 x 行高)，可为NULL
+ *					lines - 输出行数，可为NULL
+ *
+ *	函数功能:	不绘制，只计算字符串按 max_width 自动换行后的尺寸
+ *
+ *	说    明:	1. 换行规则与 LCD_LayoutText() 相同
+ *					2. 只解码字符串、读取字宽表，不读取字模，不影响当前字体
+ *					3. 排版结果保存下来，随后以相同的字符串、字体和宽度调用 LCD_DisplayTextBox() 时直接使用
+ *					4. 使用示例：LCD_MeasureText("菜菜why", 24, 0, &w, NULL, NULL); LCD_DisplayText((LCD.Width - w) / 2, y, "菜菜why");
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_MeasureText(const char *pText, uint8_t font_size, uint16_t max_width, uint16_t *width, uint16_t *height,
+					 uint16_t *lines)
+{
+	const pFONT *ascii = LCD_AsciiFonts, *ch = LCD_CHFonts;
+	LCD_Layout_t *layout = &LCD_TextLayout;
+
+	if (font_size != 0)
+	{
+		const pFONT *a, *c;
+
+		LCD_FontForSize(font_size, &a, &c);
+		LCD_Text_UseFonts(a, c);
+	}
+	LCD_LayoutText(layout, pText, max_width, LCD_TEXT_ALIGN_LEFT);
+	LCD_Text_UseFonts(ascii, ch);
+
+	if (width != NULL)
+		*width = layout->Width;
+	if (height != NULL)
+		*height = layout->Height;
+	if (lines != NULL)
+		*lines = layout->Lines;
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayTextBox
+ *
+ *	入口参数:	x - 文本框左边界
+ *					y - 第一行的垂直坐标
+ *					width - 文本框宽度，0表示到屏幕右边缘
+ *					pText - 字符串
+ *					align - 每行的对齐方式，LCD_TEXT_ALIGN_LEFT / LCD_TEXT_ALIGN_CENTER / LCD_TEXT_ALIGN_RIGHT
+ *
+ *	函数功能:	在宽度为 width 的文本框中自动换行显示字符串，每行按 align 对齐
+ *
+ *	说    明:	1. 换行规则与 LCD_LayoutText() 相同，用当前字体
+ *					2. 上一次 LCD_MeasureText() 或 LCD_DisplayTextBox() 排过同一字符串、字体和宽度时直接使用其结果，
+ *						字符串内容在此之间被改写时(校验和不同)重新排版
+ *					3. 不记录到保留列表：保留模式下直接绘制
+ *					4. 使用示例：LCD_DisplayTextBox(0, 100, LCD.Width, "居中标题", LCD_TEXT_ALIGN_CENTER)
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayTextBox(uint16_t x, uint16_t y, uint16_t width, char *pText, uint8_t align)
+{
+	LCD_Layout_t *layout = &LCD_TextLayout;
+	uint8_t cached;
+
+	if (LCD_TILE_RECORD(LCD_OP_DisplayTextBox, x, y, width, align, pText, LCD_TILE_STR))
+		return; // 录制到显示列表
+
+	if (width == 0)
+	{
+		width = (x < LCD.Width) ? LCD.Width - x : 0;
+	}
+	cached = (layout->Text == pText && layout->CHFonts == LCD_CHFonts && layout->AsciiFonts == LCD_AsciiFonts &&
+			  layout->Family == LCD_TEXT_FAMILY() && layout->Encoding == LCD_TEXT_ENCODING() &&
+			  layout->BoxWidth == width);
+	if (cached)
+	{
+		uint16_t len;
+
+		cached = (LCD_Text_Sum(pText, &len) == layout->Sum && len == layout->Bytes);
+	}
+	if (!cached)
+	{
+		LCD_LayoutText(layout, pText, width, align);
+	}
+	LCD_Layout_Draw(layout, x, y, align);
+}
+
+#ifdef LCD_PAGER_ENABLE
+static LCD_Pager_t *LCD_PagerActive = NULL; // LCD_Pager_Task() 排版的文档
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_Pager_Init
+ *
+ *	入口参数:	pager - 输出分页状态
+ *					pText - 文档(以0结尾)，需保持有效且不被改写
+ *					width - 文本框宽度，0表示屏幕宽度
+ *					height - 文本框高度，0表示屏幕高度
+ *					align - 每行的对齐方式
+ *					starts - 页起点表，由调用者提供
+ *					max_pages - 页起点表项数
+ *
+ *	函数功能:	打开一篇长文档，记下排版用的字体和第0页的起点，之后由 LCD_Pager_Task() 在后台分页
+ *
+ *	说    明:	1. 换行规则与 LCD_LayoutText() 相同，每页 height / 行高 行(至少1行)
+ *					2. 只记录每页起点的字节偏移(每页4字节)，不保存各行位置，文档长度不受 uint16_t 限制
+ *					3. 同时登记为后台分页的文档，之前登记的文档不再继续分页
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Pager_Init(LCD_Pager_t *pager, const char *pText, uint16_t width, uint16_t height, uint8_t align,
+					uint32_t *starts, uint16_t max_pages)
+{
+	if (width == 0)
+	{
+		width = LCD.Width;
+	}
+	if (height == 0)
+	{
+		height = LCD.Height;
+	}
+	pager->Text = pText;
+	pager->AsciiFonts = LCD_AsciiFonts;
+	pager->CHFonts = LCD_CHFonts;
+	pager->Family = LCD_TEXT_FAMILY();
+	pager->Encoding = LCD_TEXT_ENCODING();
+	pager->Align = align;
+	pager->BoxWidth = width;
+	pager->LineHeight = LCD_TextLineHeight();
+	pager->PageLines = (pager->LineHeight > 0 && height >= pager->LineHeight) ? height / pager->LineHeight : 1;
+	pager->Line = 0;
+	pager->Starts = starts;
+	pager->MaxPages = max_pages;
+	pager->Offset = 0;
+	pager->Pages = 0;
+	pager->Done = (pText == NULL || starts == NULL || max_pages == 0);
+	LCD_PagerActive = pager->Done ? NULL : pager;
+}
+
+/**
+ * @brief  按分页时的字体接着排版，直到排完 lines 行或第 page 页的起点已知
+ * @retval 1-还没有排到文档结尾
+ */
+static uint8_t LCD_Pager_Run(LCD_Pager_t *pager, uint16_t lines, uint16_t page)
+{
+	const pFONT *ascii = LCD_AsciiFonts, *ch = LCD_CHFonts;
+	uint8_t family = LCD_TEXT_FAMILY(), enc = LCD_TEXT_ENCODING();
+
+	if (pager->Done)
+	{
+		return 0;
+	}
+	LCD_TEXT_USE_FAMILY(pager->Family);
+	LCD_TEXT_USE_ENCODING(pager->Encoding);
+	LCD_Text_UseFonts(pager->AsciiFonts, pager->CHFonts);
+	while (lines > 0 && pager->Pages <= page)
+	{
+		uint16_t w, next, bytes = LCD_Text_LineBreak(pager->Text + pager->Offset, pager->BoxWidth, &w, &next);
+
+		if (bytes == 0 && next == 0)
+		{
+			pager->Done = 1; // 文档结尾，最后一页不是空页
+			break;
+		}
+		if (pager->Pages == 0 || pager->Line == pager->PageLines)
+		{
+			if (pager->Pages >= pager->MaxPages)
+			{
+				pager->Done = 1; // 页起点表已满，后面的文字不分页
+				break;
+			}
+			pager->Starts[pager->Pages++] = pager->Offset; // 有文字要排时才开始新的一页
+			pager->Line = 0;
+		}
+		pager->Line++;
+		pager->Offset += next;
+		lines--;
+	}
+	LCD_Text_UseFonts(ascii, ch);
+	LCD_TEXT_USE_FAMILY(family);
+	LCD_TEXT_USE_ENCODING(enc);
+	if (pager->Done && LCD_PagerActive == pager)
+	{
+		LCD_PagerActive = NULL;
+	}
+	return !pager->Done;
+}
+
+/**
+ * @brief  接着排版最多 lines 行
+ * @retval 1-还没有排到文档结尾, 0-分页完成
+ */
+uint8_t LCD_Pager_Step(LCD_Pager_t *pager, uint16_t lines)
+{
+	return LCD_Pager_Run(pager, lines, 0xFFFF);
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_Pager_DrawPage
+ *
+ *	入口参数:	pager - LCD_Pager_Init() 的分页状态
+ *					page - 页号，从0开始
+ *					x - 文本框左边界
+ *					y - 第一行的垂直坐标
+ *
+ *	函数功能:	从页起点表取出第 page 页的起点，排版并绘制这一页
+ *
+ *	说    明:	1. 已分页的页不论页号多大都只排版本页的几行，翻页和跳页耗时相同
+ *					2. 后台还没有排到该页时先接着分页到该页为止(之后的页仍由后台任务完成)
+ *					3. 用分页时的字体和当前的颜色、字符模式，每行交给 LCD_DisplayText() 的批量绘制路径；不录制到显示列表
+ *
+ *	返 回 值:	0-成功, 1-页号超出文档
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_Pager_DrawPage(LCD_Pager_t *pager, uint16_t page, uint16_t x, uint16_t y)
+{
+	const pFONT *ascii = LCD_AsciiFonts, *ch = LCD_CHFonts;
+	uint8_t family = LCD_TEXT_FAMILY(), enc = LCD_TEXT_ENCODING();
+	const char *p;
+
+	if (page >= pager->Pages)
+	{
+		LCD_Pager_Run(pager, 0xFFFF, page);
+	}
+	if (page >= pager->Pages)
+	{
+		return 1;
+	}
+
+	p = pager->Text + pager->Starts[page];
+	LCD_TEXT_USE_FAMILY(pager->Family);
+	LCD_TEXT_USE_ENCODING(pager->Encoding);
+	LCD_Text_UseFonts(pager->AsciiFonts, pager->CHFonts);
+	for (uint16_t i = 0; i < pager->PageLines; i++)
+	{
+		uint16_t w, next, bytes = LCD_Text_LineBreak(p, pager->BoxWidth, &w, &next);
+
+		if (bytes == 0 && next == 0)
+		{
+			break;
+		}
+		LCD_Layout_DrawLine(x, y, p, bytes, w, pager->BoxWidth, pager->Align);
+		y += pager->LineHeight;
+		p += next;
+	}
+	LCD_Text_UseFonts(ascii, ch);
+	LCD_TEXT_USE_FAMILY(family);
+	LCD_TEXT_USE_ENCODING(enc);
+	return 0;
+}
+
+/**
+ * @brief  后台分页任务：对登记的文档排版 LCD_PAGER_SLICE_LINES 行
+ * @retval 1-还有未排完的文档, 0-空闲
+ */
+uint8_t LCD_Pager_Task(void)
+{
+	return (LCD_PagerActive != NULL) ? LCD_Pager_Step(LCD_PagerActive, LCD_PAGER_SLICE_LINES) : 0;
+}
+
+/**
+ * @brief  停止后台分页
+ */
+void LCD_Pager_Close(LCD_Pager_t *pager)
+{
+	if (LCD_PagerActive == pager)
+	{
+		LCD_PagerActive = NULL;
+	}
+}
+#endif
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayStringID
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					id - 字符串编号，即 fontbin_tool.py --strings-header 生成的 STR_xxx
+ *
+ *	函数功能:	显示字库字符串表中当前语言(FlashFont_SetLanguage())的字符串
+ *
+ *	返 回 值:	1 - 已显示，0 - 字库中没有该字符串
+ *
+ *	说    明:	1. 字符串以 '\0' 结尾存放在QSPI映射区，直接交给 LCD_DisplayText()，不拷贝；
+ *						界面文字不占内部Flash，多语言只是换一张表
+ *					2. 映射区地址不变，定义了 LCD_TEXT_MEMO_ENABLE 时重复显示按地址命中解析缓存，不再解码和查表
+ *					3. 当前语言没有译文时显示语言0的字符串
+ *
+ *****************************************************************************************************************************************/
+
+uint8_t LCD_DisplayStringID(uint16_t x, uint16_t y, uint16_t id)
+{
+	const char *p = FlashFont_GetString(id, NULL);
+
+	if (p == NULL)
+		return 0;
+	LCD_DisplayText(x, y, (char *)p);
+	return 1;
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayGlyphRun
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					run - fontbuild.py --runs 生成的预解析文本串，例如 LCD_GLYPH_RUN(TITLE)
+ *
+ *	函数功能:	显示预解析的文本串，效果与以 run->font_size 调用 LCD_DisplayText() 相同
+ *
+ *	说    明:	1. 生成时已按字库解析出每个字符的字模偏移和显示宽度，绘制时不解码UTF-8、不查对照表和字宽表，
+ *						只读取字模(经过字模缓存)并展开
+ *					2. 字库被更新(FlashFont_RunStamp() 与 run->stamp 不同)时按 run->text 正常排版绘制
+ *					3. 用 run->font_size，不改变当前字体；到屏幕右边缘时回到 x 换行
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayGlyphRun(uint16_t x, uint16_t y, const FontGlyphRun_t *run)
+{
+	uint8_t font_size = run->font_size;
+	uint16_t x_start = x;
+
+	if (LCD_TILE_RECORD(LCD_OP_DisplayGlyphRun, x, y, 0, 0, run, 0))
+		return; // 录制到显示列表
+
+	if (run->stamp != FlashFont_RunStamp(font_size))
+	{
+		const pFONT *ascii = LCD_AsciiFonts, *ch = LCD_CHFonts, *a, *c;
+
+		uint8_t enc = LCD_TEXT_ENCODING();
+
+		LCD_FontForSize(font_size, &a, &c); // 字库已更新，预解析结果作废
+		LCD_Text_UseFonts(a, c);
+		LCD_TEXT_USE_ENCODING(Text_UTF8); // 原字符串由 fontbuild.py 写出，总是UTF-8
+		LCD_Text_Render(x, y, run->text);
+		LCD_TEXT_USE_ENCODING(enc);
+		LCD_Text_UseFonts(ascii, ch);
+		return;
+	}
+
+	for (uint16_t i = 0; i < run->count; i++)
+	{
+		const FontGlyphRef_t *ref = &run->glyphs[i];
+		const uint8_t *pData;
+
+		if (x + ref->advance > LCD.Width)
+		{
+			x = x_start;
+			y += font_size;
+		}
+		pData = FlashFont_GetGlyphRef(ref, font_size);
+		if (pData != NULL)
+		{
+			DrawFont_Bitmap(x, y, ref->advance, font_size, pData, ref->cp, ref->x);
+		}
+		x += ref->advance;
+	}
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayGlyphIds
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					run - 字符编号串，例如 lcd_remote.c 从接收缓冲区中直接引用的文本记录
+ *
+ *	函数功能:	用当前字体显示字符编号串，每个编号经 run->Table 换算为Unicode码点
+ *
+ *	说    明:	1. 不解码UTF-8/GBK，字模按码点经字模缓存读取，排版(字宽表、字偶距)与 LCD_DisplayText() 相同
+ *					2. 只画一行，超出屏幕右边缘的字符不显示；文字宽度不足 run->Clear 时用背景色补齐，
+ *						内容变短时一并擦掉上一次多出的尾部，不需要先清除整块区域
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayGlyphIds(uint16_t x, uint16_t y, const LCD_GlyphIds_t *run)
+{
+	uint8_t font_size = LCD_GetChineseFontSize();
+	uint32_t end = (uint32_t)x + run->Clear;
+
+	if (LCD_TILE_RECORD(LCD_OP_DisplayGlyphIds, x, y, 0, 0, run, 0))
+		return; // 录制到显示列表
+
+	for (uint16_t i = 0; i < run->Count; i++)
+	{
+		uint32_t cp = run->Table[run->Ids[i]];
+		uint32_t next = (i + 1 < run->Count) ? run->Table[run->Ids[i + 1]] : 0;
+		const uint8_t *pData;
+		uint8_t width;
+		int8_t src_x = 0;
+
+		if (cp >= 0x80)
+			width = font_size;
+		else
+			width = FlashFont_AsciiAdvance((char)cp, (next < 0x80) ? (char)next : 0, font_size, &src_x);
+		if (x + width > LCD.Width)
+			break;
+		pData = FlashFont_GetGlyphCP(cp, font_size);
+		if (pData != NULL)
+		{
+			DrawFont_Bitmap(x, y, width, font_size, pData, cp, src_x);
+		}
+		x += width;
+	}
+	if (end > LCD.Width)
+		end = LCD.Width;
+	if (end > x)
+	{
+		LCD_ClearRect(x, y, (uint16_t)(end - x), font_size);
+	}
+}
+
+#ifdef LCD_ALARM_ENABLE
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_Alarm_Load
+ *
+ *	入口参数:	chars - 报警文字用到的UTF-8字符，重复字符只锁定一次
+ *					font_size - 报警文字的字号
+ *
+ *	函数功能:	把报警字符的字模拷贝到字模缓存的锁定分区，并记录每个字符的宽度和存储方式
+ *
+ *	返 回 值:	0 - 全部锁定，1 - 有字符不在字库中或锁定分区已满(其余字符照常锁定)，-1 - 参数无效或不支持该字号
+ *
+ *	说    明:	1. 查字库、读QSPI都在这里完成，LCD_Alarm_Show() 只读DTCM中的字符表和锁定的字模
+ *					2. 锁定的字模是拷贝，不随 GlyphCache_Clear() 和局部改写作废；字库更新后重新调用
+ *
+ *****************************************************************************************************************************************/
+
+int8_t LCD_Alarm_Load(const char *chars, uint8_t font_size)
+{
+	const uint8_t *p = (const uint8_t *)chars;
+	int8_t result = 0;
+
+	LCD_AlarmSize = 0;
+	LCD_AlarmStats.Glyphs = 0;
+	GlyphCache_Unlock();
+	if (p == NULL || font_size == 0 || font_size > 32 || FlashFont_BytesPerChar(font_size) <= 0)
+		return -1;
+
+	while (*p != 0)
+	{
+		LCD_AlarmGlyph_t *g = &LCD_AlarmGlyph[LCD_AlarmStats.Glyphs];
+		const uint8_t *src;
+		uint8_t n;
+		uint32_t cp;
+		uint16_t i;
+
+		n = FlashFont_DecodeUTF8(p, &cp);
+		p += (n != 0) ? n : 1;
+		for (i = 0; i < LCD_AlarmStats.Glyphs && LCD_AlarmGlyph[i].Cp != cp; i++)
+			;
+		if (i < LCD_AlarmStats.Glyphs || cp < 0x20)
+			continue; // 重复字符、换行等控制字符
+		if (LCD_AlarmStats.Glyphs >= GLYPH_CACHE_LOCK_SLOTS)
+		{
+			result = 1;
+			break;
+		}
+		src = (cp < 0x80) ? ASCII_FindFont_Flash((char)cp, font_size) : FlashFont_FindFontCP(cp, font_size);
+		g->Data = (src != NULL) ? GlyphCache_Lock(FlashFont_GlyphKey(cp, font_size), font_size, src,
+												  FlashFont_GlyphBytes(src, cp, font_size))
+								: NULL;
+		if (g->Data == NULL)
+		{
+			result = 1;
+			continue;
+		}
+		g->Cp = cp;
+		g->Width = (cp < 0x80) ? font_size / 2 : font_size;
+		g->Packed = FlashFont_GlyphPacked(cp, font_size);
+		LCD_AlarmStats.Glyphs++;
+	}
+	LCD_AlarmSize = font_size;
+	return result;
+}
+
+/**
+ * @brief  在报警字符表中查找码点
+ * @retval 字符表项，未锁定返回NULL
+ * @note   最多比较 GLYPH_CACHE_LOCK_SLOTS 项
+ */
+ITCM_CODE static const LCD_AlarmGlyph_t *LCD_Alarm_Find(uint32_t cp)
+{
+	for (uint16_t i = 0; i < LCD_AlarmStats.Glyphs; i++)
+	{
+		if (LCD_AlarmGlyph[i].Cp == cp)
+			return &LCD_AlarmGlyph[i];
+	}
+	return NULL;
+}
+
+/**
+ * @brief  展开一个报警字符单元
+ * @param  g 字符表项，NULL时整个单元为背景色
+ * @param  width 单元显示宽度，可小于字模宽度(报警条末尾截断)
+ * @note   逐像素取位，不用按颜色建立的查找表，耗时只与 width x height 有关
+ */
+ITCM_CODE static void LCD_Alarm_Expand(uint16_t *dst, const LCD_AlarmGlyph_t *g, uint16_t width, uint16_t height,
+									   uint16_t fg, uint16_t bg)
+{
+	const uint8_t *tags = NULL;
+	const uint8_t *next = NULL;
+	const uint8_t *src = Glyph_BlankRow;
+	uint16_t bytes_per_row = 0;
+	uint16_t cell_w = 0;
+
+	if (g != NULL)
+	{
+		cell_w = g->Width;
+		bytes_per_row = Glyph_RowBytes(cell_w, g->Packed);
+		next = Glyph_RowBegin(g->Data, g->Packed, height, &tags);
+	}
+	for (uint16_t row = 0; row < height; row++, dst += width)
+	{
+		if (g != NULL)
+			src = Glyph_Row(&next, tags, src, row, bytes_per_row);
+		for (uint16_t col = 0; col < width; col++)
+			dst[col] = (col < cell_w && (src[col >> 3] & (0x01 << (col & 0x07)))) ? fg : bg;
+	}
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_Alarm_Show
+ *
+ *	入口参数:	x、y - 报警条左上角
+ *					width - 报警条宽度(像素)
+ *					pText - UTF-8字符串
+ *					color、back - 文字和背景颜色(RGB888)
+ *
+ *	函数功能:	在确定的时间内显示报警文字
+ *
+ *	返 回 值:	未锁定而显示为空白的字符数
+ *
+ *	说    明:	1. 代码在ITCM中，字符表、字模和统计在DTCM中，只调用ITCM中的UTF-8解码、设置窗口和发送函数，
+ *						不查字库、不读QSPI，与QSPI正在进行的读取和Cache状态无关
+ *					2. 不经过命令队列：最多等待一个已在发送的渲染缓冲区；之后排入的背景命令被拒绝，
+ *						已在队列中的命令照常执行，重叠时会覆盖报警条
+ *					3. 每次都发送 width x 字号 个像素(文字之后补背景色)，单元逐个展开并与上一个单元的DMA并行，
+ *						耗时上限由 LCD_AlarmStats_t.MaxCycles 实测(stress_bench 中在满负载下反复测量)
+ *					4. 不受裁剪区、文本效果和字符模式影响，也不改变当前颜色和字体
+ *
+ *****************************************************************************************************************************************/
+
+ITCM_CODE uint16_t LCD_Alarm_Show(uint16_t x, uint16_t y, uint16_t width, const char *pText, uint32_t color,
+								  uint32_t back)
+{
+	uint32_t start = LCD_ALARM_TIMESTAMP();
+	const uint8_t *p = (const uint8_t *)pText;
+	uint16_t fg = LCD_RGB565(color), bg = LCD_RGB565(back);
+	uint16_t size = LCD_AlarmSize;
+	uint16_t col = 0, missing = 0;
+	LCD_Rect_t clip = LCD_Clip;
+	uint32_t cycles;
+
+	LCD_AlarmActive = 1;
+	if (size == 0 || width == 0)
+		return 0;
+	LCD_Clip = (LCD_Rect_t)LCD_CLIP_NONE_RECT;
+	while (col < width)
+	{
+		const LCD_AlarmGlyph_t *g = NULL;
+		uint16_t cell = size;
+		uint16_t *pBuff;
+
+		if (p != NULL && *p != 0)
+		{
+			uint32_t cp;
+			uint8_t n = FlashFont_DecodeUTF8(p, &cp);
+
+			p += (n != 0) ? n : 1;
+			g = LCD_Alarm_Find(cp);
+			if (g != NULL)
+				cell = g->Width;
+			else
+			{
+				missing++;
+				cell = (cp < 0x80) ? size / 2 : size; // 未锁定的字符留出空白，后面的字不错位
+			}
+		}
+		if (cell > width - col)
+			cell = width - col;
+		pBuff = LCD_NextBuff(); // 先展开再设置坐标，与上一个单元的DMA传输并行
+		LCD_Alarm_Expand(pBuff, g, cell, size, fg, bg);
+		LCD_SetAddress(x + col, y, x + col + cell - 1, y + size - 1);
+		LCD_WriteBuff(pBuff, cell * size);
+		col += cell;
+	}
+	LCD_WaitIdle(); // 计时到像素发送完
+	LCD_Clip = clip;
+
+	cycles = LCD_ALARM_TIMESTAMP() - start;
+	LCD_AlarmStats.Shows++;
+	LCD_AlarmStats.Missing += missing;
+	LCD_AlarmStats.LastCycles = cycles;
+	if (cycles > LCD_AlarmStats.MaxCycles)
+		LCD_AlarmStats.MaxCycles = cycles;
+	return missing;
+}
+
+/**
+ * @brief  结束报警，重新接纳背景命令
+ */
+void LCD_Alarm_Release(void)
+{
+	LCD_AlarmActive = 0;
+}
+
+/**
+ * @brief  读取报警显示统计
+ * @param  stats 输出统计信息
+ */
+void LCD_Alarm_GetStats(LCD_AlarmStats_t *stats)
+{
+	if (stats != NULL)
+		*stats = LCD_AlarmStats;
+}
+#endif
+
+#ifdef LCD_TEXT_ROTATE_ENABLE
+/**
+ * @brief  32x32位矩阵转置，a[r]的第c位与a[c]的第r位交换
+ * @note   依次交换16/8/4/2/1位的对角块，共5轮80次移位异或，不逐位读写
+ */
+static void Glyph_Transpose32(uint32_t *a)
+{
+	uint32_t m = 0x0000FFFFUL;
+
+	for (uint32_t j = 16; j != 0; j >>= 1, m ^= (m << j))
+	{
+		for (uint32_t k = 0; k < 32; k = (k + j + 1) & ~j)
+		{
+			uint32_t t = ((a[k] >> j) ^ a[k + j]) & m;
+
+			a[k] ^= t << j;
+			a[k + j] ^= t;
+		}
+	}
+}
+
+/**
+ * @brief  生成旋转90°后的1bpp字模
+ * @param  rot 输出，按4字节补齐的逐行字模(GLYPH_ROW32)，共 width 行，每行 height 列
+ * @param  cell_w 字模单元宽度(不超过32)
+ * @param  width 显示宽度，即原字模从 src_x 列起显示的列数
+ * @note   原字模每行读入一个字，转置后每一列成为一行，顺时针旋转时行序先倒转
+ */
+static void Glyph_Rotate(uint32_t *rot, const uint8_t *pData, uint8_t packed, uint16_t cell_w, uint16_t height,
+						 uint16_t width, int8_t src_x, uint8_t rotation)
+{
+	uint32_t a[32] = {0};
+	uint16_t bytes_per_row = Glyph_RowBytes(cell_w, packed);
+	uint32_t mask = (cell_w >= 32) ? 0xFFFFFFFFUL : (1UL << cell_w) - 1;
+	const uint8_t *tags;
+	const uint8_t *next = Glyph_RowBegin(pData, packed, height, &tags);
+	const uint8_t *src = Glyph_BlankRow;
+
+	for (uint16_t row = 0; row < height; row++)
+	{
+		uint32_t v = 0;
+
+		src = Glyph_Row(&next, tags, src, row, bytes_per_row);
+		memcpy(&v, src, (bytes_per_row < 4) ? bytes_per_row : 4); // 低位在前，与小端字节序一致
+		a[(rotation == Text_Rotate_90) ? height - 1 - row : row] = v & mask; // 顺时针时第0行在最右列
+	}
+	Glyph_Transpose32(a); // a[c]为原字模第c列
+	for (uint16_t j = 0; j < width; j++)
+	{
+		int16_t c = src_x + (int16_t)((rotation == Text_Rotate_90) ? j : width - 1 - j);
+
+		rot[j] = (c >= 0 && c < (int16_t)cell_w) ? a[c] : 0; // 字模单元外的列为背景
+	}
+}
+
+/**
+ * @brief  绘制一个旋转90°的字符
+ * @param  x, y 旋转后窗口的左上角，窗口宽 font_size、高 width
+ * @note   旋转后的字模与按字补齐的字模格式相同，直接交给同色段/查表展开，整个字符一个窗口
+ */
+static void DrawFont_Rotated(uint16_t x, uint16_t y, uint16_t width, uint8_t font_size, const uint8_t *pData,
+							 uint32_t cp, int8_t src_x, uint8_t rotation)
+{
+	uint32_t rot[32]; // 每行一个字
+	uint16_t cell_w = (cp < 0x80) ? font_size / 2 : font_size;
+	uint16_t *pBuff;
+
+	Glyph_Rotate(rot, pData, FlashFont_GlyphPacked(cp, font_size), cell_w, font_size, width, src_x, rotation);
+	if (LCD.Text_Mode == Text_Transparent)
+	{
+		LCD_DrawGlyphSpans(x, y, (const uint8_t *)rot, font_size, width, GLYPH_ROW32);
+		return;
+	}
+#ifdef LCD_GLYPH_RUN_ENABLE
+	if (font_size >= LCD_GLYPH_RUN_SIZE && LCD_TEXT_EFFECT() == Text_EffectNone)
+	{
+		LCD_DrawGlyphRuns(x, y, (const uint8_t *)rot, font_size, width, GLYPH_ROW32);
+		return;
+	}
+#endif
+	pBuff = LCD_NextBuff(); // 先展开再设置坐标，与上一次DMA传输并行
+	LCD_ExpandGlyph(pBuff, (const uint8_t *)rot, font_size, width, font_size, GLYPH_ROW32);
+	LCD_SetAddress(x, y, x + font_size - 1, y + width - 1);
+	LCD_WriteBuff(pBuff, font_size * width);
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayTextRotated
+ *
+ *	入口参数:	x - 文本区左边界
+ *					y - Text_Rotate_90 时为第一个字符的上边界，Text_Rotate_270 时为第一个字符的下边界
+ *					pText - UTF-8字符串
+ *					rotation - Text_Rotate_90：顺时针旋转，从上往下排；Text_Rotate_270：逆时针旋转，从下往上排
+ *
+ *	函数功能:	显示旋转90°的文本，用于竖向标签、侧装屏幕上的仪表读数，不必切换 LCD_SetDirection()
+ *
+ *	说    明:	1. 字模每行读入一个32位字，32x32位矩阵转置后每一列成为一行，仍按行展开，
+ *						每个字符只设置一个窗口，由控制器按当前方向连续写入，不按像素设置地址
+ *					2. 用当前字体(不超过32号)、颜色和字符模式，ASCII按字宽表的比例宽度排列；
+ *						抗锯齿字模和放大倍数不生效
+ *					3. 到屏幕上/下边缘时换到下一列：顺时针向左，逆时针向右
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayTextRotated(uint16_t x, uint16_t y, char *pText, uint8_t rotation)
+{
+	uint8_t font_size = LCD_GetChineseFontSize();
+	int32_t pos = y; // 顺时针为字符上边界，逆时针为下边界
+
+	if (LCD_TILE_RECORD(LCD_OP_DisplayTextRotated, x, y, rotation, 0, pText, LCD_TILE_STR))
+		return; // 录制到显示列表
+	if ((rotation != Text_Rotate_90 && rotation != Text_Rotate_270) || font_size > 32)
+	{
+		return;
+	}
+
+	while (*pText != 0)
+	{
+		const uint8_t *pData;
+		uint32_t cp;
+		int8_t src_x;
+		uint8_t width;
+
+		pText += FlashFont_DecodeText((const uint8_t *)pText, &cp);
+		width = LCD_TextAdvance(cp, pText, font_size, &src_x);
+		if (width > 32)
+		{
+			width = 32;
+		}
+		if ((rotation == Text_Rotate_90) ? (pos + width > LCD.Height) : (pos + 1 < width))
+		{
+			pos = y; // 本列放不下，换到下一列
+			if (rotation == Text_Rotate_270)
+			{
+				x += font_size;
+			}
+			else if (x >= font_size)
+			{
+				x -= font_size;
+			}
+			else
+			{
+				break;
+			}
+		}
+		if (x + font_size > LCD.Width || ((rotation == Text_Rotate_90) ? (pos + width > LCD.Height) : (pos + 1 < width)))
+		{
+			break; // 超出屏幕或换列后仍放不下
+		}
+
+		pData = FlashFont_GetGlyphCP(cp, font_size);
+		if (pData != NULL)
+		{
+			DrawFont_Rotated(x, (uint16_t)((rotation == Text_Rotate_90) ? pos : pos + 1 - width), width, font_size,
+							 pData, cp, src_x, rotation);
+		}
+		pos += (rotation == Text_Rotate_90) ? width : -(int32_t)width;
+	}
+}
+#endif
+#endif
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_MeasureTextCycles
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					pText - 测试字符串
+ *					cold - 1：先清空指令/数据Cache和字模缓存，0：直接绘制
+ *
+ *	返 回 值:	绘制并发送完成耗费的CPU周期数(DWT计数)
+ *
+ *	函数功能:	测量 LCD_DisplayText 的文字吞吐，用于比较XIP前后字库读取是否受代码取指影响
+ *
+ *	说    明:	1. 定义 QSPI_XIP_ENABLE 时本函数放在QSPI代码区执行，与字模读取争用同一总线
+ *					2. 分别在开启和关闭XIP的固件中以相同字符串调用，比较cold=1与cold=0两组结果
+ *					3. 计时包含等待最后一次SPI传输结束
+ *
+ *****************************************************************************************************************************************/
+
+QSPI_CODE uint32_t LCD_MeasureTextCycles(uint16_t x, uint16_t y, char *pText, uint8_t cold)
+{
+	uint32_t start;
+
+	// 使能DWT周期计数器
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	LCD_WaitIdle(); // 不计入之前未完成的传输
+	if (cold)
+	{
+		SCB_InvalidateICache();
+		SCB_CleanInvalidateDCache();
+#if defined(USE_FLASH_FONT) && defined(GLYPH_CACHE_ENABLE)
+		GlyphCache_Clear();
+#endif
+	}
+	__DSB();
+
+	start = DWT->CYCCNT;
+	LCD_DisplayText(x, y, pText);
+	LCD_WaitIdle();
+	__DSB();
+
+	return DWT->CYCCNT - start;
+}
+
+/**
+ * @brief  逐位判断展开一行字模，只用于和查表、选取两种方式比较
+ */
+static void Expand_RowBit(uint16_t *dst, const uint8_t *src, uint16_t width)
+{
+	uint16_t fore = (uint16_t)Expand_LUT[0x0F][0], back = (uint16_t)Expand_LUT[0][0];
+
+	for (uint16_t k = 0; k < width; k++)
+	{
+		dst[k] = ((src[k >> 3] >> (k & 7)) & 0x01) ? fore : back;
+	}
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_MeasureExpandCycles
+ *
+ *	入口参数:	method - LCD_EXPAND_BIT 逐位判断，LCD_EXPAND_LUT 查表，LCD_EXPAND_SEL __SEL选取
+ *					pData - 1bpp字模，每行 (width+7)/8 字节，低位在前
+ *					width - 字模宽度，width*height 不超过 LCD_BUFF_PIXELS
+ *					height - 字模高度
+ *					passes - 重复展开的次数
+ *
+ *	返 回 值:	展开 passes 次耗费的CPU周期数(DWT计数)，参数无效时为0
+ *
+ *	函数功能:	比较三种1bpp展开方式在给定字宽下的耗时，结果用于选择是否定义 LCD_EXPAND_SEL_ENABLE
+ *
+ *	说    明:	1. 展开到渲染缓冲区，不发送；颜色为当前画笔色和背景色
+ *					2. 三种方式都按行调用同一个行函数，计时只包含展开本身
+ *
+ *****************************************************************************************************************************************/
+
+uint32_t LCD_MeasureExpandCycles(uint8_t method, const uint8_t *pData, uint16_t width, uint16_t height, uint16_t passes)
+{
+	uint16_t bytes_per_row = (width + 7) / 8;
+	uint16_t *pBuff;
+	uint32_t start;
+
+	if (pData == NULL || width == 0 || (uint32_t)width * height > LCD_BUFF_PIXELS || method > LCD_EXPAND_SEL)
+		return 0;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	LCD_WaitIdle(); // 渲染缓冲区不再被发送
+	pBuff = LCD_NextBuff();
+	if (!Expand_LUT_Valid)
+	{
+		Expand_BuildLUT();
+	}
+	__DSB();
+
+	start = DWT->CYCCNT;
+	for (uint16_t pass = 0; pass < passes; pass++)
+	{
+		const uint8_t *src = pData;
+		uint16_t *dst = pBuff;
+
+		for (uint16_t row = 0; row < height; row++, src += bytes_per_row, dst += width)
+		{
+			if (method == LCD_EXPAND_BIT)
+				Expand_RowBit(dst, src, width);
+			else if (method == LCD_EXPAND_SEL)
+				Expand_RowWith(dst, src, width, 1);
+			else
+				Expand_RowWith(dst, src, width, 0);
+		}
+	}
+	__DSB();
+	return DWT->CYCCNT - start;
+}
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_ShowNumMode
+ *
+ *	入口参数:	mode - 设置变量的显示模式
+ *
+ *	函数功能:	设置变量显示时多余位补0还是补空格，可输入参数 Fill_Space 填充空格，Fill_Zero 填充零
+ *
+ *	说    明:   1. 只有 LCD_DisplayNumber() 显示整数 和 LCD_DisplayDecimals()显示小数 这两个函数用到
+ *					2. 使用示例 LCD_ShowNumMode(Fill_Zero) 设置多余位填充0，例如 123 可以显示为 000123
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_ShowNumMode(uint8_t mode)
+{
+	LCD.ShowNum_Mode = mode;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetTextMode
+ *
+ *	入口参数:	mode - 字符背景模式，Text_Opaque 填充背景色，Text_Transparent 透明
+ *
+ *	函数功能:	设置显示字符时是否绘制背景
+ *
+ *	说    明:   1. 透明模式下只发送前景笔画，每段连续的前景像素单独设置一个单行窗口，适合在图片上叠加文字
+ *					2. 透明模式不使用像素缓存和行缓冲区
+ *					3. 使用示例 LCD_SetTextMode(Text_Transparent)
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetTextMode(uint8_t mode)
+{
+	LCD.Text_Mode = mode;
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetTextEffect
+ *
+ *	入口参数:	effect - Text_EffectNone，或 Text_EffectBold / Text_EffectOutline / Text_EffectShadow 的组合
+ *					Color - 描边和阴影的颜色，RGB888格式，与 LCD_SetColor() 相同
+ *
+ *	函数功能:	设置之后绘制的文本的加粗、描边和阴影效果
+ *
+ *	说    明:   1. 效果由1bpp字模逐行按32位字运算得到，展开时与前景一起写入缓冲区，不重复绘制字模，
+ *						也不需要在字库中存放粗体
+ *					2. 效果不超出字模单元：加粗向右扩1列，描边向四周扩1像素，阴影向右下偏移1像素，
+ *						字模单元边上的笔画扩出的部分不显示
+ *					3. 有效果时不使用抗锯齿字模、笔画外框和同色段发送，超过32像素宽的字模(放大后的大号ASCII)不加效果
+ *					4. 透明模式下先发送描边/阴影段，再发送前景段
+ *					5. 使用示例 LCD_SetTextEffect(Text_EffectBold | Text_EffectShadow, LCD_BLACK)
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetTextEffect(uint8_t effect, uint32_t Color)
+{
+#ifdef LCD_TEXT_EFFECT_ENABLE
+	LCD.Text_Effect = effect;
+	LCD.Effect_Color = LCD_ToRGB565(Color);
+#else
+	(void)effect;
+	(void)Color;
+#endif
+}
+
+/****************************************************************************************************************************************
+ *	函 数 名:	LCD_SetTextScale
+ *
+ *	入口参数:	scale - 放大倍数 (1-3)，超出范围按1处理
+ *
+ *	函数功能:	设置ASCII字符的整数倍放大，用于大号数字读数
+ *
+ *	说    明:   1. 影响 LCD_DisplayChar、LCD_DisplayString 以及数字显示函数，LCD_DisplayText/LCD_DisplayChinese 保持原字号
+ *					2. 字模逐行放大后分块写入渲染缓冲区发送，不占用额外的字库空间
+ *					3. 定义 LCD_TEXT_SCALE_SMOOTH 时按Scale2x/Scale3x规则补齐斜边的台阶
+ *					4. 使用示例 LCD_SetTextFont(32); LCD_SetTextScale(3); 显示48x96的数字
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_SetTextScale(uint8_t scale)
+{
+#ifdef LCD_TEXT_SCALE_ENABLE
+	LCD.Text_Scale = (scale >= 1 && scale <= 3) ? scale : 1;
+#else
+	(void)scale;
+#endif
+}
+
+#define LCD_FIXED_DECS 9 // 定点格式化支持的最大小数位数
+
+static const uint32_t LCD_Pow10[LCD_FIXED_DECS + 1] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+/**
+ * @brief  把定点数的绝对值和符号格式化为字符串，显示值为 ±u / 10^decs
+ * @param  neg 1-输出负号，u 为0时同样输出(与 printf 的 "-0.00" 一致)
+ * @param  len 总宽度(含负号、小数点)，不足时按 mode 在前面补空格或补0，与 "%*.*f" / "%0*.*f" 一致
+ * @retval 字符串长度
+ * @note   只用整数运算，结果超过 LCD_NUM_MAX-1 个字符时截断宽度
+ */
+static uint8_t LCD_FormatMagnitude(char *buf, uint64_t u, uint8_t neg, uint8_t len, uint8_t decs, uint8_t mode)
+{
+	char digits[32]; // 逆序存放的数字和小数点(最多19位整数+小数点+9位小数)
+	uint8_t k = 0, n = 0;
+
+	for (uint8_t i = 0; i < decs; i++)
+	{
+		digits[k++] = (char)('0' + u % 10);
+		u /= 10;
+	}
+	if (decs > 0)
+	{
+		digits[k++] = '.';
+	}
+	do
+	{
+		digits[k++] = (char)('0' + u % 10);
+		u /= 10;
+	} while (u != 0);
+
+	if (len > LCD_NUM_MAX - 1)
+	{
+		len = LCD_NUM_MAX - 1;
+	}
+	if (mode != Fill_Zero) // 补空格：空格在负号之前
+	{
+		while (n + k + neg < len)
+			buf[n++] = ' ';
+	}
+	if (neg)
+	{
+		buf[n++] = '-';
+	}
+	if (mode == Fill_Zero) // 补0：0在负号之后
+	{
+		while (n + k < len)
+			buf[n++] = '0';
+	}
+	while (k > 0 && n < LCD_NUM_MAX - 1)
+	{
+		buf[n++] = digits[--k];
+	}
+	buf[n] = 0;
+	return n;
+}
+
+/**
+ * @brief  把定点数格式化为字符串，显示值为 value / 10^decs，格式同 LCD_FormatMagnitude()
+ * @retval 字符串长度
+ */
+static uint8_t LCD_FormatFixed(char *buf, int64_t value, uint8_t len, uint8_t decs, uint8_t mode)
+{
+	uint64_t u = (value < 0) ? (uint64_t)(-(value + 1)) + 1 : (uint64_t)value;
+
+	return LCD_FormatMagnitude(buf, u, (uint8_t)(value < 0), len, decs, mode);
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayNumber
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					number - 要显示的数字,范围在 -2147483648~2147483647 之间
+ *					len - 数字的位数，如果位数超过len，将按其实际长度输出，如果需要显示负数，请预留一个位的符号显示空间
+ *
+ *	函数功能:	在指定坐标显示指定的整数变量
+ *
+ *	说    明:	1. 可设置要显示的字体，例如使用
+ *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0x0000FF) 设置为蓝色
+ *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0x000000) 设置为黑色的背景色
+ *					4. 使用示例 LCD_DisplayNumber( 10, 10, a, 5) ，在坐标(10,10)显示指定变量a,总共5位，多余位补0或空格，
+ *						例如 a=123 时，会根据 LCD_ShowNumMode()的设置来显示  123(前面两个空格位) 或者00123
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayNumber(uint16_t x, uint16_t y, int32_t number, uint8_t len)
+{
+	char Number_Buffer[LCD_NUM_MAX]; // 用于存储转换后的字符串
+
+	// 与 "%0.*d" 一致：补0模式下 len 是数字位数，负号另占一位
+	if (LCD.ShowNum_Mode == Fill_Zero && number < 0 && len < LCD_NUM_MAX - 2)
+	{
+		len++;
+	}
+	LCD_FormatFixed(Number_Buffer, number, len, 0, LCD.ShowNum_Mode); // 将 number 转换成字符串，便于显示
+
+	LCD_DisplayString(x, y, (char *)Number_Buffer); // 将转换得到的字符串显示出来
+}
+
+/***************************************************************************************************************************************
+ *	函 数 名:	LCD_DisplayDecimals
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					decimals - 要显示的数字, double型取值1.7 x 10^（-308）~ 1.7 x 10^（+308），但是能确保准确的有效位数为15~16位
+ *
+ *       			len - 整个变量的总位数（包括小数点和负号），若实际的总位数超过了指定的总位数，将按实际的总长度位输出，
+ *							示例1：小数 -123.123 ，指定 len <=8 的话，则实际照常输出 -123.123
+ *							示例2：小数 -123.123 ，指定 len =10 的话，则实际输出   -123.123(负号前面会有两个空格位)
+ *							示例3：小数 -123.123 ，指定 len =10 的话，当调用函数 LCD_ShowNumMode() 设置为填充0模式时，实际输出 -00123.123
+ *
+ *					decs - 要保留的小数位数，若小数的实际位数超过了指定的小数位，则按指定的宽度四舍五入输出
+ *							 示例：1.12345 ，指定 decs 为4位的话，则输出结果为1.1235
+ *							 舍入规则：decimals 乘以10^decs 后的double值四舍五入，恰好一半时远离0，舍入为0的负数显示 -0.00；
+ *							 printf 按二进制精确值舍入，恰好一半时取偶，因此个别值末位不同，如 0.125 保留2位显示0.13，printf 为 0.12
+ *
+ *	函数功能:	在指定坐标显示指定的变量，包括小数
+ *
+ *	说    明:	1. 可设置要显示的字体，例如使用 
+ *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0x0000FF) 设置为蓝色
+ *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0x000000) 设置为黑色的背景色
+ *					4. 使用示例 LCD_DisplayDecimals( 10, 10, a, 5, 3) ，在坐标(10,10)显示字变量a,总长度为5位，其中保留3位小数
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DisplayDecimals(uint16_t x, uint16_t y, double decimals, uint8_t len, uint8_t decs)
+{
+	char Number_Buffer[LCD_NUM_MAX]; // 用于存储转换后的字符串
+	double scaled = decimals * LCD_Pow10[(decs <= LCD_FIXED_DECS) ? decs : 0];
+
+	if (decs <= LCD_FIXED_DECS && scaled < 9.0e18 && scaled > -9.0e18)
+	{
+		// 放大为整数后按定点数格式化，绝对值加0.5截断；舍入为0的负数保留负号
+		LCD_FormatMagnitude(Number_Buffer, (uint64_t)((scaled < 0 ? -scaled : scaled) + 0.5), (uint8_t)(signbit(decimals) != 0), len,
+							decs, LCD.ShowNum_Mode);
+	}
+	else if (LCD.ShowNum_Mode == Fill_Zero) // 超出定点范围时仍用 sprintf
+	{
+		snprintf(Number_Buffer, sizeof(Number_Buffer), "%0*.*lf", len, decs, decimals);
+	}
+	else
+	{
+		snprintf(Number_Buffer, sizeof(Number_Buffer), "%*.*lf", len, decs, decimals);
+	}
+
+	LCD_DisplayString(x, y, (char *)Number_Buffer); // 将转换得到的字符串显示出来
+}
+
+/**
+ * @brief  LCD_Printf() 的格式化，只用整数运算，不调用libc的printf
+ * @param  size 缓冲区字节数(含结束符)，超出部分截断
+ * @retval 字符串长度
+ * @note   支持 %d %i %u %x %X %c %s %q %%，标志 '-' '0'，宽度和精度可以是数字或 '*'；
+ *         %q 为定点数(int32_t)，精度为小数位数(0-9)，与 LCD_NumberShow() 相同；
+ *         %s 的精度为最多输出的字节数，其余转换忽略精度；h/l 长度修饰按32位处理，不支持浮点
+ */
+static uint16_t LCD_FormatV(char *buf, uint16_t size, const char *fmt, va_list args)
+{
+	uint16_t n = 0;
+
+	while (*fmt != 0 && n < size - 1)
+	{
+		char num[LCD_NUM_MAX]; // 数字和字符先格式化到这里
+		const char *s = num;
+		uint8_t left = 0, zero = 0, padded = 0; // padded：数字已按宽度右对齐
+		int width = 0, prec = -1;
+		uint16_t len = 0;
+
+		if (*fmt != '%')
+		{
+			buf[n++] = *fmt++;
+			continue;
+		}
+		for (fmt++; *fmt == '-' || *fmt == '0'; fmt++)
+		{
+			if (*fmt == '-')
+				left = 1;
+			else
+				zero = 1;
+		}
+		if (*fmt == '*')
+		{
+			width = va_arg(args, int);
+			fmt++;
+			if (width < 0)
+			{
+				left = 1;
+				width = -width;
+			}
+		}
+		while (*fmt >= '0' && *fmt <= '9')
+			width = width * 10 + (*fmt++ - '0');
+		if (*fmt == '.')
+		{
+			prec = 0;
+			if (*++fmt == '*')
+			{
+				prec = va_arg(args, int);
+				fmt++;
+			}
+			while (*fmt >= '0' && *fmt <= '9')
+				prec = prec * 10 + (*fmt++ - '0');
+		}
+		while (*fmt == 'h' || *fmt == 'l')
+			fmt++;
+
+		uint8_t w = left ? 0 : (width < LCD_NUM_MAX - 1) ? (uint8_t)width : LCD_NUM_MAX - 1; // 数字右对齐的宽度
+		uint8_t mode = (zero && !left) ? Fill_Zero : Fill_Space;
+
+		switch (*fmt)
+		{
+		case 'd':
+		case 'i':
+			len = LCD_FormatFixed(num, va_arg(args, int), w, 0, mode);
+			padded = 1;
+			break;
+		case 'u':
+			len = LCD_FormatFixed(num, va_arg(args, unsigned int), w, 0, mode);
+			padded = 1;
+			break;
+		case 'q':
+			len = LCD_FormatFixed(num, va_arg(args, int), w, (prec < 0) ? 0 : (prec > LCD_FIXED_DECS) ? LCD_FIXED_DECS : (uint8_t)prec, mode);
+			padded = 1;
+			break;
+		case 'x':
+		case 'X':
+		{
+			const char *hex = (*fmt == 'x') ? "0123456789abcdef" : "0123456789ABCDEF";
+			uint32_t u = va_arg(args, unsigned int);
+			char digits[8];
+			uint8_t k = 0;
+
+			do
+			{
+				digits[k++] = hex[u & 0xF];
+				u >>= 4;
+			} while (u != 0);
+			while (len + k < w)
+				num[len++] = (mode == Fill_Zero) ? '0' : ' ';
+			while (k > 0)
+				num[len++] = digits[--k];
+			padded = 1;
+			break;
+		}
+		case 'c':
+			num[len++] = (char)va_arg(args, int);
+			break;
+		case 's':
+			s = va_arg(args, const char *);
+			if (s == NULL)
+				s = "(null)";
+			while (s[len] != 0 && (prec < 0 || len < prec))
+				len++;
+			break;
+		case '%':
+			num[len++] = '%';
+			break;
+		default: // 不支持的转换原样输出
+			num[len++] = '%';
+			if (*fmt != 0)
+				num[len++] = *fmt;
+			else
+				fmt--; // 格式串以 '%' 结尾
+			break;
+		}
+		fmt++;
+
+		if (!padded && !left)
+		{
+			while (len < width && n < size - 1)
+			{
+				buf[n++] = ' ';
+				width--;
+			}
+		}
+		for (uint16_t i = 0; i < len && n < size - 1; i++)
+			buf[n++] = s[i];
+		while (left && len < width && n < size - 1)
+		{
+			buf[n++] = ' ';
+			width--;
+		}
+	}
+	buf[n] = 0;
+	return n;
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_Printf
+ *
+ *	入口参数:	x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					fmt - 格式字符串，转换见 LCD_FormatV()，定点数用 %q，例如 "%6.2q" 把 2345 显示为 " 23.45"
+ *
+ *	函数功能:	格式化后按 LCD_DisplayText() 显示，用于带数值的标签
+ *
+ *	说    明:	1. 只用整数运算，不经过 double、sprintf/vsnprintf，格式化一个数值只需几十个周期
+ *					2. 格式化结果放在栈上的 LCD_PRINTF_BYTES 字节缓冲区中，超出部分截断
+ *					3. 缓冲区每次内容不同，不进入按字符串地址缓存的解析结果(LCD_TEXT_MEMO_ENABLE)，
+ *						直接排版和整行合成；保留列表和显示列表会拷贝字符串
+ *					4. 结果只含数字图集中的字符且字宽为半角时，从图集整串发送(LCD_NUM_ATLAS_ENABLE)
+ *					5. 使用示例 LCD_Printf(10, 10, "温度 %4.1q℃ 转速 %5u", temp_x10, rpm)
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_Printf(uint16_t x, uint16_t y, const char *fmt, ...)
+{
+	char buf[LCD_PRINTF_BYTES];
+	va_list args;
+
+	va_start(args, fmt);
+	LCD_FormatV(buf, sizeof(buf), fmt, args);
+	va_end(args);
+
+	if (LCD_RETAIN_RECORD(LCD_RETAIN_TEXT, x, y, 0, 0, buf))
+		return; // 记录到保留列表
+	if (LCD_TILE_RECORD(LCD_OP_DisplayText, x, y, 0, 0, buf, LCD_TILE_STR))
+		return; // 录制到显示列表
+	if (LCD_NUM_ATLAS_DRAW(x, y, buf, 1))
+		return; // 只含数字和常用符号，从图集整串发送
+	LCD_Text_Render(x, y, buf);
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_NumberInit
+ *
+ *	入口参数:	num - 数字控件
+ *					x - 起始水平坐标
+ *					y - 起始垂直坐标
+ *					len - 总位数（含小数点和负号），规则与 LCD_DisplayDecimals() 相同
+ *					decs - 小数位数，0表示整数
+ *
+ *	函数功能:	初始化数字控件，只记录参数，第一次 LCD_NumberShow() 时整体绘制
+ *
+ *	说    明:	使用示例 LCD_NumberInit(&temp, 10, 10, 6, 2) ，在坐标(10,10)显示6位、2位小数的数值
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_NumberInit(LCD_Number_t *num, uint16_t x, uint16_t y, uint8_t len, uint8_t decs)
+{
+	num->X = x;
+	num->Y = y;
+	num->Len = len;
+	num->Decs = (decs <= LCD_FIXED_DECS) ? decs : LCD_FIXED_DECS;
+	num->Scale = 1;
+	num->Text[0] = 0;
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_NumberInvalidate
+ *
+ *	入口参数:	num - 数字控件
+ *
+ *	函数功能:	使数字控件下次整体重绘
+ *
+ *	说    明:	清屏或控件所在区域被其他内容覆盖后调用
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_NumberInvalidate(LCD_Number_t *num)
+{
+	num->Text[0] = 0;
+}
+
+/*****************************************************************************************************************************************
+ *	函 数 名:	LCD_NumberShow
+ *
+ *	入口参数:	num - 数字控件
+ *					value - 定点数，显示值为 value / 10^decs
+ *
+ *	函数功能:	更新数字控件，只重绘与上次显示不同的字符
+ *
+ *	说    明:	1. 全程整数运算，不经过 double 和 sprintf
+ *					2. 例如 "1234" 变为 "1235" 时只发送最后一位；变短时多出的位置用背景色清除
+ *					3. 字体、放大倍数、画笔色或背景色与上次不同时整体重绘
+ *					4. 使用示例 LCD_NumberShow(&temp, 2345) ，decs=2 时显示 23.45
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_NumberShow(LCD_Number_t *num, int32_t value)
+{
+	char Number_Buffer[LCD_NUM_MAX]; // 本次的字符串
+	uint8_t scale = LCD_ASCII_SCALE;
+	uint16_t width = LCD_AsciiFonts->Width * scale;
+	uint8_t n, old_n, i = 0;
+
+	n = LCD_FormatFixed(Number_Buffer, value, num->Len, num->Decs, LCD.ShowNum_Mode);
+
+	if (num->Text[0] == 0 || num->Font != LCD_AsciiFonts || num->Scale != scale || num->Color != LCD.Color ||
+		num->BackColor != LCD.BackColor)
+	{
+		old_n = (num->Text[0] != 0 && num->Font == LCD_AsciiFonts && num->Scale == scale) ? (uint8_t)strlen(num->Text) : 0;
+		LCD_DisplayString(num->X, num->Y, Number_Buffer); // 整体重绘
+	}
+	else
+	{
+		old_n = (uint8_t)strlen(num->Text);
+		while (i < n) // 逐段重绘不同的字符
+		{
+			uint8_t start, end;
+			char saved;
+
+			if (i < old_n && Number_Buffer[i] == num->Text[i])
+			{
+				i++;
+				continue;
+			}
+			start = i;
+			while (i < n && (i >= old_n || Number_Buffer[i] != num->Text[i]))
+				i++;
+			end = i;
+
+			saved = Number_Buffer[end];
+			Number_Buffer[end] = 0;
+			LCD_DisplayString(num->X + start * width, num->Y, &Number_Buffer[start]);
+			Number_Buffer[end] = saved;
+		}
+	}
+
+	if (old_n > n) // 变短时清除多出的字符
+	{
+		LCD_ClearRect(num->X + n * width, num->Y, (old_n - n) * width, LCD_AsciiFonts->Height * scale);
+	}
+
+	memcpy(num->Text, Number_Buffer, n + 1);
+	num->Font = LCD_AsciiFonts;
+	num->Scale = scale;
+	num->Color = LCD.Color;
+	num->BackColor = LCD.BackColor;
+}
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawLine
+ *
+ *	入口参数: x1 - 起点 水平坐标
+ *			 	 y1 - 起点 垂直坐标
+ *
+ *				 x2 - 终点 水平坐标
+ *            y2 - 终点 垂直坐标
+ *
+ *	函数功能: 在两点之间画线
+ *
+ *	说    明: 1. 该函数移植于ST官方评估板的例程
+ *				 2. Bresenham 逐点推进，但不逐点发送：同一行(平缓的线)或同一列(陡峭的线)上
+ *				    连续的点合并为一段，每段只设置一次窗口并用 LCD_WriteColor() 连续发送，
+ *				    水平线、垂直线只有一段，45度斜线每个点一段
+ *
+ *****************************************************************************************************************************************/
+
+#define ABS(X) ((X) > 0 ? (X) : -(X))
+
+/**
+ * @brief  画线时发送一段同色的水平或垂直线段
+ * @param  x y 线段左端或上端的坐标
+ * @param  horizontal 1-水平线段，0-垂直线段
+ */
+static void LCD_DrawLineRun(uint16_t x, uint16_t y, uint16_t len, uint8_t horizontal)
+{
+	if (horizontal)
+		LCD_SetAddress(x, y, x + len - 1, y);
+	else
+		LCD_SetAddress(x, y, x, y + len - 1);
+	LCD_WriteColor((uint16_t)LCD.Color, len);
+}
+
+void LCD_DrawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+	int16_t deltax = 0, deltay = 0, x = 0, y = 0, xinc1 = 0, xinc2 = 0,
+			yinc1 = 0, yinc2 = 0, den = 0, num = 0, numadd = 0, numpixels = 0,
+			curpixel = 0, run_x = 0, run_y = 0;
+	uint16_t run_len = 0;
+	uint8_t horizontal;
+
+	if (LCD_TILE_RECORD(LCD_OP_DrawLine, x1, y1, x2, y2, NULL, 0))
+		return; // 录制到显示列表
+
+	deltax = ABS(x2 - x1); /* The difference between the x's */
+	deltay = ABS(y2 - y1); /* The difference between the y's */
+	x = x1;				   /* Start x off at the first pixel */
+	y = y1;				   /* Start y off at the first pixel */
+
+	if (x2 >= x1) /* The x-values are increasing */
+	{
+		xinc1 = 1;
+		xinc2 = 1;
+	}
+	else /* The x-values are decreasing */
+	{
+		xinc1 = -1;
+		xinc2 = -1;
+	}
+
+	if (y2 >= y1) /* The y-values are increasing */
+	{
+		yinc1 = 1;
+		yinc2 = 1;
+	}
+	else /* The y-values are decreasing */
+	{
+		yinc1 = -1;
+		yinc2 = -1;
+	}
+
+	if (deltax >= deltay) /* There is at least one x-value for every y-value */
+	{
+		xinc1 = 0; /* Don't change the x when numerator >= denominator */
+		yinc2 = 0; /* Don't change the y for every iteration */
+		den = deltax;
+		num = deltax / 2;
+		numadd = deltay;
+		numpixels = deltax; /* There are more x-values than y-values */
+	}
+	else /* There is at least one y-value for every x-value */
+	{
+		xinc2 = 0; /* Don't change the x for every iteration */
+		yinc1 = 0; /* Don't change the y when numerator >= denominator */
+		den = deltay;
+		num = deltay / 2;
+		numadd = deltax;
+		numpixels = deltay; /* There are more y-values than x-values */
+	}
+	horizontal = (deltax >= deltay);
+	for (curpixel = 0; curpixel <= numpixels; curpixel++)
+	{
+		if (run_len == 0)
+		{
+			run_x = x; /* Start a new run at the current pixel */
+			run_y = y;
+		}
+		run_len++;
+		num += numadd; /* Increase the numerator by the top of the fraction */
+		if (num >= den) /* Check if numerator >= denominator */
+		{
+			num -= den; /* Calculate the new numerator value */
+			x += xinc1; /* Change the x as appropriate */
+			y += yinc1; /* Change the y as appropriate */
+		}
+		x += xinc2; /* Change the x as appropriate */
+		y += yinc2; /* Change the y as appropriate */
+
+		// 次坐标变化或到达终点时，发送已累积的一段
+		if ((horizontal ? (y != run_y) : (x != run_x)) || curpixel == numpixels)
+		{
+			if (horizontal)
+				LCD_DrawLineRun((xinc2 > 0) ? run_x : run_x - run_len + 1, run_y, run_len, 1);
+			else
+				LCD_DrawLineRun(run_x, (yinc2 > 0) ? run_y : run_y - run_len + 1, run_len, 0);
+			run_len = 0;
+		}
+	}
+}
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawPolyline
+ *
+ *	入口参数: points - 顶点数组的首地址
+ *				 count - 顶点个数
+ *
+ *	函数功能: 依次连接各顶点画折线
+ *
+ *	说    明: 1. 每段由 LCD_DrawLine 绘制，超出屏幕和裁剪区的部分不绘制
+ *				 2. 显示列表只记录顶点数组的地址，LCD_TileEnd() 之前不要修改
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DrawPolyline(const LCD_Point_t *points, uint16_t count)
+{
+	if (LCD_TILE_RECORD(LCD_OP_DrawPolyline, count, 0, 0, 0, points, 0))
+		return; // 录制到显示列表
+
+	if (count == 1)
+	{
+		LCD_DrawPoint(points[0].x, points[0].y, LCD.Color);
+		return;
+	}
+	for (uint16_t i = 1; i < count; i++)
+	{
+		LCD_DrawLine(points[i - 1].x, points[i - 1].y, points[i].x, points[i].y);
+	}
+}
+
+/**
+ * @brief  折线在第 t 列(0 <= t <= dx)的纵坐标，y0 y1 为所在段两端的采样值
+ */
+static int32_t LCD_Plot_Lerp(int32_t y0, int32_t y1, uint16_t t, uint16_t dx)
+{
+	return y0 + (y1 - y0) * t / dx;
+}
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_PlotSeries
+ *
+ *	入口参数: y - 采样值数组，每个值为屏幕垂直坐标
+ *				 n - 采样个数
+ *				 x0 - 第一个采样所在的水平坐标
+ *				 dx - 相邻采样的水平间距，0按1处理
  *
- *	说    明:	先用 LCD_SetBackColor() 设置要清除的背景色，再调用该函数清屏即可
+ *	函数功能: 按列绘制趋势图/示波器曲线，同时擦除该列原来的内容
+ *
+ *	说    明: 1. 绘图区的高度为当前裁剪区与屏幕的交集(未设置裁剪区时为整屏高度)，
+ *				    宽度为 x0 到 x0 + (n-1)*dx，先用 LCD_SetClip() 把裁剪区设为曲线所在的区域
+ *				 2. 每列只有一段画笔色：从该列到下一列之间曲线经过的最低点到最高点，
+ *				    其余部分为背景色，不需要先清除旧曲线，滚动的曲线每帧直接重画即可
+ *				 3. 相邻的若干列在渲染缓冲区中拼成一条，整条只设置一次窗口，由DMA发送
+ *				 4. 超出绘图区的部分不绘制；显示列表只记录 y 的地址，LCD_TileEnd() 之前不要修改
  *
  *****************************************************************************************************************************************/
 
-void LCD_Clear(void)
+void LCD_PlotSeries(const int16_t *y, uint16_t n, uint16_t x0, uint16_t dx)
 {
-	LCD_SetAddress(0, 0, LCD.Width - 1, LCD.Height - 1); // 设置坐标
+	int32_t top, bottom, first, last;
+	uint16_t height, cols;
+
+	if (LCD_TILE_RECORD(LCD_OP_PlotSeries, n, x0, dx, 0, y, 0))
+		return; // 录制到显示列表
+
+	if (n == 0)
+		return;
+	if (dx == 0)
+		dx = 1;
+
+	// 绘图区：裁剪区与屏幕的交集
+	top = LCD_Clip.y1;
+	bottom = (LCD_Clip.y2 < LCD.Height) ? LCD_Clip.y2 : LCD.Height - 1;
+	first = (x0 > LCD_Clip.x1) ? x0 : LCD_Clip.x1;
+	last = (int32_t)x0 + (int32_t)(n - 1) * dx;
+	if (last > LCD_Clip.x2)
+		last = LCD_Clip.x2;
+	if (last > LCD.Width - 1)
+		last = LCD.Width - 1;
+	if (top > bottom || first > last)
+		return;
+
+	height = bottom - top + 1;
+	cols = LCD_BUFF_PIXELS / height; // 每条容纳的列数
+
+	for (int32_t cx = first; cx <= last; cx += cols)
+	{
+		uint16_t w = (last - cx + 1 < cols) ? (last - cx + 1) : cols;
+		uint16_t *pBuff = LCD_NextBuff(); // 取得空闲的缓冲区
 
-	LCD_DC_Data; // 数据指令选择 引脚输出高电平，代表本次传输 数据
+		for (uint16_t k = 0; k < w; k++)
+		{
+			uint32_t off = cx + k - x0;
+			uint16_t i = off / dx, t = off % dx;
+			int32_t ya, yb, lo, hi;
+			uint16_t *p = pBuff + k;
 
-	// 修改为16位数据宽度，写入数据更加效率，不需要拆分
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_16BIT; //	16位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
+			if (i + 1 < n)
+			{
+				ya = LCD_Plot_Lerp(y[i], y[i + 1], t, dx);
+				yb = LCD_Plot_Lerp(y[i], y[i + 1], t + 1, dx);
+			}
+			else
+			{
+				ya = yb = y[i]; // 最后一个采样
+			}
+			lo = (ya < yb) ? ya : yb;
+			hi = (ya < yb) ? yb : ya;
+			if (lo < top)
+				lo = top;
+			if (hi > bottom)
+				hi = bottom;
+
+			for (int32_t r = top; r <= bottom; r++, p += w)
+			{
+				*p = (r >= lo && r <= hi) ? LCD.Color : LCD.BackColor;
+			}
+		}
+		LCD_SetAddress(cx, top, cx + w - 1, bottom); // 设置坐标
+		LCD_WriteBuff(pBuff, w * height);			 // 写入显存
+	}
+}
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawLine_V
+ *
+ *	入口参数: x - 水平坐标
+ *			 	 y - 垂直坐标
+ *				 height - 垂直宽度
+ *
+ *	函数功能: 在指点位置绘制指定长宽的 垂直 线
+ *
+ *	说    明: 1. 该函数移植于ST官方评估板的例程
+ *				 2. 超出屏幕和裁剪区的部分不绘制
+ *            3. 如果只是画垂直的线，优先使用此函数，速度比 LCD_DrawLine 快很多
+ *  性能测试：
+ *****************************************************************************************************************************************/
 
-	LCD_SPI_Transmit(&LCD_SPI, LCD.BackColor, LCD.Width * LCD.Height); // 启动传输
+void LCD_DrawLine_V(uint16_t x, uint16_t y, uint16_t height)
+{
+	if (LCD_TILE_RECORD(LCD_OP_DrawLine_V, x, y, height, 0, NULL, 0))
+		return; // 录制到显示列表
 
-	// 改回8位数据宽度，因为指令和部分数据都是按照8位传输的
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_8BIT; //	8位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
+	if (height == 0)
+		return;
+	LCD_SetAddress(x, y, x, y + height - 1);   // 设置坐标
+	LCD_WriteColor((uint16_t)LCD.Color, height); // 同色连续发送，不经过渲染缓冲区
 }
 
-/****************************************************************************************************************************************
- *	函 数 名:	LCD_ClearRect
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawLine_H
  *
- *	入口参数:	x - 起始水平坐标
- *					y - 起始垂直坐标
- *					width  - 要清除区域的横向长度
- *					height - 要清除区域的纵向宽度
+ *	入口参数: x - 水平坐标
+ *			 	 y - 垂直坐标
+ *				 width  - 水平宽度
  *
- *	函数功能:	局部清屏函数，将指定位置对应的区域清除为 LCD.BackColor 的颜色
+ *	函数功能: 在指点位置绘制指定长宽的 水平 线
  *
- *	说    明:	1. 先用 LCD_SetBackColor() 设置要清除的背景色，再调用该函数清屏即可
- *				   2. 使用示例 LCD_ClearRect( 10, 10, 100, 50) ，清除坐标(10,10)开始的长100宽50的区域
+ *	说    明: 1. 该函数移植于ST官方评估板的例程
+ *				 2. 超出屏幕和裁剪区的部分不绘制
+ *            3. 如果只是画 水平 的线，优先使用此函数，速度比 LCD_DrawLine 快很多
+ *  性能测试：
+ ***********************************************************************************************************************************/
+
+void LCD_DrawLine_H(uint16_t x, uint16_t y, uint16_t width)
+{
+	if (LCD_TILE_RECORD(LCD_OP_DrawLine_H, x, y, width, 0, NULL, 0))
+		return; // 录制到显示列表
+
+	if (width == 0)
+		return;
+	LCD_SetAddress(x, y, x + width - 1, y);   // 设置坐标
+	LCD_WriteColor((uint16_t)LCD.Color, width); // 同色连续发送，不经过渲染缓冲区
+}
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawRect
+ *
+ *	入口参数: x - 水平坐标
+ *			 	 y - 垂直坐标
+ *			 	 width  - 水平宽度
+ *				 height - 垂直宽度
+ *
+ *	函数功能: 在指点位置绘制指定长宽的矩形线条
+ *
+ *	说    明: 1. 该函数移植于ST官方评估板的例程
+ *				 2. 超出屏幕和裁剪区的部分不绘制
  *
  *****************************************************************************************************************************************/
 
-void LCD_ClearRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+void LCD_DrawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
 {
-	LCD_SetAddress(x, y, x + width - 1, y + height - 1); // 设置坐标
+	if (LCD_TILE_RECORD(LCD_OP_DrawRect, x, y, width, height, NULL, 0))
+		return; // 录制到显示列表
 
-	LCD_DC_Data; // 数据指令选择 引脚输出高电平，代表本次传输 数据
+	// 绘制水平线
+	LCD_DrawLine_H(x, y, width);
+	LCD_DrawLine_H(x, y + height - 1, width);
 
-	// 修改为16位数据宽度，写入数据更加效率，不需要拆分
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_16BIT; //	16位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
+	// 绘制垂直线
+	LCD_DrawLine_V(x, y, height);
+	LCD_DrawLine_V(x + width - 1, y, height);
+}
+
+/**
+ * @brief  用画笔色填充矩形 [x1,x2] x [y1,y2]，坐标可以为负，屏幕左侧和上方的部分丢弃
+ * @note   圆、椭圆的线段都经过这里：一次窗口设置加一段同色像素
+ */
+static void LCD_DrawSpan(int x1, int y1, int x2, int y2)
+{
+	if (x2 < 0 || y2 < 0)
+		return;
+	if (x1 < 0)
+		x1 = 0;
+	if (y1 < 0)
+		y1 = 0;
+	LCD_SetAddress(x1, y1, x2, y2);
+	LCD_WriteColor((uint16_t)LCD.Color, (uint32_t)(x2 - x1 + 1) * (y2 - y1 + 1));
+}
 
-	LCD_SPI_Transmit(&LCD_SPI, LCD.BackColor, width * height); // 启动传输
+/**
+ * @brief  圆、椭圆轮廓的线段累积：按一个象限内相对圆心的偏移(dx,dy >= 0)逐点加入，
+ *         同一行或同一列上相邻的点合并为一段，结束时按四个象限对称发送
+ */
+typedef struct
+{
+	int cx, cy;			   /*!< 圆心 */
+	int x0, x1, y0, y1;	   /*!< 当前线段的偏移范围，只有一行或一列 */
+	uint8_t used;		   /*!< 是否已有点 */
+} LCD_Outline_t;
 
-	// 改回8位数据宽度，因为指令和部分数据都是按照8位传输的
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_8BIT; //	8位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
+/**
+ * @brief  发送当前线段及其在另外三个象限的对称线段，偏移为0的一侧两个象限重合，只发送一次
+ */
+static void LCD_Outline_Flush(LCD_Outline_t *o)
+{
+	int cx = o->cx, cy = o->cy;
+
+	if (!o->used)
+		return;
+	o->used = 0;
+	if (o->x0 == 0 && o->y0 == 0)
+	{
+		LCD_DrawSpan(cx - o->x1, cy - o->y1, cx + o->x1, cy + o->y1); // 跨过两条对称轴
+	}
+	else if (o->x0 == 0)
+	{
+		LCD_DrawSpan(cx - o->x1, cy + o->y0, cx + o->x1, cy + o->y1); // 跨过垂直对称轴
+		LCD_DrawSpan(cx - o->x1, cy - o->y1, cx + o->x1, cy - o->y0);
+	}
+	else if (o->y0 == 0)
+	{
+		LCD_DrawSpan(cx + o->x0, cy - o->y1, cx + o->x1, cy + o->y1); // 跨过水平对称轴
+		LCD_DrawSpan(cx - o->x1, cy - o->y1, cx - o->x0, cy + o->y1);
+	}
+	else
+	{
+		LCD_DrawSpan(cx + o->x0, cy + o->y0, cx + o->x1, cy + o->y1);
+		LCD_DrawSpan(cx - o->x1, cy + o->y0, cx - o->x0, cy + o->y1);
+		LCD_DrawSpan(cx + o->x0, cy - o->y1, cx + o->x1, cy - o->y0);
+		LCD_DrawSpan(cx - o->x1, cy - o->y1, cx - o->x0, cy - o->y0);
+	}
 }
 
-/****************************************************************************************************************************************
- *	函 数 名:	LCD_DrawPoint
+/**
+ * @brief  加入一个偏移点，与当前线段同行或同列且相邻时延长线段，否则先发送当前线段
+ */
+static void LCD_Outline_Add(LCD_Outline_t *o, int dx, int dy)
+{
+	if (o->used)
+	{
+		if (dx >= o->x0 && dx <= o->x1 && dy >= o->y0 && dy <= o->y1)
+			return; // 重复的点
+		if (o->y0 == o->y1 && dy == o->y0 && (dx == o->x0 - 1 || dx == o->x1 + 1))
+		{
+			if (dx < o->x0)
+				o->x0 = dx;
+			else
+				o->x1 = dx;
+			return;
+		}
+		if (o->x0 == o->x1 && dx == o->x0 && (dy == o->y0 - 1 || dy == o->y1 + 1))
+		{
+			if (dy < o->y0)
+				o->y0 = dy;
+			else
+				o->y1 = dy;
+			return;
+		}
+		LCD_Outline_Flush(o);
+	}
+	o->x0 = o->x1 = dx;
+	o->y0 = o->y1 = dy;
+	o->used = 1;
+}
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawCircle
  *
- *	入口参数:	x - 起始水平坐标
- *					y - 起始垂直坐标
- *					color  - 要绘制的颜色，使用 24位 RGB888 的颜色格式，用户无需关心颜色格式的转换
+ *	入口参数: x - 圆心 水平坐标
+ *			 	 y - 圆心 垂直坐标
+ *			 	 r  - 半径
  *
- *	函数功能:	在指定坐标绘制指定颜色的点
+ *	函数功能: 在坐标 (x,y) 绘制半径为 r 的圆形线条
  *
- *	说    明:	使用示例 LCD_DrawPoint( 10, 10, 0x0000FF) ，在坐标(10,10)绘制蓝色的点
+ *	说    明: 1. 该函数移植于ST官方评估板的例程
+ *				 2. 超出屏幕和裁剪区的部分不绘制
+ *				 3. 只计算一个象限，顶部、底部同一行和左右两侧同一列上相邻的点合并为一段，
+ *				    按四个象限对称发送，每段一次窗口设置
  *
  *****************************************************************************************************************************************/
 
-void LCD_DrawPoint(uint16_t x, uint16_t y, uint32_t color)
+void LCD_DrawCircle(uint16_t x, uint16_t y, uint16_t r)
 {
-	LCD_SetAddress(x, y, x, y); //	设置坐标
+	int Xadd = -r, Yadd = 0, err = 2 - 2 * r, e2;
+	LCD_Outline_t outline = {x, y, 0, 0, 0, 0, 0};
 
-	LCD_WriteData_16bit(color);
+	if (LCD_TILE_RECORD(LCD_OP_DrawCircle, x, y, r, 0, NULL, 0))
+		return; // 录制到显示列表
+
+	do
+	{
+		LCD_Outline_Add(&outline, -Xadd, Yadd); // 四个象限对称
+
+		e2 = err;
+		if (e2 <= Yadd)
+		{
+			err += ++Yadd * 2 + 1;
+			if (-Xadd == Yadd && e2 <= Xadd)
+				e2 = 0;
+		}
+		if (e2 > Xadd)
+			err += ++Xadd * 2 + 1;
+	} while (Xadd <= 0);
+	LCD_Outline_Flush(&outline);
+}
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawEllipse
+ *
+ *	入口参数: x - 圆心 水平坐标
+ *			 	 y - 圆心 垂直坐标
+ *			 	 r1  - 水平半轴的长度
+ *				 r2  - 垂直半轴的长度
+ *
+ *	函数功能: 在坐标 (x,y) 绘制水平半轴为 r1 垂直半轴为 r2 的椭圆线条
+ *
+ *	说    明: 1. 该函数移植于ST官方评估板的例程
+ *				 2. 超出屏幕和裁剪区的部分不绘制
+ *				 3. 与 LCD_DrawCircle 相同，相邻的点合并为一段后按四个象限对称发送
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DrawEllipse(int x, int y, int r1, int r2)
+{
+	int Xadd = -r1, Yadd = 0, err = 2 - 2 * r1, e2;
+	float K = 0, rad1 = 0, rad2 = 0;
+	LCD_Outline_t outline = {x, y, 0, 0, 0, 0, 0};
+
+	if (LCD_TILE_RECORD(LCD_OP_DrawEllipse, x, y, r1, r2, NULL, 0))
+		return; // 录制到显示列表
+
+	rad1 = r1;
+	rad2 = r2;
+
+	if (r1 > r2)
+	{
+		do
+		{
+			K = (float)(rad1 / rad2);
+
+			LCD_Outline_Add(&outline, -Xadd, (uint16_t)(Yadd / K)); // 四个象限对称
+
+			e2 = err;
+			if (e2 <= Yadd)
+			{
+				err += ++Yadd * 2 + 1;
+				if (-Xadd == Yadd && e2 <= Xadd)
+					e2 = 0;
+			}
+			if (e2 > Xadd)
+				err += ++Xadd * 2 + 1;
+		} while (Xadd <= 0);
+	}
+	else
+	{
+		Yadd = -r2;
+		Xadd = 0;
+		do
+		{
+			K = (float)(rad2 / rad1);
+
+			LCD_Outline_Add(&outline, (uint16_t)(Xadd / K), -Yadd); // 四个象限对称
+
+			e2 = err;
+			if (e2 <= Xadd)
+			{
+				err += ++Xadd * 3 + 1;
+				if (-Yadd == Xadd && e2 <= Yadd)
+					e2 = 0;
+			}
+			if (e2 > Yadd)
+				err += ++Yadd * 3 + 1;
+		} while (Yadd <= 0);
+	}
+	LCD_Outline_Flush(&outline);
+}
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_FillCircle
+ *
+ *	入口参数: x - 圆心 水平坐标
+ *			 	 y - 圆心 垂直坐标
+ *			 	 r  - 半径
+ *
+ *	函数功能: 在坐标 (x,y) 填充半径为 r 的圆形区域
+ *
+ *	说    明: 1. 该函数移植于ST官方评估板的例程
+ *				 2. 超出屏幕和裁剪区的部分不绘制
+ *				 3. 按列填充，每列一次窗口设置加一段同色像素(长的一段由DMA发送)；
+ *				    靠近左右两侧的列只在该列最后一次出现时发送最长的一段，不再重复覆盖
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_FillCircle(uint16_t x, uint16_t y, uint16_t r)
+{
+	int32_t D;	   /* Decision Variable */
+	uint32_t CurX; /* Current X Value */
+	uint32_t CurY; /* Current Y Value */
+
+	if (LCD_TILE_RECORD(LCD_OP_FillCircle, x, y, r, 0, NULL, 0))
+		return; // 录制到显示列表
+
+	D = 3 - (r << 1);
+
+	CurX = 0;
+	CurY = r;
+
+	while (CurX <= CurY)
+	{
+		if (CurY > 0)
+		{
+			LCD_DrawSpan(x - CurX, y - CurY, x - CurX, y + CurY - 1);
+			if (CurX > 0)
+				LCD_DrawSpan(x + CurX, y - CurY, x + CurX, y + CurY - 1);
+		}
+
+		// 同一个 CurY 对应的两列随 CurX 增长，只发送最后也是最长的一次
+		if (CurX > 0 && (D >= 0 || CurX + 1 > CurY))
+		{
+			LCD_DrawSpan(x - CurY, y - CurX, x - CurY, y + CurX - 1);
+			LCD_DrawSpan(x + CurY, y - CurX, x + CurY, y + CurX - 1);
+		}
+		if (D < 0)
+		{
+			D += (CurX << 2) + 6;
+		}
+		else
+		{
+			D += ((CurX - CurY) << 2) + 10;
+			CurY--;
+		}
+		CurX++;
+	}
+	LCD_DrawCircle(x, y, r);
 }
 
-
-
-/****************************************************************************************************************************************
- *	函 数 名:	LCD_DisplayString
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_FillRect
  *
- *	入口参数:	x - 起始水平坐标
- *					y - 起始垂直坐标
- *					p - ASCII字符串的首地址
+ *	入口参数: x - 水平坐标
+ *			 	 y - 垂直坐标
+ *			 	 width  - 水平宽度
+ *				 height -垂直宽度
  *
- *	函数功能:	在指定坐标显示指定的字符串
+ *	函数功能: 在坐标 (x,y) 填充指定长宽的实心矩形
  *
- *	说    明:	1. 可设置要显示的字体，例如使用
- *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0x0000FF) 设置为蓝色
- *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0x000000) 设置为黑色的背景色
- *					4. 使用示例 LCD_DisplayString( 10, 10, "hello") ，在起始坐标为(10,10)的地方显示字符串"hello"
+ *	说    明: 超出屏幕和裁剪区的部分不绘制
  *
  *****************************************************************************************************************************************/
 
-void LCD_DisplayString(uint16_t x, uint16_t y, char *p)
+void LCD_FillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
 {
-	while ((x < LCD.Width) && (*p != 0)) // 判断显示坐标是否超出显示区域并且字符是否为空字符
-	{
-		LCD_DisplayChar(x, y, *p);
-		x += LCD_AsciiFonts->Width; // 显示下一个字符
-		p++;						// 取下一个字符地址
-	}
+	if (LCD_RETAIN_RECORD(LCD_RETAIN_FILL, x, y, width, height, NULL))
+		return; // 记录到保留列表
+	if (LCD_TILE_RECORD(LCD_OP_FillRect, x, y, width, height, NULL, 0))
+		return; // 录制到显示列表
+
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1); // 设置坐标
+	LCD_WriteColor((uint16_t)LCD.Color, (uint32_t)width * height); // 写入帧缓冲，或由DMA/CPU发送
 }
 
-/****************************************************************************************************************************************
- *	函 数 名:	LCD_SetTextFont
- *
- *	入口参数:	font_size - 字体大小 (12/16/20/24/32)
- *
- *	函数功能:	通过数字直接设置中英文字体大小
- *
- *	说    明:	1. 输入数字自动匹配 ASCII_Font 和 CH_Font
- *					2. 使用示例: LCD_SetTextFont(24) 设置24号字体
- *					3. 如果输入无效大小，默认使用12号字体
- *
- *****************************************************************************************************************************************/
+// 渐变插值：8位分量按16.16定点逐项累加，两端颜色准确
+typedef struct
+{
+	int32_t Acc[3];	 // 当前的R、G、B
+	int32_t Step[3]; // 每项的增量
+} LCD_Ramp_t;
 
-void LCD_SetTextFont(uint8_t font_size)
+/**
+ * @brief  从 c1 到 c2 共 n 项的插值，RGB565两端先扩展为8位分量(高位复制到低位)
+ */
+static void LCD_Ramp_Init(LCD_Ramp_t *ramp, uint16_t c1, uint16_t c2, uint16_t n)
 {
-	switch (font_size)
+	int32_t a[3], b[3];
+
+	a[0] = ((c1 >> 8) & 0xF8) | (c1 >> 13);
+	a[1] = ((c1 >> 3) & 0xFC) | ((c1 >> 9) & 0x03);
+	a[2] = ((c1 << 3) & 0xF8) | ((c1 >> 2) & 0x07);
+	b[0] = ((c2 >> 8) & 0xF8) | (c2 >> 13);
+	b[1] = ((c2 >> 3) & 0xFC) | ((c2 >> 9) & 0x03);
+	b[2] = ((c2 << 3) & 0xF8) | ((c2 >> 2) & 0x07);
+	for (uint8_t i = 0; i < 3; i++)
 	{
-	case 12:
-		LCD_AsciiFonts = &ASCII_Font12;
-		LCD_CHFonts = &CH_Font12;
-		break;
-	case 16:
-		LCD_AsciiFonts = &ASCII_Font16;
-		LCD_CHFonts = &CH_Font16;
-		break;
-	case 20:
-		LCD_AsciiFonts = &ASCII_Font20;
-		LCD_CHFonts = &CH_Font20;
-		break;
-	case 24:
-		LCD_AsciiFonts = &ASCII_Font24;
-		LCD_CHFonts = &CH_Font24;
-		break;
-	case 32:
-		LCD_AsciiFonts = &ASCII_Font32;
-		LCD_CHFonts = &CH_Font32;
-		break;
-	default:
-		LCD_AsciiFonts = &ASCII_Font12;
-		LCD_CHFonts = &CH_Font12;
-		break;
+		ramp->Acc[i] = (a[i] << 16) + 0x8000; // 取整数部分时四舍五入
+		ramp->Step[i] = (n > 1) ? ((b[i] - a[i]) * 65536) / (n - 1) : 0;
 	}
 }
 
 /**
- * @brief  获取当前中文字体大小
- * @note   内部函数,用于Flash字库模式
+ * @brief  取出下一项(RGB565)并前进
  */
-uint8_t LCD_GetChineseFontSize(void)
+static inline uint16_t LCD_Ramp_Next(LCD_Ramp_t *ramp)
 {
-	if (LCD_CHFonts != NULL)
-	{
-		return LCD_CHFonts->Width;
-	}
-	return 12; // 默认12号字体
+	uint16_t c = (uint16_t)(((ramp->Acc[0] >> 8) & 0xF800) | ((ramp->Acc[1] >> 13) & 0x07E0) | (ramp->Acc[2] >> 19));
+
+	ramp->Acc[0] += ramp->Step[0];
+	ramp->Acc[1] += ramp->Step[1];
+	ramp->Acc[2] += ramp->Step[2];
+	return c;
 }
-#ifdef USE_FLASH_FONT
+
 /**
- * @brief  绘制字模到LCD(支持12/16/20/24/32)
- * @note   内部函数,用于Flash字库模式
+ * @brief  LCD_FillGradient() 的绘制部分，两端为RGB565
+ * @note   显示列表把两端颜色作为录制时的画笔色/背景色保存，回放时直接调用本函数
  */
-static void DrawFont_Bitmap(uint16_t x, uint16_t y, uint16_t width,
-                            uint16_t height, const uint8_t *pData) {
-  uint16_t i = 0;
-  // 计算每行占用的字节数。例如宽度12，(12+7)/8 = 2字节
-  uint16_t bytes_per_row = (width + 7) / 8;
-  uint16_t total_bytes = bytes_per_row * height;
+static void LCD_Gradient565(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t c1, uint16_t c2,
+							uint8_t dir)
+{
+	LCD_Ramp_t ramp;
 
-  // 设置显示区域 (根据实际宽高)
-  LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+	if (width == 0 || height == 0 || (dir == LCD_GRADIENT_H && width > LCD_BUFF_PIXELS))
+		return;
 
-  // 逐字节解析字模数据
-  for (uint16_t byte_idx = 0; byte_idx < total_bytes; byte_idx++) {
-    uint8_t byte_data = pData[byte_idx];
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1); // 整个区域只设置一次窗口
+	if (!LCD_FB_CAPTURE() && LCD_Clip_Mode == LCD_CLIP_DROP)
+		return; // 完全不可见，不生成
 
-    // 每个字节代表8个像素点
-    for (uint8_t bit = 0; bit < 8; bit++) {
-      if (byte_data & (0x01 << bit)) {
-        LCD_Buff[i] = LCD.Color; // 前景色
-      } else {
-        LCD_Buff[i] = LCD.BackColor; // 背景色
-      }
-      i++;
+	if (dir != LCD_GRADIENT_H)
+	{
+		// 垂直渐变每行同色，转换为RGB565后相同的相邻行合并为一次同色填充
+		uint16_t color, run = 1;
 
-      // 如果当前像素点计数 能够整除 宽度，说明这一行画完了
-      // 注意：这里必须处理非8倍数宽度的对齐问题
-      // 例如宽度12，画完12个点后，i=12，此时虽然字节里还有位没读完，但应该跳到下一行
-      if (i % width == 0) {
-        break; // 跳出内层循环，进入下一个字节（或下一行的起始字节）
-      }
-    }
-  }
+		LCD_Ramp_Init(&ramp, c1, c2, height);
+		color = LCD_Ramp_Next(&ramp);
+		for (uint16_t row = 1; row < height; row++)
+		{
+			uint16_t next = LCD_Ramp_Next(&ramp);
+
+			if (next != color)
+			{
+				LCD_WriteColor(color, (uint32_t)width * run);
+				color = next;
+				run = 0;
+			}
+			run++;
+		}
+		LCD_WriteColor(color, (uint32_t)width * run);
+		return;
+	}
+
+	// 水平渐变各行相同：每个缓冲区生成第一行，其余行复制
+	for (uint16_t left = height, rows; left > 0; left -= rows)
+	{
+		uint16_t *pBuff = LCD_NextBuff(); // 另一个缓冲区可能仍在发送，不用等待
 
-  // 批量写入显存
-  LCD_WriteBuff(LCD_Buff, width * height);
+		rows = (left < LCD_BUFF_PIXELS / width) ? left : LCD_BUFF_PIXELS / width;
+		LCD_Ramp_Init(&ramp, c1, c2, width);
+		for (uint16_t col = 0; col < width; col++)
+		{
+			pBuff[col] = LCD_Ramp_Next(&ramp);
+		}
+		for (uint16_t r = 1; r < rows; r++)
+		{
+			memcpy(pBuff + (uint32_t)r * width, pBuff, width * sizeof(uint16_t));
+		}
+		LCD_WriteBuff(pBuff, (uint16_t)(rows * width));
+	}
 }
-#endif
-/******************************************************************************************************************************************
- *	函 数 名:	LCD_DisplayChinese
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_FillGradient
  *
- *	入口参数:	x - 起始水平坐标
- *					y - 起始垂直坐标
- *					pText - 中文字符
+ *	入口参数: x - 水平坐标
+ *			 	 y - 垂直坐标
+ *			 	 width  - 水平宽度，水平渐变时不超过 LCD_BUFF_PIXELS
+ *				 height - 垂直宽度
+ *				 color1 - 起点颜色(RGB888)，垂直渐变为顶行，水平渐变为最左列
+ *				 color2 - 终点颜色(RGB888)
+ *				 dir - LCD_GRADIENT_V 从上到下，LCD_GRADIENT_H 从左到右
  *
- *	函数功能:	在指定坐标显示指定的单个中文字符
+ *	函数功能: 以渐变色填充矩形，代替逐行调用 LCD_DrawLine_H()
  *
- *	说    明:	1. 可设置要显示的字体，例如使用 LCD_SetTextFont(&CH_Font24) 设置为 2424的中文字体以及2412的ASCII字符字体
- *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0xff0000FF) 设置为蓝色
- *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0xff000000) 设置为黑色的背景色
- *					4. 使用示例 LCD_DisplayChinese( 10, 10, "好") ，在坐标(10,10)显示中文字符"好"
+ *	说    明: 1. 整个区域只设置一次窗口；垂直渐变相同颜色的相邻行合并为一次同色填充，
+ *				   像素数达到 LCD_SPI_DMA_FILL_MIN 时由BDMA发送
+ *				2. 水平渐变每个渲染缓冲区生成一行、复制到写满整行，生成下一段时上一段仍在发送
+ *				3. 两端颜色先转换为RGB565，中间按8位分量插值；超出屏幕和裁剪区的部分不绘制
  *
  *****************************************************************************************************************************************/
 
-void LCD_DisplayChinese(uint16_t x, uint16_t y, char *pText)
+void LCD_FillGradient(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color1, uint32_t color2,
+					  uint8_t dir)
 {
-#ifdef USE_FLASH_FONT
-  uint8_t font_size = LCD_GetChineseFontSize();
-
-#ifdef IS_GB2312
-        // 使用查找表获得的索引计算最终地址
-        const uint8_t *pFontData = GB2312_FindFont_Flash(pText, font_size);
-        // 渲染到屏幕
-#else
+	uint16_t c1 = LCD_RGB565(color1), c2 = LCD_RGB565(color2);
 
-        const uint8_t *pFontData =
-            UTF8_FindFont_Flash((const uint8_t *)pText, font_size);
+#ifdef LCD_TILE_ENABLE
+	if (LCD_Tile_Recording)
+	{
+		uint32_t fore = LCD.Color, back = LCD.BackColor;
+		uint8_t recorded;
+
+		LCD.Color = c1; // 参数不够，两端颜色随录制状态保存
+		LCD.BackColor = c2;
+		recorded = LCD_Tile_Record((dir == LCD_GRADIENT_H) ? LCD_OP_FillGradientH : LCD_OP_FillGradientV, x, y, width,
+								   height, NULL, 0);
+		LCD.Color = fore;
+		LCD.BackColor = back;
+		if (recorded)
+			return; // 录制到显示列表
+	}
 #endif
-        DrawFont_Bitmap(x, y, font_size, font_size, pFontData);
 
-#else
-	uint16_t i = 0, index = 0, counter = 0; // 计数变量
-	uint16_t addr = 0;						// 字模地址
-	uint8_t disChar;						// 字模的值
-	uint16_t Xaddress = 0;					// 水平坐标
+	LCD_Gradient565(x, y, width, height, c1, c2, dir);
+}
 
-	while (1)
-	{
-		// 对比数组中的汉字编码，用以定位该汉字字模的地址
-		if (*(LCD_CHFonts->pTable + (i + 1) * LCD_CHFonts->Sizes + 0) == *pText && *(LCD_CHFonts->pTable + (i + 1) * LCD_CHFonts->Sizes + 1) == *(pText + 1))
-		{
-			addr = i; // 字模地址偏移
-			break;
-		}
-		i += 2; // 每个中文字符编码占两字节
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_FillPattern
+ *
+ *	入口参数: x - 水平坐标
+ *			 	 y - 垂直坐标
+ *			 	 width  - 水平宽度，不超过 LCD_BUFF_PIXELS
+ *				 height - 垂直宽度
+ *				*pattern - 平铺图案(RGB565像素和尺寸)
+ *
+ *	函数功能: 以平铺图案填充矩形，图案从矩形左上角开始重复
+ *
+ *	说    明: 1. 整个区域只设置一次窗口，按整行写满渲染缓冲区后发送，生成下一段时上一段仍在发送
+ *				2. 每行先拷贝图案的一行，再把已生成的部分成倍复制；同一缓冲区中相隔一个图案高度的行直接整行复制
+ *
+ *****************************************************************************************************************************************/
 
-		if (i >= LCD_CHFonts->Table_Rows)
-			break; // 字模列表中无相应的汉字
-	}
-	i = 0;
-	for (index = 0; index < LCD_CHFonts->Sizes; index++)
+void LCD_FillPattern(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const LCD_Pattern_t *pattern)
+{
+	uint16_t row = 0, rows;
+
+	if (LCD_TILE_RECORD(LCD_OP_FillPattern, x, y, width, height, pattern, 0))
+		return; // 录制到显示列表
+
+	if (pattern == NULL || pattern->Pixels == NULL || pattern->Width == 0 || pattern->Height == 0 || width == 0 ||
+		width > LCD_BUFF_PIXELS || height == 0)
+		return;
+
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1); // 整个区域只设置一次窗口
+	if (!LCD_FB_CAPTURE() && LCD_Clip_Mode == LCD_CLIP_DROP)
+		return; // 完全不可见，不生成
+
+	for (; row < height; row += rows)
 	{
-		disChar = *(LCD_CHFonts->pTable + (addr)*LCD_CHFonts->Sizes + index); // 获取相应的字模地址
+		uint16_t *pBuff = LCD_NextBuff(); // 另一个缓冲区可能仍在发送，不用等待
 
-		for (counter = 0; counter < 8; counter++)
+		rows = (height - row < LCD_BUFF_PIXELS / width) ? height - row : LCD_BUFF_PIXELS / width;
+		for (uint16_t r = 0; r < rows; r++)
 		{
-			if (disChar & 0x01)
+			uint16_t *dst = pBuff + (uint32_t)r * width;
+			uint16_t n = (pattern->Width < width) ? pattern->Width : width;
+
+			if (r >= pattern->Height)
 			{
-				LCD_Buff[i] = LCD.Color; // 当前模值不为0时，使用画笔色绘点
+				memcpy(dst, dst - (uint32_t)pattern->Height * width, width * sizeof(uint16_t)); // 与一个图案高度之前的行相同
+				continue;
 			}
-			else
+			memcpy(dst, pattern->Pixels + (uint32_t)((row + r) % pattern->Height) * pattern->Width, n * sizeof(uint16_t));
+			while (n < width)
 			{
-				LCD_Buff[i] = LCD.BackColor; // 否则使用背景色绘制点
-			}
-			i++;
-			disChar >>= 1;
-			Xaddress++; // 水平坐标自加
+				uint16_t k = (n < width - n) ? n : width - n;
 
-			if (Xaddress == LCD_CHFonts->Width) //	如果水平坐标达到了字符宽度，则退出当前循环
-			{									//	进入下一行的绘制
-				Xaddress = 0;
-				break;
+				memcpy(dst + n, dst, k * sizeof(uint16_t));
+				n += k;
 			}
 		}
+		LCD_WriteBuff(pBuff, (uint16_t)(rows * width));
 	}
-	LCD_SetAddress(x, y, x + LCD_CHFonts->Width - 1, y + LCD_CHFonts->Height - 1); // 设置坐标
-	LCD_WriteBuff(LCD_Buff, LCD_CHFonts->Width * LCD_CHFonts->Height);			   // 写入显存
-#endif
 }
-/****************************************************************************************************************************************
- *	函 数 名:	LCD_DisplayChar
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawImage
  *
- *	入口参数:	x - 起始水平坐标
- *					y - 起始垂直坐标
- *					c  - ASCII字符
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *			 	 width  - 图片的水平宽度
+ *				 height - 图片的垂直宽度
+ *				*pImage - 图片数据存储区的首地址
  *
- *	函数功能:	在指定坐标显示指定的字符
+ *	函数功能: 在指定坐标处显示图片
  *
- *	说    明:	1. 可设置要显示的字体
- *					2.	可设置要显示的颜色，例如使用
- *LCD_SetColor(0xff0000FF) 设置为蓝色
- *					3. 可设置对应的背景色，例如使用
- *LCD_SetBackColor(0x000000) 设置为黑色的背景色
- *					4. 使用示例 LCD_DisplayChar( 10, 10,
- *'a') ，在坐标(10,10)显示字符 'a'
+ *	说    明: 1.要显示的图片需要事先进行取模、获悉图片的长度和宽度
+ *            2.使用 LCD_SetColor() 函数设置画笔色，LCD_SetBackColor() 设置背景色
+ *            3.取模数据每行 (width+7)/8 字节、低位在前，与字模格式相同，由字模展开表整行展开
  *
  *****************************************************************************************************************************************/
 
-void LCD_DisplayChar(uint16_t x, uint16_t y, uint8_t c) {
-#ifdef USE_FLASH_FONT
-  uint8_t font_size = LCD_GetChineseFontSize();
-  const uint8_t *pFontData = ASCII_FindFont_Flash(c, font_size);
+void LCD_DrawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pImage)
+{
+	uint16_t bytes_per_row = (width + 7) / 8; // 每行字节数，行尾按字节补齐
+	uint16_t Buff_Height;					  // 每个缓冲区容纳的行数
+	uint16_t rows;							  // 本次展开的行数
 
-  if (pFontData != NULL) {
-    uint8_t width = font_size / 2;
-    DrawFont_Bitmap(x, y, width, font_size, pFontData);
-    return;
-  }
-#else
+	if (LCD_TILE_RECORD(LCD_OP_DrawImage, x, y, width, height, pImage, 0))
+		return; // 录制到显示列表
 
-  uint16_t index = 0, counter = 0, i = 0, w = 0; // 计数变量
-  uint8_t disChar;                               // 存储字符的地址
+	if (width == 0 || width > LCD_BUFF_PIXELS || height == 0)
+		return;
 
-  c = c - 32; // 计算ASCII字符的偏移
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1); // 整个图片只设置一次窗口
 
-  for (index = 0; index < LCD_AsciiFonts->Sizes; index++) {
-    disChar = LCD_AsciiFonts
-                  ->pTable[c * LCD_AsciiFonts->Sizes + index]; // 获取字符的模值
-    for (counter = 0; counter < 8; counter++) {
-      if (disChar & 0x01) {
-        LCD_Buff[i] = LCD.Color; // 当前模值不为0时，使用画笔色绘点
-      } else {
-        LCD_Buff[i] = LCD.BackColor; // 否则使用背景色绘制点
-      }
-      disChar >>= 1;
-      i++;
-      w++;
-      if (w ==
-          LCD_AsciiFonts->Width) // 如果写入的数据达到了字符宽度，则退出当前循环
-      {                          // 进入下一字符的写入的绘制
-        w = 0;
-        break;
-      }
-    }
-  }
-  LCD_SetAddress(x, y, x + LCD_AsciiFonts->Width - 1,
-                 y + LCD_AsciiFonts->Height - 1); // 设置坐标
-  LCD_WriteBuff(LCD_Buff,
-                LCD_AsciiFonts->Width * LCD_AsciiFonts->Height); // 写入显存
-#endif
+	// 缓冲区大小有限，每次展开尽可能多的整行，发送的同时展开另一个缓冲区
+	Buff_Height = LCD_BUFF_PIXELS / width;
+	for (uint16_t row = 0; row < height; row += rows)
+	{
+		uint16_t *pBuff = LCD_NextBuff();
+
+		rows = (height - row < Buff_Height) ? height - row : Buff_Height;
+		LCD_ExpandBitmap(pBuff, pImage, width, rows, width, 0); // 与字模相同，按半字节查表展开整行
+		LCD_WriteBuff(pBuff, width * rows);
+		pImage += bytes_per_row * rows;
+	}
 }
-/*****************************************************************************************************************************************
- *	函 数 名:	LCD_DisplayText
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_CopyBuffer
  *
- *	入口参数:	x - 起始水平坐标
- *					y - 起始垂直坐标
- *					pText - 字符串，可以显示中文或者ASCII字符
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *			 	 width  - 目标区域的水平宽度
+ *				 height - 目标区域的垂直宽度
+ *				*pImage - 数据存储区的首地址
  *
- *	函数功能:	在指定坐标显示指定的字符串
+ *	函数功能: 在指定坐标处，直接将数据复制到屏幕的显存
  *
- *	说    明:	1. 可设置要显示的字体，例如使用 LCD_SetTextFont(&CH_Font24) 设置为 2424的中文字体以及2412的ASCII字符字体
- *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0xff0000FF) 设置为蓝色
- *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0xff000000) 设置为黑色的背景色
- *					4. 使用示例 LCD_DisplayChinese( 10, 10, "菜菜why") ，在坐标(10,10)显示字符串"菜菜why"
+ *	说    明: 批量复制函数，可用于移植 LVGL 或者将摄像头采集的图像显示出来
  *
- ***********************************************************************************************************************************/
+ *****************************************************************************************************************************************/
 
-void LCD_DisplayText(uint16_t x, uint16_t y, char *pText)
+void LCD_CopyBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *DataBuff)
 {
-#ifdef USE_FLASH_FONT
-	uint8_t font_size = LCD_GetChineseFontSize();
+	if (LCD_TILE_RECORD(LCD_OP_CopyBuffer, x, y, width, height, DataBuff, 0))
+		return; // 录制到显示列表
+
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+
+#ifdef LCD_CAPTURE_ENABLE
+	if (LCD_FB_CAPTURE())
+	{
+		LCD_FB_Write(DataBuff, 0, (uint32_t)width * height);
+		return;
+	}
+#endif
+	if (LCD_Clip_Mode != LCD_CLIP_OFF)
+	{
+		LCD_Clip_Write(DataBuff, DataBuff, 0, (uint32_t)width * height);
+		LCD_WaitIdle(); // 返回后调用者即可改写 DataBuff
+		return;
+	}
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+	{
+		LCD_Fmc_Send(DataBuff, DataBuff, 0, (uint32_t)width * height);
+		LCD_WaitIdle(); // 返回后调用者即可改写 DataBuff
+		return;
+	}
+#endif
+#ifdef LCD_RGB444_ENABLE
+	if (LCD_PIXEL_444())
+	{
+		LCD_444_Send(DataBuff, 0, (uint32_t)width * height); // 已打包到打包缓冲区，返回后调用者即可改写 DataBuff
+		return;
+	}
+#endif
+
+	LCD_DC_Data; // 数据指令选择 引脚输出高电平，代表本次传输 数据
+
+	// 修改为16位数据宽度，写入数据更加效率，不需要拆分
+	LCD_SPI_SetDataSize(SPI_DATASIZE_16BIT); // 16位数据宽度
+
+	PERF_TRACE_BEGIN(PERF_TRACE_SPI, width * height);
+	LCD_SPI_TransmitBuffer(&LCD_SPI, DataBuff, width * height);
+	PERF_TRACE_END(PERF_TRACE_SPI, 0);
+	LCD_WIN_ADVANCE((uint32_t)width * height);
+
+	//	HAL_SPI_Transmit(&hspi5, (uint8_t *)DataBuff, (x2-x1+1) * (y2-y1+1), 1000) ;
+
+	// 改回8位数据宽度，因为指令和部分数据都是按照8位传输的
+	LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT); // 8位数据宽度
+}
+
+#ifdef LCD_SPI_DMA_ENABLE
+#ifdef LCD_IMAGE_MDMA_ENABLE
+static MDMA_HandleTypeDef LCD_Image_Mdma; // 图片搬运的MDMA句柄
+static uint8_t LCD_Image_MdmaState = 0;	  // 0-未初始化，1-可用，2-初始化失败
+
+/**
+ * @brief  配置MDMA通道(软件请求，一次传完一个块，按半字搬运)
+ * @retval 1-可用，0-初始化失败
+ */
+static uint8_t LCD_Image_MdmaInit(void)
+{
+	if (LCD_Image_MdmaState == 0)
+	{
+		__HAL_RCC_MDMA_CLK_ENABLE();
+
+		LCD_Image_Mdma.Instance = LCD_IMAGE_MDMA_CHANNEL;
+		LCD_Image_Mdma.Init.Request = MDMA_REQUEST_SW;
+		LCD_Image_Mdma.Init.TransferTriggerMode = MDMA_BLOCK_TRANSFER;
+		LCD_Image_Mdma.Init.Priority = MDMA_PRIORITY_HIGH;
+		LCD_Image_Mdma.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+		LCD_Image_Mdma.Init.SourceInc = MDMA_SRC_INC_HALFWORD;
+		LCD_Image_Mdma.Init.DestinationInc = MDMA_DEST_INC_HALFWORD;
+		LCD_Image_Mdma.Init.SourceDataSize = MDMA_SRC_DATASIZE_HALFWORD; // 像素数据只保证2字节对齐
+		LCD_Image_Mdma.Init.DestDataSize = MDMA_DEST_DATASIZE_HALFWORD;
+		LCD_Image_Mdma.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+		LCD_Image_Mdma.Init.BufferTransferLength = 128;
+		LCD_Image_Mdma.Init.SourceBurst = MDMA_SOURCE_BURST_SINGLE;
+		LCD_Image_Mdma.Init.DestBurst = MDMA_DEST_BURST_SINGLE;
+		LCD_Image_Mdma.Init.SourceBlockAddressOffset = 0;
+		LCD_Image_Mdma.Init.DestBlockAddressOffset = 0;
+
+		LCD_Image_MdmaState = (HAL_MDMA_Init(&LCD_Image_Mdma) == HAL_OK) ? 1 : 2;
+	}
+	return LCD_Image_MdmaState == 1;
+}
 #endif
-	uint16_t x_start = x; // 记录起始X坐标,用于换行
 
-	while (*pText != 0)
+/**
+ * @brief  把 count 个像素从 pSrc 搬到渲染缓冲区
+ * @note   MDMA不经过CPU，可以读QSPI映射区；不可用或传输出错时由CPU拷贝
+ */
+static void LCD_Image_Fetch(uint16_t *pBuff, const uint16_t *pSrc, uint32_t count)
+{
+#ifdef LCD_IMAGE_MDMA_ENABLE
+	if (LCD_Image_MdmaInit())
 	{
-		if (*pText <= 0x7F) // ASCII字符
+		SCB_InvalidateDCache_by_Addr((uint32_t *)pBuff, count * 2); // MDMA直接写内存，丢弃缓冲区中的旧Cache行
+		if (HAL_MDMA_Start(&LCD_Image_Mdma, (uint32_t)pSrc, (uint32_t)pBuff, count * 2, 1) == HAL_OK)
 		{
-			// 检查是否需要换行
-			if (x + LCD_AsciiFonts->Width > LCD.Width)
-			{
-				x = x_start;
-#ifdef USE_FLASH_FONT
-				y += font_size;
-#else
-				y += LCD_CHFonts->Height;
-#endif
-			}
-
-			LCD_DisplayChar(x, y, *pText);
-			x += LCD_AsciiFonts->Width;
-			pText++;
+			if (HAL_MDMA_PollForTransfer(&LCD_Image_Mdma, HAL_MDMA_FULL_TRANSFER, 10) == HAL_OK)
+				return;
+			HAL_MDMA_Abort(&LCD_Image_Mdma);
 		}
-		else // 汉字(GBK编码,双字节)
-		{
-#ifdef USE_FLASH_FONT
-			// 检查是否需要换行
-			if (x + font_size > LCD.Width)
-			{
-				x = x_start;
-				y += font_size;
-			}
-#else
-			// 检查是否需要换行
-			if (x + LCD_CHFonts->Width > LCD.Width)
-			{
-				x = x_start;
-				y += LCD_CHFonts->Height;
-			}
+	}
 #endif
+	memcpy(pBuff, pSrc, count * 2);
+}
 
-			LCD_DisplayChinese(x, y, pText);
+/**
+ * @brief  调用者没有给出完成回调时使用的空回调
+ */
+static void LCD_Copy_Idle(void *arg)
+{
+	(void)arg;
+}
 
-#ifdef USE_FLASH_FONT
-			x += font_size; // Flash字库使用动态字体大小
-#else
-			x += LCD_CHFonts->Width; // 内置字库使用固定宽度
-#endif
-#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
-			uint8_t utf8_code = (uint8_t)*pText;
-			if ((utf8_code & 0xE0) == 0xC0)
-				pText += 2; // 2字节 UTF-8
-			else if ((utf8_code & 0xF0) == 0xE0)
-				pText += 3; // 3字节 UTF-8 (常用汉字)
-			else if ((utf8_code & 0xF8) == 0xF0)
-				pText += 4; // 4字节 UTF-8
-			else
-				pText += 1; // 异常情况，避免死循环
+/**
+ * @brief  准备异步复制的下一段
+ * @note   源数据在SRAM4时直接发送，每段最多65535个像素；否则搬到渲染缓冲区，每段 LCD_BUFF_PIXELS 个像素
+ */
+ITCM_CODE static void LCD_Copy_Stage(void)
+{
+	uint32_t n = LCD_Copy_Left;
+
+	if (n == 0)
+		return;
+	if (LCD_IS_DMA_RAM(LCD_Copy_Src))
+	{
+		if (n > 0xFFFF)
+			n = 0xFFFF;
+		LCD_Copy_Buff = (uint16_t *)LCD_Copy_Src;
+	}
+	else
+	{
+		if (n > LCD_BUFF_PIXELS)
+			n = LCD_BUFF_PIXELS;
+		LCD_Copy_Buff = LCD_Buff[LCD_Copy_Index];
+		LCD_Copy_Index = (uint8_t)((LCD_Copy_Index + 1) % LCD_BUFF_COUNT);
+		LCD_Image_Fetch(LCD_Copy_Buff, LCD_Copy_Src, n);
+	}
+	LCD_Copy_Src += n;
+	LCD_Copy_Left -= n;
+	LCD_Copy_Count = (uint16_t)n;
+}
+
+/**
+ * @brief  发送已准备好的一段，随后在发送期间准备下一段
+ * @retval HAL_ERROR-没有剩余的像素或启动失败
+ */
+ITCM_CODE static HAL_StatusTypeDef LCD_Copy_Send(void)
+{
+	uint16_t n;
+
+	if (LCD_Copy_Count == 0)
+		LCD_Copy_Stage(); // 只有一个渲染缓冲区时，上一段发送完才能搬运
+	n = LCD_Copy_Count;
+	if (n == 0)
+		return HAL_ERROR;
+
+	SCB_CleanDCache_by_Addr((uint32_t *)LCD_Copy_Buff, n * 2); // memcpy 或调用者写入的像素刷回SRAM4
+	LCD_DMA_TxBuff = LCD_Copy_Buff;
+	LCD_Copy_Count = 0;
+	if (HAL_SPI_Transmit_DMA(&LCD_SPI, (uint8_t *)LCD_Copy_Buff, n) != HAL_OK)
+		return HAL_ERROR;
+	LCD_PERF_TX(n * 2);
+#if LCD_BUFF_COUNT > 1
+	LCD_Copy_Stage(); // 与这一段的BDMA传输并行
 #else
-			pText += 2; // GBK
+	if (LCD_IS_DMA_RAM(LCD_Copy_Src))
+		LCD_Copy_Stage();
 #endif
-                }
-	}
+	return HAL_OK;
 }
-/*****************************************************************************************************************************************
- *	函 数 名:	LCD_ShowNumMode
+#endif
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_CopyBufferAsync
  *
- *	入口参数:	mode - 设置变量的显示模式
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *			 	 width  - 目标区域的水平宽度
+ *				 height - 目标区域的垂直宽度
+ *				*DataBuff - RGB565像素数据的首地址，可以位于AXI SRAM、SRAM4或QSPI映射区
+ *				 done - 数据全部发送后的回调，可为NULL
+ *				 arg - 回调的参数
  *
- *	函数功能:	设置变量显示时多余位补0还是补空格，可输入参数 Fill_Space 填充空格，Fill_Zero 填充零
+ *	函数功能: 启动像素数据到屏幕的后台复制后立即返回
  *
- *	说    明:   1. 只有 LCD_DisplayNumber() 显示整数 和 LCD_DisplayDecimals()显示小数 这两个函数用到
- *					2. 使用示例 LCD_ShowNumMode(Fill_Zero) 设置多余位填充0，例如 123 可以显示为 000123
+ *	说    明: 1. 用于LVGL等需要"发送完成"通知的场合：回调在SPI发送完成中断中调用，之后才能改写 DataBuff
+ *				2. 数据不在SRAM4时按渲染缓冲区大小分段，每段的完成中断中启动已搬到SRAM4的下一段，
+ *				   然后用MDMA(未启用时memcpy)搬运再下一段；复制期间渲染缓冲区全部被占用，
+ *				   其他绘图函数会先等待复制结束
+ *				3. 未启用DMA、帧缓冲/条带模式或窗口部分超出裁剪区时同步完成，返回前调用回调
+ *				4. 不能在 LCD_TileBegin() 与 LCD_TileEnd() 之间调用
  *
  *****************************************************************************************************************************************/
 
-void LCD_ShowNumMode(uint8_t mode)
+void LCD_CopyBufferAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *DataBuff,
+						 LCD_CopyDone_t done, void *arg)
 {
-	LCD.ShowNum_Mode = mode;
+#ifdef LCD_SPI_DMA_ENABLE
+	uint32_t count = (uint32_t)width * height;
+
+	if (count == 0 || LCD_FB_CAPTURE() || LCD_PIXEL_444()) // RGB444须由CPU打包，同步完成
+#endif
+	{
+		LCD_CopyBuffer(x, y, width, height, (uint16_t *)DataBuff);
+		if (done != NULL)
+			done(arg);
+		return;
+	}
+#ifdef LCD_SPI_DMA_ENABLE
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1); // 等待之前的传输结束
+	if (LCD_Copy_Done != NULL)							 // 另一块屏幕的异步复制占用全部渲染缓冲区
+		LCD_WaitBuff(NULL);
+	if (LCD_Clip_Mode != LCD_CLIP_OFF)
+	{
+		LCD_Clip_Write(DataBuff, DataBuff, 0, count);
+		LCD_WaitIdle();
+		if (done != NULL)
+			done(arg);
+		return;
+	}
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC())
+	{
+		LCD_PERF_TX(count * 2);
+		LCD_WIN_ADVANCE(count);
+		if (count >= LCD_FMC_DMA_MIN && LCD_Fmc_Dma(DataBuff, DataBuff, 0, count, 0, 0, done, arg))
+			return; // MDMA直接读取源数据，不经过渲染缓冲区
+		LCD_Fmc_WritePixels(DataBuff, 0, count);
+		if (done != NULL)
+			done(arg);
+		return;
+	}
+#endif
+
+	if (done == NULL)
+		done = LCD_Copy_Idle; // 完成回调同时作为"复制进行中"的标记
+	SCB_CleanDCache_by_Addr((uint32_t *)DataBuff, count * 2); // 调用者写入的像素刷回内存，MDMA/BDMA才能读到
+	LCD_Copy_Src = DataBuff;
+	LCD_Copy_Left = count;
+	LCD_Copy_Count = 0;
+	LCD_Copy_Arg = arg;
+
+	LCD_DC_Data;
+	LCD_SPI_SetDataSize(SPI_DATASIZE_16BIT); // 8位宽度在下一次写指令时恢复
+	LCD_DMA_SetMode(LCD_DMA_MODE_BUFF);
+	PERF_TRACE_BEGIN(PERF_TRACE_DMA, count); // 最后一段的完成中断中结束
+	LCD_Copy_Stage();
+	LCD_WIN_ADVANCE(count); // 失败时同样由下面的阻塞传输写完
+	LCD_Copy_Panel = LCD_Cur;
+	LCD_Copy_Done = done; // 之后完成中断才会接续
+	if (LCD_Copy_Send() != HAL_OK)
+	{
+		LCD_Copy_Done = NULL; // 启动失败，改用阻塞传输
+		LCD_DMA_TxBuff = NULL;
+		PERF_TRACE_END(PERF_TRACE_DMA, 0);
+		LCD_SPI_TransmitBuffer(&LCD_SPI, (uint16_t *)DataBuff, count);
+		LCD_SPI_SetDataSize(SPI_DATASIZE_8BIT);
+		done(arg);
+	}
+#endif
 }
 
-/*****************************************************************************************************************************************
- *	函 数 名:	LCD_DisplayNumber
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawImage565
  *
- *	入口参数:	x - 起始水平坐标
- *					y - 起始垂直坐标
- *					number - 要显示的数字,范围在 -2147483648~2147483647 之间
- *					len - 数字的位数，如果位数超过len，将按其实际长度输出，如果需要显示负数，请预留一个位的符号显示空间
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *			 	 width  - 图片的水平宽度
+ *				 height - 图片的垂直宽度
+ *				*pImage - RGB565像素数据的首地址(小端uint16，逐行存放)
  *
- *	函数功能:	在指定坐标显示指定的整数变量
+ *	函数功能: 在指定坐标处显示RGB565彩色图片
  *
- *	说    明:	1. 可设置要显示的字体，例如使用
- *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0x0000FF) 设置为蓝色
- *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0x000000) 设置为黑色的背景色
- *					4. 使用示例 LCD_DisplayNumber( 10, 10, a, 5) ，在坐标(10,10)显示指定变量a,总共5位，多余位补0或空格，
- *						例如 a=123 时，会根据 LCD_ShowNumMode()的设置来显示  123(前面两个空格位) 或者00123
+ *	说    明: 1. 数据格式与 LCD_CopyBuffer() 相同，可以直接位于QSPI映射区(见 FlashFont_GetImage())
+ *				2. BDMA只能读SRAM4，图片按渲染缓冲区大小分段：MDMA把下一段搬到空闲的缓冲区，
+ *				   同时BDMA发送上一段，整个过程CPU不读写像素；LCD_CopyBuffer() 则由CPU逐个写TXDR
+ *				3. 数据已在SRAM4时直接交给BDMA，返回后改写数据之前需调用 LCD_WaitIdle()
+ *				4. 整个图片只设置一次窗口，帧缓冲、条带和裁剪区与 LCD_CopyBuffer() 相同
  *
  *****************************************************************************************************************************************/
 
-void LCD_DisplayNumber(uint16_t x, uint16_t y, int32_t number, uint8_t len)
+void LCD_DrawImage565(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *pImage)
 {
-	char Number_Buffer[15]; // 用于存储转换后的字符串
+	uint32_t left = (uint32_t)width * height; // 剩余像素数
+
+	if (LCD_TILE_RECORD(LCD_OP_DrawImage565, x, y, width, height, pImage, 0))
+		return; // 录制到显示列表
+
+	if (left == 0 || pImage == NULL)
+		return;
+
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1);
 
-	if (LCD.ShowNum_Mode == Fill_Zero) // 多余位补0
+#ifdef LCD_CAPTURE_ENABLE
+	if (LCD_FB_CAPTURE())
 	{
-		sprintf(Number_Buffer, "%0.*d", len, number); // 将 number 转换成字符串，便于显示
+		LCD_FB_Write(pImage, 0, left); // 直接从源数据写入帧缓冲
+		return;
 	}
-	else // 多余位补空格
+#endif
+	if (LCD_Clip_Mode == LCD_CLIP_DROP)
+		return; // 完全不可见，不搬运数据
+#ifdef LCD_FMC_ENABLE
+	if (LCD_IS_FMC() && LCD_Clip_Mode == LCD_CLIP_OFF)
 	{
-		sprintf(Number_Buffer, "%*d", len, number); // 将 number 转换成字符串，便于显示
+		LCD_Fmc_Send(pImage, pImage, 0, left); // MDMA可以直接读QSPI映射区，不必分段搬到渲染缓冲区
+		LCD_FMC_RELEASE(pImage);
+		return;
 	}
+#endif
 
-	LCD_DisplayString(x, y, (char *)Number_Buffer); // 将转换得到的字符串显示出来
+	while (left > 0)
+	{
+		uint32_t n = (left > LCD_BUFF_PIXELS) ? LCD_BUFF_PIXELS : left;
+		uint16_t *pBuff = (uint16_t *)pImage; // 阻塞传输时直接从源数据发送
+
+#ifdef LCD_SPI_DMA_ENABLE
+		if (!LCD_IS_DMA_RAM(pImage))
+		{
+			pBuff = LCD_NextBuff();			   // 另一个缓冲区可能仍在发送，不用等待
+			LCD_Image_Fetch(pBuff, pImage, n); // 与上一段的BDMA传输并行
+		}
+#endif
+		LCD_WriteBuff(pBuff, (uint16_t)n);
+
+		pImage += n;
+		left -= n;
+	}
 }
 
+#ifdef USE_FLASH_FONT
 /***************************************************************************************************************************************
- *	函 数 名:	LCD_DisplayDecimals
- *
- *	入口参数:	x - 起始水平坐标
- *					y - 起始垂直坐标
- *					decimals - 要显示的数字, double型取值1.7 x 10^（-308）~ 1.7 x 10^（+308），但是能确保准确的有效位数为15~16位
+ *	函 数 名: LCD_DrawFlashImage
  *
- *       			len - 整个变量的总位数（包括小数点和负号），若实际的总位数超过了指定的总位数，将按实际的总长度位输出，
- *							示例1：小数 -123.123 ，指定 len <=8 的话，则实际照常输出 -123.123
- *							示例2：小数 -123.123 ，指定 len =10 的话，则实际输出   -123.123(负号前面会有两个空格位)
- *							示例3：小数 -123.123 ，指定 len =10 的话，当调用函数 LCD_ShowNumMode() 设置为填充0模式时，实际输出 -00123.123
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *				 index - 图片编号，即 fontbin_tool.py --image 的参数顺序
  *
- *					decs - 要保留的小数位数，若小数的实际位数超过了指定的小数位，则按指定的宽度四舍五入输出
- *							 示例：1.12345 ，指定 decs 为4位的话，则输出结果为1.1235
+ *	函数功能: 显示字库分区中的RGB565图片
  *
- *	函数功能:	在指定坐标显示指定的变量，包括小数
+ *	返 回 值: 1 - 已显示，0 - 字库中没有该图片
  *
- *	说    明:	1. 可设置要显示的字体，例如使用 
- *					2.	可设置要显示的颜色，例如使用 LCD_SetColor(0x0000FF) 设置为蓝色
- *					3. 可设置对应的背景色，例如使用 LCD_SetBackColor(0x000000) 设置为黑色的背景色
- *					4. 使用示例 LCD_DisplayDecimals( 10, 10, a, 5, 3) ，在坐标(10,10)显示字变量a,总长度为5位，其中保留3位小数
+ *	说    明: 开机画面、图标等随字库烧录，像素直接从QSPI映射区发送，不占用内部Flash
  *
  *****************************************************************************************************************************************/
 
-void LCD_DisplayDecimals(uint16_t x, uint16_t y, double decimals, uint8_t len, uint8_t decs)
+uint8_t LCD_DrawFlashImage(uint16_t x, uint16_t y, uint16_t index)
 {
-	char Number_Buffer[20]; // 用于存储转换后的字符串
+	uint16_t width, height;
+	const uint16_t *pImage = FlashFont_GetImage(index, &width, &height);
 
-	if (LCD.ShowNum_Mode == Fill_Zero) // 多余位填充0模式
-	{
-		sprintf(Number_Buffer, "%0*.*lf", len, decs, decimals); // 将 number 转换成字符串，便于显示
-	}
-	else // 多余位填充空格
-	{
-		sprintf(Number_Buffer, "%*.*lf", len, decs, decimals); // 将 number 转换成字符串，便于显示
-	}
+	if (pImage == NULL)
+		return 0;
 
-	LCD_DisplayString(x, y, (char *)Number_Buffer); // 将转换得到的字符串显示出来
+	LCD_DrawImage565(x, y, width, height, pImage);
+	return 1;
 }
+#endif
 
 /***************************************************************************************************************************************
- *	函 数 名: LCD_DrawLine
- *
- *	入口参数: x1 - 起点 水平坐标
- *			 	 y1 - 起点 垂直坐标
+ *	函 数 名: LCD_DrawImage888
  *
- *				 x2 - 终点 水平坐标
- *            y2 - 终点 垂直坐标
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *			 	 width  - 图片的水平宽度
+ *				 height - 图片的垂直宽度
+ *				*pImage - RGB888像素数据的首地址，每像素3字节，按 B、G、R 顺序逐行存放
  *
- *	函数功能: 在两点之间画线
+ *	函数功能: 在指定坐标处显示RGB888彩色图片，转换为RGB565后显示
  *
- *	说    明: 该函数移植于ST官方评估板的例程
+ *	说    明: 1. 字节顺序与 LCD_SetColor() 的0xRRGGBB按小端存放相同，转换时直接截取高位
+ *				2. 帧缓冲模式下定义了 LCD_DMA2D_ENABLE 时，由DMA2D转换并写入帧缓冲，数据不能位于DTCM
+ *				3. 其他情况由CPU按渲染缓冲区大小分段转换，转换下一段时上一段仍在发送
  *
  *****************************************************************************************************************************************/
 
-#define ABS(X) ((X) > 0 ? (X) : -(X))
-
-void LCD_DrawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+void LCD_DrawImage888(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pImage)
 {
-	int16_t deltax = 0, deltay = 0, x = 0, y = 0, xinc1 = 0, xinc2 = 0,
-			yinc1 = 0, yinc2 = 0, den = 0, num = 0, numadd = 0, numpixels = 0,
-			curpixel = 0;
+	uint32_t left = (uint32_t)width * height; // 剩余像素数
 
-	deltax = ABS(x2 - x1); /* The difference between the x's */
-	deltay = ABS(y2 - y1); /* The difference between the y's */
-	x = x1;				   /* Start x off at the first pixel */
-	y = y1;				   /* Start y off at the first pixel */
+	if (LCD_TILE_RECORD(LCD_OP_DrawImage888, x, y, width, height, pImage, 0))
+		return; // 录制到显示列表
 
-	if (x2 >= x1) /* The x-values are increasing */
+	if (left == 0 || pImage == NULL)
+		return;
+
+#ifdef LCD_FB_DMA2D
+	if (LCD_FB_CAPTURE() && left >= LCD_DMA2D_MIN_PIXELS)
 	{
-		xinc1 = 1;
-		xinc2 = 1;
+		LCD_Rect_t vis;
+		const uint8_t *src;
+		uint16_t w;
+
+		if (!LCD_FB_Visible(x, y, (int32_t)x + width - 1, (int32_t)y + height - 1, &vis))
+			return;
+		w = vis.x2 - vis.x1 + 1;
+		src = pImage + ((uint32_t)(vis.y1 - y) * width + (vis.x1 - x)) * 3;
+		SCB_CleanDCache_by_Addr((uint32_t *)src, ((uint32_t)(vis.y2 - vis.y1) * width + w) * 3); // CPU生成的图片先写回内存
+		if (LCD_DMA2D_Setup(DMA2D_M2M_PFC, w) &&
+			LCD_DMA2D_Layer(DMA2D_FOREGROUND_LAYER, DMA2D_INPUT_RGB888, width - w, 0xFF000000UL) &&
+			LCD_DMA2D_Start((uint32_t)src, 0, &vis))
+			return;
 	}
-	else /* The x-values are decreasing */
+#endif
+
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+	if (!LCD_FB_CAPTURE() && LCD_Clip_Mode == LCD_CLIP_DROP)
+		return; // 完全不可见，不转换
+
+	while (left > 0)
 	{
-		xinc1 = -1;
-		xinc2 = -1;
+		uint32_t n = (left > LCD_BUFF_PIXELS) ? LCD_BUFF_PIXELS : left;
+		uint16_t *pBuff = LCD_NextBuff(); // 另一个缓冲区可能仍在发送，不用等待
+
+		for (uint32_t i = 0; i < n; i++, pImage += 3)
+		{
+			pBuff[i] = (uint16_t)(((pImage[2] & 0xF8) << 8) | ((pImage[1] & 0xFC) << 3) | (pImage[0] >> 3));
+		}
+		LCD_WriteBuff(pBuff, (uint16_t)n);
+		left -= n;
 	}
+}
 
-	if (y2 >= y1) /* The y-values are increasing */
+// 调色板图片的查找表：8bpp时为256个RGB565，4bpp时为256项两像素组合(低16位为低4位对应的左侧像素)
+DTCM_BSS static union
+{
+	uint16_t Color[256];
+	uint32_t Pair[256];
+} LCD_Index_Lut;
+static uint16_t LCD_Index_Pal[16];		   // 当前两像素表对应的16色调色板
+static uint8_t LCD_Index_PairValid = 0; // 1：两像素表与 LCD_Index_Pal 一致
+
+/**
+ * @brief  由调色板建立查找表，超出颜色数的序号取第0色
+ * @note   4bpp按内容比较16色调色板，相同(连续绘制同一套图标)时不重建两像素表
+ */
+static void LCD_Index_Load(const LCD_IndexedImage_t *img)
+{
+	uint16_t n = (img->Colors > (1U << img->Bpp)) ? (1U << img->Bpp) : img->Colors;
+	uint16_t pal[16], i;
+
+	if (img->Bpp == 8)
 	{
-		yinc1 = 1;
-		yinc2 = 1;
+		for (i = 0; i < n; i++)
+			LCD_Index_Lut.Color[i] = img->Palette[i];
+		for (; i < 256; i++)
+			LCD_Index_Lut.Color[i] = img->Palette[0];
+		LCD_Index_PairValid = 0;
+		return;
 	}
-	else /* The y-values are decreasing */
+
+	for (i = 0; i < 16; i++)
+		pal[i] = img->Palette[(i < n) ? i : 0];
+	if (LCD_Index_PairValid && memcmp(pal, LCD_Index_Pal, sizeof(pal)) == 0)
+		return;
+	for (i = 0; i < 256; i++)
+		LCD_Index_Lut.Pair[i] = pal[i & 0x0F] | ((uint32_t)pal[i >> 4] << 16);
+	memcpy(LCD_Index_Pal, pal, sizeof(pal));
+	LCD_Index_PairValid = 1;
+}
+
+/**
+ * @brief  把一行中从第 col 个像素开始的 n 个像素展开为RGB565
+ */
+static void LCD_Index_Expand(uint16_t *pDst, const uint8_t *line, uint16_t col, uint32_t n, uint8_t bpp)
+{
+	if (bpp == 8)
 	{
-		yinc1 = -1;
-		yinc2 = -1;
+		line += col;
+		while (n--)
+			*pDst++ = LCD_Index_Lut.Color[*line++];
+		return;
 	}
 
-	if (deltax >= deltay) /* There is at least one x-value for every y-value */
+	line += col / 2;
+	if (col & 1)
 	{
-		xinc1 = 0; /* Don't change the x when numerator >= denominator */
-		yinc2 = 0; /* Don't change the y for every iteration */
-		den = deltax;
-		num = deltax / 2;
-		numadd = deltay;
-		numpixels = deltax; /* There are more x-values than y-values */
+		*pDst++ = (uint16_t)(LCD_Index_Lut.Pair[*line++] >> 16); // 从字节的高4位开始
+		n--;
 	}
-	else /* There is at least one y-value for every x-value */
+	for (; n >= 2; n -= 2)
 	{
-		xinc2 = 0; /* Don't change the x for every iteration */
-		yinc1 = 0; /* Don't change the y when numerator >= denominator */
-		den = deltay;
-		num = deltay / 2;
-		numadd = deltax;
-		numpixels = deltay; /* There are more y-values than x-values */
+		uint32_t pair = LCD_Index_Lut.Pair[*line++];
+
+		pDst[0] = (uint16_t)pair;
+		pDst[1] = (uint16_t)(pair >> 16);
+		pDst += 2;
 	}
-	for (curpixel = 0; curpixel <= numpixels; curpixel++)
+	if (n)
+		*pDst = (uint16_t)LCD_Index_Lut.Pair[*line];
+}
+
+#ifdef LCD_FB_DMA2D
+LCD_DMA2D_CLUT_ATTR static uint32_t LCD_Dma2d_Clut[256]; // DMA2D颜色表(ARGB8888)
+
+/**
+ * @brief  把调色板转为ARGB8888并载入前景层颜色表
+ * @retval 1-已载入，0-载入失败(由CPU完成)
+ */
+static uint8_t LCD_DMA2D_LoadClut(const LCD_IndexedImage_t *img)
+{
+	DMA2D_CLUTCfgTypeDef clut;
+	uint16_t n = (img->Colors > (1U << img->Bpp)) ? (1U << img->Bpp) : img->Colors;
+
+	for (uint16_t i = 0; i < (1U << img->Bpp); i++)
+		LCD_Dma2d_Clut[i] = LCD_DMA2D_Color(img->Palette[(i < n) ? i : 0]);
+	SCB_CleanDCache_by_Addr(LCD_Dma2d_Clut, (1U << img->Bpp) * 4);
+
+	clut.pCLUT = LCD_Dma2d_Clut;
+	clut.CLUTColorMode = DMA2D_CCM_ARGB8888;
+	clut.Size = (1U << img->Bpp) - 1;
+	return HAL_DMA2D_CLUTStartLoad(&LCD_Dma2d, &clut, DMA2D_FOREGROUND_LAYER) == HAL_OK &&
+		   HAL_DMA2D_PollForTransfer(&LCD_Dma2d, 10) == HAL_OK;
+}
+#endif
+
+/***************************************************************************************************************************************
+ *	函 数 名: LCD_DrawImageIndexed
+ *
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *				*img - 调色板图片描述(调色板、颜色序号、尺寸、4/8bpp)
+ *
+ *	函数功能: 在指定坐标处显示调色板图片
+ *
+ *	说    明: 1. 图标等颜色少的图片用4bpp/8bpp存放，读取量是RGB565的1/4或1/2，调色板不超过512字节
+ *				2. 调色板先拷贝到DTCM查找表：8bpp每像素查一次表；4bpp建立256项两像素表，每字节查一次得到两个像素，
+ *				   同一套16色调色板连续绘制时不重建
+ *				3. 按渲染缓冲区大小整行分段展开，整个图片只设置一次窗口，展开下一段时上一段仍在发送
+ *				4. 帧缓冲模式下定义了 LCD_DMA2D_ENABLE 时，调色板载入DMA2D颜色表，由DMA2D按L8/L4格式直接写入帧缓冲；
+ *				   4bpp要求宽度和可见部分的起始列为偶数(行首按字节对齐)，否则由CPU展开
+ *
+ *****************************************************************************************************************************************/
+
+void LCD_DrawImageIndexed(uint16_t x, uint16_t y, const LCD_IndexedImage_t *img)
+{
+	uint16_t width, height, stride, filled = 0;
+	uint16_t *pBuff = NULL;
+
+	if (LCD_TILE_RECORD(LCD_OP_DrawImageIndexed, x, y, 0, 0, img, 0))
+		return; // 录制到显示列表
+
+	if (img == NULL || img->Palette == NULL || img->Pixels == NULL || img->Colors == 0 ||
+		(img->Bpp != 4 && img->Bpp != 8) || img->Width == 0 || img->Height == 0)
+		return;
+	width = img->Width;
+	height = img->Height;
+	stride = (uint16_t)(((uint32_t)width * img->Bpp + 7) / 8);
+
+#ifdef LCD_FB_DMA2D
+	if (LCD_FB_CAPTURE() && (uint32_t)width * height >= LCD_DMA2D_MIN_PIXELS)
+	{
+		LCD_Rect_t vis;
+
+		if (!LCD_FB_Visible(x, y, (int32_t)x + width - 1, (int32_t)y + height - 1, &vis))
+			return;
+		if (img->Bpp == 8 || ((width & 1) == 0 && ((vis.x1 - x) & 1) == 0))
+		{
+			uint16_t w = vis.x2 - vis.x1 + 1;
+			const uint8_t *src = img->Pixels + (uint32_t)(vis.y1 - y) * stride + (vis.x1 - x) * img->Bpp / 8;
+
+			SCB_CleanDCache_by_Addr((uint32_t *)src, (uint32_t)(vis.y2 - vis.y1 + 1) * stride); // CPU生成的图片先写回内存
+			if (LCD_DMA2D_Setup(DMA2D_M2M_PFC, w) &&
+				LCD_DMA2D_Layer(DMA2D_FOREGROUND_LAYER, (img->Bpp == 8) ? DMA2D_INPUT_L8 : DMA2D_INPUT_L4, width - w, 0xFF000000UL) &&
+				LCD_DMA2D_LoadClut(img) && LCD_DMA2D_Start((uint32_t)src, 0, &vis))
+				return;
+		}
+	}
+#endif
+
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+	if (!LCD_FB_CAPTURE() && LCD_Clip_Mode == LCD_CLIP_DROP)
+		return; // 完全不可见，不展开
+
+	LCD_Index_Load(img);
+	for (uint16_t row = 0; row < height; row++)
 	{
-		LCD_DrawPoint(x, y, LCD.Color); /* Draw the current pixel */
-		num += numadd;					/* Increase the numerator by the top of the fraction */
-		if (num >= den)					/* Check if numerator >= denominator */
+		const uint8_t *line = img->Pixels + (uint32_t)row * stride;
+
+		for (uint16_t col = 0; col < width;)
 		{
-			num -= den; /* Calculate the new numerator value */
-			x += xinc1; /* Change the x as appropriate */
-			y += yinc1; /* Change the y as appropriate */
+			uint32_t n = width - col;
+
+			if (pBuff == NULL)
+				pBuff = LCD_NextBuff(); // 另一个缓冲区可能仍在发送，不用等待
+			if (n > (uint32_t)(LCD_BUFF_PIXELS - filled))
+				n = LCD_BUFF_PIXELS - filled; // 宽度超过缓冲区时一行分几段
+			LCD_Index_Expand(pBuff + filled, line, col, n, img->Bpp);
+			col += n;
+			filled += n;
+			if (filled == LCD_BUFF_PIXELS)
+			{
+				LCD_WriteBuff(pBuff, filled);
+				pBuff = NULL;
+				filled = 0;
+			}
 		}
-		x += xinc2; /* Change the x as appropriate */
-		y += yinc2; /* Change the y as appropriate */
 	}
+	if (filled > 0)
+		LCD_WriteBuff(pBuff, filled);
 }
 
+#ifdef USE_FLASH_FONT
 /***************************************************************************************************************************************
- *	函 数 名: LCD_DrawLine_V
+ *	函 数 名: LCD_DrawFlashIndexed
  *
- *	入口参数: x - 水平坐标
- *			 	 y - 垂直坐标
- *				 height - 垂直宽度
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *				 index - 图片编号，即 fontbin_tool.py --indexed 的参数顺序
  *
- *	函数功能: 在指点位置绘制指定长宽的 垂直 线
+ *	函数功能: 显示字库分区中的调色板图片
+ *
+ *	返 回 值: 1 - 已显示，0 - 字库中没有该图片
  *
- *	说    明: 1. 该函数移植于ST官方评估板的例程
- *				 2. 要绘制的区域不能超过屏幕的显示区域
- *            3. 如果只是画垂直的线，优先使用此函数，速度比 LCD_DrawLine 快很多
- *  性能测试：
  *****************************************************************************************************************************************/
 
-void LCD_DrawLine_V(uint16_t x, uint16_t y, uint16_t height)
+uint8_t LCD_DrawFlashIndexed(uint16_t x, uint16_t y, uint16_t index)
 {
-	uint16_t i; // 计数变量
+	LCD_IndexedImage_t img;
 
-	for (i = 0; i < height; i++)
-	{
-		LCD_Buff[i] = LCD.Color; // 写入缓冲区
-	}
-	LCD_SetAddress(x, y, x, y + height - 1); // 设置坐标
+	img.Pixels = FlashFont_GetIndexedImage(index, &img.Palette, &img.Colors, &img.Width, &img.Height, &img.Bpp);
+	if (img.Pixels == NULL)
+		return 0;
+	if (LCD_TILE_RECORD(LCD_OP_DrawFlashIndexed, x, y, index, 0, NULL, 0))
+		return 1; // 描述在栈上，按编号录制
 
-	LCD_WriteBuff(LCD_Buff, height); // 写入显存
+	LCD_DrawImageIndexed(x, y, &img);
+	return 1;
 }
+#endif
 
 /***************************************************************************************************************************************
- *	函 数 名: LCD_DrawLine_H
+ *	函 数 名: LCD_DrawImageRLE
  *
- *	入口参数: x - 水平坐标
- *			 	 y - 垂直坐标
- *				 width  - 水平宽度
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *				*img - 行程压缩图片描述(数据、字节数、尺寸)
  *
- *	函数功能: 在指点位置绘制指定长宽的 水平 线
+ *	函数功能: 在指定坐标处显示行程压缩的RGB565图片
  *
- *	说    明: 1. 该函数移植于ST官方评估板的例程
- *				 2. 要绘制的区域不能超过屏幕的显示区域
- *            3. 如果只是画 水平 的线，优先使用此函数，速度比 LCD_DrawLine 快很多
- *  性能测试：
- ***********************************************************************************************************************************/
+ *	说    明: 1. 记号格式见 LCD_RleImage_t；大面积纯色的界面背景通常压缩到原来的几分之一
+ *				2. 边解码边发送：重复段直接填充、原样段整段拷贝到渲染缓冲区，满一个缓冲区交给BDMA，
+ *				   解码下一段时上一段仍在发送，每像素只有一次写入，解码速度远高于SPI的像素速率
+ *				3. 跨缓冲区的段记下剩余像素数接着解码，不需要整幅图片的RAM；整个图片只设置一次窗口
+ *				4. 解码不会读到 Size 字节之后；数据不足 Width*Height 个像素时其余部分不写
+ *
+ *****************************************************************************************************************************************/
 
-void LCD_DrawLine_H(uint16_t x, uint16_t y, uint16_t width)
+void LCD_DrawImageRLE(uint16_t x, uint16_t y, const LCD_RleImage_t *img)
 {
-	uint16_t i; // 计数变量
-
-	for (i = 0; i < width; i++)
+	const uint16_t *p, *end;
+	uint32_t left; // 剩余像素数
+	uint32_t run = 0; // 当前段剩余像素数
+	uint16_t color = 0;
+	uint8_t repeat = 0;
+
+	if (LCD_TILE_RECORD(LCD_OP_DrawImageRLE, x, y, 0, 0, img, 0))
+		return; // 录制到显示列表
+
+	if (img == NULL || img->Data == NULL || img->Width == 0 || img->Height == 0)
+		return;
+
+	LCD_SetAddress(x, y, x + img->Width - 1, y + img->Height - 1);
+	if (!LCD_FB_CAPTURE() && LCD_Clip_Mode == LCD_CLIP_DROP)
+		return; // 完全不可见，不解码
+
+	p = img->Data;
+	end = p + img->Size / 2;
+	left = (uint32_t)img->Width * img->Height;
+	while (left > 0)
 	{
-		LCD_Buff[i] = LCD.Color; // 写入缓冲区
-	}
-	LCD_SetAddress(x, y, x + width - 1, y); // 设置坐标
+		uint32_t n = (left > LCD_BUFF_PIXELS) ? LCD_BUFF_PIXELS : left;
+		uint16_t *pBuff = LCD_NextBuff(); // 另一个缓冲区可能仍在发送，不用等待
+		uint32_t filled = 0;
+
+		while (filled < n)
+		{
+			uint32_t k;
 
-	LCD_WriteBuff(LCD_Buff, width); // 写入显存
+			if (run == 0)
+			{
+				uint16_t token;
+
+				if (p >= end || ((p[0] & LCD_RLE_REPEAT) && p + 1 >= end))
+					break; // 数据不完整
+				token = *p++;
+				run = (token & LCD_RLE_COUNT) + 1U;
+				repeat = (token & LCD_RLE_REPEAT) != 0;
+				if (repeat)
+					color = *p++;
+				else if (run > (uint32_t)(end - p))
+					run = end - p; // 原样段不读出数据之外
+			}
+			k = (run < n - filled) ? run : n - filled;
+			if (repeat)
+			{
+				for (uint32_t i = 0; i < k; i++)
+					pBuff[filled + i] = color;
+			}
+			else
+			{
+				memcpy(&pBuff[filled], p, k * 2);
+				p += k;
+			}
+			filled += k;
+			run -= k;
+		}
+		if (filled > 0)
+			LCD_WriteBuff(pBuff, (uint16_t)filled);
+		if (filled < n)
+			return;
+		left -= n;
+	}
 }
+
+#ifdef USE_FLASH_FONT
 /***************************************************************************************************************************************
- *	函 数 名: LCD_DrawRect
+ *	函 数 名: LCD_DrawFlashRLE
  *
- *	入口参数: x - 水平坐标
- *			 	 y - 垂直坐标
- *			 	 width  - 水平宽度
- *				 height - 垂直宽度
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *				 index - 图片编号，即 fontbin_tool.py --rle 的参数顺序
  *
- *	函数功能: 在指点位置绘制指定长宽的矩形线条
+ *	函数功能: 显示字库分区中的行程压缩图片
  *
- *	说    明: 1. 该函数移植于ST官方评估板的例程
- *				 2. 要绘制的区域不能超过屏幕的显示区域
+ *	返 回 值: 1 - 已显示，0 - 字库中没有该图片
  *
  *****************************************************************************************************************************************/
 
-void LCD_DrawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+uint8_t LCD_DrawFlashRLE(uint16_t x, uint16_t y, uint16_t index)
 {
-	// 绘制水平线
-	LCD_DrawLine_H(x, y, width);
-	LCD_DrawLine_H(x, y + height - 1, width);
+	LCD_RleImage_t img;
 
-	// 绘制垂直线
-	LCD_DrawLine_V(x, y, height);
-	LCD_DrawLine_V(x + width - 1, y, height);
+	img.Data = FlashFont_GetRleImage(index, &img.Size, &img.Width, &img.Height);
+	if (img.Data == NULL)
+		return 0;
+	if (LCD_TILE_RECORD(LCD_OP_DrawFlashRLE, x, y, index, 0, NULL, 0))
+		return 1; // 描述在栈上，按编号录制
+
+	LCD_DrawImageRLE(x, y, &img);
+	return 1;
+}
+#endif
+
+// 透明度图片混合：RGB565的三个分量错开放到32位字的互不重叠的位段(G在高16位)，
+// 一次乘法同时按透明度缩放三个分量，分量之间留出的空位吸收借位和进位
+#define LCD_ALPHA_MASK 0x07E0F81FUL
+#define LCD_ALPHA_SPREAD(c) (((uint32_t)(c) | ((uint32_t)(c) << 16)) & LCD_ALPHA_MASK)
+#define LCD_ALPHA_DST 0x10000UL // LCD_Alpha_Blend() 的背景：取目标中原有的像素
+
+/**
+ * @brief  ARGB4444的颜色部分扩展为RGB565，高位复制到低位
+ */
+ITCM_CODE static inline uint32_t LCD_ARGB4444_565(uint32_t p)
+{
+	uint32_t r = (p >> 8) & 0xF, g = (p >> 4) & 0xF, b = p & 0xF;
+
+	return (((r << 1) | (r >> 3)) << 11) | (((g << 2) | (g >> 2)) << 5) | ((b << 1) | (b >> 3));
+}
+
+/**
+ * @brief  按透明度(0-32)混合两个RGB565像素
+ */
+ITCM_CODE static inline uint16_t LCD_Alpha_Mix(uint32_t fore, uint32_t back, uint32_t a)
+{
+	uint32_t f = LCD_ALPHA_SPREAD(fore), b = LCD_ALPHA_SPREAD(back);
+
+	b = ((((f - b) * a) >> 5) + b) & LCD_ALPHA_MASK;
+	return (uint16_t)(b | (b >> 16));
+}
+
+/**
+ * @brief  把n个带透明度的像素混合到 dst
+ * @param  src ARGB4444(a8为0)或A8遮罩(a8为1，颜色为画笔色)
+ * @param  back 背景色；为 LCD_ALPHA_DST 时 dst 中原有的像素作为背景
+ * @retval 1-dst中有像素改变
+ * @note   透明度取0-32级，完全透明的像素跳过、完全不透明的直接写入，其余每像素一次乘法
+ */
+ITCM_CODE static uint8_t LCD_Alpha_Blend(uint16_t *dst, const void *src, uint32_t n, uint8_t a8, uint32_t back)
+{
+	const uint16_t *argb = (const uint16_t *)src;
+	const uint8_t *mask = (const uint8_t *)src;
+	uint32_t fore = LCD.Color;
+	uint8_t changed = 0;
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		uint32_t a, b;
+		uint16_t v;
+
+		if (a8)
+			a = (mask[i] + 4U) >> 3;
+		else
+		{
+			a = ((argb[i] >> 12) * 0x22U + 8U) >> 4;
+			fore = LCD_ARGB4444_565(argb[i]);
+		}
+		b = (back == LCD_ALPHA_DST) ? dst[i] : back;
+		if (a == 0)
+		{
+			if (back == LCD_ALPHA_DST)
+				continue;
+			v = (uint16_t)b;
+		}
+		else if (a >= 32)
+			v = (uint16_t)fore;
+		else
+			v = LCD_Alpha_Mix(fore, b, a);
+		if (v != dst[i])
+		{
+			dst[i] = v;
+			changed = 1;
+		}
+	}
+	return changed;
+}
+
+#ifdef LCD_CAPTURE_ENABLE
+/**
+ * @brief  带透明度的图片与帧缓冲/条带中已有的像素混合
+ * @note   帧缓冲模式下定义了 LCD_DMA2D_ENABLE 时由DMA2D混合(ARGB4444/A8前景层+帧缓冲背景层)
+ */
+static void LCD_FB_BlendImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const void *pImage, uint8_t a8)
+{
+	uint8_t size = a8 ? 1 : 2; // 每像素字节数
+	LCD_Rect_t vis;
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	uint16_t dy1 = 0xFFFF, dy2 = 0;
+#endif
+
+	if (!LCD_FB_Visible(x, y, (int32_t)x + width - 1, (int32_t)y + height - 1, &vis))
+		return;
+	LCD_FB_SetWindow(vis.x1, vis.y1, vis.x2, vis.y2); // 条带据此得知本命令涉及的行
+	LCD_DMA2D_Wait();
+#ifdef LCD_FB_DMA2D
+	if ((uint32_t)(vis.x2 - vis.x1 + 1) * (vis.y2 - vis.y1 + 1) >= LCD_DMA2D_MIN_PIXELS)
+	{
+		uint16_t w = vis.x2 - vis.x1 + 1;
+		const uint8_t *src = (const uint8_t *)pImage + ((uint32_t)(vis.y1 - y) * width + (vis.x1 - x)) * size;
+
+		SCB_CleanDCache_by_Addr((uint32_t *)src, ((uint32_t)(vis.y2 - vis.y1) * width + w) * size); // CPU生成的图片先写回内存
+		if (LCD_DMA2D_Setup(DMA2D_M2M_BLEND, w) &&
+			LCD_DMA2D_Layer(DMA2D_FOREGROUND_LAYER, a8 ? DMA2D_INPUT_A8 : DMA2D_INPUT_ARGB4444, width - w,
+							a8 ? LCD_DMA2D_Color(LCD.Color) : 0xFF000000UL) &&
+			LCD_DMA2D_Layer(DMA2D_BACKGROUND_LAYER, DMA2D_INPUT_RGB565, LCD_FB_STRIDE() - w, 0xFF000000UL) &&
+			LCD_DMA2D_Start((uint32_t)src, 1, &vis))
+			return;
+	}
+#endif
+
+	for (uint16_t row = vis.y1; row <= vis.y2; row++)
+	{
+		const uint8_t *src = (const uint8_t *)pImage + ((uint32_t)(row - y) * width + (vis.x1 - x)) * size;
+		uint8_t changed;
+
+		if (!LCD_FB_HIT(row))
+			continue;
+		changed = LCD_Alpha_Blend(LCD_FB_ROW(row) + vis.x1, src, vis.x2 - vis.x1 + 1, a8, LCD_ALPHA_DST);
+#ifdef LCD_FRAMEBUFFER_ENABLE
+		if (changed)
+		{
+			if (dy1 == 0xFFFF)
+				dy1 = row;
+			dy2 = row;
+		}
+#else
+		(void)changed;
+#endif
+	}
+#ifdef LCD_FRAMEBUFFER_ENABLE
+	if (dy1 != 0xFFFF)
+		LCD_FB_MarkDirty(vis.x1, dy1, vis.x2, dy2);
+#endif
+}
+#endif
+
+/**
+ * @brief  ARGB4444/A8图片的公共部分
+ * @note   写入帧缓冲/条带时与已有的像素混合；直接发送时屏幕内容读不回来，与背景色混合
+ */
+static void LCD_DrawImageAlpha(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const void *pImage, uint8_t a8)
+{
+	uint32_t left = (uint32_t)width * height; // 剩余像素数
+	const uint8_t *src = (const uint8_t *)pImage;
+
+	if (left == 0 || pImage == NULL)
+		return;
+#ifdef LCD_CAPTURE_ENABLE
+	if (LCD_FB_CAPTURE())
+	{
+		LCD_FB_BlendImage(x, y, width, height, pImage, a8);
+		return;
+	}
+#endif
+
+	LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+	if (LCD_Clip_Mode == LCD_CLIP_DROP)
+		return; // 完全不可见，不混合
+
+	while (left > 0)
+	{
+		uint32_t n = (left > LCD_BUFF_PIXELS) ? LCD_BUFF_PIXELS : left;
+		uint16_t *pBuff = LCD_NextBuff(); // 另一个缓冲区可能仍在发送，不用等待
+
+		LCD_Alpha_Blend(pBuff, src, n, a8, LCD.BackColor);
+		LCD_WriteBuff(pBuff, (uint16_t)n);
+		src += n * (a8 ? 1 : 2);
+		left -= n;
+	}
 }
 
 /***************************************************************************************************************************************
- *	函 数 名: LCD_DrawCircle
+ *	函 数 名: LCD_DrawImageARGB4444
  *
- *	入口参数: x - 圆心 水平坐标
- *			 	 y - 圆心 垂直坐标
- *			 	 r  - 半径
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *				 width - 图像宽度
+ *				 height - 图像高度
+ *				*pImage - 像素数据首地址，每像素16位 A[15:12] R[11:8] G[7:4] B[3:0]，逐行存放
  *
- *	函数功能: 在坐标 (x,y) 绘制半径为 r 的圆形线条
+ *	函数功能: 在指定坐标处显示带透明度的ARGB4444图标
  *
- *	说    明: 1. 该函数移植于ST官方评估板的例程
- *				 2. 要绘制的区域不能超过屏幕的显示区域
+ *	说    明: 1. 帧缓冲和显示列表模式下与已绘制的内容混合；直接发送时与背景色(LCD_SetBackColor)混合
+ *				2. 帧缓冲模式下定义了 LCD_DMA2D_ENABLE 时由DMA2D混合，数据不能位于DTCM
+ *				3. CPU混合时三个颜色分量用一次乘法同时计算，完全透明和完全不透明的像素不做乘法
  *
  *****************************************************************************************************************************************/
 
-void LCD_DrawCircle(uint16_t x, uint16_t y, uint16_t r)
+void LCD_DrawImageARGB4444(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *pImage)
 {
-	int Xadd = -r, Yadd = 0, err = 2 - 2 * r, e2;
-	do
-	{
+	if (LCD_TILE_RECORD(LCD_OP_DrawImageARGB4444, x, y, width, height, pImage, 0))
+		return; // 录制到显示列表
 
-		LCD_DrawPoint(x - Xadd, y + Yadd, LCD.Color);
-		LCD_DrawPoint(x + Xadd, y + Yadd, LCD.Color);
-		LCD_DrawPoint(x + Xadd, y - Yadd, LCD.Color);
-		LCD_DrawPoint(x - Xadd, y - Yadd, LCD.Color);
-
-		e2 = err;
-		if (e2 <= Yadd)
-		{
-			err += ++Yadd * 2 + 1;
-			if (-Xadd == Yadd && e2 <= Xadd)
-				e2 = 0;
-		}
-		if (e2 > Xadd)
-			err += ++Xadd * 2 + 1;
-	} while (Xadd <= 0);
+	LCD_DrawImageAlpha(x, y, width, height, pImage, 0);
 }
 
 /***************************************************************************************************************************************
- *	函 数 名: LCD_DrawEllipse
+ *	函 数 名: LCD_DrawImageA8
  *
- *	入口参数: x - 圆心 水平坐标
- *			 	 y - 圆心 垂直坐标
- *			 	 r1  - 水平半轴的长度
- *				 r2  - 垂直半轴的长度
+ *	入口参数: x - 起始水平坐标
+ *				 y - 起始垂直坐标
+ *				 width - 图像宽度
+ *				 height - 图像高度
+ *				*pAlpha - 透明度数据首地址，每像素1字节，0为透明、255为画笔色，逐行存放
  *
- *	函数功能: 在坐标 (x,y) 绘制水平半轴为 r1 垂直半轴为 r2 的椭圆线条
+ *	函数功能: 以画笔色显示8位透明度遮罩(单色图标、阴影等)
  *
- *	说    明: 1. 该函数移植于ST官方评估板的例程
- *				 2. 要绘制的区域不能超过屏幕的显示区域
+ *	说    明: 与 LCD_DrawImageARGB4444() 相同，颜色取 LCD_SetColor() 设置的画笔色
  *
  *****************************************************************************************************************************************/
 
-void LCD_DrawEllipse(int x, int y, int r1, int r2)
+void LCD_DrawImageA8(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pAlpha)
 {
-	int Xadd = -r1, Yadd = 0, err = 2 - 2 * r1, e2;
-	float K = 0, rad1 = 0, rad2 = 0;
+	if (LCD_TILE_RECORD(LCD_OP_DrawImageA8, x, y, width, height, pAlpha, 0))
+		return; // 录制到显示列表
 
-	rad1 = r1;
-	rad2 = r2;
+	LCD_DrawImageAlpha(x, y, width, height, pAlpha, 1);
+}
 
-	if (r1 > r2)
-	{
-		do
-		{
-			K = (float)(rad1 / rad2);
+// 圆角表：按半径缓存每行圆角外侧的像素数(及抗锯齿边缘的覆盖率)，只在第一次用到某个半径时计算
+// 行号i从圆角的最外一行(顶行/底行)算起，列号j从最外一列算起，四个圆角对称共用一张表
+typedef struct
+{
+	uint8_t Radius;							  // 0：空
+	uint8_t Inset[LCD_ROUND_MAX_RADIUS];	  // 像素中心在圆外的像素数，轮廓和不抗锯齿的填充使用
+#ifdef LCD_ROUND_AA_ENABLE
+	uint8_t Edge[LCD_ROUND_MAX_RADIUS];	  // 完全在圆外的像素数
+	uint8_t Solid[LCD_ROUND_MAX_RADIUS];  // 完全覆盖之前的像素数，[Edge, Solid) 为边缘像素
+	uint8_t Cover[LCD_ROUND_MAX_RADIUS][LCD_ROUND_MAX_RADIUS]; // 边缘像素的覆盖率(0-32)
+#endif
+} LCD_Round_t;
 
-			LCD_DrawPoint(x - Xadd, y + (uint16_t)(Yadd / K), LCD.Color);
-			LCD_DrawPoint(x + Xadd, y + (uint16_t)(Yadd / K), LCD.Color);
-			LCD_DrawPoint(x + Xadd, y - (uint16_t)(Yadd / K), LCD.Color);
-			LCD_DrawPoint(x - Xadd, y - (uint16_t)(Yadd / K), LCD.Color);
+static LCD_Round_t LCD_Round_Cache[LCD_ROUND_CACHE];
+static uint8_t LCD_Round_Next = 0; // 下一份覆盖的位置(轮换)
 
-			e2 = err;
-			if (e2 <= Yadd)
-			{
-				err += ++Yadd * 2 + 1;
-				if (-Xadd == Yadd && e2 <= Xadd)
-					e2 = 0;
-			}
-			if (e2 > Xadd)
-				err += ++Xadd * 2 + 1;
-		} while (Xadd <= 0);
+/**
+ * @brief  取得半径r的圆角表，没有时计算并覆盖最早的一份
+ * @note   圆心在圆角方块的外角对面(r,r)，以像素中心判断内外；抗锯齿按每像素4x4个采样点统计覆盖率
+ */
+static const LCD_Round_t *LCD_Round_Get(uint8_t r)
+{
+	LCD_Round_t *t;
+	int32_t rr = (int32_t)r * r * 4;
+
+	for (uint8_t k = 0; k < LCD_ROUND_CACHE; k++)
+	{
+		if (LCD_Round_Cache[k].Radius == r)
+			return &LCD_Round_Cache[k];
 	}
-	else
+	t = &LCD_Round_Cache[LCD_Round_Next];
+	LCD_Round_Next = (LCD_Round_Next + 1) % LCD_ROUND_CACHE;
+
+	for (uint8_t i = 0; i < r; i++)
 	{
-		Yadd = -r2;
-		Xadd = 0;
-		do
+		int32_t dy = 2 * (r - i) - 1; // 像素中心到圆心的垂直距离 x2
+
+		t->Inset[i] = r;
+		for (uint8_t j = 0; j < r; j++)
 		{
-			K = (float)(rad2 / rad1);
+			int32_t dx = 2 * (r - j) - 1;
 
-			LCD_DrawPoint(x - (uint16_t)(Xadd / K), y + Yadd, LCD.Color);
-			LCD_DrawPoint(x + (uint16_t)(Xadd / K), y + Yadd, LCD.Color);
-			LCD_DrawPoint(x + (uint16_t)(Xadd / K), y - Yadd, LCD.Color);
-			LCD_DrawPoint(x - (uint16_t)(Xadd / K), y - Yadd, LCD.Color);
+			if (dx * dx + dy * dy <= rr)
+			{
+				t->Inset[i] = j;
+				break;
+			}
+		}
+#ifdef LCD_ROUND_AA_ENABLE
+		t->Edge[i] = r;
+		t->Solid[i] = r;
+		for (uint8_t j = r; j-- > 0;) // 从内向外，遇到完全在圆外的像素为止
+		{
+			uint8_t n = 0;
 
-			e2 = err;
-			if (e2 <= Xadd)
+			for (uint8_t sy = 0; sy < 4; sy++)
 			{
-				err += ++Xadd * 3 + 1;
-				if (-Yadd == Xadd && e2 <= Yadd)
-					e2 = 0;
+				for (uint8_t sx = 0; sx < 4; sx++)
+				{
+					int32_t px = 8 * (r - j) - 2 * sx - 1, py = 8 * (r - i) - 2 * sy - 1; // 采样点到圆心的距离 x8
+
+					n += (px * px + py * py <= rr * 16);
+				}
 			}
-			if (e2 > Yadd)
-				err += ++Yadd * 3 + 1;
-		} while (Yadd <= 0);
+			t->Cover[i][j] = (uint8_t)(n * 2);
+			if (n == 0)
+				break;
+			t->Edge[i] = j;
+			if (n == 16)
+				t->Solid[i] = j;
+		}
+#endif
 	}
+	t->Radius = r;
+	return t;
 }
 
-/***************************************************************************************************************************************
- *	函 数 名: LCD_FillCircle
- *
- *	入口参数: x - 圆心 水平坐标
- *			 	 y - 圆心 垂直坐标
- *			 	 r  - 半径
- *
- *	函数功能: 在坐标 (x,y) 填充半径为 r 的圆形区域
- *
- *	说    明: 1. 该函数移植于ST官方评估板的例程
- *				 2. 要绘制的区域不能超过屏幕的显示区域
- *
- *****************************************************************************************************************************************/
+/**
+ * @brief  圆角行中第j列(从该侧最外一列算起)的覆盖率
+ * @retval 0-32，32为完全覆盖
+ */
+static inline uint8_t LCD_Round_Alpha(const LCD_Round_t *t, uint16_t i, uint16_t j)
+{
+#ifdef LCD_ROUND_AA_ENABLE
+	if (j >= t->Solid[i])
+		return 32;
+	return (j < t->Edge[i]) ? 0 : t->Cover[i][j];
+#else
+	return (j >= t->Inset[i]) ? 32 : 0;
+#endif
+}
 
-void LCD_FillCircle(uint16_t x, uint16_t y, uint16_t r)
+/**
+ * @brief  填充圆角矩形顶部或底部r行
+ * @param  flip 0：顶部，第0行为圆角最外一行；1：底部，最后一行为圆角最外一行
+ * @note   帧缓冲/条带模式下圆角外侧的像素不变，边缘像素与已有的内容混合；
+ *         直接写屏时整块只设置一次窗口，圆角外侧写背景色，边缘像素与背景色混合
+ */
+static void LCD_Round_Band(uint16_t x, uint16_t y, uint16_t width, uint16_t r, const LCD_Round_t *t, uint8_t flip)
 {
-	int32_t D;	   /* Decision Variable */
-	uint32_t CurX; /* Current X Value */
-	uint32_t CurY; /* Current Y Value */
+	uint16_t fore = (uint16_t)LCD.Color, back = (uint16_t)LCD.BackColor;
 
-	D = 3 - (r << 1);
+#ifdef LCD_CAPTURE_ENABLE
+	if (LCD_FB_CAPTURE())
+	{
+		LCD_Rect_t vis;
+#ifdef LCD_FRAMEBUFFER_ENABLE
+		uint16_t dy1 = 0xFFFF, dy2 = 0;
+#endif
+
+		if (!LCD_FB_Visible(x, y, (int32_t)x + width - 1, (int32_t)y + r - 1, &vis))
+			return;
+		LCD_FB_SetWindow(vis.x1, vis.y1, vis.x2, vis.y2); // 条带据此得知本命令涉及的行
+		LCD_DMA2D_Wait();
+		for (uint16_t row = vis.y1; row <= vis.y2; row++)
+		{
+			uint16_t i = flip ? (uint16_t)(y + r - 1 - row) : (uint16_t)(row - y);
+			uint16_t *dst = LCD_FB_ROW(row);
+			uint8_t changed = 0;
+
+			if (!LCD_FB_HIT(row))
+				continue;
+			for (uint16_t col = vis.x1; col <= vis.x2; col++)
+			{
+				uint16_t j = col - x, a;
+				uint16_t v;
+
+				if (j >= width - j)
+					j = width - 1 - j; // 右半边按左半边对称
+				a = (j < r) ? LCD_Round_Alpha(t, i, j) : 32;
+				if (a == 0)
+					continue;
+				v = (a >= 32) ? fore : LCD_Alpha_Mix(fore, dst[col], a);
+				if (v != dst[col])
+				{
+					dst[col] = v;
+					changed = 1;
+				}
+			}
+#ifdef LCD_FRAMEBUFFER_ENABLE
+			if (changed)
+			{
+				if (dy1 == 0xFFFF)
+					dy1 = row;
+				dy2 = row;
+			}
+#else
+			(void)changed;
+#endif
+		}
+#ifdef LCD_FRAMEBUFFER_ENABLE
+		if (dy1 != 0xFFFF)
+			LCD_FB_MarkDirty(vis.x1, dy1, vis.x2, dy2);
+#endif
+		return;
+	}
+#endif
 
-	CurX = 0;
-	CurY = r;
+	if (width > LCD_BUFF_PIXELS)
+		return;
+	LCD_SetAddress(x, y, x + width - 1, y + r - 1);
+	if (LCD_Clip_Mode == LCD_CLIP_DROP)
+		return; // 完全不可见，不生成
 
-	while (CurX <= CurY)
+	for (uint16_t k = 0, rows; k < r; k += rows)
 	{
-		if (CurY > 0)
-		{
-			LCD_DrawLine_V(x - CurX, y - CurY, 2 * CurY);
-			LCD_DrawLine_V(x + CurX, y - CurY, 2 * CurY);
-		}
+		uint16_t *pBuff = LCD_NextBuff(); // 另一个缓冲区可能仍在发送，不用等待
 
-		if (CurX > 0)
+		rows = (r - k < LCD_BUFF_PIXELS / width) ? r - k : LCD_BUFF_PIXELS / width;
+		for (uint16_t n = 0; n < rows; n++)
 		{
-			// LCD_DrawLine(x - CurY, y - CurX,x - CurY,y - CurX + 2*CurX);
-			// LCD_DrawLine(x + CurY, y - CurX,x + CurY,y - CurX + 2*CurX);
+			uint16_t i = flip ? (uint16_t)(r - 1 - k - n) : (uint16_t)(k + n);
+			uint16_t *dst = pBuff + (uint32_t)n * width;
 
-			LCD_DrawLine_V(x - CurY, y - CurX, 2 * CurX);
-			LCD_DrawLine_V(x + CurY, y - CurX, 2 * CurX);
-		}
-		if (D < 0)
-		{
-			D += (CurX << 2) + 6;
-		}
-		else
-		{
-			D += ((CurX - CurY) << 2) + 10;
-			CurY--;
+			for (uint16_t j = 0; j < r; j++) // 两侧圆角
+			{
+				uint8_t a = LCD_Round_Alpha(t, i, j);
+
+				dst[j] = dst[width - 1 - j] = (a == 0) ? back : (a >= 32) ? fore : LCD_Alpha_Mix(fore, back, a);
+			}
+			for (uint16_t j = r; j < width - r; j++)
+			{
+				dst[j] = fore;
+			}
 		}
-		CurX++;
+		LCD_WriteBuff(pBuff, (uint16_t)(rows * width));
 	}
-	LCD_DrawCircle(x, y, r);
+}
+
+/**
+ * @brief  半径不超过短边的一半和 LCD_ROUND_MAX_RADIUS
+ */
+static uint16_t LCD_Round_Limit(uint16_t width, uint16_t height, uint16_t r)
+{
+	if (r > width / 2)
+		r = width / 2;
+	if (r > height / 2)
+		r = height / 2;
+	return (r > LCD_ROUND_MAX_RADIUS) ? LCD_ROUND_MAX_RADIUS : r;
 }
 
 /***************************************************************************************************************************************
- *	函 数 名: LCD_FillRect
+ *	函 数 名: LCD_FillRoundRect
  *
  *	入口参数: x - 水平坐标
  *			 	 y - 垂直坐标
  *			 	 width  - 水平宽度
- *				 height -垂直宽度
+ *				 height - 垂直宽度
+ *				 r - 圆角半径，超过短边的一半或 LCD_ROUND_MAX_RADIUS 时取其中较小的
  *
- *	函数功能: 在坐标 (x,y) 填充指定长宽的实心矩形
+ *	函数功能: 以画笔色填充圆角矩形(按钮、卡片)
  *
- *	说    明: 要绘制的区域不能超过屏幕的显示区域
+ *	说    明: 1. 每行圆角外侧的像素数按半径缓存(LCD_ROUND_CACHE 份)，绘制时不再计算圆
+ *				2. 分为顶部圆角、中间矩形、底部圆角三块，各设置一次窗口；中间部分为一次同色填充，
+ *				   圆角部分按整行写满渲染缓冲区后发送，开销与行数成正比，与 LCD_FillCircle() 拼接相比没有重叠绘制
+ *				3. 定义了 LCD_ROUND_AA_ENABLE 时圆角边缘按覆盖率混合；帧缓冲/条带模式下与已有的内容混合、
+ *				   外侧不变，直接写屏时圆角外侧写背景色并与背景色混合
  *
  *****************************************************************************************************************************************/
 
-void LCD_FillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+void LCD_FillRoundRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t r)
 {
-	LCD_SetAddress(x, y, x + width - 1, y + height - 1); // 设置坐标
-
-	LCD_DC_Data; // 数据指令选择 引脚输出高电平，代表本次传输 数据
+	const LCD_Round_t *t;
 
-	// 修改为16位数据宽度，写入数据更加效率，不需要拆分
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_16BIT; //	16位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
+	if (LCD_TILE_RECORD(LCD_OP_FillRoundRect, x, y, width, height, (const void *)(uintptr_t)r, 0))
+		return; // 录制到显示列表，参数不够，半径放在地址中
 
-	LCD_SPI_Transmit(&LCD_SPI, LCD.Color, width * height);
+	if (width == 0 || height == 0)
+		return;
+	r = LCD_Round_Limit(width, height, r);
+	if (r == 0)
+	{
+		LCD_SetAddress(x, y, x + width - 1, y + height - 1);
+		LCD_WriteColor((uint16_t)LCD.Color, (uint32_t)width * height);
+		return;
+	}
 
-	// 改回8位数据宽度，因为指令和部分数据都是按照8位传输的
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_8BIT; //	8位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
+	t = LCD_Round_Get((uint8_t)r);
+	LCD_Round_Band(x, y, width, r, t, 0);
+	if (height > 2 * r)
+	{
+		LCD_SetAddress(x, y + r, x + width - 1, y + height - r - 1);
+		LCD_WriteColor((uint16_t)LCD.Color, (uint32_t)width * (height - 2 * r));
+	}
+	LCD_Round_Band(x, y + height - r, width, r, t, 1);
 }
 
 /***************************************************************************************************************************************
- *	函 数 名: LCD_DrawImage
+ *	函 数 名: LCD_DrawRoundRect
  *
- *	入口参数: x - 起始水平坐标
- *				 y - 起始垂直坐标
- *			 	 width  - 图片的水平宽度
- *				 height - 图片的垂直宽度
- *				*pImage - 图片数据存储区的首地址
+ *	入口参数: x - 水平坐标
+ *			 	 y - 垂直坐标
+ *			 	 width  - 水平宽度
+ *				 height - 垂直宽度
+ *				 r - 圆角半径，限制与 LCD_FillRoundRect() 相同
  *
- *	函数功能: 在指定坐标处显示图片
+ *	函数功能: 以画笔色绘制1像素宽的圆角矩形边框
  *
- *	说    明: 1.要显示的图片需要事先进行取模、获悉图片的长度和宽度
- *            2.使用 LCD_SetColor() 函数设置画笔色，LCD_SetBackColor() 设置背景色
+ *	说    明: 1. 与 LCD_FillRoundRect() 共用圆角表，边框是填充区域中上方或外侧有空白的像素，不抗锯齿
+ *				2. 每个圆角行左右各一段、直边各一段，每段一次窗口设置，边框内外的像素不变
  *
  *****************************************************************************************************************************************/
 
-void LCD_DrawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pImage)
+void LCD_DrawRoundRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t r)
 {
-	uint8_t disChar;			  // 字模的值
-	uint16_t Xaddress = x;		  // 水平坐标
-	uint16_t Yaddress = y;		  // 垂直坐标
-	uint16_t i = 0, j = 0, m = 0; // 计数变量
-	uint16_t BuffCount = 0;		  // 缓冲区计数
-	uint16_t Buff_Height = 0;	  // 缓冲区的行数
+	const LCD_Round_t *t;
 
-	// 因为缓冲区大小有限，需要分多次写入
-	Buff_Height = (sizeof(LCD_Buff) / 2) / height; // 计算缓冲区能够写入图片的多少行
+	if (LCD_TILE_RECORD(LCD_OP_DrawRoundRect, x, y, width, height, (const void *)(uintptr_t)r, 0))
+		return; // 录制到显示列表，参数不够，半径放在地址中
 
-	for (i = 0; i < height; i++) // 循环按行写入
+	if (width == 0 || height == 0)
+		return;
+	r = LCD_Round_Limit(width, height, r);
+	if (r == 0)
 	{
-		for (j = 0; j < (float)width / 8; j++)
-		{
-			disChar = *pImage;
-
-			for (m = 0; m < 8; m++)
-			{
-				if (disChar & 0x01)
-				{
-					LCD_Buff[BuffCount] = LCD.Color; // 当前模值不为0时，使用画笔色绘点
-				}
-				else
-				{
-					LCD_Buff[BuffCount] = LCD.BackColor; // 否则使用背景色绘制点
-				}
-				disChar >>= 1;				 // 模值移位
-				Xaddress++;					 // 水平坐标自加
-				BuffCount++;				 // 缓冲区计数
-				if ((Xaddress - x) == width) // 如果水平坐标达到了字符宽度，则退出当前循环,进入下一行的绘制
-				{
-					Xaddress = x;
-					break;
-				}
-			}
-			pImage++;
-		}
-		if (BuffCount == Buff_Height * width) // 达到缓冲区所能容纳的最大行数时
-		{
-			BuffCount = 0; // 缓冲区计数清0
+		LCD_DrawRect(x, y, width, height);
+		return;
+	}
 
-			LCD_SetAddress(x, Yaddress, x + width - 1, Yaddress + Buff_Height - 1); // 设置坐标
-			LCD_WriteBuff(LCD_Buff, width * Buff_Height);							// 写入显存
+	t = LCD_Round_Get((uint8_t)r);
+	for (uint16_t i = 0; i < r; i++)
+	{
+		int a = t->Inset[i];
+		int b = (i == 0) ? width - 1 - a : ((t->Inset[i - 1] - 1 > a) ? t->Inset[i - 1] - 1 : a); // 左侧一段的终点
 
-			Yaddress = Yaddress + Buff_Height; // 计算行偏移，开始写入下一部分数据
-		}
-		if ((i + 1) == height) // 到了最后一行时
+		if (i == 0) // 顶行和底行是整段直边
 		{
-			LCD_SetAddress(x, Yaddress, x + width - 1, i + y);		 // 设置坐标
-			LCD_WriteBuff(LCD_Buff, width * (i + 1 + y - Yaddress)); // 写入显存
+			LCD_DrawSpan(x + a, y, x + b, y);
+			LCD_DrawSpan(x + a, y + height - 1, x + b, y + height - 1);
+			continue;
 		}
+		LCD_DrawSpan(x + a, y + i, x + b, y + i);
+		LCD_DrawSpan(x + width - 1 - b, y + i, x + width - 1 - a, y + i);
+		LCD_DrawSpan(x + a, y + height - 1 - i, x + b, y + height - 1 - i);
+		LCD_DrawSpan(x + width - 1 - b, y + height - 1 - i, x + width - 1 - a, y + height - 1 - i);
+	}
+	if (height > 2 * r)
+	{
+		LCD_DrawSpan(x, y + r, x, y + height - r - 1);
+		LCD_DrawSpan(x + width - 1, y + r, x + width - 1, y + height - r - 1);
 	}
-}
-
-/***************************************************************************************************************************************
- *	函 数 名: LCD_CopyBuffer
- *
- *	入口参数: x - 起始水平坐标
- *				 y - 起始垂直坐标
- *			 	 width  - 目标区域的水平宽度
- *				 height - 目标区域的垂直宽度
- *				*pImage - 数据存储区的首地址
- *
- *	函数功能: 在指定坐标处，直接将数据复制到屏幕的显存
- *
- *	说    明: 批量复制函数，可用于移植 LVGL 或者将摄像头采集的图像显示出来
- *
- *****************************************************************************************************************************************/
-
-void LCD_CopyBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *DataBuff)
-{
-
-	LCD_SetAddress(x, y, x + width - 1, y + height - 1);
-
-	LCD_DC_Data; // 数据指令选择 引脚输出高电平，代表本次传输 数据
-
-	// 修改为16位数据宽度，写入数据更加效率，不需要拆分
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_16BIT; //	16位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
-
-	LCD_SPI_TransmitBuffer(&LCD_SPI, DataBuff, width * height);
-
-	//	HAL_SPI_Transmit(&hspi5, (uint8_t *)DataBuff, (x2-x1+1) * (y2-y1+1), 1000) ;
-
-	// 改回8位数据宽度，因为指令和部分数据都是按照8位传输的
-	LCD_SPI.Init.DataSize = SPI_DATASIZE_8BIT; //	8位数据宽度
-	HAL_SPI_Init(&LCD_SPI);
 }
 
 /**********************************************************************************************************************************
@@ -1386,18 +13907,22 @@ void LCD_CopyBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uin
  * @param Tickstart: Tick start value
  * @retval HAL status
  */
-HAL_StatusTypeDef LCD_SPI_WaitOnFlagUntilTimeout(SPI_HandleTypeDef *hspi, uint32_t Flag, FlagStatus Status,
-												 uint32_t Tickstart, uint32_t Timeout)
+ITCM_CODE HAL_StatusTypeDef LCD_SPI_WaitOnFlagUntilTimeout(SPI_HandleTypeDef *hspi, uint32_t Flag,
+														   FlagStatus Status, uint32_t Tickstart, uint32_t Timeout)
 {
+	PERF_TIMER_START(wait_start);
+
 	/* Wait until flag is set */
 	while ((__HAL_SPI_GET_FLAG(hspi, Flag) ? SET : RESET) == Status)
 	{
 		/* Check for the Timeout */
 		if ((((HAL_GetTick() - Tickstart) >= Timeout) && (Timeout != HAL_MAX_DELAY)) || (Timeout == 0U))
 		{
+			PERF_TIMER_STOP(spi_wait_cycles, wait_start);
 			return HAL_TIMEOUT;
 		}
 	}
+	PERF_TIMER_STOP(spi_wait_cycles, wait_start);
 	return HAL_OK;
 }
 
@@ -1462,6 +13987,118 @@ void LCD_SPI_CloseTransfer(SPI_HandleTypeDef *hspi)
 	hspi->RxXferCount = (uint16_t)0UL;
 }
 
+/**
+ * @brief  TXP未置位时的超时判断
+ * @note   每 LCD_SPI_TIMEOUT_POLLS 次轮询才读取一次 HAL_GetTick()，发送循环只剩标志判断和写TXDR，
+ *         CPU写入速度高于SPI发送速度，FIFO始终保持满
+ * @retval 1-已超时(传输已关闭), 0-继续等待
+ */
+ITCM_CODE static inline uint8_t LCD_SPI_PollTimeout(SPI_HandleTypeDef *hspi, uint32_t *polls, uint32_t tickstart,
+													 uint32_t Timeout)
+{
+	if ((++(*polls) & (LCD_SPI_TIMEOUT_POLLS - 1U)) != 0U)
+	{
+		return 0;
+	}
+	if (!((((HAL_GetTick() - tickstart) >= Timeout) && (Timeout != HAL_MAX_DELAY)) || (Timeout == 0U)))
+	{
+		return 0;
+	}
+
+	/* Call standard close procedure with error check */
+	LCD_SPI_CloseTransfer(hspi);
+
+	/* Process Unlocked */
+	__HAL_UNLOCK(hspi);
+
+	SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_TIMEOUT);
+	hspi->State = HAL_SPI_STATE_READY;
+	return 1;
+}
+
+/**
+ * @brief  设置传输长度并启动传输
+ * @note   第一段写入 TSIZE，第二段写入 TSER，第一段结束时硬件自动装入，传输不中断
+ * @retval 尚未写入 TSIZE/TSER 的数据个数，由 LCD_SPI_Reload() 在发送过程中接续
+ */
+ITCM_CODE static uint32_t LCD_SPI_Start(SPI_HandleTypeDef *hspi, uint32_t Size)
+{
+	uint32_t first = (Size > LCD_SPI_TSIZE_MAX) ? LCD_SPI_TSIZE_MAX : Size;
+	uint32_t next = Size - first;
+
+	if (next > LCD_SPI_TSIZE_MAX)
+		next = LCD_SPI_TSIZE_MAX;
+	__HAL_SPI_CLEAR_TSERFFLAG(hspi); // 上一次传输留下的标志会被当作 TSER 已装入
+	MODIFY_REG(hspi->Instance->CR2, SPI_CR2_TSIZE | SPI_CR2_TSER, first | (next << SPI_CR2_TSER_Pos));
+
+	/* Enable SPI peripheral */
+	__HAL_SPI_ENABLE(hspi);
+
+	if (hspi->Init.Mode == SPI_MODE_MASTER)
+	{
+		/* Master transfer start */
+		SET_BIT(hspi->Instance->CR1, SPI_CR1_CSTART);
+	}
+	return Size - first - next;
+}
+
+/**
+ * @brief  TSER 已装入 TSIZE 时写入下一段的长度
+ * @param  sr 本次轮询读到的SR
+ * @note   发送循环每次轮询都检查，此时 TSIZE 中还剩一整段；SPI只发送写入FIFO的数据，
+ *         CPU被打断时传输停在FIFO空处，不会在接续之前结束
+ */
+ITCM_CODE static inline void LCD_SPI_Reload(SPI_HandleTypeDef *hspi, uint32_t sr, uint32_t *reload)
+{
+	uint32_t next;
+
+	if (*reload == 0U || (sr & SPI_FLAG_TSERF) == 0U)
+		return;
+	next = (*reload > LCD_SPI_TSIZE_MAX) ? LCD_SPI_TSIZE_MAX : *reload;
+	__HAL_SPI_CLEAR_TSERFFLAG(hspi);
+	MODIFY_REG(hspi->Instance->CR2, SPI_CR2_TSER, next << SPI_CR2_TSER_Pos);
+	*reload -= next;
+}
+
+/**
+ * @brief  最后一个数据写入FIFO后结束传输
+ * @note   1. 启用DMA时不等待发送完：打开EOT中断后立即返回，由 HAL_SPI_IRQHandler() 关闭传输，
+ *            完成回调清除 LCD_DMA_TxBuff 的标记；FIFO中的数据发出期间CPU可以准备下一段，
+ *            下一次传输或切换数据宽度前由 LCD_WaitIdle() 等待
+ *         2. 未启用DMA时等待EOT后关闭传输；TSIZE 为实际长度，不再需要挂起(CSUSP)传输
+ */
+ITCM_CODE static HAL_StatusTypeDef LCD_SPI_Finish(SPI_HandleTypeDef *hspi, uint32_t tickstart, uint32_t Timeout)
+{
+#ifdef LCD_SPI_DMA_ENABLE
+	(void)tickstart;
+	(void)Timeout;
+	LCD_DMA_TxBuff = LCD_SPI_EOT_WAIT; // 先标记，EOT中断可能立即进入
+
+	/* Process Unlocked */
+	__HAL_UNLOCK(hspi);
+
+	__HAL_SPI_ENABLE_IT(hspi, SPI_IT_EOT); // 状态保持 BUSY_TX，由中断恢复
+	return HAL_OK;
+#else
+	if (LCD_SPI_WaitOnFlagUntilTimeout(hspi, SPI_FLAG_EOT, RESET, tickstart, Timeout) != HAL_OK)
+	{
+		SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_FLAG);
+	}
+	LCD_SPI_CloseTransfer(hspi); /* Call standard close procedure with error check */
+
+	/* Process Unlocked */
+	__HAL_UNLOCK(hspi);
+
+	hspi->State = HAL_SPI_STATE_READY;
+
+	if (hspi->ErrorCode != HAL_SPI_ERROR_NONE)
+	{
+		return HAL_ERROR;
+	}
+	return HAL_OK;
+#endif
+}
+
 /**
  * @brief  专为屏幕清屏而修改，将需要清屏的颜色批量传输
  * @param  hspi   : spi的句柄
@@ -1470,12 +14107,15 @@ void LCD_SPI_CloseTransfer(SPI_HandleTypeDef *hspi)
  * @retval HAL status
  */
 
-HAL_StatusTypeDef LCD_SPI_Transmit(SPI_HandleTypeDef *hspi, uint16_t pData, uint32_t Size)
+ITCM_CODE HAL_StatusTypeDef LCD_SPI_Transmit(SPI_HandleTypeDef *hspi, uint16_t pData, uint32_t Size)
 {
 	uint32_t tickstart;
 	uint32_t Timeout = 1000;  // 超时判断
 	uint32_t LCD_pData_32bit; // 按32位传输时的数据
 	uint32_t LCD_TxDataCount; // 传输计数
+	uint32_t polls = 0;		  // TXP未置位的轮询次数
+	uint32_t reload;		  // 尚未写入 TSIZE/TSER 的数据个数
+	uint32_t sr;
 	HAL_StatusTypeDef errorcode = HAL_OK;
 
 	/* Check Direction parameter */
@@ -1500,6 +14140,7 @@ HAL_StatusTypeDef LCD_SPI_Transmit(SPI_HandleTypeDef *hspi, uint16_t pData, uint
 		__HAL_UNLOCK(hspi);
 		return errorcode;
 	}
+	LCD_PERF_TX(Size * 2); // 16位数据宽度
 
 	/* Set the transaction information */
 	hspi->State = HAL_SPI_STATE_BUSY_TX;
@@ -1521,78 +14162,44 @@ HAL_StatusTypeDef LCD_SPI_Transmit(SPI_HandleTypeDef *hspi, uint16_t pData, uint
 		SPI_1LINE_TX(hspi);
 	}
 
-	// 不使用硬件 TSIZE 控制，此处设置为0，即不限制传输的数据长度
-	MODIFY_REG(hspi->Instance->CR2, SPI_CR2_TSIZE, 0);
-
-	/* Enable SPI peripheral */
-	__HAL_SPI_ENABLE(hspi);
-
-	if (hspi->Init.Mode == SPI_MODE_MASTER)
-	{
-		/* Master transfer start */
-		SET_BIT(hspi->Instance->CR1, SPI_CR1_CSTART);
-	}
+	// TSIZE 为实际长度，超过一段的在发送过程中经 TSER 接续，全部发出后硬件产生EOT
+	reload = LCD_SPI_Start(hspi, Size);
 
 	/* Transmit data in 16 Bit mode */
-	while (LCD_TxDataCount > 0UL)
+	// FIFO阈值为2个数据时TXP表示能放下一个32位写入，每次写2个像素
+	if (hspi->Init.FifoThreshold > SPI_FIFO_THRESHOLD_01DATA)
 	{
-		/* Wait until TXP flag is set to send data */
-		if (__HAL_SPI_GET_FLAG(hspi, SPI_FLAG_TXP))
+		while (LCD_TxDataCount > 1UL)
 		{
-			if ((hspi->TxXferCount > 1UL) && (hspi->Init.FifoThreshold > SPI_FIFO_THRESHOLD_01DATA))
-			{
-				*((__IO uint32_t *)&hspi->Instance->TXDR) = (uint32_t)LCD_pData_32bit;
-				LCD_TxDataCount -= (uint16_t)2UL;
-			}
-			else
+			sr = hspi->Instance->SR;
+			LCD_SPI_Reload(hspi, sr, &reload);
+			if ((sr & SPI_FLAG_TXP) != 0U)
 			{
-				*((__IO uint16_t *)&hspi->Instance->TXDR) = (uint16_t)pData;
-				LCD_TxDataCount--;
+				LCD_SPI_WRITE_TXDR32(hspi, LCD_pData_32bit);
+				LCD_TxDataCount -= 2UL;
 			}
-		}
-		else
-		{
-			/* Timeout management */
-			if ((((HAL_GetTick() - tickstart) >= Timeout) && (Timeout != HAL_MAX_DELAY)) || (Timeout == 0U))
+			else if (LCD_SPI_PollTimeout(hspi, &polls, tickstart, Timeout))
 			{
-				/* Call standard close procedure with error check */
-				LCD_SPI_CloseTransfer(hspi);
-
-				/* Process Unlocked */
-				__HAL_UNLOCK(hspi);
-
-				SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_TIMEOUT);
-				hspi->State = HAL_SPI_STATE_READY;
 				return HAL_ERROR;
 			}
 		}
 	}
-
-	if (LCD_SPI_WaitOnFlagUntilTimeout(hspi, SPI_SR_TXC, RESET, tickstart, Timeout) != HAL_OK)
-	{
-		SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_FLAG);
-	}
-
-	SET_BIT((hspi)->Instance->CR1, SPI_CR1_CSUSP); // 请求挂起SPI传输
-	/* 等待SPI挂起 */
-	if (LCD_SPI_WaitOnFlagUntilTimeout(hspi, SPI_FLAG_SUSP, RESET, tickstart, Timeout) != HAL_OK)
+	while (LCD_TxDataCount > 0UL) // 奇数个像素的最后一个，或阈值为1个数据时逐个发送
 	{
-		SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_FLAG);
+		sr = hspi->Instance->SR;
+		LCD_SPI_Reload(hspi, sr, &reload);
+		if ((sr & SPI_FLAG_TXP) != 0U)
+		{
+			LCD_SPI_WRITE_TXDR16(hspi, (uint16_t)pData);
+			LCD_TxDataCount--;
+		}
+		else if (LCD_SPI_PollTimeout(hspi, &polls, tickstart, Timeout))
+		{
+			return HAL_ERROR;
+		}
 	}
-	LCD_SPI_CloseTransfer(hspi); /* Call standard close procedure with error check */
-
-	SET_BIT((hspi)->Instance->IFCR, SPI_IFCR_SUSPC); // 清除挂起标志位
-
-	/* Process Unlocked */
-	__HAL_UNLOCK(hspi);
-
-	hspi->State = HAL_SPI_STATE_READY;
 
-	if (hspi->ErrorCode != HAL_SPI_ERROR_NONE)
-	{
-		return HAL_ERROR;
-	}
-	return errorcode;
+	return LCD_SPI_Finish(hspi, tickstart, Timeout);
 }
 
 /**
@@ -1602,11 +14209,14 @@ HAL_StatusTypeDef LCD_SPI_Transmit(SPI_HandleTypeDef *hspi, uint16_t pData, uint
  * @param  Size   : 数据大小
  * @retval HAL status
  */
-HAL_StatusTypeDef LCD_SPI_TransmitBuffer(SPI_HandleTypeDef *hspi, uint16_t *pData, uint32_t Size)
+ITCM_CODE HAL_StatusTypeDef LCD_SPI_TransmitBuffer(SPI_HandleTypeDef *hspi, uint16_t *pData, uint32_t Size)
 {
 	uint32_t tickstart;
 	uint32_t Timeout = 1000;  // 超时判断
 	uint32_t LCD_TxDataCount; // 传输计数
+	uint32_t polls = 0;		  // TXP未置位的轮询次数
+	uint32_t reload;		  // 尚未写入 TSIZE/TSER 的数据个数
+	uint32_t sr;
 	HAL_StatusTypeDef errorcode = HAL_OK;
 
 	/* Check Direction parameter */
@@ -1631,6 +14241,7 @@ HAL_StatusTypeDef LCD_SPI_TransmitBuffer(SPI_HandleTypeDef *hspi, uint16_t *pDat
 		__HAL_UNLOCK(hspi);
 		return errorcode;
 	}
+	LCD_PERF_TX(Size * 2); // 16位数据宽度
 
 	/* Set the transaction information */
 	hspi->State = HAL_SPI_STATE_BUSY_TX;
@@ -1651,80 +14262,46 @@ HAL_StatusTypeDef LCD_SPI_TransmitBuffer(SPI_HandleTypeDef *hspi, uint16_t *pDat
 		SPI_1LINE_TX(hspi);
 	}
 
-	// 不使用硬件 TSIZE 控制，此处设置为0，即不限制传输的数据长度
-	MODIFY_REG(hspi->Instance->CR2, SPI_CR2_TSIZE, 0);
-
-	/* Enable SPI peripheral */
-	__HAL_SPI_ENABLE(hspi);
-
-	if (hspi->Init.Mode == SPI_MODE_MASTER)
-	{
-		/* Master transfer start */
-		SET_BIT(hspi->Instance->CR1, SPI_CR1_CSTART);
-	}
+	// TSIZE 为实际长度，超过一段的在发送过程中经 TSER 接续，全部发出后硬件产生EOT
+	reload = LCD_SPI_Start(hspi, Size);
 
 	/* Transmit data in 16 Bit mode */
-	while (LCD_TxDataCount > 0UL)
+	// 与 LCD_SPI_Transmit 相同，每次32位写入2个像素，低半字先发送
+	if (hspi->Init.FifoThreshold > SPI_FIFO_THRESHOLD_01DATA)
 	{
-		/* Wait until TXP flag is set to send data */
-		if (__HAL_SPI_GET_FLAG(hspi, SPI_FLAG_TXP))
+		while (LCD_TxDataCount > 1UL)
 		{
-			if ((LCD_TxDataCount > 1UL) && (hspi->Init.FifoThreshold > SPI_FIFO_THRESHOLD_01DATA))
+			sr = hspi->Instance->SR;
+			LCD_SPI_Reload(hspi, sr, &reload);
+			if ((sr & SPI_FLAG_TXP) != 0U)
 			{
-				*((__IO uint32_t *)&hspi->Instance->TXDR) = *((uint32_t *)pData);
+				LCD_SPI_WRITE_TXDR32(hspi, *((uint32_t *)pData)); // M7允许非对齐的单字读取
 				pData += 2;
-				LCD_TxDataCount -= 2;
-			}
-			else
-			{
-				*((__IO uint16_t *)&hspi->Instance->TXDR) = *((uint16_t *)pData);
-				pData += 1;
-				LCD_TxDataCount--;
+				LCD_TxDataCount -= 2UL;
 			}
-		}
-		else
-		{
-			/* Timeout management */
-			if ((((HAL_GetTick() - tickstart) >= Timeout) && (Timeout != HAL_MAX_DELAY)) || (Timeout == 0U))
+			else if (LCD_SPI_PollTimeout(hspi, &polls, tickstart, Timeout))
 			{
-				/* Call standard close procedure with error check */
-				LCD_SPI_CloseTransfer(hspi);
-
-				/* Process Unlocked */
-				__HAL_UNLOCK(hspi);
-
-				SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_TIMEOUT);
-				hspi->State = HAL_SPI_STATE_READY;
 				return HAL_ERROR;
 			}
 		}
 	}
-
-	if (LCD_SPI_WaitOnFlagUntilTimeout(hspi, SPI_SR_TXC, RESET, tickstart, Timeout) != HAL_OK)
-	{
-		SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_FLAG);
-	}
-
-	SET_BIT((hspi)->Instance->CR1, SPI_CR1_CSUSP); // 请求挂起SPI传输
-	/* 等待SPI挂起 */
-	if (LCD_SPI_WaitOnFlagUntilTimeout(hspi, SPI_FLAG_SUSP, RESET, tickstart, Timeout) != HAL_OK)
+	while (LCD_TxDataCount > 0UL)
 	{
-		SET_BIT(hspi->ErrorCode, HAL_SPI_ERROR_FLAG);
+		sr = hspi->Instance->SR;
+		LCD_SPI_Reload(hspi, sr, &reload);
+		if ((sr & SPI_FLAG_TXP) != 0U)
+		{
+			LCD_SPI_WRITE_TXDR16(hspi, *pData);
+			pData += 1;
+			LCD_TxDataCount--;
+		}
+		else if (LCD_SPI_PollTimeout(hspi, &polls, tickstart, Timeout))
+		{
+			return HAL_ERROR;
+		}
 	}
-	LCD_SPI_CloseTransfer(hspi); /* Call standard close procedure with error check */
-
-	SET_BIT((hspi)->Instance->IFCR, SPI_IFCR_SUSPC); // 清除挂起标志位
-
-	/* Process Unlocked */
-	__HAL_UNLOCK(hspi);
-
-	hspi->State = HAL_SPI_STATE_READY;
 
-	if (hspi->ErrorCode != HAL_SPI_ERROR_NONE)
-	{
-		return HAL_ERROR;
-	}
-	return errorcode;
+	return LCD_SPI_Finish(hspi, tickstart, Timeout);
 }
 
 #endif
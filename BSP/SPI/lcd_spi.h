@@ -8,7 +8,7 @@
  * @attention
  * 配置说明：
  * - 屏幕格式：16位RGB565
- * - SPI通信速度：60MHz
+ * - SPI通信速度：默认60MHz，定义 LCD_SPI_CLOCK_ENABLE 后可运行时调整并自动校准
  * - 显存刷新：60Hz
  *
  * 使用示例：
@@ -42,28 +42,33 @@ extern "C"
 #include <stdio.h>
 #include "lcd_fonts.h"
 #include "lcd_image.h"
+#include "lcd_ctrl.h"
 #include "init.h"
 
 #ifdef LCD_SPI_ENABLE
     typedef struct _pFont pFONT; // 前向声明
+    typedef struct _FontGlyphRun FontGlyphRun_t; // 前向声明
 
     /*******************************************************************************
      *                              GPIO引脚定义
      ******************************************************************************/
 
+// 以下为屏幕0(SPI6)的引脚，其他屏幕的引脚在 LCD_Panel_Add() 的参数中给出
 #define LCD_Backlight_PIN GPIO_PIN_6                               // 背光  引脚
 #define LCD_Backlight_PORT GPIOH                                   // 背光 GPIO端口
 #define GPIO_LDC_Backlight_CLK_ENABLE __HAL_RCC_GPIOH_CLK_ENABLE() // 背光 GPIO时钟
 
-#define LCD_Backlight_OFF HAL_GPIO_WritePin(LCD_Backlight_PORT, LCD_Backlight_PIN, GPIO_PIN_RESET); // 低电平，关闭背光
-#define LCD_Backlight_ON HAL_GPIO_WritePin(LCD_Backlight_PORT, LCD_Backlight_PIN, GPIO_PIN_SET);    // 高电平，开启背光
-
 #define LCD_DC_PIN GPIO_PIN_12                              // 数据指令选择  引脚
 #define LCD_DC_PORT GPIOG                                   // 数据指令选择  GPIO端口
 #define GPIO_LDC_DC_CLK_ENABLE __HAL_RCC_GPIOG_CLK_ENABLE() // 数据指令选择  GPIO时钟
 
-#define LCD_DC_Command HAL_GPIO_WritePin(LCD_DC_PORT, LCD_DC_PIN, GPIO_PIN_RESET); // 低电平，指令传输
-#define LCD_DC_Data HAL_GPIO_WritePin(LCD_DC_PORT, LCD_DC_PIN, GPIO_PIN_SET);      // 高电平，数据传输
+#define LCD_CS_PIN GPIO_PIN_15 // 片选 引脚，平时为SPI6硬件NSS，校准回读时临时改为GPIO
+#define LCD_CS_PORT GPIOA      // 片选 GPIO端口
+
+#define LCD_TE_PIN GPIO_PIN_7                               // 撕裂效应输出(TE) 引脚，定义 LCD_TE_ENABLE 时使用，按实际接线修改
+#define LCD_TE_PORT GPIOH                                   // 撕裂效应输出 GPIO端口
+#define GPIO_LDC_TE_CLK_ENABLE __HAL_RCC_GPIOH_CLK_ENABLE() // 撕裂效应输出 GPIO时钟
+#define LCD_TE_IRQn EXTI9_5_IRQn                            // TE引脚的EXTI中断号，与 stm32h7xx_it.c 中的中断服务函数对应
 
     /*******************************************************************************
      *                              屏幕参数配置
@@ -71,6 +76,19 @@ extern "C"
 
 #define LCD_Width 240    /*!< LCD像素宽度 */
 #define LCD_Height 320   /*!< LCD像素高度 */
+#ifndef LCD_CONTROLLER
+#define LCD_CONTROLLER (&LCD_Ctrl_ST7789) /*!< 屏幕0的控制器描述表，见 lcd_ctrl.h */
+#endif
+#define LCD_SLEEP_OUT_MS 120 /*!< 退出休眠指令到打开显示的最短等待(ms)，SPI_LCD_InitEnd() 只等待剩余部分 */
+// #define LCD_WARM_RESET_ENABLE /*!< 定义了：看门狗/软件复位后(RCC->RSR 没有上电/掉电复位标志)各屏幕第一次初始化不执行初始化脚本、不等待退出休眠，只恢复显示模式、窗口和方向, 注释后：每次完整初始化；屏幕复位脚接MCU的NRST时内部复位同样复位屏幕，不能定义 */
+#define LCD_WARM_WAKE_MS 5 /*!< 热复位时退出休眠指令后的等待(ms)，复位前屏幕已休眠时需要，已唤醒时指令无作用 */
+#define LCD_SPLASH_IMAGE 0 /*!< 开机画面在字库分区中的图片编号(fontbin_tool.py --image 的顺序)，init_all() 在退出休眠的等待期间写入显存，注释后：不显示开机画面 */
+#define LCD_PALETTE_SIZE 32  /*!< 调色板项数，前 LCD_PAL_USER 项为预定义颜色，其余由 LCD_SetPaletteColor() 设置 */
+#define LCD_LUT_CACHE 4      /*!< 保存的字模展开表份数(每份128字节，抗锯齿另加32字节)，在几组颜色间切换时直接取回 */
+#define LCD_ROUND_MAX_RADIUS 24 /*!< 圆角矩形的最大圆角半径，更大的按该值绘制 */
+#define LCD_ROUND_CACHE 4       /*!< 按半径缓存的圆角表份数(每份约 LCD_ROUND_MAX_RADIUS^2+3*LCD_ROUND_MAX_RADIUS 字节) */
+#define LCD_ROUND_AA_ENABLE     /*!< 定义了：圆角矩形填充的圆角边缘按覆盖率混合, 注释后：按像素中心取舍，圆角表每份只有 LCD_ROUND_MAX_RADIUS 字节 */
+#define LCD_PANEL_MAX 2      /*!< 最多驱动的屏幕数(含SPI6上的屏幕0)，每块有独立的SPI、DMA通道和引脚，字库共用 */
 
 
     /*******************************************************************************
@@ -78,6 +96,236 @@ extern "C"
      ******************************************************************************/
 #define USE_FLASH_FONT /*!< 定义了：使用Flash字库, 注释后：使用内置取模字库 */
 // #define IS_GB2312 /*!< 在使用flash字库的前提下，定义了：使用gb2312, 注释后：使用UTF8 */
+#define LCD_TEXT_BATCH 32 /*!< LCD_DisplayText每次批量解析的字符数(每个占4字节栈空间) */
+#define LCD_LAYOUT_LINES 16 /*!< LCD_Layout_t 记录的最多行数(每行6字节)，更多的行绘制时再排版 */
+#define LCD_TEXT_LINE_BYTES 96 /*!< LCD_DisplayTextBox() 每次拷贝到栈上绘制的最多字节数 */
+// #define LCD_PAGER_ENABLE /*!< 定义了：长文档分页器，调度器后台分片排版并记录各页起点，任意页直接绘制, 注释后：不编译 */
+#define LCD_PAGER_SLICE_LINES 64 /*!< LCD_Pager_Task() 每次排版的行数(只读字宽表，16号字约每行20个字) */
+#define LCD_PAGER_MS 5 /*!< 调度器调用 LCD_Pager_Task() 的周期(ms)，排版未完成时不睡眠 */
+#define LCD_TEXT_MEMO_ENABLE /*!< 定义了：按字符串地址缓存 LCD_DisplayText()/LCD_DrawLayout() 的解析结果(字模偏移和宽度)，重复显示的标签不解码不查表(UTF8 Flash字库), 注释后：每次解析 */
+#define LCD_TEXT_MEMO_ENTRIES 16 /*!< 缓存的字符串个数(每个24字节) */
+#define LCD_TEXT_MEMO_GLYPHS 256 /*!< 所有缓存字符串合计的字符数(每个8字节)，超过其1/4的字符串不缓存 */
+#define LCD_TEXT_MEMO_VERIFY /*!< 定义了：命中时校验字符串内容(只扫描字节不解码)，改写过的缓冲区自动重新解析, 注释后：只比较地址，改写缓冲区后须调用 LCD_TextMemo_Invalidate() */
+
+    /*******************************************************************************
+     *                             SPI时钟配置
+     ******************************************************************************/
+#define LCD_SPI_CLOCK_ENABLE /*!< 定义了：SPI6内核时钟改由PLL3Q提供，像素时钟可用 LCD_SPI_SetClock() 调整, 注释后：沿用CubeMX配置(D3PCLK1 120MHz / 2 = 60MHz) */
+#define LCD_SPI_CLOCK_HZ 60000000UL     /*!< SPI_LCD_Init() 设置的像素时钟(SCK) */
+#define LCD_SPI_CLOCK_MAX_HZ 100000000UL /*!< 允许设置的最高像素时钟，SPI6内核时钟不超过其2倍 */
+#define LCD_SPI_PLL_SRC_HZ HSI_VALUE    /*!< PLL时钟源频率，须与 SystemClock_Config() 中的 PLLSource 一致 */
+#define LCD_SPI_PLL3_M 4                /*!< PLL3输入分频，64MHz / 4 = 16MHz */
+#define LCD_SPI_READ_HZ 6000000UL       /*!< 校准时回读寄存器的时钟，ST7789读周期不小于150ns */
+#define LCD_SPI_CALIB_START_HZ 40000000UL /*!< LCD_SPI_Calibrate() 的起始频率 */
+#define LCD_SPI_CALIB_STEP_HZ 5000000UL   /*!< LCD_SPI_Calibrate() 的频率步进，也是最终结果保留的余量 */
+#define LCD_SPI_CALIB_TRIALS 32           /*!< 每个频率写入/回读寄存器的次数 */
+
+    /*******************************************************************************
+     *                             DMA传输配置
+     ******************************************************************************/
+#define LCD_SPI_DMA_ENABLE /*!< 定义了：LCD_WriteBuff 使用BDMA后台传输, 注释后：阻塞传输 */
+#define LCD_DMA_RAM_BASE 0x38000000UL /*!< SRAM4起始地址，SPI6位于D3域，BDMA只能访问SRAM4 */
+#define LCD_DMA_RAM_SIZE 0x00010000UL /*!< SRAM4大小(64KB) */
+#define LCD_SPI_DMA_FILL_MIN 256 /*!< 同色填充(清屏、LCD_FillRect等)不少于该像素数时由BDMA从固定地址重复发送，立即返回；更少时CPU写TXDR */
+
+#define LCD_IMAGE_MDMA_ENABLE /*!< 定义了：LCD_DrawImage565() 由MDMA把像素搬到SRAM4渲染缓冲区, 注释后：CPU拷贝(只在 LCD_SPI_DMA_ENABLE 时使用) */
+#define LCD_IMAGE_MDMA_CHANNEL MDMA_CHANNEL(LCD_IMAGE_MDMA_CH) /*!< LCD_DrawImage565() 使用的MDMA通道，通道号在 init.h 的"MDMA通道分配"中修改 */
+
+#define LCD_RGB444_ENABLE /*!< 定义了：LCD_SetPixelFormat(LCD_PIXEL_RGB444) 可把屏幕切换为12位接口像素，发送时两个像素打包为3字节, 注释后：只用RGB565 */
+#define LCD_RGB444_WORDS 128 /*!< 每个打包缓冲区的帧数(一帧2个像素)，每块屏幕两个轮流使用 */
+
+    /*******************************************************************************
+     *                             FMC并口屏配置
+     ******************************************************************************/
+// #define LCD_FMC_ENABLE /*!< 定义了：LCD_Panel_Add() 可以添加一块接在FMC上的8080并口屏(Spi为NULL)，绘图函数与SPI屏相同, 注释后：只支持SPI屏 */
+#define LCD_FMC_MDMA_CHANNEL MDMA_CHANNEL(LCD_FMC_MDMA_CH) /*!< FMC屏发送像素的MDMA通道，通道号在 init.h 的"MDMA通道分配"中修改 */
+#define LCD_FMC_DMA_MIN 64 /*!< 不少于该像素数时由MDMA后台写入FMC数据地址，更少时CPU直接写入(只在 LCD_SPI_DMA_ENABLE 且16位总线时使用) */
+
+#define LCD_BUFF_COUNT 2     /*!< 渲染缓冲区个数，2个时一个在DMA发送、另一个展开下一个字模 */
+#define LCD_BUFF_PIXELS 1024 /*!< 每个渲染缓冲区的像素数，至少容纳最大字模(32x32) */
+
+#ifdef LCD_SPI_DMA_ENABLE
+#define LCD_DMA_AT(addr) SRAM4_AT(addr) /*!< 把缓冲区放到SRAM4的指定地址(见init.h的DMA缓冲区放置) */
+/* SRAM4各区域的起始地址(写成不带后缀的十六进制数)，每个区域不能越过下一个区域，见下方"SRAM4区域检查" */
+#define LCD_BUFF_ADDR 0x38000000        /*!< 渲染缓冲区 */
+#define LCD_TILE_ADDR 0x38002000        /*!< 条带缓冲区(只在 LCD_TILE_ENABLE 时占用，否则渲染缓冲区可以用到像素缓存之前) */
+#define LCD_PIXEL_CACHE_ADDR 0x38008000 /*!< 像素缓存 */
+#define LCD_RGB444_ADDR 0x3800A400      /*!< RGB444打包缓冲区(只在 LCD_RGB444_ENABLE 时占用，否则像素缓存可以用到同色填充颜色字之前) */
+#define LCD_FILL_ADDR 0x3800AFC0        /*!< 同色填充的颜色字 */
+#define LCD_STRIP_ADDR 0x3800B000       /*!< 文本行缓冲区，到SRAM4末尾 */
+#ifndef LCD_DMA_BUFF_ATTR
+#define LCD_DMA_BUFF_ATTR LCD_DMA_AT(LCD_BUFF_ADDR) /*!< 渲染缓冲区存放位置，SRAM4起始处 */
+#endif
+#ifndef LCD_PIXEL_CACHE_ATTR
+#define LCD_PIXEL_CACHE_ATTR LCD_DMA_AT(LCD_PIXEL_CACHE_ADDR) /*!< 像素缓存放在SRAM4(12KB)，命中时同样可以DMA发送 */
+#endif
+#ifndef LCD_STRIP_ATTR
+#define LCD_STRIP_ATTR LCD_DMA_AT(LCD_STRIP_ADDR) /*!< 文本行缓冲区放在SRAM4最后20KB */
+#endif
+#ifndef LCD_RGB444_ATTR
+#define LCD_RGB444_ATTR LCD_DMA_AT(LCD_RGB444_ADDR) /*!< RGB444打包缓冲区放在像素缓存12KB区域的后部(至多2.9KB)，BDMA直接读取 */
+#endif
+#ifndef LCD_FILL_ATTR
+#define LCD_FILL_ATTR LCD_DMA_AT(LCD_FILL_ADDR) /*!< 同色填充的颜色字，每块屏幕32字节(一个Cache行)，占用像素缓存12KB区域的最后64字节 */
+#endif
+#else
+#ifndef LCD_DMA_BUFF_ATTR
+#define LCD_DMA_BUFF_ATTR DTCM_BSS /*!< 阻塞传输时渲染缓冲区只由CPU读写，放在DTCM(需定义 TCM_ENABLE，见init.h) */
+#endif
+#ifndef LCD_RGB444_ATTR
+#define LCD_RGB444_ATTR DTCM_BSS /*!< 阻塞传输时打包缓冲区放在DTCM */
+#endif
+#endif
+
+#define LCD_PIXEL_CACHE_ENABLE /*!< 定义了：缓存展开后的RGB565字模, 注释后：每次重新展开 */
+#define LCD_PIXEL_CACHE_SLOTS 8 /*!< 像素缓存槽数 */
+#define LCD_PIXEL_CACHE_SLOT_PIXELS (24 * 24) /*!< 每槽像素数，大于此尺寸的字模不缓存(24x24槽约1.1KB) */
+// #define LCD_CACHE_BALANCE_ENABLE /*!< 定义了：字模缓存和像素缓存按未命中代价分配共同的字节预算(需 GLYPH_CACHE_ENABLE), 注释后：各用编译时容量 */
+#define LCD_CACHE_BALANCE_BYTES 12288U /*!< 两个缓存合计使用的字节数，达到两者编译时容量之和时不需要调整 */
+#define LCD_CACHE_BALANCE_MS 500	   /*!< 调度器调用 LCD_CacheBalance_Task() 的周期(ms)，每次最多移动一个像素缓存槽的字节数 */
+#define LCD_CACHE_QSPI_CYCLES 8		   /*!< 字模缓存未命中时从QSPI读取每字节的代价(CPU周期，按映射读取吞吐估计) */
+#define LCD_CACHE_EXPAND_CYCLES 2	   /*!< 像素缓存未命中时展开每个像素的代价(CPU周期，可用 LCD_MeasureExpandCycles() 测得) */
+#define LCD_NUM_ATLAS_ENABLE			 /*!< 定义了：数字和常用符号按字号、颜色预先展开到DTCM，LCD_DisplayNumber()/LCD_Printf() 等整串只设置一次窗口发送(Flash字库), 注释后：逐字绘制 */
+#define LCD_NUM_ATLAS_CHARS " 0123456789.-:%" /*!< 图集收录的字符，含补位用的空格 */
+#define LCD_NUM_ATLAS_SLOTS 2				 /*!< 同时保留的字号/颜色组合数，按最久未使用替换 */
+#define LCD_NUM_ATLAS_MAX_SIZE 24			 /*!< 收录的最大字号，每槽占 字符数 x 字号/2 x 字号 x 2 字节(24号约8.4KB) */
+#ifndef LCD_PIXEL_CACHE_ATTR
+#define LCD_PIXEL_CACHE_ATTR DTCM_BSS /*!< 阻塞传输时像素缓存放在DTCM, 如需指定AXI SRAM可定义为section属性 */
+#endif
+
+#define LCD_EXPAND_FIXED_ENABLE /*!< 定义了：常用字宽(6-32像素)的字模用宽度固定、循环全部展开的专用函数展开, 注释后：统一使用通用展开函数 */
+// #define LCD_EXPAND_SEL_ENABLE /*!< 定义了：1bpp字模的整字节部分用 __USUB16/__SEL 按位选取画笔色/背景色，每次写2个像素, 注释后：查展开表；按 LCD_MeasureExpandCycles() 的结果选择 */
+#define LCD_EXPAND_BIT 0 /*!< LCD_MeasureExpandCycles()：逐位判断 */
+#define LCD_EXPAND_LUT 1 /*!< LCD_MeasureExpandCycles()：查展开表(默认) */
+#define LCD_EXPAND_SEL 2 /*!< LCD_MeasureExpandCycles()：__SEL 选取(LCD_EXPAND_SEL_ENABLE) */
+
+#define LCD_TEXT_STRIP_ENABLE /*!< 定义了：LCD_DisplayText 把一行字模合成后一次发送, 注释后：逐字设置窗口发送 */
+#define LCD_STRIP_PIXELS (320 * 32) /*!< 行缓冲区像素数(屏幕长边 x 最大字号)，约20KB */
+#ifndef LCD_STRIP_ATTR
+#define LCD_STRIP_ATTR /*!< 行缓冲区存放位置 */
+#endif
+
+#define LCD_GLYPH_RUN_ENABLE /*!< 定义了：大字模按同色段发送，长段走常量色通道不写缓冲区, 注释后：整字展开到缓冲区 */
+#define LCD_GLYPH_RUN_SIZE 32 /*!< 字模高度不小于该值时按同色段发送(像素缓存容纳不下的字号) */
+#define LCD_GLYPH_RUN_MIN 64  /*!< 同色段不短于该像素数时用 LCD_SPI_Transmit 直接发送，更短的段仍写入缓冲区 */
+
+#define LCD_FONT_EXTRA_SIZES 4 /*!< Flash字库目录中12/16/20/24/32以外同时可选的字号数(14/18/28等)，每个字号占两个pFONT，0为不使用 */
+#define LCD_TEXT_SCALE_ENABLE /*!< 定义了：ASCII字符可整数倍放大(LCD_SetTextFont(48/64/96)、LCD_SetTextScale()), 注释后：只显示字库原有字号 */
+#define LCD_TEXT_SCALE_SMOOTH /*!< 定义了：放大时按Scale2x/Scale3x规则平滑斜边, 注释后：直接复制像素 */
+#define LCD_TEXT_EFFECT_ENABLE /*!< 定义了：LCD_SetTextEffect() 可在1bpp字模上按位运算加粗、描边和加阴影, 展开时一并写入缓冲区, 注释后：不使用 */
+#define LCD_TEXT_ROTATE_ENABLE /*!< 定义了：LCD_DisplayTextRotated() 把字模按32x32位矩阵转置后旋转90°绘制(竖向标签、旋转仪表), 注释后：不使用 */
+
+    /*******************************************************************************
+     *                             帧缓冲配置
+     ******************************************************************************/
+// #define LCD_FRAMEBUFFER_ENABLE /*!< 定义了：所有绘图先写入AXI SRAM帧缓冲，调用 LCD_Flush() 时只发送脏区域, 注释后：直接写屏 */
+#define LCD_FB_DIRTY_RECTS 8 /*!< 最多记录的脏矩形个数，超出后合并到增长面积最小的矩形 */
+#define LCD_FB_WINDOW_COST 48 /*!< 设置一次窗口的开销折合的像素数(初值)，两个脏矩形合并后多发送的像素不超过该值时合并；LCD_Flush_SetWindowCost() 可按实测修改 */
+#ifndef LCD_FB_ATTR
+#define LCD_FB_ATTR AXI_SRAM_AT(0x24000000) /*!< 帧缓冲(150KB)存放在AXI SRAM起始处 */
+#endif
+// #define LCD_DMA2D_ENABLE /*!< 定义了：帧缓冲模式下的大面积填充、RGB888和调色板图片、透明背景的4bpp抗锯齿字模由DMA2D写入帧缓冲, 注释后：CPU写入 */
+#define LCD_DMA2D_MIN_PIXELS 256 /*!< 不少于该像素数时才交给DMA2D，DMA2D写入的整个矩形计入脏区域(不再逐像素比较) */
+#ifndef LCD_DMA2D_CLUT_ATTR
+#define LCD_DMA2D_CLUT_ATTR AXI_SRAM_AT(0x24025800) /*!< 调色板图片的DMA2D颜色表(1KB)，DMA2D不能读DTCM，放在帧缓冲之后的空隙 */
+#endif
+
+// #define LCD_TILE_ENABLE /*!< 定义了：LCD_TileBegin()/LCD_TileEnd() 之间的绘图录制为显示列表，按条带回放后发送, 注释后：不使用 */
+#define LCD_TILE_PIXELS (320 * 16) /*!< 每个条带的像素数(屏幕长边 x 16行)，竖屏时每条 LCD_TILE_PIXELS/240 行 */
+#define LCD_TILE_COUNT 2           /*!< 条带缓冲区个数，2个时一个在DMA发送、另一个回放下一条 */
+#define LCD_TILE_CMDS 64           /*!< 显示列表最多记录的绘图命令数 */
+#define LCD_TILE_TEXT_BYTES 512    /*!< 显示列表中保存字符串的字节数 */
+#ifndef LCD_TILE_ATTR
+#ifdef LCD_SPI_DMA_ENABLE
+#define LCD_TILE_ATTR LCD_DMA_AT(LCD_TILE_ADDR) /*!< 条带缓冲区放在SRAM4，紧接渲染缓冲区之后(24KB) */
+#else
+#define LCD_TILE_ATTR /*!< 条带缓冲区存放位置 */
+#endif
+#endif
+
+#define LCD_RENDER_BUFFER_ENABLE /*!< 定义了：LCD_RenderTextToBuffer() 经捕获后端把文本绘制到内存缓冲区, 注释后：该函数立即返回，直接写屏时少一次捕获判断 */
+
+#if defined(LCD_FRAMEBUFFER_ENABLE) && defined(LCD_TILE_ENABLE)
+#error "LCD_FRAMEBUFFER_ENABLE 与 LCD_TILE_ENABLE 只能启用一个"
+#endif
+
+    /*******************************************************************************
+     *                             撕裂效应(TE)同步配置
+     ******************************************************************************/
+// #define LCD_TE_ENABLE /*!< 定义了：LCD_TE_Enable() 打开屏幕0的TE输出并由EXTI记录每帧起点，LCD_Flush() 等屏幕刷新扫过脏区域后再发送, 注释后：不等待 */
+#define LCD_TE_VBLANK_LINES 24  /*!< TE上升沿到显存第0行开始刷新之间的行数(前肩+后肩)，ST7789 PORCTRL(0xB2)为12+12 */
+#define LCD_TE_MARGIN_US 300    /*!< 发送时间窗两端各留的余量(微秒)，抵消DMA启动和估算误差 */
+#define LCD_TE_TIMEOUT_MS 100   /*!< 超过该时间没有TE脉冲(屏幕休眠或TE未接线)时不再等待 */
+#define LCD_TE_IRQ_PRIORITY 1   /*!< TE中断优先级，高于其他外设中断，时间戳才准确 */
+
+    /*******************************************************************************
+     *                             保留模式配置
+     ******************************************************************************/
+#define LCD_RETAIN_ENABLE /*!< 定义了：LCD_RetainBegin()/LCD_RetainEnd() 之间的文本和填充与上一帧比较，只重绘变化的部分, 注释后：不使用 */
+#define LCD_RETAIN_ITEMS 32         /*!< 每帧最多保留的项数(LCD_DisplayText/LCD_DisplayString/LCD_DisplayNumber/LCD_FillRect 各算一项) */
+#define LCD_RETAIN_TEXT_BYTES 512   /*!< 每帧保存字符串的字节数 */
+#define LCD_RETAIN_DIRTY 16         /*!< 每帧记录的重绘区域个数，超出后其余项全部重绘 */
+
+    /*******************************************************************************
+     *                             命令队列配置
+     ******************************************************************************/
+// #define LCD_QUEUE_ENABLE /*!< 定义了：LCD_Queue_*() 把绘图命令排入队列后立即返回，由 main_while() 中的 LCD_Queue_Poll() 在DMA空闲时执行, 注释后：LCD_Queue_*() 同步绘制 */
+#define LCD_QUEUE_CMDS 32         /*!< 队列最多容纳的命令数(含栅栏) */
+#define LCD_QUEUE_TEXT_BYTES 512  /*!< 队列中保存字符串的字节数，队列清空时回收 */
+#define LCD_QUEUE_SLICE_MS 2      /*!< LCD_Queue_Poll() 每次最多连续执行的毫秒数 */
+#define LCD_QUEUE_STRIP_ROWS 16   /*!< 低于 LCD_PRIO_INPUT 的清屏/填充/图片/拷贝命令每段执行的行数，段之间先执行更高优先级的命令，0：不分段 */
+#define LCD_PRIO_INPUT 0          /*!< 命令优先级：输入反馈(按键、触摸的高亮和光标)，最先执行 */
+#define LCD_PRIO_LIVE 1           /*!< 命令优先级：实时数值，默认 */
+#define LCD_PRIO_BACKGROUND 2     /*!< 命令优先级：背景和整页重绘 */
+#define LCD_QUEUE_CLASSES 3       /*!< 优先级个数 */
+// #define LCD_QUEUE_SERVER /*!< 定义了：只有渲染任务调用 LCD_Queue_Poll()，其他任务经 LCD_GC_*() 排入命令，队列满时返回0, 注释后：队列满时排入函数先执行最早的命令 */
+// #define LCD_QUEUE_LOCK() taskENTER_CRITICAL()   /*!< 排入/结束命令的临界区，未定义时关中断；也可用 osMutexAcquire(lcd_mutex, osWaitForever) */
+// #define LCD_QUEUE_UNLOCK() taskEXIT_CRITICAL()  /*!< 与 LCD_QUEUE_LOCK() 配对 */
+// #define LCD_QUEUE_YIELD() osDelay(1)            /*!< LCD_QUEUE_SERVER 下 LCD_Queue_Wait() 等待渲染任务时调用，未定义时空转 */
+
+    /*******************************************************************************
+     *                             报警显示配置
+     ******************************************************************************/
+// #define LCD_ALARM_ENABLE /*!< 定义了：LCD_Alarm_Show() 只用锁定在DTCM中的字模和ITCM中的代码绘制报警文字，耗时与QSPI和背景负载无关, 注释后：不使用(需 GLYPH_CACHE_LOCK_SLOTS 不小于报警字符数) */
+#ifndef LCD_ALARM_TIMESTAMP
+#define LCD_ALARM_TIMESTAMP() (DWT->CYCCNT) /*!< 报警绘制计时的时间戳，单位为CPU周期 */
+#endif
+
+#ifdef LCD_SPI_DMA_ENABLE
+/* SRAM4区域检查：每个区域从起始地址算起，不能越过下一个启用的区域 */
+#ifdef LCD_TILE_ENABLE
+#define LCD_BUFF_END LCD_TILE_ADDR
+#else
+#define LCD_BUFF_END LCD_PIXEL_CACHE_ADDR
+#endif
+#if LCD_BUFF_ADDR + LCD_BUFF_COUNT * LCD_BUFF_PIXELS * 2 > LCD_BUFF_END
+#error "渲染缓冲区越过了下一个SRAM4区域(条带缓冲区或像素缓存)，请减小 LCD_BUFF_COUNT 或 LCD_BUFF_PIXELS"
+#endif
+#if defined(LCD_TILE_ENABLE) && (LCD_TILE_ADDR + LCD_TILE_COUNT * LCD_TILE_PIXELS * 2 > LCD_PIXEL_CACHE_ADDR)
+#error "条带缓冲区越过了像素缓存，请减小 LCD_TILE_COUNT 或 LCD_TILE_PIXELS"
+#endif
+#if defined(LCD_PIXEL_CACHE_ENABLE) && (LCD_PIXEL_CACHE_ADDR + LCD_PIXEL_CACHE_SLOTS * LCD_PIXEL_CACHE_SLOT_PIXELS * 2 > LCD_FILL_ADDR)
+#error "像素缓存超过SRAM4中预留的12KB(最后64字节为同色填充的颜色字)"
+#endif
+#if LCD_FILL_ADDR + LCD_PANEL_MAX * 32 > LCD_STRIP_ADDR
+#error "同色填充的颜色字只预留了2块屏幕，请同时修改 LCD_FILL_ADDR 和 LCD_STRIP_ADDR"
+#endif
+#if defined(LCD_RGB444_ENABLE) && defined(LCD_PIXEL_CACHE_ENABLE) && (LCD_PIXEL_CACHE_ADDR + LCD_PIXEL_CACHE_SLOTS * LCD_PIXEL_CACHE_SLOT_PIXELS * 2 > LCD_RGB444_ADDR)
+#error "像素缓存与RGB444打包缓冲区重叠，请减小像素缓存或修改 LCD_RGB444_ADDR"
+#endif
+#if defined(LCD_RGB444_ENABLE) && (LCD_RGB444_ADDR + LCD_PANEL_MAX * LCD_RGB444_WORDS * 8 > LCD_FILL_ADDR)
+#error "RGB444打包缓冲区超过同色填充颜色字之前的空间，请减小 LCD_RGB444_WORDS"
+#endif
+#if defined(LCD_TEXT_STRIP_ENABLE) && (LCD_STRIP_ADDR + LCD_STRIP_PIXELS * 2 > LCD_DMA_RAM_BASE + LCD_DMA_RAM_SIZE)
+#error "行缓冲区超过SRAM4中预留的20KB"
+#endif
+#if defined(LCD_TILE_ENABLE) && (LCD_BUFF_COUNT * LCD_BUFF_PIXELS * 2 > 0x2000)
+#error "启用 LCD_TILE_ENABLE 时渲染缓冲区不能超过8KB"
+#endif
+#if defined(LCD_TILE_ENABLE) && (LCD_TILE_COUNT * LCD_TILE_PIXELS * 2 > 0x6000)
+#error "条带缓冲区超过SRAM4中预留的24KB"
+#endif
+#endif
 
 #ifndef FLASH_FONT_ENABLE
     #ifdef USE_FLASH_FONT
@@ -100,6 +348,36 @@ extern "C"
 #define Direction_V 2      /*!< 竖屏显示 */
 #define Direction_V_Flip 3 /*!< 竖屏显示，上下翻转 */
 
+/**
+ * @brief 接口像素格式
+ * @note  示例：LCD_SetPixelFormat(LCD_PIXEL_RGB444) 文字为主的界面整屏刷新少发25%的数据
+ */
+#define LCD_PIXEL_RGB565 0 /*!< 16位，每像素2字节(默认) */
+#define LCD_PIXEL_RGB444 1 /*!< 12位，两个像素3字节，颜色按高4位截取 */
+
+/**
+ * @brief 屏幕的总线和引脚，由 LCD_Panel_Add() 登记
+ * @note  尺寸和偏移按竖屏(Direction_V)给出，横屏时自动互换
+ */
+typedef struct
+{
+    SPI_HandleTypeDef *Spi; /*!< SPI句柄，须已关联发送DMA(hdmatx)；FMC屏为NULL */
+    GPIO_TypeDef *DcPort;   /*!< 数据指令选择 GPIO端口，FMC屏的RS接在地址线上，为NULL */
+    uint16_t DcPin;         /*!< 数据指令选择 引脚 */
+    GPIO_TypeDef *BlPort;   /*!< 背光 GPIO端口 */
+    uint16_t BlPin;         /*!< 背光 引脚 */
+    uint16_t Width;         /*!< 竖屏像素宽度 */
+    uint16_t Height;        /*!< 竖屏像素高度 */
+    uint8_t X_Offset;       /*!< 竖屏时控制器的列偏移，例如240x240屏接在240x320控制器上为0 */
+    uint8_t Y_Offset;       /*!< 竖屏时控制器的行偏移 */
+    const LCD_Controller_t *Ctrl; /*!< 控制器描述表，NULL时与屏幕0相同 */
+    volatile uint16_t *FmcCmd;    /*!< FMC屏：RS为低的地址，写入指令 */
+    volatile uint16_t *FmcData;   /*!< FMC屏：RS为高的地址，写入参数和像素 */
+    uint8_t FmcBus8;              /*!< FMC屏：1-8位数据总线(像素拆成两次写入，由CPU发送)，0-16位 */
+} LCD_PanelConfig_t;
+
+#define LCD_PANEL_NONE 0xFF /*!< LCD_Panel_Add() 失败时的返回值 */
+
 /*******************************************************************************
  *                              数字显示模式
  ******************************************************************************/
@@ -111,6 +389,353 @@ extern "C"
 #define Fill_Zero 0  /*!< 多余位填充0 */
 #define Fill_Space 1 /*!< 多余位填充空格 */
 
+#define LCD_NUM_MAX 24 /*!< 数字字符串的最大长度(含结束符)，len 超出时按此截断 */
+#define LCD_PRINTF_BYTES 96 /*!< LCD_Printf() 格式化结果的最大字节数(含结束符)，在栈上分配 */
+
+/**
+ * @brief 数字控件，记住上次显示的字符串，更新时只重绘变化的字符
+ * @note  先用 LCD_NumberInit() 初始化，之后每帧调用 LCD_NumberShow()
+ */
+typedef struct
+{
+    char Text[LCD_NUM_MAX]; /*!< 上次显示的字符串，空串表示下次整体重绘 */
+    const pFONT *Font;            /*!< 上次显示时的ASCII字体 */
+    uint32_t Color;         /*!< 上次显示时的画笔色 */
+    uint32_t BackColor;     /*!< 上次显示时的背景色 */
+    uint16_t X;             /*!< 起始水平坐标 */
+    uint16_t Y;             /*!< 起始垂直坐标 */
+    uint8_t Len;            /*!< 总位数(含符号和小数点) */
+    uint8_t Decs;           /*!< 小数位数，0表示整数 */
+    uint8_t Scale;          /*!< 上次显示时的放大倍数 */
+} LCD_Number_t;
+
+/*******************************************************************************
+ *                              文字显示模式
+ ******************************************************************************/
+/**
+ * @brief 字符背景模式
+ * @note  示例：LCD_SetTextMode(Text_Transparent) 在图片上叠加文字
+ */
+#define Text_Opaque 0      /*!< 字符背景填充背景色(默认) */
+#define Text_Transparent 1 /*!< 只绘制前景笔画，背景保持屏幕原有内容 */
+
+/**
+ * @brief 文本效果(可组合，需定义 LCD_TEXT_EFFECT_ENABLE)
+ * @note  示例：LCD_SetTextEffect(Text_EffectBold | Text_EffectOutline, LCD_BLACK) 粗体黑边标签
+ */
+#define Text_EffectNone 0x00    /*!< 无效果(默认) */
+#define Text_EffectBold 0x01    /*!< 加粗：笔画向右扩1列 */
+#define Text_EffectOutline 0x02 /*!< 描边：笔画四周1像素用效果颜色 */
+#define Text_EffectShadow 0x04  /*!< 阴影：笔画向右下偏移1像素用效果颜色 */
+
+/**
+ * @brief 文本编码(UTF8 Flash字库下运行时选择，与 FONT_ENC_UTF8/FONT_ENC_GBK 相同)
+ * @note  示例：LCD_SetTextEncoding(Text_GBK) 直接显示旧协议发来的GBK字符串
+ */
+#define Text_UTF8 0 /*!< UTF-8字符串(默认) */
+#define Text_GBK 1  /*!< GBK字符串：ASCII单字节，汉字为GB2312区位双字节 */
+
+/**
+ * @brief 文本框中每行的对齐方式
+ * @note  示例：LCD_DisplayTextBox(0, 100, 240, "标题", LCD_TEXT_ALIGN_CENTER)
+ */
+#define LCD_TEXT_ALIGN_LEFT 0   /*!< 左对齐 */
+#define LCD_TEXT_ALIGN_CENTER 1 /*!< 居中 */
+#define LCD_TEXT_ALIGN_RIGHT 2  /*!< 右对齐 */
+
+/**
+ * @brief 旋转文本的方向(相对当前显示方向)
+ * @note  示例：LCD_DisplayTextRotated(200, 10, "温度", Text_Rotate_90) 在右侧竖向显示标签
+ */
+#define Text_Rotate_90 1  /*!< 顺时针旋转90°，字头朝右，文字从上往下排 */
+#define Text_Rotate_270 3 /*!< 逆时针旋转90°，字头朝左，文字从下往上排 */
+
+/**
+ * @brief 排版结果中的一行
+ */
+typedef struct
+{
+    uint16_t Start; /*!< 行首相对字符串的字节偏移 */
+    uint16_t Bytes; /*!< 要绘制的字节数(不含换行处的空格和'\n') */
+    uint16_t Width; /*!< 显示宽度 */
+} LCD_LayoutLine_t;
+
+/**
+ * @brief 段落排版结果，由 LCD_LayoutText() 生成，LCD_DrawLayout() 反复绘制
+ * @note  只保存字符串地址，绘制前字符串需保持有效且不被改写
+ */
+typedef struct
+{
+    const char *Text;     /*!< 字符串 */
+    const pFONT *AsciiFonts;    /*!< 排版时的英文字体 */
+    const pFONT *CHFonts;       /*!< 排版时的中文字体 */
+    uint8_t Family;       /*!< 排版时的字体族 */
+    uint8_t Encoding;     /*!< 排版时的文本编码 */
+    uint16_t BoxWidth;    /*!< 文本框宽度 */
+    uint16_t Width;       /*!< 最宽一行的宽度 */
+    uint16_t Height;      /*!< 总高度 */
+    uint16_t LineHeight;  /*!< 行高 */
+    uint16_t Lines;       /*!< 总行数，可以超过 LCD_LAYOUT_LINES */
+    uint16_t Rest;        /*!< 第 LCD_LAYOUT_LINES 行之后的文字偏移 */
+    uint16_t Bytes;       /*!< 字符串字节数 */
+    uint16_t Sum;         /*!< 字符串校验和，用于发现内容被改写 */
+    uint8_t Align;        /*!< 对齐方式 */
+    LCD_LayoutLine_t Line[LCD_LAYOUT_LINES]; /*!< 各行位置 */
+} LCD_Layout_t;
+
+/**
+ * @brief 长文档分页状态，由 LCD_Pager_Init() 建立，LCD_Pager_Task() 在后台逐段排版
+ * @note  只保存文档地址和各页起点，文档(通常位于QSPI映射区，以0结尾)需保持有效且不被改写
+ */
+typedef struct
+{
+    const char *Text;        /*!< 文档 */
+    const pFONT *AsciiFonts; /*!< 排版时的英文字体 */
+    const pFONT *CHFonts;    /*!< 排版时的中文字体 */
+    uint8_t Family;          /*!< 排版时的字体族 */
+    uint8_t Encoding;        /*!< 排版时的文本编码 */
+    uint8_t Align;           /*!< 对齐方式 */
+    uint8_t Done;            /*!< 1-已排到文档结尾(或页起点表已满) */
+    uint16_t BoxWidth;       /*!< 文本框宽度 */
+    uint16_t LineHeight;     /*!< 行高 */
+    uint16_t PageLines;      /*!< 每页行数 */
+    uint16_t Line;           /*!< 最后一页已排的行数 */
+    uint16_t Pages;          /*!< 已知起点的页数，Done 为1时即总页数 */
+    uint16_t MaxPages;       /*!< 页起点表项数 */
+    uint32_t *Starts;        /*!< 页起点表(相对文档的字节偏移)，由调用者提供 */
+    uint32_t Offset;         /*!< 排版到的位置 */
+} LCD_Pager_t;
+
+/**
+ * @brief 字符编号串，由 LCD_DisplayGlyphIds() 绘制，每个编号经 Table 换算为Unicode码点
+ * @note  只保存地址，排入队列后到命令完成前 Table、Ids 和本结构都需保持有效(可直接指向接收缓冲区)
+ */
+typedef struct
+{
+    const uint16_t *Table; /*!< 编号到Unicode码点的对照表 */
+    const uint8_t *Ids;    /*!< 字符编号，每个1字节 */
+    uint16_t Count;        /*!< 字符数 */
+    uint16_t Clear;        /*!< 从起点算起用背景色补齐的宽度(像素)，文字不足该宽度时擦除旧内容的尾部，0为不补齐 */
+} LCD_GlyphIds_t;
+
+/**
+ * @brief 富文本中的一段样式，从 Start 起到下一段的 Start 为止
+ * @note  示例：{0, LCD_WHITE, LCD_BLACK}, {6, LCD_RED, LCD_BLACK} 让第6字节起的文字变红
+ */
+typedef struct
+{
+    uint16_t Start;     /*!< 样式生效处相对字符串的字节偏移，各段按升序排列 */
+    uint32_t Color;     /*!< 画笔色(RGB888) */
+    uint32_t BackColor; /*!< 背景色(RGB888) */
+} LCD_TextStyle_t;
+
+/**
+ * @brief 带内联样式的字符串，由 LCD_DisplayRichText() 绘制
+ * @note  只保存地址，绘制前(显示列表录制时到 LCD_TileEnd())字符串和样式表需保持有效
+ */
+typedef struct
+{
+    const char *Text;              /*!< 字符串，编码与 LCD_DisplayText() 相同 */
+    const LCD_TextStyle_t *Styles; /*!< 样式表，第一段之前的文字用当前颜色 */
+    uint8_t Count;                 /*!< 样式段数 */
+} LCD_RichText_t;
+
+/**
+ * @brief 绘图上下文，每个任务或控件一份，LCD_GC_*() 和 *_Ex() 按其中的设置绘制，不读写全局绘图状态
+ * @note  先用 LCD_GC_Init() 初始化，颜色和字体用 LCD_GC_Set*() 设置(设置时完成转换)
+ */
+typedef struct
+{
+    const pFONT *AsciiFonts;   /*!< 英文字体，由 LCD_GC_SetFont() 选定 */
+    const pFONT *CHFonts;      /*!< 中文字体 */
+    uint16_t Color;      /*!< 画笔色(RGB565) */
+    uint16_t BackColor;  /*!< 背景色(RGB565) */
+    uint8_t TextMode;    /*!< Text_Opaque / Text_Transparent */
+    uint8_t TextScale;   /*!< ASCII字符放大倍数 */
+    uint8_t TextEffect;  /*!< 文本效果 Text_Effect* */
+    uint16_t EffectColor; /*!< 描边/阴影颜色(RGB565) */
+    uint8_t Family;      /*!< 字体族，由 LCD_GC_SetFontFamily() 选定 */
+    uint8_t Encoding;    /*!< 文本编码 Text_UTF8 / Text_GBK */
+    uint16_t ClipX;      /*!< 裁剪区起点 */
+    uint16_t ClipY;
+    uint16_t ClipWidth;  /*!< 裁剪区尺寸，宽或高为0时不裁剪 */
+    uint16_t ClipHeight;
+    uint8_t Priority;    /*!< 排入命令的优先级 LCD_PRIO_*，LCD_GC_Init() 设为 LCD_PRIO_LIVE */
+} LCD_GC_t;
+
+/**
+ * @brief 折线顶点，LCD_DrawPolyline() 使用
+ */
+typedef struct
+{
+    uint16_t x; /*!< 水平坐标 */
+    uint16_t y; /*!< 垂直坐标 */
+} LCD_Point_t;
+
+/**
+ * @brief 调色板图片，LCD_DrawImageIndexed() 使用
+ * @note  每行 (Width*Bpp+7)/8 字节，4bpp每字节两个像素，低4位在前；
+ *        只保存地址，绘制前(显示列表录制时到 LCD_TileEnd())描述和数据需保持有效
+ */
+typedef struct
+{
+    const uint16_t *Palette; /*!< RGB565调色板，可以位于QSPI映射区 */
+    const uint8_t *Pixels;   /*!< 颜色序号，可以位于QSPI映射区 */
+    uint16_t Width;          /*!< 图片宽度 */
+    uint16_t Height;         /*!< 图片高度 */
+    uint16_t Colors;         /*!< 调色板颜色数，超出的序号显示为调色板第0色 */
+    uint8_t Bpp;             /*!< 每像素位数，4或8 */
+} LCD_IndexedImage_t;
+
+/**
+ * @brief 行程压缩RGB565图片，LCD_DrawImageRLE() 使用
+ * @note  数据为uint16记号流(格式与 fontbin_tool.py --rle 的输出相同)：记号最高位为1时后跟1个颜色，
+ *        重复 (记号&0x7FFF)+1 次；最高位为0时后跟 记号+1 个原样的颜色；跨行连续，共 Width*Height 个像素；
+ *        只保存地址，绘制前(显示列表录制时到 LCD_TileEnd())描述和数据需保持有效
+ */
+typedef struct
+{
+    const uint16_t *Data; /*!< 压缩数据，可以位于QSPI映射区 */
+    uint32_t Size;        /*!< 压缩数据字节数，解码不会读到之后 */
+    uint16_t Width;       /*!< 图片宽度 */
+    uint16_t Height;      /*!< 图片高度 */
+} LCD_RleImage_t;
+
+#define LCD_RLE_REPEAT 0x8000U /*!< 行程压缩记号：重复一个颜色，与 flash_font.h 的 FONT_RLE_REPEAT 相同 */
+#define LCD_RLE_COUNT 0x7FFFU  /*!< 行程压缩记号：像素数减1 */
+
+/**
+ * @brief 平铺图案，LCD_FillPattern() 使用
+ * @note  只保存地址，绘制前(显示列表录制时到 LCD_TileEnd())描述和像素需保持有效
+ */
+typedef struct
+{
+    const uint16_t *Pixels; /*!< RGB565像素，逐行存放 */
+    uint16_t Width;         /*!< 图案宽度 */
+    uint16_t Height;        /*!< 图案高度 */
+} LCD_Pattern_t;
+
+    /**
+     * @brief  LCD_Flush() 的发送统计
+     * @note   总代价 = 像素数 + 窗口数 x WindowCost，合并越多窗口越少、多发送的像素越多
+     */
+    typedef struct
+    {
+        uint32_t Flushes;     /*!< 发送过数据的 LCD_Flush() 次数 */
+        uint32_t Windows;     /*!< 累计发送的窗口数 */
+        uint32_t Pixels;      /*!< 累计发送的像素数 */
+        uint32_t Waste;       /*!< 累计因合并而多发送的(不在任何脏矩形中的)像素数 */
+        uint32_t LastPixels;  /*!< 最近一次发送的像素数 */
+        uint32_t LastCost;    /*!< 最近一次的总代价(折合像素) */
+        uint16_t LastWindows; /*!< 最近一次发送的窗口数 */
+        uint16_t WindowCost;  /*!< 当前每个窗口的开销(折合像素) */
+    } LCD_FlushStats_t;
+
+    /**
+     * @brief  命令队列一个优先级的延迟统计
+     * @note   从排入到执行完(含DMA发送)的CPU周期数(DWT计数)，平均值 = TotalCycles / Count
+     */
+    typedef struct
+    {
+        uint32_t Count;       /*!< 完成的命令数 */
+        uint32_t MaxCycles;   /*!< 最大延迟 */
+        uint64_t TotalCycles; /*!< 延迟总和 */
+    } LCD_QueueLatency_t;
+
+    /**
+     * @brief  命令队列统计
+     */
+    typedef struct
+    {
+        LCD_QueueLatency_t Class[LCD_QUEUE_CLASSES]; /*!< 按优先级 LCD_PRIO_* 分别统计 */
+        uint32_t Strips;                             /*!< 分段执行的段数 */
+        uint32_t Preempts;                           /*!< 命令执行到一半让给更高优先级的次数 */
+        uint16_t MaxPending;                         /*!< 队列中同时存在的最多命令数 */
+    } LCD_QueueStats_t;
+
+    /**
+     * @brief  报警显示统计(LCD_ALARM_ENABLE)
+     * @note   耗时为 LCD_Alarm_Show() 从进入到像素发送完的CPU周期数，MaxCycles 即实测的最坏情况
+     */
+    typedef struct
+    {
+        uint32_t Shows;      /*!< 绘制次数 */
+        uint32_t Missing;    /*!< 未锁定而显示为空白的字符数 */
+        uint32_t LastCycles; /*!< 最近一次的耗时 */
+        uint32_t MaxCycles;  /*!< 最大耗时 */
+        uint32_t Refused;    /*!< 报警期间拒绝排入的背景命令数 */
+        uint16_t Glyphs;     /*!< LCD_Alarm_Load() 锁定的字符数 */
+    } LCD_AlarmStats_t;
+
+    /**
+     * @brief  字模缓存与像素缓存的预算分配(LCD_CACHE_BALANCE_ENABLE)
+     */
+    typedef struct
+    {
+        uint32_t Budget;     /*!< 两个缓存合计可用的字节数，0表示未启用 */
+        uint16_t GlyphSlots; /*!< 当前分给字模缓存的槽数 */
+        uint16_t PixelSlots; /*!< 当前分给像素缓存的槽数 */
+        uint32_t GlyphCost;  /*!< 上一周期字模缓存未命中的代价(CPU周期估计) */
+        uint32_t PixelCost;  /*!< 上一周期像素缓存未命中的代价 */
+        uint32_t Moves;      /*!< 调整次数 */
+    } LCD_CacheBalanceStats_t;
+
+#define LCD_GRADIENT_V 0 /*!< LCD_FillGradient()：从上到下渐变 */
+#define LCD_GRADIENT_H 1 /*!< LCD_FillGradient()：从左到右渐变 */
+
+#define LCD_CONSOLE_LINES 16        /*!< 控制台缓冲区保存的行数，可见行数不超过该值 */
+#define LCD_CONSOLE_LINE_BYTES 64   /*!< 控制台每行最多字节数(含结束符)，UTF-8汉字占3字节 */
+#define LCD_CONSOLE_PRINTF_BYTES 128 /*!< LCD_Console_Printf() 单次格式化的最大字节数(含结束符) */
+
+/**
+ * @brief 文本控制台，按行保存最近的输出，刷新时只画新增的字符
+ * @note  先用 LCD_Console_Init() 初始化，LCD_Console_Puts()/Printf() 追加，LCD_Console_Flush() 显示
+ */
+typedef struct
+{
+    char Lines[LCD_CONSOLE_LINES][LCD_CONSOLE_LINE_BYTES]; /*!< 行缓冲区，第 n 行存放在 n % LCD_CONSOLE_LINES */
+    LCD_GC_t Gc;         /*!< 颜色、字体 */
+    uint32_t Total;      /*!< 已开始的行数，最后一行为正在追加的行 */
+    uint32_t Shown;      /*!< 光标所在行的序号 */
+    uint16_t Drawn;      /*!< 光标所在行已显示的字节数 */
+    uint16_t Len;        /*!< 最后一行的字节数 */
+    uint16_t LineWidth;  /*!< 最后一行的显示宽度 */
+    uint16_t CursorX;    /*!< 下一个字符的绘制坐标 */
+    uint16_t CursorY;
+    uint16_t X;          /*!< 显示区域 */
+    uint16_t Y;
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t LineHeight; /*!< 行高，由字体决定 */
+    uint16_t Rows;       /*!< 可见行数 */
+    uint16_t Row;        /*!< 光标在第几个可见行，写满后停在最后一行 */
+    uint8_t HwScroll;    /*!< 1：使用硬件滚动 */
+} LCD_Console_t;
+
+#define LCD_MARQUEE_CELL_MAX 64 /*!< 跑马灯字符单元缓冲区的列数，不小于最宽的字符(最大号汉字或放大后的ASCII) */
+#define LCD_MARQUEE_BUFF_PIXELS(width, height) (((uint32_t)(width) + LCD_MARQUEE_CELL_MAX) * (height)) /*!< LCD_Marquee_Init() 的缓冲区像素数 */
+
+/**
+ * @brief 水平跑马灯，可见窗口的像素保存在缓冲区中，每步左移后只渲染新进入的列，整个窗口一次发送
+ * @note  先用 LCD_Marquee_Init() 初始化，之后每帧调用 LCD_Marquee_Step()
+ */
+typedef struct
+{
+    LCD_GC_t Gc;         /*!< 颜色、字体 */
+    const char *Text;    /*!< 循环显示的字符串，显示期间须保持有效 */
+    const char *Next;    /*!< 下一个进入窗口的字符 */
+    uint16_t *Strip;     /*!< 可见窗口的像素，Width x Height */
+    uint16_t *Cell;      /*!< 正在进入的字符，每行 LCD_MARQUEE_CELL_MAX 个像素 */
+    uint16_t X;          /*!< 显示区域 */
+    uint16_t Y;
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t Gap;        /*!< 每遍文字之后的空白列数 */
+    uint16_t GapLeft;    /*!< 尚未进入的空白列数 */
+    uint16_t CellWidth;  /*!< 正在进入的字符的宽度 */
+    uint16_t CellCol;    /*!< 该字符下一个进入的列 */
+} LCD_Marquee_t;
+
 /*******************************************************************************
  *                              常用颜色定义 (RGB888)
  ******************************************************************************/
@@ -148,6 +773,41 @@ extern "C"
 #define DARK_YELLOW 0x808000  /*!< 暗黄色 */
 #define DARK_GREY 0x404040    /*!< 暗灰色 */
 
+/**
+ * @brief RGB888 转 RGB565，参数为常量时在编译期完成
+ * @note  示例：LCD_RGB565(LCD_RED) 得到 0xF800
+ */
+#define LCD_RGB565(c) ((uint16_t)((((c) & 0xF80000) >> 8) | (((c) & 0x00FC00) >> 5) | (((c) & 0x0000F8) >> 3)))
+
+/**
+ * @brief 调色板序号，前23项依次为上面的预定义颜色(已在编译期转换为RGB565)
+ * @note  示例：LCD_SetColorIndex(LCD_PAL_RED)；LCD_PAL_USER 起的项由 LCD_SetPaletteColor() 定义，默认为黑色
+ */
+#define LCD_PAL_WHITE 0
+#define LCD_PAL_BLACK 1
+#define LCD_PAL_BLUE 2
+#define LCD_PAL_GREEN 3
+#define LCD_PAL_RED 4
+#define LCD_PAL_CYAN 5
+#define LCD_PAL_MAGENTA 6
+#define LCD_PAL_YELLOW 7
+#define LCD_PAL_GREY 8
+#define LCD_PAL_LIGHT_BLUE 9
+#define LCD_PAL_LIGHT_GREEN 10
+#define LCD_PAL_LIGHT_RED 11
+#define LCD_PAL_LIGHT_CYAN 12
+#define LCD_PAL_LIGHT_MAGENTA 13
+#define LCD_PAL_LIGHT_YELLOW 14
+#define LCD_PAL_LIGHT_GREY 15
+#define LCD_PAL_DARK_BLUE 16
+#define LCD_PAL_DARK_GREEN 17
+#define LCD_PAL_DARK_RED 18
+#define LCD_PAL_DARK_CYAN 19
+#define LCD_PAL_DARK_MAGENTA 20
+#define LCD_PAL_DARK_YELLOW 21
+#define LCD_PAL_DARK_GREY 22
+#define LCD_PAL_USER 23 /*!< 第一个用户自定义项 */
+
     /*******************************************************************************
      *                              基础控制函数
      ******************************************************************************/
@@ -160,6 +820,69 @@ extern "C"
      */
     void SPI_LCD_Init(void);
 
+    /**
+     * @brief  分两步初始化SPI LCD：写入控制器参数并发出退出休眠指令后返回
+     * @note   退出休眠的 LCD_SLEEP_OUT_MS 内可初始化QSPI、字库，再调用 SPI_LCD_InitEnd()
+     * @note   两者之间不能调用绘制函数
+     * @note   定义 LCD_WARM_RESET_ENABLE 且为看门狗/软件复位时只发出恢复显示模式的几条指令，
+     *         SPI_LCD_InitEnd() 只等待 LCD_WARM_WAKE_MS
+     * @retval None
+     */
+    void SPI_LCD_InitBegin(void);
+
+    /**
+     * @brief  当前屏幕本次是否按热复位初始化(跳过了初始化脚本)
+     * @note   读取复位原因后清除了 RCC->RSR 的复位标志，应用需要时用本函数代替
+     * @retval 1-看门狗或软件复位后的第一次初始化，0-完整初始化或未定义 LCD_WARM_RESET_ENABLE
+     */
+    uint8_t LCD_IsWarmStart(void);
+
+    /**
+     * @brief  等满退出休眠的剩余时间，打开显示、清屏、点亮背光
+     * @note   须在 SPI_LCD_InitBegin() 之后调用，结束后与 SPI_LCD_Init() 的状态相同
+     * @retval None
+     */
+    void SPI_LCD_InitEnd(void);
+
+#ifdef USE_FLASH_FONT
+    /**
+     * @brief  在 SPI_LCD_InitBegin() 与 SPI_LCD_InitEnd() 之间把字库分区中的图片写入显存作为开机画面
+     * @param  index 图片编号(fontbin_tool.py --image 的参数顺序)，居中显示，其余部分为黑色
+     * @note   须在 FlashFont_Init() 之后调用；显示仍关闭，SPI_LCD_InitEnd() 打开显示时不再清屏，
+     *         点亮背光时直接显示开机画面
+     * @retval 1-已写入，0-字库中没有该图片或图片大于屏幕(SPI_LCD_InitEnd() 照常清屏)
+     */
+    uint8_t SPI_LCD_InitSplash(uint16_t index);
+#endif
+
+    /**
+     * @brief  添加一块接在另一条SPI总线(或FMC，需定义 LCD_FMC_ENABLE)上的屏幕
+     * @param  cfg 总线、引脚和竖屏尺寸，尺寸不超过 LCD_Width x LCD_Height
+     * @retval 屏幕编号，失败返回 LCD_PANEL_NONE
+     * @note   之后 LCD_Panel_Select() 选中并调用 SPI_LCD_Init() 初始化
+     */
+    uint8_t LCD_Panel_Add(const LCD_PanelConfig_t *cfg);
+
+    /**
+     * @brief  选择之后绘图函数作用的屏幕
+     * @param  id 屏幕编号，0为SPI6上的屏幕
+     * @note   不等待原屏幕的DMA，两块屏幕可以同时刷新；颜色、字体所有屏幕共用
+     * @retval None
+     */
+    void LCD_Panel_Select(uint8_t id);
+
+    /**
+     * @brief  当前选中的屏幕
+     * @retval 屏幕编号
+     */
+    uint8_t LCD_Panel_Current(void);
+
+    /**
+     * @brief  当前屏幕的控制器描述表
+     * @retval 描述表，可按 Caps 判断硬件滚动、局部显示等是否可用
+     */
+    const LCD_Controller_t *LCD_Panel_Controller(void);
+
     /**
      * @brief  清屏函数
      * @note   将整个屏幕清除为当前背景色
@@ -190,6 +913,21 @@ extern "C"
      */
     void LCD_SetAddress(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
 
+    /**
+     * @brief  设置裁剪区，之后所有绘图只写入裁剪区内的部分
+     * @param  x、y 裁剪区起点
+     * @param  width、height 裁剪区尺寸，为0时取消裁剪
+     * @note   部分可见的字符、图片和填充只发送可见的行列，完全不可见时不发送
+     * @retval None
+     */
+    void LCD_SetClip(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+    /**
+     * @brief  取消裁剪，只受屏幕边界限制
+     * @retval None
+     */
+    void LCD_ResetClip(void);
+
     /*******************************************************************************
      *                              颜色和方向设置
      ******************************************************************************/
@@ -212,6 +950,37 @@ extern "C"
      */
     void LCD_SetBackColor(uint32_t Color);
 
+    /**
+     * @brief  设置调色板中的一项
+     * @param  index 调色板序号，超出 LCD_PALETTE_SIZE 时忽略
+     * @param  Color 24位RGB888颜色值，设置时转换为RGB565
+     * @note   示例：LCD_SetPaletteColor(LCD_PAL_USER, 0x336699)；也可覆盖预定义项
+     * @retval None
+     */
+    void LCD_SetPaletteColor(uint8_t index, uint32_t Color);
+
+    /**
+     * @brief  读取调色板中的一项
+     * @param  index 调色板序号
+     * @retval RGB565颜色，序号无效时返回0
+     */
+    uint16_t LCD_GetPaletteColor(uint8_t index);
+
+    /**
+     * @brief  按调色板序号设置画笔颜色，不做颜色转换
+     * @param  index 调色板序号，超出 LCD_PALETTE_SIZE 时忽略
+     * @note   示例：LCD_SetColorIndex(LCD_PAL_RED)
+     * @retval None
+     */
+    void LCD_SetColorIndex(uint8_t index);
+
+    /**
+     * @brief  按调色板序号设置背景颜色，不做颜色转换
+     * @param  index 调色板序号，超出 LCD_PALETTE_SIZE 时忽略
+     * @retval None
+     */
+    void LCD_SetBackColorIndex(uint8_t index);
+
     /**
      * @brief  设置显示方向
      * @param  direction 显示方向 (Direction_H/Direction_V/Direction_H_Flip/Direction_V_Flip)
@@ -220,46 +989,280 @@ extern "C"
      */
     void LCD_SetDirection(uint8_t direction);
 
-    /*******************************************************************************
-     *                              ASCII字符显示
-     ******************************************************************************/
+    /**
+     * @brief  设置屏幕接收像素数据的字节顺序
+     * @param  swap 1：低字节在前(接收字节交换过的RGB565)，0：高字节在前(默认)
+     * @note   只在整个界面都由已交换字节的缓冲区绘制时使用，本驱动自身的绘制不需要交换
+     * @note   控制器没有 LCD_CTRL_BYTESWAP 能力时不做任何事
+     */
+    void LCD_SetByteSwap(uint8_t swap);
 
     /**
-     * @brief  显示单个ASCII字符
-     * @param  x 起始水平坐标
-     * @param  y 起始垂直坐标
-     * @param  c ASCII字符
-     * @note   示例：LCD_DisplayChar(10, 10, 'A')
-     * @retval None
+     * @brief  设置当前屏幕的接口像素格式(COLMOD)
+     * @param  format LCD_PIXEL_RGB565 / LCD_PIXEL_RGB444
+     * @note   绘图函数和缓冲区仍为RGB565，RGB444时在发送处每两个像素截成两个12位SPI帧，
+     *         由BDMA从打包缓冲区发送，调用者的缓冲区在返回后即可改写
+     * @note   显存中已有的内容不变；屏幕重新初始化后恢复RGB565
+     * @note   只用于SPI屏，控制器没有 LCD_CTRL_RGB444 能力或未定义 LCD_RGB444_ENABLE 时返回0
+     * @retval 1-已切换，0-不支持
      */
-    void LCD_DisplayChar(uint16_t x, uint16_t y, uint8_t c);
+    uint8_t LCD_SetPixelFormat(uint8_t format);
 
     /**
-     * @brief  显示ASCII字符串
-     * @param  x 起始水平坐标
-     * @param  y 起始垂直坐标
-     * @param  p 字符串首地址
-     * @note   示例：LCD_DisplayString(10, 10, "Hello")
-     * @retval None
+     * @brief  读取当前屏幕的接口像素格式
+     * @retval LCD_PIXEL_RGB565 / LCD_PIXEL_RGB444
      */
-    void LCD_DisplayString(uint16_t x, uint16_t y, char *p);
+    uint8_t LCD_GetPixelFormat(void);
 
     /*******************************************************************************
-     *                              中文字符显示
+     *                              硬件滚动
      ******************************************************************************/
+
     /**
-     * @brief  获取当前中文字体大小
-     * @retval 字体大小 (12/16/20/24/32)
+     * @brief  设置硬件滚动区(VSCRDEF)并清除，用于逐行追加的日志、终端
+     * @param  y 滚动区起始垂直坐标
+     * @param  height 滚动区高度，按 line_height 取整
+     * @param  line_height 每行文字的高度
+     * @note   只支持竖屏；滚动区内只用 LCD_Scroll_NewLine()/LCD_Scroll_Print() 绘制
+     * @retval 1-成功，0-横屏、超出屏幕或控制器不支持滚动
      */
-    uint8_t LCD_GetChineseFontSize(void);
+    uint8_t LCD_Scroll_Init(uint16_t y, uint16_t height, uint16_t line_height);
+
     /**
-     * @brief  设置中英文混合字体
-     * @param  font_size 字体大小 (12/16/20/24/32)
-     * @note   自动匹配对应的ASCII和中文字体
-     * @note   示例：LCD_SetTextFont(24) 设置24x24中文+24x12 ASCII
-     * @retval None
+     * @brief  滚动区上移一行(只写VSCSAD)，清除底部新出现的一行
+     * @retval 新的一行的垂直坐标，未启用滚动时返回0
      */
-    void LCD_SetTextFont(uint8_t font_size);
+    uint16_t LCD_Scroll_NewLine(void);
+
+    /**
+     * @brief  滚动区上移一行，在底部显示一行文字
+     * @param  pText 字符串，可以包含中文
+     * @note   使用当前字体和颜色，超出这一行的部分不显示
+     * @retval None
+     */
+    void LCD_Scroll_Print(const char *pText);
+
+    /**
+     * @brief  设置硬件滚动区(VSCRDEF)，不清除，原有内容照常显示
+     * @param  y 滚动区起始垂直坐标
+     * @param  height 滚动区高度
+     * @note   用于页面推入过渡：之后每帧 LCD_Scroll_Advance() 上移几行，只绘制新出现的行
+     * @retval 1-成功，0-横屏、超出屏幕或控制器不支持滚动
+     */
+    uint8_t LCD_Scroll_Region(uint16_t y, uint16_t height);
+
+    /**
+     * @brief  滚动区上移 rows 行(只写VSCSAD)，不清除
+     * @param  rows 上移的行数
+     * @note   新出现的行从返回的坐标起向下排列，越过滚动区底部的部分从滚动区顶部接着排列
+     * @retval 第一行新出现的行的垂直坐标，未启用滚动时返回0
+     */
+    uint16_t LCD_Scroll_Advance(uint16_t rows);
+
+    /**
+     * @brief  结束硬件滚动，显存与屏幕恢复逐行对应
+     * @note   LCD_SetDirection() 会自动调用
+     * @retval None
+     */
+    void LCD_Scroll_Stop(void);
+
+    /**
+     * @brief  局部显示：只有 y 起的 height 行正常显示，其余行不刷新(显示为背景，由控制器决定)
+     * @param  y 局部区起始垂直坐标
+     * @param  height 局部区行数，0表示恢复正常显示
+     * @note   只支持竖屏，用于待机时只刷新一条状态栏以降低功耗
+     * @note   帧缓冲模式下局部显示期间 LCD_Flush() 只发送局部区内的部分，区外的脏区域恢复正常显示后再发送
+     * @retval 1-成功，0-横屏、超出屏幕或控制器不支持局部显示
+     */
+    uint8_t LCD_SetPartialArea(uint16_t y, uint16_t height);
+
+    /**
+     * @brief  空闲模式：每个颜色分量只显示最高位(8色)，控制器降低功耗
+     * @param  enable 1-进入(IDMON 0x39)，0-退出(IDMOFF 0x38)
+     * @note   显存内容和绘图不受影响，退出后恢复原来的颜色
+     * @retval 1-成功，0-控制器不支持空闲模式
+     */
+    uint8_t LCD_SetIdleMode(uint8_t enable);
+
+    /**
+     * @brief  进入低功耗静态显示：只有 y 起的 height 行(如时钟)继续刷新，并打开空闲模式
+     * @note   先调用 LCD_Flush() 发送已有的脏区域；之后帧缓冲中区外的修改只记录，SPI保持空闲，
+     *         退出时补发；控制器不支持空闲模式时只进入局部显示
+     * @note   示例：LCD_LowPower_Enter(clock_y, 32); 每秒重画时钟后 LCD_Flush()；有操作时 LCD_LowPower_Exit()
+     * @retval 1-成功，0-横屏、超出屏幕或控制器不支持局部显示(保持正常显示)
+     */
+    uint8_t LCD_LowPower_Enter(uint16_t y, uint16_t height);
+
+    /**
+     * @brief  退出低功耗静态显示：关闭空闲模式和局部显示，并发送期间保留的脏区域
+     * @retval None
+     */
+    void LCD_LowPower_Exit(void);
+
+    /*******************************************************************************
+     *                              文本控制台
+     ******************************************************************************/
+
+    /**
+     * @brief  初始化文本控制台并清除显示区域
+     * @param  con 控制台
+     * @param  gc 颜色、字体(拷贝一份)
+     * @param  x、y、width、height 显示区域
+     * @note   占满屏幕宽度的竖屏区域使用硬件滚动
+     * @retval 1-成功，0-区域放不下一行
+     */
+    uint8_t LCD_Console_Init(LCD_Console_t *con, const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+    /**
+     * @brief  追加文字到控制台缓冲区，'\n' 换行，超宽自动换行，不写屏
+     * @param  con 控制台
+     * @param  pText 字符串，编码与 LCD_DisplayText() 相同
+     * @retval None
+     */
+    void LCD_Console_Puts(LCD_Console_t *con, const char *pText);
+
+    /**
+     * @brief  格式化后追加到控制台缓冲区，不写屏
+     * @param  con 控制台
+     * @param  fmt 格式字符串，与 printf 相同
+     * @retval None
+     */
+    void LCD_Console_Printf(LCD_Console_t *con, const char *fmt, ...);
+
+    /**
+     * @brief  显示上次刷新以来追加的文字
+     * @param  con 控制台
+     * @note   只画新增的字符；新增超过一屏时只画最后一屏
+     * @retval None
+     */
+    void LCD_Console_Flush(LCD_Console_t *con);
+
+    /*******************************************************************************
+     *                              水平跑马灯
+     ******************************************************************************/
+
+    /**
+     * @brief  初始化跑马灯，窗口先填满背景色，文字从右边缘进入
+     * @param  mq 跑马灯
+     * @param  gc 颜色、字体(拷贝一份)
+     * @param  x、y、width、height 显示区域
+     * @param  buff 像素缓冲区，至少 LCD_MARQUEE_BUFF_PIXELS(width, height) 个像素，只由CPU读写
+     * @param  pText 循环显示的字符串，UTF-8，显示期间须保持有效
+     * @param  gap 每遍文字之后的空白列数
+     * @note   字符由 LCD_RenderTextToBuffer() 逐个渲染，仅在定义 LCD_RENDER_BUFFER_ENABLE 时显示文字
+     * @retval 1-成功，0-参数无效
+     */
+    uint8_t LCD_Marquee_Init(LCD_Marquee_t *mq, const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width,
+                             uint16_t height, uint16_t *buff, const char *pText, uint16_t gap);
+
+    /**
+     * @brief  更换跑马灯的文字，正在进入的字符结束后接着进入新文字
+     * @param  mq 跑马灯
+     * @param  pText 新的字符串，显示期间须保持有效
+     * @retval None
+     */
+    void LCD_Marquee_SetText(LCD_Marquee_t *mq, const char *pText);
+
+    /**
+     * @brief  左移 dx 列并显示
+     * @param  mq 跑马灯
+     * @param  dx 移动的列数，超过窗口宽度时按窗口宽度，0表示只重发当前内容
+     * @note   缓冲区内左移后只渲染右边缘新进入的 dx 列，每个字符进入时渲染一次；
+     *         整个窗口由 LCD_CopyBuffer() 一次发送，每帧耗时与文字长度无关
+     * @note   分块模式(LCD_TILE_ENABLE)下只记录缓冲区地址，LCD_TileEnd() 之前不能再次调用
+     * @retval None
+     */
+    void LCD_Marquee_Step(LCD_Marquee_t *mq, uint16_t dx);
+
+    /*******************************************************************************
+     *                              ASCII字符显示
+     ******************************************************************************/
+
+    /**
+     * @brief  显示单个ASCII字符
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  c ASCII字符
+     * @note   示例：LCD_DisplayChar(10, 10, 'A')
+     * @retval None
+     */
+    void LCD_DisplayChar(uint16_t x, uint16_t y, uint8_t c);
+
+    /**
+     * @brief  显示ASCII字符串
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  p 字符串首地址
+     * @note   示例：LCD_DisplayString(10, 10, "Hello")
+     * @retval None
+     */
+    void LCD_DisplayString(uint16_t x, uint16_t y, char *p);
+
+    /**
+     * @brief  设置字符背景模式
+     * @param  mode 背景模式 (Text_Opaque/Text_Transparent)
+     * @note   透明模式下每一段连续的前景像素单独设置窗口发送，只传输笔画像素
+     * @retval None
+     */
+    void LCD_SetTextMode(uint8_t mode);
+
+    /**
+     * @brief  设置文本效果
+     * @param  effect Text_EffectNone，或 Text_EffectBold/Text_EffectOutline/Text_EffectShadow 的组合
+     * @param  Color 描边和阴影颜色(RGB888)
+     * @note   效果在1bpp字模行上按32位位运算得到，与前景一起一遍展开，不在字库中存放粗体，也不重复绘制字模
+     * @note   效果不超出字模单元；有效果时不使用抗锯齿字模，超过32像素宽的字模不加效果
+     * @retval None
+     */
+    void LCD_SetTextEffect(uint8_t effect, uint32_t Color);
+
+    /**
+     * @brief  设置ASCII字符放大倍数
+     * @param  scale 放大倍数 (1-3)，超出范围按1处理
+     * @note   只影响 LCD_DisplayChar/LCD_DisplayString 和数字显示，LCD_DisplayText 保持原字号
+     * @note   需定义 LCD_TEXT_SCALE_ENABLE，LCD_SetTextFont() 会复位放大倍数
+     * @retval None
+     */
+    void LCD_SetTextScale(uint8_t scale);
+
+    /*******************************************************************************
+     *                              中文字符显示
+     ******************************************************************************/
+    /**
+     * @brief  获取当前中文字体大小
+     * @retval 字体大小 (12/16/20/24/32)
+     */
+    uint8_t LCD_GetChineseFontSize(void);
+    /**
+     * @brief  设置中英文混合字体
+     * @param  font_size 字体大小 (12/16/20/24/32，定义 LCD_TEXT_SCALE_ENABLE 时另有48/64/96)
+     * @note   自动匹配对应的ASCII和中文字体
+     * @note   48/64/96 为24/32号ASCII字符放大2/2/3倍，中文保持24/32号
+     * @note   Flash字库目录中有的其他字号(14/18/28等)直接使用，见 LCD_FONT_EXTRA_SIZES
+     * @note   示例：LCD_SetTextFont(24) 设置24x24中文+24x12 ASCII
+     * @note   同时选择字体族0(默认字体)
+     * @retval None
+     */
+    void LCD_SetTextFont(uint8_t font_size);
+
+    /**
+     * @brief  按字体族和字号设置中英文字体
+     * @param  family 字体族(字库目录项的 family，0为默认字体)
+     * @param  font_size 字体大小，与 LCD_SetTextFont() 相同
+     * @note   字体族没有的字号或字符类型使用字体族0；不使用Flash字库时 family 被忽略
+     * @note   示例：LCD_SetTextFontFamily(1, 32) 用字体族1(如粗体数字)显示32号读数
+     * @retval None
+     */
+    void LCD_SetTextFontFamily(uint8_t family, uint8_t font_size);
+
+    /**
+     * @brief  选择文本函数解码字符串的编码
+     * @param  enc Text_UTF8 / Text_GBK
+     * @note   UTF8 Flash字库且定义 FLASH_FONT_GBK_TEXT 时生效，GBK字符串直接绘制、测量和排版，不需要转换
+     * @note   示例：LCD_SetTextEncoding(Text_GBK); LCD_DisplayText(10, 10, gbk_msg);
+     * @retval None
+     */
+    void LCD_SetTextEncoding(uint8_t enc);
 
     /**
      * @brief  显示单个汉字
@@ -277,10 +1280,337 @@ extern "C"
      * @param  y 起始垂直坐标
      * @param  pText 字符串首地址
      * @note   示例：LCD_DisplayText(10, 10, "反客科技STM32")
+     * @note   Flash字库带ASCII字宽表时英文按比例宽度排版
      * @retval None
      */
     void LCD_DisplayText(uint16_t x, uint16_t y, char *pText);
 
+    /**
+     * @brief  显示带内联样式的字符串，各段文字用各自的画笔色和背景色
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  rich 字符串和样式表
+     * @note   示例：LCD_DisplayRichText(10, 10, &rich) 一次画出"温度: 25℃"而数值为红色
+     * @note   排版和换行与 LCD_DisplayText() 相同，换色不打断整行合成；绘制后恢复原来的颜色
+     * @retval None
+     */
+    void LCD_DisplayRichText(uint16_t x, uint16_t y, const LCD_RichText_t *rich);
+
+    /**
+     * @brief  把字符串绘制到内存缓冲区(动画、精灵合成、LVGL画布)，不访问屏幕
+     * @param  dst 目标缓冲区(RGB565)
+     * @param  stride 缓冲区每行像素数，不小于 width
+     * @param  width 绘制区域宽度，按此换行
+     * @param  height 绘制区域高度，超出的行丢弃
+     * @param  pText 字符串，编码与 LCD_DisplayText() 相同
+     * @param  gc 绘图上下文，NULL时使用当前的颜色、字体和字符模式
+     * @note   示例：LCD_RenderTextToBuffer(sprite, 120, 120, 24, "温度", &gc); 之后每帧 LCD_CopyBuffer(x, y, 120, 24, sprite)
+     * @note   查找、排版和字模展开与 LCD_DisplayText() 相同；字符单元之外的像素保持原样，透明模式下与原有内容混合
+     * @note   仅在定义 LCD_RENDER_BUFFER_ENABLE 时有效
+     * @retval None
+     */
+    void LCD_RenderTextToBuffer(uint16_t *dst, uint16_t stride, uint16_t width, uint16_t height, const char *pText,
+                                const LCD_GC_t *gc);
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+    /**
+     * @brief  竖排显示字符串(字符直立，从上往下，一列排满后向左换列)
+     * @param  x 第一列的左边界
+     * @param  y 每列的上边界
+     * @param  pText UTF-8字符串首地址
+     * @note   示例：LCD_DisplayTextVertical(200, 20, "产品标签")
+     * @note   定义 LCD_TEXT_STRIP_ENABLE 时整列合成后一个窗口一次发送
+     * @retval None
+     */
+    void LCD_DisplayTextVertical(uint16_t x, uint16_t y, char *pText);
+
+    /**
+     * @brief  把一行文字按指定颜色展开到内存缓冲区，不设置窗口、不发送
+     * @param  dst 目标RGB565缓冲区中第一个字符左上角的像素
+     * @param  stride 目标缓冲区每行像素数
+     * @param  max_width 可用宽度，放不下的字符不展开
+     * @param  pText UTF-8字符串，遇到 '\0' 或 '\n' 停止
+     * @param  width 输出展开的总宽度，可为NULL
+     * @note   供 lcd_rgb.c 等帧缓冲后端使用，与SPI屏共用字模查找、字模缓存和展开表；按不透明模式展开
+     * @retval 展开的字节数，字库不可用时返回0
+     */
+    uint16_t LCD_ExpandText(uint16_t *dst, uint16_t stride, uint16_t max_width, const char *pText,
+                            uint8_t font_size, uint16_t color, uint16_t back_color, uint16_t *width);
+#endif
+
+    /**
+     * @brief  不绘制，计算字符串自动换行后的尺寸
+     * @param  pText 字符串首地址
+     * @param  font_size 字号(与 LCD_SetTextFont() 相同)，0表示当前字体
+     * @param  max_width 换行宽度，0表示屏幕宽度
+     * @param  width 输出最宽一行的宽度，可为NULL
+     * @param  height 输出总高度，可为NULL
+     * @param  lines 输出行数，可为NULL
+     * @note   换行规则同 LCD_LayoutText()，只读字宽表不读字模；排版结果供紧接着的 LCD_DisplayTextBox() 使用
+     * @retval None
+     */
+    void LCD_MeasureText(const char *pText, uint8_t font_size, uint16_t max_width, uint16_t *width,
+                         uint16_t *height, uint16_t *lines);
+
+    /**
+     * @brief  在文本框中自动换行显示字符串，每行按指定方式对齐
+     * @param  x 文本框左边界
+     * @param  y 第一行的垂直坐标
+     * @param  width 文本框宽度，0表示到屏幕右边缘
+     * @param  pText 字符串首地址
+     * @param  align LCD_TEXT_ALIGN_LEFT / LCD_TEXT_ALIGN_CENTER / LCD_TEXT_ALIGN_RIGHT
+     * @note   示例：LCD_DisplayTextBox(0, 100, LCD.Width, "居中标题", LCD_TEXT_ALIGN_CENTER)
+     * @retval None
+     */
+    void LCD_DisplayTextBox(uint16_t x, uint16_t y, uint16_t width, char *pText, uint8_t align);
+
+    /**
+     * @brief  把字符串排成若干行，结果可反复绘制
+     * @param  layout 输出排版结果
+     * @param  pText 字符串首地址，绘制前需保持有效且不被改写
+     * @param  width 文本框宽度，0表示屏幕宽度
+     * @param  align LCD_TEXT_ALIGN_LEFT / LCD_TEXT_ALIGN_CENTER / LCD_TEXT_ALIGN_RIGHT
+     * @note   用当前字体；在空格、汉字前后和连字符之后换行，行首不出现逗号句号等标点，'\n' 强制换行
+     * @retval 总行数
+     */
+    uint16_t LCD_LayoutText(LCD_Layout_t *layout, const char *pText, uint16_t width, uint8_t align);
+
+    /**
+     * @brief  绘制排版结果，不再解码和换行
+     * @param  layout LCD_LayoutText() 的结果
+     * @param  x 文本框左边界
+     * @param  y 第一行的垂直坐标
+     * @note   用排版时的字体、当前的颜色和字符模式；示例：静态段落排版一次，每帧 LCD_DrawLayout(&layout, 0, 40)
+     * @retval None
+     */
+    void LCD_DrawLayout(const LCD_Layout_t *layout, uint16_t x, uint16_t y);
+
+#ifdef LCD_PAGER_ENABLE
+    /**
+     * @brief  打开一篇长文档，之后由 LCD_Pager_Task() 在后台分页
+     * @param  pager 输出分页状态
+     * @param  pText 文档(以0结尾)，需保持有效且不被改写
+     * @param  width 文本框宽度，0表示屏幕宽度
+     * @param  height 文本框高度，0表示屏幕高度，按行高取整为每页行数
+     * @param  align LCD_TEXT_ALIGN_LEFT / LCD_TEXT_ALIGN_CENTER / LCD_TEXT_ALIGN_RIGHT
+     * @param  starts 页起点表，每页4字节，由调用者提供
+     * @param  max_pages 页起点表项数，超出的部分不分页
+     * @note   用当前字体，换行规则同 LCD_LayoutText()；同时登记为后台分页的文档(只有一篇)
+     * @retval None
+     */
+    void LCD_Pager_Init(LCD_Pager_t *pager, const char *pText, uint16_t width, uint16_t height, uint8_t align,
+                        uint32_t *starts, uint16_t max_pages);
+
+    /**
+     * @brief  接着排版最多 lines 行
+     * @retval 1-还没有排到文档结尾, 0-分页完成
+     */
+    uint8_t LCD_Pager_Step(LCD_Pager_t *pager, uint16_t lines);
+
+    /**
+     * @brief  绘制一页
+     * @param  pager LCD_Pager_Init() 的分页状态
+     * @param  page 页号(从0开始)
+     * @param  x 文本框左边界
+     * @param  y 第一行的垂直坐标
+     * @note   已分页的页直接从起点绘制；后台还没有排到该页时先排到该页为止
+     * @note   用排版时的字体、当前的颜色和字符模式，不录制到显示列表
+     * @retval 0-成功, 1-页号超出文档
+     */
+    uint8_t LCD_Pager_DrawPage(LCD_Pager_t *pager, uint16_t page, uint16_t x, uint16_t y);
+
+    /**
+     * @brief  后台分页任务，调度器每 LCD_PAGER_MS 调用一次
+     * @note   对最近一次 LCD_Pager_Init() 的文档排版 LCD_PAGER_SLICE_LINES 行
+     * @retval 1-还有未排完的文档, 0-空闲
+     */
+    uint8_t LCD_Pager_Task(void);
+
+    /**
+     * @brief  停止后台分页(文档关闭、分页状态即将失效时调用)
+     * @retval None
+     */
+    void LCD_Pager_Close(LCD_Pager_t *pager);
+#endif
+
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+/**
+ * @brief 取 fontbuild.py --runs 生成的预解析文本串，name 为字符串列表中的名字
+ * @note  示例：LCD_DisplayGlyphRun(10, 10, LCD_GLYPH_RUN(TITLE))
+ */
+#define LCD_GLYPH_RUN(name) (&FONTBIN_RUN_##name)
+
+    /**
+     * @brief  显示预解析的文本串
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  run fontbuild.py --runs 生成的文本串
+     * @note   不解码UTF-8、不查对照表和字宽表，只读取并展开字模；字库已更新时按原字符串绘制
+     * @retval None
+     */
+    void LCD_DisplayGlyphRun(uint16_t x, uint16_t y, const FontGlyphRun_t *run);
+
+    /**
+     * @brief  显示字符编号串
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  run 编号串和对照表
+     * @note   用当前字体，不解码UTF-8；只画一行，超出屏幕右边缘的字符不显示
+     * @retval None
+     */
+    void LCD_DisplayGlyphIds(uint16_t x, uint16_t y, const LCD_GlyphIds_t *run);
+
+    /**
+     * @brief  显示字库字符串表中当前语言的字符串
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  id 字符串编号(fontbin_tool.py --strings-header 生成的 STR_xxx)
+     * @note   排版同 LCD_DisplayText()，字符串直接从QSPI映射区读取，不占内部Flash和RAM
+     * @retval 1-已显示，0-字库中没有该字符串
+     */
+    uint8_t LCD_DisplayStringID(uint16_t x, uint16_t y, uint16_t id);
+
+#ifdef LCD_ALARM_ENABLE
+    /**
+     * @brief  锁定报警文字用到的字模
+     * @param  chars UTF-8字符列表，重复字符只锁定一次
+     * @param  font_size 报警文字的字号
+     * @note   清空原有的锁定分区后逐字从字库拷贝，只在初始化或切换语言时调用；字库更新后需重新调用
+     * @retval 0-全部锁定，1-有字符不在字库中或锁定分区已满，-1-参数无效或字库不支持该字号
+     */
+    int8_t LCD_Alarm_Load(const char *chars, uint8_t font_size);
+
+    /**
+     * @brief  显示报警文字
+     * @param  x、y 报警条左上角
+     * @param  width 报警条宽度(像素)，文字之后用背景色补齐，超出的文字截断
+     * @param  pText UTF-8字符串，只应包含 LCD_Alarm_Load() 锁定的字符
+     * @param  color 文字颜色(RGB888)
+     * @param  back 背景颜色(RGB888)
+     * @note   1. 不查字库、不读QSPI、不经过命令队列，每次发送 width x 字号个像素，耗时只取决于 width
+     *         2. 之后排入的 LCD_PRIO_BACKGROUND 命令被拒绝，直到 LCD_Alarm_Release()
+     *         3. 不受裁剪区和文本效果影响；定义 LCD_QUEUE_SERVER 时只能在渲染任务中调用
+     * @retval 未锁定而显示为空白的字符数
+     */
+    uint16_t LCD_Alarm_Show(uint16_t x, uint16_t y, uint16_t width, const char *pText, uint32_t color, uint32_t back);
+
+    /**
+     * @brief  结束报警，重新接纳背景命令
+     * @note   不擦除报警条，由调用者重绘该区域
+     */
+    void LCD_Alarm_Release(void);
+
+    /**
+     * @brief  读取报警显示统计
+     * @param  stats 输出统计信息
+     */
+    void LCD_Alarm_GetStats(LCD_AlarmStats_t *stats);
+#endif
+
+#ifdef LCD_TEXT_MEMO_ENABLE
+    /**
+     * @brief  作废一个字符串的缓存解析结果(含以它开头的排版行)
+     * @param  pText 字符串地址，NULL时作废全部
+     * @note   未定义 LCD_TEXT_MEMO_VERIFY 时，改写传给 LCD_DisplayText() 的缓冲区后调用
+     * @retval None
+     */
+    void LCD_TextMemo_Invalidate(const char *pText);
+
+    /**
+     * @brief  读取解析结果缓存的命中统计
+     * @param  hits 输出命中次数，可为NULL
+     * @param  misses 输出解析次数，可为NULL
+     * @retval 已占用的字符数
+     */
+    uint16_t LCD_TextMemo_GetStats(uint32_t *hits, uint32_t *misses);
+
+    /**
+     * @brief  限制解析结果缓存运行时使用的字符串个数
+     * @param  entries 项数，0或超过 LCD_TEXT_MEMO_ENTRIES 时为 LCD_TEXT_MEMO_ENTRIES
+     * @note   缓存随即作废，命中统计保留
+     * @retval 生效的项数
+     */
+    uint8_t LCD_TextMemo_SetLimit(uint8_t entries);
+#endif
+
+#ifdef LCD_TEXT_ROTATE_ENABLE
+    /**
+     * @brief  显示旋转90°的文本
+     * @param  x 文本区左边界
+     * @param  y Text_Rotate_90 时为第一个字符的上边界，Text_Rotate_270 时为第一个字符的下边界
+     * @param  rotation Text_Rotate_90 或 Text_Rotate_270
+     * @note   用当前字体(不超过32号)和字符模式，每个字符一个窗口，按行连续发送；
+     *         到屏幕边缘时换到下一列(顺时针向左、逆时针向右)，抗锯齿字模和放大倍数不生效
+     * @retval None
+     */
+    void LCD_DisplayTextRotated(uint16_t x, uint16_t y, char *pText, uint8_t rotation);
+#endif
+#endif
+
+    /**
+     * @brief  测量一次 LCD_DisplayText 的耗时
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  pText 测试字符串
+     * @param  cold 1-先清空指令/数据Cache和字模缓存, 0-直接绘制
+     * @note   用于比较定义 QSPI_XIP_ENABLE 前后的文字吞吐
+     * @retval 绘制并发送完成耗费的CPU周期数
+     */
+    uint32_t LCD_MeasureTextCycles(uint16_t x, uint16_t y, char *pText, uint8_t cold);
+
+    /**
+     * @brief  测量一种1bpp字模展开方式的耗时
+     * @param  method LCD_EXPAND_BIT/LCD_EXPAND_LUT/LCD_EXPAND_SEL
+     * @param  pData 1bpp字模，每行 (width+7)/8 字节，低位在前
+     * @param  width 字模宽度，width*height 不超过 LCD_BUFF_PIXELS
+     * @param  height 字模高度
+     * @param  passes 重复展开的次数
+     * @note   展开到渲染缓冲区不发送，用于按字号比较后决定是否定义 LCD_EXPAND_SEL_ENABLE
+     * @retval 展开 passes 次耗费的CPU周期数，参数无效时为0
+     */
+    uint32_t LCD_MeasureExpandCycles(uint8_t method, const uint8_t *pData, uint16_t width, uint16_t height, uint16_t passes);
+
+    /**
+     * @brief  读取RGB565像素缓存的命中统计
+     * @param  hits 输出命中次数，可为NULL
+     * @param  misses 输出未命中次数，可为NULL
+     * @note   仅在定义 LCD_PIXEL_CACHE_ENABLE 时有效，否则输出0
+     * @retval None
+     */
+    void LCD_PixelCache_GetStats(uint32_t *hits, uint32_t *misses);
+
+    /**
+     * @brief  限制RGB565像素缓存运行时使用的槽数
+     * @param  slots 槽数，0或超过 LCD_PIXEL_CACHE_SLOTS 时为 LCD_PIXEL_CACHE_SLOTS
+     * @note   调小时作废序号在 slots 之后的槽，其余字模和统计保留；存储区仍按 LCD_PIXEL_CACHE_SLOTS 静态分配
+     * @retval 生效的槽数，未启用像素缓存时为0
+     */
+    uint16_t LCD_PixelCache_SetLimit(uint16_t slots);
+
+#ifdef LCD_CACHE_BALANCE_ENABLE
+    /**
+     * @brief  按上一周期的未命中代价在字模缓存和像素缓存之间移动预算，由调度器每 LCD_CACHE_BALANCE_MS 调用
+     * @note   代价 = 字模缓存装入的字节数 x LCD_CACHE_QSPI_CYCLES 与像素缓存展开的像素数 x LCD_CACHE_EXPAND_CYCLES，
+     *         大号字体的一次未命中比小号字体贵；有空槽的缓存不再增加，代价相差不到1/4时不调整
+     * @retval None
+     */
+    void LCD_CacheBalance_Task(void);
+
+    /**
+     * @brief  设置两个缓存合计的字节预算并重新对半分配
+     * @param  bytes 字节数，0表示停止调整，两个缓存恢复编译时容量
+     * @retval 生效的预算(不超过两者编译时容量之和)
+     */
+    uint32_t LCD_CacheBalance_SetBudget(uint32_t bytes);
+
+    /**
+     * @brief  读取当前分配和上一周期的代价
+     * @param  stats 输出
+     * @retval None
+     */
+    void LCD_CacheBalance_GetStats(LCD_CacheBalanceStats_t *stats);
+#endif
+
     /*******************************************************************************
      *                              数字显示
      ******************************************************************************/
@@ -312,10 +1642,68 @@ extern "C"
      * @param  len 总位数（含小数点和符号）
      * @param  decs 小数位数
      * @note   示例：LCD_DisplayDecimals(10, 10, 1.12345, 8, 4) 显示"  1.1235"
+     * @note   放大后的值四舍五入，恰好一半时远离0(printf 取偶，如0.125保留2位为0.13，printf 为0.12)；舍入为0的负数显示"-0.00"
      * @retval None
      */
     void LCD_DisplayDecimals(uint16_t x, uint16_t y, double number, uint8_t len, uint8_t decs);
 
+    /**
+     * @brief  格式化显示字符串
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  fmt 格式字符串：%d %i %u %x %X %c %s %% 与 printf 相同(标志 '-' '0'、宽度、%s 的精度)，
+     *             %q 为 int32_t 定点数，精度为小数位数，不支持浮点
+     * @note   只用整数运算，不调用 sprintf，结果按 LCD_DisplayText() 显示，最长 LCD_PRINTF_BYTES-1 字节
+     * @note   示例：LCD_Printf(10, 10, "电压 %5.2qV", 1234) 显示"电压 12.34V"
+     * @retval None
+     */
+    void LCD_Printf(uint16_t x, uint16_t y, const char *fmt, ...);
+
+    /**
+     * @brief  作废数字图集，下次显示数字时重新展开
+     * @note   仅在定义 LCD_NUM_ATLAS_ENABLE 且使用Flash字库时有效；换字库(FlashFont_Init)后调用
+     * @retval None
+     */
+    void LCD_NumAtlas_Invalidate(void);
+
+    /**
+     * @brief  限制数字图集运行时使用的槽数
+     * @param  slots 槽数，0或超过 LCD_NUM_ATLAS_SLOTS 时为 LCD_NUM_ATLAS_SLOTS
+     * @note   图集随即作废
+     * @retval 生效的槽数，未启用数字图集时为0
+     */
+    uint8_t LCD_NumAtlas_SetLimit(uint8_t slots);
+
+    /**
+     * @brief  初始化数字控件
+     * @param  num 控件
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  len 总位数（含小数点和符号），规则与 LCD_DisplayDecimals() 相同
+     * @param  decs 小数位数，0表示整数
+     * @note   只记录参数，不写屏
+     * @retval None
+     */
+    void LCD_NumberInit(LCD_Number_t *num, uint16_t x, uint16_t y, uint8_t len, uint8_t decs);
+
+    /**
+     * @brief  更新数字控件的显示
+     * @param  num 控件
+     * @param  value 定点数，显示值为 value / 10^decs，例如 decs=2 时 2345 显示为 23.45
+     * @note   只重绘与上次不同的字符，字体或颜色改变时整体重绘
+     * @note   示例：LCD_NumberShow(&temp, 2345)
+     * @retval None
+     */
+    void LCD_NumberShow(LCD_Number_t *num, int32_t value);
+
+    /**
+     * @brief  使数字控件下次整体重绘
+     * @param  num 控件
+     * @note   清屏或控件被其他内容覆盖后调用
+     * @retval None
+     */
+    void LCD_NumberInvalidate(LCD_Number_t *num);
+
     /*******************************************************************************
      *                              2D图形绘制
      ******************************************************************************/
@@ -359,17 +1747,49 @@ extern "C"
      * @note   移植自ST官方例程
      * @retval None
      */
-    void LCD_DrawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+    void LCD_DrawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+
+    /**
+     * @brief  依次连接各顶点画折线
+     * @param  points 顶点数组首地址
+     * @param  count 顶点个数
+     * @note   显示列表只记录顶点数组的地址
+     * @retval None
+     */
+    void LCD_DrawPolyline(const LCD_Point_t *points, uint16_t count);
+
+    /**
+     * @brief  按列绘制趋势图曲线，每列一段画笔色，其余为背景色
+     * @param  y 采样值数组(屏幕垂直坐标)
+     * @param  n 采样个数
+     * @param  x0 第一个采样的水平坐标
+     * @param  dx 相邻采样的水平间距
+     * @note   绘图区高度为当前裁剪区，整列重画时同时擦除旧曲线，滚动曲线不需要先清屏
+     * @retval None
+     */
+    void LCD_PlotSeries(const int16_t *y, uint16_t n, uint16_t x0, uint16_t dx);
+
+    /**
+     * @brief  绘制矩形框
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  width 矩形宽度
+     * @param  height 矩形高度
+     * @retval None
+     */
+    void LCD_DrawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
 
     /**
-     * @brief  绘制矩形框
+     * @brief  绘制1像素宽的圆角矩形边框
      * @param  x 起始水平坐标
      * @param  y 起始垂直坐标
      * @param  width 矩形宽度
      * @param  height 矩形高度
+     * @param  r 圆角半径，超过短边的一半或 LCD_ROUND_MAX_RADIUS 时取其中较小的
+     * @note   与 LCD_FillRoundRect() 共用按半径缓存的圆角表，不抗锯齿
      * @retval None
      */
-    void LCD_DrawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+    void LCD_DrawRoundRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t r);
 
     /**
      * @brief  绘制圆形轮廓
@@ -407,6 +1827,47 @@ extern "C"
      */
     void LCD_FillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
 
+    /**
+     * @brief  以渐变色填充矩形区域
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  width 矩形宽度，不超过 LCD_BUFF_PIXELS
+     * @param  height 矩形高度
+     * @param  color1 起点颜色(RGB888)，即顶行或最左列
+     * @param  color2 终点颜色(RGB888)
+     * @param  dir LCD_GRADIENT_V 或 LCD_GRADIENT_H
+     * @note   整个区域只设置一次窗口：垂直渐变每段同色的行一次同色填充，水平渐变生成整行写满渲染缓冲区后发送；
+     *         两端颜色先转换为RGB565，中间按8位分量插值
+     * @retval None
+     */
+    void LCD_FillGradient(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color1, uint32_t color2,
+                          uint8_t dir);
+
+    /**
+     * @brief  以平铺图案填充矩形区域
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  width 矩形宽度，不超过 LCD_BUFF_PIXELS
+     * @param  height 矩形高度
+     * @param  pattern 图案，从矩形左上角开始重复
+     * @note   整个区域只设置一次窗口，按行生成写满渲染缓冲区后发送，生成下一段时上一段仍在发送
+     * @retval None
+     */
+    void LCD_FillPattern(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const LCD_Pattern_t *pattern);
+
+    /**
+     * @brief  以画笔色填充圆角矩形
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  width 矩形宽度，直接写屏时不超过 LCD_BUFF_PIXELS
+     * @param  height 矩形高度
+     * @param  r 圆角半径，超过短边的一半或 LCD_ROUND_MAX_RADIUS 时取其中较小的
+     * @note   顶部圆角、中间矩形、底部圆角各一个窗口，每行圆角外侧的像素数按半径缓存；
+     *         定义 LCD_ROUND_AA_ENABLE 时边缘抗锯齿。直接写屏时圆角外侧写背景色，帧缓冲/条带模式下外侧不变
+     * @retval None
+     */
+    void LCD_FillRoundRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t r);
+
     /**
      * @brief  填充圆形区域
      * @param  x 圆心水平坐标
@@ -433,6 +1894,111 @@ extern "C"
      */
     void LCD_DrawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pImage);
 
+    /**
+     * @brief  显示RGB565彩色图像
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  width 图像宽度
+     * @param  height 图像高度
+     * @param  pImage 像素数据首地址(小端uint16，逐行存放)，可以位于QSPI映射区
+     * @note   像素不经过CPU：MDMA把下一段搬到渲染缓冲区的同时，BDMA发送上一段
+     * @retval None
+     */
+    void LCD_DrawImage565(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *pImage);
+
+#ifdef USE_FLASH_FONT
+    /**
+     * @brief  显示字库分区中的RGB565图片
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  index 图片编号(fontbin_tool.py --image 的参数顺序)
+     * @retval 1-已显示，0-字库中没有该图片
+     */
+    uint8_t LCD_DrawFlashImage(uint16_t x, uint16_t y, uint16_t index);
+#endif
+
+    /**
+     * @brief  显示调色板图片(4/8bpp)
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  img 图片描述
+     * @note   调色板先拷贝到DTCM中的查找表(4bpp展开为一次查出两个像素的256项表)，按渲染缓冲区大小分段展开，
+     *         展开下一段时上一段仍在发送；帧缓冲模式下定义 LCD_DMA2D_ENABLE 时由DMA2D按L8/L4格式和颜色表直接写入帧缓冲
+     * @retval None
+     */
+    void LCD_DrawImageIndexed(uint16_t x, uint16_t y, const LCD_IndexedImage_t *img);
+
+#ifdef USE_FLASH_FONT
+    /**
+     * @brief  显示字库分区中的调色板图片
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  index 图片编号(fontbin_tool.py --indexed 的参数顺序)
+     * @retval 1-已显示，0-字库中没有该图片
+     */
+    uint8_t LCD_DrawFlashIndexed(uint16_t x, uint16_t y, uint16_t index);
+#endif
+
+    /**
+     * @brief  显示行程压缩的RGB565图片
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  img 图片描述
+     * @note   边解码边发送：重复段填充、原样段拷贝到渲染缓冲区，满一个缓冲区交给BDMA，解码下一段时上一段仍在发送，
+     *         不需要整幅图片的RAM；数据不足 Width*Height 个像素时其余部分不写
+     * @retval None
+     */
+    void LCD_DrawImageRLE(uint16_t x, uint16_t y, const LCD_RleImage_t *img);
+
+#ifdef USE_FLASH_FONT
+    /**
+     * @brief  显示字库分区中的行程压缩图片
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  index 图片编号(fontbin_tool.py --rle 的参数顺序)
+     * @retval 1-已显示，0-字库中没有该图片
+     */
+    uint8_t LCD_DrawFlashRLE(uint16_t x, uint16_t y, uint16_t index);
+#endif
+
+    /**
+     * @brief  显示带透明度的ARGB4444图标
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  width 图像宽度
+     * @param  height 图像高度
+     * @param  pImage 像素数据首地址，每像素16位 A[15:12] R[11:8] G[7:4] B[3:0]，逐行存放
+     * @note   帧缓冲和显示列表模式下与已绘制的内容混合，直接发送时与背景色混合；
+     *         帧缓冲模式下定义 LCD_DMA2D_ENABLE 时由DMA2D混合，数据不能位于DTCM
+     * @retval None
+     */
+    void LCD_DrawImageARGB4444(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *pImage);
+
+    /**
+     * @brief  以画笔色显示8位透明度遮罩
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  width 图像宽度
+     * @param  height 图像高度
+     * @param  pAlpha 透明度数据首地址，每像素1字节(0透明，255为画笔色)，逐行存放
+     * @note   混合方式与 LCD_DrawImageARGB4444() 相同
+     * @retval None
+     */
+    void LCD_DrawImageA8(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pAlpha);
+
+    /**
+     * @brief  显示RGB888彩色图像
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  width 图像宽度
+     * @param  height 图像高度
+     * @param  pImage 像素数据首地址，每像素3字节 B,G,R(即 LCD_SetColor() 的 0xRRGGBB 按小端存放的低3字节)，逐行存放
+     * @note   帧缓冲模式下定义 LCD_DMA2D_ENABLE 时由DMA2D转换后直接写入帧缓冲，数据不能位于DTCM；
+     *         其他情况由CPU逐块转换为RGB565后发送
+     * @retval None
+     */
+    void LCD_DrawImage888(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pImage);
+
     /**
      * @brief  批量复制缓冲区到屏幕（LVGL移植用）
      * @param  x 起始水平坐标
@@ -445,10 +2011,394 @@ extern "C"
      */
     void LCD_CopyBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *DataBuff);
 
+    /**
+     * @brief  异步复制完成回调
+     * @param  arg LCD_CopyBufferAsync() 传入的参数
+     * @note   启用 LCD_SPI_DMA_ENABLE 时在SPI发送完成中断中调用
+     */
+    typedef void (*LCD_CopyDone_t)(void *arg);
+
+    /**
+     * @brief  后台复制缓冲区到屏幕，发送完成后调用回调（LVGL flush_cb 用）
+     * @param  x 起始水平坐标
+     * @param  y 起始垂直坐标
+     * @param  width 区域宽度
+     * @param  height 区域高度
+     * @param  DataBuff RGB565数据缓冲区，可以位于AXI SRAM，回调之前不能改写
+     * @param  done 完成回调，可为NULL
+     * @param  arg 回调参数
+     * @note   不在SRAM4的数据由MDMA逐段搬到渲染缓冲区，搬运与BDMA发送交替进行；
+     *         未启用DMA、帧缓冲/条带模式或窗口部分超出裁剪区时同步完成，返回前调用回调
+     * @retval None
+     */
+    void LCD_CopyBufferAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t *DataBuff,
+                             LCD_CopyDone_t done, void *arg);
+
+    /**
+     * @brief  向 LCD_SetAddress() 设置的窗口批量写入像素
+     * @param  DataBuff RGB565数据缓冲区
+     * @param  DataSize 像素个数
+     * @note   DataBuff 位于SRAM4时由BDMA后台发送，其他位置阻塞发送
+     * @retval None
+     */
+    void LCD_WriteBuff(uint16_t *DataBuff, uint16_t DataSize);
+
+    /**
+     * @brief  等待后台DMA传输结束
+     * @note   修改已交给 LCD_WriteBuff() 的缓冲区之前必须调用
+     * @note   未定义 LCD_SPI_DMA_ENABLE 时立即返回
+     * @retval None
+     */
+    void LCD_WaitIdle(void);
+
+    /**
+     * @brief  取得一个空闲的渲染缓冲区(SRAM4，LCD_BUFF_PIXELS 个像素)
+     * @note   填好像素后交给 LCD_DrawImage565() 即由BDMA直接发送
+     * @note   调用本驱动的其他绘制函数后缓冲区可能被改写
+     * @retval 缓冲区首地址
+     */
+    uint16_t *LCD_GetBuff(void);
+
+    /**
+     * @brief  SPI发送完成/出错处理，在 HAL_SPI_TxCpltCallback 和 HAL_SPI_ErrorCallback 中调用
+     * @param  hspi SPI句柄
+     * @retval None
+     */
+    void LCD_SPI_TxCpltHandler(SPI_HandleTypeDef *hspi);
+
+#ifdef LCD_FMC_ENABLE
+    /**
+     * @brief  FMC屏的MDMA中断处理，在 MDMA_IRQHandler 中调用
+     * @retval None
+     */
+    void LCD_FMC_IRQHandler(void);
+#endif
+
+#ifdef LCD_SPI_CLOCK_ENABLE
+    /**
+     * @brief  设置SPI像素时钟(SCK)
+     * @param  hz 目标频率，超过 LCD_SPI_CLOCK_MAX_HZ 时按最大值设置
+     * @note   重新配置PLL3使 SPI6内核时钟 = 2 x SCK，取不超过目标的最接近值
+     * @note   会等待后台DMA传输结束；PLL3只供SPI6使用，选中其他屏幕时返回0
+     * @retval 实际频率(Hz)，配置失败返回0(时钟不变)
+     */
+    uint32_t LCD_SPI_SetClock(uint32_t hz);
+
+    /**
+     * @brief  读取当前SPI像素时钟
+     * @retval 频率(Hz)
+     */
+    uint32_t LCD_SPI_GetClock(void);
+
+    /**
+     * @brief  测试指定频率下的写入是否可靠
+     * @param  hz 测试频率
+     * @param  clear_cycles 输出该频率下整屏清屏的CPU周期数，可为NULL
+     * @note   以测试频率写入显存访问控制寄存器(0x36)，再降到 LCD_SPI_READ_HZ
+     *         经SDA半双工读回(0x0B)比较，共 LCD_SPI_CALIB_TRIALS 次
+     * @note   测试结束后时钟保持为 hz，屏幕方向恢复，清屏会覆盖屏幕内容
+     * @retval 读回不一致的次数，0表示全部正确
+     */
+    uint16_t LCD_SPI_TestClock(uint32_t hz, uint32_t *clear_cycles);
+
+    /**
+     * @brief  自动校准：寻找屏幕能稳定工作的最高像素时钟
+     * @param  max_hz 搜索上限
+     * @note   从 LCD_SPI_CALIB_START_HZ 起按 LCD_SPI_CALIB_STEP_HZ 递增测试，
+     *         遇到第一个出错的频率后退回一档作为余量
+     * @note   模块未引出可读的SDA(读回全部失败)时恢复 LCD_SPI_CLOCK_HZ 并返回0
+     * @retval 最终设置的频率(Hz)
+     */
+    uint32_t LCD_SPI_Calibrate(uint32_t max_hz);
+#endif
+
+    /**
+     * @brief  把帧缓冲中的脏区域发送到屏幕
+     * @note   仅在定义 LCD_FRAMEBUFFER_ENABLE 时有效，否则立即返回
+     * @note   绘图函数只修改帧缓冲，需要周期性调用本函数(例如每帧一次)才会显示
+     * @retval None
+     */
+    void LCD_Flush(void);
+
+    /**
+     * @brief  设置脏矩形合并的代价模型
+     * @param  pixels 设置一次窗口的开销折合的像素数，0时恢复 LCD_FB_WINDOW_COST
+     * @note   LCD_Bench_Run() 测得 win_px 后自动设置；未定义 LCD_FRAMEBUFFER_ENABLE 时不起作用
+     * @retval None
+     */
+    void LCD_Flush_SetWindowCost(uint16_t pixels);
+
+    /**
+     * @brief  读取 LCD_Flush() 的发送统计，用于调整界面布局和 LCD_FB_WINDOW_COST
+     * @param  stats 输出，未定义 LCD_FRAMEBUFFER_ENABLE 时全部为0
+     * @param  reset 1-读取后清零累计值
+     * @retval None
+     */
+    void LCD_Flush_GetStats(LCD_FlushStats_t *stats, uint8_t reset);
+
+    /**
+     * @brief  读取帧缓冲(只读)
+     * @param  width、height 输出当前方向的宽高，可为NULL
+     * @note   远程镜像等只读用途，等待进行中的DMA2D写入完成后返回
+     * @retval 帧缓冲首地址，行宽为 width；未定义 LCD_FRAMEBUFFER_ENABLE 时返回NULL
+     */
+    const uint16_t *LCD_FB_Get(uint16_t *width, uint16_t *height);
+
+#ifdef LCD_TE_ENABLE
+    /**
+     * @brief  打开或关闭屏幕0的撕裂效应同步
+     * @param  enable 1-配置TE引脚的EXTI并发送TEON(0x35，只在垂直消隐期输出)，0-发送TEOFF(0x34)并释放引脚
+     * @note   须在 SPI_LCD_Init() 之后、选中屏幕0时调用；收到两个TE脉冲、测出刷新周期后 LCD_Flush() 开始同步
+     * @retval 1-成功，0-当前不是屏幕0
+     */
+    uint8_t LCD_TE_Enable(uint8_t enable);
+
+    /**
+     * @brief  等到矩形区域可以一次写完而不撕裂的时刻
+     * @note   供直接写屏的整页更新(LCD_CopyBuffer() 等)代替固定延时；区域大到一帧内写不完时
+     *         等到可以开始写的最早时刻，LCD_Flush() 会自动分段
+     * @note   没有锁定TE(未打开、不是屏幕0、超时)时立即返回
+     * @retval None
+     */
+    void LCD_TE_WaitRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+    /**
+     * @brief  屏幕刷新周期
+     * @retval 周期(微秒)，没有锁定TE时返回0
+     */
+    uint32_t LCD_TE_GetPeriod(void);
+
+    /**
+     * @brief  估算屏幕当前正在刷新的显存行
+     * @retval 行号(按刷新顺序，0 ~ 显存行数-1)，处于垂直消隐期或没有锁定TE时返回0xFFFF
+     */
+    uint16_t LCD_TE_GetScanline(void);
+
+    /**
+     * @brief  TE引脚的EXTI中断服务入口
+     * @note   由 stm32h7xx_it.c 中TE引脚所在的EXTI中断服务函数调用，只处理TE引脚的挂起位
+     * @retval None
+     */
+    void LCD_TE_IRQHandler(void);
+#endif
+
+    /**
+     * @brief  在帧缓冲中反显矩形区域：每个像素与 (画笔色 ^ 背景色) 异或，按当前颜色绘制的文字前景、背景互换
+     * @note   再调用一次恢复原样；不重新查找、展开字模，只有该区域计入脏区域
+     * @note   示例：LCD_InvertRect(0, old_y, 240, 24); LCD_InvertRect(0, new_y, 240, 24); LCD_Flush(); 移动菜单光标
+     * @retval 1-已完成，0-未定义 LCD_FRAMEBUFFER_ENABLE，需交换颜色后重画
+     */
+    uint8_t LCD_InvertRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+    /**
+     * @brief  在帧缓冲中高亮矩形区域：背景色像素换成 Color(RGB888)，Color像素换回背景色，笔画不变
+     * @note   再调用一次恢复原样，其余与 LCD_InvertRect() 相同
+     * @retval 1-已完成，0-未定义 LCD_FRAMEBUFFER_ENABLE
+     */
+    uint8_t LCD_HighlightRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t Color);
+
+    /**
+     * @brief  开始录制显示列表
+     * @note   仅在定义 LCD_TILE_ENABLE 时有效，之后的绘图函数只记录命令(连同当时的颜色、字体、字符模式)，不写屏
+     * @note   列表未覆盖的区域显示为调用本函数时的背景色
+     * @note   LCD_DrawImage()/LCD_CopyBuffer() 只记录数据地址，数据在 LCD_TileEnd() 之前必须保持有效
+     * @retval None
+     */
+    void LCD_TileBegin(void);
+
+    /**
+     * @brief  结束录制，逐条带回放显示列表并发送到屏幕
+     * @note   每个条带在SRAM4中合成，发送的同时回放下一条；与条带不相交的命令不会回放
+     * @note   列表或字符串空间用完时先把已录制的部分显示出来，之后的绘图直接写屏
+     * @retval None
+     */
+    void LCD_TileEnd(void);
+
+    /**
+     * @brief  开始记录一帧保留模式的内容
+     * @note   仅在定义 LCD_RETAIN_ENABLE 时有效，之后的 LCD_DisplayText()、LCD_DisplayString()、
+     *         LCD_DisplayNumber()、LCD_DisplayDecimals()、LCD_FillRect() 只记录，不写屏
+     * @note   各项按调用顺序与上一帧同一序号的项比较，布局不变的界面每帧按相同顺序调用即可
+     * @retval None
+     */
+    void LCD_RetainBegin(void);
+
+    /**
+     * @brief  结束记录，与上一帧比较后只重绘变化的部分
+     * @note   文本按字符比较，只重发内容改变的字符；变短时多出的字符用该项的背景色清除
+     * @note   项被删除或位置、字体、颜色改变时，先用该项的背景色清除旧区域再整项重绘
+     * @note   与清除或重绘区域重叠的其他项会按原顺序一并重绘
+     * @retval None
+     */
+    void LCD_RetainEnd(void);
+
+    /**
+     * @brief  丢弃上一帧的记录，下一次 LCD_RetainEnd() 整屏重绘
+     * @note   调用 LCD_Clear() 或切换界面后使用
+     * @retval None
+     */
+    void LCD_RetainInvalidate(void);
+
+    /**
+     * @brief  命令完成回调
+     * @param  seq: 完成的栅栏序号
+     * @param  arg: LCD_Queue_Fence() 传入的参数
+     */
+    typedef void (*LCD_QueueCallback_t)(uint32_t seq, void *arg);
+
+    /**
+     * @brief  排入清屏/填充矩形/文本/图片/缓冲区拷贝命令，立即返回
+     * @note   参数与 LCD_Clear()、LCD_FillRect()、LCD_DisplayText()、LCD_DrawImage()、LCD_CopyBuffer() 相同，
+     *         使用排入时的颜色、字体和字符模式
+     * @note   字符串拷贝保存；图片和缓冲区只记录地址，命令完成前数据必须保持有效
+     * @note   队列满时先执行最早的命令；未定义 LCD_QUEUE_ENABLE 时同步绘制
+     * @retval 命令序号，用于 LCD_Queue_IsDone()/LCD_Queue_Wait()；在完成回调中排入而队列已满时返回0
+     */
+    uint32_t LCD_Queue_Clear(void);
+    uint32_t LCD_Queue_FillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+    uint32_t LCD_Queue_Text(uint16_t x, uint16_t y, const char *pText);
+    uint32_t LCD_Queue_Image(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pImage);
+    uint32_t LCD_Queue_Copy(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *DataBuff);
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+    uint32_t LCD_Queue_GlyphIds(uint16_t x, uint16_t y, const LCD_GlyphIds_t *run); /*!< 只记录地址，同图片 */
+#endif
+
+    /**
+     * @brief  插入栅栏，之前排入的同级和更高优先级的命令全部完成(含DMA发送)后调用 callback
+     * @note   栅栏使用 LCD_Queue_SetPriority() 设置的优先级
+     * @param  callback: 完成回调，可为NULL；在 LCD_Queue_Poll() 中调用，可以排入新命令
+     * @param  arg: 回调参数
+     * @retval 栅栏序号
+     */
+    uint32_t LCD_Queue_Fence(LCD_QueueCallback_t callback, void *arg);
+
+    /**
+     * @brief  查询命令是否完成
+     * @param  seq: LCD_Queue_*() 返回的序号
+     * @retval 1-该命令已完成(同一优先级的命令按排入顺序完成)，0-尚未完成
+     */
+    uint8_t LCD_Queue_IsDone(uint32_t seq);
+
+    /**
+     * @brief  执行队列直到指定命令完成，不能在完成回调中调用
+     * @param  seq: LCD_Queue_*() 返回的序号
+     * @retval None
+     */
+    void LCD_Queue_Wait(uint32_t seq);
+
+    /**
+     * @brief  队列中尚未完成的命令数
+     * @retval 命令数
+     */
+    uint16_t LCD_Queue_Pending(void);
+
+    /**
+     * @brief  执行队列，在 main_while() 中周期调用
+     * @note   DMA发送中立即返回；每次连续执行不超过 LCD_QUEUE_SLICE_MS 毫秒
+     * @note   先执行优先级最高的命令；低于 LCD_PRIO_INPUT 的清屏/填充/图片/拷贝按 LCD_QUEUE_STRIP_ROWS 行分段，
+     *         每段之后重新选择，文本命令不拆分
+     * @note   队列非空时不要直接调用其他绘图函数，否则显示顺序与调用顺序不一致
+     * @retval None
+     */
+    void LCD_Queue_Poll(void);
+
+    /**
+     * @brief  设置 LCD_Queue_*() 排入命令的优先级
+     * @param  prio: LCD_PRIO_INPUT / LCD_PRIO_LIVE / LCD_PRIO_BACKGROUND
+     * @note   LCD_Queue_Poll() 总是先执行优先级最高的命令；同一优先级按排入顺序执行。LCD_GC_*() 使用上下文自己的优先级
+     * @retval 原来的优先级
+     */
+    uint8_t LCD_Queue_SetPriority(uint8_t prio);
+
+    /**
+     * @brief  读取命令队列的延迟统计
+     * @param  stats: 输出
+     * @param  reset: 1-读取后清零
+     * @retval None
+     */
+    void LCD_Queue_GetStats(LCD_QueueStats_t *stats, uint8_t reset);
+
+    /**
+     * @brief  初始化绘图上下文：白色画笔、黑色背景、24号字体、背景不透明、不裁剪
+     * @param  gc: 绘图上下文
+     * @retval None
+     */
+    void LCD_GC_Init(LCD_GC_t *gc);
+
+    /**
+     * @brief  设置绘图上下文的画笔色/背景色(RGB888，保存为RGB565)、字体大小和字符背景模式
+     * @note   参数与 LCD_SetColor()、LCD_SetBackColor()、LCD_SetTextFont()、LCD_SetTextFontFamily()、LCD_SetTextMode()、
+     *         LCD_SetTextEncoding()、LCD_SetTextEffect() 相同，不影响全局状态
+     * @retval None
+     */
+    void LCD_GC_SetColor(LCD_GC_t *gc, uint32_t Color);
+    void LCD_GC_SetBackColor(LCD_GC_t *gc, uint32_t Color);
+    void LCD_GC_SetFont(LCD_GC_t *gc, uint8_t font_size);
+    void LCD_GC_SetFontFamily(LCD_GC_t *gc, uint8_t family, uint8_t font_size);
+    void LCD_GC_SetTextMode(LCD_GC_t *gc, uint8_t mode);
+    void LCD_GC_SetTextEncoding(LCD_GC_t *gc, uint8_t enc);
+    void LCD_GC_SetTextEffect(LCD_GC_t *gc, uint8_t effect, uint32_t Color);
+
+    /**
+     * @brief  设置按该上下文排入命令的优先级 LCD_PRIO_*
+     * @retval None
+     */
+    void LCD_GC_SetPriority(LCD_GC_t *gc, uint8_t prio);
+
+    /**
+     * @brief  设置裁剪区，width或height为0时不裁剪
+     * @note   与 LCD_SetClip() 相同，只作用于按该上下文绘制的命令
+     * @retval None
+     */
+    void LCD_GC_SetClip(LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+    /**
+     * @brief  按绘图上下文排入清除(背景色填充裁剪区)/填充矩形/文本/图片/缓冲区拷贝命令
+     * @note   可在多个任务中调用，只在排入时短暂进入 LCD_QUEUE_LOCK()；定义 LCD_QUEUE_SERVER 时由渲染任务执行
+     * @retval 命令序号；无法排入时返回0
+     */
+    uint32_t LCD_GC_Clear(const LCD_GC_t *gc);
+    uint32_t LCD_GC_FillRect(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+    uint32_t LCD_GC_Text(const LCD_GC_t *gc, uint16_t x, uint16_t y, const char *pText);
+    uint32_t LCD_GC_Image(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                          const uint8_t *pImage);
+    uint32_t LCD_GC_Copy(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                         uint16_t *DataBuff);
+#if defined(USE_FLASH_FONT) && !defined(IS_GB2312)
+    uint32_t LCD_GC_GlyphIds(const LCD_GC_t *gc, uint16_t x, uint16_t y, const LCD_GlyphIds_t *run);
+#endif
+
+    /**
+     * @brief  按绘图上下文立即绘制，参数与不带 _Ex 的函数相同，调用前后全局绘图状态不变
+     * @note   按上下文的裁剪区裁剪
+     * @retval None
+     */
+    void LCD_DisplayText_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, char *pText);
+    void LCD_DisplayString_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, char *p);
+    void LCD_DisplayNumber_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, int32_t number, uint8_t len);
+    void LCD_DisplayDecimals_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, double decimals, uint8_t len,
+                                uint8_t decs);
+    void LCD_NumberShow_Ex(const LCD_GC_t *gc, LCD_Number_t *num, int32_t value);
+    void LCD_FillRect_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+    void LCD_ClearRect_Ex(const LCD_GC_t *gc, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
 #endif
 
 #ifdef __cplusplus
 }
 #endif
 
+#ifdef LCD_SPRITE_ENABLE
+#include "lcd_sprite.h" // 位图缓存使用 LCD_GC_t，在本文件的类型定义之后包含
+#endif
+#ifdef LCD_ANIM_ENABLE
+#include "lcd_anim.h" // 动画使用 LCD_GC_t 和 LCD_Number_t，同样在类型定义之后包含
+#endif
+#ifdef LCD_MIRROR_ENABLE
+#include "lcd_mirror.h"
+#endif
+#ifdef LCD_REMOTE_ENABLE
+#include "lcd_remote.h" // 远程文本协议使用 LCD_GC_t 和 LCD_GlyphIds_t
+#endif
+
 #endif // __spi_lcd
@@ -0,0 +1,294 @@
+/**
+ ******************************************************************************
+ * @file    lcd_spi.hpp
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   SPI LCD 驱动的C++接口(只有头文件)
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 只是 lcd_spi.h 的一层内联封装，不增加源文件，C工程不需要包含本文件；需要C++11(ARMCC5 加 --cpp11)
+ * - 颜色和调色板是 constexpr 类型，RGB888 到 RGB565 的转换在编译时完成
+ * - Text<字号, 像素格式> 在构造时选定字号(LCD_GC_SetFont() 同时选好该字宽的专用展开函数)，
+ *   字号是否编译进固件(init.h FONT_SIZES)由 static_assert 检查；没有虚函数
+ * - Canvas 持有一个绘图上下文，只能移动不能拷贝；ClipScope / TileFrame / RetainFrame
+ *   在构造时开始、析构时结束，作用域退出时自动恢复
+ *
+ * 使用示例：
+ *     constexpr lcd::Color kTitle(0x00FFCC);
+ *     lcd::Canvas canvas;
+ *     canvas.color(kTitle);
+ *     {
+ *         lcd::TileFrame frame;                  // 作用域结束时 LCD_TileEnd()
+ *         lcd::Canvas::ClipScope clip(canvas, 0, 0, 120, 40);
+ *         lcd::Text<24> title(canvas);
+ *         title.draw(0, 0, "反客科技");
+ *     }
+ *
+ ******************************************************************************
+ */
+
+#ifndef LCD_SPI_HPP
+#define LCD_SPI_HPP
+
+#include "lcd_spi.h"
+
+#ifdef LCD_SPI_ENABLE
+
+namespace lcd
+{
+    /*******************************************************************************
+     *                              颜色
+     ******************************************************************************/
+
+    /**
+     * @brief 接口像素格式，与 LCD_SetPixelFormat() 的参数相同
+     */
+    enum class PixelFormat : uint8_t
+    {
+        RGB565 = LCD_PIXEL_RGB565, /*!< 16位(默认) */
+        RGB444 = LCD_PIXEL_RGB444  /*!< 12位，发送时截取 */
+    };
+
+    /**
+     * @brief RGB888颜色，与 LCD_SetColor() 等的参数相同
+     */
+    class Color
+    {
+    public:
+        constexpr Color() : rgb_(0) {}
+        constexpr explicit Color(uint32_t rgb) : rgb_(rgb & 0xFFFFFF) {}
+        constexpr Color(uint8_t r, uint8_t g, uint8_t b)
+            : rgb_(((uint32_t)r << 16) | ((uint32_t)g << 8) | b) {}
+
+        constexpr uint32_t rgb() const { return rgb_; }
+        constexpr uint16_t rgb565() const { return LCD_RGB565(rgb_); }
+
+        /**
+         * @brief  按像素格式取得绘图使用的值
+         * @note   绘图函数和缓冲区总是RGB565，RGB444只在发送时截取，两种格式结果相同
+         */
+        template <PixelFormat F>
+        constexpr uint16_t native() const { return rgb565(); }
+
+    private:
+        uint32_t rgb_;
+    };
+
+    /**
+     * @brief 调色板，颜色在编译时转换好，load() 写入 LCD_SetPaletteColor() 的调色板
+     */
+    template <uint8_t N>
+    class Palette
+    {
+    public:
+        template <typename... C>
+        constexpr Palette(C... colors) : colors_{colors...}
+        {
+            static_assert(sizeof...(C) == N, "调色板颜色数与N不一致");
+        }
+
+        constexpr uint8_t size() const { return N; }
+        constexpr Color operator[](uint8_t index) const { return colors_[index]; }
+
+        /**
+         * @brief  从 first 号开始写入调色板
+         */
+        void load(uint8_t first = 0) const
+        {
+            for (uint8_t i = 0; i < N; i++)
+            {
+                LCD_SetPaletteColor((uint8_t)(first + i), colors_[i].rgb());
+            }
+        }
+
+    private:
+        Color colors_[N];
+    };
+
+    /*******************************************************************************
+     *                              绘图上下文
+     ******************************************************************************/
+
+    /**
+     * @brief 持有一个 LCD_GC_t，只能移动；绘制不读写全局绘图状态
+     */
+    class Canvas
+    {
+    public:
+        Canvas() { LCD_GC_Init(&gc_); }
+        Canvas(const Canvas &) = delete;
+        Canvas &operator=(const Canvas &) = delete;
+        Canvas(Canvas &&other) : gc_(other.gc_), live_(other.live_) { other.live_ = false; }
+        Canvas &operator=(Canvas &&other)
+        {
+            gc_ = other.gc_;
+            live_ = other.live_;
+            other.live_ = false;
+            return *this;
+        }
+
+        /**
+         * @brief  是否仍持有上下文，移出后为false，之后的绘制不执行
+         */
+        explicit operator bool() const { return live_; }
+        const LCD_GC_t *gc() const { return &gc_; }
+        LCD_GC_t *gc() { return &gc_; }
+
+        void color(Color c) { gc_.Color = c.rgb565(); }
+        void backColor(Color c) { gc_.BackColor = c.rgb565(); }
+        void textMode(uint8_t mode) { LCD_GC_SetTextMode(&gc_, mode); }
+        void priority(uint8_t prio) { LCD_GC_SetPriority(&gc_, prio); }
+        void clip(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+        {
+            LCD_GC_SetClip(&gc_, x, y, width, height);
+        }
+
+        void fillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height) const
+        {
+            if (live_)
+                LCD_FillRect_Ex(&gc_, x, y, width, height);
+        }
+        void clearRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height) const
+        {
+            if (live_)
+                LCD_ClearRect_Ex(&gc_, x, y, width, height);
+        }
+
+        /**
+         * @brief 裁剪作用域：构造时设置上下文的裁剪区，析构时恢复原来的裁剪区，可以嵌套
+         */
+        class ClipScope
+        {
+        public:
+            ClipScope(Canvas &canvas, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+                : gc_(canvas.gc()), x_(gc_->ClipX), y_(gc_->ClipY), w_(gc_->ClipWidth), h_(gc_->ClipHeight)
+            {
+                LCD_GC_SetClip(gc_, x, y, width, height);
+            }
+            ~ClipScope() { LCD_GC_SetClip(gc_, x_, y_, w_, h_); }
+            ClipScope(const ClipScope &) = delete;
+            ClipScope &operator=(const ClipScope &) = delete;
+
+        private:
+            LCD_GC_t *gc_;
+            uint16_t x_, y_, w_, h_;
+        };
+
+    private:
+        LCD_GC_t gc_;
+        bool live_ = true;
+    };
+
+    /*******************************************************************************
+     *                              文本
+     ******************************************************************************/
+
+    /**
+     * @brief 编译时字号
+     */
+    template <uint8_t Size>
+    struct Font
+    {
+        static_assert(FONT_SIZE_USED(Size), "该字号未在 init.h 的 FONT_SIZES 中启用");
+        static constexpr uint8_t size = Size;
+        static constexpr uint8_t asciiWidth = Size / 2; /*!< ASCII字符宽度 */
+    };
+
+    /**
+     * @brief 按固定字号和像素格式绘制文本，构造时把字号写入上下文，绘制时不再按字号分支
+     * @note  Canvas 需在 Text 之前构造、之后析构
+     */
+    template <uint8_t Size, PixelFormat F = PixelFormat::RGB565>
+    class Text
+    {
+        static_assert(FONT_SIZE_USED(Size), "该字号未在 init.h 的 FONT_SIZES 中启用");
+
+    public:
+        typedef Font<Size> font;
+
+        explicit Text(Canvas &canvas) : canvas_(canvas) { LCD_GC_SetFont(canvas_.gc(), Size); }
+
+        void color(Color c) { canvas_.gc()->Color = c.native<F>(); }
+        void backColor(Color c) { canvas_.gc()->BackColor = c.native<F>(); }
+
+        void draw(uint16_t x, uint16_t y, const char *text) const
+        {
+            if (canvas_)
+                LCD_DisplayText_Ex(canvas_.gc(), x, y, const_cast<char *>(text));
+        }
+        void number(uint16_t x, uint16_t y, int32_t value, uint8_t len) const
+        {
+            if (canvas_)
+                LCD_DisplayNumber_Ex(canvas_.gc(), x, y, value, len);
+        }
+
+        /**
+         * @brief  排入绘图队列，返回命令序号，无法排入时为0
+         */
+        uint32_t queue(uint16_t x, uint16_t y, const char *text) const
+        {
+            return canvas_ ? LCD_GC_Text(canvas_.gc(), x, y, text) : 0;
+        }
+
+        /**
+         * @brief  n个等宽字符(ASCII)的宽度，编译时常量
+         */
+        static constexpr uint16_t asciiWidth(uint16_t n) { return (uint16_t)(n * font::asciiWidth); }
+
+    private:
+        Canvas &canvas_;
+    };
+
+    /*******************************************************************************
+     *                              帧作用域
+     ******************************************************************************/
+
+    /**
+     * @brief 全局裁剪作用域，析构时取消裁剪(全局裁剪区不能读回，不能嵌套)
+     */
+    class ScreenClip
+    {
+    public:
+        ScreenClip(uint16_t x, uint16_t y, uint16_t width, uint16_t height) { LCD_SetClip(x, y, width, height); }
+        ~ScreenClip() { LCD_ResetClip(); }
+        ScreenClip(const ScreenClip &) = delete;
+        ScreenClip &operator=(const ScreenClip &) = delete;
+    };
+
+    /**
+     * @brief 显示列表作用域：构造时 LCD_TileBegin()，析构时 LCD_TileEnd() 逐条带合成发送
+     */
+    class TileFrame
+    {
+    public:
+        TileFrame() { LCD_TileBegin(); }
+        ~TileFrame() { LCD_TileEnd(); }
+        TileFrame(const TileFrame &) = delete;
+        TileFrame &operator=(const TileFrame &) = delete;
+    };
+
+    /**
+     * @brief 保留模式作用域：构造时 LCD_RetainBegin()，析构时 LCD_RetainEnd() 只重绘变化的部分
+     */
+    class RetainFrame
+    {
+    public:
+        RetainFrame() { LCD_RetainBegin(); }
+        ~RetainFrame() { LCD_RetainEnd(); }
+        RetainFrame(const RetainFrame &) = delete;
+        RetainFrame &operator=(const RetainFrame &) = delete;
+    };
+
+    /**
+     * @brief  切换接口像素格式
+     * @retval 1-已切换，0-不支持
+     */
+    template <PixelFormat F>
+    inline uint8_t selectFormat() { return LCD_SetPixelFormat((uint8_t)F); }
+
+} // namespace lcd
+
+#endif // LCD_SPI_ENABLE
+
+#endif // LCD_SPI_HPP
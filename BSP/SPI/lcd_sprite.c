@@ -0,0 +1,319 @@
+/**
+ ******************************************************************************
+ * @file    lcd_sprite.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   控件位图缓存实现文件
+ ******************************************************************************
+ * @attention
+ * 实现方式：
+ * 1. 索引表每项记录键值、尺寸、在缓存区中的起始像素和最近使用时刻，按键值线性查找
+ * 2. 分配时在已用块之间找第一个放得下的空隙(起点按32字节Cache行对齐)，找不到就淘汰
+ *    最久未使用的一项再找，块数很少，不维护空闲链表
+ * 3. 复制使用 LCD_CopyBuffer()，返回时数据已发送完，缓存区只由CPU读写
+ *
+ ******************************************************************************
+ */
+
+#include "init.h"
+
+#if defined(LCD_SPRITE_ENABLE) && defined(LCD_SPI_ENABLE)
+#include "lcd_sprite.h"
+
+/*******************************************************************************
+ *                              私有宏定义
+ ******************************************************************************/
+#define LCD_SPRITE_ALIGN 16U								  /*!< 分配粒度(像素)，一个Cache行 */
+#define LCD_SPRITE_PIXELS (LCD_SPRITE_BYTES / 2U)			  /*!< 缓存区像素数 */
+#define LCD_SPRITE_ROUND(n) (((n) + LCD_SPRITE_ALIGN - 1U) & ~(LCD_SPRITE_ALIGN - 1U))
+
+#if LCD_SPRITE_BYTES > 0xA000U || (LCD_SPRITE_BYTES % 32U) != 0
+#error "LCD_SPRITE_BYTES 必须是32的倍数，且不超过 0x24036000-0x24040000 之间的40KB"
+#endif
+#if LCD_SPRITE_ENTRIES < 1 || LCD_SPRITE_ENTRIES > 255
+#error "LCD_SPRITE_ENTRIES 必须在1-255之间"
+#endif
+
+/*******************************************************************************
+ *                              私有类型与变量
+ ******************************************************************************/
+
+/**
+ * @brief  位图索引项
+ */
+typedef struct
+{
+	uint32_t key;	 /*!< 键值 */
+	uint32_t stamp;	 /*!< 最近使用时刻，0表示空项 */
+	uint32_t offset; /*!< 在缓存区中的起始像素 */
+	uint16_t width;	 /*!< 位图宽度 */
+	uint16_t height; /*!< 位图高度 */
+} LCD_Sprite_Tag_t;
+
+LCD_SPRITE_ATTR static uint16_t LCD_Sprite_Pool[LCD_SPRITE_PIXELS] __attribute__((aligned(32))); // 位图缓存区
+static LCD_Sprite_Tag_t LCD_Sprite_Tag[LCD_SPRITE_ENTRIES];										// 索引表
+static uint32_t LCD_Sprite_Clock = 0;															// 使用计数，作为LRU时间戳
+static uint32_t LCD_Sprite_Used = 0;															// 已占用的像素数(含对齐)
+static uint32_t LCD_Sprite_Peak = 0;															// 占用像素数的峰值
+static uint32_t LCD_Sprite_Limit = LCD_SPRITE_PIXELS;											// 运行时可用的像素数(LCD_Sprite_SetLimit())
+static uint32_t LCD_Sprite_Hits = 0;
+static uint32_t LCD_Sprite_Misses = 0;
+
+/**
+ * @brief  LCD_Sprite_Text() 的绘制参数
+ */
+typedef struct
+{
+	const char *text;
+	const LCD_GC_t *gc;
+} LCD_Sprite_TextArg_t;
+
+/*******************************************************************************
+ *                              私有函数实现
+ ******************************************************************************/
+
+/**
+ * @brief  位图占用的像素数(按分配粒度取整)
+ */
+static uint32_t LCD_Sprite_Size(const LCD_Sprite_Tag_t *t)
+{
+	return LCD_SPRITE_ROUND((uint32_t)t->width * t->height);
+}
+
+/**
+ * @brief  释放一项
+ */
+static void LCD_Sprite_Free(LCD_Sprite_Tag_t *t)
+{
+	LCD_Sprite_Used -= LCD_Sprite_Size(t);
+	t->stamp = 0;
+}
+
+/**
+ * @brief  在已用块之间找第一个能放下 pixels 个像素的空隙
+ * @retval 起始像素，在运行时上限内找不到时返回 LCD_SPRITE_PIXELS
+ */
+static uint32_t LCD_Sprite_FindGap(uint32_t pixels)
+{
+	uint32_t start = 0; // 候选起点：缓存区起点和每个已用块的末尾
+
+	for (uint32_t c = 0; c <= LCD_SPRITE_ENTRIES; c++)
+	{
+		if (c > 0)
+		{
+			const LCD_Sprite_Tag_t *t = &LCD_Sprite_Tag[c - 1];
+			if (t->stamp == 0)
+				continue;
+			start = t->offset + LCD_Sprite_Size(t);
+		}
+		if (start + pixels > LCD_Sprite_Limit)
+			continue;
+
+		uint8_t overlap = 0;
+		for (uint32_t i = 0; i < LCD_SPRITE_ENTRIES; i++)
+		{
+			const LCD_Sprite_Tag_t *t = &LCD_Sprite_Tag[i];
+			if (t->stamp != 0 && t->offset < start + pixels && start < t->offset + LCD_Sprite_Size(t))
+			{
+				overlap = 1;
+				break;
+			}
+		}
+		if (!overlap)
+			return start;
+	}
+	return LCD_SPRITE_PIXELS;
+}
+
+/**
+ * @brief  最久未使用的一项，没有已用项时返回NULL
+ */
+static LCD_Sprite_Tag_t *LCD_Sprite_Oldest(void)
+{
+	LCD_Sprite_Tag_t *victim = NULL;
+
+	for (uint32_t i = 0; i < LCD_SPRITE_ENTRIES; i++)
+	{
+		LCD_Sprite_Tag_t *t = &LCD_Sprite_Tag[i];
+		if (t->stamp != 0 && (victim == NULL || t->stamp < victim->stamp))
+			victim = t;
+	}
+	return victim;
+}
+
+/**
+ * @brief  分配一项和 pixels 个像素，空间不够时按LRU淘汰
+ * @retval 索引项，pixels 超出缓存区时返回NULL
+ */
+static LCD_Sprite_Tag_t *LCD_Sprite_Alloc(uint32_t pixels)
+{
+	LCD_Sprite_Tag_t *slot = NULL;
+	LCD_Sprite_Tag_t *victim;
+	uint32_t offset;
+
+	if (pixels > LCD_Sprite_Limit)
+		return NULL;
+
+	for (uint32_t i = 0; i < LCD_SPRITE_ENTRIES && slot == NULL; i++)
+	{
+		if (LCD_Sprite_Tag[i].stamp == 0)
+			slot = &LCD_Sprite_Tag[i];
+	}
+	if (slot == NULL) // 索引表已满
+	{
+		slot = LCD_Sprite_Oldest();
+		LCD_Sprite_Free(slot);
+	}
+
+	while ((offset = LCD_Sprite_FindGap(pixels)) == LCD_SPRITE_PIXELS)
+	{
+		victim = LCD_Sprite_Oldest(); // 缓存区全空时一定能放下，此处不会为NULL
+		LCD_Sprite_Free(victim);
+	}
+
+	slot->offset = offset;
+	LCD_Sprite_Used += pixels;
+	if (LCD_Sprite_Used > LCD_Sprite_Peak)
+		LCD_Sprite_Peak = LCD_Sprite_Used;
+	return slot;
+}
+
+/**
+ * @brief  查找键值
+ */
+static LCD_Sprite_Tag_t *LCD_Sprite_Find(uint32_t key)
+{
+	for (uint32_t i = 0; i < LCD_SPRITE_ENTRIES; i++)
+	{
+		LCD_Sprite_Tag_t *t = &LCD_Sprite_Tag[i];
+		if (t->stamp != 0 && t->key == key)
+			return t;
+	}
+	return NULL;
+}
+
+/**
+ * @brief  LCD_Sprite_Text() 的绘制函数：背景色填充后渲染文本
+ */
+static void LCD_Sprite_DrawText(uint16_t *dst, uint16_t width, uint16_t height, void *arg)
+{
+	const LCD_Sprite_TextArg_t *a = (const LCD_Sprite_TextArg_t *)arg;
+	uint32_t count = (uint32_t)width * height;
+
+	for (uint32_t i = 0; i < count; i++)
+		dst[i] = a->gc->BackColor;
+	LCD_RenderTextToBuffer(dst, width, width, height, a->text, a->gc);
+}
+
+/*******************************************************************************
+ *                              导出函数实现
+ ******************************************************************************/
+
+uint8_t LCD_Sprite_Draw(uint32_t key, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+						LCD_SpriteDraw_t draw, void *arg)
+{
+	LCD_Sprite_Tag_t *t = LCD_Sprite_Find(key);
+
+	if (t != NULL && (t->width != width || t->height != height))
+	{
+		LCD_Sprite_Free(t); // 尺寸变化，重新分配
+		t = NULL;
+	}
+	if (t != NULL)
+	{
+		t->stamp = ++LCD_Sprite_Clock;
+		LCD_Sprite_Hits++;
+		LCD_CopyBuffer(x, y, width, height, &LCD_Sprite_Pool[t->offset]);
+		return LCD_SPRITE_HIT;
+	}
+
+	if (width == 0 || height == 0 || draw == NULL)
+		return LCD_SPRITE_NONE;
+	t = LCD_Sprite_Alloc(LCD_SPRITE_ROUND((uint32_t)width * height));
+	if (t == NULL)
+		return LCD_SPRITE_NONE;
+
+	t->key = key;
+	t->width = width;
+	t->height = height;
+	t->stamp = ++LCD_Sprite_Clock;
+	LCD_Sprite_Misses++;
+	draw(&LCD_Sprite_Pool[t->offset], width, height, arg);
+	LCD_CopyBuffer(x, y, width, height, &LCD_Sprite_Pool[t->offset]);
+	return LCD_SPRITE_DRAWN;
+}
+
+uint8_t LCD_Sprite_Text(uint32_t key, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const char *pText,
+						const LCD_GC_t *gc)
+{
+	uint8_t ret = LCD_SPRITE_NONE;
+
+	if (pText == NULL || gc == NULL)
+		return LCD_SPRITE_NONE;
+#ifdef LCD_RENDER_BUFFER_ENABLE
+	LCD_Sprite_TextArg_t arg = {pText, gc};
+	ret = LCD_Sprite_Draw(key, x, y, width, height, LCD_Sprite_DrawText, &arg);
+#else
+	(void)key;
+	(void)width;
+	(void)height;
+#endif
+	if (ret == LCD_SPRITE_NONE) // 不能离屏渲染或位图放不下，直接绘制
+		LCD_DisplayText_Ex(gc, x, y, (char *)pText);
+	return ret;
+}
+
+void LCD_Sprite_Invalidate(uint32_t key)
+{
+	LCD_Sprite_Tag_t *t = LCD_Sprite_Find(key);
+
+	if (t != NULL)
+		LCD_Sprite_Free(t);
+}
+
+void LCD_Sprite_Clear(void)
+{
+	for (uint32_t i = 0; i < LCD_SPRITE_ENTRIES; i++)
+		LCD_Sprite_Tag[i].stamp = 0;
+	LCD_Sprite_Used = 0;
+}
+
+uint32_t LCD_Sprite_GetStats(uint32_t *hits, uint32_t *misses)
+{
+	if (hits != NULL)
+		*hits = LCD_Sprite_Hits;
+	if (misses != NULL)
+		*misses = LCD_Sprite_Misses;
+	return LCD_Sprite_Used * 2U;
+}
+
+uint32_t LCD_Sprite_SetLimit(uint32_t bytes)
+{
+	if (bytes == 0 || bytes > LCD_SPRITE_BYTES)
+		bytes = LCD_SPRITE_BYTES;
+	bytes &= ~(LCD_SPRITE_ALIGN * 2U - 1U); // 整数个Cache行
+	if (bytes == 0)
+		bytes = LCD_SPRITE_ALIGN * 2U;
+	LCD_Sprite_Clear();
+	LCD_Sprite_Peak = 0;
+	LCD_Sprite_Limit = bytes / 2U;
+	return bytes;
+}
+
+#ifdef PERF_MEMORY_ENABLE
+void LCD_Sprite_GetMemory(PerfMemory_Entry_t *entry)
+{
+	entry->name = "sprite";
+	entry->unit = "byte";
+	entry->base = LCD_Sprite_Pool;
+	entry->bytes = sizeof(LCD_Sprite_Pool) + sizeof(LCD_Sprite_Tag);
+	entry->capacity = LCD_SPRITE_BYTES;
+	entry->limit = LCD_Sprite_Limit * 2U;
+	entry->used = LCD_Sprite_Used * 2U;
+	entry->peak = LCD_Sprite_Peak * 2U;
+	entry->hits = LCD_Sprite_Hits;
+	entry->misses = LCD_Sprite_Misses;
+	entry->resizable = 1;
+}
+#endif
+
+#endif // LCD_SPRITE_ENABLE && LCD_SPI_ENABLE
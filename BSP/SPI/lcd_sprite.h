@@ -0,0 +1,125 @@
+/**
+ ******************************************************************************
+ * @file    lcd_sprite.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   控件位图缓存头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 反复绘制的组合控件(带图标的标签、表头、按钮等)第一次绘制时渲染到AXI SRAM中的
+ *   离屏位图，之后按键值直接 LCD_CopyBuffer() 整块发送，不再重新查找字模、排版和展开
+ * - 位图按像素数从 LCD_SPRITE_BYTES 的缓存区中分配(首次适配)，放不下时按最久未使用淘汰，
+ *   切换页面时整页控件只剩每个一次的窗口设置和连续发送
+ * - 键值由调用者决定(控件编号、文本的哈希等)，同一键值的尺寸变化时自动重新渲染；
+ *   内容变化(数值、颜色、字库更新)时调用 LCD_Sprite_Invalidate() 或 LCD_Sprite_Clear()
+ * - 由 init.h 中的 LCD_SPRITE_ENABLE 控制
+ *
+ * 使用示例：
+ *     LCD_Sprite_Text(0x100, 10, 40, 120, 24, "温度", &gc);      // 第一次渲染，之后直接复制
+ *     LCD_Sprite_Draw(0x101, 10, 80, 64, 64, DrawIcon, &icon);  // 自定义绘制函数
+ *
+ ******************************************************************************
+ */
+
+#ifndef __LCD_SPRITE_H
+#define __LCD_SPRITE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "lcd_spi.h"
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          功能配置
+ ******************************************************************************/
+#define LCD_SPRITE_BYTES 32768U /*!< 位图缓存区字节数，单个位图超过该值时不缓存 */
+#define LCD_SPRITE_ENTRIES 32   /*!< 最多缓存的位图个数 */
+#ifndef LCD_SPRITE_ATTR
+#define LCD_SPRITE_ATTR AXI_SRAM_AT(0x24036000) /*!< 缓存区放在AXI SRAM，字库安装缓冲区之后、LVGL缓冲区之前(最多40KB) */
+#endif
+
+#define LCD_SPRITE_NONE 0  /*!< LCD_Sprite_Draw()：没有缓存也没有绘制(尺寸为0、超出缓存区或绘制函数为NULL) */
+#define LCD_SPRITE_HIT 1   /*!< LCD_Sprite_Draw()：命中，直接复制 */
+#define LCD_SPRITE_DRAWN 2 /*!< LCD_Sprite_Draw()：未命中，已渲染、缓存并复制 */
+
+    /**
+     * @brief  位图绘制函数类型
+     * @param  dst: 位图首地址，按 width 个像素一行排列，内容未初始化
+     * @param  width: 位图宽度
+     * @param  height: 位图高度
+     * @param  arg: LCD_Sprite_Draw() 传入的参数
+     * @note   必须写满整个位图，通常先填充背景色，再调用 LCD_RenderTextToBuffer()
+     */
+    typedef void (*LCD_SpriteDraw_t)(uint16_t *dst, uint16_t width, uint16_t height, void *arg);
+
+    /*******************************************************************************
+     *                          导出函数声明
+     ******************************************************************************/
+
+    /**
+     * @brief  显示缓存的位图，未命中时先调用绘制函数渲染
+     * @param  key: 键值
+     * @param  x: 屏幕上的起始水平坐标
+     * @param  y: 屏幕上的起始垂直坐标
+     * @param  width: 位图宽度
+     * @param  height: 位图高度
+     * @param  draw: 绘制函数
+     * @param  arg: 绘制函数的参数
+     * @note   返回 LCD_SPRITE_NONE 时屏幕没有变化，调用者应直接绘制
+     * @note   分块模式(LCD_TILE_ENABLE)下复制只记录地址，同一帧内淘汰的位图会被覆盖，
+     *         缓存区应能放下一帧内用到的全部位图
+     * @retval LCD_SPRITE_NONE / LCD_SPRITE_HIT / LCD_SPRITE_DRAWN
+     */
+    uint8_t LCD_Sprite_Draw(uint32_t key, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                            LCD_SpriteDraw_t draw, void *arg);
+
+    /**
+     * @brief  显示缓存的文本位图，未命中时用背景色填充后以 LCD_RenderTextToBuffer() 渲染
+     * @param  key: 键值，同一键值必须对应同一文本和绘图上下文
+     * @param  x: 屏幕上的起始水平坐标
+     * @param  y: 屏幕上的起始垂直坐标
+     * @param  width: 位图宽度
+     * @param  height: 位图高度
+     * @param  pText: UTF-8字符串
+     * @param  gc: 绘图上下文，不能为NULL
+     * @retval LCD_SPRITE_NONE(已直接用 LCD_DisplayText_Ex() 绘制) / LCD_SPRITE_HIT / LCD_SPRITE_DRAWN
+     */
+    uint8_t LCD_Sprite_Text(uint32_t key, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const char *pText,
+                            const LCD_GC_t *gc);
+
+    /**
+     * @brief  作废一个位图，下次显示时重新渲染
+     * @param  key: 键值
+     */
+    void LCD_Sprite_Invalidate(uint32_t key);
+
+    /**
+     * @brief  作废全部位图(切换主题、字库更新后调用)
+     */
+    void LCD_Sprite_Clear(void);
+
+    /**
+     * @brief  读取命中统计
+     * @param  hits: 输出命中次数，可为NULL
+     * @param  misses: 输出渲染次数，可为NULL
+     * @retval 已占用的缓存区字节数
+     */
+    uint32_t LCD_Sprite_GetStats(uint32_t *hits, uint32_t *misses);
+
+    /**
+     * @brief  限制运行时使用的缓存区字节数
+     * @param  bytes: 字节数，按32字节取整；0或超过 LCD_SPRITE_BYTES 时为 LCD_SPRITE_BYTES
+     * @retval 生效的字节数
+     * @note   全部位图随即作废，命中统计保留；超过上限的位图不缓存，直接绘制
+     */
+    uint32_t LCD_Sprite_SetLimit(uint32_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LCD_SPRITE_H
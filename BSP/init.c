@@ -8,7 +8,8 @@
  *
  * 本文件实现：
  * - init_all(): 根据 init.h 中的使能开关初始化各外设模块
- * - main_while(): 周期调用各模块的非阻塞任务（如按键扫描）
+ * - main_while(): 按协作式调度器运行各模块的非阻塞任务（如按键扫描）
+ * - Sched_*(): 固定容量的周期任务表，每个任务按各自周期运行，空闲时WFI睡眠
  *
  * 使用示例：
  * int main(void) {
@@ -19,8 +20,7 @@
  *     init_all();  // 初始化所有外设
  *
  *     while (1) {
- *         main_while();  // 周期任务
- *         HAL_Delay(10); // 建议10ms调用一次
+ *         main_while();  // 周期任务，连续调用，各任务周期由任务表决定
  *     }
  * }
  *
@@ -31,6 +31,303 @@
 #include "GPIO/led.h"
 #include "SPI/lcd_spi.h"
 
+/*******************************************************************************
+ *                              协作式任务调度
+ ******************************************************************************/
+
+/**
+ * @brief 任务表项
+ */
+typedef struct
+{
+    Sched_TaskFunc func; /*!< 任务函数，NULL表示空闲项 */
+    uint32_t period;     /*!< 调用周期（毫秒） */
+    uint32_t next;       /*!< 下次到期的系统节拍 */
+} Sched_Task;
+
+static Sched_Task sched_tasks[SCHED_MAX_TASKS];
+static volatile uint8_t sched_kick = 0; /*!< 本轮有任务或中断报告剩余工作，不睡眠 */
+static Sched_Stats sched_stats;         /*!< 调度器统计 */
+#ifdef LCD_LVGL_ENABLE
+static int8_t sched_lvgl_id = -1; /*!< LVGL任务号，周期按 lv_timer_handler() 的返回值调整 */
+#endif
+
+/**
+ * @brief  注册周期任务
+ * @param  func: 任务函数
+ * @param  period_ms: 调用周期（毫秒），0表示每次都调用
+ * @retval 任务号，失败返回-1
+ */
+int8_t Sched_Add(Sched_TaskFunc func, uint32_t period_ms)
+{
+    if (func == NULL)
+        return -1;
+    for (int8_t i = 0; i < SCHED_MAX_TASKS; i++)
+    {
+        if (sched_tasks[i].func == NULL)
+        {
+            sched_tasks[i].func = func;
+            sched_tasks[i].period = period_ms;
+            sched_tasks[i].next = GetTick();
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief  修改任务周期
+ * @param  id: 任务号
+ * @param  period_ms: 新周期（毫秒）
+ * @retval None
+ */
+void Sched_SetPeriod(int8_t id, uint32_t period_ms)
+{
+    if (id < 0 || id >= SCHED_MAX_TASKS)
+        return;
+    sched_tasks[id].period = period_ms;
+    sched_tasks[id].next = GetTick() + period_ms;
+}
+
+/**
+ * @brief  注销任务
+ * @param  id: 任务号
+ * @retval None
+ */
+void Sched_Remove(int8_t id)
+{
+    if (id < 0 || id >= SCHED_MAX_TASKS)
+        return;
+    sched_tasks[id].func = NULL;
+}
+
+/**
+ * @brief  运行所有到期的任务
+ * @note   到期判断用有符号差值，GetTick() 回绕后仍然正确
+ * @note   正常情况下按周期对齐推进；落后超过一个周期（前面的任务运行过久）时从当前时刻顺延，不补跑
+ * @retval None
+ */
+void Sched_Run(void)
+{
+    uint32_t start = DWT->CYCCNT;
+
+    sched_kick = 0;
+    for (int i = 0; i < SCHED_MAX_TASKS; i++)
+    {
+        Sched_Task *t = &sched_tasks[i];
+        uint32_t now = GetTick();
+
+        if (t->func == NULL || (int32_t)(now - t->next) < 0)
+            continue;
+        t->next += t->period;
+        if ((int32_t)(now - t->next) >= 0)
+            t->next = now + t->period;
+        t->func();
+    }
+    sched_stats.passes++;
+    sched_stats.active_cycles += DWT->CYCCNT - start;
+}
+
+/**
+ * @brief  通知调度器还有工作
+ * @retval None
+ */
+void Sched_Kick(void)
+{
+    sched_kick = 1;
+}
+
+/**
+ * @brief  空闲时进入睡眠
+ * @note   关中断后检查：之后到来的中断挂起，WFI立即返回；开中断后中断服务函数才执行
+ * @note   只检查周期不为0的任务是否到期，周期为0的任务通过 Sched_Kick() 报告剩余工作
+ * @note   定义 FLASH_FONT_POWER_DOWN 时顺带检查字库是否空闲到可以让QSPI Flash深度掉电
+ * @retval 1=进入过睡眠，0=有工作未睡眠
+ */
+uint8_t Sched_Idle(void)
+{
+#ifdef SCHED_IDLE_SLEEP
+    uint8_t slept = 0;
+    uint32_t now;
+
+#if defined(FLASH_FONT_ENABLE) && defined(FLASH_FONT_POWER_DOWN)
+    if (!sched_kick)
+        FlashFont_PowerIdle(); /* 没有剩余工作(含队列中指向Flash的图片)时才允许掉电 */
+#endif
+    __disable_irq();
+    now = GetTick();
+    if (!sched_kick)
+    {
+        slept = 1;
+        for (int i = 0; i < SCHED_MAX_TASKS; i++)
+        {
+            Sched_Task *t = &sched_tasks[i];
+            if (t->func != NULL && t->period != 0 && (int32_t)(now - t->next) >= 0)
+            {
+                slept = 0;
+                break;
+            }
+        }
+    }
+    if (slept)
+    {
+        __DSB();
+        __WFI();
+        sched_stats.sleeps++;
+    }
+    __enable_irq();
+    return slept;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief  读取调度器统计
+ * @param  st: 输出
+ * @retval None
+ */
+void Sched_GetStats(Sched_Stats *st)
+{
+    *st = sched_stats;
+}
+
+/**
+ * @brief  清零调度器统计
+ * @note   同时使能DWT周期计数器
+ * @retval None
+ */
+void Sched_ResetStats(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    sched_stats.passes = 0;
+    sched_stats.sleeps = 0;
+    sched_stats.active_cycles = 0;
+    sched_stats.start_tick = GetTick();
+}
+
+#ifdef LCD_SPI_ENABLE
+/**
+ * @brief  命令队列任务，队列未执行完时不睡眠
+ * @retval None
+ */
+static void LCD_QueueTask(void)
+{
+    LCD_Queue_Poll();
+    if (LCD_Queue_Pending())
+        Sched_Kick();
+}
+#endif
+
+#ifdef LCD_ANIM_ENABLE
+/**
+ * @brief  动画任务（适配任务函数类型，进度按系统节拍计算，调用晚了也不改变动画时长）
+ * @retval None
+ */
+static void LCD_AnimTask(void)
+{
+    (void)LCD_Anim_Task();
+}
+#endif
+
+#ifdef LCD_MIRROR_ENABLE
+/**
+ * @brief  镜像任务（适配任务函数类型，LCD_Mirror_Start() 注册输出函数之前不发送）
+ * @retval None
+ */
+static void LCD_MirrorTask(void)
+{
+    (void)LCD_Mirror_Task();
+}
+#endif
+
+#ifdef LCD_REMOTE_ENABLE
+/**
+ * @brief  远程文本协议任务（适配任务函数类型，没有收到数据包时立即返回）
+ * @retval None
+ */
+static void LCD_RemoteTask(void)
+{
+    (void)LCD_Remote_Task();
+}
+#endif
+
+#if defined(LCD_SPI_ENABLE) && defined(LCD_PAGER_ENABLE)
+/**
+ * @brief  长文档分页任务（还有未排完的文档时不睡眠）
+ * @retval None
+ */
+static void LCD_PagerTask(void)
+{
+    if (LCD_Pager_Task())
+        Sched_Kick();
+}
+#endif
+
+#ifdef LCD_LVGL_ENABLE
+/**
+ * @brief  LVGL按需渲染：下次调用时间取 lv_timer_handler() 返回的等待时间
+ * @note   界面没有变化时LVGL返回较长的等待时间，调度器在此期间可以睡眠
+ * @retval None
+ */
+static void LCD_LVGL_TaskOnDemand(void)
+{
+    uint32_t ms = LCD_LVGL_Task();
+
+    if (ms == 0)
+        ms = 1;
+    if (ms > SCHED_LVGL_MAX_MS)
+        ms = SCHED_LVGL_MAX_MS;
+    Sched_SetPeriod(sched_lvgl_id, ms);
+}
+#endif
+
+#ifdef FLASH_FONT_ENABLE
+/**
+ * @brief  字库后台任务（适配任务函数类型，还有剩余工作时不睡眠）
+ * @retval None
+ */
+static void FlashFont_IdleTask(void)
+{
+    uint8_t busy = FlashFont_Idle();
+
+#if defined(GLYPH_CACHE_ENABLE) && defined(GLYPH_PREFETCH_ENABLE)
+    busy |= GlyphPrefetch_Idle(); /* 登记的下一页文字分批预取到字模缓存 */
+#endif
+    if (busy)
+        Sched_Kick();
+}
+#endif
+
+#ifdef DEBUG_LOG_ENABLE
+/**
+ * @brief  日志输出任务（还有未输出的记录时不睡眠）
+ * @retval None
+ */
+static void DebugLog_IdleTask(void)
+{
+    if (DebugLog_Task())
+        Sched_Kick();
+}
+#endif
+
+#ifdef FONT_STREAM_ENABLE
+/**
+ * @brief  字库在线更新任务（写入已收到的块，提交后切换到新字库）
+ * @retval None
+ */
+static void FontStream_Task(void)
+{
+    int8_t status = FontStream_Poll();
+
+    if (status == FONT_STREAM_COMMITTED)
+        FlashFont_Init();
+    else if (status == FONT_STREAM_BUSY)
+        Sched_Kick();
+}
+#endif
+
 /*******************************************************************************
  *                              初始化函数
  ******************************************************************************/
@@ -47,6 +344,16 @@ void init_all(void)
      *                              外设初始化部分
      ******************************************************************************/
 
+    Debug_Init(); /* 日志缓冲区，之后各模块的 DEBUG_INFO/DEBUG_ERROR 才能记录 */
+
+#ifdef PERF_STATS_ENABLE
+    PerfStats_Reset(); /* 清零热点计数并使能DWT */
+#endif                 /* PERF_STATS_ENABLE */
+
+#ifdef PERF_FRAME_ENABLE
+    PerfFrame_Reset(); /* 清零帧耗时统计并使能DWT */
+#endif                 /* PERF_FRAME_ENABLE */
+
 #ifdef LED_ENABLE
     LED_Init(); /* 初始化LED驱动，关闭所有LED */
 #endif          /* LED_ENABLE */
@@ -68,18 +375,32 @@ void init_all(void)
 #endif                 /* UI_ENCODER_ENABLE */
 
 #ifdef LCD_SPI_ENABLE
-    SPI_LCD_Init(); /* 初始化LCD SPI驱动 */
-#endif              /* LCD_SPI_ENABLE */
+    SPI_LCD_InitBegin(); /* 写入LCD控制器参数并退出休眠，不等待 */
+#endif                   /* LCD_SPI_ENABLE */
 
-
-#ifdef QSPI_FLASH_ENABLE
+    /* 以下在LCD退出休眠的120ms内完成，不再串行等待 */
+#if defined(QSPI_FLASH_ENABLE) && !defined(QSPI_XIP_ENABLE)
     QSPI_W25Qxx_Init(); /* 初始化QSPI Flash驱动 */
     QSPI_W25Qxx_MemoryMappedMode();
-#endif
+#endif /* XIP时已由 MX_XIP_Init() 完成映射 */
 
 #ifdef FLASH_FONT_ENABLE
-    FlashFont_Init();
+    FlashFont_Init(); /* 定义FLASH_FONT_LAZY_INIT时只解析目录，RAM索引由 main_while() 分步建立 */
+#endif
+#ifdef FONT_STREAM_ENABLE
+    FontStream_Init(NULL); /* USB协议栈初始化后再次调用，传入CDC发送函数 */
 #endif
+#if defined(LCD_SPI_ENABLE) && defined(USE_FLASH_FONT) && defined(LCD_SPLASH_IMAGE)
+    SPI_LCD_InitSplash(LCD_SPLASH_IMAGE); /* 显示关闭期间写入开机画面，点亮背光时直接显示 */
+#endif
+
+#ifdef LCD_SPI_ENABLE
+    SPI_LCD_InitEnd(); /* 等满剩余的退出休眠时间，打开显示和背光 */
+#endif                 /* LCD_SPI_ENABLE */
+
+#ifdef LCD_LVGL_ENABLE
+    LCD_LVGL_Init(); /* 初始化LVGL并注册显示设备 */
+#endif               /* LCD_LVGL_ENABLE */
 #ifdef DMIC_ENABLE
     DMIC_Init();
 #endif /* DMIC_ENABLE */
@@ -117,6 +438,76 @@ void init_all(void)
     LCD_DisplayText(0, 0, "这是一个测试，哈基米南北绿豆，stm32~");
     LCD_SetTextFont(12);
     LCD_DisplayText(0, 48, "这是一个测试，哈基米南北绿豆，stm32~");
+#if defined(LCD_BENCH_ENABLE) || defined(QSPI_BENCH_ENABLE) || defined(STRESS_BENCH_ENABLE)
+#ifdef FLASH_FONT_ENABLE
+    while (FlashFont_Idle()) /* 基准测试按索引建完后的稳态计时 */
+    {
+    }
+#endif
+#endif
+#ifdef QSPI_BENCH_ENABLE
+    QSPI_Bench_Run(); /* 结束后已按默认配置恢复映射模式 */
+    QSPI_Bench_Print();
+#endif
+#ifdef STRESS_BENCH_ENABLE
+    Stress_Bench_Run(); /* 混合负载基线，与 LCD_BENCH_ENABLE 同时定义时结果页被其覆盖 */
+    Stress_Bench_Print();
+    Stress_Bench_Show();
+#endif
+#ifdef LCD_BENCH_ENABLE
+    LCD_Bench_Run();   /* 覆盖上面的测试文字，结果由 main_while() 分页显示 */
+    LCD_Bench_Print();
+#endif
+
+    /*******************************************************************************
+     *                              周期任务注册
+     ******************************************************************************/
+    Sched_ResetStats();
+#ifdef LED_ENABLE
+    LED_Effect_Blink(1000); /* 原阻塞的 LED_Blink_All(1000)，改为后台闪烁 */
+    Sched_Add(LED_Task, SCHED_LED_MS);
+#endif
+#ifdef KEY_ENABLE
+#ifdef KEY_EXTI_ENABLE
+    Sched_Add(KEY_Task, 0); /* 只分发队列中的事件，中断唤醒后立即处理 */
+#else
+    Sched_Add(KEY_Task, SCHED_KEY_MS);
+#endif
+#endif
+#ifdef LCD_SPI_ENABLE
+    Sched_Add(LCD_QueueTask, 0);
+#endif
+#ifdef FLASH_FONT_ENABLE
+    Sched_Add(FlashFont_IdleTask, 0);
+#endif
+#ifdef FONT_STREAM_ENABLE
+    Sched_Add(FontStream_Task, 0);
+#endif
+#ifdef DEBUG_LOG_ENABLE
+    Sched_Add(DebugLog_IdleTask, 0);
+#endif
+#ifdef LCD_ANIM_ENABLE
+    Sched_Add(LCD_AnimTask, LCD_ANIM_FRAME_MS);
+#endif
+#ifdef LCD_MIRROR_ENABLE
+    Sched_Add(LCD_MirrorTask, LCD_MIRROR_TASK_MS);
+#endif
+#ifdef LCD_REMOTE_ENABLE
+    Sched_Add(LCD_RemoteTask, LCD_REMOTE_TASK_MS);
+#endif
+#ifdef LCD_CACHE_BALANCE_ENABLE
+    Sched_Add(LCD_CacheBalance_Task, LCD_CACHE_BALANCE_MS);
+#endif
+#if defined(LCD_SPI_ENABLE) && defined(LCD_PAGER_ENABLE)
+    Sched_Add(LCD_PagerTask, LCD_PAGER_MS);
+#endif
+#ifdef LCD_BENCH_ENABLE
+    Sched_Add(LCD_Bench_Task, SCHED_BENCH_MS);
+#endif
+#ifdef LCD_LVGL_ENABLE
+    sched_lvgl_id = Sched_Add(LCD_LVGL_TaskOnDemand, SCHED_LVGL_MS);
+#endif
+
     // RGB_LCD_SetColor(0xff333333);     /* 设置画笔色，使用自定义颜色 */
     // RGB_LCD_SetBackColor(0xffB9EDF8); /* 设置背景色，使用自定义颜色 */
     // RGB_LCD_Clear();                  /* 清屏，刷背景色 */
@@ -139,17 +530,27 @@ void init_all(void)
 
 /**
  * @brief  主循环周期任务
- * @note   在主函数 while(1) 中调用，驱动非阻塞任务
- * @note   建议调用间隔: 5~20ms
+ * @note   在主函数 while(1) 中连续调用，不需要额外延时；各任务按 init_all() 中注册的周期运行
+ * @note   任务都是非阻塞的，单次调用耗时取决于到期任务中最长的一步
+ * @note   定义 SCHED_IDLE_SLEEP 时没有工作就WFI睡眠，直到下一个中断
  *
- * @par    调用的任务列表：
- *         - KEY_Task(): 按键扫描（消抖、事件检测）
- *         - DIGITAL_SENSOR_Task(): 数字传感器扫描
- *         - UI_ENCODER_Poll(): UI编码器轮询（如果启用）
+ * @par    init_all() 注册的任务列表：
+ *         - LED_Task(): LED闪烁/呼吸/流水效果（SCHED_LED_MS）
+ *         - KEY_Task(): 按键扫描（消抖、事件检测，SCHED_KEY_MS；KEY_EXTI_ENABLE 时只分发中断中产生的事件，每次调用；LCD_RGB_TOUCH_ENABLE 时触摸事件同在此分发）
+ *         - LCD_Queue_Poll(): 执行屏幕命令队列（DMA空闲时取下一条，每次调用）
+ *         - FlashFont_Idle(): 分步建立字库RAM索引、校验字库各段CRC，提交和启动登记的字模预取（全部完成后立即返回，每次调用）
+ *         - LCD_Anim_Task(): 推进界面动画，只绘制变化的部分（如果启用，LCD_ANIM_FRAME_MS）
+ *         - LCD_Mirror_Task(): 把已上屏的脏区域编码为一个数据包交给镜像输出函数（如果启用，LCD_MIRROR_TASK_MS）
+ *         - LCD_Remote_Task(): 解析串口收到的远程文本数据包并排入命令队列，交还已画完的接收缓冲区（如果启用，LCD_REMOTE_TASK_MS）
+ *         - LCD_CacheBalance_Task(): 按未命中代价在字模缓存和像素缓存之间移动字节预算（如果启用，LCD_CACHE_BALANCE_MS）
+ *         - LCD_Pager_Task(): 对打开的长文档接着分页 LCD_PAGER_SLICE_LINES 行（如果启用，LCD_PAGER_MS）
+ *         - LCD_Bench_Task(): 基准测试结果分页显示（如果启用，SCHED_BENCH_MS）
+ *         - LCD_LVGL_Task(): LVGL定时器与渲染（如果启用，间隔取LVGL下次定时器到期时间，不超过 SCHED_LVGL_MAX_MS）
  *
  * @retval None
  */
 void main_while(void)
 {
-    LED_Blink_All(1000);
+    Sched_Run();
+    Sched_Idle();
 }
@@ -10,7 +10,8 @@
  * 使用说明：
  * 1. 在此文件中定义需要启用的外设模块（LED_ENABLE / KEY_ENABLE 等）
  * 2. 平台抽象宏（GPIO_WritePin等）默认映射到STM32 HAL库，可重定义以适配其他平台
- * 3. init_all() 完成所有外设初始化，main_while() 在主循环中周期调用
+ * 3. init_all() 完成所有外设初始化并注册周期任务，main_while() 在主循环中连续调用
+ * 4. 周期任务由协作式调度器按各自周期运行，任务函数必须非阻塞（不能调用Delay_ms）
  *
  ******************************************************************************
  */
@@ -33,22 +34,116 @@ extern "C"
  * @note  注释掉对应宏即可禁用该模块，减少代码体积
  */
 // #define DEBUG_ENABLE /*!< 调试输出使能 */
+// #define DEBUG_LOG_ENABLE /*!< 延迟输出的调试日志使能(DEBUG_INFO/DEBUG_ERROR 只写环形缓冲区，主循环空闲时输出)，优先于 DEBUG_ENABLE */
+// #define PERF_STATS_ENABLE /*!< 热点路径计数器使能(字模命中、SPI/QSPI字节数、阻塞周期) */
+// #define PERF_TRACE_ENABLE /*!< 渲染时间线事件记录使能(Chrome Trace格式导出) */
+// #define PERF_FRAME_ENABLE /*!< 帧耗时监视使能(按画面统计DWT周期、超预算记录) */
+// #define PERF_MEMORY_ENABLE /*!< 渲染/字库缓存内存占用报告使能(各缓存的区域、容量、用量、峰值和命中，可运行时调整上限) */
+// #define PERF_PROFILE_ENABLE /*!< 函数级周期剖析使能(按函数统计inclusive/exclusive周期)，需对要分析的源文件另加 --gnu_instrument 或 -finstrument-functions 编译选项 */
 #define LED_ENABLE /*!< LED驱动使能 */
 // #define KEY_ENABLE            /*!< 按键驱动使能 */
 // #define BUZZER_ENABLE         /*!< 蜂鸣器驱动使能 */
 // #define DIGITAL_SENSOR_ENABLE /*!< 数字传感器驱动使能 */
 // #define UI_ENCODER_ENABLE     /*!< UI编码器驱动使能 */
 #define LCD_SPI_ENABLE    /*!< LCD SPI驱动使能 */
-// #define LCD_RGB_ENABLE    /*!< LCD RGB驱动使能 */
-// #define LCD_RGB_TOUCH_ENABLE /*!< LCD RGB触摸驱动使能,触摸屏使用，必须先定义 LCD_RGB_ENABLE*/
+// #define LCD_RGB_ENABLE    /*!< LCD RGB驱动使能，与SPI屏共用字体引擎，必须优先定义LCD_SPI_ENABLE，并在stm32h7xx_hal_conf.h中使能HAL_LTDC_MODULE_ENABLED */
+// #define LCD_RGB_TOUCH_ENABLE /*!< LCD RGB触摸驱动使能(GT911，INT中断+DMA读取)，必须先定义 LCD_RGB_ENABLE，事件经按键队列分发，需定义 KEY_ENABLE 和 KEY_EXTI_ENABLE */
 #define QSPI_FLASH_ENABLE /*!< QSPI Flash驱动使能 */
 #define FLASH_FONT_ENABLE /*!< Flash字体驱动使能,必须优先定义QSPI_FLASH_ENABLE */
+// #define FONT_STREAM_ENABLE /*!< USB CDC/串口字库在线更新使能，必须优先定义FLASH_FONT_ENABLE，USB协议栈需另行加入工程 */
+// #define LCD_JPEG_ENABLE   /*!< 硬件JPEG解码显示使能，必须优先定义LCD_SPI_ENABLE，并在stm32h7xx_hal_conf.h中使能HAL_JPEG_MODULE_ENABLED */
+// #define LCD_LVGL_ENABLE   /*!< LVGL显示驱动使能，必须优先定义LCD_SPI_ENABLE，LVGL源码和lv_conf.h需另行加入工程 */
+// #define LCD_SPRITE_ENABLE /*!< 控件位图缓存使能(反复绘制的组合控件渲染一次后整块复制)，必须优先定义LCD_SPI_ENABLE，头文件由lcd_spi.h包含 */
+// #define LCD_POOL_ENABLE   /*!< 渲染子系统固定块内存池与帧内分配区使能(不使用malloc)，LCD_FrameEnd() 时清空分配区 */
+// #define LCD_ANIM_ENABLE   /*!< 界面动画使能(进度条、数值过渡、面板滑入，只绘制变化的部分)，必须优先定义LCD_SPI_ENABLE，头文件由lcd_spi.h包含 */
+// #define LCD_MIRROR_ENABLE /*!< 远程屏幕镜像使能(LCD_Flush() 发送的脏区域行程编码后经串口/USB CDC输出)，需在lcd_spi.h中定义LCD_FRAMEBUFFER_ENABLE，头文件由lcd_spi.h包含 */
+// #define LCD_REMOTE_ENABLE /*!< 远程文本显示协议使能(上位机经串口DMA发送字符编号串、坐标和样式号，不拷贝地排入命令队列)，需要UTF-8 Flash字库，头文件由lcd_spi.h包含 */
 // #define DMIC_ENABLE       /*!< INMP441数字麦克风驱动使能 */
 // #define OLED_HARD_ENABLE  /*!< OLED硬件I2C驱动使能 */
 // #define OLED_SOFT_ENABLE  /*!< OLED软件I2C驱动使能 */
 // #define SDMMC_ENABLE      /*!< SDMMC驱动使能 */
 // #define FATFS_ENABLE      /*!< SD卡的FATFS文件系统使能，必须优先定义SDMMC_ENABLE */
 // #define SDRAM_ENABLE      /*!< SDRAM驱动使能 */
+// #define LCD_BENCH_ENABLE  /*!< 渲染基准测试使能，上电后运行并在屏幕上显示结果，必须优先定义LCD_SPI_ENABLE和FLASH_FONT_ENABLE */
+// #define QSPI_BENCH_ENABLE /*!< QSPI映射读取基准测试使能，上电后扫描QSPI配置并输出到调试串口，必须优先定义QSPI_FLASH_ENABLE，不能与QSPI_XIP_ENABLE同时使用 */
+// #define STRESS_BENCH_ENABLE /*!< 混合负载压力测试使能，上电后运行跑马灯+趋势图+整页文字+按键翻页并输出帧率和延迟，必须优先定义LCD_SPI_ENABLE和FLASH_FONT_ENABLE，只支持UTF-8字库 */
+
+/*******************************************************************************
+ *                              字号裁剪
+ ******************************************************************************/
+/**
+ * @brief 编译进固件的字号(12/16/20/24/32)
+ * @note  未列出字号的内置字模、专用展开函数和Flash字库段描述都不编译/不解析，
+ *        字模缓存槽按启用的最大字号分配；LCD_SetTextFont() 选到未启用的字号时使用最小字号
+ * @note  fontbin_tool.py --sizes 生成只含这些字号的字库镜像(与 --pack 同用时不占Flash)
+ */
+#define FONT_SIZE_BIT(size) (1UL << ((size) / 4U)) /*!< 字号对应的位(12/16/20/24/32号为第3/4/5/6/8位) */
+#ifndef FONT_SIZES
+#define FONT_SIZES (FONT_SIZE_BIT(12) | FONT_SIZE_BIT(16) | FONT_SIZE_BIT(20) | FONT_SIZE_BIT(24) | FONT_SIZE_BIT(32)) /*!< 启用的字号，例如只用16/24号时为 (FONT_SIZE_BIT(16) | FONT_SIZE_BIT(24)) */
+#endif
+
+#if FONT_SIZES & FONT_SIZE_BIT(32)
+#define FONT_SIZE_MAX 32
+#elif FONT_SIZES & FONT_SIZE_BIT(24)
+#define FONT_SIZE_MAX 24
+#elif FONT_SIZES & FONT_SIZE_BIT(20)
+#define FONT_SIZE_MAX 20
+#elif FONT_SIZES & FONT_SIZE_BIT(16)
+#define FONT_SIZE_MAX 16
+#elif FONT_SIZES & FONT_SIZE_BIT(12)
+#define FONT_SIZE_MAX 12
+#else
+#error "FONT_SIZES 至少要包含12/16/20/24/32中的一个字号"
+#endif
+#if FONT_SIZES & FONT_SIZE_BIT(12)
+#define FONT_SIZE_MIN 12
+#elif FONT_SIZES & FONT_SIZE_BIT(16)
+#define FONT_SIZE_MIN 16
+#elif FONT_SIZES & FONT_SIZE_BIT(20)
+#define FONT_SIZE_MIN 20
+#elif FONT_SIZES & FONT_SIZE_BIT(24)
+#define FONT_SIZE_MIN 24
+#else
+#define FONT_SIZE_MIN 32
+#endif
+
+/**
+ * @brief 字号是否启用
+ * @note  只裁剪12/16/20/24/32这五个字号，字体族等其他字号的段照常使用
+ */
+#define FONT_SIZE_USED(size)                                                                     \
+    (((size) != 12 && (size) != 16 && (size) != 20 && (size) != 24 && (size) != 32) || \
+     (FONT_SIZES & FONT_SIZE_BIT(size)) != 0)
+
+/*******************************************************************************
+ *                              MDMA通道分配
+ ******************************************************************************/
+/**
+ * @brief 各模块使用的MDMA通道号(0~15)
+ * @note  HAL_MDMA_Init() 会按自己的请求源重新配置通道，两个模块共用一个通道时先初始化的一方失效，
+ *        因此通道号统一在这里分配，未启用的模块也保留其通道；改动时只能写十进制数字
+ */
+#define QSPI_MDMA_CH 0              /*!< QUADSPI间接模式DMA读写(quadspi.c) */
+#define GLYPH_PREFETCH_CH 1         /*!< 字模预取(glyph_prefetch.h) */
+#define LCD_FMC_MDMA_CH 2           /*!< FMC屏发送像素(lcd_spi.h) */
+#define FLASH_FONT_MIRROR_CH 3      /*!< 字库镜像到SDRAM(flash_font.h) */
+#define FLASH_FONT_PHASH_CH 4       /*!< 完美哈希段拷贝(flash_font.h) */
+#define LCD_IMAGE_MDMA_CH 5         /*!< LCD_DrawImage565() 搬运像素到SRAM4(lcd_spi.h) */
+#define MDMA_CHANNEL(n) MDMA_CHANNEL_(n) /*!< 通道号转换为 MDMA_Channeln */
+#define MDMA_CHANNEL_(n) MDMA_Channel##n
+
+#define MDMA_CH_BIT(n) (1UL << (n))
+#if QSPI_MDMA_CH > 15 || GLYPH_PREFETCH_CH > 15 || LCD_FMC_MDMA_CH > 15 || \
+    FLASH_FONT_MIRROR_CH > 15 || FLASH_FONT_PHASH_CH > 15 || LCD_IMAGE_MDMA_CH > 15
+#error "MDMA通道号只能是0~15"
+#endif
+#if (MDMA_CH_BIT(QSPI_MDMA_CH) | MDMA_CH_BIT(GLYPH_PREFETCH_CH) | MDMA_CH_BIT(LCD_FMC_MDMA_CH) |               \
+     MDMA_CH_BIT(FLASH_FONT_MIRROR_CH) | MDMA_CH_BIT(FLASH_FONT_PHASH_CH) | MDMA_CH_BIT(LCD_IMAGE_MDMA_CH)) != \
+    (MDMA_CH_BIT(QSPI_MDMA_CH) + MDMA_CH_BIT(GLYPH_PREFETCH_CH) + MDMA_CH_BIT(LCD_FMC_MDMA_CH) +               \
+     MDMA_CH_BIT(FLASH_FONT_MIRROR_CH) + MDMA_CH_BIT(FLASH_FONT_PHASH_CH) + MDMA_CH_BIT(LCD_IMAGE_MDMA_CH))
+#error "QSPI、字模预取、FMC屏、字库镜像、完美哈希、图片搬运的MDMA通道号必须互不相同"
+#endif
+
 /*******************************************************************************
  *                              头文件包含（自动包含）
  ******************************************************************************/
@@ -100,6 +195,14 @@ extern "C"
 #include "QSPI/qspi_flash.h"
 #endif
 
+#ifdef LCD_JPEG_ENABLE
+#include "JPEG/lcd_jpeg.h"
+#endif
+
+#ifdef LCD_LVGL_ENABLE
+#include "LVGL/lcd_lvgl.h"
+#endif
+
 #ifdef DMIC_ENABLE
 #include "I2S/dmic.h"
 #endif /* DMIC_ENABLE */
@@ -123,21 +226,149 @@ extern "C"
 #include "SDIO/sdmmc_sd.h"
 #endif
 
+#if defined(FATFS_ENABLE) && defined(FLASH_FONT_ENABLE)
+#include "QSPI/font_install.h"
+#endif
+
+#ifdef FONT_STREAM_ENABLE
+#include "QSPI/font_stream.h"
+#endif
+
 #ifdef SDRAM_ENABLE
 #include "FMC/sdram.h"
 #endif
 
-#ifdef DEBUG_ENABLE
+#ifdef LCD_BENCH_ENABLE
+#include "BENCH/lcd_bench.h"
+#endif
+
+#ifdef QSPI_BENCH_ENABLE
+#include "BENCH/qspi_bench.h"
+#endif
+
+#ifdef STRESS_BENCH_ENABLE
+#include "BENCH/stress_bench.h"
+#endif
+
+#ifdef DEBUG_LOG_ENABLE
+#include "DEBUG/debug_log.h"
+#elif defined(DEBUG_ENABLE)
 #include "DEBUG/debug.h"
 #else /* DEBUG_ENABLE 未定义 */
 #define Debug_Init() ((void)0)
 #define DEBUG_INFO(msg) ((void)0)
 #define DEBUG_ERROR(msg) ((void)0)
 #endif /* DEBUG_ENABLE */
+
+#ifdef PERF_STATS_ENABLE
+#include "PERF/perf_stats.h"
+#else /* PERF_STATS_ENABLE 未定义 */
+#define PERF_COUNT(field) ((void)0)
+#define PERF_ADD(field, n) ((void)0)
+#define PERF_TIMER_START(t) ((void)0)
+#define PERF_TIMER_STOP(field, t) ((void)0)
+#define PerfStats_Reset() ((void)0)
+#endif /* PERF_STATS_ENABLE */
+
+#ifdef PERF_TRACE_ENABLE
+#include "PERF/perf_trace.h"
+#else /* PERF_TRACE_ENABLE 未定义 */
+#define PERF_TRACE_BEGIN(ev, arg) ((void)0)
+#define PERF_TRACE_END(ev, arg) ((void)0)
+#define PERF_TRACE_MARK(ev, arg) ((void)0)
+#endif /* PERF_TRACE_ENABLE */
+
+#ifdef PERF_FRAME_ENABLE
+#include "PERF/perf_frame.h"
+#else /* PERF_FRAME_ENABLE 未定义 */
+#define LCD_FrameBegin(screen) ((void)0)
+#define LCD_FrameEnd() ((void)0)
+#endif /* PERF_FRAME_ENABLE */
+
+#ifdef PERF_MEMORY_ENABLE
+#include "PERF/perf_memory.h"
+#endif /* PERF_MEMORY_ENABLE */
+
+#ifdef PERF_PROFILE_ENABLE
+#include "PERF/perf_profile.h"
+#endif /* PERF_PROFILE_ENABLE */
+
+#ifdef LCD_POOL_ENABLE
+#include "SPI/lcd_pool.h"
+#undef LCD_FrameEnd
+#ifdef PERF_FRAME_ENABLE
+#define LCD_FrameEnd() (LCD_Arena_Reset(), PerfFrame_End()) /*!< 结束一帧并清空帧内分配区 */
+#else
+#define LCD_FrameEnd() LCD_Arena_Reset() /*!< 结束一帧，清空帧内分配区 */
+#endif
+#endif /* LCD_POOL_ENABLE */
     /*******************************************************************************
      *                              平台抽象层宏
      ******************************************************************************/
 
+/**
+ * @brief 紧耦合存储器(TCM)放置
+ * @note  ITCM(0x00000000, 64KB)和DTCM(0x20000000, 128KB)零等待访问，不经过Cache
+ * @note  需使用分散加载文件 MDK-ARM/auto_stm32_test_tcm.sct，ITCM代码在启动时由 __main 从Flash拷贝
+ * @note  DMA只能访问AXI SRAM/SRAM4的缓冲区(如BDMA发送的 LCD_Buff)不能放入DTCM
+ */
+#define TCM_ENABLE /*!< 定义了：热点函数放入ITCM、CPU专用缓冲区放入DTCM, 注释后：按链接器默认位置存放 */
+
+#ifndef ITCM_CODE
+#ifdef TCM_ENABLE
+#define ITCM_CODE __attribute__((section(".itcm_text"))) /*!< 函数放入ITCM */
+#else
+#define ITCM_CODE
+#endif
+#endif
+
+#ifndef DTCM_BSS
+#ifdef TCM_ENABLE
+#define DTCM_BSS __attribute__((section(".dtcm_bss"), zero_init)) /*!< 未初始化(清零)变量放入DTCM */
+#else
+#define DTCM_BSS
+#endif
+#endif
+
+/**
+ * @brief QSPI就地执行(XIP)放置
+ * @note  需在qspi_flash.h中定义 QSPI_XIP_ENABLE，代码区与字库数据区的划分见该文件
+ * @note  放入QSPI的代码在 MX_XIP_Init() 打开内存映射之前不能调用
+ */
+#ifndef QSPI_CODE
+#ifdef QSPI_XIP_ENABLE
+#define QSPI_CODE __attribute__((section(".qspi_text"))) /*!< 函数放入QSPI代码区执行 */
+#else
+#define QSPI_CODE
+#endif
+#endif
+
+#ifndef QSPI_RODATA
+#ifdef QSPI_XIP_ENABLE
+#define QSPI_RODATA __attribute__((section(".qspi_rodata"))) /*!< 常量表放入QSPI代码区 */
+#else
+#define QSPI_RODATA
+#endif
+#endif
+
+/**
+ * @brief DMA缓冲区放置
+ * @note  D3域的SRAM4(0x38000000, 64KB)是BDMA唯一能访问的内存，SPI6发送缓冲区放在这里；
+ *        AXI SRAM(0x24000000, 512KB)供MDMA、DMA1/2、DMA2D、SDMMC的IDMA访问；DTCM只有MDMA能访问
+ * @note  这两块内存都经过D-Cache，按地址清理/失效以32字节Cache行为单位：
+ *        DMA读取前 SCB_CleanDCache_by_Addr() 写回CPU写入的数据，DMA写入后
+ *        SCB_InvalidateDCache_by_Addr() 丢弃旧行；缓冲区首尾不满一行时会连带相邻变量，
+ *        因此DMA缓冲区一律按Cache行对齐，长度取整到32字节
+ * @note  地址分配见 README 的"内存布局"，各模块的 _ATTR 宏可改为其他地址
+ */
+#define DMA_CACHE_LINE 32U /*!< D-Cache行字节数 */
+#define DMA_ALIGNED __attribute__((aligned(32))) /*!< 按Cache行对齐 */
+#define DMA_LINE_ROUND(n) (((n) + DMA_CACHE_LINE - 1U) & ~(DMA_CACHE_LINE - 1U)) /*!< 字节数取整到Cache行 */
+#define SRAM4_AT(addr) SRAM4_AT_(addr) /*!< 放到SRAM4的指定地址(BDMA可访问)，地址可以是展开为不带后缀十六进制数的宏 */
+#define SRAM4_AT_(addr) __attribute__((section(".ARM.__at_" #addr), zero_init, aligned(32)))
+#define AXI_SRAM_AT(addr) AXI_SRAM_AT_(addr) /*!< 放到AXI SRAM的指定地址(MDMA/DMA1/2可访问)，地址可以是展开为不带后缀十六进制数的宏 */
+#define AXI_SRAM_AT_(addr) __attribute__((section(".ARM.__at_" #addr), zero_init, aligned(32)))
+
 #ifndef GPIO_WritePin
 #define GPIO_WritePin(port, pin, state) HAL_GPIO_WritePin((port), (pin), (state))
 #endif
@@ -181,6 +412,47 @@ extern "C"
     } while (0)
 #endif
 
+/*******************************************************************************
+ *                              协作式任务调度
+ ******************************************************************************/
+/**
+ * @brief 主循环任务表与各任务周期
+ * @note  周期为0的任务每次 main_while() 都运行（内部自带空闲判断的任务，如命令队列）
+ * @note  任务超时不补跑：错过的周期直接顺延，避免阻塞后连续多次调用
+ */
+#define SCHED_MAX_TASKS 8  /*!< 任务表容量 */
+#define SCHED_LED_MS 1     /*!< LED效果任务周期(毫秒)，呼吸效果的软件PWM按1ms分级 */
+#define SCHED_KEY_MS 10    /*!< 按键扫描周期(毫秒)，KEY_Task建议5~20ms */
+#define SCHED_LVGL_MS 5    /*!< LVGL任务周期(毫秒) */
+#define SCHED_BENCH_MS 100 /*!< 基准测试分页任务周期(毫秒)，翻页间隔由 LCD_BENCH_PAGE_MS 决定 */
+#define SCHED_LVGL_MAX_MS 50 /*!< LVGL按需渲染时两次调用的最长间隔(毫秒)，实际间隔取 lv_timer_handler() 的返回值 */
+
+/**
+ * @brief 空闲睡眠
+ * @note  一轮任务结束后，若没有到期的周期任务、本轮也没有任务或中断调用 Sched_Kick()（命令队列非空、字库后台
+ *        工作未完成、新的按键事件等），执行WFI进入Sleep模式，由SysTick(1ms)或任意外设中断唤醒；
+ *        DMA和定时器在Sleep模式下照常工作
+ * @note  不使用Stop模式：Stop模式会停掉PLL、SysTick和TIM1(LED硬件波形)，唤醒后还要重新配置时钟
+ */
+#define SCHED_IDLE_SLEEP /*!< 定义了：空闲时WFI睡眠, 注释后：主循环空转 */
+
+    /**
+     * @brief 调度器统计
+     * @note  主循环负载 = active_cycles / (经过的毫秒数 * SystemCoreClock / 1000)，不含中断服务函数
+     */
+    typedef struct
+    {
+        uint32_t passes;        /*!< main_while() 调用次数 */
+        uint32_t sleeps;        /*!< 进入WFI的次数 */
+        uint32_t active_cycles; /*!< Sched_Run() 中运行任务的CPU周期(DWT计数，累计) */
+        uint32_t start_tick;    /*!< 统计开始时的系统节拍 */
+    } Sched_Stats;
+
+    /**
+     * @brief 周期任务函数类型，必须非阻塞，每次调用只做一步
+     */
+    typedef void (*Sched_TaskFunc)(void);
+
     /*******************************************************************************
      *                              导出函数
      ******************************************************************************/
@@ -200,6 +472,65 @@ extern "C"
      */
     void main_while(void);
 
+    /**
+     * @brief  注册周期任务
+     * @param  func: 任务函数
+     * @param  period_ms: 调用周期（毫秒），0表示每次 main_while() 都调用
+     * @note   同一时刻到期的任务按注册顺序运行，注册后下一次 main_while() 即首次运行
+     * @retval 任务号(>=0)，任务表已满或func为空时返回-1
+     */
+    int8_t Sched_Add(Sched_TaskFunc func, uint32_t period_ms);
+
+    /**
+     * @brief  修改任务周期，从当前时刻重新计时
+     * @param  id: Sched_Add() 返回的任务号
+     * @param  period_ms: 新周期（毫秒）
+     * @retval None
+     */
+    void Sched_SetPeriod(int8_t id, uint32_t period_ms);
+
+    /**
+     * @brief  注销任务，任务号之后可被重新分配
+     * @param  id: Sched_Add() 返回的任务号
+     * @retval None
+     */
+    void Sched_Remove(int8_t id);
+
+    /**
+     * @brief  运行所有到期的任务，每个任务最多一次
+     * @note   由 main_while() 调用，也可在自定义主循环中直接调用
+     * @retval None
+     */
+    void Sched_Run(void);
+
+    /**
+     * @brief  空闲时进入睡眠
+     * @note   由 main_while() 在 Sched_Run() 之后调用；在关中断状态下检查有无工作再执行WFI，
+     *         检查之后到来的中断仍会立即唤醒，不会睡过一个事件
+     * @retval 1=进入过睡眠，0=有工作未睡眠
+     */
+    uint8_t Sched_Idle(void);
+
+    /**
+     * @brief  通知调度器还有工作，本轮结束后不要睡眠
+     * @note   可在任务或中断中调用；周期为0、每次调用只做一部分工作的任务在还有剩余时调用
+     * @retval None
+     */
+    void Sched_Kick(void);
+
+    /**
+     * @brief  读取调度器统计
+     * @param  st: 输出
+     * @retval None
+     */
+    void Sched_GetStats(Sched_Stats *st);
+
+    /**
+     * @brief  清零调度器统计，从当前时刻重新开始
+     * @retval None
+     */
+    void Sched_ResetStats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,7 @@
  * @param  ev: 事件类型（KEY_Event枚举值）
  * @note   此函数覆盖key.c中的弱符号默认实现
  * @note   使用if判断按键ID，switch判断事件类型
+ * @note   由 KEY_Task() 在主循环中调用，不要在这里调用阻塞函数（如 LED_Blink_All）
  * @retval None
  */
 #ifdef KEY_ENABLE
@@ -38,30 +39,187 @@ void KEY_EventHandler(KEY_ID id, KEY_Event ev)
             break;
 
         case KEY_EV_CLICK:
-            /* 单击事件：闪烁LED一次（示例） */
-            {
-                LED_Blink_All(1000);
-            }
+            /* 单击事件：LED慢闪（示例） */
+            LED_Effect_Blink(1000);
             break;
 
         case KEY_EV_DOUBLE_CLICK:
-            /* 双击事件：闪烁LED两次（示例） */
-            {
-                LED_Blink_All(1000);
-                LED_Blink_All(1000);
-            }
+            /* 双击事件：LED快闪（示例） */
+            LED_Effect_Blink(250);
             break;
 
         case KEY_EV_LONG_PRESS:
-            /* 长按事件：闪烁LED三次（示例） */
-            {
-                LED_Blink_All(1000);
-                LED_Blink_All(1000);
-                LED_Blink_All(1000);
-            }
+            /* 长按事件：LED呼吸（示例） */
+            LED_Effect_Breathe(2000);
             break;
         }
     }
     /* 若有更多按键，在此添加 else if (id == KEY2) { ... } */
 }
+
+#ifdef KEY_EXTI_ENABLE
+/**
+ * @brief  EXTI边沿回调
+ * @param  GPIO_Pin: 触发的引脚
+ * @note   按键引脚的边沿启动扫描定时器，消抖和事件识别在定时器中断中完成
+ * @retval None
+ */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    KEY_EXTI_Handler(GPIO_Pin);
+}
+#endif // KEY_EXTI_ENABLE
 #endif // KEY_ENABLE
+
+#ifdef LCD_RGB_TOUCH_ENABLE
+/**
+ * @brief  I2C寄存器读取完成回调
+ * @param  hi2c: I2C句柄
+ * @note   触摸INT中断启动的DMA读取结束后调用，解析触点并产生触摸事件
+ * @retval None
+ */
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    Touch_RxCpltHandler(hi2c);
+}
+
+/**
+ * @brief  I2C寄存器写入完成回调
+ * @param  hi2c: I2C句柄
+ * @note   触摸芯片状态清除后调用，期间又收到INT时开始下一次读取
+ * @retval None
+ */
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    Touch_TxCpltHandler(hi2c);
+}
+
+/**
+ * @brief  I2C错误回调
+ * @param  hi2c: I2C句柄
+ * @retval None
+ */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    Touch_ErrorHandler(hi2c);
+}
+#endif // LCD_RGB_TOUCH_ENABLE
+
+#ifdef LCD_SPI_ENABLE
+/**
+ * @brief  SPI发送完成回调
+ * @param  hspi: SPI句柄
+ * @note   LCD_WriteBuff 使用DMA时，由SPI6中断在传输结束后调用
+ * @retval None
+ */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    LCD_SPI_TxCpltHandler(hspi);
+}
+
+/**
+ * @brief  SPI错误回调
+ * @param  hspi: SPI句柄
+ * @note   传输出错时同样释放LCD缓冲区，避免 LCD_WaitIdle 等到超时
+ * @retval None
+ */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+    LCD_SPI_TxCpltHandler(hspi);
+}
+#endif // LCD_SPI_ENABLE
+
+#ifdef LCD_JPEG_ENABLE
+/**
+ * @brief  JPEG帧头解析完成回调
+ * @param  hjpeg: JPEG句柄
+ * @param  pInfo: 图片信息
+ * @note   LCD_JPEG_Draw 据此确定MCU格式
+ * @retval None
+ */
+void HAL_JPEG_InfoReadyCallback(JPEG_HandleTypeDef *hjpeg, JPEG_ConfTypeDef *pInfo)
+{
+    LCD_JPEG_InfoHandler(hjpeg, pInfo);
+}
+
+/**
+ * @brief  JPEG输入数据用完回调
+ * @param  hjpeg: JPEG句柄
+ * @param  NbDecodedData: 已送入解码器的字节数
+ * @retval None
+ */
+void HAL_JPEG_GetDataCallback(JPEG_HandleTypeDef *hjpeg, uint32_t NbDecodedData)
+{
+    LCD_JPEG_GetDataHandler(hjpeg, NbDecodedData);
+}
+
+/**
+ * @brief  JPEG输出缓冲区已满/解码结束回调
+ * @param  hjpeg: JPEG句柄
+ * @param  pDataOut: MCU数据
+ * @param  OutDataLength: 字节数
+ * @note   LCD_JPEG_Draw 在此把MCU转换为RGB565并写屏
+ * @retval None
+ */
+void HAL_JPEG_DataReadyCallback(JPEG_HandleTypeDef *hjpeg, uint8_t *pDataOut, uint32_t OutDataLength)
+{
+    LCD_JPEG_DataReadyHandler(hjpeg, pDataOut, OutDataLength);
+}
+#endif // LCD_JPEG_ENABLE
+
+#ifdef QSPI_FLASH_ENABLE
+/**
+ * @brief  QSPI接收完成回调
+ * @param  hqspi: QSPI句柄
+ * @note   QSPI_W25Qxx_ReadBuffer_DMA 每段传输结束后调用
+ * @retval None
+ */
+void HAL_QSPI_RxCpltCallback(QSPI_HandleTypeDef *hqspi)
+{
+    QSPI_W25Qxx_RxCpltHandler(hqspi);
+}
+
+/**
+ * @brief  QSPI命令完成回调
+ * @param  hqspi: QSPI句柄
+ * @note   QSPI_W25Qxx_WriteBuffer_Async / QSPI_W25Qxx_Erase_Async 写使能、擦除命令完成后调用
+ * @retval None
+ */
+void HAL_QSPI_CmdCpltCallback(QSPI_HandleTypeDef *hqspi)
+{
+    QSPI_W25Qxx_CmdCpltHandler(hqspi);
+}
+
+/**
+ * @brief  QSPI发送完成回调
+ * @param  hqspi: QSPI句柄
+ * @note   QSPI_W25Qxx_WriteBuffer_Async 每页数据发送完成后调用
+ * @retval None
+ */
+void HAL_QSPI_TxCpltCallback(QSPI_HandleTypeDef *hqspi)
+{
+    QSPI_W25Qxx_TxCpltHandler(hqspi);
+}
+
+/**
+ * @brief  QSPI状态匹配回调
+ * @param  hqspi: QSPI句柄
+ * @note   QSPI_W25Qxx_WriteBuffer_Async 每页编程结束、QSPI_W25Qxx_Erase_Async 擦除结束(BUSY清零)后调用
+ * @retval None
+ */
+void HAL_QSPI_StatusMatchCallback(QSPI_HandleTypeDef *hqspi)
+{
+    QSPI_W25Qxx_StatusMatchHandler(hqspi);
+}
+
+/**
+ * @brief  QSPI错误回调
+ * @param  hqspi: QSPI句柄
+ * @note   DMA读取或异步写入出错时结束本次传输并通知调用者
+ * @retval None
+ */
+void HAL_QSPI_ErrorCallback(QSPI_HandleTypeDef *hqspi)
+{
+    QSPI_W25Qxx_ErrorHandler(hqspi);
+}
+#endif // QSPI_FLASH_ENABLE
@@ -29,6 +29,7 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
+#include "init.h"
 
 /* USER CODE END Includes */
 
@@ -37,6 +38,7 @@ extern "C" {
 /* USER CODE END Private defines */
 
 /* USER CODE BEGIN Prototypes */
+void MX_XIP_Init(void);
 
 /* USER CODE END Prototypes */
 
@@ -35,6 +35,7 @@ extern "C" {
 extern QSPI_HandleTypeDef hqspi;
 
 /* USER CODE BEGIN Private defines */
+extern MDMA_HandleTypeDef hmdma_quadspi_fifo_th;
 
 /* USER CODE END Private defines */
 
@@ -55,7 +55,11 @@ void SVC_Handler(void);
 void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
+void SPI6_IRQHandler(void);
+void BDMA_Channel0_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void QUADSPI_IRQHandler(void);
+void MDMA_IRQHandler(void);
 
 /* USER CODE END EFP */
 
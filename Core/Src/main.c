@@ -100,6 +100,7 @@ int main(void)
   MX_SPI6_Init();
   MX_QUADSPI_Init();
   /* USER CODE BEGIN 2 */
+  MX_XIP_Init();
   init_all();
   /* USER CODE END 2 */
 
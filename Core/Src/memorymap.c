@@ -26,4 +26,19 @@
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief  打开QSPI内存映射，供就地执行(XIP)的代码和字库使用
+  * @note   必须在调用任何 QSPI_CODE 函数之前执行，未定义 QSPI_XIP_ENABLE 时为空
+  */
+void MX_XIP_Init(void)
+{
+#ifdef QSPI_XIP_ENABLE
+  if (QSPI_W25Qxx_Init() != QSPI_W25Qxx_OK ||
+      QSPI_W25Qxx_MemoryMappedMode() != QSPI_W25Qxx_OK)
+  {
+    Error_Handler();
+  }
+#endif
+}
+
 /* USER CODE END 1 */
@@ -21,7 +21,9 @@
 #include "quadspi.h"
 
 /* USER CODE BEGIN 0 */
+#include "init.h"
 
+MDMA_HandleTypeDef hmdma_quadspi_fifo_th;
 /* USER CODE END 0 */
 
 QSPI_HandleTypeDef hqspi;
@@ -111,7 +113,34 @@ void HAL_QSPI_MspInit(QSPI_HandleTypeDef* qspiHandle)
     HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
 
   /* USER CODE BEGIN QUADSPI_MspInit 1 */
+    /* QUADSPI MDMA Init: 间接模式DMA读写, 方向由HAL_QSPI_Receive_DMA/Transmit_DMA切换 */
+    __HAL_RCC_MDMA_CLK_ENABLE();
+    hmdma_quadspi_fifo_th.Instance = MDMA_CHANNEL(QSPI_MDMA_CH); /* 通道号见 init.h 的"MDMA通道分配" */
+    hmdma_quadspi_fifo_th.Init.Request = MDMA_REQUEST_QUADSPI_FIFO_TH;
+    hmdma_quadspi_fifo_th.Init.TransferTriggerMode = MDMA_BUFFER_TRANSFER;
+    hmdma_quadspi_fifo_th.Init.Priority = MDMA_PRIORITY_HIGH;
+    hmdma_quadspi_fifo_th.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+    hmdma_quadspi_fifo_th.Init.SourceInc = MDMA_SRC_INC_DISABLE;
+    hmdma_quadspi_fifo_th.Init.DestinationInc = MDMA_DEST_INC_BYTE;
+    hmdma_quadspi_fifo_th.Init.SourceDataSize = MDMA_SRC_DATASIZE_BYTE;
+    hmdma_quadspi_fifo_th.Init.DestDataSize = MDMA_DEST_DATASIZE_BYTE;
+    hmdma_quadspi_fifo_th.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+    hmdma_quadspi_fifo_th.Init.BufferTransferLength = 32; /* 与FifoThreshold一致 */
+    hmdma_quadspi_fifo_th.Init.SourceBurst = MDMA_SOURCE_BURST_SINGLE;
+    hmdma_quadspi_fifo_th.Init.DestBurst = MDMA_DEST_BURST_SINGLE;
+    hmdma_quadspi_fifo_th.Init.SourceBlockAddressOffset = 0;
+    hmdma_quadspi_fifo_th.Init.DestBlockAddressOffset = 0;
+    if (HAL_MDMA_Init(&hmdma_quadspi_fifo_th) != HAL_OK)
+    {
+      Error_Handler();
+    }
+    __HAL_LINKDMA(qspiHandle, hmdma, hmdma_quadspi_fifo_th);
 
+    /* QUADSPI/MDMA interrupt Init */
+    HAL_NVIC_SetPriority(QUADSPI_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
+    HAL_NVIC_SetPriority(MDMA_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(MDMA_IRQn);
   /* USER CODE END QUADSPI_MspInit 1 */
   }
 }
@@ -141,7 +170,8 @@ void HAL_QSPI_MspDeInit(QSPI_HandleTypeDef* qspiHandle)
                           |GPIO_PIN_9);
 
   /* USER CODE BEGIN QUADSPI_MspDeInit 1 */
-
+    HAL_MDMA_DeInit(qspiHandle->hmdma);
+    HAL_NVIC_DisableIRQ(QUADSPI_IRQn);
   /* USER CODE END QUADSPI_MspDeInit 1 */
   }
 }
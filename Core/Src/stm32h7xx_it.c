@@ -22,6 +22,7 @@
 #include "stm32h7xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "init.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -55,8 +56,12 @@
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
+extern DMA_HandleTypeDef hdma_spi6_tx;
+extern SPI_HandleTypeDef hspi6;
 
 /* USER CODE BEGIN EV */
+extern QSPI_HandleTypeDef hqspi;
+extern MDMA_HandleTypeDef hmdma_quadspi_fifo_th;
 
 /* USER CODE END EV */
 
@@ -198,6 +203,148 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32h7xx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles SPI6 global interrupt.
+  */
+void SPI6_IRQHandler(void)
+{
+  /* USER CODE BEGIN SPI6_IRQn 0 */
+
+  /* USER CODE END SPI6_IRQn 0 */
+  HAL_SPI_IRQHandler(&hspi6);
+  /* USER CODE BEGIN SPI6_IRQn 1 */
+
+  /* USER CODE END SPI6_IRQn 1 */
+}
+
+/**
+  * @brief This function handles BDMA channel0 global interrupt.
+  */
+void BDMA_Channel0_IRQHandler(void)
+{
+  /* USER CODE BEGIN BDMA_Channel0_IRQn 0 */
+
+  /* USER CODE END BDMA_Channel0_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_spi6_tx);
+  /* USER CODE BEGIN BDMA_Channel0_IRQn 1 */
+
+  /* USER CODE END BDMA_Channel0_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles QUADSPI global interrupt.
+  */
+void QUADSPI_IRQHandler(void)
+{
+  HAL_QSPI_IRQHandler(&hqspi);
+}
+
+/**
+  * @brief This function handles MDMA global interrupt.
+  */
+void MDMA_IRQHandler(void)
+{
+  HAL_MDMA_IRQHandler(&hmdma_quadspi_fifo_th);
+#if defined(FLASH_FONT_ENABLE) && defined(GLYPH_CACHE_ENABLE) && defined(GLYPH_PREFETCH_ENABLE)
+  GlyphPrefetch_IRQHandler();
+#endif
+#if defined(FLASH_FONT_ENABLE) && defined(FLASH_FONT_MIRROR_ENABLE)
+  FlashFont_MirrorIRQHandler();
+#endif
+#if defined(LCD_SPI_ENABLE) && defined(LCD_FMC_ENABLE)
+  LCD_FMC_IRQHandler();
+#endif
+}
+
+#if (defined(KEY_ENABLE) && defined(KEY_EXTI_ENABLE)) || (defined(LCD_SPI_ENABLE) && defined(LCD_TE_ENABLE)) || defined(LCD_RGB_TOUCH_ENABLE)
+/**
+  * @brief EXTI lines shared by KEY_LIST, the LCD TE pin and the touch INT pin, each handler only clears its own pins.
+  */
+static void EXTI_Shared_IRQHandler(void)
+{
+#if defined(LCD_SPI_ENABLE) && defined(LCD_TE_ENABLE)
+  LCD_TE_IRQHandler();
+#endif
+#ifdef LCD_RGB_TOUCH_ENABLE
+  Touch_EXTI_IRQHandler();
+#endif
+#if defined(KEY_ENABLE) && defined(KEY_EXTI_ENABLE)
+  KEY_EXTI_IRQHandler();
+#endif
+}
+
+void EXTI0_IRQHandler(void)
+{
+  EXTI_Shared_IRQHandler();
+}
+
+void EXTI1_IRQHandler(void)
+{
+  EXTI_Shared_IRQHandler();
+}
+
+void EXTI2_IRQHandler(void)
+{
+  EXTI_Shared_IRQHandler();
+}
+
+void EXTI3_IRQHandler(void)
+{
+  EXTI_Shared_IRQHandler();
+}
+
+void EXTI4_IRQHandler(void)
+{
+  EXTI_Shared_IRQHandler();
+}
+
+void EXTI9_5_IRQHandler(void)
+{
+  EXTI_Shared_IRQHandler();
+}
+
+void EXTI15_10_IRQHandler(void)
+{
+  EXTI_Shared_IRQHandler();
+}
+
+#endif
+
+#if defined(KEY_ENABLE) && defined(KEY_EXTI_ENABLE)
+/**
+  * @brief This function handles the key scan timer (TIM6) interrupt.
+  */
+void TIM6_DAC_IRQHandler(void)
+{
+  KEY_TIM_IRQHandler();
+}
+#endif
+
+#ifdef LCD_RGB_TOUCH_ENABLE
+/**
+  * @brief This function handles the touch I2C event interrupt.
+  */
+void I2C1_EV_IRQHandler(void)
+{
+  Touch_IIC_EV_IRQHandler();
+}
+
+/**
+  * @brief This function handles the touch I2C error interrupt.
+  */
+void I2C1_ER_IRQHandler(void)
+{
+  Touch_IIC_ER_IRQHandler();
+}
+
+/**
+  * @brief This function handles the touch I2C RX DMA stream interrupt.
+  */
+void DMA1_Stream0_IRQHandler(void)
+{
+  Touch_IIC_DMA_IRQHandler();
+}
+#endif
 
 /* USER CODE END 1 */
@@ -0,0 +1,884 @@
+/**
+ ******************************************************************************
+ * @file    sim_hal.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   主机仿真：HAL替身、ST7789屏幕模型与字库映射实现
+ ******************************************************************************
+ * @attention
+ *
+ * 实现方式：
+ * - SPI阻塞传输立即把数据交给屏幕模型
+ * - SPI DMA传输只记录缓冲区，等CPU下一次调用 HAL_GetTick()(LCD_WaitIdle
+ *   的等待循环)时才读取并完成，模拟后台发送：缓冲区在完成前被改写会
+ *   直接体现在输出图像上
+ * - 同色填充(源地址固定)的DMA传输重复发送缓冲区开头的一个像素
+ * - MDMA链表传输在启动时同步拷贝，随后调用完成回调；轮询传输同样在启动时完成
+ * - DMA2D填充、格式转换(含L8/L4颜色表)和混合在启动时同步完成，RGB565输入按硬件的方式用高位补齐低位
+ * - 字库文件以 MAP_PRIVATE 映射，在线更新写入的数据不会改动原文件
+ *
+ ******************************************************************************
+ */
+
+#include "sim_hal.h"
+#include "init.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ *                              外设实例
+ ******************************************************************************/
+
+GPIO_TypeDef g_gpio[8]; // GPIOA~GPIOI(无F)，地址为常量，可用于静态初始化
+
+static SPI_TypeDef g_spi6_regs;
+SPI_HandleTypeDef hspi6;
+QSPI_HandleTypeDef hqspi;
+
+static MDMA_Channel_TypeDef g_mdma_regs[6];
+MDMA_Channel_TypeDef *MDMA_Channel0 = &g_mdma_regs[0],
+                     *MDMA_Channel1 = &g_mdma_regs[1],
+                     *MDMA_Channel2 = &g_mdma_regs[2],
+                     *MDMA_Channel3 = &g_mdma_regs[3],
+                     *MDMA_Channel4 = &g_mdma_regs[4],
+                     *MDMA_Channel5 = &g_mdma_regs[5];
+
+uint32_t g_bkpsram[1024];
+
+static DMA2D_TypeDef g_dma2d_regs;
+DMA2D_TypeDef *DMA2D = &g_dma2d_regs;
+
+static DWT_Type g_dwt;
+static CoreDebug_Type g_core_debug;
+DWT_Type *DWT = &g_dwt;
+CoreDebug_Type *CoreDebug = &g_core_debug;
+
+uint32_t SystemCoreClock = 480000000;
+
+/*******************************************************************************
+ *                              屏幕模型
+ ******************************************************************************/
+
+static uint16_t g_frame[SIM_PANEL_DIM * SIM_PANEL_DIM]; /*!< 显存模型 */
+static Sim_Stats_t g_stats;
+
+static uint8_t g_dc = 0;       /*!< 数据指令选择引脚电平 */
+static uint8_t g_cmd = 0;      /*!< 当前指令 */
+static uint8_t g_argc = 0;     /*!< 当前指令已收到的参数字节数 */
+static uint16_t g_col[2], g_row[2]; /*!< 窗口 */
+static uint16_t g_cx, g_cy;    /*!< 写入位置 */
+static uint8_t g_hi, g_half;   /*!< 像素高字节及是否已收到 */
+static uint8_t g_pix12;        /*!< COLMOD(0x3A)为12位像素 */
+static uint32_t g_bits, g_nbits; /*!< 12位像素时尚未凑成像素的位 */
+static uint64_t g_wire;          /*!< 线上尚未凑成字节的位(12位帧) */
+static uint8_t g_nwire;
+static uint8_t g_reg_active;   /*!< 寄存器级传输进行中 */
+static uint16_t g_scroll[4] = {0, SIM_PANEL_DIM, 0, 0}; /*!< VSCRDEF(TFA/VSA/BFA)与VSCSAD */
+static uint16_t g_display[SIM_PANEL_DIM * SIM_PANEL_DIM]; /*!< 按滚动设置扫描出的画面 */
+
+static const uint8_t *g_dma_data = NULL; /*!< 等待完成的SPI DMA数据 */
+static uint16_t g_dma_size;
+static uint8_t g_dma_fill = 0; /*!< DMA源地址固定(同色填充) */
+
+static uint32_t g_tick = 0;
+
+#define SIM_FNV_BASIS 2166136261u
+#define SIM_FNV_PRIME 16777619u
+
+/**
+ * @brief  把一个字节并入FNV-1a散列
+ */
+static uint32_t Sim_Hash(uint32_t h, uint8_t b) { return (h ^ b) * SIM_FNV_PRIME; }
+
+/**
+ * @brief  写入一个像素并按窗口前进
+ */
+static void Panel_Pixel(uint16_t color) {
+  if (g_cx < SIM_PANEL_DIM && g_cy < SIM_PANEL_DIM) {
+    g_frame[g_cy * SIM_PANEL_DIM + g_cx] = color;
+  }
+  g_stats.pixels++;
+  g_stats.pixel_hash = Sim_Hash(Sim_Hash(g_stats.pixel_hash, (uint8_t)(color >> 8)), (uint8_t)color);
+  if (++g_cx > g_col[1]) {
+    g_cx = g_col[0];
+    if (++g_cy > g_row[1]) {
+      g_cy = g_row[0]; // 越过窗口末尾后回到起点，与控制器相同
+    }
+  }
+}
+
+/**
+ * @brief  屏幕控制器收到一个字节
+ */
+static void Panel_Byte(uint8_t b) {
+  g_stats.bytes++;
+  if (!g_dc || g_cmd != 0x2C) {
+    g_stats.command_hash = Sim_Hash(g_stats.command_hash, b);
+  }
+  if (!g_dc) {
+    g_cmd = b;
+    g_argc = 0;
+    g_stats.commands++;
+    if (b == 0x2A) {
+      g_stats.windows++;
+    } else if (b == 0x2C) {
+      g_cx = g_col[0];
+      g_cy = g_row[0];
+      g_half = 0;
+      g_nbits = 0;
+    }
+    return;
+  }
+
+  switch (g_cmd) {
+  case 0x2A:
+  case 0x2B: {
+    uint16_t *v = (g_cmd == 0x2A) ? g_col : g_row;
+
+    if (g_argc < 4) {
+      v[g_argc / 2] = (g_argc & 1) ? (uint16_t)(v[g_argc / 2] | b)
+                                   : (uint16_t)(b << 8);
+    }
+    g_argc++;
+    break;
+  }
+  case 0x33:
+  case 0x37: {
+    uint16_t *v = (g_cmd == 0x33) ? g_scroll : &g_scroll[3];
+    uint8_t n = (g_cmd == 0x33) ? 6 : 2;
+
+    if (g_argc < n) {
+      v[g_argc / 2] = (g_argc & 1) ? (uint16_t)(v[g_argc / 2] | b)
+                                   : (uint16_t)(b << 8);
+    }
+    g_argc++;
+    break;
+  }
+  case 0x3A:
+    g_pix12 = ((b & 0x07) == 0x03);
+    break;
+  case 0x2C:
+    if (g_pix12) { // R1G1 B1R2 G2B2，分量为4位，展开为RGB565
+      g_bits = (g_bits << 8) | b;
+      g_nbits += 8;
+      if (g_nbits >= 12) {
+        uint32_t p = (g_bits >> (g_nbits - 12)) & 0xFFF;
+        uint32_t r = p >> 8, g = (p >> 4) & 0xF, bl = p & 0xF;
+
+        g_nbits -= 12;
+        Panel_Pixel((uint16_t)((((r << 1) | (r >> 3)) << 11) |
+                               (((g << 2) | (g >> 2)) << 5) |
+                               ((bl << 1) | (bl >> 3))));
+      }
+      break;
+    }
+    if (!g_half) {
+      g_hi = b;
+      g_half = 1;
+    } else {
+      Panel_Pixel((uint16_t)((g_hi << 8) | b));
+      g_half = 0;
+    }
+    break;
+  default:
+    break; // 其他指令的参数不影响显存
+  }
+}
+
+/**
+ * @brief  按当前数据宽度发送一帧(高位先出)，屏幕按字节接收
+ */
+static void Panel_Frame(const SPI_HandleTypeDef *hspi, uint32_t v) {
+  uint8_t bits = (uint8_t)((hspi->Init.DataSize & 0x1F) + 1);
+
+  g_wire = (g_wire << bits) | (v & (uint32_t)((1ULL << bits) - 1));
+  g_nwire = (uint8_t)(g_nwire + bits);
+  while (g_nwire >= 8) {
+    g_nwire -= 8;
+    Panel_Byte((uint8_t)(g_wire >> g_nwire));
+  }
+}
+
+/**
+ * @brief  一帧在内存中占用的字节数(HAL的数据打包方式)
+ */
+static uint8_t Frame_Bytes(const SPI_HandleTypeDef *hspi) {
+  return (hspi->Init.DataSize > SPI_DATASIZE_16BIT)  ? 4
+         : (hspi->Init.DataSize > SPI_DATASIZE_8BIT) ? 2
+                                                     : 1;
+}
+
+/**
+ * @brief  按数据宽度把缓冲区拆成帧发送
+ */
+static void Panel_Buffer(const SPI_HandleTypeDef *hspi, const uint8_t *p,
+                         uint16_t frames) {
+  uint8_t n = Frame_Bytes(hspi);
+
+  for (uint16_t i = 0; i < frames; i++, p += n) {
+    uint32_t v = 0;
+
+    memcpy(&v, p, n);
+    Panel_Frame(hspi, v);
+  }
+}
+
+/**
+ * @brief  完成等待中的SPI DMA传输并调用完成回调
+ */
+static void Sim_DMA_Service(void) {
+  const uint8_t *p = g_dma_data;
+
+  if (hspi6.Instance->IER & SPI_IT_EOT) { // 寄存器级发送打开的EOT中断，与 HAL_SPI_IRQHandler() 相同
+    __HAL_SPI_DISABLE_IT(&hspi6, SPI_IT_EOT);
+    Sim_SPI_EndTransfer(&hspi6);
+    hspi6.State = HAL_SPI_STATE_READY;
+    HAL_SPI_TxCpltCallback(&hspi6);
+    return;
+  }
+  if (p == NULL) {
+    return;
+  }
+  g_dma_data = NULL;
+  if (g_dma_fill) {
+    uint32_t v = 0;
+
+    memcpy(&v, p, (Frame_Bytes(&hspi6) == 4) ? 4 : 2);
+    for (uint16_t i = 0; i < g_dma_size; i++) {
+      Panel_Frame(&hspi6, v);
+    }
+  } else {
+    Panel_Buffer(&hspi6, p, g_dma_size);
+  }
+  hspi6.State = HAL_SPI_STATE_READY;
+  HAL_SPI_TxCpltCallback(&hspi6);
+}
+
+/*******************************************************************************
+ *                              HAL替身
+ ******************************************************************************/
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit) {
+  (void)PeriphClkInit;
+  return HAL_OK;
+}
+
+uint32_t Sim_Cycles(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec) *
+                    (SystemCoreClock / 1000000) / 1000);
+}
+
+uint32_t HAL_GetTick(void) {
+  Sim_DMA_Service(); // 等待循环中让后台传输完成
+  return g_tick++;
+}
+
+void HAL_Delay(uint32_t Delay) { g_tick += Delay; }
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority,
+                          uint32_t SubPriority) {
+  (void)IRQn;
+  (void)PreemptPriority;
+  (void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) { (void)IRQn; }
+
+void SCB_InvalidateICache(void) {}
+void SCB_CleanInvalidateDCache(void) {}
+void SCB_CleanDCache_by_Addr(uint32_t *addr, int32_t dsize) {
+  (void)addr;
+  (void)dsize;
+}
+void SCB_InvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize) {
+  (void)addr;
+  (void)dsize;
+}
+void SCB_CleanInvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize) {
+  (void)addr;
+  (void)dsize;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init) {
+  (void)GPIOx;
+  (void)GPIO_Init;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin,
+                       GPIO_PinState PinState) {
+  if (PinState == GPIO_PIN_SET) {
+    GPIOx->ODR |= GPIO_Pin;
+  } else {
+    GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+  }
+  if (GPIOx == LCD_DC_PORT && GPIO_Pin == LCD_DC_PIN) {
+    g_dc = (PinState == GPIO_PIN_SET);
+  }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+  HAL_GPIO_WritePin(GPIOx, GPIO_Pin,
+                    (GPIOx->ODR & GPIO_Pin) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+  return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi) {
+  g_stats.spi_inits++;
+  MODIFY_REG(hspi->Instance->CFG1, SPI_CFG1_DSIZE, hspi->Init.DataSize);
+  hspi->State = HAL_SPI_STATE_READY;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData,
+                                  uint16_t Size, uint32_t Timeout) {
+  (void)hspi;
+  (void)Timeout;
+  memset(pData, 0, Size); // 屏幕模型不支持回读
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi,
+                                   const uint8_t *pData, uint16_t Size,
+                                   uint32_t Timeout) {
+  (void)Timeout;
+  if (hspi->State != HAL_SPI_STATE_READY) {
+    g_stats.collisions++; // 硬件上会返回HAL_BUSY，此处先完成后台传输再继续
+    Sim_DMA_Service();
+  }
+  g_stats.transfers++;
+  Panel_Buffer(hspi, pData, Size);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi,
+                                       const uint8_t *pData, uint16_t Size) {
+  if (hspi->State != HAL_SPI_STATE_READY) {
+    g_stats.collisions++;
+    Sim_DMA_Service();
+  }
+  g_stats.transfers++;
+  g_stats.dma++;
+  hspi->State = HAL_SPI_STATE_BUSY_TX;
+  hspi->ErrorCode = HAL_SPI_ERROR_NONE; /* 与HAL相同，寄存器级发送留下的错误标志不影响完成回调 */
+  g_dma_data = pData;
+  g_dma_size = Size;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef *hspi) {
+  g_dma_data = NULL;
+  hspi->State = HAL_SPI_STATE_READY;
+  return HAL_OK;
+}
+
+/* 与 user_hal_callbacks.c 相同，该文件依赖QSPI驱动，不参与仿真 */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
+  LCD_SPI_TxCpltHandler(hspi);
+}
+
+/**
+ * @brief  lcd_spi.c 寄存器级发送的一次 TXDR 写入
+ * @param  bytes: 写入宽度(1、2或4字节)，按当前数据宽度拆成帧
+ */
+void Sim_SPI_WriteTXDR(SPI_HandleTypeDef *hspi, uint32_t value,
+                       uint8_t bytes) {
+  uint8_t frame = Frame_Bytes(hspi);
+
+  if (!g_reg_active) {
+    g_reg_active = 1;
+    g_stats.transfers++;
+  }
+  for (uint8_t i = 0; i < bytes; i += frame) {
+    Panel_Frame(hspi, (frame == 4) ? value : (value >> (i * 8)));
+  }
+}
+
+/**
+ * @brief  切换DMA源地址是否固定(lcd_spi.c 的 LCD_SPI_DMA_SET_MODE)
+ */
+void Sim_SPI_SetDMAFill(uint8_t fill) { g_dma_fill = fill; }
+
+/**
+ * @brief  寄存器级传输结束(LCD_SPI_CloseTransfer 清除EOT标志)
+ */
+void Sim_SPI_EndTransfer(SPI_HandleTypeDef *hspi) {
+  (void)hspi;
+  g_reg_active = 0;
+}
+
+HAL_StatusTypeDef HAL_MDMA_Init(MDMA_HandleTypeDef *hmdma) {
+  hmdma->FirstLinkedListNodeAddress = NULL;
+  hmdma->LastLinkedListNodeAddress = NULL;
+  hmdma->LinkedListNodeCounter = 0;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_MDMA_RegisterCallback(
+    MDMA_HandleTypeDef *hmdma, HAL_MDMA_CallbackIDTypeDef CallbackID,
+    void (*pCallback)(MDMA_HandleTypeDef *_hmdma)) {
+  if (CallbackID == HAL_MDMA_XFER_CPLT_CB_ID) {
+    hmdma->XferCpltCallback = pCallback;
+  } else if (CallbackID == HAL_MDMA_XFER_ERROR_CB_ID) {
+    hmdma->XferErrorCallback = pCallback;
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef
+HAL_MDMA_LinkedList_CreateNode(MDMA_LinkNodeTypeDef *pNode,
+                               MDMA_LinkNodeConfTypeDef *pNodeConfig) {
+  memset((void *)pNode, 0, sizeof(*pNode));
+  pNode->CSAR = pNodeConfig->SrcAddress;
+  pNode->CDAR = pNodeConfig->DstAddress;
+  pNode->CBNDTR = pNodeConfig->BlockDataLength;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_MDMA_LinkedList_AddNode(MDMA_HandleTypeDef *hmdma,
+                                              MDMA_LinkNodeTypeDef *pNewNode,
+                                              MDMA_LinkNodeTypeDef *pPrevNode) {
+  (void)pPrevNode; // 只支持追加到链表末尾
+  pNewNode->CLAR = 0;
+  if (hmdma->LastLinkedListNodeAddress != NULL) {
+    hmdma->LastLinkedListNodeAddress->CLAR = (uint32_t)(uintptr_t)pNewNode;
+  } else {
+    hmdma->FirstLinkedListNodeAddress = pNewNode;
+  }
+  hmdma->LastLinkedListNodeAddress = pNewNode;
+  hmdma->LinkedListNodeCounter++;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_MDMA_Start_IT(MDMA_HandleTypeDef *hmdma,
+                                    uint32_t SrcAddress, uint32_t DstAddress,
+                                    uint32_t BlockDataLength,
+                                    uint32_t BlockCount) {
+  const MDMA_LinkNodeTypeDef *node = hmdma->FirstLinkedListNodeAddress;
+
+  (void)BlockCount;
+  memcpy((void *)(uintptr_t)DstAddress, (const void *)(uintptr_t)SrcAddress,
+         BlockDataLength);
+  while (node != NULL) {
+    memcpy((void *)(uintptr_t)node->CDAR, (const void *)(uintptr_t)node->CSAR,
+           node->CBNDTR);
+    node = (const MDMA_LinkNodeTypeDef *)(uintptr_t)node->CLAR;
+  }
+  if (hmdma->XferCpltCallback != NULL) {
+    hmdma->XferCpltCallback(hmdma);
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_MDMA_Start(MDMA_HandleTypeDef *hmdma,
+                                 uint32_t SrcAddress, uint32_t DstAddress,
+                                 uint32_t BlockDataLength,
+                                 uint32_t BlockCount) {
+  (void)hmdma;
+  memcpy((void *)(uintptr_t)DstAddress, (const void *)(uintptr_t)SrcAddress,
+         (size_t)BlockDataLength * BlockCount);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef
+HAL_MDMA_PollForTransfer(MDMA_HandleTypeDef *hmdma,
+                         HAL_MDMA_LevelCompleteTypeDef CompleteLevel,
+                         uint32_t Timeout) {
+  (void)hmdma;
+  (void)CompleteLevel;
+  (void)Timeout;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_MDMA_Abort(MDMA_HandleTypeDef *hmdma) {
+  (void)hmdma;
+  return HAL_OK;
+}
+
+void HAL_MDMA_IRQHandler(MDMA_HandleTypeDef *hmdma) { (void)hmdma; }
+
+/*******************************************************************************
+ *                              DMA2D
+ ******************************************************************************/
+
+/**
+ * @brief  读取前景/背景层的第 i 个像素，输出ARGB8888
+ */
+static uint32_t Sim_DMA2D_Read(const DMA2D_LayerCfgTypeDef *cfg,
+                               const uint32_t *clut, uint32_t addr,
+                               uint32_t i) {
+  const uint8_t *p = (const uint8_t *)(uintptr_t)addr;
+
+  switch (cfg->InputColorMode) {
+  case DMA2D_INPUT_L8:
+    return clut[p[i]];
+  case DMA2D_INPUT_L4:
+    return clut[(p[i / 2] >> ((i & 1) * 4)) & 0x0F];
+  case DMA2D_INPUT_RGB888:
+    p += i * 3;
+    return 0xFF000000U | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+  case DMA2D_INPUT_A4: {
+    uint32_t a = (p[i / 2] >> ((i & 1) * 4)) & 0x0F;
+
+    return ((a * 17) << 24) | (cfg->InputAlpha & 0x00FFFFFFU);
+  }
+  case DMA2D_INPUT_A8:
+    return ((uint32_t)p[i] << 24) | (cfg->InputAlpha & 0x00FFFFFFU);
+  case DMA2D_INPUT_ARGB4444: {
+    uint32_t c = ((const uint16_t *)p)[i];
+
+    return ((c >> 12) * 17) << 24 | (((c >> 8) & 0xF) * 17) << 16 |
+           (((c >> 4) & 0xF) * 17) << 8 | (c & 0xF) * 17;
+  }
+  default: {
+    uint32_t c = ((const uint16_t *)p)[i];
+    uint32_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+
+    return 0xFF000000U | (((r << 3) | (r >> 2)) << 16) |
+           (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+  }
+  }
+}
+
+static uint16_t Sim_DMA2D_To565(uint32_t argb) {
+  return (uint16_t)(((argb >> 8) & 0xF800) | ((argb >> 5) & 0x07E0) |
+                    ((argb >> 3) & 0x001F));
+}
+
+/**
+ * @brief  逐像素完成一次传输，fg/bg 为各层每行起始地址的计算基准
+ */
+static void Sim_DMA2D_Run(DMA2D_HandleTypeDef *hdma2d, uint32_t fg,
+                          uint32_t bg, uint32_t dst, uint32_t width,
+                          uint32_t height) {
+  const DMA2D_LayerCfgTypeDef *lf = &hdma2d->LayerCfg[DMA2D_FOREGROUND_LAYER];
+  const DMA2D_LayerCfgTypeDef *lb = &hdma2d->LayerCfg[DMA2D_BACKGROUND_LAYER];
+  uint16_t *out = (uint16_t *)(uintptr_t)dst;
+
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      uint32_t c;
+
+      if (hdma2d->Init.Mode == DMA2D_R2M) {
+        c = fg;
+      } else if (hdma2d->Init.Mode == DMA2D_M2M_BLEND) {
+        uint32_t f = Sim_DMA2D_Read(lf, hdma2d->CLUT[DMA2D_FOREGROUND_LAYER], fg,
+                                    y * (width + lf->InputOffset) + x);
+        uint32_t b = Sim_DMA2D_Read(lb, hdma2d->CLUT[DMA2D_BACKGROUND_LAYER], bg,
+                                    y * (width + lb->InputOffset) + x);
+        uint32_t a = f >> 24;
+
+        c = 0;
+        for (uint32_t s = 0; s < 24; s += 8) {
+          uint32_t cf = (f >> s) & 0xFF, cb = (b >> s) & 0xFF;
+
+          c |= ((cf * a + cb * (255 - a)) / 255) << s;
+        }
+      } else {
+        c = Sim_DMA2D_Read(lf, hdma2d->CLUT[DMA2D_FOREGROUND_LAYER], fg,
+                           y * (width + lf->InputOffset) + x);
+      }
+      out[y * (width + hdma2d->Init.OutputOffset) + x] = Sim_DMA2D_To565(c);
+    }
+  }
+}
+
+HAL_StatusTypeDef HAL_DMA2D_Init(DMA2D_HandleTypeDef *hdma2d) {
+  return (hdma2d->Init.ColorMode == DMA2D_OUTPUT_RGB565) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_ConfigLayer(DMA2D_HandleTypeDef *hdma2d,
+                                        uint32_t LayerIdx) {
+  (void)hdma2d;
+  return (LayerIdx < 2) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_Start(DMA2D_HandleTypeDef *hdma2d, uint32_t pdata,
+                                  uint32_t DstAddress, uint32_t Width,
+                                  uint32_t Height) {
+  Sim_DMA2D_Run(hdma2d, pdata, 0, DstAddress, Width, Height);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_BlendingStart(DMA2D_HandleTypeDef *hdma2d,
+                                          uint32_t SrcAddress1,
+                                          uint32_t SrcAddress2,
+                                          uint32_t DstAddress, uint32_t Width,
+                                          uint32_t Height) {
+  Sim_DMA2D_Run(hdma2d, SrcAddress1, SrcAddress2, DstAddress, Width, Height);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_CLUTStartLoad(DMA2D_HandleTypeDef *hdma2d,
+                                          const DMA2D_CLUTCfgTypeDef *CLUTCfg,
+                                          uint32_t LayerIdx) {
+  if (LayerIdx >= 2 || CLUTCfg->CLUTColorMode != DMA2D_CCM_ARGB8888) {
+    return HAL_ERROR;
+  }
+  hdma2d->CLUT[LayerIdx] = CLUTCfg->pCLUT;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_PollForTransfer(DMA2D_HandleTypeDef *hdma2d,
+                                            uint32_t Timeout) {
+  (void)hdma2d;
+  (void)Timeout;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_Abort(DMA2D_HandleTypeDef *hdma2d) {
+  (void)hdma2d;
+  return HAL_OK;
+}
+
+/*******************************************************************************
+ *                              CRC
+ ******************************************************************************/
+
+/**
+ * @brief  CRC初始化：仿真只实现输入按字节反转、输出反转的配置(与zlib.crc32相同)
+ */
+HAL_StatusTypeDef HAL_CRC_Init(CRC_HandleTypeDef *hcrc) {
+  hcrc->State = 0xFFFFFFFFU;
+  return HAL_OK;
+}
+
+uint32_t HAL_CRC_Accumulate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[],
+                            uint32_t BufferLength) {
+  const uint8_t *p = (const uint8_t *)pBuffer;
+  uint32_t crc = hcrc->State;
+
+  // 输出反转后的中间值即按低位在前计算的寄存器值
+  for (uint32_t i = 0; i < BufferLength; i++) {
+    crc ^= p[i];
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+    }
+  }
+  hcrc->State = crc;
+  return crc;
+}
+
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[],
+                           uint32_t BufferLength) {
+  hcrc->State = 0xFFFFFFFFU;
+  return HAL_CRC_Accumulate(hcrc, pBuffer, BufferLength);
+}
+
+static QSPI_W25Qxx_Range_t sim_update; /*!< 最近一次改写(仿真只记一条) */
+
+/**
+ * @brief  字库在线更新：直接写入映射区(MAP_PRIVATE，不改动原文件)
+ */
+int8_t QSPI_W25Qxx_MappedUpdate(const uint8_t *pData, uint32_t WriteAddr,
+                                uint32_t Size,
+                                QSPI_W25Qxx_UpdateStats_t *stats) {
+  memcpy((uint8_t *)(uintptr_t)(W25Qxx_Mem_Addr + WriteAddr), pData, Size);
+  sim_update.addr = WriteAddr;
+  sim_update.size = Size;
+  sim_update.epoch++;
+  if (stats != NULL) {
+    memset(stats, 0, sizeof(*stats));
+  }
+  return QSPI_W25Qxx_OK;
+}
+
+uint32_t QSPI_W25Qxx_UpdateEpoch(void) { return sim_update.epoch; }
+
+/**
+ * @brief  改写记录：上次同步之后只改写过一次时返回该范围，否则要求整体作废
+ */
+uint8_t QSPI_W25Qxx_UpdateRanges(uint32_t *since, QSPI_W25Qxx_Range_t *out) {
+  uint8_t n = 0;
+
+  if (*since != sim_update.epoch) {
+    if (*since + 1 == sim_update.epoch) {
+      out[0] = sim_update;
+      n = 1;
+    } else {
+      n = W25Qxx_UPDATE_OVERFLOW;
+    }
+    *since = sim_update.epoch;
+  }
+  return n;
+}
+
+static uint8_t sim_qspi_pd = 0; /*!< 仿真的深度掉电状态，映射区始终可读 */
+
+int8_t QSPI_W25Qxx_MemoryMappedMode(void) { return QSPI_W25Qxx_OK; }
+uint8_t QSPI_W25Qxx_DMA_Busy(void) { return 0; }
+uint32_t QSPI_W25Qxx_MeasureReadCycles(uint32_t ReadAddr, uint32_t NumByteToRead, uint8_t cold) {
+  (void)ReadAddr;
+  (void)NumByteToRead;
+  (void)cold;
+  return 0; // 仿真没有QSPI总线时序，压力测试的占用率显示为未知
+}
+uint8_t QSPI_W25Qxx_Write_Busy(void) { return 0; }
+int8_t QSPI_W25Qxx_EraseSuspend(void) { return W25Qxx_ERROR_Erase; } // 仿真中没有异步擦写
+int8_t QSPI_W25Qxx_EraseResume(void) { return W25Qxx_ERROR_Erase; }
+uint8_t QSPI_W25Qxx_EraseSuspended(void) { return 0; }
+uint8_t QSPI_W25Qxx_IsPoweredDown(void) { return sim_qspi_pd; }
+
+/**
+ * @brief  深度掉电：只记录状态
+ */
+int8_t QSPI_W25Qxx_PowerDown(void) {
+  sim_qspi_pd = 1;
+  return QSPI_W25Qxx_OK;
+}
+
+int8_t QSPI_W25Qxx_WakeUp(void) {
+  sim_qspi_pd = 0;
+  return QSPI_W25Qxx_OK;
+}
+
+/*******************************************************************************
+ *                              仿真接口
+ ******************************************************************************/
+
+/**
+ * @brief  初始化仿真外设并映射字库
+ * @param  font_bin: 字库bin文件路径，NULL时不映射
+ * @retval 0-成功, -1-映射失败
+ */
+int Sim_Init(const char *font_bin) {
+  hspi6.Instance = &g_spi6_regs;
+  hspi6.Init.Mode = SPI_MODE_MASTER;
+  hspi6.Init.Direction = SPI_DIRECTION_2LINES_TXONLY;
+  hspi6.Init.DataSize = SPI_DATASIZE_8BIT;
+  hspi6.Init.FifoThreshold = SPI_FIFO_THRESHOLD_02DATA; // 与CubeMX配置一致
+  hspi6.State = HAL_SPI_STATE_READY;
+  g_spi6_regs.SR = 0xFFFFFFFFU; // 所有状态标志恒为置位，寄存器级发送从不等待
+  hqspi.State = HAL_QSPI_STATE_BUSY_MEM_MAPPED;
+
+  memset(g_frame, 0, sizeof(g_frame));
+  Sim_ResetStats();
+
+  if (font_bin != NULL) {
+    uint8_t *base;
+    struct stat st;
+    int fd = open(font_bin, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &st) != 0) {
+      perror(font_bin);
+      return -1;
+    }
+    // 整片W25Q256先映射为擦除状态(0xFF)，再把字库文件覆盖到A分区
+    base = mmap((void *)(uintptr_t)W25Qxx_Mem_Addr, W25Qxx_FlashSize,
+                PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (base != (uint8_t *)(uintptr_t)W25Qxx_Mem_Addr) {
+      perror("mmap W25Qxx_Mem_Addr");
+      close(fd);
+      return -1;
+    }
+    memset(base, 0xFF, W25Qxx_FlashSize);
+    if (st.st_size > FONT_BANK_SIZE) {
+      st.st_size = FONT_BANK_SIZE;
+    }
+    if (mmap(base + BASE_ADDR, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+      perror(font_bin);
+      close(fd);
+      return -1;
+    }
+    close(fd);
+  }
+  return 0;
+}
+
+void Sim_ResetStats(void) {
+  memset(&g_stats, 0, sizeof(g_stats));
+  g_stats.pixel_hash = SIM_FNV_BASIS;
+  g_stats.command_hash = SIM_FNV_BASIS;
+}
+
+void Sim_GetStats(Sim_Stats_t *stats) { *stats = g_stats; }
+
+const uint16_t *Sim_Frame(void) { return g_frame; }
+
+uint32_t Sim_FrameHash(void) {
+  const uint8_t *p = (const uint8_t *)g_frame;
+  uint32_t h = SIM_FNV_BASIS;
+
+  for (uint32_t i = 0; i < sizeof(g_frame); i++) {
+    h = Sim_Hash(h, p[i]);
+  }
+  return h;
+}
+
+const uint16_t *Sim_Display(void) {
+  uint16_t tfa = g_scroll[0], vsa = g_scroll[1], vsp = g_scroll[3];
+
+  for (uint16_t y = 0; y < SIM_PANEL_DIM; y++) {
+    uint16_t row = y;
+
+    // 滚动区第一行显示 VSP 所在的显存行，之后依次向下并在滚动区内回绕
+    if (vsa > 0 && y >= tfa && y < tfa + vsa && vsp >= tfa && vsp < tfa + vsa) {
+      row = tfa + (y - tfa + vsp - tfa) % vsa;
+    }
+    memcpy(&g_display[y * SIM_PANEL_DIM], &g_frame[row * SIM_PANEL_DIM],
+           SIM_PANEL_DIM * 2);
+  }
+  return g_display;
+}
+
+int Sim_SavePPM(const char *path, uint16_t width, uint16_t height) {
+  FILE *f = fopen(path, "wb");
+
+  if (f == NULL) {
+    return -1;
+  }
+  fprintf(f, "P6\n%u %u\n255\n", width, height);
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      uint16_t c = g_frame[y * SIM_PANEL_DIM + x];
+      uint8_t rgb[3] = {(uint8_t)((c >> 11) << 3), (uint8_t)(((c >> 5) & 0x3F) << 2),
+                        (uint8_t)((c & 0x1F) << 3)};
+      fwrite(rgb, 1, 3, f);
+    }
+  }
+  fclose(f);
+  return 0;
+}
+
+int Sim_SaveRaw(const char *path) {
+  FILE *f = fopen(path, "wb");
+  size_t n;
+
+  if (f == NULL) {
+    return -1;
+  }
+  n = fwrite(g_frame, sizeof(g_frame), 1, f);
+  fclose(f);
+  return (n == 1) ? 0 : -1;
+}
+
+int32_t Sim_CompareRaw(const char *path) {
+  static uint16_t ref[SIM_PANEL_DIM * SIM_PANEL_DIM];
+  FILE *f = fopen(path, "rb");
+  int32_t diff = 0;
+  size_t n;
+
+  if (f == NULL) {
+    return -1;
+  }
+  n = fread(ref, sizeof(ref), 1, f);
+  fclose(f);
+  if (n != 1) {
+    return -1;
+  }
+  for (uint32_t i = 0; i < SIM_PANEL_DIM * SIM_PANEL_DIM; i++) {
+    diff += (ref[i] != g_frame[i]);
+  }
+  return diff;
+}
@@ -0,0 +1,103 @@
+/**
+ ******************************************************************************
+ * @file    sim_hal.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   主机仿真：屏幕模型、SPI统计与字库映射
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 仿真ST7789控制器的 0x2A/0x2B/0x2C 指令，把SPI像素流写入显存模型
+ * - 统计SPI指令数、窗口数、传输次数和字节数，用来比较渲染路径的总线开销
+ * - 像素流、指令流和整个显存分别计算散列，回归比较(lcd_sim -r)据此判断输出是否改变
+ * - Sim_Init() 把字库bin映射到 W25Qxx_Mem_Addr + BASE_ADDR，与硬件上
+ *   内存映射模式看到的地址完全相同，flash_font.c 无需修改
+ *
+ ******************************************************************************
+ */
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define SIM_PANEL_DIM 320 /*!< 显存模型边长，横竖屏都能容纳 */
+
+    /**
+     * @brief  SPI总线统计
+     */
+    typedef struct
+    {
+        uint32_t commands;  /*!< 指令字节数(DC低电平) */
+        uint32_t windows;   /*!< 设置列地址(0x2A)次数 */
+        uint32_t transfers; /*!< SPI传输次数(阻塞 + DMA + 寄存器级) */
+        uint32_t dma;       /*!< 其中DMA传输次数 */
+        uint32_t spi_inits; /*!< HAL_SPI_Init 调用次数 */
+        uint32_t collisions; /*!< DMA未完成时又发起SPI传输的次数(硬件上会失败) */
+        uint64_t bytes;     /*!< 总线上的字节数 */
+        uint64_t pixels;    /*!< 写入显存的像素数 */
+        uint32_t pixel_hash;   /*!< 像素流(按写入顺序)的FNV-1a散列 */
+        uint32_t command_hash; /*!< 指令及其参数(不含像素数据)的FNV-1a散列 */
+    } Sim_Stats_t;
+
+    /**
+     * @brief  初始化仿真外设并映射字库
+     * @param  font_bin: 字库bin文件路径，NULL时不映射(只能使用内置字库)
+     * @retval 0-成功, -1-映射失败
+     */
+    int Sim_Init(const char *font_bin);
+
+    /**
+     * @brief  清零SPI统计，像素流和指令散列重新开始
+     */
+    void Sim_ResetStats(void);
+
+    /**
+     * @brief  读取SPI统计
+     * @param  stats: 输出统计信息
+     */
+    void Sim_GetStats(Sim_Stats_t *stats);
+
+    /**
+     * @brief  显存模型首地址(SIM_PANEL_DIM x SIM_PANEL_DIM，RGB565)
+     */
+    const uint16_t *Sim_Frame(void);
+
+    /**
+     * @brief  整个显存模型的FNV-1a散列，与绘制顺序无关
+     */
+    uint32_t Sim_FrameHash(void);
+
+    /**
+     * @brief  按 VSCRDEF/VSCSAD 把显存扫描为屏幕上看到的画面(竖屏，行不翻转)
+     */
+    const uint16_t *Sim_Display(void);
+
+    /**
+     * @brief  把显存左上角 width x height 区域保存为PPM图像
+     * @retval 0-成功, -1-文件无法写入
+     */
+    int Sim_SavePPM(const char *path, uint16_t width, uint16_t height);
+
+    /**
+     * @brief  保存整个显存模型(原始RGB565)
+     * @retval 0-成功, -1-文件无法写入
+     */
+    int Sim_SaveRaw(const char *path);
+
+    /**
+     * @brief  与 Sim_SaveRaw() 保存的参考图逐像素比较
+     * @retval 不同的像素数，文件无法读取或大小不符返回-1
+     */
+    int32_t Sim_CompareRaw(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_HAL_H
@@ -0,0 +1,663 @@
+/**
+ ******************************************************************************
+ * @file    sim_main.c
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   主机仿真：文字渲染吞吐测试与参考图比较
+ ******************************************************************************
+ * @attention
+ *
+ * 运行流程：
+ * 1. 映射字库，执行 SPI_LCD_Init() / FlashFont_Init()，与板上启动顺序一致
+ * 2. 参考画面：每个字号显示语料第一行，可保存为PPM/原始图或与参考图比较
+ * 3. 吞吐测试：每个字号把整份语料重复渲染N遍，统计耗时、SPI总线开销
+ *    和字模缓存命中率
+ * 4. 回归比较(-r/-R)：代替2、3，每个字号渲染一组场景(UTF-8、GBK、换行、缺字、
+ *    底边裁剪、透明叠加)，显存散列必须与参考结果一致，字节、窗口、传输和字模查找
+ *    数不能增加；像素流或指令流散列变化只说明发送顺序改变
+ *
+ * 使用示例：
+ *     ./lcd_sim -c corpus.txt -n 20             # 吞吐测试
+ *     ./lcd_sim -w golden.raw -o golden.ppm     # 生成参考图
+ *     ./lcd_sim -g golden.raw                   # 与参考图比较，不同则返回1
+ *     make DEFS=-DPERF_TRACE_ENABLE && ./lcd_sim -t scene.json
+ *                                               # 参考画面的渲染时间线
+ *     make DEFS=-DPERF_STATS_ENABLE && ./lcd_sim -c corpus.txt -p profile.txt
+ *                                               # 汉字字模QSPI读取统计(fontbuild.py --profile)
+ *     make PROFILE=1 && ./lcd_sim -c corpus.txt -C cycles.txt
+ *                                               # 吞吐测试中各函数的周期(profile_view.py 换算函数名)
+ *     make DEFS="-DSTRESS_BENCH_ENABLE -DSTRESS_BENCH_KEY_MS=5" && ./lcd_sim -S
+ *                                               # 混合负载压力测试(主机上帧很快，按键间隔要缩短)
+ *     make DEFS="-DLCD_ALARM_ENABLE -DGLYPH_CACHE_LOCK_SLOTS=32 -DSTRESS_BENCH_ENABLE -DSTRESS_BENCH_KEY_MS=5" && ./lcd_sim -S
+ *                                               # 同时测量报警条的最坏耗时
+ *     ./lcd_sim -R golden.txt                   # 保存回归场景的散列和总线计数
+ *     ./lcd_sim -r golden.txt -l history.csv    # 画面不同或开销增加则返回1，合计追加到历史
+ *     make check                                # 默认配置与已提交的 golden.txt 比较
+ *
+ ******************************************************************************
+ */
+
+#include "sim_hal.h"
+#include "init.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SIM_DEFAULT_FONT "../../BSP/QSPI/FontBin/merged_fonts.bin"
+#define SIM_MAX_SIZES 8
+#define SIM_MAX_LINES 4096
+
+/* 未指定 -c 时使用的语料 */
+static const char *const g_default_corpus[] = {
+    "反客科技STM32 这是一个测试，哈基米南北绿豆，stm32~",
+    "温度25.6C 湿度48% 电压3.30V 电流0.52A",
+    "设置 返回 确定 取消 菜单 时间 日期 亮度 音量",
+    "The quick brown fox jumps over the lazy dog 0123456789",
+    "字库渲染性能测试：查找、展开、发送三个阶段的耗时。",
+};
+
+static char *g_lines[SIM_MAX_LINES];
+static uint32_t g_line_count = 0;
+
+/**
+ * @brief  读入语料文件，每行一段，忽略空行
+ * @retval 0-成功, -1-文件无法读取
+ */
+static int Sim_LoadCorpus(const char *path) {
+  FILE *f = fopen(path, "rb");
+  char *text, *p;
+  long size;
+
+  if (f == NULL) {
+    perror(path);
+    return -1;
+  }
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  text = malloc((size_t)size + 1);
+  if (text == NULL || fread(text, 1, (size_t)size, f) != (size_t)size) {
+    fclose(f);
+    return -1;
+  }
+  fclose(f);
+  text[size] = 0;
+
+  for (p = strtok(text, "\r\n"); p != NULL && g_line_count < SIM_MAX_LINES;
+       p = strtok(NULL, "\r\n")) {
+    g_lines[g_line_count++] = p;
+  }
+  return 0;
+}
+
+/**
+ * @brief  统计UTF8字符数
+ */
+static uint32_t Sim_CountChars(const char *text) {
+  const uint8_t *p = (const uint8_t *)text;
+  uint32_t n = 0, cp;
+
+  while (*p != 0) {
+    p += FlashFont_DecodeUTF8(p, &cp);
+    n++;
+  }
+  return n;
+}
+
+/**
+ * @brief  解析 "12,16,24" 形式的字号列表
+ */
+static uint8_t Sim_ParseSizes(const char *arg, uint8_t *sizes) {
+  uint8_t n = 0;
+  char *end;
+
+  while (*arg != 0 && n < SIM_MAX_SIZES) {
+    long v = strtol(arg, &end, 10);
+    if (end == arg) {
+      break;
+    }
+    sizes[n++] = (uint8_t)v;
+    arg = (*end == ',') ? end + 1 : end;
+  }
+  return n;
+}
+
+#ifdef PERF_STATS_ENABLE
+static FILE *g_profile_file;
+
+static void Sim_ProfileWrite(const char *data, uint16_t len) {
+  fwrite(data, 1, len, g_profile_file);
+}
+#endif
+
+#ifdef PERF_PROFILE_ENABLE
+static FILE *g_cycles_file;
+
+static void Sim_CyclesWrite(const char *data, uint16_t len) {
+  fwrite(data, 1, len, g_cycles_file);
+}
+#endif
+
+#ifdef PERF_TRACE_ENABLE
+static FILE *g_trace_file;
+
+static void Sim_TraceWrite(const char *data, uint16_t len) {
+  fwrite(data, 1, len, g_trace_file);
+}
+#endif
+
+static double Sim_Now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief  等待绘制结束；帧缓冲模式下先把脏区域发送到仿真屏
+ */
+static void Sim_Present(void) {
+#ifdef LCD_FRAMEBUFFER_ENABLE
+  LCD_Flush();
+#endif
+  LCD_WaitIdle();
+}
+
+/**
+ * @brief  参考画面：每个字号一行，从上到下排列
+ */
+static void Sim_DrawScene(const uint8_t *sizes, uint8_t count) {
+  uint16_t y = 0;
+
+  LCD_SetColor(LCD_WHITE);
+  LCD_SetBackColor(LCD_BLACK);
+  LCD_Clear();
+  for (uint8_t i = 0; i < count; i++) {
+    LCD_SetTextFont(sizes[i]);
+    LCD_DisplayText(0, y, g_lines[0]);
+    y += sizes[i] * 2; // 长行会折到下一行
+  }
+  Sim_Present();
+}
+
+/**
+ * @brief  吞吐测试：单个字号重复渲染整份语料
+ */
+static void Sim_Throughput(uint8_t font_size, uint32_t passes) {
+  GlyphCache_Stats_t cache;
+  Sim_Stats_t bus;
+#ifdef PERF_STATS_ENABLE
+  PerfStats_t perf;
+#endif
+  uint64_t chars = 0;
+  uint16_t y = 0;
+  double t0, dt;
+
+  LCD_SetTextFont(font_size);
+  LCD_Clear();
+#ifdef GLYPH_CACHE_ENABLE
+  GlyphCache_Clear();
+#endif
+  Sim_ResetStats();
+  PerfStats_Reset();
+
+  t0 = Sim_Now();
+  for (uint32_t pass = 0; pass < passes; pass++) {
+    for (uint32_t i = 0; i < g_line_count; i++) {
+      if (y + font_size > LCD_Height) {
+        y = 0;
+      }
+      LCD_DisplayText(0, y, g_lines[i]);
+      y += font_size;
+      chars += Sim_CountChars(g_lines[i]);
+    }
+  }
+  LCD_WaitIdle();
+  dt = Sim_Now() - t0;
+
+  Sim_GetStats(&bus);
+  memset(&cache, 0, sizeof(cache));
+#ifdef GLYPH_CACHE_ENABLE
+  GlyphCache_GetStats(&cache);
+#endif
+  printf("%4u %9llu %9.3f %10.0f %8.2f %8.2f %8.2f %6.1f%%\n", font_size,
+         (unsigned long long)chars, dt * 1e3, chars / (dt > 0 ? dt : 1e-9),
+         (double)bus.bytes / chars, (double)bus.windows / chars,
+         (double)bus.transfers / chars,
+         100.0 * cache.hits / ((cache.hits + cache.misses) ? (cache.hits + cache.misses) : 1));
+#ifdef PERF_STATS_ENABLE
+  PerfStats_Get(&perf);
+  printf("     字模 常驻%u 缓存%u QSPI%u 缺字%u，QSPI %u B，SPI %u B/%u 次，"
+         "宽度切换%u，窗口%u(省去地址指令%u，接着写入%u)\n",
+         perf.glyph_resident, perf.glyph_cache, perf.glyph_qspi, perf.glyph_missing,
+         perf.qspi_bytes, perf.spi_bytes, perf.spi_transfers, perf.spi_reconfigs,
+         perf.set_address, perf.window_skips, perf.window_continues);
+  if (g_profile_file != NULL) {
+    PerfStats_ExportGlyphProfile(Sim_ProfileWrite); // 各字号依次追加，同一码点由工具累加
+  }
+#endif
+  if (bus.collisions != 0) {
+    printf("     警告：%u 次SPI传输在DMA未完成时发起\n", bus.collisions);
+  }
+}
+
+/*******************************************************************************
+ *                              回归比较
+ ******************************************************************************/
+
+#define SIM_MAX_CASES 64
+
+/**
+ * @brief  回归场景，按 -s 的每个字号各渲染一次
+ */
+typedef struct {
+  const char *name;
+  uint8_t encoding; /*!< Text_UTF8 / Text_GBK */
+  uint8_t mode;     /*!< Text_Opaque / Text_Transparent */
+  int16_t x, y;     /*!< 起点；x为负数时距右边，y为负数时只露出字高的一半 */
+  const char *text;
+} Sim_Scene_t;
+
+static const Sim_Scene_t g_scenes[] = {
+    {"utf8", Text_UTF8, Text_Opaque, 0, 0, "反客科技STM32 这是一个测试，哈基米南北绿豆，stm32~"},
+    {"ascii", Text_UTF8, Text_Opaque, 3, 5, "The quick brown fox jumps over the lazy dog 0123456789"},
+    {"gbk", Text_GBK, Text_Opaque, 0, 0, // "温度25.6C 湿度48% 设置 返回"
+     "\xCE\xC2\xB6\xC8" "25.6C \xCA\xAA\xB6\xC8" "48% \xC9\xE8\xD6\xC3 \xB7\xB5\xBB\xD8"},
+    {"wrap", Text_UTF8, Text_Opaque, -40, 0, "温度25.6C 湿度48% 电压3.30V 电流0.52A 设置 返回 确定 取消"},
+    {"missing", Text_UTF8, Text_Opaque, 0, 0, "缺字\xF0\x9F\x98\x80测试\xE3\x90\x80 end"}, // U+1F600、U+3400 不在GB2312中
+    {"bottom", Text_UTF8, Text_Opaque, 0, -1, "底边裁剪 Clip 0123"},
+    {"transparent", Text_UTF8, Text_Transparent, 8, 8, "透明叠加 Overlay 25.6C"},
+};
+
+/**
+ * @brief  一个场景的结果：画面散列决定是否正确，计数决定是否变慢
+ */
+typedef struct {
+  char name[24];
+  uint32_t frame, pixels, commands; /*!< 显存、像素流、指令流散列 */
+  uint64_t bytes;
+  uint32_t windows, transfers;
+  uint32_t lookups, qspi; /*!< 字模缓存查找次数、其中从QSPI读取的次数 */
+} Sim_Result_t;
+
+/**
+ * @brief  渲染一个场景并记录散列和总线计数
+ */
+static void Sim_RunScene(const Sim_Scene_t *sc, uint8_t font_size, Sim_Result_t *r) {
+  GlyphCache_Stats_t cache;
+  Sim_Stats_t bus;
+  uint16_t x = (sc->x < 0) ? (uint16_t)(LCD_Width + sc->x) : (uint16_t)sc->x;
+  uint16_t y = (sc->y < 0) ? (uint16_t)(LCD_Height - font_size / 2) : (uint16_t)sc->y;
+
+  LCD_SetColor(LCD_WHITE);
+  LCD_SetBackColor(LCD_BLACK);
+  LCD_Clear();
+  if (sc->mode == Text_Transparent) {
+    LCD_SetColor(LCD_BLUE);
+    LCD_FillRect(0, 0, LCD_Width, (uint16_t)(y + font_size / 2)); // 上半行压在色块上
+    LCD_SetColor(LCD_WHITE);
+  }
+  Sim_Present(); // 清屏的发送不计入场景
+#ifdef GLYPH_CACHE_ENABLE
+  GlyphCache_Clear(); // 每个场景都从空缓存开始，计数与场景顺序无关
+#endif
+  Sim_ResetStats();
+
+  LCD_SetTextFont(font_size);
+  LCD_SetTextEncoding(sc->encoding);
+  LCD_SetTextMode(sc->mode);
+  LCD_DisplayText(x, y, (char *)sc->text);
+  Sim_Present();
+  LCD_SetTextEncoding(Text_UTF8);
+  LCD_SetTextMode(Text_Opaque);
+
+  Sim_GetStats(&bus);
+  memset(&cache, 0, sizeof(cache));
+#ifdef GLYPH_CACHE_ENABLE
+  GlyphCache_GetStats(&cache);
+#endif
+  snprintf(r->name, sizeof(r->name), "%s-%u", sc->name, font_size);
+  r->frame = Sim_FrameHash();
+  r->pixels = bus.pixel_hash;
+  r->commands = bus.command_hash;
+  r->bytes = bus.bytes;
+  r->windows = bus.windows;
+  r->transfers = bus.transfers;
+  r->lookups = cache.hits + cache.misses;
+  r->qspi = cache.misses;
+}
+
+/**
+ * @brief  读入 Sim_Regress() 保存的参考结果
+ * @retval 场景数，文件无法读取返回-1
+ */
+static int Sim_LoadResults(const char *path, Sim_Result_t *out, int max) {
+  FILE *f = fopen(path, "r");
+  char line[256];
+  int n = 0;
+
+  if (f == NULL) {
+    return -1;
+  }
+  while (n < max && fgets(line, sizeof(line), f) != NULL) {
+    Sim_Result_t *r = &out[n];
+    unsigned long long bytes;
+
+    if (line[0] == '#') {
+      continue;
+    }
+    if (sscanf(line, "%23s %x %x %x %llu %u %u %u %u", r->name, &r->frame, &r->pixels,
+               &r->commands, &bytes, &r->windows, &r->transfers, &r->lookups, &r->qspi) == 9) {
+      r->bytes = bytes;
+      n++;
+    }
+  }
+  fclose(f);
+  return n;
+}
+
+/**
+ * @brief  新旧计数对比，增加时返回1
+ */
+static int Sim_Delta(const char *label, uint64_t now, uint64_t ref) {
+  if (now != ref) {
+    printf(" %s %llu→%llu", label, (unsigned long long)ref, (unsigned long long)now);
+  }
+  return now > ref;
+}
+
+/**
+ * @brief  回归比较：渲染全部场景，与参考结果比较或保存为参考结果
+ * @param  record: 非NULL时保存结果
+ * @param  golden: 非NULL时与参考结果比较
+ * @param  history: 非NULL时追加一行合计，跟踪各次修改后的总线开销
+ * @retval 0-画面一致且计数没有增加，1-画面不同、场景增减或计数增加，2-文件错误
+ */
+static int Sim_Regress(const uint8_t *sizes, uint8_t size_count, const char *record,
+                       const char *golden, const char *history) {
+  static Sim_Result_t now[SIM_MAX_CASES], ref[SIM_MAX_CASES];
+  Sim_Result_t total;
+  int n = 0, ref_count = 0, wrong = 0, slower = 0, faster = 0, reordered = 0;
+  double t0 = Sim_Now(), dt;
+
+  for (uint32_t s = 0; s < sizeof(g_scenes) / sizeof(g_scenes[0]); s++) {
+    for (uint8_t i = 0; i < size_count && n < SIM_MAX_CASES; i++) {
+      if (FlashFont_BytesPerChar(sizes[i]) > 0) {
+        Sim_RunScene(&g_scenes[s], sizes[i], &now[n++]);
+      }
+    }
+  }
+  dt = Sim_Now() - t0;
+
+  memset(&total, 0, sizeof(total));
+  for (int i = 0; i < n; i++) {
+    total.bytes += now[i].bytes;
+    total.windows += now[i].windows;
+    total.transfers += now[i].transfers;
+    total.lookups += now[i].lookups;
+    total.qspi += now[i].qspi;
+  }
+  printf("回归：%d 个场景，%.3f ms，SPI %llu B，窗口 %u，传输 %u，字模查找 %u(QSPI %u)\n", n,
+         dt * 1e3, (unsigned long long)total.bytes, total.windows, total.transfers, total.lookups,
+         total.qspi);
+
+  if (golden != NULL && (ref_count = Sim_LoadResults(golden, ref, SIM_MAX_CASES)) < 0) {
+    perror(golden);
+    return 2;
+  }
+  for (int i = 0; golden != NULL && i < n; i++) {
+    const Sim_Result_t *a = &now[i], *b = NULL;
+    int up = 0, down;
+
+    for (int j = 0; j < ref_count && b == NULL; j++) {
+      b = (strcmp(ref[j].name, a->name) == 0) ? &ref[j] : NULL;
+    }
+    if (b == NULL) {
+      printf("%-16s 参考结果中没有该场景\n", a->name);
+      wrong++;
+      continue;
+    }
+    if (a->frame != b->frame) {
+      printf("%-16s 画面不同\n", a->name);
+      wrong++;
+      continue;
+    }
+    if (a->pixels == b->pixels && a->commands == b->commands && a->bytes == b->bytes &&
+        a->windows == b->windows && a->transfers == b->transfers && a->lookups == b->lookups &&
+        a->qspi == b->qspi) {
+      continue; // 输出完全相同
+    }
+    printf("%-16s 画面一致，%s", a->name,
+           (a->pixels != b->pixels || a->commands != b->commands) ? "发送顺序改变" : "发送相同");
+    up |= Sim_Delta("字节", a->bytes, b->bytes);
+    up |= Sim_Delta("窗口", a->windows, b->windows);
+    up |= Sim_Delta("传输", a->transfers, b->transfers);
+    up |= Sim_Delta("查找", a->lookups, b->lookups);
+    up |= Sim_Delta("QSPI", a->qspi, b->qspi);
+    printf("%s\n", up ? "  ← 开销增加" : "");
+    down = a->bytes < b->bytes || a->windows < b->windows || a->transfers < b->transfers ||
+           a->lookups < b->lookups || a->qspi < b->qspi;
+    slower += up;
+    faster += !up && down;
+    reordered += !up && !down;
+  }
+  for (int j = 0; j < ref_count; j++) {
+    int found = 0;
+
+    for (int i = 0; i < n && !found; i++) {
+      found = strcmp(now[i].name, ref[j].name) == 0;
+    }
+    if (!found) {
+      printf("%-16s 本次没有渲染该场景\n", ref[j].name);
+      wrong++;
+    }
+  }
+  if (golden != NULL) {
+    printf("%s: 画面不同或场景增减 %d，开销增加 %d，开销减少 %d，仅发送顺序改变 %d\n", golden, wrong, slower,
+           faster, reordered);
+  }
+
+  if (record != NULL) {
+    FILE *f = fopen(record, "w");
+
+    if (f == NULL) {
+      perror(record);
+      return 2;
+    }
+    fprintf(f, "# name frame pixels commands bytes windows transfers lookups qspi\n");
+    for (int i = 0; i < n; i++) {
+      fprintf(f, "%s %08x %08x %08x %llu %u %u %u %u\n", now[i].name, now[i].frame, now[i].pixels,
+              now[i].commands, (unsigned long long)now[i].bytes, now[i].windows, now[i].transfers,
+              now[i].lookups, now[i].qspi);
+    }
+    fclose(f);
+  }
+  if (history != NULL) {
+    FILE *f = fopen(history, "a");
+
+    if (f == NULL) {
+      perror(history);
+      return 2;
+    }
+    fprintf(f, "%ld,%d,%d,%llu,%u,%u,%u,%u,%.3f\n", (long)time(NULL), n, wrong,
+            (unsigned long long)total.bytes, total.windows, total.transfers, total.lookups,
+            total.qspi, dt * 1e3);
+    fclose(f);
+  }
+  return (wrong > 0 || slower > 0) ? 1 : 0;
+}
+
+static void Sim_Usage(const char *prog) {
+  fprintf(stderr,
+          "用法: %s [-f font.bin] [-c corpus.txt] [-s 12,16,24] [-n passes]\n"
+          "          [-o scene.ppm] [-w scene.raw] [-g golden.raw] [-t trace.json]\n"
+          "          [-p profile.txt] [-C cycles.txt] [-r golden.txt] [-R golden.txt]\n"
+          "          [-l history.csv] [-S]\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  const char *font = SIM_DEFAULT_FONT, *corpus = NULL;
+  const char *ppm = NULL, *save = NULL, *golden = NULL, *trace = NULL;
+  const char *profile = NULL, *regress = NULL, *record = NULL, *history = NULL;
+  const char *cycles = NULL;
+  uint8_t stress = 0;
+  uint8_t sizes[SIM_MAX_SIZES] = {12, 16, 20, 24, 32};
+  uint8_t size_count = 5;
+  uint32_t passes = 10;
+  int opt, ret = 0;
+
+  while ((opt = getopt(argc, argv, "f:c:s:n:o:w:g:t:p:C:r:R:l:Sh")) != -1) {
+    switch (opt) {
+    case 'f': font = optarg; break;
+    case 'c': corpus = optarg; break;
+    case 's': size_count = Sim_ParseSizes(optarg, sizes); break;
+    case 'n': passes = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 'o': ppm = optarg; break;
+    case 'w': save = optarg; break;
+    case 'g': golden = optarg; break;
+    case 't': trace = optarg; break;
+    case 'p': profile = optarg; break;
+    case 'C': cycles = optarg; break;
+    case 'r': regress = optarg; break;
+    case 'R': record = optarg; break;
+    case 'l': history = optarg; break;
+    case 'S': stress = 1; break;
+    default: Sim_Usage(argv[0]); return 2;
+    }
+  }
+
+  if (corpus != NULL) {
+    if (Sim_LoadCorpus(corpus) != 0) {
+      return 2;
+    }
+  } else {
+    for (uint32_t i = 0; i < sizeof(g_default_corpus) / sizeof(g_default_corpus[0]); i++) {
+      g_lines[g_line_count++] = (char *)g_default_corpus[i];
+    }
+  }
+  if (g_line_count == 0 || size_count == 0) {
+    Sim_Usage(argv[0]);
+    return 2;
+  }
+
+  if (Sim_Init(font) != 0) {
+    return 2;
+  }
+  SPI_LCD_Init();
+  if (FlashFont_Init() != 0) {
+    fprintf(stderr, "%s: 字库初始化失败\n", font);
+    return 2;
+  }
+  while (FlashFont_Idle()) {
+    // 与板上主循环空闲时建完索引后的稳态一致
+  }
+
+  // 压力测试只运行压力场景
+  if (stress) {
+#ifdef STRESS_BENCH_ENABLE
+    Stress_Bench_Run();
+    Stress_Bench_Print();
+    return 0;
+#else
+    fprintf(stderr, "-S: 需要以 -DSTRESS_BENCH_ENABLE 编译\n");
+    return 2;
+#endif
+  }
+
+  // 回归比较只渲染回归场景
+  if (regress != NULL || record != NULL || history != NULL) {
+    return Sim_Regress(sizes, size_count, record, regress, history);
+  }
+
+  // 参考画面
+#ifdef PERF_TRACE_ENABLE
+  PerfTrace_Start();
+#endif
+  Sim_DrawScene(sizes, size_count);
+#ifdef PERF_TRACE_ENABLE
+  PerfTrace_Stop();
+  if (trace != NULL) {
+    g_trace_file = fopen(trace, "w");
+    if (g_trace_file == NULL) {
+      perror(trace);
+      ret = 2;
+    } else {
+      PerfTrace_Export(Sim_TraceWrite);
+      fclose(g_trace_file);
+    }
+  }
+#else
+  if (trace != NULL) {
+    fprintf(stderr, "%s: 需要以 -DPERF_TRACE_ENABLE 编译\n", trace);
+  }
+#endif
+  if (ppm != NULL && Sim_SavePPM(ppm, LCD_Width, LCD_Height) != 0) {
+    perror(ppm);
+    ret = 2;
+  }
+  if (save != NULL && Sim_SaveRaw(save) != 0) {
+    perror(save);
+    ret = 2;
+  }
+  if (golden != NULL) {
+    int32_t diff = Sim_CompareRaw(golden);
+
+    if (diff != 0) {
+      fprintf(stderr, "%s: %d 个像素不同\n", golden, (int)diff);
+      ret = 1;
+    } else {
+      printf("%s: 一致\n", golden);
+    }
+  }
+
+  // 吞吐测试
+#ifdef PERF_STATS_ENABLE
+  if (profile != NULL && passes > 0 && (g_profile_file = fopen(profile, "w")) == NULL) {
+    perror(profile);
+    ret = 2;
+  }
+#else
+  if (profile != NULL) {
+    fprintf(stderr, "%s: 需要以 -DPERF_STATS_ENABLE 编译\n", profile);
+  }
+#endif
+#ifdef PERF_PROFILE_ENABLE
+  if (cycles != NULL && passes > 0) {
+    PerfProfile_Start();
+  }
+#else
+  if (cycles != NULL) {
+    fprintf(stderr, "%s: 需要以 make PROFILE=1 编译\n", cycles);
+  }
+#endif
+  if (passes > 0) {
+    printf("%s，%u 行语料 x %u 遍\n", LCD_Panel_Controller()->Name, g_line_count, passes);
+    printf("size     chars     ms     chars/s  B/char  win/char xfer/char  cache\n");
+    for (uint8_t i = 0; i < size_count; i++) {
+      if (FlashFont_BytesPerChar(sizes[i]) <= 0) {
+        printf("%4u 字库中没有该字号\n", sizes[i]);
+        continue;
+      }
+      Sim_Throughput(sizes[i], passes);
+    }
+  }
+#ifdef PERF_STATS_ENABLE
+  if (g_profile_file != NULL) {
+    fclose(g_profile_file);
+  }
+#endif
+#ifdef PERF_PROFILE_ENABLE
+  if (cycles != NULL && passes > 0) {
+    PerfProfile_Stop();
+    if ((g_cycles_file = fopen(cycles, "w")) == NULL) {
+      perror(cycles);
+      ret = 2;
+    } else {
+      PerfProfile_Export(Sim_CyclesWrite, 0);
+      fclose(g_cycles_file);
+    }
+  }
+#endif
+  return ret;
+}
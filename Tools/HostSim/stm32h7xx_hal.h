@@ -0,0 +1,637 @@
+/**
+ ******************************************************************************
+ * @file    stm32h7xx_hal.h
+ * @author  菜菜why（B站：菜菜whyy）
+ * @brief   主机仿真用的HAL替身头文件
+ ******************************************************************************
+ * @attention
+ *
+ * 说明：
+ * - 只声明 lcd_spi.c / flash_font.c / glyph_cache.c / glyph_prefetch.c
+ *   用到的类型、宏和函数，实现位于 sim_hal.c
+ * - 外设寄存器是普通内存，SPI状态标志恒为置位，发送寄存器的写入
+ *   经 LCD_SPI_WRITE_TXDR16/32 交给仿真的屏幕控制器
+ * - 字库通过 mmap 映射到 W25Qxx_Mem_Addr(0x90000000)，与硬件地址一致
+ * - Cache维护、DWT、NVIC等与结果无关的操作为空函数
+ *
+ ******************************************************************************
+ */
+
+#ifndef SIM_STM32H7XX_HAL_H
+#define SIM_STM32H7XX_HAL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ *                          编译器与内核
+ ******************************************************************************/
+#define __weak __attribute__((weak))
+#define __IO volatile
+#define __STATIC_FORCEINLINE __attribute__((always_inline)) static inline
+#define __NOP() ((void)0)
+#define __DSB() ((void)0)
+#define __ISB() ((void)0)
+#define __get_PRIMASK() 0U /* 单线程，临界区为空 */
+#define __set_PRIMASK(x) ((void)(x))
+#define __disable_irq() ((void)0)
+#define __CLZ(x) ((x) ? (uint32_t)__builtin_clz(x) : 32U)
+
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t v) /* 位反转，与Cortex-M7的RBIT指令相同 */
+{
+  uint32_t r = 0;
+
+  for (int i = 0; i < 32; i++, v >>= 1) {
+    r = (r << 1) | (v & 1U);
+  }
+  return r;
+}
+static uint32_t Sim_APSR_GE; /* APSR.GE[3:0]，由 __USUB16 设置、__SEL 使用 */
+__STATIC_FORCEINLINE uint32_t __USUB16(uint32_t a, uint32_t b) /* 两个半字分别相减，不借位时置位对应的两个GE位 */
+{
+  uint32_t lo = (a & 0xFFFFU) - (b & 0xFFFFU), hi = (a >> 16) - (b >> 16);
+
+  Sim_APSR_GE = ((lo & 0x10000U) ? 0U : 0x3U) | ((hi & 0x10000U) ? 0U : 0xCU);
+  return (lo & 0xFFFFU) | (hi << 16);
+}
+__STATIC_FORCEINLINE uint32_t __SEL(uint32_t a, uint32_t b) /* GE位为1的字节取a，否则取b */
+{
+  uint32_t r = 0;
+
+  for (int i = 0; i < 4; i++) {
+    r |= (((Sim_APSR_GE >> i) & 1U) ? a : b) & (0xFFU << (i * 8));
+  }
+  return r;
+}
+#define zero_init /* ARMCC专有属性，主机上由 .bss 清零 */
+#define UNUSED(x) ((void)(x))
+#define assert_param(expr) ((void)0)
+
+#define SET_BIT(REG, BIT) ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT) ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT) ((REG) & (BIT))
+#define WRITE_REG(REG, VAL) ((REG) = (VAL))
+#define READ_REG(REG) ((REG))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK)                                    \
+  WRITE_REG((REG), (((READ_REG(REG)) & (~(CLEARMASK))) | (SETMASK)))
+
+    typedef enum
+    {
+        HAL_OK = 0x00U,
+        HAL_ERROR = 0x01U,
+        HAL_BUSY = 0x02U,
+        HAL_TIMEOUT = 0x03U
+    } HAL_StatusTypeDef;
+
+    typedef enum
+    {
+        HAL_UNLOCKED = 0x00U,
+        HAL_LOCKED = 0x01U
+    } HAL_LockTypeDef;
+
+    typedef enum
+    {
+        RESET = 0U,
+        SET = !RESET
+    } FlagStatus,
+        ITStatus;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+#define __HAL_LOCK(__HANDLE__)                                                 \
+  do {                                                                         \
+    if ((__HANDLE__)->Lock == HAL_LOCKED) {                                    \
+      return HAL_BUSY;                                                         \
+    }                                                                          \
+    (__HANDLE__)->Lock = HAL_LOCKED;                                           \
+  } while (0)
+#define __HAL_UNLOCK(__HANDLE__)                                               \
+  do {                                                                         \
+    (__HANDLE__)->Lock = HAL_UNLOCKED;                                         \
+  } while (0)
+
+    extern uint32_t SystemCoreClock;
+    uint32_t HAL_GetTick(void);
+    void HAL_Delay(uint32_t Delay);
+
+    typedef int IRQn_Type;
+    void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority,
+                              uint32_t SubPriority);
+    void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+
+    /* Cache维护 */
+    void SCB_InvalidateICache(void);
+    void SCB_CleanInvalidateDCache(void);
+    void SCB_CleanDCache_by_Addr(uint32_t *addr, int32_t dsize);
+    void SCB_InvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize);
+    void SCB_CleanInvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize);
+
+    /* DWT周期计数器，主机上CYCCNT保持为0，耗时由仿真程序用系统时钟测量 */
+    typedef struct
+    {
+        volatile uint32_t CTRL, CYCCNT, LAR;
+    } DWT_Type;
+    typedef struct
+    {
+        volatile uint32_t DEMCR;
+    } CoreDebug_Type;
+    extern DWT_Type *DWT;
+    extern CoreDebug_Type *CoreDebug;
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+
+    /* 事件记录的时间戳改用主机时钟换算的周期数；主机上单线程执行，独占访问直接读写 */
+    uint32_t Sim_Cycles(void);
+#define PERF_TRACE_TIMESTAMP() Sim_Cycles()
+#define PERF_PROFILE_TIMESTAMP() Sim_Cycles()
+#define STRESS_BENCH_TIMESTAMP() Sim_Cycles()
+#define LCD_ALARM_TIMESTAMP() Sim_Cycles()
+#define __LDREXW(p) (*(p))
+#define __STREXW(v, p) ((*(p) = (v)), 0U)
+#define __CLREX() ((void)0)
+#define __DMB() ((void)0)
+
+/*******************************************************************************
+ *                          RCC(外设时钟配置直接返回成功)
+ ******************************************************************************/
+#define HSI_VALUE 64000000UL
+
+    typedef struct
+    {
+        uint32_t PLL3M, PLL3N, PLL3P, PLL3Q, PLL3R, PLL3RGE, PLL3VCOSEL, PLL3FRACN;
+    } RCC_PLL3InitTypeDef;
+
+    typedef struct
+    {
+        uint64_t PeriphClockSelection;
+        RCC_PLL3InitTypeDef PLL3;
+        uint32_t Spi6ClockSelection;
+    } RCC_PeriphCLKInitTypeDef;
+
+#define RCC_PERIPHCLK_SPI6 (1ULL << 15)
+#define RCC_SPI6CLKSOURCE_PLL3 0x02000000U
+#define RCC_PLL3VCIRANGE_0 0U
+#define RCC_PLL3VCIRANGE_1 1U
+#define RCC_PLL3VCIRANGE_2 2U
+#define RCC_PLL3VCIRANGE_3 3U
+#define RCC_PLL3VCOWIDE 0U
+
+    HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit);
+
+/*******************************************************************************
+ *                          GPIO
+ ******************************************************************************/
+    typedef enum
+    {
+        GPIO_PIN_RESET = 0U,
+        GPIO_PIN_SET
+    } GPIO_PinState;
+
+    typedef struct
+    {
+        volatile uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2];
+    } GPIO_TypeDef;
+
+    typedef struct
+    {
+        uint32_t Pin, Mode, Pull, Speed, Alternate;
+    } GPIO_InitTypeDef;
+
+    extern GPIO_TypeDef g_gpio[8];
+#define GPIOA (&g_gpio[0])
+#define GPIOB (&g_gpio[1])
+#define GPIOC (&g_gpio[2])
+#define GPIOD (&g_gpio[3])
+#define GPIOE (&g_gpio[4])
+#define GPIOG (&g_gpio[5])
+#define GPIOH (&g_gpio[6])
+#define GPIOI (&g_gpio[7])
+
+#define GPIO_PIN_0 ((uint16_t)0x0001)
+#define GPIO_PIN_6 ((uint16_t)0x0040)
+#define GPIO_PIN_12 ((uint16_t)0x1000)
+#define GPIO_PIN_13 ((uint16_t)0x2000)
+#define GPIO_PIN_15 ((uint16_t)0x8000)
+#define GPIO_MODE_INPUT 0x00000000U
+#define GPIO_MODE_OUTPUT_PP 0x00000001U
+#define GPIO_MODE_AF_PP 0x00000002U
+#define GPIO_AF7_SPI6 ((uint8_t)0x07)
+#define GPIO_NOPULL 0x00000000U
+#define GPIO_PULLUP 0x00000001U
+#define GPIO_SPEED_FREQ_LOW 0x00000000U
+#define GPIO_SPEED_FREQ_VERY_HIGH 0x00000003U
+#define __HAL_RCC_GPIOA_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOG_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOH_CLK_ENABLE() ((void)0)
+
+    void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+    void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+    void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+    GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+
+/*******************************************************************************
+ *                          SPI
+ ******************************************************************************/
+    typedef struct
+    {
+        volatile uint32_t CR1, CR2, CFG1, CFG2, IER, SR, IFCR, RESERVED0, TXDR,
+            RESERVED1[3], RXDR, RESERVED2[3], CRCPOLY, TXCRC, RXCRC, UDRDR, I2SCFGR;
+    } SPI_TypeDef;
+
+    typedef struct
+    {
+        uint32_t Mode, Direction, DataSize, CLKPolarity, CLKPhase, NSS,
+            BaudRatePrescaler, FirstBit, TIMode, CRCCalculation, CRCPolynomial,
+            CRCLength, TxCRCInitializationPattern, RxCRCInitializationPattern,
+            NSSPMode, NSSPolarity, FifoThreshold, MasterSSIdleness,
+            MasterInterDataIdleness, MasterReceiverAutoSusp, MasterKeepIOState,
+            IOSwap;
+    } SPI_InitTypeDef;
+
+    typedef enum
+    {
+        HAL_SPI_STATE_RESET = 0x00U,
+        HAL_SPI_STATE_READY,
+        HAL_SPI_STATE_BUSY,
+        HAL_SPI_STATE_BUSY_TX,
+        HAL_SPI_STATE_BUSY_RX,
+        HAL_SPI_STATE_BUSY_TX_RX,
+        HAL_SPI_STATE_ERROR,
+        HAL_SPI_STATE_ABORT
+    } HAL_SPI_StateTypeDef;
+
+    typedef struct __SPI_HandleTypeDef
+    {
+        SPI_TypeDef *Instance;
+        SPI_InitTypeDef Init;
+        const uint8_t *pTxBuffPtr;
+        uint16_t TxXferSize;
+        volatile uint16_t TxXferCount;
+        uint8_t *pRxBuffPtr;
+        uint16_t RxXferSize;
+        volatile uint16_t RxXferCount;
+        uint32_t CRCSize;
+        void (*RxISR)(struct __SPI_HandleTypeDef *hspi);
+        void (*TxISR)(struct __SPI_HandleTypeDef *hspi);
+        void *hdmatx, *hdmarx;
+        HAL_LockTypeDef Lock;
+        volatile HAL_SPI_StateTypeDef State;
+        volatile uint32_t ErrorCode;
+    } SPI_HandleTypeDef;
+
+#define SPI_DATASIZE_8BIT 0x00000007U
+#define SPI_DATASIZE_12BIT 0x0000000BU
+#define SPI_DATASIZE_16BIT 0x0000000FU
+#define SPI_DATASIZE_24BIT 0x00000017U
+#define SPI_DATASIZE_32BIT 0x0000001FU
+#define SPI_FIFO_THRESHOLD_01DATA 0x00000000U
+#define SPI_FIFO_THRESHOLD_02DATA 0x00000020U
+#define SPI_DIRECTION_2LINES_TXONLY 0x00020000U
+#define SPI_DIRECTION_1LINE 0x00060000U
+#define SPI_MODE_MASTER 0x00400000U
+#define SPI_BAUDRATEPRESCALER_2 0x00000000U
+
+#define SPI_CR1_SPE (1UL << 0)
+#define SPI_CR1_CSTART (1UL << 9)
+#define SPI_CR1_CSUSP (1UL << 10)
+#define SPI_CR1_HDDIR (1UL << 11)
+#define SPI_CR2_TSIZE 0x0000FFFFUL
+#define SPI_CR2_TSER_Pos 16U
+#define SPI_CR2_TSER (0xFFFFUL << SPI_CR2_TSER_Pos)
+#define SPI_CFG1_DSIZE 0x0000001FUL
+#define SPI_CFG1_RXDMAEN (1UL << 14)
+#define SPI_CFG1_TXDMAEN (1UL << 15)
+#define SPI_CFG1_MBR_Pos 28U
+#define SPI_CFG1_MBR (7UL << SPI_CFG1_MBR_Pos)
+#define SPI_CFG2_COMM (3UL << 17)
+#define SPI_SR_TXP (1UL << 1)
+#define SPI_SR_EOT (1UL << 3)
+#define SPI_SR_TXTF (1UL << 4)
+#define SPI_SR_TSERF (1UL << 10)
+#define SPI_SR_SUSP (1UL << 11)
+#define SPI_SR_TXC (1UL << 12)
+#define SPI_IFCR_EOTC (1UL << 3)
+#define SPI_IFCR_TXTFC (1UL << 4)
+#define SPI_IFCR_TSERFC (1UL << 10)
+#define SPI_IFCR_SUSPC (1UL << 11)
+
+#define SPI_FLAG_TXP SPI_SR_TXP
+#define SPI_FLAG_EOT SPI_SR_EOT
+#define SPI_FLAG_UDR (1UL << 5)
+#define SPI_FLAG_OVR (1UL << 6)
+#define SPI_FLAG_FRE (1UL << 8)
+#define SPI_FLAG_MODF (1UL << 9)
+#define SPI_FLAG_TSERF SPI_SR_TSERF
+#define SPI_FLAG_SUSP SPI_SR_SUSP
+#define SPI_FLAG_TXC SPI_SR_TXC
+#define SPI_IT_RXP (1UL << 0)
+#define SPI_IT_TXP (1UL << 1)
+#define SPI_IT_DXP (1UL << 2)
+#define SPI_IT_EOT (1UL << 3)
+#define SPI_IT_UDR (1UL << 5)
+#define SPI_IT_OVR (1UL << 6)
+#define SPI_IT_FRE (1UL << 8)
+#define SPI_IT_MODF (1UL << 9)
+
+#define HAL_SPI_ERROR_NONE 0x00000000UL
+#define HAL_SPI_ERROR_MODF 0x00000001UL
+#define HAL_SPI_ERROR_OVR 0x00000004UL
+#define HAL_SPI_ERROR_FRE 0x00000008UL
+#define HAL_SPI_ERROR_UDR 0x00000020UL
+#define HAL_SPI_ERROR_FLAG 0x00000100UL
+#define HAL_SPI_ERROR_TIMEOUT 0x00000400UL
+
+#define SPI_1LINE_TX(__HANDLE__) SET_BIT((__HANDLE__)->Instance->CR1, SPI_CR1_HDDIR)
+#define __HAL_SPI_ENABLE(__HANDLE__) SET_BIT((__HANDLE__)->Instance->CR1, SPI_CR1_SPE)
+#define __HAL_SPI_DISABLE(__HANDLE__) CLEAR_BIT((__HANDLE__)->Instance->CR1, SPI_CR1_SPE)
+#define __HAL_SPI_ENABLE_IT(__HANDLE__, __IT__) SET_BIT((__HANDLE__)->Instance->IER, (__IT__))
+#define __HAL_SPI_DISABLE_IT(__HANDLE__, __IT__) CLEAR_BIT((__HANDLE__)->Instance->IER, (__IT__))
+#define __HAL_SPI_GET_FLAG(__HANDLE__, __FLAG__) ((((__HANDLE__)->Instance->SR) & (__FLAG__)) == (__FLAG__))
+#define __HAL_SPI_CLEAR_EOTFLAG(__HANDLE__) Sim_SPI_EndTransfer(__HANDLE__) /*!< 寄存器级传输结束 */
+#define __HAL_SPI_CLEAR_TXTFFLAG(__HANDLE__) ((void)(__HANDLE__))
+#define __HAL_SPI_CLEAR_UDRFLAG(__HANDLE__) ((void)(__HANDLE__))
+#define __HAL_SPI_CLEAR_OVRFLAG(__HANDLE__) ((void)(__HANDLE__))
+#define __HAL_SPI_CLEAR_MODFFLAG(__HANDLE__) ((void)(__HANDLE__))
+#define __HAL_SPI_CLEAR_FREFLAG(__HANDLE__) ((void)(__HANDLE__))
+#define __HAL_SPI_CLEAR_TSERFFLAG(__HANDLE__) ((void)(__HANDLE__))
+
+/* lcd_spi.c 寄存器级发送的写入口，交给仿真屏幕 */
+#define LCD_SPI_WRITE_TXDR32(hspi, v) Sim_SPI_WriteTXDR((hspi), (uint32_t)(v), 4)
+#define LCD_SPI_WRITE_TXDR16(hspi, v) Sim_SPI_WriteTXDR((hspi), (uint32_t)(v), 2)
+#define LCD_SPI_WRITE_TXDR8(hspi, v) Sim_SPI_WriteTXDR((hspi), (uint32_t)(v), 1)
+/* lcd_spi.c 切换BDMA工作方式的入口，1、2为固定源地址的同色填充，0、3为缓冲区发送 */
+#define LCD_SPI_DMA_SET_MODE(mode) Sim_SPI_SetDMAFill((mode) == 1 || (mode) == 2)
+
+    void Sim_SPI_WriteTXDR(SPI_HandleTypeDef *hspi, uint32_t value, uint8_t bytes);
+    void Sim_SPI_SetDMAFill(uint8_t fill);
+    void Sim_SPI_EndTransfer(SPI_HandleTypeDef *hspi);
+
+    HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi);
+    HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData,
+                                       uint16_t Size, uint32_t Timeout);
+    HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, const uint8_t *pData,
+                                           uint16_t Size);
+    HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size,
+                                      uint32_t Timeout);
+    HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef *hspi);
+    void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi);
+
+/*******************************************************************************
+ *                          QSPI(只用到类型，驱动不参与仿真)
+ ******************************************************************************/
+    typedef enum
+    {
+        HAL_QSPI_STATE_RESET = 0x00U,
+        HAL_QSPI_STATE_READY,
+        HAL_QSPI_STATE_BUSY,
+        HAL_QSPI_STATE_BUSY_MEM_MAPPED = 0x88U
+    } HAL_QSPI_StateTypeDef;
+
+    typedef struct __QSPI_HandleTypeDef
+    {
+        void *Instance;
+        volatile HAL_QSPI_StateTypeDef State;
+    } QSPI_HandleTypeDef;
+
+    extern QSPI_HandleTypeDef hqspi;
+
+/*******************************************************************************
+ *                          MDMA(链表传输在启动时同步完成)
+ ******************************************************************************/
+    typedef struct
+    {
+        volatile uint32_t CISR, CIFCR, CESR, CCR, CTCR, CBNDTR, CSAR, CDAR, CBRUR, CLAR, CTBR;
+    } MDMA_Channel_TypeDef;
+
+    extern MDMA_Channel_TypeDef *MDMA_Channel0, *MDMA_Channel1, *MDMA_Channel2, *MDMA_Channel3,
+        *MDMA_Channel4, *MDMA_Channel5;
+#define MDMA_IRQn 122
+
+    typedef struct
+    {
+        uint32_t Request, TransferTriggerMode, Priority, Endianness, SourceInc,
+            DestinationInc, SourceDataSize, DestDataSize, DataAlignment,
+            BufferTransferLength, SourceBurst, DestBurst;
+        int32_t SourceBlockAddressOffset, DestBlockAddressOffset;
+    } MDMA_InitTypeDef;
+
+    typedef struct
+    {
+        volatile uint32_t CTCR, CBNDTR, CSAR, CDAR, CBRUR, CLAR, CTBR, Reserved, CMAR, CMDR;
+    } MDMA_LinkNodeTypeDef;
+
+    typedef struct
+    {
+        MDMA_InitTypeDef Init;
+        uint32_t SrcAddress, DstAddress, BlockDataLength, BlockCount,
+            PostRequestMaskAddress, PostRequestMaskData;
+    } MDMA_LinkNodeConfTypeDef;
+
+    typedef enum
+    {
+        HAL_MDMA_XFER_CPLT_CB_ID = 0x00U,
+        HAL_MDMA_XFER_BLOCKCPLT_CB_ID,
+        HAL_MDMA_XFER_BUFFERCPLT_CB_ID,
+        HAL_MDMA_XFER_REPBLOCKCPLT_CB_ID,
+        HAL_MDMA_XFER_ERROR_CB_ID,
+        HAL_MDMA_XFER_ABORT_CB_ID,
+        HAL_MDMA_XFER_ALL_CB_ID
+    } HAL_MDMA_CallbackIDTypeDef;
+
+    typedef struct __MDMA_HandleTypeDef
+    {
+        MDMA_Channel_TypeDef *Instance;
+        MDMA_InitTypeDef Init;
+        MDMA_LinkNodeTypeDef *FirstLinkedListNodeAddress;
+        MDMA_LinkNodeTypeDef *LastLinkedListNodeAddress;
+        uint32_t LinkedListNodeCounter;
+        void (*XferCpltCallback)(struct __MDMA_HandleTypeDef *hmdma);
+        void (*XferErrorCallback)(struct __MDMA_HandleTypeDef *hmdma);
+    } MDMA_HandleTypeDef;
+
+#define MDMA_REQUEST_SW 0x40000000U
+#define MDMA_FULL_TRANSFER 0x30000000U
+#define MDMA_PRIORITY_LOW 0x00000000U
+#define MDMA_LITTLE_ENDIANNESS_PRESERVE 0x00000000U
+#define MDMA_SRC_INC_BYTE 0x00000002U
+#define MDMA_DEST_INC_BYTE 0x00000008U
+#define MDMA_SRC_DATASIZE_BYTE 0x00000000U
+#define MDMA_DEST_DATASIZE_BYTE 0x00000000U
+#define MDMA_DATAALIGN_PACKENABLE 0x00001000U
+#define MDMA_SOURCE_BURST_SINGLE 0x00000000U
+#define MDMA_DEST_BURST_SINGLE 0x00000000U
+#define MDMA_BLOCK_TRANSFER 0x10000000U
+#define MDMA_PRIORITY_HIGH 0x00000080U
+#define MDMA_SRC_INC_HALFWORD 0x00000102U
+#define MDMA_DEST_INC_HALFWORD 0x00000408U
+#define MDMA_SRC_DATASIZE_HALFWORD 0x00000010U
+#define MDMA_DEST_DATASIZE_HALFWORD 0x00000040U
+#define MDMA_SRC_INC_DISABLE 0x00000000U
+#define MDMA_DEST_INC_DISABLE 0x00000000U
+#define MDMA_SRC_INC_WORD 0x00000202U
+#define MDMA_DEST_INC_WORD 0x00000808U
+#define MDMA_SRC_DATASIZE_WORD 0x00000020U
+#define MDMA_DEST_DATASIZE_WORD 0x00000080U
+
+    typedef enum
+    {
+        HAL_MDMA_FULL_TRANSFER = 0x00U,
+        HAL_MDMA_BUFFER_TRANSFER,
+        HAL_MDMA_BLOCK_TRANSFER,
+        HAL_MDMA_REPEAT_BLOCK_TRANSFER
+    } HAL_MDMA_LevelCompleteTypeDef;
+#define __HAL_RCC_MDMA_CLK_ENABLE() ((void)0)
+
+    HAL_StatusTypeDef HAL_MDMA_Init(MDMA_HandleTypeDef *hmdma);
+    HAL_StatusTypeDef HAL_MDMA_RegisterCallback(MDMA_HandleTypeDef *hmdma,
+                                                HAL_MDMA_CallbackIDTypeDef CallbackID,
+                                                void (*pCallback)(MDMA_HandleTypeDef *_hmdma));
+    HAL_StatusTypeDef HAL_MDMA_LinkedList_CreateNode(MDMA_LinkNodeTypeDef *pNode,
+                                                     MDMA_LinkNodeConfTypeDef *pNodeConfig);
+    HAL_StatusTypeDef HAL_MDMA_LinkedList_AddNode(MDMA_HandleTypeDef *hmdma,
+                                                  MDMA_LinkNodeTypeDef *pNewNode,
+                                                  MDMA_LinkNodeTypeDef *pPrevNode);
+    HAL_StatusTypeDef HAL_MDMA_Start_IT(MDMA_HandleTypeDef *hmdma, uint32_t SrcAddress,
+                                        uint32_t DstAddress, uint32_t BlockDataLength,
+                                        uint32_t BlockCount);
+    HAL_StatusTypeDef HAL_MDMA_Start(MDMA_HandleTypeDef *hmdma, uint32_t SrcAddress,
+                                     uint32_t DstAddress, uint32_t BlockDataLength,
+                                     uint32_t BlockCount);
+    HAL_StatusTypeDef HAL_MDMA_PollForTransfer(MDMA_HandleTypeDef *hmdma,
+                                               HAL_MDMA_LevelCompleteTypeDef CompleteLevel,
+                                               uint32_t Timeout);
+    HAL_StatusTypeDef HAL_MDMA_Abort(MDMA_HandleTypeDef *hmdma);
+    void HAL_MDMA_IRQHandler(MDMA_HandleTypeDef *hmdma);
+
+/*******************************************************************************
+ *                          DMA2D(传输在启动时同步完成)
+ ******************************************************************************/
+    typedef struct
+    {
+        volatile uint32_t CR;
+    } DMA2D_TypeDef;
+
+    extern DMA2D_TypeDef *DMA2D;
+
+    typedef struct
+    {
+        uint32_t Mode;
+        uint32_t ColorMode;
+        uint32_t OutputOffset;
+        uint32_t AlphaInverted;
+        uint32_t RedBlueSwap;
+        uint32_t BytesSwap;
+        uint32_t LineOffsetMode;
+    } DMA2D_InitTypeDef;
+
+    typedef struct
+    {
+        uint32_t InputOffset;
+        uint32_t InputColorMode;
+        uint32_t AlphaMode;
+        uint32_t InputAlpha;
+        uint32_t AlphaInverted;
+        uint32_t RedBlueSwap;
+        uint32_t ChromaSubSampling;
+    } DMA2D_LayerCfgTypeDef;
+
+    typedef struct
+    {
+        uint32_t *pCLUT;
+        uint32_t CLUTColorMode;
+        uint32_t Size;
+    } DMA2D_CLUTCfgTypeDef;
+
+    typedef struct
+    {
+        DMA2D_TypeDef *Instance;
+        DMA2D_InitTypeDef Init;
+        DMA2D_LayerCfgTypeDef LayerCfg[2];
+        const uint32_t *CLUT[2]; /*!< 仿真：载入颜色表时只记录地址 */
+    } DMA2D_HandleTypeDef;
+
+#define DMA2D_M2M_PFC 0x00010000U
+#define DMA2D_M2M_BLEND 0x00020000U
+#define DMA2D_R2M 0x00030000U
+#define DMA2D_OUTPUT_RGB565 0x00000002U
+#define DMA2D_INPUT_RGB888 0x00000001U
+#define DMA2D_INPUT_RGB565 0x00000002U
+#define DMA2D_INPUT_ARGB4444 0x00000004U
+#define DMA2D_INPUT_L8 0x00000005U
+#define DMA2D_INPUT_L4 0x00000008U
+#define DMA2D_INPUT_A8 0x00000009U
+#define DMA2D_INPUT_A4 0x0000000AU
+#define DMA2D_CCM_ARGB8888 0x00000000U
+#define DMA2D_NO_MODIF_ALPHA 0x00000000U
+#define DMA2D_REGULAR_ALPHA 0x00000000U
+#define DMA2D_RB_REGULAR 0x00000000U
+#define DMA2D_BYTES_REGULAR 0x00000000U
+#define DMA2D_LOM_PIXELS 0x00000000U
+#define DMA2D_NO_CSS 0x00000000U
+#define DMA2D_BACKGROUND_LAYER 0x00000000U
+#define DMA2D_FOREGROUND_LAYER 0x00000001U
+#define __HAL_RCC_DMA2D_CLK_ENABLE() ((void)0)
+
+    HAL_StatusTypeDef HAL_DMA2D_Init(DMA2D_HandleTypeDef *hdma2d);
+    HAL_StatusTypeDef HAL_DMA2D_ConfigLayer(DMA2D_HandleTypeDef *hdma2d, uint32_t LayerIdx);
+    HAL_StatusTypeDef HAL_DMA2D_Start(DMA2D_HandleTypeDef *hdma2d, uint32_t pdata, uint32_t DstAddress,
+                                      uint32_t Width, uint32_t Height);
+    HAL_StatusTypeDef HAL_DMA2D_BlendingStart(DMA2D_HandleTypeDef *hdma2d, uint32_t SrcAddress1,
+                                              uint32_t SrcAddress2, uint32_t DstAddress, uint32_t Width,
+                                              uint32_t Height);
+    HAL_StatusTypeDef HAL_DMA2D_CLUTStartLoad(DMA2D_HandleTypeDef *hdma2d, const DMA2D_CLUTCfgTypeDef *CLUTCfg,
+                                              uint32_t LayerIdx);
+    HAL_StatusTypeDef HAL_DMA2D_PollForTransfer(DMA2D_HandleTypeDef *hdma2d, uint32_t Timeout);
+    HAL_StatusTypeDef HAL_DMA2D_Abort(DMA2D_HandleTypeDef *hdma2d);
+
+/*******************************************************************************
+ *                          CRC(软件计算，只支持字库校验使用的配置)
+ ******************************************************************************/
+    typedef struct
+    {
+        uint32_t DefaultPolynomialUse;
+        uint32_t DefaultInitValueUse;
+        uint32_t InputDataInversionMode;
+        uint32_t OutputDataInversionMode;
+    } CRC_InitTypeDef;
+
+    typedef struct
+    {
+        void *Instance;
+        CRC_InitTypeDef Init;
+        uint32_t InputDataFormat;
+        uint32_t State; /*!< 中间值(输出反转后) */
+    } CRC_HandleTypeDef;
+
+#define CRC ((void *)0)
+#define DEFAULT_POLYNOMIAL_ENABLE 0x00U
+#define DEFAULT_INIT_VALUE_ENABLE 0x00U
+#define CRC_INPUTDATA_INVERSION_BYTE 0x00000020U
+#define CRC_OUTPUTDATA_INVERSION_ENABLE 0x00000080U
+#define CRC_INPUTDATA_FORMAT_BYTES 0x00000001U
+#define __HAL_RCC_CRC_CLK_ENABLE() ((void)0)
+
+    HAL_StatusTypeDef HAL_CRC_Init(CRC_HandleTypeDef *hcrc);
+    uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength);
+    uint32_t HAL_CRC_Accumulate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength);
+
+    /*******************************************************************************
+     *                          备份SRAM
+     ******************************************************************************/
+    extern uint32_t g_bkpsram[1024]; /* 4KB，进程内保持 */
+#define D3_BKPSRAM_BASE ((uint32_t)(uintptr_t)g_bkpsram)
+#define __HAL_RCC_BKPRAM_CLK_ENABLE() ((void)0)
+#define HAL_PWR_EnableBkUpAccess() ((void)0)
+#define HAL_PWREx_EnableBkUpReg() ((void)0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_STM32H7XX_HAL_H
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+fontsort.py - 内置中文字模表排序与键表生成工具
+
+不使用Flash字库(未定义 USE_FLASH_FONT)时，lcd_fonts.c 中的 Chinese_xxxx
+小字库按"字模, 编码"两行一组排列。本工具把每张表按编码(前两个字节，高字节
+在前)升序重排，并在表后生成编码键表和 CHINESE_xxxx_KEYS 宏，驱动据此二分
+查找，每个字符的查找次数为 log2(字数) 而不是字数。
+
+用PCtoLCD取模追加新字后重新运行一次即可；键表过期时驱动校验不通过，改为
+顺序查找，显示不受影响，只是变慢。
+
+用法:
+    python Tools/fontsort.py BSP/SPI/lcd_fonts.c           # 原地重排并更新键表
+    python Tools/fontsort.py BSP/SPI/lcd_fonts.c --check   # 只检查，需要更新时返回1
+"""
+
+import argparse
+import re
+import sys
+
+# 文件按字节处理(latin-1一一对应)，编码行中的汉字原样保留为源文件中的字节
+TABLE_RE = re.compile(r"const\s+uint8_t\s+(Chinese_(\d{4}))\s*\[\s*\d+\s*\]\s*\[\s*\d+\s*\]\s*=\s*\{")
+KEYS_RE = r"\n/\* {name} %s.*?\*/\n(?:const uint16_t {name}_Keys\[\d+\] = \{{[^}}]*\}};\n)?#define {macro} [^\n]*\n" % (
+    "的编码键表".encode("utf-8").decode("latin-1"))
+
+
+def split_items(body):
+    """把数组体拆成顶层 {...} 项，返回项文本列表"""
+    items, depth, start, quote = [], 0, 0, False
+    for i, ch in enumerate(body):
+        if quote:
+            if ch == '"' and body[i - 1] != "\\":
+                quote = False
+            continue
+        if ch == '"':
+            quote = True
+        elif ch == "{":
+            if depth == 0:
+                start = i
+            depth += 1
+        elif ch == "}":
+            depth -= 1
+            if depth == 0:
+                items.append(body[start:i + 1])
+    return items
+
+
+def item_key(code_item):
+    """编码行 {"测 "} 的键值，与驱动相同取前两个字节"""
+    m = re.search(r'"((?:[^"\\]|\\.)*)"', code_item)
+    if m is None:
+        return None
+    raw = m.group(1).encode("latin-1")
+    if len(raw) < 2:
+        return None
+    return (raw[0] << 8) | raw[1]
+
+
+def sort_table(text, m):
+    """重排一张表，返回(新文本, 数组体结束位置, 键列表)"""
+    body_start = m.end()
+    depth, i = 1, body_start
+    while depth:
+        if text[i] == "{":
+            depth += 1
+        elif text[i] == "}":
+            depth -= 1
+        i += 1
+    body_end = i - 1  # 数组体的右括号
+    items = split_items(text[body_start:body_end])
+    if len(items) % 2:
+        sys.exit("%s: 字模和编码行数不成对" % m.group(1))
+
+    entries, seen = [], set()
+    for glyph, code in zip(items[0::2], items[1::2]):
+        key = item_key(code)
+        if key is None:
+            sys.exit("%s: 无法识别编码行 %s" % (m.group(1), code.encode("latin-1").decode("utf-8", "replace")))
+        if key in seen:
+            # 与顺序查找相同，只有排在前面的一个能被找到(如UTF-8源文件中前两个字节相同的字)
+            print("%s: 重复的编码 0x%04X，只有第一个能显示" % (m.group(1), key), file=sys.stderr)
+        seen.add(key)
+        entries.append((key, glyph, code))
+    entries.sort(key=lambda e: e[0])  # 稳定排序，相同编码保持原顺序，驱动取第一个
+
+    if entries:
+        body = "\n" + "".join("\t%s,%s,\n" % (g, c) for _, g, c in entries)
+    else:
+        body = text[body_start:body_end]  # 空表保持原样
+    return text[:body_start] + body + text[body_end:], body_start + len(body), [e[0] for e in entries]
+
+
+def keys_block(name, keys):
+    macro = name.upper() + "_KEYS"
+    comment = "的编码键表，由 Tools/fontsort.py 生成，不要手工修改".encode("utf-8").decode("latin-1")
+    out = "\n/* %s %s */\n" % (name, comment)
+    if not keys:
+        return out + "#define %s NULL, 0\n" % macro
+    rows = []
+    for i in range(0, len(keys), 12):
+        rows.append("\t" + ", ".join("0x%04X" % k for k in keys[i:i + 12]) + ",")
+    out += "const uint16_t %s_Keys[%d] = {\n%s\n};\n" % (name, len(keys), "\n".join(rows))
+    return out + "#define %s %s_Keys, %d\n" % (macro, name, len(keys))
+
+
+def process(text):
+    pos = 0
+    while True:
+        m = TABLE_RE.search(text, pos)
+        if m is None:
+            return text
+        name = m.group(1)
+        text, body_end, keys = sort_table(text, m)
+        end = text.index("};", body_end) + 3  # 数组结束的 "};\n"
+        old = re.compile(KEYS_RE.format(name=name, macro=name.upper() + "_KEYS"), re.S).match(text, end)
+        block = keys_block(name, keys)
+        text = text[:end] + block + text[old.end() if old else end:]
+        pos = end + len(block)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="排序内置中文字模表并生成编码键表")
+    parser.add_argument("source", help="lcd_fonts.c")
+    parser.add_argument("--check", action="store_true", help="只检查，需要更新时返回1")
+    args = parser.parse_args()
+
+    with open(args.source, "rb") as f:
+        text = f.read().decode("latin-1")
+    new = process(text)
+    if new == text:
+        print("%s: 已是最新" % args.source)
+        return
+    if args.check:
+        sys.exit("%s: 需要重新运行 fontsort.py" % args.source)
+    data = new.encode("latin-1")
+    with open(args.source, "wb") as f:
+        f.write(data)
+    print("%s: 已更新" % args.source)
+
+
+if __name__ == "__main__":
+    main()
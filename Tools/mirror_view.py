@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+mirror_view.py - 接收开发板的远程屏幕镜像并保存为图片
+
+配合 lcd_mirror.c(init.h 中定义 LCD_MIRROR_ENABLE)使用。数据包格式(小端):
+    包头 uint16 magic 0x4D4C("LM"), 屏幕宽, 屏幕高, x, y, 宽, 行数, 数据字节数
+    数据 逐行行程编码：c < 0x80 时后跟 c+1 个RGB565像素，否则1个像素重复 (c & 0x7F)+2 次
+从串口或录下的文件读取，画面有更新时覆盖写入输出的PPM图片(看图软件可自动刷新)。
+开发板只发送变化的区域，中途接入时先在固件中调用 LCD_Mirror_Refresh() 发一次整屏。
+
+用法:
+    python mirror_view.py COM5 --baud 921600 -o screen.ppm
+    python mirror_view.py /dev/ttyACM0 -o screen.ppm
+    python mirror_view.py capture.bin --file -o screen.ppm   # 解码录下的数据
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+MAGIC = 0x4D4C
+HEADER = struct.Struct("<8H")
+
+
+def decode_rows(data, w, rows):
+    """解码一个数据包中的各行，返回像素列表的列表；数据不完整时返回None"""
+    out, pos = [], 0
+    for _ in range(rows):
+        row = []
+        while len(row) < w:
+            if pos >= len(data):
+                return None
+            c = data[pos]
+            pos += 1
+            if c < 0x80:
+                n = c + 1
+                row.extend(struct.unpack_from("<%dH" % n, data, pos))
+                pos += n * 2
+            else:
+                row.extend([struct.unpack_from("<H", data, pos)[0]] * ((c & 0x7F) + 2))
+                pos += 2
+        if len(row) != w:
+            return None
+        out.append(row)
+    return out if pos == len(data) else None
+
+
+class Screen:
+    def __init__(self):
+        self.w = self.h = 0
+        self.pix = []
+
+    def apply(self, sw, sh, x, y, w, rows, pixels):
+        if (sw, sh) != (self.w, self.h):  # 首包或屏幕旋转
+            self.w, self.h = sw, sh
+            self.pix = [0] * (sw * sh)
+        for r, row in enumerate(pixels):
+            if y + r < sh:
+                base = (y + r) * sw + x
+                self.pix[base:base + len(row)] = row[:sw - x]
+
+    def save(self, path):
+        rgb = bytearray()
+        for c in self.pix:
+            rgb += bytes(((c >> 11) << 3, ((c >> 5) & 0x3F) << 2, (c & 0x1F) << 3))
+        with open(path, "wb") as f:
+            f.write(b"P6\n%d %d\n255\n" % (self.w, self.h))
+            f.write(rgb)
+
+
+def parse(buf, screen):
+    """从缓冲区中取出完整的数据包，返回(剩余数据, 应用的包数)"""
+    applied = 0
+    while True:
+        i = buf.find(b"\x4c\x4d")
+        if i < 0:
+            return buf[-1:], applied
+        buf = buf[i:]
+        if len(buf) < HEADER.size:
+            return buf, applied
+        magic, sw, sh, x, y, w, rows, length = HEADER.unpack_from(buf)
+        if magic != MAGIC or w == 0 or x + w > sw or y + rows > sh:
+            buf = buf[1:]  # 不是包头，继续找
+            continue
+        if len(buf) < HEADER.size + length:
+            return buf, applied
+        pixels = decode_rows(buf[HEADER.size:HEADER.size + length], w, rows)
+        if pixels is None:
+            buf = buf[1:]
+            continue
+        screen.apply(sw, sh, x, y, w, rows, pixels)
+        buf = buf[HEADER.size + length:]
+        applied += 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="接收开发板的远程屏幕镜像")
+    parser.add_argument("source", help="串口名(如 COM5、/dev/ttyACM0)或 --file 时的文件名")
+    parser.add_argument("--baud", type=int, default=921600, help="串口波特率，USB CDC时不起作用")
+    parser.add_argument("--file", action="store_true", help="source 为录下的数据文件")
+    parser.add_argument("-o", "--output", default="screen.ppm", help="输出的PPM图片")
+    args = parser.parse_args()
+
+    screen = Screen()
+    if args.file:
+        with open(args.source, "rb") as f:
+            _, n = parse(f.read(), screen)
+        if screen.w:
+            screen.save(args.output)
+        print("%d 个数据包" % n)
+        return
+
+    try:
+        import serial
+    except ImportError:
+        sys.exit("需要 pyserial: pip install pyserial")
+    port = serial.Serial(args.source, args.baud, timeout=0.05)
+    buf, total, start = b"", 0, time.time()
+    while True:
+        buf += port.read(4096)
+        buf, n = parse(buf, screen)
+        if n and screen.w:
+            total += n
+            screen.save(args.output)
+            print("\r  %d 个数据包  %.1f 包/s" % (total, total / max(time.time() - start, 1e-3)), end="")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+profile_view.py - 把开发板导出的函数级周期统计换算为函数名并排序显示
+
+配合 perf_profile.c(init.h 中定义 PERF_PROFILE_ENABLE，并对要分析的源文件加
+--gnu_instrument 或 -finstrument-functions)使用。PerfProfile_Export() 的输出:
+    profile 函数数 表满次数 过深次数 MHz
+    0x地址 调用次数 inclusive exclusive 单次最长     (单位为CPU周期)
+板上没有符号表，函数名从MDK的.map文件(Image Symbol Table)或ELF文件(调用nm)中查找，
+Thumb函数地址的最低位不参与比较。
+
+用法:
+    python profile_view.py cycles.txt --map auto_stm32_test.map
+    python profile_view.py cycles.txt --elf firmware.elf --nm arm-none-eabi-nm --top 20
+    python profile_view.py cycles.txt --elf HostSim/lcd_sim --public --sort incl
+"""
+
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+
+# armlink .map 的符号行: 名字  0x地址  Thumb Code  大小  所在目标文件(段)
+MAP_SYMBOL = re.compile(r"^\s+(\S+)\s+0x([0-9a-fA-F]+)\s+(?:Thumb|ARM) Code\s+(\d+)")
+
+
+def load_map(path):
+    """读取MDK .map 的 Image Symbol Table, 返回 [(地址, 大小, 名字, 是否全局)]"""
+    symbols, scope = [], None
+    with open(path, "r", encoding="utf-8", errors="replace") as f:
+        for line in f:
+            if "Local Symbols" in line:
+                scope = False
+            elif "Global Symbols" in line:
+                scope = True
+            elif scope is not None:
+                m = MAP_SYMBOL.match(line)
+                if m:
+                    symbols.append((int(m.group(2), 16) & ~1, int(m.group(3)),
+                                    m.group(1), scope))
+    return symbols
+
+
+def load_elf(path, nm):
+    """用 nm 读取ELF中的函数符号, 返回 [(地址, 大小, 名字, 是否全局)]"""
+    out = subprocess.run([nm, "-S", "--defined-only", path], check=True,
+                         capture_output=True, text=True).stdout
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in "tTwW":
+            symbols.append((int(parts[0], 16) & ~1, int(parts[1], 16), parts[3],
+                            parts[2] in "TW"))
+    return symbols
+
+
+class Resolver:
+    def __init__(self, symbols):
+        symbols = sorted(symbols)
+        self.addrs = [s[0] for s in symbols]
+        self.symbols = symbols
+
+    def find(self, addr):
+        """返回 (名字, 是否全局); 找不到时返回地址本身"""
+        addr &= ~1
+        i = bisect.bisect_right(self.addrs, addr) - 1
+        if i >= 0:
+            base, size, name, public = self.symbols[i]
+            if addr == base:
+                return name, public
+            if addr < base + max(size, 1):
+                return "%s+0x%x" % (name, addr - base), public
+        return "0x%08x" % addr, False
+
+
+def parse(path):
+    """读取导出文本, 返回 (头部字段, [(地址, 调用, inclusive, exclusive, 最长)])"""
+    head, rows = None, []
+    with open(path, "r", encoding="utf-8", errors="replace") as f:
+        for line in f:
+            parts = line.split()
+            if len(parts) == 5 and parts[0] == "profile":
+                head = [int(v) for v in parts[1:]]
+            elif len(parts) == 5 and parts[0].startswith("0x"):
+                rows.append((int(parts[0], 16),) + tuple(int(v) for v in parts[1:]))
+    if head is None:
+        raise ValueError("%s: 没有 profile 首行, 不是 PerfProfile_Export() 的输出" % path)
+    return head, rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description="函数级周期统计的函数名换算与排序")
+    parser.add_argument("input", help="PerfProfile_Export() 的输出")
+    parser.add_argument("--map", help="MDK 链接生成的 .map 文件")
+    parser.add_argument("--elf", help="ELF文件(主机仿真的 lcd_sim 或GCC固件)")
+    parser.add_argument("--nm", default="nm", help="与 --elf 同用的 nm 程序")
+    parser.add_argument("--sort", choices=("excl", "incl", "calls", "max"), default="excl",
+                        help="排序字段")
+    parser.add_argument("--top", type=int, default=30, help="显示的函数数, 0为全部")
+    parser.add_argument("--public", action="store_true",
+                        help="只显示全局函数(LCD_*、FlashFont_*、QSPI_W25Qxx_* 等接口)")
+    args = parser.parse_args()
+
+    head, rows = parse(args.input)
+    count, full, deep, mhz = head
+    symbols = []
+    if args.map:
+        symbols = load_map(args.map)
+    elif args.elf:
+        symbols = load_elf(args.elf, args.nm)
+    resolver = Resolver(symbols)
+
+    key = {"excl": 3, "incl": 2, "calls": 1, "max": 4}[args.sort]
+    rows.sort(key=lambda r: r[key], reverse=True)
+    total = sum(r[3] for r in rows) or 1
+    mhz = mhz or 1
+    print("%d 个函数, 表满 %d 次, 过深 %d 次, exclusive 合计 %.3f ms" %
+          (count, full, deep, total / mhz / 1000.0))
+    print("%-40s %9s %11s %11s %6s %9s %9s" %
+          ("函数", "调用", "incl(us)", "excl(us)", "excl%", "平均(us)", "最长(us)"))
+    shown = 0
+    for addr, calls, incl, excl, longest in rows:
+        name, public = resolver.find(addr)
+        if args.public and not public:
+            continue
+        print("%-40s %9d %11.1f %11.1f %5.1f%% %9.2f %9.1f" %
+              (name[:40], calls, incl / mhz, excl / mhz, 100.0 * excl / total,
+               incl / mhz / max(calls, 1), longest / mhz))
+        shown += 1
+        if args.top and shown >= args.top:
+            break
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())